@@ -0,0 +1,52 @@
+TEMPLATE = app
+TARGET   = HUpnpAvLoadTestApp
+QT      += network xml
+QT      -= gui
+CONFIG  += warn_on console
+
+INCLUDEPATH += \
+    ../../hupnp/include/ \
+    ../../hupnp_av/include/ \
+    ../loadtest-app
+
+LIBS += -L"../../hupnp/bin" -lHUpnp \
+        -L"../../hupnp_av/bin" -lHUpnpAv
+
+win32 {
+    LIBS += -lws2_32
+
+    DESCRIPTIONS = $$PWD\\..\\simple_avtest-app\\descriptions
+    DESCRIPTIONS = $${replace(DESCRIPTIONS, /, \\)}
+    QMAKE_POST_LINK += xcopy $$DESCRIPTIONS bin\\descriptions /E /Y /C /I $$escape_expand(\\n\\t)
+    QMAKE_POST_LINK += copy ..\\..\\hupnp\\bin\\* bin /Y $$escape_expand(\\n\\t)
+    QMAKE_POST_LINK += copy ..\\..\\hupnp_av\\bin\\* bin /Y
+}
+else {
+    !macx:QMAKE_LFLAGS += -Wl,--rpath=\\\$\$ORIGIN
+
+    QMAKE_POST_LINK += cp -Rf $$PWD/../simple_avtest-app/descriptions bin &
+    QMAKE_POST_LINK += cp -Rf ../../hupnp/bin/* bin &
+    QMAKE_POST_LINK += cp -fR ../../hupnp_av/bin/* bin
+}
+
+macx {
+  CONFIG -= app_bundle
+}
+
+OBJECTS_DIR = obj
+MOC_DIR = obj
+
+DESTDIR = ./bin
+
+HEADERS += \
+    contentgenerator.h \
+    cdsbenchmark.h \
+    browserbenchmark.h \
+    ../loadtest-app/memoryusage.h
+
+SOURCES += \
+    main.cpp \
+    contentgenerator.cpp \
+    cdsbenchmark.cpp \
+    browserbenchmark.cpp \
+    ../loadtest-app/memoryusage.cpp
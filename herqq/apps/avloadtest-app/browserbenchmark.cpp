@@ -0,0 +1,134 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of an application named HUpnpAvLoadTestApp
+ *  used for measuring the performance of the Herqq UPnP A/V (HUPnPAv) library.
+ *
+ *  HUpnpAvLoadTestApp is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  HUpnpAvLoadTestApp is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with HUpnpAvLoadTestApp. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "browserbenchmark.h"
+
+#include <HUpnpAv/HMediaBrowser>
+#include <HUpnpAv/HBrowseParams>
+#include <HUpnpAv/HCdsDataSource>
+#include <HUpnpAv/HAvControlPoint>
+#include <HUpnpAv/HMediaServerAdapter>
+#include <HUpnpAv/HContentDirectoryAdapter>
+
+#include <HUpnpCore/HClientDevice>
+#include <HUpnpCore/HDeviceInfo>
+
+#include <QtCore/QTimer>
+
+using namespace Herqq::Upnp;
+using namespace Herqq::Upnp::Av;
+
+BrowserBenchmark::BrowserBenchmark(
+    const HUdn& udn, const QString& containerId, qint32 iterations,
+    QObject* parent) :
+        QObject(parent),
+            m_udn(udn), m_containerId(containerId),
+            m_iterations(qMax(1, iterations)),
+            m_controlPoint(new HAvControlPoint(this)), m_cds(0), m_browser(0),
+            m_timer(), m_result(QString("HMediaBrowser, children, all"))
+{
+    bool ok = connect(
+        m_controlPoint,
+        SIGNAL(mediaServerOnline(Herqq::Upnp::Av::HMediaServerAdapter*)),
+        this,
+        SLOT(mediaServerOnline(Herqq::Upnp::Av::HMediaServerAdapter*)));
+    Q_ASSERT(ok); Q_UNUSED(ok)
+}
+
+BrowserBenchmark::~BrowserBenchmark()
+{
+    delete m_browser;
+}
+
+bool BrowserBenchmark::start()
+{
+    return m_controlPoint->init();
+}
+
+void BrowserBenchmark::mediaServerOnline(HMediaServerAdapter* server)
+{
+    if (m_cds || server->device()->info().udn() != m_udn)
+    {
+        return;
+    }
+
+    m_cds = server->contentDirectory();
+    next();
+}
+
+void BrowserBenchmark::next()
+{
+    delete m_browser;
+    m_browser = 0;
+
+    if (m_result.m_usecs.size() + m_result.m_failures >= m_iterations)
+    {
+        emit finished();
+        return;
+    }
+
+    m_browser = new HMediaBrowser(this);
+
+    bool ok = connect(
+        m_browser, SIGNAL(browseComplete(Herqq::Upnp::Av::HMediaBrowser*)),
+        this, SLOT(browseComplete(Herqq::Upnp::Av::HMediaBrowser*)));
+    Q_ASSERT(ok); Q_UNUSED(ok)
+
+    ok = connect(
+        m_browser, SIGNAL(browseFailed(Herqq::Upnp::Av::HMediaBrowser*)),
+        this, SLOT(browseFailed(Herqq::Upnp::Av::HMediaBrowser*)));
+    Q_ASSERT(ok);
+
+    m_timer.start();
+    if (!m_browser->reset(m_cds, false) ||
+        !m_browser->browse(
+            HBrowseParams(m_containerId, HBrowseParams::DirectChildren)))
+    {
+        done(false);
+    }
+}
+
+void BrowserBenchmark::done(bool succeeded)
+{
+    if (succeeded)
+    {
+        m_result.m_usecs.append(m_timer.nsecsElapsed() / 1000);
+        m_result.m_objects += m_browser->dataSource()->count();
+    }
+    else
+    {
+        ++m_result.m_failures;
+    }
+
+    // the browser is not deleted from within its own signal
+    QTimer::singleShot(0, this, SLOT(next()));
+}
+
+void BrowserBenchmark::browseComplete(HMediaBrowser*)
+{
+    done(true);
+}
+
+void BrowserBenchmark::browseFailed(HMediaBrowser*)
+{
+    done(false);
+}
@@ -0,0 +1,86 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of an application named HUpnpAvLoadTestApp
+ *  used for measuring the performance of the Herqq UPnP A/V (HUPnPAv) library.
+ *
+ *  HUpnpAvLoadTestApp is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  HUpnpAvLoadTestApp is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with HUpnpAvLoadTestApp. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BROWSERBENCHMARK_H
+#define BROWSERBENCHMARK_H
+
+#include "cdsbenchmark.h"
+
+#include <HUpnpCore/HUdn>
+
+#include <QtCore/QObject>
+#include <QtCore/QElapsedTimer>
+
+//
+// Times the control point round trip of browsing the direct children of
+// a container through HMediaBrowser. Every run uses a browser of its own,
+// so that the objects of the previous run are not counted as known.
+//
+class BrowserBenchmark :
+    public QObject
+{
+Q_OBJECT
+Q_DISABLE_COPY(BrowserBenchmark)
+
+private:
+
+    Herqq::Upnp::HUdn m_udn;
+    // the media server to be browsed; other media servers in the network
+    // are ignored
+
+    QString m_containerId;
+    qint32 m_iterations;
+
+    Herqq::Upnp::Av::HAvControlPoint* m_controlPoint;
+    Herqq::Upnp::Av::HContentDirectoryAdapter* m_cds;
+    Herqq::Upnp::Av::HMediaBrowser* m_browser;
+
+    QElapsedTimer m_timer;
+    CaseResult m_result;
+
+    void done(bool succeeded);
+
+private Q_SLOTS:
+
+    void mediaServerOnline(Herqq::Upnp::Av::HMediaServerAdapter*);
+    void browseComplete(Herqq::Upnp::Av::HMediaBrowser*);
+    void browseFailed(Herqq::Upnp::Av::HMediaBrowser*);
+    void next();
+
+public:
+
+    BrowserBenchmark(
+        const Herqq::Upnp::HUdn& udn, const QString& containerId,
+        qint32 iterations, QObject* parent = 0);
+
+    virtual ~BrowserBenchmark();
+
+    bool start();
+
+    inline const CaseResult& result() const { return m_result; }
+
+Q_SIGNALS:
+
+    void finished();
+};
+
+#endif // BROWSERBENCHMARK_H
@@ -0,0 +1,255 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of an application named HUpnpAvLoadTestApp
+ *  used for measuring the performance of the Herqq UPnP A/V (HUPnPAv) library.
+ *
+ *  HUpnpAvLoadTestApp is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  HUpnpAvLoadTestApp is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with HUpnpAvLoadTestApp. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cdsbenchmark.h"
+
+#include <HUpnpAv/HObject>
+#include <HUpnpAv/HContainer>
+#include <HUpnpAv/HSearchResult>
+#include <HUpnpAv/HContentDirectoryInfo>
+#include <HUpnpAv/HCdsDidlLiteSerializer>
+#include <HUpnpAv/HAbstractCdsDataSource>
+#include <HUpnpAv/HContentDirectoryService>
+
+#include <HUpnpCore/HUpnp>
+
+#include <QtCore/QSet>
+#include <QtCore/QStringList>
+#include <QtCore/QTextStream>
+#include <QtCore/QElapsedTimer>
+
+using namespace Herqq::Upnp;
+using namespace Herqq::Upnp::Av;
+
+namespace
+{
+qint64 percentile(const QVector<qint64>& sorted, qint32 permille)
+{
+    if (sorted.isEmpty())
+    {
+        return 0;
+    }
+
+    return sorted.at((permille * (sorted.size() - 1)) / 1000);
+}
+
+QString msecs(qint64 usecs)
+{
+    return QString::number(usecs / 1000.0, 'f', 3);
+}
+
+QSet<QString> filterSet(const char* filter)
+{
+    return QString(filter).split(',', QString::SkipEmptyParts).toSet();
+}
+}
+
+/*******************************************************************************
+ * CaseResult
+ *******************************************************************************/
+CaseResult::CaseResult(const QString& name) :
+    m_name(name), m_usecs(), m_objects(0), m_bytes(0), m_failures(0)
+{
+}
+
+void printResults(QTextStream& out, const QList<CaseResult>& results)
+{
+    out << QString("%1%2%3%4%5%6%7\n").arg("case", -36).arg("runs", 6).
+        arg("failed", 7).arg("p50 ms", 10).arg("p99 ms", 10).
+        arg("objects/s", 12).arg("B/object", 10);
+
+    foreach(const CaseResult& result, results)
+    {
+        QVector<qint64> sorted = result.m_usecs;
+        qSort(sorted);
+
+        qint64 total = 0;
+        foreach(qint64 usecs, sorted)
+        {
+            total += usecs;
+        }
+
+        double rate = total > 0 ? result.m_objects * 1000000.0 / total : 0;
+        double size = result.m_objects > 0 ?
+            static_cast<double>(result.m_bytes) / result.m_objects : 0;
+
+        out << QString("%1%2%3%4%5%6%7\n").arg(result.m_name, -36).
+            arg(sorted.size(), 6).arg(result.m_failures, 7).
+            arg(msecs(percentile(sorted, 500)), 10).
+            arg(msecs(percentile(sorted, 990)), 10).
+            arg(QString::number(rate, 'f', 0), 12).
+            arg(QString::number(size, 'f', 0), 10);
+    }
+}
+
+/*******************************************************************************
+ * CdsBenchmark
+ *******************************************************************************/
+CdsBenchmark::CdsBenchmark(
+    HContentDirectoryService* cds, HAbstractCdsDataSource* dataSource,
+    qint32 iterations) :
+        m_cds(cds), m_dataSource(dataSource),
+        m_iterations(qMax(1, iterations))
+{
+    Q_ASSERT(m_cds);
+    Q_ASSERT(m_dataSource);
+}
+
+CaseResult CdsBenchmark::browse(
+    const QString& name, const QString& objectId, bool metadata,
+    const char* filter, const char* sortCriteria, quint32 startingIndex,
+    quint32 requestedCount)
+{
+    CaseResult retVal(name);
+
+    QSet<QString> filters = filterSet(filter);
+    QStringList sorts = QString(sortCriteria).split(
+        ',', QString::SkipEmptyParts);
+
+    QElapsedTimer timer;
+    for(qint32 i = 0; i < m_iterations; ++i)
+    {
+        HSearchResult result;
+
+        timer.start();
+        qint32 rc = m_cds->browse(
+            objectId,
+            metadata ? HContentDirectoryInfo::BrowseMetadata :
+                       HContentDirectoryInfo::BrowseDirectChildren,
+            filters, startingIndex, requestedCount, sorts, &result);
+        qint64 usecs = timer.nsecsElapsed() / 1000;
+
+        if (rc != UpnpSuccess)
+        {
+            ++retVal.m_failures;
+            continue;
+        }
+
+        retVal.m_usecs.append(usecs);
+        retVal.m_objects += result.numberReturned();
+        retVal.m_bytes += result.result().toUtf8().size();
+    }
+
+    return retVal;
+}
+
+void CdsBenchmark::serialize(
+    const QString& containerId, qint32 batchSize, QList<CaseResult>* results)
+{
+    HContainer* container = m_dataSource->findContainer(containerId);
+    if (!container)
+    {
+        return;
+    }
+
+    HObjects objects = m_dataSource->findObjects(container->childIds());
+    objects = objects.mid(0, batchSize);
+
+    QString name = QString("%1 objects").arg(objects.size());
+    CaseResult toXml(QString("serializeToXml, %1").arg(name));
+    CaseResult fromXml(QString("serializeFromXml, %1").arg(name));
+
+    HCdsDidlLiteSerializer serializer;
+    QElapsedTimer timer;
+    for(qint32 i = 0; i < m_iterations; ++i)
+    {
+        timer.start();
+        QString doc = serializer.serializeToXml(objects);
+        toXml.m_usecs.append(timer.nsecsElapsed() / 1000);
+
+        qint64 bytes = doc.toUtf8().size();
+        toXml.m_objects += objects.size();
+        toXml.m_bytes += bytes;
+
+        HObjects parsed;
+        timer.start();
+        bool ok = serializer.serializeFromXml(doc, &parsed);
+        qint64 usecs = timer.nsecsElapsed() / 1000;
+
+        if (ok)
+        {
+            fromXml.m_usecs.append(usecs);
+            fromXml.m_objects += parsed.size();
+            fromXml.m_bytes += bytes;
+        }
+        else
+        {
+            ++fromXml.m_failures;
+        }
+
+        qDeleteAll(parsed);
+    }
+
+    results->append(toXml);
+    results->append(fromXml);
+}
+
+QList<CaseResult> CdsBenchmark::run(
+    const QString& containerId, const QString& itemId, qint32 batchSize)
+{
+    QList<CaseResult> retVal;
+
+    HContainer* container = m_dataSource->findContainer(containerId);
+    quint32 children = container ? container->childIds().size() : 0;
+
+    retVal.append(browse(
+        "children, first 10", containerId, false, "*", "", 0, 10));
+
+    retVal.append(browse(
+        "children, first 100", containerId, false, "*", "", 0, 100));
+
+    retVal.append(browse(
+        "children, first 1000", containerId, false, "*", "", 0, 1000));
+
+    retVal.append(browse(
+        "children, 100 from the middle", containerId, false, "*", "",
+        children / 2, 100));
+
+    retVal.append(browse(
+        "children, all", containerId, false, "*", "", 0, 0));
+
+    retVal.append(browse(
+        "children, 100, dc:title filter", containerId, false,
+        "dc:title", "", 0, 100));
+
+    retVal.append(browse(
+        "children, 100, dc:creator,res filter", containerId, false,
+        "dc:creator,res", "", 0, 100));
+
+    retVal.append(browse(
+        "children, 100, +dc:title", containerId, false, "*",
+        "+dc:title", 0, 100));
+
+    retVal.append(browse(
+        "children, 100, +upnp:class,-dc:date", containerId, false, "*",
+        "+upnp:class,-dc:date", 0, 100));
+
+    retVal.append(browse(
+        "metadata, container", containerId, true, "*", "", 0, 0));
+
+    retVal.append(browse(
+        "metadata, item", itemId, true, "*", "", 0, 0));
+
+    serialize(containerId, batchSize, &retVal);
+
+    return retVal;
+}
@@ -0,0 +1,90 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of an application named HUpnpAvLoadTestApp
+ *  used for measuring the performance of the Herqq UPnP A/V (HUPnPAv) library.
+ *
+ *  HUpnpAvLoadTestApp is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  HUpnpAvLoadTestApp is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with HUpnpAvLoadTestApp. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CDSBENCHMARK_H
+#define CDSBENCHMARK_H
+
+#include <HUpnpAv/HUpnpAv>
+
+#include <QtCore/QVector>
+#include <QtCore/QString>
+
+class QTextStream;
+
+//
+// The timings of a single benchmark case, in microseconds
+//
+struct CaseResult
+{
+    QString m_name;
+    QVector<qint64> m_usecs;
+    qint64 m_objects;
+    qint64 m_bytes;
+    // the number of objects processed and the size of the DIDL-Lite
+    // documents produced or consumed over all the runs
+
+    qint32 m_failures;
+
+    explicit CaseResult(const QString& name);
+};
+
+//
+// Prints a table of the specified results, including the throughput in
+// objects per second and the size of the DIDL-Lite per object
+//
+void printResults(QTextStream& out, const QList<CaseResult>& results);
+
+//
+// Times the server-side ContentDirectory and the DIDL-Lite serializer
+// directly, without the HTTP and SOAP layers
+//
+class CdsBenchmark
+{
+Q_DISABLE_COPY(CdsBenchmark)
+
+private:
+
+    Herqq::Upnp::Av::HContentDirectoryService* m_cds;
+    Herqq::Upnp::Av::HAbstractCdsDataSource* m_dataSource;
+    qint32 m_iterations;
+
+    CaseResult browse(
+        const QString& name, const QString& objectId, bool metadata,
+        const char* filter, const char* sortCriteria, quint32 startingIndex,
+        quint32 requestedCount);
+
+    void serialize(
+        const QString& containerId, qint32 batchSize,
+        QList<CaseResult>* results);
+
+public:
+
+    CdsBenchmark(
+        Herqq::Upnp::Av::HContentDirectoryService* cds,
+        Herqq::Upnp::Av::HAbstractCdsDataSource* dataSource,
+        qint32 iterations);
+
+    QList<CaseResult> run(
+        const QString& containerId, const QString& itemId, qint32 batchSize);
+};
+
+#endif // CDSBENCHMARK_H
@@ -0,0 +1,140 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of an application named HUpnpAvLoadTestApp
+ *  used for measuring the performance of the Herqq UPnP A/V (HUPnPAv) library.
+ *
+ *  HUpnpAvLoadTestApp is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  HUpnpAvLoadTestApp is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with HUpnpAvLoadTestApp. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "contentgenerator.h"
+
+#include <HUpnpAv/HPhoto>
+#include <HUpnpAv/HMovie>
+#include <HUpnpAv/HResource>
+#include <HUpnpAv/HMusicTrack>
+#include <HUpnpAv/HProtocolInfo>
+#include <HUpnpAv/HStorageFolder>
+#include <HUpnpAv/HPersonWithRole>
+#include <HUpnpAv/HAbstractCdsDataSource>
+
+#include <QtCore/QUrl>
+#include <QtCore/QDateTime>
+
+using namespace Herqq::Upnp::Av;
+
+ContentGenerator::ContentGenerator(
+    HAbstractCdsDataSource* dataSource, qint32 depth, qint32 fanout) :
+        m_dataSource(dataSource), m_depth(qMax(0, depth)),
+        m_fanout(qMax(1, fanout)), m_leafIds(), m_containerCount(0),
+        m_itemCount(0)
+{
+    Q_ASSERT(m_dataSource);
+}
+
+void ContentGenerator::addContainers(const QString& parentId, qint32 level)
+{
+    if (level == m_depth)
+    {
+        m_leafIds.append(parentId);
+        return;
+    }
+
+    for(qint32 i = 0; i < m_fanout; ++i)
+    {
+        QString id = QString("c%1").arg(m_containerCount++);
+        m_dataSource->add(
+            new HStorageFolder(QString("Folder %1").arg(id), parentId, id));
+
+        addContainers(id, level + 1);
+    }
+}
+
+HItem* ContentGenerator::createItem(qint32 index, const QString& parentId)
+{
+    // the titles are scrambled so that sorting them has some work to do
+    QString title = QString("Title %1").arg(
+        (static_cast<quint32>(index) * 2654435761u) % 10000019u, 8, 10,
+        QChar('0'));
+
+    QString id = QString("i%1").arg(index);
+    QDateTime date = QDateTime(QDate(2000, 1, 1)).addSecs(index * 3600);
+
+    HItem* item = 0;
+    QString contentFormat;
+    switch(index % 3)
+    {
+    case 0:
+    {
+        HMusicTrack* track = new HMusicTrack(title, parentId, id);
+        track->setArtists(QList<HPersonWithRole>() <<
+            HPersonWithRole(QString("Artist %1").arg(index % 97)));
+        track->setAlbums(QStringList() << QString("Album %1").arg(index % 499));
+        track->setOriginalTrackNumber(index % 20 + 1);
+        track->setDate(date);
+        item = track;
+        contentFormat = "audio/mpeg";
+        break;
+    }
+    case 1:
+    {
+        HPhoto* photo = new HPhoto(title, parentId, id);
+        photo->setAlbums(QStringList() << QString("Album %1").arg(index % 499));
+        photo->setDate(date);
+        item = photo;
+        contentFormat = "image/jpeg";
+        break;
+    }
+    default:
+    {
+        HMovie* movie = new HMovie(title, parentId, id);
+        movie->setDescription(QString("Description of %1").arg(title));
+        item = movie;
+        contentFormat = "video/mp4";
+        break;
+    }
+    }
+
+    item->setCreator(QString("Creator %1").arg(index % 31));
+    item->setResources(QList<HResource>() << HResource(
+        QUrl(QString("http://127.0.0.1/content/%1").arg(id)),
+        HProtocolInfo("http-get", "*", contentFormat, "*")));
+
+    return item;
+}
+
+void ContentGenerator::generate(qint32 itemCount)
+{
+    m_dataSource->add(new HStorageFolder("Contents", "-1", "0"));
+    addContainers("0", 0);
+
+    for(qint32 i = 0; i < itemCount; ++i)
+    {
+        m_dataSource->add(createItem(i, m_leafIds.at(i % m_leafIds.size())));
+    }
+
+    m_itemCount = itemCount;
+}
+
+QString ContentGenerator::largestContainerId() const
+{
+    return m_leafIds.isEmpty() ? QString("0") : m_leafIds.first();
+}
+
+QString ContentGenerator::sampleItemId() const
+{
+    return m_itemCount > 0 ? QString("i0") : QString("0");
+}
@@ -0,0 +1,71 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of an application named HUpnpAvLoadTestApp
+ *  used for measuring the performance of the Herqq UPnP A/V (HUPnPAv) library.
+ *
+ *  HUpnpAvLoadTestApp is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  HUpnpAvLoadTestApp is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with HUpnpAvLoadTestApp. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CONTENTGENERATOR_H
+#define CONTENTGENERATOR_H
+
+#include <HUpnpAv/HUpnpAv>
+
+#include <QtCore/QStringList>
+
+//
+// Fills a data source with synthetic music tracks, photos and movies in
+// equal shares. A depth of zero places every item directly under the root
+// container, whereas a positive depth creates a tree of storage folders
+// with the specified fan-out and spreads the items evenly over its leaves.
+//
+class ContentGenerator
+{
+Q_DISABLE_COPY(ContentGenerator)
+
+private:
+
+    Herqq::Upnp::Av::HAbstractCdsDataSource* m_dataSource;
+    qint32 m_depth;
+    qint32 m_fanout;
+
+    QStringList m_leafIds;
+    qint32 m_containerCount;
+    qint32 m_itemCount;
+
+    void addContainers(const QString& parentId, qint32 level);
+    Herqq::Upnp::Av::HItem* createItem(qint32 index, const QString& parentId);
+
+public:
+
+    ContentGenerator(
+        Herqq::Upnp::Av::HAbstractCdsDataSource* dataSource,
+        qint32 depth, qint32 fanout);
+
+    void generate(qint32 itemCount);
+
+    inline qint32 containerCount() const { return m_containerCount; }
+    inline qint32 itemCount() const { return m_itemCount; }
+
+    // the ID of a container holding the largest number of items
+    QString largestContainerId() const;
+
+    // the ID of an item that can be browsed for its metadata
+    QString sampleItemId() const;
+};
+
+#endif // CONTENTGENERATOR_H
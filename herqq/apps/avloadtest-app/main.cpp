@@ -0,0 +1,225 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of an application named HUpnpAvLoadTestApp
+ *  used for measuring the performance of the Herqq UPnP A/V (HUPnPAv) library.
+ *
+ *  HUpnpAvLoadTestApp is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  HUpnpAvLoadTestApp is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with HUpnpAvLoadTestApp. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cdsbenchmark.h"
+#include "memoryusage.h"
+#include "contentgenerator.h"
+#include "browserbenchmark.h"
+
+#include <HUpnpAv/HCdsDataSource>
+#include <HUpnpAv/HAvDeviceModelCreator>
+#include <HUpnpAv/HContentDirectoryService>
+#include <HUpnpAv/HAbstractMediaServerDevice>
+#include <HUpnpAv/HMediaServerDeviceConfiguration>
+#include <HUpnpAv/HContentDirectoryServiceConfiguration>
+
+#include <HUpnpCore/HUpnp>
+#include <HUpnpCore/HDeviceInfo>
+#include <HUpnpCore/HDeviceHost>
+#include <HUpnpCore/HDeviceHostConfiguration>
+
+#include <QtCore/QTimer>
+#include <QtCore/QStringList>
+#include <QtCore/QTextStream>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QCoreApplication>
+
+using namespace Herqq::Upnp;
+using namespace Herqq::Upnp::Av;
+
+namespace
+{
+void printUsage(QTextStream& out)
+{
+    out << "Usage: HUpnpAvLoadTestApp [options]\n\n"
+        << "Fills a ContentDirectory with synthetic music tracks, photos "
+           "and movies\nand times browsing it, serializing its objects to "
+           "DIDL-Lite and back\nand browsing it through HMediaBrowser.\n\n"
+        << "  --items=N         the number of items (10000)\n"
+        << "  --depth=D         the depth of the container tree; 0 places "
+           "every item\n"
+        << "                    directly under the root container (0)\n"
+        << "  --fanout=F        the number of child containers per "
+           "container (10)\n"
+        << "  --iterations=N    the number of runs of each case (20)\n"
+        << "  --batch=N         the number of objects serialized per "
+           "run (1000)\n"
+        << "  --roundtrip=N     the number of HMediaBrowser round trips; "
+           "0 skips them (5)\n"
+        << "  --timeout=S       the time the round trips may take in "
+           "seconds (60)\n";
+}
+
+qint32 intOption(const QString& arg, const QString& name, qint32 def)
+{
+    QString prefix = QString("--%1=").arg(name);
+    if (!arg.startsWith(prefix))
+    {
+        return def;
+    }
+
+    bool ok = false;
+    qint32 value = arg.mid(prefix.size()).toInt(&ok);
+    return ok ? value : def;
+}
+}
+
+int main(int argc, char* argv[])
+{
+    SetLoggingLevel(Warning);
+
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    qint32 items = 10000, depth = 0, fanout = 10, iterations = 20;
+    qint32 batch = 1000, roundtrips = 5, timeout = 60;
+
+    QStringList args = app.arguments();
+    for(qint32 i = 1; i < args.size(); ++i)
+    {
+        const QString& arg = args.at(i);
+        if (arg.startsWith("--items=") ||
+            arg.startsWith("--depth=") ||
+            arg.startsWith("--fanout=") ||
+            arg.startsWith("--iterations=") ||
+            arg.startsWith("--batch=") ||
+            arg.startsWith("--roundtrip=") ||
+            arg.startsWith("--timeout="))
+        {
+            items = intOption(arg, "items", items);
+            depth = intOption(arg, "depth", depth);
+            fanout = intOption(arg, "fanout", fanout);
+            iterations = intOption(arg, "iterations", iterations);
+            batch = intOption(arg, "batch", batch);
+            roundtrips = intOption(arg, "roundtrip", roundtrips);
+            timeout = intOption(arg, "timeout", timeout);
+        }
+        else
+        {
+            printUsage(out);
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    HCdsDataSource dataSource;
+    ContentGenerator generator(&dataSource, depth, fanout);
+
+    qint64 memoryBefore = memoryUsage("VmRSS");
+    QElapsedTimer fillTimer;
+    fillTimer.start();
+
+    generator.generate(qMax(0, items));
+
+    qint64 fillMsecs = qMax<qint64>(1, fillTimer.elapsed());
+    qint64 memoryAfter = memoryUsage("VmRSS");
+
+    out << "items: " << generator.itemCount() << ", containers: "
+        << generator.containerCount() + 1 << ", fill: " << fillMsecs
+        << " ms, " << QString::number(
+            generator.itemCount() * 1000.0 / fillMsecs, 'f', 0)
+        << " items/s\n";
+
+    if (memoryBefore >= 0 && memoryAfter >= 0 && generator.itemCount() > 0)
+    {
+        out << "memory: " << (memoryAfter - memoryBefore) / 1024
+            << " kB, " << (memoryAfter - memoryBefore) / generator.itemCount()
+            << " B per item\n";
+    }
+    out << "\n";
+    out.flush();
+
+    HContentDirectoryServiceConfiguration cdsConfiguration;
+    cdsConfiguration.setDataSource(&dataSource, false);
+
+    HMediaServerDeviceConfiguration mediaServerConfiguration;
+    mediaServerConfiguration.setContentDirectoryConfiguration(cdsConfiguration);
+
+    HAvDeviceModelCreator creator;
+    creator.setMediaServerConfiguration(mediaServerConfiguration);
+
+    HDeviceConfiguration deviceConfiguration;
+    deviceConfiguration.setPathToDeviceDescription(
+        "./descriptions/herqq_mediaserver_description.xml");
+
+    HDeviceHostConfiguration hostConfiguration(deviceConfiguration);
+    hostConfiguration.setDeviceModelCreator(creator);
+
+    HDeviceHost deviceHost;
+    if (!deviceHost.init(hostConfiguration))
+    {
+        out << "Failed to start the media server: "
+            << deviceHost.errorDescription() << "\n";
+        return 1;
+    }
+
+    HAbstractMediaServerDevice* mediaServer =
+        qobject_cast<HAbstractMediaServerDevice*>(
+            deviceHost.rootDevices().at(0));
+
+    HContentDirectoryService* cds = mediaServer ?
+        qobject_cast<HContentDirectoryService*>(
+            mediaServer->contentDirectory()) : 0;
+
+    if (!cds)
+    {
+        out << "The media server has no ContentDirectory to benchmark.\n";
+        return 1;
+    }
+
+    QString containerId = generator.largestContainerId();
+
+    CdsBenchmark benchmark(cds, &dataSource, iterations);
+    QList<CaseResult> results = benchmark.run(
+        containerId, generator.sampleItemId(), batch);
+
+    if (roundtrips > 0)
+    {
+        BrowserBenchmark browser(
+            mediaServer->info().udn(), containerId, roundtrips);
+
+        bool ok = QObject::connect(
+            &browser, SIGNAL(finished()), &app, SLOT(quit()));
+        Q_ASSERT(ok); Q_UNUSED(ok)
+
+        QTimer::singleShot(qMax(1, timeout) * 1000, &app, SLOT(quit()));
+
+        if (!browser.start())
+        {
+            out << "Failed to start the control point.\n";
+        }
+        else
+        {
+            app.exec();
+            results.append(browser.result());
+        }
+    }
+
+    out << "container: " << containerId << ", "
+        << dataSource.findContainer(containerId)->childIds().size()
+        << " children\n\n";
+
+    printResults(out, results);
+
+    deviceHost.quit();
+
+    return 0;
+}
@@ -0,0 +1,131 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of an application named HUpnpHttpBenchApp
+ *  used for measuring the performance of the Herqq UPnP (HUPnP) library.
+ *
+ *  HUpnpHttpBenchApp is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  HUpnpHttpBenchApp is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with HUpnpHttpBenchApp. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "allocationcounter.h"
+
+#include <new>
+#include <cstdlib>
+
+namespace
+{
+qint64 s_allocations = 0;
+qint64 s_bytes = 0;
+
+inline void count(std::size_t size)
+{
+    // the counters are updated atomically where the compiler allows it,
+    // since the threads of Qt allocate memory as well
+#if defined(__GNUC__)
+    __sync_fetch_and_add(&s_allocations, static_cast<qint64>(1));
+    __sync_fetch_and_add(&s_bytes, static_cast<qint64>(size));
+#else
+    ++s_allocations;
+    s_bytes += size;
+#endif
+}
+}
+
+#if defined(__GLIBC__)
+
+//
+// The allocation functions of glibc are replaced with ones that count the
+// calls and forward them to the implementations of glibc. The functions of
+// an executable take precedence over those of the shared libraries, which
+// is why the allocations of HUPnP and Qt are counted as well.
+//
+extern "C"
+{
+void* __libc_malloc(std::size_t);
+void* __libc_calloc(std::size_t, std::size_t);
+void* __libc_realloc(void*, std::size_t);
+
+void* malloc(std::size_t size)
+{
+    count(size);
+    return __libc_malloc(size);
+}
+
+void* calloc(std::size_t count_, std::size_t size)
+{
+    count(count_ * size);
+    return __libc_calloc(count_, size);
+}
+
+void* realloc(void* ptr, std::size_t size)
+{
+    count(size);
+    return __libc_realloc(ptr, size);
+}
+}
+
+bool countsMalloc()
+{
+    return true;
+}
+
+#else
+
+void* operator new(std::size_t size) throw(std::bad_alloc)
+{
+    count(size);
+    void* retVal = std::malloc(size ? size : 1);
+    if (!retVal)
+    {
+        throw std::bad_alloc();
+    }
+    return retVal;
+}
+
+void* operator new[](std::size_t size) throw(std::bad_alloc)
+{
+    return operator new(size);
+}
+
+void operator delete(void* ptr) throw()
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) throw()
+{
+    std::free(ptr);
+}
+
+bool countsMalloc()
+{
+    return false;
+}
+
+#endif
+
+AllocationCount allocationCount()
+{
+    AllocationCount retVal;
+#if defined(__GNUC__)
+    retVal.m_allocations = __sync_fetch_and_add(&s_allocations, 0);
+    retVal.m_bytes = __sync_fetch_and_add(&s_bytes, 0);
+#else
+    retVal.m_allocations = s_allocations;
+    retVal.m_bytes = s_bytes;
+#endif
+    return retVal;
+}
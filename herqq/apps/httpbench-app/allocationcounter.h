@@ -0,0 +1,47 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of an application named HUpnpHttpBenchApp
+ *  used for measuring the performance of the Herqq UPnP (HUPnP) library.
+ *
+ *  HUpnpHttpBenchApp is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  HUpnpHttpBenchApp is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with HUpnpHttpBenchApp. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <QtCore/QtGlobal>
+
+//
+// The number of heap allocations made by the process since it started and
+// the number of bytes requested by them
+//
+struct AllocationCount
+{
+    qint64 m_allocations;
+    qint64 m_bytes;
+};
+
+AllocationCount allocationCount();
+
+//
+// Returns true in case every malloc(), calloc() and realloc() is counted,
+// which includes the memory Qt allocates for the data of its containers and
+// strings. Otherwise only the allocations made with operator new are counted.
+//
+bool countsMalloc();
+
+#endif // ALLOCATIONCOUNTER_H
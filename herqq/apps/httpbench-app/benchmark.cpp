@@ -0,0 +1,138 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of an application named HUpnpHttpBenchApp
+ *  used for measuring the performance of the Herqq UPnP (HUPnP) library.
+ *
+ *  HUpnpHttpBenchApp is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  HUpnpHttpBenchApp is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with HUpnpHttpBenchApp. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "benchmark.h"
+#include "allocationcounter.h"
+
+#include <QtCore/QTextStream>
+#include <QtCore/QElapsedTimer>
+
+namespace
+{
+// the number of runs before the timing starts
+const qint32 WarmupRuns = 16;
+
+// the number of runs between the reads of the clock
+const qint32 BatchSize = 16;
+
+QString perOperation(qint64 total, qint64 operations, qint32 decimals)
+{
+    if (operations <= 0)
+    {
+        return QString("-");
+    }
+
+    double value = static_cast<double>(total) / operations;
+    return QString::number(value, 'f', decimals);
+}
+}
+
+/*******************************************************************************
+ * BenchmarkCase
+ ******************************************************************************/
+BenchmarkCase::BenchmarkCase(const QString& name) :
+    m_name(name)
+{
+}
+
+BenchmarkCase::~BenchmarkCase()
+{
+}
+
+/*******************************************************************************
+ * BenchmarkResult
+ ******************************************************************************/
+BenchmarkResult::BenchmarkResult(const QString& name) :
+    m_name(name), m_operations(0), m_nsecs(0), m_allocations(0),
+    m_allocatedBytes(0), m_failures(0)
+{
+}
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+BenchmarkResult measure(BenchmarkCase* benchmarkCase, qint32 msecs)
+{
+    Q_ASSERT(benchmarkCase);
+
+    BenchmarkResult retVal(benchmarkCase->name());
+
+    for(qint32 i = 0; i < WarmupRuns; ++i)
+    {
+        benchmarkCase->run();
+    }
+
+    const qint64 limit = static_cast<qint64>(qMax(1, msecs)) * 1000000;
+
+    AllocationCount before = allocationCount();
+
+    QElapsedTimer timer;
+    timer.start();
+
+    do
+    {
+        for(qint32 i = 0; i < BatchSize; ++i)
+        {
+            if (!benchmarkCase->run())
+            {
+                ++retVal.m_failures;
+            }
+        }
+
+        retVal.m_operations += BatchSize;
+        retVal.m_nsecs = timer.nsecsElapsed();
+    }
+    while(retVal.m_nsecs < limit);
+
+    AllocationCount after = allocationCount();
+
+    retVal.m_allocations = after.m_allocations - before.m_allocations;
+    retVal.m_allocatedBytes = after.m_bytes - before.m_bytes;
+
+    return retVal;
+}
+
+void printResults(QTextStream& out, const QList<BenchmarkResult>& results)
+{
+    out << QString("%1 %2 %3 %4 %5 %6\n").arg(
+        "case", -40).arg("ops/s", 10).arg("ns/op", 10).arg(
+        "allocs/op", 10).arg("bytes/op", 10).arg("failures", 9);
+
+    foreach(const BenchmarkResult& result, results)
+    {
+        qint64 opsPerSec = result.m_nsecs > 0 ?
+            (result.m_operations * 1000000000) / result.m_nsecs : 0;
+
+        qint64 ops = result.m_operations;
+
+        out << QString("%1 %2 %3 %4 %5 %6\n").arg(
+            result.m_name, -40).arg(opsPerSec, 10).arg(
+            perOperation(result.m_nsecs, ops, 0), 10).arg(
+            perOperation(result.m_allocations, ops, 1), 10).arg(
+            perOperation(result.m_allocatedBytes, ops, 0), 10).arg(
+            result.m_failures, 9);
+    }
+
+    out << "\nallocations counted: "
+        << (countsMalloc() ? "malloc, calloc and realloc" : "operator new only")
+        << "\n";
+}
@@ -0,0 +1,82 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of an application named HUpnpHttpBenchApp
+ *  used for measuring the performance of the Herqq UPnP (HUPnP) library.
+ *
+ *  HUpnpHttpBenchApp is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  HUpnpHttpBenchApp is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with HUpnpHttpBenchApp. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <QtCore/QList>
+#include <QtCore/QString>
+
+class QTextStream;
+
+//
+// A single operation that is timed by running it repeatedly
+//
+class BenchmarkCase
+{
+Q_DISABLE_COPY(BenchmarkCase)
+
+private:
+
+    const QString m_name;
+
+public:
+
+    explicit BenchmarkCase(const QString& name);
+    virtual ~BenchmarkCase();
+
+    inline const QString& name() const { return m_name; }
+
+    // runs the operation once. returns false in case the operation failed,
+    // which is counted, but does not stop the benchmark
+    virtual bool run() = 0;
+};
+
+//
+// The totals of the runs of a benchmark case
+//
+struct BenchmarkResult
+{
+    QString m_name;
+    qint64 m_operations;
+    qint64 m_nsecs;
+    qint64 m_allocations;
+    qint64 m_allocatedBytes;
+    qint64 m_failures;
+
+    explicit BenchmarkResult(const QString& name);
+};
+
+//
+// Runs the specified case for at least the specified time after a few
+// warm-up runs, which fill the caches and the memory pools the operation
+// uses, and returns the totals of the timed runs
+//
+BenchmarkResult measure(BenchmarkCase*, qint32 msecs);
+
+//
+// Prints a table of the specified results with the throughput in operations
+// per second and the heap allocations and the bytes allocated per operation
+//
+void printResults(QTextStream& out, const QList<BenchmarkResult>& results);
+
+#endif // BENCHMARK_H
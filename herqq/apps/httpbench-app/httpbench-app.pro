@@ -0,0 +1,45 @@
+TEMPLATE = app
+TARGET   = HUpnpHttpBenchApp
+QT      += network xml
+QT      -= gui
+CONFIG  += warn_on console
+
+INCLUDEPATH += ../../hupnp/include
+
+LIBS += -L"../../hupnp/bin" -lHUpnp
+
+win32 {
+    LIBS += -lws2_32
+    QMAKE_POST_LINK += copy ..\\..\\hupnp\\bin\\* bin /Y
+}
+else {
+    !macx:QMAKE_LFLAGS += -Wl,--rpath=\\\$\$ORIGIN
+
+    QMAKE_POST_LINK += cp -Rf ../../hupnp/bin/* bin
+}
+
+macx {
+  CONFIG -= app_bundle
+}
+
+OBJECTS_DIR = obj
+MOC_DIR = obj
+
+DESTDIR = ./bin
+
+HEADERS += \
+    allocationcounter.h \
+    benchmark.h \
+    httpcases.h \
+    soapcases.h \
+    socketcases.h \
+    ssdpcases.h
+
+SOURCES += \
+    main.cpp \
+    allocationcounter.cpp \
+    benchmark.cpp \
+    httpcases.cpp \
+    soapcases.cpp \
+    socketcases.cpp \
+    ssdpcases.cpp
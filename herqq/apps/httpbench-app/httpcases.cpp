@@ -0,0 +1,309 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of an application named HUpnpHttpBenchApp
+ *  used for measuring the performance of the Herqq UPnP (HUPnP) library.
+ *
+ *  HUpnpHttpBenchApp is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  HUpnpHttpBenchApp is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with HUpnpHttpBenchApp. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "httpcases.h"
+#include "benchmark.h"
+
+#include <HUpnpCore/HProductTokens>
+
+#include <HUpnpCore/private/hhttp_p.h>
+#include <HUpnpCore/private/hhttp_header_p.h>
+#include <HUpnpCore/private/hevent_messages_p.h>
+#include <HUpnpCore/private/hhttp_messaginginfo_p.h>
+#include <HUpnpCore/private/hhttp_messagecreator_p.h>
+
+#include <QtCore/QUrl>
+#include <QtCore/QUuid>
+#include <QtNetwork/QTcpSocket>
+
+using namespace Herqq::Upnp;
+
+namespace
+{
+const char NotifyBody[] =
+    "<?xml version=\"1.0\" encoding=\"utf-8\"?>\r\n"
+    "<e:propertyset xmlns:e=\"urn:schemas-upnp-org:event-1-0\">"
+    "<e:property><SystemUpdateID>1234</SystemUpdateID></e:property>"
+    "<e:property><ContainerUpdateIDs>12,5,64,7</ContainerUpdateIDs>"
+    "</e:property>"
+    "<e:property><TransferIDs></TransferIDs></e:property>"
+    "</e:propertyset>";
+
+const char NotifyHeader[] =
+    "NOTIFY /8d1c5a0e-1b4f-4a8e-9c41-0b7d7e3f5a21/event HTTP/1.1\r\n"
+    "HOST: 192.168.1.20:40000\r\n"
+    "CONTENT-TYPE: text/xml; charset=\"utf-8\"\r\n"
+    "CONTENT-LENGTH: 301\r\n"
+    "NT: upnp:event\r\n"
+    "NTS: upnp:propchange\r\n"
+    "SID: uuid:6b8c1b52-5c69-4f8c-9a2b-3f0c9d1e2a47\r\n"
+    "SEQ: 12\r\n"
+    "\r\n";
+
+const char SubscribeHeader[] =
+    "SUBSCRIBE /upnp/event/ContentDirectory HTTP/1.1\r\n"
+    "HOST: 192.168.1.10:49152\r\n"
+    "USER-AGENT: Linux/2.6 UPnP/1.1 HUPnP/1.0\r\n"
+    "CALLBACK: <http://192.168.1.20:40000/8d1c5a0e/event>\r\n"
+    "NT: upnp:event\r\n"
+    "TIMEOUT: Second-1800\r\n"
+    "\r\n";
+
+const char ControlResponseHeader[] =
+    "HTTP/1.1 200 OK\r\n"
+    "CONTENT-LENGTH: 2048\r\n"
+    "CONTENT-TYPE: text/xml; charset=\"utf-8\"\r\n"
+    "DATE: Mon, 01 Aug 2011 10:00:00 GMT\r\n"
+    "EXT:\r\n"
+    "SERVER: Linux/2.6 UPnP/1.1 HUPnP/1.0\r\n"
+    "CONNECTION: keep-alive\r\n"
+    "\r\n";
+
+const char ControlBody[] =
+    "<?xml version=\"1.0\" encoding=\"utf-8\"?>\r\n"
+    "<s:Envelope xmlns:s=\"http://schemas.xmlsoap.org/soap/envelope/\" "
+    "s:encodingStyle=\"http://schemas.xmlsoap.org/soap/encoding/\">"
+    "<s:Body><u:Play xmlns:u=\"urn:schemas-upnp-org:service:AVTransport:1\">"
+    "<InstanceID>0</InstanceID><Speed>1</Speed></u:Play></s:Body>"
+    "</s:Envelope>";
+
+//
+// Parses a header from raw text
+//
+template<typename Header>
+class ParseHeaderCase :
+    public BenchmarkCase
+{
+private:
+
+    const QByteArray m_data;
+
+public:
+
+    ParseHeaderCase(const QString& name, const char* data) :
+        BenchmarkCase(name), m_data(data)
+    {
+    }
+
+    virtual bool run()
+    {
+        Header hdr(m_data);
+        return hdr.isValid();
+    }
+};
+
+//
+// The base of the cases that need an HMessagingInfo. The socket is never
+// connected, the message creator only reads the settings of the object.
+//
+class MessagingCase :
+    public BenchmarkCase
+{
+protected:
+
+    QTcpSocket m_socket;
+    HMessagingInfo m_mi;
+
+public:
+
+    explicit MessagingCase(const QString& name) :
+        BenchmarkCase(name), m_socket(), m_mi(m_socket, true)
+    {
+        m_mi.setHostInfo(QUrl("http://192.168.1.10:49152"));
+    }
+};
+
+class CreateSubscribeCase :
+    public MessagingCase
+{
+private:
+
+    const HSubscribeRequest m_request;
+
+public:
+
+    CreateSubscribeCase() :
+        MessagingCase("create SUBSCRIBE"),
+        m_request(
+            QUrl("http://192.168.1.10:49152/upnp/event/ContentDirectory"),
+            HProductTokens("Linux/2.6 UPnP/1.1 HUPnP/1.0"),
+            QUrl("http://192.168.1.20:40000/8d1c5a0e/event"),
+            HTimeout(1800))
+    {
+    }
+
+    virtual bool run()
+    {
+        return !HHttpMessageCreator::create(m_request, m_mi).isEmpty();
+    }
+};
+
+class CreateNotifyCase :
+    public MessagingCase
+{
+private:
+
+    const HNotifyRequest m_request;
+
+public:
+
+    CreateNotifyCase() :
+        MessagingCase("create NOTIFY"),
+        m_request(
+            QUrl("http://192.168.1.20:40000/8d1c5a0e/event"),
+            HSid(QUuid::createUuid()), 12, QByteArray(NotifyBody))
+    {
+    }
+
+    virtual bool run()
+    {
+        return !HHttpMessageCreator::create(m_request, &m_mi).isEmpty();
+    }
+};
+
+class CreateControlRequestCase :
+    public MessagingCase
+{
+private:
+
+    HHttpRequestHeader m_header;
+    const QByteArray m_body;
+
+public:
+
+    CreateControlRequestCase() :
+        MessagingCase("create control request"),
+        m_header("POST", "/upnp/control/AVTransport"),
+        m_body(ControlBody)
+    {
+        m_header.setValue(
+            HHttpHeader::Field_SoapAction,
+            "\"urn:schemas-upnp-org:service:AVTransport:1#Play\"");
+    }
+
+    virtual bool run()
+    {
+        // the header is modified by the creator, as it is when a request
+        // is sent
+        HHttpRequestHeader hdr(m_header);
+        return !HHttpMessageCreator::setupData(
+            hdr, m_body, m_mi, ContentType_TextXml).isEmpty();
+    }
+};
+
+class CreateControlResponseCase :
+    public MessagingCase
+{
+private:
+
+    const QByteArray m_body;
+
+public:
+
+    CreateControlResponseCase() :
+        MessagingCase("create control response"), m_body(ControlBody)
+    {
+    }
+
+    virtual bool run()
+    {
+        return !HHttpMessageCreator::createResponse(
+            Ok, m_mi, m_body, ContentType_TextXml).isEmpty();
+    }
+};
+
+//
+// Parses a SUBSCRIBE request from raw text and interprets it, as the
+// device host does when a request arrives
+//
+class ParseSubscribeCase :
+    public BenchmarkCase
+{
+private:
+
+    const QByteArray m_data;
+
+public:
+
+    ParseSubscribeCase() :
+        BenchmarkCase("parse SUBSCRIBE"), m_data(SubscribeHeader)
+    {
+    }
+
+    virtual bool run()
+    {
+        HHttpRequestHeader hdr(m_data);
+        HSubscribeRequest req;
+        return HHttpMessageCreator::create(hdr, req) ==
+            HSubscribeRequest::Success;
+    }
+};
+
+//
+// Parses a NOTIFY request from raw text and interprets it including the
+// property set in its body, as the control point does when an event arrives
+//
+class ParseNotifyCase :
+    public BenchmarkCase
+{
+private:
+
+    const QByteArray m_header;
+    const QByteArray m_body;
+
+public:
+
+    ParseNotifyCase() :
+        BenchmarkCase("parse NOTIFY"),
+        m_header(NotifyHeader), m_body(NotifyBody)
+    {
+    }
+
+    virtual bool run()
+    {
+        HHttpRequestHeader hdr(m_header);
+        HNotifyRequest req;
+        return HHttpMessageCreator::create(hdr, m_body, req) ==
+            HNotifyRequest::Success;
+    }
+};
+}
+
+void createHttpCases(QList<BenchmarkCase*>* cases)
+{
+    Q_ASSERT(cases);
+
+    cases->append(new ParseHeaderCase<HHttpRequestHeader>(
+        "request header, NOTIFY", NotifyHeader));
+    cases->append(new ParseHeaderCase<HHttpRequestHeader>(
+        "request header, SUBSCRIBE", SubscribeHeader));
+    cases->append(new ParseHeaderCase<HHttpResponseHeader>(
+        "response header, control", ControlResponseHeader));
+
+    cases->append(new CreateSubscribeCase());
+    cases->append(new CreateNotifyCase());
+    cases->append(new CreateControlRequestCase());
+    cases->append(new CreateControlResponseCase());
+
+    cases->append(new ParseSubscribeCase());
+    cases->append(new ParseNotifyCase());
+}
@@ -0,0 +1,37 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of an application named HUpnpHttpBenchApp
+ *  used for measuring the performance of the Herqq UPnP (HUPnP) library.
+ *
+ *  HUpnpHttpBenchApp is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  HUpnpHttpBenchApp is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with HUpnpHttpBenchApp. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HTTPCASES_H
+#define HTTPCASES_H
+
+#include <QtCore/QList>
+
+class BenchmarkCase;
+
+//
+// Appends the cases that parse HTTP headers from raw text and that create
+// and interpret the GENA (SUBSCRIBE, NOTIFY) and control messages with
+// HHttpMessageCreator. None of these touch a socket.
+//
+void createHttpCases(QList<BenchmarkCase*>* cases);
+
+#endif // HTTPCASES_H
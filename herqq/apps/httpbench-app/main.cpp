@@ -0,0 +1,166 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of an application named HUpnpHttpBenchApp
+ *  used for measuring the performance of the Herqq UPnP (HUPnP) library.
+ *
+ *  HUpnpHttpBenchApp is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  HUpnpHttpBenchApp is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with HUpnpHttpBenchApp. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "benchmark.h"
+#include "httpcases.h"
+#include "soapcases.h"
+#include "socketcases.h"
+#include "ssdpcases.h"
+
+#include <HUpnpCore/HUpnp>
+
+#include <QtCore/QStringList>
+#include <QtCore/QTextStream>
+#include <QtCore/QCoreApplication>
+
+using namespace Herqq::Upnp;
+
+namespace
+{
+const char ReadHeader[] =
+    "NOTIFY /8d1c5a0e-1b4f-4a8e-9c41-0b7d7e3f5a21/event HTTP/1.1\r\n"
+    "HOST: 127.0.0.1:40000\r\n"
+    "CONTENT-TYPE: text/xml; charset=\"utf-8\"\r\n"
+    "CONTENT-LENGTH: 0\r\n"
+    "NT: upnp:event\r\n"
+    "NTS: upnp:propchange\r\n"
+    "SID: uuid:6b8c1b52-5c69-4f8c-9a2b-3f0c9d1e2a47\r\n"
+    "SEQ: 12\r\n"
+    "\r\n";
+
+void printUsage(QTextStream& out)
+{
+    out << "Usage: HUpnpHttpBenchApp [options]\n\n"
+        << "Times the parsing and the creation of the HTTP and SSDP messages, "
+           "the\nchunked transfer coding and the SOAP envelopes of HUPnP and "
+           "reports the\noperations per second and the heap allocations "
+           "per operation.\n\n"
+        << "  --time=MS         the time each case runs in milliseconds "
+           "(500)\n"
+        << "  --filter=TEXT     runs only the cases the names of which "
+           "contain the text\n"
+        << "  --body=KB         the size of the chunked messages in "
+           "kilobytes (64)\n"
+        << "  --chunk=B         the size of the chunks in bytes (4096)\n";
+}
+
+qint32 intOption(const QString& arg, const QString& name, qint32 def)
+{
+    QString prefix = QString("--%1=").arg(name);
+    if (!arg.startsWith(prefix))
+    {
+        return def;
+    }
+
+    bool ok = false;
+    qint32 value = arg.mid(prefix.size()).toInt(&ok);
+    return ok ? value : def;
+}
+
+QByteArray chunkedBody(qint32 size)
+{
+    static const char line[] =
+        "<item id=\"1000\"><dc:title>Track 1000</dc:title></item>\r\n";
+
+    QByteArray retVal;
+    retVal.reserve(size);
+    while(retVal.size() < size)
+    {
+        qint32 length = sizeof(line) - 1;
+        retVal.append(line, qMin(length, size - retVal.size()));
+    }
+    return retVal;
+}
+}
+
+int main(int argc, char* argv[])
+{
+    SetLoggingLevel(Warning);
+
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    qint32 msecs = 500, bodySize = 64, chunkSize = 4096;
+    QString filter;
+
+    QStringList args = app.arguments();
+    for(qint32 i = 1; i < args.size(); ++i)
+    {
+        const QString& arg = args.at(i);
+        if (arg.startsWith("--time=") ||
+            arg.startsWith("--body=") ||
+            arg.startsWith("--chunk="))
+        {
+            msecs = intOption(arg, "time", msecs);
+            bodySize = intOption(arg, "body", bodySize);
+            chunkSize = intOption(arg, "chunk", chunkSize);
+        }
+        else if (arg.startsWith("--filter="))
+        {
+            filter = arg.mid(9);
+        }
+        else
+        {
+            printUsage(out);
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    QList<BenchmarkCase*> cases;
+    createHttpCases(&cases);
+    createSoapCases(&cases);
+    createSsdpCases(&cases);
+
+    // each socket case has a connection of its own, since the send case
+    // discards everything arriving on its connection
+    LoopbackConnection readConnection, sendConnection, receiveConnection;
+    if (readConnection.connect() && sendConnection.connect() &&
+        receiveConnection.connect())
+    {
+        QByteArray body = chunkedBody(qMax(1, bodySize) * 1024);
+        chunkSize = qMax(1, chunkSize);
+
+        cases.append(new ReadHeaderCase(&readConnection, ReadHeader));
+        cases.append(new ChunkedSendCase(&sendConnection, body, chunkSize));
+        cases.append(
+            new ChunkedReceiveCase(&receiveConnection, body, chunkSize));
+    }
+    else
+    {
+        out << "Failed to connect over the loopback interface, "
+               "the socket cases are skipped.\n\n";
+    }
+
+    QList<BenchmarkResult> results;
+    foreach(BenchmarkCase* benchmarkCase, cases)
+    {
+        if (filter.isEmpty() || benchmarkCase->name().contains(filter))
+        {
+            results.append(measure(benchmarkCase, msecs));
+        }
+    }
+
+    printResults(out, results);
+
+    qDeleteAll(cases);
+    return 0;
+}
@@ -0,0 +1,250 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of an application named HUpnpHttpBenchApp
+ *  used for measuring the performance of the Herqq UPnP (HUPnP) library.
+ *
+ *  HUpnpHttpBenchApp is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  HUpnpHttpBenchApp is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with HUpnpHttpBenchApp. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "soapcases.h"
+#include "benchmark.h"
+
+#include <HUpnpCore/HActionArguments>
+#include <HUpnpCore/HStateVariableInfo>
+
+#include <HUpnpCore/private/hsoap_p.h>
+
+#include <QtCore/QString>
+
+using namespace Herqq::Upnp;
+
+namespace
+{
+const char AvTransport[] = "urn:schemas-upnp-org:service:AVTransport:1";
+const char ContentDirectory[] =
+    "urn:schemas-upnp-org:service:ContentDirectory:1";
+
+struct ArgumentDef
+{
+    const char* m_name;
+    HUpnpDataTypes::DataType m_type;
+    const char* m_value;
+};
+
+const ArgumentDef PlayArgs[] =
+{
+    { "InstanceID", HUpnpDataTypes::ui4, "0" },
+    { "Speed", HUpnpDataTypes::string, "1" },
+    { 0, HUpnpDataTypes::Undefined, 0 }
+};
+
+const ArgumentDef BrowseArgs[] =
+{
+    { "ObjectID", HUpnpDataTypes::string, "64" },
+    { "BrowseFlag", HUpnpDataTypes::string, "BrowseDirectChildren" },
+    { "Filter", HUpnpDataTypes::string, "dc:title,res,upnp:albumArtURI" },
+    { "StartingIndex", HUpnpDataTypes::ui4, "0" },
+    { "RequestedCount", HUpnpDataTypes::ui4, "50" },
+    { "SortCriteria", HUpnpDataTypes::string, "+dc:title" },
+    { 0, HUpnpDataTypes::Undefined, 0 }
+};
+
+// a track in the form it is written inside DIDL-Lite
+const char TrackDidl[] =
+    "<item id=\"%1\" parentID=\"64\" restricted=\"1\">"
+    "<dc:title>Track %1</dc:title>"
+    "<upnp:class>object.item.audioItem.musicTrack</upnp:class>"
+    "<upnp:artist>Some Artist</upnp:artist>"
+    "<upnp:album>Some Album</upnp:album>"
+    "<res protocolInfo=\"http-get:*:audio/mpeg:DLNA.ORG_PN=MP3\" "
+    "duration=\"0:03:45.000\" size=\"5400000\">"
+    "http://192.168.1.10:49152/media/%1.mp3</res>"
+    "</item>";
+
+QString didlLite(qint32 items)
+{
+    QString retVal(
+        "<DIDL-Lite xmlns=\"urn:schemas-upnp-org:metadata-1-0/DIDL-Lite/\" "
+        "xmlns:dc=\"http://purl.org/dc/elements/1.1/\" "
+        "xmlns:upnp=\"urn:schemas-upnp-org:metadata-1-0/upnp/\">");
+
+    for(qint32 i = 0; i < items; ++i)
+    {
+        retVal.append(QString(TrackDidl).arg(1000 + i));
+    }
+
+    return retVal.append("</DIDL-Lite>");
+}
+
+void addArgument(
+    HActionArguments* args, const QString& name,
+    HUpnpDataTypes::DataType type, const QVariant& value)
+{
+    HActionArgument arg(name, HStateVariableInfo(QString("A_ARG_%1").arg(
+        name), type));
+
+    bool ok = arg.setValue(value);
+    Q_ASSERT(ok); Q_UNUSED(ok)
+
+    args->append(arg);
+}
+
+HActionArguments createArguments(const ArgumentDef defs[])
+{
+    HActionArguments retVal;
+    for(qint32 i = 0; defs[i].m_name; ++i)
+    {
+        QString value(defs[i].m_value);
+        addArgument(
+            &retVal, defs[i].m_name, defs[i].m_type,
+            defs[i].m_type == HUpnpDataTypes::ui4 ?
+                QVariant(value.toUInt()) : QVariant(value));
+    }
+    return retVal;
+}
+
+HActionArguments setUriArguments()
+{
+    HActionArguments retVal;
+    addArgument(&retVal, "InstanceID", HUpnpDataTypes::ui4, 0u);
+    addArgument(
+        &retVal, "CurrentURI", HUpnpDataTypes::string,
+        "http://192.168.1.10:49152/media/1000.mp3");
+    addArgument(
+        &retVal, "CurrentURIMetaData", HUpnpDataTypes::string, didlLite(1));
+
+    return retVal;
+}
+
+HActionArguments browseResponseArguments(qint32 items)
+{
+    HActionArguments retVal;
+    addArgument(&retVal, "Result", HUpnpDataTypes::string, didlLite(items));
+    addArgument(
+        &retVal, "NumberReturned", HUpnpDataTypes::ui4,
+        static_cast<quint32>(items));
+    addArgument(&retVal, "TotalMatches", HUpnpDataTypes::ui4, 1200u);
+    addArgument(&retVal, "UpdateID", HUpnpDataTypes::ui4, 17u);
+    return retVal;
+}
+
+//
+// Writes the envelope of an action request or a response
+//
+class EncodeCase :
+    public BenchmarkCase
+{
+private:
+
+    const QString m_methodName;
+    const QString m_methodNamespace;
+    const HActionArguments m_args;
+
+public:
+
+    EncodeCase(
+        const QString& name, const QString& methodName,
+        const char* methodNamespace, const HActionArguments& args) :
+            BenchmarkCase(name),
+            m_methodName(methodName), m_methodNamespace(methodNamespace),
+            m_args(args)
+    {
+    }
+
+    virtual bool run()
+    {
+        return !HSoapMessage::createMethod(
+            m_methodName, m_methodNamespace, m_args).isEmpty();
+    }
+};
+
+//
+// Reads an envelope written by HSoapMessage
+//
+class DecodeCase :
+    public BenchmarkCase
+{
+private:
+
+    const QByteArray m_data;
+
+public:
+
+    DecodeCase(const QString& name, const QByteArray& data) :
+        BenchmarkCase(name), m_data(data)
+    {
+    }
+
+    virtual bool run()
+    {
+        HSoapMessage msg;
+        return msg.parse(m_data) && msg.type() != HSoapMessage::Undefined;
+    }
+};
+
+class EncodeFaultCase :
+    public BenchmarkCase
+{
+public:
+
+    EncodeFaultCase() :
+        BenchmarkCase("encode fault")
+    {
+    }
+
+    virtual bool run()
+    {
+        return !HSoapMessage::createFault(701, "No such object").isEmpty();
+    }
+};
+
+void addPair(
+    QList<BenchmarkCase*>* cases, const QString& name,
+    const QString& methodName, const char* methodNamespace,
+    const HActionArguments& args)
+{
+    cases->append(new EncodeCase(
+        QString("encode %1").arg(name), methodName, methodNamespace, args));
+
+    cases->append(new DecodeCase(
+        QString("decode %1").arg(name),
+        HSoapMessage::createMethod(methodName, methodNamespace, args)));
+}
+}
+
+void createSoapCases(QList<BenchmarkCase*>* cases)
+{
+    Q_ASSERT(cases);
+
+    addPair(cases, "AVT Play", "Play", AvTransport, createArguments(PlayArgs));
+
+    addPair(
+        cases, "AVT SetAVTransportURI", "SetAVTransportURI", AvTransport,
+        setUriArguments());
+
+    addPair(
+        cases, "CDS Browse", "Browse", ContentDirectory,
+        createArguments(BrowseArgs));
+
+    addPair(
+        cases, "CDS BrowseResponse, 50 items", "BrowseResponse",
+        ContentDirectory, browseResponseArguments(50));
+
+    cases->append(new EncodeFaultCase());
+    cases->append(new DecodeCase(
+        "decode fault", HSoapMessage::createFault(701, "No such object")));
+}
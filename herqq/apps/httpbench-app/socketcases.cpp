@@ -0,0 +1,260 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of an application named HUpnpHttpBenchApp
+ *  used for measuring the performance of the Herqq UPnP (HUPnP) library.
+ *
+ *  HUpnpHttpBenchApp is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  HUpnpHttpBenchApp is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with HUpnpHttpBenchApp. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "socketcases.h"
+
+#include <HUpnpCore/private/hhttp_utils_p.h>
+#include <HUpnpCore/private/hhttp_asynchandler_p.h>
+#include <HUpnpCore/private/hhttp_messaginginfo_p.h>
+
+#include <QtNetwork/QHostAddress>
+
+using namespace Herqq::Upnp;
+
+namespace
+{
+// the time a single operation may take in milliseconds
+const qint32 Timeout = 5000;
+
+const char ChunkedHeader[] =
+    "HTTP/1.1 200 OK\r\n"
+    "CONTENT-TYPE: text/xml; charset=\"utf-8\"\r\n"
+    "TRANSFER-ENCODING: chunked\r\n"
+    "SERVER: Linux/2.6 UPnP/1.1 HUPnP/1.0\r\n"
+    "\r\n";
+
+HMessagingInfo* createMessagingInfo(QTcpSocket* socket)
+{
+    HMessagingInfo* retVal =
+        new HMessagingInfo(qMakePair(socket, false), true, Timeout);
+
+    retVal->setHostInfo(QString("127.0.0.1:%1").arg(socket->peerPort()));
+    return retVal;
+}
+}
+
+/*******************************************************************************
+ * LoopbackConnection
+ ******************************************************************************/
+LoopbackConnection::LoopbackConnection() :
+    m_server(), m_client(), m_accepted(0)
+{
+}
+
+LoopbackConnection::~LoopbackConnection()
+{
+    delete m_accepted;
+}
+
+bool LoopbackConnection::connect()
+{
+    if (!m_server.listen(QHostAddress::LocalHost))
+    {
+        return false;
+    }
+
+    m_client.connectToHost(QHostAddress::LocalHost, m_server.serverPort());
+    if (!m_client.waitForConnected(Timeout) ||
+        !m_server.waitForNewConnection(Timeout))
+    {
+        return false;
+    }
+
+    m_accepted = m_server.nextPendingConnection();
+    m_server.close();
+
+    return m_accepted != 0;
+}
+
+/*******************************************************************************
+ * ReadHeaderCase
+ ******************************************************************************/
+ReadHeaderCase::ReadHeaderCase(
+    LoopbackConnection* connection, const QByteArray& header) :
+        BenchmarkCase("HHttpUtils::readHeader"),
+            m_connection(connection), m_header(header), m_target()
+{
+    Q_ASSERT(m_connection);
+}
+
+bool ReadHeaderCase::run()
+{
+    m_target.clear();
+
+    QTcpSocket* client = m_connection->client();
+    if (client->write(m_header) != m_header.size())
+    {
+        return false;
+    }
+
+    while(client->bytesToWrite() > 0)
+    {
+        if (!client->waitForBytesWritten(Timeout))
+        {
+            return false;
+        }
+    }
+
+    QTcpSocket* server = m_connection->server();
+    while(!HHttpUtils::readHeader(*server, m_target))
+    {
+        if (!server->waitForReadyRead(Timeout))
+        {
+            return false;
+        }
+    }
+
+    return m_target.size() == m_header.size();
+}
+
+/*******************************************************************************
+ * AsyncHttpCase
+ ******************************************************************************/
+AsyncHttpCase::AsyncHttpCase(
+    const QString& name, LoopbackConnection* connection) :
+        QObject(),
+        BenchmarkCase(name),
+            m_connection(connection),
+            m_handler(new HHttpAsyncHandler("__httpbench__", this)),
+            m_loop(),
+            m_operation(0),
+            m_succeeded(false)
+{
+    Q_ASSERT(m_connection);
+}
+
+AsyncHttpCase::~AsyncHttpCase()
+{
+}
+
+bool AsyncHttpCase::wait(HHttpAsyncOperation* operation)
+{
+    if (!operation)
+    {
+        return false;
+    }
+
+    m_operation = operation;
+    m_succeeded = false;
+
+    // the handler is connected to the signal first, which means that the
+    // operation has been released by the handler once operationDone() runs
+    bool ok = QObject::connect(
+        operation, SIGNAL(done(unsigned int)), this, SLOT(operationDone()));
+
+    Q_ASSERT(ok); Q_UNUSED(ok)
+
+    // the loop always quits, since the operation fails after the timeout
+    m_loop.exec();
+
+    m_operation = 0;
+    return m_succeeded;
+}
+
+void AsyncHttpCase::operationDone()
+{
+    HHttpAsyncOperation* operation = m_operation;
+    Q_ASSERT(operation);
+
+    m_succeeded =
+        operation->state() == HHttpAsyncOperation::Succeeded &&
+        check(operation);
+
+    // the operation is still emitting the signal that ended up here
+    operation->deleteLater();
+    m_loop.quit();
+}
+
+/*******************************************************************************
+ * ChunkedSendCase
+ ******************************************************************************/
+ChunkedSendCase::ChunkedSendCase(
+    LoopbackConnection* connection, const QByteArray& body,
+    qint32 chunkSize) :
+        AsyncHttpCase(
+            QString("chunked send, %1 kB in %2 B chunks").arg(
+                body.size() / 1024).arg(chunkSize), connection),
+            m_chunkSize(chunkSize),
+            m_message(QByteArray(ChunkedHeader).append(body))
+{
+    bool ok = QObject::connect(
+        m_connection->client(), SIGNAL(readyRead()), this, SLOT(discard()));
+
+    Q_ASSERT(ok); Q_UNUSED(ok)
+}
+
+void ChunkedSendCase::discard()
+{
+    QTcpSocket* client = m_connection->client();
+    client->read(client->bytesAvailable());
+}
+
+bool ChunkedSendCase::check(const HHttpAsyncOperation*)
+{
+    return true;
+}
+
+bool ChunkedSendCase::run()
+{
+    HMessagingInfo* mi = createMessagingInfo(m_connection->server());
+    mi->setChunkedInfo(HChunkedInfo(m_chunkSize));
+
+    return wait(m_handler->send(mi, m_message));
+}
+
+/*******************************************************************************
+ * ChunkedReceiveCase
+ ******************************************************************************/
+ChunkedReceiveCase::ChunkedReceiveCase(
+    LoopbackConnection* connection, const QByteArray& body,
+    qint32 chunkSize) :
+        AsyncHttpCase(
+            QString("chunked receive, %1 kB in %2 B chunks").arg(
+                body.size() / 1024).arg(chunkSize), connection),
+            m_bodySize(body.size()),
+            m_message(ChunkedHeader)
+{
+    for(qint32 i = 0; i < body.size(); i += chunkSize)
+    {
+        qint32 size = qMin(chunkSize, body.size() - i);
+        m_message.append(QByteArray::number(size, 16)).append("\r\n");
+        m_message.append(body.constData() + i, size).append("\r\n");
+    }
+    m_message.append("0\r\n\r\n");
+}
+
+bool ChunkedReceiveCase::check(const HHttpAsyncOperation* operation)
+{
+    return operation->dataRead().size() == m_bodySize;
+}
+
+bool ChunkedReceiveCase::run()
+{
+    QTcpSocket* server = m_connection->server();
+    if (server->write(m_message) != m_message.size())
+    {
+        return false;
+    }
+
+    HMessagingInfo* mi = createMessagingInfo(m_connection->client());
+    return wait(m_handler->receive(mi, false));
+}
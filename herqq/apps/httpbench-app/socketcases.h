@@ -0,0 +1,182 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of an application named HUpnpHttpBenchApp
+ *  used for measuring the performance of the Herqq UPnP (HUPnP) library.
+ *
+ *  HUpnpHttpBenchApp is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  HUpnpHttpBenchApp is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with HUpnpHttpBenchApp. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SOCKETCASES_H
+#define SOCKETCASES_H
+
+#include "benchmark.h"
+
+#include <HUpnpCore/HUpnp>
+
+#include <QtCore/QObject>
+#include <QtCore/QEventLoop>
+#include <QtCore/QByteArray>
+#include <QtNetwork/QTcpServer>
+#include <QtNetwork/QTcpSocket>
+
+namespace Herqq
+{
+namespace Upnp
+{
+class HHttpAsyncHandler;
+class HHttpAsyncOperation;
+}
+}
+
+//
+// A pair of TCP sockets connected to each other over the loopback interface
+//
+class LoopbackConnection
+{
+Q_DISABLE_COPY(LoopbackConnection)
+
+private:
+
+    QTcpServer m_server;
+    QTcpSocket m_client;
+    QTcpSocket* m_accepted;
+
+public:
+
+    LoopbackConnection();
+    ~LoopbackConnection();
+
+    // blocks until the sockets are connected, or until the attempt fails
+    bool connect();
+
+    inline QTcpSocket* client() { return &m_client; }
+    inline QTcpSocket* server() { return m_accepted; }
+};
+
+//
+// Reads an HTTP header from a socket with HHttpUtils::readHeader(). The
+// header is written to the other end of a loopback connection first, which
+// means that the time includes the system calls.
+//
+class ReadHeaderCase :
+    public BenchmarkCase
+{
+private:
+
+    LoopbackConnection* m_connection;
+    const QByteArray m_header;
+    QByteArray m_target;
+
+public:
+
+    ReadHeaderCase(LoopbackConnection*, const QByteArray& header);
+    virtual bool run();
+};
+
+//
+// The base of the cases that run an operation of HHttpAsyncHandler over a
+// loopback connection. run() spins an event loop until the operation is
+// done, which is why the time includes the event dispatching.
+//
+class AsyncHttpCase :
+    public QObject,
+    public BenchmarkCase
+{
+Q_OBJECT
+
+protected:
+
+    LoopbackConnection* m_connection;
+    Herqq::Upnp::HHttpAsyncHandler* m_handler;
+
+    // waits for the specified operation, which may be null
+    bool wait(Herqq::Upnp::HHttpAsyncOperation*);
+
+    virtual bool check(const Herqq::Upnp::HHttpAsyncOperation*) = 0;
+
+private:
+
+    QEventLoop m_loop;
+    Herqq::Upnp::HHttpAsyncOperation* m_operation;
+    bool m_succeeded;
+
+private Q_SLOTS:
+
+    void operationDone();
+
+public:
+
+    AsyncHttpCase(const QString& name, LoopbackConnection*);
+    virtual ~AsyncHttpCase();
+};
+
+//
+// Sends a response in chunks of the specified size with the chunked encoder
+// of HHttpAsyncOperation. The other end of the connection discards the data
+// as it arrives.
+//
+class ChunkedSendCase :
+    public AsyncHttpCase
+{
+Q_OBJECT
+
+private:
+
+    const qint32 m_chunkSize;
+    QByteArray m_message;
+
+protected:
+
+    virtual bool check(const Herqq::Upnp::HHttpAsyncOperation*);
+
+private Q_SLOTS:
+
+    void discard();
+
+public:
+
+    ChunkedSendCase(
+        LoopbackConnection*, const QByteArray& body, qint32 chunkSize);
+
+    virtual bool run();
+};
+
+//
+// Receives a response encoded in chunks of the specified size with the
+// chunked decoder of HHttpAsyncOperation
+//
+class ChunkedReceiveCase :
+    public AsyncHttpCase
+{
+private:
+
+    const qint32 m_bodySize;
+    QByteArray m_message;
+
+protected:
+
+    virtual bool check(const Herqq::Upnp::HHttpAsyncOperation*);
+
+public:
+
+    ChunkedReceiveCase(
+        LoopbackConnection*, const QByteArray& body, qint32 chunkSize);
+
+    virtual bool run();
+};
+
+#endif // SOCKETCASES_H
@@ -0,0 +1,251 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of an application named HUpnpHttpBenchApp
+ *  used for measuring the performance of the Herqq UPnP (HUPnP) library.
+ *
+ *  HUpnpHttpBenchApp is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  HUpnpHttpBenchApp is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with HUpnpHttpBenchApp. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ssdpcases.h"
+#include "benchmark.h"
+
+#include <HUpnpCore/HEndpoint>
+#include <HUpnpCore/HDiscoveryType>
+#include <HUpnpCore/HProductTokens>
+#include <HUpnpCore/HResourceUpdate>
+#include <HUpnpCore/HDiscoveryRequest>
+#include <HUpnpCore/HDiscoveryResponse>
+#include <HUpnpCore/HResourceAvailable>
+#include <HUpnpCore/HResourceUnavailable>
+
+#include <HUpnpCore/private/hssdp_p.h>
+#include <HUpnpCore/private/hhttp_header_p.h>
+#include <HUpnpCore/private/hssdp_messagecreator_p.h>
+
+#include <QtCore/QUrl>
+#include <QtCore/QDateTime>
+#include <QtNetwork/QHostAddress>
+
+using namespace Herqq::Upnp;
+
+namespace
+{
+const char Location[] = "http://192.168.1.10:49152/description.xml";
+const char ServerTokens[] = "Linux/2.6 UPnP/1.1 HUPnP/1.0";
+const char Usn[] =
+    "uuid:2fac1234-31f8-11b4-a222-08002b34c003::"
+    "urn:schemas-upnp-org:device:MediaServer:1";
+
+const char DeviceAvailable[] =
+    "NOTIFY * HTTP/1.1\r\n"
+    "HOST: 239.255.255.250:1900\r\n"
+    "CACHE-CONTROL: max-age=1800\r\n"
+    "LOCATION: http://192.168.1.10:49152/description.xml\r\n"
+    "NT: urn:schemas-upnp-org:device:MediaServer:1\r\n"
+    "NTS: ssdp:alive\r\n"
+    "SERVER: Linux/2.6 UPnP/1.1 HUPnP/1.0\r\n"
+    "USN: uuid:2fac1234-31f8-11b4-a222-08002b34c003::"
+    "urn:schemas-upnp-org:device:MediaServer:1\r\n"
+    "BOOTID.UPNP.ORG: 3\r\n"
+    "CONFIGID.UPNP.ORG: 1\r\n"
+    "\r\n";
+
+const char DiscoveryResponse[] =
+    "HTTP/1.1 200 OK\r\n"
+    "CACHE-CONTROL: max-age=1800\r\n"
+    "DATE: Mon, 01 Aug 2011 10:00:00 GMT\r\n"
+    "EXT:\r\n"
+    "LOCATION: http://192.168.1.10:49152/description.xml\r\n"
+    "SERVER: Linux/2.6 UPnP/1.1 HUPnP/1.0\r\n"
+    "ST: urn:schemas-upnp-org:device:MediaServer:1\r\n"
+    "USN: uuid:2fac1234-31f8-11b4-a222-08002b34c003::"
+    "urn:schemas-upnp-org:device:MediaServer:1\r\n"
+    "BOOTID.UPNP.ORG: 3\r\n"
+    "CONFIGID.UPNP.ORG: 1\r\n"
+    "\r\n";
+
+const char DiscoveryRequest[] =
+    "M-SEARCH * HTTP/1.1\r\n"
+    "HOST: 239.255.255.250:1900\r\n"
+    "MAN: \"ssdp:discover\"\r\n"
+    "MX: 3\r\n"
+    "ST: urn:schemas-upnp-org:device:MediaServer:1\r\n"
+    "USER-AGENT: Linux/2.6 UPnP/1.1 HUPnP/1.0\r\n"
+    "\r\n";
+
+//
+// The base of the cases that parse a datagram. The SSDP instance is never
+// initialized, the parsing does not use its sockets.
+//
+class ParseCase :
+    public BenchmarkCase
+{
+protected:
+
+    HSsdpPrivate m_ssdp;
+    const QByteArray m_data;
+
+public:
+
+    ParseCase(const QString& name, const char* data) :
+        BenchmarkCase(name), m_ssdp(0), m_data(data)
+    {
+    }
+};
+
+//
+// Parses an ssdp:alive announcement from raw text, as HSsdp does when a
+// multicast NOTIFY arrives
+//
+class ParseDeviceAvailableCase :
+    public ParseCase
+{
+public:
+
+    ParseDeviceAvailableCase() :
+        ParseCase("parse ssdp:alive", DeviceAvailable)
+    {
+    }
+
+    virtual bool run()
+    {
+        HHttpRequestHeader hdr(m_data);
+        HResourceAvailable msg;
+        return hdr.isValid() && m_ssdp.parseDeviceAvailable(hdr, &msg);
+    }
+};
+
+class ParseDiscoveryResponseCase :
+    public ParseCase
+{
+public:
+
+    ParseDiscoveryResponseCase() :
+        ParseCase("parse discovery response", DiscoveryResponse)
+    {
+    }
+
+    virtual bool run()
+    {
+        HHttpResponseHeader hdr(m_data);
+        HDiscoveryResponse msg;
+        return hdr.isValid() && m_ssdp.parseDiscoveryResponse(hdr, &msg);
+    }
+};
+
+class ParseDiscoveryRequestCase :
+    public ParseCase
+{
+public:
+
+    ParseDiscoveryRequestCase() :
+        ParseCase("parse M-SEARCH", DiscoveryRequest)
+    {
+    }
+
+    virtual bool run()
+    {
+        HHttpRequestHeader hdr(m_data);
+        HDiscoveryRequest msg;
+        return hdr.isValid() &&
+               m_ssdp.parseDiscoveryRequest(hdr, false, &msg);
+    }
+};
+
+//
+// Serializes a message of the specified type with HSsdpMessageCreator
+//
+template<typename Message>
+class CreateCase :
+    public BenchmarkCase
+{
+private:
+
+    const Message m_msg;
+
+public:
+
+    CreateCase(const QString& name, const Message& msg) :
+        BenchmarkCase(name), m_msg(msg)
+    {
+    }
+
+    virtual bool run()
+    {
+        return !HSsdpMessageCreator::create(m_msg).isEmpty();
+    }
+};
+
+class CreateUnicastSearchCase :
+    public BenchmarkCase
+{
+private:
+
+    const HDiscoveryRequest m_msg;
+    const HEndpoint m_destination;
+
+public:
+
+    explicit CreateUnicastSearchCase(const HDiscoveryRequest& msg) :
+        BenchmarkCase("create unicast M-SEARCH"),
+        m_msg(msg), m_destination(QHostAddress("192.168.1.10"), 1900)
+    {
+    }
+
+    virtual bool run()
+    {
+        return !HSsdpMessageCreator::create(m_msg, m_destination).isEmpty();
+    }
+};
+}
+
+void createSsdpCases(QList<BenchmarkCase*>* cases)
+{
+    Q_ASSERT(cases);
+
+    cases->append(new ParseDeviceAvailableCase());
+    cases->append(new ParseDiscoveryResponseCase());
+    cases->append(new ParseDiscoveryRequestCase());
+
+    HDiscoveryType usn(Usn, LooseChecks);
+    HProductTokens tokens(ServerTokens);
+
+    cases->append(new CreateCase<HResourceAvailable>(
+        "create ssdp:alive",
+        HResourceAvailable(1800, QUrl(Location), tokens, usn, 3, 1)));
+
+    cases->append(new CreateCase<HResourceUnavailable>(
+        "create ssdp:byebye", HResourceUnavailable(usn, 3, 1)));
+
+    cases->append(new CreateCase<HResourceUpdate>(
+        "create ssdp:update",
+        HResourceUpdate(QUrl(Location), usn, 3, 1, 4)));
+
+    HDiscoveryRequest search(
+        3, HDiscoveryType(
+            "urn:schemas-upnp-org:device:MediaServer:1", LooseChecks),
+        tokens);
+
+    cases->append(new CreateCase<HDiscoveryRequest>("create M-SEARCH", search));
+    cases->append(new CreateUnicastSearchCase(search));
+
+    cases->append(new CreateCase<HDiscoveryResponse>(
+        "create discovery response",
+        HDiscoveryResponse(
+            1800, QDateTime::currentDateTime(), QUrl(Location), tokens, usn,
+            3, 1)));
+}
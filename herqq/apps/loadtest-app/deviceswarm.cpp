@@ -0,0 +1,375 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of an application named HUpnpLoadTestApp
+ *  used for measuring the performance of the Herqq UPnP (HUPnP) library.
+ *
+ *  HUpnpLoadTestApp is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  HUpnpLoadTestApp is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with HUpnpLoadTestApp. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "deviceswarm.h"
+#include "httpmessage.h"
+#include "memoryusage.h"
+
+#include <HUpnpCore/HSsdp>
+#include <HUpnpCore/HControlPoint>
+
+#include <QtCore/QFile>
+#include <QtCore/QVariant>
+#include <QtCore/QTextStream>
+#include <QtNetwork/QUdpSocket>
+#include <QtNetwork/QTcpSocket>
+#include <QtNetwork/QTcpServer>
+
+using namespace Herqq::Upnp;
+
+namespace
+{
+const char TemplateUdn[] = "uuid:5d794fc2-5c5e-4460-a023-f04a51363300";
+const qint32 SendIntervalMsecs = 10;
+
+QByteArray readFile(const QString& path)
+{
+    QFile file(path);
+    return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+}
+
+QByteArray httpResponse(const char* status, const QByteArray& body)
+{
+    QByteArray retVal("HTTP/1.1 ");
+    retVal.append(status).append("\r\n");
+    if (!body.isEmpty())
+    {
+        retVal.append("CONTENT-TYPE: text/xml; charset=\"utf-8\"\r\n");
+    }
+
+    return retVal.append("CONTENT-LENGTH: ").
+        append(QByteArray::number(body.size())).append("\r\n\r\n").
+        append(body);
+}
+}
+
+/*******************************************************************************
+ * DeviceSwarm
+ *******************************************************************************/
+DeviceSwarm::DeviceSwarm(
+    qint32 deviceCount, const QHostAddress& address,
+    const QString& descriptionDir) :
+        QObject(),
+            m_deviceCount(qMax(1, deviceCount)), m_address(address),
+            m_deviceDescription(
+                readFile(descriptionDir + "/hupnp_testdevice.xml")),
+            m_serviceDescription(
+                readFile(descriptionDir + "/hupnp_testservice_scpd.xml")),
+            m_ssdp(0), m_http(0), m_pending(), m_sendTimer(),
+            m_responsesPerTick(1), m_responsesSent(0), m_descriptionsServed(0)
+{
+    m_sendTimer.setInterval(SendIntervalMsecs);
+
+    bool ok = connect(
+        &m_sendTimer, SIGNAL(timeout()), this, SLOT(sendResponses()));
+    Q_ASSERT(ok); Q_UNUSED(ok)
+}
+
+DeviceSwarm::~DeviceSwarm()
+{
+}
+
+bool DeviceSwarm::start()
+{
+    if (m_deviceDescription.isEmpty() || m_serviceDescription.isEmpty())
+    {
+        return false;
+    }
+
+    m_http = new QTcpServer(this);
+    if (!m_http->listen(m_address))
+    {
+        return false;
+    }
+
+    bool ok = connect(
+        m_http, SIGNAL(newConnection()), this, SLOT(httpConnection()));
+    Q_ASSERT(ok); Q_UNUSED(ok)
+
+    m_ssdp = new QUdpSocket(this);
+
+#if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
+    QHostAddress any = QHostAddress::Any;
+#else
+    QHostAddress any = QHostAddress::AnyIPv4;
+#endif
+
+    QUdpSocket::BindMode mode =
+        QUdpSocket::ShareAddress | QUdpSocket::ReuseAddressHint;
+
+    if (!m_ssdp->bind(any, 1900, mode) ||
+        !m_ssdp->joinMulticastGroup(QHostAddress("239.255.255.250")))
+    {
+        return false;
+    }
+
+    ok = connect(m_ssdp, SIGNAL(readyRead()), this, SLOT(discoveryReceived()));
+    Q_ASSERT(ok);
+
+    return true;
+}
+
+void DeviceSwarm::stop()
+{
+    m_sendTimer.stop();
+
+    delete m_ssdp;
+    m_ssdp = 0;
+
+    delete m_http;
+    m_http = 0;
+}
+
+QByteArray DeviceSwarm::udn(qint32 device) const
+{
+    return QByteArray(TemplateUdn).left(sizeof(TemplateUdn) - 13).append(
+        QByteArray::number(device).rightJustified(12, '0'));
+}
+
+QByteArray DeviceSwarm::response(
+    qint32 device, const QByteArray& location) const
+{
+    QByteArray retVal(
+        "HTTP/1.1 200 OK\r\n"
+        "CACHE-CONTROL: max-age=1800\r\n"
+        "EXT:\r\n"
+        "LOCATION: ");
+
+    return retVal.append(location).append("\r\n").
+        append("SERVER: Linux/1.0 UPnP/1.1 HUpnpLoadTestApp/1.0\r\n").
+        append("ST: upnp:rootdevice\r\n").
+        append("USN: ").append(udn(device)).append("::upnp:rootdevice\r\n").
+        append("BOOTID.UPNP.ORG: 1\r\nCONFIGID.UPNP.ORG: 0\r\n\r\n");
+}
+
+void DeviceSwarm::discoveryReceived()
+{
+    while(m_ssdp->hasPendingDatagrams())
+    {
+        QByteArray datagram;
+        datagram.resize(m_ssdp->pendingDatagramSize());
+
+        QHostAddress source;
+        quint16 port = 0;
+        m_ssdp->readDatagram(datagram.data(), datagram.size(), &source, &port);
+
+        QByteArray st = fieldValue(datagram, "st");
+        if (!datagram.startsWith("M-SEARCH") ||
+            (st != "upnp:rootdevice" && st != "ssdp:all"))
+        {
+            continue;
+        }
+
+        for(qint32 i = 0; i < m_deviceCount; ++i)
+        {
+            m_pending.append(qMakePair(i, qMakePair(source, port)));
+        }
+
+        // the responses are spread over the MX seconds the requestor waits
+        qint32 mx = qBound(1, fieldValue(datagram, "mx").toInt(), 5);
+        qint32 ticks = mx * 1000 / SendIntervalMsecs;
+        m_responsesPerTick = qMax(1, (m_pending.size() + ticks - 1) / ticks);
+
+        if (!m_sendTimer.isActive())
+        {
+            m_sendTimer.start();
+        }
+    }
+}
+
+void DeviceSwarm::sendResponses()
+{
+    QByteArray locationBase = QByteArray("http://").
+        append(m_address.toString().toUtf8()).append(':').
+        append(QByteArray::number(m_http->serverPort())).append('/');
+
+    for(qint32 i = 0; i < m_responsesPerTick && !m_pending.isEmpty(); ++i)
+    {
+        QPair<qint32, QPair<QHostAddress, quint16> > pending =
+            m_pending.takeFirst();
+
+        QByteArray location = locationBase;
+        location.append(QByteArray::number(pending.first)).
+            append("/description.xml");
+
+        if (m_ssdp->writeDatagram(
+                response(pending.first, location),
+                pending.second.first, pending.second.second) > 0)
+        {
+            ++m_responsesSent;
+        }
+    }
+
+    if (m_pending.isEmpty())
+    {
+        m_sendTimer.stop();
+    }
+}
+
+void DeviceSwarm::httpConnection()
+{
+    while(m_http->hasPendingConnections())
+    {
+        QTcpSocket* socket = m_http->nextPendingConnection();
+
+        bool ok = connect(
+            socket, SIGNAL(readyRead()), this, SLOT(httpReadyRead()));
+        Q_ASSERT(ok); Q_UNUSED(ok)
+
+        ok = connect(
+            socket, SIGNAL(disconnected()), socket, SLOT(deleteLater()));
+        Q_ASSERT(ok);
+    }
+}
+
+void DeviceSwarm::httpReadyRead()
+{
+    QTcpSocket* socket = qobject_cast<QTcpSocket*>(sender());
+    Q_ASSERT(socket);
+
+    QByteArray buffer = socket->property("buffer").toByteArray();
+    buffer.append(socket->readAll());
+
+    QByteArray header;
+    while(takeMessage(&buffer, &header))
+    {
+        // GET /<device>/description.xml or /<device>/<scpd> HTTP/1.1
+        QList<QByteArray> requestLine = header.left(header.indexOf("\r\n")).
+            split(' ');
+
+        QByteArray path = requestLine.size() > 1 ? requestLine.at(1) : "";
+        QList<QByteArray> parts = path.split('/');
+
+        bool ok = false;
+        qint32 device = parts.size() == 3 ? parts.at(1).toInt(&ok) : -1;
+
+        if (!ok || device < 0 || device >= m_deviceCount)
+        {
+            socket->write(httpResponse("404 Not Found", QByteArray()));
+        }
+        else if (parts.at(2) == "description.xml")
+        {
+            ++m_descriptionsServed;
+
+            QByteArray description = m_deviceDescription;
+            description.replace(TemplateUdn, udn(device));
+            socket->write(httpResponse("200 OK", description));
+        }
+        else if (parts.at(2) == "hupnp_testservice_scpd.xml")
+        {
+            ++m_descriptionsServed;
+            socket->write(httpResponse("200 OK", m_serviceDescription));
+        }
+        else
+        {
+            socket->write(httpResponse("404 Not Found", QByteArray()));
+        }
+    }
+
+    socket->setProperty("buffer", buffer);
+}
+
+/*******************************************************************************
+ * DiscoveryMonitor
+ *******************************************************************************/
+DiscoveryMonitor::DiscoveryMonitor(
+    HControlPoint* controlPoint, qint32 deviceCount) :
+        QObject(),
+            m_controlPoint(controlPoint), m_deviceCount(deviceCount),
+            m_clock(), m_sampleTimer(), m_allOnlineMsecs(-1), m_online(0),
+            m_maxPendingBuilds(0)
+{
+    m_sampleTimer.setInterval(SendIntervalMsecs);
+
+    bool ok = connect(
+        &m_sampleTimer, SIGNAL(timeout()), this, SLOT(sample()));
+    Q_ASSERT(ok); Q_UNUSED(ok)
+
+    ok = connect(
+        m_controlPoint, SIGNAL(rootDeviceOnline(Herqq::Upnp::HClientDevice*)),
+        this, SLOT(rootDeviceOnline(Herqq::Upnp::HClientDevice*)));
+    Q_ASSERT(ok);
+}
+
+void DiscoveryMonitor::start()
+{
+    m_clock.start();
+    m_sampleTimer.start();
+}
+
+void DiscoveryMonitor::rootDeviceOnline(HClientDevice*)
+{
+    if (++m_online == m_deviceCount)
+    {
+        m_allOnlineMsecs = m_clock.elapsed();
+        m_sampleTimer.stop();
+        emit allOnline();
+    }
+}
+
+void DiscoveryMonitor::sample()
+{
+    m_maxPendingBuilds = qMax(
+        m_maxPendingBuilds,
+        m_controlPoint->runtimeStatus()->pendingDeviceBuilds());
+}
+
+void DiscoveryMonitor::report(QTextStream& out, const DeviceSwarm& swarm) const
+{
+    const HControlPointRuntimeStatus* status = m_controlPoint->runtimeStatus();
+
+    out << "devices online: " << m_online << " of " << m_deviceCount << "\n";
+    if (m_allOnlineMsecs >= 0)
+    {
+        out << "time until all online: " << m_allOnlineMsecs << " ms\n";
+    }
+
+    qint64 received = status->ssdpMessagesReceived(HSsdp::DiscoveryResponse);
+    qint64 sent = swarm.responsesSent();
+
+    out << "discovery responses: " << sent << " sent, " << received
+        << " received";
+    if (sent > 0)
+    {
+        out << " (" << QString::number(
+            qMax<qint64>(0, sent - received) * 100.0 / sent, 'f', 2)
+            << "% lost)";
+    }
+    out << "\n";
+
+    out << "descriptions served: " << swarm.descriptionsServed() << "\n";
+    out << "device builds: " << status->startedDeviceBuilds() << " started, "
+        << status->failedDeviceBuilds() << " failed, at most "
+        << m_maxPendingBuilds << " pending\n";
+
+    if (status->deviceBuildLatency(50) >= 0)
+    {
+        out << "device build time: p50 " << status->deviceBuildLatency(50)
+            << " ms, p99 " << status->deviceBuildLatency(99) << " ms\n";
+    }
+
+    qint64 peak = memoryUsage("VmHWM");
+    if (peak >= 0)
+    {
+        out << "peak memory: " << peak / 1024 << " kB\n";
+    }
+}
@@ -0,0 +1,141 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of an application named HUpnpLoadTestApp
+ *  used for measuring the performance of the Herqq UPnP (HUPnP) library.
+ *
+ *  HUpnpLoadTestApp is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  HUpnpLoadTestApp is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with HUpnpLoadTestApp. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DEVICESWARM_H
+#define DEVICESWARM_H
+
+#include <HUpnpCore/HUpnp>
+
+#include <QtCore/QList>
+#include <QtCore/QPair>
+#include <QtCore/QTimer>
+#include <QtCore/QObject>
+#include <QtCore/QElapsedTimer>
+#include <QtNetwork/QHostAddress>
+
+class QUdpSocket;
+class QTcpServer;
+class QTextStream;
+
+//
+// Simulates a number of root devices that answer the discovery requests
+// of a control point and serve their descriptions. Every device uses the
+// description of the test device with a UDN of its own. The responses to
+// a discovery request are spread over the MX time the request allows,
+// as the responses of real devices would be.
+//
+class DeviceSwarm :
+    public QObject
+{
+Q_OBJECT
+Q_DISABLE_COPY(DeviceSwarm)
+
+private:
+
+    qint32 m_deviceCount;
+    QHostAddress m_address;
+
+    QByteArray m_deviceDescription;
+    QByteArray m_serviceDescription;
+
+    QUdpSocket* m_ssdp;
+    QTcpServer* m_http;
+
+    QList<QPair<qint32, QPair<QHostAddress, quint16> > > m_pending;
+    QTimer m_sendTimer;
+    qint32 m_responsesPerTick;
+    // the devices whose discovery responses are yet to be sent and the
+    // destinations of the responses
+
+    qint64 m_responsesSent;
+    qint64 m_descriptionsServed;
+
+    QByteArray udn(qint32 device) const;
+    QByteArray response(qint32 device, const QByteArray& location) const;
+
+private Q_SLOTS:
+
+    void discoveryReceived();
+    void sendResponses();
+    void httpConnection();
+    void httpReadyRead();
+
+public:
+
+    DeviceSwarm(
+        qint32 deviceCount, const QHostAddress& address,
+        const QString& descriptionDir);
+
+    virtual ~DeviceSwarm();
+
+    inline qint64 responsesSent() const { return m_responsesSent; }
+    inline qint64 descriptionsServed() const { return m_descriptionsServed; }
+
+public Q_SLOTS:
+
+    // returns false in case the sockets could not be bound
+    bool start();
+    void stop();
+};
+
+//
+// Follows a control point until it has every simulated device online and
+// samples the number of device model builds it has pending
+//
+class DiscoveryMonitor :
+    public QObject
+{
+Q_OBJECT
+Q_DISABLE_COPY(DiscoveryMonitor)
+
+private:
+
+    Herqq::Upnp::HControlPoint* m_controlPoint;
+    qint32 m_deviceCount;
+
+    QElapsedTimer m_clock;
+    QTimer m_sampleTimer;
+    qint64 m_allOnlineMsecs;
+    qint32 m_online;
+    qint32 m_maxPendingBuilds;
+
+private Q_SLOTS:
+
+    void rootDeviceOnline(Herqq::Upnp::HClientDevice*);
+    void sample();
+
+public:
+
+    DiscoveryMonitor(Herqq::Upnp::HControlPoint*, qint32 deviceCount);
+
+    // starts the clock, which has to be done before the control point
+    // is initialized
+    void start();
+
+    void report(QTextStream& out, const DeviceSwarm& swarm) const;
+
+Q_SIGNALS:
+
+    void allOnline();
+};
+
+#endif // DEVICESWARM_H
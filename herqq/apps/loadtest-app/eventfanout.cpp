@@ -0,0 +1,314 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of an application named HUpnpLoadTestApp
+ *  used for measuring the performance of the Herqq UPnP (HUPnP) library.
+ *
+ *  HUpnpLoadTestApp is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  HUpnpLoadTestApp is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with HUpnpLoadTestApp. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "eventfanout.h"
+#include "httpmessage.h"
+#include "memoryusage.h"
+
+#include <HUpnpCore/HServerStateVariable>
+
+#include <QtCore/QVector>
+#include <QtCore/QVariant>
+#include <QtCore/QtAlgorithms>
+#include <QtCore/QTextStream>
+#include <QtNetwork/QTcpSocket>
+#include <QtNetwork/QTcpServer>
+#include <QtNetwork/QHostAddress>
+
+using namespace Herqq::Upnp;
+
+namespace
+{
+const char EventedVariable[] = "RegisteredClientCount";
+}
+
+/*******************************************************************************
+ * EventFanout
+ *******************************************************************************/
+EventFanout::EventFanout(
+    const LoadTarget& target, qint32 subscriberCount,
+    const QElapsedTimer& clock) :
+        QObject(),
+            m_target(target), m_subscriberCount(qMax(1, subscriberCount)),
+            m_clock(clock), m_sink(0), m_subscriber(0), m_buffer(),
+            m_subscribed(0), m_failedSubscriptions(0), m_residentBefore(-1),
+            m_residentAfter(-1), m_changesMutex(), m_changes(),
+            m_notifications(0), m_bytes(0)
+{
+}
+
+EventFanout::~EventFanout()
+{
+}
+
+void EventFanout::start()
+{
+    m_residentBefore = memoryUsage("VmRSS");
+
+    m_sink = new QTcpServer(this);
+    m_sink->listen(QHostAddress(m_target.m_host));
+
+    bool ok = connect(
+        m_sink, SIGNAL(newConnection()), this, SLOT(sinkConnection()));
+    Q_ASSERT(ok); Q_UNUSED(ok)
+
+    m_subscriber = new QTcpSocket(this);
+
+    ok = connect(
+        m_subscriber, SIGNAL(connected()), this, SLOT(subscriberConnected()));
+    Q_ASSERT(ok);
+
+    ok = connect(
+        m_subscriber, SIGNAL(readyRead()), this, SLOT(subscriberReadyRead()));
+    Q_ASSERT(ok);
+
+    connectSubscriber();
+}
+
+void EventFanout::stop()
+{
+    delete m_subscriber;
+    m_subscriber = 0;
+
+    delete m_sink;
+    m_sink = 0;
+}
+
+void EventFanout::connectSubscriber()
+{
+    m_buffer.clear();
+    m_subscriber->abort();
+    m_subscriber->connectToHost(m_target.m_host, m_target.m_port);
+}
+
+void EventFanout::subscriberConnected()
+{
+    subscribe();
+}
+
+void EventFanout::subscribe()
+{
+    QByteArray request("SUBSCRIBE ");
+    request.append(m_target.m_eventSubPath).append(" HTTP/1.1\r\n").
+        append("HOST: ").append(m_target.m_host.toUtf8()).append(':').
+        append(QByteArray::number(m_target.m_port)).append("\r\n").
+        append("CALLBACK: <http://").append(m_target.m_host.toUtf8()).
+        append(':').append(QByteArray::number(m_sink->serverPort())).
+        append("/>\r\nNT: upnp:event\r\nTIMEOUT: Second-1800\r\n\r\n");
+
+    m_subscriber->write(request);
+}
+
+void EventFanout::subscriberReadyRead()
+{
+    m_buffer.append(m_subscriber->readAll());
+
+    QByteArray header;
+    if (!takeMessage(&m_buffer, &header))
+    {
+        return;
+    }
+
+    if (header.startsWith("HTTP/1.1 200"))
+    {
+        ++m_subscribed;
+    }
+    else
+    {
+        ++m_failedSubscriptions;
+    }
+
+    if (m_subscribed + m_failedSubscriptions >= m_subscriberCount)
+    {
+        m_residentAfter = memoryUsage("VmRSS");
+        m_subscriber->disconnectFromHost();
+        emit subscribed();
+    }
+    else if (fieldValue(header, "connection").toLower() == "close")
+    {
+        connectSubscriber();
+    }
+    else
+    {
+        subscribe();
+    }
+}
+
+void EventFanout::sinkConnection()
+{
+    while(m_sink->hasPendingConnections())
+    {
+        QTcpSocket* socket = m_sink->nextPendingConnection();
+
+        bool ok = connect(
+            socket, SIGNAL(readyRead()), this, SLOT(sinkReadyRead()));
+        Q_ASSERT(ok); Q_UNUSED(ok)
+
+        ok = connect(
+            socket, SIGNAL(disconnected()), socket, SLOT(deleteLater()));
+        Q_ASSERT(ok);
+    }
+}
+
+void EventFanout::sinkReadyRead()
+{
+    QTcpSocket* socket = qobject_cast<QTcpSocket*>(sender());
+    Q_ASSERT(socket);
+
+    QByteArray buffer = socket->property("buffer").toByteArray();
+    buffer.append(socket->readAll());
+
+    QByteArray header, body;
+    qint32 size = buffer.size();
+    while(takeMessage(&buffer, &header, &body))
+    {
+        socket->write("HTTP/1.1 200 OK\r\nCONTENT-LENGTH: 0\r\n\r\n");
+        received(body, size - buffer.size());
+        size = buffer.size();
+    }
+
+    socket->setProperty("buffer", buffer);
+}
+
+void EventFanout::received(const QByteArray& body, qint64 bytes)
+{
+    ++m_notifications;
+    m_bytes += bytes;
+
+    QByteArray startTag = QByteArray("<").append(EventedVariable).append('>');
+
+    qint32 start = body.indexOf(startTag);
+    if (start < 0)
+    {
+        return;
+    }
+
+    start += startTag.size();
+    quint32 value = body.mid(start, body.indexOf('<', start) - start).toUInt();
+
+    QMutexLocker lock(&m_changesMutex);
+
+    QHash<quint32, Change>::iterator it = m_changes.find(value);
+    if (it != m_changes.end() && ++it->m_received == m_subscribed)
+    {
+        it->m_completedAt = m_clock.nsecsElapsed() / 1000;
+    }
+}
+
+void EventFanout::changing(quint32 value)
+{
+    Change change = { m_clock.nsecsElapsed() / 1000, -1, 0 };
+
+    QMutexLocker lock(&m_changesMutex);
+    m_changes.insert(value, change);
+}
+
+void EventFanout::report(QTextStream& out)
+{
+    QVector<qint64> latencies;
+    qint32 incomplete = 0;
+    {
+        QMutexLocker lock(&m_changesMutex);
+        foreach(const Change& change, m_changes)
+        {
+            if (change.m_completedAt < 0)
+            {
+                ++incomplete;
+            }
+            else
+            {
+                latencies.append(change.m_completedAt - change.m_changedAt);
+            }
+        }
+    }
+
+    qSort(latencies);
+
+    out << "subscribers: " << m_subscribed << " ("
+        << m_failedSubscriptions << " failed)\n";
+
+    if (m_residentBefore >= 0 && m_residentAfter >= 0 && m_subscribed > 0)
+    {
+        out << "memory: " << (m_residentAfter - m_residentBefore) / m_subscribed
+            << " bytes per subscriber (both ends included)\n";
+    }
+
+    out << "changes: " << latencies.size() + incomplete << ", "
+        << incomplete << " did not reach every subscriber\n";
+
+    if (!latencies.isEmpty())
+    {
+        out << "time until the last NOTIFY: p50 "
+            << QString::number(
+                   latencies.at(latencies.size() / 2) / 1000.0, 'f', 3)
+            << " ms, p99 "
+            << QString::number(
+                   latencies.at((latencies.size() - 1) * 99 / 100) / 1000.0,
+                   'f', 3)
+            << " ms, max "
+            << QString::number(latencies.last() / 1000.0, 'f', 3) << " ms\n";
+    }
+
+    out << "notifications: " << m_notifications << ", " << m_bytes
+        << " bytes";
+    if (m_notifications > 0)
+    {
+        out << " (" << m_bytes / m_notifications << " per notification)";
+    }
+    out << "\n";
+}
+
+/*******************************************************************************
+ * StateChanger
+ *******************************************************************************/
+StateChanger::StateChanger(
+    HServerStateVariable* variable, EventFanout* fanout,
+    qint32 changesPerSec, qint32 durationSecs) :
+        QObject(),
+            m_variable(variable), m_fanout(fanout), m_timer(),
+            m_changesLeft(qMax(1, changesPerSec) * qMax(1, durationSecs))
+{
+    m_timer.setInterval(1000 / qBound(1, changesPerSec, 1000));
+
+    bool ok = connect(&m_timer, SIGNAL(timeout()), this, SLOT(change()));
+    Q_ASSERT(ok); Q_UNUSED(ok)
+}
+
+void StateChanger::start()
+{
+    m_timer.start();
+}
+
+void StateChanger::change()
+{
+    if (m_changesLeft-- <= 0)
+    {
+        m_timer.stop();
+        emit finished();
+        return;
+    }
+
+    quint32 value = m_variable->value().toUInt() + 1;
+
+    m_fanout->changing(value);
+    m_variable->setValue(value);
+}
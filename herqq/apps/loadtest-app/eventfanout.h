@@ -0,0 +1,155 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of an application named HUpnpLoadTestApp
+ *  used for measuring the performance of the Herqq UPnP (HUPnP) library.
+ *
+ *  HUpnpLoadTestApp is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  HUpnpLoadTestApp is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with HUpnpLoadTestApp. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EVENTFANOUT_H
+#define EVENTFANOUT_H
+
+#include "loadgenerator.h"
+
+#include <HUpnpCore/HUpnp>
+
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QTimer>
+#include <QtCore/QObject>
+#include <QtCore/QElapsedTimer>
+
+class QTcpSocket;
+class QTcpServer;
+class QTextStream;
+
+//
+// Subscribes a number of loopback GENA subscribers to the test service and
+// measures the time it takes for a state change to reach every one of them.
+// Every subscriber uses the same callback, which is a server run by this
+// class. The subscriptions are made one after the other over a single
+// connection.
+//
+class EventFanout :
+    public QObject
+{
+Q_OBJECT
+Q_DISABLE_COPY(EventFanout)
+
+private:
+
+    struct Change
+    {
+        qint64 m_changedAt;
+        qint64 m_completedAt;
+        qint32 m_received;
+    };
+
+    LoadTarget m_target;
+    qint32 m_subscriberCount;
+    const QElapsedTimer& m_clock;
+    // the clock shared with the thread that changes the state
+
+    QTcpServer* m_sink;
+    QTcpSocket* m_subscriber;
+    QByteArray m_buffer;
+    qint32 m_subscribed;
+    qint32 m_failedSubscriptions;
+
+    qint64 m_residentBefore;
+    qint64 m_residentAfter;
+    // the resident memory of the process before and after the subscriptions
+
+    QMutex m_changesMutex;
+    QHash<quint32, Change> m_changes;
+    // the state changes by the value they set
+
+    qint64 m_notifications;
+    qint64 m_bytes;
+    // the notifications and the bytes received by the callback
+
+    void connectSubscriber();
+    void subscribe();
+    void received(const QByteArray& body, qint64 bytes);
+
+private Q_SLOTS:
+
+    void subscriberConnected();
+    void subscriberReadyRead();
+    void sinkConnection();
+    void sinkReadyRead();
+
+public:
+
+    EventFanout(
+        const LoadTarget& target, qint32 subscriberCount,
+        const QElapsedTimer& clock);
+
+    virtual ~EventFanout();
+
+    // records that the value is about to be set. this is thread-safe
+    void changing(quint32 value);
+
+    void report(QTextStream& out);
+
+public Q_SLOTS:
+
+    void start();
+    void stop();
+
+Q_SIGNALS:
+
+    void subscribed();
+};
+
+//
+// Changes the value of the evented state variable of the test service at
+// a specified rate
+//
+class StateChanger :
+    public QObject
+{
+Q_OBJECT
+Q_DISABLE_COPY(StateChanger)
+
+private:
+
+    Herqq::Upnp::HServerStateVariable* m_variable;
+    EventFanout* m_fanout;
+    QTimer m_timer;
+    qint32 m_changesLeft;
+
+private Q_SLOTS:
+
+    void change();
+
+public:
+
+    StateChanger(
+        Herqq::Upnp::HServerStateVariable* variable, EventFanout* fanout,
+        qint32 changesPerSec, qint32 durationSecs);
+
+public Q_SLOTS:
+
+    void start();
+
+Q_SIGNALS:
+
+    void finished();
+};
+
+#endif // EVENTFANOUT_H
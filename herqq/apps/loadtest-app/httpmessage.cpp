@@ -0,0 +1,93 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of an application named HUpnpLoadTestApp
+ *  used for measuring the performance of the Herqq UPnP (HUPnP) library.
+ *
+ *  HUpnpLoadTestApp is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  HUpnpLoadTestApp is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with HUpnpLoadTestApp. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "httpmessage.h"
+
+QByteArray fieldValue(const QByteArray& header, const char* field)
+{
+    QByteArray lower = header.toLower();
+    QByteArray key = QByteArray("\r\n").append(field).append(':');
+
+    qint32 index = lower.indexOf(key);
+    if (index < 0)
+    {
+        return QByteArray();
+    }
+
+    index += key.size();
+    return header.mid(index, header.indexOf("\r\n", index) - index).trimmed();
+}
+
+bool takeMessage(QByteArray* buffer, QByteArray* header, QByteArray* body)
+{
+    qint32 headerEnd = buffer->indexOf("\r\n\r\n");
+    if (headerEnd < 0)
+    {
+        return false;
+    }
+
+    QByteArray hdr = buffer->left(headerEnd + 2);
+    qint32 pos = headerEnd + 4;
+
+    if (fieldValue(hdr, "transfer-encoding").toLower() == "chunked")
+    {
+        for(;;)
+        {
+            qint32 lineEnd = buffer->indexOf("\r\n", pos);
+            if (lineEnd < 0)
+            {
+                return false;
+            }
+
+            QByteArray sizeLine = buffer->mid(pos, lineEnd - pos);
+            qint32 size = sizeLine.left(sizeLine.indexOf(';')).trimmed().
+                toInt(0, 16);
+
+            pos = lineEnd + 2 + size + 2;
+            if (buffer->size() < pos)
+            {
+                return false;
+            }
+            else if (size == 0)
+            {
+                break;
+            }
+        }
+    }
+    else
+    {
+        pos += fieldValue(hdr, "content-length").toInt();
+        if (buffer->size() < pos)
+        {
+            return false;
+        }
+        else if (body)
+        {
+            *body = buffer->mid(headerEnd + 4, pos - headerEnd - 4);
+        }
+    }
+
+    *header = hdr;
+    buffer->remove(0, pos);
+    return true;
+}
+
@@ -0,0 +1,41 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of an application named HUpnpLoadTestApp
+ *  used for measuring the performance of the Herqq UPnP (HUPnP) library.
+ *
+ *  HUpnpLoadTestApp is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  HUpnpLoadTestApp is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with HUpnpLoadTestApp. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HTTPMESSAGE_H
+#define HTTPMESSAGE_H
+
+#include <QtCore/QByteArray>
+
+//
+// Returns the value of the specified header field, which has to be
+// in lower case
+//
+QByteArray fieldValue(const QByteArray& header, const char* field);
+
+//
+// Removes a complete HTTP message from the start of the buffer. Returns false
+// in case the buffer does not yet contain a complete message. The body is
+// returned only when it is not sent in chunks.
+//
+bool takeMessage(QByteArray* buffer, QByteArray* header, QByteArray* body = 0);
+
+#endif // HTTPMESSAGE_H
@@ -0,0 +1,393 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of an application named HUpnpLoadTestApp
+ *  used for measuring the performance of the Herqq UPnP (HUPnP) library.
+ *
+ *  HUpnpLoadTestApp is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  HUpnpLoadTestApp is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with HUpnpLoadTestApp. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "loadgenerator.h"
+#include "httpmessage.h"
+
+#include <QtCore/QTimer>
+#include <QtCore/QtAlgorithms>
+#include <QtCore/QTextStream>
+#include <QtNetwork/QTcpSocket>
+#include <QtNetwork/QTcpServer>
+#include <QtNetwork/QHostAddress>
+
+namespace
+{
+qint64 percentile(const QVector<qint64>& sorted, qint32 permille)
+{
+    if (sorted.isEmpty())
+    {
+        return 0;
+    }
+
+    return sorted.at((permille * (sorted.size() - 1)) / 1000);
+}
+
+QString msecs(qint64 usecs)
+{
+    return QString::number(usecs / 1000.0, 'f', 3);
+}
+}
+
+/*******************************************************************************
+ * LoadClient
+ *******************************************************************************/
+LoadClient::LoadClient(LoadGenerator* owner) :
+    QObject(owner),
+        m_owner(owner), m_socket(new QTcpSocket(this)), m_buffer(),
+        m_operation(ControlRequest), m_timer(), m_waiting(false), m_sid()
+{
+    bool ok = connect(m_socket, SIGNAL(connected()), this, SLOT(connected()));
+    Q_ASSERT(ok); Q_UNUSED(ok)
+
+    ok = connect(m_socket, SIGNAL(readyRead()), this, SLOT(readyRead()));
+    Q_ASSERT(ok);
+
+    ok = connect(
+        m_socket, SIGNAL(error(QAbstractSocket::SocketError)),
+        this, SLOT(error(QAbstractSocket::SocketError)));
+    Q_ASSERT(ok);
+}
+
+LoadClient::~LoadClient()
+{
+}
+
+void LoadClient::start()
+{
+    connectToHost();
+}
+
+void LoadClient::connectToHost()
+{
+    m_buffer.clear();
+    m_socket->abort();
+    m_socket->connectToHost(m_owner->m_target.m_host, m_owner->m_target.m_port);
+}
+
+void LoadClient::connected()
+{
+    send();
+}
+
+void LoadClient::reconnect()
+{
+    if (m_owner->m_running)
+    {
+        connectToHost();
+    }
+}
+
+void LoadClient::send()
+{
+    if (!m_owner->m_running)
+    {
+        m_socket->abort();
+        return;
+    }
+
+    QByteArray request;
+    if (!m_sid.isEmpty())
+    {
+        m_operation = UnsubscribeRequest;
+        request = m_owner->unsubscribeRequest(m_sid);
+        m_sid.clear();
+    }
+    else
+    {
+        m_operation = m_owner->nextOperation();
+        switch(m_operation)
+        {
+        case SubscribeRequest:
+            request = m_owner->m_subscribeRequest;
+            break;
+        case DescriptionRequest:
+            request = m_owner->m_descriptionRequest;
+            break;
+        default:
+            request = m_owner->m_controlRequest;
+            break;
+        }
+    }
+
+    m_waiting = true;
+    m_timer.start();
+    m_socket->write(request);
+}
+
+void LoadClient::readyRead()
+{
+    m_buffer.append(m_socket->readAll());
+
+    QByteArray header;
+    if (!m_waiting || !takeMessage(&m_buffer, &header))
+    {
+        return;
+    }
+
+    m_waiting = false;
+
+    qint64 usecs = m_timer.nsecsElapsed() / 1000;
+    bool succeeded = header.startsWith("HTTP/1.1 200");
+
+    if (succeeded && m_operation == SubscribeRequest)
+    {
+        m_sid = fieldValue(header, "sid");
+    }
+
+    m_owner->completed(m_operation, usecs, succeeded);
+
+    if (fieldValue(header, "connection").toLower() == "close")
+    {
+        connectToHost();
+    }
+    else
+    {
+        send();
+    }
+}
+
+void LoadClient::error(QAbstractSocket::SocketError)
+{
+    if (m_waiting)
+    {
+        m_waiting = false;
+        m_owner->completed(m_operation, m_timer.nsecsElapsed() / 1000, false);
+    }
+
+    // the subscription, if any, is left to expire. the connection is
+    // re-opened after a moment and outside of the signal handler
+    m_sid.clear();
+    QTimer::singleShot(100, this, SLOT(reconnect()));
+}
+
+/*******************************************************************************
+ * LoadGenerator
+ *******************************************************************************/
+LoadGenerator::LoadGenerator(
+    const LoadTarget& target, qint32 clientCount, qint32 durationSecs,
+    qint32 controlWeight, qint32 subscribeWeight, qint32 descriptionWeight) :
+        QObject(),
+            m_target(target), m_clientCount(qMax(1, clientCount)),
+            m_durationSecs(qMax(1, durationSecs)), m_hostField(),
+            m_controlRequest(),
+            m_subscribeRequest(), m_descriptionRequest(), m_clients(),
+            m_notifySink(0), m_running(false), m_elapsed(), m_elapsedMsecs(0),
+            m_cpuStart(0), m_cpuEnd(0)
+{
+    m_weights[0] = qMax(0, controlWeight);
+    m_weights[1] = qMax(0, subscribeWeight);
+    m_weights[2] = qMax(0, descriptionWeight);
+
+    if (m_weights[0] + m_weights[1] + m_weights[2] == 0)
+    {
+        m_weights[0] = 1;
+    }
+
+    for(qint32 i = 0; i < OperationCount; ++i)
+    {
+        m_failures[i] = 0;
+    }
+
+    m_hostField = QByteArray("HOST: ").append(m_target.m_host.toUtf8()).
+        append(':').append(QByteArray::number(m_target.m_port)).append("\r\n");
+
+    QByteArray body =
+        "<?xml version=\"1.0\" encoding=\"utf-8\"?>"
+        "<s:Envelope xmlns:s=\"http://schemas.xmlsoap.org/soap/envelope/\" "
+        "s:encodingStyle=\"http://schemas.xmlsoap.org/soap/encoding/\">"
+        "<s:Body><u:Echo xmlns:u=\"";
+    body.append(m_target.m_serviceType).append(
+        "\"><MessageIn>HUPnP load test</MessageIn></u:Echo>"
+        "</s:Body></s:Envelope>");
+
+    m_controlRequest.append("POST ").append(m_target.m_controlPath).
+        append(" HTTP/1.1\r\n").append(m_hostField).
+        append("CONTENT-TYPE: text/xml; charset=\"utf-8\"\r\n").
+        append("SOAPACTION: \"").append(m_target.m_serviceType).
+        append("#Echo\"\r\n").
+        append("CONTENT-LENGTH: ").append(QByteArray::number(body.size())).
+        append("\r\n\r\n").append(body);
+
+    m_descriptionRequest.append("GET ").append(m_target.m_descriptionPath).
+        append(" HTTP/1.1\r\n").append(m_hostField).append("\r\n");
+}
+
+LoadGenerator::~LoadGenerator()
+{
+}
+
+void LoadGenerator::start()
+{
+    m_notifySink = new QTcpServer(this);
+    m_notifySink->listen(QHostAddress(m_target.m_host));
+
+    bool ok = connect(
+        m_notifySink, SIGNAL(newConnection()), this, SLOT(notifyConnection()));
+    Q_ASSERT(ok); Q_UNUSED(ok)
+
+    m_subscribeRequest.append("SUBSCRIBE ").append(m_target.m_eventSubPath).
+        append(" HTTP/1.1\r\n").append(m_hostField).
+        append("CALLBACK: <http://").append(m_target.m_host.toUtf8()).
+        append(':').
+        append(QByteArray::number(m_notifySink->serverPort())).append("/>\r\n").
+        append("NT: upnp:event\r\nTIMEOUT: Second-300\r\n\r\n");
+
+    m_running = true;
+    m_elapsed.start();
+    m_cpuStart = std::clock();
+
+    for(qint32 i = 0; i < m_clientCount; ++i)
+    {
+        LoadClient* client = new LoadClient(this);
+        m_clients.append(client);
+        client->start();
+    }
+
+    QTimer::singleShot(m_durationSecs * 1000, this, SLOT(stop()));
+}
+
+void LoadGenerator::stop()
+{
+    m_running = false;
+    m_elapsedMsecs = m_elapsed.elapsed();
+    m_cpuEnd = std::clock();
+
+    // the sockets are deleted in the thread they belong to
+    qDeleteAll(m_clients);
+    m_clients.clear();
+
+    delete m_notifySink;
+    m_notifySink = 0;
+
+    emit finished();
+}
+
+Operation LoadGenerator::nextOperation() const
+{
+    qint32 value = qrand() % (m_weights[0] + m_weights[1] + m_weights[2]);
+    if (value < m_weights[0])
+    {
+        return ControlRequest;
+    }
+    else if (value < m_weights[0] + m_weights[1])
+    {
+        return SubscribeRequest;
+    }
+    return DescriptionRequest;
+}
+
+QByteArray LoadGenerator::unsubscribeRequest(const QByteArray& sid) const
+{
+    QByteArray retVal("UNSUBSCRIBE ");
+    return retVal.append(m_target.m_eventSubPath).append(" HTTP/1.1\r\n").
+        append(m_hostField).append("SID: ").append(sid).append("\r\n\r\n");
+}
+
+void LoadGenerator::completed(Operation operation, qint64 usecs, bool succeeded)
+{
+    if (!m_running)
+    {
+        return;
+    }
+
+    if (succeeded)
+    {
+        m_latencies[operation].append(usecs);
+    }
+    else
+    {
+        ++m_failures[operation];
+    }
+}
+
+void LoadGenerator::notifyConnection()
+{
+    while(m_notifySink->hasPendingConnections())
+    {
+        QTcpSocket* socket = m_notifySink->nextPendingConnection();
+
+        bool ok = connect(
+            socket, SIGNAL(readyRead()), this, SLOT(notifyReceived()));
+        Q_ASSERT(ok); Q_UNUSED(ok)
+
+        ok = connect(
+            socket, SIGNAL(disconnected()), socket, SLOT(deleteLater()));
+        Q_ASSERT(ok);
+    }
+}
+
+void LoadGenerator::notifyReceived()
+{
+    QTcpSocket* socket = qobject_cast<QTcpSocket*>(sender());
+    Q_ASSERT(socket);
+
+    QByteArray buffer = socket->property("buffer").toByteArray();
+    buffer.append(socket->readAll());
+
+    QByteArray header;
+    while(takeMessage(&buffer, &header))
+    {
+        socket->write("HTTP/1.1 200 OK\r\nCONTENT-LENGTH: 0\r\n\r\n");
+    }
+
+    socket->setProperty("buffer", buffer);
+}
+
+void LoadGenerator::report(QTextStream& out) const
+{
+    static const char* names[] =
+    {
+        "control", "subscribe", "unsubscribe", "description"
+    };
+
+    double secs = qMax<qint64>(1, m_elapsedMsecs) / 1000.0;
+    qint64 total = 0;
+
+    out << "clients: " << m_clientCount << ", duration: " << secs << " s\n\n";
+    out << QString("%1%2%3%4%5%6%7\n").arg(
+        "request", -12).arg("count", 10).arg("failed", 10).arg("req/s", 10).
+        arg("p50 ms", 10).arg("p99 ms", 10).arg("p99.9 ms", 10);
+
+    for(qint32 i = 0; i < OperationCount; ++i)
+    {
+        QVector<qint64> sorted = m_latencies[i];
+        qSort(sorted);
+
+        total += sorted.size() + m_failures[i];
+
+        out << QString("%1%2%3%4%5%6%7\n").arg(names[i], -12).
+            arg(sorted.size(), 10).arg(m_failures[i], 10).
+            arg(QString::number(sorted.size() / secs, 'f', 1), 10).
+            arg(msecs(percentile(sorted, 500)), 10).
+            arg(msecs(percentile(sorted, 990)), 10).
+            arg(msecs(percentile(sorted, 999)), 10);
+    }
+
+    double cpuUsecs = (m_cpuEnd - m_cpuStart) * 1000000.0 / CLOCKS_PER_SEC;
+
+    out << "\ntotal: " << total << " requests, "
+        << QString::number(total / secs, 'f', 1) << " req/s\n";
+    out << "cpu: " << QString::number(cpuUsecs / 1000000.0, 'f', 2) << " s, "
+        << QString::number(total ? cpuUsecs / total : 0, 'f', 1)
+        << " us per request (the clients included)\n";
+}
@@ -0,0 +1,184 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of an application named HUpnpLoadTestApp
+ *  used for measuring the performance of the Herqq UPnP (HUPnP) library.
+ *
+ *  HUpnpLoadTestApp is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  HUpnpLoadTestApp is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with HUpnpLoadTestApp. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LOADGENERATOR_H
+#define LOADGENERATOR_H
+
+#include <QtCore/QList>
+#include <QtCore/QVector>
+#include <QtCore/QObject>
+#include <QtCore/QByteArray>
+#include <QtCore/QElapsedTimer>
+#include <QtNetwork/QAbstractSocket>
+
+#include <ctime>
+
+class QTcpSocket;
+class QTcpServer;
+class QTextStream;
+
+class LoadGenerator;
+
+//
+// The requests the load generator sends
+//
+enum Operation
+{
+    ControlRequest = 0,
+    SubscribeRequest,
+    UnsubscribeRequest,
+    DescriptionRequest,
+    OperationCount
+};
+
+//
+// The addresses of the device the load generator sends the requests to
+//
+struct LoadTarget
+{
+    QString m_host;
+    quint16 m_port;
+
+    QByteArray m_controlPath;
+    QByteArray m_eventSubPath;
+    QByteArray m_descriptionPath;
+    QByteArray m_serviceType;
+};
+
+//
+// A client that keeps a persistent connection to the device host and sends
+// a new request as soon as the previous one has been answered. A SUBSCRIBE
+// is always followed by an UNSUBSCRIBE of the created subscription, which
+// keeps the number of subscribers constant.
+//
+class LoadClient :
+    public QObject
+{
+Q_OBJECT
+Q_DISABLE_COPY(LoadClient)
+
+private:
+
+    LoadGenerator* m_owner;
+    QTcpSocket* m_socket;
+
+    QByteArray m_buffer;
+    // the data of the response received so far
+
+    Operation m_operation;
+    QElapsedTimer m_timer;
+    bool m_waiting;
+    // the request in progress, its start time and whether a response
+    // is expected
+
+    QByteArray m_sid;
+    // the subscription to be cancelled by the next request, if any
+
+    void connectToHost();
+    void send();
+
+private Q_SLOTS:
+
+    void connected();
+    void reconnect();
+    void readyRead();
+    void error(QAbstractSocket::SocketError);
+
+public:
+
+    explicit LoadClient(LoadGenerator* owner);
+    virtual ~LoadClient();
+
+    void start();
+};
+
+//
+// Runs a number of clients against a device host for a specified time
+// and collects the latencies of the requests
+//
+class LoadGenerator :
+    public QObject
+{
+Q_OBJECT
+Q_DISABLE_COPY(LoadGenerator)
+friend class LoadClient;
+
+private:
+
+    LoadTarget m_target;
+    qint32 m_clientCount;
+    qint32 m_durationSecs;
+    qint32 m_weights[3];
+    // the relative shares of the control requests, the subscriptions and
+    // the description requests
+
+    QByteArray m_hostField;
+    QByteArray m_controlRequest;
+    QByteArray m_subscribeRequest;
+    QByteArray m_descriptionRequest;
+    // the requests are created once, as only the SID of an UNSUBSCRIBE varies
+
+    QList<LoadClient*> m_clients;
+    QTcpServer* m_notifySink;
+    // answers the event notifications sent to the subscriptions
+
+    bool m_running;
+    QElapsedTimer m_elapsed;
+    qint64 m_elapsedMsecs;
+    std::clock_t m_cpuStart;
+    std::clock_t m_cpuEnd;
+
+    QVector<qint64> m_latencies[OperationCount];
+    qint64 m_failures[OperationCount];
+    // the latencies of the successful requests in microseconds and the
+    // number of the failed requests
+
+    Operation nextOperation() const;
+    QByteArray unsubscribeRequest(const QByteArray& sid) const;
+    void completed(Operation, qint64 usecs, bool succeeded);
+
+private Q_SLOTS:
+
+    void notifyConnection();
+    void notifyReceived();
+    void stop();
+
+public:
+
+    LoadGenerator(
+        const LoadTarget& target, qint32 clientCount, qint32 durationSecs,
+        qint32 controlWeight, qint32 subscribeWeight, qint32 descriptionWeight);
+
+    virtual ~LoadGenerator();
+
+    void report(QTextStream& out) const;
+
+public Q_SLOTS:
+
+    void start();
+
+Q_SIGNALS:
+
+    void finished();
+};
+
+#endif // LOADGENERATOR_H
@@ -0,0 +1,52 @@
+TEMPLATE = app
+TARGET   = HUpnpLoadTestApp
+QT      += network xml
+QT      -= gui
+CONFIG  += warn_on console
+
+INCLUDEPATH += ../../hupnp/include
+
+LIBS += -L"../../hupnp/bin" -lHUpnp
+
+win32 {
+    LIBS += -lws2_32
+
+    DESCRIPTIONS = $$PWD\\..\\simple_test-app\\descriptions
+    DESCRIPTIONS = $${replace(DESCRIPTIONS, /, \\)}
+    QMAKE_POST_LINK += xcopy $$DESCRIPTIONS bin\\descriptions /E /Y /C /I $$escape_expand(\\n\\t)
+    QMAKE_POST_LINK += copy ..\\..\\hupnp\\bin\\* bin /Y
+}
+else {
+    !macx:QMAKE_LFLAGS += -Wl,--rpath=\\\$\$ORIGIN
+
+    QMAKE_POST_LINK += cp -Rf $$PWD/../simple_test-app/descriptions bin &
+    QMAKE_POST_LINK += cp -Rf ../../hupnp/bin/* bin
+}
+
+macx {
+  CONFIG -= app_bundle
+}
+
+OBJECTS_DIR = obj
+MOC_DIR = obj
+
+DESTDIR = ./bin
+
+HEADERS += \
+    testdevice.h \
+    httpmessage.h \
+    loadgenerator.h \
+    eventfanout.h \
+    deviceswarm.h \
+    memoryusage.h \
+    trafficreplay.h
+
+SOURCES += \
+    main.cpp \
+    testdevice.cpp \
+    httpmessage.cpp \
+    loadgenerator.cpp \
+    eventfanout.cpp \
+    deviceswarm.cpp \
+    memoryusage.cpp \
+    trafficreplay.cpp
@@ -0,0 +1,435 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of an application named HUpnpLoadTestApp
+ *  used for measuring the performance of the Herqq UPnP (HUPnP) library.
+ *
+ *  HUpnpLoadTestApp is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  HUpnpLoadTestApp is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with HUpnpLoadTestApp. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testdevice.h"
+#include "loadgenerator.h"
+#include "eventfanout.h"
+#include "deviceswarm.h"
+#include "trafficreplay.h"
+
+#include <HUpnpCore/HUpnp>
+#include <HUpnpCore/HDeviceHost>
+#include <HUpnpCore/HControlPoint>
+#include <HUpnpCore/HServiceInfo>
+#include <HUpnpCore/HResourceType>
+#include <HUpnpCore/HServerDevice>
+#include <HUpnpCore/HServerService>
+#include <HUpnpCore/HTrafficCapture>
+#include <HUpnpCore/HDeviceHostConfiguration>
+#include <HUpnpCore/HControlPointConfiguration>
+
+#include <QtCore/QUrl>
+#include <QtCore/QFile>
+#include <QtCore/QTimer>
+#include <QtCore/QThread>
+#include <QtCore/QStringList>
+#include <QtCore/QTextStream>
+#include <QtCore/QCoreApplication>
+
+using namespace Herqq::Upnp;
+
+namespace
+{
+void printUsage(QTextStream& out)
+{
+    out << "Usage: HUpnpLoadTestApp [options]\n\n"
+        << "Starts a device host carrying the test device of the "
+           "HUpnpSimpleTestApp\nand runs a number of HTTP clients "
+           "against it.\n\n"
+        << "  --clients=N       the number of concurrent keep-alive "
+           "clients (8)\n"
+        << "  --duration=S      the length of the run in seconds (10)\n"
+        << "  --mix=C:S:G       the relative shares of the control "
+           "requests, the\n"
+        << "                    SUBSCRIBE/UNSUBSCRIBE pairs and the "
+           "description GETs (8:1:1)\n"
+        << "  --http-threads=N  the number of HTTP worker threads of the "
+           "device host (0)\n\n"
+        << "  --subscribers=N   measures the event fan-out to N "
+           "subscribers instead\n"
+        << "  --rate=R          the state changes per second in the "
+           "fan-out (10)\n\n"
+        << "  --devices=N       measures the discovery of N simulated "
+           "devices by\n"
+        << "                    a control point instead. The run ends "
+           "once every\n"
+        << "                    device is online or the duration has "
+           "passed\n\n"
+        << "  --capture=FILE    records the SSDP and HTTP traffic of the "
+           "run into FILE\n"
+        << "  --replay=FILE     replays the traffic received in a capture "
+           "instead\n"
+        << "  --target=H:P      the HTTP endpoint the replay is sent to. "
+           "The test device\n"
+        << "                    host is started and used when this is "
+           "not specified\n"
+        << "  --speed=X         the speed of the replay relative to the "
+           "capture, or\n"
+        << "                    max to send the messages as fast as "
+           "possible (1)\n";
+}
+
+qint32 intOption(const QString& arg, const QString& name, qint32 def)
+{
+    QString prefix = QString("--%1=").arg(name);
+    if (!arg.startsWith(prefix))
+    {
+        return def;
+    }
+
+    bool ok = false;
+    qint32 value = arg.mid(prefix.size()).toInt(&ok);
+    return ok ? value : def;
+}
+
+//
+// Records the traffic of the process into a file for as long as it exists.
+//
+class CaptureFile
+{
+Q_DISABLE_COPY(CaptureFile)
+
+private:
+
+    QFile m_file;
+
+public:
+
+    explicit CaptureFile(const QString& path) : m_file(path)
+    {
+        if (!path.isEmpty() && m_file.open(QIODevice::WriteOnly))
+        {
+            HTrafficCapture::start(&m_file);
+        }
+    }
+
+    ~CaptureFile()
+    {
+        if (m_file.isOpen())
+        {
+            HTrafficCapture::stop();
+        }
+    }
+
+    inline bool failed() const
+    {
+        return !m_file.fileName().isEmpty() && !HTrafficCapture::isEnabled();
+    }
+};
+
+int runReplay(
+    QCoreApplication& app, QTextStream& out, const QString& path,
+    const QHostAddress& host, quint16 port, double speed)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        out << "Failed to open the capture: " << file.errorString() << "\n";
+        return 1;
+    }
+
+    TrafficReplay* replay = new TrafficReplay(host, port, speed);
+    if (!replay->load(&file))
+    {
+        out << "The file " << path << " does not contain a capture.\n";
+        delete replay;
+        return 1;
+    }
+
+    // the replay is run in a thread of its own, so that it does not
+    // compete with the target for its event loop, in case the target is
+    // the device host of this process
+    QThread replayThread;
+    replay->moveToThread(&replayThread);
+
+    bool ok = QObject::connect(
+        replay, SIGNAL(finished()), &app, SLOT(quit()),
+        Qt::QueuedConnection);
+    Q_ASSERT(ok); Q_UNUSED(ok)
+
+    replayThread.start();
+    QMetaObject::invokeMethod(replay, "start", Qt::QueuedConnection);
+
+    app.exec();
+
+    replayThread.quit();
+    replayThread.wait();
+
+    replay->report(out);
+    delete replay;
+
+    return 0;
+}
+
+int runDiscovery(
+    QCoreApplication& app, QTextStream& out, qint32 devices, qint32 duration)
+{
+    HControlPointConfiguration configuration;
+    configuration.setSubscribeToEvents(false);
+
+    QHostAddress address = configuration.networkAddressesToUse().at(0);
+
+    // the simulated devices are run in a thread of their own, so that they
+    // do not compete with the control point for its event loop
+    QThread swarmThread;
+    DeviceSwarm* swarm = new DeviceSwarm(devices, address, "./descriptions");
+    swarm->moveToThread(&swarmThread);
+    swarmThread.start();
+
+    bool started = false;
+    QMetaObject::invokeMethod(
+        swarm, "start", Qt::BlockingQueuedConnection,
+        Q_RETURN_ARG(bool, started));
+
+    if (!started)
+    {
+        out << "Failed to start the simulated devices.\n";
+    }
+    else
+    {
+        HControlPoint controlPoint;
+        DiscoveryMonitor monitor(&controlPoint, devices);
+
+        bool ok = QObject::connect(
+            &monitor, SIGNAL(allOnline()), &app, SLOT(quit()));
+        Q_ASSERT(ok); Q_UNUSED(ok)
+
+        QTimer::singleShot(qMax(1, duration) * 1000, &app, SLOT(quit()));
+
+        monitor.start();
+        if (!controlPoint.init(configuration))
+        {
+            out << "Failed to start the control point: "
+                << controlPoint.errorDescription() << "\n";
+        }
+        else
+        {
+            app.exec();
+            monitor.report(out, *swarm);
+        }
+    }
+
+    QMetaObject::invokeMethod(swarm, "stop", Qt::BlockingQueuedConnection);
+
+    swarmThread.quit();
+    swarmThread.wait();
+    delete swarm;
+
+    return started ? 0 : 1;
+}
+}
+
+int main(int argc, char* argv[])
+{
+    SetLoggingLevel(Warning);
+
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    qint32 clients = 8, duration = 10, httpThreads = 0;
+    qint32 subscribers = 0, rate = 10, devices = 0;
+    qint32 weights[3] = { 8, 1, 1 };
+    QString capturePath, replayPath;
+    QHostAddress replayHost;
+    quint16 replayPort = 0;
+    double speed = 1;
+
+    QStringList args = app.arguments();
+    for(qint32 i = 1; i < args.size(); ++i)
+    {
+        const QString& arg = args.at(i);
+        if (arg.startsWith("--mix="))
+        {
+            QStringList parts = arg.mid(6).split(':');
+            for(qint32 j = 0; j < 3 && j < parts.size(); ++j)
+            {
+                weights[j] = parts.at(j).toInt();
+            }
+        }
+        else if (arg.startsWith("--capture="))
+        {
+            capturePath = arg.mid(10);
+        }
+        else if (arg.startsWith("--replay="))
+        {
+            replayPath = arg.mid(9);
+        }
+        else if (arg.startsWith("--target="))
+        {
+            QUrl url(QString("http://%1").arg(arg.mid(9)));
+            replayHost = QHostAddress(url.host());
+            replayPort = static_cast<quint16>(url.port(0));
+        }
+        else if (arg.startsWith("--speed="))
+        {
+            QString value = arg.mid(8);
+            speed = value == "max" ? 0 : value.toDouble();
+        }
+        else if (arg.startsWith("--clients=") ||
+                 arg.startsWith("--duration=") ||
+                 arg.startsWith("--http-threads=") ||
+                 arg.startsWith("--subscribers=") ||
+                 arg.startsWith("--rate=") ||
+                 arg.startsWith("--devices="))
+        {
+            clients = intOption(arg, "clients", clients);
+            duration = intOption(arg, "duration", duration);
+            httpThreads = intOption(arg, "http-threads", httpThreads);
+            subscribers = intOption(arg, "subscribers", subscribers);
+            rate = intOption(arg, "rate", rate);
+            devices = intOption(arg, "devices", devices);
+        }
+        else
+        {
+            printUsage(out);
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    CaptureFile capture(capturePath);
+    if (capture.failed())
+    {
+        out << "Failed to start the capture into " << capturePath << "\n";
+        return 1;
+    }
+
+    if (devices > 0)
+    {
+        return runDiscovery(app, out, devices, duration);
+    }
+
+    if (!replayPath.isEmpty() && replayPort)
+    {
+        return runReplay(
+            app, out, replayPath, replayHost, replayPort, speed);
+    }
+
+    HDeviceConfiguration deviceConfiguration;
+    deviceConfiguration.setPathToDeviceDescription(
+        "./descriptions/hupnp_testdevice.xml");
+
+    HDeviceHostConfiguration hostConfiguration(deviceConfiguration);
+    hostConfiguration.setDeviceModelCreator(HTestDeviceCreator());
+    hostConfiguration.setHttpWorkerThreadCount(httpThreads);
+
+    HDeviceHost deviceHost;
+    if (!deviceHost.init(hostConfiguration))
+    {
+        out << "Failed to start the device host: "
+            << deviceHost.errorDescription() << "\n";
+        return 1;
+    }
+
+    HServerDevice* device = deviceHost.rootDevices().at(0);
+    HServerService* service = device->services().at(0);
+    QUrl location = device->locations().at(0);
+
+    LoadTarget target;
+    target.m_host = location.host();
+    target.m_port = location.port();
+    target.m_descriptionPath = location.path().toUtf8();
+    target.m_controlPath =
+        location.resolved(service->info().controlUrl()).path().toUtf8();
+    target.m_eventSubPath =
+        location.resolved(service->info().eventSubUrl()).path().toUtf8();
+    target.m_serviceType = service->info().serviceType().toString().toUtf8();
+
+    if (!replayPath.isEmpty())
+    {
+        return runReplay(
+            app, out, replayPath, QHostAddress(location.host()),
+            static_cast<quint16>(location.port()), speed);
+    }
+
+    // the clients are run in a thread of their own, so that they do not
+    // compete with the device host for its event loop
+    QThread clientThread;
+
+    if (subscribers > 0)
+    {
+        QElapsedTimer clock;
+        clock.start();
+
+        EventFanout* fanout = new EventFanout(target, subscribers, clock);
+        fanout->moveToThread(&clientThread);
+
+        StateChanger changer(
+            service->stateVariables().value("RegisteredClientCount"),
+            fanout, rate, duration);
+
+        QTimer drain;
+        drain.setSingleShot(true);
+        drain.setInterval(2000);
+        // the notifications of the last changes are waited for
+
+        bool ok = QObject::connect(
+            fanout, SIGNAL(subscribed()), &changer, SLOT(start()),
+            Qt::QueuedConnection);
+        Q_ASSERT(ok); Q_UNUSED(ok)
+
+        ok = QObject::connect(
+            &changer, SIGNAL(finished()), &drain, SLOT(start()));
+        Q_ASSERT(ok);
+
+        ok = QObject::connect(&drain, SIGNAL(timeout()), &app, SLOT(quit()));
+        Q_ASSERT(ok);
+
+        clientThread.start();
+        QMetaObject::invokeMethod(fanout, "start", Qt::QueuedConnection);
+
+        app.exec();
+
+        QMetaObject::invokeMethod(
+            fanout, "stop", Qt::BlockingQueuedConnection);
+
+        clientThread.quit();
+        clientThread.wait();
+
+        fanout->report(out);
+        delete fanout;
+
+        return 0;
+    }
+
+    LoadGenerator* generator = new LoadGenerator(
+        target, clients, duration, weights[0], weights[1], weights[2]);
+
+    generator->moveToThread(&clientThread);
+
+    bool ok = QObject::connect(
+        generator, SIGNAL(finished()), &app, SLOT(quit()),
+        Qt::QueuedConnection);
+    Q_ASSERT(ok); Q_UNUSED(ok)
+
+    clientThread.start();
+    QMetaObject::invokeMethod(generator, "start", Qt::QueuedConnection);
+
+    app.exec();
+
+    clientThread.quit();
+    clientThread.wait();
+
+    generator->report(out);
+    delete generator;
+
+    return 0;
+}
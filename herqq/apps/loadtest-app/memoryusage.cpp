@@ -0,0 +1,50 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of an application named HUpnpLoadTestApp
+ *  used for measuring the performance of the Herqq UPnP (HUPnP) library.
+ *
+ *  HUpnpLoadTestApp is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  HUpnpLoadTestApp is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with HUpnpLoadTestApp. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "memoryusage.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QByteArray>
+
+qint64 memoryUsage(const char* field)
+{
+    QFile file("/proc/self/status");
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return -1;
+    }
+
+    QByteArray prefix = QByteArray(field).append(':');
+
+    QByteArray line;
+    while(!(line = file.readLine()).isEmpty())
+    {
+        if (line.startsWith(prefix))
+        {
+            // the value is in kilobytes
+            return line.mid(prefix.size()).trimmed().split(' ').at(0).
+                toLongLong() * 1024;
+        }
+    }
+
+    return -1;
+}
@@ -0,0 +1,126 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of an application named HUpnpLoadTestApp
+ *  used for measuring the performance of the Herqq UPnP (HUPnP) library.
+ *
+ *  HUpnpLoadTestApp is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  HUpnpLoadTestApp is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with HUpnpLoadTestApp. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testdevice.h"
+
+#include <HUpnpCore/HDeviceInfo>
+#include <HUpnpCore/HServiceInfo>
+#include <HUpnpCore/HActionArguments>
+#include <HUpnpCore/HServerStateVariable>
+
+using namespace Herqq::Upnp;
+
+/*******************************************************************************
+ * HTestService
+ *******************************************************************************/
+HTestService::HTestService()
+{
+}
+
+HTestService::~HTestService()
+{
+}
+
+HServerService::HActionInvokes HTestService::createActionInvokes()
+{
+    HActionInvokes retVal;
+
+    retVal.insert(
+        "Echo", HActionInvoke(this, &HTestService::echoAction));
+
+    retVal.insert(
+        "Register", HActionInvoke(this, &HTestService::registerAction));
+
+    retVal.insert(
+        "Chargen", HActionInvoke(this, &HTestService::chargenAction));
+
+    return retVal;
+}
+
+qint32 HTestService::echoAction(
+    const HActionArguments& inArgs, HActionArguments* outArgs)
+{
+    (*outArgs)["MessageOut"].setValue(inArgs["MessageIn"].value());
+    return UpnpSuccess;
+}
+
+qint32 HTestService::registerAction(
+    const HActionArguments& /*inArgs*/, HActionArguments* /*outArgs*/)
+{
+    // modifies an evented state variable, which causes events to be sent to
+    // the subscribers
+    HServerStateVariable* sv = stateVariables().value("RegisteredClientCount");
+    Q_ASSERT(sv);
+
+    sv->setValue(sv->value().toUInt() + 1);
+    return UpnpSuccess;
+}
+
+qint32 HTestService::chargenAction(
+    const HActionArguments& inArgs, HActionArguments* outArgs)
+{
+    qint32 charCount = inArgs["Count"].value().toInt();
+    (*outArgs)["Characters"].setValue(QString(charCount, 'z'));
+    return UpnpSuccess;
+}
+
+/*******************************************************************************
+ * HTestDevice
+ *******************************************************************************/
+HTestDevice::HTestDevice() :
+    HServerDevice()
+{
+}
+
+HTestDevice::~HTestDevice()
+{
+}
+
+/*******************************************************************************
+ * HTestDeviceCreator
+ *******************************************************************************/
+HTestDeviceCreator* HTestDeviceCreator::newInstance() const
+{
+    return new HTestDeviceCreator();
+}
+
+HServerDevice* HTestDeviceCreator::createDevice(const HDeviceInfo& info) const
+{
+    if (info.deviceType().toString() == "urn:herqq-org:device:HTestDevice:1")
+    {
+        return new HTestDevice();
+    }
+
+    return 0;
+}
+
+HServerService* HTestDeviceCreator::createService(
+    const HServiceInfo& serviceInfo, const HDeviceInfo&) const
+{
+    if (serviceInfo.serviceType().toString() ==
+        "urn:herqq-org:service:HTestService:1")
+    {
+        return new HTestService();
+    }
+
+    return 0;
+}
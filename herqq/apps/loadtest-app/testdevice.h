@@ -0,0 +1,99 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of an application named HUpnpLoadTestApp
+ *  used for measuring the performance of the Herqq UPnP (HUPnP) library.
+ *
+ *  HUpnpLoadTestApp is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  HUpnpLoadTestApp is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with HUpnpLoadTestApp. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TESTDEVICE_H
+#define TESTDEVICE_H
+
+#include <HUpnpCore/HUpnp>
+#include <HUpnpCore/HServerDevice>
+#include <HUpnpCore/HServerService>
+#include <HUpnpCore/HDeviceModelCreator>
+
+//
+// The service of the test device of the HUpnpSimpleTestApp. The actions do
+// nothing besides what the protocol requires, so that the measurements
+// reflect the cost of HUPnP rather than that of the actions.
+//
+class HTestService :
+    public Herqq::Upnp::HServerService
+{
+Q_OBJECT
+Q_DISABLE_COPY(HTestService)
+
+private:
+
+    virtual HActionInvokes createActionInvokes();
+
+public:
+
+    HTestService();
+    virtual ~HTestService();
+
+    qint32 echoAction(
+        const Herqq::Upnp::HActionArguments& inArgs,
+        Herqq::Upnp::HActionArguments* outArgs = 0);
+
+    qint32 registerAction(
+        const Herqq::Upnp::HActionArguments& inArgs,
+        Herqq::Upnp::HActionArguments* outArgs = 0);
+
+    qint32 chargenAction(
+        const Herqq::Upnp::HActionArguments& inArgs,
+        Herqq::Upnp::HActionArguments* outArgs = 0);
+};
+
+//
+// The test device, which contains only the test service
+//
+class HTestDevice :
+    public Herqq::Upnp::HServerDevice
+{
+Q_OBJECT
+Q_DISABLE_COPY(HTestDevice)
+
+public:
+
+    HTestDevice();
+    virtual ~HTestDevice();
+};
+
+//
+// Creates the test device and its service for the device host
+//
+class HTestDeviceCreator :
+    public Herqq::Upnp::HDeviceModelCreator
+{
+protected:
+
+    virtual HTestDeviceCreator* newInstance() const;
+
+public:
+
+    virtual Herqq::Upnp::HServerDevice* createDevice(
+        const Herqq::Upnp::HDeviceInfo& info) const;
+
+    virtual Herqq::Upnp::HServerService* createService(
+        const Herqq::Upnp::HServiceInfo& serviceInfo,
+        const Herqq::Upnp::HDeviceInfo& parentDeviceInfo) const;
+};
+
+#endif // TESTDEVICE_H
@@ -0,0 +1,468 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of an application named HUpnpLoadTestApp
+ *  used for measuring the performance of the Herqq UPnP (HUPnP) library.
+ *
+ *  HUpnpLoadTestApp is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  HUpnpLoadTestApp is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with HUpnpLoadTestApp. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "trafficreplay.h"
+#include "httpmessage.h"
+
+#include <HUpnpCore/HEndpoint>
+#include <HUpnpCore/HTrafficCaptureReader>
+
+#include <QtCore/QtAlgorithms>
+#include <QtCore/QTextStream>
+#include <QtNetwork/QUdpSocket>
+#include <QtNetwork/QTcpSocket>
+
+using namespace Herqq::Upnp;
+
+namespace
+{
+qint64 percentile(const QVector<qint64>& sorted, qint32 permille)
+{
+    if (sorted.isEmpty())
+    {
+        return 0;
+    }
+
+    return sorted.at((permille * (sorted.size() - 1)) / 1000);
+}
+
+QString msecs(qint64 usecs)
+{
+    return QString::number(usecs / 1000.0, 'f', 3);
+}
+
+bool isSuccess(const QByteArray& responseHeader)
+{
+    qint32 status = responseHeader.mid(9, 3).toInt();
+    return status >= 200 && status < 300;
+}
+}
+
+/*******************************************************************************
+ * ReplayConnection
+ *******************************************************************************/
+ReplayConnection::ReplayConnection(TrafficReplay* owner) :
+    QObject(owner),
+        m_owner(owner), m_socket(new QTcpSocket(this)), m_due(), m_buffer(),
+        m_timer(), m_waiting(false)
+{
+    bool ok = connect(m_socket, SIGNAL(connected()), this, SLOT(connected()));
+    Q_ASSERT(ok); Q_UNUSED(ok)
+
+    ok = connect(m_socket, SIGNAL(readyRead()), this, SLOT(readyRead()));
+    Q_ASSERT(ok);
+
+    ok = connect(
+        m_socket, SIGNAL(disconnected()), this, SLOT(disconnected()));
+    Q_ASSERT(ok);
+
+    ok = connect(
+        m_socket, SIGNAL(error(QAbstractSocket::SocketError)),
+        this, SLOT(error(QAbstractSocket::SocketError)));
+    Q_ASSERT(ok);
+}
+
+ReplayConnection::~ReplayConnection()
+{
+}
+
+void ReplayConnection::enqueue(const QByteArray& request)
+{
+    m_due.enqueue(request);
+
+    if (m_socket->state() == QAbstractSocket::UnconnectedState)
+    {
+        m_socket->connectToHost(m_owner->m_targetHost, m_owner->m_targetPort);
+    }
+    else
+    {
+        sendNext();
+    }
+}
+
+void ReplayConnection::sendNext()
+{
+    if (m_waiting || m_due.isEmpty() ||
+        m_socket->state() != QAbstractSocket::ConnectedState)
+    {
+        return;
+    }
+
+    m_buffer.clear();
+    m_waiting = true;
+    m_timer.start();
+    m_socket->write(m_due.dequeue());
+}
+
+void ReplayConnection::connected()
+{
+    sendNext();
+}
+
+void ReplayConnection::readyRead()
+{
+    m_buffer.append(m_socket->readAll());
+
+    QByteArray header;
+    if (!m_waiting || !takeMessage(&m_buffer, &header))
+    {
+        return;
+    }
+
+    m_waiting = false;
+    m_owner->completed(m_timer.nsecsElapsed() / 1000, isSuccess(header));
+
+    if (fieldValue(header, "connection").toLower() == "close")
+    {
+        // the next request is sent once the connection is opened again
+        m_socket->disconnectFromHost();
+    }
+    else
+    {
+        sendNext();
+    }
+
+    m_owner->checkFinished();
+}
+
+void ReplayConnection::disconnected()
+{
+    if (m_waiting)
+    {
+        m_waiting = false;
+        m_owner->completed(m_timer.nsecsElapsed() / 1000, false);
+    }
+
+    if (!m_due.isEmpty())
+    {
+        m_socket->connectToHost(m_owner->m_targetHost, m_owner->m_targetPort);
+    }
+
+    m_owner->checkFinished();
+}
+
+void ReplayConnection::error(QAbstractSocket::SocketError)
+{
+    if (m_waiting || m_socket->state() != QAbstractSocket::UnconnectedState)
+    {
+        // disconnected() is emitted as well
+        return;
+    }
+
+    // the connection could not be opened, which fails the requests
+    // that were waiting for it
+    while(!m_due.isEmpty())
+    {
+        m_due.dequeue();
+        m_owner->completed(0, false);
+    }
+
+    m_owner->checkFinished();
+}
+
+/*******************************************************************************
+ * TrafficReplay
+ *******************************************************************************/
+TrafficReplay::TrafficReplay(
+    const QHostAddress& targetHost, quint16 targetPort, double speed) :
+        m_targetHost(targetHost), m_targetPort(targetPort),
+        m_speed(qMax(0.0, speed)), m_messages(), m_next(0),
+        m_connectionCount(0), m_connections(), m_ssdp(0), m_searches(),
+        m_timer(), m_drain(), m_elapsed(), m_elapsedMsecs(0), m_ssdpSent(0),
+        m_searchesSent(0), m_searchLatencies(), m_httpLatencies(),
+        m_httpFailures(0), m_skipped(0)
+{
+    m_timer.setSingleShot(true);
+    bool ok = connect(&m_timer, SIGNAL(timeout()), this, SLOT(sendDue()));
+    Q_ASSERT(ok); Q_UNUSED(ok)
+
+    // the responses to the last discovery requests may be delayed by up to
+    // the MX time the requests specified
+    m_drain.setSingleShot(true);
+    m_drain.setInterval(5000);
+    ok = connect(&m_drain, SIGNAL(timeout()), this, SLOT(stop()));
+    Q_ASSERT(ok);
+}
+
+TrafficReplay::~TrafficReplay()
+{
+}
+
+bool TrafficReplay::load(QIODevice* dev)
+{
+    HTrafficCaptureReader reader(dev);
+    if (!reader.isValid())
+    {
+        return false;
+    }
+
+    QHash<QString, qint32> connections;
+    qint64 first = -1;
+
+    while(reader.readNext())
+    {
+        if (reader.direction() != HTrafficCaptureReader::Inbound)
+        {
+            continue;
+        }
+
+        QByteArray data = reader.data();
+        if (data.size() != reader.size())
+        {
+            ++m_skipped;
+            continue;
+        }
+
+        Message msg;
+        msg.m_connection = -1;
+        if (reader.protocol() == HTrafficCaptureReader::Http)
+        {
+            if (data.startsWith("HTTP/"))
+            {
+                // a response to a request of the captured process, which the
+                // target sends itself
+                continue;
+            }
+
+            QString key = QString("%1-%2").arg(
+                reader.localEndpoint().toString(), reader.peer().toString());
+
+            QHash<QString, qint32>::const_iterator it =
+                connections.constFind(key);
+
+            msg.m_connection = it != connections.constEnd() ?
+                it.value() :
+                connections.insert(key, connections.size()).value();
+
+            data = rewriteHost(data);
+        }
+
+        if (first < 0)
+        {
+            first = reader.timestamp();
+        }
+
+        msg.m_time = reader.timestamp() - first;
+        msg.m_data = data;
+        m_messages.append(msg);
+    }
+
+    m_connectionCount = connections.size();
+    return true;
+}
+
+QByteArray TrafficReplay::rewriteHost(const QByteArray& request) const
+{
+    qint32 headerEnd = request.indexOf("\r\n\r\n");
+    qint32 index = request.left(headerEnd).toLower().indexOf("\r\nhost:");
+    if (index < 0)
+    {
+        return request;
+    }
+
+    index += 7;
+    QByteArray retVal = request;
+    retVal.replace(
+        index, retVal.indexOf("\r\n", index) - index,
+        QString(" %1:%2").arg(
+            m_targetHost.toString(), QString::number(m_targetPort)).toUtf8());
+
+    return retVal;
+}
+
+void TrafficReplay::start()
+{
+    m_ssdp = new QUdpSocket(this);
+    m_ssdp->bind(QHostAddress::Any, 0);
+
+    bool ok = connect(m_ssdp, SIGNAL(readyRead()), this, SLOT(ssdpReceived()));
+    Q_ASSERT(ok); Q_UNUSED(ok)
+
+    for(qint32 i = 0; i < m_connectionCount; ++i)
+    {
+        m_connections.append(new ReplayConnection(this));
+    }
+
+    m_elapsed.start();
+    sendDue();
+}
+
+void TrafficReplay::sendDue()
+{
+    qint64 elapsed = now();
+
+    for(; m_next < m_messages.size(); ++m_next)
+    {
+        const Message& msg = m_messages.at(m_next);
+        if (m_speed > 0 && msg.m_time > elapsed * m_speed)
+        {
+            break;
+        }
+
+        if (msg.m_connection >= 0)
+        {
+            m_connections.at(msg.m_connection)->enqueue(msg.m_data);
+            continue;
+        }
+
+        // the SSDP messages are sent to the port the target listens to for
+        // both the multicast and the unicast discovery requests
+        m_ssdp->writeDatagram(msg.m_data, m_targetHost, 1900);
+        ++m_ssdpSent;
+
+        if (msg.m_data.startsWith("M-SEARCH"))
+        {
+            Search search = { elapsed, fieldValue(msg.m_data, "st") };
+            m_searches.append(search);
+            ++m_searchesSent;
+        }
+    }
+
+    if (m_next < m_messages.size())
+    {
+        qint64 wait = m_messages.at(m_next).m_time / m_speed - elapsed;
+        m_timer.start(static_cast<qint32>(qMax(Q_INT64_C(0), wait / 1000)));
+    }
+    else
+    {
+        checkFinished();
+    }
+}
+
+void TrafficReplay::ssdpReceived()
+{
+    while(m_ssdp->hasPendingDatagrams())
+    {
+        QByteArray datagram;
+        datagram.resize(static_cast<qint32>(m_ssdp->pendingDatagramSize()));
+        m_ssdp->readDatagram(datagram.data(), datagram.size());
+
+        if (!datagram.startsWith("HTTP/1.1 200"))
+        {
+            continue;
+        }
+
+        // a response answers the oldest search for its type. only the
+        // first response to a search is timed, since the rest are spread
+        // over the MX time the search allowed
+        QByteArray st = fieldValue(datagram, "st");
+        for(qint32 i = 0; i < m_searches.size(); ++i)
+        {
+            const Search& search = m_searches.at(i);
+            if (search.m_st == st || search.m_st == "ssdp:all")
+            {
+                m_searchLatencies.append(now() - search.m_sentAt);
+                m_searches.removeAt(i);
+                break;
+            }
+        }
+    }
+}
+
+void TrafficReplay::completed(qint64 usecs, bool succeeded)
+{
+    if (succeeded)
+    {
+        m_httpLatencies.append(usecs);
+    }
+    else
+    {
+        ++m_httpFailures;
+    }
+}
+
+void TrafficReplay::checkFinished()
+{
+    if (m_next < m_messages.size() || m_drain.isActive())
+    {
+        return;
+    }
+
+    foreach(const ReplayConnection* connection, m_connections)
+    {
+        if (!connection->isIdle())
+        {
+            return;
+        }
+    }
+
+    m_elapsedMsecs = m_elapsed.elapsed();
+    if (m_searches.isEmpty())
+    {
+        stop();
+    }
+    else
+    {
+        m_drain.start();
+    }
+}
+
+void TrafficReplay::stop()
+{
+    m_timer.stop();
+    m_drain.stop();
+    emit finished();
+}
+
+void TrafficReplay::report(QTextStream& out) const
+{
+    double secs = qMax<qint64>(1, m_elapsedMsecs) / 1000.0;
+
+    out << "replayed: " << m_messages.size() << " messages, "
+        << m_connectionCount << " HTTP connections, speed: "
+        << (m_speed > 0 ? QString::number(m_speed) : QString("max"))
+        << ", duration: " << secs << " s\n";
+
+    if (m_skipped)
+    {
+        out << "skipped: " << m_skipped
+            << " messages that were not captured in full\n";
+    }
+
+    out << "\n" << QString("%1%2%3%4%5%6%7\n").arg(
+        "traffic", -12).arg("count", 10).arg("failed", 10).arg("msg/s", 10).
+        arg("p50 ms", 10).arg("p99 ms", 10).arg("p99.9 ms", 10);
+
+    QVector<qint64> sorted = m_httpLatencies;
+    qSort(sorted);
+
+    out << QString("%1%2%3%4%5%6%7\n").arg("http", -12).
+        arg(sorted.size(), 10).arg(m_httpFailures, 10).
+        arg(QString::number(sorted.size() / secs, 'f', 1), 10).
+        arg(msecs(percentile(sorted, 500)), 10).
+        arg(msecs(percentile(sorted, 990)), 10).
+        arg(msecs(percentile(sorted, 999)), 10);
+
+    sorted = m_searchLatencies;
+    qSort(sorted);
+
+    out << QString("%1%2%3%4%5%6%7\n").arg("m-search", -12).
+        arg(m_searchesSent, 10).arg(m_searches.size(), 10).
+        arg(QString::number(m_searchesSent / secs, 'f', 1), 10).
+        arg(msecs(percentile(sorted, 500)), 10).
+        arg(msecs(percentile(sorted, 990)), 10).
+        arg(msecs(percentile(sorted, 999)), 10);
+
+    out << "\nssdp: " << m_ssdpSent << " datagrams sent, "
+        << QString::number(m_ssdpSent / secs, 'f', 1) << " per second. "
+        << "The unanswered searches are counted as failed.\n";
+}
@@ -0,0 +1,199 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of an application named HUpnpLoadTestApp
+ *  used for measuring the performance of the Herqq UPnP (HUPnP) library.
+ *
+ *  HUpnpLoadTestApp is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  HUpnpLoadTestApp is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with HUpnpLoadTestApp. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRAFFICREPLAY_H
+#define TRAFFICREPLAY_H
+
+#include <QtCore/QList>
+#include <QtCore/QQueue>
+#include <QtCore/QTimer>
+#include <QtCore/QObject>
+#include <QtCore/QVector>
+#include <QtCore/QByteArray>
+#include <QtCore/QElapsedTimer>
+#include <QtNetwork/QHostAddress>
+#include <QtNetwork/QAbstractSocket>
+
+class QIODevice;
+class QUdpSocket;
+class QTcpSocket;
+class QTextStream;
+
+class TrafficReplay;
+
+//
+// Replays the HTTP requests a single connection carried in the capture.
+// The requests are sent in order over a connection of its own and the next
+// one is sent only after the previous one has been answered, which is how
+// the original client sent them.
+//
+class ReplayConnection :
+    public QObject
+{
+Q_OBJECT
+Q_DISABLE_COPY(ReplayConnection)
+
+private:
+
+    TrafficReplay* m_owner;
+    QTcpSocket* m_socket;
+
+    QQueue<QByteArray> m_due;
+    // the requests whose time has come, oldest first
+
+    QByteArray m_buffer;
+    // the data of the response received so far
+
+    QElapsedTimer m_timer;
+    bool m_waiting;
+    // the start time of the request in progress and whether a response
+    // is expected
+
+    void sendNext();
+
+private Q_SLOTS:
+
+    void connected();
+    void readyRead();
+    void disconnected();
+    void error(QAbstractSocket::SocketError);
+
+public:
+
+    explicit ReplayConnection(TrafficReplay* owner);
+    virtual ~ReplayConnection();
+
+    void enqueue(const QByteArray& request);
+
+    inline bool isIdle() const { return m_due.isEmpty() && !m_waiting; }
+};
+
+//
+// Feeds the traffic captured with HTrafficCapture back into a device host or
+// a control point. Only the messages the captured process received are
+// replayed, since the target produces the rest itself:
+// - the SSDP datagrams are sent to the SSDP port of the target. The first
+//   response to each M-SEARCH is timed.
+// - the HTTP requests are sent to the HTTP endpoint of the target with their
+//   HOST fields rewritten. Every captured connection is replayed over
+//   a connection of its own and every request is timed until the response
+//   has been received.
+//
+// The messages are sent at the pace they were captured, divided by the speed.
+// A speed of zero sends every message as soon as possible, in which case
+// the rate of the HTTP requests is limited only by the target.
+//
+class TrafficReplay :
+    public QObject
+{
+Q_OBJECT
+Q_DISABLE_COPY(TrafficReplay)
+friend class ReplayConnection;
+
+private:
+
+    struct Message
+    {
+        qint64 m_time;
+        // in microseconds since the first replayed message was captured
+
+        qint32 m_connection;
+        // the index of the connection of an HTTP request, or -1 for SSDP
+
+        QByteArray m_data;
+    };
+
+    QHostAddress m_targetHost;
+    quint16 m_targetPort;
+    double m_speed;
+
+    QList<Message> m_messages;
+    qint32 m_next;
+    // the next message to be sent
+
+    qint32 m_connectionCount;
+    QList<ReplayConnection*> m_connections;
+
+    struct Search
+    {
+        qint64 m_sentAt;
+        // in microseconds since the replay was started
+
+        QByteArray m_st;
+    };
+
+    QUdpSocket* m_ssdp;
+    QList<Search> m_searches;
+    // the M-SEARCH requests that have not been answered, oldest first
+
+    QTimer m_timer;
+    QTimer m_drain;
+    QElapsedTimer m_elapsed;
+    qint64 m_elapsedMsecs;
+
+    qint64 m_ssdpSent;
+    qint64 m_searchesSent;
+    QVector<qint64> m_searchLatencies;
+    QVector<qint64> m_httpLatencies;
+    qint64 m_httpFailures;
+    // the latencies are in microseconds
+
+    qint32 m_skipped;
+    // the messages left out because the capture did not contain them in full
+
+    QByteArray rewriteHost(const QByteArray& request) const;
+    inline qint64 now() const { return m_elapsed.nsecsElapsed() / 1000; }
+
+    void completed(qint64 usecs, bool succeeded);
+    void checkFinished();
+
+private Q_SLOTS:
+
+    void sendDue();
+    void ssdpReceived();
+    void stop();
+
+public:
+
+    TrafficReplay(
+        const QHostAddress& targetHost, quint16 targetPort, double speed);
+
+    virtual ~TrafficReplay();
+
+    // reads the messages to be replayed. returns false in case the device
+    // does not contain a capture
+    bool load(QIODevice*);
+
+    inline qint32 messageCount() const { return m_messages.size(); }
+
+    void report(QTextStream& out) const;
+
+public Q_SLOTS:
+
+    void start();
+
+Q_SIGNALS:
+
+    void finished();
+};
+
+#endif // TRAFFICREPLAY_H
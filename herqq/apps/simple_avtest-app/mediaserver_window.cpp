@@ -82,8 +82,11 @@ MediaServerWindow::MediaServerWindow(QWidget *parent) :
     hostConfiguration.setDeviceModelCreator(creator);
     hostConfiguration.add(config);
 
-    // 6) Initialize the HDeviceHost.
+    // 6) Initialize the HDeviceHost. The data source adds the scanned
+    // content using the scheduler of the host, so that the host keeps
+    // answering the network requests while large directories are added.
     m_deviceHost = new HDeviceHost(this);
+    m_datasource->setTaskScheduler(m_deviceHost->taskScheduler());
     if (!m_deviceHost->init(hostConfiguration))
     {
         Q_ASSERT_X(false, "", m_deviceHost->errorDescription().toLocal8Bit());
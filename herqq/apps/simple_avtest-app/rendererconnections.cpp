@@ -25,6 +25,7 @@
 #include <HUpnpAv/HDuration>
 #include <HUpnpAv/HSeekInfo>
 #include <HUpnpAv/HMediaInfo>
+#include <HUpnpAv/HMediaFetcher>
 #include <HUpnpAv/HTransportState>
 
 #include <QtCore/QUrl>
@@ -193,10 +194,18 @@ qint32 RendererConnectionForImagesAndText::doSetResource(
     Q_UNUSED(resourceUri)
     Q_UNUSED(cdsObjectData)
 
-    QNetworkRequest req(resourceUri);
-    m_currentResource = m_nam.get(req);
-    bool ok = connect(m_currentResource, SIGNAL(finished()), this, SLOT(finished()));
-    Q_ASSERT(ok); Q_UNUSED(ok)
+    // the resource may have been prefetched as the next resource, in which
+    // case the download may have completed already
+    m_currentResource = mediaFetcher()->open(resourceUri);
+    if (m_currentResource->isFinished())
+    {
+        QMetaObject::invokeMethod(this, "finished", Qt::QueuedConnection);
+    }
+    else
+    {
+        bool ok = connect(m_currentResource, SIGNAL(finished()), this, SLOT(finished()));
+        Q_ASSERT(ok); Q_UNUSED(ok)
+    }
 
     return UpnpSuccess;
 }
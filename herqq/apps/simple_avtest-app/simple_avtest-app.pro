@@ -8,17 +8,9 @@ INCLUDEPATH += \
     ../../hupnp_av/include/
 
 LIBS += -L"../../hupnp/bin" -lHUpnp \
-        -L"../../hupnp_av/bin" -lHUpnpAv \
-        -L"../../hupnp/lib/qtsoap-2.7-opensource/lib"
+        -L"../../hupnp_av/bin" -lHUpnpAv
 
 win32 {
-    debug {
-        LIBS += -lQtSolutions_SOAP-2.7d
-    }
-    else {
-        LIBS += -lQtSolutions_SOAP-2.7
-    }
-
     LIBS += -lws2_32
 
     DESCRIPTIONS = $$PWD\\descriptions
@@ -28,7 +20,6 @@ win32 {
     QMAKE_POST_LINK += copy ..\\..\\hupnp_av\\bin\\* bin /Y
 }
 else {
-    LIBS += -lQtSolutions_SOAP-2.7
     !macx:QMAKE_LFLAGS += -Wl,--rpath=\\\$\$ORIGIN
 
     QMAKE_POST_LINK += cp -Rf $$PWD/descriptions bin/descriptions &
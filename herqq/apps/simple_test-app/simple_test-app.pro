@@ -5,17 +5,9 @@ CONFIG  += warn_on
 
 INCLUDEPATH += ../../hupnp/include
 
-LIBS += -L"../../hupnp/bin" -lHUpnp \
-        -L"../../hupnp/lib/qtsoap-2.7-opensource/lib"
+LIBS += -L"../../hupnp/bin" -lHUpnp
 
 win32 {
-    debug {
-        LIBS += -lQtSolutions_SOAP-2.7d
-    }
-    else {
-        LIBS += -lQtSolutions_SOAP-2.7
-    }
-
     LIBS += -lws2_32
 
     DESCRIPTIONS = $$PWD\\descriptions
@@ -24,7 +16,6 @@ win32 {
     QMAKE_POST_LINK += copy ..\\..\\hupnp\\bin\\* bin /Y
 }
 else {
-    LIBS += -lQtSolutions_SOAP-2.7
     !macx:QMAKE_LFLAGS += -Wl,--rpath=\\\$\$ORIGIN
 
     QMAKE_POST_LINK += cp -Rf $$PWD/descriptions bin &
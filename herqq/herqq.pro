@@ -22,6 +22,10 @@ exists(hupnp_av/options.pri) {
 CONFIG(DISABLE_QTSOAP) {
     system(echo "CONFIG += DISABLE_QTSOAP" > hupnp/options.pri)
 }
+CONFIG(DISABLE_TRACE) {
+    system(echo "CONFIG += DISABLE_TRACE" >> hupnp/options.pri)
+    system(echo "CONFIG += DISABLE_TRACE" >> hupnp_av/options.pri)
+}
 CONFIG(USE_QT_INSTALL_LOC) {
     system(echo "CONFIG += USE_QT_INSTALL_LOC" >> hupnp/options.pri)
 	system(echo "CONFIG += USE_QT_INSTALL_LOC" >> hupnp_av/options.pri)
@@ -31,3 +35,6 @@ CONFIG(USE_QT_INSTALL_LOC) {
 !CONFIG(DISABLE_AV) : SUBDIRS += hupnp_av
 !CONFIG(DISABLE_TESTAPP) : SUBDIRS += apps/simple_test-app
 !CONFIG(DISABLE_AVTESTAPP) : SUBDIRS += apps/simple_avtest-app
+!CONFIG(DISABLE_LOADTESTAPP) : SUBDIRS += apps/loadtest-app
+!CONFIG(DISABLE_AVLOADTESTAPP) : SUBDIRS += apps/avloadtest-app
+!CONFIG(DISABLE_HTTPBENCHAPP) : SUBDIRS += apps/httpbench-app
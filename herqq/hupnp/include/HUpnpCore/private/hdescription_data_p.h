@@ -0,0 +1 @@
+#include "../../../src/devicemodel/hdescription_data_p.h"
@@ -0,0 +1 @@
+#include "../../../src/devicehosting/messages/hevent_messages_p.h"
@@ -0,0 +1 @@
+#include "../../../src/http/hhttp_utils_p.h"
@@ -0,0 +1 @@
+#include "../../../src/general/hmemoryaccount_p.h"
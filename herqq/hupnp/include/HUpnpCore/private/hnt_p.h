@@ -0,0 +1 @@
+#include "../../../src/devicehosting/messages/hnt_p.h"
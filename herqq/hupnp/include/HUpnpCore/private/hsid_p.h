@@ -0,0 +1 @@
+#include "../../../src/devicehosting/messages/hsid_p.h"
@@ -0,0 +1 @@
+#include "../../../src/http/hsoap_p.h"
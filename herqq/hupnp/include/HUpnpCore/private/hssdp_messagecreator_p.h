@@ -0,0 +1 @@
+#include "../../../src/ssdp/hssdp_messagecreator_p.h"
@@ -0,0 +1 @@
+#include "../../../src/ssdp/hssdp_p.h"
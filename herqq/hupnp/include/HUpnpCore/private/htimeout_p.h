@@ -0,0 +1 @@
+#include "../../../src/devicehosting/messages/htimeout_p.h"
@@ -0,0 +1 @@
+#include "../../../src/utils/htimerwheel_p.h"
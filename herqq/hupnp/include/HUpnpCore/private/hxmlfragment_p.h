@@ -0,0 +1 @@
+#include "../../../src/general/hxmlfragment_p.h"
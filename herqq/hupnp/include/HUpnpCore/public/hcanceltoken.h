@@ -0,0 +1 @@
+#include "../../../src/devicemodel/hcanceltoken.h"
@@ -0,0 +1 @@
+#include "../../../src/devicemodel/client/hclientbatchop.h"
@@ -0,0 +1 @@
+#include "../../../src/general/hmemoryusage.h"
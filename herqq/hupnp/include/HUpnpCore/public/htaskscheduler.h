@@ -0,0 +1 @@
+#include "../../../src/devicehosting/devicehost/htaskscheduler.h"
@@ -0,0 +1 @@
+#include "../../../src/general/htracing.h"
@@ -0,0 +1 @@
+#include "../../../src/devicemodel/server/htypedstatevariable.h"
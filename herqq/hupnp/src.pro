@@ -10,34 +10,18 @@ exists(options.pri) {
     include(options.pri)
 }
 
-INCLUDEPATH += ./include/
+CONFIG(DISABLE_TRACE) : DEFINES += HUPNP_NO_TRACE
 
-CONFIG(DISABLE_QTSOAP) {
-    INCLUDEPATH += $$[QT_INSTALL_HEADERS]/QtSoap
-}
-else {
-    INCLUDEPATH += ./lib/qtsoap-2.7-opensource/src
-}
+INCLUDEPATH += ./include/
 
 LIBS += -L"./bin/"
-!CONFIG(DISABLE_QTSOAP): LIBS += -L"./lib/qtsoap-2.7-opensource/lib"
 
 debug:DEFINES += DEBUG
 
 win32 {
-    debug {
-        LIBS += -lQtSolutions_SOAP-2.7d
-    }
-    else {
-        LIBS += -lQtSolutions_SOAP-2.7
-    }
-
     LIBS += -lws2_32
     TARGET_EXT = .dll
 }
-else {
-    LIBS += -lQtSolutions_SOAP-2.7
-}
 
 OBJECTS_DIR = obj
 DESTDIR     = ./bin
@@ -57,15 +41,6 @@ include (src/devicemodel/devicemodel.pri)
 include (src/dataelements/dataelements.pri)
 include (src/devicehosting/devicehosting.pri)
 
-!CONFIG(DISABLE_QTSOAP) {
-    win32 {
-        QMAKE_POST_LINK += copy lib\\qtsoap-2.7-opensource\\lib\\* bin /Y
-    }
-    else {
-        QMAKE_POST_LINK += cp -fR ./lib/qtsoap-2.7-opensource/lib/* ./bin/
-    }
-}
-
 CONFIG(USE_QT_INSTALL_LOC) {
     INSTLOC_INC = $$[QT_INSTALL_HEADERS]/HUpnpCore
     INSTLOC_LIB = $$[QT_INSTALL_LIBS]
@@ -9,6 +9,7 @@ HEADERS += \
     $$SRC_LOC/dataelements/hserviceid.h \
     $$SRC_LOC/dataelements/hudn.h \
     $$SRC_LOC/dataelements/hresourcetype.h \
+    $$SRC_LOC/dataelements/hresourcetype_p.h \
     $$SRC_LOC/dataelements/hproduct_tokens.h \
     $$SRC_LOC/dataelements/hdiscoverytype.h \
     $$SRC_LOC/dataelements/hstatevariableinfo.h \
@@ -362,6 +362,17 @@ HDiscoveryType HDiscoveryType::createDiscoveryTypeForAllResources()
 
 bool operator==(const HDiscoveryType& obj1, const HDiscoveryType& obj2)
 {
+    // copies share the data and the contents determine the type, which
+    // settle most comparisons before the strings are compared
+    if (obj1.h_ptr == obj2.h_ptr)
+    {
+        return true;
+    }
+    else if (obj1.h_ptr->m_type != obj2.h_ptr->m_type)
+    {
+        return false;
+    }
+
     return obj1.h_ptr->m_contents == obj2.h_ptr->m_contents;
 }
 
@@ -23,8 +23,10 @@
 
 #include "../general/hlogger_p.h"
 
+#include <QtCore/QMutex>
 #include <QtCore/QRegExp>
 #include <QtCore/QVector>
+#include <QtCore/QAtomicInt>
 
 namespace Herqq
 {
@@ -309,13 +311,40 @@ public:
 
     HProductTokensPrivate() :
         m_upnpTokenIndex(-1), m_dlnaTokenIndex(-1),
-        m_originalTokenString(), m_productTokens()
+        m_originalTokenString(), m_productTokens(), m_tokenized(1)
     {
     }
 
     HProductTokensPrivate(const QString& tokens) :
         m_upnpTokenIndex(-1), m_dlnaTokenIndex(-1),
-        m_originalTokenString(tokens.simplified()), m_productTokens()
+        m_originalTokenString(tokens.simplified()), m_productTokens(),
+        m_tokenized(0)
+    {
+    }
+
+    // parses the token string unless that has been done already
+    inline void tokenize() const
+    {
+        if (!m_tokenized.fetchAndAddOrdered(0))
+        {
+            QMutexLocker lock(&s_tokenizeMutex);
+            if (!m_tokenized.fetchAndAddOrdered(0))
+            {
+                const_cast<HProductTokensPrivate*>(this)->doTokenize();
+                m_tokenized.fetchAndStoreOrdered(1);
+            }
+        }
+    }
+
+private:
+
+    mutable QAtomicInt m_tokenized;
+    // the instances are shared between threads, which may ask for the
+    // tokens of the same instance at the same time
+
+    static QMutex s_tokenizeMutex;
+
+    void doTokenize()
     {
         HLOG(H_AT, H_FUN);
 
@@ -336,7 +365,7 @@ public:
             {
                 HLOG_WARN_NONSTD(QString(
                     "Comma should not be used as a delimiter in "
-                    "product tokens: [%1]").arg(tokens));
+                    "product tokens: [%1]").arg(m_originalTokenString));
 
                 return;
             }
@@ -384,6 +413,7 @@ public:
     }
 };
 
+QMutex HProductTokensPrivate::s_tokenizeMutex;
 
 /*******************************************************************************
  * HProductTokens
@@ -417,11 +447,13 @@ HProductTokens::~HProductTokens()
 
 bool HProductTokens::hasUpnpToken() const
 {
+    h_ptr->tokenize();
     return h_ptr->m_upnpTokenIndex >= 0;
 }
 
 bool HProductTokens::hasDlnaDocToken() const
 {
+    h_ptr->tokenize();
     return h_ptr->m_dlnaTokenIndex >= 0;
 }
 
@@ -432,18 +464,21 @@ bool HProductTokens::isEmpty() const
 
 HProductToken HProductTokens::upnpToken() const
 {
+    h_ptr->tokenize();
     return h_ptr->m_upnpTokenIndex >= 0 ?
                h_ptr->m_productTokens[h_ptr->m_upnpTokenIndex] : HProductToken();
 }
 
 HProductToken HProductTokens::dlnaDocToken() const
 {
+    h_ptr->tokenize();
     return h_ptr->m_dlnaTokenIndex >= 0 ?
                h_ptr->m_productTokens[h_ptr->m_dlnaTokenIndex] : HProductToken();
 }
 
 QVector<HProductToken> HProductTokens::tokens() const
 {
+    h_ptr->tokenize();
     return h_ptr->m_productTokens;
 }
 
@@ -238,6 +238,10 @@ class HProductTokensPrivate;
  * instances, but you can retrieve the full unparsed product tokens string using
  * toString().
  *
+ * The string is parsed only when the tokens are first needed, which means
+ * that copying and storing the product tokens of the received messages is
+ * cheap and most of them are never parsed at all.
+ *
  * \headerfile hproduct_tokens.h HProductTokens
  *
  * \remarks This class is not thread-safe.
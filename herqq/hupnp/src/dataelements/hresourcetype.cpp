@@ -20,9 +20,11 @@
  */
 
 #include "hresourcetype.h"
+#include "hresourcetype_p.h"
 #include "../utils/hmisc_utils_p.h"
 
 #include <QtCore/QByteArray>
+#include <QtCore/QMutexLocker>
 
 namespace Herqq
 {
@@ -30,31 +32,38 @@ namespace Herqq
 namespace Upnp
 {
 
-HResourceType::HResourceType() :
-    m_type(Undefined), m_resourceElements()
+namespace
+{
+// the maximum number of resource types and resource type strings interned
+const qint32 MaxInternedTypes = 4096;
+const qint32 MaxInternedStrings = 8192;
+
+quint32 hashOf(const QString& str)
 {
+    QByteArray data = str.toLocal8Bit();
+    return hash(data.constData(), data.size());
 }
 
-HResourceType::HResourceType(const QString& resourceTypeAsStr) :
-    m_type(Undefined), m_resourceElements()
+HResourceType::Type parseResourceType(
+    const QString& resourceTypeAsStr, QStringList* resourceElements)
 {
     qint32 flags = 0;
 
     QStringList tmp = resourceTypeAsStr.simplified().split(":");
     if (tmp.size() != 5)
     {
-        return;
+        return HResourceType::Undefined;
     }
 
     if (tmp[0] != "urn")
     {
-        return;
+        return HResourceType::Undefined;
     }
 
     tmp[1] = tmp[1].simplified();
     if (tmp[1].isEmpty())
     {
-        return;
+        return HResourceType::Undefined;
     }
     if (tmp[1].compare("schemas-upnp-org") != 0)
     {
@@ -77,42 +86,174 @@ HResourceType::HResourceType(const QString& resourceTypeAsStr) :
     }
     else
     {
-        return;
+        return HResourceType::Undefined;
     }
 
     tmp[3] = tmp[3].simplified();
     if (tmp[3].isEmpty())
     {
-        return;
+        return HResourceType::Undefined;
     }
 
     bool ok = false;
     tmp[4].toInt(&ok);
     if (!ok)
     {
-        return;
+        return HResourceType::Undefined;
     }
 
+    *resourceElements = tmp;
+
     switch(flags)
     {
     case 0x05:
-        m_type = VendorSpecifiedDeviceType;
-        break;
+        return HResourceType::VendorSpecifiedDeviceType;
     case 0x06:
-        m_type = StandardDeviceType;
-        break;
+        return HResourceType::StandardDeviceType;
     case 0x09:
-        m_type = VendorSpecifiedServiceType;
-        break;
+        return HResourceType::VendorSpecifiedServiceType;
     case 0x0a:
-        m_type = StandardServiceType;
-        break;
+        return HResourceType::StandardServiceType;
     default:
         Q_ASSERT(false);
-        return;
+        return HResourceType::Undefined;
+    }
+}
+}
+
+/*******************************************************************************
+ * HResourceTypePrivate
+ ******************************************************************************/
+HResourceTypePrivate::HResourceTypePrivate(
+    HResourceType::Type type, const QStringList& resourceElements,
+    quint32 typeId) :
+        m_type(type),
+        m_resourceElements(resourceElements),
+        m_version(resourceElements[4].toInt()),
+        m_typeId(typeId),
+        m_hash(hashOf(resourceElements.join(":")))
+{
+}
+
+/*******************************************************************************
+ * HResourceTypeTable
+ ******************************************************************************/
+QScopedPointer<HResourceTypeTable> HResourceTypeTable::s_instance;
+QMutex HResourceTypeTable::s_initMutex;
+
+HResourceTypeTable::HResourceTypeTable() :
+    m_mutex(), m_typesByString(), m_typesByCanonicalString(), m_typeIds()
+{
+}
+
+HResourceTypeTable::~HResourceTypeTable()
+{
+    // the interned resource types are not deleted, since static
+    // HResourceType objects may be destroyed after this
+}
+
+HResourceTypeTable& HResourceTypeTable::instance()
+{
+    QMutexLocker lock(&s_initMutex);
+
+    if (s_instance)
+    {
+        return *s_instance;
     }
 
-    m_resourceElements = tmp;
+    s_instance.reset(new HResourceTypeTable());
+    return *s_instance;
+}
+
+HResourceTypePrivate* HResourceTypeTable::get(const QString& resourceTypeAsStr)
+{
+    QMutexLocker lock(&m_mutex);
+
+    QHash<QString, HResourceTypePrivate*>::const_iterator ci =
+        m_typesByString.constFind(resourceTypeAsStr);
+
+    if (ci != m_typesByString.constEnd())
+    {
+        return ci.value();
+    }
+
+    lock.unlock();
+
+    QStringList resourceElements;
+    HResourceType::Type type =
+        parseResourceType(resourceTypeAsStr, &resourceElements);
+
+    lock.relock();
+
+    HResourceTypePrivate* retVal = 0;
+    if (type != HResourceType::Undefined)
+    {
+        QString canonical = resourceElements.join(":");
+
+        retVal = m_typesByCanonicalString.value(canonical);
+        if (!retVal)
+        {
+            if (m_typesByCanonicalString.size() >= MaxInternedTypes)
+            {
+                // the instance is owned by the HResourceType objects
+                return new HResourceTypePrivate(type, resourceElements, 0);
+            }
+
+            QString withoutVersion =
+                canonical.left(canonical.lastIndexOf(':'));
+
+            quint32 typeId = m_typeIds.value(withoutVersion);
+            if (!typeId)
+            {
+                typeId = m_typeIds.size() + 1;
+                m_typeIds.insert(withoutVersion, typeId);
+            }
+
+            retVal = new HResourceTypePrivate(type, resourceElements, typeId);
+
+            // the reference of the table, which keeps the instance alive
+            retVal->ref.ref();
+
+            m_typesByCanonicalString.insert(canonical, retVal);
+        }
+    }
+
+    if (m_typesByString.size() < MaxInternedStrings)
+    {
+        m_typesByString.insert(resourceTypeAsStr, retVal);
+    }
+
+    return retVal;
+}
+
+/*******************************************************************************
+ * HResourceType
+ ******************************************************************************/
+HResourceType::HResourceType() :
+    m_type(Undefined), h_ptr()
+{
+}
+
+HResourceType::HResourceType(const QString& resourceTypeAsStr) :
+    m_type(Undefined),
+    h_ptr(HResourceTypeTable::instance().get(resourceTypeAsStr))
+{
+    if (h_ptr)
+    {
+        m_type = h_ptr->m_type;
+    }
+}
+
+HResourceType::HResourceType(const HResourceType& other) :
+    m_type(other.m_type), h_ptr(other.h_ptr)
+{
+}
+
+HResourceType& HResourceType::operator=(const HResourceType& other)
+{
+    m_type = other.m_type;
+    h_ptr = other.h_ptr;
+    return *this;
 }
 
 HResourceType::~HResourceType()
@@ -135,28 +276,28 @@ QString HResourceType::toString(Tokens tokens) const
 
     if (tokens & Domain)
     {
-        retVal.append(m_resourceElements[1]);
+        retVal.append(h_ptr->m_resourceElements[1]);
         appendDelim = true;
     }
 
     if (tokens & Type)
     {
         if (appendDelim) { retVal.append(':'); }
-        retVal.append(m_resourceElements[2]);
+        retVal.append(h_ptr->m_resourceElements[2]);
         appendDelim = true;
     }
 
     if (tokens & TypeSuffix)
     {
         if (appendDelim) { retVal.append(':'); }
-        retVal.append(m_resourceElements[3]);
+        retVal.append(h_ptr->m_resourceElements[3]);
         appendDelim = true;
     }
 
     if (tokens & Version)
     {
         if (appendDelim) { retVal.append(':'); }
-        retVal.append(m_resourceElements[4]);
+        retVal.append(h_ptr->m_resourceElements[4]);
     }
 
     return retVal;
@@ -169,7 +310,7 @@ qint32 HResourceType::version() const
         return -1;
     }
 
-    return m_resourceElements[4].toInt();
+    return h_ptr->m_version;
 }
 
 bool HResourceType::compare(
@@ -210,9 +351,16 @@ bool HResourceType::compare(
         Q_ASSERT(false);
     }
 
-    for(qint32 i = 0; i < m_resourceElements.size() - 1; ++i)
+    if (h_ptr->m_typeId && other.h_ptr->m_typeId)
     {
-        if (m_resourceElements[i] != other.m_resourceElements[i])
+        return h_ptr->m_typeId == other.h_ptr->m_typeId;
+    }
+
+    const QStringList& elements = h_ptr->m_resourceElements;
+    const QStringList& otherElements = other.h_ptr->m_resourceElements;
+    for(qint32 i = 0; i < elements.size() - 1; ++i)
+    {
+        if (elements[i] != otherElements[i])
         {
             return false;
         }
@@ -223,13 +371,26 @@ bool HResourceType::compare(
 
 bool operator==(const HResourceType& arg1, const HResourceType& arg2)
 {
-    return arg1.m_resourceElements == arg2.m_resourceElements;
+    if (arg1.h_ptr == arg2.h_ptr)
+    {
+        return true;
+    }
+    else if (!arg1.h_ptr || !arg2.h_ptr)
+    {
+        return false;
+    }
+    else if (arg1.h_ptr->m_typeId && arg2.h_ptr->m_typeId)
+    {
+        // distinct interned instances represent distinct resource types
+        return false;
+    }
+
+    return arg1.h_ptr->m_resourceElements == arg2.h_ptr->m_resourceElements;
 }
 
 quint32 qHash(const HResourceType& key)
 {
-    QByteArray data = key.toString().toLocal8Bit();
-    return hash(data.constData(), data.size());
+    return key.h_ptr ? key.h_ptr->m_hash : hashOf(QString());
 }
 
 }
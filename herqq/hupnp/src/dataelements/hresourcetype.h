@@ -26,6 +26,7 @@
 
 #include <QtCore/QMetaType>
 #include <QtCore/QStringList>
+#include <QtCore/QExplicitlySharedDataPointer>
 
 namespace Herqq
 {
@@ -67,6 +68,7 @@ class H_UPNP_CORE_EXPORT HResourceType
 {
 friend H_UPNP_CORE_EXPORT bool operator==(
     const HResourceType&, const HResourceType&);
+friend H_UPNP_CORE_EXPORT quint32 qHash(const HResourceType&);
 
 public:
 
@@ -136,7 +138,7 @@ public:
 private:
 
     Type m_type;
-    QStringList m_resourceElements;
+    QExplicitlySharedDataPointer<HResourceTypePrivate> h_ptr;
 
 public:
 
@@ -171,6 +173,20 @@ public:
      */
     HResourceType(const QString& resourceTypeAsStr);
 
+    /*!
+     * Copies the contents of the other to this.
+     *
+     * \param other specifies the object to be copied.
+     */
+    HResourceType(const HResourceType& other);
+
+    /*!
+     * Assigns the contents of the other to this.
+     *
+     * \param other specifies the object to be copied.
+     */
+    HResourceType& operator=(const HResourceType& other);
+
     /*!
      * \brief Destroys the instance.
      */
@@ -0,0 +1,123 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef HRESOURCETYPE_P_H_
+#define HRESOURCETYPE_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include "hresourcetype.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QSharedData>
+#include <QtCore/QScopedPointer>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+//
+// Implementation details of HResourceType. An instance is immutable once it
+// is created, which is why it is shared by all the HResourceType objects
+// that represent the same resource type.
+//
+class HResourceTypePrivate :
+    public QSharedData
+{
+H_DISABLE_COPY(HResourceTypePrivate)
+
+public:
+
+    const HResourceType::Type m_type;
+    const QStringList m_resourceElements;
+    const qint32 m_version;
+
+    const quint32 m_typeId;
+    // identifies the resource type without its version among the interned
+    // resource types, or 0 in case this instance is not interned
+
+    const quint32 m_hash;
+
+    HResourceTypePrivate(
+        HResourceType::Type type, const QStringList& resourceElements,
+        quint32 typeId);
+};
+
+//
+// A process-wide table of the resource types that have been created, which
+// guarantees that each distinct resource type string is parsed only once and
+// that each distinct resource type is represented by a single
+// HResourceTypePrivate instance. Two interned resource types are hence
+// equal only if they are the same instance.
+//
+// The number of interned resource types is bounded, since the types may be
+// received from the network. Once the table is full, the resource types not
+// yet in it are created as separate instances that are compared by value.
+//
+// This class is thread-safe.
+//
+class HResourceTypeTable
+{
+H_DISABLE_COPY(HResourceTypeTable)
+friend class QScopedPointer<HResourceTypeTable>;
+
+private:
+
+    static QScopedPointer<HResourceTypeTable> s_instance;
+    static QMutex s_initMutex;
+
+    QMutex m_mutex;
+
+    QHash<QString, HResourceTypePrivate*> m_typesByString;
+    // the strings that have been parsed and the resource types they parsed
+    // to. an invalid string maps to null
+
+    QHash<QString, HResourceTypePrivate*> m_typesByCanonicalString;
+
+    QHash<QString, quint32> m_typeIds;
+    // the identifiers of the resource types without their versions
+
+    HResourceTypeTable();
+    ~HResourceTypeTable();
+
+public:
+
+    static HResourceTypeTable& instance();
+
+    // returns the resource type the string represents or null in case the
+    // string is not a valid resource type
+    HResourceTypePrivate* get(const QString& resourceTypeAsStr);
+};
+
+}
+}
+
+#endif /* HRESOURCETYPE_P_H_ */
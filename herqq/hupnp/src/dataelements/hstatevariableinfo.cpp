@@ -24,6 +24,7 @@
 
 #include "../general/hupnp_global_p.h"
 #include "../general/hupnp_datatypes_p.h"
+#include "../general/hxmlfragment_p.h"
 
 #include "../utils/hmisc_utils_p.h"
 
@@ -37,6 +38,12 @@ namespace Upnp
  * HStateVariableInfoPrivate
  ******************************************************************************/
 HStateVariableInfoPrivate::HStateVariableInfoPrivate() :
+    m_allowedValueSet(),
+    m_rangeType(NoRange),
+    m_minimumInteger(0),
+    m_maximumInteger(0),
+    m_minimumRational(0),
+    m_maximumRational(0),
     m_name(),
     m_dataType(HUpnpDataTypes::Undefined),
     m_variantDataType(QVariant::Invalid),
@@ -50,44 +57,51 @@ HStateVariableInfoPrivate::HStateVariableInfoPrivate() :
 {
 }
 
-bool HStateVariableInfoPrivate::isWithinAllowedRange(
-    const QVariant& value, QString* errDescr)
+void HStateVariableInfoPrivate::compileConstraints()
 {
-    Q_ASSERT(!m_allowedValueRange.isNull());
-    Q_ASSERT(HUpnpDataTypes::isNumeric(m_dataType));
+    m_allowedValueSet.clear();
+    m_rangeType = NoRange;
 
-    if (HUpnpDataTypes::isRational(m_dataType))
+    if (m_dataType == HUpnpDataTypes::string)
+    {
+        m_allowedValueSet = m_allowedValueList.toSet();
+    }
+    else if (HUpnpDataTypes::isNumeric(m_dataType) &&
+             !m_allowedValueRange.isNull())
     {
-        qreal tmp = value.toDouble();
-        if (tmp < m_allowedValueRange.minimum().toDouble() ||
-            tmp > m_allowedValueRange.maximum().toDouble())
+        if (HUpnpDataTypes::isRational(m_dataType))
         {
-            if (errDescr)
-            {
-                *errDescr = QString(
-                    "Value [%1] is not within the specified allowed values range.").arg(
-                        value.toString());
-            }
-            return false;
+            m_rangeType = RationalRange;
+            m_minimumRational = m_allowedValueRange.minimum().toDouble();
+            m_maximumRational = m_allowedValueRange.maximum().toDouble();
+        }
+        else
+        {
+            m_rangeType = IntegerRange;
+            m_minimumInteger = m_allowedValueRange.minimum().toLongLong();
+            m_maximumInteger = m_allowedValueRange.maximum().toLongLong();
         }
     }
-    else
+}
+
+bool HStateVariableInfoPrivate::isWithinAllowedRange(
+    const QVariant& value) const
+{
+    switch(m_rangeType)
     {
-        qlonglong tmp = value.toLongLong();
-        if (tmp < m_allowedValueRange.minimum().toLongLong() ||
-            tmp > m_allowedValueRange.maximum().toLongLong())
+    case IntegerRange:
         {
-            if (errDescr)
-            {
-                *errDescr = QString(
-                    "Value [%1] is not within the specified allowed values range.").arg(
-                        value.toString());
-            }
-            return false;
+            qlonglong tmp = value.toLongLong();
+            return tmp >= m_minimumInteger && tmp <= m_maximumInteger;
+        }
+    case RationalRange:
+        {
+            qreal tmp = value.toDouble();
+            return tmp >= m_minimumRational && tmp <= m_maximumRational;
         }
+    default:
+        return true;
     }
-
-    return true;
 }
 
 bool HStateVariableInfoPrivate::checkValue(
@@ -106,6 +120,20 @@ bool HStateVariableInfoPrivate::checkValue(
         return false;
     }
 
+    if (value.userType() == qMetaTypeId<HXmlFragment>())
+    {
+        // A pre-serialized string value is accepted as is, unless it has to
+        // be matched against the allowed values.
+        if (m_dataType == HUpnpDataTypes::string && m_allowedValueSet.isEmpty())
+        {
+            *acceptableValue = value;
+            return true;
+        }
+
+        return checkValue(
+            value.value<HXmlFragment>().toString(), acceptableValue, errDescr);
+    }
+
     if (value.type() != m_variantDataType)
     {
         if (m_variantDataType == QVariant::Url)
@@ -137,9 +165,9 @@ bool HStateVariableInfoPrivate::checkValue(
         }
     }
 
-    if (m_dataType == HUpnpDataTypes::string && m_allowedValueList.size())
+    if (!m_allowedValueSet.isEmpty())
     {
-        if (m_allowedValueList.indexOf(value.toString()) < 0)
+        if (!m_allowedValueSet.contains(tmp.toString()))
         {
             if (errDescr)
             {
@@ -150,35 +178,15 @@ bool HStateVariableInfoPrivate::checkValue(
             return false;
         }
     }
-    else if (HUpnpDataTypes::isRational(m_dataType) && !m_allowedValueRange.isNull())
+    else if (!isWithinAllowedRange(tmp))
     {
-        qreal tmp = value.toDouble();
-        if (tmp < m_allowedValueRange.minimum().toDouble() ||
-            tmp > m_allowedValueRange.maximum().toDouble())
-        {
-            if (errDescr)
-            {
-                *errDescr = QString(
-                    "Value [%1] is not within the specified allowed values range.").arg(
-                        value.toString());
-            }
-            return false;
-        }
-    }
-    else if (HUpnpDataTypes::isNumeric(m_dataType) && !m_allowedValueRange.isNull())
-    {
-        qlonglong tmp = value.toLongLong();
-        if (tmp < m_allowedValueRange.minimum().toLongLong() ||
-            tmp > m_allowedValueRange.maximum().toLongLong())
+        if (errDescr)
         {
-            if (errDescr)
-            {
-                *errDescr = QString(
-                    "Value [%1] is not within the specified allowed values range.").arg(
-                        value.toString());
-            }
-            return false;
+            *errDescr = QString(
+                "Value [%1] is not within the specified allowed values range.").arg(
+                    value.toString());
         }
+        return false;
     }
 
     *acceptableValue = tmp;
@@ -211,6 +219,7 @@ bool HStateVariableInfoPrivate::setDataType(
     m_dataType = arg;
     m_variantDataType = HUpnpDataTypes::convertToVariantType(m_dataType);
     m_defaultValue = QVariant(m_variantDataType);
+    compileConstraints();
 
     return true;
 }
@@ -250,6 +259,7 @@ bool HStateVariableInfoPrivate::setAllowedValueList(
     }
 
     m_allowedValueList = allowedValueList;
+    compileConstraints();
     if (!allowedValueList.empty() && !allowedValueList.contains(m_defaultValue.toString()))
     {
         m_defaultValue = QVariant(QVariant::String);
@@ -283,6 +293,7 @@ bool HStateVariableInfoPrivate::setAllowedValueRange(
     }
 
     m_allowedValueRange = valueRange;
+    compileConstraints();
     if (!isWithinAllowedRange(m_defaultValue))
     {
         m_defaultValue = QVariant(m_variantDataType);
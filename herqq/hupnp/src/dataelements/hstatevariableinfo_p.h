@@ -35,6 +35,7 @@
 #include "../general/hupnp_global.h"
 #include "../general/hupnp_datatypes.h"
 
+#include <QtCore/QSet>
 #include <QtCore/QString>
 #include <QtCore/QVariant>
 #include <QtCore/QSharedData>
@@ -53,6 +54,29 @@ class HStateVariableInfoPrivate :
     public QSharedData
 {
 
+private:
+
+    // the constraints of the state variable in a form that can be checked
+    // without going through QStringList searches and QVariant conversions.
+    // these are derived from the data type, the allowed value list and the
+    // allowed value range whenever any of those changes
+    enum RangeType
+    {
+        NoRange,
+        IntegerRange,
+        RationalRange
+    };
+
+    QSet<QString> m_allowedValueSet;
+    RangeType m_rangeType;
+    qlonglong m_minimumInteger;
+    qlonglong m_maximumInteger;
+    qreal m_minimumRational;
+    qreal m_maximumRational;
+
+    void compileConstraints();
+    bool isWithinAllowedRange(const QVariant&) const;
+
 public: // attributes
 
     QString                  m_name;
@@ -71,8 +95,6 @@ public: // methods
 
     HStateVariableInfoPrivate();
 
-    bool isWithinAllowedRange(const QVariant&, QString* errDescr=0);
-
     bool checkValue(
         const QVariant&, QVariant* acceptableValue, QString* errDescr = 0) const;
 
@@ -24,7 +24,6 @@
 #include "../utils/hmisc_utils_p.h"
 
 #include <QtCore/QString>
-#include <QtCore/QByteArray>
 
 namespace Herqq
 {
@@ -32,57 +31,87 @@ namespace Herqq
 namespace Upnp
 {
 
+namespace
+{
+inline QString canonicalForm(const QUuid& uuid)
+{
+    return QString("uuid:").append(uuid.toString().remove('{').remove('}'));
+}
+}
+
 HUdn::HUdn() :
-    m_value()
+    m_uuid(), m_value(), m_hash(0)
 {
+    init(QString());
 }
 
 HUdn::HUdn(const QUuid& value) :
-    m_value(value.toString().remove('{').remove('}'))
+    m_uuid(value), m_value(), m_hash(0)
 {
+    if (value.isNull())
+    {
+        // a null UUID is stored as a string, which keeps it distinct from
+        // an empty UDN
+        init(canonicalForm(value));
+    }
+    else
+    {
+        m_hash = hash(reinterpret_cast<const char*>(&m_uuid), sizeof(m_uuid));
+    }
 }
 
 HUdn::HUdn(const QString& value) :
-    m_value(value.simplified())
+    m_uuid(), m_value(), m_hash(0)
 {
+    init(value.simplified());
 }
 
 HUdn::~HUdn()
 {
 }
 
-QUuid HUdn::value() const
+void HUdn::init(const QString& value)
 {
-    if (m_value.startsWith("uuid:"))
+    // the hash is computed once, since UDNs are compared and used as hash
+    // keys far more often than they are created. the string is kept only
+    // when it cannot be reproduced from the UUID, which keeps the copying
+    // and the comparison of the canonical UDNs free of allocations
+    if (value.isEmpty() || value.startsWith("uuid:"))
+    {
+        m_value = value;
+    }
+    else
     {
-        return QUuid(m_value.mid(5));
+        m_value = QString("uuid:").append(value);
     }
 
-    return QUuid(m_value);
-}
+    if (!m_value.isEmpty())
+    {
+        m_uuid = QUuid(m_value.mid(5));
+    }
 
-QString HUdn::toString() const
-{
-    if (m_value.isEmpty())
+    if (!m_uuid.isNull() && m_value == canonicalForm(m_uuid))
     {
-        return m_value;
+        m_value.clear();
+        m_hash = hash(reinterpret_cast<const char*>(&m_uuid), sizeof(m_uuid));
     }
-    else if (m_value.startsWith("uuid:"))
+    else
     {
-        return m_value;
+        m_hash = hash(
+            reinterpret_cast<const char*>(m_value.unicode()),
+            m_value.size() * static_cast<int>(sizeof(QChar)));
     }
+}
 
-    return QString("uuid:").append(m_value);
+QString HUdn::toString() const
+{
+    return m_value.isEmpty() && !m_uuid.isNull() ?
+        canonicalForm(m_uuid) : m_value;
 }
 
 QString HUdn::toSimpleUuid() const
 {
-    if (m_value.startsWith("uuid:"))
-    {
-        return m_value.mid(5);
-    }
-
-    return m_value;
+    return toString().mid(5);
 }
 
 HUdn HUdn::createUdn()
@@ -92,13 +121,13 @@ HUdn HUdn::createUdn()
 
 bool operator==(const HUdn& udn1, const HUdn& udn2)
 {
-    return udn1.toString() == udn2.toString();
+    return udn1.m_hash == udn2.m_hash && udn1.m_uuid == udn2.m_uuid &&
+           udn1.m_value == udn2.m_value;
 }
 
 quint32 qHash(const HUdn& key)
 {
-    QByteArray data = key.toString().toLocal8Bit();
-    return hash(data.constData(), data.size());
+    return key.m_hash;
 }
 
 }
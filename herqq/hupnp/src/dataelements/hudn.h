@@ -54,7 +54,18 @@ friend H_UPNP_CORE_EXPORT bool operator==(const HUdn&, const HUdn&);
 
 private:
 
+    QUuid m_uuid;
+    // null in case the UDN does not contain a proper UUID
+
     QString m_value;
+    // the complete UDN, which is prefixed with "uuid:" unless it is empty.
+    // this is left empty when the UDN is in its canonical form, i.e. the
+    // prefix is followed by the lowercase UUID without curly braces, in
+    // which case the string is built from m_uuid only when asked
+
+    quint32 m_hash;
+
+    void init(const QString& value);
 
 public:
 
@@ -111,7 +122,8 @@ public:
      */
     inline bool isValid(HValidityCheckLevel checkLevel) const
     {
-        return checkLevel == StrictChecks ? !value().isNull() : !m_value.isEmpty();
+        return checkLevel == StrictChecks ?
+            !m_uuid.isNull() : !m_uuid.isNull() || !m_value.isEmpty();
     }
 
     /*!
@@ -122,7 +134,10 @@ public:
      * \remarks if the UDN is not strictly valid, i.e. isValid(true) returns
      * \e false, this method will return a null \c QUuid.
      */
-    QUuid value() const;
+    inline QUuid value() const
+    {
+        return m_uuid;
+    }
 
     /*!
      * \brief Returns the complete UDN value.
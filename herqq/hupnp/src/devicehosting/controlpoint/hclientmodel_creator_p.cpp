@@ -20,6 +20,9 @@
  */
 
 #include "hclientmodel_creator_p.h"
+#include "hicon_cache_p.h"
+#include "hservicedescription_cache_p.h"
+#include "hcontrolpoint_dataretriever_p.h"
 
 #include "../../dataelements/hudn.h"
 #include "../../dataelements/hserviceid.h"
@@ -28,6 +31,7 @@
 #include "../../general/hupnp_global_p.h"
 #include "../../general/hupnp_datatypes_p.h"
 
+#include "../../devicemodel/client/hclientaction_p.h"
 #include "../../devicemodel/client/hclientservice_p.h"
 #include "../../devicemodel/client/hclientdevice_p.h"
 #include "../../devicemodel/client/hdefault_clientaction_p.h"
@@ -51,7 +55,9 @@ namespace Upnp
  * HClientModelCreationArgs
  ******************************************************************************/
 HClientModelCreationArgs::HClientModelCreationArgs(QNetworkAccessManager* nam) :
-    m_nam(nam)
+    m_deviceDescription(), m_serviceDescriptionFetcher(), m_nam(nam),
+    m_serviceDescriptionCache(0), m_iconCache(0),
+    m_serviceDescriptionsOnDemand(false), m_maxConcurrentInvocations(1)
 {
 }
 
@@ -62,7 +68,13 @@ HClientModelCreationArgs::~HClientModelCreationArgs()
 HClientModelCreationArgs::HClientModelCreationArgs(
     const HClientModelCreationArgs& other) :
         HModelCreationArgs(other),
-            m_nam(other.m_nam)
+            m_deviceDescription(other.m_deviceDescription),
+            m_serviceDescriptionFetcher(other.m_serviceDescriptionFetcher),
+            m_nam(other.m_nam),
+            m_serviceDescriptionCache(other.m_serviceDescriptionCache),
+            m_iconCache(other.m_iconCache),
+            m_serviceDescriptionsOnDemand(other.m_serviceDescriptionsOnDemand),
+            m_maxConcurrentInvocations(other.m_maxConcurrentInvocations)
 {
 }
 
@@ -71,7 +83,13 @@ HClientModelCreationArgs& HClientModelCreationArgs::operator=(
 {
     Q_ASSERT(this != &other);
     HModelCreationArgs::operator=(other);
+    m_deviceDescription = other.m_deviceDescription;
+    m_serviceDescriptionFetcher = other.m_serviceDescriptionFetcher;
     m_nam = other.m_nam;
+    m_serviceDescriptionCache = other.m_serviceDescriptionCache;
+    m_iconCache = other.m_iconCache;
+    m_serviceDescriptionsOnDemand = other.m_serviceDescriptionsOnDemand;
+    m_maxConcurrentInvocations = other.m_maxConcurrentInvocations;
     return *this;
 }
 
@@ -83,25 +101,15 @@ HClientModelCreator::HClientModelCreator(
         m_creationParameters(new HClientModelCreationArgs(creationParameters)),
         m_docParser(creationParameters.m_loggingIdentifier, LooseChecks)
 {
-    Q_ASSERT(creationParameters.m_serviceDescriptionFetcher);
     Q_ASSERT(creationParameters.m_deviceLocations.size() > 0);
-    Q_ASSERT(creationParameters.m_iconFetcher);
     Q_ASSERT(!creationParameters.m_loggingIdentifier.isEmpty());
 }
 
 bool HClientModelCreator::parseStateVariables(
-    HDefaultClientService* service, QDomElement stateVariableElement)
+    HDefaultClientService* service, const QList<HStateVariableInfo>& svInfos)
 {
-    while(!stateVariableElement.isNull())
+    foreach(const HStateVariableInfo& svInfo, svInfos)
     {
-        HStateVariableInfo svInfo;
-        if (!m_docParser.parseStateVariable(stateVariableElement, &svInfo))
-        {
-            m_lastError = convert(m_docParser.lastError());
-            m_lastErrorDescription = m_docParser.lastErrorDescription();
-            return false;
-        }
-
         HDefaultClientStateVariable* sv =
             new HDefaultClientStateVariable(svInfo, service);
 
@@ -116,42 +124,25 @@ bool HClientModelCreator::parseStateVariables(
             SLOT(notifyListeners()));
 
         Q_ASSERT(ok); Q_UNUSED(ok)
-
-        Q_ASSERT(ok); Q_UNUSED(ok)
-
-        stateVariableElement =
-            stateVariableElement.nextSiblingElement("stateVariable");
     }
 
     return true;
 }
 
 bool HClientModelCreator::parseActions(
-    HDefaultClientService* service, QDomElement actionElement,
-    const HStateVariableInfos& svInfos)
+    HDefaultClientService* service, const QList<HActionInfo>& actionInfos)
 {
-    while(!actionElement.isNull())
+    foreach(const HActionInfo& actionInfo, actionInfos)
     {
-        HActionInfo actionInfo;
-        if (!m_docParser.parseActionInfo(
-                actionElement, svInfos, &actionInfo))
-        {
-            m_lastError = convert(m_docParser.lastError());
-            m_lastErrorDescription = m_docParser.lastErrorDescription();
-            return false;
-        }
-
         HDefaultClientAction* action =
             new HDefaultClientAction(
                 actionInfo,
                 service,
-                *m_creationParameters->m_nam);
+                *service->parentDevice()->invocationChannel());
 
         QString name = action->info().name();
 
         service->addAction(action);
-
-        actionElement = actionElement.nextSiblingElement("action");
     }
 
     return true;
@@ -162,29 +153,71 @@ bool HClientModelCreator::parseServiceDescription(HDefaultClientService* service
     HLOG2(H_AT, H_FUN, m_creationParameters->m_loggingIdentifier);
     Q_ASSERT(service);
 
-    QDomDocument doc;
-    QDomElement firstSv, firstAction;
-    if (!m_docParser.parseServiceDescription(
-        service->description(), &doc, &firstSv, &firstAction))
+    HServiceDescriptionCache* cache =
+        m_creationParameters->m_serviceDescriptionCache;
+
+    HParsedServiceDescription parsed;
+    if (cache && cache->get(service->descriptionData(), &parsed))
     {
-        m_lastError = convert(m_docParser.lastError());
-        m_lastErrorDescription = m_docParser.lastErrorDescription();
-        return false;
+        // the service shares the description and the information parsed
+        // from it with every other service using the same description
+        service->setDescription(parsed.m_description);
     }
+    else
+    {
+        parsed.m_description = service->descriptionData();
+        if (!m_docParser.parseServiceDescription(
+            parsed.m_description, &parsed.m_stateVariables, &parsed.m_actions))
+        {
+            m_lastError = convert(m_docParser.lastError());
+            m_lastErrorDescription = m_docParser.lastErrorDescription();
+            return false;
+        }
 
-    if (!parseStateVariables(service, firstSv))
+        if (cache)
+        {
+            cache->put(parsed);
+        }
+    }
+
+    if (!parseStateVariables(service, parsed.m_stateVariables))
     {
         return false;
     }
 
-    HStateVariableInfos svInfos;
-    HClientStateVariables svs = service->stateVariables();
-    foreach(const QString& key, svs.keys())
+    return parseActions(service, parsed.m_actions);
+}
+
+bool HClientModelCreator::createServiceModel(HDefaultClientService* service)
+{
+    HLOG2(H_AT, H_FUN, m_creationParameters->m_loggingIdentifier);
+    Q_ASSERT(service);
+    Q_ASSERT(m_creationParameters->m_serviceDescriptionFetcher);
+
+    QByteArray description;
+    if (!m_creationParameters->m_serviceDescriptionFetcher(
+            extractBaseUrl(m_creationParameters->m_deviceLocations[0]),
+            service->info().scpdUrl(), &description))
     {
-        svInfos.insert(key, svs.value(key)->info());
+        m_lastError = FailedToGetDataError;
+        m_lastErrorDescription = QString(
+            "Could not retrieve service description from [%1]").arg(
+                service->info().scpdUrl().toString());
+
+        return false;
     }
 
-    return parseActions(service, firstAction, svInfos);
+    return createServiceModel(service, description);
+}
+
+bool HClientModelCreator::createServiceModel(
+    HDefaultClientService* service, const QByteArray& description)
+{
+    HLOG2(H_AT, H_FUN, m_creationParameters->m_loggingIdentifier);
+    Q_ASSERT(service);
+
+    service->setDescription(description);
+    return parseServiceDescription(service);
 }
 
 bool HClientModelCreator::parseServiceList(
@@ -210,21 +243,11 @@ bool HClientModelCreator::parseServiceList(
         QScopedPointer<HDefaultClientService> service(
             new HDefaultClientService(info, device));
 
-        QString description;
-        if (!m_creationParameters->m_serviceDescriptionFetcher(
-                extractBaseUrl(m_creationParameters->m_deviceLocations[0]),
-                info.scpdUrl(), &description))
+        if (m_creationParameters->m_serviceDescriptionsOnDemand)
         {
-            m_lastError = FailedToGetDataError;
-            m_lastErrorDescription = QString(
-                "Could not retrieve service description from [%1]").arg(
-                    info.scpdUrl().toString());
-
-            return false;
+            service->setLoader(new HServiceModelLoader(*m_creationParameters));
         }
-
-        service->setDescription(description);
-        if (!parseServiceDescription(service.data()))
+        else if (!createServiceModel(service.data()))
         {
             return false;
         }
@@ -258,6 +281,20 @@ HDefaultClientDevice* HClientModelCreator::parseDevice(
             m_creationParameters->m_deviceTimeoutInSecs,
             parentDevice));
 
+    if (!parentDevice)
+    {
+        device->setInvocationChannel(
+            new HInvocationChannel(
+                *m_creationParameters->m_nam,
+                m_creationParameters->m_maxConcurrentInvocations));
+
+        // the icons are not retrieved as part of the build, but on demand
+        device->setIconRetriever(
+            new HIconRetriever(
+                *m_creationParameters->m_nam,
+                m_creationParameters->m_iconCache));
+    }
+
     QDomElement serviceListElement =
         deviceElement.firstChildElement("serviceList");
 
@@ -337,6 +374,42 @@ HDefaultClientDevice* HClientModelCreator::createRootDevice()
 
     return createdDevice.take();
 }
+/*******************************************************************************
+ * HServiceModelLoader
+ ******************************************************************************/
+HServiceModelLoader::HServiceModelLoader(
+    const HClientModelCreationArgs& creationParameters) :
+        m_creationParameters(creationParameters)
+{
+    m_creationParameters.m_serviceDescriptionFetcher =
+        ServiceDescriptionDataFetcher();
+}
+
+bool HServiceModelLoader::load(HDefaultClientService* service)
+{
+    HLOG2(H_AT, H_FUN, m_creationParameters.m_loggingIdentifier);
+    Q_ASSERT(service);
+
+    HDataRetriever dataRetriever(m_creationParameters.m_loggingIdentifier);
+
+    HClientModelCreationArgs creatorParams(m_creationParameters);
+    creatorParams.m_serviceDescriptionFetcher =
+        ServiceDescriptionDataFetcher(
+            &dataRetriever, &HDataRetriever::retrieveServiceDescription);
+
+    HClientModelCreator creator(creatorParams);
+    if (!creator.createServiceModel(service))
+    {
+        HLOG_WARN(QString(
+            "Failed to load the description of service [%1]: %2").arg(
+                service->info().serviceId().toString(),
+                creator.lastErrorDescription()));
+
+        return false;
+    }
+
+    return true;
+}
 
 }
 }
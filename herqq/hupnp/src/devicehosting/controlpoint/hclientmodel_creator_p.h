@@ -33,6 +33,8 @@
 #include "../hddoc_parser_p.h"
 #include "../hmodelcreation_p.h"
 
+#include "../../devicemodel/client/hclientservice_p.h"
+
 #include <QtXml/QDomElement>
 
 class QNetworkAccessManager;
@@ -44,6 +46,8 @@ namespace Upnp
 {
 
 class HDefaultClientDevice;
+class HIconCache;
+class HServiceDescriptionCache;
 
 //
 //
@@ -53,8 +57,29 @@ class HClientModelCreationArgs :
 {
 public:
 
+    QByteArray m_deviceDescription;
+    // the device description as it was received
+
+    ServiceDescriptionDataFetcher m_serviceDescriptionFetcher;
+
     QNetworkAccessManager* m_nam;
 
+    HServiceDescriptionCache* m_serviceDescriptionCache;
+    // the cache of parsed service descriptions shared by the builds of a
+    // control point. may be null.
+
+    HIconCache* m_iconCache;
+    // the cache of icons shared by the devices of a control point. may be
+    // null.
+
+    bool m_serviceDescriptionsOnDemand;
+    // when set, the services are created without their actions and state
+    // variables, which are created when the services are first accessed
+
+    qint32 m_maxConcurrentInvocations;
+    // the maximum number of action invocations in progress to a root device
+    // at a time. zero means no limit
+
     HClientModelCreationArgs(QNetworkAccessManager* nam);
     virtual ~HClientModelCreationArgs();
 
@@ -95,15 +120,12 @@ private:
 
 private:
 
-    QList<QPair<QUrl, QByteArray> > parseIconList(
-        const QDomElement& iconListElement);
-
     bool parseStateVariables(
-        HDefaultClientService* service, QDomElement stateVariableElement);
+        HDefaultClientService* service,
+        const QList<HStateVariableInfo>& svInfos);
 
     bool parseActions(
-        HDefaultClientService*, QDomElement actionElement,
-        const HStateVariableInfos& svInfos);
+        HDefaultClientService*, const QList<HActionInfo>& actionInfos);
 
     bool parseServiceDescription(HDefaultClientService*);
 
@@ -134,10 +156,41 @@ public:
     HClientModelCreator(const HClientModelCreationArgs&);
     HDefaultClientDevice* createRootDevice();
 
+    // retrieves the description of the service and creates the actions and
+    // the state variables of it
+    bool createServiceModel(HDefaultClientService*);
+
+    // creates the actions and the state variables of a service from
+    // a description that has already been retrieved
+    bool createServiceModel(
+        HDefaultClientService*, const QByteArray& description);
+
     inline ErrorType lastError() const { return m_lastError; }
     inline QString lastErrorDescription() const { return m_lastErrorDescription; }
 };
 
+//
+// Creates the actions and the state variables of a service the first time
+// the service is accessed, when the service descriptions are retrieved on
+// demand
+//
+class HServiceModelLoader :
+    public HClientServiceLoader
+{
+H_DISABLE_COPY(HServiceModelLoader)
+
+private:
+
+    HClientModelCreationArgs m_creationParameters;
+    // the fetchers are not copied, as they refer to the build that created
+    // the service
+
+public:
+
+    HServiceModelLoader(const HClientModelCreationArgs&);
+    virtual bool load(HDefaultClientService*);
+};
+
 }
 }
 
@@ -26,6 +26,8 @@
 #include "hcontrolpoint_configuration.h"
 #include "hcontrolpoint_configuration_p.h"
 #include "hcontrolpoint_dataretriever_p.h"
+#include "hdescription_cache_p.h"
+#include "hdiscovery_scheduler_p.h"
 
 #include "../../general/hupnp_global_p.h"
 #include "../../general/hupnp_datatypes_p.h"
@@ -37,13 +39,20 @@
 #include "../../devicemodel/client/hdefault_clientdevice_p.h"
 #include "../../devicemodel/client/hdefault_clientservice_p.h"
 
+#include "../../http/hhttp_header_p.h"
 #include "../../http/hhttp_messagecreator_p.h"
+#include "../../http/hopenmetrics_p.h"
 
+#include "../../general/htrace_p.h"
 #include "../../general/hlogger_p.h"
 #include "../../utils/hsysutils_p.h"
+#include "../../utils/hstallwatchdog_p.h"
+#include "../../utils/htimerwheel_p.h"
+#include "../../utils/hnetworkthread_p.h"
 
 #include <QtCore/QUrl>
 #include <QtCore/QString>
+#include <QtCore/QDateTime>
 
 #include <QtCore/QMetaType>
 
@@ -61,6 +70,219 @@ namespace Herqq
 namespace Upnp
 {
 
+namespace
+{
+// the maximum number of repeat keys remembered before the cache is reset
+const qint32 MaxKnownAnnouncements = 4096;
+
+// the granularity of the device expiries
+const qint32 ExpiryTickInMsecs = 1000;
+
+// the total time the shutdown waits for the event subscriptions to be
+// cancelled
+const qint32 UnsubscribeDeadlineInMsecs = 1000;
+
+inline HDeviceExpiry::Source expirySource(const HResourceAvailable&)
+{
+    return HDeviceExpiry::Announcement;
+}
+
+inline HDeviceExpiry::Source expirySource(const HDiscoveryResponse&)
+{
+    return HDeviceExpiry::DiscoveryResponse;
+}
+
+// the number of services in the device tree
+qint32 countServices(const HClientDevice* device)
+{
+    qint32 retVal = device->services().size();
+    foreach(const HClientDevice* embedded, device->embeddedDevices())
+    {
+        retVal += countServices(embedded);
+    }
+    return retVal;
+}
+
+void collectUdns(const HClientDevice* device, QList<HUdn>* udns)
+{
+    udns->append(device->info().udn());
+    foreach(const HClientDevice* embedded, device->embeddedDevices())
+    {
+        collectUdns(embedded, udns);
+    }
+}
+
+bool hasSubscriptions(
+    const HEventSubscriptionManager* subscriber, const HClientDevice* device)
+{
+    foreach(const HClientService* service, device->services())
+    {
+        if (subscriber->subscriptionStatus(service) ==
+            HEventSubscription::Status_Subscribed)
+        {
+            return true;
+        }
+    }
+    foreach(const HClientDevice* embedded, device->embeddedDevices())
+    {
+        if (hasSubscriptions(subscriber, embedded))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// the builds of the devices that answered a search of the control point are
+// started before the builds triggered by unsolicited announcements
+inline qint32 buildPriority(const HResourceAvailable&)
+{
+    return 0;
+}
+
+inline qint32 buildPriority(const HDiscoveryResponse&)
+{
+    return 1;
+}
+
+// returns true in case the device trees contain the same devices and the
+// same services in the same order
+bool hasSameStructure(const HClientDevice* device, const HClientDevice* other)
+{
+    if (device->info().udn() != other->info().udn() ||
+        device->info().deviceType() != other->info().deviceType())
+    {
+        return false;
+    }
+
+    HClientServices services = device->services();
+    HClientServices otherServices = other->services();
+    if (services.size() != otherServices.size())
+    {
+        return false;
+    }
+
+    for (qint32 i = 0; i < services.size(); ++i)
+    {
+        if (services[i]->info().serviceId() !=
+            otherServices[i]->info().serviceId())
+        {
+            return false;
+        }
+    }
+
+    HClientDevices devices = device->embeddedDevices();
+    HClientDevices otherDevices = other->embeddedDevices();
+    if (devices.size() != otherDevices.size())
+    {
+        return false;
+    }
+
+    for (qint32 i = 0; i < devices.size(); ++i)
+    {
+        if (!hasSameStructure(devices[i], otherDevices[i]))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+typedef QPair<HDefaultClientService*, HDefaultClientService*> ServicePair;
+
+// updates the information of the devices of a tree from another build of the
+// tree and lists the services whose information or description changed,
+// each with its counterpart in the other build
+void updateDevices(
+    HDefaultClientDevice* device, HDefaultClientDevice* build,
+    QList<ServicePair>* changed)
+{
+    device->update(*build);
+
+    HClientServices services = device->services();
+    HClientServices builtServices = build->services();
+    for (qint32 i = 0; i < services.size(); ++i)
+    {
+        HDefaultClientService* service =
+            static_cast<HDefaultClientService*>(services[i]);
+
+        HDefaultClientService* builtService =
+            static_cast<HDefaultClientService*>(builtServices[i]);
+
+        // a service whose description has not been loaded yet loads the
+        // current description when it is first accessed
+        if (!(service->info() == builtService->info()) ||
+            (service->hasDescription() &&
+             !service->hasSameDescription(*builtService)))
+        {
+            changed->append(ServicePair(service, builtService));
+        }
+    }
+
+    HClientDevices devices = device->embeddedDevices();
+    HClientDevices builtDevices = build->embeddedDevices();
+    for (qint32 i = 0; i < devices.size(); ++i)
+    {
+        updateDevices(
+            static_cast<HDefaultClientDevice*>(devices[i]),
+            static_cast<HDefaultClientDevice*>(builtDevices[i]), changed);
+    }
+}
+
+//
+// Runs HControlPoint::init() in the network thread of the control point
+//
+class InitCall
+{
+private:
+
+    HControlPoint* m_controlPoint;
+    bool* m_retVal;
+
+public:
+
+    InitCall(HControlPoint* controlPoint, bool* retVal) :
+        m_controlPoint(controlPoint), m_retVal(retVal)
+    {
+    }
+
+    void operator()()
+    {
+        *m_retVal = m_controlPoint->init();
+    }
+};
+}
+
+/*******************************************************************************
+ * HDeviceExpiry
+ ******************************************************************************/
+QString HDeviceExpiry::toString() const
+{
+    QString source;
+    switch(m_source)
+    {
+    case DeviceAdded:
+        source = "the device was added";
+        break;
+    case Announcement:
+        source = "the last announcement";
+        break;
+    case DiscoveryResponse:
+        source = "the last discovery response";
+        break;
+    case RepeatedAdvertisement:
+        source = "the last repeated advertisement";
+        break;
+    default:
+        Q_ASSERT(false);
+    }
+
+    return QString(
+        "no advertisement was received within [%1] seconds after %2").arg(
+            QString::number(m_timeoutInSecs), source);
+}
+
 /*******************************************************************************
  * ControlPointHttpServer
  ******************************************************************************/
@@ -97,6 +319,76 @@ void ControlPointHttpServer::incomingNotifyMessage(
     m_httpHandler->send(mi, HHttpMessageCreator::createResponse(statusCode, *mi));
 }
 
+void ControlPointHttpServer::incomingUnknownGetRequest(
+    HMessagingInfo* mi, const HHttpRequestHeader& requestHdr)
+{
+    HLOG2(H_AT, H_FUN, m_owner->m_loggingIdentifier);
+
+    QString metricsPath = m_owner->m_configuration->metricsPath();
+    if (metricsPath.isEmpty() || requestHdr.path() != metricsPath)
+    {
+        HLOG_WARN(QString("Responding NOT_FOUND [%1] to [%2].").arg(
+            requestHdr.path(), peerAsStr(mi->socket())));
+
+        m_httpHandler->send(
+            mi, HHttpMessageCreator::createResponse(NotFound, *mi));
+
+        return;
+    }
+
+    const HControlPointRuntimeStatus& status = *m_owner->m_runtimeStatus;
+
+    HOpenMetricsWriter writer;
+    addSsdpMetrics(writer, status);
+
+    writer.begin(
+        "hupnp_device_builds", "counter", "Device model builds started.");
+    writer.add("hupnp_device_builds_total", status.startedDeviceBuilds());
+
+    writer.begin(
+        "hupnp_device_build_failures", "counter",
+        "Device model builds that failed.");
+    writer.add(
+        "hupnp_device_build_failures_total", status.failedDeviceBuilds());
+
+    writer.begin(
+        "hupnp_device_build_latency_seconds", "summary",
+        "Duration of the recent device model builds.");
+    writer.addSummary(
+        "hupnp_device_build_latency_seconds",
+        status.deviceBuildLatency(50), status.deviceBuildLatency(90),
+        status.deviceBuildLatency(99), m_owner->m_buildLatencies.count());
+
+    writer.begin(
+        "hupnp_device_builds_pending", "gauge",
+        "Device model builds queued or in progress.");
+    writer.add("hupnp_device_builds_pending", status.pendingDeviceBuilds());
+
+    writer.begin(
+        "hupnp_event_subscriptions", "gauge", "Active event subscriptions.");
+    writer.add("hupnp_event_subscriptions", status.activeSubscriptions());
+
+    writer.begin(
+        "hupnp_event_subscription_failures", "counter",
+        "Subscription attempts that failed.");
+    writer.add(
+        "hupnp_event_subscription_failures_total",
+        status.failedSubscriptions());
+
+    writer.begin(
+        "hupnp_event_notifications_received", "counter",
+        "Event notifications received.");
+    writer.add(
+        "hupnp_event_notifications_received_total",
+        status.receivedEventNotifications());
+
+    addStallMetrics(writer, status);
+    addMemoryMetrics(writer);
+
+    m_httpHandler->send(mi, HHttpMessageCreator::createResponse(
+        Ok, *mi, writer.finish(), ContentType_OpenMetrics));
+}
+
 /*******************************************************************************
  * HControlPointSsdpHandler
  ******************************************************************************/
@@ -105,6 +397,7 @@ HControlPointSsdpHandler::HControlPointSsdpHandler(
         HSsdp(owner->m_loggingIdentifier, owner), m_owner(owner)
 {
     setFilter(DiscoveryResponse | DeviceUnavailable | DeviceAvailable);
+    h_ptr->m_repeatFilter = this;
 }
 
 HControlPointSsdpHandler::~HControlPointSsdpHandler()
@@ -112,6 +405,12 @@ HControlPointSsdpHandler::~HControlPointSsdpHandler()
     HLOG2(H_AT, H_FUN, h_ptr->m_loggingIdentifier);
 }
 
+bool HControlPointSsdpHandler::handleRepeat(
+    const QByteArray& key, const HEndpoint& /*source*/)
+{
+    return m_owner->processRepeatedDiscovery(key);
+}
+
 bool HControlPointSsdpHandler::incomingDiscoveryResponse(
     const HDiscoveryResponse& msg, const HEndpoint& source)
 {
@@ -148,8 +447,27 @@ HControlPointPrivate::HControlPointPrivate() :
         m_nam(new QNetworkAccessManager(this)),
         m_state(HControlPointPrivate::Uninitialized),
         m_threadPool(new HThreadPool(this)),
-        m_deviceStorage(m_loggingIdentifier)
+        m_descriptionCache(0),
+        m_serviceDescriptionCache(),
+        m_iconCache(),
+        m_deviceStorage(m_loggingIdentifier),
+        m_knownAnnouncements(),
+        m_expiryWheel(
+            new HTimerWheel(ExpiryTickInMsecs, this)),
+        m_expiries(),
+        m_discoveryScheduler(0),
+        m_lastUses(),
+        m_useCount(0),
+        m_evictedDevices(),
+        m_evictedUdns(),
+        m_limitCheckPending(false),
+        m_runtimeStatus(new HControlPointRuntimeStatus()),
+        m_startedBuilds(0),
+        m_failedBuilds(0),
+        m_buildLatencies(),
+        m_networkThread(0)
 {
+    m_runtimeStatus->h_ptr->m_owner = this;
 }
 
 HControlPointPrivate::~HControlPointPrivate()
@@ -158,47 +476,130 @@ HControlPointPrivate::~HControlPointPrivate()
 }
 
 HDefaultClientDevice* HControlPointPrivate::buildDevice(
-    const QUrl& deviceLocation, qint32 maxAgeInSecs, QString* err)
+    const QUrl& deviceLocation, qint32 maxAgeInSecs, const HUdn& udn,
+    qint32 configId, bool allDescriptions, HDataRetriever* dataRetriever,
+    QByteArray* cachedDescription, QString* err, quint32 requestId)
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
-    HDataRetriever dataRetriever(m_loggingIdentifier);
+    HTraceSpan span("build", "description", requestId);
+
+    HDescriptionCacheEntry entry;
+    bool cached = m_descriptionCache &&
+        m_descriptionCache->get(udn, deviceLocation, configId, &entry);
 
-    QString deviceDescr;
-    if (!dataRetriever.retrieveDeviceDescription(deviceLocation, &deviceDescr))
+    if (!cached)
     {
-        *err = dataRetriever.lastError();
-        return 0;
+        if (!dataRetriever->retrieveDeviceDescription(
+                deviceLocation, &entry.m_deviceDescription))
+        {
+            *err = dataRetriever->lastError();
+            return 0;
+        }
+
+        // every service description is requested before the model is built,
+        // so that the build waits roughly a single round trip instead of one
+        // round trip for each service
+        if (allDescriptions || !m_configuration->serviceDescriptionsOnDemand())
+        {
+            dataRetriever->prefetchServiceDescriptions(
+                extractBaseUrl(deviceLocation), entry.m_deviceDescription);
+        }
     }
 
     QList<QUrl> deviceLocations;
     deviceLocations.push_back(deviceLocation);
 
+    HCachingDescriptionFetcher fetcher(dataRetriever, &entry);
+
     HClientModelCreationArgs creatorParams(m_nam);
-    creatorParams.m_deviceDescription = deviceDescr;
+    creatorParams.m_serviceDescriptionCache = &m_serviceDescriptionCache;
+    creatorParams.m_iconCache = &m_iconCache;
+    creatorParams.m_serviceDescriptionsOnDemand =
+        !allDescriptions && m_configuration->serviceDescriptionsOnDemand();
+    creatorParams.m_maxConcurrentInvocations =
+        m_configuration->maxConcurrentInvocations();
+    creatorParams.m_deviceDescription = entry.m_deviceDescription;
     creatorParams.m_deviceLocations = deviceLocations;
 
     creatorParams.m_serviceDescriptionFetcher =
-        ServiceDescriptionFetcher(
-            &dataRetriever, &HDataRetriever::retrieveServiceDescription);
+        ServiceDescriptionDataFetcher(
+            &fetcher, &HCachingDescriptionFetcher::retrieveServiceDescription);
 
     creatorParams.m_deviceTimeoutInSecs = maxAgeInSecs;
 
-    creatorParams.m_iconFetcher =
-        IconFetcher(&dataRetriever, &HDataRetriever::retrieveIcon);
-
     creatorParams.m_loggingIdentifier = m_loggingIdentifier;
 
+    // the model stage includes the retrieval of the service descriptions
+    // that were not prefetched
+    span.next("model");
+
     HClientModelCreator creator(creatorParams);
     HDefaultClientDevice* device = creator.createRootDevice();
-    if (!device && err)
+    span.end();
+    if (!device)
+    {
+        if (cached)
+        {
+            // the cached descriptions did not produce a device, in which case
+            // they are dropped and the device is built from the network
+            m_descriptionCache->remove(udn, deviceLocation, configId);
+
+            return buildDevice(
+                deviceLocation, maxAgeInSecs, udn, configId, allDescriptions,
+                dataRetriever, cachedDescription, err, requestId);
+        }
+
+        if (err)
+        {
+            *err = creator.lastErrorDescription();
+        }
+    }
+    else if (m_descriptionCache)
     {
-        *err = creator.lastErrorDescription();
+        if (!cached || fetcher.networkUsed())
+        {
+            m_descriptionCache->put(udn, deviceLocation, configId, entry);
+        }
+        else
+        {
+            *cachedDescription = entry.m_deviceDescription;
+        }
     }
 
     return device;
 }
 
+HControlPointSsdpHandler* HControlPointPrivate::createSsdpHandler()
+{
+    HControlPointSsdpHandler* retVal = new HControlPointSsdpHandler(this);
+
+    retVal->setReceiveBufferSize(m_configuration->ssdpReceiveBufferSize());
+    retVal->setSendBufferSize(m_configuration->ssdpSendBufferSize());
+    retVal->setReceiveThreadEnabled(
+        m_configuration->ssdpReceiveThreadsEnabled());
+    retVal->setMulticastSharingEnabled(m_configuration->sharedSsdpEnabled());
+
+    return retVal;
+}
+
+void HControlPointPrivate::updateNetworkAddresses()
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    QList<QHostAddress> addrs;
+    for(qint32 i = 0; i < m_ssdps.size(); ++i)
+    {
+        addrs.append(m_ssdps[i].second->unicastEndpoint().hostAddress());
+    }
+
+    if (!m_configuration->setNetworkAddressesToUse(addrs))
+    {
+        // some other address in use has disappeared as well
+        HLOG_WARN("Not all the network addresses in use are local addresses");
+    }
+}
+
 bool HControlPointPrivate::addRootDevice(HDefaultClientDevice* newRootDevice)
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
@@ -231,7 +632,7 @@ bool HControlPointPrivate::addRootDevice(HDefaultClientDevice* newRootDevice)
     }
 
     newRootDevice->setParent(this);
-    newRootDevice->startStatusNotifier(HDefaultClientDevice::All);
+    scheduleExpiry(newRootDevice, HDeviceExpiry::DeviceAdded);
 
     bool ok = connect(
         newRootDevice, SIGNAL(statusTimeout(HDefaultClientDevice*)),
@@ -246,9 +647,20 @@ bool HControlPointPrivate::addRootDevice(HDefaultClientDevice* newRootDevice)
                 newRootDevice->info().udn().toSimpleUuid(),
                 m_deviceStorage.lastError()));
 
+        cancelExpiry(newRootDevice);
         return false;
     }
 
+    // a device that was evicted is added again either because the
+    // application asked for it, or because its tree changed
+    forgetEvicted(newRootDevice->info().udn());
+    m_lastUses.insert(newRootDevice, ++m_useCount);
+
+    if (m_discoveryScheduler)
+    {
+        m_discoveryScheduler->churn();
+    }
+
     emit q_ptr->rootDeviceOnline(newRootDevice);
     return true;
 }
@@ -259,17 +671,93 @@ void HControlPointPrivate::deviceExpired(HDefaultClientDevice* source)
     Q_ASSERT(thread() == QThread::currentThread());
 
     // according to the UDA v1.1 a "device tree" (root, embedded and services)
-    // are "timed out" only when every advertisement has timed out.
+    // are "timed out" only when every advertisement has timed out. every
+    // advertisement of the tree postpones the expiry of the root device,
+    // which is why the expiry of it times out the entire tree.
+
+    Q_ASSERT(!source->parentDevice());
+
+    HDeviceExpiry expiry = m_expiries.take(source);
+
+    HLOG_INFO(QString("Device [%1] expired: %2.").arg(
+        source->info().udn().toString(), expiry.toString()));
+
+    forgetAnnouncements(source);
+    source->deviceStatus()->setOnline(false);
+    m_eventSubscriber->cancel(
+        source, VisitThisRecursively, false);
+
+    if (m_discoveryScheduler)
+    {
+        m_discoveryScheduler->churn();
+    }
+
+    emit q_ptr->rootDeviceOffline(source);
+}
+
+void HControlPointPrivate::scheduleExpiry(
+    HDefaultClientDevice* root, HDeviceExpiry::Source source)
+{
+    Q_ASSERT(root && !root->parentDevice());
+
+    qint32 timeoutInSecs = root->deviceTimeoutInSecs();
+
+    m_expiries.insert(root, HDeviceExpiry(source, timeoutInSecs));
+    m_expiryWheel->schedule(root, "timeout_", timeoutInSecs * 1000);
+}
 
-    source = static_cast<HDefaultClientDevice*>(source->rootDevice());
+qint32 HControlPointPrivate::sendDiscoveryRequests()
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
-    if (source->isTimedout(HDefaultClientDevice::All))
+    HDiscoveryRequest req(
+        1,
+        HDiscoveryType::createDiscoveryTypeForRootDevices(),
+        HSysInfo::instance().herqqProductTokens());
+
+    qint32 sent = 0;
+    for(qint32 i = 0; i < m_ssdps.size(); ++i)
     {
-        source->deviceStatus()->setOnline(false);
-        m_eventSubscriber->cancel(
-            source, VisitThisRecursively, false);
+        QString ep = m_ssdps[i].second->unicastEndpoint().toString();
+
+        HLOG_DBG(QString(
+            "Sending discovery request using endpoint [%1]").arg(ep));
+
+        qint32 messagesSent = m_ssdps[i].second->sendDiscoveryRequest(req);
+        if (messagesSent <= 0)
+        {
+            HLOG_WARN(QString(
+                "Failed to send discovery request using endpoint "
+                "[%1]").arg(ep));
+        }
+        else
+        {
+            sent += messagesSent;
+        }
+    }
+
+    return sent;
+}
+
+void HControlPointPrivate::cancelExpiry(HDefaultClientDevice* root)
+{
+    m_expiryWheel->unschedule(root);
+    m_expiries.remove(root);
+}
 
-        emit q_ptr->rootDeviceOffline(source);
+void HControlPointPrivate::subscribed(HClientService* service)
+{
+    Q_ASSERT(service);
+    touch(service->parentDevice());
+
+    // the limits are not checked during the emission, as the subscription
+    // manager still uses the subscription when this returns
+    if (m_configuration->maxSubscriptions() > 0 && !m_limitCheckPending)
+    {
+        m_limitCheckPending = true;
+        bool ok = QMetaObject::invokeMethod(
+            this, "enforceLimits", Qt::QueuedConnection);
+        Q_ASSERT(ok); Q_UNUSED(ok)
     }
 }
 
@@ -280,6 +768,41 @@ void HControlPointPrivate::unsubscribed(HClientService* service)
     emit q_ptr->subscriptionCanceled(service);
 }
 
+bool HControlPointPrivate::processRepeatedDiscovery(const QByteArray& repeatKey)
+{
+    HDefaultClientDevice* device = m_knownAnnouncements.value(repeatKey);
+    if (!device)
+    {
+        return false;
+    }
+
+    // the announcement is identical to one already processed while the
+    // device has been online. only the timeouts need refreshing.
+    Q_ASSERT(device->deviceStatus()->online());
+    scheduleExpiry(device, HDeviceExpiry::RepeatedAdvertisement);
+
+    return true;
+}
+
+void HControlPointPrivate::forgetAnnouncements(
+    const HClientDevice* rootDevice)
+{
+    QHash<QByteArray, HDefaultClientDevice*>::iterator it =
+        m_knownAnnouncements.begin();
+
+    while (it != m_knownAnnouncements.end())
+    {
+        if (it.value() == rootDevice)
+        {
+            it = m_knownAnnouncements.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
 bool HControlPointPrivate::processDeviceOffline(
     const HResourceUnavailable& msg, const HEndpoint& /*source*/,
     HControlPointSsdpHandler* /*origin*/)
@@ -296,6 +819,12 @@ bool HControlPointPrivate::processDeviceOffline(
         // the device is not known by us.
         // note that even service announcements contain the "UDN", which identifies
         // the device that contains them.
+        QHash<HUdn, HUdn>::const_iterator it =
+            m_evictedUdns.constFind(msg.usn().udn());
+        if (it != m_evictedUdns.constEnd())
+        {
+            forgetEvicted(it.value());
+        }
         return true;
     }
 
@@ -314,12 +843,18 @@ bool HControlPointPrivate::processDeviceOffline(
 
         Q_ASSERT(root);
 
+        forgetAnnouncements(root);
         root->deviceStatus()->setOnline(false);
 
         m_eventSubscriber->remove(root, true);
 
         root->clearLocations();
-        root->stopStatusNotifier(HDefaultClientDevice::All);
+        cancelExpiry(root);
+
+        if (m_discoveryScheduler)
+        {
+            m_discoveryScheduler->churn();
+        }
 
         emit q_ptr->rootDeviceOffline(root);
     }
@@ -327,12 +862,40 @@ bool HControlPointPrivate::processDeviceOffline(
     return true;
 }
 
+template<typename Msg>
+void HControlPointPrivate::startDeviceBuild(const Msg& msg, bool refresh)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    DeviceBuildTask* newBuildTask = new DeviceBuildTask(this, msg, refresh);
+    ++m_startedBuilds;
+
+    newBuildTask->setAutoDelete(false);
+
+    m_deviceBuildTasks.add(newBuildTask);
+
+    bool ok = connect(
+        newBuildTask, SIGNAL(done(Herqq::Upnp::HUdn)),
+        this, SLOT(deviceModelBuildDone(Herqq::Upnp::HUdn)));
+
+    Q_ASSERT(ok); Q_UNUSED(ok)
+
+    m_threadPool->start(newBuildTask, buildPriority(msg));
+}
+
 template<typename Msg>
 bool HControlPointPrivate::processDeviceDiscovery(
-    const Msg& msg, const HEndpoint& source, HControlPointSsdpHandler*)
+    const Msg& msg, const HEndpoint& source, HControlPointSsdpHandler* origin)
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
+    if (m_state == Exiting)
+    {
+        // the shutdown may process events while it waits for the event
+        // subscriptions to be cancelled
+        return true;
+    }
+
     const HUdn& resourceUdn = msg.usn().udn();
 
     HDefaultClientDevice* device =
@@ -341,13 +904,38 @@ bool HControlPointPrivate::processDeviceDiscovery(
 
     if (device)
     {
+        HDefaultClientDevice* root =
+            static_cast<HDefaultClientDevice*>(device->rootDevice());
+
+        qint32 configId = root->deviceStatus()->configId();
+        if (configId >= 0 && msg.configId() >= 0 &&
+            msg.configId() != configId && !m_deviceBuildTasks.get(msg) &&
+            !m_deviceBuildTasks.isFull())
+        {
+            // the configuration of the device has changed. the description
+            // is fetched again and only the services that changed are
+            // replaced once the build is done. until then the device is
+            // used as it is
+            HLOG_INFO(QString(
+                "The config ID of device [%1] changed from [%2] to [%3]. "
+                "Fetching the new configuration.").arg(
+                    root->info().udn().toString(), QString::number(configId),
+                    QString::number(msg.configId())));
+
+            startDeviceBuild(msg, true);
+        }
+
         // according to the UDA v1.1 spec, if a control point receives an
         // alive announcement of any type for a device tree, the control point
         // can assume that all devices and services are available.
         // ==> reset timeouts for entire device tree and all services.
 
-        device = static_cast<HDefaultClientDevice*>(device->rootDevice());
-        device->startStatusNotifier(HDefaultClientDevice::All);
+        device = root;
+        scheduleExpiry(device, expirySource(msg));
+
+        // the port, at which the device receives unicast M-SEARCH requests,
+        // -1 if it is the default port 1900
+        device->deviceStatus()->setSearchPort(msg.searchPort());
 
         // it cannot be that only some embedded device is available at certain
         // interface, since the device description is always fetched from the
@@ -366,6 +954,17 @@ bool HControlPointPrivate::processDeviceDiscovery(
             processDeviceOnline(device, false);
         }
 
+        // the next repetition of this message can bypass all of the above
+        const QByteArray& repeatKey = origin->repeatKey();
+        if (!repeatKey.isEmpty() && device->deviceStatus()->online())
+        {
+            if (m_knownAnnouncements.size() >= MaxKnownAnnouncements)
+            {
+                m_knownAnnouncements.clear();
+            }
+            m_knownAnnouncements.insert(repeatKey, device);
+        }
+
         return true;
     }
 
@@ -377,11 +976,18 @@ bool HControlPointPrivate::processDeviceDiscovery(
     DeviceBuildTask* dbp = m_deviceBuildTasks.get(msg);
     if (dbp)
     {
-        if (!dbp->m_locations.contains(msg.location()))
-        {
-            dbp->m_locations.push_back(msg.location());
-        }
+        m_deviceBuildTasks.addLocation(dbp, msg.location());
+        return true;
+    }
 
+    if (processEvictedDiscovery(msg))
+    {
+        // the device is built again only once the application asks for it
+        return true;
+    }
+
+    if (!passesDiscoveryFilter(msg.usn()))
+    {
         return true;
     }
 
@@ -393,28 +999,311 @@ bool HControlPointPrivate::processDeviceDiscovery(
         return true;
     }
 
-    DeviceBuildTask* newBuildTask = new DeviceBuildTask(this, msg);
-
-    newBuildTask->setAutoDelete(false);
-
-    m_deviceBuildTasks.add(newBuildTask);
-
-    bool ok = connect(
-        newBuildTask, SIGNAL(done(Herqq::Upnp::HUdn)),
-        this, SLOT(deviceModelBuildDone(Herqq::Upnp::HUdn)));
+    if (m_deviceBuildTasks.isFull())
+    {
+        // the device will be found by a later advertisement or search
+        HLOG_DBG(QString(
+            "Ignoring resource advertisement [%1]: too many device builds "
+            "are pending").arg(msg.usn().toString()));
 
-    Q_ASSERT(ok); Q_UNUSED(ok)
+        return true;
+    }
 
     HLOG_INFO(QString(
         "New resource [%1] is available @ [%2]. "
         "Attempting to build the device model.").arg(
             msg.usn().toString(), msg.location().toString()));
 
-    m_threadPool->start(newBuildTask);
+    startDeviceBuild(msg, false);
 
     return true;
 }
 
+template<typename Msg>
+bool HControlPointPrivate::processEvictedDiscovery(const Msg& msg)
+{
+    QHash<HUdn, HUdn>::const_iterator it =
+        m_evictedUdns.constFind(msg.usn().udn());
+
+    if (it == m_evictedUdns.constEnd())
+    {
+        return false;
+    }
+
+    HEvictedDevice& evicted = m_evictedDevices[it.value()];
+    evicted.m_location = msg.location();
+    evicted.m_cacheControlMaxAge = msg.cacheControlMaxAge();
+    evicted.m_bootId = msg.bootId();
+    evicted.m_configId = msg.configId();
+    evicted.m_searchPort = msg.searchPort();
+    evicted.m_advertised.start();
+
+    return true;
+}
+
+bool HControlPointPrivate::hasLimits() const
+{
+    return m_configuration->maxRootDevices() > 0 ||
+           m_configuration->maxServices() > 0 ||
+           m_configuration->maxSubscriptions() > 0;
+}
+
+void HControlPointPrivate::touch(const HClientDevice* device)
+{
+    if (!device || !hasLimits())
+    {
+        return;
+    }
+
+    QHash<const HClientDevice*, quint64>::iterator it =
+        m_lastUses.find(device->rootDevice());
+
+    if (it != m_lastUses.end())
+    {
+        it.value() = ++m_useCount;
+    }
+}
+
+void HControlPointPrivate::enforceLimits()
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    m_limitCheckPending = false;
+    if (m_state != Initialized || !hasLimits())
+    {
+        return;
+    }
+
+    qint32 maxRootDevices = m_configuration->maxRootDevices();
+    qint32 maxServices = m_configuration->maxServices();
+    qint32 maxSubscriptions = m_configuration->maxSubscriptions();
+
+    for(;;)
+    {
+        HClientDevices roots = m_deviceStorage.rootDevices();
+        if (roots.size() < 2)
+        {
+            break;
+        }
+
+        bool tooManyRoots = maxRootDevices > 0 && roots.size() > maxRootDevices;
+
+        bool tooManyServices = false;
+        if (maxServices > 0)
+        {
+            qint32 services = 0;
+            foreach(const HClientDevice* root, roots)
+            {
+                services += countServices(root);
+            }
+            tooManyServices = services > maxServices;
+        }
+
+        bool tooManySubscriptions = maxSubscriptions > 0 &&
+            m_eventSubscriber->activeSubscriptionCount() > maxSubscriptions;
+
+        if (!tooManyRoots && !tooManyServices && !tooManySubscriptions)
+        {
+            break;
+        }
+
+        // the device used last is never evicted. when only the subscriptions
+        // exceed their limit, only a device that has some of them will do
+        const HClientDevice* lastUsed = roots[0];
+        foreach(const HClientDevice* root, roots)
+        {
+            if (m_lastUses.value(root) > m_lastUses.value(lastUsed))
+            {
+                lastUsed = root;
+            }
+        }
+
+        HClientDevice* victim = 0;
+        foreach(HClientDevice* root, roots)
+        {
+            if (root == lastUsed ||
+                (victim && m_lastUses.value(root) >= m_lastUses.value(victim)))
+            {
+                continue;
+            }
+
+            if (!tooManyRoots && !tooManyServices &&
+                !hasSubscriptions(m_eventSubscriber, root))
+            {
+                continue;
+            }
+
+            victim = root;
+        }
+
+        if (!victim)
+        {
+            break;
+        }
+
+        evict(static_cast<HDefaultClientDevice*>(victim));
+    }
+}
+
+void HControlPointPrivate::evict(HDefaultClientDevice* root)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+    Q_ASSERT(root && !root->parentDevice());
+
+    HDeviceInfo info(root->info());
+    HLOG_INFO(QString(
+        "Evicting the model of device [%1] to stay within the limits of "
+        "the configuration").arg(info.udn().toString()));
+
+    // the evicted devices that are no longer advertised are forgotten here,
+    // since nothing else refers to them
+    QHash<HUdn, HEvictedDevice>::iterator it = m_evictedDevices.begin();
+    while (it != m_evictedDevices.end())
+    {
+        if (it->isExpired())
+        {
+            foreach(const HUdn& udn, it->m_udns)
+            {
+                m_evictedUdns.remove(udn);
+            }
+            it = m_evictedDevices.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    QList<QUrl> locations = root->locations();
+    if (root->deviceStatus()->online() && !locations.isEmpty())
+    {
+        HEvictedDevice evicted;
+        collectUdns(root, &evicted.m_udns);
+        evicted.m_location = locations.first();
+        evicted.m_cacheControlMaxAge = root->deviceTimeoutInSecs();
+        evicted.m_bootId = root->deviceStatus()->bootId();
+        evicted.m_configId = root->deviceStatus()->configId();
+        evicted.m_searchPort = root->deviceStatus()->searchPort();
+        evicted.m_advertised.start();
+
+        foreach(const HUdn& udn, evicted.m_udns)
+        {
+            m_evictedUdns.insert(udn, info.udn());
+        }
+        m_evictedDevices.insert(info.udn(), evicted);
+    }
+
+    m_eventSubscriber->remove(root, true);
+    forgetAnnouncements(root);
+    cancelExpiry(root);
+    m_lastUses.remove(root);
+
+    if (m_deviceStorage.removeRootDevice(root))
+    {
+        emit q_ptr->rootDeviceEvicted(info);
+    }
+}
+
+void HControlPointPrivate::forgetEvicted(const HUdn& rootUdn)
+{
+    QHash<HUdn, HEvictedDevice>::iterator it =
+        m_evictedDevices.find(rootUdn);
+
+    if (it != m_evictedDevices.end())
+    {
+        foreach(const HUdn& udn, it->m_udns)
+        {
+            m_evictedUdns.remove(udn);
+        }
+        m_evictedDevices.erase(it);
+    }
+}
+
+bool HControlPointPrivate::rebuildEvicted(const HUdn& udn)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    QHash<HUdn, HUdn>::const_iterator it = m_evictedUdns.constFind(udn);
+    if (it == m_evictedUdns.constEnd() || m_deviceBuildTasks.isFull())
+    {
+        return false;
+    }
+
+    HUdn rootUdn = it.value();
+    HEvictedDevice evicted = m_evictedDevices.value(rootUdn);
+    forgetEvicted(rootUdn);
+
+    if (evicted.isExpired())
+    {
+        return false;
+    }
+
+    // the build is prioritized as if the device had answered a search,
+    // since the application is waiting for it
+    HDiscoveryResponse msg(
+        evicted.m_cacheControlMaxAge, QDateTime::currentDateTime(),
+        evicted.m_location, HProductTokens(), HDiscoveryType(rootUdn),
+        evicted.m_bootId, evicted.m_configId, evicted.m_searchPort);
+
+    if (!m_deviceBuildTasks.get(msg))
+    {
+        HLOG_INFO(QString("Rebuilding the evicted device [%1]").arg(
+            rootUdn.toString()));
+
+        startDeviceBuild(msg, false);
+    }
+
+    return true;
+}
+
+bool HControlPointPrivate::passesDiscoveryFilter(
+    const HDiscoveryType& resource) const
+{
+    QList<HDiscoveryType> filter = m_configuration->discoveryFilter();
+
+    if (filter.isEmpty())
+    {
+        return true;
+    }
+
+    foreach(const HDiscoveryType& accepted, filter)
+    {
+        if (accepted.udn().isValid(LooseChecks) &&
+            accepted.udn() != resource.udn())
+        {
+            continue;
+        }
+
+        switch(accepted.type())
+        {
+        case HDiscoveryType::RootDevices:
+        case HDiscoveryType::SpecificRootDevice:
+            if (resource.type() == HDiscoveryType::RootDevices ||
+                resource.type() == HDiscoveryType::SpecificRootDevice)
+            {
+                return true;
+            }
+            break;
+
+        case HDiscoveryType::DeviceType:
+        case HDiscoveryType::SpecificDeviceWithType:
+        case HDiscoveryType::ServiceType:
+        case HDiscoveryType::SpecificServiceWithType:
+            if (resource.resourceType().compare(
+                    accepted.resourceType(), HResourceType::EqualOrGreater))
+            {
+                return true;
+            }
+            break;
+
+        default:
+            return true;
+        }
+    }
+
+    return false;
+}
+
 void HControlPointPrivate::processDeviceOnline(
     HDefaultClientDevice* device, bool newDevice)
 {
@@ -469,43 +1358,328 @@ void HControlPointPrivate::processDeviceOnline(
                 device, VisitThisRecursively,
                 m_configuration->desiredSubscriptionTimeout());
         }
+        if (newDevice)
+        {
+            enforceLimits();
+        }
+    }
+}
+
+bool HControlPointPrivate::updateRootDevice(
+    HDefaultClientDevice* rootDevice, HDefaultClientDevice* build)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+    Q_ASSERT(rootDevice && build);
+
+    if (!hasSameStructure(rootDevice, build))
+    {
+        return false;
+    }
+
+    QList<ServicePair> changed;
+    updateDevices(rootDevice, build, &changed);
+
+    if (changed.isEmpty())
+    {
+        HLOG_INFO(QString(
+            "The services of device [%1] have not changed").arg(
+                rootDevice->info().udn().toString()));
+
+        return true;
+    }
+
+    HClientModelCreationArgs creatorParams(m_nam);
+    creatorParams.m_serviceDescriptionCache = &m_serviceDescriptionCache;
+    creatorParams.m_iconCache = &m_iconCache;
+    creatorParams.m_maxConcurrentInvocations =
+        m_configuration->maxConcurrentInvocations();
+    creatorParams.m_deviceLocations = build->locations();
+    creatorParams.m_loggingIdentifier = m_loggingIdentifier;
+
+    HClientModelCreator creator(creatorParams);
+
+    QList<HDefaultClientService*> resubscribe;
+
+    m_deviceStorage.beginTreeUpdate(rootDevice);
+
+    foreach(const ServicePair& pair, changed)
+    {
+        HDefaultClientService* oldService = pair.first;
+        HDefaultClientDevice* parentDevice = oldService->parentDevice();
+
+        // the new service is created into the existing device tree, so that
+        // its actions are invoked through the invocation channel of the tree
+        QScopedPointer<HDefaultClientService> newService(
+            new HDefaultClientService(pair.second->info(), parentDevice));
+
+        if (!creator.createServiceModel(
+                newService.data(), pair.second->descriptionData()))
+        {
+            HLOG_WARN(QString(
+                "Failed to replace service [%1]: %2").arg(
+                    oldService->info().serviceId().toString(),
+                    creator.lastErrorDescription()));
+
+            continue;
+        }
+
+        if (m_eventSubscriber->subscriptionStatus(oldService) !=
+            HEventSubscription::Status_Unsubscribed)
+        {
+            resubscribe.append(newService.data());
+        }
+        m_eventSubscriber->remove(oldService);
+
+        QList<HDefaultClientService*> services;
+        foreach(HClientService* service, parentDevice->services())
+        {
+            services.append(service == oldService ? newService.data() :
+                static_cast<HDefaultClientService*>(service));
+        }
+        parentDevice->setServices(services);
+        newService.take();
+
+        HLOG_INFO(QString("Service [%1] of device [%2] has changed").arg(
+            oldService->info().serviceId().toString(),
+            parentDevice->info().udn().toString()));
+
+        // the users may hold the old service until the control returns to
+        // the event loop
+        oldService->deleteLater();
+    }
+
+    m_deviceStorage.endTreeUpdate(rootDevice);
+
+    foreach(HDefaultClientService* service, resubscribe)
+    {
+        m_eventSubscriber->subscribe(
+            service, m_configuration->desiredSubscriptionTimeout());
+    }
+
+    return true;
+}
+
+void HControlPointPrivate::deviceModelBuildDone(const Herqq::Upnp::HUdn& udn)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    DeviceBuildTask* build = m_deviceBuildTasks.get(udn);
+    Q_ASSERT(build);
+
+    m_buildLatencies.add(build->elapsed());
+    if (build->completionValue() != 0)
+    {
+        ++m_failedBuilds;
+    }
+
+    if (m_state == Initialized)
+    {
+        // The check is done because it is possible that a user has called
+        // HControlPoint::quit() before this event is delivered.
+        if (build->completionValue() == 0)
+        {
+            HLOG_INFO(QString("Device model for [%1] built successfully.").arg(
+                udn.toString()));
+
+            HDefaultClientDevice* device = build->createdDevice();
+            Q_ASSERT(device);
+
+            HUdn rootUdn = device->info().udn();
+            HDefaultClientDevice* known = static_cast<HDefaultClientDevice*>(
+                m_deviceStorage.searchDeviceByUdn(rootUdn, RootDevices));
+
+            if (known)
+            {
+                if (updateRootDevice(known, device))
+                {
+                    delete device;
+                    device = 0;
+
+                    known->addLocations(build->m_locations);
+                    known->deviceStatus()->setConfigId(build->configId());
+
+                    emit q_ptr->rootDeviceUpdated(known);
+                }
+                else
+                {
+                    HLOG_INFO(QString(
+                        "The device tree of [%1] has changed. Replacing the "
+                        "device.").arg(rootUdn.toString()));
+
+                    emit q_ptr->rootDeviceInvalidated(known);
+
+                    // the device may have been removed while the signal
+                    // was delivered
+                    if (m_deviceStorage.searchDeviceByUdn(rootUdn, RootDevices))
+                    {
+                        q_ptr->removeRootDevice(known);
+                    }
+                }
+            }
+
+            if (device)
+            {
+                for (qint32 i = 0; i < build->m_locations.size(); ++i)
+                {
+                    device->addLocation(build->m_locations[i]);
+                }
+
+                device->deviceStatus()->setConfigId(build->configId());
+
+                processDeviceOnline(device, true);
+            }
+
+            if (device && m_descriptionCache &&
+                !build->cachedDescription().isEmpty())
+            {
+                m_descriptionCache->revalidate(
+                    m_nam, udn, build->m_locations[0], build->configId(),
+                    build->cachedDescription());
+            }
+        }
+        else
+        {
+            HLOG_WARN(QString("Device model for [%1] could not be built: %2.").arg(
+                udn.toString(), build->errorString()));
+        }
+    }
+
+    m_deviceBuildTasks.remove(udn);
+}
+
+/*******************************************************************************
+ * HControlPointRuntimeStatusPrivate
+ ******************************************************************************/
+HControlPointRuntimeStatusPrivate::HControlPointRuntimeStatusPrivate() :
+    m_owner(0)
+{
+}
+
+/*******************************************************************************
+ * HControlPointRuntimeStatus
+ ******************************************************************************/
+HControlPointRuntimeStatus::HControlPointRuntimeStatus() :
+    h_ptr(new HControlPointRuntimeStatusPrivate())
+{
+}
+
+HControlPointRuntimeStatus::~HControlPointRuntimeStatus()
+{
+    delete h_ptr;
+}
+
+qint64 HControlPointRuntimeStatus::ssdpMessagesReceived(
+    HSsdp::AllowedMessage type) const
+{
+    Q_ASSERT(h_ptr->m_owner);
+
+    qint64 retVal = 0;
+    for(qint32 i = 0; i < h_ptr->m_owner->m_ssdps.size(); ++i)
+    {
+        retVal += h_ptr->m_owner->m_ssdps[i].second->messagesReceived(type);
     }
+    return retVal;
 }
 
-void HControlPointPrivate::deviceModelBuildDone(const Herqq::Upnp::HUdn& udn)
+qint64 HControlPointRuntimeStatus::ssdpMessagesSent(
+    HSsdp::AllowedMessage type) const
 {
-    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+    Q_ASSERT(h_ptr->m_owner);
 
-    DeviceBuildTask* build = m_deviceBuildTasks.get(udn);
-    Q_ASSERT(build);
-
-    if (m_state == Initialized)
+    qint64 retVal = 0;
+    for(qint32 i = 0; i < h_ptr->m_owner->m_ssdps.size(); ++i)
     {
-        // The check is done because it is possible that a user has called
-        // HControlPoint::quit() before this event is delivered.
-        if (build->completionValue() == 0)
-        {
-            HLOG_INFO(QString("Device model for [%1] built successfully.").arg(
-                udn.toString()));
+        retVal += h_ptr->m_owner->m_ssdps[i].second->messagesSent(type);
+    }
+    return retVal;
+}
 
-            HDefaultClientDevice* device = build->createdDevice();
-            Q_ASSERT(device);
+qint64 HControlPointRuntimeStatus::ssdpDatagramsDropped(
+    HSsdp::DropReason reason) const
+{
+    Q_ASSERT(h_ptr->m_owner);
 
-            for (qint32 i = 0; i < build->m_locations.size(); ++i)
-            {
-                device->addLocation(build->m_locations[i]);
-            }
+    qint64 retVal = -1;
+    for(qint32 i = 0; i < h_ptr->m_owner->m_ssdps.size(); ++i)
+    {
+        qint64 dropped =
+            h_ptr->m_owner->m_ssdps[i].second->droppedDatagrams(reason);
 
-            processDeviceOnline(device, true);
-        }
-        else
+        if (dropped >= 0)
         {
-            HLOG_WARN(QString("Device model for [%1] could not be built: %2.").arg(
-                udn.toString(), build->errorString()));
+            retVal = qMax(retVal, Q_INT64_C(0)) + dropped;
         }
     }
+    return retVal;
+}
 
-    m_deviceBuildTasks.remove(udn);
+qint64 HControlPointRuntimeStatus::startedDeviceBuilds() const
+{
+    Q_ASSERT(h_ptr->m_owner);
+    return h_ptr->m_owner->m_startedBuilds;
+}
+
+qint64 HControlPointRuntimeStatus::failedDeviceBuilds() const
+{
+    Q_ASSERT(h_ptr->m_owner);
+    return h_ptr->m_owner->m_failedBuilds;
+}
+
+qint32 HControlPointRuntimeStatus::deviceBuildLatency(qint32 percentile) const
+{
+    Q_ASSERT(h_ptr->m_owner);
+    return h_ptr->m_owner->m_buildLatencies.percentile(percentile);
+}
+
+qint32 HControlPointRuntimeStatus::pendingDeviceBuilds() const
+{
+    Q_ASSERT(h_ptr->m_owner);
+    return h_ptr->m_owner->m_deviceBuildTasks.size();
+}
+
+qint32 HControlPointRuntimeStatus::activeSubscriptions() const
+{
+    Q_ASSERT(h_ptr->m_owner);
+    HEventSubscriptionManager* subscriber = h_ptr->m_owner->m_eventSubscriber;
+    return subscriber ? subscriber->activeSubscriptionCount() : 0;
+}
+
+qint64 HControlPointRuntimeStatus::failedSubscriptions() const
+{
+    Q_ASSERT(h_ptr->m_owner);
+    HEventSubscriptionManager* subscriber = h_ptr->m_owner->m_eventSubscriber;
+    return subscriber ? subscriber->failedSubscriptions() : 0;
+}
+
+qint64 HControlPointRuntimeStatus::receivedEventNotifications() const
+{
+    Q_ASSERT(h_ptr->m_owner);
+    HEventSubscriptionManager* subscriber = h_ptr->m_owner->m_eventSubscriber;
+    return subscriber ? subscriber->receivedEvents() : 0;
+}
+
+QStringList HControlPointRuntimeStatus::stalledHandlers() const
+{
+    Q_ASSERT(h_ptr->m_owner);
+    HHttpServer* server = h_ptr->m_owner->m_server;
+    return server ? server->stallWatchdog()->stalls().keys() : QStringList();
+}
+
+qint64 HControlPointRuntimeStatus::handlerStalls(const QString& handler) const
+{
+    Q_ASSERT(h_ptr->m_owner);
+    HHttpServer* server = h_ptr->m_owner->m_server;
+    return server ?
+        server->stallWatchdog()->stalls().value(handler).m_count : 0;
+}
+
+qint32 HControlPointRuntimeStatus::worstHandlerStall(
+    const QString& handler) const
+{
+    Q_ASSERT(h_ptr->m_owner);
+    HHttpServer* server = h_ptr->m_owner->m_server;
+    return server ?
+        server->stallWatchdog()->stalls().value(handler).m_worst : 0;
 }
 
 /*******************************************************************************
@@ -559,6 +1733,13 @@ HControlPoint::HControlPoint(
 HControlPoint::~HControlPoint()
 {
     quit();
+
+    if (h_ptr->m_networkThread)
+    {
+        h_ptr->m_networkThread->release();
+        h_ptr->m_networkThread = 0;
+    }
+
     delete h_ptr;
 }
 
@@ -602,6 +1783,13 @@ bool HControlPoint::init()
 {
     HLOG2(H_AT, H_FUN, h_ptr->m_loggingIdentifier);
 
+    if (h_ptr->m_networkThread && thread() != QThread::currentThread())
+    {
+        bool retVal = false;
+        h_ptr->m_networkThread->execute(InitCall(this, &retVal));
+        return retVal;
+    }
+
     Q_ASSERT_X(
         thread() == QThread::currentThread(), H_AT,
         "The control point has to be initialized in the thread in which it is "
@@ -616,6 +1804,25 @@ bool HControlPoint::init()
         return false;
     }
 
+    if (h_ptr->m_configuration->networkThreadEnabled() &&
+        !h_ptr->m_networkThread)
+    {
+        HNetworkThread* networkThread = new HNetworkThread(this);
+        if (!networkThread->attach())
+        {
+            delete networkThread;
+            setError(
+                InvalidArgumentError,
+                "A control point that has a parent cannot be run in "
+                "a network thread");
+
+            return false;
+        }
+
+        h_ptr->m_networkThread = networkThread;
+        return init();
+    }
+
     Q_ASSERT(h_ptr->m_state == HControlPointPrivate::Uninitialized);
 
     bool ok = true;
@@ -642,6 +1849,14 @@ bool HControlPoint::init()
 
     Q_ASSERT(ok);
 
+    ok = connect(
+        h_ptr->m_eventSubscriber,
+        SIGNAL(subscriptionProgress(qint32, qint32)),
+        this,
+        SIGNAL(subscriptionProgress(qint32, qint32)));
+
+    Q_ASSERT(ok);
+
     ok = connect(
         h_ptr->m_eventSubscriber,
         SIGNAL(unsubscribed(Herqq::Upnp::HClientService*)),
@@ -650,7 +1865,32 @@ bool HControlPoint::init()
 
     Q_ASSERT(ok);
 
+    ok = connect(
+        h_ptr->m_eventSubscriber,
+        SIGNAL(subscribed(Herqq::Upnp::HClientService*)),
+        h_ptr,
+        SLOT(subscribed(Herqq::Upnp::HClientService*)));
+
+    Q_ASSERT(ok);
+
     h_ptr->m_server = new ControlPointHttpServer(h_ptr);
+    h_ptr->m_server->setStallThreshold(
+        h_ptr->m_configuration->stallThreshold());
+
+    h_ptr->m_threadPool->setThreadPool(
+        h_ptr->m_configuration->deviceBuildThreadPool());
+    h_ptr->m_threadPool->setMaxConcurrency(
+        h_ptr->m_configuration->maxConcurrentDeviceBuilds());
+    h_ptr->m_threadPool->setPriority(
+        h_ptr->m_configuration->deviceBuildPriority());
+
+    delete h_ptr->m_descriptionCache; h_ptr->m_descriptionCache = 0;
+    if (!h_ptr->m_configuration->descriptionCacheDirectory().isEmpty())
+    {
+        h_ptr->m_descriptionCache = new HDescriptionCache(
+            h_ptr->m_configuration->descriptionCacheDirectory(),
+            h_ptr->m_loggingIdentifier, h_ptr);
+    }
 
     if (!doInit())
     {
@@ -673,7 +1913,7 @@ bool HControlPoint::init()
         ok = HSysInfo::instance().localNetwork(ha, &netwAddr);
         Q_ASSERT(ok);
 
-        HControlPointSsdpHandler* ssdp = new HControlPointSsdpHandler(h_ptr);
+        HControlPointSsdpHandler* ssdp = h_ptr->createSsdpHandler();
         if (!ssdp->init(ha))
         {
             delete ssdp;
@@ -684,32 +1924,25 @@ bool HControlPoint::init()
         h_ptr->m_ssdps.append(qMakePair(netwAddr, ssdp));
     }
 
-    if (h_ptr->m_configuration->autoDiscovery())
+    if (h_ptr->m_configuration->multicastEventingEnabled() &&
+        !h_ptr->m_eventSubscriber->startMulticastEventing(addrs))
     {
-        HLOG_DBG("Searching for UPnP devices");
-
-        for(qint32 i = 0; i < h_ptr->m_ssdps.size(); ++i)
-        {
-            QString ep =
-                h_ptr->m_ssdps[i].second->unicastEndpoint().toString();
+        HLOG_WARN("Failed to start receiving multicast events");
+    }
 
-            HLOG_DBG(QString(
-                "Sending discovery request using endpoint [%1]").arg(ep));
+    if (h_ptr->m_configuration->adaptiveDiscovery())
+    {
+        HLOG_DBG("Scheduling the searches for UPnP devices");
 
-            qint32 messagesSent =
-                h_ptr->m_ssdps[i].second->sendDiscoveryRequest(
-                    HDiscoveryRequest(
-                        1,
-                        HDiscoveryType::createDiscoveryTypeForRootDevices(),
-                        HSysInfo::instance().herqqProductTokens()));
+        h_ptr->m_discoveryScheduler = new HDiscoveryScheduler(
+            h_ptr, h_ptr->m_configuration->maxDiscoveryRate());
 
-            if (!messagesSent)
-            {
-                HLOG_WARN(QString(
-                    "Failed to send discovery request using endpoint "
-                    "[%1]").arg(ep));
-            }
-        }
+        h_ptr->m_discoveryScheduler->start();
+    }
+    else if (h_ptr->m_configuration->autoDiscovery())
+    {
+        HLOG_DBG("Searching for UPnP devices");
+        h_ptr->sendDiscoveryRequests();
     }
     else
     {
@@ -734,6 +1967,11 @@ end:
     return true;
 }
 
+const HControlPointRuntimeStatus* HControlPoint::runtimeStatus() const
+{
+    return h_ptr->m_runtimeStatus.data();
+}
+
 HControlPoint::ControlPointError HControlPoint::error() const
 {
     return h_ptr->m_lastError;
@@ -748,6 +1986,14 @@ void HControlPoint::quit()
 {
     HLOG2(H_AT, H_FUN, h_ptr->m_loggingIdentifier);
 
+    if (h_ptr->m_networkThread && thread() != QThread::currentThread())
+    {
+        h_ptr->m_networkThread->execute(
+            Functor<void>(this, &HControlPoint::quit));
+
+        return;
+    }
+
     Q_ASSERT_X(
         thread() == QThread::currentThread(), H_AT,
         "The control point has to be shutdown in the thread in which it is "
@@ -762,13 +2008,31 @@ void HControlPoint::quit()
 
     h_ptr->m_state = HControlPointPrivate::Exiting;
 
-    h_ptr->m_eventSubscriber->cancelAll(100);
+    qint32 notCancelled =
+        h_ptr->m_eventSubscriber->cancelAll(UnsubscribeDeadlineInMsecs);
+
     h_ptr->m_eventSubscriber->removeAll();
 
     h_ptr->m_server->close();
 
+    // the builds in progress are told to abort their downloads, but the
+    // shutdown has to wait for them to return
+    qint32 abortedBuilds = h_ptr->m_deviceBuildTasks.size();
     h_ptr->m_threadPool->shutdown();
 
+    if (notCancelled > 0 || abortedBuilds > 0)
+    {
+        HLOG_WARN(QString(
+            "Shutdown left [%1] event subscriptions uncancelled and "
+            "aborted [%2] device model builds").arg(
+                QString::number(notCancelled), QString::number(abortedBuilds)));
+    }
+
+    delete h_ptr->m_discoveryScheduler; h_ptr->m_discoveryScheduler = 0;
+    delete h_ptr->m_descriptionCache; h_ptr->m_descriptionCache = 0;
+    h_ptr->m_serviceDescriptionCache.clear();
+    h_ptr->m_iconCache.clear();
+
     doQuit();
 
     delete h_ptr->m_server; h_ptr->m_server = 0;
@@ -778,6 +2042,19 @@ void HControlPoint::quit()
     }
     h_ptr->m_ssdps.clear();
 
+    h_ptr->m_knownAnnouncements.clear();
+
+    foreach(HDefaultClientDevice* root, h_ptr->m_expiries.keys())
+    {
+        h_ptr->m_expiryWheel->unschedule(root);
+    }
+    h_ptr->m_expiries.clear();
+
+    h_ptr->m_lastUses.clear();
+    h_ptr->m_evictedDevices.clear();
+    h_ptr->m_evictedUdns.clear();
+    h_ptr->m_limitCheckPending = false;
+
     h_ptr->m_deviceStorage.clear();
 
     delete h_ptr->m_eventSubscriber; h_ptr->m_eventSubscriber = 0;
@@ -830,7 +2107,16 @@ HClientDevice* HControlPoint::device(
         return 0;
     }
 
-    return h_ptr->m_deviceStorage.searchDeviceByUdn(udn, dts);
+    HClientDevice* retVal = h_ptr->m_deviceStorage.searchDeviceByUdn(udn, dts);
+    if (retVal)
+    {
+        h_ptr->touch(retVal);
+    }
+    else
+    {
+        h_ptr->rebuildEvicted(udn);
+    }
+    return retVal;
 }
 
 bool HControlPoint::subscribeEvents(
@@ -862,6 +2148,8 @@ bool HControlPoint::subscribeEvents(
             device, visitType,
             h_ptr->m_configuration->desiredSubscriptionTimeout());
 
+    h_ptr->touch(device);
+
     if (!ok)
     {
         setError(
@@ -907,6 +2195,7 @@ bool HControlPoint::subscribeEvents(HClientService* service)
     switch(res)
     {
     case HEventSubscriptionManager::Sub_Success:
+        h_ptr->touch(service->parentDevice());
         return true;
 
     case HEventSubscriptionManager::Sub_AlreadySubscribed:
@@ -1037,6 +2326,10 @@ bool HControlPoint::removeRootDevice(HClientDevice* rootDevice)
     h_ptr->m_eventSubscriber->remove(rootDevice, true);
     // TODO should send unsubscription to the UPnP device?
 
+    h_ptr->forgetAnnouncements(rootDevice);
+    h_ptr->cancelExpiry(static_cast<HDefaultClientDevice*>(rootDevice));
+    h_ptr->m_lastUses.remove(rootDevice);
+
     HDeviceInfo info(rootDevice->info());
     if (h_ptr->m_deviceStorage.removeRootDevice(rootDevice))
     {
@@ -1082,6 +2375,11 @@ bool HControlPoint::scan(const HDiscoveryType& discoveryType, qint32 count)
             1, discoveryType, HSysInfo::instance().herqqProductTokens());
 
         qint32 messagesSent = ssdp.second->sendDiscoveryRequest(req, count);
+        if (h_ptr->m_discoveryScheduler)
+        {
+            h_ptr->m_discoveryScheduler->charge(messagesSent);
+        }
+
         if (messagesSent != count)
         {
             return false;
@@ -1132,6 +2430,11 @@ bool HControlPoint::scan(
             qint32 messagesSent = ssdp.second->sendDiscoveryRequest(
                 req, destination, count);
 
+            if (h_ptr->m_discoveryScheduler)
+            {
+                h_ptr->m_discoveryScheduler->charge(messagesSent);
+            }
+
             return messagesSent == count;
         }
     }
@@ -1139,5 +2442,207 @@ bool HControlPoint::scan(
     return false;
 }
 
+bool HControlPoint::refresh(const HUdn& udn)
+{
+    HLOG2(H_AT, H_FUN, h_ptr->m_loggingIdentifier);
+
+    if (!isStarted())
+    {
+        setError(NotInitializedError, "The control point is not initialized");
+        return false;
+    }
+
+    HDefaultClientDevice* device =
+        static_cast<HDefaultClientDevice*>(
+            h_ptr->m_deviceStorage.searchDeviceByUdn(udn, AllDevices));
+
+    if (!device)
+    {
+        setError(
+            InvalidArgumentError,
+            "The device was not found in this control point");
+
+        return false;
+    }
+
+    device = static_cast<HDefaultClientDevice*>(device->rootDevice());
+
+    qint32 searchPort = device->deviceStatus()->searchPort();
+    quint16 port = searchPort > 0 && searchPort <= 0xffff ? searchPort : 1900;
+
+    HDiscoveryRequest req(
+        0, HDiscoveryType(udn), HSysInfo::instance().herqqProductTokens());
+
+    QList<QUrl> locations = device->locations();
+    foreach(const QUrl& location, locations)
+    {
+        QHostAddress host(location.host());
+
+        quint32 netAddr;
+        if (!HSysInfo::instance().localNetwork(host, &netAddr))
+        {
+            continue;
+        }
+
+        for(qint32 i = 0; i < h_ptr->m_ssdps.size(); ++i)
+        {
+            QPair<quint32, HControlPointSsdpHandler*> ssdp = h_ptr->m_ssdps[i];
+            if (netAddr == ssdp.first)
+            {
+                qint32 messagesSent = ssdp.second->sendDiscoveryRequest(
+                    req, HEndpoint(host, port), 1);
+
+                if (h_ptr->m_discoveryScheduler)
+                {
+                    h_ptr->m_discoveryScheduler->charge(messagesSent);
+                }
+
+                return messagesSent == 1;
+            }
+        }
+    }
+
+    setError(
+        InvalidArgumentError,
+        "The device is not available on any network address in use");
+
+    return false;
+}
+
+bool HControlPoint::addNetworkAddress(const QHostAddress& address)
+{
+    HLOG2(H_AT, H_FUN, h_ptr->m_loggingIdentifier);
+
+    if (!isStarted())
+    {
+        setError(NotInitializedError, "The control point is not initialized");
+        return false;
+    }
+
+    quint32 netwAddr;
+    if (!HSysInfo::instance().localNetwork(address, &netwAddr))
+    {
+        setError(
+            InvalidArgumentError,
+            "The provided address is not a local network address");
+
+        return false;
+    }
+
+    for(qint32 i = 0; i < h_ptr->m_ssdps.size(); ++i)
+    {
+        HControlPointSsdpHandler* ssdp = h_ptr->m_ssdps[i].second;
+        if (ssdp->unicastEndpoint().hostAddress() == address)
+        {
+            setError(InvalidArgumentError, "The network address is already in use");
+            return false;
+        }
+    }
+
+    if (!h_ptr->m_server->addEndpoint(HEndpoint(address)))
+    {
+        setError(CommunicationsError, "Failed to bind the HTTP server");
+        return false;
+    }
+
+    HControlPointSsdpHandler* ssdp = h_ptr->createSsdpHandler();
+    if (!ssdp->init(address))
+    {
+        delete ssdp;
+        h_ptr->m_server->removeEndpoint(address);
+
+        setError(CommunicationsError, "Failed to start SSDP");
+        return false;
+    }
+
+    HLOG_INFO(QString("Starting to use network address %1").arg(
+        address.toString()));
+
+    h_ptr->m_ssdps.append(qMakePair(netwAddr, ssdp));
+    h_ptr->updateNetworkAddresses();
+
+    if (h_ptr->m_configuration->multicastEventingEnabled() &&
+        !h_ptr->m_eventSubscriber->addMulticastEventingAddress(address))
+    {
+        HLOG_WARN("Failed to start receiving multicast events");
+    }
+
+    if (h_ptr->m_discoveryScheduler)
+    {
+        h_ptr->m_discoveryScheduler->start();
+    }
+    else if (h_ptr->m_configuration->autoDiscovery())
+    {
+        qint32 messagesSent = ssdp->sendDiscoveryRequest(
+            HDiscoveryRequest(
+                1,
+                HDiscoveryType::createDiscoveryTypeForRootDevices(),
+                HSysInfo::instance().herqqProductTokens()));
+
+        if (!messagesSent)
+        {
+            HLOG_WARN(QString(
+                "Failed to send discovery request using endpoint "
+                "[%1]").arg(ssdp->unicastEndpoint().toString()));
+        }
+    }
+
+    return true;
+}
+
+bool HControlPoint::removeNetworkAddress(const QHostAddress& address)
+{
+    HLOG2(H_AT, H_FUN, h_ptr->m_loggingIdentifier);
+
+    if (!isStarted())
+    {
+        setError(NotInitializedError, "The control point is not initialized");
+        return false;
+    }
+
+    qint32 index = -1;
+    for(qint32 i = 0; i < h_ptr->m_ssdps.size(); ++i)
+    {
+        HControlPointSsdpHandler* ssdp = h_ptr->m_ssdps[i].second;
+        if (ssdp->unicastEndpoint().hostAddress() == address)
+        {
+            index = i;
+            break;
+        }
+    }
+
+    if (index < 0)
+    {
+        setError(InvalidArgumentError, "The network address is not in use");
+        return false;
+    }
+    else if (h_ptr->m_ssdps.size() == 1)
+    {
+        setError(
+            InvalidArgumentError,
+            "The last network address cannot be removed");
+
+        return false;
+    }
+
+    HLOG_INFO(QString("Stopping to use network address %1").arg(
+        address.toString()));
+
+    delete h_ptr->m_ssdps.takeAt(index).second;
+    h_ptr->updateNetworkAddresses();
+
+    h_ptr->m_server->removeEndpoint(address);
+
+    qint32 moved = h_ptr->m_eventSubscriber->serverAddressRemoved(address);
+    if (moved)
+    {
+        HLOG_DBG(QString(
+            "Subscribing again to [%1] services to receive their events "
+            "through another address").arg(QString::number(moved)));
+    }
+
+    return true;
+}
+
 }
 }
@@ -24,9 +24,12 @@
 
 #include <HUpnpCore/HClientDevice>
 #include <HUpnpCore/HResourceType>
+#include <HUpnpCore/HSsdp>
 
 #include <QtCore/QObject>
+#include <QtCore/QStringList>
 
+class QHostAddress;
 class QNetworkReply;
 class QAuthenticator;
 
@@ -38,6 +41,7 @@ namespace Upnp
 
 class HControlPointPrivate;
 class HControlPointConfiguration;
+class HControlPointRuntimeStatusPrivate;
 
 /*!
  * \brief This is a class for discovering and interacting with UPnP devices in the network.
@@ -67,6 +71,9 @@ class HControlPointConfiguration;
  * - HControlPoint::rootDeviceRemoved(), which is emitted when a control point has
  * removed and deleted an HClientDevice. Note, an HClientDevice is never deleted without
  * an explicit request from a user. See removeRootDevice() for further information.
+ * - HControlPoint::rootDeviceEvicted(), which is emitted when a control point
+ * has deleted an HClientDevice to stay within the limits set in
+ * HControlPointConfiguration.
  *
  * Consider an example:
  *
@@ -166,6 +173,9 @@ class HControlPointConfiguration;
  * \li You can use \c QObject::moveToThread() on the \c %HControlPoint, which causes
  * the control point and every object managed by it to be moved to the chosen thread.
  * However, you cannot move individual objects managed by \c %HControlPoint.
+ * \li When HControlPointConfiguration::setNetworkThreadEnabled() is set, the
+ * control point moves itself into an internal network thread upon init().
+ * In that case init(), quit() and the destructor can be called from any thread.
  * \li a control point never transfers the ownership of the HClientDevice objects it manages.
  * \li <b>%HControlPoint always destroys every %HClientDevice it manages when it is
  * being destroyed</b>.
@@ -523,7 +533,9 @@ public:
      * from the control point to prevent accidental dereference.
      *
      * \remarks An \c %HControlPoint instance has to be destroyed in the thread
-     * in which it is located.
+     * in which it is located, unless it is run in a network thread.
+     *
+     * \sa HControlPointConfiguration::setNetworkThreadEnabled()
      */
     virtual ~HControlPoint();
 
@@ -560,6 +572,16 @@ public:
      */
     QString errorDescription() const;
 
+    /*!
+     * \brief Returns runtime status information of the control point.
+     *
+     * \return runtime status information of the control point.
+     *
+     * \warning The returned object is deleted when the control point is
+     * being destroyed.
+     */
+    const HControlPointRuntimeStatus* runtimeStatus() const;
+
     /*!
      * \brief Indicates whether or not the host is successfully started.
      *
@@ -588,7 +610,12 @@ public:
      *
      * \remarks This method does not perform a network scan. The search is run
      * against the devices that are already in the control of the control point.
-     * You can call scan() to perform an explicit network scan.
+     * You can call scan() to perform an explicit network scan. However, if the
+     * device was evicted and it is still advertised, the control point
+     * starts to build it again in the background and rootDeviceOnline() is
+     * emitted once it is available.
+     *
+     * \sa rootDeviceEvicted()
      */
     HClientDevice* device(
         const HUdn& udn,
@@ -833,6 +860,9 @@ public:
      * More specifically, any device that does not respond
      * to the scan will not be considered as expired and no rootDeviceOffline()
      * signals will be sent consequently.
+     * \li Instead of calling this on a timer, consider letting the control
+     * point schedule the searches with
+     * HControlPointConfiguration::setAdaptiveDiscovery().
      */
     bool scan(const HDiscoveryType& discoveryType, qint32 count = 1);
 
@@ -868,6 +898,72 @@ public:
         const HDiscoveryType& discoveryType, const HEndpoint& destination,
         qint32 count = 1);
 
+    /*!
+     * \brief Checks that a known device is still available.
+     *
+     * A unicast M-SEARCH for the device is sent to the host of the device
+     * at the port the device advertised in SEARCHPORT.UPNP.ORG, or at the
+     * port 1900 if the device has not advertised one. As specified by UDA 1.1,
+     * the device responds at once, which resets the expiration of the
+     * device tree the same way an alive announcement does. Unlike scan(),
+     * this costs the network a single request and the responses of the
+     * device instead of a multicast search answered by every device.
+     *
+     * \param udn specifies the UDN of the device or of any of its embedded
+     * devices.
+     *
+     * \return \e true in case the request was sent.
+     *
+     * \remarks
+     * \li This method returns immediately.
+     * \li A device that does not respond is not expired any sooner than
+     * it otherwise would.
+     *
+     * \sa error(), errorDescription()
+     */
+    bool refresh(const HUdn& udn);
+
+    /*!
+     * \brief Starts to use another network address without restarting the
+     * control point.
+     *
+     * The HTTP server and an SSDP socket are bound to the address and, in
+     * case the multicast events are received, the multicast group of the
+     * events is joined on the address. If the automatic discovery is enabled,
+     * the devices on the network of the address are searched for. The devices
+     * found earlier and the event subscriptions are left intact.
+     *
+     * \param address specifies the local network address to take into use.
+     *
+     * \return \e true in case the address was taken into use. If the method
+     * returns \e false, you can call error() and errorDescription() to get
+     * more information of the error that occurred.
+     *
+     * \sa removeNetworkAddress(), HControlPointConfiguration::networkAddressesToUse()
+     */
+    bool addNetworkAddress(const QHostAddress& address);
+
+    /*!
+     * \brief Stops using a network address without restarting the control
+     * point.
+     *
+     * The HTTP server and the SSDP socket bound to the address are closed.
+     * The services whose events were sent to the address are subscribed again
+     * with a callback on another address. The devices found through the
+     * address are not removed, but they expire in case they are not
+     * advertised on the other networks.
+     *
+     * \param address specifies the network address to stop using. The last
+     * network address of the control point cannot be removed.
+     *
+     * \return \e true in case the address is no longer used. If the method
+     * returns \e false, you can call error() and errorDescription() to get
+     * more information of the error that occurred.
+     *
+     * \sa addNetworkAddress()
+     */
+    bool removeNetworkAddress(const QHostAddress& address);
+
 public Q_SLOTS:
 
     /*!
@@ -937,6 +1033,28 @@ Q_SIGNALS:
      */
     void subscriptionFailed(Herqq::Upnp::HClientService* service);
 
+    /*!
+     * \brief This signal is emitted when an event subscription started by the
+     * control point has either succeeded or failed.
+     *
+     * The subscriptions started while others are still in progress form a
+     * batch, such as the subscriptions to all the services of a device tree.
+     * The progress of a batch is reported until all of its subscriptions
+     * have completed, after which the next subscription starts a new batch.
+     *
+     * The control point limits the number of subscription requests it sends
+     * at the same time, both to a single device and overall, and hence the
+     * subscriptions of a large batch may take some time to complete.
+     *
+     * \param completed specifies the number of subscriptions in the batch
+     * that have succeeded or failed.
+     *
+     * \param total specifies the number of subscriptions in the batch.
+     *
+     * \sa subscriptionSucceeded(), subscriptionFailed()
+     */
+    void subscriptionProgress(qint32 completed, qint32 total);
+
     /*!
      * \brief This signal is emitted when an event subscription to the specified
      * service has been canceled.
@@ -991,16 +1109,47 @@ Q_SIGNALS:
      * If the configuration changes the old device tree has to be discarded in
      * place of the new one.
      *
+     * This signal is emitted only when the devices or the services of the
+     * new configuration differ from the old ones. A change limited to the
+     * descriptions of the devices and services is reported by
+     * rootDeviceUpdated() instead.
+     *
      * After this signal is emitted the specified HClientDevice object has become
-     * invalid and should be discarded and removed immediately.
+     * invalid. The control point removes and deletes it once the signal has
+     * been delivered, unless it was removed already.
      * In addition, rootDeviceOnline() signal may be emitted shortly after this
      * signal, but only when the new configuration of the device is accepted
      * by this instance.
      *
      * \param device is the device that has been invalidated.
+     *
+     * \sa rootDeviceUpdated()
      */
     void rootDeviceInvalidated(Herqq::Upnp::HClientDevice* device);
 
+    /*!
+     * \brief This signal is emitted when a previously discovered device has
+     * changed its configuration and the device model has been updated to it.
+     *
+     * When the \c CONFIGID.UPNP.ORG of a device changes, the control point
+     * fetches the device description and the service descriptions again.
+     * In case the device tree contains the same devices and services as
+     * before, the device object is kept and only the services whose
+     * information or service description changed are replaced by new
+     * objects. The unchanged services are kept along with their state and
+     * their event subscriptions. A replaced service is subscribed to in case
+     * the service it replaced was subscribed to.
+     *
+     * \param device is the device that was updated.
+     *
+     * \remarks The replaced HClientService objects are deleted once the
+     * control returns to the event loop, which is why the services should be
+     * looked up again from the device when this signal is received.
+     *
+     * \sa rootDeviceInvalidated()
+     */
+    void rootDeviceUpdated(Herqq::Upnp::HClientDevice* device);
+
     /*!
      * \brief This signal is emitted when a root device has been removed from the control
      * of this control point and deleted.
@@ -1012,6 +1161,24 @@ Q_SIGNALS:
      */
     void rootDeviceRemoved(const Herqq::Upnp::HDeviceInfo& deviceInfo);
 
+    /*!
+     * \brief This signal is emitted when a root device has been removed from
+     * the control of this control point and deleted to stay within the limits
+     * set in HControlPointConfiguration.
+     *
+     * The device that was used least recently is evicted first. The control
+     * point remembers where an evicted device can be found for as long as the
+     * device keeps advertising itself, and device() builds it again on demand.
+     *
+     * \param deviceInfo specifies information about the device that was
+     * evicted.
+     *
+     * \sa HControlPointConfiguration::setMaxRootDevices(),
+     * HControlPointConfiguration::setMaxServices(),
+     * HControlPointConfiguration::setMaxSubscriptions()
+     */
+    void rootDeviceEvicted(const Herqq::Upnp::HDeviceInfo& deviceInfo);
+
     /*!
      * \brief This signal is emitted when a run-time error has occurred.
      *
@@ -1022,6 +1189,208 @@ Q_SIGNALS:
     //void error(ErrorType err, const QString& errStr);
 };
 
+/*!
+ * This is a class for detailing information of the runtime status of an
+ * HControlPoint instance.
+ *
+ * \headerfile hcontrolpoint.h HControlPointRuntimeStatus
+ *
+ * \ingroup hupnp_devicehosting
+ *
+ * \sa HControlPoint
+ */
+class H_UPNP_CORE_EXPORT HControlPointRuntimeStatus
+{
+H_DISABLE_COPY(HControlPointRuntimeStatus)
+friend class HControlPointPrivate;
+
+protected:
+
+    HControlPointRuntimeStatusPrivate* h_ptr;
+
+    /*!
+     * \brief Creates an instance.
+     *
+     * Creates an instance.
+     */
+    HControlPointRuntimeStatus();
+
+public:
+
+    /*!
+     * \brief Destroys the instance.
+     */
+    virtual ~HControlPointRuntimeStatus();
+
+    /*!
+     * \brief Returns the number of SSDP messages of the specified type the
+     * control point has received.
+     *
+     * \param type specifies the message type. The value has to be a single
+     * message type.
+     *
+     * \return The number of SSDP messages of the specified type the control
+     * point has received on every network it uses.
+     *
+     * \sa ssdpMessagesSent(), HSsdp::messagesReceived()
+     */
+    qint64 ssdpMessagesReceived(HSsdp::AllowedMessage type) const;
+
+    /*!
+     * \brief Returns the number of SSDP messages of the specified type the
+     * control point has sent.
+     *
+     * \param type specifies the message type. The value has to be a single
+     * message type.
+     *
+     * \return The number of SSDP messages of the specified type the control
+     * point has sent on every network it uses.
+     *
+     * \sa ssdpMessagesReceived(), HSsdp::messagesSent()
+     */
+    qint64 ssdpMessagesSent(HSsdp::AllowedMessage type) const;
+
+    /*!
+     * \brief Returns the number of received SSDP datagrams the control point
+     * has dropped for the specified reason.
+     *
+     * \param reason specifies the reason the datagrams were dropped.
+     *
+     * \return The number of SSDP datagrams dropped for the specified reason
+     * on every network the control point uses, or -1 in case the datagrams are
+     * not counted on this platform.
+     *
+     * \sa HSsdp::droppedDatagrams()
+     */
+    qint64 ssdpDatagramsDropped(HSsdp::DropReason reason) const;
+
+    /*!
+     * \brief Returns the number of device model builds the control point
+     * has started.
+     *
+     * A build is started when an advertisement or a discovery response
+     * of a device that is not yet known to the control point is received.
+     *
+     * \return The number of device model builds the control point has
+     * started.
+     *
+     * \sa failedDeviceBuilds(), deviceBuildLatency()
+     */
+    qint64 startedDeviceBuilds() const;
+
+    /*!
+     * \brief Returns the number of device model builds that have failed.
+     *
+     * \return The number of device model builds that have failed.
+     *
+     * \sa startedDeviceBuilds()
+     */
+    qint64 failedDeviceBuilds() const;
+
+    /*!
+     * \brief Returns the specified percentile of the time the recent device
+     * model builds have taken.
+     *
+     * The time is measured from the moment a build is queued until it has
+     * completed or failed, which includes the retrieval of the description
+     * documents.
+     *
+     * \param percentile specifies the percentile, which is a value
+     * between 0 and 100. For instance, 50 returns the median.
+     *
+     * \return The specified percentile of the build time in milliseconds,
+     * or -1 in case no build has completed.
+     */
+    qint32 deviceBuildLatency(qint32 percentile) const;
+
+    /*!
+     * \brief Returns the number of device model builds that are queued
+     * or in progress.
+     *
+     * \return The number of device model builds that are queued or in
+     * progress.
+     *
+     * \sa startedDeviceBuilds()
+     */
+    qint32 pendingDeviceBuilds() const;
+
+    /*!
+     * \brief Returns the number of event subscriptions that are currently
+     * active.
+     *
+     * \return The number of event subscriptions that are currently active.
+     *
+     * \sa failedSubscriptions()
+     */
+    qint32 activeSubscriptions() const;
+
+    /*!
+     * \brief Returns the number of subscription attempts that have failed.
+     *
+     * \return The number of subscription attempts that have failed,
+     * including the failed renewals of existing subscriptions.
+     *
+     * \sa activeSubscriptions()
+     */
+    qint64 failedSubscriptions() const;
+
+    /*!
+     * \brief Returns the number of event notifications the control point
+     * has received.
+     *
+     * \return The number of unicast and multicast event notifications that
+     * the control point has received and accepted for the services it
+     * is subscribed to.
+     */
+    qint64 receivedEventNotifications() const;
+
+    /*!
+     * \brief Returns the identities of the handlers that have stalled the
+     * thread that receives the event notifications.
+     *
+     * A handler is identified by the HTTP method and the path of the request
+     * it handled, such as <c>NOTIFY /uuid/service</c>. The stalls that were
+     * not caused by the handling of a request, such as the processing of
+     * SSDP messages or slow slots connected to the signals of the control
+     * point, are reported under an empty string.
+     *
+     * \return The identities of the handlers that have stalled the thread.
+     * The list is empty in case stall detection is disabled.
+     *
+     * \sa handlerStalls(), worstHandlerStall(),
+     * HControlPointConfiguration::setStallThreshold()
+     */
+    QStringList stalledHandlers() const;
+
+    /*!
+     * \brief Returns the number of times the specified handler has run longer
+     * than the stall threshold.
+     *
+     * \param handler specifies the identity of the handler, as returned by
+     * stalledHandlers().
+     *
+     * \return The number of times the specified handler has run longer than
+     * the stall threshold.
+     *
+     * \sa worstHandlerStall()
+     */
+    qint64 handlerStalls(const QString& handler) const;
+
+    /*!
+     * \brief Returns the longest time the specified handler has stalled the
+     * thread that receives the event notifications.
+     *
+     * \param handler specifies the identity of the handler, as returned by
+     * stalledHandlers().
+     *
+     * \return The longest time in milliseconds the specified handler has
+     * stalled the thread, or zero in case the handler has not stalled it.
+     *
+     * \sa handlerStalls()
+     */
+    qint32 worstHandlerStall(const QString& handler) const;
+};
+
 }
 }
 
@@ -40,7 +40,27 @@ HControlPointConfigurationPrivate::HControlPointConfigurationPrivate() :
     m_subscribeToEvents(true),
     m_desiredSubscriptionTimeout(1800),
     m_autoDiscovery(true),
-    m_networkAddresses()
+    m_networkAddresses(),
+    m_ssdpReceiveBufferSize(256 * 1024),
+    m_ssdpSendBufferSize(0),
+    m_ssdpReceiveThreads(false),
+    m_sharedSsdp(false),
+    m_networkThread(false),
+    m_multicastEventing(false),
+    m_descriptionCacheDirectory(),
+    m_maxConcurrentDeviceBuilds(0),
+    m_deviceBuildPriority(0),
+    m_deviceBuildThreadPool(0),
+    m_serviceDescriptionsOnDemand(false),
+    m_discoveryFilter(),
+    m_maxConcurrentInvocations(1),
+    m_metricsPath(),
+    m_adaptiveDiscovery(false),
+    m_maxDiscoveryRate(0),
+    m_maxRootDevices(0),
+    m_maxServices(0),
+    m_maxSubscriptions(0),
+    m_stallThreshold(0)
 {
     QHostAddress ha = findBindableHostAddress();
     m_networkAddresses.append(ha);
@@ -59,6 +79,26 @@ HControlPointConfigurationPrivate* HControlPointConfigurationPrivate::clone() co
     newObj->m_desiredSubscriptionTimeout = m_desiredSubscriptionTimeout;
     newObj->m_autoDiscovery = m_autoDiscovery;
     newObj->m_networkAddresses = m_networkAddresses;
+    newObj->m_ssdpReceiveBufferSize = m_ssdpReceiveBufferSize;
+    newObj->m_ssdpSendBufferSize = m_ssdpSendBufferSize;
+    newObj->m_ssdpReceiveThreads = m_ssdpReceiveThreads;
+    newObj->m_sharedSsdp = m_sharedSsdp;
+    newObj->m_networkThread = m_networkThread;
+    newObj->m_multicastEventing = m_multicastEventing;
+    newObj->m_descriptionCacheDirectory = m_descriptionCacheDirectory;
+    newObj->m_maxConcurrentDeviceBuilds = m_maxConcurrentDeviceBuilds;
+    newObj->m_deviceBuildPriority = m_deviceBuildPriority;
+    newObj->m_deviceBuildThreadPool = m_deviceBuildThreadPool;
+    newObj->m_serviceDescriptionsOnDemand = m_serviceDescriptionsOnDemand;
+    newObj->m_discoveryFilter = m_discoveryFilter;
+    newObj->m_maxConcurrentInvocations = m_maxConcurrentInvocations;
+    newObj->m_metricsPath = m_metricsPath;
+    newObj->m_adaptiveDiscovery = m_adaptiveDiscovery;
+    newObj->m_maxDiscoveryRate = m_maxDiscoveryRate;
+    newObj->m_maxRootDevices = m_maxRootDevices;
+    newObj->m_maxServices = m_maxServices;
+    newObj->m_maxSubscriptions = m_maxSubscriptions;
+    newObj->m_stallThreshold = m_stallThreshold;
 
     return newObj;
 }
@@ -126,6 +166,106 @@ QList<QHostAddress> HControlPointConfiguration::networkAddressesToUse() const
     return h_ptr->m_networkAddresses;
 }
 
+qint32 HControlPointConfiguration::ssdpReceiveBufferSize() const
+{
+    return h_ptr->m_ssdpReceiveBufferSize;
+}
+
+qint32 HControlPointConfiguration::ssdpSendBufferSize() const
+{
+    return h_ptr->m_ssdpSendBufferSize;
+}
+
+bool HControlPointConfiguration::ssdpReceiveThreadsEnabled() const
+{
+    return h_ptr->m_ssdpReceiveThreads;
+}
+
+bool HControlPointConfiguration::sharedSsdpEnabled() const
+{
+    return h_ptr->m_sharedSsdp;
+}
+
+bool HControlPointConfiguration::networkThreadEnabled() const
+{
+    return h_ptr->m_networkThread;
+}
+
+bool HControlPointConfiguration::multicastEventingEnabled() const
+{
+    return h_ptr->m_multicastEventing;
+}
+
+QString HControlPointConfiguration::descriptionCacheDirectory() const
+{
+    return h_ptr->m_descriptionCacheDirectory;
+}
+
+qint32 HControlPointConfiguration::maxConcurrentDeviceBuilds() const
+{
+    return h_ptr->m_maxConcurrentDeviceBuilds;
+}
+
+qint32 HControlPointConfiguration::deviceBuildPriority() const
+{
+    return h_ptr->m_deviceBuildPriority;
+}
+
+QThreadPool* HControlPointConfiguration::deviceBuildThreadPool() const
+{
+    return h_ptr->m_deviceBuildThreadPool;
+}
+
+bool HControlPointConfiguration::serviceDescriptionsOnDemand() const
+{
+    return h_ptr->m_serviceDescriptionsOnDemand;
+}
+
+QList<HDiscoveryType> HControlPointConfiguration::discoveryFilter() const
+{
+    return h_ptr->m_discoveryFilter;
+}
+
+qint32 HControlPointConfiguration::maxConcurrentInvocations() const
+{
+    return h_ptr->m_maxConcurrentInvocations;
+}
+
+QString HControlPointConfiguration::metricsPath() const
+{
+    return h_ptr->m_metricsPath;
+}
+
+bool HControlPointConfiguration::adaptiveDiscovery() const
+{
+    return h_ptr->m_adaptiveDiscovery;
+}
+
+qint32 HControlPointConfiguration::maxDiscoveryRate() const
+{
+    return h_ptr->m_maxDiscoveryRate;
+}
+
+qint32 HControlPointConfiguration::maxRootDevices() const
+{
+    return h_ptr->m_maxRootDevices;
+}
+
+qint32 HControlPointConfiguration::maxServices() const
+{
+    return h_ptr->m_maxServices;
+}
+
+qint32 HControlPointConfiguration::maxSubscriptions() const
+{
+    return h_ptr->m_maxSubscriptions;
+}
+
+qint32 HControlPointConfiguration::stallThreshold() const
+{
+    return h_ptr->m_stallThreshold;
+}
+
 void HControlPointConfiguration::setSubscribeToEvents(bool arg)
 {
     h_ptr->m_subscribeToEvents = arg;
@@ -160,5 +300,135 @@ bool HControlPointConfiguration::setNetworkAddressesToUse(
     return true;
 }
 
+void HControlPointConfiguration::setSsdpReceiveBufferSize(qint32 bytes)
+{
+    if (bytes < 0)
+    {
+        return;
+    }
+
+    h_ptr->m_ssdpReceiveBufferSize = bytes;
+}
+
+void HControlPointConfiguration::setSsdpSendBufferSize(qint32 bytes)
+{
+    if (bytes < 0)
+    {
+        return;
+    }
+
+    h_ptr->m_ssdpSendBufferSize = bytes;
+}
+
+void HControlPointConfiguration::setSsdpReceiveThreadsEnabled(bool enable)
+{
+    h_ptr->m_ssdpReceiveThreads = enable;
+}
+
+void HControlPointConfiguration::setSharedSsdpEnabled(bool enable)
+{
+    h_ptr->m_sharedSsdp = enable;
+}
+
+void HControlPointConfiguration::setNetworkThreadEnabled(bool enable)
+{
+    h_ptr->m_networkThread = enable;
+}
+
+void HControlPointConfiguration::setMulticastEventingEnabled(bool enable)
+{
+    h_ptr->m_multicastEventing = enable;
+}
+
+void HControlPointConfiguration::setDescriptionCacheDirectory(
+    const QString& directory)
+{
+    h_ptr->m_descriptionCacheDirectory = directory;
+}
+
+void HControlPointConfiguration::setMaxConcurrentDeviceBuilds(qint32 count)
+{
+    h_ptr->m_maxConcurrentDeviceBuilds = count < 0 ? 0 : count;
+}
+
+void HControlPointConfiguration::setDeviceBuildPriority(qint32 priority)
+{
+    h_ptr->m_deviceBuildPriority = priority;
+}
+
+void HControlPointConfiguration::setDeviceBuildThreadPool(QThreadPool* pool)
+{
+    h_ptr->m_deviceBuildThreadPool = pool;
+}
+
+void HControlPointConfiguration::setServiceDescriptionsOnDemand(bool enable)
+{
+    h_ptr->m_serviceDescriptionsOnDemand = enable;
+}
+
+void HControlPointConfiguration::setDiscoveryFilter(
+    const QList<HDiscoveryType>& filter)
+{
+    h_ptr->m_discoveryFilter.clear();
+    foreach(const HDiscoveryType& type, filter)
+    {
+        if (type.type() == HDiscoveryType::Undefined)
+        {
+            continue;
+        }
+        else if (type.type() == HDiscoveryType::All)
+        {
+            // nothing is filtered
+            h_ptr->m_discoveryFilter.clear();
+            return;
+        }
+
+        h_ptr->m_discoveryFilter.append(type);
+    }
+}
+
+void HControlPointConfiguration::setMaxConcurrentInvocations(qint32 count)
+{
+    h_ptr->m_maxConcurrentInvocations = count < 0 ? 0 : count;
+}
+
+void HControlPointConfiguration::setMetricsPath(const QString& path)
+{
+    if (path.isEmpty() || path.startsWith('/'))
+    {
+        h_ptr->m_metricsPath = path;
+    }
+}
+
+void HControlPointConfiguration::setAdaptiveDiscovery(bool arg)
+{
+    h_ptr->m_adaptiveDiscovery = arg;
+}
+
+void HControlPointConfiguration::setMaxDiscoveryRate(qint32 packetsPerSecond)
+{
+    h_ptr->m_maxDiscoveryRate = packetsPerSecond < 0 ? 0 : packetsPerSecond;
+}
+
+void HControlPointConfiguration::setMaxRootDevices(qint32 count)
+{
+    h_ptr->m_maxRootDevices = count < 0 ? 0 : count;
+}
+
+void HControlPointConfiguration::setMaxServices(qint32 count)
+{
+    h_ptr->m_maxServices = count < 0 ? 0 : count;
+}
+
+void HControlPointConfiguration::setMaxSubscriptions(qint32 count)
+{
+    h_ptr->m_maxSubscriptions = count < 0 ? 0 : count;
+}
+
+void HControlPointConfiguration::setStallThreshold(qint32 msecs)
+{
+    h_ptr->m_stallThreshold = msecs < 0 ? 0 : msecs;
+}
+
 }
 }
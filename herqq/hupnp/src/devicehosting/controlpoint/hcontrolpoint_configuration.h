@@ -24,6 +24,7 @@
 
 #include <HUpnpCore/HClonable>
 
+class QThreadPool;
 class QHostAddress;
 
 namespace Herqq
@@ -54,6 +55,12 @@ class HControlPointConfigurationPrivate;
  * The default is the first found interface that is up. Non-loopback interfaces
  * have preference, but if none are found the loopback is used. However, in this
  * case UDP multicast is not available.
+ * - Set the size of the receive buffer of the SSDP sockets with
+ * setSsdpReceiveBufferSize(). The default is 256 kilobytes.
+ * - Set the size of the send buffer of the SSDP unicast sockets with
+ * setSsdpSendBufferSize(). By default the operating system decides.
+ * - Detect the request handlers that block the thread of the HControlPoint
+ * with setStallThreshold(). By default the detection is disabled.
  *
  * \headerfile hcontrolpoint_configuration.h HControlPointConfiguration
  *
@@ -152,6 +159,249 @@ public:
      */
     QList<QHostAddress> networkAddressesToUse() const;
 
+    /*!
+     * \brief Returns the size of the receive buffer of the sockets a control
+     * point uses for SSDP.
+     *
+     * The default value is 256 kilobytes.
+     *
+     * \return The size of the receive buffer in bytes. A value of zero
+     * means that the default of the operating system is used.
+     *
+     * \sa setSsdpReceiveBufferSize()
+     */
+    qint32 ssdpReceiveBufferSize() const;
+
+    /*!
+     * \brief Returns the size of the send buffer of the sockets a control
+     * point uses for sending SSDP messages.
+     *
+     * The default value is zero.
+     *
+     * \return The size of the send buffer in bytes. A value of zero
+     * means that the default of the operating system is used.
+     *
+     * \sa setSsdpSendBufferSize()
+     */
+    qint32 ssdpSendBufferSize() const;
+
+    /*!
+     * \brief Indicates whether the SSDP multicast messages of each network
+     * a control point uses are received in a thread of their own.
+     *
+     * The default value is \e false.
+     *
+     * \return \e true in case the SSDP multicast messages of each network
+     * are received in a thread of their own.
+     *
+     * \sa setSsdpReceiveThreadsEnabled()
+     */
+    bool ssdpReceiveThreadsEnabled() const;
+
+    /*!
+     * \brief Indicates whether the control point shares the SSDP
+     * multicast sockets with the other control points and device hosts of
+     * its thread.
+     *
+     * The default value is \e false.
+     *
+     * \return \e true in case the SSDP multicast sockets are shared.
+     *
+     * \sa setSharedSsdpEnabled()
+     */
+    bool sharedSsdpEnabled() const;
+
+    /*!
+     * \brief Indicates whether the control point is run in a network thread
+     * of its own.
+     *
+     * The default value is \e false.
+     *
+     * \return \e true in case the control point is run in a network thread
+     * of its own.
+     *
+     * \sa setNetworkThreadEnabled()
+     */
+    bool networkThreadEnabled() const;
+
+    /*!
+     * \brief Indicates whether the control point listens to the UPnP 1.1
+     * multicast events.
+     *
+     * The default value is \e false.
+     *
+     * \return \e true in case the control point listens to the UPnP 1.1
+     * multicast events.
+     *
+     * \sa setMulticastEventingEnabled()
+     */
+    bool multicastEventingEnabled() const;
+
+    /*!
+     * \brief Returns the directory in which the control point caches the
+     * descriptions of the devices it builds.
+     *
+     * \return The directory in which the control point caches the device
+     * and service descriptions. An empty string means that the descriptions
+     * are not cached. This is the default.
+     *
+     * \sa setDescriptionCacheDirectory()
+     */
+    QString descriptionCacheDirectory() const;
+
+    /*!
+     * \brief Returns the maximum number of devices the control point builds
+     * at the same time.
+     *
+     * \return The maximum number of devices the control point builds at the
+     * same time. Zero means that only the thread pool used for the builds
+     * limits the number. This is the default.
+     *
+     * \sa setMaxConcurrentDeviceBuilds()
+     */
+    qint32 maxConcurrentDeviceBuilds() const;
+
+    /*!
+     * \brief Returns the priority of the device builds of the control point
+     * in the thread pool used for the builds.
+     *
+     * \return The priority of the device builds of the control point. The
+     * default is zero.
+     *
+     * \sa setDeviceBuildPriority()
+     */
+    qint32 deviceBuildPriority() const;
+
+    /*!
+     * \brief Returns the thread pool in which the control point builds
+     * the devices it discovers.
+     *
+     * \return The thread pool in which the control point builds the devices
+     * it discovers. A null pointer means that the control point uses a
+     * thread pool of its own. This is the default.
+     *
+     * \sa setDeviceBuildThreadPool()
+     */
+    QThreadPool* deviceBuildThreadPool() const;
+
+    /*!
+     * \brief Indicates whether the control point retrieves the service
+     * descriptions of the devices it builds only when they are needed.
+     *
+     * \return \e true when the service descriptions are retrieved on demand.
+     * The default is \e false.
+     *
+     * \sa setServiceDescriptionsOnDemand()
+     */
+    bool serviceDescriptionsOnDemand() const;
+
+    /*!
+     * \brief Returns the resources whose advertisements and discovery
+     * responses make the control point build a device.
+     *
+     * \return The resources whose advertisements and discovery responses
+     * make the control point build a device. An empty list means that
+     * every advertisement of an unknown device is accepted. This is the
+     * default.
+     *
+     * \sa setDiscoveryFilter()
+     */
+    QList<HDiscoveryType> discoveryFilter() const;
+
+    /*!
+     * \brief Returns the maximum number of action invocations the control
+     * point runs to a single device at the same time.
+     *
+     * \return The maximum number of action invocations in progress to
+     * a single device at the same time. Zero means that the number is not
+     * limited. The default is one.
+     *
+     * \sa setMaxConcurrentInvocations()
+     */
+    qint32 maxConcurrentInvocations() const;
+
+    /*!
+     * \brief Returns the path at which the control point serves its runtime
+     * metrics.
+     *
+     * \return The path at which the control point serves its runtime metrics
+     * in the OpenMetrics text format. The path is empty if the metrics are
+     * not served, which is the default.
+     *
+     * \sa setMetricsPath()
+     */
+    QString metricsPath() const;
+
+    /*!
+     * \brief Indicates whether the control point keeps searching for devices
+     * on its own after it has been initialized.
+     *
+     * \return \e true in case the control point schedules its own searches.
+     * The default is \e false.
+     *
+     * \sa setAdaptiveDiscovery()
+     */
+    bool adaptiveDiscovery() const;
+
+    /*!
+     * \brief Returns the maximum number of M-SEARCH packets the control point
+     * sends per second.
+     *
+     * \return The maximum number of M-SEARCH packets the control point sends
+     * per second. Zero means that the rate is not limited. This is the
+     * default.
+     *
+     * \sa setMaxDiscoveryRate()
+     */
+    qint32 maxDiscoveryRate() const;
+
+    /*!
+     * \brief Returns the maximum number of root devices the control point
+     * keeps built.
+     *
+     * \return The maximum number of root devices the control point keeps
+     * built. Zero means that the number is not limited. This is the default.
+     *
+     * \sa setMaxRootDevices()
+     */
+    qint32 maxRootDevices() const;
+
+    /*!
+     * \brief Returns the maximum number of services the built device trees
+     * of the control point contain in total.
+     *
+     * \return The maximum number of services the built device trees contain
+     * in total. Zero means that the number is not limited. This is the
+     * default.
+     *
+     * \sa setMaxServices()
+     */
+    qint32 maxServices() const;
+
+    /*!
+     * \brief Returns the maximum number of active event subscriptions the
+     * control point keeps.
+     *
+     * \return The maximum number of active event subscriptions the control
+     * point keeps. Zero means that the number is not limited. This is the
+     * default.
+     *
+     * \sa setMaxSubscriptions()
+     */
+    qint32 maxSubscriptions() const;
+
+    /*!
+     * \brief Returns the time in milliseconds after which a request handler
+     * is considered to have stalled the thread of the control point.
+     *
+     * \return The time in milliseconds after which a request handler
+     * is considered to have stalled the thread of the control point. Zero
+     * means that stalls are not detected. This is the default.
+     *
+     * \sa setStallThreshold()
+     */
+    qint32 stallThreshold() const;
+
     /*!
      * Defines whether a control point should automatically subscribe to all
      * events on all services of a device when a new device is added
@@ -206,6 +456,411 @@ public:
      * \sa networkAddressesToUse()
      */
     bool setNetworkAddressesToUse(const QList<QHostAddress>& addresses);
+
+    /*!
+     * \brief Sets the size of the receive buffer of the sockets a control
+     * point uses for SSDP.
+     *
+     * The responses to a discovery request arrive in a burst and a receive
+     * buffer that is too small causes some of them to be dropped.
+     *
+     * \param bytes specifies the size of the receive buffer in bytes.
+     * A value of zero means that the default of the operating system is used.
+     * Negative values are ignored.
+     *
+     * \sa ssdpReceiveBufferSize()
+     */
+    void setSsdpReceiveBufferSize(qint32 bytes);
+
+    /*!
+     * \brief Sets the size of the send buffer of the sockets a control
+     * point uses for sending SSDP messages.
+     *
+     * A discovery that searches for many types at once sends a burst of
+     * requests, which a small send buffer may not hold.
+     *
+     * \param bytes specifies the size of the send buffer in bytes.
+     * A value of zero means that the default of the operating system is used.
+     * Negative values are ignored.
+     *
+     * \sa ssdpSendBufferSize(), HSsdp::setSendBufferSize()
+     */
+    void setSsdpSendBufferSize(qint32 bytes);
+
+    /*!
+     * \brief Specifies whether the SSDP multicast messages of each network
+     * a control point uses are received in a thread of their own.
+     *
+     * On a host attached to several networks, a burst of SSDP traffic on
+     * one network delays the handling of the others when all of them are
+     * read in the same thread. With receive threads enabled each network is
+     * read in a dedicated thread and the received messages of the networks
+     * are processed in turns in the thread of the control point.
+     *
+     * \param enable specifies whether the receive threads are used.
+     *
+     * \sa ssdpReceiveThreadsEnabled(), HSsdp::setReceiveThreadEnabled()
+     */
+    void setSsdpReceiveThreadsEnabled(bool enable);
+
+    /*!
+     * \brief Specifies whether the control point shares the SSDP
+     * multicast sockets with the other control points and device hosts of
+     * its thread.
+     *
+     * A process that runs several control points and device hosts in the
+     * same thread otherwise receives and parses every SSDP multicast message
+     * once per instance. With sharing enabled the instances that use the
+     * same network read the message from one socket, which parses it once
+     * and hands it to each of them. The rest of the networking, such as
+     * the unicast sockets and the HTTP servers, is not shared.
+     *
+     * \param enable specifies whether the SSDP multicast sockets are shared.
+     *
+     * \remarks The value is ignored in case the SSDP receive threads are
+     * enabled.
+     *
+     * \sa sharedSsdpEnabled(), HSsdp::setMulticastSharingEnabled()
+     */
+    void setSharedSsdpEnabled(bool enable);
+
+    /*!
+     * \brief Specifies whether the control point is run in a network thread
+     * of its own.
+     *
+     * When this is enabled HControlPoint::init() moves the control point into
+     * an internal thread, in which all of its SSDP, HTTP and eventing work
+     * is done from then on. The networking then no longer competes with the
+     * other work of the thread that created the control point.
+     *
+     * HControlPoint::init(), HControlPoint::quit() and the destructor
+     * can be called from any thread, as they are run in the network thread
+     * and waited for. The signals of the control point are delivered to
+     * receivers in other threads through queued connections. The rest of the
+     * API and the device model retain their thread affinity to the network
+     * thread.
+     *
+     * \param enable specifies whether the network thread is used.
+     *
+     * \remarks A control point that has a parent object cannot be run in
+     * a network thread, in which case HControlPoint::init() fails.
+     *
+     * \sa networkThreadEnabled()
+     */
+    void setNetworkThreadEnabled(bool enable);
+
+    /*!
+     * \brief Specifies whether the control point listens to the UPnP 1.1
+     * multicast events.
+     *
+     * A UPnP 1.1 device sends the changes of its multicast evented state
+     * variables to the multicast group 239.255.255.246:7900, in which case a
+     * single datagram reaches every control point interested in them.
+     * When this is enabled the control point updates the state variables
+     * of the services it knows based on these events, regardless of whether
+     * it has subscribed to the services.
+     *
+     * \param enable specifies whether the multicast events are received.
+     *
+     * \sa multicastEventingEnabled()
+     */
+    void setMulticastEventingEnabled(bool enable);
+
+    /*!
+     * \brief Specifies the directory in which the control point caches the
+     * descriptions of the devices it builds.
+     *
+     * When a cache directory is set, the device description and the service
+     * descriptions of every device the control point builds are stored into
+     * the directory. A later control point that discovers the same device
+     * with the same UDN, location and \c CONFIGID.UPNP.ORG builds the device
+     * from the stored descriptions without retrieving them from the network.
+     * The device description is retrieved again after the device is added,
+     * and the stored descriptions are dropped if it has changed.
+     *
+     * \param directory specifies the directory in which the descriptions
+     * are cached. An empty string disables the caching.
+     *
+     * \remarks A device that does not send \c CONFIGID.UPNP.ORG, such as
+     * a UPnP 1.0 device, is cached as well. Such a device is detected
+     * to have changed only by the revalidation.
+     *
+     * \sa descriptionCacheDirectory()
+     */
+    void setDescriptionCacheDirectory(const QString& directory);
+
+    /*!
+     * \brief Specifies the maximum number of devices the control point builds
+     * at the same time.
+     *
+     * The builds that exceed the limit wait until an earlier build of the
+     * same control point completes. The limit applies to each control point
+     * separately, even if the control points share a thread pool.
+     *
+     * \param count specifies the maximum number of concurrent device builds.
+     * Zero means that only the thread pool limits the number. Negative values
+     * are treated as zero.
+     *
+     * \sa maxConcurrentDeviceBuilds()
+     */
+    void setMaxConcurrentDeviceBuilds(qint32 count);
+
+    /*!
+     * \brief Specifies the priority of the device builds of the control point
+     * in the thread pool used for the builds.
+     *
+     * The priority decides the order in which a thread pool shared by
+     * several control points runs the device builds waiting in it. The builds
+     * of a control point with a higher priority run first.
+     *
+     * \param priority specifies the priority of the device builds.
+     *
+     * \sa deviceBuildPriority(), setDeviceBuildThreadPool()
+     */
+    void setDeviceBuildPriority(qint32 priority);
+
+    /*!
+     * \brief Specifies the thread pool in which the control point builds
+     * the devices it discovers.
+     *
+     * Several control points can share a single thread pool, in which case
+     * the threads of the pool and the maximum thread count of it are shared
+     * by all of them.
+     *
+     * \param pool specifies the thread pool used for the device builds.
+     * A null pointer makes the control point use a thread pool of its own.
+     * The ownership of the pool is not transferred and the pool has to
+     * outlive every control point that uses it.
+     *
+     * \remarks The thread pool is taken into use when the control point
+     * is initialized.
+     *
+     * \sa deviceBuildThreadPool()
+     */
+    void setDeviceBuildThreadPool(QThreadPool* pool);
+
+    /*!
+     * \brief Specifies whether the control point retrieves the service
+     * descriptions of the devices it builds only when they are needed.
+     *
+     * By default a control point retrieves and parses the description of
+     * every service of a device and creates all of its actions and state
+     * variables before it reports the device. When the descriptions are
+     * retrieved on demand, a device is reported as soon as its device
+     * description has been retrieved, and the description of each service
+     * is retrieved the first time the actions, the state variables or the
+     * description of the service are accessed.
+     *
+     * This is useful when a large number of devices is monitored but the
+     * actions of only a few of them are ever invoked.
+     *
+     * \param enable specifies whether the service descriptions are retrieved
+     * on demand.
+     *
+     * \remarks
+     * \li The first access to a service blocks the calling thread until
+     * the service description has been retrieved. Events are processed
+     * meanwhile.
+     * \li A service whose description cannot be retrieved or parsed has no
+     * actions and no state variables.
+     * \li Subscribing to the events of a service requires its state
+     * variables. When the control point subscribes to events automatically,
+     * the descriptions of the services are retrieved when the device is
+     * added. Use setSubscribeToEvents() to disable that.
+     *
+     * \sa serviceDescriptionsOnDemand(), HClientService::description()
+     */
+    void setServiceDescriptionsOnDemand(bool enable);
+
+    /*!
+     * \brief Specifies the resources whose advertisements and discovery
+     * responses make the control point build a device.
+     *
+     * When a filter is set, an advertisement or a discovery response of a
+     * device that is not in the control of the control point is ignored,
+     * unless the \c NT or the \c ST and the \c USN of it match one of the
+     * entries of the filter. The filter is applied as soon as the message is
+     * received, before the device description is retrieved and before
+     * HControlPoint::acceptResource() is called. The messages of the devices
+     * that are already in the control of the control point are not filtered.
+     *
+     * A device type or a service type in the filter matches the same type
+     * of the same or a higher version, a UDN matches every resource of the
+     * device and HDiscoveryType::RootDevices matches the root device
+     * advertisements. For instance, a filter containing only the type
+     * \c urn:schemas-upnp-org:device:MediaServer:1 makes the control point
+     * build only the devices that advertise themselves or an embedded device
+     * as a MediaServer.
+     *
+     * \param filter specifies the accepted resources. An empty list or a list
+     * containing an HDiscoveryType::All entry accepts every resource.
+     * Undefined entries are ignored.
+     *
+     * \sa discoveryFilter(), HControlPoint::acceptResource()
+     */
+    void setDiscoveryFilter(const QList<HDiscoveryType>& filter);
+
+    /*!
+     * \brief Specifies the maximum number of action invocations the control
+     * point runs to a single device at the same time.
+     *
+     * The invocations of all the actions of all the services of a root device
+     * and its embedded devices share a single queue. The invocations are
+     * sent to the device in the order they were started and the invocations
+     * that exceed the limit wait in the queue until an earlier invocation
+     * completes. Since the network access of the control point keeps the
+     * connections to a device open, the queued invocations reuse the
+     * connections of the earlier ones.
+     *
+     * With the default limit of one, the device receives the invocations one
+     * at a time over a single persistent connection and the invocations
+     * complete in the order they were started. With a higher limit an
+     * invocation that takes long, such as a large \c Browse, does not delay
+     * the others, but the invocations may complete in any order.
+     * The invocations of a single HClientAction are always run one at a time
+     * and in order.
+     *
+     * \param count specifies the maximum number of action invocations in
+     * progress to a single device at the same time. Zero means that the
+     * number is not limited. Negative values are treated as zero.
+     *
+     * \remarks
+     * \li The limit is taken into use for the devices built after the
+     * control point is initialized.
+     * \li No more than six connections are opened to a single device,
+     * regardless of the limit.
+     *
+     * \sa maxConcurrentInvocations(), HClientAction::beginInvoke()
+     */
+    void setMaxConcurrentInvocations(qint32 count);
+
+    /*!
+     * \brief Specifies the path at which the control point serves its runtime
+     * metrics.
+     *
+     * When a path is set, an HTTP GET request to the path on any of the
+     * HTTP endpoints of the control point is answered with the counters and
+     * latency summaries of the
+     * HControlPointRuntimeStatus in the
+     * OpenMetrics text format, which can be scraped by Prometheus, for
+     * instance. The metrics are rendered when they are requested.
+     *
+     * \param path specifies the absolute path at which the metrics are
+     * served, such as \c /metrics. An empty path means that the metrics are
+     * not served. A path that does not start with a slash is ignored.
+     *
+     * \remarks The metrics are served to anyone that can reach the HTTP
+     * endpoints.
+     *
+     * \sa metricsPath(), HControlPointRuntimeStatus
+     */
+    void setMetricsPath(const QString& path);
+
+    /*!
+     * \brief Defines whether the control point keeps searching for devices
+     * on its own after it has been initialized.
+     *
+     * Instead of the single search of autoDiscovery(), the control point
+     * sends a burst of three searches for root devices a second apart when
+     * it is initialized and when it starts to use another network address.
+     * After that the interval between the searches starts from ten seconds
+     * and doubles up to fifteen minutes for as long as the devices on the
+     * network stay the same. A device that appears, says byebye or expires
+     * brings the interval back to ten seconds. This keeps rootDevices()
+     * up to date without the application calling scan() on a timer.
+     *
+     * \param arg when \e true the control point schedules its own searches.
+     * The default is \e false.
+     *
+     * \remarks When this is enabled the setting of setAutoDiscovery() has
+     * no effect.
+     *
+     * \sa adaptiveDiscovery(), setMaxDiscoveryRate()
+     */
+    void setAdaptiveDiscovery(bool arg);
+
+    /*!
+     * \brief Specifies the maximum number of M-SEARCH packets the control
+     * point sends per second.
+     *
+     * A search sends one packet on every network address in use. The searches
+     * the control point schedules on its own are delayed for as long as
+     * sending them would exceed the rate. The searches requested with
+     * HControlPoint::scan() are always sent, but they are charged against
+     * the same rate and hence they delay the scheduled searches.
+     *
+     * \param packetsPerSecond specifies the maximum number of M-SEARCH packets
+     * sent per second. Zero means that the rate is not limited. Negative
+     * values are treated as zero.
+     *
+     * \sa maxDiscoveryRate(), setAdaptiveDiscovery()
+     */
+    void setMaxDiscoveryRate(qint32 packetsPerSecond);
+
+    /*!
+     * \brief Specifies the maximum number of root devices the control point
+     * keeps built.
+     *
+     * When a new device tree would exceed this, or the limits set with
+     * setMaxServices() and setMaxSubscriptions(), the control point evicts
+     * the root devices that were used least recently until the limits are
+     * met. The model of an evicted device is deleted and
+     * HControlPoint::rootDeviceEvicted() is emitted. Only the information
+     * in the advertisements of the device is kept, which is refreshed by
+     * the advertisements as usual. The device is built again once the
+     * application looks it up with HControlPoint::device(). A device is
+     * considered used when it is added, looked up with
+     * HControlPoint::device() or subscribed to.
+     *
+     * The device that was added last is never evicted, so a single device
+     * tree that exceeds the limits on its own is kept.
+     *
+     * \param count specifies the maximum number of root devices. Zero means
+     * that the number is not limited. Negative values are treated as zero.
+     *
+     * \sa maxRootDevices(), setMaxServices(), setMaxSubscriptions()
+     */
+    void setMaxRootDevices(qint32 count);
+
+    /*!
+     * \brief Specifies the maximum number of services the built device trees
+     * of the control point contain in total.
+     *
+     * \param count specifies the maximum number of services. Zero means that
+     * the number is not limited. Negative values are treated as zero.
+     *
+     * \sa maxServices(), setMaxRootDevices()
+     */
+    void setMaxServices(qint32 count);
+
+    /*!
+     * \brief Specifies the maximum number of active event subscriptions the
+     * control point keeps.
+     *
+     * \param count specifies the maximum number of active event
+     * subscriptions. Zero means that the number is not limited. Negative
+     * values are treated as zero.
+     *
+     * \sa maxSubscriptions(), setMaxRootDevices()
+     */
+    void setMaxSubscriptions(qint32 count);
+
+    /*!
+     * \brief Specifies the time in milliseconds after which a request handler
+     * is considered to have stalled the thread of the control point.
+     *
+     * When a threshold is set, the control point times the handling of
+     * every HTTP request it receives, such as an event notification, and
+     * records the ones that take longer than the threshold by the HTTP method
+     * and path. A heartbeat timer catches the stalls caused by anything else.
+     * The stalls are reported by HControlPointRuntimeStatus.
+     *
+     * \param msecs specifies the threshold in milliseconds. Zero disables
+     * the detection. Negative values are treated as zero.
+     *
+     * \sa stallThreshold(), HControlPointRuntimeStatus::stalledHandlers()
+     */
+    void setStallThreshold(qint32 msecs);
 };
 
 }
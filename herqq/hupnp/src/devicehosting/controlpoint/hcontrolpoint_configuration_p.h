@@ -31,10 +31,14 @@
 //
 
 #include "../../utils/hglobal.h"
+#include "../../dataelements/hdiscoverytype.h"
 
 #include <QtCore/QList>
+#include <QtCore/QString>
 #include <QtNetwork/QHostAddress>
 
+class QThreadPool;
+
 namespace Herqq
 {
 
@@ -54,6 +58,26 @@ public: // attributes
     qint32 m_desiredSubscriptionTimeout;
     bool m_autoDiscovery;
     QList<QHostAddress> m_networkAddresses;
+    qint32 m_ssdpReceiveBufferSize;
+    qint32 m_ssdpSendBufferSize;
+    bool m_ssdpReceiveThreads;
+    bool m_sharedSsdp;
+    bool m_networkThread;
+    bool m_multicastEventing;
+    QString m_descriptionCacheDirectory;
+    qint32 m_maxConcurrentDeviceBuilds;
+    qint32 m_deviceBuildPriority;
+    QThreadPool* m_deviceBuildThreadPool;
+    bool m_serviceDescriptionsOnDemand;
+    QList<HDiscoveryType> m_discoveryFilter;
+    qint32 m_maxConcurrentInvocations;
+    QString m_metricsPath;
+    bool m_adaptiveDiscovery;
+    qint32 m_maxDiscoveryRate;
+    qint32 m_maxRootDevices;
+    qint32 m_maxServices;
+    qint32 m_maxSubscriptions;
+    qint32 m_stallThreshold;
 
 public: // methods
 
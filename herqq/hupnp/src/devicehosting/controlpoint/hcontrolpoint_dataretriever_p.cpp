@@ -22,10 +22,12 @@
 #include "hcontrolpoint_dataretriever_p.h"
 
 #include "../../general/hlogger_p.h"
+#include "../hddoc_parser_p.h"
 #include "../../general/hupnp_global_p.h"
 
 #include <QtCore/QUrl>
 #include <QtCore/QTimerEvent>
+#include <QtCore/QXmlStreamReader>
 #include <QtNetwork/QNetworkReply>
 #include <QtNetwork/QNetworkRequest>
 
@@ -37,17 +39,45 @@ namespace Upnp
 
 HDataRetriever::HDataRetriever(const QByteArray& loggingId) :
     m_loggingIdentifier(loggingId), m_nam(), m_reply(0), m_lastError(),
-    m_success(false)
+    m_success(false), m_aborted(false), m_pendingPrefetches(), m_prefetched()
 {
     bool ok = connect(
-        &m_nam, SIGNAL(finished(QNetworkReply*)), this, SLOT(finished()));
+        &m_nam, SIGNAL(finished(QNetworkReply*)),
+        this, SLOT(finished(QNetworkReply*)));
     Q_ASSERT(ok); Q_UNUSED(ok)
 }
 
-void HDataRetriever::finished()
+void HDataRetriever::finished(QNetworkReply* reply)
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
+    if (m_pendingPrefetches.contains(reply))
+    {
+        QString request = m_pendingPrefetches.take(reply);
+        if (reply->error() == QNetworkReply::NoError)
+        {
+            m_prefetched.insert(request, reply->readAll());
+        }
+        else
+        {
+            HLOG_WARN(QString("Request failed: %1").arg(reply->errorString()));
+        }
+
+        reply->deleteLater();
+
+        if (m_pendingPrefetches.isEmpty())
+        {
+            quit();
+        }
+
+        return;
+    }
+    else if (reply != m_reply)
+    {
+        // a prefetch that was aborted
+        return;
+    }
+
     quit();
 
     if (m_reply->error() != QNetworkReply::NoError)
@@ -61,11 +91,19 @@ void HDataRetriever::finished()
     }
 }
 
-bool HDataRetriever::retrieveData(
-    const QUrl& baseUrl, const QUrl& query, QByteArray* data)
+void HDataRetriever::abort()
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
+    m_aborted = true;
+    m_success = false;
+    m_lastError = "The retrieval was aborted";
+
+    quit();
+}
+
+QString HDataRetriever::requestUrl(const QUrl& baseUrl, const QUrl& query)
+{
     QString queryPart = extractRequestPart(query);
 
     QString request = queryPart.startsWith('/') ?
@@ -83,6 +121,27 @@ bool HDataRetriever::retrieveData(
         request.append('/');
     }
 
+    return request;
+}
+
+bool HDataRetriever::retrieveData(
+    const QUrl& baseUrl, const QUrl& query, QByteArray* data)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    if (m_aborted)
+    {
+        return false;
+    }
+
+    QString request = requestUrl(baseUrl, query);
+
+    if (m_prefetched.contains(request))
+    {
+        *data = m_prefetched.take(request);
+        return true;
+    }
+
     QNetworkRequest req(request);
     m_reply = m_nam.get(req);
 
@@ -90,6 +149,11 @@ bool HDataRetriever::retrieveData(
     exec();
     killTimer(id);
 
+    if (m_aborted)
+    {
+        m_success = false;
+    }
+
     if (m_success)
     {
         *data = m_reply->readAll();
@@ -112,7 +176,7 @@ void HDataRetriever::timerEvent(QTimerEvent* event)
 }
 
 bool HDataRetriever::retrieveServiceDescription(
-    const QUrl& deviceLocation, const QUrl& scpdUrl, QString* data)
+    const QUrl& deviceLocation, const QUrl& scpdUrl, QByteArray* data)
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
@@ -120,45 +184,80 @@ bool HDataRetriever::retrieveServiceDescription(
         "Attempting to fetch a service description for [%1] from: [%2]").arg(
             scpdUrl.toString(), deviceLocation.toString()));
 
-    QByteArray tmp;
-    if (!retrieveData(deviceLocation, scpdUrl, &tmp))
-    {
-        return false;
-    }
-
-    *data = QString::fromUtf8(tmp);
-    return true;
+    return retrieveData(deviceLocation, scpdUrl, data);
 }
 
-bool HDataRetriever::retrieveIcon(
-    const QUrl& deviceLocation, const QUrl& iconUrl, QByteArray* data)
+bool HDataRetriever::retrieveDeviceDescription(
+    const QUrl& deviceLocation, QByteArray* data)
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
     HLOG_DBG(QString(
-        "Attempting to retrieve icon [%1] from: [%2]").arg(
-            iconUrl.toString(), deviceLocation.toString()));
+        "Attempting to fetch a device description from: [%1]").arg(
+            deviceLocation.toString()));
 
-    return retrieveData(deviceLocation, iconUrl, data);
+    return retrieveData(deviceLocation, QUrl(), data);
 }
 
-bool HDataRetriever::retrieveDeviceDescription(
-    const QUrl& deviceLocation, QString* data)
+void HDataRetriever::prefetchServiceDescriptions(
+    const QUrl& deviceLocation, const QByteArray& deviceDescription)
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
+    if (m_aborted)
+    {
+        return;
+    }
+
+    QXmlStreamReader reader(deviceDescription);
+    while (!reader.atEnd())
+    {
+        if (reader.readNext() != QXmlStreamReader::StartElement ||
+            reader.name() != "SCPDURL")
+        {
+            continue;
+        }
+
+        QString request = requestUrl(
+            deviceLocation,
+            HDocParser::parsedStringToUrl(reader.readElementText().trimmed()));
+
+        if (m_prefetched.contains(request) ||
+            m_pendingPrefetches.values().contains(request))
+        {
+            continue;
+        }
+
+        // QNetworkAccessManager runs the requests in parallel over the
+        // connections it keeps open to the device
+        QNetworkReply* reply = m_nam.get(QNetworkRequest(request));
+        m_pendingPrefetches.insert(reply, request);
+    }
+
+    if (m_pendingPrefetches.isEmpty())
+    {
+        return;
+    }
+
     HLOG_DBG(QString(
-        "Attempting to fetch a device description from: [%1]").arg(
+        "Prefetching [%1] service descriptions from: [%2]").arg(
+            QString::number(m_pendingPrefetches.size()),
             deviceLocation.toString()));
 
-    QByteArray tmp;
-    if (!retrieveData(deviceLocation, QUrl(), &tmp))
+    int id = startTimer(3000);
+    exec();
+    killTimer(id);
+
+    // the requests that did not complete in time are retried one by one
+    // when the service descriptions are retrieved
+    QList<QNetworkReply*> unfinished = m_pendingPrefetches.keys();
+    m_pendingPrefetches.clear();
+
+    foreach(QNetworkReply* reply, unfinished)
     {
-        return false;
+        reply->abort();
+        reply->deleteLater();
     }
-
-    *data = QString::fromUtf8(tmp);
-    return true;
 }
 
 }
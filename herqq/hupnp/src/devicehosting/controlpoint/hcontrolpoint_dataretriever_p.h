@@ -32,6 +32,7 @@
 
 #include "../../general/hupnp_defs.h"
 
+#include <QtCore/QHash>
 #include <QtCore/QByteArray>
 #include <QtCore/QEventLoop>
 #include <QtNetwork/QNetworkAccessManager>
@@ -56,7 +57,14 @@ H_DISABLE_COPY(HDataRetriever)
 
 private slots:
 
-    void finished();
+    void finished(QNetworkReply*);
+
+public slots:
+
+    // ends the ongoing retrieval and makes every subsequent retrieval fail.
+    // this is meant to be invoked through a queued connection from another
+    // thread, when the retrieval is no longer needed
+    void abort();
 
 private:
 
@@ -66,6 +74,15 @@ private:
     QString m_lastError;
 
     bool m_success;
+    bool m_aborted;
+
+    QHash<QNetworkReply*, QString> m_pendingPrefetches;
+    // the requests issued by prefetchServiceDescriptions() that have not
+    // completed yet
+
+    QHash<QString, QByteArray> m_prefetched;
+    // the prefetched data keyed by the request from which it was retrieved.
+    // each entry is consumed by the first retrieval of it
 
 private:
 
@@ -79,18 +96,27 @@ public:
 
     HDataRetriever(const QByteArray& loggingId);
 
+    // returns the request for the specified URL relative to the base URL of
+    // a device
+    static QString requestUrl(const QUrl& baseUrl, const QUrl& query);
+
     inline QString lastError() const
     {
         return m_lastError;
     }
 
     bool retrieveServiceDescription(
-        const QUrl& deviceLocation, const QUrl& scpdUrl, QString*);
+        const QUrl& deviceLocation, const QUrl& scpdUrl, QByteArray*);
 
-    bool retrieveIcon(
-        const QUrl& deviceLocation, const QUrl& iconUrl, QByteArray*);
+    bool retrieveDeviceDescription(const QUrl& deviceLocation, QByteArray*);
 
-    bool retrieveDeviceDescription(const QUrl& deviceLocation, QString*);
+    // issues the requests for every service description referenced in the
+    // specified device description at once and waits for all of them to
+    // complete. the service descriptions retrieved this way are returned
+    // by the subsequent calls to retrieveServiceDescription() without
+    // additional round trips
+    void prefetchServiceDescriptions(
+        const QUrl& deviceLocation, const QByteArray& deviceDescription);
 };
 
 }
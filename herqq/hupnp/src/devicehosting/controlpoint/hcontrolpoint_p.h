@@ -32,7 +32,10 @@
 
 #include "hcontrolpoint.h"
 #include "hdevicebuild_p.h"
+#include "hicon_cache_p.h"
+#include "hservicedescription_cache_p.h"
 #include "hevent_subscriptionmanager_p.h"
+#include "hcontrolpoint_runtimestatus_p.h"
 
 #include "../hdevicestorage_p.h"
 
@@ -45,8 +48,12 @@
 #include "../../ssdp/hdiscovery_messages.h"
 
 #include "../../utils/hthreadpool_p.h"
+#include "../../utils/hlatency_samples_p.h"
+#include "../../utils/hnetworkthread_p.h"
 
+#include <QtCore/QHash>
 #include <QtCore/QUuid>
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QScopedPointer>
 #include <QtNetwork/QNetworkAccessManager>
 
@@ -56,6 +63,10 @@ namespace Herqq
 namespace Upnp
 {
 
+class HTimerWheel;
+class HDataRetriever;
+class HDiscoveryScheduler;
+class HDescriptionCache;
 class HControlPointPrivate;
 
 //
@@ -75,6 +86,10 @@ protected:
 
     virtual void incomingNotifyMessage(HMessagingInfo*, const HNotifyRequest&);
 
+    virtual void incomingUnknownGetRequest(
+        HMessagingInfo*, const HHttpRequestHeader&);
+    // serves the metrics, in case they are enabled in the configuration
+
 public:
 
     explicit ControlPointHttpServer(HControlPointPrivate*);
@@ -85,7 +100,8 @@ public:
 //
 //
 class HControlPointSsdpHandler :
-    public HSsdp
+    public HSsdp,
+    private HSsdpRepeatFilter
 {
 H_DISABLE_COPY(HControlPointSsdpHandler)
 
@@ -93,6 +109,8 @@ private:
 
     HControlPointPrivate* m_owner;
 
+    virtual bool handleRepeat(const QByteArray& key, const HEndpoint& source);
+
 protected:
 
     virtual bool incomingDiscoveryResponse(
@@ -108,6 +126,77 @@ public:
 
     HControlPointSsdpHandler(HControlPointPrivate*);
     virtual ~HControlPointSsdpHandler();
+
+    // the repeat key of the message being processed, if any
+    inline const QByteArray& repeatKey() const
+    {
+        return h_ptr->m_repeatKey;
+    }
+};
+
+//
+// Describes the scheduled expiry of a root device: the message that last
+// postponed it and the time the device tree is considered available after
+// that message. this is reported when the device expires.
+//
+class HDeviceExpiry
+{
+public:
+
+    enum Source
+    {
+        DeviceAdded,
+        Announcement,
+        DiscoveryResponse,
+        RepeatedAdvertisement
+    };
+
+    Source m_source;
+    qint32 m_timeoutInSecs;
+
+    HDeviceExpiry() : m_source(DeviceAdded), m_timeoutInSecs(0) {}
+
+    HDeviceExpiry(Source source, qint32 timeoutInSecs) :
+        m_source(source), m_timeoutInSecs(timeoutInSecs)
+    {
+    }
+
+    QString toString() const;
+};
+
+//
+// The advertised information of a root device whose model was evicted to
+// keep the control point within the limits of its configuration. this is
+// all that is kept of the device until it is built again.
+//
+class HEvictedDevice
+{
+public:
+
+    QList<HUdn> m_udns;
+    // the UDNs of the devices in the tree, the root device first
+
+    QUrl m_location;
+    qint32 m_cacheControlMaxAge;
+    qint32 m_bootId;
+    qint32 m_configId;
+    qint32 m_searchPort;
+    // from the latest advertisement of the device
+
+    QElapsedTimer m_advertised;
+    // started when the device was last advertised. the device is forgotten
+    // once the max age of the advertisement has passed
+
+    HEvictedDevice() :
+        m_udns(), m_location(), m_cacheControlMaxAge(0), m_bootId(-1),
+        m_configId(-1), m_searchPort(-1), m_advertised()
+    {
+    }
+
+    inline bool isExpired() const
+    {
+        return m_advertised.elapsed() > m_cacheControlMaxAge * 1000;
+    }
 };
 
 //
@@ -149,11 +238,41 @@ private:
     template<class Msg>
     bool shouldFetch(const Msg&);
 
+    template<class Msg>
+    void startDeviceBuild(const Msg&, bool refresh);
+
+    // replaces the services of a known root device whose configuration has
+    // changed with the ones of a new build of the device, when the services
+    // differ. the services that have not changed are kept as they are.
+    // returns false in case the device trees differ by more than their
+    // services and the information of their devices
+    bool updateRootDevice(
+        HDefaultClientDevice* rootDevice, HDefaultClientDevice* build);
+
+    // checks the resource against the discovery filter of the configuration
+    bool passesDiscoveryFilter(const HDiscoveryType& resource) const;
+
+    // refreshes the information of an evicted device from an advertisement
+    // of any device in its tree. returns false in case the device has not
+    // been evicted
+    template<class Msg>
+    bool processEvictedDiscovery(const Msg&);
+
+    // deletes the model of a root device and keeps its advertised
+    // information, in case it is online
+    void evict(HDefaultClientDevice* root);
+    void forgetEvicted(const HUdn& rootUdn);
+
 private Q_SLOTS:
 
     void deviceExpired(HDefaultClientDevice* source);
+    void subscribed(Herqq::Upnp::HClientService*);
     void unsubscribed(Herqq::Upnp::HClientService*);
 
+    // evicts the least recently used root devices until the limits of the
+    // configuration are met. the device used last is never evicted
+    void enforceLimits();
+
 public:
 
     const QByteArray m_loggingIdentifier;
@@ -187,13 +306,101 @@ public:
 
     HThreadPool* m_threadPool;
 
+    HDescriptionCache* m_descriptionCache;
+    // null unless the descriptions are cached. created when the control
+    // point is initialized and deleted after the thread pool is shut down,
+    // as the device builds use it
+
+    HServiceDescriptionCache m_serviceDescriptionCache;
+    // the parsed service descriptions of the devices built, shared by
+    // every device using an identical description
+
+    HIconCache m_iconCache;
+    // the icons retrieved by the devices, keyed by their URLs
+
     HDeviceStorage<HClientDevice, HClientService> m_deviceStorage;
 
+    QHash<QByteArray, HDefaultClientDevice*> m_knownAnnouncements;
+    // the repeat keys of the announcements and discovery responses of the
+    // online root devices. a repetition of any of these only refreshes
+    // the timeouts of the device tree.
+
+    bool processRepeatedDiscovery(const QByteArray& repeatKey);
+    void forgetAnnouncements(const HClientDevice* rootDevice);
+
+    HTimerWheel* m_expiryWheel;
+    QHash<HDefaultClientDevice*, HDeviceExpiry> m_expiries;
+    // the root devices are expired centrally instead of each device running
+    // timers of its own. an advertisement of a device tree only re-schedules
+    // the expiry of the root device, which is a constant time operation.
+
+    void scheduleExpiry(HDefaultClientDevice* root, HDeviceExpiry::Source);
+    void cancelExpiry(HDefaultClientDevice* root);
+
+    HDiscoveryScheduler* m_discoveryScheduler;
+    // null unless the configuration asked for adaptive discovery
+
+    QHash<const HClientDevice*, quint64> m_lastUses;
+    quint64 m_useCount;
+    // the use count at the time each root device was last used. used to
+    // find the least recently used device when the limits are exceeded
+
+    QHash<HUdn, HEvictedDevice> m_evictedDevices;
+    // key == the UDN of an evicted root device
+
+    QHash<HUdn, HUdn> m_evictedUdns;
+    // key == the UDN of a device in an evicted tree, value == the UDN of
+    // the root device
+
+    bool m_limitCheckPending;
+
+    bool hasLimits() const;
+
+    // marks the root device of the specified device used
+    void touch(const HClientDevice* device);
+
+    // starts a new build of the device tree that contains the specified
+    // device, in case the tree has been evicted. returns true if the build
+    // was started
+    bool rebuildEvicted(const HUdn& udn);
+
+    // sends a search for root devices on every network address in use and
+    // returns the number of packets sent
+    qint32 sendDiscoveryRequests();
+
+    QScopedPointer<HControlPointRuntimeStatus> m_runtimeStatus;
+
+    qint64 m_startedBuilds;
+    qint64 m_failedBuilds;
+    HLatencySamples m_buildLatencies;
+    // the number of device model builds started and failed and the
+    // durations of the recent builds, from queueing to completion
+
+    HNetworkThread* m_networkThread;
+    // the thread the control point is run in, if the configuration asked
+    // for one. the calls to init() and quit() from other threads are run
+    // in this thread
+
     HControlPointPrivate();
     virtual ~HControlPointPrivate();
 
+    // creates an SSDP handler configured according to the configuration of
+    // the control point. the handler is not initialized
+    HControlPointSsdpHandler* createSsdpHandler();
+
+    // sets the network addresses of the configuration to the ones the
+    // SSDP handlers are bound to
+    void updateNetworkAddresses();
+
+    // cachedDescription is set to the device description in case the device
+    // was built entirely from the description cache
     HDefaultClientDevice* buildDevice(
-        const QUrl& deviceLocation, qint32 maxAge, QString* err);
+        const QUrl& deviceLocation, qint32 maxAge, const HUdn& udn,
+        qint32 configId, bool allDescriptions, HDataRetriever* dataRetriever,
+        QByteArray* cachedDescription, QString* err, quint32 requestId = 0);
+    // the request id identifies the build in the structured tracing.
+    // allDescriptions retrieves every service description even if the
+    // configuration asks for them to be retrieved on demand
 };
 
 }
@@ -0,0 +1,274 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "hdescription_cache_p.h"
+#include "hcontrolpoint_dataretriever_p.h"
+
+#include "../../dataelements/hudn.h"
+#include "../../general/hlogger_p.h"
+
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QThread>
+#include <QtCore/QDataStream>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QCryptographicHash>
+#include <QtNetwork/QNetworkReply>
+#include <QtNetwork/QNetworkRequest>
+#include <QtNetwork/QNetworkAccessManager>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace
+{
+// identifies the format of the cache files. entries of other formats are
+// ignored. the descriptions are stored as the documents they were received
+// as since the second version
+const quint32 CacheFileMagic = 0x48644332;
+}
+
+/*******************************************************************************
+ * HCachingDescriptionFetcher
+ ******************************************************************************/
+HCachingDescriptionFetcher::HCachingDescriptionFetcher(
+    HDataRetriever* retriever, HDescriptionCacheEntry* entry) :
+        m_retriever(retriever), m_entry(entry), m_networkUsed(false)
+{
+    Q_ASSERT(m_retriever);
+    Q_ASSERT(m_entry);
+}
+
+bool HCachingDescriptionFetcher::retrieveServiceDescription(
+    const QUrl& deviceLocation, const QUrl& scpdUrl, QByteArray* data)
+{
+    QString key = scpdUrl.toString();
+
+    QHash<QString, QByteArray>::const_iterator ci =
+        m_entry->m_serviceDescriptions.constFind(key);
+
+    if (ci != m_entry->m_serviceDescriptions.constEnd())
+    {
+        *data = ci.value();
+        return true;
+    }
+
+    m_networkUsed = true;
+    if (!m_retriever->retrieveServiceDescription(deviceLocation, scpdUrl, data))
+    {
+        return false;
+    }
+
+    m_entry->m_serviceDescriptions.insert(key, *data);
+    return true;
+}
+
+/*******************************************************************************
+ * HDescriptionCache
+ ******************************************************************************/
+HDescriptionCache::HDescriptionCache(
+    const QString& directory, const QByteArray& loggingId, QObject* parent) :
+        QObject(parent),
+            m_loggingIdentifier(loggingId), m_directory(directory),
+            m_mutex(), m_revalidations()
+{
+    QDir().mkpath(m_directory);
+}
+
+HDescriptionCache::~HDescriptionCache()
+{
+    QList<QNetworkReply*> replies = m_revalidations.keys();
+    m_revalidations.clear();
+
+    foreach(QNetworkReply* reply, replies)
+    {
+        reply->abort();
+        reply->deleteLater();
+    }
+}
+
+QString HDescriptionCache::fileName(
+    const HUdn& udn, const QUrl& location, qint32 configId) const
+{
+    QString key = QString("%1\n%2\n%3").arg(
+        udn.toString(), location.toString(), QString::number(configId));
+
+    QByteArray digest = QCryptographicHash::hash(
+        key.toUtf8(), QCryptographicHash::Sha1).toHex();
+
+    return QDir(m_directory).filePath(
+        QString::fromLatin1(digest).append(".cache"));
+}
+
+bool HDescriptionCache::get(
+    const HUdn& udn, const QUrl& location, qint32 configId,
+    HDescriptionCacheEntry* entry)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    Q_ASSERT(entry);
+
+    QMutexLocker lock(&m_mutex);
+
+    QFile file(fileName(udn, location, configId));
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_4_6);
+
+    quint32 magic = 0;
+    QString udnStr, locationStr;
+    HDescriptionCacheEntry tmp;
+
+    in >> magic;
+    if (magic != CacheFileMagic)
+    {
+        return false;
+    }
+
+    in >> udnStr >> locationStr >>
+          tmp.m_deviceDescription >> tmp.m_serviceDescriptions;
+
+    if (in.status() != QDataStream::Ok || tmp.isEmpty() ||
+        udnStr != udn.toString() || locationStr != location.toString())
+    {
+        HLOG_WARN(QString(
+            "Ignoring a corrupt description cache entry: [%1]").arg(
+                file.fileName()));
+        return false;
+    }
+
+    *entry = tmp;
+    return true;
+}
+
+void HDescriptionCache::put(
+    const HUdn& udn, const QUrl& location, qint32 configId,
+    const HDescriptionCacheEntry& entry)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    Q_ASSERT(!entry.isEmpty());
+
+    QMutexLocker lock(&m_mutex);
+
+    // the entry is written to a temporary file first, so that a partially
+    // written file is never read as an entry
+    QString name = fileName(udn, location, configId);
+    QString tmpName = QString(name).append(".tmp");
+
+    QFile file(tmpName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        HLOG_WARN(QString("Failed to write a description cache entry: %1").arg(
+            file.errorString()));
+        return;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_4_6);
+
+    out << CacheFileMagic << udn.toString() << location.toString() <<
+           entry.m_deviceDescription << entry.m_serviceDescriptions;
+
+    file.close();
+
+    if (out.status() != QDataStream::Ok || file.error() != QFile::NoError)
+    {
+        QFile::remove(tmpName);
+        return;
+    }
+
+    QFile::remove(name);
+    if (!QFile::rename(tmpName, name))
+    {
+        QFile::remove(tmpName);
+    }
+}
+
+void HDescriptionCache::remove(
+    const HUdn& udn, const QUrl& location, qint32 configId)
+{
+    QMutexLocker lock(&m_mutex);
+    QFile::remove(fileName(udn, location, configId));
+}
+
+void HDescriptionCache::revalidate(
+    QNetworkAccessManager* nam, const HUdn& udn, const QUrl& location,
+    qint32 configId, const QByteArray& cachedDeviceDescription)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    Q_ASSERT(thread() == QThread::currentThread());
+
+    Revalidation revalidation;
+    revalidation.m_fileName = fileName(udn, location, configId);
+    revalidation.m_deviceDescription = cachedDeviceDescription;
+
+    QNetworkReply* reply = nam->get(QNetworkRequest(location));
+    m_revalidations.insert(reply, revalidation);
+
+    bool ok = connect(
+        reply, SIGNAL(finished()), this, SLOT(revalidationDone()));
+    Q_ASSERT(ok); Q_UNUSED(ok)
+}
+
+void HDescriptionCache::revalidationDone()
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
+    if (!reply || !m_revalidations.contains(reply))
+    {
+        return;
+    }
+
+    Revalidation revalidation = m_revalidations.take(reply);
+    reply->deleteLater();
+
+    if (reply->error() != QNetworkReply::NoError)
+    {
+        // the device may be offline. the entry is still checked the next
+        // time it is used
+        return;
+    }
+
+    if (reply->readAll() != revalidation.m_deviceDescription)
+    {
+        HLOG_WARN(QString(
+            "The device description at [%1] has changed without a change in "
+            "CONFIGID.UPNP.ORG. Dropping the cached descriptions.").arg(
+                reply->url().toString()));
+
+        QMutexLocker lock(&m_mutex);
+        QFile::remove(revalidation.m_fileName);
+    }
+}
+
+}
+}
@@ -0,0 +1,165 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef HDESCRIPTION_CACHE_P_H_
+#define HDESCRIPTION_CACHE_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include "../../general/hupnp_defs.h"
+
+#include <QtCore/QUrl>
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QObject>
+#include <QtCore/QString>
+
+class QNetworkReply;
+class QNetworkAccessManager;
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+class HUdn;
+class HDataRetriever;
+
+//
+// The device description of a root device and the service descriptions
+// referenced in it
+//
+class HDescriptionCacheEntry
+{
+public:
+
+    QByteArray m_deviceDescription;
+
+    QHash<QString, QByteArray> m_serviceDescriptions;
+    // keyed by the SCPD URLs as the model creator requests them
+
+    inline bool isEmpty() const
+    {
+        return m_deviceDescription.isEmpty();
+    }
+};
+
+//
+// A service description fetcher for the model creator. The service
+// descriptions are looked up from the entry first and retrieved through the
+// data retriever otherwise. every description that is retrieved is recorded
+// into the entry, so that the entry can be stored once the build succeeds.
+//
+class HCachingDescriptionFetcher
+{
+H_DISABLE_COPY(HCachingDescriptionFetcher)
+
+private:
+
+    HDataRetriever* m_retriever;
+    HDescriptionCacheEntry* m_entry;
+    bool m_networkUsed;
+
+public:
+
+    HCachingDescriptionFetcher(
+        HDataRetriever* retriever, HDescriptionCacheEntry* entry);
+
+    bool retrieveServiceDescription(
+        const QUrl& deviceLocation, const QUrl& scpdUrl, QByteArray*);
+
+    inline bool networkUsed() const { return m_networkUsed; }
+};
+
+//
+// An on-disk cache of the descriptions of the root devices a control point
+// has built. The entries are keyed by the UDN, the location and the
+// CONFIGID.UPNP.ORG of the root device, since a device is required to change
+// its CONFIGID.UPNP.ORG whenever any of its descriptions change.
+//
+// The entries are read and written from the threads that build the devices,
+// while revalidate() has to be called from the thread of the cache.
+//
+class HDescriptionCache :
+    public QObject
+{
+Q_OBJECT
+H_DISABLE_COPY(HDescriptionCache)
+
+private:
+
+    const QByteArray m_loggingIdentifier;
+    const QString m_directory;
+
+    QMutex m_mutex;
+
+    struct Revalidation
+    {
+        QString m_fileName;
+        QByteArray m_deviceDescription;
+    };
+
+    QHash<QNetworkReply*, Revalidation> m_revalidations;
+
+    QString fileName(
+        const HUdn& udn, const QUrl& location, qint32 configId) const;
+
+private Q_SLOTS:
+
+    void revalidationDone();
+
+public:
+
+    HDescriptionCache(
+        const QString& directory, const QByteArray& loggingId,
+        QObject* parent);
+
+    virtual ~HDescriptionCache();
+
+    bool get(
+        const HUdn& udn, const QUrl& location, qint32 configId,
+        HDescriptionCacheEntry*);
+
+    void put(
+        const HUdn& udn, const QUrl& location, qint32 configId,
+        const HDescriptionCacheEntry&);
+
+    void remove(const HUdn& udn, const QUrl& location, qint32 configId);
+
+    // fetches the device description again and drops the entry if the
+    // device description has changed since the entry was stored
+    void revalidate(
+        QNetworkAccessManager* nam, const HUdn& udn, const QUrl& location,
+        qint32 configId, const QByteArray& cachedDeviceDescription);
+};
+
+}
+}
+
+#endif /* HDESCRIPTION_CACHE_P_H_ */
@@ -21,6 +21,7 @@
 
 #include "hdevicebuild_p.h"
 #include "hcontrolpoint_p.h"
+#include "hcontrolpoint_dataretriever_p.h"
 
 #include "../../devicemodel/client/hdefault_clientdevice_p.h"
 
@@ -52,14 +53,60 @@ HDefaultClientDevice* DeviceBuildTask::createdDevice()
     return m_createdDevice.take();
 }
 
+void DeviceBuildTask::cancel()
+{
+    QMutexLocker locker(&m_retrieverMutex);
+    if (m_retriever)
+    {
+        // the retriever runs an event loop in the thread of the build
+        bool ok = QMetaObject::invokeMethod(
+            m_retriever, "abort", Qt::QueuedConnection);
+
+        Q_ASSERT(ok); Q_UNUSED(ok)
+    }
+}
+
 void DeviceBuildTask::run()
 {
     HLOG2(H_AT, H_FUN, m_owner->m_loggingIdentifier);
 
+    if (m_queuedAt >= 0)
+    {
+        HTraceRecorder::complete("build", "queue", m_queuedAt, m_requestId);
+    }
+
     QString err;
     QScopedPointer<HDefaultClientDevice> device;
-    device.reset(
-        m_owner->buildDevice(m_locations[0], m_cacheControlMaxAge, &err));
+
+    if (isExiting())
+    {
+        // the control point was shut down before the build started
+        err = "The device build was cancelled";
+    }
+    else
+    {
+        HDataRetriever dataRetriever(m_owner->m_loggingIdentifier);
+
+        QMutexLocker locker(&m_retrieverMutex);
+        m_retriever = &dataRetriever;
+        locker.unlock();
+
+        if (isExiting())
+        {
+            // the shutdown may have occurred before the retriever was set
+            dataRetriever.abort();
+        }
+
+        device.reset(
+            m_owner->buildDevice(
+                m_location, m_cacheControlMaxAge, m_udn, m_configId,
+                m_refresh, &dataRetriever, &m_cachedDescription, &err,
+                m_requestId));
+
+        locker.relock();
+        m_retriever = 0;
+    }
+
     // the returned device is a fully built root device containing every
     // embedded device and service advertised in the device and service descriptions
     // otherwise, the creation failed
@@ -85,7 +132,7 @@ void DeviceBuildTask::run()
  * DeviceBuildTasks
  ******************************************************************************/
 DeviceBuildTasks::DeviceBuildTasks() :
-    m_builds()
+    m_builds(), m_locations()
 {
 }
 
@@ -96,45 +143,60 @@ DeviceBuildTasks::~DeviceBuildTasks()
 
 DeviceBuildTask* DeviceBuildTasks::get(const HUdn& udn) const
 {
-    QList<DeviceBuildTask*>::const_iterator ci = m_builds.constBegin();
+    return m_builds.value(udn);
+}
+
+bool DeviceBuildTasks::addLocation(
+    DeviceBuildTask* build, const QUrl& location)
+{
+    Q_ASSERT(build);
+    Q_ASSERT(m_builds.value(build->udn()) == build);
 
-    for(; ci != m_builds.constEnd(); ++ci)
+    if (build->m_locations.contains(location))
     {
-        if ((*ci)->udn() == udn)
-        {
-            return *ci;
-        }
+        return false;
     }
 
-    return 0;
+    build->m_locations.append(location);
+    m_locations.insert(location.toString(), build);
+
+    return true;
 }
 
 void DeviceBuildTasks::remove(const HUdn& udn)
 {
-    QList<DeviceBuildTask*>::iterator i = m_builds.begin();
+    DeviceBuildTask* build = m_builds.take(udn);
+    Q_ASSERT(build);
 
-    for(; i != m_builds.end(); ++i)
+    foreach(const QUrl& location, build->m_locations)
     {
-        if ((*i)->udn() == udn)
+        QHash<QString, DeviceBuildTask*>::iterator it =
+            m_locations.find(location.toString());
+
+        if (it != m_locations.end() && it.value() == build)
         {
-            delete (*i);
-            m_builds.erase(i);
-            return;
+            m_locations.erase(it);
         }
     }
 
-    Q_ASSERT(false);
+    delete build;
 }
 
 void DeviceBuildTasks::add(DeviceBuildTask* arg)
 {
     Q_ASSERT(arg);
-    m_builds.push_back(arg);
+    Q_ASSERT(!m_builds.contains(arg->udn()));
+
+    m_builds.insert(arg->udn(), arg);
+    foreach(const QUrl& location, arg->m_locations)
+    {
+        m_locations.insert(location.toString(), arg);
+    }
 }
 
 QList<DeviceBuildTask*> DeviceBuildTasks::values() const
 {
-    return m_builds;
+    return m_builds.values();
 }
 
 }
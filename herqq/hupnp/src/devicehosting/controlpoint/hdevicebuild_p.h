@@ -30,11 +30,16 @@
 // change or the file may be removed without of notice.
 //
 
+#include "../../general/htrace_p.h"
 #include "../../general/hupnp_defs.h"
 #include "../../dataelements/hudn.h"
 #include "../../utils/hthreadpool_p.h"
 
+#include <QtCore/QHash>
 #include <QtCore/QList>
+#include <QtCore/QUrl>
+#include <QtCore/QMutex>
+#include <QtCore/QElapsedTimer>
 
 namespace Herqq
 {
@@ -42,6 +47,7 @@ namespace Herqq
 namespace Upnp
 {
 
+class HDataRetriever;
 class HServiceSubscribtion;
 class HControlPointPrivate;
 class HDefaultClientDevice;
@@ -69,22 +75,67 @@ private:
     QScopedPointer<HDefaultClientDevice> m_createdDevice;
 
     const HUdn m_udn;
+    const QUrl m_location;
+    // the location the build uses. the locations learned while the build
+    // runs are appended to m_locations by the thread of the control point,
+    // which is why the build never reads that list
     const qint32 m_cacheControlMaxAge;
+    const qint32 m_configId;
+
+    const bool m_refresh;
+    // whether the build replaces the model of a known device whose
+    // configuration has changed. such a build retrieves every service
+    // description, so that the changed services can be told apart
+
+    QByteArray m_cachedDescription;
+    // the device description, if the device was built from the
+    // description cache
+
+    QMutex m_retrieverMutex;
+    HDataRetriever* m_retriever;
+    // the retriever used by the ongoing build. cancel() aborts it from the
+    // thread that shuts down the thread pool
+
+    const quint32 m_requestId;
+    const qint64 m_queuedAt;
+    // the request id of the build in the structured tracing and the time
+    // the build was queued, or -1 when the build is not traced
+
+    QElapsedTimer m_timer;
+    // started when the build is queued. used for the build latency reported
+    // by the runtime status of the control point
+
+protected:
+
+    virtual void cancel();
 
 public:
 
     QList<QUrl> m_locations;
 
     template<typename Msg>
-    DeviceBuildTask(HControlPointPrivate* owner, const Msg& msg) :
+    DeviceBuildTask(
+        HControlPointPrivate* owner, const Msg& msg, bool refresh = false) :
             m_owner(owner),
             m_completionValue(-1),
             m_errorString(),
             m_createdDevice(0),
             m_udn(msg.usn().udn()),
+            m_location(msg.location()),
             m_cacheControlMaxAge(msg.cacheControlMaxAge()),
+            m_configId(msg.configId()),
+            m_refresh(refresh),
+            m_cachedDescription(),
+            m_retrieverMutex(),
+            m_retriever(0),
+            m_requestId(HTraceRecorder::isEnabled() ?
+                HTraceRecorder::newRequestId() : 0),
+            m_queuedAt(HTraceRecorder::isEnabled() ?
+                HTraceRecorder::now() : -1),
+            m_timer(),
             m_locations()
     {
+        m_timer.start();
         m_locations.append(msg.location());
     }
 
@@ -94,6 +145,15 @@ public:
     virtual void run();
 
     inline HUdn udn() const { return m_udn; }
+    inline qint32 configId() const { return m_configId; }
+    inline bool isRefresh() const { return m_refresh; }
+
+    inline qint64 elapsed() const { return m_timer.elapsed(); }
+    // returns the number of milliseconds since the build was queued
+
+    inline QByteArray cachedDescription() const { return m_cachedDescription; }
+    // returns the device description only if the device was built from the
+    // description cache
 
     inline qint32 completionValue() const {
 #if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
@@ -125,47 +185,44 @@ H_DISABLE_COPY(DeviceBuildTasks)
 
 private:
 
-    QList<DeviceBuildTask*> m_builds;
+    QHash<HUdn, DeviceBuildTask*> m_builds;
+
+    QHash<QString, DeviceBuildTask*> m_locations;
+    // the builds indexed by every location they have learned. root and
+    // embedded devices do not share a UDN, but they share the location of
+    // the device description
 
 public:
 
+    enum
+    {
+        MaxBuilds = 256
+        // the maximum number of device builds that are queued or run at the
+        // same time
+    };
+
     DeviceBuildTasks();
     ~DeviceBuildTasks();
 
     template<typename Msg>
     DeviceBuildTask* get(const Msg& msg) const
     {
-        QList<DeviceBuildTask*>::const_iterator ci = m_builds.constBegin();
-
-        for(; ci != m_builds.constEnd(); ++ci)
+        DeviceBuildTask* retVal = m_builds.value(msg.usn().udn());
+        if (!retVal)
         {
-            if ((*ci)->udn() == msg.usn().udn())
-            {
-                // UDN match, we are definitely already building the device
-                // the message advertises
-                return *ci;
-            }
-
-            QList<QUrl>::const_iterator ci2 = (*ci)->m_locations.constBegin();
-
-            for(; ci2 != (*ci)->m_locations.constEnd(); ++ci2)
-            {
-                if (*ci2 == msg.location())
-                {
-                    // exact "location" (the URL to device description) match.
-                    // This means that we are already
-                    // building the device tree, but the build started from
-                    // a different advertisement message advertising another
-                    // device in the tree (root & embedded devices do not share
-                    // a common UDN).
-                    return *ci;
-                }
-            }
+            // an exact "location" (the URL to device description) match
+            // means that the device tree is already being built, but the
+            // build started from a message advertising another device in
+            // the tree
+            retVal = m_locations.value(msg.location().toString());
         }
-
-        return 0;
+        return retVal;
     }
 
+    // adds the location to the locations of the build, unless the build
+    // already knows it. returns true if the location was added
+    bool addLocation(DeviceBuildTask* build, const QUrl& location);
+
     // ownership is not transferred
     DeviceBuildTask* get(const HUdn& udn) const;
 
@@ -177,6 +234,12 @@ public:
 
     // ownership is not transferred
     QList<DeviceBuildTask*> values() const;
+
+    inline qint32 size() const { return m_builds.size(); }
+
+    inline bool isFull() const { return m_builds.size() >= MaxBuilds; }
+    // returns true when no new build should be started before the ongoing
+    // builds complete
 };
 
 }
@@ -0,0 +1,158 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "hdiscovery_scheduler_p.h"
+#include "hcontrolpoint_p.h"
+
+#include "../../general/hlogger_p.h"
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace
+{
+// the cost of a single packet in the units of the budget
+const qint64 PacketCost = 1000;
+}
+
+/*******************************************************************************
+ * HDiscoveryScheduler
+ ******************************************************************************/
+HDiscoveryScheduler::HDiscoveryScheduler(
+    HControlPointPrivate* owner, qint32 packetsPerSecond) :
+        QObject(owner),
+            m_owner(owner), m_packetsPerSecond(packetsPerSecond),
+            m_credit(0), m_clock(), m_lastRefill(0), m_due(-1),
+            m_burstLeft(0), m_interval(MinInterval), m_timer()
+{
+    Q_ASSERT(owner);
+    Q_ASSERT(packetsPerSecond >= 0);
+
+    m_clock.start();
+    m_timer.setSingleShot(true);
+
+    bool ok = connect(&m_timer, SIGNAL(timeout()), this, SLOT(timeout()));
+    Q_ASSERT(ok); Q_UNUSED(ok)
+}
+
+HDiscoveryScheduler::~HDiscoveryScheduler()
+{
+}
+
+qint64 HDiscoveryScheduler::maxCredit() const
+{
+    // at most a second worth of the budget, but always enough for a search
+    // on every network address in use
+    return qMax(m_packetsPerSecond, m_owner->m_ssdps.size()) * PacketCost;
+}
+
+void HDiscoveryScheduler::refill()
+{
+    qint64 now = m_clock.elapsed();
+    if (m_packetsPerSecond > 0)
+    {
+        // a packet per second is a thousandth of a packet per millisecond
+        m_credit = qMin(
+            m_credit + (now - m_lastRefill) * m_packetsPerSecond, maxCredit());
+    }
+    m_lastRefill = now;
+}
+
+void HDiscoveryScheduler::scheduleIn(qint64 msecs)
+{
+    m_due = m_clock.elapsed() + msecs;
+    m_timer.start(static_cast<int>(msecs));
+}
+
+void HDiscoveryScheduler::timeout()
+{
+    HLOG(H_AT, H_FUN);
+
+    m_due = -1;
+
+    qint64 cost = m_owner->m_ssdps.size() * PacketCost;
+    if (m_packetsPerSecond > 0)
+    {
+        refill();
+        if (m_credit < cost)
+        {
+            // the search is delayed until the budget allows it
+            scheduleIn((cost - m_credit) / m_packetsPerSecond + 1);
+            return;
+        }
+        m_credit -= cost;
+    }
+
+    m_owner->sendDiscoveryRequests();
+
+    if (m_burstLeft > 0 && --m_burstLeft > 0)
+    {
+        scheduleIn(BurstInterval);
+    }
+    else
+    {
+        scheduleIn(m_interval);
+        m_interval = qMin(m_interval * 2, static_cast<qint32>(MaxInterval));
+    }
+}
+
+void HDiscoveryScheduler::start()
+{
+    refill();
+    if (m_credit >= 0)
+    {
+        // the burst starts with a full budget, unless more than the budget
+        // was just sent through HControlPoint::scan()
+        m_credit = maxCredit();
+    }
+
+    m_burstLeft = BurstSize;
+    m_interval = MinInterval;
+    scheduleIn(0);
+}
+
+void HDiscoveryScheduler::churn()
+{
+    m_interval = MinInterval;
+    if (m_due >= 0 && m_due - m_clock.elapsed() > MinInterval)
+    {
+        HLOG(H_AT, H_FUN);
+        HLOG_DBG("Device population changed, searching sooner");
+
+        scheduleIn(MinInterval);
+    }
+}
+
+void HDiscoveryScheduler::charge(qint32 packets)
+{
+    if (m_packetsPerSecond > 0 && packets > 0)
+    {
+        refill();
+        m_credit -= packets * PacketCost;
+    }
+}
+
+}
+}
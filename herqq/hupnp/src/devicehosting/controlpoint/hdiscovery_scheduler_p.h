@@ -0,0 +1,136 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef HDISCOVERY_SCHEDULER_P_H_
+#define HDISCOVERY_SCHEDULER_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include "../../general/hupnp_defs.h"
+
+#include <QtCore/QTimer>
+#include <QtCore/QObject>
+#include <QtCore/QElapsedTimer>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+class HControlPointPrivate;
+
+//
+// Internal class that decides when a control point searches for devices on
+// its own.
+//
+// A discovery starts with a burst of BurstSize searches BurstInterval apart.
+// After that the interval between the searches doubles from MinInterval up to
+// MaxInterval for as long as the device population stays stable. A device
+// that says byebye, expires or appears makes the population look unstable
+// and the interval drops back to MinInterval.
+//
+// Every M-SEARCH sent, including the ones requested through
+// HControlPoint::scan(), is charged against a budget that is refilled at
+// the configured number of packets per second. A search that does not fit
+// the budget is delayed until it does.
+//
+class HDiscoveryScheduler :
+    public QObject
+{
+Q_OBJECT
+H_DISABLE_COPY(HDiscoveryScheduler)
+
+public:
+
+    enum
+    {
+        BurstSize = 3,
+
+        BurstInterval = 1000,
+        // in milliseconds
+
+        MinInterval = 10000,
+        // in milliseconds
+
+        MaxInterval = 900000
+        // in milliseconds
+    };
+
+private:
+
+    HControlPointPrivate* m_owner;
+
+    const qint32 m_packetsPerSecond;
+    // zero if the rate is not limited
+
+    qint64 m_credit;
+    // the budget in thousandths of a packet, which is negative when more
+    // has been sent than the rate allows
+
+    QElapsedTimer m_clock;
+    qint64 m_lastRefill;
+    // the time of the last refill of the budget in m_clock milliseconds
+
+    qint64 m_due;
+    // the time of the next search in m_clock milliseconds, -1 if none is
+    // scheduled
+
+    qint32 m_burstLeft;
+    qint32 m_interval;
+    // the interval used after the next search, once the burst is over
+
+    QTimer m_timer;
+
+    qint64 maxCredit() const;
+    void refill();
+    void scheduleIn(qint64 msecs);
+
+private Q_SLOTS:
+
+    void timeout();
+
+public:
+
+    HDiscoveryScheduler(HControlPointPrivate* owner, qint32 packetsPerSecond);
+    virtual ~HDiscoveryScheduler();
+
+    // starts over with a burst of searches
+    void start();
+
+    // tells that the device population has changed
+    void churn();
+
+    // charges packets sent outside the scheduler against the budget
+    void charge(qint32 packets);
+};
+
+}
+}
+
+#endif /* HDISCOVERY_SCHEDULER_P_H_ */
@@ -20,6 +20,7 @@
  */
 
 #include "hevent_subscription_p.h"
+#include "hevent_subscriptionscheduler_p.h"
 
 #include "../../devicemodel/client/hclientdevice.h"
 #include "../../devicemodel/client/hdefault_clientservice_p.h"
@@ -27,9 +28,15 @@
 #include "../../dataelements/hserviceinfo.h"
 
 #include "../../http/hhttp_messagecreator_p.h"
+#include "../../http/hhttp_connectionpool_p.h"
+
+#include "../../utils/htimerwheel_p.h"
 
 #include "../../general/hlogger_p.h"
 #include "../../general/hupnp_global_p.h"
+#include "../../general/hmemoryaccount_p.h"
+
+#include <QtCore/QTimerEvent>
 
 namespace Herqq
 {
@@ -37,12 +44,25 @@ namespace Herqq
 namespace Upnp
 {
 
+namespace
+{
+// the number of notifications that may be received ahead of the expected
+// one before the service is re-subscribed
+const qint32 ReorderWindow = 8;
+
+// the time the missing notification is waited for before the service is
+// re-subscribed
+const qint32 ReorderTimeoutInMsecs = 5000;
+}
+
 /*******************************************************************************
  * HEventSubscription definition
  ******************************************************************************/
 HEventSubscription::HEventSubscription(
     const QByteArray& loggingIdentifier, HClientService* service,
-    const QUrl& serverRootUrl, const HTimeout& desiredTimeout, QObject* parent) :
+    const QUrl& serverRootUrl, const HTimeout& desiredTimeout,
+    HHttpConnectionPool* connectionPool, HTimerWheel* renewalWheel,
+    HEventSubscriptionScheduler* scheduler, QObject* parent) :
         QObject(parent),
             m_loggingIdentifier(loggingIdentifier),
             m_randomIdentifier (QUuid::createUuid()),
@@ -54,13 +74,16 @@ HEventSubscription::HEventSubscription(
             m_seq(0),
             m_desiredTimeout(desiredTimeout),
             m_timeout(),
-            m_subscriptionTimer(this),
-            m_announcementTimer(this),
-            m_announcementTimedOut(false),
+            m_renewalWheel(renewalWheel),
+            m_scheduler(scheduler),
+            m_admitted(false),
             m_service(service),
             m_serverRootUrl(serverRootUrl),
             m_http(loggingIdentifier, this),
-            m_socket(this),
+            m_connectionPool(connectionPool),
+            m_socket(0),
+            m_socketEndpoint(),
+            m_socketReused(false),
             m_currentOpType(Op_None),
             m_nextOpType(Op_None),
             m_subscribed(false)
@@ -68,6 +91,9 @@ HEventSubscription::HEventSubscription(
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
     Q_ASSERT(m_service);
+    Q_ASSERT(m_connectionPool);
+    Q_ASSERT(m_renewalWheel);
+    Q_ASSERT(m_scheduler);
     Q_ASSERT(!m_serverRootUrl.isEmpty());
     Q_ASSERT_X(m_serverRootUrl.isValid(), H_AT,
              m_serverRootUrl.toString().toLocal8Bit());
@@ -83,39 +109,31 @@ HEventSubscription::HEventSubscription(
     }
 
     bool ok = connect(
-        &m_subscriptionTimer, SIGNAL(timeout()),
-        this, SLOT(subscriptionTimeout()));
-
-    Q_ASSERT(ok); Q_UNUSED(ok)
-
-    ok = connect(
-        &m_announcementTimer, SIGNAL(timeout()),
-        this, SLOT(announcementTimeout()));
-
-    Q_ASSERT(ok);
-
-    ok = connect(&m_socket, SIGNAL(connected()), this, SLOT(connected()));
-
-    Q_ASSERT(ok);
-
-    ok = connect(
         &m_http, SIGNAL(msgIoComplete(HHttpAsyncOperation*)),
         this, SLOT(msgIoComplete(HHttpAsyncOperation*)),
         Qt::DirectConnection);
 
-    Q_ASSERT(ok);
+    Q_ASSERT(ok); Q_UNUSED(ok)
+
+    HMemoryAccount::get(HMemoryAccount::ClientSubscriptions)->add(
+        sizeof(HEventSubscription) + m_loggingIdentifier.size());
 }
 
 HEventSubscription::~HEventSubscription()
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+    m_renewalWheel->unschedule(this);
+    m_scheduler->release(this);
+
+    HMemoryAccount::get(HMemoryAccount::ClientSubscriptions)->remove(
+        sizeof(HEventSubscription) + m_loggingIdentifier.size());
 }
 
 void HEventSubscription::subscriptionTimeout()
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
-    m_subscriptionTimer.stop();
+    m_renewalWheel->unschedule(this);
 
     if (m_sid.isEmpty())
     {
@@ -124,13 +142,82 @@ void HEventSubscription::subscriptionTimeout()
     else
     {
         renewSubscription();
+        emit renewalDue(this);
+    }
+}
+
+void HEventSubscription::admitted()
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    if (!m_scheduler->isAdmitted(this))
+    {
+        // the subscription was reset after it was admitted
+        return;
+    }
+
+    if (m_currentOpType != Op_Subscribe && m_currentOpType != Op_Renew)
+    {
+        m_scheduler->release(this);
+        return;
+    }
+
+    m_admitted = true;
+    runNextOp();
+}
+
+bool HEventSubscription::admit()
+{
+    if (!m_admitted)
+    {
+        m_admitted = m_scheduler->admit(
+            this, HEndpoint(m_deviceLocations[m_nextLocationToTry]));
     }
+
+    return m_admitted;
+}
+
+void HEventSubscription::releaseAdmission()
+{
+    m_admitted = false;
+    m_scheduler->release(this);
 }
 
-void HEventSubscription::announcementTimeout()
+bool HEventSubscription::renewEarly()
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
-    m_announcementTimedOut = true;
+
+    if (m_currentOpType != Op_None || m_sid.isEmpty() || m_timeout.isInfinite())
+    {
+        return false;
+    }
+
+    qint64 remaining = m_renewalWheel->remainingTime(this);
+    if (remaining < 0 || remaining > m_timeout.value() * 1000 / 2 / 4)
+    {
+        return false;
+    }
+
+    m_renewalWheel->unschedule(this);
+    renewSubscription();
+
+    return true;
+}
+
+void HEventSubscription::scheduleRenewal()
+{
+    if (m_timeout.isInfinite())
+    {
+        return;
+    }
+
+    // the subscription is renewed when half of the timeout has elapsed.
+    // the renewals of the subscriptions made at the same time, such as
+    // those made right after a device was discovered, are spread over the
+    // last tenth of that time
+    qint32 renewalInMsecs = m_timeout.value() * 1000 / 2;
+    m_renewalWheel->schedule(
+        this, "subscriptionTimeout", renewalInMsecs, renewalInMsecs / 10);
 }
 
 void HEventSubscription::resetSubscription()
@@ -145,12 +232,11 @@ void HEventSubscription::resetSubscription()
     m_currentOpType = Op_None;
     m_subscribed = false;
     m_connectErrorCount = 0;
-    m_subscriptionTimer.stop();
+    m_renewalWheel->unschedule(this);
+    clearReorderBuffer();
 
-    if (m_socket.state() == QAbstractSocket::ConnectedState)
-    {
-        m_socket.disconnectFromHost();
-    }
+    releaseSocket(false);
+    releaseAdmission();
 }
 
 void HEventSubscription::runNextOp()
@@ -184,7 +270,7 @@ void HEventSubscription::connected()
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
     bool ok = disconnect(
-        &m_socket, SIGNAL(error(QAbstractSocket::SocketError)),
+        m_socket, SIGNAL(error(QAbstractSocket::SocketError)),
         this, SLOT(error(QAbstractSocket::SocketError)));
 
     Q_ASSERT(ok); Q_UNUSED(ok)
@@ -199,6 +285,23 @@ void HEventSubscription::msgIoComplete(HHttpAsyncOperation* op)
 
     Q_ASSERT(op);
 
+    if (op->state() == HHttpAsyncOperation::Failed && m_socketReused)
+    {
+        // the device may have closed the idle connection just before the
+        // request was sent. the operation is retried once using a new
+        // connection
+        HLOG_DBG("Request over a reused connection failed. Retrying.");
+
+        delete op;
+        releaseSocket(false);
+        runNextOp();
+        return;
+    }
+
+    bool keepAlive =
+        op->state() != HHttpAsyncOperation::Failed &&
+        op->messagingInfo()->keepAlive();
+
     switch(m_currentOpType)
     {
     case Op_Subscribe:
@@ -218,13 +321,11 @@ void HEventSubscription::msgIoComplete(HHttpAsyncOperation* op)
         break;
     };
 
-    if (m_socket.state() == QTcpSocket::ConnectedState)
-    {
-        m_socket.disconnectFromHost();
-    }
-
     delete op;
 
+    releaseSocket(keepAlive);
+    releaseAdmission();
+
     if (m_currentOpType == Op_Subscribe || m_currentOpType == Op_Renew)
     {
         foreach(const HNotifyRequest& req, m_queuedNotifications)
@@ -297,10 +398,7 @@ void HEventSubscription::renewSubscription_done(HHttpAsyncOperation* op)
         m_eventUrl.toString(), m_sid.toString()));
 
     m_timeout = response.timeout();
-    if (!m_timeout.isInfinite())
-    {
-        m_subscriptionTimer.start(m_timeout.value() * 1000 / 2);
-    }
+    scheduleRenewal();
 }
 
 void HEventSubscription::renewSubscription()
@@ -312,10 +410,14 @@ void HEventSubscription::renewSubscription()
         return;
     }
 
-    m_announcementTimer.stop();
-
     m_currentOpType = Op_Renew;
 
+    if (!admit())
+    {
+        // the renewal is sent once the scheduler admits it
+        return;
+    }
+
     if (!connectToDevice())
     {
         return;
@@ -328,7 +430,7 @@ void HEventSubscription::renewSubscription()
         extractBaseUrl(m_deviceLocations[m_nextLocationToTry]),
         m_service->info().eventSubUrl());
 
-    HMessagingInfo* mi = new HMessagingInfo(m_socket, false);
+    HMessagingInfo* mi = new HMessagingInfo(*m_socket, true);
     mi->setHostInfo(eventUrl);
 
     HSubscribeRequest req(eventUrl, m_sid, m_desiredTimeout);
@@ -364,6 +466,20 @@ void HEventSubscription::error(QAbstractSocket::SocketError /*err*/)
 
     if (++m_connectErrorCount >= m_deviceLocations.size() * 2)
     {
+        HLOG_WARN(QString("Could not connect to the device @ [%1]").arg(
+            urlsAsStr(m_deviceLocations)));
+
+        releaseSocket(false);
+
+        if (m_currentOpType == Op_Unsubscribe)
+        {
+            resetSubscription();
+            emit unsubscribed(this);
+        }
+        else
+        {
+            emit subscriptionFailed(this);
+        }
         return;
     }
 
@@ -385,31 +501,74 @@ bool HEventSubscription::connectToDevice(qint32 msecsToWait)
 
     Q_ASSERT(m_currentOpType != Op_None);
 
-    if (m_socket.state() == QTcpSocket::ConnectedState)
+    if (m_socket)
     {
-        return true;
+        if (m_socket->state() == QTcpSocket::ConnectedState)
+        {
+            return true;
+        }
+        else if (m_socket->state() == QTcpSocket::ConnectingState ||
+                 m_socket->state() == QTcpSocket::HostLookupState)
+        {
+            return false;
+        }
+
+        releaseSocket(false);
     }
-    else if (m_socket.state() == QTcpSocket::ConnectingState ||
-             m_socket.state() == QTcpSocket::HostLookupState)
+
+    QUrl lastLoc = m_deviceLocations[m_nextLocationToTry];
+
+    m_socketEndpoint = HEndpoint(lastLoc);
+    m_socket = m_connectionPool->acquire(m_socketEndpoint, &m_socketReused);
+    m_socket->setParent(this);
+
+    if (m_socketReused)
     {
-        return false;
+        return true;
     }
 
-    QUrl lastLoc = m_deviceLocations[m_nextLocationToTry];
+    bool ok = connect(m_socket, SIGNAL(connected()), this, SLOT(connected()));
+    Q_ASSERT(ok); Q_UNUSED(ok)
 
-    bool ok = connect(
-        &m_socket, SIGNAL(error(QAbstractSocket::SocketError)),
+    ok = connect(
+        m_socket, SIGNAL(error(QAbstractSocket::SocketError)),
         this, SLOT(error(QAbstractSocket::SocketError)));
 
-    Q_ASSERT(ok); Q_UNUSED(ok)
+    Q_ASSERT(ok);
 
-    m_socket.connectToHost(lastLoc.host(), lastLoc.port());
+    m_socket->connectToHost(lastLoc.host(), lastLoc.port());
     if (msecsToWait > 0)
     {
-        m_socket.waitForConnected(msecsToWait);
+        m_socket->waitForConnected(msecsToWait);
+    }
+
+    return m_socket->state() == QAbstractSocket::ConnectedState;
+}
+
+void HEventSubscription::releaseSocket(bool keepAlive)
+{
+    if (!m_socket)
+    {
+        return;
+    }
+
+    m_socket->disconnect(this);
+
+    if (keepAlive)
+    {
+        m_connectionPool->release(m_socketEndpoint, m_socket);
+    }
+    else
+    {
+        if (m_socket->state() == QTcpSocket::ConnectedState)
+        {
+            m_socket->disconnectFromHost();
+        }
+        m_socket->deleteLater();
     }
 
-    return m_socket.state() == QAbstractSocket::ConnectedState;
+    m_socket = 0;
+    m_socketReused = false;
 }
 
 void HEventSubscription::subscribe_done(HHttpAsyncOperation* op)
@@ -449,10 +608,7 @@ void HEventSubscription::subscribe_done(HHttpAsyncOperation* op)
     HLOG_DBG(QString("Subscription to [%1] succeeded. Received SID: [%2]").arg(
         m_eventUrl.toString(), m_sid.toString()));
 
-    if (!m_timeout.isInfinite())
-    {
-        m_subscriptionTimer.start(m_timeout.value() * 1000 / 2);
-    }
+    scheduleRenewal();
 
     emit subscribed(this);
 }
@@ -490,6 +646,12 @@ void HEventSubscription::subscribe()
         return;
     }
 
+    if (!admit())
+    {
+        // the subscription is sent once the scheduler admits it
+        return;
+    }
+
     if (!connectToDevice())
     {
         return;
@@ -499,7 +661,7 @@ void HEventSubscription::subscribe()
         extractBaseUrl(m_deviceLocations[m_nextLocationToTry]),
         m_service->info().eventSubUrl());
 
-    HMessagingInfo* mi = new HMessagingInfo(m_socket, false);
+    HMessagingInfo* mi = new HMessagingInfo(*m_socket, true);
     mi->setHostInfo(m_eventUrl);
 
     HSubscribeRequest req(
@@ -518,12 +680,57 @@ void HEventSubscription::subscribe()
     {
         HLOG_WARN(QString(
             "Failed to subscribe to events @ [%1]: %2").arg(
-                urlsAsStr(m_deviceLocations), m_socket.errorString()));
+                urlsAsStr(m_deviceLocations), m_socket->errorString()));
 
         emit subscriptionFailed(this);
     }
 }
 
+StatusCode HEventSubscription::applyNotify(const HNotifyRequest& req)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    HDefaultClientService* srv = static_cast<HDefaultClientService*>(m_service);
+    // TODO, this should not be necessary, or it should be done elsewhere.
+
+    if (srv->updateVariables(req.variables(), m_seq > 0))
+    {
+        HLOG_DBG(QString(
+            "Notify [sid: %1, seq: %2] OK. State variable(s) were updated.").arg(
+                m_sid.toString(), QString::number(m_seq)));
+
+        ++m_seq;
+        return Ok;
+    }
+
+    HLOG_WARN(QString("Notify failed. State variable(s) were not updated."));
+    return InternalServerError;
+}
+
+void HEventSubscription::clearReorderBuffer()
+{
+    m_reorderBuffer.clear();
+    m_reorderTimer.stop();
+}
+
+void HEventSubscription::timerEvent(QTimerEvent* event)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    if (event->timerId() != m_reorderTimer.timerId())
+    {
+        QObject::timerEvent(event);
+        return;
+    }
+
+    HLOG_WARN(QString(
+        "Notification [sid: %1, seq: %2] was not received in time. "
+        "Re-subscribing...").arg(m_sid.toString(), QString::number(m_seq)));
+
+    clearReorderBuffer();
+    resubscribe();
+}
+
 StatusCode HEventSubscription::processNotify(const HNotifyRequest& req)
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
@@ -537,7 +744,33 @@ StatusCode HEventSubscription::processNotify(const HNotifyRequest& req)
     }
 
     qint32 seq = req.seq();
-    if (seq != m_seq)
+    if (seq < m_seq && m_seq - seq <= ReorderWindow)
+    {
+        // a notification that has already been processed
+        HLOG_DBG(QString("Ignoring a duplicate notification [seq: %1]").arg(
+            QString::number(seq)));
+
+        return Ok;
+    }
+    else if (seq > m_seq && seq - m_seq <= ReorderWindow && m_seq > 0)
+    {
+        // the notifications are often delivered over several connections and
+        // may arrive out of order. the notification is applied once those
+        // preceding it have arrived. the initial notification carries the
+        // full state and it is never waited for
+        HLOG_DBG(QString(
+            "Buffering notification [seq: %1] received ahead of [%2]").arg(
+                QString::number(seq), QString::number(m_seq)));
+
+        m_reorderBuffer.insert(seq, req);
+        if (!m_reorderTimer.isActive())
+        {
+            m_reorderTimer.start(ReorderTimeoutInMsecs, this);
+        }
+
+        return Ok;
+    }
+    else if (seq != m_seq)
     {
         HLOG_WARN(QString(
             "Received sequence number is not expected. Expected [%1], got [%2]. "
@@ -547,25 +780,38 @@ StatusCode HEventSubscription::processNotify(const HNotifyRequest& req)
         // in this case the received sequence number does not match to what is
         // expected. UDA instructs to re-subscribe in this scenario.
 
+        clearReorderBuffer();
         resubscribe();
         return PreconditionFailed;
     }
 
-    HDefaultClientService* srv = static_cast<HDefaultClientService*>(m_service);
-    // TODO, this should not be necessary, or it should be done elsewhere.
+    StatusCode retVal = applyNotify(req);
 
-    if (srv->updateVariables(req.variables(), m_seq > 0))
+    while(retVal == Ok && !m_reorderBuffer.isEmpty())
     {
-        HLOG_DBG(QString(
-            "Notify [sid: %1, seq: %2] OK. State variable(s) were updated.").arg(
-                m_sid.toString(), QString::number(m_seq)));
+        QMap<qint32, HNotifyRequest>::iterator it = m_reorderBuffer.begin();
+        if (it.key() != m_seq)
+        {
+            // the next gap has not closed yet
+            m_reorderTimer.start(ReorderTimeoutInMsecs, this);
+            return retVal;
+        }
 
-        ++m_seq;
-        return Ok;
+        HNotifyRequest next = it.value();
+        m_reorderBuffer.erase(it);
+
+        if (applyNotify(next) != Ok)
+        {
+            break;
+        }
     }
 
-    HLOG_WARN(QString("Notify failed. State variable(s) were not updated."));
-    return InternalServerError;
+    if (m_reorderBuffer.isEmpty())
+    {
+        m_reorderTimer.stop();
+    }
+
+    return retVal;
 }
 
 StatusCode HEventSubscription::onNotify(const HNotifyRequest& req)
@@ -634,7 +880,7 @@ void HEventSubscription::unsubscribe(qint32 msecsToWait)
     Q_ASSERT(m_sid.isValid());
     Q_ASSERT(!m_eventUrl.isEmpty());
 
-    m_subscriptionTimer.stop();
+    m_renewalWheel->unschedule(this);
 
     if (!connectToDevice(msecsToWait))
     {
@@ -649,7 +895,7 @@ void HEventSubscription::unsubscribe(qint32 msecsToWait)
         "Attempting to cancel event subscription from [%1]").arg(
             m_eventUrl.toString()));
 
-    HMessagingInfo* mi = new HMessagingInfo(m_socket, false);
+    HMessagingInfo* mi = new HMessagingInfo(*m_socket, true);
     mi->setHostInfo(m_eventUrl);
 
     HUnsubscribeRequest req(m_eventUrl, m_sid);
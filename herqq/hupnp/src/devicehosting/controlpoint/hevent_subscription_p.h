@@ -34,13 +34,16 @@
 #include "../messages/hevent_messages_p.h"
 #include "../../http/hhttp_asynchandler_p.h"
 
+#include <HUpnpCore/HEndpoint>
+
 #include "../../general/hupnp_defs.h"
 #include "../../general/hupnp_fwd.h"
 
 #include <QtCore/QUrl>
+#include <QtCore/QMap>
 #include <QtCore/QList>
-#include <QtCore/QTimer>
 #include <QtCore/QByteArray>
+#include <QtCore/QBasicTimer>
 
 #include <QtNetwork/QTcpSocket>
 
@@ -51,6 +54,9 @@ namespace Upnp
 {
 
 class HHttpAsyncOperation;
+class HTimerWheel;
+class HEventSubscriptionScheduler;
+class HHttpConnectionPool;
 
 //
 // This class represents and maintains a subscription to a service instantiated on the
@@ -97,11 +103,16 @@ private:
     // upon successful subscription. if no error occurs, the subscription will
     // be renewed before the specified timeout elapses.
 
-    QTimer m_subscriptionTimer;
-    // used to signal the time when the subscription should be renewed
+    HTimerWheel* m_renewalWheel;
+    // used to signal the time when the subscription should be renewed. the
+    // wheel is shared by all the subscriptions of the control point. not owned
+
+    HEventSubscriptionScheduler* m_scheduler;
+    // bounds the number of subscription requests in progress. not owned
 
-    QTimer m_announcementTimer;
-    bool m_announcementTimedOut;
+    bool m_admitted;
+    // true when the scheduler has admitted the current subscription or
+    // renewal request
 
     HClientService* m_service;
     // the target service of the subscription
@@ -122,8 +133,17 @@ private:
         Op_Unsubscribe
     };
 
-    QTcpSocket m_socket;
-    // socket for the messaging
+    HHttpConnectionPool* m_connectionPool;
+    // the pool the sockets are acquired from and released to. not owned
+
+    QTcpSocket* m_socket;
+    // socket for the messaging. this is null between operations
+
+    HEndpoint m_socketEndpoint;
+    // the endpoint m_socket is connected to
+
+    bool m_socketReused;
+    // true if m_socket was an idle connection from the pool
 
     OperationType m_currentOpType;
     OperationType m_nextOpType;
@@ -132,10 +152,18 @@ private:
 
     QList<HNotifyRequest> m_queuedNotifications;
 
+    QMap<qint32, HNotifyRequest> m_reorderBuffer;
+    // the notifications received ahead of the expected sequence number,
+    // keyed by their sequence numbers
+
+    QBasicTimer m_reorderTimer;
+    // bounds the time the notification with the expected sequence number
+    // is waited for, after which the service is re-subscribed
+
 private Q_SLOTS:
 
     void subscriptionTimeout();
-    void announcementTimeout();
+    void admitted();
 
     void connected();
     void msgIoComplete(HHttpAsyncOperation*);
@@ -145,19 +173,30 @@ private Q_SLOTS:
 private:
 
     bool connectToDevice(qint32 msecsToWait=0);
+    void releaseSocket(bool keepAlive);
     void subscribe_done(HHttpAsyncOperation*);
     void renewSubscription_done(HHttpAsyncOperation*);
     void unsubscribe_done(HHttpAsyncOperation*);
 
+    bool admit();
+    void releaseAdmission();
+    void scheduleRenewal();
     void runNextOp();
     void resubscribe();
     void renewSubscription();
     StatusCode processNotify(const HNotifyRequest&);
+    StatusCode applyNotify(const HNotifyRequest&);
+    void clearReorderBuffer();
+
+protected:
+
+    virtual void timerEvent(QTimerEvent*);
 
 Q_SIGNALS:
 
     void subscribed(HEventSubscription*);
     void subscriptionFailed(HEventSubscription*);
+    void renewalDue(HEventSubscription*);
     void unsubscribed(HEventSubscription*);
 
 public:
@@ -174,6 +213,9 @@ public:
         HClientService* service,
         const QUrl& serverRootUrl,
         const HTimeout& desiredTimeout,
+        HHttpConnectionPool* connectionPool,
+        HTimerWheel* renewalWheel,
+        HEventSubscriptionScheduler* scheduler,
         QObject* parent = 0);
 
     virtual ~HEventSubscription();
@@ -181,8 +223,20 @@ public:
     inline QUuid id() const { return m_randomIdentifier ; }
     inline HClientService* service() const { return m_service; }
 
+    inline QUrl serverRootUrl() const { return m_serverRootUrl; }
+
+    // sets the URL of the server the notifications are sent to. this
+    // takes effect in the next subscription, as the callback of an existing
+    // subscription cannot be changed
+    inline void setServerRootUrl(const QUrl& arg) { m_serverRootUrl = arg; }
+
     void subscribe();
     void unsubscribe(qint32 msecsToWait=0);
+
+    // renews the subscription right away, if the renewal is due within the
+    // last quarter of the renewal interval. this is used to renew the
+    // subscriptions to the same device together
+    bool renewEarly();
     void resetSubscription();
     StatusCode onNotify(const HNotifyRequest&);
 
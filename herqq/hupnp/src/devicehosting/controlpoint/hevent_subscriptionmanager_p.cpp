@@ -20,6 +20,7 @@
  */
 
 #include "hevent_subscriptionmanager_p.h"
+#include "hevent_subscriptionscheduler_p.h"
 #include "hcontrolpoint_configuration.h"
 #include "hcontrolpoint_p.h"
 
@@ -34,15 +35,48 @@
 
 #include "../../general/hlogger_p.h"
 
+#include "../../http/hhttp_header_p.h"
+#include "../../http/hhttp_connectionpool_p.h"
+#include "../../http/hhttp_messagecreator_p.h"
+
+#include "../../socket/hmulticast_socket.h"
+
+#include "../../utils/htimerwheel_p.h"
+
+#include <QtCore/QTimer>
+#include <QtCore/QEventLoop>
+
 namespace Herqq
 {
 
 namespace Upnp
 {
 
+namespace
+{
+// the granularity of the subscription renewals
+const qint32 RenewalTickInMsecs = 1000;
+
+// the number of subscription requests sent to a single host and overall at
+// the same time. the requests to a host are sent over the same persistent
+// connections
+const qint32 MaxActiveRequestsPerHost = 2;
+const qint32 MaxActiveRequests = 32;
+}
+
 HEventSubscriptionManager::HEventSubscriptionManager(HControlPointPrivate* owner) :
     QObject(owner),
-        m_owner(owner), m_subscribtionsByUuid(), m_subscriptionsByUdn()
+        m_owner(owner), m_subscribtionsByUuid(), m_subscriptionsByUdn(),
+        m_connectionPool(new HHttpConnectionPool(this)),
+        m_renewalWheel(
+            new HTimerWheel(RenewalTickInMsecs, this)),
+        m_scheduler(new HEventSubscriptionScheduler(
+            MaxActiveRequestsPerHost, MaxActiveRequests, this)),
+        m_pendingSubscriptions(),
+        m_startedSubscriptions(0), m_completedSubscriptions(0),
+        m_multicastSocket(0), m_multicastSeqs(),
+        m_failedSubscriptions(0), m_receivedEvents(0),
+        m_pendingCancellations(), m_cancellationLoop(0)
 {
     Q_ASSERT(m_owner);
 }
@@ -51,6 +85,13 @@ HEventSubscriptionManager::~HEventSubscriptionManager()
 {
     HLOG2(H_AT, H_FUN, m_owner->m_loggingIdentifier);
     removeAll();
+
+    const HHttpConnectionPool::Statistics& stats = m_connectionPool->statistics();
+    HLOG_DBG(QString(
+        "Event subscription connections: created [%1], reused [%2], "
+        "expired [%3], discarded [%4]").arg(
+            QString::number(stats.m_created), QString::number(stats.m_reused),
+            QString::number(stats.m_expired), QString::number(stats.m_discarded)));
 }
 
 void HEventSubscriptionManager::subscribed_slot(HEventSubscription* sub)
@@ -59,6 +100,7 @@ void HEventSubscriptionManager::subscribed_slot(HEventSubscription* sub)
     Q_ASSERT(sub);
 
     emit subscribed(sub->service());
+    subscriptionCompleted(sub);
 }
 
 void HEventSubscriptionManager::subscriptionFailed_slot(HEventSubscription* sub)
@@ -66,9 +108,74 @@ void HEventSubscriptionManager::subscriptionFailed_slot(HEventSubscription* sub)
     HLOG2(H_AT, H_FUN, m_owner->m_loggingIdentifier);
     Q_ASSERT(sub);
 
+    ++m_failedSubscriptions;
+
     HClientService* service = sub->service();
     sub->resetSubscription();
+    cancellationCompleted(sub);
     emit subscriptionFailed(service);
+    subscriptionCompleted(sub);
+}
+
+void HEventSubscriptionManager::renewalDue(HEventSubscription* sub)
+{
+    HLOG2(H_AT, H_FUN, m_owner->m_loggingIdentifier);
+    Q_ASSERT(sub);
+
+    // the renewals of the other subscriptions to the same device that are
+    // due soon are sent along with this one, so that they can be sent over
+    // the connection this one uses
+    QList<HEventSubscription*>* subs = m_subscriptionsByUdn.value(
+        sub->service()->parentDevice()->info().udn());
+
+    if (!subs)
+    {
+        return;
+    }
+
+    qint32 count = 0;
+    foreach(HEventSubscription* other, *subs)
+    {
+        if (other != sub && other->renewEarly())
+        {
+            ++count;
+        }
+    }
+
+    if (count)
+    {
+        HLOG_DBG(QString(
+            "Renewing [%1] other subscriptions to the same device early").arg(
+                QString::number(count)));
+    }
+}
+
+void HEventSubscriptionManager::subscriptionStarted(HEventSubscription* sub)
+{
+    if (!m_pendingSubscriptions.contains(sub))
+    {
+        m_pendingSubscriptions.insert(sub);
+        ++m_startedSubscriptions;
+    }
+}
+
+void HEventSubscriptionManager::subscriptionCompleted(HEventSubscription* sub)
+{
+    if (!m_pendingSubscriptions.remove(sub))
+    {
+        return;
+    }
+
+    qint32 completed = ++m_completedSubscriptions;
+    qint32 total = m_startedSubscriptions;
+
+    if (m_pendingSubscriptions.isEmpty())
+    {
+        m_startedSubscriptions = 0;
+        m_completedSubscriptions = 0;
+    }
+
+    emit subscriptionProgress(completed, total);
 }
 
 void HEventSubscriptionManager::unsubscribed(HEventSubscription* sub)
@@ -76,9 +183,19 @@ void HEventSubscriptionManager::unsubscribed(HEventSubscription* sub)
     HLOG2(H_AT, H_FUN, m_owner->m_loggingIdentifier);
     Q_ASSERT(sub);
 
+    cancellationCompleted(sub);
     emit unsubscribed(sub->service());
 }
 
+void HEventSubscriptionManager::cancellationCompleted(HEventSubscription* sub)
+{
+    if (m_pendingCancellations.remove(sub) &&
+        m_pendingCancellations.isEmpty() && m_cancellationLoop)
+    {
+        m_cancellationLoop->quit();
+    }
+}
+
 HEventSubscription* HEventSubscriptionManager::createSubscription(
     HClientService* service, qint32 timeout)
 {
@@ -98,6 +215,9 @@ HEventSubscription* HEventSubscriptionManager::createSubscription(
             service,
             httpSrvRootUrl,
             HTimeout(timeout),
+            m_connectionPool,
+            m_renewalWheel,
+            m_scheduler,
             this);
 
     bool ok = connect(
@@ -122,6 +242,12 @@ HEventSubscription* HEventSubscriptionManager::createSubscription(
 
     Q_ASSERT(ok);
 
+    ok = connect(
+        subscription, SIGNAL(renewalDue(HEventSubscription*)),
+        this, SLOT(renewalDue(HEventSubscription*)));
+
+    Q_ASSERT(ok);
+
     return subscription;
 }
 
@@ -234,6 +360,7 @@ HEventSubscriptionManager::SubscriptionResult
                 }
                 else
                 {
+                    subscriptionStarted(sub);
                     sub->subscribe();
                     return Sub_Success;
                 }
@@ -248,6 +375,7 @@ end:
     m_subscriptionsByUdn.insert(deviceUdn, subs);
     subs->append(sub);
 
+    subscriptionStarted(sub);
     sub->subscribe();
 
     return Sub_Success;
@@ -311,6 +439,8 @@ bool HEventSubscriptionManager::cancel(
         {
             (*it)->resetSubscription();
         }
+
+        subscriptionCompleted(*it);
     }
 
     if (visitType == VisitThisAndDirectChildren ||
@@ -350,6 +480,8 @@ bool HEventSubscriptionManager::remove(HClientDevice* device, bool recursive)
     {
         HEventSubscription* sub = (*it);
         m_subscribtionsByUuid.remove(sub->id());
+        subscriptionCompleted(sub);
+        cancellationCompleted(sub);
         delete sub;
     }
 
@@ -404,6 +536,7 @@ bool HEventSubscriptionManager::cancel(HClientService* service, bool unsubscribe
             (*it)->resetSubscription();
         }
 
+        subscriptionCompleted(*it);
         return true;
     }
 
@@ -445,6 +578,8 @@ bool HEventSubscriptionManager::remove(HClientService* service)
         }
 
         m_subscribtionsByUuid.remove(sub->id());
+        subscriptionCompleted(sub);
+        cancellationCompleted(sub);
         delete sub;
 
         return true;
@@ -453,18 +588,54 @@ bool HEventSubscriptionManager::remove(HClientService* service)
     return false;
 }
 
-void HEventSubscriptionManager::cancelAll(qint32 msecsToWait)
+qint32 HEventSubscriptionManager::cancelAll(qint32 msecsToWait)
 {
     HLOG2(H_AT, H_FUN, m_owner->m_loggingIdentifier);
     Q_ASSERT(thread() == QThread::currentThread());
+    Q_ASSERT(!m_cancellationLoop);
 
-    QHash<QUuid, HEventSubscription*>::iterator it =
-        m_subscribtionsByUuid.begin();
+    // None of the subscriptions waits for its connection, so that the
+    // connections are established and the requests are sent concurrently.
+    QList<HEventSubscription*> subs = m_subscribtionsByUuid.values();
+    foreach(HEventSubscription* sub, subs)
+    {
+        sub->unsubscribe(0);
+        if (sub->subscriptionStatus() !=
+                HEventSubscription::Status_Unsubscribed)
+        {
+            m_pendingCancellations.insert(sub);
+        }
+    }
 
-    for(; it != m_subscribtionsByUuid.end(); ++it)
+    if (!m_pendingCancellations.isEmpty() && msecsToWait > 0)
     {
-        (*it)->unsubscribe(msecsToWait);
+        QEventLoop loop;
+        m_cancellationLoop = &loop;
+
+        QTimer::singleShot(msecsToWait, &loop, SLOT(quit()));
+        loop.exec(QEventLoop::ExcludeUserInputEvents);
+
+        m_cancellationLoop = 0;
     }
+
+    qint32 retVal = m_pendingCancellations.size();
+    if (retVal > 0)
+    {
+        HLOG_WARN(QString(
+            "[%1] of [%2] event subscriptions could not be cancelled "
+            "within [%3] ms").arg(
+                QString::number(retVal), QString::number(subs.size()),
+                QString::number(msecsToWait)));
+
+        foreach(HEventSubscription* sub, m_pendingCancellations)
+        {
+            HLOG_DBG(QString("Subscription to [%1] was not cancelled").arg(
+                sub->service()->info().serviceId().toString()));
+        }
+    }
+
+    m_pendingCancellations.clear();
+    return retVal;
 }
 
 void HEventSubscriptionManager::removeAll()
@@ -472,6 +643,10 @@ void HEventSubscriptionManager::removeAll()
     HLOG2(H_AT, H_FUN, m_owner->m_loggingIdentifier);
     Q_ASSERT(thread() == QThread::currentThread());
 
+    m_pendingSubscriptions.clear();
+    m_startedSubscriptions = 0;
+    m_completedSubscriptions = 0;
+
     qDeleteAll(m_subscribtionsByUuid);
     m_subscribtionsByUuid.clear();
 
@@ -496,8 +671,225 @@ StatusCode HEventSubscriptionManager::onNotify(
         return BadRequest;
     }
 
+    ++m_receivedEvents;
     return sub->onNotify(req);
 }
 
+qint32 HEventSubscriptionManager::activeSubscriptionCount() const
+{
+    qint32 retVal = 0;
+    foreach(const HEventSubscription* sub, m_subscribtionsByUuid)
+    {
+        if (sub->subscriptionStatus() == HEventSubscription::Status_Subscribed)
+        {
+            ++retVal;
+        }
+    }
+    return retVal;
+}
+
+bool HEventSubscriptionManager::startMulticastEventing(
+    const QList<QHostAddress>& addresses)
+{
+    HLOG2(H_AT, H_FUN, m_owner->m_loggingIdentifier);
+
+    Q_ASSERT(!m_multicastSocket);
+
+    m_multicastSocket = new HMulticastSocket(this);
+
+    bool ok = connect(
+        m_multicastSocket, SIGNAL(readyRead()),
+        this, SLOT(multicastEventReceived()));
+
+    Q_ASSERT(ok); Q_UNUSED(ok)
+
+    HEndpoint group = HMulticastNotifyRequest::multicastEndpoint();
+    if (!m_multicastSocket->bind(group.portNumber()))
+    {
+        HLOG_WARN("Failed to bind the socket for multicast events");
+        delete m_multicastSocket;
+        m_multicastSocket = 0;
+        return false;
+    }
+
+    bool joined = false;
+    foreach(const QHostAddress& address, addresses)
+    {
+        if (m_multicastSocket->joinMulticastGroup(group.hostAddress(), address))
+        {
+            joined = true;
+        }
+        else
+        {
+            HLOG_WARN(QString("Could not join %1 using [%2]").arg(
+                group.hostAddress().toString(), address.toString()));
+        }
+    }
+
+    return joined;
+}
+
+bool HEventSubscriptionManager::addMulticastEventingAddress(
+    const QHostAddress& address)
+{
+    HLOG2(H_AT, H_FUN, m_owner->m_loggingIdentifier);
+
+    if (!m_multicastSocket)
+    {
+        return startMulticastEventing(QList<QHostAddress>() << address);
+    }
+
+    HEndpoint group = HMulticastNotifyRequest::multicastEndpoint();
+    if (!m_multicastSocket->joinMulticastGroup(group.hostAddress(), address))
+    {
+        HLOG_WARN(QString("Could not join %1 using [%2]").arg(
+            group.hostAddress().toString(), address.toString()));
+
+        return false;
+    }
+
+    return true;
+}
+
+qint32 HEventSubscriptionManager::serverAddressRemoved(
+    const QHostAddress& address)
+{
+    HLOG2(H_AT, H_FUN, m_owner->m_loggingIdentifier);
+    Q_ASSERT(thread() == QThread::currentThread());
+
+    if (m_multicastSocket)
+    {
+        HEndpoint group = HMulticastNotifyRequest::multicastEndpoint();
+        m_multicastSocket->leaveMulticastGroup(group.hostAddress(), address);
+    }
+
+    qint32 retVal = 0;
+    foreach(HEventSubscription* sub, m_subscribtionsByUuid)
+    {
+        if (QHostAddress(sub->serverRootUrl().host()) != address)
+        {
+            continue;
+        }
+
+        // the callback of a subscription cannot be changed, which is why the
+        // service is subscribed again with a callback on another address.
+        // the subscription made earlier expires on the device.
+        bool active = sub->subscriptionStatus() !=
+                      HEventSubscription::Status_Unsubscribed;
+
+        sub->resetSubscription();
+        subscriptionCompleted(sub);
+
+        sub->setServerRootUrl(getSuitableHttpServerRootUrl(
+            sub->service()->parentDevice()->locations()));
+
+        if (active)
+        {
+            subscriptionStarted(sub);
+            sub->subscribe();
+            ++retVal;
+        }
+    }
+
+    return retVal;
+}
+
+void HEventSubscriptionManager::multicastEventReceived()
+{
+    HLOG2(H_AT, H_FUN, m_owner->m_loggingIdentifier);
+
+    QList<QByteArray> datagrams;
+    QList<HEndpoint> sources;
+    m_multicastSocket->readDatagrams(&datagrams, &sources, 64);
+
+    foreach(const QByteArray& datagram, datagrams)
+    {
+        qint32 bodyStart = datagram.indexOf("\r\n\r\n");
+        if (bodyStart < 0)
+        {
+            continue;
+        }
+
+        HHttpRequestHeader hdr(datagram.left(bodyStart + 4));
+        if (!hdr.isValid() || hdr.method() != "NOTIFY")
+        {
+            continue;
+        }
+
+        QByteArray body = datagram.mid(bodyStart + 4);
+        if (hdr.hasContentLength())
+        {
+            body.truncate(hdr.contentLength());
+        }
+
+        HMulticastNotifyRequest req;
+        if (HHttpMessageCreator::create(hdr, body, req) !=
+            HNotifyRequest::Success)
+        {
+            HLOG_DBG("Ignoring an invalid multicast event");
+            continue;
+        }
+
+        processMulticastNotify(req);
+    }
+
+    if (m_multicastSocket->hasPendingDatagrams())
+    {
+        // the rest are read on the next round so that the other events
+        // are not starved
+        QMetaObject::invokeMethod(
+            this, "multicastEventReceived", Qt::QueuedConnection);
+    }
+}
+
+void HEventSubscriptionManager::processMulticastNotify(
+    const HMulticastNotifyRequest& req)
+{
+    HLOG2(H_AT, H_FUN, m_owner->m_loggingIdentifier);
+
+    HClientDevice* device =
+        m_owner->m_deviceStorage.searchDeviceByUdn(req.usn().udn(), AllDevices);
+
+    if (!device)
+    {
+        return;
+    }
+
+    HDefaultClientService* service =
+        static_cast<HDefaultClientService*>(
+            device->serviceById(req.serviceId()));
+
+    if (!service)
+    {
+        return;
+    }
+
+    // the events of a service are processed in order. an older event is
+    // dropped, except when the device has rebooted or reset its sequence
+    QString key = req.usn().toString();
+    QHash<QString, QPair<qint32, quint32> >::iterator it =
+        m_multicastSeqs.find(key);
+
+    if (it != m_multicastSeqs.end() && it.value().first == req.bootId() &&
+        req.seq() != 0 &&
+        static_cast<qint32>(req.seq() - it.value().second) <= 0)
+    {
+        HLOG_DBG(QString(
+            "Ignoring an out of order multicast event [seq: %1] from [%2]").arg(
+                QString::number(req.seq()), key));
+        return;
+    }
+
+    m_multicastSeqs.insert(key, qMakePair(req.bootId(), req.seq()));
+    ++m_receivedEvents;
+
+    if (!service->updateVariables(req.variables(), true))
+    {
+        HLOG_WARN(QString(
+            "Multicast event from [%1] failed. State variable(s) were not "
+            "updated.").arg(key));
+    }
+}
+
 }
 }
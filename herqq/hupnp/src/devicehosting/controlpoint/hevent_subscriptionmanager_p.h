@@ -27,17 +27,28 @@
 #include "../../devicemodel/client/hclientdevice.h"
 
 #include <QtCore/QList>
+#include <QtCore/QSet>
 #include <QtCore/QHash>
+#include <QtCore/QPair>
 #include <QtCore/QUuid>
 #include <QtCore/QObject>
 
+#include <QtNetwork/QHostAddress>
+
+class QEventLoop;
+
 namespace Herqq
 {
 
 namespace Upnp
 {
 
+class HMulticastSocket;
 class HControlPointPrivate;
+class HTimerWheel;
+class HEventSubscriptionScheduler;
+class HHttpConnectionPool;
+class HMulticastNotifyRequest;
 
 //
 //
@@ -55,6 +66,41 @@ private:
     QHash<QUuid, HEventSubscription*> m_subscribtionsByUuid;
     QHash<HUdn, QList<HEventSubscription*>* > m_subscriptionsByUdn;
 
+    HHttpConnectionPool* m_connectionPool;
+    // the persistent connections shared by the subscriptions
+
+    HTimerWheel* m_renewalWheel;
+    // schedules the renewals of all the subscriptions using a single timer
+
+    HEventSubscriptionScheduler* m_scheduler;
+    // bounds the number of subscription requests in progress
+
+    QSet<HEventSubscription*> m_pendingSubscriptions;
+    // the subscriptions started, which have not yet succeeded or failed
+
+    qint32 m_startedSubscriptions;
+    qint32 m_completedSubscriptions;
+    // the progress of the subscriptions started since there were no
+    // pending subscriptions
+
+    HMulticastSocket* m_multicastSocket;
+    // the socket receiving the UPnP 1.1 multicast events, if enabled
+
+    QHash<QString, QPair<qint32, quint32> > m_multicastSeqs;
+    // the boot ID and the latest sequence number of the multicast events
+    // of each service, keyed by the USN of the service
+
+    qint64 m_failedSubscriptions;
+    qint64 m_receivedEvents;
+    // the number of subscription attempts that failed and the number of
+    // unicast and multicast events received for the subscribed services
+
+    QSet<HEventSubscription*> m_pendingCancellations;
+    // the subscriptions cancelAll() is waiting for
+
+    QEventLoop* m_cancellationLoop;
+    // the event loop cancelAll() runs while waiting, if any
+
 private:
 
     HEventSubscription* createSubscription(HClientService*, qint32 timeout);
@@ -62,17 +108,31 @@ private:
     // attempts to figure out the most suitable HTTP server URL for one of the
     // device locations specified
 
+    void processMulticastNotify(const HMulticastNotifyRequest&);
+
+    void subscriptionStarted(HEventSubscription*);
+    void subscriptionCompleted(HEventSubscription*);
+
+    // called when a subscription no longer needs to be cancelled
+    void cancellationCompleted(HEventSubscription*);
+
 public Q_SLOTS:
 
     void subscribed_slot(HEventSubscription*);
     void subscriptionFailed_slot(HEventSubscription*);
     void unsubscribed(HEventSubscription*);
 
+private Q_SLOTS:
+
+    void multicastEventReceived();
+    void renewalDue(HEventSubscription*);
+
 Q_SIGNALS:
 
     void subscribed(Herqq::Upnp::HClientService*);
     void subscriptionFailed(Herqq::Upnp::HClientService*);
     void unsubscribed(Herqq::Upnp::HClientService*);
+    void subscriptionProgress(qint32 completed, qint32 total);
 
 public:
 
@@ -96,13 +156,43 @@ public:
     // if not, the subscription is just reset to default state (in which it does nothing)
     bool cancel(HClientDevice*, DeviceVisitType, bool unsubscribe);
     bool cancel(HClientService*, bool unsubscribe);
-    void cancelAll(qint32 msecsToWait);
+
+    // sends the unsubscription requests of all the subscriptions at once and
+    // waits at most the specified total time for them to complete. returns
+    // the number of subscriptions whose cancellation did not complete
+    qint32 cancelAll(qint32 msecsToWait);
 
     bool remove(HClientDevice*, bool recursive);
     bool remove(HClientService*);
     void removeAll();
 
     StatusCode onNotify(const QUuid& id, const HNotifyRequest& req);
+
+    // joins the multicast group of the UPnP 1.1 multicast events on the
+    // specified interfaces
+    bool startMulticastEventing(const QList<QHostAddress>& addresses);
+
+    // joins the multicast group of the UPnP 1.1 multicast events on another
+    // interface, starting the multicast eventing if necessary
+    bool addMulticastEventingAddress(const QHostAddress& address);
+
+    // leaves the multicast group on the interface the control point no longer
+    // uses and subscribes again the services whose notifications were sent
+    // to the HTTP server on the address. this has to be called after the
+    // HTTP server has stopped listening to the address. returns the number
+    // of the subscriptions that were moved to another address
+    qint32 serverAddressRemoved(const QHostAddress& address);
+
+    inline HHttpConnectionPool* connectionPool() const
+    {
+        return m_connectionPool;
+    }
+
+    // returns the number of subscriptions that are currently active
+    qint32 activeSubscriptionCount() const;
+
+    inline qint64 failedSubscriptions() const { return m_failedSubscriptions; }
+    inline qint64 receivedEvents() const { return m_receivedEvents; }
 };
 
 }
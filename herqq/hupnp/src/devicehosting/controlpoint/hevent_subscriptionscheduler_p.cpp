@@ -0,0 +1,140 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "hevent_subscriptionscheduler_p.h"
+#include "hevent_subscription_p.h"
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+/*******************************************************************************
+ * HEventSubscriptionScheduler
+ ******************************************************************************/
+HEventSubscriptionScheduler::HEventSubscriptionScheduler(
+    qint32 maxActivePerHost, qint32 maxActive, QObject* parent) :
+        QObject(parent),
+            m_maxActivePerHost(maxActivePerHost), m_maxActive(maxActive),
+            m_active(), m_activePerHost(), m_waiting()
+{
+    Q_ASSERT(maxActivePerHost > 0);
+    Q_ASSERT(maxActive > 0);
+}
+
+HEventSubscriptionScheduler::~HEventSubscriptionScheduler()
+{
+}
+
+void HEventSubscriptionScheduler::admitWaiting()
+{
+    for(qint32 i = 0; i < m_waiting.size() && m_active.size() < m_maxActive;)
+    {
+        const QPair<HEventSubscription*, HEndpoint>& next = m_waiting.at(i);
+
+        qint32& activeToHost = m_activePerHost[next.second];
+        if (activeToHost >= m_maxActivePerHost)
+        {
+            ++i;
+            continue;
+        }
+
+        ++activeToHost;
+        m_active.insert(next.first, next.second);
+
+        // the subscription is resumed asynchronously, since this is usually
+        // called when another request completes
+        QMetaObject::invokeMethod(
+            next.first, "admitted", Qt::QueuedConnection);
+
+        m_waiting.removeAt(i);
+    }
+}
+
+bool HEventSubscriptionScheduler::admit(
+    HEventSubscription* subscription, const HEndpoint& host)
+{
+    Q_ASSERT(subscription);
+
+    if (m_active.contains(subscription))
+    {
+        return true;
+    }
+
+    for(qint32 i = 0; i < m_waiting.size(); ++i)
+    {
+        if (m_waiting.at(i).first == subscription)
+        {
+            return false;
+        }
+    }
+
+    qint32& activeToHost = m_activePerHost[host];
+    if (activeToHost >= m_maxActivePerHost || m_active.size() >= m_maxActive)
+    {
+        if (!activeToHost)
+        {
+            m_activePerHost.remove(host);
+        }
+
+        m_waiting.append(qMakePair(subscription, host));
+        return false;
+    }
+
+    ++activeToHost;
+    m_active.insert(subscription, host);
+
+    return true;
+}
+
+void HEventSubscriptionScheduler::release(HEventSubscription* subscription)
+{
+    QHash<HEventSubscription*, HEndpoint>::iterator it =
+        m_active.find(subscription);
+
+    if (it == m_active.end())
+    {
+        for(qint32 i = 0; i < m_waiting.size(); ++i)
+        {
+            if (m_waiting.at(i).first == subscription)
+            {
+                m_waiting.removeAt(i);
+                break;
+            }
+        }
+        return;
+    }
+
+    QHash<HEndpoint, qint32>::iterator hit = m_activePerHost.find(it.value());
+    if (hit != m_activePerHost.end() && --hit.value() <= 0)
+    {
+        m_activePerHost.erase(hit);
+    }
+
+    m_active.erase(it);
+
+    admitWaiting();
+}
+
+}
+}
@@ -0,0 +1,109 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef HEVENT_SUBSCRIPTIONSCHEDULER_P_H_
+#define HEVENT_SUBSCRIPTIONSCHEDULER_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include "../../general/hupnp_defs.h"
+
+#include <HUpnpCore/HEndpoint>
+
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QPair>
+#include <QtCore/QObject>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+class HEventSubscription;
+
+//
+// Internal class that bounds the number of subscription requests a control
+// point has in progress, both to a single host and overall.
+//
+// A subscription asks for an admission before it sends a subscription or a
+// renewal request and releases the admission once the request completes. In
+// case the request cannot be sent yet, the subscription is queued and its
+// admitted() slot is invoked once it is its turn. The subscriptions are
+// admitted in the order they asked, skipping those that target a host that
+// already has the maximum number of requests in progress.
+//
+class HEventSubscriptionScheduler :
+    public QObject
+{
+Q_OBJECT
+H_DISABLE_COPY(HEventSubscriptionScheduler)
+
+private:
+
+    const qint32 m_maxActivePerHost;
+    const qint32 m_maxActive;
+
+    QHash<HEventSubscription*, HEndpoint> m_active;
+    // the admitted subscriptions and the hosts they target
+
+    QHash<HEndpoint, qint32> m_activePerHost;
+
+    QList<QPair<HEventSubscription*, HEndpoint> > m_waiting;
+
+    void admitWaiting();
+
+public:
+
+    HEventSubscriptionScheduler(
+        qint32 maxActivePerHost, qint32 maxActive, QObject* parent = 0);
+
+    virtual ~HEventSubscriptionScheduler();
+
+    // returns true if the subscription may send its request to the host
+    // right away. otherwise the subscription is queued
+    bool admit(HEventSubscription*, const HEndpoint& host);
+
+    // releases the admission of the subscription or removes the subscription
+    // from the queue
+    void release(HEventSubscription*);
+
+    inline bool isAdmitted(HEventSubscription* subscription) const
+    {
+        return m_active.contains(subscription);
+    }
+
+    inline qint32 activeCount() const { return m_active.size(); }
+    inline qint32 waitingCount() const { return m_waiting.size(); }
+};
+
+}
+}
+
+#endif /* HEVENT_SUBSCRIPTIONSCHEDULER_P_H_ */
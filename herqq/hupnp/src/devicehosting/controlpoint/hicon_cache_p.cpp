@@ -0,0 +1,198 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hicon_cache_p.h"
+#include "hcontrolpoint_dataretriever_p.h"
+
+#include "../../devicemodel/client/hclientdevice.h"
+#include "../../dataelements/hdeviceinfo.h"
+#include "../../general/hupnp_global_p.h"
+#include "../../general/hlogger_p.h"
+
+#include <QtCore/QMutexLocker>
+#include <QtNetwork/QNetworkReply>
+#include <QtNetwork/QNetworkRequest>
+#include <QtNetwork/QNetworkAccessManager>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+/*******************************************************************************
+ * HIconCache
+ ******************************************************************************/
+HIconCache::HIconCache() :
+    m_mutex(), m_entries()
+{
+}
+
+QByteArray HIconCache::etag(const QString& url)
+{
+    QMutexLocker lock(&m_mutex);
+    return m_entries.value(url).m_etag;
+}
+
+bool HIconCache::get(
+    const QString& url, const QByteArray& etag, QByteArray* data)
+{
+    Q_ASSERT(data);
+
+    QMutexLocker lock(&m_mutex);
+
+    QHash<QString, Entry>::const_iterator ci = m_entries.constFind(url);
+    if (ci == m_entries.constEnd() || ci.value().m_etag != etag)
+    {
+        return false;
+    }
+
+    *data = ci.value().m_data;
+    return true;
+}
+
+void HIconCache::put(
+    const QString& url, const QByteArray& etag, const QByteArray& data)
+{
+    Q_ASSERT(!etag.isEmpty());
+
+    Entry entry;
+    entry.m_etag = etag;
+    entry.m_data = data;
+
+    QMutexLocker lock(&m_mutex);
+    m_entries.insert(url, entry);
+}
+
+void HIconCache::clear()
+{
+    QMutexLocker lock(&m_mutex);
+    m_entries.clear();
+}
+
+/*******************************************************************************
+ * HIconRetriever
+ ******************************************************************************/
+HIconRetriever::HIconRetriever(QNetworkAccessManager& nam, HIconCache* cache) :
+    QObject(), m_nam(nam), m_cache(cache), m_pending()
+{
+}
+
+HIconRetriever::~HIconRetriever()
+{
+    QHash<QNetworkReply*, Request>::iterator it = m_pending.begin();
+    for(; it != m_pending.end(); ++it)
+    {
+        it.key()->disconnect(this);
+        it.key()->abort();
+        it.key()->deleteLater();
+    }
+}
+
+bool HIconRetriever::retrieve(HClientDevice* device, const QUrl& iconUrl)
+{
+    HLOG(H_AT, H_FUN);
+    Q_ASSERT(device);
+
+    QList<QUrl> locations = device->locations();
+    if (locations.isEmpty() || !device->info().icons().contains(iconUrl))
+    {
+        return false;
+    }
+
+    Request request;
+    request.m_device = device;
+    request.m_iconUrl = iconUrl;
+    request.m_url = iconUrl.isRelative() ?
+        HDataRetriever::requestUrl(extractBaseUrl(locations[0]), iconUrl) :
+        iconUrl.toString();
+
+    QNetworkRequest req(request.m_url);
+    if (m_cache)
+    {
+        // the icon is downloaded only if it has changed since it was cached
+        request.m_etag = m_cache->etag(request.m_url);
+        if (!request.m_etag.isEmpty())
+        {
+            req.setRawHeader("If-None-Match", request.m_etag);
+        }
+    }
+
+    HLOG_DBG(QString("Retrieving icon from: [%1]").arg(request.m_url));
+
+    QNetworkReply* reply = m_nam.get(req);
+    m_pending.insert(reply, request);
+
+    bool ok = connect(reply, SIGNAL(finished()), this, SLOT(finished()));
+    Q_ASSERT(ok); Q_UNUSED(ok)
+
+    return true;
+}
+
+void HIconRetriever::finished()
+{
+    HLOG(H_AT, H_FUN);
+
+    QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
+    if (!reply || !m_pending.contains(reply))
+    {
+        return;
+    }
+
+    Request request = m_pending.take(reply);
+    reply->deleteLater();
+
+    int status =
+        reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+
+    QByteArray data;
+    bool ok = false;
+    if (status == 304 && m_cache)
+    {
+        ok = m_cache->get(request.m_url, request.m_etag, &data);
+    }
+    else if (reply->error() == QNetworkReply::NoError)
+    {
+        data = reply->readAll();
+        ok = true;
+
+        QByteArray etag = reply->rawHeader("ETag");
+        if (m_cache && !etag.isEmpty())
+        {
+            m_cache->put(request.m_url, etag, data);
+        }
+    }
+
+    if (!ok)
+    {
+        HLOG_WARN(QString("Failed to retrieve icon from [%1]: %2").arg(
+            request.m_url, reply->errorString()));
+    }
+
+    if (request.m_device)
+    {
+        emit request.m_device->iconRetrieved(
+            request.m_device, request.m_iconUrl, ok, data);
+    }
+}
+
+}
+}
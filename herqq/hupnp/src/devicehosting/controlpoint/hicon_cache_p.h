@@ -0,0 +1,137 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HICON_CACHE_P_H_
+#define HICON_CACHE_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include "../../general/hupnp_defs.h"
+
+#include <QtCore/QUrl>
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QObject>
+#include <QtCore/QPointer>
+#include <QtCore/QByteArray>
+
+class QNetworkReply;
+class QNetworkAccessManager;
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+class HClientDevice;
+
+//
+// A cache of the icons the devices of a control point have retrieved.
+// The entries are keyed by the URLs of the icons and every entry holds the
+// entity tag the device sent with the icon, which is used to validate the
+// entry the next time the icon is requested. Icons served without an entity
+// tag cannot be validated and are not cached.
+//
+// The cache is accessed from the threads that own the devices.
+//
+class HIconCache
+{
+H_DISABLE_COPY(HIconCache)
+
+private:
+
+    struct Entry
+    {
+        QByteArray m_etag;
+        QByteArray m_data;
+    };
+
+    QMutex m_mutex;
+    QHash<QString, Entry> m_entries;
+
+public:
+
+    HIconCache();
+
+    // returns the entity tag of the cached icon or an empty array in case
+    // the icon is not cached
+    QByteArray etag(const QString& url);
+
+    // returns the cached icon in case its entity tag matches
+    bool get(const QString& url, const QByteArray& etag, QByteArray* data);
+
+    void put(const QString& url, const QByteArray& etag, const QByteArray&);
+
+    void clear();
+};
+
+//
+// Retrieves the icons of a device tree on demand. Only the root device of a
+// tree has one and it is owned by the root device.
+//
+class HIconRetriever :
+    public QObject
+{
+Q_OBJECT
+H_DISABLE_COPY(HIconRetriever)
+
+private:
+
+    struct Request
+    {
+        QPointer<HClientDevice> m_device;
+        QUrl m_iconUrl;
+        QString m_url;
+        QByteArray m_etag;
+    };
+
+    QNetworkAccessManager& m_nam;
+
+    HIconCache* m_cache;
+    // may be null, in which case every icon is downloaded
+
+    QHash<QNetworkReply*, Request> m_pending;
+
+private Q_SLOTS:
+
+    void finished();
+
+public:
+
+    HIconRetriever(QNetworkAccessManager&, HIconCache*);
+    virtual ~HIconRetriever();
+
+    // starts retrieving the specified icon of the specified device, which
+    // announces the result with HClientDevice::iconRetrieved()
+    bool retrieve(HClientDevice* device, const QUrl& iconUrl);
+};
+
+}
+}
+
+#endif /* HICON_CACHE_P_H_ */
@@ -0,0 +1,114 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "hservicedescription_cache_p.h"
+
+#include "../../general/hmemoryaccount_p.h"
+
+#include <QtCore/QMutexLocker>
+#include <QtCore/QCryptographicHash>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+/*******************************************************************************
+ * HServiceDescriptionCache
+ ******************************************************************************/
+HServiceDescriptionCache::HServiceDescriptionCache() :
+    m_mutex(), m_entries(), m_bytes(0)
+{
+}
+
+HServiceDescriptionCache::~HServiceDescriptionCache()
+{
+    clear();
+}
+
+QByteArray HServiceDescriptionCache::key(const QByteArray& description)
+{
+    return QCryptographicHash::hash(description, QCryptographicHash::Sha1);
+}
+
+qint64 HServiceDescriptionCache::footprint(
+    const HParsedServiceDescription& entry)
+{
+    // the parsed information is estimated from its fixed-size parts only,
+    // the description itself dominates the footprint anyway
+    return sizeof(HParsedServiceDescription) + entry.m_description.size() +
+        entry.m_stateVariables.size() * sizeof(HStateVariableInfo) +
+        entry.m_actions.size() * sizeof(HActionInfo);
+}
+
+bool HServiceDescriptionCache::get(
+    const QByteArray& description, HParsedServiceDescription* retVal)
+{
+    Q_ASSERT(retVal);
+
+    QByteArray digest = key(description);
+
+    QMutexLocker lock(&m_mutex);
+
+    QHash<QByteArray, HParsedServiceDescription>::const_iterator ci =
+        m_entries.constFind(digest);
+
+    // the descriptions are compared as well, since the entry is used in place
+    // of parsing the description
+    if (ci == m_entries.constEnd() || ci.value().m_description != description)
+    {
+        return false;
+    }
+
+    *retVal = ci.value();
+    return true;
+}
+
+void HServiceDescriptionCache::put(const HParsedServiceDescription& entry)
+{
+    QByteArray digest = key(entry.m_description);
+
+    QMutexLocker lock(&m_mutex);
+    if (!m_entries.contains(digest))
+    {
+        m_entries.insert(digest, entry);
+
+        qint64 bytes = footprint(entry);
+        m_bytes += bytes;
+        HMemoryAccount::get(HMemoryAccount::DescriptionCache)->add(bytes);
+    }
+}
+
+void HServiceDescriptionCache::clear()
+{
+    QMutexLocker lock(&m_mutex);
+
+    HMemoryAccount::get(HMemoryAccount::DescriptionCache)->remove(
+        m_bytes, m_entries.size());
+
+    m_entries.clear();
+    m_bytes = 0;
+}
+
+}
+}
@@ -0,0 +1,100 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef HSERVICEDESCRIPTION_CACHE_P_H_
+#define HSERVICEDESCRIPTION_CACHE_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include "../../general/hupnp_defs.h"
+#include "../../dataelements/hactioninfo.h"
+#include "../../dataelements/hstatevariableinfo.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QString>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+//
+// The contents of a parsed service description
+//
+class HParsedServiceDescription
+{
+public:
+
+    QByteArray m_description;
+    QList<HStateVariableInfo> m_stateVariables;
+    QList<HActionInfo> m_actions;
+};
+
+//
+// A cache of the service descriptions the devices of a control point use.
+// The entries are keyed by the contents of the descriptions, which means that
+// every device using an identical description, such as every device of the
+// same model, shares the description and the state variable and action
+// information parsed from it instead of holding copies of its own.
+//
+// The cache is accessed from the threads that build the devices.
+//
+class HServiceDescriptionCache
+{
+H_DISABLE_COPY(HServiceDescriptionCache)
+
+private:
+
+    QMutex m_mutex;
+    QHash<QByteArray, HParsedServiceDescription> m_entries;
+    // keyed by the SHA-1 digests of the descriptions
+
+    qint64 m_bytes;
+    // the estimated footprint of the entries
+
+    static QByteArray key(const QByteArray& description);
+    static qint64 footprint(const HParsedServiceDescription&);
+
+public:
+
+    HServiceDescriptionCache();
+    ~HServiceDescriptionCache();
+
+    bool get(const QByteArray& description, HParsedServiceDescription*);
+    void put(const HParsedServiceDescription&);
+
+    void clear();
+};
+
+}
+}
+
+#endif /* HSERVICEDESCRIPTION_CACHE_P_H_ */
@@ -0,0 +1,222 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "haction_executor_p.h"
+
+#include "../../http/hhttp_messaginginfo_p.h"
+
+#include "../../devicemodel/server/hserveraction.h"
+#include "../../devicemodel/server/hserverdevice.h"
+#include "../../devicemodel/server/hserverservice.h"
+
+#include "../../general/hupnp_global.h"
+#include "../../general/hlogger_p.h"
+
+#include <QtCore/QThread>
+#include <QtCore/QMutexLocker>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+/*******************************************************************************
+ * HActionJob
+ ******************************************************************************/
+HActionJob::HActionJob(
+    HServerAction* action, const HActionArguments& inArgs,
+    HMessagingInfo* mi, bool acceptsGzip, qint64 startedAt) :
+        m_owner(0), m_serialized(false),
+        m_action(action), m_inArgs(inArgs),
+        m_outArgs(), m_rc(UpnpUndefinedFailure),
+        m_mi(mi), m_acceptsGzip(acceptsGzip), m_startedAt(startedAt)
+{
+    Q_ASSERT(m_action);
+    setAutoDelete(false);
+}
+
+HActionJob::~HActionJob()
+{
+    delete m_mi;
+}
+
+void HActionJob::run()
+{
+    Q_ASSERT(m_owner);
+    if (!m_owner->isStopping())
+    {
+        m_rc = m_action->invoke(m_inArgs, &m_outArgs);
+    }
+    m_owner->jobFinished(this);
+}
+
+/*******************************************************************************
+ * HActionExecutor
+ ******************************************************************************/
+HActionExecutor::HActionExecutor(
+    const QByteArray& loggingIdentifier, QObject* parent) :
+        QObject(parent),
+            m_loggingIdentifier(loggingIdentifier),
+            m_threadPool(), m_jobs(), m_serializedJobs(), m_pendingCounts(),
+            m_mutex(), m_finishedJobs(), m_stopping(false)
+{
+}
+
+HActionExecutor::~HActionExecutor()
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    {
+        QMutexLocker lock(&m_mutex);
+        m_stopping = true;
+    }
+
+    m_threadPool.waitForDone();
+    qDeleteAll(m_jobs);
+}
+
+void HActionExecutor::setMaxThreadCount(qint32 count)
+{
+    m_threadPool.setMaxThreadCount(
+        count > 0 ? count : QThread::idealThreadCount());
+}
+
+bool HActionExecutor::isStopping()
+{
+    QMutexLocker lock(&m_mutex);
+    return m_stopping;
+}
+
+bool HActionExecutor::isSaturated(HServerAction* action) const
+{
+    qint32 max = action->maxPendingInvocations();
+    return max > 0 && m_pendingCounts.value(action) >= max;
+}
+
+bool HActionExecutor::hasPendingJobs(const HServerDevice* rootDevice) const
+{
+    QHash<HServerAction*, qint32>::const_iterator ci =
+        m_pendingCounts.constBegin();
+
+    for(; ci != m_pendingCounts.constEnd(); ++ci)
+    {
+        if (ci.key()->parentService()->parentDevice()->rootDevice() ==
+            rootDevice)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void HActionExecutor::execute(HActionJob* job)
+{
+    Q_ASSERT(job && !job->m_owner);
+
+    job->m_owner = this;
+    job->m_serialized =
+        job->m_action->executionPolicy() != HServerAction::ExecuteConcurrently;
+
+    m_jobs.insert(job);
+    ++m_pendingCounts[job->m_action];
+
+    if (job->m_serialized)
+    {
+        QQueue<HActionJob*>& queue =
+            m_serializedJobs[job->m_action->parentService()];
+
+        queue.enqueue(job);
+        if (queue.size() > 1)
+        {
+            // a previous invocation of an action of the service is running
+            return;
+        }
+    }
+
+    m_threadPool.start(job);
+}
+
+void HActionExecutor::jobFinished(HActionJob* job)
+{
+    QMutexLocker lock(&m_mutex);
+
+    m_finishedJobs.append(job);
+    if (m_finishedJobs.size() == 1)
+    {
+        QMetaObject::invokeMethod(
+            this, "processFinishedJobs", Qt::QueuedConnection);
+    }
+}
+
+void HActionExecutor::processFinishedJobs()
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    QList<HActionJob*> finishedJobs;
+    {
+        QMutexLocker lock(&m_mutex);
+        finishedJobs = m_finishedJobs;
+        m_finishedJobs.clear();
+    }
+
+    foreach(HActionJob* job, finishedJobs)
+    {
+        m_jobs.remove(job);
+
+        QHash<HServerAction*, qint32>::iterator pit =
+            m_pendingCounts.find(job->m_action);
+
+        Q_ASSERT(pit != m_pendingCounts.end());
+        if (--pit.value() == 0)
+        {
+            m_pendingCounts.erase(pit);
+        }
+
+        if (job->m_serialized)
+        {
+            HServerService* service = job->m_action->parentService();
+
+            QHash<HServerService*, QQueue<HActionJob*> >::iterator it =
+                m_serializedJobs.find(service);
+
+            Q_ASSERT(it != m_serializedJobs.end());
+            Q_ASSERT(it->head() == job);
+
+            it->dequeue();
+            if (it->isEmpty())
+            {
+                m_serializedJobs.erase(it);
+            }
+            else
+            {
+                m_threadPool.start(it->head());
+            }
+        }
+
+        emit jobCompleted(job);
+    }
+}
+
+}
+}
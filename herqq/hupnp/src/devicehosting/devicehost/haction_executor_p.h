@@ -0,0 +1,181 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef HACTION_EXECUTOR_P_H_
+#define HACTION_EXECUTOR_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include "../../devicemodel/hactionarguments.h"
+
+#include <QtCore/QSet>
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QQueue>
+#include <QtCore/QObject>
+#include <QtCore/QRunnable>
+#include <QtCore/QThreadPool>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+class HServerAction;
+class HServerDevice;
+class HServerService;
+class HMessagingInfo;
+class HActionExecutor;
+
+//
+// A single invocation of an action that is run in a worker thread of
+// an HActionExecutor
+//
+class HActionJob :
+    public QRunnable
+{
+H_DISABLE_COPY(HActionJob)
+friend class HActionExecutor;
+
+private:
+
+    HActionExecutor* m_owner;
+    bool m_serialized;
+
+public:
+
+    HServerAction* const m_action;
+    const HActionArguments m_inArgs;
+
+    HActionArguments m_outArgs;
+    qint32 m_rc;
+    // the result of the invocation, which is set in the worker thread
+
+    HMessagingInfo* m_mi;
+    const bool m_acceptsGzip;
+    // the connection the response is sent to and whether the invoker accepts
+    // a compressed response. the messaging info is owned by the job until
+    // it is taken for sending the response
+
+    const qint64 m_startedAt;
+    // the time the invocation was started, which is used by the creator of
+    // the job to measure the duration of the invocation
+
+public:
+
+    HActionJob(
+        HServerAction*, const HActionArguments& inArgs, HMessagingInfo*,
+        bool acceptsGzip, qint64 startedAt);
+
+    virtual ~HActionJob();
+
+    virtual void run();
+};
+
+//
+// Runs the actions that are not run in the thread of the device host
+//
+// The jobs are run in a thread pool of their own. The serialized jobs of a
+// service are queued and only the job at the head of the queue of a service
+// is in the pool at a time. The completion of every job is signaled in the
+// thread of the executor.
+//
+class HActionExecutor :
+    public QObject
+{
+Q_OBJECT
+H_DISABLE_COPY(HActionExecutor)
+friend class HActionJob;
+
+private:
+
+    const QByteArray m_loggingIdentifier;
+
+    QThreadPool m_threadPool;
+
+    QSet<HActionJob*> m_jobs;
+    // every job owned by the executor, whether it is queued, running or
+    // waiting to be signaled
+
+    QHash<HServerService*, QQueue<HActionJob*> > m_serializedJobs;
+    // the serialized jobs of each service. the job at the head of a queue is
+    // the one in the thread pool
+
+    QHash<HServerAction*, qint32> m_pendingCounts;
+    // the number of jobs of each action that have not been signaled yet
+
+    QMutex m_mutex;
+    QList<HActionJob*> m_finishedJobs;
+    bool m_stopping;
+    // the jobs that have been run in the pool and that are waiting to be
+    // signaled in the thread of the executor, and whether the jobs that have
+    // not started yet should be skipped. these are guarded by the mutex
+
+    // called from a worker thread once the job has been run
+    void jobFinished(HActionJob*);
+
+    bool isStopping();
+
+private Q_SLOTS:
+
+    void processFinishedJobs();
+
+Q_SIGNALS:
+
+    // the receiver takes the ownership of the job
+    void jobCompleted(Herqq::Upnp::HActionJob*);
+
+public:
+
+    HActionExecutor(const QByteArray& loggingIdentifier, QObject* parent = 0);
+
+    // waits for the jobs that are running to finish. the jobs that have not
+    // started are not run
+    virtual ~HActionExecutor();
+
+    // a value of zero or less means the number of processor cores
+    void setMaxThreadCount(qint32 count);
+
+    // indicates whether the action has as many pending jobs as its
+    // HServerAction::maxPendingInvocations() allows
+    bool isSaturated(HServerAction*) const;
+
+    // indicates whether an action of the device tree has a job that has not
+    // been signaled yet
+    bool hasPendingJobs(const HServerDevice* rootDevice) const;
+
+    // takes the ownership of the job
+    void execute(HActionJob*);
+};
+
+}
+}
+
+#endif /* HACTION_EXECUTOR_P_H_ */
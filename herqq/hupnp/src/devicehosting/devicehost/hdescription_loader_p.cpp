@@ -0,0 +1,865 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "hdescription_loader_p.h"
+#include "hdevicehost_configuration.h"
+
+#include "../../dataelements/hudn.h"
+#include "../../dataelements/hserviceinfo.h"
+#include "../../devicemodel/hactionarguments.h"
+
+#include "../../general/hupnpinfo.h"
+#include "../../general/hupnp_global_p.h"
+#include "../../general/hlogger_p.h"
+
+#include <QtCore/QSet>
+#include <QtCore/QFile>
+#include <QtCore/QDateTime>
+#include <QtCore/QVector>
+#include <QtCore/QFileInfo>
+#include <QtCore/QStringList>
+#include <QtCore/QDataStream>
+#include <QtCore/QThreadPool>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QCryptographicHash>
+
+#include <QtXml/QDomDocument>
+#include <QtXml/QDomElement>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace
+{
+// the UDN of an embedded device of a device created from a template. this is
+// a name-based UUID of the UDN of the root device and the UDN in the template,
+// which keeps the UDN the same every time the device is created
+HUdn derivedUdn(const HUdn& rootUdn, const QString& templateUdn)
+{
+    QByteArray hash = QCryptographicHash::hash(
+        rootUdn.toString().append(templateUdn).toUtf8(),
+        QCryptographicHash::Md5);
+
+    hash[6] = static_cast<char>((hash[6] & 0x0f) | 0x30);
+    hash[8] = static_cast<char>((hash[8] & 0x3f) | 0x80);
+
+    QString hex = QString::fromLatin1(hash.toHex());
+    return HUdn(QUuid(QString("{%1-%2-%3-%4-%5}").arg(
+        hex.mid(0, 8), hex.mid(8, 4), hex.mid(12, 4), hex.mid(16, 4),
+        hex.mid(20))));
+}
+
+void setElementText(QDomElement element, const QString& text)
+{
+    if (element.isNull())
+    {
+        return;
+    }
+
+    while (element.hasChildNodes())
+    {
+        element.removeChild(element.firstChild());
+    }
+    element.appendChild(element.ownerDocument().createTextNode(text));
+}
+
+void replaceEmbeddedUdns(const QDomElement& deviceElement, const HUdn& rootUdn)
+{
+    QDomElement embeddedDeviceElement = deviceElement.firstChildElement(
+        "deviceList").firstChildElement("device");
+
+    for(; !embeddedDeviceElement.isNull();
+        embeddedDeviceElement =
+            embeddedDeviceElement.nextSiblingElement("device"))
+    {
+        QDomElement udnElement = embeddedDeviceElement.firstChildElement("UDN");
+        setElementText(
+            udnElement,
+            derivedUdn(rootUdn, udnElement.text().trimmed()).toString());
+
+        replaceEmbeddedUdns(embeddedDeviceElement, rootUdn);
+    }
+}
+
+// replaces the UDNs and the friendly name of the description with the ones
+// specified in the configuration
+bool instantiateTemplate(
+    const HDeviceConfiguration& config, QString* description, QString* err)
+{
+    QDomDocument doc;
+    if (!doc.setContent(*description, err))
+    {
+        return false;
+    }
+
+    QDomElement deviceElement =
+        doc.documentElement().firstChildElement("device");
+    if (deviceElement.isNull())
+    {
+        *err = "The device description has no device element";
+        return false;
+    }
+
+    setElementText(
+        deviceElement.firstChildElement("UDN"), config.udn().toString());
+
+    if (!config.friendlyName().isEmpty())
+    {
+        setElementText(
+            deviceElement.firstChildElement("friendlyName"),
+            config.friendlyName());
+    }
+
+    replaceEmbeddedUdns(deviceElement, config.udn());
+
+    *description = doc.toString();
+    return true;
+}
+
+inline bool isTemplate(const HDeviceConfiguration* config)
+{
+    return config->udn().isValid(LooseChecks);
+}
+
+// identifies the format of the snapshot files. the format version has to be
+// changed whenever the contents of the snapshot change
+const quint32 SnapshotFileMagic = 0x48645331;
+const quint32 SnapshotFormatVersion = 1;
+
+// the key of a device description instantiated from a template
+QString templateKey(const HDeviceConfiguration* config)
+{
+    return QString("%1\n%2\n%3").arg(
+        config->pathToDeviceDescription(), config->udn().toString(),
+        config->friendlyName());
+}
+
+// the values of the types HUPnP registers itself cannot be streamed
+inline bool isStreamable(const QVariant& value)
+{
+    return value.userType() < QVariant::UserType;
+}
+
+bool writeStateVariable(QDataStream& out, const HStateVariableInfo& info)
+{
+    if (!isStreamable(info.minimumValue()) ||
+        !isStreamable(info.maximumValue()) ||
+        !isStreamable(info.stepValue()) ||
+        !isStreamable(info.defaultValue()))
+    {
+        return false;
+    }
+
+    out << info.name() << static_cast<qint32>(info.dataType()) <<
+           static_cast<qint32>(info.eventingType()) <<
+           static_cast<qint32>(info.inclusionRequirement()) <<
+           info.version() << info.maxEventRate() <<
+           info.allowedValueList() << info.minimumValue() <<
+           info.maximumValue() << info.stepValue() << info.defaultValue();
+
+    return true;
+}
+
+bool readStateVariable(QDataStream& in, HStateVariableInfo* info)
+{
+    QString name;
+    qint32 dataType = 0, eventingType = 0, incReq = 0;
+    qint32 version = 0, maxEventRate = 0;
+    QStringList allowedValues;
+    QVariant minimumValue, maximumValue, stepValue, defaultValue;
+
+    in >> name >> dataType >> eventingType >> incReq >> version >>
+          maxEventRate >> allowedValues >> minimumValue >> maximumValue >>
+          stepValue >> defaultValue;
+
+    if (in.status() != QDataStream::Ok)
+    {
+        return false;
+    }
+
+    HStateVariableInfo tmp(
+        name, static_cast<HUpnpDataTypes::DataType>(dataType),
+        static_cast<HInclusionRequirement>(incReq));
+
+    tmp.setVersion(version);
+    tmp.setMaxEventRate(maxEventRate);
+    tmp.setEventingType(
+        static_cast<HStateVariableInfo::EventingType>(eventingType));
+
+    if ((!allowedValues.isEmpty() && !tmp.setAllowedValueList(allowedValues)) ||
+        (minimumValue.isValid() && !tmp.setAllowedValueRange(
+            minimumValue, maximumValue, stepValue)) ||
+        (defaultValue.isValid() && !tmp.setDefaultValue(defaultValue)) ||
+        !tmp.isValid())
+    {
+        return false;
+    }
+
+    *info = tmp;
+    return true;
+}
+
+bool writeArguments(QDataStream& out, const HActionArguments& args)
+{
+    out << static_cast<qint32>(args.size());
+    for(qint32 i = 0; i < args.size(); ++i)
+    {
+        out << args[i].name();
+        if (!writeStateVariable(out, args[i].relatedStateVariable()))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool readArguments(QDataStream& in, HActionArguments* args)
+{
+    qint32 count = 0;
+    in >> count;
+
+    QVector<HActionArgument> tmp;
+    for(qint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i)
+    {
+        QString name;
+        HStateVariableInfo stateVariable;
+
+        in >> name;
+        if (!readStateVariable(in, &stateVariable))
+        {
+            return false;
+        }
+
+        HActionArgument arg(name, stateVariable);
+        if (!arg.isValid())
+        {
+            return false;
+        }
+        tmp.append(arg);
+    }
+
+    *args = HActionArguments(tmp);
+    return in.status() == QDataStream::Ok;
+}
+
+bool writeServiceDescription(
+    QDataStream& out, const HParsedServiceDescription& description)
+{
+    out << static_cast<qint32>(description.m_stateVariables.size());
+    foreach(const HStateVariableInfo& info, description.m_stateVariables)
+    {
+        if (!writeStateVariable(out, info))
+        {
+            return false;
+        }
+    }
+
+    out << static_cast<qint32>(description.m_actions.size());
+    foreach(const HActionInfo& info, description.m_actions)
+    {
+        out << info.name() << static_cast<qint32>(info.inclusionRequirement())
+            << !info.returnArgumentName().isEmpty();
+
+        if (!writeArguments(out, info.inputArguments()) ||
+            !writeArguments(out, info.outputArguments()))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool readServiceDescription(
+    QDataStream& in, HParsedServiceDescription* description)
+{
+    qint32 count = 0;
+    in >> count;
+    for(qint32 i = 0; i < count; ++i)
+    {
+        HStateVariableInfo info;
+        if (!readStateVariable(in, &info))
+        {
+            return false;
+        }
+        description->m_stateVariables.append(info);
+    }
+
+    in >> count;
+    for(qint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i)
+    {
+        QString name;
+        qint32 incReq = 0;
+        bool hasRetVal = false;
+        HActionArguments inArgs, outArgs;
+
+        in >> name >> incReq >> hasRetVal;
+        if (!readArguments(in, &inArgs) || !readArguments(in, &outArgs))
+        {
+            return false;
+        }
+
+        HActionInfo info(
+            name, inArgs, outArgs, hasRetVal,
+            static_cast<HInclusionRequirement>(incReq));
+
+        if (!info.isValid())
+        {
+            return false;
+        }
+        description->m_actions.append(info);
+    }
+
+    return in.status() == QDataStream::Ok;
+}
+}
+
+/*******************************************************************************
+ * HDescriptionReadJob
+ ******************************************************************************/
+HDescriptionReadJob::HDescriptionReadJob(
+    const QByteArray& loggingId, const QString& path,
+    const HDeviceHostFileCache& cache) :
+        m_loggingIdentifier(loggingId), m_path(path), m_cache(cache),
+        m_serviceDescriptions(), m_error(HDeviceHost::UndefinedError),
+        m_errorDescription()
+{
+    setAutoDelete(false);
+}
+
+bool HDescriptionReadJob::readServices(
+    HDocParser& parser, DeviceHostDataRetriever& dataRetriever,
+    const QDomElement& deviceElement)
+{
+    QDomElement serviceElement = deviceElement.firstChildElement(
+        "serviceList").firstChildElement("service");
+
+    for(; !serviceElement.isNull();
+        serviceElement = serviceElement.nextSiblingElement("service"))
+    {
+        HServiceInfo info;
+        if (!parser.parseServiceInfo(serviceElement, &info))
+        {
+            m_error = HDeviceHost::InvalidDeviceDescriptionError;
+            m_errorDescription = parser.lastErrorDescription();
+            return false;
+        }
+
+        QString description;
+        if (!dataRetriever.retrieveServiceDescription(
+            QUrl(), info.scpdUrl(), &description))
+        {
+            m_error = HDeviceHost::UndefinedError;
+            m_errorDescription = QString(
+                "Could not retrieve service description from [%1]").arg(
+                    info.scpdUrl().toString());
+
+            return false;
+        }
+
+        if (m_serviceDescriptions.contains(description))
+        {
+            continue;
+        }
+
+        HParsedServiceDescription parsed;
+        if (!parser.parseServiceDescription(
+            description, &parsed.m_stateVariables, &parsed.m_actions))
+        {
+            m_error = HDeviceHost::InvalidServiceDescriptionError;
+            m_errorDescription = parser.lastErrorDescription();
+            return false;
+        }
+
+        m_serviceDescriptions.insert(description, parsed);
+    }
+
+    QDomElement embeddedDeviceElement = deviceElement.firstChildElement(
+        "deviceList").firstChildElement("device");
+
+    for(; !embeddedDeviceElement.isNull();
+        embeddedDeviceElement =
+            embeddedDeviceElement.nextSiblingElement("device"))
+    {
+        if (!readServices(parser, dataRetriever, embeddedDeviceElement))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void HDescriptionReadJob::run()
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    DeviceHostDataRetriever dataRetriever(
+        m_loggingIdentifier, extractBaseUrl(m_path), &m_cache);
+
+    QString description;
+    if (!dataRetriever.retrieveDeviceDescription(m_path, &description))
+    {
+        m_error = HDeviceHost::InvalidConfigurationError;
+        m_errorDescription = dataRetriever.lastError();
+        return;
+    }
+
+    HDocParser parser(m_loggingIdentifier, StrictChecks);
+
+    QDomDocument doc;
+    QDomElement rootDeviceElement;
+    if (!parser.parseRoot(description, &doc, &rootDeviceElement))
+    {
+        m_error = HDeviceHost::InvalidDeviceDescriptionError;
+        m_errorDescription = parser.lastErrorDescription();
+        return;
+    }
+
+    if (readServices(parser, dataRetriever, rootDeviceElement))
+    {
+        m_error = HDeviceHost::NoError;
+    }
+}
+
+/*******************************************************************************
+ * HTemplateJob
+ ******************************************************************************/
+HTemplateJob::HTemplateJob(
+    const HDeviceConfiguration* config, const QString& description) :
+        m_config(config), m_description(description),
+        m_error(HDeviceHost::UndefinedError), m_errorDescription()
+{
+    Q_ASSERT(m_config);
+    setAutoDelete(false);
+}
+
+void HTemplateJob::run()
+{
+    QString err;
+    if (!instantiateTemplate(*m_config, &m_description, &err))
+    {
+        m_error = HDeviceHost::InvalidDeviceDescriptionError;
+        m_errorDescription = QString(
+            "Could not use the device description [%1] as a template: %2").arg(
+                m_config->pathToDeviceDescription(), err);
+
+        return;
+    }
+
+    m_error = HDeviceHost::NoError;
+}
+
+/*******************************************************************************
+ * HDescriptionLoader
+ ******************************************************************************/
+HDescriptionLoader::HDescriptionLoader(
+    const QByteArray& loggingId, HDeviceHostFileCache* cache) :
+        m_loggingIdentifier(loggingId), m_cache(cache),
+        m_serviceDescriptions(), m_deviceDescriptions(),
+        m_lastError(HDeviceHost::NoError), m_lastErrorDescription(),
+        m_loadedFromSnapshot(false)
+{
+    Q_ASSERT(m_cache);
+}
+
+bool HDescriptionLoader::readDescriptions(
+    const QList<const HDeviceConfiguration*>& configs)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QSet<QString> paths;
+    QList<HDescriptionReadJob*> jobs;
+    foreach(const HDeviceConfiguration* config, configs)
+    {
+        QString path = config->pathToDeviceDescription();
+        if (!paths.contains(path))
+        {
+            paths.insert(path);
+            jobs.append(
+                new HDescriptionReadJob(m_loggingIdentifier, path, *m_cache));
+        }
+    }
+
+    QThreadPool threadPool;
+    foreach(HDescriptionReadJob* job, jobs)
+    {
+        threadPool.start(job);
+    }
+    threadPool.waitForDone();
+
+    bool ok = true;
+    foreach(HDescriptionReadJob* job, jobs)
+    {
+        if (job->m_error != HDeviceHost::NoError)
+        {
+            // the error of the first configuration that failed is reported
+            if (ok)
+            {
+                m_lastError = job->m_error;
+                m_lastErrorDescription = job->m_errorDescription;
+                ok = false;
+            }
+            continue;
+        }
+
+        QHash<QString, QString>::const_iterator ci =
+            job->m_cache.m_documents.constBegin();
+        for(; ci != job->m_cache.m_documents.constEnd(); ++ci)
+        {
+            m_cache->m_documents.insert(ci.key(), ci.value());
+        }
+
+        HParsedServiceDescriptions::const_iterator ci2 =
+            job->m_serviceDescriptions.constBegin();
+        for(; ci2 != job->m_serviceDescriptions.constEnd(); ++ci2)
+        {
+            m_serviceDescriptions.insert(ci2.key(), ci2.value());
+        }
+    }
+
+    qDeleteAll(jobs);
+
+    if (ok)
+    {
+        HLOG_DBG(QString(
+            "Read and parsed [%1] device descriptions and [%2] service "
+            "descriptions in [%3] ms").arg(
+                QString::number(paths.size()),
+                QString::number(m_serviceDescriptions.size()),
+                QString::number(timer.elapsed())));
+    }
+
+    return ok;
+}
+
+bool HDescriptionLoader::instantiateTemplates(
+    const QList<const HDeviceConfiguration*>& configs)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QList<HTemplateJob*> jobs;
+    foreach(const HDeviceConfiguration* config, configs)
+    {
+        QString description =
+            m_cache->m_documents.value(config->pathToDeviceDescription());
+
+        if (isTemplate(config))
+        {
+            jobs.append(new HTemplateJob(config, description));
+        }
+        else
+        {
+            m_deviceDescriptions.insert(config, description);
+        }
+    }
+
+    if (jobs.isEmpty())
+    {
+        return true;
+    }
+
+    QThreadPool threadPool;
+    foreach(HTemplateJob* job, jobs)
+    {
+        threadPool.start(job);
+    }
+    threadPool.waitForDone();
+
+    bool ok = true;
+    foreach(HTemplateJob* job, jobs)
+    {
+        if (job->m_error != HDeviceHost::NoError)
+        {
+            if (ok)
+            {
+                m_lastError = job->m_error;
+                m_lastErrorDescription = job->m_errorDescription;
+                ok = false;
+            }
+            continue;
+        }
+
+        m_deviceDescriptions.insert(job->m_config, job->m_description);
+    }
+
+    if (ok)
+    {
+        HLOG_DBG(QString(
+            "Instantiated [%1] device descriptions from templates "
+            "in [%2] ms").arg(
+                QString::number(jobs.size()),
+                QString::number(timer.elapsed())));
+    }
+
+    qDeleteAll(jobs);
+
+    return ok;
+}
+
+bool HDescriptionLoader::readSnapshot(
+    const QString& path, const QList<const HDeviceConfiguration*>& configs)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        HLOG_INFO(QString("No snapshot found at [%1]").arg(path));
+        return false;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_4_6);
+
+    quint32 magic = 0, formatVersion = 0;
+    QString coreVersion;
+
+    in >> magic >> formatVersion >> coreVersion;
+    if (magic != SnapshotFileMagic || formatVersion != SnapshotFormatVersion ||
+        coreVersion != QString(hupnpCoreVersion()))
+    {
+        HLOG_INFO(QString(
+            "Ignoring the snapshot [%1] written by a different version of "
+            "HUPnP").arg(path));
+        return false;
+    }
+
+    qint32 count = 0;
+    in >> count;
+    for(qint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i)
+    {
+        QString filePath;
+        qint64 size = 0;
+        QDateTime lastModified;
+
+        in >> filePath >> size >> lastModified;
+
+        QFileInfo fileInfo(filePath);
+        if (in.status() == QDataStream::Ok &&
+            (!fileInfo.exists() || fileInfo.size() != size ||
+             fileInfo.lastModified() != lastModified))
+        {
+            HLOG_INFO(QString(
+                "Ignoring the snapshot [%1], since the file [%2] has "
+                "changed").arg(path, filePath));
+            return false;
+        }
+    }
+
+    HDeviceHostFileCache cache;
+    QHash<QString, QString> instantiatedTemplates;
+    in >> cache.m_documents >> cache.m_data >> instantiatedTemplates;
+
+    HParsedServiceDescriptions serviceDescriptions;
+
+    in >> count;
+    for(qint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i)
+    {
+        QString filePath;
+        HParsedServiceDescription description;
+
+        in >> filePath;
+        if (!cache.m_documents.contains(filePath) ||
+            !readServiceDescription(in, &description))
+        {
+            HLOG_WARN(QString("Ignoring a corrupt snapshot: [%1]").arg(path));
+            return false;
+        }
+
+        serviceDescriptions.insert(
+            cache.m_documents.value(filePath), description);
+    }
+
+    if (in.status() != QDataStream::Ok)
+    {
+        HLOG_WARN(QString("Ignoring a corrupt snapshot: [%1]").arg(path));
+        return false;
+    }
+
+    QHash<const HDeviceConfiguration*, QString> deviceDescriptions;
+    foreach(const HDeviceConfiguration* config, configs)
+    {
+        QString key = isTemplate(config) ?
+            templateKey(config) : config->pathToDeviceDescription();
+
+        const QHash<QString, QString>& descriptions =
+            isTemplate(config) ? instantiatedTemplates : cache.m_documents;
+
+        if (!descriptions.contains(key))
+        {
+            HLOG_INFO(QString(
+                "Ignoring the snapshot [%1], since it does not contain the "
+                "device description [%2]").arg(
+                    path, config->pathToDeviceDescription()));
+            return false;
+        }
+
+        deviceDescriptions.insert(config, descriptions.value(key));
+    }
+
+    QHash<QString, QString>::const_iterator ci =
+        cache.m_documents.constBegin();
+    for(; ci != cache.m_documents.constEnd(); ++ci)
+    {
+        m_cache->m_documents.insert(ci.key(), ci.value());
+    }
+
+    QHash<QString, QByteArray>::const_iterator ci2 =
+        cache.m_data.constBegin();
+    for(; ci2 != cache.m_data.constEnd(); ++ci2)
+    {
+        m_cache->m_data.insert(ci2.key(), ci2.value());
+    }
+
+    m_serviceDescriptions = serviceDescriptions;
+    m_deviceDescriptions = deviceDescriptions;
+
+    HLOG_DBG(QString("Read the snapshot [%1] in [%2] ms").arg(
+        path, QString::number(timer.elapsed())));
+
+    return true;
+}
+
+bool HDescriptionLoader::writeSnapshot(
+    const QString& path, const QList<const HDeviceConfiguration*>& configs,
+    QString* err)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    Q_ASSERT(err);
+
+    QByteArray contents;
+    QDataStream out(&contents, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_4_6);
+
+    out << SnapshotFileMagic << SnapshotFormatVersion <<
+           QString(hupnpCoreVersion());
+
+    QStringList filePaths = m_cache->m_documents.keys();
+    filePaths.append(m_cache->m_data.keys());
+
+    out << static_cast<qint32>(filePaths.size());
+    foreach(const QString& filePath, filePaths)
+    {
+        QFileInfo fileInfo(filePath);
+        out << filePath << fileInfo.size() << fileInfo.lastModified();
+    }
+
+    QHash<QString, QString> instantiatedTemplates;
+    foreach(const HDeviceConfiguration* config, configs)
+    {
+        if (isTemplate(config))
+        {
+            instantiatedTemplates.insert(
+                templateKey(config), m_deviceDescriptions.value(config));
+        }
+    }
+
+    out << m_cache->m_documents << m_cache->m_data << instantiatedTemplates;
+
+    // the parsed service descriptions are stored by the paths of the service
+    // descriptions, which lets them share the documents when read
+    QList<QString> servicePaths;
+    QHash<QString, QString>::const_iterator ci =
+        m_cache->m_documents.constBegin();
+    for(; ci != m_cache->m_documents.constEnd(); ++ci)
+    {
+        if (m_serviceDescriptions.contains(ci.value()))
+        {
+            servicePaths.append(ci.key());
+        }
+    }
+
+    out << static_cast<qint32>(servicePaths.size());
+    foreach(const QString& servicePath, servicePaths)
+    {
+        out << servicePath;
+        if (!writeServiceDescription(out, m_serviceDescriptions.value(
+            m_cache->m_documents.value(servicePath))))
+        {
+            *err = QString(
+                "The service description [%1] contains values that cannot "
+                "be stored in a snapshot").arg(servicePath);
+            return false;
+        }
+    }
+
+    // the snapshot is written to a temporary file first, so that a partially
+    // written file is never read as a snapshot
+    QString tmpPath = QString(path).append(".tmp");
+
+    QFile file(tmpPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) ||
+        file.write(contents) != contents.size())
+    {
+        *err = QString("Failed to write the snapshot [%1]: %2").arg(
+            path, file.errorString());
+
+        file.close();
+        QFile::remove(tmpPath);
+        return false;
+    }
+
+    file.close();
+
+    QFile::remove(path);
+    if (!QFile::rename(tmpPath, path))
+    {
+        *err = QString("Failed to replace the snapshot [%1]").arg(path);
+        QFile::remove(tmpPath);
+        return false;
+    }
+
+    return true;
+}
+
+bool HDescriptionLoader::load(
+    const QList<const HDeviceConfiguration*>& configs,
+    const QString& snapshotPath)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    if (!snapshotPath.isEmpty() && readSnapshot(snapshotPath, configs))
+    {
+        m_loadedFromSnapshot = true;
+        return true;
+    }
+
+    return readDescriptions(configs) && instantiateTemplates(configs);
+}
+
+}
+}
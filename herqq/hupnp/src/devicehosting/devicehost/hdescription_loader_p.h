@@ -0,0 +1,197 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef HDESCRIPTION_LOADER_P_H_
+#define HDESCRIPTION_LOADER_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include "hdevicehost.h"
+#include "hservermodel_creator_p.h"
+#include "hdevicehost_dataretriever_p.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QString>
+#include <QtCore/QRunnable>
+
+class QDomElement;
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+class HDeviceConfiguration;
+
+//
+// Reads a device description and the service descriptions it refers to and
+// parses them in a worker thread
+//
+class HDescriptionReadJob :
+    public QRunnable
+{
+H_DISABLE_COPY(HDescriptionReadJob)
+
+private:
+
+    bool readServices(
+        HDocParser&, DeviceHostDataRetriever&, const QDomElement& device);
+
+public:
+
+    const QByteArray m_loggingIdentifier;
+
+    const QString m_path;
+    // the path to the device description
+
+    HDeviceHostFileCache m_cache;
+    // the files read by the job, which are seeded with the files the
+    // device host has already read
+
+    HParsedServiceDescriptions m_serviceDescriptions;
+
+    HDeviceHost::DeviceHostError m_error;
+    QString m_errorDescription;
+
+    HDescriptionReadJob(
+        const QByteArray& loggingId, const QString& path,
+        const HDeviceHostFileCache& cache);
+
+    virtual void run();
+};
+
+//
+// Replaces the UDNs and the friendly name of a device description with the
+// ones of a device configuration in a worker thread
+//
+class HTemplateJob :
+    public QRunnable
+{
+H_DISABLE_COPY(HTemplateJob)
+
+public:
+
+    const HDeviceConfiguration* m_config;
+    // not owned
+
+    QString m_description;
+    // the template when the job starts and the device description of the
+    // configuration when it is done
+
+    HDeviceHost::DeviceHostError m_error;
+    QString m_errorDescription;
+
+    HTemplateJob(const HDeviceConfiguration*, const QString& description);
+
+    virtual void run();
+};
+
+//
+// Reads and parses the description files of the device configurations of
+// a device host in a thread pool
+//
+// The descriptions are read and parsed first, once per distinct file, after
+// which the templated configurations are instantiated. The device model
+// itself has to be created in the thread of the device host, since it is
+// created by the user-defined HDeviceModelCreator, but the creation then
+// only has to find the files and the parsed service descriptions here.
+//
+class HDescriptionLoader
+{
+H_DISABLE_COPY(HDescriptionLoader)
+
+private:
+
+    const QByteArray m_loggingIdentifier;
+
+    HDeviceHostFileCache* m_cache;
+    // not owned. the files read are added here
+
+    HParsedServiceDescriptions m_serviceDescriptions;
+    QHash<const HDeviceConfiguration*, QString> m_deviceDescriptions;
+
+    HDeviceHost::DeviceHostError m_lastError;
+    QString m_lastErrorDescription;
+
+    bool m_loadedFromSnapshot;
+
+    bool readDescriptions(const QList<const HDeviceConfiguration*>&);
+    bool instantiateTemplates(const QList<const HDeviceConfiguration*>&);
+
+    bool readSnapshot(
+        const QString& path, const QList<const HDeviceConfiguration*>&);
+
+public:
+
+    HDescriptionLoader(
+        const QByteArray& loggingId, HDeviceHostFileCache* cache);
+
+    bool load(
+        const QList<const HDeviceConfiguration*>&,
+        const QString& snapshotPath = QString());
+    // the description files are read only if the snapshot is not specified
+    // or it is out of date
+
+    bool writeSnapshot(
+        const QString& path, const QList<const HDeviceConfiguration*>&,
+        QString* err);
+    // writes the files in the cache and the descriptions loaded for the
+    // specified configurations to the snapshot
+
+    inline bool loadedFromSnapshot() const
+    {
+        return m_loadedFromSnapshot;
+    }
+
+    inline QString deviceDescription(const HDeviceConfiguration* config) const
+    {
+        return m_deviceDescriptions.value(config);
+    }
+
+    inline const HParsedServiceDescriptions* serviceDescriptions() const
+    {
+        return &m_serviceDescriptions;
+    }
+
+    inline HDeviceHost::DeviceHostError lastError() const
+    {
+        return m_lastError;
+    }
+
+    inline QString lastErrorDescription() const
+    {
+        return m_lastErrorDescription;
+    }
+};
+
+}
+}
+
+#endif /* HDESCRIPTION_LOADER_P_H_ */
@@ -21,6 +21,7 @@
 
 #include "hdevicehost.h"
 #include "hdevicehost_p.h"
+#include "htaskscheduler.h"
 #include "hevent_notifier_p.h"
 #include "hpresence_announcer_p.h"
 #include "hdevicehost_configuration.h"
@@ -28,16 +29,21 @@
 #include "hdevicehost_http_server_p.h"
 #include "hdevicehost_ssdp_handler_p.h"
 #include "hdevicehost_runtimestatus_p.h"
+#include "hdescription_loader_p.h"
 #include "hdevicehost_dataretriever_p.h"
+#include "hdiscoveryrequest_limiter_p.h"
 
 #include "hservermodel_creator_p.h"
 
 #include "../../general/hlogger_p.h"
 #include "../../utils/hsysutils_p.h"
+#include "../../utils/hnetworkthread_p.h"
+#include "../../utils/hstallwatchdog_p.h"
 
 #include <ctime>
 
 #include <QtCore/QTimer>
+#include <QtCore/QElapsedTimer>
 
 namespace Herqq
 {
@@ -45,20 +51,59 @@ namespace Herqq
 namespace Upnp
 {
 
+namespace
+{
+// a device is re-advertised at most a tenth of its timeout early
+const qint32 AnnouncementJitterDivisor = 10;
+
+//
+// Runs HDeviceHost::init() in the network thread of the device host
+//
+class InitCall
+{
+private:
+
+    HDeviceHost* m_deviceHost;
+    const HDeviceHostConfiguration* m_config;
+    bool* m_retVal;
+
+public:
+
+    InitCall(
+        HDeviceHost* deviceHost, const HDeviceHostConfiguration* config,
+        bool* retVal) :
+            m_deviceHost(deviceHost), m_config(config), m_retVal(retVal)
+    {
+    }
+
+    void operator()()
+    {
+        *m_retVal = m_deviceHost->init(*m_config);
+    }
+};
+}
+}
+
 /*******************************************************************************
  * HServerDeviceController
  ******************************************************************************/
 HServerDeviceController::HServerDeviceController(
     HServerDevice* device, qint32 deviceTimeoutInSecs, QObject* parent) :
         QObject(parent),
+            m_timedout(false),
+            m_deviceTimeoutInSecs(deviceTimeoutInSecs),
             m_statusNotifier(new QTimer(this)),
             m_deviceStatus(new HDeviceStatus()),
+            m_rootDeviceUsn(device->info().udn(), true),
+            m_usns(),
             m_device(device)
 {
     Q_ASSERT(m_device);
     //m_device->setParent(this);
 
-    m_statusNotifier->setInterval(deviceTimeoutInSecs * 1000);
+    createUsns(m_device);
+
+    m_statusNotifier->setSingleShot(true);
     bool ok = connect(
         m_statusNotifier.data(), SIGNAL(timeout()), this, SLOT(timeout_()));
 
@@ -69,9 +114,45 @@ HServerDeviceController::~HServerDeviceController()
 {
 }
 
+void HServerDeviceController::createUsns(const HServerDevice* device)
+{
+    HDeviceInfo deviceInfo = device->info();
+
+    QList<HDiscoveryType>& usns = m_usns[device];
+
+    HDiscoveryType usn(deviceInfo.udn());
+    usns.append(usn);
+
+    usn.setResourceType(deviceInfo.deviceType());
+    usns.append(usn);
+
+    const HServerServices& services = device->services();
+    foreach(const HServerService* service, services)
+    {
+        usn.setResourceType(service->info().serviceType());
+        usns.append(usn);
+    }
+
+    const HServerDevices& devices = device->embeddedDevices();
+    foreach(const HServerDevice* embeddedDevice, devices)
+    {
+        createUsns(embeddedDevice);
+    }
+}
+
+const QList<HDiscoveryType>& HServerDeviceController::usns(
+    const HServerDevice* device) const
+{
+    QHash<const HServerDevice*, QList<HDiscoveryType> >::const_iterator ci =
+        m_usns.constFind(device);
+
+    Q_ASSERT(ci != m_usns.constEnd());
+    return ci.value();
+}
+
 qint32 HServerDeviceController::deviceTimeoutInSecs() const
 {
-    return m_statusNotifier->interval() / 1000;
+    return m_deviceTimeoutInSecs;
 }
 
 void HServerDeviceController::timeout_()
@@ -85,9 +166,17 @@ void HServerDeviceController::timeout_()
 }
 
 void HServerDeviceController::startStatusNotifier()
+{
+    qint32 timeoutInMsecs = m_deviceTimeoutInSecs * 1000;
+    qint32 maxJitterInMsecs = timeoutInMsecs / AnnouncementJitterDivisor;
+
+    startStatusNotifier(timeoutInMsecs - qrand() % (maxJitterInMsecs + 1));
+}
+
+void HServerDeviceController::startStatusNotifier(qint32 timeoutInMsecs)
 {
     HLOG(H_AT, H_FUN);
-    m_statusNotifier->start();
+    m_statusNotifier->start(qMax(timeoutInMsecs, 1));
     m_timedout = false;
 }
 
@@ -115,12 +204,18 @@ HDeviceHostPrivate::HDeviceHostPrivate() :
         m_httpServer       (0),
         m_eventNotifier    (0),
         m_presenceAnnouncer(0),
+        m_discoveryRequestLimiter(0),
         m_runtimeStatus    (0),
         q_ptr(0),
         m_lastError(HDeviceHost::UndefinedError),
         m_initialized(false),
+        m_deviceConfigurations(),
         m_deviceStorage(m_loggingIdentifier),
-        m_nam(0)
+        m_nam(0),
+        m_fileCache(),
+        m_servicePrototypes(),
+        m_networkThread(0),
+        m_taskScheduler(new HTaskScheduler(this))
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
     qsrand(time(0));
@@ -136,37 +231,29 @@ void HDeviceHostPrivate::announcementTimedout(
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
-    QList<ResourceAvailableAnnouncement> announcements;
-    m_presenceAnnouncer->createAnnouncementMessagesForRootDevice(
-        controller->m_device, controller->deviceTimeoutInSecs(), &announcements);
-
-    m_presenceAnnouncer->sendAnnouncements(announcements);
+    m_presenceAnnouncer->announce<ResourceAvailableAnnouncement>(controller);
 
     controller->startStatusNotifier();
 }
 
-bool HDeviceHostPrivate::createRootDevice(const HDeviceConfiguration* deviceconfig)
+HServerDevice* HDeviceHostPrivate::createDeviceModel(
+    const HDeviceConfiguration* deviceconfig, const QString& deviceDescr,
+    const HParsedServiceDescriptions* serviceDescriptions)
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
     QString baseDir = extractBaseUrl(deviceconfig->pathToDeviceDescription());
 
-    DeviceHostDataRetriever dataRetriever(m_loggingIdentifier, baseDir);
-
-    QString deviceDescr;
-    if (!dataRetriever.retrieveDeviceDescription(
-        deviceconfig->pathToDeviceDescription(), &deviceDescr))
-    {
-        m_lastError = HDeviceHost::InvalidConfigurationError;
-        m_lastErrorDescription = dataRetriever.lastError();
-        return false;
-    }
+    DeviceHostDataRetriever dataRetriever(
+        m_loggingIdentifier, baseDir, &m_fileCache);
 
     HServerModelCreationArgs creatorParams(m_config->deviceModelCreator());
     creatorParams.m_deviceDescription = deviceDescr;
     creatorParams.m_deviceLocations = m_httpServer->rootUrls();
     creatorParams.setDeviceDescriptionPostfix(deviceDescriptionPostFix());
     creatorParams.setInfoProvider(m_config->deviceModelInfoProvider());
+    creatorParams.setParsedServiceDescriptions(serviceDescriptions);
+    creatorParams.setServicePrototypes(&m_servicePrototypes);
 
     creatorParams.m_serviceDescriptionFetcher = ServiceDescriptionFetcher(
         &dataRetriever, &DeviceHostDataRetriever::retrieveServiceDescription);
@@ -182,7 +269,7 @@ bool HDeviceHostPrivate::createRootDevice(const HDeviceConfiguration* deviceconf
     creatorParams.m_loggingIdentifier = m_loggingIdentifier;
 
     HServerModelCreator creator(creatorParams);
-    QScopedPointer<HServerDevice> rootDevice(creator.createRootDevice());
+    HServerDevice* rootDevice = creator.createRootDevice();
 
     if (!rootDevice)
     {
@@ -202,45 +289,123 @@ bool HDeviceHostPrivate::createRootDevice(const HDeviceConfiguration* deviceconf
                 m_lastError = HDeviceHost::UndefinedError;
                 break;
         }
-
-        return false;
     }
 
-    Q_ASSERT(rootDevice);
+    return rootDevice;
+}
+
+HServerDeviceController* HDeviceHostPrivate::addRootDevice(
+    HServerDevice* device, const HDeviceConfiguration* deviceconfig)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    Q_ASSERT(device);
+
+    QScopedPointer<HServerDevice> rootDevice(device);
 
     HServerDeviceController* controller =
         new HServerDeviceController(
-            rootDevice.data(), creatorParams.m_deviceTimeoutInSecs, this);
+            rootDevice.data(), deviceconfig->cacheControlMaxAge() / 2, this);
+    // the same timeout the device model was created with
 
     if (!m_deviceStorage.addRootDevice(rootDevice.data(), controller))
     {
         delete controller;
         m_lastError = HDeviceHost::ResourceConflict;
         m_lastErrorDescription = m_deviceStorage.lastError();
-        return false;
+        return 0;
     }
 
+    m_httpServer->addToDispatchTable(rootDevice.data());
+
     rootDevice->setParent(this);
     connectSelfToServiceSignals(rootDevice.take());
 
-    return true;
+    m_deviceConfigurations.insert(controller, deviceconfig);
+
+    return controller;
 }
 
-bool HDeviceHostPrivate::createRootDevices()
+void HDeviceHostPrivate::removeRootDevice(
+    HServerDeviceController* controller)
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
-    QList<const HDeviceConfiguration*> diParams =
-        m_config->deviceConfigurations();
+    HServerDevice* rootDevice = controller->m_device;
+
+    controller->stopStatusNotifier();
+
+    m_eventNotifier->deviceRemoved(rootDevice);
+    m_presenceAnnouncer->deviceRemoved(rootDevice);
+    m_httpServer->removeFromDispatchTable(rootDevice);
+
+    m_deviceConfigurations.remove(controller);
+
+    // the controller is deleted along with the device
+    m_deviceStorage.removeRootDevice(rootDevice);
+}
+
+HServerDeviceController* HDeviceHostPrivate::createRootDevice(
+    const HDeviceConfiguration* deviceconfig, const QString& deviceDescr,
+    const HParsedServiceDescriptions* serviceDescriptions)
+{
+    HServerDevice* rootDevice =
+        createDeviceModel(deviceconfig, deviceDescr, serviceDescriptions);
+
+    return rootDevice ? addRootDevice(rootDevice, deviceconfig) : 0;
+}
+
+bool HDeviceHostPrivate::createRootDevices(
+    const QList<const HDeviceConfiguration*>& diParams,
+    const QString& snapshotPath)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    // the description files are read and parsed in worker threads, but the
+    // device model is created here, since HDeviceModelCreator creates
+    // objects that have to live in the thread of the device host
+    QElapsedTimer timer;
+    timer.start();
+
+    HDescriptionLoader loader(m_loggingIdentifier, &m_fileCache);
+    if (!loader.load(diParams, snapshotPath))
+    {
+        m_lastError = loader.lastError();
+        m_lastErrorDescription = loader.lastErrorDescription();
+        return false;
+    }
+
+    qint64 loadTime = timer.restart();
 
     foreach(const HDeviceConfiguration* deviceconfig, diParams)
     {
-        if (!createRootDevice(deviceconfig))
+        if (!createRootDevice(
+            deviceconfig, loader.deviceDescription(deviceconfig),
+            loader.serviceDescriptions()))
         {
             return false;
         }
     }
 
+    HLOG_INFO(QString(
+        "Created [%1] root devices. Loading the descriptions took [%2] ms "
+        "and creating the devices took [%3] ms").arg(
+            QString::number(diParams.size()), QString::number(loadTime),
+            QString::number(timer.elapsed())));
+
+    if (!snapshotPath.isEmpty() && !loader.loadedFromSnapshot())
+    {
+        QString err;
+        if (loader.writeSnapshot(snapshotPath, diParams, &err))
+        {
+            HLOG_INFO(QString("Wrote the snapshot [%1]").arg(snapshotPath));
+        }
+        else
+        {
+            HLOG_WARN(err);
+        }
+    }
+
     return true;
 }
 
@@ -268,7 +433,8 @@ void HDeviceHostPrivate::connectSelfToServiceSignals(HServerDevice* device)
     }
 }
 
-void HDeviceHostPrivate::startNotifiers(HServerDeviceController* controller)
+void HDeviceHostPrivate::startNotifiers(
+    HServerDeviceController* controller, qint32 firstTimeoutInMsecs)
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
     Q_ASSERT(controller);
@@ -279,17 +445,115 @@ void HDeviceHostPrivate::startNotifiers(HServerDeviceController* controller)
 
     Q_ASSERT(ok); Q_UNUSED(ok)
 
-    controller->startStatusNotifier();
+    if (firstTimeoutInMsecs < 0)
+    {
+        controller->startStatusNotifier();
+    }
+    else
+    {
+        controller->startStatusNotifier(firstTimeoutInMsecs);
+    }
 }
 
 void HDeviceHostPrivate::startNotifiers()
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
+    // the root devices are announced together when the host starts. their
+    // first re-advertisements are spread evenly over the device timeout,
+    // each in a slot of its own, so that the later re-advertisements do not
+    // form a burst either.
+    QList<HServerDeviceController*> controllers = m_deviceStorage.controllers();
+    for (qint32 i = 0; i < controllers.size(); ++i)
+    {
+        HServerDeviceController* controller = controllers.at(i);
+
+        qint32 slotInMsecs =
+            controller->deviceTimeoutInSecs() * 1000 / controllers.size();
+
+        startNotifiers(
+            controller,
+            slotInMsecs * (i + 1) - qrand() % (slotInMsecs / 2 + 1));
+    }
+}
+
+HDeviceHostSsdpHandler* HDeviceHostPrivate::createSsdpHandler()
+{
+    HDeviceHostSsdpHandler* retVal =
+        new HDeviceHostSsdpHandler(
+            m_loggingIdentifier, m_deviceStorage,
+            m_discoveryRequestLimiter.data(), q_ptr);
+
+    retVal->setReceiveBufferSize(m_config->ssdpReceiveBufferSize());
+    retVal->setSendBufferSize(m_config->ssdpSendBufferSize());
+    retVal->setReceiveThreadEnabled(m_config->ssdpReceiveThreadsEnabled());
+    retVal->setMulticastSharingEnabled(m_config->sharedSsdpEnabled());
+
+    return retVal;
+}
+
+void HDeviceHostPrivate::updateRootDevices(bool nextBootId)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    QList<QUrl> rootUrls = m_httpServer->rootUrls();
+
     QList<HServerDeviceController*> controllers = m_deviceStorage.controllers();
     foreach(HServerDeviceController* controller, controllers)
     {
-        startNotifiers(controller);
+        HServerDevice* device = controller->m_device;
+
+        HServerModelCreator::setLocations(
+            device, rootUrls, deviceDescriptionPostFix());
+
+        if (nextBootId)
+        {
+            HServerModelCreator::setBootId(
+                device, device->deviceStatus().bootId() + 1);
+        }
+    }
+
+    updateSearchPort();
+}
+
+void HDeviceHostPrivate::updateSearchPort()
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    qint32 searchPort = -1;
+    foreach(HDeviceHostSsdpHandler* ssdp, m_ssdps)
+    {
+        quint16 port = ssdp->unicastEndpoint().portNumber();
+        if (port != 1900)
+        {
+            // UDA 1.1 requires the SEARCHPORT.UPNP.ORG in case unicast
+            // M-SEARCH requests are not received on the port 1900
+            searchPort = port;
+            break;
+        }
+    }
+
+    QList<HServerDeviceController*> controllers = m_deviceStorage.controllers();
+    foreach(HServerDeviceController* controller, controllers)
+    {
+        HServerModelCreator::setSearchPort(controller->m_device, searchPort);
+    }
+}
+
+void HDeviceHostPrivate::updateNetworkAddresses()
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    QList<QHostAddress> addrs;
+    foreach(HDeviceHostSsdpHandler* ssdp, m_ssdps)
+    {
+        addrs.append(ssdp->unicastEndpoint().hostAddress());
+    }
+
+    if (!m_config->setNetworkAddressesToUse(addrs))
+    {
+        // some other address in use has disappeared as well
+        HLOG_WARN("Not all the network addresses in use are local addresses");
     }
 }
 
@@ -320,6 +584,13 @@ HDeviceHost::HDeviceHost(QObject* parent) :
 HDeviceHost::~HDeviceHost()
 {
     quit();
+
+    if (h_ptr->m_networkThread)
+    {
+        h_ptr->m_networkThread->release();
+        h_ptr->m_networkThread = 0;
+    }
+
     delete h_ptr;
 }
 
@@ -350,6 +621,11 @@ const HDeviceHostRuntimeStatus* HDeviceHost::runtimeStatus() const
     return h_ptr->m_runtimeStatus.data();
 }
 
+HTaskScheduler* HDeviceHost::taskScheduler() const
+{
+    return h_ptr->m_taskScheduler;
+}
+
 void HDeviceHost::setError(DeviceHostError error, const QString& errorStr)
 {
     HLOG2(H_AT, H_FUN, h_ptr->m_loggingIdentifier);
@@ -362,6 +638,13 @@ bool HDeviceHost::init(const HDeviceHostConfiguration& config)
 {
     HLOG2(H_AT, H_FUN, h_ptr->m_loggingIdentifier);
 
+    if (h_ptr->m_networkThread && thread() != QThread::currentThread())
+    {
+        bool retVal = false;
+        h_ptr->m_networkThread->execute(InitCall(this, &config, &retVal));
+        return retVal;
+    }
+
     Q_ASSERT_X(
         thread() == QThread::currentThread(), H_AT,
         "The device host has to be initialized in the thread in which "
@@ -379,6 +662,24 @@ bool HDeviceHost::init(const HDeviceHostConfiguration& config)
         return false;
     }
 
+    if (config.networkThreadEnabled() && !h_ptr->m_networkThread)
+    {
+        HNetworkThread* networkThread = new HNetworkThread(this);
+        if (!networkThread->attach())
+        {
+            delete networkThread;
+            setError(
+                InvalidConfigurationError,
+                "A device host that has a parent cannot be run in "
+                "a network thread");
+
+            return false;
+        }
+
+        h_ptr->m_networkThread = networkThread;
+        return init(config);
+    }
+
     bool ok = false;
     HLOG_INFO("DeviceHost Initializing.");
 
@@ -397,6 +698,21 @@ bool HDeviceHost::init(const HDeviceHostConfiguration& config)
             h_ptr->m_deviceStorage,
             *h_ptr->m_eventNotifier, this));
 
+    h_ptr->m_httpServer->setWorkerThreadCount(config.httpWorkerThreadCount());
+    h_ptr->m_httpServer->setListenersPerEndpoint(
+        config.httpListenersPerEndpoint());
+    h_ptr->m_httpServer->setActionThreadCount(config.actionThreadCount());
+    h_ptr->m_httpServer->setMaxBytesToLoad(config.maxHttpRequestBodySize());
+    h_ptr->m_httpServer->setMaxConnectionsPerEndpoint(
+        config.maxHttpConnectionsPerEndpoint());
+    h_ptr->m_httpServer->setMaxConnectionsPerPeer(
+        config.maxHttpConnectionsPerPeer());
+    h_ptr->m_httpServer->setMaxQueuedWriteBytes(
+        config.maxHttpQueuedWriteBytes());
+    h_ptr->m_httpServer->setMetrics(
+        config.metricsPath(), h_ptr->m_runtimeStatus.data());
+    h_ptr->m_httpServer->setStallThreshold(config.stallThreshold());
+
     QList<QHostAddress> addrs = config.networkAddressesToUse();
     if (!h_ptr->m_httpServer->init(convertHostAddressesToEndpoints(addrs)))
     {
@@ -405,17 +721,21 @@ bool HDeviceHost::init(const HDeviceHostConfiguration& config)
     }
     else
     {
-         if (!h_ptr->createRootDevices())
+         if (!h_ptr->createRootDevices(
+                 h_ptr->m_config->deviceConfigurations(),
+                 h_ptr->m_config->snapshotPath()))
          {
              goto err;
          }
 
+        h_ptr->m_discoveryRequestLimiter.reset(
+            new HDiscoveryRequestLimiter(
+                config.maxDiscoveryRequestsPerSource(),
+                config.maxDiscoveryRequests()));
+
         foreach(const QHostAddress& ha, addrs)
         {
-            HDeviceHostSsdpHandler* ssdp =
-                new HDeviceHostSsdpHandler(
-                    h_ptr->m_loggingIdentifier, h_ptr->m_deviceStorage, this);
-
+            HDeviceHostSsdpHandler* ssdp = h_ptr->createSsdpHandler();
             h_ptr->m_ssdps.append(ssdp);
 
             if (!ssdp->init(ha))
@@ -425,10 +745,14 @@ bool HDeviceHost::init(const HDeviceHostConfiguration& config)
             }
         }
 
+        h_ptr->updateSearchPort();
+
         h_ptr->m_presenceAnnouncer.reset(
             new PresenceAnnouncer(
+                h_ptr->m_loggingIdentifier,
                 h_ptr->m_ssdps,
-                h_ptr->m_config->individualAdvertisementCount()));
+                h_ptr->m_config->individualAdvertisementCount(),
+                h_ptr->m_config->maxAnnouncementRate()));
 
         // allow the derived classes to perform their initialization routines
         // before the hosted devices are announced to the network and timers
@@ -472,6 +796,14 @@ void HDeviceHost::quit()
 {
     HLOG2(H_AT, H_FUN, h_ptr->m_loggingIdentifier);
 
+    if (h_ptr->m_networkThread && thread() != QThread::currentThread())
+    {
+        h_ptr->m_networkThread->execute(
+            Functor<void>(this, &HDeviceHost::quit));
+
+        return;
+    }
+
     Q_ASSERT_X(
         thread() == QThread::currentThread(), H_AT,
         "The device host has to be shutdown in the thread in which it is "
@@ -500,11 +832,16 @@ void HDeviceHost::quit()
     qDeleteAll(h_ptr->m_ssdps);
     h_ptr->m_ssdps.clear();
 
+    h_ptr->m_discoveryRequestLimiter.reset(0);
+
     h_ptr->m_httpServer.reset(0);
     h_ptr->m_eventNotifier.reset(0);
     h_ptr->m_config.reset(0);
 
+    h_ptr->m_deviceConfigurations.clear();
     h_ptr->m_deviceStorage.clear();
+    h_ptr->m_fileCache.clear();
+    h_ptr->m_servicePrototypes.clear();
 
     HLOG_INFO("Shut down.");
 }
@@ -529,17 +866,346 @@ bool HDeviceHost::add(const HDeviceConfiguration& configuration)
         return false;
     }
 
-    bool b = h_ptr->createRootDevice(&configuration);
-    if (b)
+    h_ptr->m_config->add(configuration);
+    const HDeviceConfiguration* stored =
+        h_ptr->m_config->deviceConfigurations().last();
+
+    QList<const HDeviceConfiguration*> configurations;
+    configurations.append(stored);
+
+    if (!h_ptr->createRootDevices(configurations))
+    {
+        h_ptr->m_config->remove(stored);
+        return false;
+    }
+
+    HServerDeviceController* newController =
+        h_ptr->m_deviceStorage.controllers().last();
+
+    h_ptr->updateSearchPort();
+
+    h_ptr->m_presenceAnnouncer->announce<ResourceAvailableAnnouncement>(
+        newController);
+
+    h_ptr->startNotifiers(newController);
+
+    return true;
+}
+
+bool HDeviceHost::remove(const HUdn& udn)
+{
+    HLOG2(H_AT, H_FUN, h_ptr->m_loggingIdentifier);
+
+    if (!isStarted())
+    {
+        setError(NotStarted, "The device host is not started");
+        return false;
+    }
+
+    HServerDevice* rootDevice =
+        h_ptr->m_deviceStorage.searchDeviceByUdn(udn, RootDevices);
+
+    if (!rootDevice)
+    {
+        setError(
+            InvalidConfigurationError,
+            QString("No root device with the UDN [%1] is hosted").arg(
+                udn.toString()));
+
+        return false;
+    }
+    else if (h_ptr->m_httpServer->hasPendingInvocations(rootDevice))
+    {
+        setError(
+            ResourceConflict,
+            "The device has action invocations in progress");
+
+        return false;
+    }
+
+    HServerDeviceController* controller =
+        h_ptr->m_deviceStorage.getController(rootDevice);
+
+    const HDeviceConfiguration* config =
+        h_ptr->m_deviceConfigurations.value(controller);
+
+    // only the removed device says byebye, the others are not affected
+    h_ptr->m_presenceAnnouncer->announce<ResourceUnavailableAnnouncement>(
+        controller);
+
+    h_ptr->removeRootDevice(controller);
+    h_ptr->m_config->remove(config);
+
+    HLOG_INFO(QString("Removed root device [%1]").arg(udn.toString()));
+
+    return true;
+}
+
+bool HDeviceHost::update(const HDeviceConfiguration& configuration)
+{
+    HLOG2(H_AT, H_FUN, h_ptr->m_loggingIdentifier);
+
+    if (!isStarted())
+    {
+        setError(NotStarted, "The device host is not started");
+        return false;
+    }
+    else if (!configuration.isValid())
+    {
+        setError(InvalidConfigurationError, "The provided configuration is not valid");
+        return false;
+    }
+
+    QList<const HDeviceConfiguration*> configurations;
+    configurations.append(&configuration);
+
+    HDescriptionLoader loader(h_ptr->m_loggingIdentifier, &h_ptr->m_fileCache);
+    if (!loader.load(configurations, QString()))
+    {
+        setError(loader.lastError(), loader.lastErrorDescription());
+        return false;
+    }
+
+    // the new model is created before the old one is touched, so that an
+    // invalid description leaves the hosted device as it was
+    QScopedPointer<HServerDevice> newDevice(h_ptr->createDeviceModel(
+        &configuration, loader.deviceDescription(&configuration),
+        loader.serviceDescriptions()));
+
+    if (!newDevice)
+    {
+        return false;
+    }
+
+    HUdn udn = newDevice->info().udn();
+
+    HServerDevice* oldDevice =
+        h_ptr->m_deviceStorage.searchDeviceByUdn(udn, RootDevices);
+
+    if (!oldDevice)
+    {
+        setError(
+            InvalidConfigurationError,
+            QString("No root device with the UDN [%1] is hosted").arg(
+                udn.toString()));
+
+        return false;
+    }
+    else if (h_ptr->m_httpServer->hasPendingInvocations(oldDevice))
+    {
+        setError(
+            ResourceConflict,
+            "The device has action invocations in progress");
+
+        return false;
+    }
+
+    HServerDeviceController* oldController =
+        h_ptr->m_deviceStorage.getController(oldDevice);
+
+    const HDeviceConfiguration* oldConfig =
+        h_ptr->m_deviceConfigurations.value(oldController);
+
+    qint32 bootId = oldDevice->deviceStatus().bootId() + 1;
+    qint32 configId = oldDevice->deviceStatus().configId() + 1;
+
+    // the next boot ID is announced with ssdp:update for this device only.
+    // after that the device is replaced and announced again with its
+    // new boot ID and config ID
+    h_ptr->m_presenceAnnouncer->announce<ResourceUpdateAnnouncement>(
+        oldController);
+
+    h_ptr->removeRootDevice(oldController);
+    h_ptr->m_config->remove(oldConfig);
+
+    h_ptr->m_config->add(configuration);
+    const HDeviceConfiguration* stored =
+        h_ptr->m_config->deviceConfigurations().last();
+
+    HServerModelCreator::setBootId(newDevice.data(), bootId);
+    HServerModelCreator::setConfigId(newDevice.data(), configId);
+
+    HServerDeviceController* newController =
+        h_ptr->addRootDevice(newDevice.take(), stored);
+
+    if (!newController)
+    {
+        // the UDN was just freed, so this should not happen
+        h_ptr->m_config->remove(stored);
+        return false;
+    }
+
+    h_ptr->updateSearchPort();
+
+    h_ptr->m_presenceAnnouncer->announce<ResourceAvailableAnnouncement>(
+        newController);
+
+    h_ptr->startNotifiers(newController);
+
+    HLOG_INFO(QString("Updated root device [%1] to config ID [%2]").arg(
+        udn.toString(), QString::number(configId)));
+
+    return true;
+}
+
+bool HDeviceHost::addNetworkAddress(const QHostAddress& address)
+{
+    HLOG2(H_AT, H_FUN, h_ptr->m_loggingIdentifier);
+
+    if (!isStarted())
+    {
+        setError(NotStarted, "The device host is not started");
+        return false;
+    }
+
+    foreach(HDeviceHostSsdpHandler* ssdp, h_ptr->m_ssdps)
+    {
+        if (ssdp->unicastEndpoint().hostAddress() == address)
+        {
+            setError(ResourceConflict, "The network address is already in use");
+            return false;
+        }
+    }
+
+    if (!HSysInfo::instance().areLocalAddresses(
+            QList<QHostAddress>() << address))
+    {
+        setError(
+            InvalidConfigurationError,
+            "The provided address is not a local network address");
+
+        return false;
+    }
+
+    if (!h_ptr->m_httpServer->addEndpoint(HEndpoint(address)))
     {
-        HServerDeviceController* newController =
-            h_ptr->m_deviceStorage.controllers().last();
+        setError(CommunicationsError, "Failed to bind the HTTP server");
+        return false;
+    }
 
-        h_ptr->m_config->add(configuration);
-        h_ptr->m_presenceAnnouncer->announce<ResourceAvailableAnnouncement>(newController);
-        h_ptr->startNotifiers(newController);
+    HDeviceHostSsdpHandler* ssdp = h_ptr->createSsdpHandler();
+    if (!ssdp->init(address))
+    {
+        delete ssdp;
+        h_ptr->m_httpServer->removeEndpoint(address);
+
+        setError(CommunicationsError, "Failed to initialize SSDP");
+        return false;
     }
-    return b;
+
+    HLOG_INFO(QString("Starting to use network address %1").arg(
+        address.toString()));
+
+    QList<HServerDeviceController*> controllers =
+        h_ptr->m_deviceStorage.controllers();
+
+    // the next boot ID is announced on the networks the devices are on,
+    // after which the devices are announced with it on every network
+    h_ptr->m_presenceAnnouncer->announce<ResourceUpdateAnnouncement>(
+        controllers);
+
+    h_ptr->m_ssdps.append(ssdp);
+    h_ptr->m_presenceAnnouncer->setSsdps(h_ptr->m_ssdps);
+
+    h_ptr->updateRootDevices(true);
+    h_ptr->updateNetworkAddresses();
+
+    h_ptr->m_presenceAnnouncer->announce<ResourceAvailableAnnouncement>(
+        controllers);
+
+    return true;
+}
+
+bool HDeviceHost::removeNetworkAddress(const QHostAddress& address)
+{
+    HLOG2(H_AT, H_FUN, h_ptr->m_loggingIdentifier);
+
+    if (!isStarted())
+    {
+        setError(NotStarted, "The device host is not started");
+        return false;
+    }
+
+    HDeviceHostSsdpHandler* ssdp = 0;
+    foreach(HDeviceHostSsdpHandler* handler, h_ptr->m_ssdps)
+    {
+        if (handler->unicastEndpoint().hostAddress() == address)
+        {
+            ssdp = handler;
+            break;
+        }
+    }
+
+    if (!ssdp)
+    {
+        setError(InvalidConfigurationError, "The network address is not in use");
+        return false;
+    }
+    else if (h_ptr->m_ssdps.size() == 1)
+    {
+        setError(
+            InvalidConfigurationError,
+            "The last network address cannot be removed");
+
+        return false;
+    }
+
+    HLOG_INFO(QString("Stopping to use network address %1").arg(
+        address.toString()));
+
+    h_ptr->m_ssdps.removeOne(ssdp);
+    h_ptr->m_presenceAnnouncer->setSsdps(h_ptr->m_ssdps);
+    delete ssdp;
+
+    h_ptr->m_httpServer->removeEndpoint(address);
+    h_ptr->m_eventNotifier->networkAddressRemoved(address);
+
+    // the devices keep their boot ID, since they do not start to use any
+    // new network interface
+    h_ptr->updateRootDevices(false);
+    h_ptr->updateNetworkAddresses();
+
+    return true;
+}
+
+bool HDeviceHost::writeSnapshot(
+    const HDeviceHostConfiguration& configuration, QString* errorDescription)
+{
+    HLOG(H_AT, H_FUN);
+
+    QString err;
+    if (!configuration.isValid())
+    {
+        err = "The provided configuration is not valid";
+    }
+    else if (configuration.snapshotPath().isEmpty())
+    {
+        err = "The provided configuration does not specify a snapshot path";
+    }
+    else
+    {
+        HDeviceHostFileCache cache;
+        HDescriptionLoader loader("__DEVICE HOST SNAPSHOT__: ", &cache);
+
+        QList<const HDeviceConfiguration*> configurations =
+            configuration.deviceConfigurations();
+
+        if (!loader.load(configurations))
+        {
+            err = loader.lastErrorDescription();
+        }
+        else if (loader.writeSnapshot(
+            configuration.snapshotPath(), configurations, &err))
+        {
+            return true;
+        }
+    }
+
+    if (errorDescription)
+    {
+        *errorDescription = err;
+    }
+    return false;
 }
 
 HServerDevices HDeviceHost::rootDevices() const
@@ -607,5 +1273,246 @@ QList<HEndpoint> HDeviceHostRuntimeStatus::httpEndpoints() const
     return h_ptr->m_deviceHost->h_ptr->m_httpServer->endpoints();
 }
 
+qint64 HDeviceHostRuntimeStatus::duplicateDiscoveryRequests() const
+{
+    Q_ASSERT(h_ptr->m_deviceHost);
+    HDiscoveryRequestLimiter* limiter =
+        h_ptr->m_deviceHost->h_ptr->m_discoveryRequestLimiter.data();
+
+    return limiter ? limiter->duplicateRequests() : 0;
+}
+
+qint64 HDeviceHostRuntimeStatus::sourceRateLimitedDiscoveryRequests() const
+{
+    Q_ASSERT(h_ptr->m_deviceHost);
+    HDiscoveryRequestLimiter* limiter =
+        h_ptr->m_deviceHost->h_ptr->m_discoveryRequestLimiter.data();
+
+    return limiter ? limiter->sourceLimitedRequests() : 0;
+}
+
+qint64 HDeviceHostRuntimeStatus::globalRateLimitedDiscoveryRequests() const
+{
+    Q_ASSERT(h_ptr->m_deviceHost);
+    HDiscoveryRequestLimiter* limiter =
+        h_ptr->m_deviceHost->h_ptr->m_discoveryRequestLimiter.data();
+
+    return limiter ? limiter->globalLimitedRequests() : 0;
+}
+
+qint32 HDeviceHostRuntimeStatus::lastAnnouncementBurstSize() const
+{
+    Q_ASSERT(h_ptr->m_deviceHost);
+    PresenceAnnouncer* announcer =
+        h_ptr->m_deviceHost->h_ptr->m_presenceAnnouncer.data();
+
+    return announcer ? announcer->lastBurstSize() : 0;
+}
+
+qint32 HDeviceHostRuntimeStatus::largestAnnouncementBurstSize() const
+{
+    Q_ASSERT(h_ptr->m_deviceHost);
+    PresenceAnnouncer* announcer =
+        h_ptr->m_deviceHost->h_ptr->m_presenceAnnouncer.data();
+
+    return announcer ? announcer->largestBurstSize() : 0;
+}
+
+qint64 HDeviceHostRuntimeStatus::mergedEventNotifications() const
+{
+    Q_ASSERT(h_ptr->m_deviceHost);
+    HEventNotifier* notifier =
+        h_ptr->m_deviceHost->h_ptr->m_eventNotifier.data();
+
+    return notifier ? notifier->delivery().mergedNotifications() : 0;
+}
+
+qint64 HDeviceHostRuntimeStatus::droppedEventSubscribers() const
+{
+    Q_ASSERT(h_ptr->m_deviceHost);
+    HEventNotifier* notifier =
+        h_ptr->m_deviceHost->h_ptr->m_eventNotifier.data();
+
+    return notifier ? notifier->delivery().droppedSubscribers() : 0;
+}
+
+qint32 HDeviceHostRuntimeStatus::eventDeliveryLatency(qint32 percentile) const
+{
+    Q_ASSERT(h_ptr->m_deviceHost);
+    HEventNotifier* notifier =
+        h_ptr->m_deviceHost->h_ptr->m_eventNotifier.data();
+
+    return notifier ? notifier->delivery().latencyPercentile(percentile) : -1;
+}
+
+qint64 HDeviceHostRuntimeStatus::ssdpMessagesReceived(
+    HSsdp::AllowedMessage type) const
+{
+    Q_ASSERT(h_ptr->m_deviceHost);
+
+    qint64 retVal = 0;
+    foreach(HDeviceHostSsdpHandler* ssdp, h_ptr->m_deviceHost->h_ptr->m_ssdps)
+    {
+        retVal += ssdp->messagesReceived(type);
+    }
+    return retVal;
+}
+
+qint64 HDeviceHostRuntimeStatus::ssdpMessagesSent(
+    HSsdp::AllowedMessage type) const
+{
+    Q_ASSERT(h_ptr->m_deviceHost);
+
+    qint64 retVal = 0;
+    foreach(HDeviceHostSsdpHandler* ssdp, h_ptr->m_deviceHost->h_ptr->m_ssdps)
+    {
+        retVal += ssdp->messagesSent(type);
+    }
+    return retVal;
+}
+
+qint64 HDeviceHostRuntimeStatus::ssdpDatagramsDropped(
+    HSsdp::DropReason reason) const
+{
+    Q_ASSERT(h_ptr->m_deviceHost);
+
+    qint64 retVal = -1;
+    foreach(HDeviceHostSsdpHandler* ssdp, h_ptr->m_deviceHost->h_ptr->m_ssdps)
+    {
+        qint64 dropped = ssdp->droppedDatagrams(reason);
+        if (dropped >= 0)
+        {
+            retVal = qMax(retVal, Q_INT64_C(0)) + dropped;
+        }
+    }
+    return retVal;
+}
+
+qint64 HDeviceHostRuntimeStatus::httpRequests(const QString& method) const
+{
+    Q_ASSERT(h_ptr->m_deviceHost);
+    HDeviceHostHttpServer* server =
+        h_ptr->m_deviceHost->h_ptr->m_httpServer.data();
+
+    return server ?
+        server->statistics().m_requests.value(method.toUpper()) : 0;
+}
+
+qint32 HDeviceHostRuntimeStatus::openConnections() const
+{
+    Q_ASSERT(h_ptr->m_deviceHost);
+    HDeviceHostHttpServer* server =
+        h_ptr->m_deviceHost->h_ptr->m_httpServer.data();
+
+    return server ? server->statistics().m_openConnections : 0;
+}
+
+QStringList HDeviceHostRuntimeStatus::invokedActions() const
+{
+    Q_ASSERT(h_ptr->m_deviceHost);
+    HDeviceHostHttpServer* server =
+        h_ptr->m_deviceHost->h_ptr->m_httpServer.data();
+
+    return server ? server->actionStatistics().keys() : QStringList();
+}
+
+qint64 HDeviceHostRuntimeStatus::actionInvocations(
+    const QString& actionName) const
+{
+    Q_ASSERT(h_ptr->m_deviceHost);
+    HDeviceHostHttpServer* server =
+        h_ptr->m_deviceHost->h_ptr->m_httpServer.data();
+
+    return server ?
+        server->actionStatistics().value(actionName).m_latencies.count() : 0;
+}
+
+qint64 HDeviceHostRuntimeStatus::failedActionInvocations(
+    const QString& actionName) const
+{
+    Q_ASSERT(h_ptr->m_deviceHost);
+    HDeviceHostHttpServer* server =
+        h_ptr->m_deviceHost->h_ptr->m_httpServer.data();
+
+    return server ?
+        server->actionStatistics().value(actionName).m_failures : 0;
+}
+
+qint32 HDeviceHostRuntimeStatus::actionLatency(
+    const QString& actionName, qint32 percentile) const
+{
+    Q_ASSERT(h_ptr->m_deviceHost);
+    HDeviceHostHttpServer* server =
+        h_ptr->m_deviceHost->h_ptr->m_httpServer.data();
+
+    if (!server)
+    {
+        return -1;
+    }
+
+    QHash<QString, HActionStatistics>::const_iterator it =
+        server->actionStatistics().constFind(actionName);
+
+    return it != server->actionStatistics().constEnd() ?
+        it->m_latencies.percentile(percentile) : -1;
+}
+
+qint64 HDeviceHostRuntimeStatus::sentEventNotifications() const
+{
+    Q_ASSERT(h_ptr->m_deviceHost);
+    HEventNotifier* notifier =
+        h_ptr->m_deviceHost->h_ptr->m_eventNotifier.data();
+
+    return notifier ? notifier->delivery().deliveredNotifications() : 0;
+}
+
+qint64 HDeviceHostRuntimeStatus::failedEventNotifications() const
+{
+    Q_ASSERT(h_ptr->m_deviceHost);
+    HEventNotifier* notifier =
+        h_ptr->m_deviceHost->h_ptr->m_eventNotifier.data();
+
+    return notifier ? notifier->delivery().failedNotifications() : 0;
+}
+
+qint32 HDeviceHostRuntimeStatus::activeSubscriptions() const
+{
+    Q_ASSERT(h_ptr->m_deviceHost);
+    HEventNotifier* notifier =
+        h_ptr->m_deviceHost->h_ptr->m_eventNotifier.data();
+
+    return notifier ? notifier->activeSubscriberCount() : 0;
+}
+
+QStringList HDeviceHostRuntimeStatus::stalledHandlers() const
+{
+    Q_ASSERT(h_ptr->m_deviceHost);
+    HDeviceHostHttpServer* server =
+        h_ptr->m_deviceHost->h_ptr->m_httpServer.data();
+
+    return server ? server->stallWatchdog()->stalls().keys() : QStringList();
+}
+
+qint64 HDeviceHostRuntimeStatus::handlerStalls(const QString& handler) const
+{
+    Q_ASSERT(h_ptr->m_deviceHost);
+    HDeviceHostHttpServer* server =
+        h_ptr->m_deviceHost->h_ptr->m_httpServer.data();
+
+    return server ?
+        server->stallWatchdog()->stalls().value(handler).m_count : 0;
+}
+
+qint32 HDeviceHostRuntimeStatus::worstHandlerStall(
+    const QString& handler) const
+{
+    Q_ASSERT(h_ptr->m_deviceHost);
+    HDeviceHostHttpServer* server =
+        h_ptr->m_deviceHost->h_ptr->m_httpServer.data();
+
+    return server ?
+        server->stallWatchdog()->stalls().value(handler).m_worst : 0;
+}
+
 }
 }
@@ -23,8 +23,12 @@
 #define HDEVICEHOST_H_
 
 #include <HUpnpCore/HUpnp>
+#include <HUpnpCore/HSsdp>
 
 #include <QtCore/QObject>
+#include <QtCore/QStringList>
+
+class QHostAddress;
 
 namespace Herqq
 {
@@ -193,6 +197,10 @@ class HDeviceHostPrivate;
  * the device host and every object managed by it to be moved to the chosen thread.
  * However, you cannot move individual objects managed by \c %HDeviceHost.
  *
+ * \li When HDeviceHostConfiguration::setNetworkThreadEnabled() is set, the
+ * device host moves itself into an internal network thread upon init().
+ * In that case init(), quit() and the destructor can be called from any thread.
+ *
  * \li \c %HDeviceHost is the owner of the instances of
  * \c %HServerDevice it manages. It manages the memory of every object it has created.
  * In other words, a device host \b never transfers the ownership of the
@@ -434,6 +442,30 @@ public:
      */
     HServerDevices rootDevices() const;
 
+    /*!
+     * \brief Returns the scheduler that runs long operations in the thread of
+     * the device host.
+     *
+     * Work that would otherwise keep the thread of the device host busy for
+     * a long time, such as adding a large number of objects to a data
+     * source, can be split into steps and scheduled here. The steps are run
+     * in short slices between the network events of the device host, which
+     * means that the discovery requests and the control requests are
+     * answered in time while the work is in progress.
+     *
+     * \return The scheduler of the device host.
+     *
+     * \remarks
+     * \li The scheduler is created when the device host is created and it
+     * runs regardless of whether the device host is initialized.
+     * \li In case the device host runs in a thread of its own, the tasks are
+     * run in that thread as well.
+     * \li The ownership of the scheduler is \b never transferred.
+     *
+     * \sa HTaskScheduler
+     */
+    HTaskScheduler* taskScheduler() const;
+
     /*!
      * Initializes the device host and the devices it is supposed to host.
      *
@@ -484,13 +516,140 @@ public:
      * returns \e false, you can call error() and errorDescription() to get
      * more information of the error that occurred.
      *
-     * \remarks The specified device configuration has to be compatible with
+     * \remarks
+     * \li The specified device configuration has to be compatible with
      * the specified HDeviceHostConfiguration specified in init().
+     * \li Only the new device is announced. The other hosted devices
+     * are not affected.
      *
-     * \sa error(), errorDescription()
+     * \sa remove(), update(), error(), errorDescription()
      */
     bool add(const HDeviceConfiguration& configuration);
 
+    /*!
+     * Removes a root device from the device host.
+     *
+     * The device host announces that the device and its embedded devices
+     * and services are no longer available, stops serving them and deletes
+     * the device model. The configuration of the device is removed from
+     * the configuration of the device host as well.
+     *
+     * \param udn specifies the UDN of the root device to remove.
+     *
+     * \return \e true if the device was removed. If the method
+     * returns \e false, you can call error() and errorDescription() to get
+     * more information of the error that occurred.
+     *
+     * \remarks
+     * \li The device is not removed in case an action of it is being
+     * invoked. In that case the error is HDeviceHost::ResourceConflict
+     * and the call can be retried later.
+     * \li The other hosted devices are not affected and nothing is
+     * announced about them.
+     *
+     * \sa add(), update(), error(), errorDescription()
+     */
+    bool remove(const HUdn& udn);
+
+    /*!
+     * Replaces a root device with one created from a new configuration.
+     *
+     * The device that has the UDN specified in the new device description
+     * is replaced. The device host announces the next boot ID of the device
+     * with \c ssdp:update, replaces the device model and then announces
+     * the new device with its increased boot ID and config ID, so that
+     * control points know to fetch the new description.
+     *
+     * \param configuration specifies the new configuration of the device.
+     *
+     * \return \e true if the device was replaced. If the method
+     * returns \e false, the old device is left as it was and you can call
+     * error() and errorDescription() to get more information of the error that
+     * occurred.
+     *
+     * \remarks
+     * \li The event subscriptions to the services of the old device are
+     * dropped and the subscribers have to subscribe again.
+     * \li The device is not replaced in case an action of it is being
+     * invoked. In that case the error is HDeviceHost::ResourceConflict.
+     * \li Only the updated device is announced. The other hosted devices
+     * are not affected.
+     *
+     * \sa add(), remove(), error(), errorDescription()
+     */
+    bool update(const HDeviceConfiguration& configuration);
+
+    /*!
+     * \brief Starts to use another network address without restarting the
+     * device host.
+     *
+     * The HTTP server and an SSDP socket are bound to the address and the
+     * root devices get a location on it. As UDA 1.1 requires when a device
+     * starts to use another network interface, the devices first announce
+     * the boot ID they are about to use with \c ssdp:update messages on the
+     * networks they already are on, after which the devices are announced
+     * with the new boot ID on every network. The devices, their state and
+     * the event subscriptions are left intact.
+     *
+     * \param address specifies the local network address to take into use.
+     *
+     * \return \e true in case the address was taken into use. If the method
+     * returns \e false, you can call error() and errorDescription() to get
+     * more information of the error that occurred.
+     *
+     * \sa removeNetworkAddress(), HDeviceHostConfiguration::networkAddressesToUse()
+     */
+    bool addNetworkAddress(const QHostAddress& address);
+
+    /*!
+     * \brief Stops using a network address without restarting the device host.
+     *
+     * The HTTP server and the SSDP socket bound to the address are closed and
+     * the locations of the root devices on the address are removed. The
+     * connections accepted through the address are served until they are
+     * closed. No \c ssdp:byebye messages are sent, since they would announce
+     * the devices unavailable on every network. Instead, the announcements the
+     * control points received through the address are left to expire.
+     *
+     * \param address specifies the network address to stop using. The last
+     * network address of the device host cannot be removed.
+     *
+     * \return \e true in case the address is no longer used. If the method
+     * returns \e false, you can call error() and errorDescription() to get
+     * more information of the error that occurred.
+     *
+     * \sa addNetworkAddress()
+     */
+    bool removeNetworkAddress(const QHostAddress& address);
+
+    /*!
+     * \brief Writes a snapshot of the description files of the devices of
+     * the specified configuration.
+     *
+     * The snapshot is written to HDeviceHostConfiguration::snapshotPath().
+     * This can be used to create the snapshot in advance, for instance when
+     * the description files are installed, in which case the first call to
+     * init() does not have to read and parse the description files either.
+     * The icons of the devices are not included in a snapshot written with
+     * this method, but they are read from their files when needed.
+     *
+     * \param configuration specifies the configuration of the devices.
+     *
+     * \param errorDescription specifies a pointer to a \c QString that
+     * receives a description of the error in case the snapshot could not be
+     * written. This is optional.
+     *
+     * \return \e true in case the snapshot was written.
+     *
+     * \sa HDeviceHostConfiguration::setSnapshotPath()
+     *
+     * \remarks This method does not need an instance of HDeviceHost and it
+     * does not use the network.
+     */
+    static bool writeSnapshot(
+        const HDeviceHostConfiguration& configuration,
+        QString* errorDescription = 0);
+
 public Q_SLOTS:
 
     /*!
@@ -558,6 +717,299 @@ public:
      * \return The IP endpoints that the device host uses for HTTP communications.
      */
     QList<HEndpoint> httpEndpoints() const;
+
+    /*!
+     * \brief Returns the number of discovery requests the device host has
+     * ignored because they repeated an earlier request within its
+     * response window.
+     *
+     * \return The number of discovery requests the device host has
+     * ignored as repetitions.
+     */
+    qint64 duplicateDiscoveryRequests() const;
+
+    /*!
+     * \brief Returns the number of discovery requests the device host has
+     * ignored because their requestors exceeded the per-requestor rate limit.
+     *
+     * \return The number of discovery requests the device host has
+     * ignored because of the per-requestor rate limit.
+     *
+     * \sa HDeviceHostConfiguration::setMaxDiscoveryRequestsPerSource()
+     */
+    qint64 sourceRateLimitedDiscoveryRequests() const;
+
+    /*!
+     * \brief Returns the number of discovery requests the device host has
+     * ignored because the total rate limit was exceeded.
+     *
+     * \return The number of discovery requests the device host has
+     * ignored because of the total rate limit.
+     *
+     * \sa HDeviceHostConfiguration::setMaxDiscoveryRequests()
+     */
+    qint64 globalRateLimitedDiscoveryRequests() const;
+
+    /*!
+     * \brief Returns the number of presence announcements the device host
+     * sent at once in its latest announcement.
+     *
+     * The number includes the repetitions of each announcement and the
+     * announcements sent to every network the device host uses.
+     *
+     * \return The number of presence announcements the device host
+     * sent at once in its latest announcement.
+     *
+     * \sa largestAnnouncementBurstSize(),
+     * HDeviceHostConfiguration::setMaxAnnouncementRate()
+     */
+    qint32 lastAnnouncementBurstSize() const;
+
+    /*!
+     * \brief Returns the largest number of presence announcements the
+     * device host has sent at once.
+     *
+     * \return The largest number of presence announcements the
+     * device host has sent at once.
+     *
+     * \sa lastAnnouncementBurstSize(),
+     * HDeviceHostConfiguration::setMaxAnnouncementRate()
+     */
+    qint32 largestAnnouncementBurstSize() const;
+
+    /*!
+     * \brief Returns the number of event notifications the device host has
+     * merged into later notifications because the subscribers did not
+     * receive them fast enough.
+     *
+     * \return The number of event notifications the device host has
+     * merged into later notifications.
+     */
+    qint64 mergedEventNotifications() const;
+
+    /*!
+     * \brief Returns the number of event subscribers the device host has
+     * dropped because of repeated delivery failures.
+     *
+     * \return The number of event subscribers the device host has
+     * dropped because of repeated delivery failures.
+     */
+    qint64 droppedEventSubscribers() const;
+
+    /*!
+     * \brief Returns the specified percentile of the time it has taken to
+     * deliver the latest event notifications.
+     *
+     * The delivery time of a notification is measured from the moment the
+     * device host starts sending it to the moment the subscriber has
+     * acknowledged it.
+     *
+     * \param percentile specifies the percentile, which is a value
+     * between 0 and 100. For instance, 50 returns the median and 99 the
+     * delivery time that is exceeded by one notification in a hundred.
+     *
+     * \return The specified percentile of the delivery time in milliseconds,
+     * or -1 in case no event notification has been delivered.
+     */
+    qint32 eventDeliveryLatency(qint32 percentile) const;
+
+    /*!
+     * \brief Returns the number of SSDP messages of the specified type the
+     * device host has received.
+     *
+     * \param type specifies the message type. The value has to be a single
+     * message type.
+     *
+     * \return The number of SSDP messages of the specified type the device
+     * host has received on every network it uses.
+     *
+     * \sa ssdpMessagesSent(), HSsdp::messagesReceived()
+     */
+    qint64 ssdpMessagesReceived(HSsdp::AllowedMessage type) const;
+
+    /*!
+     * \brief Returns the number of SSDP messages of the specified type the
+     * device host has sent.
+     *
+     * The number of the responses sent to discovery requests is returned
+     * when \a type is HSsdp::DiscoveryResponse.
+     *
+     * \param type specifies the message type. The value has to be a single
+     * message type.
+     *
+     * \return The number of SSDP messages of the specified type the device
+     * host has sent on every network it uses.
+     *
+     * \sa ssdpMessagesReceived(), HSsdp::messagesSent()
+     */
+    qint64 ssdpMessagesSent(HSsdp::AllowedMessage type) const;
+
+    /*!
+     * \brief Returns the number of received SSDP datagrams the device host
+     * dropped for the specified reason.
+     *
+     * \param reason specifies the reason the datagrams were dropped.
+     *
+     * \return The number of SSDP datagrams dropped for the specified reason
+     * on every network the device host uses, or -1 in case the datagrams are
+     * not counted on this platform.
+     *
+     * \sa HSsdp::droppedDatagrams()
+     */
+    qint64 ssdpDatagramsDropped(HSsdp::DropReason reason) const;
+
+    /*!
+     * \brief Returns the number of HTTP requests with the specified method
+     * the device host has served.
+     *
+     * \param method specifies the HTTP method, such as \c GET or \c POST.
+     * The requests with a method the device host does not serve are counted
+     * under an empty string.
+     *
+     * \return The number of HTTP requests with the specified method
+     * the device host has served.
+     */
+    qint64 httpRequests(const QString& method) const;
+
+    /*!
+     * \brief Returns the number of HTTP connections open to the device host.
+     *
+     * \return The number of HTTP connections open to the device host.
+     */
+    qint32 openConnections() const;
+
+    /*!
+     * \brief Returns the names of the actions that have been invoked.
+     *
+     * The invocations of the actions are counted by the names of the
+     * actions, which means that the invocations of the actions that have
+     * the same name in different services are counted together.
+     *
+     * \return The names of the actions that have been invoked.
+     *
+     * \sa actionInvocations(), actionLatency()
+     */
+    QStringList invokedActions() const;
+
+    /*!
+     * \brief Returns the number of times the specified action has been invoked.
+     *
+     * \param actionName specifies the name of the action.
+     *
+     * \return The number of times the specified action has been invoked,
+     * including the invocations that failed.
+     *
+     * \sa failedActionInvocations(), invokedActions()
+     */
+    qint64 actionInvocations(const QString& actionName) const;
+
+    /*!
+     * \brief Returns the number of times an invocation of the specified action
+     * has failed.
+     *
+     * \param actionName specifies the name of the action.
+     *
+     * \return The number of times an invocation of the specified action
+     * has returned an error code.
+     *
+     * \sa actionInvocations()
+     */
+    qint64 failedActionInvocations(const QString& actionName) const;
+
+    /*!
+     * \brief Returns the specified percentile of the time it has taken to
+     * run the latest invocations of the specified action.
+     *
+     * The time of an invocation is measured from the moment the invocation
+     * is started to the moment the action returns, which includes the time
+     * the invocation waits for a worker thread.
+     *
+     * \param actionName specifies the name of the action.
+     *
+     * \param percentile specifies the percentile, which is a value
+     * between 0 and 100.
+     *
+     * \return The specified percentile of the invocation time in milliseconds,
+     * or -1 in case the action has not been invoked.
+     *
+     * \sa eventDeliveryLatency()
+     */
+    qint32 actionLatency(const QString& actionName, qint32 percentile) const;
+
+    /*!
+     * \brief Returns the number of event notifications the device host has
+     * delivered to the subscribers.
+     *
+     * \return The number of event notifications the device host has
+     * delivered to the subscribers.
+     *
+     * \sa failedEventNotifications()
+     */
+    qint64 sentEventNotifications() const;
+
+    /*!
+     * \brief Returns the number of event notifications the device host
+     * could not deliver.
+     *
+     * \return The number of event notifications the device host
+     * could not deliver.
+     *
+     * \sa sentEventNotifications(), droppedEventSubscribers()
+     */
+    qint64 failedEventNotifications() const;
+
+    /*!
+     * \brief Returns the number of event subscriptions that have not expired.
+     *
+     * \return The number of event subscriptions that have not expired.
+     */
+    qint32 activeSubscriptions() const;
+
+    /*!
+     * \brief Returns the identities of the handlers that have stalled the
+     * thread that serves HTTP.
+     *
+     * A handler is identified by the name of the action it ran or by the
+     * HTTP method and the path of the request it handled, such as
+     * <c>GET /device/description.xml</c>. The stalls that were not caused
+     * by the handling of a request are reported under an empty string.
+     *
+     * \return The identities of the handlers that have stalled the
+     * thread that serves HTTP. The list is empty in case stall detection
+     * is disabled.
+     *
+     * \sa handlerStalls(), worstHandlerStall(),
+     * HDeviceHostConfiguration::setStallThreshold()
+     */
+    QStringList stalledHandlers() const;
+
+    /*!
+     * \brief Returns the number of times the specified handler has run longer
+     * than the stall threshold.
+     *
+     * \param handler specifies the identity of the handler, as returned by
+     * stalledHandlers().
+     *
+     * \return The number of times the specified handler has run longer than
+     * the stall threshold.
+     *
+     * \sa worstHandlerStall()
+     */
+    qint64 handlerStalls(const QString& handler) const;
+
+    /*!
+     * \brief Returns the longest time the specified handler has stalled the
+     * thread that serves HTTP.
+     *
+     * \param handler specifies the identity of the handler, as returned by
+     * stalledHandlers().
+     *
+     * \return The longest time in milliseconds the specified handler has
+     * stalled the thread, or zero in case the handler has not stalled it.
+     *
+     * \sa handlerStalls()
+     */
+    qint32 worstHandlerStall(const QString& handler) const;
 };
 
 }
@@ -38,7 +38,8 @@ namespace Upnp
  * HDeviceConfigurationPrivate
  ******************************************************************************/
 HDeviceConfigurationPrivate::HDeviceConfigurationPrivate() :
-    m_pathToDeviceDescriptor(), m_cacheControlMaxAgeInSecs(1800)
+    m_pathToDeviceDescriptor(), m_cacheControlMaxAgeInSecs(1800),
+    m_udn(), m_friendlyName()
 {
 }
 
@@ -75,6 +76,8 @@ void HDeviceConfiguration::doClone(HClonable* target) const
 
     conf->h_ptr->m_cacheControlMaxAgeInSecs = h_ptr->m_cacheControlMaxAgeInSecs;
     conf->h_ptr->m_pathToDeviceDescriptor = h_ptr->m_pathToDeviceDescriptor;
+    conf->h_ptr->m_udn = h_ptr->m_udn;
+    conf->h_ptr->m_friendlyName = h_ptr->m_friendlyName;
 }
 
 HDeviceConfiguration* HDeviceConfiguration::clone() const
@@ -114,6 +117,26 @@ qint32 HDeviceConfiguration::cacheControlMaxAge() const
     return h_ptr->m_cacheControlMaxAgeInSecs;
 }
 
+void HDeviceConfiguration::setUdn(const HUdn& udn)
+{
+    h_ptr->m_udn = udn;
+}
+
+HUdn HDeviceConfiguration::udn() const
+{
+    return h_ptr->m_udn;
+}
+
+void HDeviceConfiguration::setFriendlyName(const QString& friendlyName)
+{
+    h_ptr->m_friendlyName = friendlyName;
+}
+
+QString HDeviceConfiguration::friendlyName() const
+{
+    return h_ptr->m_friendlyName;
+}
+
 bool HDeviceConfiguration::isValid() const
 {
     return !h_ptr->m_pathToDeviceDescriptor.isEmpty();
@@ -126,6 +149,25 @@ HDeviceHostConfigurationPrivate::HDeviceHostConfigurationPrivate() :
     m_collection(),
     m_individualAdvertisementCount(2),
     m_subscriptionExpirationTimeout(0),
+    m_httpWorkerThreadCount(0),
+    m_httpListenersPerEndpoint(1),
+    m_actionThreadCount(0),
+    m_maxHttpRequestBodySize(1024*1024*5),
+    m_maxHttpConnectionsPerEndpoint(0),
+    m_maxHttpConnectionsPerPeer(0),
+    m_maxHttpQueuedWriteBytes(0),
+    m_maxDiscoveryRequestsPerSource(0),
+    m_maxDiscoveryRequests(0),
+    m_maxAnnouncementRate(0),
+    m_ssdpReceiveBufferSize(256 * 1024),
+    m_ssdpSendBufferSize(0),
+    m_ssdpReceiveThreads(false),
+    m_sharedSsdp(false),
+    m_networkThread(false),
+    m_eventModerationWindow(0),
+    m_snapshotPath(),
+    m_metricsPath(),
+    m_stallThreshold(0),
     m_networkAddresses(),
     m_deviceCreator(0),
     m_infoProvider(0)
@@ -178,6 +220,29 @@ void HDeviceHostConfiguration::doClone(HClonable* target) const
     conf->h_ptr->m_subscriptionExpirationTimeout =
         h_ptr->m_subscriptionExpirationTimeout;
 
+    conf->h_ptr->m_httpWorkerThreadCount = h_ptr->m_httpWorkerThreadCount;
+    conf->h_ptr->m_httpListenersPerEndpoint =
+        h_ptr->m_httpListenersPerEndpoint;
+    conf->h_ptr->m_actionThreadCount = h_ptr->m_actionThreadCount;
+    conf->h_ptr->m_maxHttpRequestBodySize = h_ptr->m_maxHttpRequestBodySize;
+    conf->h_ptr->m_maxHttpConnectionsPerEndpoint =
+        h_ptr->m_maxHttpConnectionsPerEndpoint;
+    conf->h_ptr->m_maxHttpConnectionsPerPeer = h_ptr->m_maxHttpConnectionsPerPeer;
+    conf->h_ptr->m_maxHttpQueuedWriteBytes = h_ptr->m_maxHttpQueuedWriteBytes;
+    conf->h_ptr->m_maxDiscoveryRequestsPerSource =
+        h_ptr->m_maxDiscoveryRequestsPerSource;
+    conf->h_ptr->m_maxDiscoveryRequests = h_ptr->m_maxDiscoveryRequests;
+    conf->h_ptr->m_maxAnnouncementRate = h_ptr->m_maxAnnouncementRate;
+    conf->h_ptr->m_ssdpReceiveBufferSize = h_ptr->m_ssdpReceiveBufferSize;
+    conf->h_ptr->m_ssdpSendBufferSize = h_ptr->m_ssdpSendBufferSize;
+    conf->h_ptr->m_ssdpReceiveThreads = h_ptr->m_ssdpReceiveThreads;
+    conf->h_ptr->m_sharedSsdp = h_ptr->m_sharedSsdp;
+    conf->h_ptr->m_networkThread = h_ptr->m_networkThread;
+    conf->h_ptr->m_eventModerationWindow = h_ptr->m_eventModerationWindow;
+    conf->h_ptr->m_snapshotPath = h_ptr->m_snapshotPath;
+    conf->h_ptr->m_metricsPath = h_ptr->m_metricsPath;
+    conf->h_ptr->m_stallThreshold = h_ptr->m_stallThreshold;
+
     QList<const HDeviceConfiguration*> confCollection;
     foreach(const HDeviceConfiguration* conf, h_ptr->m_collection)
     {
@@ -210,6 +275,17 @@ bool HDeviceHostConfiguration::add(const HDeviceConfiguration& arg)
     return false;
 }
 
+bool HDeviceHostConfiguration::remove(const HDeviceConfiguration* arg)
+{
+    if (!h_ptr->m_collection.removeOne(arg))
+    {
+        return false;
+    }
+
+    delete arg;
+    return true;
+}
+
 void HDeviceHostConfiguration::clear()
 {
     qDeleteAll(h_ptr->m_collection);
@@ -280,6 +356,234 @@ void HDeviceHostConfiguration::setSubscriptionExpirationTimeout(qint32 arg)
     h_ptr->m_subscriptionExpirationTimeout = arg;
 }
 
+qint32 HDeviceHostConfiguration::httpWorkerThreadCount() const
+{
+    return h_ptr->m_httpWorkerThreadCount;
+}
+
+void HDeviceHostConfiguration::setHttpWorkerThreadCount(qint32 count)
+{
+    h_ptr->m_httpWorkerThreadCount = count > 0 ? count : 0;
+}
+
+qint32 HDeviceHostConfiguration::httpListenersPerEndpoint() const
+{
+    return h_ptr->m_httpListenersPerEndpoint;
+}
+
+void HDeviceHostConfiguration::setHttpListenersPerEndpoint(qint32 count)
+{
+    h_ptr->m_httpListenersPerEndpoint = count > 1 ? count : 1;
+}
+
+qint32 HDeviceHostConfiguration::actionThreadCount() const
+{
+    return h_ptr->m_actionThreadCount;
+}
+
+void HDeviceHostConfiguration::setActionThreadCount(qint32 count)
+{
+    h_ptr->m_actionThreadCount = count > 0 ? count : 0;
+}
+
+qint32 HDeviceHostConfiguration::maxHttpRequestBodySize() const
+{
+    return h_ptr->m_maxHttpRequestBodySize;
+}
+
+void HDeviceHostConfiguration::setMaxHttpRequestBodySize(qint32 maxBytes)
+{
+    if (maxBytes >= 0)
+    {
+        h_ptr->m_maxHttpRequestBodySize = maxBytes;
+    }
+}
+
+qint32 HDeviceHostConfiguration::maxHttpConnectionsPerEndpoint() const
+{
+    return h_ptr->m_maxHttpConnectionsPerEndpoint;
+}
+
+void HDeviceHostConfiguration::setMaxHttpConnectionsPerEndpoint(
+    qint32 maxConnections)
+{
+    if (maxConnections >= 0)
+    {
+        h_ptr->m_maxHttpConnectionsPerEndpoint = maxConnections;
+    }
+}
+
+qint32 HDeviceHostConfiguration::maxHttpConnectionsPerPeer() const
+{
+    return h_ptr->m_maxHttpConnectionsPerPeer;
+}
+
+void HDeviceHostConfiguration::setMaxHttpConnectionsPerPeer(qint32 maxConnections)
+{
+    if (maxConnections >= 0)
+    {
+        h_ptr->m_maxHttpConnectionsPerPeer = maxConnections;
+    }
+}
+
+qint32 HDeviceHostConfiguration::maxHttpQueuedWriteBytes() const
+{
+    return h_ptr->m_maxHttpQueuedWriteBytes;
+}
+
+void HDeviceHostConfiguration::setMaxHttpQueuedWriteBytes(qint32 maxBytes)
+{
+    if (maxBytes >= 0)
+    {
+        h_ptr->m_maxHttpQueuedWriteBytes = maxBytes;
+    }
+}
+
+qint32 HDeviceHostConfiguration::maxDiscoveryRequestsPerSource() const
+{
+    return h_ptr->m_maxDiscoveryRequestsPerSource;
+}
+
+void HDeviceHostConfiguration::setMaxDiscoveryRequestsPerSource(
+    qint32 maxRequests)
+{
+    if (maxRequests >= 0)
+    {
+        h_ptr->m_maxDiscoveryRequestsPerSource = maxRequests;
+    }
+}
+
+qint32 HDeviceHostConfiguration::maxDiscoveryRequests() const
+{
+    return h_ptr->m_maxDiscoveryRequests;
+}
+
+void HDeviceHostConfiguration::setMaxDiscoveryRequests(qint32 maxRequests)
+{
+    if (maxRequests >= 0)
+    {
+        h_ptr->m_maxDiscoveryRequests = maxRequests;
+    }
+}
+
+qint32 HDeviceHostConfiguration::maxAnnouncementRate() const
+{
+    return h_ptr->m_maxAnnouncementRate;
+}
+
+void HDeviceHostConfiguration::setMaxAnnouncementRate(qint32 maxAnnouncements)
+{
+    if (maxAnnouncements >= 0)
+    {
+        h_ptr->m_maxAnnouncementRate = maxAnnouncements;
+    }
+}
+
+qint32 HDeviceHostConfiguration::ssdpReceiveBufferSize() const
+{
+    return h_ptr->m_ssdpReceiveBufferSize;
+}
+
+qint32 HDeviceHostConfiguration::ssdpSendBufferSize() const
+{
+    return h_ptr->m_ssdpSendBufferSize;
+}
+
+void HDeviceHostConfiguration::setSsdpReceiveBufferSize(qint32 bytes)
+{
+    if (bytes >= 0)
+    {
+        h_ptr->m_ssdpReceiveBufferSize = bytes;
+    }
+}
+
+void HDeviceHostConfiguration::setSsdpSendBufferSize(qint32 bytes)
+{
+    if (bytes >= 0)
+    {
+        h_ptr->m_ssdpSendBufferSize = bytes;
+    }
+}
+
+bool HDeviceHostConfiguration::ssdpReceiveThreadsEnabled() const
+{
+    return h_ptr->m_ssdpReceiveThreads;
+}
+
+bool HDeviceHostConfiguration::sharedSsdpEnabled() const
+{
+    return h_ptr->m_sharedSsdp;
+}
+
+void HDeviceHostConfiguration::setSsdpReceiveThreadsEnabled(bool enable)
+{
+    h_ptr->m_ssdpReceiveThreads = enable;
+}
+
+void HDeviceHostConfiguration::setSharedSsdpEnabled(bool enable)
+{
+    h_ptr->m_sharedSsdp = enable;
+}
+
+bool HDeviceHostConfiguration::networkThreadEnabled() const
+{
+    return h_ptr->m_networkThread;
+}
+
+void HDeviceHostConfiguration::setNetworkThreadEnabled(bool enable)
+{
+    h_ptr->m_networkThread = enable;
+}
+
+qint32 HDeviceHostConfiguration::eventModerationWindow() const
+{
+    return h_ptr->m_eventModerationWindow;
+}
+
+void HDeviceHostConfiguration::setEventModerationWindow(qint32 msecs)
+{
+    if (msecs >= 0)
+    {
+        h_ptr->m_eventModerationWindow = msecs;
+    }
+}
+
+QString HDeviceHostConfiguration::snapshotPath() const
+{
+    return h_ptr->m_snapshotPath;
+}
+
+void HDeviceHostConfiguration::setSnapshotPath(const QString& path)
+{
+    h_ptr->m_snapshotPath = path;
+}
+
+QString HDeviceHostConfiguration::metricsPath() const
+{
+    return h_ptr->m_metricsPath;
+}
+
+void HDeviceHostConfiguration::setMetricsPath(const QString& path)
+{
+    if (path.isEmpty() || path.startsWith('/'))
+    {
+        h_ptr->m_metricsPath = path;
+    }
+}
+
+qint32 HDeviceHostConfiguration::stallThreshold() const
+{
+    return h_ptr->m_stallThreshold;
+}
+
+void HDeviceHostConfiguration::setStallThreshold(qint32 msecs)
+{
+    if (msecs >= 0)
+    {
+        h_ptr->m_stallThreshold = msecs;
+    }
+}
+
 bool HDeviceHostConfiguration::setNetworkAddressesToUse(
     const QList<QHostAddress>& addresses)
 {
@@ -47,6 +47,17 @@ class HDeviceConfigurationPrivate;
  * HDeviceHost in regard to the HServerDevice instance that is created based
  * on the pathToDeviceDescription().
  *
+ * A device description can also be used as a template for any number of
+ * devices: when the UDN of the device is set with setUdn(), the UDN and
+ * optionally the friendly name in the description are replaced for the
+ * device that is created. The UDNs of the embedded devices are derived from
+ * the specified UDN. An HDeviceHost reads the files of a template only once
+ * and the devices created from the same template share the contents of
+ * the service descriptions and icons, which keeps the memory needed by each
+ * additional device small. To avoid a burst of announcements when a large
+ * number of devices is hosted, see
+ * HDeviceHostConfiguration::setMaxAnnouncementRate().
+ *
  * \headerfile hdevicehost_configuration.h HDeviceConfiguration
  *
  * \ingroup hupnp_devicehosting
@@ -133,6 +144,56 @@ public:
      */
     qint32 cacheControlMaxAge() const;
 
+    /*!
+     * \brief Specifies the UDN of the device, which replaces the UDN in
+     * the device description.
+     *
+     * Use this to create several devices from the same device description.
+     * The UDNs of the embedded devices are replaced as well with UDNs that
+     * are derived from the specified UDN and the UDNs in the description,
+     * which means that the UDNs stay the same every time the device is
+     * created with the same configuration.
+     *
+     * \param udn specifies the UDN of the device. If the UDN is not valid,
+     * the UDNs in the device description are used. This is the default.
+     *
+     * \sa udn(), setFriendlyName()
+     */
+    void setUdn(const HUdn& udn);
+
+    /*!
+     * \brief Returns the UDN that replaces the UDN in the device description.
+     *
+     * \return The UDN that replaces the UDN in the device description, which
+     * is not valid in case the UDNs in the description are used.
+     *
+     * \sa setUdn()
+     */
+    HUdn udn() const;
+
+    /*!
+     * \brief Specifies the friendly name of the device, which replaces the
+     * friendly name in the device description.
+     *
+     * \param friendlyName specifies the friendly name of the device. If the
+     * name is empty, the name in the device description is used. This is the
+     * default.
+     *
+     * \sa friendlyName(), setUdn()
+     */
+    void setFriendlyName(const QString& friendlyName);
+
+    /*!
+     * \brief Returns the friendly name that replaces the friendly name in the
+     * device description.
+     *
+     * \return The friendly name that replaces the friendly name in the device
+     * description, which is empty in case the name in the description is used.
+     *
+     * \sa setFriendlyName()
+     */
+    QString friendlyName() const;
+
     /*!
      * \brief Indicates whether or not the object contains the necessary details
      * for hosting an HServerDevice class in a HDeviceHost.
@@ -180,6 +241,33 @@ class HDeviceHostConfigurationPrivate;
  * setSubscriptionExpirationTimeout(). The default is 0, which means that
  * an HDeviceHost respects the subscription timeouts requested by control points
  * as long as the requested values are less than a day.
+ * - Specify the number of threads used for receiving HTTP requests with
+ * setHttpWorkerThreadCount(). The default is 0, which means that every
+ * request is received in the thread of the HDeviceHost.
+ * - Specify the number of listening sockets opened for each HTTP endpoint
+ * with setHttpListenersPerEndpoint(). The default is 1.
+ * - Specify the number of threads used for running the actions that are not
+ * run in the thread of the HDeviceHost with setActionThreadCount().
+ * The default is 0, which means that the number of threads matches the number
+ * of processor cores.
+ * - Specify the maximum size of an HTTP request body the device host buffers
+ * in memory with setMaxHttpRequestBodySize(). The default is 5 MB.
+ * - Limit the number of HTTP connections with setMaxHttpConnectionsPerEndpoint()
+ * and setMaxHttpConnectionsPerPeer() and the amount of response data waiting
+ * to be sent with setMaxHttpQueuedWriteBytes(). By default none of these
+ * are limited.
+ * - Limit the rate of answered discovery requests with
+ * setMaxDiscoveryRequestsPerSource() and setMaxDiscoveryRequests().
+ * By default the rate is not limited.
+ * - Set the sizes of the receive and the send buffers of the SSDP sockets
+ * with setSsdpReceiveBufferSize() and setSsdpSendBufferSize(). By default
+ * the receive buffer is 256 kilobytes and the operating system decides
+ * the size of the send buffer.
+ * - Specify a snapshot file of the description files with setSnapshotPath(),
+ * which lets an HDeviceHost skip reading and parsing the description files
+ * while the files are unchanged. By default no snapshot is used.
+ * - Detect the request handlers that block the thread of the HDeviceHost
+ * with setStallThreshold(). By default the detection is disabled.
  * - Specify the network addresses an HDeviceHost should use in its operations
  * with setNetworkAddressesToUse().
  * The default is the first found interface that is up. Non-loopback interfaces
@@ -252,6 +340,18 @@ public:
      */
     bool add(const HDeviceConfiguration& deviceConfiguration);
 
+    /*!
+     * Removes a device configuration.
+     *
+     * \param deviceConfiguration specifies the device configuration to be
+     * removed. This has to be one of the objects returned by
+     * deviceConfigurations().
+     *
+     * \return \e true in case the configuration was found and removed.
+     * The object is deleted and it must not be used after this call.
+     */
+    bool remove(const HDeviceConfiguration* deviceConfiguration);
+
     /*!
      * Removes device configurations.
      *
@@ -306,6 +406,257 @@ public:
      */
     qint32 subscriptionExpirationTimeout() const;
 
+    /*!
+     * \brief Returns the number of threads the device host uses to receive
+     * HTTP requests.
+     *
+     * The default value is zero, which means that every HTTP request is
+     * received in the thread of the device host.
+     *
+     * \return The number of threads the device host uses to receive
+     * HTTP requests.
+     *
+     * \sa setHttpWorkerThreadCount()
+     */
+    qint32 httpWorkerThreadCount() const;
+
+    /*!
+     * \brief Returns the number of listening sockets the device host opens
+     * for each HTTP endpoint.
+     *
+     * The default value is 1.
+     *
+     * \return The number of listening sockets the device host opens
+     * for each HTTP endpoint.
+     *
+     * \sa setHttpListenersPerEndpoint()
+     */
+    qint32 httpListenersPerEndpoint() const;
+
+    /*!
+     * \brief Returns the maximum number of threads the device host uses
+     * to run the actions whose execution policy is not
+     * HServerAction::ExecuteInHostThread.
+     *
+     * The default value is zero, which means that the number of threads
+     * matches the number of processor cores.
+     *
+     * \return The maximum number of threads the device host uses to run
+     * actions.
+     *
+     * \sa setActionThreadCount(), HServerAction::setExecutionPolicy()
+     */
+    qint32 actionThreadCount() const;
+
+    /*!
+     * \brief Returns the maximum size of an HTTP request body in bytes the
+     * device host accepts.
+     *
+     * The default value is 5 MB.
+     *
+     * \return The maximum size of an HTTP request body in bytes the
+     * device host accepts. Zero means that the size is not limited.
+     *
+     * \sa setMaxHttpRequestBodySize()
+     */
+    qint32 maxHttpRequestBodySize() const;
+
+    /*!
+     * \brief Returns the maximum number of HTTP connections the device host
+     * keeps open per network endpoint.
+     *
+     * The default value is zero, which means that the number of connections
+     * is not limited.
+     *
+     * \return The maximum number of HTTP connections the device host
+     * keeps open per network endpoint.
+     *
+     * \sa setMaxHttpConnectionsPerEndpoint()
+     */
+    qint32 maxHttpConnectionsPerEndpoint() const;
+
+    /*!
+     * \brief Returns the maximum number of HTTP connections a single
+     * peer can have open to the device host.
+     *
+     * The default value is zero, which means that the number of connections
+     * is not limited.
+     *
+     * \return The maximum number of HTTP connections a single
+     * peer can have open to the device host.
+     *
+     * \sa setMaxHttpConnectionsPerPeer()
+     */
+    qint32 maxHttpConnectionsPerPeer() const;
+
+    /*!
+     * \brief Returns the maximum number of bytes of HTTP responses that can
+     * be waiting to be sent before the device host starts rejecting requests.
+     *
+     * The default value is zero, which means that the amount is not limited.
+     *
+     * \return The maximum number of bytes of HTTP responses that can
+     * be waiting to be sent before the device host starts rejecting requests.
+     *
+     * \sa setMaxHttpQueuedWriteBytes()
+     */
+    qint32 maxHttpQueuedWriteBytes() const;
+
+    /*!
+     * \brief Returns the maximum number of discovery requests per second the
+     * device host answers from a single requestor.
+     *
+     * The default value is zero, which means that the rate is not limited.
+     *
+     * \return The maximum number of discovery requests per second the
+     * device host answers from a single requestor.
+     *
+     * \sa setMaxDiscoveryRequestsPerSource()
+     */
+    qint32 maxDiscoveryRequestsPerSource() const;
+
+    /*!
+     * \brief Returns the maximum number of discovery requests per second the
+     * device host answers in total.
+     *
+     * The default value is zero, which means that the rate is not limited.
+     *
+     * \return The maximum number of discovery requests per second the
+     * device host answers in total.
+     *
+     * \sa setMaxDiscoveryRequests()
+     */
+    qint32 maxDiscoveryRequests() const;
+
+    /*!
+     * \brief Returns the maximum number of presence announcements per second
+     * the device host sends to a network.
+     *
+     * The default value is zero, which means that the announcements are
+     * sent as fast as possible.
+     *
+     * \return The maximum number of presence announcements per second
+     * the device host sends to a network.
+     *
+     * \sa setMaxAnnouncementRate()
+     */
+    qint32 maxAnnouncementRate() const;
+
+    /*!
+     * \brief Returns the size of the receive buffer of the sockets a device
+     * host uses for SSDP.
+     *
+     * The default value is 256 kilobytes.
+     *
+     * \return The size of the receive buffer in bytes. A value of zero
+     * means that the default of the operating system is used.
+     *
+     * \sa setSsdpReceiveBufferSize()
+     */
+    qint32 ssdpReceiveBufferSize() const;
+
+    /*!
+     * \brief Returns the size of the send buffer of the sockets a device
+     * host uses for sending SSDP messages.
+     *
+     * The default value is zero.
+     *
+     * \return The size of the send buffer in bytes. A value of zero
+     * means that the default of the operating system is used.
+     *
+     * \sa setSsdpSendBufferSize()
+     */
+    qint32 ssdpSendBufferSize() const;
+
+    /*!
+     * \brief Indicates whether the SSDP multicast messages of each network
+     * a device host uses are received in a thread of their own.
+     *
+     * The default value is \e false.
+     *
+     * \return \e true in case the SSDP multicast messages of each network
+     * are received in a thread of their own.
+     *
+     * \sa setSsdpReceiveThreadsEnabled()
+     */
+    bool ssdpReceiveThreadsEnabled() const;
+
+    /*!
+     * \brief Indicates whether the device host shares the SSDP
+     * multicast sockets with the other control points and device hosts of
+     * its thread.
+     *
+     * The default value is \e false.
+     *
+     * \return \e true in case the SSDP multicast sockets are shared.
+     *
+     * \sa setSharedSsdpEnabled()
+     */
+    bool sharedSsdpEnabled() const;
+
+    /*!
+     * \brief Indicates whether the device host is run in a network thread
+     * of its own.
+     *
+     * The default value is \e false.
+     *
+     * \return \e true in case the device host is run in a network thread
+     * of its own.
+     *
+     * \sa setNetworkThreadEnabled()
+     */
+    bool networkThreadEnabled() const;
+
+    /*!
+     * \brief Returns the time in milliseconds the state changes of a service
+     * are collected before they are evented to the subscribers.
+     *
+     * The default value is zero, in which case the state changes made during
+     * the same pass of the event loop are sent in a single notification.
+     *
+     * \return The time in milliseconds the state changes of a service
+     * are collected before they are evented to the subscribers.
+     *
+     * \sa setEventModerationWindow()
+     */
+    qint32 eventModerationWindow() const;
+
+    /*!
+     * \brief Returns the path to the snapshot file of the description files
+     * of the hosted devices.
+     *
+     * \return The path to the snapshot file of the description files
+     * of the hosted devices. The path is empty if no snapshot is used,
+     * which is the default.
+     *
+     * \sa setSnapshotPath()
+     */
+    QString snapshotPath() const;
+
+    /*!
+     * \brief Returns the path at which the device host serves its runtime
+     * metrics.
+     *
+     * \return The path at which the device host serves its runtime metrics
+     * in the OpenMetrics text format. The path is empty if the metrics are
+     * not served, which is the default.
+     *
+     * \sa setMetricsPath()
+     */
+    QString metricsPath() const;
+
+    /*!
+     * \brief Returns the time in milliseconds after which a request handler
+     * is considered to have stalled the thread that serves HTTP.
+     *
+     * \return The time in milliseconds after which a request handler
+     * is considered to have stalled the thread that serves HTTP. The default
+     * is zero, which means that stalls are not detected.
+     *
+     * \sa setStallThreshold()
+     */
+    qint32 stallThreshold() const;
+
     /*!
      * \brief Returns the device model creator the HDeviceHost should use
      * to create HServerDevice instances.
@@ -381,6 +732,374 @@ public:
      */
     void setSubscriptionExpirationTimeout(qint32 timeout);
 
+    /*!
+     * \brief Specifies the number of threads the device host uses to receive
+     * HTTP requests.
+     *
+     * When the count is larger than zero, the accepted connections are
+     * spread across the specified number of threads, each of which runs an
+     * event loop of its own. Reading and parsing the requests is done in these
+     * threads, which enables the device host to receive requests from multiple
+     * clients concurrently.
+     *
+     * Once a request is fully received, it is handed to the thread of the
+     * device host, where it is dispatched. Because of this, the hosted
+     * HServerDevice and HServerService objects are always accessed from
+     * the thread of the device host regardless of this setting.
+     *
+     * \param count specifies the number of worker threads. If the value is
+     * zero or negative, every HTTP request is received in the thread of
+     * the device host. This is the default.
+     *
+     * \sa httpWorkerThreadCount()
+     */
+    void setHttpWorkerThreadCount(qint32 count);
+
+    /*!
+     * \brief Specifies the number of listening sockets the device host opens
+     * for each HTTP endpoint.
+     *
+     * The first socket accepts connections in the thread of the device host
+     * and the others are spread over the HTTP worker threads, which accept
+     * the connections themselves. The sockets share the port using
+     * SO_REUSEPORT, which makes the operating system balance the incoming
+     * connections between the sockets, and thus between the threads. This
+     * helps when a lot of short-lived connections arrive at once, such as
+     * when a large number of control points fetch the device descriptions
+     * after an announcement.
+     *
+     * More than one socket is opened only if HTTP worker threads are used
+     * and the platform supports SO_REUSEPORT. At most one socket is opened
+     * for each worker thread in addition to the first one.
+     *
+     * \param count specifies the number of listening sockets for each
+     * endpoint. Values less than 1 are treated as 1, which is the default.
+     *
+     * \sa httpListenersPerEndpoint(), setHttpWorkerThreadCount(),
+     * setMaxHttpConnectionsPerEndpoint()
+     */
+    void setHttpListenersPerEndpoint(qint32 count);
+
+    /*!
+     * \brief Specifies the maximum number of threads the device host uses
+     * to run the actions whose execution policy is not
+     * HServerAction::ExecuteInHostThread.
+     *
+     * The threads are started as the actions are invoked and they are
+     * shared by every service of every hosted device. The invocations that
+     * do not fit into the threads wait until a thread becomes available.
+     *
+     * \param count specifies the maximum number of threads. If the value is
+     * zero or negative, the number of threads matches the number of processor
+     * cores. This is the default.
+     *
+     * \sa actionThreadCount(), HServerAction::setExecutionPolicy()
+     */
+    void setActionThreadCount(qint32 count);
+
+    /*!
+     * \brief Specifies the maximum size of an HTTP request body in bytes the
+     * device host accepts.
+     *
+     * The body of an HTTP request is buffered in memory until the request has
+     * been fully received. Requests with larger bodies are rejected as soon as
+     * the limit is exceeded, which bounds the memory a single connection
+     * can consume.
+     *
+     * \param maxBytes specifies the maximum size of an HTTP request body in
+     * bytes. Zero means that the size is not limited. Negative values
+     * are ignored.
+     *
+     * \sa maxHttpRequestBodySize()
+     */
+    void setMaxHttpRequestBodySize(qint32 maxBytes);
+
+    /*!
+     * \brief Specifies the maximum number of HTTP connections the device host
+     * keeps open per network endpoint.
+     *
+     * Once the limit is reached, the device host stops accepting connections
+     * to the endpoint until one of the open connections is closed. In the
+     * meantime new connections wait in the backlog of the operating system.
+     * When several listening sockets are opened for each endpoint, each
+     * socket gets an equal share of the limit.
+     *
+     * \param maxConnections specifies the maximum number of HTTP connections
+     * per network endpoint. Zero means that the number is not limited.
+     * Negative values are ignored.
+     *
+     * \sa maxHttpConnectionsPerEndpoint(), setHttpListenersPerEndpoint()
+     */
+    void setMaxHttpConnectionsPerEndpoint(qint32 maxConnections);
+
+    /*!
+     * \brief Specifies the maximum number of HTTP connections a single
+     * peer can have open to the device host.
+     *
+     * Requests received over connections exceeding the limit are answered
+     * with <em>503 Service Unavailable</em> and a \c RETRY-AFTER header,
+     * after which the connections are closed.
+     *
+     * \param maxConnections specifies the maximum number of HTTP connections
+     * per peer. Zero means that the number is not limited. Negative values
+     * are ignored.
+     *
+     * \sa maxHttpConnectionsPerPeer()
+     */
+    void setMaxHttpConnectionsPerPeer(qint32 maxConnections);
+
+    /*!
+     * \brief Specifies the maximum number of bytes of HTTP responses that can
+     * be waiting to be sent before the device host starts rejecting requests.
+     *
+     * While the limit is exceeded, new requests are answered with
+     * <em>503 Service Unavailable</em> and a \c RETRY-AFTER header.
+     *
+     * \param maxBytes specifies the maximum number of bytes. Zero means that
+     * the amount is not limited. Negative values are ignored.
+     *
+     * \sa maxHttpQueuedWriteBytes()
+     */
+    void setMaxHttpQueuedWriteBytes(qint32 maxBytes);
+
+    /*!
+     * \brief Specifies the maximum number of discovery requests per second the
+     * device host answers from a single requestor.
+     *
+     * A requestor may send a burst of requests up to the limit, after which
+     * its requests are ignored until its allowance is replenished.
+     * Regardless of the limit, a request that is repeated within its
+     * response window is ignored, since the responses to the first request
+     * answer the repetitions as well.
+     *
+     * The device host keeps track of at most 8192 requestors and recently
+     * answered requests. While either of these is full, the requests that
+     * would have to be tracked anew are ignored until the idle entries
+     * have been forgotten, which takes at most a few seconds.
+     *
+     * \param maxRequests specifies the maximum number of requests per second.
+     * Zero means that the rate is not limited. Negative values are ignored.
+     *
+     * \sa maxDiscoveryRequestsPerSource(), setMaxDiscoveryRequests()
+     */
+    void setMaxDiscoveryRequestsPerSource(qint32 maxRequests);
+
+    /*!
+     * \brief Specifies the maximum number of discovery requests per second the
+     * device host answers in total.
+     *
+     * This limits the amount of multicast traffic the device host generates
+     * when it is flooded with discovery requests from several requestors.
+     *
+     * \param maxRequests specifies the maximum number of requests per second.
+     * Zero means that the rate is not limited. Negative values are ignored.
+     *
+     * \sa maxDiscoveryRequests(), setMaxDiscoveryRequestsPerSource()
+     */
+    void setMaxDiscoveryRequests(qint32 maxRequests);
+
+    /*!
+     * \brief Specifies the maximum number of presence announcements per second
+     * the device host sends to a network.
+     *
+     * A device host announces each of its devices and services separately
+     * and it repeats every announcement as many times as specified by
+     * individualAdvertisementCount(). When a device host has several
+     * root devices the announcements can form bursts that congest the
+     * network. When the rate is limited the announcements that exceed the
+     * rate are queued and sent evenly over time. The notifications of
+     * device unavailability are never delayed.
+     *
+     * \param maxAnnouncements specifies the maximum number of announcements
+     * per second. Zero means that the rate is not limited.
+     * Negative values are ignored.
+     *
+     * \sa maxAnnouncementRate()
+     */
+    void setMaxAnnouncementRate(qint32 maxAnnouncements);
+
+    /*!
+     * \brief Sets the size of the receive buffer of the sockets a device
+     * host uses for SSDP.
+     *
+     * The discovery requests of the control points of a network tend to
+     * arrive in bursts, such as when many of them start at the same time,
+     * and a receive buffer that is too small causes some of them to be
+     * dropped.
+     *
+     * \param bytes specifies the size of the receive buffer in bytes.
+     * A value of zero means that the default of the operating system is used.
+     * Negative values are ignored.
+     *
+     * \sa ssdpReceiveBufferSize(), HSsdp::setReceiveBufferSize()
+     */
+    void setSsdpReceiveBufferSize(qint32 bytes);
+
+    /*!
+     * \brief Sets the size of the send buffer of the sockets a device
+     * host uses for sending SSDP messages.
+     *
+     * The announcements of a device tree and the responses to a discovery
+     * request for \c ssdp:all are sent in a burst, which a small send buffer
+     * may not hold.
+     *
+     * \param bytes specifies the size of the send buffer in bytes.
+     * A value of zero means that the default of the operating system is used.
+     * Negative values are ignored.
+     *
+     * \sa ssdpSendBufferSize(), HSsdp::setSendBufferSize()
+     */
+    void setSsdpSendBufferSize(qint32 bytes);
+
+    /*!
+     * \brief Specifies whether the SSDP multicast messages of each network
+     * a device host uses are received in a thread of their own.
+     *
+     * On a host attached to several networks, a burst of SSDP traffic on
+     * one network delays the handling of the others when all of them are
+     * read in the same thread. With receive threads enabled each network is
+     * read in a dedicated thread and the received messages of the networks
+     * are processed in turns in the thread of the device host.
+     *
+     * \param enable specifies whether the receive threads are used.
+     *
+     * \sa ssdpReceiveThreadsEnabled(), HSsdp::setReceiveThreadEnabled()
+     */
+    void setSsdpReceiveThreadsEnabled(bool enable);
+
+    /*!
+     * \brief Specifies whether the device host shares the SSDP
+     * multicast sockets with the other control points and device hosts of
+     * its thread.
+     *
+     * A process that runs several control points and device hosts in the
+     * same thread otherwise receives and parses every SSDP multicast message
+     * once per instance. With sharing enabled the instances that use the
+     * same network read the message from one socket, which parses it once
+     * and hands it to each of them. The rest of the networking, such as
+     * the unicast sockets and the HTTP servers, is not shared.
+     *
+     * \param enable specifies whether the SSDP multicast sockets are shared.
+     *
+     * \remarks The value is ignored in case the SSDP receive threads are
+     * enabled.
+     *
+     * \sa sharedSsdpEnabled(), HSsdp::setMulticastSharingEnabled()
+     */
+    void setSharedSsdpEnabled(bool enable);
+
+    /*!
+     * \brief Specifies whether the device host is run in a network thread
+     * of its own.
+     *
+     * When this is enabled HDeviceHost::init() moves the device host into
+     * an internal thread, in which all of its SSDP, HTTP and eventing work
+     * is done from then on. The networking then no longer competes with the
+     * other work of the thread that created the device host.
+     *
+     * HDeviceHost::init(), HDeviceHost::quit() and the destructor can be
+     * called from any thread, as they are run in the network thread and
+     * waited for. The hosted devices and services are run in the network
+     * thread as well, which means that the value of a state variable
+     * should be changed through a queued call from other threads.
+     *
+     * \param enable specifies whether the network thread is used.
+     *
+     * \remarks A device host that has a parent object cannot be run in
+     * a network thread, in which case HDeviceHost::init() fails.
+     *
+     * \sa networkThreadEnabled()
+     */
+    void setNetworkThreadEnabled(bool enable);
+
+    /*!
+     * \brief Specifies the time in milliseconds the state changes of a service
+     * are collected before they are evented to the subscribers.
+     *
+     * A service that changes the values of its state variables in rapid
+     * succession would otherwise send a notification to every subscriber
+     * for every change. Regardless of this value, a change of a state variable
+     * that has a maximum event rate defined is not evented more often than
+     * the rate allows, unless another change is evented at the same time.
+     *
+     * \param msecs specifies the time in milliseconds the state changes are
+     * collected. A negative value is ignored.
+     *
+     * \sa eventModerationWindow(), HStateVariableInfo::maxEventRate()
+     */
+    void setEventModerationWindow(qint32 msecs);
+
+    /*!
+     * \brief Specifies the path to the snapshot file of the description files
+     * of the hosted devices.
+     *
+     * A snapshot contains the device and service descriptions and the icons
+     * of the hosted devices in a binary form, in which the service
+     * descriptions are already parsed and checked. When the snapshot is up
+     * to date, HDeviceHost::init() uses it instead of reading and parsing
+     * the description files. Otherwise the description files are used and
+     * a new snapshot is written to the path once the devices have been
+     * successfully created. A snapshot can also be written in advance
+     * with HDeviceHost::writeSnapshot().
+     *
+     * A snapshot is out of date when any of the files it was created from
+     * has changed, when the device configurations refer to files or
+     * templates it does not contain or when it was written by a different
+     * version of HUPnP.
+     *
+     * \param path specifies the path to the snapshot file. An empty path
+     * means that no snapshot is used.
+     *
+     * \sa snapshotPath(), HDeviceHost::writeSnapshot()
+     */
+    void setSnapshotPath(const QString& path);
+
+    /*!
+     * \brief Specifies the path at which the device host serves its runtime
+     * metrics.
+     *
+     * When a path is set, an HTTP GET request to the path on any of the
+     * HTTP endpoints of the device host is answered with the counters and
+     * latency summaries of the
+     * HDeviceHostRuntimeStatus in the
+     * OpenMetrics text format, which can be scraped by Prometheus, for
+     * instance. The metrics are rendered when they are requested.
+     *
+     * \param path specifies the absolute path at which the metrics are
+     * served, such as \c /metrics. An empty path means that the metrics are
+     * not served. A path that does not start with a slash is ignored.
+     *
+     * \remarks The metrics are served to anyone that can reach the HTTP
+     * endpoints.
+     *
+     * \sa metricsPath(), HDeviceHostRuntimeStatus
+     */
+    void setMetricsPath(const QString& path);
+
+    /*!
+     * \brief Specifies the time in milliseconds after which a request handler
+     * is considered to have stalled the thread that serves HTTP.
+     *
+     * A device host that does not return to its event loop misses the
+     * deadlines of its SSDP responses and lets the HTTP requests of control
+     * points time out. When a threshold is set, the device host times the
+     * handling of every HTTP request and every action invoked in its own
+     * thread and records the ones that take longer than the threshold by
+     * the name of the action or by the HTTP method and path. A heartbeat
+     * timer catches the stalls caused by anything else, such as the
+     * delivery of event notifications or a long-running timer of the
+     * application. The stalls are reported by HDeviceHostRuntimeStatus.
+     *
+     * \param msecs specifies the threshold in milliseconds. Zero disables
+     * the detection. A negative value is ignored.
+     *
+     * \remarks The heartbeat timer fires once per threshold, which is why a
+     * very small threshold costs a few wake-ups per second.
+     *
+     * \sa stallThreshold(), HDeviceHostRuntimeStatus::stalledHandlers()
+     */
+    void setStallThreshold(qint32 msecs);
+
     /*!
      * Defines the network addresses the device host should use in its
      * operations.
@@ -32,6 +32,8 @@
 
 #include "hdevicehost_configuration.h"
 
+#include "../../dataelements/hudn.h"
+
 #include <QtCore/QList>
 #include <QtCore/QString>
 #include <QtCore/QScopedPointer>
@@ -55,6 +57,10 @@ public: // attributes
     QString m_pathToDeviceDescriptor;
     qint32  m_cacheControlMaxAgeInSecs;
 
+    HUdn m_udn;
+    QString m_friendlyName;
+    // these replace the values in the device description when they are set
+
 public: // methods
 
     HDeviceConfigurationPrivate();
@@ -78,6 +84,53 @@ public:
 
     qint32 m_subscriptionExpirationTimeout;
 
+    qint32 m_httpWorkerThreadCount;
+    // the number of threads used to receive HTTP requests
+
+    qint32 m_httpListenersPerEndpoint;
+    // the number of listening sockets opened for each HTTP endpoint
+
+    qint32 m_actionThreadCount;
+    // the maximum number of threads used to run actions outside the thread
+    // of the device host. zero means the number of processor cores.
+
+    qint32 m_maxHttpRequestBodySize;
+    // the maximum size of an HTTP request body in bytes
+
+    qint32 m_maxHttpConnectionsPerEndpoint;
+    qint32 m_maxHttpConnectionsPerPeer;
+    qint32 m_maxHttpQueuedWriteBytes;
+    // the limits of the HTTP admission control. zero means no limit.
+
+    qint32 m_maxDiscoveryRequestsPerSource;
+    qint32 m_maxDiscoveryRequests;
+    // the rate limits of answered discovery requests per second.
+    // zero means no limit.
+
+    qint32 m_maxAnnouncementRate;
+    // the maximum number of announcements sent per second. zero means no limit.
+
+    qint32 m_ssdpReceiveBufferSize;
+    qint32 m_ssdpSendBufferSize;
+    // zero means the default of the operating system
+
+    bool m_ssdpReceiveThreads;
+    bool m_sharedSsdp;
+    bool m_networkThread;
+
+    qint32 m_eventModerationWindow;
+    // the time in msecs the state changes of a service are collected
+    // into a single event notification
+
+    QString m_snapshotPath;
+    // the snapshot of the description files. empty if no snapshot is used
+
+    QString m_metricsPath;
+    // the path at which the metrics are served. empty if they are not
+
+    qint32 m_stallThreshold;
+    // in msecs, zero if stalls are not detected
+
     QList<QHostAddress> m_networkAddresses;
 
     QScopedPointer<HDeviceModelCreator> m_deviceCreator;
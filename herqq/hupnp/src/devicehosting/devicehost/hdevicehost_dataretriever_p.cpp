@@ -33,8 +33,9 @@ namespace Upnp
 {
 
 DeviceHostDataRetriever::DeviceHostDataRetriever(
-    const QByteArray& loggingId, const QUrl& rootDir) :
-        m_loggingIdentifier(loggingId), m_rootDir(rootDir)
+    const QByteArray& loggingId, const QUrl& rootDir,
+    HDeviceHostFileCache* cache) :
+        m_loggingIdentifier(loggingId), m_rootDir(rootDir), m_cache(cache)
 {
 }
 
@@ -58,6 +59,12 @@ bool DeviceHostDataRetriever::retrieveServiceDescription(
     // UDA mandates that the paths inside a device description are treated relative
     // to the device description location.
 
+    if (m_cache && m_cache->m_documents.contains(fullScpdPath))
+    {
+        *retVal = m_cache->m_documents.value(fullScpdPath);
+        return true;
+    }
+
     QFile file(fullScpdPath);
 
     HLOG_DBG(QString(
@@ -73,6 +80,10 @@ bool DeviceHostDataRetriever::retrieveServiceDescription(
     }
 
     *retVal = QString::fromUtf8(file.readAll());
+    if (m_cache)
+    {
+        m_cache->m_documents.insert(fullScpdPath, *retVal);
+    }
     return true;
 }
 
@@ -96,6 +107,12 @@ bool DeviceHostDataRetriever::retrieveIcon(
     // UDA mandates that the paths inside a device description are treated relative
     // to the device description location.
 
+    if (m_cache && m_cache->m_data.contains(fullIconPath))
+    {
+        *retVal = m_cache->m_data.value(fullIconPath);
+        return true;
+    }
+
     HLOG_DBG(QString(
         "Attempting to open a file [%1] that should contain an icon").arg(
             fullIconPath));
@@ -110,6 +127,10 @@ bool DeviceHostDataRetriever::retrieveIcon(
     }
 
     *retVal = iconFile.readAll();
+    if (m_cache)
+    {
+        m_cache->m_data.insert(fullIconPath, *retVal);
+    }
     return true;
 }
 
@@ -118,6 +139,12 @@ bool DeviceHostDataRetriever::retrieveDeviceDescription(
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
+    if (m_cache && m_cache->m_documents.contains(filePath))
+    {
+        *retVal = m_cache->m_documents.value(filePath);
+        return true;
+    }
+
     QFile file(filePath);
     if (!file.open(QIODevice::ReadOnly))
     {
@@ -129,8 +156,11 @@ bool DeviceHostDataRetriever::retrieveDeviceDescription(
     }
 
     *retVal = QString::fromUtf8(file.readAll());
+    if (m_cache)
+    {
+        m_cache->m_documents.insert(filePath, *retVal);
+    }
     return true;
-
 }
 
 }
@@ -25,6 +25,8 @@
 #include "../../general/hupnp_defs.h"
 
 #include <QtCore/QUrl>
+#include <QtCore/QHash>
+#include <QtCore/QString>
 #include <QtCore/QByteArray>
 
 namespace Herqq
@@ -33,6 +35,30 @@ namespace Herqq
 namespace Upnp
 {
 
+//
+// The files a device host has read, keyed by their paths
+//
+// The devices created from the same description files share the contents
+// of the files, which keeps the memory needed by every additional device
+// small when a large number of devices is hosted.
+//
+class HDeviceHostFileCache
+{
+public:
+
+    QHash<QString, QString> m_documents;
+    // the device and service descriptions
+
+    QHash<QString, QByteArray> m_data;
+    // the icons
+
+    inline void clear()
+    {
+        m_documents.clear();
+        m_data.clear();
+    }
+};
+
 //
 //
 //
@@ -45,6 +71,9 @@ private:
     const QByteArray m_loggingIdentifier;
     QUrl m_rootDir;
 
+    HDeviceHostFileCache* m_cache;
+    // not owned. the files are read every time if this is null
+
     QString m_lastError;
 
     bool retrieveData(const QUrl& baseUrl, const QUrl& query, QByteArray*);
@@ -52,7 +81,8 @@ private:
 public:
 
     DeviceHostDataRetriever(
-        const QByteArray& loggingId, const QUrl& rootDir);
+        const QByteArray& loggingId, const QUrl& rootDir,
+        HDeviceHostFileCache* cache = 0);
 
     bool retrieveServiceDescription(
         const QUrl& deviceLocation, const QUrl& scpdUrl, QString*);
@@ -21,14 +21,21 @@
 
 #include "hdevicehost_http_server_p.h"
 #include "hevent_subscriber_p.h"
+#include "hservermodel_creator_p.h"
+#include "hdevicehost.h"
 
 #include "../messages/hcontrol_messages_p.h"
 
+#include "../../http/hhttp_utils_p.h"
+#include "../../http/hhttp_header_p.h"
 #include "../../http/hhttp_messagecreator_p.h"
+#include "../../http/hsoap_p.h"
+#include "../../http/hopenmetrics_p.h"
 
 #include "../../general/hupnp_global_p.h"
 #include "../../general/hupnp_datatypes_p.h"
 
+#include "../../devicemodel/hdevicestatus.h"
 #include "../../devicemodel/hactionarguments.h"
 #include "../../devicemodel/server/hserveraction.h"
 #include "../../devicemodel/server/hserverdevice.h"
@@ -39,9 +46,13 @@
 #include "../../dataelements/hserviceinfo.h"
 
 #include "../../general/hlogger_p.h"
+#include "../../utils/hstallwatchdog_p.h"
 
 #include <QtCore/QUrl>
+#include <QtCore/QFile>
 #include <QtCore/QPair>
+#include <QtCore/QDateTime>
+#include <QtCore/QFileInfo>
 
 namespace Herqq
 {
@@ -71,6 +82,88 @@ inline QString extractRequestExludingUdn(const QUrl& arg)
 
     return pathToSearch;
 }
+
+// the size of a control response below which the response is not compressed
+// even if the invoker would accept it, since the savings would be negligible
+const qint32 MinCompressedResponseSize = 4096;
+
+inline qint32 configIdOf(HServerDevice* device)
+{
+    return device->rootDevice()->deviceStatus().configId();
+}
+
+bool etagMatches(const QByteArray& ifNoneMatch, const QByteArray& etag)
+{
+    QList<QByteArray> tags = ifNoneMatch.split(',');
+    foreach(QByteArray tag, tags)
+    {
+        tag = tag.trimmed();
+        if (tag == "*")
+        {
+            return true;
+        }
+        else if (tag.startsWith("W/"))
+        {
+            // a weak comparison is sufficient for a conditional GET
+            tag.remove(0, 2);
+        }
+
+        if (tag == etag)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// the formats of the icons are recognized from the data, since the icon URLs
+// do not carry the MIME types declared in the device description
+ContentType iconContentType(const QByteArray& data)
+{
+    if (data.startsWith("\x89PNG"))
+    {
+        return ContentType_ImagePng;
+    }
+    else if (data.startsWith("\xff\xd8"))
+    {
+        return ContentType_ImageJpeg;
+    }
+    else if (data.startsWith("GIF8"))
+    {
+        return ContentType_ImageGif;
+    }
+    else if (data.startsWith("BM"))
+    {
+        return ContentType_ImageBmp;
+    }
+
+    return ContentType_OctetStream;
+}
+
+inline QString controlTargetKey(const QString& path, const QString& actionName)
+{
+    return QString("%1#%2").arg(path, actionName);
+}
+
+void collectServices(HServerDevice* device, QList<HServerService*>* services)
+{
+    services->append(device->services());
+    foreach(HServerDevice* embeddedDevice, device->embeddedDevices())
+    {
+        collectServices(embeddedDevice, services);
+    }
+}
+
+QByteArray createGzipResponse(
+    const HMessagingInfo& mi, const QByteArray& gzipBody, ContentType ct)
+{
+    HHttpResponseHeader responseHdr = HHttpMessageCreator::createResponseHeader(Ok);
+    responseHdr.setValue(HHttpHeader::Field_ContentEncoding, "gzip");
+    responseHdr.setValue(HHttpHeader::Field_Vary, "Accept-Encoding");
+
+    return HHttpMessageCreator::setupData(responseHdr, gzipBody, mi, ct);
+}
 }
 
 /*******************************************************************************
@@ -82,15 +175,29 @@ HDeviceHostHttpServer::HDeviceHostHttpServer(
     HEventNotifier& en,
     QObject* parent) :
         HHttpServer(loggingId, parent),
+            m_actionExecutor(new HActionExecutor(loggingId, this)),
             m_deviceStorage(ds), m_eventNotifier(en), m_ddPostFix(ddPostFix),
-            m_ops()
+            m_ops(), m_descriptionCache(), m_iconCache(), m_controlPaths(),
+            m_controlTargets(), m_clock(), m_actionStatistics(),
+            m_metricsPath(), m_runtimeStatus(0)
 {
+    m_clock.start();
+
+    bool ok = connect(
+        m_actionExecutor, SIGNAL(jobCompleted(Herqq::Upnp::HActionJob*)),
+        this, SLOT(actionCompleted(Herqq::Upnp::HActionJob*)));
+
+    Q_ASSERT(ok); Q_UNUSED(ok)
 }
 
 HDeviceHostHttpServer::~HDeviceHostHttpServer()
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
+    // the actions that are running have to finish before the hosted devices
+    // are deleted, which happens after the server is deleted
+    delete m_actionExecutor;
+
     QList<QPair<QPointer<HHttpAsyncOperation>, HOpInfo> >::iterator it = m_ops.begin();
     for(; it != m_ops.end(); ++it)
     {
@@ -215,24 +322,30 @@ void HDeviceHostHttpServer::incomingControlRequest(
     HLOG_DBG(QString("Control message to [%1] received.").arg(
         invokeActionRequest.soapAction()));
 
-    QUuid udn = extractUdn(invokeActionRequest.serviceUrl());
+    const HSoapMessage* soapMsg = invokeActionRequest.soapMsg();
+    if (soapMsg->type() != HSoapMessage::Method)
+    {
+        HLOG_WARN("Invalid control method.");
 
-    HServerDevice* device =
-        !udn.isNull() ? m_deviceStorage.searchDeviceByUdn(HUdn(udn), AllDevices) : 0;
+        mi->setKeepAlive(false);
 
-    HServerService* service = 0;
+        m_httpHandler->send(mi, HHttpMessageCreator::createResponse(
+            BadRequest, *mi));
 
-    if (!device)
-    {
-        // the request did not have the UDN prefix, which means that either
-        // 1) the request was for a ControlURL that was defined as an absolute URL
-        //    in the device description or
-        // 2) the request is invalid
+        return;
+    }
 
-        service = m_deviceStorage.searchServiceByControlUrl(
-            invokeActionRequest.serviceUrl());
+    QString path = urlKey(invokeActionRequest.serviceUrl());
 
-        if (!service)
+    // the action is named by SOAPACTION as well, but the name in the body is
+    // the one the arguments are read with
+    QHash<QString, HControlTarget>::const_iterator target =
+        m_controlTargets.constFind(
+            controlTargetKey(path, soapMsg->methodName()));
+
+    if (target == m_controlTargets.constEnd())
+    {
+        if (!m_controlPaths.contains(path))
         {
             HLOG_WARN(QString(
                 "Ignoring invalid action invocation to: [%1].").arg(
@@ -245,117 +358,258 @@ void HDeviceHostHttpServer::incomingControlRequest(
 
             return;
         }
-    }
-    else if (!service)
-    {
-        service = m_deviceStorage.searchServiceByControlUrl(
-            device, extractRequestExludingUdn(invokeActionRequest.serviceUrl()));
-    }
 
-    if (!service)
-    {
-        HLOG_WARN(QString("Ignoring invalid action invocation to: [%1].").arg(
-            invokeActionRequest.serviceUrl().toString()));
-
-        mi->setKeepAlive(false);
-
-        m_httpHandler->send(mi, HHttpMessageCreator::createResponse(
-            BadRequest, *mi));
-
-        return;
-    }
-
-    const QtSoapMessage* soapMsg = invokeActionRequest.soapMsg();
-    const QtSoapType& method = soapMsg->method();
-    if (!method.isValid())
-    {
-        HLOG_WARN("Invalid control method.");
-
-        mi->setKeepAlive(false);
-
-        m_httpHandler->send(mi, HHttpMessageCreator::createResponse(
-            BadRequest, *mi));
-
-        return;
-    }
-
-    HServerAction* action = service->actions().value(method.name().name());
-
-    if (!action)
-    {
         HLOG_WARN(QString("The service has no action named [%1].").arg(
-            method.name().name()));
+            soapMsg->methodName()));
 
         mi->setKeepAlive(false);
         m_httpHandler->send(mi, HHttpMessageCreator::createResponse(
-            *mi, UpnpInvalidArgs, soapMsg->toXmlString()));
+            *mi, UpnpInvalidArgs, QString("No action named [%1]").arg(
+                soapMsg->methodName())));
 
         return;
     }
 
-    HActionArguments iargs = action->info().inputArguments();
+    HServerAction* action = target->m_action;
+
+    HActionArguments iargs = target->m_inputArgs;
     HActionArguments::iterator it = iargs.begin();
     for(; it != iargs.end(); ++it)
     {
         HActionArgument iarg = *it;
 
-        const QtSoapType& arg = method[iarg.name()];
-        if (!arg.isValid())
+        bool found = false;
+        QString value = soapMsg->argument(iarg.name(), &found);
+        if (!found)
         {
             mi->setKeepAlive(false);
             m_httpHandler->send(mi, HHttpMessageCreator::createResponse(
-                *mi, UpnpInvalidArgs, soapMsg->toXmlString()));
+                *mi, UpnpInvalidArgs, QString("Missing argument [%1]").arg(
+                    iarg.name())));
 
             return;
         }
 
         if (!iarg.setValue(
                 HUpnpDataTypes::convertToRightVariantType(
-                    arg.value().toString(), iarg.dataType())))
+                    value, iarg.dataType())))
         {
             mi->setKeepAlive(false);
             m_httpHandler->send(mi, HHttpMessageCreator::createResponse(
-                *mi, UpnpInvalidArgs, soapMsg->toXmlString()));
+                *mi, UpnpInvalidArgs, QString("Invalid value for [%1]").arg(
+                    iarg.name())));
+
+            return;
+        }
+    }
+
+    qint64 startedAt = m_clock.elapsed();
+
+    if (action->executionPolicy() != HServerAction::ExecuteInHostThread)
+    {
+        if (m_actionExecutor->isSaturated(action))
+        {
+            // The invoker is better off retrying later than waiting behind
+            // a queue that grows faster than the workers drain it.
+            HLOG_WARN(QString(
+                "Rejecting an invocation of action [%1]: too many "
+                "invocations are pending.").arg(action->info().name()));
+
+            sendActionResponse(
+                mi, action, invokeActionRequest.acceptsGzip(),
+                UpnpActionFailed, HActionArguments(), startedAt);
 
             return;
         }
+
+        HLOG_DBG(QString("Running action [%1] in a worker thread.").arg(
+            action->info().name()));
+
+        m_actionExecutor->execute(new HActionJob(
+            action, iargs, mi, invokeActionRequest.acceptsGzip(), startedAt));
+
+        return;
     }
 
     HActionArguments outArgs = action->info().outputArguments();
-    qint32 retVal = action->invoke(iargs, &outArgs);
-    if (retVal != UpnpSuccess)
+    qint32 retVal;
     {
+        QString actionName = action->info().name();
+        HStallWatchdog::Scope stallScope(m_stallWatchdog, actionName);
+        retVal = action->invoke(iargs, &outArgs);
+    }
+
+    sendActionResponse(
+        mi, action, invokeActionRequest.acceptsGzip(), retVal, outArgs,
+        startedAt);
+}
+
+void HDeviceHostHttpServer::sendActionResponse(
+    HMessagingInfo* mi, HServerAction* action, bool acceptsGzip, qint32 rc,
+    const HActionArguments& outArgs, qint64 startedAt)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    HActionStatistics& stats = m_actionStatistics[action->info().name()];
+    stats.m_latencies.add(static_cast<qint32>(m_clock.elapsed() - startedAt));
+
+    if (rc != UpnpSuccess)
+    {
+        ++stats.m_failures;
+
         mi->setKeepAlive(false);
         m_httpHandler->send(mi, HHttpMessageCreator::createResponse(
-            *mi, retVal, soapMsg->toXmlString()));
+            *mi, rc, upnpErrorCodeToString(rc)));
 
         return;
     }
 
-    QtSoapNamespaces::instance().registerNamespace(
-        "u", service->info().serviceType().toString());
-
-    QtSoapMessage soapResponse;
-    soapResponse.setMethod(QtSoapQName(
+    QByteArray body = HSoapMessage::createMethod(
         QString("%1%2").arg(action->info().name(), "Response"),
-        service->info().serviceType().toString()));
+        action->parentService()->info().serviceType().toString(),
+        outArgs);
 
-    foreach(const HActionArgument& oarg, outArgs)
+    if (acceptsGzip && body.size() >= MinCompressedResponseSize)
     {
-        QtSoapType* soapArg =
-            new SoapType(oarg.name(), oarg.dataType(), oarg.value());
+        // large responses, such as the DIDL-Lite documents of Browse results,
+        // compress well
+        QByteArray gzipBody = HHttpUtils::gzip(body);
+        if (!gzipBody.isEmpty() && gzipBody.size() < body.size())
+        {
+            m_httpHandler->send(
+                mi, createGzipResponse(*mi, gzipBody, ContentType_TextXml));
 
-        soapResponse.addMethodArgument(soapArg);
+            HLOG_DBG("Control message successfully handled.");
+            return;
+        }
     }
 
-    QString xml = "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\r\n" + soapResponse.toXmlString();
-
     m_httpHandler->send(mi, HHttpMessageCreator::createResponse(
-        Ok, *mi, xml.toUtf8(), ContentType_TextXml));
+        Ok, *mi, body, ContentType_TextXml));
 
     HLOG_DBG("Control message successfully handled.");
 }
 
+void HDeviceHostHttpServer::actionCompleted(HActionJob* job)
+{
+    HMessagingInfo* mi = job->m_mi;
+    job->m_mi = 0;
+
+    sendActionResponse(
+        mi, job->m_action, job->m_acceptsGzip, job->m_rc, job->m_outArgs,
+        job->m_startedAt);
+
+    delete job;
+}
+
+void HDeviceHostHttpServer::setActionThreadCount(qint32 count)
+{
+    m_actionExecutor->setMaxThreadCount(count);
+}
+
+void HDeviceHostHttpServer::addControlPath(
+    const QString& path, HServerService* service)
+{
+    if (m_controlPaths.contains(path))
+    {
+        // in case several services share a path, the requests are routed to
+        // the one that was found first
+        return;
+    }
+
+    m_controlPaths.insert(path, service);
+
+    HServerActions actions = service->actions();
+    HServerActions::const_iterator ci = actions.constBegin();
+    for(; ci != actions.constEnd(); ++ci)
+    {
+        HServerAction* action = ci.value();
+        m_controlTargets.insert(
+            controlTargetKey(path, ci.key()),
+            HControlTarget(action, action->info().inputArguments()));
+    }
+}
+
+void HDeviceHostHttpServer::addToDispatchTable(HServerDevice* device)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    // a control request may be prefixed with the UDN of any device in the
+    // tree that contains the service, and a request to a control URL that
+    // is an absolute path has no prefix at all
+    QList<HServerService*> services;
+    collectServices(device, &services);
+
+    QString udnPrefix = device->info().udn().toSimpleUuid();
+    foreach(HServerService* service, services)
+    {
+        QString controlUrlKey = urlKey(service->info().controlUrl());
+
+        addControlPath(
+            QString("%1/%2").arg(udnPrefix, controlUrlKey), service);
+
+        if (!device->parentDevice())
+        {
+            addControlPath(controlUrlKey, service);
+        }
+    }
+
+    foreach(HServerDevice* embeddedDevice, device->embeddedDevices())
+    {
+        addToDispatchTable(embeddedDevice);
+    }
+}
+
+void HDeviceHostHttpServer::removeFromDispatchTable(HServerDevice* device)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+    Q_ASSERT(!device->parentDevice());
+
+    QHash<QString, HServerService*>::iterator it = m_controlPaths.begin();
+    while (it != m_controlPaths.end())
+    {
+        if (it.value()->parentDevice()->rootDevice() == device)
+        {
+            it = m_controlPaths.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    QHash<QString, HControlTarget>::iterator tit = m_controlTargets.begin();
+    while (tit != m_controlTargets.end())
+    {
+        const HServerService* service = tit.value().m_action->parentService();
+        if (service->parentDevice()->rootDevice() == device)
+        {
+            tit = m_controlTargets.erase(tit);
+        }
+        else
+        {
+            ++tit;
+        }
+    }
+
+    // the paths of the other trees that were shadowed by the removed tree
+    // are added, since a path that is already routed is left intact
+    QList<HServerDevice*> rootDevices = m_deviceStorage.rootDevices();
+    foreach(HServerDevice* rootDevice, rootDevices)
+    {
+        if (rootDevice != device)
+        {
+            addToDispatchTable(rootDevice);
+        }
+    }
+}
+
+bool HDeviceHostHttpServer::hasPendingInvocations(
+    const HServerDevice* device) const
+{
+    return m_actionExecutor->hasPendingJobs(device);
+}
+
 void HDeviceHostHttpServer::incomingUnknownGetRequest(
     HMessagingInfo* mi, const HHttpRequestHeader& requestHdr)
 {
@@ -367,6 +621,13 @@ void HDeviceHostHttpServer::incomingUnknownGetRequest(
     HLOG_DBG(QString(
         "HTTP GET request received from [%1] to [%2].").arg(peer, requestPath));
 
+    if (!m_metricsPath.isEmpty() && requestPath == m_metricsPath)
+    {
+        HLOG_DBG(QString("Sending metrics to [%1] as requested.").arg(peer));
+        sendMetrics(mi);
+        return;
+    }
+
     QUuid searchedUdn(requestPath.section('/', 1, 1));
     if (searchedUdn.isNull())
     {
@@ -383,8 +644,10 @@ void HDeviceHostHttpServer::incomingUnknownGetRequest(
             HLOG_DBG(QString(
                 "Sending service description to [%1] as requested.").arg(peer));
 
-            m_httpHandler->send(mi, HHttpMessageCreator::createResponse(
-                Ok, *mi, service->description().toUtf8(), ContentType_TextXml));
+            sendDescription(
+                mi, requestHdr,
+                HServerModelCreator::descriptionData(service),
+                configIdOf(service->parentDevice()));
 
             return;
         }
@@ -413,8 +676,9 @@ void HDeviceHostHttpServer::incomingUnknownGetRequest(
         HLOG_DBG(QString(
             "Sending device description to [%1] as requested.").arg(peer));
 
-        m_httpHandler->send(mi, HHttpMessageCreator::createResponse(
-            Ok, *mi, device->description().toUtf8(), ContentType_TextXml));
+        sendDescription(
+            mi, requestHdr, HServerModelCreator::descriptionData(device),
+            configIdOf(device));
 
         return;
     }
@@ -429,36 +693,329 @@ void HDeviceHostHttpServer::incomingUnknownGetRequest(
         HLOG_DBG(QString(
             "Sending service description to [%1] as requested.").arg(peer));
 
+        sendDescription(
+            mi, requestHdr, HServerModelCreator::descriptionData(service),
+            configIdOf(device));
+
+        return;
+    }
+
+    bool readFailed = false;
+    const HCachedIcon* icon =
+        cachedIcon(requestPath, device, extractedRequestPart, &readFailed);
+
+    if (readFailed)
+    {
         m_httpHandler->send(mi, HHttpMessageCreator::createResponse(
-            Ok, *mi, service->description().toUtf8(), ContentType_TextXml));
+            InternalServerError, *mi));
 
         return;
     }
+    else if (icon)
+    {
+        HLOG_DBG(QString("Sending icon to [%1] as requested.").arg(peer));
+        sendIcon(mi, requestHdr, *icon);
+        return;
+    }
+
+    HLOG_WARN(QString("Responding NOT_FOUND [%1] to [%2].").arg(
+        requestHdr.path(), peerAsStr(mi->socket())));
+
+    m_httpHandler->send(mi, HHttpMessageCreator::createResponse(NotFound, *mi));
+}
+
+HCachedDescription& HDeviceHostHttpServer::cachedDescription(
+    const QString& requestPath, const HDescriptionData& description,
+    qint32 configId)
+{
+    HCachedDescription& entry = m_descriptionCache[requestPath];
+    if (entry.m_source.isSharedWith(description) && !entry.m_etag.isEmpty())
+    {
+        return entry;
+    }
 
-    QUrl icon = m_deviceStorage.seekIcon(device, extractedRequestPart);
+    // the document is decoded only once it is requested. an uncompressed
+    // document shares its data with the device model
+    entry.m_source = description;
+    entry.m_data = description.toUtf8();
+    entry.m_gzipData.clear();
+    entry.m_gzipCreated = false;
 
-    if (!icon.isEmpty())
+    // the CONFIGID changes whenever the description documents are changed,
+    // but the hash of the content is included in case a document is changed
+    // without the CONFIGID being updated
+    entry.m_etag = QByteArray("\"").append(QByteArray::number(configId)).
+        append('-').append(QByteArray::number(qHash(entry.m_data), 16)).
+        append('"');
+
+    entry.m_lastModified =
+        HHttpUtils::toHttpDate(QDateTime::currentDateTime().toUTC());
+
+    return entry;
+}
+
+void HDeviceHostHttpServer::sendDescription(
+    HMessagingInfo* mi, const HHttpRequestHeader& requestHdr,
+    const HDescriptionData& description, qint32 configId)
+{
+    HCachedDescription& entry =
+        cachedDescription(requestHdr.path(), description, configId);
+
+    QByteArray ifNoneMatch = requestHdr.rawValue(HHttpHeader::Field_IfNoneMatch);
+    if (!ifNoneMatch.isEmpty() && etagMatches(ifNoneMatch, entry.m_etag))
     {
-        QFile iconFile(icon.toLocalFile());
-        if (!iconFile.open(QIODevice::ReadOnly))
+        HLOG_DBG("The description has not been modified.");
+        sendNotModified(mi, entry.m_etag);
+        return;
+    }
+
+    bool gzip = HHttpUtils::acceptsGzip(
+        requestHdr.rawValue(HHttpHeader::Field_AcceptEncoding));
+
+    if (gzip && !entry.m_gzipCreated)
+    {
+        // the compressed form is created only once it is requested and
+        // it is kept only if it actually is smaller
+        QByteArray gzipData = HHttpUtils::gzip(entry.m_data);
+        if (!gzipData.isEmpty() && gzipData.size() < entry.m_data.size())
         {
-            HLOG_WARN(QString("Could not open icon file.").arg(icon.toLocalFile()));
-            m_httpHandler->send(mi, HHttpMessageCreator::createResponse(InternalServerError, *mi));
-            return;
+            entry.m_gzipData = gzipData;
         }
+        entry.m_gzipCreated = true;
+    }
 
-        HLOG_DBG(QString("Sending icon to [%1] as requested.").arg(peer));
+    HHttpResponseHeader responseHdr =
+        HHttpMessageCreator::createResponseHeader(Ok);
 
-        m_httpHandler->send(mi, HHttpMessageCreator::createResponse(
-            Ok, *mi, iconFile.readAll(), ContentType_TextXml));
+    responseHdr.setValue(HHttpHeader::Field_ETag, entry.m_etag);
+    responseHdr.setValue(HHttpHeader::Field_LastModified, entry.m_lastModified);
+    responseHdr.setValue(HHttpHeader::Field_Vary, "Accept-Encoding");
+
+    if (gzip && !entry.m_gzipData.isEmpty())
+    {
+        responseHdr.setValue(HHttpHeader::Field_ContentEncoding, "gzip");
+
+        m_httpHandler->send(
+            mi, HHttpMessageCreator::setupData(
+                responseHdr, entry.m_gzipData, *mi, ContentType_TextXml));
+    }
+    else
+    {
+        m_httpHandler->send(
+            mi, HHttpMessageCreator::setupData(
+                responseHdr, entry.m_data, *mi, ContentType_TextXml));
+    }
+}
+
+const HCachedIcon* HDeviceHostHttpServer::cachedIcon(
+    const QString& requestPath, HServerDevice* device, const QString& iconPart,
+    bool* readFailed)
+{
+    qint32 configId = configIdOf(device);
 
+    QHash<QString, HCachedIcon>::iterator it = m_iconCache.find(requestPath);
+    if (it != m_iconCache.end() && it->m_configId == configId)
+    {
+        return &it.value();
+    }
+
+    QUrl icon = m_deviceStorage.seekIcon(device, iconPart);
+    if (icon.isEmpty())
+    {
+        if (it != m_iconCache.end())
+        {
+            m_iconCache.erase(it);
+        }
+        return 0;
+    }
+
+    QFile iconFile(icon.toLocalFile());
+    if (!iconFile.open(QIODevice::ReadOnly))
+    {
+        HLOG_WARN(QString("Could not open icon file [%1].").arg(
+            icon.toLocalFile()));
+
+        *readFailed = true;
+        return 0;
+    }
+
+    HCachedIcon entry;
+    entry.m_data = iconFile.readAll();
+    entry.m_contentType = iconContentType(entry.m_data);
+    entry.m_configId = configId;
+
+    entry.m_etag = QByteArray("\"").append(QByteArray::number(configId)).
+        append('-').append(QByteArray::number(qHash(entry.m_data), 16)).
+        append('"');
+
+    entry.m_lastModified = HHttpUtils::toHttpDate(
+        QFileInfo(iconFile).lastModified().toUTC());
+
+    return &(m_iconCache[requestPath] = entry);
+}
+
+void HDeviceHostHttpServer::sendIcon(
+    HMessagingInfo* mi, const HHttpRequestHeader& requestHdr,
+    const HCachedIcon& icon)
+{
+    QByteArray ifNoneMatch = requestHdr.rawValue(HHttpHeader::Field_IfNoneMatch);
+    if (!ifNoneMatch.isEmpty() && etagMatches(ifNoneMatch, icon.m_etag))
+    {
+        HLOG_DBG("The icon has not been modified.");
+        sendNotModified(mi, icon.m_etag);
         return;
     }
 
-    HLOG_WARN(QString("Responding NOT_FOUND [%1] to [%2].").arg(
-        requestHdr.path(), peerAsStr(mi->socket())));
+    HHttpResponseHeader responseHdr =
+        HHttpMessageCreator::createResponseHeader(Ok);
 
-    m_httpHandler->send(mi, HHttpMessageCreator::createResponse(NotFound, *mi));
+    responseHdr.setValue(HHttpHeader::Field_ETag, icon.m_etag);
+    responseHdr.setValue(HHttpHeader::Field_LastModified, icon.m_lastModified);
+
+    m_httpHandler->send(
+        mi, HHttpMessageCreator::setupData(
+            responseHdr, icon.m_data, *mi, icon.m_contentType));
+}
+
+void HDeviceHostHttpServer::sendNotModified(
+    HMessagingInfo* mi, const QByteArray& etag)
+{
+    HHttpResponseHeader responseHdr =
+        HHttpMessageCreator::createResponseHeader(NotModified);
+
+    responseHdr.setValue(HHttpHeader::Field_ETag, etag);
+
+    m_httpHandler->send(mi, HHttpMessageCreator::setupData(responseHdr, *mi));
+}
+
+void HDeviceHostHttpServer::setMetrics(
+    const QString& path, const HDeviceHostRuntimeStatus* status)
+{
+    m_metricsPath = status ? path : QString();
+    m_runtimeStatus = status;
+}
+
+void HDeviceHostHttpServer::sendMetrics(HMessagingInfo* mi)
+{
+    Q_ASSERT(m_runtimeStatus);
+    const HDeviceHostRuntimeStatus& status = *m_runtimeStatus;
+
+    HOpenMetricsWriter writer;
+    addSsdpMetrics(writer, status);
+
+    writer.begin(
+        "hupnp_discovery_requests_ignored", "counter",
+        "Discovery requests left unanswered by reason.");
+    writer.add(
+        "hupnp_discovery_requests_ignored_total",
+        status.duplicateDiscoveryRequests(),
+        HOpenMetricsWriter::label("reason", "duplicate"));
+    writer.add(
+        "hupnp_discovery_requests_ignored_total",
+        status.sourceRateLimitedDiscoveryRequests(),
+        HOpenMetricsWriter::label("reason", "source_rate"));
+    writer.add(
+        "hupnp_discovery_requests_ignored_total",
+        status.globalRateLimitedDiscoveryRequests(),
+        HOpenMetricsWriter::label("reason", "global_rate"));
+
+    static const char* methods[] =
+    {
+        "GET", "HEAD", "POST", "NOTIFY", "SUBSCRIBE", "UNSUBSCRIBE"
+    };
+
+    writer.begin(
+        "hupnp_http_requests", "counter", "HTTP requests received by method.");
+    for(qint32 i = 0; i < 6; ++i)
+    {
+        writer.add(
+            "hupnp_http_requests_total", status.httpRequests(methods[i]),
+            HOpenMetricsWriter::label("method", methods[i]));
+    }
+
+    writer.begin(
+        "hupnp_http_open_connections", "gauge", "Open HTTP connections.");
+    writer.add("hupnp_http_open_connections", status.openConnections());
+
+    QStringList actions = status.invokedActions();
+
+    writer.begin(
+        "hupnp_action_invocations", "counter", "Action invocations by action.");
+    foreach(const QString& action, actions)
+    {
+        writer.add(
+            "hupnp_action_invocations_total", status.actionInvocations(action),
+            HOpenMetricsWriter::label("action", action));
+    }
+
+    writer.begin(
+        "hupnp_action_invocation_failures", "counter",
+        "Action invocations that did not succeed by action.");
+    foreach(const QString& action, actions)
+    {
+        writer.add(
+            "hupnp_action_invocation_failures_total",
+            status.failedActionInvocations(action),
+            HOpenMetricsWriter::label("action", action));
+    }
+
+    writer.begin(
+        "hupnp_action_latency_seconds", "summary",
+        "Duration of the recent action invocations by action.");
+    foreach(const QString& action, actions)
+    {
+        writer.addSummary(
+            "hupnp_action_latency_seconds",
+            status.actionLatency(action, 50), status.actionLatency(action, 90),
+            status.actionLatency(action, 99), status.actionInvocations(action),
+            HOpenMetricsWriter::label("action", action));
+    }
+
+    writer.begin(
+        "hupnp_event_notifications_sent", "counter",
+        "Event notifications delivered to the subscribers.");
+    writer.add(
+        "hupnp_event_notifications_sent_total",
+        status.sentEventNotifications());
+
+    writer.begin(
+        "hupnp_event_notification_failures", "counter",
+        "Event notifications that could not be delivered.");
+    writer.add(
+        "hupnp_event_notification_failures_total",
+        status.failedEventNotifications());
+
+    writer.begin(
+        "hupnp_event_notifications_merged", "counter",
+        "Event notifications merged into later notifications.");
+    writer.add(
+        "hupnp_event_notifications_merged_total",
+        status.mergedEventNotifications());
+
+    writer.begin(
+        "hupnp_event_subscribers_dropped", "counter",
+        "Event subscribers dropped after repeated delivery failures.");
+    writer.add(
+        "hupnp_event_subscribers_dropped_total",
+        status.droppedEventSubscribers());
+
+    writer.begin(
+        "hupnp_event_subscriptions", "gauge", "Active event subscriptions.");
+    writer.add("hupnp_event_subscriptions", status.activeSubscriptions());
+
+    writer.begin(
+        "hupnp_event_delivery_latency_seconds", "summary",
+        "Duration of the recent event notification deliveries.");
+    writer.addSummary(
+        "hupnp_event_delivery_latency_seconds",
+        status.eventDeliveryLatency(50), status.eventDeliveryLatency(90),
+        status.eventDeliveryLatency(99), status.sentEventNotifications());
+
+    addStallMetrics(writer, status);
+    addMemoryMetrics(writer);
+
+    m_httpHandler->send(mi, HHttpMessageCreator::createResponse(
+        Ok, *mi, writer.finish(), ContentType_OpenMetrics));
 }
 
 bool HDeviceHostHttpServer::sendComplete(HHttpAsyncOperation* op)
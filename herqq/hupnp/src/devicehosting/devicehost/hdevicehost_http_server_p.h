@@ -31,14 +31,19 @@
 //
 
 #include "hevent_notifier_p.h"
+#include "haction_executor_p.h"
 #include "hserverdevicecontroller_p.h"
 
 #include "../hdevicestorage_p.h"
 #include "../messages/hevent_messages_p.h"
 
 #include "../../http/hhttp_server_p.h"
+#include "../../utils/hlatency_samples_p.h"
+#include "../../devicemodel/hdescription_data_p.h"
 
+#include <QtCore/QHash>
 #include <QtCore/QPointer>
+#include <QtCore/QElapsedTimer>
 
 namespace Herqq
 {
@@ -71,6 +76,96 @@ public:
     inline bool isValid() const { return m_service; }
 };
 
+//
+// The encoded forms of a description document that has been served,
+// so that the document does not have to be decoded on every request
+//
+class HCachedDescription
+{
+public:
+
+    HDescriptionData m_source;
+    QByteArray m_data;
+    QByteArray m_gzipData;
+    bool m_gzipCreated;
+    QByteArray m_etag;
+    QByteArray m_lastModified;
+
+    HCachedDescription() :
+        m_source(), m_data(), m_gzipData(), m_gzipCreated(false), m_etag(),
+        m_lastModified()
+    {
+    }
+};
+
+//
+// The contents of an icon file that has been served, so that the file does
+// not have to be read on every request
+//
+class HCachedIcon
+{
+public:
+
+    QByteArray m_data;
+    ContentType m_contentType;
+    QByteArray m_etag;
+    QByteArray m_lastModified;
+
+    qint32 m_configId;
+    // the CONFIGID of the device tree when the icon was read. the icon is
+    // read again once the configuration changes
+
+    HCachedIcon() :
+        m_data(), m_contentType(ContentType_Undefined), m_etag(),
+        m_lastModified(), m_configId(-1)
+    {
+    }
+};
+
+//
+// An entry of the control dispatch table of HDeviceHostHttpServer
+//
+class HControlTarget
+{
+public:
+
+    HServerAction* m_action;
+
+    HActionArguments m_inputArgs;
+    // the input arguments of the action without values. these are copied for
+    // every invocation and the copies share the argument schema
+
+    HControlTarget() :
+        m_action(0), m_inputArgs()
+    {
+    }
+
+    HControlTarget(HServerAction* action, const HActionArguments& inputArgs) :
+        m_action(action), m_inputArgs(inputArgs)
+    {
+    }
+};
+
+//
+// The statistics of the invocations of the actions that share a name
+//
+class HActionStatistics
+{
+public:
+
+    qint64 m_failures;
+    // the number of invocations that did not succeed
+
+    HLatencySamples m_latencies;
+    // the durations of the latest invocations in msecs. the number of samples
+    // added is the number of invocations
+
+    HActionStatistics() :
+        m_failures(0), m_latencies()
+    {
+    }
+};
+
 //
 // Internal class that provides minimal HTTP server functionality for the needs of
 // Device Host
@@ -83,12 +178,66 @@ H_DISABLE_COPY(HDeviceHostHttpServer)
 
 private:
 
+    HActionExecutor* m_actionExecutor;
+
     HDeviceStorage<HServerDevice, HServerService, HServerDeviceController>& m_deviceStorage;
     HEventNotifier& m_eventNotifier;
     QString m_ddPostFix;
 
     QList<QPair<QPointer<HHttpAsyncOperation>, HOpInfo> > m_ops;
 
+    QHash<QString, HCachedDescription> m_descriptionCache;
+    QHash<QString, HCachedIcon> m_iconCache;
+    // keyed by the request path
+
+    QHash<QString, HServerService*> m_controlPaths;
+    QHash<QString, HControlTarget> m_controlTargets;
+    // the services by the request paths of their control URLs and the actions
+    // by the request paths and the names of the actions. the paths are keyed
+    // by urlKey(), both with and without the UDN prefix of each device
+
+    QElapsedTimer m_clock;
+    QHash<QString, HActionStatistics> m_actionStatistics;
+    // the statistics of the action invocations by the names of the actions
+
+    QString m_metricsPath;
+    const HDeviceHostRuntimeStatus* m_runtimeStatus;
+    // the request path of the metrics and the status they are rendered from.
+    // the metrics are not served when the path is empty
+
+    void addControlPath(const QString& path, HServerService*);
+
+    HCachedDescription& cachedDescription(
+        const QString& requestPath, const HDescriptionData& description,
+        qint32 configId);
+
+    void sendDescription(
+        HMessagingInfo*, const HHttpRequestHeader&,
+        const HDescriptionData& description, qint32 configId);
+
+    // returns the icon the request is for in case there is one, reading
+    // the icon file only if it has not been read for the current CONFIGID
+    const HCachedIcon* cachedIcon(
+        const QString& requestPath, HServerDevice*, const QString& iconPart,
+        bool* readFailed);
+
+    void sendIcon(
+        HMessagingInfo*, const HHttpRequestHeader&, const HCachedIcon&);
+
+    void sendNotModified(HMessagingInfo*, const QByteArray& etag);
+
+    void sendMetrics(HMessagingInfo*);
+
+    // the start time is the time the invocation was started, in the time of
+    // m_clock
+    void sendActionResponse(
+        HMessagingInfo*, HServerAction*, bool acceptsGzip, qint32 rc,
+        const HActionArguments& outArgs, qint64 startedAt);
+
+private Q_SLOTS:
+
+    void actionCompleted(Herqq::Upnp::HActionJob*);
+
 protected:
 
     virtual void incomingSubscriptionRequest(
@@ -113,6 +262,45 @@ public:
         QObject* parent = 0);
 
     virtual ~HDeviceHostHttpServer();
+
+    //
+    // Sets the maximum number of threads used to run the actions that are not
+    // run in the thread of the server. Zero means the number of processor
+    // cores, which is the default.
+    //
+    void setActionThreadCount(qint32 count);
+
+    //
+    // Adds the services of the device tree to the table used to route the
+    // control requests. This has to be called whenever a device tree is added
+    // to the device storage.
+    //
+    void addToDispatchTable(HServerDevice*);
+
+    //
+    // Removes the services of the device tree from the table used to route
+    // the control requests. A path the tree shared with another device tree
+    // is routed to the other tree afterwards. This has to be called before
+    // the device tree is removed from the device storage.
+    //
+    void removeFromDispatchTable(HServerDevice*);
+
+    //
+    // Indicates whether an action of the device tree is being run in
+    // a worker thread.
+    //
+    bool hasPendingInvocations(const HServerDevice*) const;
+
+    //
+    // Sets the request path at which the metrics of the runtime status are
+    // served in the OpenMetrics text format. An empty path disables them.
+    //
+    void setMetrics(const QString& path, const HDeviceHostRuntimeStatus*);
+
+    inline const QHash<QString, HActionStatistics>& actionStatistics() const
+    {
+        return m_actionStatistics;
+    }
 };
 
 }
@@ -31,9 +31,12 @@
 //
 
 #include "hdevicehost.h"
+#include "hdevicehost_dataretriever_p.h"
+#include "hservermodel_creator_p.h"
 
 #include "../hdevicestorage_p.h"
 
+#include <QtCore/QHash>
 #include <QtCore/QObject>
 #include <QtCore/QScopedPointer>
 
@@ -48,9 +51,12 @@ namespace Upnp
 
 class HDeviceHost;
 class HServerDevice;
+class HNetworkThread;
+class HTaskScheduler;
 class HDeviceStatus;
 class HEventNotifier;
 class PresenceAnnouncer;
+class HDiscoveryRequestLimiter;
 class HDeviceHostHttpServer;
 class HDeviceHostSsdpHandler;
 class HServerDeviceController;
@@ -91,6 +97,9 @@ public: // attributes
     QScopedPointer<PresenceAnnouncer> m_presenceAnnouncer;
     // Creates and sends the SSDP "presence announcement" messages
 
+    QScopedPointer<HDiscoveryRequestLimiter> m_discoveryRequestLimiter;
+    // Decides which discovery requests the SSDP handlers answer
+
     QScopedPointer<HDeviceHostRuntimeStatus> m_runtimeStatus;
     //
 
@@ -103,12 +112,34 @@ public: // attributes
 
     bool m_initialized;
 
+    QHash<const HServerDeviceController*, const HDeviceConfiguration*>
+        m_deviceConfigurations;
+    // the configuration in m_config each root device was created from
+
     HDeviceStorage<HServerDevice, HServerService, HServerDeviceController> m_deviceStorage;
     // This contains the root devices and it provides lookup methods to the
     // contents of the device tree
 
     QNetworkAccessManager* m_nam;
 
+    HDeviceHostFileCache m_fileCache;
+    // the description files and icons read while the host runs, which are
+    // shared by the devices created from the same files
+
+    HServicePrototypes m_servicePrototypes;
+    // the services validated while the host runs. the services identical
+    // to these are created without validating them again
+
+    HNetworkThread* m_networkThread;
+    // the thread the device host is run in, if the configuration asked
+    // for one. the calls to init() and quit() from other threads are run
+    // in this thread
+
+    HTaskScheduler* m_taskScheduler;
+    // runs long operations in slices between the network events of the
+    // device host. this is a child of this object and it moves to the
+    // network thread along with the device host
+
 public Q_SLOTS:
 
     void announcementTimedout(HServerDeviceController*);
@@ -120,10 +151,48 @@ public: // methods
     virtual ~HDeviceHostPrivate();
 
     void stopNotifiers();
-    void startNotifiers(HServerDeviceController*);
+    void startNotifiers(
+        HServerDeviceController*, qint32 firstTimeoutInMsecs = -1);
     void startNotifiers();
-    bool createRootDevice(const HDeviceConfiguration*);
-    bool createRootDevices();
+
+    // creates the device model of a root device, but does not host it.
+    // returns null and sets the error in case the model could not be created
+    HServerDevice* createDeviceModel(
+        const HDeviceConfiguration*, const QString& deviceDescription,
+        const HParsedServiceDescriptions*);
+
+    // starts to host a root device created with createDeviceModel() and
+    // takes its ownership. returns null and deletes the device in case
+    // it could not be hosted
+    HServerDeviceController* addRootDevice(
+        HServerDevice*, const HDeviceConfiguration*);
+
+    // stops hosting a root device and deletes it, without announcing
+    // anything. the configuration of the device is not removed
+    void removeRootDevice(HServerDeviceController*);
+
+    HServerDeviceController* createRootDevice(
+        const HDeviceConfiguration*, const QString& deviceDescription,
+        const HParsedServiceDescriptions*);
+    bool createRootDevices(
+        const QList<const HDeviceConfiguration*>&,
+        const QString& snapshotPath = QString());
+
+    // creates an SSDP handler configured according to the configuration of
+    // the device host. the handler is not initialized
+    HDeviceHostSsdpHandler* createSsdpHandler();
+
+    // sets the locations of the root devices to match the endpoints of the
+    // HTTP server and optionally moves the devices to their next boot ID
+    void updateRootDevices(bool nextBootId);
+
+    // advertises the port of the unicast sockets of the SSDP handlers as
+    // the SEARCHPORT.UPNP.ORG of the root devices in case it is not 1900
+    void updateSearchPort();
+
+    // sets the network addresses of the configuration to the ones the
+    // SSDP handlers are bound to
+    void updateNetworkAddresses();
 
     inline static const QString& deviceDescriptionPostFix()
     {
@@ -21,6 +21,7 @@
 
 #include "hdevicehost_ssdp_handler_p.h"
 #include "hserverdevicecontroller_p.h"
+#include "hdiscoveryrequest_limiter_p.h"
 
 #include "../../general/hupnp_global_p.h"
 
@@ -37,8 +38,14 @@
 #include "../../general/hlogger_p.h"
 #include "../../utils/hsysutils_p.h"
 
+#include "../../http/hhttp_messagecreator_p.h"
+#include "../../ssdp/hssdp_messagecreator_p.h"
+
 #include <QtCore/QUuid>
 #include <QtCore/QDateTime>
+#include <QtCore/QTimerEvent>
+
+#include <algorithm>
 
 namespace Herqq
 {
@@ -46,38 +53,60 @@ namespace Herqq
 namespace Upnp
 {
 
-/*******************************************************************************
- * HDelayedWriter
- ******************************************************************************/
-HDelayedWriter::HDelayedWriter(
-    HDeviceHostSsdpHandler& ssdp,
-    const QList<HDiscoveryResponse>& responses,
-    const HEndpoint& source,
-    qint32 msecs) :
-        QObject(&ssdp),
-            m_ssdp(ssdp), m_responses(responses), m_source(source), m_msecs(msecs)
+namespace
 {
-}
-
-void HDelayedWriter::timerEvent(QTimerEvent*)
+// the maximum number of cached response sets. the cache is emptied when
+// this is reached, which bounds the memory used by unique search targets
+const qint32 MaxCachedResponseSets = 128;
+
+//
+// HDeviceStorage::searchValidLocation() picks the location of a device by
+// the /24 subnet of the requestor. Requestors in the same subnet therefore
+// receive the same responses.
+//
+QString subnetOf(const HEndpoint& source)
 {
-    HLOG2(H_AT, H_FUN, m_ssdp.loggingIdentifier());
-    foreach(const HDiscoveryResponse& resp, m_responses)
+    QHostAddress ha = source.hostAddress();
+    if (ha.protocol() == QAbstractSocket::IPv4Protocol)
     {
-        qint32 count = m_ssdp.sendDiscoveryResponse(resp, m_source);
-        if (count <= 0)
-        {
-            HLOG_WARN(QString("Failed to send discovery response [%1] to: [%2].").arg(
-                resp.usn().toString(), m_source.toString()));
-        }
+        return QString::number(ha.toIPv4Address() & 0xffffff00, 16);
     }
 
-    emit sent();
+    return ha.toString();
 }
 
-void HDelayedWriter::run()
+// the maximum number of responses sent at the same randomized time. larger
+// response sets are split, which spreads them over the delay window
+const qint32 MaxResponsesPerBatch = 8;
+
+// the maximum delay a requestor may ask for according to the UDA
+const qint32 MaxMx = 5;
+
+QString requestKeyOf(const HDiscoveryRequest& msg, const HEndpoint& source)
+{
+    return msg.searchTarget().toString().append(' ').append(
+        subnetOf(source));
+}
+
+// orders the schedule into a min-heap
+inline bool dueLater(
+    const HScheduledResponses& obj1, const HScheduledResponses& obj2)
 {
-   startTimer(m_msecs);
+    return obj1.m_dueTime > obj2.m_dueTime;
+}
+
+// adds the DATE field to the end of the serialized response header
+QByteArray withDate(const QByteArray& response, const QByteArray& date)
+{
+    Q_ASSERT(response.endsWith("\r\n\r\n"));
+
+    QByteArray retVal;
+    retVal.reserve(response.size() + date.size() + 8);
+    retVal.append(response.constData(), response.size() - 2)
+          .append("DATE: ", 6).append(date).append("\r\n\r\n", 4);
+
+    return retVal;
+}
 }
 
 /*******************************************************************************
@@ -86,9 +115,12 @@ void HDelayedWriter::run()
 HDeviceHostSsdpHandler::HDeviceHostSsdpHandler(
     const QByteArray& loggingIdentifier,
     HDeviceStorage<HServerDevice, HServerService, HServerDeviceController>& ds,
-    QObject* parent) :
-        HSsdp(loggingIdentifier, parent), m_deviceStorage(ds)
+    HDiscoveryRequestLimiter* limiter, QObject* parent) :
+        HSsdp(loggingIdentifier, parent), m_deviceStorage(ds),
+            m_responseCache(), m_responseCacheRevision(ds.revision()),
+            m_schedule(), m_limiter(limiter), m_clock(), m_scheduleTimer()
 {
+    m_clock.start();
     Q_ASSERT(parent);
     setFilter(DiscoveryRequest);
 }
@@ -146,7 +178,8 @@ bool HDeviceHostSsdpHandler::processSearchRequest_specificDevice(
             HSysInfo::instance().herqqProductTokens(),
             st, // the searched usn
             device->deviceStatus().bootId(),
-            device->deviceStatus().configId()
+            device->deviceStatus().configId(),
+            device->deviceStatus().searchPort()
             ));
 
     return true;
@@ -203,7 +236,8 @@ bool HDeviceHostSsdpHandler::processSearchRequest_deviceType(
                 HSysInfo::instance().herqqProductTokens(),
                 st,
                 device->deviceStatus().bootId(),
-                device->deviceStatus().configId()
+                device->deviceStatus().configId(),
+                device->deviceStatus().searchPort()
                 ));
     }
 
@@ -271,7 +305,8 @@ bool HDeviceHostSsdpHandler::processSearchRequest_serviceType(
                 HSysInfo::instance().herqqProductTokens(),
                 st,
                 dc->deviceStatus().bootId(),
-                dc->deviceStatus().configId()
+                dc->deviceStatus().configId(),
+                dc->deviceStatus().searchPort()
                 ));
     }
 
@@ -285,9 +320,7 @@ void HDeviceHostSsdpHandler::processSearchRequest(
     HLOG2(H_AT, H_FUN, h_ptr->m_loggingIdentifier);
     Q_ASSERT(device);
 
-    HDeviceInfo deviceInfo = device->info();
-    HProductTokens pt = HSysInfo::instance().herqqProductTokens();
-    HDiscoveryType usn(deviceInfo.udn());
+    const HProductTokens& pt = HSysInfo::instance().herqqProductTokens();
 
     const HServerDeviceController* controller =
         m_deviceStorage.getController(device);
@@ -296,36 +329,17 @@ void HDeviceHostSsdpHandler::processSearchRequest(
 
     const HDeviceStatus& deviceStatus = device->deviceStatus();
 
-    // device UDN
-    responses->push_back(
-        HDiscoveryResponse(
-            controller->deviceTimeoutInSecs() * 2,
-            QDateTime::currentDateTime(), location, pt, usn,
-            deviceStatus.bootId(),
-            deviceStatus.configId()));
-
-    usn.setResourceType(deviceInfo.deviceType());
-
-    // device type
-    responses->push_back(
-        HDiscoveryResponse(
-            controller->deviceTimeoutInSecs() * 2,
-            QDateTime::currentDateTime(), location, pt, usn,
-            deviceStatus.bootId(),
-            deviceStatus.configId()));
-
-    const HServerServices& services = device->services();
-    foreach(const HServerService* service, services)
+    // the device UDN, the device type and the service types
+    const QList<HDiscoveryType>& usns = controller->usns(device);
+    foreach(const HDiscoveryType& usn, usns)
     {
-        usn.setResourceType(service->info().serviceType());
-
         responses->push_back(
             HDiscoveryResponse(
                 controller->deviceTimeoutInSecs() * 2,
                 QDateTime::currentDateTime(), location, pt, usn,
                 deviceStatus.bootId(),
-                deviceStatus.configId()
-                ));
+                deviceStatus.configId(),
+                deviceStatus.searchPort()));
     }
 
     const HServerDevices& devices = device->embeddedDevices();
@@ -360,8 +374,6 @@ bool HDeviceHostSsdpHandler::processSearchRequest_AllDevices(
             continue;
         }
 
-        HDiscoveryType usn(rootDevice->info().udn(), true);
-
         const HServerDeviceController* controller =
             m_deviceStorage.getController(rootDevice);
 
@@ -373,9 +385,10 @@ bool HDeviceHostSsdpHandler::processSearchRequest_AllDevices(
                 QDateTime::currentDateTime(),
                 location,
                 pt,
-                usn,
+                controller->rootDeviceUsn(),
                 rootDevice->deviceStatus().bootId(),
-                rootDevice->deviceStatus().configId()
+                rootDevice->deviceStatus().configId(),
+                rootDevice->deviceStatus().searchPort()
                 ));
 
         processSearchRequest(rootDevice, location, responses);
@@ -428,8 +441,6 @@ bool HDeviceHostSsdpHandler::processSearchRequest_RootDevice(
             continue;
         }
 
-        HDiscoveryType usn(rootDevice->info().udn(), true);
-
         const HServerDeviceController* controller =
             m_deviceStorage.getController(rootDevice);
 
@@ -441,22 +452,36 @@ bool HDeviceHostSsdpHandler::processSearchRequest_RootDevice(
                 QDateTime::currentDateTime(),
                 location,
                 HSysInfo::instance().herqqProductTokens(),
-                usn,
+                controller->rootDeviceUsn(),
                 rootDevice->deviceStatus().bootId(),
-                rootDevice->deviceStatus().configId()));
+                rootDevice->deviceStatus().configId(),
+                rootDevice->deviceStatus().searchPort()));
     }
 
     return responses->size() > prevSize;
 }
 
-bool HDeviceHostSsdpHandler::incomingDiscoveryRequest(
-    const HDiscoveryRequest& msg, const HEndpoint& source,
-    DiscoveryRequestMethod requestType)
+QList<QByteArray> HDeviceHostSsdpHandler::cachedResponses(
+    const HDiscoveryRequest& msg, const HEndpoint& source)
 {
     HLOG2(H_AT, H_FUN, h_ptr->m_loggingIdentifier);
 
-    HLOG_DBG(QString("Received discovery request for [%1] from [%2]").arg(
-        msg.searchTarget().toString(), source.toString()));
+    if (m_responseCacheRevision != m_deviceStorage.revision())
+    {
+        // devices have been added or removed since the responses were built
+        m_responseCache.clear();
+        m_responseCacheRevision = m_deviceStorage.revision();
+    }
+
+    QString key = requestKeyOf(msg, source);
+
+    QHash<QString, QList<QByteArray> >::const_iterator ci =
+        m_responseCache.constFind(key);
+
+    if (ci != m_responseCache.constEnd())
+    {
+        return ci.value();
+    }
 
     bool ok = false;
     QList<HDiscoveryResponse> responses;
@@ -483,38 +508,194 @@ bool HDeviceHostSsdpHandler::incomingDiscoveryRequest(
             break;
 
         default:
-            return true;
+            Q_ASSERT(false);
     }
 
+    QList<QByteArray> retVal;
     if (ok)
     {
-        if (requestType == MulticastDiscovery)
+        foreach(const HDiscoveryResponse& resp, responses)
         {
-            HDelayedWriter* writer =
-                new HDelayedWriter(
-                    *this, responses, source, (qrand() % msg.mx()) * 1000);
+            QByteArray data = HSsdpMessageCreator::create(resp);
+            if (!data.isEmpty())
+            {
+                retVal.append(data);
+            }
+        }
+    }
+
+    if (m_responseCache.size() >= MaxCachedResponseSets)
+    {
+        m_responseCache.clear();
+    }
 
-            bool ok =
-                connect(writer, SIGNAL(sent()), writer, SLOT(deleteLater()));
+    // empty sets are cached as well, since requests for resources that are
+    // not hosted have to be processed as cheaply as the rest
+    m_responseCache.insert(key, retVal);
 
-            Q_ASSERT(ok); Q_UNUSED(ok)
+    return retVal;
+}
 
-            writer->run();
-        }
-        else
+qint32 HDeviceHostSsdpHandler::sendResponses(
+    const QList<QByteArray>& responses, const HEndpoint& destination)
+{
+    if (!isInitialized() || destination.isNull())
+    {
+        return -1;
+    }
+
+    QByteArray date = HHttpMessageCreator::currentDate();
+
+    QList<QByteArray> data;
+    data.reserve(responses.size());
+    foreach(const QByteArray& response, responses)
+    {
+        data.append(withDate(response, date));
+    }
+
+    return h_ptr->send(data, destination);
+}
+
+void HDeviceHostSsdpHandler::schedule(
+    const QList<QByteArray>& responses, const HEndpoint& destination,
+    qint32 mx)
+{
+    qint32 windowMsecs = qBound(1, mx, MaxMx) * 1000;
+    qint64 now = m_clock.elapsed();
+
+    for (qint32 i = 0; i < responses.size(); i += MaxResponsesPerBatch)
+    {
+        HScheduledResponses entry;
+        entry.m_dueTime = now + qrand() % windowMsecs;
+        entry.m_destination = destination;
+        entry.m_responses = responses.mid(i, MaxResponsesPerBatch);
+
+        m_schedule.append(entry);
+        std::push_heap(m_schedule.begin(), m_schedule.end(), dueLater);
+    }
+
+    restartScheduleTimer();
+}
+
+void HDeviceHostSsdpHandler::restartScheduleTimer()
+{
+    if (m_schedule.isEmpty())
+    {
+        m_scheduleTimer.stop();
+        return;
+    }
+
+    qint64 wait = m_schedule.first().m_dueTime - m_clock.elapsed();
+    m_scheduleTimer.start(static_cast<int>(qMax(wait, qint64(0))), this);
+}
+
+void HDeviceHostSsdpHandler::sendDueResponses()
+{
+    HLOG2(H_AT, H_FUN, h_ptr->m_loggingIdentifier);
+
+    qint64 now = m_clock.elapsed();
+
+    // the responses that are due are grouped by the destination, so that
+    // each destination gets its responses in a single batch
+    QList<HScheduledResponses> due;
+    while (!m_schedule.isEmpty() && m_schedule.first().m_dueTime <= now)
+    {
+        std::pop_heap(m_schedule.begin(), m_schedule.end(), dueLater);
+        HScheduledResponses entry = m_schedule.last();
+        m_schedule.pop_back();
+
+        bool merged = false;
+        for (qint32 i = 0; i < due.size(); ++i)
         {
-            foreach (const HDiscoveryResponse& resp, responses)
+            if (due[i].m_destination == entry.m_destination)
             {
-                qint32 count = sendDiscoveryResponse(resp, source);
-                Q_ASSERT(count >= 0); Q_UNUSED(count)
+                due[i].m_responses.append(entry.m_responses);
+                merged = true;
+                break;
             }
         }
+
+        if (!merged)
+        {
+            due.append(entry);
+        }
+    }
+
+    foreach(const HScheduledResponses& entry, due)
+    {
+        qint32 count = sendResponses(entry.m_responses, entry.m_destination);
+        if (count < entry.m_responses.size())
+        {
+            HLOG_WARN(QString(
+                "Failed to send %1 of %2 discovery responses to: [%3].").arg(
+                    QString::number(entry.m_responses.size() - qMax(count, 0)),
+                    QString::number(entry.m_responses.size()),
+                    entry.m_destination.toString()));
+        }
+    }
+
+    restartScheduleTimer();
+}
+
+void HDeviceHostSsdpHandler::timerEvent(QTimerEvent* event)
+{
+    if (event->timerId() == m_scheduleTimer.timerId())
+    {
+        sendDueResponses();
     }
     else
+    {
+        HSsdp::timerEvent(event);
+    }
+}
+
+bool HDeviceHostSsdpHandler::incomingDiscoveryRequest(
+    const HDiscoveryRequest& msg, const HEndpoint& source,
+    DiscoveryRequestMethod requestType)
+{
+    HLOG2(H_AT, H_FUN, h_ptr->m_loggingIdentifier);
+
+    HLOG_DBG(QString("Received discovery request for [%1] from [%2]").arg(
+        msg.searchTarget().toString(), source.toString()));
+
+    switch (msg.searchTarget().type())
+    {
+        case HDiscoveryType::All:
+        case HDiscoveryType::RootDevices:
+        case HDiscoveryType::SpecificDevice:
+        case HDiscoveryType::DeviceType:
+        case HDiscoveryType::ServiceType:
+            break;
+
+        default:
+            return true;
+    }
+
+    if (m_limiter && !m_limiter->admit(
+            requestKeyOf(msg, source).append(' ').append(source.toString()),
+            source, msg.mx()))
+    {
+        return true;
+    }
+
+    QList<QByteArray> responses = cachedResponses(msg, source);
+    if (responses.isEmpty())
     {
         HLOG_DBG(QString(
             "No resources found for discovery request [%1] from [%2]").arg(
                 msg.searchTarget().toString(), source.toString()));
+
+        return true;
+    }
+
+    if (requestType == MulticastDiscovery)
+    {
+        schedule(responses, source, msg.mx());
+    }
+    else
+    {
+        qint32 count = sendResponses(responses, source);
+        Q_ASSERT(count >= 0); Q_UNUSED(count)
     }
 
     return true;
@@ -38,7 +38,11 @@
 
 #include "../../socket/hendpoint.h"
 
+#include <QtCore/QHash>
 #include <QtCore/QList>
+#include <QtCore/QVector>
+#include <QtCore/QBasicTimer>
+#include <QtCore/QElapsedTimer>
 
 namespace Herqq
 {
@@ -47,42 +51,19 @@ namespace Upnp
 {
 
 class HServerDevice;
-class HDeviceHostSsdpHandler;
 class HServerDeviceController;
+class HDiscoveryRequestLimiter;
 
 //
+// A set of discovery responses waiting for its randomized send time
 //
-//
-class HDelayedWriter :
-    public QObject
+struct HScheduledResponses
 {
-Q_OBJECT
-H_DISABLE_COPY(HDelayedWriter)
-
-private:
-
-    HDeviceHostSsdpHandler& m_ssdp;
-    QList<HDiscoveryResponse> m_responses;
-    HEndpoint m_source;
-    qint32 m_msecs;
-
-protected:
-
-    void timerEvent(QTimerEvent*);
+    qint64 m_dueTime;
+    // the time when the responses should be sent, in milliseconds
 
-public:
-
-    HDelayedWriter(
-        HDeviceHostSsdpHandler&,
-        const QList<HDiscoveryResponse>&,
-        const HEndpoint& source,
-        qint32 msecs);
-
-    void run();
-
-Q_SIGNALS:
-
-    void sent();
+    HEndpoint m_destination;
+    QList<QByteArray> m_responses;
 };
 
 //
@@ -97,8 +78,35 @@ private:
 
     HDeviceStorage<HServerDevice, HServerService, HServerDeviceController>& m_deviceStorage;
 
+    QHash<QString, QList<QByteArray> > m_responseCache;
+    // the serialized discovery responses keyed by the search target and
+    // the subnet of the requestor. the DATE field is added when sending
+
+    quint32 m_responseCacheRevision;
+    // the revision of the device storage the cached responses were built of
+
+    QVector<HScheduledResponses> m_schedule;
+    // the responses to multicast discovery requests in a min-heap ordered
+    // by the send time
+
+    HDiscoveryRequestLimiter* m_limiter;
+    // decides which requests are answered. may be shared by several handlers
+
+    QElapsedTimer m_clock;
+    QBasicTimer m_scheduleTimer;
+
 private:
 
+    void schedule(
+        const QList<QByteArray>& responses, const HEndpoint& destination,
+        qint32 mx);
+
+    void restartScheduleTimer();
+    void sendDueResponses();
+
+    QList<QByteArray> cachedResponses(
+        const HDiscoveryRequest&, const HEndpoint& source);
+
     void processSearchRequest(
         const HServerDevice*, const QUrl& deviceLocation,
         QList<HDiscoveryResponse>*);
@@ -125,6 +133,8 @@ private:
 
 protected:
 
+    virtual void timerEvent(QTimerEvent*);
+
     virtual bool incomingDiscoveryRequest(
         const HDiscoveryRequest&, const HEndpoint&, DiscoveryRequestMethod);
 
@@ -133,7 +143,7 @@ public:
     HDeviceHostSsdpHandler(
         const QByteArray& loggingIdentifier,
         HDeviceStorage<HServerDevice, HServerService, HServerDeviceController>&,
-        QObject* parent = 0);
+        HDiscoveryRequestLimiter* limiter, QObject* parent = 0);
 
     virtual ~HDeviceHostSsdpHandler();
 
@@ -141,6 +151,17 @@ public:
     {
         return h_ptr->m_loggingIdentifier;
     }
+
+    // sends the specified serialized discovery responses after adding the
+    // DATE field to them
+    qint32 sendResponses(
+        const QList<QByteArray>& responses, const HEndpoint& destination);
+
+    // multicasts the specified pre-serialized announcements
+    inline qint32 announce(const QList<QByteArray>& datagrams)
+    {
+        return h_ptr->announce(datagrams);
+    }
 };
 
 }
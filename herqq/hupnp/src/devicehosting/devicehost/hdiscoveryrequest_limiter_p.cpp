@@ -0,0 +1,242 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hdiscoveryrequest_limiter_p.h"
+
+#include "../../socket/hendpoint.h"
+#include "../../general/hlogger_p.h"
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace
+{
+// the number of tracked requestors and requests after which the idle
+// entries are removed
+const qint32 PruneThreshold = 1024;
+
+// the maximum number of tracked requestors and requests. once a table is
+// full, the requests that would need a new entry are ignored
+const qint32 MaxTrackedEntries = 8192;
+
+// the interval at which a table that is at its capacity is pruned
+const qint32 FullPruneIntervalInMsecs = 1000;
+
+qint32 nextPruneSize(qint32 size)
+{
+    return qBound(PruneThreshold, size * 2, MaxTrackedEntries);
+}
+
+// the maximum response window a requestor may ask for according to the UDA
+const qint32 MaxMx = 5;
+}
+
+/*******************************************************************************
+ * HTokenBucket
+ ******************************************************************************/
+bool HTokenBucket::consume(qint64 now)
+{
+    qint64 capacity = m_rate * 1000;
+
+    m_tokens = qMin(capacity, m_tokens + (now - m_lastRefill) * m_rate);
+    m_lastRefill = now;
+
+    if (m_tokens < 1000)
+    {
+        return false;
+    }
+
+    m_tokens -= 1000;
+    return true;
+}
+
+bool HTokenBucket::isFull(qint64 now) const
+{
+    return m_tokens + (now - m_lastRefill) * m_rate >= m_rate * 1000;
+}
+
+/*******************************************************************************
+ * HDiscoveryRequestLimiter
+ ******************************************************************************/
+HDiscoveryRequestLimiter::HDiscoveryRequestLimiter(
+    qint32 maxRequestsPerSource, qint32 maxRequests) :
+        m_maxRequestsPerSource(maxRequestsPerSource),
+        m_maxRequests(maxRequests),
+        m_clock(),
+        m_globalBucket(),
+        m_sourceBuckets(),
+        m_recentRequests(),
+        m_sourcesPruneSize(PruneThreshold),
+        m_requestsPruneSize(PruneThreshold),
+        m_nextFullPrune(0),
+        m_duplicateRequests(0),
+        m_sourceLimitedRequests(0),
+        m_globalLimitedRequests(0)
+{
+    m_clock.start();
+    m_globalBucket = HTokenBucket(m_maxRequests, m_clock.elapsed());
+}
+
+bool HDiscoveryRequestLimiter::shouldPrune(
+    qint32 size, qint32 pruneSize, qint64 now) const
+{
+    // a full table may consist of entries that are all in use, in which case
+    // pruning it on every request would only waste time
+    return size >= pruneSize &&
+           (pruneSize < MaxTrackedEntries || now >= m_nextFullPrune);
+}
+
+void HDiscoveryRequestLimiter::prune(qint64 now)
+{
+    bool pruned = false;
+    if (shouldPrune(m_recentRequests.size(), m_requestsPruneSize, now))
+    {
+        QHash<QString, qint64>::iterator it = m_recentRequests.begin();
+        while (it != m_recentRequests.end())
+        {
+            if (it.value() <= now)
+            {
+                it = m_recentRequests.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        m_requestsPruneSize = nextPruneSize(m_recentRequests.size());
+        pruned = true;
+    }
+
+    if (shouldPrune(m_sourceBuckets.size(), m_sourcesPruneSize, now))
+    {
+        QHash<QString, HTokenBucket>::iterator it = m_sourceBuckets.begin();
+        while (it != m_sourceBuckets.end())
+        {
+            if (it.value().isFull(now))
+            {
+                it = m_sourceBuckets.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        m_sourcesPruneSize = nextPruneSize(m_sourceBuckets.size());
+        pruned = true;
+    }
+
+    if (pruned)
+    {
+        m_nextFullPrune = now + FullPruneIntervalInMsecs;
+    }
+}
+
+bool HDiscoveryRequestLimiter::admit(
+    const QString& requestKey, const HEndpoint& source, qint32 mx)
+{
+    HLOG(H_AT, H_FUN);
+
+    qint64 now = m_clock.elapsed();
+    prune(now);
+
+    QHash<QString, qint64>::const_iterator ci =
+        m_recentRequests.constFind(requestKey);
+
+    if (ci != m_recentRequests.constEnd() && ci.value() > now)
+    {
+        // the requestor has repeated the request within the response
+        // window. the responses sent to the first one answer both.
+        ++m_duplicateRequests;
+        HLOG_DBG(QString("Ignoring a repeated discovery request from [%1]").arg(
+            source.toString()));
+
+        return false;
+    }
+
+    if (ci == m_recentRequests.constEnd() &&
+        m_recentRequests.size() >= MaxTrackedEntries)
+    {
+        ++m_globalLimitedRequests;
+        HLOG_DBG(QString(
+            "Ignoring a discovery request from [%1]: too many requests "
+            "are tracked").arg(source.toString()));
+
+        return false;
+    }
+
+    if (m_maxRequestsPerSource > 0)
+    {
+        QString sourceKey = source.hostAddress().toString();
+
+        QHash<QString, HTokenBucket>::iterator it =
+            m_sourceBuckets.find(sourceKey);
+
+        if (it == m_sourceBuckets.end())
+        {
+            if (m_sourceBuckets.size() >= MaxTrackedEntries)
+            {
+                // the requestors cannot be told apart from the ones that
+                // spoof their addresses, which is why the new ones are
+                // ignored until the idle requestors have been forgotten
+                ++m_sourceLimitedRequests;
+                HLOG_DBG(QString(
+                    "Ignoring a discovery request from [%1]: too many "
+                    "requestors are tracked").arg(source.toString()));
+
+                return false;
+            }
+
+            it = m_sourceBuckets.insert(
+                sourceKey, HTokenBucket(m_maxRequestsPerSource, now));
+        }
+
+        if (!it.value().consume(now))
+        {
+            ++m_sourceLimitedRequests;
+            HLOG_DBG(QString(
+                "Ignoring a discovery request from [%1]: the requestor "
+                "exceeds its rate limit").arg(source.toString()));
+
+            return false;
+        }
+    }
+
+    if (m_maxRequests > 0 && !m_globalBucket.consume(now))
+    {
+        ++m_globalLimitedRequests;
+        HLOG_DBG(QString(
+            "Ignoring a discovery request from [%1]: the device host "
+            "exceeds its rate limit").arg(source.toString()));
+
+        return false;
+    }
+
+    m_recentRequests.insert(requestKey, now + qBound(1, mx, MaxMx) * 1000);
+    return true;
+}
+
+}
+}
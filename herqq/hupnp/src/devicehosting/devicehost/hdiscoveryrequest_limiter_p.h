@@ -0,0 +1,148 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HDISCOVERYREQUEST_LIMITER_P_H_
+#define HDISCOVERYREQUEST_LIMITER_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include "../../general/hupnp_defs.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QString>
+#include <QtCore/QElapsedTimer>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+class HEndpoint;
+
+//
+// A token bucket that is refilled at the specified rate per second and that
+// holds at most the same amount of tokens. The tokens are counted in
+// thousandths to avoid floating point arithmetic.
+//
+class HTokenBucket
+{
+private:
+
+    qint64 m_rate;
+    qint64 m_tokens;
+    qint64 m_lastRefill;
+
+public:
+
+    inline HTokenBucket() :
+        m_rate(0), m_tokens(0), m_lastRefill(0)
+    {
+    }
+
+    inline HTokenBucket(qint32 ratePerSecond, qint64 now) :
+        m_rate(ratePerSecond), m_tokens(m_rate * 1000), m_lastRefill(now)
+    {
+    }
+
+    // consumes a token and returns true in case one is available
+    bool consume(qint64 now);
+
+    // returns true in case the bucket has been refilled completely, which
+    // means that it has not been used for a while
+    bool isFull(qint64 now) const;
+};
+
+//
+// Decides which discovery requests the device host answers. The requests
+// can be limited per requestor and in total using token buckets and the
+// repetitions of a request within the response window are suppressed.
+//
+class HDiscoveryRequestLimiter
+{
+H_DISABLE_COPY(HDiscoveryRequestLimiter)
+
+private:
+
+    const qint32 m_maxRequestsPerSource;
+    const qint32 m_maxRequests;
+    // the maximum number of requests per second. zero means no limit
+
+    QElapsedTimer m_clock;
+
+    HTokenBucket m_globalBucket;
+    QHash<QString, HTokenBucket> m_sourceBuckets;
+    // the buckets of requestors, keyed by the host address
+
+    QHash<QString, qint64> m_recentRequests;
+    // the requests that have been admitted recently and the time until
+    // which their repetitions are suppressed
+
+    qint32 m_sourcesPruneSize;
+    qint32 m_requestsPruneSize;
+    // the sizes at which the idle entries are removed from the tables next.
+    // a table is pruned once it has doubled in size since it was last
+    // pruned, which spreads the cost of pruning over the requests
+
+    qint64 m_nextFullPrune;
+    // the earliest time a table that is at its capacity is pruned again
+
+    qint64 m_duplicateRequests;
+    qint64 m_sourceLimitedRequests;
+    qint64 m_globalLimitedRequests;
+
+    bool shouldPrune(qint32 size, qint32 pruneSize, qint64 now) const;
+    void prune(qint64 now);
+
+public:
+
+    HDiscoveryRequestLimiter(qint32 maxRequestsPerSource, qint32 maxRequests);
+
+    // returns true in case the request identified by the specified key
+    // should be answered. mx is the response window in seconds
+    bool admit(const QString& requestKey, const HEndpoint& source, qint32 mx);
+
+    inline qint64 duplicateRequests() const
+    {
+        return m_duplicateRequests;
+    }
+
+    inline qint64 sourceLimitedRequests() const
+    {
+        return m_sourceLimitedRequests;
+    }
+
+    inline qint64 globalLimitedRequests() const
+    {
+        return m_globalLimitedRequests;
+    }
+};
+
+}
+}
+
+#endif /* HDISCOVERYREQUEST_LIMITER_P_H_ */
@@ -0,0 +1,137 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "hevent_delivery_p.h"
+#include "hevent_subscriber_p.h"
+
+#include "../../http/hhttp_connectionpool_p.h"
+
+#include <QtNetwork/QTcpSocket>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace
+{
+// the number of notifications sent to a single endpoint at the same time
+const qint32 MaxActiveSendsPerEndpoint = 2;
+
+// the number of the latest delivery times the percentiles are computed from
+const qint32 LatencySampleCount = 1024;
+}
+
+/*******************************************************************************
+ * HEventDelivery
+ ******************************************************************************/
+HEventDelivery::HEventDelivery(QObject* parent) :
+    QObject(parent),
+        m_connectionPool(new HHttpConnectionPool(this)),
+        m_activeSends(), m_waitingSubscribers(),
+        m_latencies(LatencySampleCount), m_failedNotifications(0),
+        m_mergedNotifications(0), m_droppedSubscribers(0)
+{
+    m_connectionPool->setMaxIdleConnectionsPerEndpoint(
+        MaxActiveSendsPerEndpoint);
+}
+
+HEventDelivery::~HEventDelivery()
+{
+}
+
+QTcpSocket* HEventDelivery::acquire(
+    HServiceEventSubscriber* subscriber, const HEndpoint& endpoint,
+    bool* reused)
+{
+    Q_ASSERT(subscriber);
+
+    qint32& activeSends = m_activeSends[endpoint];
+    if (activeSends >= MaxActiveSendsPerEndpoint)
+    {
+        QQueue<HServiceEventSubscriber*>& waiting =
+            m_waitingSubscribers[endpoint];
+
+        if (!waiting.contains(subscriber))
+        {
+            waiting.enqueue(subscriber);
+        }
+
+        return 0;
+    }
+
+    ++activeSends;
+    return m_connectionPool->acquire(endpoint, reused);
+}
+
+void HEventDelivery::release(
+    const HEndpoint& endpoint, QTcpSocket* socket, bool keepAlive)
+{
+    Q_ASSERT(socket);
+
+    m_connectionPool->release(keepAlive ? endpoint : HEndpoint(), socket);
+
+    QHash<HEndpoint, qint32>::iterator it = m_activeSends.find(endpoint);
+    if (it != m_activeSends.end() && --it.value() <= 0)
+    {
+        m_activeSends.erase(it);
+    }
+
+    QHash<HEndpoint, QQueue<HServiceEventSubscriber*> >::iterator wit =
+        m_waitingSubscribers.find(endpoint);
+
+    if (wit != m_waitingSubscribers.end())
+    {
+        HServiceEventSubscriber* next = wit.value().dequeue();
+        if (wit.value().isEmpty())
+        {
+            m_waitingSubscribers.erase(wit);
+        }
+
+        // the subscriber is resumed asynchronously so that the sends do not
+        // recurse
+        QMetaObject::invokeMethod(next, "send", Qt::QueuedConnection);
+    }
+}
+
+void HEventDelivery::cancel(HServiceEventSubscriber* subscriber)
+{
+    QHash<HEndpoint, QQueue<HServiceEventSubscriber*> >::iterator it =
+        m_waitingSubscribers.begin();
+
+    while(it != m_waitingSubscribers.end())
+    {
+        it.value().removeAll(subscriber);
+        if (it.value().isEmpty())
+        {
+            it = m_waitingSubscribers.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+}
+}
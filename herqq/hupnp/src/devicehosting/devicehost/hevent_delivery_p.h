@@ -0,0 +1,139 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef HEVENT_DELIVERY_P_H_
+#define HEVENT_DELIVERY_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include "../../general/hupnp_defs.h"
+#include "../../utils/hlatency_samples_p.h"
+
+#include <HUpnpCore/HEndpoint>
+
+#include <QtCore/QHash>
+#include <QtCore/QQueue>
+#include <QtCore/QObject>
+
+class QTcpSocket;
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+class HHttpConnectionPool;
+class HServiceEventSubscriber;
+
+//
+// Internal class that provides the event subscribers of a device host the
+// connections used to deliver the notifications.
+//
+// The connections are kept alive and shared by the subscribers that use the
+// same callback endpoint. The number of notifications sent to an endpoint
+// at the same time is bounded; a subscriber that cannot send is resumed
+// once another send to the endpoint completes. In addition, the class
+// collects the delivery statistics of the subscribers.
+//
+class HEventDelivery :
+    public QObject
+{
+Q_OBJECT
+H_DISABLE_COPY(HEventDelivery)
+
+private:
+
+    HHttpConnectionPool* m_connectionPool;
+
+    QHash<HEndpoint, qint32> m_activeSends;
+    // the number of sends in progress to each endpoint
+
+    QHash<HEndpoint, QQueue<HServiceEventSubscriber*> > m_waitingSubscribers;
+    // the subscribers waiting for a send to their endpoint to complete
+
+    HLatencySamples m_latencies;
+    // the delivery times of the latest notifications in msecs
+
+    qint64 m_failedNotifications;
+    qint64 m_mergedNotifications;
+    qint64 m_droppedSubscribers;
+
+public:
+
+    HEventDelivery(QObject* parent = 0);
+    virtual ~HEventDelivery();
+
+    // returns a socket to the endpoint, which is connected if it was reused,
+    // or null in case the maximum number of sends to the endpoint are in
+    // progress. in the latter case the subscriber is resumed by invoking
+    // its send() slot once a send to the endpoint completes
+    QTcpSocket* acquire(
+        HServiceEventSubscriber*, const HEndpoint&, bool* reused);
+
+    // returns the socket to the pool, if the connection can be kept alive.
+    // otherwise the socket is deleted
+    void release(const HEndpoint&, QTcpSocket*, bool keepAlive);
+
+    // removes the subscriber from the subscribers waiting for a socket
+    void cancel(HServiceEventSubscriber*);
+
+    // records a delivered notification and the time it took to deliver
+    inline void addLatency(qint32 msecs) { m_latencies.add(msecs); }
+
+    // returns the specified percentile of the latest delivery times in msecs
+    // or -1 in case no notification has been delivered
+    inline qint32 latencyPercentile(qint32 percentile) const
+    {
+        return m_latencies.percentile(percentile);
+    }
+
+    inline void addFailedNotification() { ++m_failedNotifications; }
+
+    inline qint64 deliveredNotifications() const
+    {
+        return m_latencies.count();
+    }
+
+    inline qint64 failedNotifications() const { return m_failedNotifications; }
+
+    inline void addMergedNotifications(qint32 count)
+    {
+        m_mergedNotifications += count;
+    }
+
+    inline void addDroppedSubscriber() { ++m_droppedSubscribers; }
+
+    inline qint64 mergedNotifications() const { return m_mergedNotifications; }
+    inline qint64 droppedSubscribers() const { return m_droppedSubscribers; }
+};
+
+}
+}
+
+#endif /* HEVENT_DELIVERY_P_H_ */
@@ -26,6 +26,7 @@
 #include "../messages/hevent_messages_p.h"
 
 #include "../../devicemodel/server/hserverdevice.h"
+#include "../../devicemodel/hdevicestatus.h"
 #include "../../devicemodel/server/hserverservice.h"
 #include "../../devicemodel/server/hserverstatevariable.h"
 
@@ -35,10 +36,14 @@
 #include "../../dataelements/hstatevariableinfo.h"
 
 #include "../../http/hhttp_messaginginfo_p.h"
+#include "../../http/hhttp_messagecreator_p.h"
 
+#include "../../socket/hmulticast_socket.h"
+
+#include "../../utils/htimerwheel_p.h"
 #include "../../general/hlogger_p.h"
 
-#include <QtXml/QDomDocument>
+#include <QtCore/QTimerEvent>
 #include <QtNetwork/QTcpSocket>
 
 namespace Herqq
@@ -49,46 +54,45 @@ namespace Upnp
 
 namespace
 {
-void getCurrentValues(QByteArray& msgBody, const HServerService* service)
-{
-    HLOG(H_AT, H_FUN);
-
-    QDomDocument dd;
+// the interval at which the expired subscribers are removed
+const qint32 ReapIntervalInMsecs = 30000;
 
-    QDomProcessingInstruction proc =
-        dd.createProcessingInstruction("xml", "version=\"1.0\" encoding=\"utf-8\"");
+// the granularity of the subscription expiry
+const qint32 ExpiryTickInMsecs = 1000;
 
-    dd.appendChild(proc);
-
-    QDomElement propertySetElem =
-        dd.createElementNS("urn:schemas-upnp-org:event-1-0", "e:propertyset");
-
-    dd.appendChild(propertySetElem);
+// returns the names and the values of the evented variables of the service
+HNotifyRequest::Variables currentValues(
+    const HServerService* service, bool multicastOnly = false)
+{
+    HNotifyRequest::Variables retVal;
 
     HServerStateVariables stateVars = service->stateVariables();
-    QHash<QString, HServerStateVariable*>::const_iterator ci = stateVars.constBegin();
+    HServerStateVariables::const_iterator ci = stateVars.constBegin();
     for(; ci != stateVars.constEnd(); ++ci)
     {
         HServerStateVariable* stateVar = ci.value();
         Q_ASSERT(stateVar);
 
         const HStateVariableInfo& info = stateVar->info();
-        if (info.eventingType() == HStateVariableInfo::NoEvents)
+        if (info.eventingType() == HStateVariableInfo::NoEvents ||
+           (multicastOnly &&
+            info.eventingType() != HStateVariableInfo::UnicastAndMulticast))
         {
             continue;
         }
 
-        QDomElement propertyElem =
-            dd.createElementNS("urn:schemas-upnp-org:event-1-0", "e:property");
-
-        QDomElement variableElem = dd.createElement(info.name());
-        variableElem.appendChild(dd.createTextNode(stateVar->value().toString()));
-
-        propertyElem.appendChild(variableElem);
-        propertySetElem.appendChild(propertyElem);
+        retVal.append(qMakePair(info.name(), stateVar->value().toString()));
     }
 
-    msgBody = dd.toByteArray();
+    return retVal;
+}
+
+void getCurrentValues(
+    QByteArray& msgBody, const HServerService* service,
+    bool multicastOnly = false)
+{
+    msgBody = HNotifyRequest::createPropertySet(
+        currentValues(service, multicastOnly));
 }
 }
 
@@ -102,8 +106,20 @@ HEventNotifier::HEventNotifier(
         QObject(parent),
             m_loggingIdentifier(loggingIdentifier),
             m_subscribers(),
-            m_configuration(configuration)
+            m_subscribersByService(),
+            m_fullStateSubscribers(),
+            m_reapTimer(),
+            m_multicastSocket(0),
+            m_delivery(new HEventDelivery(this)),
+            m_expiryWheel(
+                new HTimerWheel(ExpiryTickInMsecs, this)),
+            m_configuration(configuration),
+            m_moderatedEvents(),
+            m_clock(),
+            m_moderationTimer()
 {
+    m_clock.start();
+    m_reapTimer.start(ReapIntervalInMsecs, this);
 }
 
 HEventNotifier::~HEventNotifier()
@@ -135,32 +151,122 @@ HTimeout HEventNotifier::getSubscriptionTimeout(const HSubscribeRequest& sreq)
     return HTimeout(max);
 }
 
-namespace
+void HEventNotifier::deleteSubscriber(HServiceEventSubscriber* subscriber)
 {
-bool isSameService(HServerService* srv1, HServerService* srv2)
-{
-    return srv1->parentDevice()->info().udn() ==
-           srv2->parentDevice()->info().udn() &&
-           srv1->info().scpdUrl() == srv2->info().scpdUrl();
+    QHash<const HServerService*, QList<HServiceEventSubscriber*> >::iterator
+        it = m_subscribersByService.find(subscriber->service());
+
+    if (it != m_subscribersByService.end())
+    {
+        it.value().removeOne(subscriber);
+        if (it.value().isEmpty())
+        {
+            m_subscribersByService.erase(it);
+        }
+    }
+
+    m_subscribers.remove(subscriber->sid());
+    m_fullStateSubscribers.remove(subscriber);
+    delete subscriber;
 }
+
+void HEventNotifier::reapExpiredSubscribers()
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    QList<HServiceEventSubscriber*> expired;
+
+    QHash<HSid, HServiceEventSubscriber*>::const_iterator ci =
+        m_subscribers.constBegin();
+
+    for(; ci != m_subscribers.constEnd(); ++ci)
+    {
+        if (ci.value()->expired())
+        {
+            expired.append(ci.value());
+        }
+    }
+
+    foreach(HServiceEventSubscriber* sub, expired)
+    {
+        HLOG_INFO(QString(
+            "removing an expired subscription [SID [%1]] from [%2]").arg(
+                sub->sid().toString(), sub->location().toString()));
+
+        deleteSubscriber(sub);
+    }
 }
 
 HServiceEventSubscriber* HEventNotifier::remoteClient(const HSid& sid) const
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+    return m_subscribers.value(sid);
+}
 
-    QList<HServiceEventSubscriber*>::const_iterator it =
-        m_subscribers.constBegin();
+qint32 HEventNotifier::activeSubscriberCount() const
+{
+    qint32 retVal = 0;
+    foreach(const HServiceEventSubscriber* subscriber, m_subscribers)
+    {
+        if (!subscriber->expired())
+        {
+            ++retVal;
+        }
+    }
+    return retVal;
+}
+
+void HEventNotifier::networkAddressRemoved(const QHostAddress& address)
+{
+    if (m_multicastSocket && m_multicastSocket->localAddress() == address)
+    {
+        delete m_multicastSocket;
+        m_multicastSocket = 0;
+    }
+}
+
+void HEventNotifier::deviceRemoved(const HServerDevice* rootDevice)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    QList<HServiceEventSubscriber*> removed;
+
+    QHash<const HServerService*, QList<HServiceEventSubscriber*> >::
+        const_iterator ci = m_subscribersByService.constBegin();
 
-    for(; it != m_subscribers.end(); ++it)
+    for(; ci != m_subscribersByService.constEnd(); ++ci)
     {
-        if ((*it)->sid() == sid)
+        if (ci.key()->parentDevice()->rootDevice() == rootDevice)
         {
-            return *it;
+            removed.append(ci.value());
         }
     }
 
-    return 0;
+    foreach(HServiceEventSubscriber* sub, removed)
+    {
+        HLOG_INFO(QString(
+            "removing subscriber [SID [%1]] of a removed device").arg(
+                sub->sid().toString()));
+
+        deleteSubscriber(sub);
+    }
+
+    QHash<const HServerService*, HModeratedEvents>::iterator it =
+        m_moderatedEvents.begin();
+
+    while (it != m_moderatedEvents.end())
+    {
+        if (it.key()->parentDevice()->rootDevice() == rootDevice)
+        {
+            it = m_moderatedEvents.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    restartModerationTimer();
 }
 
 StatusCode HEventNotifier::addSubscriber(
@@ -177,12 +283,12 @@ StatusCode HEventNotifier::addSubscriber(
     // This is enforced at the HServerService class, which should not send any
     // events unless one or more of its state variables are evented.
 
-    for(qint32 i = 0; i < m_subscribers.size(); ++i)
-    {
-        HServiceEventSubscriber* rc = m_subscribers[i];
+    const QList<HServiceEventSubscriber*> subscribers =
+        m_subscribersByService.value(service);
 
-        if (isSameService(rc->service(), service) &&
-            sreq.callbacks().contains(rc->location()))
+    foreach(HServiceEventSubscriber* rc, subscribers)
+    {
+        if (!rc->expired() && sreq.callbacks().contains(rc->location()))
         {
             HLOG_WARN(QString(
                 "subscriber [%1] to the specified service URL [%2] already "
@@ -217,9 +323,13 @@ StatusCode HEventNotifier::addSubscriber(
             service,
             sreq.callbacks().at(0),
             timeout,
+            m_delivery,
+            m_expiryWheel,
             this);
 
-    m_subscribers.push_back(rc);
+    m_subscribers.insert(rc->sid(), rc);
+    m_fullStateSubscribers.insert(rc);
+    m_subscribersByService[service].append(rc);
 
     *sid = rc->sid();
 
@@ -230,83 +340,301 @@ bool HEventNotifier::removeSubscriber(const HUnsubscribeRequest& req)
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
-    bool found = false;
+    HServiceEventSubscriber* sub = m_subscribers.value(req.sid());
+    if (!sub)
+    {
+        HLOG_WARN(QString("Could not cancel subscription. Invalid SID [%1]").arg(
+            req.sid().toString()));
+
+        return false;
+    }
+
+    HLOG_INFO(QString("removing subscriber [SID [%1]] from [%2]").arg(
+        req.sid().toString(), sub->location().toString()));
+
+    deleteSubscriber(sub);
+
+    return true;
+}
 
-    QList<HServiceEventSubscriber*>::iterator it = m_subscribers.begin();
-    for(; it != m_subscribers.end(); )
+StatusCode HEventNotifier::renewSubscription(
+    const HSubscribeRequest& req, HSid* sid)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    Q_ASSERT(sid);
+
+    HServiceEventSubscriber* sub = m_subscribers.value(req.sid());
+    if (sub && sub->expired())
+    {
+        HLOG_INFO(QString("removing subscriber [SID [%1]] from [%2]").arg(
+            sub->sid().toString(), sub->location().toString()));
+
+        deleteSubscriber(sub);
+        sub = 0;
+    }
+
+    if (!sub)
     {
-        if ((*it)->sid() == req.sid())
+        HLOG_WARN(QString("Cannot renew subscription. Invalid SID: [%1]").arg(
+            req.sid().toString()));
+
+        return PreconditionFailed;
+    }
+
+    HLOG_INFO(QString("renewing subscription from [%1]").arg(
+        sub->location().toString()));
+
+    sub->renew(getSubscriptionTimeout(req));
+    *sid = sub->sid();
+
+    return Ok;
+}
+
+qint64 HEventNotifier::dueTime(
+    const HServerService* service, const HModeratedEvents& events, qint64 now)
+{
+    qint64 window = m_configuration.eventModerationWindow();
+    qint64 retVal = -1;
+
+    HServerStateVariables stateVars = service->stateVariables();
+    HServerStateVariables::const_iterator ci = stateVars.constBegin();
+    for(; ci != stateVars.constEnd(); ++ci)
+    {
+        const HStateVariableInfo& info = ci.value()->info();
+        if (info.eventingType() == HStateVariableInfo::NoEvents)
         {
-            HLOG_INFO(QString("removing subscriber [SID [%1]] from [%2]").arg(
-                req.sid().toString(), (*it)->location().toString()));
+            continue;
+        }
 
-            delete *it;
-            it = m_subscribers.erase(it);
+        QHash<QString, QString>::const_iterator sent =
+            events.m_sentValues.constFind(info.name());
 
-            found = true;
+        if (sent != events.m_sentValues.constEnd() &&
+            sent.value() == ci.value()->value().toString())
+        {
+            continue;
         }
-        else if ((*it)->expired())
+
+        // the max event rate is the minimum interval in msecs between
+        // two events of the variable
+        qint64 allowed = now + window;
+        qint64 sentTime = events.m_sentTimes.value(info.name(), -1);
+        if (info.maxEventRate() > 0 && sentTime >= 0)
         {
-            HLOG_INFO(QString(
-                "removing an expired subscription [SID [%1]] from [%2]").arg(
-                    (*it)->sid().toString(), (*it)->location().toString()));
+            allowed = qMax(allowed, sentTime + info.maxEventRate());
+        }
 
-            delete *it;
-            it = m_subscribers.erase(it);
+        if (retVal < 0 || allowed < retVal)
+        {
+            retVal = allowed;
         }
-        else
+    }
+
+    return retVal;
+}
+
+void HEventNotifier::notifySubscribers(
+    const HServerService* source, HModeratedEvents* events)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    HNotifyRequest::Variables values = currentValues(source);
+    HNotifyRequest::Variables changed;
+
+    qint64 now = m_clock.elapsed();
+    bool multicastChanged = false;
+
+    QHash<QString, QString> sentValues;
+    for(qint32 i = 0; i < values.size(); ++i)
+    {
+        const QPair<QString, QString>& value = values.at(i);
+        sentValues.insert(value.first, value.second);
+
+        QHash<QString, QString>::const_iterator sent =
+            events->m_sentValues.constFind(value.first);
+
+        if (sent != events->m_sentValues.constEnd() &&
+            sent.value() == value.second)
         {
-            ++it;
+            continue;
+        }
+
+        changed.append(value);
+        events->m_sentTimes.insert(value.first, now);
+
+        const HServerStateVariable* stateVar =
+            source->stateVariables().value(value.first);
+
+        if (stateVar && stateVar->info().eventingType() ==
+            HStateVariableInfo::UnicastAndMulticast)
+        {
+            multicastChanged = true;
         }
     }
 
-    if (!found)
+    events->m_sentValues = sentValues;
+    events->m_pending = false;
+
+    if (multicastChanged)
     {
-        HLOG_WARN(QString("Could not cancel subscription. Invalid SID [%1]").arg(
-            req.sid().toString()));
+        sendMulticastEvent(source, events);
     }
 
-    return found;
+    // a subscriber that has received the initial notify, but not a
+    // notification since its subscription, may have seen values that differ
+    // from the latest notification and therefore it receives the full state.
+    // the others receive only the variables that have changed.
+    QByteArray fullBody = HNotifyRequest::createPropertySet(values);
+
+    QByteArray deltaBody;
+    if (changed.size() == values.size())
+    {
+        deltaBody = fullBody;
+    }
+    else if (!changed.isEmpty())
+    {
+        deltaBody = HNotifyRequest::createPropertySet(changed);
+    }
+
+    // the expired subscribers are skipped here and removed by the reap timer
+    const QList<HServiceEventSubscriber*> subscribers =
+        m_subscribersByService.value(source);
+
+    foreach(HServiceEventSubscriber* sub, subscribers)
+    {
+        if (!sub->isInterested(source))
+        {
+            continue;
+        }
+
+        if (m_fullStateSubscribers.remove(sub))
+        {
+            sub->notify(fullBody);
+        }
+        else if (!deltaBody.isEmpty())
+        {
+            sub->notify(deltaBody);
+        }
+    }
 }
 
-StatusCode HEventNotifier::renewSubscription(
-    const HSubscribeRequest& req, HSid* sid)
+void HEventNotifier::sendMulticastEvent(
+    const HServerService* source, HModeratedEvents* events)
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
-    Q_ASSERT(sid);
+    QByteArray msgBody;
+    getCurrentValues(msgBody, source, true);
+
+    const HServerDevice* device = source->parentDevice();
+
+    HMulticastNotifyRequest req(
+        HDiscoveryType(
+            device->info().udn(), source->info().serviceType(), LooseChecks),
+        source->info().serviceId(),
+        events->m_multicastSeq,
+        device->rootDevice()->deviceStatus().bootId(),
+        msgBody);
 
-    QList<HServiceEventSubscriber*>::iterator it = m_subscribers.begin();
-    for(; it != m_subscribers.end();)
+    if (!req.isValid())
     {
-        HServiceEventSubscriber* sub = (*it);
-        if (sub->sid() == req.sid())
-        {
-            HLOG_INFO(QString("renewing subscription from [%1]").arg(
-                (*it)->location().toString()));
+        HLOG_WARN(QString("Could not create a multicast event for [%1]").arg(
+            source->info().serviceId().toString()));
+        return;
+    }
 
-            sub->renew(getSubscriptionTimeout(req));
-            *sid = sub->sid();
-            return Ok;
-        }
-        else if (sub->expired())
+    // as with unicast events, the sequence number wraps to 1
+    events->m_multicastSeq =
+        events->m_multicastSeq == 0xffffffff ? 1 : events->m_multicastSeq + 1;
+
+    if (!m_multicastSocket)
+    {
+        QList<QHostAddress> addresses = m_configuration.networkAddressesToUse();
+
+        m_multicastSocket = new HMulticastSocket(this);
+        if (!m_multicastSocket->bind(
+                addresses.isEmpty() ? QHostAddress(QHostAddress::Any) :
+                                      addresses.first(), 0))
         {
-            HLOG_INFO(QString("removing subscriber [SID [%1]] from [%2]").arg(
-                sub->sid().toString(), sub->location().toString()));
+            HLOG_WARN(QString("Failed to bind the multicast event socket: %1").arg(
+                m_multicastSocket->errorString()));
+        }
+
+        m_multicastSocket->setMulticastTtl(2);
+    }
+
+    HEndpoint ep = HMulticastNotifyRequest::multicastEndpoint();
+
+    QByteArray data = HHttpMessageCreator::create(req);
+    if (m_multicastSocket->writeDatagram(
+            data, ep.hostAddress(), ep.portNumber()) != data.size())
+    {
+        HLOG_WARN(QString("Failed to send a multicast event: %1").arg(
+            m_multicastSocket->errorString()));
+    }
+}
 
-            delete *it;
-            it = m_subscribers.erase(it);
+void HEventNotifier::sendDueEvents()
+{
+    qint64 now = m_clock.elapsed();
+
+    QHash<const HServerService*, HModeratedEvents>::iterator it =
+        m_moderatedEvents.begin();
+
+    for(; it != m_moderatedEvents.end(); ++it)
+    {
+        if (it.value().m_pending && it.value().m_dueTime <= now)
+        {
+            notifySubscribers(it.key(), &it.value());
         }
-        else
+    }
+
+    restartModerationTimer();
+}
+
+void HEventNotifier::restartModerationTimer()
+{
+    qint64 nextDueTime = -1;
+
+    QHash<const HServerService*, HModeratedEvents>::const_iterator ci =
+        m_moderatedEvents.constBegin();
+
+    for(; ci != m_moderatedEvents.constEnd(); ++ci)
+    {
+        if (ci.value().m_pending &&
+            (nextDueTime < 0 || ci.value().m_dueTime < nextDueTime))
         {
-            ++it;
+            nextDueTime = ci.value().m_dueTime;
         }
     }
 
-    HLOG_WARN(QString("Cannot renew subscription. Invalid SID: [%1]").arg(
-        req.sid().toString()));
+    if (nextDueTime < 0)
+    {
+        m_moderationTimer.stop();
+    }
+    else
+    {
+        m_moderationTimer.start(
+            static_cast<int>(qMax(nextDueTime - m_clock.elapsed(), qint64(0))),
+            this);
+    }
+}
 
-    return PreconditionFailed;
+void HEventNotifier::timerEvent(QTimerEvent* event)
+{
+    if (event->timerId() == m_moderationTimer.timerId())
+    {
+        sendDueEvents();
+    }
+    else if (event->timerId() == m_reapTimer.timerId())
+    {
+        reapExpiredSubscribers();
+    }
+    else
+    {
+        QObject::timerEvent(event);
+    }
 }
 
 void HEventNotifier::stateChanged(const HServerService* source)
@@ -315,33 +643,19 @@ void HEventNotifier::stateChanged(const HServerService* source)
 
     Q_ASSERT(source->isEvented());
 
-    QByteArray msgBody;
-    getCurrentValues(msgBody, source);
+    HModeratedEvents& events = m_moderatedEvents[source];
 
-    QList<HServiceEventSubscriber*>::iterator it = m_subscribers.begin();
-    for(; it != m_subscribers.end(); )
+    qint64 due = dueTime(source, events, m_clock.elapsed());
+    if (due < 0)
     {
-        HServiceEventSubscriber* sub = (*it);
-        if (sub->isInterested(source))
-        {
-            sub->notify(msgBody);
-            ++it;
-        }
-        else if ((*it)->expired())
-        {
-            HLOG_INFO(QString("removing subscriber [SID [%1]] from [%2]").arg(
-                sub->sid().toString(), sub->location().toString()));
-
-            delete *it;
-            it = m_subscribers.erase(it);
-        }
-        else
-        {
-            ++it;
-        }
+        // the evented values are the same as in the latest notification
+        return;
     }
 
-    // TODO add multicast event support
+    events.m_dueTime = events.m_pending ? qMin(events.m_dueTime, due) : due;
+    events.m_pending = true;
+
+    restartModerationTimer();
 }
 
 void HEventNotifier::initialNotify(
@@ -30,13 +30,22 @@
 // change or the file may be removed without of notice.
 //
 
+#include "hevent_subscriber_p.h"
+#include "hevent_delivery_p.h"
+#include "../messages/hsid_p.h"
 #include "../../http/hhttp_p.h"
 #include "../../general/hupnp_fwd.h"
 #include "../../general/hupnp_defs.h"
 
+#include <QtCore/QHash>
+#include <QtCore/QSet>
 #include <QtCore/QList>
 #include <QtCore/QObject>
 #include <QtCore/QByteArray>
+#include <QtCore/QBasicTimer>
+#include <QtCore/QElapsedTimer>
+
+#include <QtNetwork/QHostAddress>
 
 namespace Herqq
 {
@@ -44,16 +53,48 @@ namespace Herqq
 namespace Upnp
 {
 
-class HSid;
 class HTimeout;
 class HMessagingInfo;
+class HTimerWheel;
+class HMulticastSocket;
 class HSubscribeRequest;
 class HUnsubscribeRequest;
-class HServiceEventSubscriber;
+
+//
+// The moderation state of the events of a single service
+//
+struct HModeratedEvents
+{
+    bool m_pending;
+    // true when a notification has been scheduled
+
+    qint64 m_dueTime;
+    // the time in msecs at which the scheduled notification is sent
+
+    QHash<QString, QString> m_sentValues;
+    // the values of the evented variables in the latest notification
+
+    QHash<QString, qint64> m_sentTimes;
+    // the time in msecs at which each variable was last evented
+
+    quint32 m_multicastSeq;
+    // the sequence number of the next multicast event of the service
+
+    HModeratedEvents() :
+        m_pending(false), m_dueTime(0), m_sentValues(), m_sentTimes(),
+        m_multicastSeq(0)
+    {
+    }
+};
 
 //
 // Internal class used to notify event subscribers of events.
 //
+// The state changes of a service are coalesced: changes made within the
+// moderation window are sent in a single notification. In addition, a change
+// of a variable that has a maximum event rate is not evented sooner than the
+// rate allows, unless the notification is sent because of another variable.
+//
 class HEventNotifier :
     public QObject
 {
@@ -65,14 +106,59 @@ private: // attributes
     const QByteArray m_loggingIdentifier;
     // prefix for logging
 
-    QList<HServiceEventSubscriber*> m_subscribers;
+    QHash<HSid, HServiceEventSubscriber*> m_subscribers;
+    QHash<const HServerService*, QList<HServiceEventSubscriber*> >
+        m_subscribersByService;
+    // the subscribers indexed by their SIDs and by the services they are
+    // subscribed to. both indexes contain the same objects.
+
+    QSet<HServiceEventSubscriber*> m_fullStateSubscribers;
+    // the subscribers that receive all the evented variables in their next
+    // notification instead of the changed ones
+
+    QBasicTimer m_reapTimer;
+    // used to periodically remove the expired subscribers
+
+    HMulticastSocket* m_multicastSocket;
+    // the socket used to send the UPnP 1.1 multicast events, created when
+    // the first multicast event is sent
+
+    HEventDelivery* m_delivery;
+    // the connections used to deliver the notifications and the delivery
+    // statistics
+
+    HTimerWheel* m_expiryWheel;
+    // schedules the expiry of all the subscriptions using a single timer
 
     HDeviceHostConfiguration& m_configuration;
 
+    QHash<const HServerService*, HModeratedEvents> m_moderatedEvents;
+    QElapsedTimer m_clock;
+    QBasicTimer m_moderationTimer;
+
 private: // methods
 
     HTimeout getSubscriptionTimeout(const HSubscribeRequest&);
 
+    void deleteSubscriber(HServiceEventSubscriber*);
+    void reapExpiredSubscribers();
+
+    // returns the time at which the changes made to the service since its
+    // latest notification may be evented or -1 if nothing has changed
+    qint64 dueTime(const HServerService*, const HModeratedEvents&, qint64 now);
+
+    void notifySubscribers(const HServerService*, HModeratedEvents*);
+
+    // sends the current values of the multicast evented variables of the
+    // service to the multicast group of UPnP events
+    void sendMulticastEvent(const HServerService*, HModeratedEvents*);
+    void sendDueEvents();
+    void restartModerationTimer();
+
+protected:
+
+    virtual void timerEvent(QTimerEvent*);
+
 private Q_SLOTS:
 
     void stateChanged(const Herqq::Upnp::HServerService* source);
@@ -92,7 +178,24 @@ public:
     StatusCode renewSubscription(const HSubscribeRequest&, HSid*);
     HServiceEventSubscriber* remoteClient(const HSid&) const;
 
+    // returns the number of subscribers that have not expired
+    qint32 activeSubscriberCount() const;
+
+    // closes the multicast event socket in case it is bound to the address
+    // the device host no longer uses. the socket is re-created with the
+    // current addresses when the next multicast event is sent
+    void networkAddressRemoved(const QHostAddress&);
+
+    // removes the subscribers and the moderation state of the services of
+    // the device tree, which is about to be removed from the device host
+    void deviceRemoved(const HServerDevice* rootDevice);
+
     void initialNotify(HServiceEventSubscriber*, HMessagingInfo*);
+
+    inline const HEventDelivery& delivery() const
+    {
+        return *m_delivery;
+    }
 };
 
 }
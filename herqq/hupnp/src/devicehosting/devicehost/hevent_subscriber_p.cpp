@@ -25,10 +25,14 @@
 #include "../../dataelements/hserviceid.h"
 #include "../../dataelements/hserviceinfo.h"
 
+#include "hevent_delivery_p.h"
+
 #include "../../http/hhttp_messagecreator_p.h"
 
 #include "../../general/hlogger_p.h"
+#include "../../general/hmemoryaccount_p.h"
 #include "../../utils/hsysutils_p.h"
+#include "../../utils/htimerwheel_p.h"
 
 #include <QtNetwork/QTcpSocket>
 
@@ -38,6 +42,17 @@ namespace Herqq
 namespace Upnp
 {
 
+namespace
+{
+// the number of notifications queued in addition to the one being sent,
+// after which the queued notifications are merged into one
+const qint32 MaxQueuedNotifications = 4;
+
+// the number of consecutive delivery failures after which the subscription
+// is considered expired
+const qint32 MaxConsecutiveFailures = 3;
+}
+
 bool HServiceEventSubscriber::send(HMessagingInfo* mi)
 {
     HLOG2(H_AT, H_FUN, "__DEVICE HOST__: ");
@@ -49,9 +64,14 @@ bool HServiceEventSubscriber::send(HMessagingInfo* mi)
                 m_sid.toString()));
 
         delete mi;
+
+        // the message is sent using a new connection
+        send();
         return false;
     }
 
+    m_sendTime.start();
+
     QByteArray message = m_messagesToSend.head();
     qint32 seq = m_seq++;
 
@@ -77,52 +97,60 @@ bool HServiceEventSubscriber::send(HMessagingInfo* mi)
             "Could not send notify [seq: %1, sid: %2] to host @ [%3].").arg(
                 QString::number(seq), m_sid.toString(),
                 m_location.toString()));
+
+        deliveryFailed();
+        return false;
     }
 
-    return oper;
+    m_operationActive = true;
+    return true;
 }
 
 HServiceEventSubscriber::HServiceEventSubscriber(
     const QByteArray& loggingIdentifier, HServerService* service,
-    const QUrl location, const HTimeout& timeout, QObject* parent) :
+    const QUrl location, const HTimeout& timeout,
+    HEventDelivery* delivery, HTimerWheel* expiryWheel, QObject* parent) :
         QObject(parent),
             m_service(service),
             m_location(location),
             m_sid(QUuid::createUuid()),
             m_seq(0),
             m_timeout(timeout),
-            m_timer(this),
+            m_expiryWheel(expiryWheel),
             m_asyncHttp(loggingIdentifier, this),
-            m_socket(new QTcpSocket(this)),
+            m_delivery(delivery),
+            m_endpoint(location),
+            m_socket(0),
+            m_socketReused(false),
+            m_sendTime(),
             m_messagesToSend(),
+            m_undelivered(),
+            m_consecutiveFailures(0),
+            m_operationActive(false),
             m_expired(false),
             m_loggingIdentifier(loggingIdentifier)
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
     Q_ASSERT(service);
+    Q_ASSERT(delivery);
+    Q_ASSERT(expiryWheel);
     Q_ASSERT(location.isValid());
 
     bool ok = connect(
-        &m_timer, SIGNAL(timeout()), this, SLOT(subscriptionTimeout()));
-
-    Q_ASSERT(ok); Q_UNUSED(ok)
-
-    ok = connect(
-        m_socket.data(), SIGNAL(connected()), this, SLOT(send()));
-
-    Q_ASSERT(ok);
-
-    ok = connect(
         &m_asyncHttp, SIGNAL(msgIoComplete(HHttpAsyncOperation*)),
         this, SLOT(msgIoComplete(HHttpAsyncOperation*)));
 
-    Q_ASSERT(ok);
+    Q_ASSERT(ok); Q_UNUSED(ok)
 
     if (!timeout.isInfinite())
     {
-        m_timer.start(timeout.value() * 1000);
+        m_expiryWheel->schedule(
+            this, "subscriptionTimeout", timeout.value() * 1000);
     }
+
+    HMemoryAccount::get(HMemoryAccount::ServerSubscriptions)->add(
+        sizeof(HServiceEventSubscriber) + m_loggingIdentifier.size());
 }
 
 HServiceEventSubscriber::~HServiceEventSubscriber()
@@ -133,30 +161,141 @@ HServiceEventSubscriber::~HServiceEventSubscriber()
     HLOG_DBG(QString(
         "Subscription from [%1] with SID %2 cancelled").arg(
             m_location.toString(), m_sid.toString()));
+
+    m_delivery->cancel(this);
+    m_expiryWheel->unschedule(this);
+    releaseSocket(false);
+
+    HMemoryAccount::get(HMemoryAccount::ServerSubscriptions)->remove(
+        sizeof(HServiceEventSubscriber) + m_loggingIdentifier.size());
+}
+
+void HServiceEventSubscriber::releaseSocket(bool keepAlive)
+{
+    if (!m_socket)
+    {
+        return;
+    }
+
+    m_socket->disconnect(this);
+    m_delivery->release(m_endpoint, m_socket, keepAlive);
+
+    m_socket = 0;
+    m_socketReused = false;
+}
+
+void HServiceEventSubscriber::mergeInto(
+    HNotifyRequest::Variables* target, const QByteArray& msg)
+{
+    HNotifyRequest req(m_location, m_sid, 0, msg);
+    HNotifyRequest::Variables variables = req.variables();
+
+    for(qint32 i = 0; i < variables.size(); ++i)
+    {
+        qint32 j = 0;
+        for(; j < target->size(); ++j)
+        {
+            if ((*target)[j].first == variables[i].first)
+            {
+                (*target)[j].second = variables[i].second;
+                break;
+            }
+        }
+
+        if (j == target->size())
+        {
+            target->append(variables[i]);
+        }
+    }
 }
 
-bool HServiceEventSubscriber::connectToHost()
+void HServiceEventSubscriber::mergeQueuedMessages()
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
-    Q_ASSERT(QThread::currentThread() == m_socket->thread());
-    Q_ASSERT(m_socket.data());
+    Q_ASSERT(m_messagesToSend.size() > 2);
+
+    HNotifyRequest::Variables merged;
+    for(qint32 i = 1; i < m_messagesToSend.size(); ++i)
+    {
+        mergeInto(&merged, m_messagesToSend.at(i));
+    }
 
-    QTcpSocket::SocketState state = m_socket->state();
+    m_delivery->addMergedNotifications(m_messagesToSend.size() - 2);
+
+    HLOG_DBG(QString(
+        "Merged [%1] queued notifications to subscriber [%2] @ [%3]").arg(
+            QString::number(m_messagesToSend.size() - 1), m_sid.toString(),
+            m_location.toString()));
+
+    QByteArray head = m_messagesToSend.head();
+
+    m_messagesToSend.clear();
+    m_messagesToSend.enqueue(head);
+    m_messagesToSend.enqueue(HNotifyRequest::createPropertySet(merged));
+}
+
+void HServiceEventSubscriber::deliveryFailed()
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
-    if (state == QTcpSocket::ConnectedState)
+    m_operationActive = false;
+    releaseSocket(false);
+
+    m_delivery->addFailedNotification();
+
+    // according to UDA v1.1 the message is abandoned, but the changes it
+    // carries are sent in the next one, since the notifications contain
+    // only the changed variables
+    if (!m_messagesToSend.isEmpty())
     {
-        return true;
+        mergeInto(&m_undelivered, m_messagesToSend.dequeue());
     }
-    else if (state == QTcpSocket::ConnectingState ||
-             state == QTcpSocket::HostLookupState)
+
+    if (++m_consecutiveFailures >= MaxConsecutiveFailures)
     {
-        return false;
+        HLOG_WARN(QString(
+            "Dropping subscriber [sid: %1] @ [%2] after [%3] consecutive "
+            "delivery failures").arg(
+                m_sid.toString(), m_location.toString(),
+                QString::number(m_consecutiveFailures)));
+
+        m_delivery->addDroppedSubscriber();
+
+        m_messagesToSend.clear();
+        m_undelivered.clear();
+
+        subscriptionTimeout();
+        return;
+    }
+
+    if (!m_messagesToSend.isEmpty())
+    {
+        HNotifyRequest::Variables merged = m_undelivered;
+        mergeInto(&merged, m_messagesToSend.head());
+        m_messagesToSend.head() = HNotifyRequest::createPropertySet(merged);
+        m_undelivered.clear();
+
+        send();
     }
+}
 
-    m_socket->connectToHost(m_location.host(), m_location.port());
+void HServiceEventSubscriber::connectionError(QAbstractSocket::SocketError)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
-    return false;
+    if (m_operationActive || m_messagesToSend.isEmpty())
+    {
+        // the errors of an active operation are reported by the operation;
+        // otherwise there is nothing waiting for the connection
+        return;
+    }
+
+    HLOG_WARN(QString(
+        "Could not connect to subscriber [sid: %1] @ [%2]: %3").arg(
+            m_sid.toString(), m_location.toString(), m_socket->errorString()));
+
+    deliveryFailed();
 }
 
 void HServiceEventSubscriber::msgIoComplete(HHttpAsyncOperation* operation)
@@ -164,6 +303,20 @@ void HServiceEventSubscriber::msgIoComplete(HHttpAsyncOperation* operation)
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
     operation->deleteLater();
+    m_operationActive = false;
+
+    if (operation->state() == HHttpAsyncOperation::Failed && m_socketReused)
+    {
+        // the subscriber may have closed the idle connection just before the
+        // notification was sent. the notification is re-sent once using a
+        // new connection
+        HLOG_DBG("Notification over a reused connection failed. Retrying.");
+
+        releaseSocket(false);
+        m_seq--;
+        send();
+        return;
+    }
 
     if (operation->state() == HHttpAsyncOperation::Failed)
     {
@@ -174,23 +327,33 @@ void HServiceEventSubscriber::msgIoComplete(HHttpAsyncOperation* operation)
                 m_location.toString(),
                 operation->messagingInfo()->lastErrorDescription()));
 
-        if (m_seq == 1)
+        if (m_seq == 1 && m_consecutiveFailures + 1 < MaxConsecutiveFailures)
         {
+            // the initial notify is re-sent using a new connection
+            ++m_consecutiveFailures;
+            releaseSocket(false);
             m_seq--;
             send();
             return;
         }
+
+        deliveryFailed();
+        return;
     }
-    else
-    {
-        HLOG_DBG(QString(
-            "Notification [seq: %1] successfully sent to subscriber [%2] @ [%3]").arg(
-                QString::number(m_seq-1), m_sid.toString(), m_location.toString()));
-    }
+
+    HLOG_DBG(QString(
+        "Notification [seq: %1] successfully sent to subscriber [%2] @ [%3]").arg(
+            QString::number(m_seq-1), m_sid.toString(), m_location.toString()));
+
+    releaseSocket(operation->messagingInfo()->keepAlive());
+
+    m_consecutiveFailures = 0;
+    m_delivery->addLatency(static_cast<qint32>(m_sendTime.elapsed()));
 
     if (!m_messagesToSend.isEmpty())
     {
         m_messagesToSend.dequeue();
+        m_sendTime.invalidate();
     }
 
     if (!m_messagesToSend.isEmpty())
@@ -203,15 +366,53 @@ void HServiceEventSubscriber::send()
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
-    if (m_messagesToSend.isEmpty() || !connectToHost() || !m_socket->isValid())
+    if (m_messagesToSend.isEmpty() || m_operationActive || expired())
+    {
+        return;
+    }
+
+    if (!m_sendTime.isValid())
+    {
+        m_sendTime.start();
+    }
+
+    if (!m_socket)
+    {
+        m_socket = m_delivery->acquire(this, m_endpoint, &m_socketReused);
+        if (!m_socket)
+        {
+            // the maximum number of notifications are being sent to the
+            // endpoint. this is invoked again once one of them completes
+            return;
+        }
+
+        m_socket->setParent(this);
+
+        bool ok = connect(m_socket, SIGNAL(connected()), this, SLOT(send()));
+        Q_ASSERT(ok); Q_UNUSED(ok)
+
+        ok = connect(
+            m_socket, SIGNAL(error(QAbstractSocket::SocketError)),
+            this, SLOT(connectionError(QAbstractSocket::SocketError)));
+
+        Q_ASSERT(ok);
+
+        if (!m_socketReused)
+        {
+            m_socket->connectToHost(m_location.host(), m_location.port());
+            return;
+        }
+    }
+    else if (m_socket->state() != QTcpSocket::ConnectedState)
     {
+        // still connecting
         return;
     }
 
     QByteArray message = m_messagesToSend.head();
     qint32 seq = m_seq++;
 
-    HMessagingInfo* mi = new HMessagingInfo(*m_socket, false, 10000);
+    HMessagingInfo* mi = new HMessagingInfo(*m_socket, true, 10000);
     // timeout specified by UDA v 1.1 is 30 seconds, but that seems absurd
     // in this context. however, if this causes problems change it back.
 
@@ -237,7 +438,12 @@ void HServiceEventSubscriber::send()
             "Could not send notify [seq: %1, sid: %2] to host @ [%3].").arg(
                 QString::number(seq), m_sid.toString(),
                 m_location.toString()));
+
+        deliveryFailed();
+        return;
     }
+
+    m_operationActive = true;
 }
 
 void HServiceEventSubscriber::subscriptionTimeout()
@@ -245,11 +451,7 @@ void HServiceEventSubscriber::subscriptionTimeout()
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
     m_expired = true;
-
-    if (m_timer.isActive())
-    {
-        m_timer.stop();
-    }
+    m_expiryWheel->unschedule(this);
 
     HLOG_DBG(QString(
         "Subscription from [%1] with SID %2 expired").arg(
@@ -277,9 +479,14 @@ void HServiceEventSubscriber::renew(const HTimeout& newTimeout)
 
     m_timeout = newTimeout;
 
-    if (!m_timeout.isInfinite())
+    if (m_timeout.isInfinite())
     {
-        m_timer.start(m_timeout.value() * 1000);
+        m_expiryWheel->unschedule(this);
+    }
+    else
+    {
+        m_expiryWheel->schedule(
+            this, "subscriptionTimeout", m_timeout.value() * 1000);
     }
 }
 
@@ -288,7 +495,28 @@ void HServiceEventSubscriber::notify(const QByteArray& msgBody)
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
     Q_ASSERT(QThread::currentThread() == thread());
 
-    m_messagesToSend.enqueue(msgBody);
+    if (expired())
+    {
+        return;
+    }
+
+    if (m_undelivered.isEmpty())
+    {
+        m_messagesToSend.enqueue(msgBody);
+    }
+    else
+    {
+        HNotifyRequest::Variables merged = m_undelivered;
+        mergeInto(&merged, msgBody);
+        m_messagesToSend.enqueue(HNotifyRequest::createPropertySet(merged));
+        m_undelivered.clear();
+    }
+
+    if (m_messagesToSend.size() > MaxQueuedNotifications + 1)
+    {
+        mergeQueuedMessages();
+    }
+
     if (m_messagesToSend.size() <= 1)
     {
         // if there's more messages to send the sending process is active and
@@ -33,9 +33,13 @@
 #include "../messages/hevent_messages_p.h"
 #include "../../http/hhttp_asynchandler_p.h"
 
+#include <HUpnpCore/HEndpoint>
+
 #include <QtCore/QQueue>
-#include <QtCore/QTimer>
 #include <QtCore/QObject>
+#include <QtCore/QElapsedTimer>
+
+#include <QtNetwork/QAbstractSocket>
 
 class QByteArray;
 class QTcpSocket;
@@ -46,11 +50,19 @@ namespace Herqq
 namespace Upnp
 {
 
+class HTimerWheel;
+class HEventDelivery;
 class HMessagingInfo;
 
 //
 // Internal class used to maintain information about a single event subscriber.
 //
+// The number of queued notifications is bounded. When the subscriber cannot
+// keep up, the notifications waiting in the queue are merged into one that
+// contains the latest value of each variable. The variables of a notification
+// that could not be delivered are merged into the next one, and after several
+// consecutive failures the subscription is considered expired.
+//
 class HServiceEventSubscriber :
     public QObject
 {
@@ -64,23 +76,55 @@ private: // attributes
     HSid m_sid;
     quint32 m_seq;
     HTimeout m_timeout;
-    QTimer m_timer;
+
+    HTimerWheel* m_expiryWheel;
+    // schedules the expiry of the subscription along with those of the other
+    // subscribers
     HHttpAsyncHandler m_asyncHttp;
 
-    QScopedPointer<QTcpSocket> m_socket;
+    HEventDelivery* m_delivery;
+    // provides the persistent connections shared with the other subscribers
+
+    HEndpoint m_endpoint;
+    QTcpSocket* m_socket;
+    // the socket to the subscriber. this is null between notifications
+
+    bool m_socketReused;
+    // true if m_socket was an idle connection from the pool
+
+    QElapsedTimer m_sendTime;
+    // the time elapsed since the head of the queue was first sent
+
     QQueue<QByteArray> m_messagesToSend;
+    // the head is the message being sent, if any
+
+    HNotifyRequest::Variables m_undelivered;
+    // the variables of the failed notifications not yet merged into a
+    // queued one
+
+    qint32 m_consecutiveFailures;
+
+    bool m_operationActive;
+    // true when the head of the queue is being sent over the socket
 
     bool m_expired;
 
     const QByteArray m_loggingIdentifier;
 
-    bool connectToHost();
+    void releaseSocket(bool keepAlive);
+
+    // merges the variables of the message into the target, in which the
+    // latest value of each variable is kept
+    void mergeInto(HNotifyRequest::Variables* target, const QByteArray& msg);
+    void mergeQueuedMessages();
+    void deliveryFailed();
 
 private Q_SLOTS:
 
     void send();
     void msgIoComplete(HHttpAsyncOperation*);
     void subscriptionTimeout();
+    void connectionError(QAbstractSocket::SocketError);
 
 private:
 
@@ -91,6 +135,7 @@ public:
     HServiceEventSubscriber(
         const QByteArray& loggingIdentifier,
         HServerService* service, const QUrl location, const HTimeout& timeout,
+        HEventDelivery* delivery, HTimerWheel* expiryWheel,
         QObject* parent = 0);
 
     virtual ~HServiceEventSubscriber();
@@ -0,0 +1,141 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "hpresence_announcer_p.h"
+
+#include "../../general/hlogger_p.h"
+
+#include <QtCore/QTimerEvent>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace
+{
+// the interval in msecs at which the queued announcements are sent
+const qint32 PacingInterval = 50;
+}
+
+/*******************************************************************************
+ * PresenceAnnouncer
+ ******************************************************************************/
+PresenceAnnouncer::PresenceAnnouncer(
+    const QByteArray& loggingIdentifier,
+    const QList<HDeviceHostSsdpHandler*>& ssdps, quint32 advertisementCount,
+    qint32 maxAnnouncementRate, QObject* parent) :
+        QObject(parent),
+            m_loggingIdentifier(loggingIdentifier),
+            m_ssdps(ssdps), m_advertisementCount(advertisementCount),
+            m_cache(), m_maxAnnouncementRate(maxAnnouncementRate),
+            m_pendingDatagrams(), m_pacingTimer(),
+            m_lastBurstSize(0), m_largestBurstSize(0)
+{
+    Q_ASSERT(m_advertisementCount > 0);
+    Q_ASSERT(m_maxAnnouncementRate >= 0);
+}
+
+PresenceAnnouncer::~PresenceAnnouncer()
+{
+}
+
+void PresenceAnnouncer::sendDatagrams(const QList<QByteArray>& datagrams)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    if (datagrams.isEmpty())
+    {
+        return;
+    }
+
+    for (quint32 i = 0; i < m_advertisementCount; ++i)
+    {
+        foreach(HDeviceHostSsdpHandler* ssdp, m_ssdps)
+        {
+            ssdp->announce(datagrams);
+        }
+    }
+
+    m_lastBurstSize = datagrams.size() * m_advertisementCount * m_ssdps.size();
+    if (m_lastBurstSize > m_largestBurstSize)
+    {
+        m_largestBurstSize = m_lastBurstSize;
+    }
+
+    HLOG_DBG(QString("Sent a burst of [%1] announcements").arg(
+        QString::number(m_lastBurstSize)));
+}
+
+void PresenceAnnouncer::sendPaced(const QList<QByteArray>& datagrams)
+{
+    if (!m_maxAnnouncementRate)
+    {
+        sendDatagrams(datagrams);
+        return;
+    }
+
+    m_pendingDatagrams.append(datagrams);
+    if (!m_pacingTimer.isActive())
+    {
+        // the first batch is sent right away, the rest at the pacing interval
+        m_pacingTimer.start(PacingInterval, this);
+        sendPendingBatch();
+    }
+}
+
+void PresenceAnnouncer::sendPendingBatch()
+{
+    // the advertisement count multiplies every datagram taken from the queue
+    qint32 batchSize = qMax(1,
+        m_maxAnnouncementRate * PacingInterval / 1000 /
+        static_cast<qint32>(m_advertisementCount));
+
+    if (batchSize >= m_pendingDatagrams.size())
+    {
+        sendDatagrams(m_pendingDatagrams);
+        m_pendingDatagrams.clear();
+        m_pacingTimer.stop();
+    }
+    else
+    {
+        sendDatagrams(m_pendingDatagrams.mid(0, batchSize));
+        m_pendingDatagrams.erase(
+            m_pendingDatagrams.begin(), m_pendingDatagrams.begin() + batchSize);
+    }
+}
+
+void PresenceAnnouncer::timerEvent(QTimerEvent* event)
+{
+    if (event->timerId() == m_pacingTimer.timerId())
+    {
+        sendPendingBatch();
+    }
+    else
+    {
+        QObject::timerEvent(event);
+    }
+}
+
+}
+}
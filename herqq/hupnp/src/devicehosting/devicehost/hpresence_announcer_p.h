@@ -31,6 +31,7 @@
 //
 
 #include "hserverdevicecontroller_p.h"
+#include "hdevicehost_ssdp_handler_p.h"
 
 #include "../../general/hupnp_global_p.h"
 #include "../../devicemodel/hdevicestatus.h"
@@ -39,6 +40,7 @@
 
 #include "../../ssdp/hssdp.h"
 #include "../../ssdp/hdiscovery_messages.h"
+#include "../../ssdp/hssdp_messagecreator_p.h"
 
 #include "../../dataelements/hudn.h"
 #include "../../dataelements/hdeviceinfo.h"
@@ -47,6 +49,9 @@
 #include "../../dataelements/hproduct_tokens.h"
 
 #include <QtCore/QUrl>
+#include <QtCore/QHash>
+#include <QtCore/QObject>
+#include <QtCore/QBasicTimer>
 
 namespace Herqq
 {
@@ -98,6 +103,8 @@ class ResourceAvailableAnnouncement :
 
 public:
 
+    enum { CacheSlot = 0, Paced = 1 };
+
     ResourceAvailableAnnouncement()
     {
     }
@@ -119,9 +126,18 @@ public:
             pt,
             m_usn,
             m_device->deviceStatus().bootId(),
-            m_device->deviceStatus().configId()
+            m_device->deviceStatus().configId(),
+            m_device->deviceStatus().searchPort()
             );
     }
+
+    // returns an empty array in case the message is not valid
+    inline QByteArray toDatagram() const
+    {
+        HResourceAvailable msg = (*this)();
+        return msg.isValid(StrictChecks) ?
+            HSsdpMessageCreator::create(msg) : QByteArray();
+    }
 };
 
 //
@@ -132,6 +148,8 @@ class ResourceUnavailableAnnouncement :
 {
 public:
 
+    enum { CacheSlot = 1, Paced = 0 };
+
     ResourceUnavailableAnnouncement()
     {
     }
@@ -151,51 +169,152 @@ public:
             m_device->deviceStatus().configId()
             );
     }
+
+    // returns an empty array in case the message is not valid
+    inline QByteArray toDatagram() const
+    {
+        HResourceUnavailable msg = (*this)();
+        return msg.isValid(StrictChecks) ?
+            HSsdpMessageCreator::create(msg) : QByteArray();
+    }
 };
 
-class HDeviceHostSsdpHandler;
+//
+// Announces the boot ID the device starts to use next. This is sent to the
+// networks the device is already on before the device starts to use another
+// network interface, after which the device is announced with the new boot ID.
+//
+class ResourceUpdateAnnouncement :
+    private Announcement
+{
+public:
+
+    enum { CacheSlot = 2, Paced = 0 };
+
+    ResourceUpdateAnnouncement()
+    {
+    }
+
+    ResourceUpdateAnnouncement(
+        HServerDevice* device, const HDiscoveryType& usn,
+        const QUrl& location, int deviceTimeoutInSecs) :
+            Announcement(device, usn, location, deviceTimeoutInSecs)
+    {
+    }
+
+    HResourceUpdate operator()() const
+    {
+        const HDeviceStatus& status = m_device->deviceStatus();
+
+        return HResourceUpdate(
+            m_location,
+            m_usn,
+            status.bootId(),
+            status.configId(),
+            status.bootId() + 1,
+            status.searchPort()
+            );
+    }
+
+    // returns an empty array in case the message is not valid
+    inline QByteArray toDatagram() const
+    {
+        HResourceUpdate msg = (*this)();
+        return msg.isValid(StrictChecks) ?
+            HSsdpMessageCreator::create(msg) : QByteArray();
+    }
+};
 
 //
 // Class that sends the SSDP announcements.
 //
-class PresenceAnnouncer
+// The announcements of a root device are serialized once and sent as
+// pre-built datagrams until the boot ID, the config ID, the device timeout
+// or the locations of the device change.
+//
+// The announcements of device availability can be paced to a maximum rate,
+// in which case the datagrams exceeding the rate are queued and sent in
+// small batches. The announcements of device unavailability are always
+// sent immediately.
+//
+class PresenceAnnouncer :
+    public QObject
 {
+Q_OBJECT
+H_DISABLE_COPY(PresenceAnnouncer)
+
 private:
 
+    struct CacheEntry
+    {
+        qint32 m_bootId;
+        qint32 m_configId;
+        int m_deviceTimeoutInSecs;
+        QList<QUrl> m_locations;
+
+        QList<QByteArray> m_datagrams[3];
+        // the serialized announcements indexed by AnnouncementType::CacheSlot
+
+        CacheEntry() :
+            m_bootId(-1), m_configId(-1), m_deviceTimeoutInSecs(-1),
+            m_locations()
+        {
+        }
+
+        CacheEntry(
+            const HDeviceStatus& status, int deviceTimeoutInSecs,
+            const QList<QUrl>& locations) :
+                m_bootId(status.bootId()), m_configId(status.configId()),
+                m_deviceTimeoutInSecs(deviceTimeoutInSecs),
+                m_locations(locations)
+        {
+        }
+
+        inline bool isCurrent(
+            const HDeviceStatus& status, int deviceTimeoutInSecs,
+            const QList<QUrl>& locations) const
+        {
+            return m_bootId == status.bootId() &&
+                   m_configId == status.configId() &&
+                   m_deviceTimeoutInSecs == deviceTimeoutInSecs &&
+                   m_locations == locations;
+        }
+    };
+
+    const QByteArray m_loggingIdentifier;
+
     QList<HDeviceHostSsdpHandler*> m_ssdps;
     quint32 m_advertisementCount;
 
+    QHash<const HServerDevice*, CacheEntry> m_cache;
+
+    qint32 m_maxAnnouncementRate;
+    // the maximum number of datagrams sent per second. zero means no limit.
+
+    QList<QByteArray> m_pendingDatagrams;
+    QBasicTimer m_pacingTimer;
+
+    qint32 m_lastBurstSize, m_largestBurstSize;
+    // the number of datagrams sent at once to all networks
+
 private:
 
     template<typename AnnouncementType>
     void createAnnouncementMessagesForEmbeddedDevice(
-        HServerDevice* device, int deviceTimeoutInSecs,
-        QList<AnnouncementType>* announcements)
+        const HServerDeviceController* controller, HServerDevice* device,
+        int deviceTimeoutInSecs, QList<AnnouncementType>* announcements)
     {
+        // the device UDN, the device type and the service types
+        const QList<HDiscoveryType>& usns = controller->usns(device);
+
         QList<QUrl> locations = device->locations();
         foreach(const QUrl& location, locations)
         {
-            HDeviceInfo deviceInfo = device->info();
-
-            HUdn udn = deviceInfo.udn();
-            HDiscoveryType usn(udn);
-
-            // device UDN advertisement
-            announcements->push_back(
-                AnnouncementType(device, usn, location, deviceTimeoutInSecs));
-
-            // device type advertisement
-            usn.setResourceType(deviceInfo.deviceType());
-            announcements->push_back(
-                AnnouncementType(device, usn, location, deviceTimeoutInSecs));
-
-            // service advertisements
-            const HServerServices& services = device->services();
-            foreach(HServerService* service, services)
+            foreach(const HDiscoveryType& usn, usns)
             {
-                usn.setResourceType(service->info().serviceType());
                 announcements->push_back(
-                    AnnouncementType(device, usn, location, deviceTimeoutInSecs));
+                    AnnouncementType(
+                        device, usn, location, deviceTimeoutInSecs));
             }
         }
 
@@ -203,85 +322,138 @@ private:
         foreach(HServerDevice* embeddedDevice, devices)
         {
             createAnnouncementMessagesForEmbeddedDevice(
-                embeddedDevice, deviceTimeoutInSecs, announcements);
+                controller, embeddedDevice, deviceTimeoutInSecs, announcements);
         }
     }
 
-public:
-
-    PresenceAnnouncer(
-        const QList<HDeviceHostSsdpHandler*>& ssdps, quint32 advertisementCount) :
-            m_ssdps(ssdps), m_advertisementCount(advertisementCount)
+    template<typename AnnouncementType>
+    void createAnnouncementMessagesForRootDevice(
+        const HServerDeviceController* controller, int deviceTimeoutInSecs,
+        QList<AnnouncementType>* announcements)
     {
-        Q_ASSERT(m_advertisementCount > 0);
-    }
+        HServerDevice* rootDevice = controller->m_device;
 
-    ~PresenceAnnouncer()
-    {
+        QList<QUrl> locations = rootDevice->locations();
+        foreach(const QUrl& location, locations)
+        {
+            announcements->push_back(
+                AnnouncementType(
+                    rootDevice, controller->rootDeviceUsn(), location,
+                    deviceTimeoutInSecs));
+        }
+
+        // generic device advertisement (same for both root and embedded devices)
+        createAnnouncementMessagesForEmbeddedDevice(
+            controller, rootDevice, deviceTimeoutInSecs, announcements);
     }
 
+    // returns the serialized announcements of the specified root device,
+    // which are re-rendered only if the cached ones are out of date
     template<typename AnnouncementType>
-    void announce(const HServerDeviceController* rootDevice)
+    const QList<QByteArray>& datagrams(
+        const HServerDeviceController* rootDevice)
     {
-        Q_ASSERT(rootDevice);
+        HServerDevice* device = rootDevice->m_device;
+        int deviceTimeoutInSecs = rootDevice->deviceTimeoutInSecs();
 
-        QList<AnnouncementType> announcements;
-
-        createAnnouncementMessagesForRootDevice(
-            rootDevice->m_device, rootDevice->deviceTimeoutInSecs(),
-            &announcements);
+        const HDeviceStatus& status = device->deviceStatus();
+        QList<QUrl> locations = device->locations();
 
-        sendAnnouncements(announcements);
-    }
+        CacheEntry& entry = m_cache[device];
+        if (!entry.isCurrent(status, deviceTimeoutInSecs, locations))
+        {
+            entry = CacheEntry(status, deviceTimeoutInSecs, locations);
+        }
 
-    template<typename AnnouncementType>
-    void announce(const QList<HServerDeviceController*>& rootDevices)
-    {
-        QList<AnnouncementType> announcements;
+        QList<QByteArray>& retVal =
+            entry.m_datagrams[AnnouncementType::CacheSlot];
 
-        foreach(HServerDeviceController* rootDevice, rootDevices)
+        if (retVal.isEmpty())
         {
+            QList<AnnouncementType> announcements;
             createAnnouncementMessagesForRootDevice(
-                rootDevice->m_device, rootDevice->deviceTimeoutInSecs(),
-                &announcements);
+                rootDevice, deviceTimeoutInSecs, &announcements);
+
+            foreach(const AnnouncementType& at, announcements)
+            {
+                QByteArray datagram = at.toDatagram();
+                if (!datagram.isEmpty())
+                {
+                    retVal.append(datagram);
+                }
+            }
         }
 
-        sendAnnouncements(announcements);
+        return retVal;
     }
 
+    // sends the datagrams immediately
+    void sendDatagrams(const QList<QByteArray>& datagrams);
+
+    // sends the datagrams as fast as the maximum rate allows
+    void sendPaced(const QList<QByteArray>& datagrams);
+    void sendPendingBatch();
+
     template<typename AnnouncementType>
-    void createAnnouncementMessagesForRootDevice(
-        HServerDevice* rootDevice, int deviceTimeoutInSecs,
-        QList<AnnouncementType>* announcements)
+    inline void send(const QList<QByteArray>& datagrams)
     {
-        QList<QUrl> locations = rootDevice->locations();
-        foreach(const QUrl& location, locations)
+        if (AnnouncementType::Paced)
         {
-            HUdn udn(rootDevice->info().udn());
-            HDiscoveryType usn(udn, true);
-
-            announcements->push_back(
-                AnnouncementType(rootDevice, usn, location, deviceTimeoutInSecs));
+            sendPaced(datagrams);
+        }
+        else
+        {
+            sendDatagrams(datagrams);
         }
+    }
 
-        // generic device advertisement (same for both root and embedded devices)
-        createAnnouncementMessagesForEmbeddedDevice(
-            rootDevice, deviceTimeoutInSecs, announcements);
+protected:
+
+    virtual void timerEvent(QTimerEvent*);
+
+public:
+
+    PresenceAnnouncer(
+        const QByteArray& loggingIdentifier,
+        const QList<HDeviceHostSsdpHandler*>& ssdps, quint32 advertisementCount,
+        qint32 maxAnnouncementRate, QObject* parent = 0);
+
+    virtual ~PresenceAnnouncer();
+
+    // sets the SSDP handlers the announcements are sent through, which
+    // changes when the device host starts or stops using a network interface
+    inline void setSsdps(const QList<HDeviceHostSsdpHandler*>& ssdps)
+    {
+        m_ssdps = ssdps;
+    }
+
+    // forgets the serialized announcements of a root device that is removed
+    inline void deviceRemoved(const HServerDevice* rootDevice)
+    {
+        m_cache.remove(rootDevice);
+    }
+
+    inline qint32 lastBurstSize() const { return m_lastBurstSize; }
+    inline qint32 largestBurstSize() const { return m_largestBurstSize; }
+
+    template<typename AnnouncementType>
+    void announce(const HServerDeviceController* rootDevice)
+    {
+        Q_ASSERT(rootDevice);
+        send<AnnouncementType>(datagrams<AnnouncementType>(rootDevice));
     }
 
     template<typename AnnouncementType>
-    void sendAnnouncements(const QList<AnnouncementType>& announcements)
+    void announce(const QList<HServerDeviceController*>& rootDevices)
     {
-        for (quint32 i = 0; i < m_advertisementCount; ++i)
+        QList<QByteArray> allDatagrams;
+
+        foreach(HServerDeviceController* rootDevice, rootDevices)
         {
-            foreach(HSsdp* ssdp, m_ssdps)
-            {
-                foreach(const AnnouncementType& at, announcements)
-                {
-                    ssdp->announcePresence(at());
-                }
-            }
+            allDatagrams.append(datagrams<AnnouncementType>(rootDevice));
         }
+
+        send<AnnouncementType>(allDatagrams);
     }
 };
 
@@ -31,7 +31,10 @@
 //
 
 #include <HUpnpCore/HUpnp>
+#include <HUpnpCore/HDiscoveryType>
 
+#include <QtCore/QHash>
+#include <QtCore/QList>
 #include <QtCore/QObject>
 #include <QtCore/QScopedPointer>
 
@@ -59,9 +62,17 @@ H_DISABLE_COPY(HServerDeviceController)
 private:
 
     bool m_timedout;
+    qint32 m_deviceTimeoutInSecs;
     QScopedPointer<QTimer> m_statusNotifier;
     QScopedPointer<HDeviceStatus> m_deviceStatus;
 
+    HDiscoveryType m_rootDeviceUsn;
+    QHash<const HServerDevice*, QList<HDiscoveryType> > m_usns;
+    // the USNs of every device of the tree, built once since the device
+    // model does not change while it is hosted
+
+    void createUsns(const HServerDevice*);
+
 private Q_SLOTS:
 
     void timeout_();
@@ -85,7 +96,24 @@ public:
         return m_deviceStatus.data();
     }
 
+    // returns the "uuid:device-UUID::upnp:rootdevice" USN of the root device
+    inline const HDiscoveryType& rootDeviceUsn() const
+    {
+        return m_rootDeviceUsn;
+    }
+
+    // returns the USNs of the specified device of this tree in the order they
+    // are advertised: the UDN, the device type and the types of the services
+    // of the device. the USNs of the embedded devices are not included.
+    const QList<HDiscoveryType>& usns(const HServerDevice*) const;
+
+    // starts the notifier to time out somewhat before the device timeout.
+    // the random jitter keeps the re-advertisements of different devices
+    // from synchronizing.
     void startStatusNotifier();
+
+    // starts the notifier to time out after the specified number of msecs
+    void startStatusNotifier(qint32 timeoutInMsecs);
     void stopStatusNotifier();
 
     bool isTimedout() const;
@@ -59,7 +59,10 @@ namespace Upnp
  ******************************************************************************/
 HServerModelCreationArgs::HServerModelCreationArgs(
     HDeviceModelCreator* creator) :
-        m_deviceModelCreator(creator), m_infoProvider(0), m_ddPostFix()
+        m_deviceModelCreator(creator), m_infoProvider(0), m_ddPostFix(),
+        m_parsedServiceDescriptions(0), m_servicePrototypes(0),
+        m_deviceDescription(),
+        m_serviceDescriptionFetcher()
 {
 }
 
@@ -72,7 +75,11 @@ HServerModelCreationArgs::HServerModelCreationArgs(
         HModelCreationArgs(other),
             m_deviceModelCreator(other.m_deviceModelCreator),
             m_infoProvider(other.m_infoProvider),
-            m_ddPostFix(other.m_ddPostFix)
+            m_ddPostFix(other.m_ddPostFix),
+            m_parsedServiceDescriptions(other.m_parsedServiceDescriptions),
+            m_servicePrototypes(other.m_servicePrototypes),
+            m_deviceDescription(other.m_deviceDescription),
+            m_serviceDescriptionFetcher(other.m_serviceDescriptionFetcher)
 {
 }
 
@@ -86,6 +93,10 @@ HServerModelCreationArgs& HServerModelCreationArgs::operator=(
     m_deviceModelCreator = other.m_deviceModelCreator;
     m_infoProvider = other.m_infoProvider;
     m_ddPostFix = other.m_ddPostFix;
+    m_parsedServiceDescriptions = other.m_parsedServiceDescriptions;
+    m_servicePrototypes = other.m_servicePrototypes;
+    m_deviceDescription = other.m_deviceDescription;
+    m_serviceDescriptionFetcher = other.m_serviceDescriptionFetcher;
 
     return *this;
 }
@@ -97,7 +108,7 @@ HServerModelCreator::HServerModelCreator(
     const HServerModelCreationArgs& creationParameters) :
         m_creationParameters(new HServerModelCreationArgs(creationParameters)),
         m_docParser(creationParameters.m_loggingIdentifier, StrictChecks),
-        m_lastErrorDescription()
+        m_lastErrorDescription(), m_deviceDescription()
 {
     Q_ASSERT(creationParameters.m_serviceDescriptionFetcher);
     Q_ASSERT(creationParameters.m_deviceLocations.size() > 0);
@@ -150,22 +161,14 @@ HDevicesSetupData HServerModelCreator::getDevicesSetupData(
     return HDevicesSetupData();
 }
 
-bool HServerModelCreator::parseStateVariables(
-    HServerService* service, QDomElement stateVariableElement)
+bool HServerModelCreator::validateStateVariables(
+    HServerService* service, const QList<HStateVariableInfo>& svInfos)
 {
     HStateVariablesSetupData stateVariablesSetup =
         getStateVariablesSetupData(service);
 
-    while(!stateVariableElement.isNull())
+    foreach(const HStateVariableInfo& svInfo, svInfos)
     {
-        HStateVariableInfo svInfo;
-        if (!m_docParser.parseStateVariable(stateVariableElement, &svInfo))
-        {
-            m_lastError = convert(m_docParser.lastError());
-            m_lastErrorDescription = m_docParser.lastErrorDescription();
-            return false;
-        }
-
         QString name = svInfo.name();
         HStateVariableInfo setupData = stateVariablesSetup.get(name);
         if (!setupData.isValid() &&
@@ -181,7 +184,7 @@ bool HServerModelCreator::parseStateVariables(
         }
 
         HDeviceValidator validator;
-        if (!validator.validate(stateVariablesSetup.get(name), svInfo))
+        if (!validator.validate(setupData, svInfo))
         {
             m_lastError = InvalidServiceDescription;
             m_lastErrorDescription =
@@ -192,24 +195,6 @@ bool HServerModelCreator::parseStateVariables(
             return false;
         }
 
-        HDefaultServerStateVariable* sv =
-            new HDefaultServerStateVariable(svInfo, service);
-
-        service->h_ptr->addStateVariable(sv);
-
-        bool ok = QObject::connect(
-            sv,
-            SIGNAL(valueChanged(
-                Herqq::Upnp::HServerStateVariable*,
-                const Herqq::Upnp::HStateVariableEvent&)),
-            service,
-            SLOT(notifyListeners()));
-
-        Q_ASSERT(ok); Q_UNUSED(ok)
-
-        stateVariableElement =
-            stateVariableElement.nextSiblingElement("stateVariable");
-
         stateVariablesSetup.remove(name);
     }
 
@@ -234,41 +219,15 @@ bool HServerModelCreator::parseStateVariables(
     return true;
 }
 
-bool HServerModelCreator::parseActions(
-    HServerService* service, QDomElement actionElement,
-    const HStateVariableInfos& svInfos)
+bool HServerModelCreator::validateActions(
+    HServerService* service, const QList<HActionInfo>& actionInfos)
 {
     HActionsSetupData actionsSetupData = getActionsSetupData(service);
 
-    QHash<QString, HActionInvoke> actionInvokes = service->createActionInvokes();
-
-    while(!actionElement.isNull())
+    foreach(const HActionInfo& actionInfo, actionInfos)
     {
-        HActionInfo actionInfo;
-        if (!m_docParser.parseActionInfo(
-                actionElement, svInfos, &actionInfo))
-        {
-            m_lastError = convert(m_docParser.lastError());
-            m_lastErrorDescription = m_docParser.lastErrorDescription();
-            return false;
-        }
-
         QString name = actionInfo.name();
 
-        HActionInvoke actionInvoke = actionInvokes.value(name);
-        if (!actionInvoke)
-        {
-            m_lastError = UnimplementedAction;
-            m_lastErrorDescription = QString(
-                "Service [%1]: action [%2] lacks an implementation").arg(
-                    service->info().serviceId().toString(), name);
-
-            return false;
-        }
-
-        QScopedPointer<HDefaultServerAction> action(
-            new HDefaultServerAction(actionInfo, actionInvoke, service));
-
         HDeviceValidator validator;
         if (!validator.validate(actionsSetupData.get(name), actionInfo))
         {
@@ -281,10 +240,6 @@ bool HServerModelCreator::parseActions(
             return false;
         }
 
-        service->h_ptr->m_actions.insert(name, action.take());
-
-        actionElement = actionElement.nextSiblingElement("action");
-
         actionsSetupData.remove(name);
     }
 
@@ -309,34 +264,128 @@ bool HServerModelCreator::parseActions(
     return true;
 }
 
-bool HServerModelCreator::parseServiceDescription(HServerService* service)
+void HServerModelCreator::createStateVariables(
+    HServerService* service, const QList<HStateVariableInfo>& svInfos)
+{
+    foreach(const HStateVariableInfo& svInfo, svInfos)
+    {
+        HDefaultServerStateVariable* sv =
+            new HDefaultServerStateVariable(svInfo, service);
+
+        service->h_ptr->addStateVariable(sv);
+
+        bool ok = QObject::connect(
+            sv,
+            SIGNAL(valueChanged(
+                Herqq::Upnp::HServerStateVariable*,
+                const Herqq::Upnp::HStateVariableEvent&)),
+            service,
+            SLOT(notifyListeners()));
+
+        Q_ASSERT(ok); Q_UNUSED(ok)
+    }
+}
+
+bool HServerModelCreator::createActions(
+    HServerService* service, const QList<HActionInfo>& actionInfos)
+{
+    // the invokes are bound to the service object, which is why they are
+    // asked for every service even when the service matches a prototype
+    QHash<QString, HActionInvoke> actionInvokes = service->createActionInvokes();
+
+    foreach(const HActionInfo& actionInfo, actionInfos)
+    {
+        QString name = actionInfo.name();
+
+        HActionInvoke actionInvoke = actionInvokes.value(name);
+        if (!actionInvoke)
+        {
+            m_lastError = UnimplementedAction;
+            m_lastErrorDescription = QString(
+                "Service [%1]: action [%2] lacks an implementation").arg(
+                    service->info().serviceId().toString(), name);
+
+            return false;
+        }
+
+        service->h_ptr->m_actions.insert(
+            name, new HDefaultServerAction(actionInfo, actionInvoke, service));
+    }
+
+    return true;
+}
+
+namespace
+{
+inline QPair<QString, QString> prototypeKey(
+    const HServerService* service, const QString& serviceDescription)
+{
+    const HServiceInfo& info = service->info();
+    return qMakePair(
+        QString("%1 %2 %3").arg(
+            service->parentDevice()->info().deviceType().toString(),
+            info.serviceType().toString(), info.serviceId().toString()),
+        serviceDescription);
+}
+}
+
+bool HServerModelCreator::parseServiceDescription(
+    HServerService* service, const QString& serviceDescription)
 {
     HLOG2(H_AT, H_FUN, m_creationParameters->m_loggingIdentifier);
     Q_ASSERT(service);
 
-    QDomDocument doc;
-    QDomElement firstSv, firstAction;
-    if (!m_docParser.parseServiceDescription(
-        service->h_ptr->m_serviceDescription, &doc, &firstSv, &firstAction))
+    HServicePrototypes* prototypes = m_creationParameters->servicePrototypes();
+
+    QPair<QString, QString> key;
+    if (prototypes)
+    {
+        key = prototypeKey(service, serviceDescription);
+
+        HServicePrototypes::const_iterator it = prototypes->constFind(key);
+        if (it != prototypes->constEnd())
+        {
+            // an identical service has been validated already. only the
+            // objects of this instance have to be created
+            createStateVariables(service, it.value().m_stateVariables);
+            return createActions(service, it.value().m_actions);
+        }
+    }
+
+    const HParsedServiceDescriptions* parsedDescriptions =
+        m_creationParameters->parsedServiceDescriptions();
+
+    HParsedServiceDescription parsed;
+    if (parsedDescriptions && parsedDescriptions->contains(serviceDescription))
+    {
+        parsed = parsedDescriptions->value(serviceDescription);
+    }
+    else if (!m_docParser.parseServiceDescription(
+        serviceDescription, &parsed.m_stateVariables, &parsed.m_actions))
     {
         m_lastError = convert(m_docParser.lastError());
         m_lastErrorDescription = m_docParser.lastErrorDescription();
         return false;
     }
 
-    if (!parseStateVariables(service, firstSv))
+    if (!validateStateVariables(service, parsed.m_stateVariables) ||
+        !validateActions(service, parsed.m_actions))
+    {
+        return false;
+    }
+
+    createStateVariables(service, parsed.m_stateVariables);
+    if (!createActions(service, parsed.m_actions))
     {
         return false;
     }
 
-    HStateVariableInfos svInfos;
-    HServerStateVariables svs = service->stateVariables();
-    foreach(const QString& key, svs.keys())
+    if (prototypes)
     {
-        svInfos.insert(key, svs.value(key)->info());
+        prototypes->insert(key, parsed);
     }
 
-    return parseActions(service, firstAction, svInfos);
+    return true;
 }
 
 bool HServerModelCreator::parseServiceList(
@@ -386,9 +435,10 @@ bool HServerModelCreator::parseServiceList(
             return false;
         }
 
+        QString serviceDescription;
         if (!m_creationParameters->m_serviceDescriptionFetcher(
                 extractBaseUrl(m_creationParameters->m_deviceLocations[0]),
-                info.scpdUrl(), &service->h_ptr->m_serviceDescription))
+                info.scpdUrl(), &serviceDescription))
         {
             m_lastError = FailedToGetDataError;
             m_lastErrorDescription = QString(
@@ -398,11 +448,15 @@ bool HServerModelCreator::parseServiceList(
             return false;
         }
 
-        if (!parseServiceDescription(service.data()))
+        if (!parseServiceDescription(service.data(), serviceDescription))
         {
             return false;
         }
 
+        // the services of the same type share the stored description
+        service->h_ptr->m_serviceDescription =
+            HDescriptionData(serviceDescription);
+
         QString errDescr;
         bool ok = service->finalizeInit(&errDescr);
         if (!ok)
@@ -496,8 +550,7 @@ HServerDevice* HServerModelCreator::parseDevice(
         return 0;
     }
 
-    device->h_ptr->m_deviceDescription =
-        m_creationParameters->m_deviceDescription;
+    device->h_ptr->m_deviceDescription = m_deviceDescription;
 
     QDomElement serviceListElement =
         deviceElement.firstChildElement("serviceList");
@@ -588,6 +641,9 @@ HServerDevice* HServerModelCreator::createRootDevice()
         return 0;
     }
 
+    m_deviceDescription =
+        HDescriptionData(m_creationParameters->m_deviceDescription);
+
     QScopedPointer<HServerDevice> createdDevice(parseDevice(rootElement, 0));
     if (!createdDevice)
     {
@@ -616,5 +672,49 @@ HServerDevice* HServerModelCreator::createRootDevice()
     return createdDevice.take();
 }
 
+void HServerModelCreator::setLocations(
+    HServerDevice* rootDevice, const QList<QUrl>& rootUrls,
+    const QString& ddPostFix)
+{
+    Q_ASSERT(rootDevice && !rootDevice->parentDevice());
+
+    rootDevice->h_ptr->m_locations =
+        generateLocations(rootDevice->info().udn(), rootUrls, ddPostFix);
+}
+
+void HServerModelCreator::setBootId(HServerDevice* rootDevice, qint32 bootId)
+{
+    Q_ASSERT(rootDevice && !rootDevice->parentDevice());
+    rootDevice->h_ptr->m_deviceStatus->setBootId(bootId);
+}
+
+void HServerModelCreator::setConfigId(
+    HServerDevice* rootDevice, qint32 configId)
+{
+    Q_ASSERT(rootDevice && !rootDevice->parentDevice());
+    rootDevice->h_ptr->m_deviceStatus->setConfigId(configId);
+}
+
+void HServerModelCreator::setSearchPort(
+    HServerDevice* rootDevice, qint32 searchPort)
+{
+    Q_ASSERT(rootDevice && !rootDevice->parentDevice());
+    rootDevice->h_ptr->m_deviceStatus->setSearchPort(searchPort);
+}
+
+HDescriptionData HServerModelCreator::descriptionData(
+    const HServerDevice* device)
+{
+    Q_ASSERT(device);
+    return device->h_ptr->m_deviceDescription;
+}
+
+HDescriptionData HServerModelCreator::descriptionData(
+    const HServerService* service)
+{
+    Q_ASSERT(service);
+    return service->h_ptr->m_serviceDescription;
+}
+
 }
 }
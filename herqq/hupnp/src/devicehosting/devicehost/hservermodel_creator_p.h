@@ -33,6 +33,10 @@
 #include "../hddoc_parser_p.h"
 #include "../hmodelcreation_p.h"
 #include "../../devicemodel/hactioninvoke.h"
+#include "../../devicemodel/hdescription_data_p.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QPair>
 
 namespace Herqq
 {
@@ -40,6 +44,27 @@ namespace Herqq
 namespace Upnp
 {
 
+//
+// The parsed contents of a service description
+//
+class HParsedServiceDescription
+{
+public:
+
+    QList<HStateVariableInfo> m_stateVariables;
+    QList<HActionInfo> m_actions;
+};
+
+typedef QHash<QString, HParsedServiceDescription> HParsedServiceDescriptions;
+// the parsed service descriptions keyed by the descriptions themselves
+
+typedef QHash<QPair<QString, QString>, HParsedServiceDescription>
+    HServicePrototypes;
+// the service descriptions that have been validated against the setup data
+// of the info provider, keyed by the device type, the service type and the
+// service ID of a service together with its description. the services that
+// match a prototype are created without validating them again
+
 //
 //
 //
@@ -56,8 +81,22 @@ private:
 
     QString m_ddPostFix;
 
+    const HParsedServiceDescriptions* m_parsedServiceDescriptions;
+    // Not owned. The service descriptions not found here are parsed when
+    // the model is created
+
+    HServicePrototypes* m_servicePrototypes;
+    // Not owned. May be null. The services validated during the creation
+    // of the model are added here
+
 public:
 
+    QString m_deviceDescription;
+
+    ServiceDescriptionFetcher m_serviceDescriptionFetcher;
+    // provides the possibility of defining how the service description is
+    // retrieved
+
     HServerModelCreationArgs(HDeviceModelCreator*);
     HServerModelCreationArgs(const HServerModelCreationArgs&);
 
@@ -89,6 +128,27 @@ public:
     {
         return m_ddPostFix;
     }
+
+    inline void setParsedServiceDescriptions(
+        const HParsedServiceDescriptions* arg)
+    {
+        m_parsedServiceDescriptions = arg;
+    }
+
+    inline const HParsedServiceDescriptions* parsedServiceDescriptions() const
+    {
+        return m_parsedServiceDescriptions;
+    }
+
+    inline void setServicePrototypes(HServicePrototypes* arg)
+    {
+        m_servicePrototypes = arg;
+    }
+
+    inline HServicePrototypes* servicePrototypes() const
+    {
+        return m_servicePrototypes;
+    }
 };
 
 //
@@ -120,6 +180,9 @@ private:
     QString m_lastErrorDescription;
     ErrorType m_lastError;
 
+    HDescriptionData m_deviceDescription;
+    // the device description shared by every device of the tree
+
 private:
 
     HStateVariablesSetupData getStateVariablesSetupData(HServerService*);
@@ -130,15 +193,20 @@ private:
     QList<QPair<QUrl, QByteArray> > parseIconList(
         const QDomElement& iconListElement);
 
-    bool parseStateVariables(
-        HServerService* service, QDomElement stateVariableElement);
+    bool validateStateVariables(
+        HServerService* service, const QList<HStateVariableInfo>& svInfos);
+
+    bool validateActions(
+        HServerService* service, const QList<HActionInfo>& actionInfos);
 
-    bool parseActions(
-        HServerService* service,
-        QDomElement actionElement,
-        const HStateVariableInfos& svInfos);
+    void createStateVariables(
+        HServerService* service, const QList<HStateVariableInfo>& svInfos);
 
-    bool parseServiceDescription(HServerService*);
+    bool createActions(
+        HServerService* service, const QList<HActionInfo>& actionInfos);
+
+    bool parseServiceDescription(
+        HServerService*, const QString& serviceDescription);
 
     bool parseServiceList(
         const QDomElement& serviceListElement, HServerDevice*,
@@ -167,6 +235,26 @@ public:
     HServerModelCreator(const HServerModelCreationArgs&);
     HServerDevice* createRootDevice();
 
+    // replaces the locations of a root device created earlier with ones
+    // generated from the specified root URLs of the HTTP server
+    static void setLocations(
+        HServerDevice* rootDevice, const QList<QUrl>& rootUrls,
+        const QString& ddPostFix);
+
+    // sets the boot ID of a root device created earlier
+    static void setBootId(HServerDevice* rootDevice, qint32 bootId);
+
+    // sets the config ID of a root device created earlier
+    static void setConfigId(HServerDevice* rootDevice, qint32 configId);
+
+    // sets the SEARCHPORT.UPNP.ORG of a root device created earlier
+    static void setSearchPort(HServerDevice* rootDevice, qint32 searchPort);
+
+    // returns the descriptions of a device or a service created earlier in
+    // the form they are stored in
+    static HDescriptionData descriptionData(const HServerDevice*);
+    static HDescriptionData descriptionData(const HServerService*);
+
     inline ErrorType lastError() const { return m_lastError; }
     inline QString lastErrorDescription() const { return m_lastErrorDescription; }
 };
@@ -0,0 +1,198 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "htaskscheduler.h"
+#include "htaskscheduler_p.h"
+
+#include "../../general/hlogger_p.h"
+
+#include <QtCore/QTimerEvent>
+#include <QtCore/QElapsedTimer>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+/*******************************************************************************
+ * HTaskSchedulerPrivate
+ ******************************************************************************/
+HTaskSchedulerPrivate::HTaskSchedulerPrivate() :
+    m_pending(), m_sliceLength(5), m_lastId(0), m_timerId(0)
+{
+}
+
+bool HTaskSchedulerPrivate::takeNext(Task* task, qint32* priority)
+{
+    for (qint32 i = 0; i < PriorityCount; ++i)
+    {
+        if (!m_queues[i].isEmpty())
+        {
+            *task = m_queues[i].takeFirst();
+            *priority = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+/*******************************************************************************
+ * HTaskScheduler
+ ******************************************************************************/
+HTaskScheduler::HTaskScheduler(QObject* parent) :
+    QObject(parent), h_ptr(new HTaskSchedulerPrivate())
+{
+}
+
+HTaskScheduler::~HTaskScheduler()
+{
+    delete h_ptr;
+}
+
+void HTaskScheduler::timerEvent(QTimerEvent* event)
+{
+    if (event->timerId() != h_ptr->m_timerId)
+    {
+        QObject::timerEvent(event);
+        return;
+    }
+
+    QElapsedTimer elapsed;
+    elapsed.start();
+
+    // The next task is chosen after every step, so a task of a higher
+    // priority scheduled by a step runs before the lower priority tasks
+    // that were waiting.
+    HTaskSchedulerPrivate::Task task(0, HTaskStep());
+    qint32 priority = 0;
+    while (h_ptr->takeNext(&task, &priority))
+    {
+        bool more = task.m_step();
+        if (!h_ptr->m_pending.contains(task.m_id))
+        {
+            // cancelled during the step
+        }
+        else if (more)
+        {
+            h_ptr->m_queues[priority].append(task);
+        }
+        else
+        {
+            h_ptr->m_pending.remove(task.m_id);
+            emit taskFinished(task.m_id);
+        }
+
+        if (elapsed.elapsed() >= h_ptr->m_sliceLength)
+        {
+            break;
+        }
+    }
+
+    if (h_ptr->m_pending.isEmpty() && h_ptr->m_timerId)
+    {
+        killTimer(h_ptr->m_timerId);
+        h_ptr->m_timerId = 0;
+    }
+}
+
+qint32 HTaskScheduler::sliceLength() const
+{
+    return h_ptr->m_sliceLength;
+}
+
+void HTaskScheduler::setSliceLength(qint32 msecs)
+{
+    if (msecs > 0)
+    {
+        h_ptr->m_sliceLength = msecs;
+    }
+}
+
+qint32 HTaskScheduler::schedule(const HTaskStep& step, Priority priority)
+{
+    HLOG(H_AT, H_FUN);
+
+    if (!step || priority < HighPriority || priority > LowPriority)
+    {
+        HLOG_WARN("Ignoring an invalid task");
+        return 0;
+    }
+
+    do
+    {
+        if (++h_ptr->m_lastId <= 0)
+        {
+            h_ptr->m_lastId = 1;
+        }
+    }
+    while (h_ptr->m_pending.contains(h_ptr->m_lastId));
+
+    qint32 taskId = h_ptr->m_lastId;
+    h_ptr->m_queues[priority].append(
+        HTaskSchedulerPrivate::Task(taskId, step));
+    h_ptr->m_pending.insert(taskId);
+
+    if (!h_ptr->m_timerId)
+    {
+        h_ptr->m_timerId = startTimer(0);
+    }
+
+    return taskId;
+}
+
+bool HTaskScheduler::cancel(qint32 taskId)
+{
+    if (!h_ptr->m_pending.remove(taskId))
+    {
+        return false;
+    }
+
+    for (qint32 i = 0; i < HTaskSchedulerPrivate::PriorityCount; ++i)
+    {
+        QList<HTaskSchedulerPrivate::Task>& queue = h_ptr->m_queues[i];
+        for (qint32 j = 0; j < queue.size(); ++j)
+        {
+            if (queue[j].m_id == taskId)
+            {
+                queue.removeAt(j);
+                return true;
+            }
+        }
+    }
+
+    // The task is running its step and it is dropped once the
+    // step returns.
+    return true;
+}
+
+bool HTaskScheduler::isPending(qint32 taskId) const
+{
+    return h_ptr->m_pending.contains(taskId);
+}
+
+qint32 HTaskScheduler::pendingCount() const
+{
+    return h_ptr->m_pending.size();
+}
+
+}
+}
@@ -0,0 +1,215 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HTASKSCHEDULER_H_
+#define HTASKSCHEDULER_H_
+
+#include <HUpnpCore/HUpnp>
+#include <HUpnpCore/HFunctor>
+
+#include <QtCore/QObject>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+class HTaskSchedulerPrivate;
+
+/*!
+ * \brief This is a type definition for a step of a task run by HTaskScheduler.
+ *
+ * A step does a bounded amount of work and returns \e true in case the task
+ * has more work to do, or \e false in case the task is done.
+ *
+ * \headerfile htaskscheduler.h HTaskScheduler
+ *
+ * \ingroup hupnp_devicehosting
+ *
+ * \sa HTaskScheduler
+ */
+typedef Functor<bool> HTaskStep;
+
+/*!
+ * \brief This class runs long operations in short slices in the thread it
+ * lives in.
+ *
+ * A long operation that is run as a single call in the thread of a device
+ * host delays everything else the thread does, including the responses to
+ * discovery requests, which have to be sent within the time the requester
+ * specified. Such an operation can be split into steps and scheduled to an
+ * HTaskScheduler, which runs the steps of the scheduled tasks for at most
+ * sliceLength() milliseconds at a time and returns to the event loop in
+ * between, so that the network events are processed between the slices.
+ *
+ * Every task has a priority. A step of a task is run only when no task of
+ * a higher priority is waiting and the tasks of the same priority take turns
+ * one step at a time.
+ *
+ * \headerfile htaskscheduler.h HTaskScheduler
+ *
+ * \ingroup hupnp_devicehosting
+ *
+ * \sa HDeviceHost::taskScheduler()
+ *
+ * \remarks
+ * \li This class is not thread-safe. The steps are run in the thread of the
+ * scheduler and a task should access only objects of that thread.
+ * \li A step is never interrupted, which is why a step should not take
+ * longer than a fraction of the slice length.
+ */
+class H_UPNP_CORE_EXPORT HTaskScheduler :
+    public QObject
+{
+Q_OBJECT
+H_DISABLE_COPY(HTaskScheduler)
+H_DECLARE_PRIVATE(HTaskScheduler)
+
+public:
+
+    /*!
+     * \brief This enumeration specifies the priorities of the tasks.
+     */
+    enum Priority
+    {
+        /*!
+         * The task is latency-critical, such as protocol work that has
+         * a deadline.
+         */
+        HighPriority = 0,
+
+        /*!
+         * The task is run when there are no high priority tasks.
+         */
+        NormalPriority,
+
+        /*!
+         * The task is background work, such as the addition of a large
+         * number of objects to a data source.
+         */
+        LowPriority
+    };
+
+private:
+
+    HTaskSchedulerPrivate* h_ptr;
+
+protected:
+
+    virtual void timerEvent(QTimerEvent*);
+
+public:
+
+    /*!
+     * \brief Creates a new instance.
+     *
+     * \param parent specifies the parent \c QObject.
+     */
+    explicit HTaskScheduler(QObject* parent = 0);
+
+    /*!
+     * \brief Destroys the instance.
+     *
+     * The tasks that have not finished are discarded.
+     */
+    virtual ~HTaskScheduler();
+
+    /*!
+     * \brief Returns the time the scheduler runs the steps of the tasks before
+     * it returns to the event loop.
+     *
+     * \return The time the scheduler runs the steps of the tasks before it
+     * returns to the event loop in milliseconds. The default is 5.
+     *
+     * \sa setSliceLength()
+     */
+    qint32 sliceLength() const;
+
+    /*!
+     * \brief Specifies the time the scheduler runs the steps of the tasks
+     * before it returns to the event loop.
+     *
+     * \param msecs specifies the length of a slice in milliseconds. A value
+     * smaller than one is ignored.
+     *
+     * \sa sliceLength()
+     */
+    void setSliceLength(qint32 msecs);
+
+    /*!
+     * \brief Schedules a new task.
+     *
+     * \param step specifies the step that is run until it returns \e false.
+     * \param priority specifies the priority of the task.
+     *
+     * \return The ID of the task, which is always a positive number,
+     * or zero in case the \a step is not valid.
+     *
+     * \remarks The first step is run after the control returns to the
+     * event loop, never during this call.
+     *
+     * \sa cancel(), taskFinished()
+     */
+    qint32 schedule(const HTaskStep& step, Priority priority = NormalPriority);
+
+    /*!
+     * \brief Cancels a task.
+     *
+     * \param taskId specifies the ID of the task.
+     *
+     * \return \e true in case the task was waiting or running and it is not
+     * run again. A task can cancel itself in its step.
+     */
+    bool cancel(qint32 taskId);
+
+    /*!
+     * \brief Indicates whether the specified task has not yet finished.
+     *
+     * \param taskId specifies the ID of the task.
+     *
+     * \return \e true in case the task has been scheduled and it has neither
+     * finished nor been cancelled.
+     */
+    bool isPending(qint32 taskId) const;
+
+    /*!
+     * \brief Returns the number of tasks that have not yet finished.
+     *
+     * \return The number of tasks that have not yet finished.
+     */
+    qint32 pendingCount() const;
+
+Q_SIGNALS:
+
+    /*!
+     * \brief This signal is emitted when the step of a task has returned
+     * \e false.
+     *
+     * \param taskId specifies the ID of the task.
+     */
+    void taskFinished(qint32 taskId);
+};
+
+}
+}
+
+#endif /* HTASKSCHEDULER_H_ */
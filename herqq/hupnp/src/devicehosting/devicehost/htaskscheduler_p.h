@@ -0,0 +1,92 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HTASKSCHEDULER_P_H_
+#define HTASKSCHEDULER_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include "htaskscheduler.h"
+
+#include <QtCore/QSet>
+#include <QtCore/QList>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+//
+// Implementation details of HTaskScheduler
+//
+class HTaskSchedulerPrivate
+{
+H_DISABLE_COPY(HTaskSchedulerPrivate)
+
+public:
+
+    enum
+    {
+        PriorityCount = HTaskScheduler::LowPriority + 1
+    };
+
+    struct Task
+    {
+        qint32 m_id;
+        HTaskStep m_step;
+
+        Task(qint32 id, const HTaskStep& step) : m_id(id), m_step(step) {}
+    };
+
+    QList<Task> m_queues[PriorityCount];
+    // the tasks waiting for their next step, indexed by priority. the task
+    // whose step is running is not in the queues
+
+    QSet<qint32> m_pending;
+    // the IDs of the tasks that have not finished or been cancelled
+
+    qint32 m_sliceLength;
+    // in milliseconds
+
+    qint32 m_lastId;
+
+    qint32 m_timerId;
+    // the zero-timer that runs the next slice, or zero if there is
+    // nothing to run
+
+    HTaskSchedulerPrivate();
+
+    // removes the next task to run from the queues. returns false in case
+    // there is none
+    bool takeNext(Task* task, qint32* priority);
+};
+
+}
+}
+
+#endif /* HTASKSCHEDULER_P_H_ */
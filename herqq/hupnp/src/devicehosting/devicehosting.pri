@@ -9,27 +9,45 @@ HEADERS += \
     $$SRC_LOC/devicehosting/messages/hsid_p.h \
     $$SRC_LOC/devicehosting/messages/htimeout_p.h \
     $$SRC_LOC/devicehosting/controlpoint/hcontrolpoint_p.h \
+    $$SRC_LOC/devicehosting/controlpoint/hcontrolpoint_runtimestatus_p.h \
     $$SRC_LOC/devicehosting/controlpoint/hcontrolpoint.h \
     $$SRC_LOC/devicehosting/controlpoint/hdevicebuild_p.h \
+    $$SRC_LOC/devicehosting/controlpoint/hdescription_cache_p.h \
+    $$SRC_LOC/devicehosting/controlpoint/hservicedescription_cache_p.h \
+    $$SRC_LOC/devicehosting/controlpoint/hicon_cache_p.h \
     $$SRC_LOC/devicehosting/controlpoint/hclientmodel_creator_p.h \
     $$SRC_LOC/devicehosting/controlpoint/hcontrolpoint_configuration.h \
     $$SRC_LOC/devicehosting/controlpoint/hcontrolpoint_configuration_p.h \
     $$SRC_LOC/devicehosting/controlpoint/hcontrolpoint_dataretriever_p.h \
     $$SRC_LOC/devicehosting/controlpoint/hevent_subscription_p.h \
     $$SRC_LOC/devicehosting/controlpoint/hevent_subscriptionmanager_p.h \
+    $$SRC_LOC/devicehosting/controlpoint/hevent_subscriptionscheduler_p.h \
+    $$SRC_LOC/devicehosting/controlpoint/hdiscovery_scheduler_p.h \
     $$SRC_LOC/devicehosting/devicehost/hdevicehost_p.h \
     $$SRC_LOC/devicehosting/devicehost/hdevicehost.h \
     $$SRC_LOC/devicehosting/devicehost/hserverdevicecontroller_p.h \
     $$SRC_LOC/devicehosting/devicehost/hservermodel_creator_p.h \
     $$SRC_LOC/devicehosting/devicehost/hdevicehost_dataretriever_p.h \
+    $$SRC_LOC/devicehosting/devicehost/hdescription_loader_p.h \
     $$SRC_LOC/devicehosting/devicehost/hevent_notifier_p.h \
     $$SRC_LOC/devicehosting/devicehost/hdevicehost_configuration.h \
     $$SRC_LOC/devicehosting/devicehost/hdevicehost_configuration_p.h \
     $$SRC_LOC/devicehosting/devicehost/hdevicehost_runtimestatus_p.h \
     $$SRC_LOC/devicehosting/devicehost/hdevicehost_ssdp_handler_p.h \
     $$SRC_LOC/devicehosting/devicehost/hdevicehost_http_server_p.h \
+    $$SRC_LOC/devicehosting/devicehost/haction_executor_p.h \
     $$SRC_LOC/devicehosting/devicehost/hpresence_announcer_p.h \
-    $$SRC_LOC/devicehosting/devicehost/hevent_subscriber_p.h
+    $$SRC_LOC/devicehosting/devicehost/hdiscoveryrequest_limiter_p.h \
+    $$SRC_LOC/devicehosting/devicehost/hevent_subscriber_p.h \
+    $$SRC_LOC/devicehosting/devicehost/hevent_delivery_p.h \
+    $$SRC_LOC/devicehosting/devicehost/htaskscheduler.h \
+    $$SRC_LOC/devicehosting/devicehost/htaskscheduler_p.h
+
+EXPORTED_PRIVATE_HEADERS += \
+    $$SRC_LOC/devicehosting/messages/hevent_messages_p.h \
+    $$SRC_LOC/devicehosting/messages/hnt_p.h \
+    $$SRC_LOC/devicehosting/messages/hsid_p.h \
+    $$SRC_LOC/devicehosting/messages/htimeout_p.h
 
 SOURCES += \
     $$SRC_LOC/devicehosting/hdevicestorage_p.cpp \
@@ -43,15 +61,26 @@ SOURCES += \
     $$SRC_LOC/devicehosting/controlpoint/hcontrolpoint.cpp \
     $$SRC_LOC/devicehosting/controlpoint/hclientmodel_creator_p.cpp \
     $$SRC_LOC/devicehosting/controlpoint/hdevicebuild_p.cpp \
+    $$SRC_LOC/devicehosting/controlpoint/hdescription_cache_p.cpp \
+    $$SRC_LOC/devicehosting/controlpoint/hservicedescription_cache_p.cpp \
+    $$SRC_LOC/devicehosting/controlpoint/hicon_cache_p.cpp \
     $$SRC_LOC/devicehosting/controlpoint/hcontrolpoint_configuration.cpp \
     $$SRC_LOC/devicehosting/controlpoint/hcontrolpoint_dataretriever_p.cpp \
     $$SRC_LOC/devicehosting/controlpoint/hevent_subscription_p.cpp \
     $$SRC_LOC/devicehosting/controlpoint/hevent_subscriptionmanager_p.cpp \
+    $$SRC_LOC/devicehosting/controlpoint/hevent_subscriptionscheduler_p.cpp \
+    $$SRC_LOC/devicehosting/controlpoint/hdiscovery_scheduler_p.cpp \
     $$SRC_LOC/devicehosting/devicehost/hdevicehost.cpp \
     $$SRC_LOC/devicehosting/devicehost/hservermodel_creator_p.cpp \
     $$SRC_LOC/devicehosting/devicehost/hdevicehost_dataretriever_p.cpp \
+    $$SRC_LOC/devicehosting/devicehost/hdescription_loader_p.cpp \
     $$SRC_LOC/devicehosting/devicehost/hevent_notifier_p.cpp \
     $$SRC_LOC/devicehosting/devicehost/hdevicehost_configuration.cpp \
     $$SRC_LOC/devicehosting/devicehost/hdevicehost_ssdp_handler_p.cpp \
     $$SRC_LOC/devicehosting/devicehost/hdevicehost_http_server_p.cpp \
-    $$SRC_LOC/devicehosting/devicehost/hevent_subscriber_p.cpp
+    $$SRC_LOC/devicehosting/devicehost/haction_executor_p.cpp \
+    $$SRC_LOC/devicehosting/devicehost/hdiscoveryrequest_limiter_p.cpp \
+    $$SRC_LOC/devicehosting/devicehost/hpresence_announcer_p.cpp \
+    $$SRC_LOC/devicehosting/devicehost/hevent_subscriber_p.cpp \
+    $$SRC_LOC/devicehosting/devicehost/hevent_delivery_p.cpp \
+    $$SRC_LOC/devicehosting/devicehost/htaskscheduler.cpp
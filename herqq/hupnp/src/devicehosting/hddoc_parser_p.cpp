@@ -30,6 +30,9 @@
 
 #include "../general/hlogger_p.h"
 
+#include <QtCore/QStringList>
+#include <QtCore/QXmlStreamReader>
+
 namespace Herqq
 {
 
@@ -47,52 +50,30 @@ HDocParser::HDocParser(
 }
 
 HStateVariableInfo HDocParser::parseStateVariableInfo_str(
-    const QString& name, const QVariant& defValue, const QDomElement& svElement,
+    const QString& name, const QVariant& defValue,
+    const QStringList& allowedValues,
     HStateVariableInfo::EventingType evType, HInclusionRequirement incReq)
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
-    QStringList allowedValues;
-
-    QDomElement allowedValueListElement =
-        svElement.firstChildElement("allowedValueList");
-
-    if (!allowedValueListElement.isNull())
-    {
-        QDomElement allowedValueElement =
-            allowedValueListElement.firstChildElement("allowedValue");
-
-        while(!allowedValueElement.isNull())
-        {
-            allowedValues.push_back(allowedValueElement.text());
-
-            allowedValueElement =
-                allowedValueElement.nextSiblingElement("allowedValue");
-        }
-    }
-
     return HStateVariableInfo(
         name, defValue, allowedValues, evType, incReq, &m_lastErrorDescription);
 }
 
 HStateVariableInfo HDocParser::parseStateVariableInfo_numeric(
-    const QString& name, const QVariant& defValue, const QDomElement& svElement,
+    const QString& name, const QVariant& defValue, bool rangeDefined,
+    QString minimumStr, QString maximumStr, QString stepStr,
     HStateVariableInfo::EventingType evType, HInclusionRequirement incReq,
     HUpnpDataTypes::DataType dataTypeEnumValue)
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
-    QDomElement allowedValueRangeElement =
-        svElement.firstChildElement("allowedValueRange");
-
-    if (allowedValueRangeElement.isNull())
+    if (!rangeDefined)
     {
         return HStateVariableInfo(
             name, dataTypeEnumValue, defValue, evType, incReq, &m_lastErrorDescription);
     }
 
-    QString minimumStr = readElementValue("minimum", allowedValueRangeElement);
-
     if (minimumStr.isEmpty())
     {
         QString descr = QString(
@@ -112,8 +93,6 @@ HStateVariableInfo HDocParser::parseStateVariableInfo_numeric(
         }
     }
 
-    QString maximumStr = readElementValue("maximum", allowedValueRangeElement);
-
     if (maximumStr.isEmpty())
     {
         QString descr = QString(
@@ -133,8 +112,6 @@ HStateVariableInfo HDocParser::parseStateVariableInfo_numeric(
         }
     }
 
-    QString stepStr = readElementValue("step", allowedValueRangeElement);
-
     if (stepStr.isEmpty())
     {
         if (HUpnpDataTypes::isRational(dataTypeEnumValue))
@@ -162,7 +139,7 @@ HStateVariableInfo HDocParser::parseStateVariableInfo_numeric(
 }
 
 bool HDocParser::parseActionArguments(
-    const QDomElement& argListElement,
+    const QList<ArgumentDescription>& arguments,
     const QHash<QString, HStateVariableInfo>& stateVars,
     QVector<HActionArgument>* inArgs,
     QVector<HActionArgument>* outArgs,
@@ -172,17 +149,11 @@ bool HDocParser::parseActionArguments(
 
     bool firstOutArgFound  = false;
 
-    QDomElement argumentElement = argListElement.firstChildElement("argument");
-    while(!argumentElement.isNull())
+    foreach(const ArgumentDescription& argument, arguments)
     {
-        QString name = readElementValue("name", argumentElement);
-        QString dirStr = readElementValue("direction", argumentElement);
-
-        bool retValWasDefined = false;
-        readElementValue("retval", argumentElement, &retValWasDefined);
-
-        QString relatedSvStr =
-            readElementValue("relatedStateVariable", argumentElement);
+        const QString& name = argument.m_name;
+        const QString& dirStr = argument.m_direction;
+        const QString& relatedSvStr = argument.m_relatedStateVariable;
 
         if (!stateVars.contains(relatedSvStr))
         {
@@ -197,7 +168,7 @@ bool HDocParser::parseActionArguments(
         HActionArgument createdArg;
         if (dirStr.compare("out", Qt::CaseInsensitive) == 0)
         {
-            if (retValWasDefined)
+            if (argument.m_retval)
             {
                 if (firstOutArgFound)
                 {
@@ -262,8 +233,274 @@ bool HDocParser::parseActionArguments(
 
             return false;
         }
+    }
+
+    return true;
+}
+
+bool HDocParser::setServiceDescriptionParseError(const QXmlStreamReader& reader)
+{
+    m_lastError = InvalidServiceDescriptionError;
+    m_lastErrorDescription = QString(
+        "Failed to parse the service description: [%1] @ line [%2].").arg(
+            reader.errorString(), QString::number(reader.lineNumber()));
 
-        argumentElement = argumentElement.nextSiblingElement("argument");
+    return false;
+}
+
+bool HDocParser::parseStateVariable(
+    QXmlStreamReader& reader, HStateVariableInfo* svInfo)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    Q_ASSERT(svInfo);
+    Q_ASSERT(reader.isStartElement() && reader.name() == "stateVariable");
+
+    qint64 line = reader.lineNumber();
+    QXmlStreamAttributes attributes = reader.attributes();
+
+    QString strSendEvents = attributes.hasAttribute("sendEvents") ?
+        attributes.value("sendEvents").toString() : QString("no");
+
+    bool bSendEvents      = false;
+    if (strSendEvents.compare("yes", Qt::CaseInsensitive) == 0)
+    {
+        bSendEvents = true;
+    }
+    else if (strSendEvents.compare("no", Qt::CaseInsensitive) != 0)
+    {
+        m_lastError = InvalidServiceDescriptionError;
+        m_lastErrorDescription = QString(
+            "Invalid <stateVariable> definition @ line [%1]: "
+            "invalid value for [sendEvents] attribute: [%2].").arg(
+                QString::number(line), strSendEvents);
+
+        return false;
+    }
+
+    QString strMulticast = attributes.hasAttribute("multicast") ?
+        attributes.value("multicast").toString() : QString("no");
+
+    bool bMulticast       = false;
+    if (strMulticast.compare("yes", Qt::CaseInsensitive) == 0)
+    {
+        bMulticast = true;
+    }
+    else if (strMulticast.compare("no", Qt::CaseInsensitive) != 0)
+    {
+        m_lastError = InvalidServiceDescriptionError;
+        m_lastErrorDescription = QString(
+            "Invalid <stateVariable> definition @ line [%1]: "
+            "invalid value for [multicast]: [%2].").arg(
+                QString::number(line), strMulticast);
+
+        return false;
+    }
+
+    HStateVariableInfo::EventingType evType = HStateVariableInfo::NoEvents;
+    if (bSendEvents)
+    {
+        evType = bMulticast ?
+            HStateVariableInfo::UnicastAndMulticast : HStateVariableInfo::UnicastOnly;
+    }
+
+    QString name, dataType, defaultValueStr;
+    bool defValueWasDefined = false;
+
+    QStringList allowedValues;
+    bool rangeDefined = false;
+    QString minimumStr, maximumStr, stepStr;
+
+    while(reader.readNextStartElement())
+    {
+        QStringRef tag = reader.name();
+        if (tag == "name")
+        {
+            name = reader.readElementText(QXmlStreamReader::SkipChildElements);
+        }
+        else if (tag == "dataType")
+        {
+            dataType =
+                reader.readElementText(QXmlStreamReader::SkipChildElements);
+        }
+        else if (tag == "defaultValue")
+        {
+            defValueWasDefined = true;
+            defaultValueStr =
+                reader.readElementText(QXmlStreamReader::SkipChildElements);
+        }
+        else if (tag == "allowedValueList")
+        {
+            while(reader.readNextStartElement())
+            {
+                if (reader.name() == "allowedValue")
+                {
+                    allowedValues.push_back(reader.readElementText(
+                        QXmlStreamReader::SkipChildElements));
+                }
+                else
+                {
+                    reader.skipCurrentElement();
+                }
+            }
+        }
+        else if (tag == "allowedValueRange")
+        {
+            rangeDefined = true;
+            while(reader.readNextStartElement())
+            {
+                QStringRef rangeTag = reader.name();
+                QString* target =
+                    rangeTag == "minimum" ? &minimumStr :
+                    rangeTag == "maximum" ? &maximumStr :
+                    rangeTag == "step"    ? &stepStr    : 0;
+
+                if (target)
+                {
+                    *target = reader.readElementText(
+                        QXmlStreamReader::SkipChildElements);
+                }
+                else
+                {
+                    reader.skipCurrentElement();
+                }
+            }
+        }
+        else
+        {
+            reader.skipCurrentElement();
+        }
+    }
+
+    if (reader.hasError())
+    {
+        return setServiceDescriptionParseError(reader);
+    }
+
+    HUpnpDataTypes::DataType dtEnumValue = HUpnpDataTypes::dataType(dataType);
+
+    QVariant defaultValue =
+        defValueWasDefined ?
+            HUpnpDataTypes::convertToRightVariantType(
+                defaultValueStr, dtEnumValue) : QVariant();
+
+    HStateVariableInfo parsedInfo;
+
+    if (dtEnumValue == HUpnpDataTypes::string)
+    {
+        parsedInfo = parseStateVariableInfo_str(
+            name,
+            defValueWasDefined ? defaultValueStr : QVariant(),
+            allowedValues,
+            evType,
+            InclusionMandatory);
+    }
+    else if (HUpnpDataTypes::isNumeric(dtEnumValue))
+    {
+        parsedInfo = parseStateVariableInfo_numeric(
+            name,
+            defaultValue,
+            rangeDefined,
+            minimumStr,
+            maximumStr,
+            stepStr,
+            evType,
+            InclusionMandatory,
+            dtEnumValue);
+    }
+    else
+    {
+        parsedInfo = HStateVariableInfo(
+            name,
+            dtEnumValue,
+            defaultValue,
+            evType,
+            InclusionMandatory,
+            &m_lastErrorDescription);
+    }
+
+    if (!parsedInfo.isValid())
+    {
+        m_lastError = InvalidServiceDescriptionError;
+        m_lastErrorDescription =
+            QString("Invalid <stateVariable> [%1] definition: %2").arg(
+                name, m_lastErrorDescription);
+
+        return false;
+    }
+
+    *svInfo = parsedInfo;
+    return true;
+}
+
+bool HDocParser::parseAction(
+    QXmlStreamReader& reader, ActionDescription* action)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    Q_ASSERT(action);
+    Q_ASSERT(reader.isStartElement() && reader.name() == "action");
+
+    while(reader.readNextStartElement())
+    {
+        QStringRef tag = reader.name();
+        if (tag == "name")
+        {
+            action->m_name =
+                reader.readElementText(QXmlStreamReader::SkipChildElements);
+        }
+        else if (tag == "argumentList")
+        {
+            while(reader.readNextStartElement())
+            {
+                if (reader.name() != "argument")
+                {
+                    reader.skipCurrentElement();
+                    continue;
+                }
+
+                ArgumentDescription argument;
+                argument.m_retval = false;
+
+                while(reader.readNextStartElement())
+                {
+                    QStringRef argTag = reader.name();
+                    if (argTag == "retval")
+                    {
+                        argument.m_retval = true;
+                        reader.skipCurrentElement();
+                        continue;
+                    }
+
+                    QString* target =
+                        argTag == "name" ? &argument.m_name :
+                        argTag == "direction" ? &argument.m_direction :
+                        argTag == "relatedStateVariable" ?
+                            &argument.m_relatedStateVariable : 0;
+
+                    if (target)
+                    {
+                        *target = reader.readElementText(
+                            QXmlStreamReader::SkipChildElements);
+                    }
+                    else
+                    {
+                        reader.skipCurrentElement();
+                    }
+                }
+
+                action->m_arguments.push_back(argument);
+            }
+        }
+        else
+        {
+            reader.skipCurrentElement();
+        }
+    }
+
+    if (reader.hasError())
+    {
+        return setServiceDescriptionParseError(reader);
     }
 
     return true;
@@ -298,7 +535,32 @@ bool HDocParser::parseRoot(
     Q_ASSERT(rootEl);
 
     QString errMsg; qint32 errLine = 0;
-    if (!doc->setContent(docStr, false, &errMsg, &errLine))
+    bool ok = doc->setContent(docStr, false, &errMsg, &errLine);
+
+    return parseRootElement(ok, errMsg, errLine, doc, rootEl);
+}
+
+bool HDocParser::parseRoot(
+    const QByteArray& docData, QDomDocument* doc, QDomElement* rootEl)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    Q_ASSERT(doc);
+    Q_ASSERT(rootEl);
+
+    // the document is decoded by the parser according to its XML
+    // declaration, which makes a separate decoding pass unnecessary
+    QString errMsg; qint32 errLine = 0;
+    bool ok = doc->setContent(docData, false, &errMsg, &errLine);
+
+    return parseRootElement(ok, errMsg, errLine, doc, rootEl);
+}
+
+bool HDocParser::parseRootElement(
+    bool contentSet, const QString& errMsg, qint32 errLine,
+    QDomDocument* doc, QDomElement* rootEl)
+{
+    if (!contentSet)
     {
         m_lastError = InvalidDeviceDescriptionError;
         m_lastErrorDescription = QString(
@@ -566,30 +828,41 @@ bool HDocParser::parseServiceInfo(
 }
 
 bool HDocParser::parseServiceDescription(
-    const QString& docStr, QDomDocument* doc,
-    QDomElement* stateVarElement, QDomElement* retVal)
+    const QString& docStr, QList<HStateVariableInfo>* stateVariables,
+    QList<HActionInfo>* actions)
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
-    Q_ASSERT(stateVarElement);
-    Q_ASSERT(retVal);
+    QXmlStreamReader reader(docStr);
+    return parseServiceDescription(reader, stateVariables, actions);
+}
 
-    qint32 errLine;
-    QString errMsg;
-    if (!doc->setContent(docStr, false, &errMsg, &errLine))
-    {
-        m_lastError = InvalidServiceDescriptionError;
-        m_lastErrorDescription = QString(
-            "Failed to parse the service description: [%1] @ line [%2].").arg(
-                errMsg, QString::number(errLine));
+bool HDocParser::parseServiceDescription(
+    const QByteArray& docData, QList<HStateVariableInfo>* stateVariables,
+    QList<HActionInfo>* actions)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
-        return false;
+    QXmlStreamReader reader(docData);
+    return parseServiceDescription(reader, stateVariables, actions);
+}
+
+bool HDocParser::parseServiceDescription(
+    QXmlStreamReader& reader, QList<HStateVariableInfo>* stateVariables,
+    QList<HActionInfo>* actions)
+{
+    Q_ASSERT(stateVariables);
+    Q_ASSERT(actions);
+
+    // the service description is read as a stream, since no node of it is
+    // needed after the state variables and actions have been created and
+    // building a DOM tree for every description fetched is wasteful.
+    if (!reader.readNextStartElement())
+    {
+        return setServiceDescriptionParseError(reader);
     }
-    //QDomNodeList scpdElementNodeList =
-        //tmp.elementsByTagNameNS("urn:schemas-upnp-org:service-1-0","scpd");
 
-    QDomElement scpdElement = doc->firstChildElement("scpd");
-    if (scpdElement.isNull())
+    if (reader.name() != "scpd")
     {
         m_lastError = InvalidServiceDescriptionError;
         m_lastErrorDescription =
@@ -598,7 +871,102 @@ bool HDocParser::parseServiceDescription(
         return false;
     }
 
-    if (!verifySpecVersion(scpdElement, &m_lastErrorDescription))
+    bool specVersionFound = false;
+    QString majorVersion, minorVersion;
+
+    bool stateTableFound = false;
+    QList<HStateVariableInfo> svInfos;
+
+    bool actionListFound = false;
+    QList<ActionDescription> actionDescriptions;
+
+    while(reader.readNextStartElement())
+    {
+        QStringRef tag = reader.name();
+        if (tag == "specVersion" && !specVersionFound)
+        {
+            specVersionFound = true;
+            while(reader.readNextStartElement())
+            {
+                if (reader.name() == "major")
+                {
+                    majorVersion = reader.readElementText(
+                        QXmlStreamReader::SkipChildElements);
+                }
+                else if (reader.name() == "minor")
+                {
+                    minorVersion = reader.readElementText(
+                        QXmlStreamReader::SkipChildElements);
+                }
+                else
+                {
+                    reader.skipCurrentElement();
+                }
+            }
+        }
+        else if (tag == "serviceStateTable" && !stateTableFound)
+        {
+            stateTableFound = true;
+            while(reader.readNextStartElement())
+            {
+                if (reader.name() != "stateVariable")
+                {
+                    reader.skipCurrentElement();
+                    continue;
+                }
+
+                HStateVariableInfo svInfo;
+                if (!parseStateVariable(reader, &svInfo))
+                {
+                    return false;
+                }
+
+                svInfos.push_back(svInfo);
+            }
+        }
+        else if (tag == "actionList" && !actionListFound)
+        {
+            actionListFound = true;
+            while(reader.readNextStartElement())
+            {
+                if (reader.name() != "action")
+                {
+                    reader.skipCurrentElement();
+                    continue;
+                }
+
+                ActionDescription actionDescription;
+                if (!parseAction(reader, &actionDescription))
+                {
+                    return false;
+                }
+
+                actionDescriptions.push_back(actionDescription);
+            }
+        }
+        else
+        {
+            reader.skipCurrentElement();
+        }
+    }
+
+    if (reader.hasError())
+    {
+        return setServiceDescriptionParseError(reader);
+    }
+
+    bool specVersionOk = false;
+    if (specVersionFound)
+    {
+        specVersionOk = verifySpecVersion(
+            majorVersion, minorVersion, &m_lastErrorDescription);
+    }
+    else
+    {
+        m_lastErrorDescription = "Missing mandatory <specVersion> element.";
+    }
+
+    if (!specVersionOk)
     {
         if (m_cLevel == StrictChecks)
         {
@@ -612,10 +980,7 @@ bool HDocParser::parseServiceDescription(
         }
     }
 
-    QDomElement serviceStateTableElement =
-        scpdElement.firstChildElement("serviceStateTable");
-
-    if (serviceStateTableElement.isNull())
+    if (!stateTableFound)
     {
         m_lastError = InvalidServiceDescriptionError;
         m_lastErrorDescription =
@@ -624,10 +989,7 @@ bool HDocParser::parseServiceDescription(
         return false;
     }
 
-    QDomElement stateVariableElement =
-        serviceStateTableElement.firstChildElement("stateVariable");
-
-    if (stateVariableElement.isNull())
+    if (svInfos.isEmpty())
     {
         QString err = "Service description document does not have a "
                       "single <stateVariable> element. "
@@ -645,14 +1007,7 @@ bool HDocParser::parseServiceDescription(
         }
     }
 
-    QDomElement actionListElement = scpdElement.firstChildElement("actionList");
-    if (actionListElement.isNull())
-    {
-        return true;
-    }
-
-    QDomElement actionElement = actionListElement.firstChildElement("action");
-    if (actionElement.isNull())
+    if (actionListFound && actionDescriptions.isEmpty())
     {
         QString err = "Service description document has <actionList> "
                       "element that has no <action> elements.";
@@ -669,150 +1024,57 @@ bool HDocParser::parseServiceDescription(
         }
     }
 
-    *stateVarElement = stateVariableElement;
-    *retVal = actionElement;
-    return true;
-}
-
-bool HDocParser::parseStateVariable(
-    const QDomElement& stateVariableElement, HStateVariableInfo* svInfo)
-{
-    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
-
-    Q_ASSERT(svInfo);
-
-    QString strSendEvents = stateVariableElement.attribute("sendEvents", "no");
-    bool bSendEvents      = false;
-    if (strSendEvents.compare("yes", Qt::CaseInsensitive) == 0)
-    {
-        bSendEvents = true;
-    }
-    else if (strSendEvents.compare("no", Qt::CaseInsensitive) != 0)
-    {
-        m_lastError = InvalidServiceDescriptionError;
-        m_lastErrorDescription = QString(
-            "Invalid <stateVariable> definition: "
-            "invalid value for [sendEvents] attribute:\n%1.").arg(
-                toString(stateVariableElement));
-
-        return false;
-    }
-
-    QString strMulticast  = stateVariableElement.attribute("multicast", "no");
-    bool bMulticast       = false;
-    if (strMulticast.compare("yes", Qt::CaseInsensitive) == 0)
-    {
-        bMulticast = true;
-    }
-    else if (strMulticast.compare("no", Qt::CaseInsensitive) != 0)
-    {
-        m_lastError = InvalidServiceDescriptionError;
-        m_lastErrorDescription = QString(
-            "Invalid <stateVariable> definition: "
-            "invalid value for [multicast]: %1.").arg(
-                toString(stateVariableElement));
-
-        return false;
-    }
-
-    HStateVariableInfo::EventingType evType = HStateVariableInfo::NoEvents;
-    if (bSendEvents)
-    {
-        evType = bMulticast ?
-            HStateVariableInfo::UnicastAndMulticast : HStateVariableInfo::UnicastOnly;
-    }
-
-    QString name = readElementValue("name", stateVariableElement);
-    QString dataType = readElementValue("dataType", stateVariableElement);
-
-    HUpnpDataTypes::DataType dtEnumValue = HUpnpDataTypes::dataType(dataType);
-
-    bool defValueWasDefined = false;
-    QString defaultValueStr = readElementValue(
-        "defaultValue", stateVariableElement, &defValueWasDefined);
-
-    QVariant defaultValue =
-        defValueWasDefined ?
-            HUpnpDataTypes::convertToRightVariantType(
-                defaultValueStr, dtEnumValue) : QVariant();
-
-    HStateVariableInfo parsedInfo;
-
-    if (dtEnumValue == HUpnpDataTypes::string)
+    // the <actionList> precedes the <serviceStateTable> in a description,
+    // which is why the actions can be created only after the whole
+    // document has been read.
+    QHash<QString, HStateVariableInfo> stateVars;
+    foreach(const HStateVariableInfo& svInfo, svInfos)
     {
-        parsedInfo = parseStateVariableInfo_str(
-            name,
-            defValueWasDefined ? defaultValueStr : QVariant(),
-            stateVariableElement,
-            evType,
-            InclusionMandatory);
-    }
-    else if (HUpnpDataTypes::isNumeric(dtEnumValue))
-    {
-        parsedInfo = parseStateVariableInfo_numeric(
-            name,
-            defaultValue,
-            stateVariableElement,
-            evType,
-            InclusionMandatory,
-            dtEnumValue);
-    }
-    else
-    {
-        parsedInfo = HStateVariableInfo(
-            name,
-            dtEnumValue,
-            defaultValue,
-            evType,
-            InclusionMandatory,
-            &m_lastErrorDescription);
+        stateVars.insert(svInfo.name(), svInfo);
     }
 
-    if (!parsedInfo.isValid())
+    QList<HActionInfo> actionInfos;
+    foreach(const ActionDescription& actionDescription, actionDescriptions)
     {
-        m_lastError = InvalidServiceDescriptionError;
-        m_lastErrorDescription =
-            QString("Invalid <stateVariable> [%1] definition: %2").arg(
-                name, m_lastErrorDescription);
+        HActionInfo actionInfo;
+        if (!parseActionInfo(actionDescription, stateVars, &actionInfo))
+        {
+            return false;
+        }
 
-        return false;
+        actionInfos.push_back(actionInfo);
     }
 
-    *svInfo = parsedInfo;
+    *stateVariables = svInfos;
+    *actions = actionInfos;
     return true;
 }
 
 bool HDocParser::parseActionInfo(
-    const QDomElement& actionElement,
+    const ActionDescription& actionDescription,
     const QHash<QString, HStateVariableInfo>& stateVars,
     HActionInfo* ai)
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
-    QString name = readElementValue("name", actionElement);
+    const QString& name = actionDescription.m_name;
 
     bool hasRetVal = false;
     QVector<HActionArgument> inputArguments;
     QVector<HActionArgument> outputArguments;
 
-    QDomElement argumentListElement =
-        actionElement.firstChildElement("argumentList");
-
-    if (!argumentListElement.isNull())
+    if (!parseActionArguments(
+            actionDescription.m_arguments,
+            stateVars,
+            &inputArguments,
+            &outputArguments,
+            &hasRetVal))
     {
-        if (!parseActionArguments(
-                argumentListElement,
-                stateVars,
-                &inputArguments,
-                &outputArguments,
-                &hasRetVal))
-        {
-            m_lastErrorDescription = QString(
-                "Invalid action [%1] definition: %2").arg(
-                    name, m_lastErrorDescription);
+        m_lastErrorDescription = QString(
+            "Invalid action [%1] definition: %2").arg(
+                name, m_lastErrorDescription);
 
-            return false;
-        }
+        return false;
     }
 
     HActionArguments inArgs(inputArguments);
@@ -846,9 +1108,15 @@ bool HDocParser::verifySpecVersion(const QDomElement& rootElement, QString* err)
         return false;
     }
 
-    QString minorVersion = readElementValue("minor", specVersionElement);
-    QString majorVersion = readElementValue("major", specVersionElement);
+    return verifySpecVersion(
+        readElementValue("major", specVersionElement),
+        readElementValue("minor", specVersionElement),
+        err);
+}
 
+bool HDocParser::verifySpecVersion(
+    const QString& majorVersion, const QString& minorVersion, QString* err)
+{
     bool ok;
     qint32 major = majorVersion.toInt(&ok);
     if (!ok || major != 1)
@@ -48,6 +48,8 @@
 
 class QDomElement;
 class QDomDocument;
+class QStringList;
+class QXmlStreamReader;
 
 namespace Herqq
 {
@@ -77,8 +79,44 @@ private:
     QList<QUrl> parseIconList(
         const QDomElement& iconListElement);
 
+    // the raw contents of an <argument> element, which can be resolved only
+    // after the <serviceStateTable> has been read
+    struct ArgumentDescription
+    {
+        QString m_name;
+        QString m_direction;
+        QString m_relatedStateVariable;
+        bool m_retval;
+    };
+
+    // the raw contents of an <action> element
+    struct ActionDescription
+    {
+        QString m_name;
+        QList<ArgumentDescription> m_arguments;
+    };
+
+    bool setServiceDescriptionParseError(const QXmlStreamReader&);
+
+    bool parseRootElement(
+        bool contentSet, const QString& errMsg, qint32 errLine,
+        QDomDocument*, QDomElement*);
+
+    bool parseServiceDescription(
+        QXmlStreamReader&,
+        QList<HStateVariableInfo>* stateVariables,
+        QList<HActionInfo>* actions);
+
+    bool parseStateVariable(QXmlStreamReader&, HStateVariableInfo*);
+    bool parseAction(QXmlStreamReader&, ActionDescription*);
+
+    bool parseActionInfo(
+        const ActionDescription&,
+        const QHash<QString, HStateVariableInfo>&,
+        HActionInfo*);
+
     bool parseActionArguments(
-        const QDomElement& argListElement,
+        const QList<ArgumentDescription>&,
         const QHash<QString, HStateVariableInfo>&,
         QVector<HActionArgument>* inArgs,
         QVector<HActionArgument>* outArgs,
@@ -87,14 +125,17 @@ private:
     HStateVariableInfo parseStateVariableInfo_str(
         const QString& name,
         const QVariant& defValue,
-        const QDomElement& svElement,
+        const QStringList& allowedValues,
         HStateVariableInfo::EventingType,
         HInclusionRequirement);
 
     HStateVariableInfo parseStateVariableInfo_numeric(
         const QString& name,
         const QVariant& defValue,
-        const QDomElement& svElement,
+        bool rangeDefined,
+        QString minimumStr,
+        QString maximumStr,
+        QString stepStr,
         HStateVariableInfo::EventingType,
         HInclusionRequirement,
         HUpnpDataTypes::DataType dataTypeEnumValue);
@@ -114,28 +155,29 @@ public:
     inline DocumentErrorTypes lastError() const { return m_lastError; }
 
     bool parseRoot(const QString& doc, QDomDocument*, QDomElement*);
+
+    // the document is expected to be in the encoding it was received in
+    bool parseRoot(const QByteArray& doc, QDomDocument*, QDomElement*);
+
     qint32 readConfigId(const QDomElement&);
     bool parseDeviceInfo(const QDomElement&, HDeviceInfo*);
     bool parseServiceInfo(const QDomElement& serviceDefinition, HServiceInfo*);
 
     bool parseServiceDescription(
         const QString& docStr,
-        QDomDocument* doc,
-        QDomElement* stateVarElement,
-        QDomElement* actionElement);
+        QList<HStateVariableInfo>* stateVariables,
+        QList<HActionInfo>* actions);
 
-    bool parseStateVariable(
-        const QDomElement& stateVariableElement,
-        HStateVariableInfo*);
-
-    bool parseActionInfo(
-        const QDomElement& actionElement,
-        const QHash<QString, HStateVariableInfo>&,
-        HActionInfo*);
+    bool parseServiceDescription(
+        const QByteArray& docData,
+        QList<HStateVariableInfo>* stateVariables,
+        QList<HActionInfo>* actions);
 
     bool verifySpecVersion(const QDomElement&, QString* err = 0);
 
-private:
+    bool verifySpecVersion(
+        const QString& major, const QString& minor, QString* err = 0);
+
     static QUrl parsedStringToUrl(const QString &string);
 };
 
@@ -36,10 +36,14 @@
 #include <HUpnpCore/HUdn>
 #include <HUpnpCore/HEndpoint>
 #include <HUpnpCore/HDeviceInfo>
+#include <HUpnpCore/HServiceInfo>
 #include <HUpnpCore/HResourceType>
 
 #include <QtCore/QUrl>
+#include <QtCore/QSet>
+#include <QtCore/QHash>
 #include <QtCore/QList>
+#include <QtCore/QVector>
 #include <QtCore/QString>
 #include <QtCore/QByteArray>
 
@@ -69,15 +73,18 @@ public:
     }
 };
 
-static bool compareUrls(const QUrl& u1, const QUrl& u2)
+// returns the request part of the URL without the leading slash. two URLs
+// are considered to identify the same resource when their keys are equal
+static QString urlKey(const QUrl& url)
 {
-    QString u1Str = extractRequestPart(u1);
-    QString u2Str = extractRequestPart(u2);
-
-    if (u1Str.startsWith('/')) { u1Str.remove(0, 1); }
-    if (u2Str.startsWith('/')) { u2Str.remove(0, 1); }
+    QString retVal = extractRequestPart(url);
+    if (retVal.startsWith('/')) { retVal.remove(0, 1); }
+    return retVal;
+}
 
-    return u1Str == u2Str;
+static bool compareUrls(const QUrl& u1, const QUrl& u2)
+{
+    return urlKey(u1) == urlKey(u2);
 }
 
 //
@@ -221,6 +228,27 @@ public:
     }
 };
 
+// returns a key that is equal for resource types that are equal when their
+// versions are ignored
+inline quint32 typeKey(const HResourceType& resourceType)
+{
+    return qHash(resourceType.toString(
+        HResourceType::UrnPrefix | HResourceType::Domain |
+        HResourceType::Type | HResourceType::TypeSuffix));
+}
+
+//
+// An entry of the flattened device trees of HDeviceStorage
+//
+template<typename T>
+struct HTypeIndexEntry
+{
+    T* m_item;
+    quint32 m_typeKey;
+    bool m_rootLevel;
+    // true if the item is a root device or a service of one
+};
+
 template<typename Device, typename T>
 void seekDevices(
     Device* device, const MatchFunctor<Device, T>& mf,
@@ -339,12 +367,243 @@ private:
 
     QList<QPair<Device*, Controller*> > m_deviceControllers;
 
+    quint32 m_revision;
+    // incremented whenever root devices are added or removed
+
+    QHash<HUdn, Device*> m_devicesByUdn;
+    QHash<HUdn, Device*> m_rootDevicesByUdn;
+
+    QHash<QString, Service*> m_servicesByScpdUrl;
+    QHash<QString, Service*> m_servicesByControlUrl;
+    QHash<QString, Service*> m_servicesByEventUrl;
+    // the indexes used to route the requests, keyed by urlKey(). in case
+    // several devices or services share a key, the index refers to the one
+    // that is found first when the device trees are searched in order
+
+    QVector<HTypeIndexEntry<Device> > m_allDevices;
+    QVector<HTypeIndexEntry<Service> > m_allServices;
+    // the devices and services of all the device trees in the order they are
+    // found when the trees are searched depth-first. the type queries are
+    // scans over these
+
     QString m_lastError;
 
+    void addToIndexes(Device* device)
+    {
+        HTypeIndexEntry<Device> deviceEntry = {
+            device, typeKey(device->info().deviceType()),
+            !device->parentDevice() };
+
+        m_allDevices.append(deviceEntry);
+
+        if (!m_devicesByUdn.contains(device->info().udn()))
+        {
+            m_devicesByUdn.insert(device->info().udn(), device);
+        }
+
+        if (!device->parentDevice() &&
+            !m_rootDevicesByUdn.contains(device->info().udn()))
+        {
+            m_rootDevicesByUdn.insert(device->info().udn(), device);
+        }
+
+        QList<Service*> services = device->services();
+        foreach(Service* service, services)
+        {
+            const HServiceInfo& info = service->info();
+
+            HTypeIndexEntry<Service> serviceEntry = {
+                service, typeKey(info.serviceType()), !device->parentDevice() };
+
+            m_allServices.append(serviceEntry);
+
+            addToIndex(m_servicesByScpdUrl, info.scpdUrl(), service);
+            addToIndex(m_servicesByControlUrl, info.controlUrl(), service);
+            addToIndex(m_servicesByEventUrl, info.eventSubUrl(), service);
+        }
+
+        QList<Device*> devices = device->embeddedDevices();
+        foreach(Device* embeddedDevice, devices)
+        {
+            addToIndexes(embeddedDevice);
+        }
+    }
+
+    static void addToIndex(
+        QHash<QString, Service*>& index, const QUrl& url, Service* service)
+    {
+        QString key = urlKey(url);
+        if (!index.contains(key))
+        {
+            index.insert(key, service);
+        }
+    }
+
+    static void removeFromIndex(
+        QHash<QString, Service*>& index, const QUrl& url, Service* service,
+        QSet<QString>* freedKeys)
+    {
+        QString key = urlKey(url);
+        if (index.value(key) == service)
+        {
+            index.remove(key);
+            freedKeys->insert(key);
+        }
+    }
+
+    static void refillIndex(
+        QHash<QString, Service*>& index, const QSet<QString>& freedKeys,
+        const QUrl& url, Service* service)
+    {
+        if (!freedKeys.isEmpty())
+        {
+            QString key = urlKey(url);
+            if (freedKeys.contains(key) && !index.contains(key))
+            {
+                index.insert(key, service);
+            }
+        }
+    }
+
+    // removes the devices and services of the device tree from the indexes.
+    // a key the tree shared with another device tree is given to the
+    // device or service of the other trees that is found first, as if the
+    // indexes were rebuilt
+    void removeFromIndexes(Device* root)
+    {
+        QSet<HUdn> freedUdns;
+
+        qint32 kept = 0;
+        for(qint32 i = 0; i < m_allDevices.size(); ++i)
+        {
+            Device* device = m_allDevices[i].m_item;
+            if (!isInTree(device, root))
+            {
+                m_allDevices[kept++] = m_allDevices[i];
+                continue;
+            }
+
+            const HUdn& udn = device->info().udn();
+            if (m_devicesByUdn.value(udn) == device)
+            {
+                m_devicesByUdn.remove(udn);
+                freedUdns.insert(udn);
+            }
+            if (m_rootDevicesByUdn.value(udn) == device)
+            {
+                m_rootDevicesByUdn.remove(udn);
+            }
+        }
+        m_allDevices.resize(kept);
+
+        QSet<QString> freedScpdKeys, freedControlKeys, freedEventKeys;
+
+        kept = 0;
+        for(qint32 i = 0; i < m_allServices.size(); ++i)
+        {
+            Service* service = m_allServices[i].m_item;
+            if (!isInTree(service->parentDevice(), root))
+            {
+                m_allServices[kept++] = m_allServices[i];
+                continue;
+            }
+
+            const HServiceInfo& info = service->info();
+            removeFromIndex(
+                m_servicesByScpdUrl, info.scpdUrl(), service, &freedScpdKeys);
+            removeFromIndex(
+                m_servicesByControlUrl, info.controlUrl(), service,
+                &freedControlKeys);
+            removeFromIndex(
+                m_servicesByEventUrl, info.eventSubUrl(), service,
+                &freedEventKeys);
+        }
+        m_allServices.resize(kept);
+
+        if (!freedUdns.isEmpty())
+        {
+            for(qint32 i = 0; i < m_allDevices.size(); ++i)
+            {
+                Device* device = m_allDevices[i].m_item;
+                const HUdn& udn = device->info().udn();
+                if (freedUdns.contains(udn) && !m_devicesByUdn.contains(udn))
+                {
+                    m_devicesByUdn.insert(udn, device);
+                }
+            }
+        }
+
+        if (!freedScpdKeys.isEmpty() || !freedControlKeys.isEmpty() ||
+            !freedEventKeys.isEmpty())
+        {
+            for(qint32 i = 0; i < m_allServices.size(); ++i)
+            {
+                Service* service = m_allServices[i].m_item;
+                const HServiceInfo& info = service->info();
+
+                refillIndex(
+                    m_servicesByScpdUrl, freedScpdKeys, info.scpdUrl(),
+                    service);
+                refillIndex(
+                    m_servicesByControlUrl, freedControlKeys,
+                    info.controlUrl(), service);
+                refillIndex(
+                    m_servicesByEventUrl, freedEventKeys, info.eventSubUrl(),
+                    service);
+            }
+        }
+    }
+
+    void clearIndexes()
+    {
+        m_devicesByUdn.clear();
+        m_rootDevicesByUdn.clear();
+        m_servicesByScpdUrl.clear();
+        m_servicesByControlUrl.clear();
+        m_servicesByEventUrl.clear();
+        m_allDevices.clear();
+        m_allServices.clear();
+    }
+
+    // returns true if the device is the specified device or one of its
+    // embedded devices
+    template<typename D>
+    static bool isInTree(const D* device, const void* tree)
+    {
+        return device &&
+            (device == tree || isInTree(device->parentDevice(), tree));
+    }
+
+    // returns the service from the index if it belongs to the device tree
+    // rooted at the specified device
+    Service* searchService(
+        const QHash<QString, Service*>& index, Device* device,
+        const QUrl& url, bool* notInTree) const
+    {
+        *notInTree = false;
+
+        Service* service = index.value(urlKey(url));
+        if (!service)
+        {
+            return 0;
+        }
+
+        if (isInTree(service->parentDevice(), device))
+        {
+            return service;
+        }
+
+        *notInTree = true;
+        return 0;
+    }
+
 public: // instance methods
 
     HDeviceStorage(const QByteArray& lid) :
-        m_loggingIdentifier(lid), m_rootDevices()
+        m_loggingIdentifier(lid), m_rootDevices(), m_deviceControllers(),
+        m_revision(0), m_devicesByUdn(), m_rootDevicesByUdn(),
+        m_servicesByScpdUrl(), m_servicesByControlUrl(), m_servicesByEventUrl(),
+        m_allDevices(), m_allServices()
     {
     }
 
@@ -358,8 +617,16 @@ public: // instance methods
         return m_lastError;
     }
 
+    // allows the users to detect changes in the stored device trees
+    inline quint32 revision() const
+    {
+        return m_revision;
+    }
+
     void clear()
     {
+        ++m_revision;
+        clearIndexes();
         qDeleteAll(m_rootDevices);
         m_rootDevices.clear();
         for(int i = 0; i < m_deviceControllers.size(); ++i)
@@ -385,15 +652,8 @@ public: // instance methods
 
     Device* searchDeviceByUdn(const HUdn& udn, TargetDeviceType dts) const
     {
-        QList<Device*> devices;
-
-        seekDevices(
-            m_rootDevices,
-            MatchFunctor<Device, UdnTester<Device> >(udn),
-            devices,
-            dts);
-
-        return devices.size() > 0 ? devices[0] : 0;
+        return dts == RootDevices ?
+            m_rootDevicesByUdn.value(udn) : m_devicesByUdn.value(udn);
     }
 
     bool searchValidLocation(
@@ -428,12 +688,19 @@ public: // instance methods
     {
         QList<Device*> retVal;
 
-        seekDevices(
-            m_rootDevices,
-            MatchFunctor<Device, DeviceTypeTester<Device> >(
-                DeviceTypeTester<Device>(deviceType, vm)),
-            retVal,
-            dts);
+        DeviceTypeTester<Device> tester(deviceType, vm);
+        quint32 key = typeKey(deviceType);
+
+        for(qint32 i = 0; i < m_allDevices.size(); ++i)
+        {
+            const HTypeIndexEntry<Device>& entry = m_allDevices[i];
+            if (entry.m_typeKey == key &&
+                (dts == AllDevices || entry.m_rootLevel) &&
+                tester(entry.m_item))
+            {
+                retVal.append(entry.m_item);
+            }
+        }
 
         return retVal;
     }
@@ -443,12 +710,17 @@ public: // instance methods
     {
         QList<Service*> retVal;
 
-        seekServices(
-            m_rootDevices,
-            MatchFunctor<Service, ServiceTypeTester<Service> >(
-                ServiceTypeTester<Service>(serviceType, vm)),
-            retVal,
-            false);
+        ServiceTypeTester<Service> tester(serviceType, vm);
+        quint32 key = typeKey(serviceType);
+
+        for(qint32 i = 0; i < m_allServices.size(); ++i)
+        {
+            const HTypeIndexEntry<Service>& entry = m_allServices[i];
+            if (entry.m_typeKey == key && tester(entry.m_item))
+            {
+                retVal.append(entry.m_item);
+            }
+        }
 
         return retVal;
     }
@@ -491,6 +763,8 @@ public: // instance methods
 
         m_rootDevices.push_back(root);
         m_deviceControllers.append(qMakePair(root, controller));
+        addToIndexes(root);
+        ++m_revision;
 
         HLOG_DBG(QString("New root device [%1] added. Current device count is %2").arg(
             root->info().friendlyName(), QString::number(m_rootDevices.size())));
@@ -528,15 +802,35 @@ public: // instance methods
             }
         }
 
+        removeFromIndexes(root);
+
         delete root;
         Q_ASSERT(found);
 
+        ++m_revision;
+
         HLOG_DBG(QString("Root device [%1] removed. Current device count is %2").arg(
             devInfo.friendlyName(), QString::number(m_rootDevices.size())));
 
         return true;
     }
 
+    // the services of a device tree that is stored can be replaced only
+    // between these calls, which take the tree out of the indexes and put
+    // it back
+    void beginTreeUpdate(Device* root)
+    {
+        Q_ASSERT(root && !root->parentDevice());
+        removeFromIndexes(root);
+    }
+
+    void endTreeUpdate(Device* root)
+    {
+        Q_ASSERT(root && !root->parentDevice());
+        addToIndexes(root);
+        ++m_revision;
+    }
+
     QUrl seekIcon(Device* device, const QString& iconUrl)
     {
         Q_ASSERT(device);
@@ -563,8 +857,20 @@ public: // instance methods
         return QUrl();
     }
 
+    // in case the service found from the index belongs to another device
+    // tree, the device tree is searched for another service with the same URL
+
     Service* searchServiceByScpdUrl(Device* device, const QUrl& scpdUrl) const
     {
+        bool notInTree;
+        Service* service =
+            searchService(m_servicesByScpdUrl, device, scpdUrl, &notInTree);
+
+        if (!notInTree)
+        {
+            return service;
+        }
+
         QList<Device*> tmp; tmp.push_back(device);
         return seekService(
             tmp,
@@ -573,14 +879,21 @@ public: // instance methods
 
     Service* searchServiceByScpdUrl(const QUrl& scpdUrl) const
     {
-        return seekService(
-            m_rootDevices,
-            MatchFunctor<Service, ScpdUrlTester<Service> >(scpdUrl));
+        return m_servicesByScpdUrl.value(urlKey(scpdUrl));
     }
 
     Service* searchServiceByControlUrl(
         Device* device, const QUrl& controlUrl) const
     {
+        bool notInTree;
+        Service* service = searchService(
+            m_servicesByControlUrl, device, controlUrl, &notInTree);
+
+        if (!notInTree)
+        {
+            return service;
+        }
+
         QList<Device*> tmp; tmp.push_back(device);
         return seekService(
             tmp,
@@ -589,13 +902,20 @@ public: // instance methods
 
     Service* searchServiceByControlUrl(const QUrl& controlUrl) const
     {
-        return seekService(
-            m_rootDevices,
-            MatchFunctor<Service, ControlUrlTester<Service> >(controlUrl));
+        return m_servicesByControlUrl.value(urlKey(controlUrl));
     }
 
     Service* searchServiceByEventUrl(Device* device, const QUrl& eventUrl) const
     {
+        bool notInTree;
+        Service* service =
+            searchService(m_servicesByEventUrl, device, eventUrl, &notInTree);
+
+        if (!notInTree)
+        {
+            return service;
+        }
+
         QList<Device*> tmp; tmp.push_back(device);
         return seekService(
             tmp,
@@ -604,9 +924,7 @@ public: // instance methods
 
     Service* searchServiceByEventUrl(const QUrl& eventUrl) const
     {
-        return seekService(
-            m_rootDevices,
-            MatchFunctor<Service, EventUrlTester<Service> >(eventUrl));
+        return m_servicesByEventUrl.value(urlKey(eventUrl));
     }
 
     template<typename T>
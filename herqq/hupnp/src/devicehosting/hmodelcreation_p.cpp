@@ -32,9 +32,7 @@ namespace Upnp
  * HModelCreationArgs
  ******************************************************************************/
 HModelCreationArgs::HModelCreationArgs() :
-    m_deviceDescription(),
     m_deviceLocations(),
-    m_serviceDescriptionFetcher(),
     m_deviceTimeoutInSecs(0),
     m_iconFetcher(),
     m_loggingIdentifier()
@@ -50,6 +50,12 @@ namespace Upnp
 typedef Functor<bool, H_TYPELIST_3(const QUrl&, const QUrl&, QString*)>
     ServiceDescriptionFetcher;
 
+//
+// Retrieves a service description as the encoded document it was received as
+//
+typedef Functor<bool, H_TYPELIST_3(const QUrl&, const QUrl&, QByteArray*)>
+    ServiceDescriptionDataFetcher;
+
 //
 //
 //
@@ -68,13 +74,8 @@ public:
     HModelCreationArgs();
     virtual ~HModelCreationArgs() = 0;
 
-    QString m_deviceDescription;
     QList<QUrl> m_deviceLocations;
 
-    ServiceDescriptionFetcher m_serviceDescriptionFetcher;
-    // provides the possibility of defining how the service description is
-    // retrieved
-
     qint32 m_deviceTimeoutInSecs;
     IconFetcher m_iconFetcher;
     QByteArray m_loggingIdentifier;
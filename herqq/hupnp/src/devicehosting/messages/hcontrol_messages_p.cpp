@@ -28,14 +28,15 @@ namespace Upnp
 {
 
 HInvokeActionRequest::HInvokeActionRequest() :
-    m_soapAction(), m_soapMsg(), m_serviceUrl()
+    m_soapAction(), m_soapMsg(), m_serviceUrl(), m_acceptsGzip(false)
 {
 }
 
 HInvokeActionRequest::HInvokeActionRequest(
-    const QString& soapAction, const QtSoapMessage& soapMsg,
-    const QUrl& serviceUrl) :
-        m_soapAction(soapAction), m_soapMsg(soapMsg), m_serviceUrl(serviceUrl)
+    const QString& soapAction, const HSoapMessage& soapMsg,
+    const QUrl& serviceUrl, bool acceptsGzip) :
+        m_soapAction(soapAction), m_soapMsg(soapMsg), m_serviceUrl(serviceUrl),
+        m_acceptsGzip(acceptsGzip)
 {
 }
 
@@ -33,7 +33,7 @@
 #include <QtCore/QUrl>
 #include <QtCore/QString>
 
-#include <QtSoapMessage>
+#include "../../http/hsoap_p.h"
 
 namespace Herqq
 {
@@ -49,15 +49,16 @@ class HInvokeActionRequest
 private:
 
     QString       m_soapAction;
-    QtSoapMessage m_soapMsg;
+    HSoapMessage  m_soapMsg;
     QUrl          m_serviceUrl;
+    bool          m_acceptsGzip;
 
 public:
 
     HInvokeActionRequest();
     HInvokeActionRequest(
-        const QString& soapAction, const QtSoapMessage& soapMsg,
-        const QUrl& serviceUrl);
+        const QString& soapAction, const HSoapMessage& soapMsg,
+        const QUrl& serviceUrl, bool acceptsGzip = false);
 
     ~HInvokeActionRequest();
 
@@ -66,7 +67,7 @@ public:
         return m_soapAction;
     }
 
-    inline const QtSoapMessage* soapMsg() const
+    inline const HSoapMessage* soapMsg() const
     {
         return &m_soapMsg;
     }
@@ -75,6 +76,12 @@ public:
     {
         return m_serviceUrl;
     }
+
+    // whether the invoker accepts a gzip-encoded response
+    inline bool acceptsGzip() const
+    {
+        return m_acceptsGzip;
+    }
 };
 
 }
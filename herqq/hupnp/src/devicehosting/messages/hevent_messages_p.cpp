@@ -23,10 +23,10 @@
 
 #include "../../general/hlogger_p.h"
 
-#include <QtXml/QDomDocument>
-
 #include <QtCore/QRegExp>
 #include <QtCore/QStringList>
+#include <QtCore/QXmlStreamReader>
+#include <QtCore/QXmlStreamWriter>
 
 #include <QtNetwork/QHostAddress>
 
@@ -293,41 +293,41 @@ HNotifyRequest::RetVal parseData(
 {
     HLOG(H_AT, H_FUN);
 
-    QDomDocument dd;
-    if (!dd.setContent(data, true))
+    // the property set is read as a stream, since it is usually small and
+    // it is parsed for every notification
+    QXmlStreamReader reader(data);
+    if (!reader.readNextStartElement() || reader.name() != "propertyset")
     {
         return HNotifyRequest::InvalidContents;
     }
 
-    //QDomNodeList propertySetNodes =
-      //  dd.elementsByTagNameNS("urn:schemas-upnp.org:event-1-0", "propertyset");
-
-    QDomElement propertySetElement = dd.firstChildElement("propertyset");
-
-    if (propertySetElement.isNull())
-    {
-        return HNotifyRequest::InvalidContents;
-    }
-
-    QDomElement propertyElement =
-        propertySetElement.firstChildElement("property");
-        //propertySetNodes.at(0).toElement().elementsByTagNameNS(
-          //  "urn:schemas-upnp.org:event-1-0", "property");
-
     QList<QPair<QString, QString> > tmp;
-    while(!propertyElement.isNull())
+    while(reader.readNextStartElement())
     {
-        QDomElement variableElement = propertyElement.firstChildElement();
-        if (variableElement.isNull())
+        if (reader.name() != "property")
+        {
+            reader.skipCurrentElement();
+            continue;
+        }
+
+        if (!reader.readNextStartElement())
         {
             return HNotifyRequest::InvalidContents;
         }
 
-        QDomText variableValue = variableElement.firstChild().toText();
-        tmp.push_back(
-            qMakePair(variableElement.localName(), variableValue.data()));
+        QString name = reader.name().toString();
+        QString value =
+            reader.readElementText(QXmlStreamReader::SkipChildElements);
 
-        propertyElement = propertyElement.nextSiblingElement("property");
+        tmp.push_back(qMakePair(name, value));
+
+        // skips the rest of the property element
+        reader.skipCurrentElement();
+    }
+
+    if (reader.hasError())
+    {
+        return HNotifyRequest::InvalidContents;
     }
 
     parsedData = tmp;
@@ -368,6 +368,31 @@ HNotifyRequest::~HNotifyRequest()
 {
 }
 
+QByteArray HNotifyRequest::createPropertySet(const Variables& variables)
+{
+    HLOG(H_AT, H_FUN);
+
+    // the body is streamed directly instead of building and rendering a DOM
+    QByteArray retVal;
+    QXmlStreamWriter writer(&retVal);
+
+    writer.writeProcessingInstruction(
+        "xml", "version=\"1.0\" encoding=\"utf-8\"");
+    writer.writeNamespace("urn:schemas-upnp-org:event-1-0", "e");
+    writer.writeStartElement("urn:schemas-upnp-org:event-1-0", "propertyset");
+
+    for(qint32 i = 0; i < variables.size(); ++i)
+    {
+        writer.writeStartElement("urn:schemas-upnp-org:event-1-0", "property");
+        writer.writeTextElement(variables.at(i).first, variables.at(i).second);
+        writer.writeEndElement();
+    }
+
+    writer.writeEndElement();
+
+    return retVal;
+}
+
 HNotifyRequest::RetVal HNotifyRequest::setContents(
     const QUrl& callback,
     const QString& nt, const QString& nts, const QString& sid,
@@ -417,5 +442,100 @@ HNotifyRequest::RetVal HNotifyRequest::setContents(
     return Success;
 }
 
+/*******************************************************************************
+ * HMulticastNotifyRequest
+ *******************************************************************************/
+HMulticastNotifyRequest::HMulticastNotifyRequest() :
+    m_usn(), m_serviceId(), m_seq(0), m_level(), m_bootId(-1),
+    m_dataAsVariables(), m_data()
+{
+}
+
+HMulticastNotifyRequest::HMulticastNotifyRequest(
+    const HDiscoveryType& usn, const HServiceId& serviceId,
+    quint32 seq, qint32 bootId, const QByteArray& contents) :
+        m_usn(), m_serviceId(), m_seq(0), m_level(), m_bootId(-1),
+        m_dataAsVariables(), m_data()
+{
+    HLOG(H_AT, H_FUN);
+
+    if (usn.type() != HDiscoveryType::SpecificServiceWithType ||
+        !serviceId.isValid(LooseChecks) || contents.isEmpty())
+    {
+        return;
+    }
+
+    if (parseData(contents, m_dataAsVariables) != HNotifyRequest::Success)
+    {
+        return;
+    }
+
+    m_usn       = usn;
+    m_serviceId = serviceId;
+    m_seq       = seq;
+    m_level     = "upnp:/info";
+    m_bootId    = bootId;
+    m_data      = contents;
+}
+
+HMulticastNotifyRequest::~HMulticastNotifyRequest()
+{
+}
+
+HEndpoint HMulticastNotifyRequest::multicastEndpoint()
+{
+    static HEndpoint retVal("239.255.255.246:7900");
+    return retVal;
+}
+
+HNotifyRequest::RetVal HMulticastNotifyRequest::setContents(
+    const QString& nt, const QString& nts, const QString& usn,
+    const QString& svcid, const QString& seq, const QString& level,
+    qint32 bootId, const QByteArray& contents)
+{
+    HLOG(H_AT, H_FUN);
+
+    HNt tmpNt(nt, nts);
+    if (tmpNt.type   () != HNt::Type_UpnpEvent ||
+        tmpNt.subType() != HNt::SubType_UpnpPropChange)
+    {
+        return HNotifyRequest::PreConditionFailed;
+    }
+
+    HMulticastNotifyRequest tmp;
+
+    tmp.m_usn = HDiscoveryType(usn, LooseChecks);
+    if (tmp.m_usn.type() != HDiscoveryType::SpecificServiceWithType)
+    {
+        return HNotifyRequest::PreConditionFailed;
+    }
+
+    tmp.m_serviceId = HServiceId(svcid.trimmed());
+    if (!tmp.m_serviceId.isValid(LooseChecks))
+    {
+        return HNotifyRequest::PreConditionFailed;
+    }
+
+    bool ok = false;
+    tmp.m_seq = seq.trimmed().toUInt(&ok);
+    if (!ok)
+    {
+        return HNotifyRequest::InvalidSequenceNr;
+    }
+
+    tmp.m_level  = level.trimmed();
+    tmp.m_bootId = bootId;
+    tmp.m_data   = contents;
+
+    HNotifyRequest::RetVal rv = parseData(tmp.m_data, tmp.m_dataAsVariables);
+    if (rv != HNotifyRequest::Success)
+    {
+        return rv;
+    }
+
+    *this = tmp;
+    return HNotifyRequest::Success;
+}
+
 }
 }
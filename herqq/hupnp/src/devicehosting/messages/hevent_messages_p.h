@@ -34,6 +34,9 @@
 #include "hsid_p.h"
 #include "htimeout_p.h"
 
+#include <HUpnpCore/HEndpoint>
+#include <HUpnpCore/HServiceId>
+#include <HUpnpCore/HDiscoveryType>
 #include <HUpnpCore/HProductTokens>
 
 #include <QtCore/QUrl>
@@ -53,7 +56,7 @@ namespace Upnp
 //
 // Class that represents the UPnP eventing subscription request.
 //
-class HSubscribeRequest
+class H_UPNP_CORE_EXPORT HSubscribeRequest
 {
 private:
 
@@ -150,7 +153,7 @@ public:
 //
 //
 //
-class HSubscribeResponse
+class H_UPNP_CORE_EXPORT HSubscribeResponse
 {
 private:
 
@@ -197,7 +200,7 @@ public:
 //
 //
 //
-class HUnsubscribeRequest
+class H_UPNP_CORE_EXPORT HUnsubscribeRequest
 {
 private:
 
@@ -242,7 +245,7 @@ public:
 //
 //
 //
-class HNotifyRequest
+class H_UPNP_CORE_EXPORT HNotifyRequest
 {
 public:
 
@@ -275,6 +278,9 @@ public:
 
     ~HNotifyRequest();
 
+    // creates the propertyset body of a notification
+    static QByteArray createPropertySet(const Variables&);
+
     RetVal setContents(
         const QUrl& callback,
         const QString& nt, const QString& nts, const QString& sid,
@@ -299,6 +305,62 @@ public:
     inline Variables  variables() const { return m_dataAsVariables; }
 };
 
+//
+// Class that represents the UPnP 1.1 multicast event notification, which is
+// sent to the multicast group 239.255.255.246:7900 instead of a subscriber.
+//
+class H_UPNP_CORE_EXPORT HMulticastNotifyRequest
+{
+private:
+
+    HDiscoveryType m_usn;
+    // the UDN of the device and the type of the service that sent the event
+
+    HServiceId m_serviceId;
+    quint32    m_seq;
+    QString    m_level;
+    qint32     m_bootId;
+
+    HNotifyRequest::Variables m_dataAsVariables;
+    QByteArray m_data;
+
+public:
+
+    HMulticastNotifyRequest();
+
+    HMulticastNotifyRequest(
+        const HDiscoveryType& usn, const HServiceId& serviceId,
+        quint32 seq, qint32 bootId, const QByteArray& contents);
+
+    ~HMulticastNotifyRequest();
+
+    // the group to which the multicast events are sent
+    static HEndpoint multicastEndpoint();
+
+    HNotifyRequest::RetVal setContents(
+        const QString& nt, const QString& nts, const QString& usn,
+        const QString& svcid, const QString& seq, const QString& level,
+        qint32 bootId, const QByteArray& contents);
+
+    inline bool isValid() const
+    {
+        return m_usn.type() == HDiscoveryType::SpecificServiceWithType;
+        // if this is defined then everything else is defined as well
+    }
+
+    inline HDiscoveryType usn      () const { return m_usn            ; }
+    inline HServiceId     serviceId() const { return m_serviceId      ; }
+    inline quint32        seq      () const { return m_seq            ; }
+    inline QString        level    () const { return m_level          ; }
+    inline qint32         bootId   () const { return m_bootId         ; }
+    inline QByteArray     data     () const { return m_data           ; }
+
+    inline HNotifyRequest::Variables variables() const
+    {
+        return m_dataAsVariables;
+    }
+};
+
 }
 }
 
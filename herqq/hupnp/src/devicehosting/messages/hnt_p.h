@@ -22,6 +22,8 @@
 #ifndef HNT_H_
 #define HNT_H_
 
+#include "../../general/hupnp_defs.h"
+
 #include <QtCore/QPair>
 #include <QtCore/QString>
 
@@ -42,7 +44,7 @@ namespace Upnp
 //
 //
 //
-class HNt
+class H_UPNP_CORE_EXPORT HNt
 {
 public:
 
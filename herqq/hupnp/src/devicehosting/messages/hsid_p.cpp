@@ -29,34 +29,47 @@ namespace Herqq
 namespace Upnp
 {
 
+namespace
+{
+inline QString canonicalForm(const QUuid& uuid)
+{
+    return QString("uuid:%1").arg(uuid.toString().remove('{').remove('}'));
+}
+}
+
 HSid::HSid() :
-    m_value(), m_valueAsStr()
+    m_value(), m_valueAsStr(), m_hash(0)
 {
+    init();
 }
 
 HSid::HSid(const QUuid& sid) :
-    m_value(sid), m_valueAsStr(
-        QString("uuid:%1").arg(sid.toString().remove('{').remove('}')))
+    m_value(sid), m_valueAsStr(), m_hash(0)
 {
+    if (sid.isNull())
+    {
+        // a null UUID has to remain distinguishable from an empty SID
+        m_valueAsStr = canonicalForm(sid);
+    }
+    init();
 }
 
 HSid::HSid(const HSid& other) :
-    m_value(), m_valueAsStr()
+    m_value(other.m_value), m_valueAsStr(other.m_valueAsStr),
+    m_hash(other.m_hash)
 {
     Q_ASSERT(&other != this);
-
-    m_value = other.m_value;
-    m_valueAsStr = other.m_valueAsStr;
 }
 
 HSid::HSid(const QString& sid) :
-    m_value(), m_valueAsStr()
+    m_value(), m_valueAsStr(), m_hash(0)
 {
     QString tmp(sid.simplified());
     if (tmp.isEmpty())
     {
         // in essence, only "empty" strings are not acceptable. If UUIDs are not
         // enforced, there can be no "minimum" requirement for an "invalid" UUID.
+        init();
         return;
     }
     else if (tmp.startsWith("uuid:", Qt::CaseInsensitive))
@@ -69,18 +82,46 @@ HSid::HSid(const QString& sid) :
         m_value = QUuid(tmp);
         m_valueAsStr = QString("uuid:%1").arg(tmp);
     }
+
+    if (!m_value.isNull() && m_valueAsStr == canonicalForm(m_value))
+    {
+        m_valueAsStr.clear();
+    }
+    init();
 }
 
 HSid::~HSid()
 {
 }
 
+void HSid::init()
+{
+    if (m_valueAsStr.isEmpty())
+    {
+        m_hash = m_value.isNull() ? 0 :
+            hash(reinterpret_cast<const char*>(&m_value), sizeof(m_value));
+    }
+    else
+    {
+        m_hash = hash(
+            reinterpret_cast<const char*>(m_valueAsStr.unicode()),
+            m_valueAsStr.size() * static_cast<int>(sizeof(QChar)));
+    }
+}
+
+QString HSid::toString() const
+{
+    return m_valueAsStr.isEmpty() && !m_value.isNull() ?
+        canonicalForm(m_value) : m_valueAsStr;
+}
+
 HSid& HSid::operator=(const HSid& other)
 {
     Q_ASSERT(&other != this);
 
     m_value = other.m_value;
     m_valueAsStr = other.m_valueAsStr;
+    m_hash = other.m_hash;
     return *this;
 }
 
@@ -100,13 +141,8 @@ HSid& HSid::operator=(const QUuid& other)
 
 bool operator==(const HSid& sid1, const HSid& sid2)
 {
-    return sid1.m_valueAsStr == sid2.m_valueAsStr;
-}
-
-quint32 qHash(const HSid& key)
-{
-    QByteArray data = key.toString().toLocal8Bit();
-    return hash(data.constData(), data.size());
+    return sid1.m_hash == sid2.m_hash && sid1.m_value == sid2.m_value &&
+           sid1.m_valueAsStr == sid2.m_valueAsStr;
 }
 
 }
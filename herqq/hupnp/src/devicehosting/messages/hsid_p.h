@@ -22,6 +22,8 @@
 #ifndef HSID_H_
 #define HSID_H_
 
+#include "../../general/hupnp_defs.h"
+
 #include <QtCore/QUuid>
 #include <QtCore/QString>
 
@@ -44,7 +46,7 @@ namespace Upnp
 // since there are UPnP software that do not generate and use valid UUIDs.
 // Because of this, the class "accepts" any string. However, validity can be checked
 // with the isValid(). **Do NOT change the semantics of this class**
-class HSid
+class H_UPNP_CORE_EXPORT HSid
 {
 friend quint32 qHash(const HSid& key);
 friend bool operator==(const HSid&, const HSid&);
@@ -52,7 +54,15 @@ friend bool operator==(const HSid&, const HSid&);
 private:
 
     QUuid m_value;
+
     QString m_valueAsStr;
+    // empty when the SID is in its canonical form, i.e. "uuid:" followed by
+    // the lowercase UUID without curly braces. the string is then built only
+    // when asked, as the SIDs are mostly copied, compared and hashed
+
+    quint32 m_hash;
+
+    void init();
 
 public:
 
@@ -72,10 +82,7 @@ public:
         return m_value;
     }
 
-    inline QString toString() const
-    {
-        return m_valueAsStr;
-    }
+    QString toString() const;
 
     inline bool isValid()const
     {
@@ -84,7 +91,7 @@ public:
 
     inline bool isEmpty() const
     {
-        return m_valueAsStr.isEmpty();
+        return m_value.isNull() && m_valueAsStr.isEmpty();
     }
 };
 
@@ -94,7 +101,10 @@ inline bool operator!=(const HSid& obj1, const HSid& obj2)
     return !(obj1 == obj2);
 }
 
-quint32 qHash(const HSid& key);
+inline quint32 qHash(const HSid& key)
+{
+    return key.m_hash;
+}
 
 }
 }
@@ -30,6 +30,8 @@
 // change or the file may be removed without of notice.
 //
 
+#include "../../general/hupnp_defs.h"
+
 #include <QtCore/QtGlobal>
 
 class QString;
@@ -43,7 +45,7 @@ namespace Upnp
 //
 //
 //
-class HTimeout
+class H_UPNP_CORE_EXPORT HTimeout
 {
 friend bool operator==(const HTimeout&, const HTimeout&);
 
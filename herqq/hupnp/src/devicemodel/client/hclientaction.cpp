@@ -27,11 +27,17 @@
 #include "hdefault_clientaction_p.h"
 #include "hdefault_clientservice_p.h"
 
+#include "../hcanceltoken_p.h"
+
+#include "../../general/hmemoryaccount_p.h"
+#include "../../general/htrace_p.h"
 #include "../../general/hlogger_p.h"
 
 #include "../../general/hupnp_global_p.h"
 #include "../../general/hupnp_datatypes_p.h"
 
+#include "../../http/hsoap_p.h"
+
 #include "../../dataelements/hudn.h"
 #include "../../dataelements/hactioninfo.h"
 #include "../../dataelements/hdeviceinfo.h"
@@ -40,7 +46,10 @@
 #include "../../general/hlogger_p.h"
 
 #include <QtCore/QList>
-#include <QtSoapMessage>
+#include <QtCore/QThread>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QThreadStorage>
 
 namespace Herqq
 {
@@ -48,18 +57,68 @@ namespace Herqq
 namespace Upnp
 {
 
+namespace
+{
+//
+// The invocation serialized last in a thread. When the same invocation is
+// sent to a group of devices in a row, the SOAP message is created only once
+// and the rest of the invocations share it.
+//
+struct HSerializedInvocation
+{
+    QString m_actionName;
+    QString m_serviceType;
+    HActionArguments m_inArgs;
+    QByteArray m_soapMsg;
+};
+
+QThreadStorage<HSerializedInvocation*> s_lastSerialized;
+
+QByteArray serialize(
+    const QString& actionName, const QString& serviceType,
+    const HActionArguments& inArgs)
+{
+    HSerializedInvocation* last = s_lastSerialized.localData();
+    if (!last)
+    {
+        last = new HSerializedInvocation();
+        s_lastSerialized.setLocalData(last);
+    }
+    else if (!last->m_soapMsg.isEmpty() &&
+             last->m_actionName == actionName &&
+             last->m_serviceType == serviceType &&
+             last->m_inArgs == inArgs)
+    {
+        return last->m_soapMsg;
+    }
+
+    last->m_soapMsg =
+        HSoapMessage::createMethod(actionName, serviceType, inArgs);
+
+    last->m_actionName = actionName;
+    last->m_serviceType = serviceType;
+    last->m_inArgs = inArgs;
+
+    return last->m_soapMsg;
+}
+}
+
 /*******************************************************************************
  * HActionProxy
  ******************************************************************************/
 HActionProxy::HActionProxy(
-    QNetworkAccessManager& nam, HDefaultClientAction* owner) :
+    HInvocationChannel& channel, HDefaultClientAction* owner) :
         QObject(owner),
             m_locations(),
             m_lastUsedLocation(),
             m_iNextLocationToTry(0),
-            m_nam(nam),
+            m_channel(channel),
             m_reply(0),
-            m_owner(owner)
+            m_owner(owner),
+            m_soapMsg(),
+            m_queued(false),
+            m_requestId(0),
+            m_traceStart(-1)
 {
     Q_ASSERT(m_owner);
     bool ok = connect(
@@ -77,6 +136,8 @@ HActionProxy::~HActionProxy()
 void HActionProxy::invocationDone(qint32 rc, const HActionArguments* outArgs)
 {
     deleteReply();
+    m_soapMsg.clear();
+    m_channel.remove(this);
     m_owner->invokeCompleted(rc, outArgs);
 }
 
@@ -108,8 +169,16 @@ void HActionProxy::error(QNetworkReply::NetworkError err)
     {
         return;
     }
-    else if (err == QNetworkReply::ConnectionRefusedError ||
-             err == QNetworkReply::HostNotFoundError)
+
+    if (m_traceStart >= 0)
+    {
+        HTraceRecorder::complete(
+            "action", "network", m_traceStart, m_requestId);
+        m_traceStart = -1;
+    }
+
+    if (err == QNetworkReply::ConnectionRefusedError ||
+        err == QNetworkReply::HostNotFoundError)
     {
         HLOG_WARN(QString("Couldn't connect to the device [%1] @ [%2].").arg(
             m_owner->parentService()->parentDevice()->info().udn().toSimpleUuid(),
@@ -119,7 +188,7 @@ void HActionProxy::error(QNetworkReply::NetworkError err)
         {
             ++m_iNextLocationToTry;
             deleteReply();
-            send();
+            post();
 
             return;
         }
@@ -146,6 +215,14 @@ void HActionProxy::finished()
         return;
     }
 
+    if (m_traceStart >= 0)
+    {
+        HTraceRecorder::complete(
+            "action", "network", m_traceStart, m_requestId);
+        m_traceStart = -1;
+    }
+    HTraceSpan span("action", "parse", m_requestId);
+
     bool ok = false;
     qint32 statusCode = m_reply->attribute(
         QNetworkRequest::HttpStatusCodeAttribute).toInt(&ok);
@@ -165,8 +242,8 @@ void HActionProxy::finished()
     }
 
     QByteArray data = m_reply->readAll();
-    QtSoapMessage response;
-    if (!response.setContent(data))
+    HSoapMessage response;
+    if (!response.parse(data))
     {
         HLOG_WARN(QString(
             "Received an invalid SOAP message as a response to "
@@ -179,13 +256,12 @@ void HActionProxy::finished()
     if (response.isFault())
     {
         HLOG_WARN(QString(
-            "Action invocation failed: [%1, %2]").arg(
-                response.faultString().toString(),
-                response.faultDetail().toString()));
+            "Action invocation failed: [%1, %2: %3]").arg(
+                response.faultString(),
+                QString::number(response.errorCode()),
+                response.errorDescription()));
 
-        QtSoapType errCode = response.faultDetail()["errorCode"];
-        invocationDone(errCode.isValid() ?
-            errCode.value().toInt() : UpnpUndefinedFailure);
+        invocationDone(response.errorCode());
         return;
     }
 
@@ -197,41 +273,32 @@ void HActionProxy::finished()
         return;
     }
 
-    const QtSoapType& root = response.method();
-    if (!root.isValid())
-    {
-        HLOG_WARN(QString(
-            "Received an invalid response to action invocation: [%1]").arg(
-                response.toXmlString()));
-
-        invocationDone(UpnpUndefinedFailure);
-        return;
-    }
-
     HActionArguments outArgs = m_owner->info().outputArguments();
     HActionArguments::const_iterator ci = outArgs.constBegin();
     for(; ci != outArgs.constEnd(); ++ci)
     {
         HActionArgument oarg = *ci;
 
-        const QtSoapType& arg = root[oarg.name()];
-        if (!arg.isValid())
+        bool found = false;
+        QString value = response.argument(oarg.name(), &found);
+        if (!found)
         {
+            HLOG_WARN(QString(
+                "Received an invalid response to action invocation: "
+                "missing output argument [%1]").arg(oarg.name()));
+
             invocationDone(UpnpUndefinedFailure);
             return;
         }
 
-        HActionArgument userArg = outArgs.get(oarg.name());
-
-        userArg.setValue(
-            HUpnpDataTypes::convertToRightVariantType(
-                arg.value().toString(), oarg.dataType()));
+        oarg.setValue(
+            HUpnpDataTypes::convertToRightVariantType(value, oarg.dataType()));
     }
 
     invocationDone(UpnpSuccess, &outArgs);
 }
 
-bool HActionProxy::send()
+bool HActionProxy::send(const HActionArguments& inArgs)
 {
     HLOG2(H_AT, H_FUN, m_owner->loggingIdentifier());
 
@@ -247,33 +314,46 @@ bool HActionProxy::send()
         }
     }
 
-    Q_ASSERT(m_iNextLocationToTry < m_locations.size());
+    m_requestId =
+        HTraceRecorder::isEnabled() ? HTraceRecorder::newRequestId() : 0;
+
+    HTraceSpan span("action", "serialize", m_requestId);
+    m_soapMsg = serialize(
+        m_owner->info().name(),
+        m_owner->parentService()->info().serviceType().toString(),
+        inArgs);
+    span.end();
 
-    QtSoapNamespaces::instance().registerNamespace(
-        "u", m_owner->parentService()->info().serviceType().toString());
+    // the time the invocation waits in the channel is traced as well
+    m_traceStart = HTraceRecorder::isEnabled() ? HTraceRecorder::now() : -1;
 
-    QtSoapMessage soapMsg;
-    soapMsg.setMethod(
-        QtSoapQName(
-            m_owner->info().name(),
-            m_owner->parentService()->info().serviceType().toString()));
+    m_queued = true;
+    m_channel.enqueue(this);
 
-    HActionArguments::const_iterator ci = m_inArgs.constBegin();
-    for(; ci != m_inArgs.constEnd(); ++ci)
+    return true;
+}
+
+void HActionProxy::post()
+{
+    HLOG2(H_AT, H_FUN, m_owner->loggingIdentifier());
+
+    Q_ASSERT(!m_reply);
+    m_queued = false;
+
+    if (m_locations.isEmpty())
     {
-        HActionArgument iarg = *ci;
-        if (!m_inArgs.contains(iarg.name()))
+        // the locations of the device changed while the invocation was queued
+        m_locations = m_owner->parentService()->parentDevice()->locations(BaseUrl);
+        m_iNextLocationToTry = 0;
+        if (m_locations.isEmpty())
         {
-            invocationDone(UpnpInvalidArgs);
-            return false;
+            invocationDone(UpnpUndefinedFailure);
+            return;
         }
-
-        QtSoapType* soapArg =
-            new SoapType(iarg.name(), iarg.dataType(), iarg.value());
-
-        soapMsg.addMethodArgument(soapArg);
     }
 
+    Q_ASSERT(m_iNextLocationToTry < m_locations.size());
+
     QNetworkRequest req;
 
     req.setHeader(
@@ -294,7 +374,12 @@ bool HActionProxy::send()
 
     req.setUrl(url);
 
-    m_reply = m_nam.post(req, soapMsg.toXmlString().toUtf8());
+    if (m_traceStart >= 0)
+    {
+        HTraceRecorder::complete("action", "queue", m_traceStart, m_requestId);
+    }
+    m_traceStart = HTraceRecorder::isEnabled() ? HTraceRecorder::now() : -1;
+    m_reply = m_channel.nam().post(req, m_soapMsg);
 
     bool ok = connect(
         m_reply, SIGNAL(error(QNetworkReply::NetworkError)),
@@ -303,60 +388,147 @@ bool HActionProxy::send()
 
     ok = connect(m_reply, SIGNAL(finished()), this, SLOT(finished()));
     Q_ASSERT(ok);
-
-    return true;
 }
 
 void HActionProxy::abort()
 {
+    m_queued = false;
     deleteReply();
+    m_soapMsg.clear();
+    m_channel.remove(this);
     m_owner->invokeCompleted(UpnpInvocationAborted, 0);
 }
 
+/*******************************************************************************
+ * HInvocationChannel
+ ******************************************************************************/
+HInvocationChannel::HInvocationChannel(
+    QNetworkAccessManager& nam, qint32 maxParallel) :
+        QObject(),
+            m_nam(nam),
+            m_maxParallel(maxParallel < 0 ? 0 : maxParallel),
+            m_queued(),
+            m_inProgress()
+{
+}
+
+HInvocationChannel::~HInvocationChannel()
+{
+}
+
+void HInvocationChannel::dispatch()
+{
+    // the proxies of the actions that have been deleted are dropped
+    m_inProgress.removeAll(QPointer<HActionProxy>());
+
+    while(!m_queued.isEmpty() &&
+          (!m_maxParallel || m_inProgress.size() < m_maxParallel))
+    {
+        QPointer<HActionProxy> proxy = m_queued.dequeue();
+        if (proxy)
+        {
+            m_inProgress.append(proxy);
+            proxy->post();
+        }
+    }
+}
+
+void HInvocationChannel::enqueue(HActionProxy* proxy)
+{
+    Q_ASSERT(proxy);
+    m_queued.enqueue(proxy);
+    dispatch();
+}
+
+void HInvocationChannel::remove(HActionProxy* proxy)
+{
+    if (!m_inProgress.removeOne(proxy))
+    {
+        m_queued.removeOne(proxy);
+        return;
+    }
+
+    dispatch();
+}
+
 /*******************************************************************************
  * HClientActionPrivate
  ******************************************************************************/
 HClientActionPrivate::HClientActionPrivate() :
-    m_loggingIdentifier(), q_ptr(0), m_info(), m_proxy(0), m_invocations()
+    m_loggingIdentifier(), q_ptr(0), m_info(), m_proxy(0), m_invocations(),
+    m_freeInvocations()
 {
 }
 
 HClientActionPrivate::~HClientActionPrivate()
 {
+    qDeleteAll(m_invocations);
+    qDeleteAll(m_freeInvocations);
+}
+
+HInvocationInfo* HClientActionPrivate::newInvocation(
+    const HActionArguments& inArgs, const HActionInvokeCallback& cb,
+    const HExecArgs& execArgs)
+{
+    HInvocationInfo* retVal = m_freeInvocations.isEmpty() ?
+        new HInvocationInfo() : m_freeInvocations.takeLast();
+
+    retVal->set(inArgs, cb, execArgs);
+    retVal->m_invokeId.setRunner(this);
+
+    return retVal;
+}
+
+void HClientActionPrivate::recycle(HInvocationInfo* inv)
+{
+    if (m_freeInvocations.size() < MaxFreeInvocations)
+    {
+        // the operation object is kept until the next invocation replaces it,
+        // but the callback may refer to an object that is about to be deleted
+        inv->callback = HActionInvokeCallback();
+        m_freeInvocations.append(inv);
+    }
+    else
+    {
+        delete inv;
+    }
 }
 
 void HClientActionPrivate::invokeCompleted(int rc, const HActionArguments* outArgs)
 {
     Q_ASSERT(!m_invocations.isEmpty());
 
-    HInvocationInfo inv = m_invocations.dequeue();
+    HInvocationInfo* inv = m_invocations.takeFirst();
 
-    inv.m_invokeId.setReturnValue(rc);
-    inv.m_invokeId.setOutputArguments(outArgs ? *outArgs : HActionArguments());
+    inv->m_invokeId.setReturnValue(rc);
+    if (outArgs)
+    {
+        inv->m_invokeId.setOutputArguments(*outArgs);
+    }
 
-    if (inv.execArgs.execType() != HExecArgs::FireAndForget)
+    if (inv->execArgs.execType() != HExecArgs::FireAndForget)
     {
         bool sendEvent = true;
-        if (inv.callback && rc != UpnpInvocationAborted)
+        if (inv->callback && rc != UpnpInvocationAborted)
         {
             // If invocation was aborted there's no guarantees that the
             // callback object is valid at this point. With Qt's signals / slots
             // there's no such limitation.
-            sendEvent = inv.callback(q_ptr, inv.m_invokeId);
+            sendEvent = inv->callback(q_ptr, inv->m_invokeId);
         }
 
         if (sendEvent)
         {
             // This is safe even if the invocation was aborted.
-            emit q_ptr->invokeComplete(q_ptr, inv.m_invokeId);
+            emit q_ptr->invokeComplete(q_ptr, inv->m_invokeId);
         }
     }
 
+    recycle(inv);
+
     if (!m_invocations.isEmpty() && !m_proxy->invocationInProgress())
     {
-        const HInvocationInfo& inv = m_invocations.head();
-        m_proxy->setInputArgs(inv.m_inArgs);
-        m_proxy->send();
+        m_proxy->send(m_invocations.first()->inputArguments());
     }
 }
 
@@ -375,18 +547,17 @@ void HClientActionPrivate::abort(unsigned int id)
 {
     if (!m_invocations.isEmpty())
     {
-        if (m_invocations.head().m_invokeId.id() == id)
+        if (m_invocations.first()->m_invokeId.id() == id)
         {
             m_proxy->abort();
         }
         else
         {
-            QQueue<HInvocationInfo>::iterator it = m_invocations.begin();
-            for(; it != m_invocations.end(); ++it)
+            for(qint32 i = 1; i < m_invocations.size(); ++i)
             {
-                if (it->m_invokeId.id() == id)
+                if (m_invocations.at(i)->m_invokeId.id() == id)
                 {
-                    m_invocations.erase(it);
+                    recycle(m_invocations.takeAt(i));
                     break;
                 }
             }
@@ -412,6 +583,164 @@ void HClientActionOp_::setRunner(HClientActionPrivate* runner)
     h->m_runner = runner;
 }
 
+/*******************************************************************************
+ * HSyncInvokeWaiter
+ ******************************************************************************/
+HSyncInvokeWaiter::HSyncInvokeWaiter() :
+    m_mutex(), m_waitCondition(),
+    m_done(false), m_cancelled(false),
+    m_rc(UpnpUndefinedFailure), m_outArgs()
+{
+}
+
+void HSyncInvokeWaiter::complete(qint32 rc, const HActionArguments& outArgs)
+{
+    QMutexLocker lock(&m_mutex);
+    m_done = true;
+    m_rc = rc;
+    m_outArgs = outArgs;
+    m_waitCondition.wakeAll();
+}
+
+void HSyncInvokeWaiter::cancel()
+{
+    QMutexLocker lock(&m_mutex);
+    m_cancelled = true;
+    m_waitCondition.wakeAll();
+}
+
+qint32 HSyncInvokeWaiter::wait(
+    qint32 timeoutMsecs, const HCancelToken* token, HActionArguments* outArgs)
+{
+    if (token)
+    {
+        QMutexLocker lock(&token->h_ptr->m_mutex);
+        if (token->h_ptr->m_cancelled)
+        {
+            return UpnpInvocationAborted;
+        }
+        token->h_ptr->m_waiters.append(this);
+    }
+
+    qint32 rc = UpnpInvocationTimedOut;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    m_mutex.lock();
+    while (!m_done && !m_cancelled)
+    {
+        if (timeoutMsecs < 0)
+        {
+            m_waitCondition.wait(&m_mutex);
+            continue;
+        }
+
+        qint64 remaining = timeoutMsecs - timer.elapsed();
+        if (remaining <= 0)
+        {
+            break;
+        }
+        m_waitCondition.wait(&m_mutex, static_cast<unsigned long>(remaining));
+    }
+
+    if (m_done)
+    {
+        rc = m_rc;
+        if (outArgs)
+        {
+            *outArgs = m_outArgs;
+        }
+    }
+    else if (m_cancelled)
+    {
+        rc = UpnpInvocationAborted;
+    }
+    m_mutex.unlock();
+
+    if (token)
+    {
+        // the waiter is not locked here, since HCancelToken::cancel() locks the
+        // token before it locks the waiters
+        QMutexLocker lock(&token->h_ptr->m_mutex);
+        token->h_ptr->m_waiters.removeAll(this);
+    }
+
+    return rc;
+}
+
+/*******************************************************************************
+ * HSyncInvocation
+ ******************************************************************************/
+HSyncInvocation::HSyncInvocation(
+    HClientAction* action, const HActionArguments& inArgs,
+    const QSharedPointer<HSyncInvokeWaiter>& waiter) :
+        QObject(),
+            m_action(action), m_inArgs(inArgs), m_waiter(waiter),
+            m_op(), m_done(false)
+{
+    Q_ASSERT(action);
+    bool ok = connect(
+        action, SIGNAL(destroyed()), this, SLOT(actionDestroyed()));
+    Q_ASSERT(ok); Q_UNUSED(ok)
+
+    moveToThread(action->thread());
+}
+
+HSyncInvocation::~HSyncInvocation()
+{
+}
+
+bool HSyncInvocation::invocationDone(
+    HClientAction*, const HClientActionOp& op)
+{
+    m_done = true;
+    m_waiter->complete(op.returnValue(), op.outputArguments());
+    return false;
+}
+
+void HSyncInvocation::actionDestroyed()
+{
+    if (!m_done)
+    {
+        m_done = true;
+        m_waiter->complete(UpnpUndefinedFailure, HActionArguments());
+    }
+}
+
+void HSyncInvocation::start()
+{
+    if (!m_action)
+    {
+        actionDestroyed();
+        return;
+    }
+
+    m_op = m_action->beginInvoke(
+        m_inArgs,
+        HActionInvokeCallback(this, &HSyncInvocation::invocationDone));
+
+    if (!m_done && m_op.returnValue() != UpnpInvocationInProgress)
+    {
+        // the invocation could not be dispatched
+        m_done = true;
+        m_waiter->complete(m_op.returnValue(), HActionArguments());
+    }
+}
+
+void HSyncInvocation::release()
+{
+    if (!m_done && m_action)
+    {
+        // the waiting thread gave up on the invocation due to the deadline
+        // or the cancel token. it is aborted to free the invocation channel
+        // of the device for the invocations that are still waited for
+        m_done = true;
+        m_op.abort();
+    }
+    deleteLater();
+}
+
 /*******************************************************************************
  * HClientAction
  ******************************************************************************/
@@ -424,10 +753,16 @@ HClientAction::HClientAction(const HActionInfo& info, HClientService* parent) :
 
     h_ptr->m_info.reset(new HActionInfo(info));
     h_ptr->q_ptr = this;
+
+    HMemoryAccount::get(HMemoryAccount::ClientDeviceModel)->add(
+        sizeof(HClientAction) + sizeof(HClientActionPrivate));
 }
 
 HClientAction::~HClientAction()
 {
+    HMemoryAccount::get(HMemoryAccount::ClientDeviceModel)->remove(
+        sizeof(HClientAction) + sizeof(HClientActionPrivate));
+
     delete h_ptr;
 }
 
@@ -451,31 +786,67 @@ HClientActionOp HClientAction::beginInvoke(
     const HActionArguments& inArgs, const HActionInvokeCallback& cb,
     HExecArgs* execArgs)
 {
-    HInvocationInfo inv(inArgs, cb, execArgs ? *execArgs : HExecArgs());
-    inv.m_invokeId.setRunner(h_ptr);
-    h_ptr->m_invocations.enqueue(inv);
+    HInvocationInfo* inv = h_ptr->newInvocation(
+        inArgs, cb, execArgs ? *execArgs : HExecArgs());
+    h_ptr->m_invocations.append(inv);
 
     if (!h_ptr->m_proxy->invocationInProgress())
     {
-        h_ptr->m_proxy->setInputArgs(inArgs);
-        if (!h_ptr->m_proxy->send())
+        if (!h_ptr->m_proxy->send(inArgs))
         {
+            // the invocation was never sent and it will not complete
+            h_ptr->recycle(h_ptr->m_invocations.takeLast());
             return HClientActionOp(UpnpActionFailed, "Failed to dispatch action invocation");
         }
     }
 
-    inv.m_invokeId.setReturnValue(UpnpInvocationInProgress);
-    return inv.m_invokeId;
+    inv->m_invokeId.setReturnValue(UpnpInvocationInProgress);
+    return inv->m_invokeId;
+}
+
+qint32 HClientAction::invoke(
+    const HActionArguments& inArgs, HActionArguments* outArgs,
+    qint32 timeoutMsecs, const HCancelToken* cancelToken)
+{
+    HLOG2(H_AT, H_FUN, h_ptr->m_loggingIdentifier);
+
+    if (QThread::currentThread() == thread())
+    {
+        HLOG_WARN(QString(
+            "Cannot invoke action [%1] synchronously from the thread of the "
+            "action, since the invocation is run in that thread").arg(
+                info().name()));
+
+        return UpnpUndefinedFailure;
+    }
+
+    QSharedPointer<HSyncInvokeWaiter> waiter(new HSyncInvokeWaiter());
+
+    HSyncInvocation* invocation = new HSyncInvocation(this, inArgs, waiter);
+    bool ok = QMetaObject::invokeMethod(
+        invocation, "start", Qt::QueuedConnection);
+    Q_ASSERT(ok);
+
+    qint32 rc = waiter->wait(timeoutMsecs, cancelToken, outArgs);
+
+    // the invocation object is always released in the thread of the action,
+    // where it aborts the invocation in case it has not completed
+    ok = QMetaObject::invokeMethod(
+        invocation, "release", Qt::QueuedConnection);
+    Q_ASSERT(ok); Q_UNUSED(ok)
+
+    return rc;
 }
 
 /*******************************************************************************
  * HDefaultClientAction
  ******************************************************************************/
 HDefaultClientAction::HDefaultClientAction(
-    const HActionInfo& info, HDefaultClientService* parent, QNetworkAccessManager& nam) :
+    const HActionInfo& info, HDefaultClientService* parent,
+    HInvocationChannel& channel) :
         HClientAction(info, parent)
 {
-    h_ptr->m_proxy = new HActionProxy(nam, this);
+    h_ptr->m_proxy = new HActionProxy(channel, this);
 }
 
 const QByteArray& HDefaultClientAction::loggingIdentifier() const
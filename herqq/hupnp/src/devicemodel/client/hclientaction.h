@@ -174,6 +174,46 @@ public:
         const HActionInvokeCallback& completionCallback,
         HExecArgs* execArgs = 0);
 
+    /*!
+     * Invokes the action synchronously.
+     *
+     * The method blocks the calling thread until the invocation completes,
+     * the specified deadline passes or the specified token is cancelled.
+     * The invocation itself is run in the thread of the action in the same
+     * way as an invocation started with beginInvoke(), which is why the
+     * method does not run an event loop in the calling thread and which
+     * is why the method cannot be called from the thread of the action.
+     *
+     * No invokeComplete() signal is emitted for a synchronous invocation.
+     *
+     * \param inArgs specifies the input arguments for the action invocation.
+     *
+     * \param outArgs specifies a pointer to an object that receives the
+     * output arguments of the action invocation. This is optional.
+     *
+     * \param timeoutMsecs specifies the number of milliseconds the invocation
+     * may take before the method gives up on it. A negative value means that
+     * the method waits until the invocation completes.
+     *
+     * \param cancelToken specifies a token that can be used to cancel the
+     * invocation from any thread. This is optional.
+     *
+     * \return the UPnP return code of the invocation, which is \c UpnpSuccess
+     * in case the invocation succeeded. \c UpnpInvocationTimedOut is returned
+     * in case the deadline passed and \c UpnpInvocationAborted is returned in
+     * case the token was cancelled. In both cases the invocation is aborted.
+     * \c UpnpUndefinedFailure is returned in case the method was called from
+     * the thread of the action.
+     *
+     * \sa beginInvoke(), HCancelToken
+     *
+     * \remarks This method is thread-safe, but the thread of the action has
+     * to run an event loop for the invocation to proceed.
+     */
+    qint32 invoke(
+        const HActionArguments& inArgs, HActionArguments* outArgs = 0,
+        qint32 timeoutMsecs = -1, const HCancelToken* cancelToken = 0);
+
 Q_SIGNALS:
 
     /*!
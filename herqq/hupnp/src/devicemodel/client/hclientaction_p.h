@@ -40,9 +40,13 @@
 #include <QtCore/QUrl>
 #include <QtCore/QQueue>
 #include <QtCore/QString>
+#include <QtCore/QMutex>
 #include <QtCore/QPointer>
+#include <QtCore/QWaitCondition>
+#include <QtCore/QSharedPointer>
 #include <QtCore/QScopedPointer>
 #include <QtNetwork/QNetworkReply>
+#include <QtNetwork/QNetworkRequest>
 #include <QtNetwork/QNetworkAccessManager>
 
 namespace Herqq
@@ -51,7 +55,9 @@ namespace Herqq
 namespace Upnp
 {
 
+class HCancelToken;
 class HInvocationInfo;
+class HInvocationChannel;
 class HDefaultClientAction;
 
 //
@@ -73,12 +79,20 @@ private:
     // the device locations and the index the next connection attempt should try
     // these are the places to which the action invocation requests are sent
 
-    QNetworkAccessManager& m_nam;
+    HInvocationChannel& m_channel;
     QPointer<QNetworkReply> m_reply;
 
     HDefaultClientAction* m_owner;
 
-    HActionArguments m_inArgs;
+    QByteArray m_soapMsg;
+    bool m_queued;
+    // the SOAP message of the current invocation and whether it is waiting
+    // in the invocation channel of the device
+
+    quint32 m_requestId;
+    qint64 m_traceStart;
+    // the request id of the current invocation in the structured tracing and
+    // the time the invocation was posted, or -1 when it is not traced
 
 private:
 
@@ -93,18 +107,64 @@ private slots:
 
 public:
 
-    HActionProxy(QNetworkAccessManager&, HDefaultClientAction* owner);
+    HActionProxy(HInvocationChannel&, HDefaultClientAction* owner);
     virtual ~HActionProxy();
 
-    bool send();
+    // serializes the input arguments and queues the invocation into the
+    // invocation channel
+    bool send(const HActionArguments& inArgs);
+
+    // posts the invocation to the current location of the device. called by
+    // the invocation channel once the invocation is allowed to proceed
+    void post();
+
     void abort();
 
-    inline void setInputArgs(const HActionArguments& inArgs)
-    {
-        m_inArgs = inArgs;
-    }
+    inline bool invocationInProgress() const { return m_queued || m_reply; }
+};
+
+//
+// The channel through which the actions of a device tree are invoked
+//
+// The invocations of every action of every service of a device tree are
+// queued into the channel of the root device, which posts them in the order
+// they were queued. At most a configured number of invocations are in
+// progress at a time, which keeps QNetworkAccessManager running them over the
+// same persistent connections to the device. With a limit of one, the device
+// receives and completes the invocations in the order they were made.
+//
+class HInvocationChannel :
+    public QObject
+{
+Q_OBJECT
+H_DISABLE_COPY(HInvocationChannel)
+
+private:
+
+    QNetworkAccessManager& m_nam;
+
+    qint32 m_maxParallel;
+    // zero means that the number of invocations in progress is not limited
 
-    inline bool invocationInProgress() const { return m_reply; }
+    QQueue<QPointer<HActionProxy> > m_queued;
+    QList<QPointer<HActionProxy> > m_inProgress;
+
+    void dispatch();
+
+public:
+
+    HInvocationChannel(QNetworkAccessManager&, qint32 maxParallel);
+    virtual ~HInvocationChannel();
+
+    inline QNetworkAccessManager& nam() const { return m_nam; }
+
+    // queues an invocation of the proxy, which is posted once the number of
+    // invocations in progress allows it
+    void enqueue(HActionProxy*);
+
+    // removes the invocation of the proxy from the channel, whether it is
+    // queued or in progress
+    void remove(HActionProxy*);
 };
 
 //
@@ -129,13 +189,31 @@ public:
     QScopedPointer<HActionInfo> m_info;
 
     HActionProxy* m_proxy;
-    QQueue<HInvocationInfo> m_invocations;
+
+    QList<HInvocationInfo*> m_invocations;
+    // the invocations in the order they were made. the first one is in
+    // progress, unless the proxy failed to send it
+
+    QList<HInvocationInfo*> m_freeInvocations;
+    // the objects of completed invocations, which are reused by the next
+    // invocations
+
+    enum
+    {
+        MaxFreeInvocations = 8
+    };
+
+    void recycle(HInvocationInfo*);
 
 public:
 
     HClientActionPrivate();
     ~HClientActionPrivate();
 
+    HInvocationInfo* newInvocation(
+        const HActionArguments& inArgs, const HActionInvokeCallback&,
+        const HExecArgs&);
+
     bool setInfo(const HActionInfo&);
     void abort(unsigned int id);
 };
@@ -154,32 +232,124 @@ public:
 };
 
 //
+// A pending invocation of an action
 //
+// The input arguments of the invocation are stored only in the operation
+// object, which is returned to the user as well.
 //
 class HInvocationInfo
 {
+H_DISABLE_COPY(HInvocationInfo)
 
 public:
 
     HActionInvokeCallback callback;
     HExecArgs execArgs;
 
-    HActionArguments m_inArgs;
     HClientActionOp_ m_invokeId;
 
-    inline HInvocationInfo() : callback(), execArgs(), m_inArgs(), m_invokeId() { }
+    inline HInvocationInfo() : callback(), execArgs(), m_invokeId() { }
     inline ~HInvocationInfo() { }
 
-    inline HInvocationInfo(
+    inline void set(
         const HActionArguments& inArgs,
         const HActionInvokeCallback& cb,
-        const HExecArgs& eargs) :
-            callback(cb),
-            execArgs(eargs),
-            m_inArgs(inArgs),
-            m_invokeId(inArgs)
+        const HExecArgs& eargs)
     {
+        callback = cb;
+        execArgs = eargs;
+        m_invokeId = HClientActionOp_(inArgs);
     }
+
+    inline const HActionArguments& inputArguments() const
+    {
+        return m_invokeId.inputArguments();
+    }
+};
+
+//
+// The object a thread blocks on while a synchronous action invocation is run
+// in the thread of the action
+//
+// The waiter is shared by the blocked thread and the HSyncInvocation running
+// the invocation, since either of them may be the last one to need it. The
+// blocked thread does not run an event loop; it sleeps on a wait condition
+// until the invocation completes, the deadline passes or a cancel token
+// the waiter is registered to is cancelled.
+//
+class HSyncInvokeWaiter
+{
+H_DISABLE_COPY(HSyncInvokeWaiter)
+
+private:
+
+    QMutex m_mutex;
+    QWaitCondition m_waitCondition;
+
+    bool m_done;
+    bool m_cancelled;
+
+    qint32 m_rc;
+    HActionArguments m_outArgs;
+
+public:
+
+    HSyncInvokeWaiter();
+
+    // called in the thread of the action once the invocation is complete
+    void complete(qint32 rc, const HActionArguments& outArgs);
+
+    // called by HCancelToken from any thread
+    void cancel();
+
+    // blocks the calling thread until the invocation is complete, the timeout
+    // elapses or the token is cancelled. a negative timeout means no deadline
+    qint32 wait(
+        qint32 timeoutMsecs, const HCancelToken*, HActionArguments* outArgs);
+};
+
+//
+// Runs a single synchronous action invocation in the thread of the action
+//
+// An instance is created by the blocked thread and moved to the thread of the
+// action, where the invocation is started and where the instance is released
+// once the blocked thread no longer waits for it. An invocation that has not
+// completed by the time it is released is aborted.
+//
+class HSyncInvocation :
+    public QObject
+{
+Q_OBJECT
+H_DISABLE_COPY(HSyncInvocation)
+
+private:
+
+    QPointer<HClientAction> m_action;
+    HActionArguments m_inArgs;
+
+    QSharedPointer<HSyncInvokeWaiter> m_waiter;
+
+    HClientActionOp m_op;
+    bool m_done;
+
+    bool invocationDone(HClientAction*, const HClientActionOp&);
+
+private Q_SLOTS:
+
+    void actionDestroyed();
+
+public:
+
+    HSyncInvocation(
+        HClientAction*, const HActionArguments& inArgs,
+        const QSharedPointer<HSyncInvokeWaiter>&);
+
+    virtual ~HSyncInvocation();
+
+public Q_SLOTS:
+
+    void start();
+    void release();
 };
 
 }
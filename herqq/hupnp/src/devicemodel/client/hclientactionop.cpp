@@ -26,12 +26,42 @@
 #include "../hasyncop.h"
 #include "../hactionarguments.h"
 
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+
 namespace Herqq
 {
 
 namespace Upnp
 {
 
+namespace
+{
+class HClientActionOpPool
+{
+H_DISABLE_COPY(HClientActionOpPool)
+
+public:
+
+    enum
+    {
+        MaxFreeObjects = 32
+    };
+
+    QMutex m_mutex;
+    QList<HClientActionOpPrivate*> m_free;
+
+    HClientActionOpPool() : m_mutex(), m_free() { }
+    ~HClientActionOpPool() { qDeleteAll(m_free); }
+};
+
+HClientActionOpPool* opPool()
+{
+    static HClientActionOpPool pool;
+    return &pool;
+}
+}
+
 /*******************************************************************************
  * HClientActionOpPrivate
  *******************************************************************************/
@@ -45,22 +75,72 @@ HClientActionOpPrivate::~HClientActionOpPrivate()
 {
 }
 
+HClientActionOpPrivate* HClientActionOpPrivate::create()
+{
+    HClientActionOpPool* pool = opPool();
+
+    HClientActionOpPrivate* retVal = 0;
+    {
+        QMutexLocker lock(&pool->m_mutex);
+        if (!pool->m_free.isEmpty())
+        {
+            retVal = pool->m_free.takeLast();
+        }
+    }
+
+    if (!retVal)
+    {
+        return new HClientActionOpPrivate();
+    }
+
+    retVal->reset(genId());
+    return retVal;
+}
+
+void HClientActionOpPrivate::release()
+{
+    // the arguments are cleared here so that the pool does not keep the
+    // values of completed invocations alive
+    if (!m_inArgs.isEmpty())
+    {
+        m_inArgs.clear();
+    }
+    if (!m_outArgs.isEmpty())
+    {
+        m_outArgs.clear();
+    }
+    m_runner = 0;
+
+    HClientActionOpPool* pool = opPool();
+
+    QMutexLocker lock(&pool->m_mutex);
+    if (pool->m_free.size() < HClientActionOpPool::MaxFreeObjects)
+    {
+        pool->m_free.append(this);
+        return;
+    }
+    lock.unlock();
+
+    delete this;
+}
+
 /*******************************************************************************
  * HClientActionOp
  *******************************************************************************/
 HClientActionOp::HClientActionOp() :
-    HAsyncOp(*new HClientActionOpPrivate())
+    HAsyncOp(*HClientActionOpPrivate::create())
 {
 }
 
 HClientActionOp::HClientActionOp(
     qint32 returnCode, const QString& errorDescription) :
-        HAsyncOp(returnCode, errorDescription, *new HClientActionOpPrivate())
+        HAsyncOp(
+            returnCode, errorDescription, *HClientActionOpPrivate::create())
 {
 }
 
 HClientActionOp::HClientActionOp(const HActionArguments& inArgs) :
-    HAsyncOp(*new HClientActionOpPrivate())
+    HAsyncOp(*HClientActionOpPrivate::create())
 {
     H_D(HClientActionOp);
     h->m_inArgs = inArgs;
@@ -43,9 +43,21 @@ namespace Upnp
 
 class HClientActionPrivate;
 
+//
+// Implementation details of HClientActionOp
+//
+// The objects of completed operations are kept in a pool shared by all
+// actions and reused by the next operations. An operation is started in the
+// thread of its action, but the last copy of it may be destroyed in any
+// thread.
+//
 class HClientActionOpPrivate :
     public HAsyncOpPrivate
 {
+private:
+
+    HClientActionOpPrivate();
+
 public:
 
     HActionArguments m_inArgs, m_outArgs;
@@ -53,8 +65,14 @@ public:
 
 public:
 
-    HClientActionOpPrivate();
     virtual ~HClientActionOpPrivate();
+
+    // returns an object for a new operation, which is taken from the pool
+    // when there is one available
+    static HClientActionOpPrivate* create();
+
+    // returns the object to the pool if the pool is not full
+    virtual void release();
 };
 
 }
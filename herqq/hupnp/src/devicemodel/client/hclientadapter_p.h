@@ -139,6 +139,7 @@ public:
                 retVal.setReturnValue(op.returnValue());
                 retVal.setErrorDescription(op.errorDescription());
                 remove(i);
+                retVal.runContinuations();
                 break;
             }
         }
@@ -156,6 +157,7 @@ public:
                 retVal.setReturnValue(op.returnValue());
                 retVal.setErrorDescription(op.errorDescription());
                 remove(i);
+                retVal.runContinuations();
                 break;
             }
         }
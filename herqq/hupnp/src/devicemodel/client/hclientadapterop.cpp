@@ -22,6 +22,8 @@
 #include "hclientadapterop.h"
 #include "../hasyncop_p.h"
 
+#include <QtCore/QList>
+
 namespace Herqq
 {
 
@@ -33,8 +35,13 @@ class HAbstractClientAdapterOpPrivate :
 {
 public:
 
+    QList<HClientAdapterOpContinuation> m_continuations;
+    // the rest of the chain, in the order the continuations are called
+
+    HClientAdapterOpFailureCallback m_onFailure;
+
     HAbstractClientAdapterOpPrivate() :
-        HAsyncOpPrivate(genId())
+        HAsyncOpPrivate(genId()), m_continuations(), m_onFailure()
     {
     }
 };
@@ -62,5 +69,80 @@ HAbstractClientAdapterOp& HAbstractClientAdapterOp::operator=(
     return static_cast<HAbstractClientAdapterOp&>(HAsyncOp::operator=(other));
 }
 
+void HAbstractClientAdapterOp::runContinuations()
+{
+    HAbstractClientAdapterOpPrivate* h =
+        static_cast<HAbstractClientAdapterOpPrivate*>(h_ptr);
+
+    if (h->m_continuations.isEmpty() && !h->m_onFailure)
+    {
+        return;
+    }
+
+    // the chain is detached first, as a continuation can add continuations
+    // to the operation it starts
+    QList<HClientAdapterOpContinuation> continuations = h->m_continuations;
+    HClientAdapterOpFailureCallback onFailure = h->m_onFailure;
+    h->m_continuations.clear();
+    h->m_onFailure = HClientAdapterOpFailureCallback();
+
+    HAbstractClientAdapterOp current = *this;
+    while(current.returnValue() == UpnpSuccess && !continuations.isEmpty())
+    {
+        HAbstractClientAdapterOp next = continuations.takeFirst()(current);
+        if (next.returnValue() == UpnpInvocationInProgress)
+        {
+            // the rest of the chain runs once the next operation completes
+            HAbstractClientAdapterOpPrivate* nh =
+                static_cast<HAbstractClientAdapterOpPrivate*>(next.h_ptr);
+
+            nh->m_continuations.append(continuations);
+            if (!nh->m_onFailure)
+            {
+                nh->m_onFailure = onFailure;
+            }
+            return;
+        }
+        current = next;
+    }
+
+    if (current.returnValue() != UpnpSuccess && onFailure)
+    {
+        onFailure(current);
+    }
+}
+
+HAbstractClientAdapterOp& HAbstractClientAdapterOp::then(
+    const HClientAdapterOpContinuation& continuation)
+{
+    HAbstractClientAdapterOpPrivate* h =
+        static_cast<HAbstractClientAdapterOpPrivate*>(h_ptr);
+
+    h->m_continuations.append(continuation);
+
+    if (returnValue() != UpnpInvocationInProgress)
+    {
+        runContinuations();
+    }
+
+    return *this;
+}
+
+HAbstractClientAdapterOp& HAbstractClientAdapterOp::otherwise(
+    const HClientAdapterOpFailureCallback& callback)
+{
+    HAbstractClientAdapterOpPrivate* h =
+        static_cast<HAbstractClientAdapterOpPrivate*>(h_ptr);
+
+    h->m_onFailure = callback;
+
+    if (returnValue() != UpnpInvocationInProgress)
+    {
+        runContinuations();
+    }
+
+    return *this;
+}
+
 }
 }
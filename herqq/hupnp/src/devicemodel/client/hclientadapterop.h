@@ -23,6 +23,7 @@
 #define HCLIENTADAPTER_OP_H_
 
 #include <HUpnpCore/HAsyncOp>
+#include <HUpnpCore/HFunctor>
 #include <QtCore/QExplicitlySharedDataPointer>
 
 namespace Herqq
@@ -53,8 +54,64 @@ class HClientAdapterOp;
  */
 typedef HClientAdapterOp<HNullValue> HClientAdapterOpNull;
 
+class HAbstractClientAdapterOp;
 class HAbstractClientAdapterOpPrivate;
 
+/*!
+ * This is a type definition for a <em>callable entity</em> that continues
+ * a chain of \e Client \e Adapter operations.
+ *
+ * You can create \c %HClientAdapterOpContinuation objects using normal
+ * functions, functors and member functions that follow the signature of
+ *
+ * <tt>
+ *
+ * Herqq::Upnp::HAbstractClientAdapterOp function(
+ *     const Herqq::Upnp::HAbstractClientAdapterOp&);
+ *
+ * </tt>
+ *
+ * <h3>Parameters</h3>
+ * \li The parameter is the operation that completed successfully. You can
+ * cast it to the concrete operation type to access its value.
+ *
+ * <h3>Return value</h3>
+ * The return value is the operation started by the continuation, such as
+ * the return value of HAvTransportAdapter::play(). The rest of the chain
+ * continues once that operation completes.
+ *
+ * \headerfile hclientadapterop.h HClientAdapterOpContinuation
+ *
+ * \ingroup hupnp_devicemodel
+ *
+ * \sa HAbstractClientAdapterOp::then()
+ */
+typedef Functor<HAbstractClientAdapterOp, H_TYPELIST_1(
+    const HAbstractClientAdapterOp&)> HClientAdapterOpContinuation;
+
+/*!
+ * This is a type definition for a <em>callable entity</em> that is called
+ * when an operation of a chain of \e Client \e Adapter operations fails.
+ *
+ * The signature of the callable entity is
+ *
+ * <tt>
+ *
+ * void function(const Herqq::Upnp::HAbstractClientAdapterOp&);
+ *
+ * </tt>
+ *
+ * The parameter is the operation that failed.
+ *
+ * \headerfile hclientadapterop.h HClientAdapterOpFailureCallback
+ *
+ * \ingroup hupnp_devicemodel
+ *
+ * \sa HAbstractClientAdapterOp::otherwise()
+ */
+typedef Functor<void, H_TYPELIST_1(
+    const HAbstractClientAdapterOp&)> HClientAdapterOpFailureCallback;
+
 /*!
  * This is an abstract base class for classes used to identify \e Client \e Adapter
  * operations.
@@ -63,6 +120,46 @@ class HAbstractClientAdapterOpPrivate;
  *
  * \ingroup hupnp_devicemodel
  *
+ * \section chaining Chaining operations
+ *
+ * An operation can be followed by other operations using then(). Each
+ * continuation is called as soon as the operation before it has completed
+ * successfully, right after the response of the action invocation has been
+ * parsed and before the completion signal of the adapter is emitted. Since
+ * the next invocation is sent without waiting for the event loop, the device
+ * receives the requests of the chain back to back over the connection the
+ * control point keeps open to it:
+ *
+ * \code
+ *
+ * HAbstractClientAdapterOp MyPlayer::play(const HAbstractClientAdapterOp&)
+ * {
+ *     return m_transport->play("1");
+ * }
+ *
+ * HAbstractClientAdapterOp MyPlayer::getTransportInfo(
+ *     const HAbstractClientAdapterOp&)
+ * {
+ *     return m_transport->getTransportInfo();
+ * }
+ *
+ * void MyPlayer::start(const QUrl& uri)
+ * {
+ *     typedef HClientAdapterOpContinuation Next;
+ *
+ *     m_transport->setAVTransportURI(uri, QString()).
+ *         then(Next(this, &MyPlayer::play)).
+ *         then(Next(this, &MyPlayer::getTransportInfo)).
+ *         otherwise(HClientAdapterOpFailureCallback(this, &MyPlayer::failed));
+ * }
+ *
+ * \endcode
+ *
+ * If an operation of the chain fails, the rest of the continuations are not
+ * called and the failure callback set with otherwise() is called instead.
+ * The completion signals of the adapters are emitted as usual for every
+ * operation of the chain.
+ *
  * \sa HClientDeviceAdapter, HClientServiceAdapter
  *
  * \remarks This class is not thread-safe.
@@ -70,6 +167,12 @@ class HAbstractClientAdapterOpPrivate;
 class H_UPNP_CORE_EXPORT HAbstractClientAdapterOp :
     public HAsyncOp
 {
+friend class HAbstractClientAdapterPrivate;
+
+private:
+
+    void runContinuations();
+
 protected:
 
     /*!
@@ -90,10 +193,14 @@ protected:
      */
     HAbstractClientAdapterOp(qint32 returnCode, const QString& errorDescription);
 
+public:
+
     /*!
      * \brief Copy constructor.
      *
-     * Copies the contents of the \c other to this.
+     * Copies the contents of the \c other to this. The copy refers to the
+     * same operation, but it does not have access to the return value of
+     * a concrete operation type.
      */
     HAbstractClientAdapterOp(const HAbstractClientAdapterOp&);
 
@@ -103,6 +210,45 @@ protected:
      * \return reference to this object.
      */
     HAbstractClientAdapterOp& operator=(const HAbstractClientAdapterOp&);
+
+    /*!
+     * \brief Specifies a continuation to be called once the operation and
+     * the continuations specified before this one have completed successfully.
+     *
+     * \param continuation specifies the callable entity that starts the
+     * next operation of the chain.
+     *
+     * \return reference to this object.
+     *
+     * \remarks
+     * \li If the operation has already completed, the continuation is called
+     * before this method returns, or it is discarded in case the operation
+     * failed.
+     * \li The continuation is called only if the operation completes through
+     * an action invocation of a service adapter. It does not delay the
+     * completion signal of the adapter, but it must not delete the adapter.
+     *
+     * \sa otherwise()
+     */
+    HAbstractClientAdapterOp& then(
+        const HClientAdapterOpContinuation& continuation);
+
+    /*!
+     * \brief Specifies a callable entity to be called if the operation or
+     * any of the operations started by its continuations fails.
+     *
+     * \param callback specifies the callable entity that handles the
+     * failure. It replaces the one specified previously, if any.
+     *
+     * \return reference to this object.
+     *
+     * \remarks If the operation has already failed, the callback is called
+     * before this method returns.
+     *
+     * \sa then()
+     */
+    HAbstractClientAdapterOp& otherwise(
+        const HClientAdapterOpFailureCallback& callback);
 };
 
 /*!
@@ -0,0 +1,113 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "hclientbatchop.h"
+#include "hclientbatchop_p.h"
+#include "hclientservice_p.h"
+
+#include "../hasyncop.h"
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+/*******************************************************************************
+ * HClientBatchOpPrivate
+ *******************************************************************************/
+HClientBatchOpPrivate::HClientBatchOpPrivate() :
+    HAsyncOpPrivate(HAsyncOpPrivate::genId()),
+        m_operations(), m_runner(0)
+{
+}
+
+HClientBatchOpPrivate::~HClientBatchOpPrivate()
+{
+}
+
+/*******************************************************************************
+ * HClientBatchOp
+ *******************************************************************************/
+HClientBatchOp::HClientBatchOp() :
+    HAsyncOp(*new HClientBatchOpPrivate())
+{
+}
+
+HClientBatchOp::HClientBatchOp(
+    qint32 returnCode, const QString& errorDescription) :
+        HAsyncOp(returnCode, errorDescription, *new HClientBatchOpPrivate())
+{
+}
+
+HClientBatchOp::HClientBatchOp(const HClientBatchOp& other) :
+    HAsyncOp(other)
+{
+}
+
+HClientBatchOp::~HClientBatchOp()
+{
+}
+
+void HClientBatchOp::abort()
+{
+    H_D(HClientBatchOp);
+    if (h->m_runner)
+    {
+        h->m_runner->abort();
+    }
+}
+
+HClientBatchOp& HClientBatchOp::operator=(const HClientBatchOp& other)
+{
+    Q_ASSERT(&other != this);
+    HAsyncOp::operator=(other);
+    return *this;
+}
+
+const QList<HClientActionOp>& HClientBatchOp::operations() const
+{
+    const H_D(HClientBatchOp);
+    return h->m_operations;
+}
+
+/*******************************************************************************
+ * HClientBatchOp_
+ *******************************************************************************/
+HClientBatchOp_::HClientBatchOp_()
+{
+}
+
+void HClientBatchOp_::setRunner(HClientBatchRunner* runner)
+{
+    H_D(HClientBatchOp);
+    h->m_runner = runner;
+}
+
+void HClientBatchOp_::setOperations(const QList<HClientActionOp>& operations)
+{
+    H_D(HClientBatchOp);
+    h->m_operations = operations;
+}
+
+}
+}
@@ -0,0 +1,122 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef HCLIENTBATCH_OP_H_
+#define HCLIENTBATCH_OP_H_
+
+#include <HUpnpCore/HAsyncOp>
+
+#include <QtCore/QList>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+class HClientBatchOpPrivate;
+
+/*!
+ * \brief This class is used to identify a batch of client-side action
+ * invocations and the results of them.
+ *
+ * When you call HClientService::beginInvokeBatch() you get an instance of
+ * this class that uniquely identifies the batch within the running process.
+ * Once every invocation of the batch has completed, the
+ * HClientService::batchInvokeComplete() signal is sent with a copy of the
+ * instance. You can call operations() to get an HClientActionOp for each
+ * invocation of the batch, which contains the UPnP return code and the output
+ * arguments of the invocation.
+ *
+ * \headerfile hclientbatchop.h HClientBatchOp
+ *
+ * \ingroup hupnp_devicemodel
+ *
+ * \sa HClientService, HClientActionOp, HAsyncOp
+ *
+ * \remarks This class is not thread-safe.
+ */
+class H_UPNP_CORE_EXPORT HClientBatchOp :
+    public HAsyncOp
+{
+H_DECLARE_PRIVATE(HClientBatchOp);
+
+public:
+
+    /*!
+     * \brief Creates a new instance.
+     */
+    HClientBatchOp();
+
+    /*!
+     * Creates a new invalid instance.
+     *
+     * \param returnCode specifies the return code.
+     *
+     * \param errorDescription specifies a human-readable description of the error
+     * that occurred.
+     */
+    HClientBatchOp(qint32 returnCode, const QString& errorDescription);
+
+    /*!
+     * \brief Copy constructor.
+     *
+     * Copies the contents of the \c other to this.
+     */
+    HClientBatchOp(const HClientBatchOp&);
+
+    /*!
+     * \brief Destroys the instance.
+     */
+    virtual ~HClientBatchOp();
+
+    /*!
+     * \brief Aborts every invocation of the batch that has not completed.
+     *
+     * The HClientService::batchInvokeComplete() signal is sent immediately
+     * and the return value of the batch is set to \c UpnpInvocationAborted.
+     */
+    virtual void abort();
+
+    /*!
+     * \brief Assigns the contents of the other object to this.
+     *
+     * \return reference to this object.
+     */
+    HClientBatchOp& operator=(const HClientBatchOp&);
+
+    /*!
+     * \brief Returns the invocations of the batch.
+     *
+     * \return The invocations of the batch in the order they were specified
+     * to HClientService::beginInvokeBatch().
+     *
+     * \remarks Do not abort the returned operations individually.
+     * Use abort() instead.
+     */
+    const QList<HClientActionOp>& operations() const;
+};
+
+}
+}
+
+#endif /* HCLIENTBATCH_OP_H_ */
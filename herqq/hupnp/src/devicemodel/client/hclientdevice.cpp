@@ -23,7 +23,9 @@
 #include "hclientdevice_p.h"
 #include "hdefault_clientdevice_p.h"
 #include "hdefault_clientservice_p.h"
+#include "hclientaction_p.h"
 
+#include "../../general/hmemoryaccount_p.h"
 #include "../../general/hlogger_p.h"
 #include "../../general/hupnp_global_p.h"
 
@@ -31,7 +33,8 @@
 #include "../../dataelements/hdeviceinfo.h"
 #include "../../dataelements/hserviceinfo.h"
 
-#include <QtCore/QTimer>
+#include "../../devicehosting/controlpoint/hicon_cache_p.h"
+
 #include <QtCore/QString>
 
 namespace Herqq
@@ -55,10 +58,16 @@ HClientDevice::HClientDevice(
     h_ptr->m_parentDevice = parentDev;
     h_ptr->m_deviceInfo.reset(new HDeviceInfo(info));
     h_ptr->q_ptr = this;
+
+    HMemoryAccount::get(HMemoryAccount::ClientDeviceModel)->add(
+        sizeof(HClientDevice) + sizeof(HClientDevicePrivate));
 }
 
 HClientDevice::~HClientDevice()
 {
+    HMemoryAccount::get(HMemoryAccount::ClientDeviceModel)->remove(
+        sizeof(HClientDevice) + sizeof(HClientDevicePrivate));
+
     delete h_ptr;
 }
 
@@ -106,7 +115,13 @@ const HDeviceInfo& HClientDevice::info() const
 
 QString HClientDevice::description() const
 {
-    return h_ptr->m_deviceDescription;
+    if (h_ptr->m_parentDevice)
+    {
+        // the root device and the embedded devices share the description
+        return rootDevice()->description();
+    }
+
+    return h_ptr->m_deviceDescription.toString();
 }
 
 QList<QUrl> HClientDevice::locations(LocationUrlType urlType) const
@@ -128,29 +143,35 @@ QList<QUrl> HClientDevice::locations(LocationUrlType urlType) const
     return retVal;
 }
 
+bool HClientDevice::retrieveIcon(const QUrl& iconUrl)
+{
+    HDefaultClientDevice* device = qobject_cast<HDefaultClientDevice*>(this);
+    HIconRetriever* retriever = device ? device->iconRetriever() : 0;
+
+    return retriever ? retriever->retrieve(this, iconUrl) : false;
+}
+
 /*******************************************************************************
  * HDefaultClientDevice
  ******************************************************************************/
 HDefaultClientDevice::HDefaultClientDevice(
-    const QString& description,
+    const QByteArray& description,
     const QList<QUrl>& locations,
     const HDeviceInfo& info,
     qint32 deviceTimeoutInSecs,
     HDefaultClientDevice* parentDev) :
         HClientDevice(info, parentDev),
-            m_timedout(false),
-            m_statusNotifier(new QTimer(this)),
+            m_deviceTimeoutInSecs(deviceTimeoutInSecs),
             m_deviceStatus(new HDeviceStatus()),
-            m_configId(0)
+            m_configId(0),
+            m_invocationChannel(0),
+            m_iconRetriever(0)
 {
-    h_ptr->m_deviceDescription = description;
+    if (!parentDev)
+    {
+        h_ptr->m_deviceDescription = HDescriptionData(description);
+    }
     h_ptr->m_locations = locations;
-
-    m_statusNotifier->setInterval(deviceTimeoutInSecs * 1000);
-    bool ok = connect(
-        m_statusNotifier.data(), SIGNAL(timeout()), this, SLOT(timeout_()));
-
-    Q_ASSERT(ok); Q_UNUSED(ok)
 }
 
 void HDefaultClientDevice::setServices(
@@ -173,83 +194,47 @@ void HDefaultClientDevice::setEmbeddedDevices(
     }
 }
 
-quint32 HDefaultClientDevice::deviceTimeoutInSecs() const
+void HDefaultClientDevice::update(const HDefaultClientDevice& other)
 {
-    return m_statusNotifier->interval() / 1000;
+    Q_ASSERT(info().udn() == other.info().udn());
+
+    h_ptr->m_deviceInfo.reset(new HDeviceInfo(other.info()));
+    if (!parentDevice())
+    {
+        h_ptr->m_deviceDescription = other.h_ptr->m_deviceDescription;
+        m_configId = other.m_configId;
+    }
 }
 
-void HDefaultClientDevice::timeout_()
+void HDefaultClientDevice::setInvocationChannel(HInvocationChannel* channel)
 {
-    HLOG(H_AT, H_FUN);
-
-    m_timedout = true;
-    stopStatusNotifier(HDefaultClientDevice::ThisOnly);
+    Q_ASSERT(!parentDevice());
+    Q_ASSERT(!m_invocationChannel);
+    Q_ASSERT(channel);
 
-    emit statusTimeout(this);
+    m_invocationChannel = channel;
+    m_invocationChannel->setParent(this);
 }
 
-void HDefaultClientDevice::startStatusNotifier(SearchCriteria searchCriteria)
+void HDefaultClientDevice::setIconRetriever(HIconRetriever* retriever)
 {
-    HLOG(H_AT, H_FUN);
-
-    m_statusNotifier->start();
-    if (searchCriteria & Services)
-    {
-        // TODO
-    }
-    if (searchCriteria & EmbeddedDevices)
-    {
-        foreach(HClientDevice* dc, h_ptr->m_embeddedDevices)
-        {
-            static_cast<HDefaultClientDevice*>(dc)->startStatusNotifier(searchCriteria);
-        }
-    }
+    Q_ASSERT(!parentDevice());
+    Q_ASSERT(!m_iconRetriever);
+    Q_ASSERT(retriever);
 
-    m_timedout = false;
+    m_iconRetriever = retriever;
+    m_iconRetriever->setParent(this);
 }
 
-void HDefaultClientDevice::stopStatusNotifier(SearchCriteria searchCriteria)
+quint32 HDefaultClientDevice::deviceTimeoutInSecs() const
 {
-    HLOG(H_AT, H_FUN);
-
-    m_statusNotifier->stop();
-    if (searchCriteria & Services)
-    {
-        // TODO
-    }
-    if (searchCriteria & EmbeddedDevices)
-    {
-        foreach(HClientDevice* dc, h_ptr->m_embeddedDevices)
-        {
-            static_cast<HDefaultClientDevice*>(dc)->stopStatusNotifier(searchCriteria);
-        }
-    }
+    return m_deviceTimeoutInSecs;
 }
 
-bool HDefaultClientDevice::isTimedout(SearchCriteria searchCriteria) const
+void HDefaultClientDevice::timeout_()
 {
-    if (m_timedout)
-    {
-        return true;
-    }
-
-    if (searchCriteria & Services)
-    {
-        // TODO
-    }
-
-    if (searchCriteria & EmbeddedDevices)
-    {
-        foreach(HClientDevice* dc, h_ptr->m_embeddedDevices)
-        {
-            if (static_cast<HDefaultClientDevice*>(dc)->isTimedout(searchCriteria))
-            {
-                return true;
-            }
-        }
-    }
-
-    return false;
+    HLOG(H_AT, H_FUN);
+    emit statusTimeout(this);
 }
 
 namespace
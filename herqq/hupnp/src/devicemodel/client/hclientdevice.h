@@ -28,6 +28,7 @@
 
 class QUrl;
 class QString;
+class QByteArray;
 
 namespace Herqq
 {
@@ -63,6 +64,10 @@ class HClientDevicePrivate;
  * the device is an embedded device, it always has a parent device, which you can
  * get by calling parentDevice().
  *
+ * The icons listed in the device description are not retrieved when the
+ * device is built. You can retrieve an icon when you need it by calling
+ * retrieveIcon().
+ *
  * \headerfile hclientdevice.h HClientDevice
  *
  * \ingroup hupnp_devicemodel
@@ -75,6 +80,7 @@ class H_UPNP_CORE_EXPORT HClientDevice :
 Q_OBJECT
 H_DISABLE_COPY(HClientDevice)
 H_DECLARE_PRIVATE(HClientDevice)
+friend class HIconRetriever;
 
 protected:
 
@@ -224,6 +230,48 @@ public:
      * \return a list of locations where the device is currently available.
      */
     QList<QUrl> locations(LocationUrlType urlType=AbsoluteUrl) const;
+
+    /*!
+     * \brief Starts retrieving an icon of the device.
+     *
+     * The icon is retrieved asynchronously and iconRetrieved() is emitted
+     * once the retrieval has completed or failed. The icons retrieved by
+     * the devices of a control point are cached and an icon that is already
+     * cached is downloaded again only if the device reports that the icon
+     * has changed.
+     *
+     * \param iconUrl specifies the icon to retrieve. This has to be one of
+     * the URLs returned by HDeviceInfo::icons().
+     *
+     * \return \e true in case the retrieval was started. If the URL does not
+     * identify an icon of the device or the device is not connected to a
+     * control point, \e false is returned and the signal is not emitted.
+     *
+     * \sa iconRetrieved(), HDeviceInfo::icons()
+     */
+    bool retrieveIcon(const QUrl& iconUrl);
+
+Q_SIGNALS:
+
+    /*!
+     * \brief This signal is emitted when the retrieval of an icon started with
+     * retrieveIcon() has completed or failed.
+     *
+     * \param source specifies the device whose icon was retrieved.
+     *
+     * \param iconUrl specifies the icon, as it was given to retrieveIcon().
+     *
+     * \param ok specifies whether the icon was retrieved successfully.
+     *
+     * \param icon specifies the contents of the icon file, if \c ok is
+     * \e true.
+     *
+     * \remarks This signal has thread affinity to the thread where the object
+     * resides. Do not connect to this signal from other threads.
+     */
+    void iconRetrieved(
+        const Herqq::Upnp::HClientDevice* source, const QUrl& iconUrl,
+        bool ok, const QByteArray& icon);
 };
 
 }
@@ -51,7 +51,7 @@ H_DISABLE_COPY(HClientDevicePrivate)
 
 public:
 
-    HClientDevicePrivate(){}
+    HClientDevicePrivate() {}
     virtual ~HClientDevicePrivate(){}
 };
 
@@ -23,12 +23,16 @@
 #include "hclientservice_p.h"
 
 #include "hclientaction.h"
+#include "hclientactionop.h"
 #include "hdefault_clientdevice_p.h"
 #include "hdefault_clientservice_p.h"
 #include "hdefault_clientstatevariable_p.h"
 
+#include "../../general/hmemoryaccount_p.h"
 #include "../../dataelements/hactioninfo.h"
 
+#include <QtCore/QScopedPointer>
+
 namespace Herqq
 {
 
@@ -39,12 +43,104 @@ namespace Upnp
  * HClientServicePrivate
  ******************************************************************************/
 HClientServicePrivate::HClientServicePrivate() :
-    m_stateVariablesConst()
+    m_stateVariablesConst(), m_loader(0),
+        m_snapshot(new HClientStateSnapshot()), m_snapshotEpoch(0)
 {
 }
 
 HClientServicePrivate::~HClientServicePrivate()
 {
+    delete m_loader;
+    delete m_snapshot.fetchAndAddOrdered(0);
+    qDeleteAll(m_retiredSnapshots[0]);
+    qDeleteAll(m_retiredSnapshots[1]);
+}
+
+void HClientServicePrivate::publishSnapshot()
+{
+    HClientStateSnapshot* current = m_snapshot.fetchAndAddOrdered(0);
+
+    HClientStateSnapshot* snapshot = new HClientStateSnapshot();
+    snapshot->m_sequence = current->m_sequence + 1;
+
+    QHash<QString, HDefaultClientStateVariable*>::const_iterator ci =
+        m_stateVariables.constBegin();
+    for (; ci != m_stateVariables.constEnd(); ++ci)
+    {
+        snapshot->m_values.insert(ci.key(), ci.value()->value());
+    }
+
+    qint32 epoch = m_snapshotEpoch.fetchAndAddOrdered(0) & 1;
+    m_retiredSnapshots[epoch].append(
+        m_snapshot.fetchAndStoreOrdered(snapshot));
+
+    // a reader announces itself in the current epoch before it loads the
+    // pointer. a snapshot replaced during the previous epoch can only be
+    // held by a reader of that epoch or of the one before it, and the
+    // readers of the one before it were done when the current epoch began.
+    // once the readers of the previous epoch are done as well, its
+    // snapshots are deleted and its reader count is reused for the next
+    // epoch. the readers of an epoch only copy a hash, so each replaced
+    // snapshot is deleted within a couple of swaps even if some thread is
+    // reading at all times
+    qint32 previous = 1 - epoch;
+    if (m_snapshotReaders[previous].fetchAndAddOrdered(0) == 0)
+    {
+        qDeleteAll(m_retiredSnapshots[previous]);
+        m_retiredSnapshots[previous].clear();
+        m_snapshotEpoch.fetchAndAddOrdered(1);
+    }
+}
+
+QHash<QString, QVariant> HClientServicePrivate::snapshot(
+    quint32* sequence) const
+{
+    QAtomicInt& epoch = const_cast<QAtomicInt&>(m_snapshotEpoch);
+
+    QAtomicInt* readers = 0;
+    for (;;)
+    {
+        qint32 current = epoch.fetchAndAddOrdered(0) & 1;
+        readers = const_cast<QAtomicInt*>(&m_snapshotReaders[current]);
+        readers->fetchAndAddOrdered(1);
+
+        // the writer may have begun a new epoch before the reader was
+        // counted, in which case the count may already be in use for the
+        // epoch after it
+        if ((epoch.fetchAndAddOrdered(0) & 1) == current)
+        {
+            break;
+        }
+        readers->fetchAndAddOrdered(-1);
+    }
+
+    const HClientStateSnapshot* snapshot =
+        const_cast<QAtomicPointer<HClientStateSnapshot>&>(
+            m_snapshot).fetchAndAddOrdered(0);
+
+    // copying the hash only increments its reference count
+    QHash<QString, QVariant> retVal = snapshot->m_values;
+    if (sequence) { *sequence = snapshot->m_sequence; }
+
+    readers->fetchAndAddOrdered(-1);
+    return retVal;
+}
+
+void HClientServicePrivate::load()
+{
+    if (!m_loader)
+    {
+        return;
+    }
+
+    // the loader is detached first, as it populates the service through
+    // the same methods that trigger the loading. a failed load is not
+    // retried, which leaves the service without actions and state variables
+    QScopedPointer<HClientServiceLoader> loader(m_loader);
+    m_loader = 0;
+
+    loader->load(static_cast<HDefaultClientService*>(q_ptr));
+    publishSnapshot();
 }
 
 bool HClientServicePrivate::addStateVariable(HDefaultClientStateVariable* sv)
@@ -64,14 +160,157 @@ HClientServicePrivate::ReturnValue HClientServicePrivate::updateVariables(
     ReturnValue rv =
         HServicePrivate<HClientService, HClientAction, HDefaultClientStateVariable>::updateVariables(variables);
 
-    if (rv == Updated && sendEvent && m_evented)
+    if (rv == Updated)
     {
-        emit q_ptr->stateChanged(q_ptr);
+        publishSnapshot();
+
+        if (sendEvent && m_evented)
+        {
+            emit q_ptr->stateChanged(q_ptr);
+        }
     }
 
     return rv;
 }
 
+void HClientServicePrivate::batchCompleted(const HClientBatchOp& op)
+{
+    emit q_ptr->batchInvokeComplete(q_ptr, op);
+}
+
+/*******************************************************************************
+ * HClientBatchRunner
+ ******************************************************************************/
+HClientBatchRunner::HClientBatchRunner(HClientServicePrivate* owner) :
+    QObject(owner->q_ptr),
+        m_owner(owner), m_op(), m_pending(0), m_starting(false), m_done(false)
+{
+}
+
+HClientBatchRunner::~HClientBatchRunner()
+{
+}
+
+HClientBatchOp HClientBatchRunner::run(
+    const QList<QPair<QString, HActionArguments> >& invocations)
+{
+    m_op.setRunner(this);
+    m_op.setReturnValue(UpnpInvocationInProgress);
+    m_starting = true;
+
+    QList<HClientActionOp> operations;
+
+    QList<QPair<QString, HActionArguments> >::const_iterator ci =
+        invocations.constBegin();
+
+    for(; ci != invocations.constEnd(); ++ci)
+    {
+        HClientAction* action = m_owner->m_actions.value(ci->first);
+        if (!action)
+        {
+            operations.append(HClientActionOp(
+                UpnpInvalidAction,
+                QString("The service has no action named [%1]").arg(
+                    ci->first)));
+
+            continue;
+        }
+
+        ++m_pending;
+        HClientActionOp op = action->beginInvoke(
+            ci->second,
+            HActionInvokeCallback(this, &HClientBatchRunner::invocationDone));
+
+        if (op.returnValue() != UpnpInvocationInProgress)
+        {
+            --m_pending;
+        }
+
+        operations.append(op);
+    }
+
+    m_op.setOperations(operations);
+    m_starting = false;
+
+    if (!m_pending)
+    {
+        // the completion is always reported after the batch has been
+        // returned to the caller
+        bool ok = QMetaObject::invokeMethod(
+            this, "completed", Qt::QueuedConnection);
+        Q_ASSERT(ok); Q_UNUSED(ok)
+    }
+
+    return m_op;
+}
+
+bool HClientBatchRunner::invocationDone(
+    HClientAction*, const HClientActionOp&)
+{
+    if (!m_done && --m_pending == 0 && !m_starting)
+    {
+        completed();
+    }
+
+    // the invocations of the batch are reported only through the batch
+    return false;
+}
+
+void HClientBatchRunner::completed()
+{
+    if (m_done)
+    {
+        return;
+    }
+
+    m_done = true;
+
+    qint32 rc = UpnpSuccess;
+    foreach(const HClientActionOp& op, m_op.operations())
+    {
+        if (op.returnValue() != UpnpSuccess)
+        {
+            rc = op.returnValue();
+            break;
+        }
+    }
+
+    report(rc);
+}
+
+void HClientBatchRunner::report(qint32 rc)
+{
+    Q_ASSERT(m_done);
+
+    m_op.setReturnValue(rc);
+    m_op.setRunner(0);
+
+    HClientBatchOp op = m_op;
+    deleteLater();
+
+    m_owner->batchCompleted(op);
+}
+
+void HClientBatchRunner::abort()
+{
+    if (m_done)
+    {
+        return;
+    }
+
+    m_done = true;
+    foreach(HClientActionOp op, m_op.operations())
+    {
+        if (op.returnValue() == UpnpInvocationInProgress)
+        {
+            op.abort();
+            op.setReturnValue(UpnpInvocationAborted);
+        }
+    }
+
+    report(UpnpInvocationAborted);
+}
+
 /*******************************************************************************
  * HClientService
  ******************************************************************************/
@@ -84,10 +323,16 @@ HClientService::HClientService(
 
     h_ptr->m_serviceInfo = info;
     h_ptr->q_ptr = this;
+
+    HMemoryAccount::get(HMemoryAccount::ClientDeviceModel)->add(
+        sizeof(HClientService) + sizeof(HClientServicePrivate));
 }
 
 HClientService::~HClientService()
 {
+    HMemoryAccount::get(HMemoryAccount::ClientDeviceModel)->remove(
+        sizeof(HClientService) + sizeof(HClientServicePrivate));
+
     delete h_ptr;
 }
 
@@ -103,16 +348,19 @@ const HServiceInfo& HClientService::info() const
 
 QString HClientService::description() const
 {
-    return h_ptr->m_serviceDescription;
+    h_ptr->load();
+    return h_ptr->m_serviceDescription.toString();
 }
 
 const HClientActions& HClientService::actions() const
 {
+    h_ptr->load();
     return h_ptr->m_actions;
 }
 
 const HClientStateVariables& HClientService::stateVariables() const
 {
+    h_ptr->load();
     return h_ptr->m_stateVariablesConst;
 }
 
@@ -126,14 +374,36 @@ void HClientService::notifyListeners()
 
 bool HClientService::isEvented() const
 {
+    h_ptr->load();
     return h_ptr->m_evented;
 }
 
+HClientBatchOp HClientService::beginInvokeBatch(
+    const QList<QPair<QString, HActionArguments> >& invocations)
+{
+    h_ptr->load();
+
+    if (invocations.isEmpty())
+    {
+        return HClientBatchOp(UpnpInvalidArgs, "The batch is empty");
+    }
+
+    HClientBatchRunner* runner = new HClientBatchRunner(h_ptr);
+    return runner->run(invocations);
+}
+
 QVariant HClientService::value(const QString& stateVarName, bool* ok) const
 {
+    h_ptr->load();
     return h_ptr->value(stateVarName, ok);
 }
 
+QHash<QString, QVariant> HClientService::valuesSnapshot(
+    quint32* sequence) const
+{
+    return h_ptr->snapshot(sequence);
+}
+
 /*******************************************************************************
  * HDefaultClientService
  ******************************************************************************/
@@ -155,14 +425,38 @@ void HDefaultClientService::addStateVariable(HDefaultClientStateVariable* sv)
     h_ptr->addStateVariable(sv);
 }
 
-void HDefaultClientService::setDescription(const QString& description)
+void HDefaultClientService::setDescription(const QByteArray& description)
+{
+    h_ptr->m_serviceDescription = HDescriptionData(description);
+}
+
+QByteArray HDefaultClientService::descriptionData() const
+{
+    return h_ptr->m_serviceDescription.toUtf8();
+}
+
+bool HDefaultClientService::hasSameDescription(
+    const HDefaultClientService& other) const
+{
+    return h_ptr->m_serviceDescription.isSharedWith(
+        other.h_ptr->m_serviceDescription);
+}
+
+bool HDefaultClientService::hasDescription() const
+{
+    return !h_ptr->m_serviceDescription.isEmpty();
+}
+
+void HDefaultClientService::setLoader(HClientServiceLoader* loader)
 {
-    h_ptr->m_serviceDescription = description;
+    Q_ASSERT(!h_ptr->m_loader);
+    h_ptr->m_loader = loader;
 }
 
 bool HDefaultClientService::updateVariables(
     const QList<QPair<QString, QString> >& variables, bool sendEvent)
 {
+    h_ptr->load();
     return h_ptr->updateVariables(variables, sendEvent) != HClientServicePrivate::Failed;
 }
 
@@ -24,7 +24,11 @@
 
 #include <HUpnpCore/HAsyncOp>
 
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QPair>
 #include <QtCore/QObject>
+#include <QtCore/QVariant>
 
 class QUrl;
 
@@ -75,7 +79,8 @@ class HClientServicePrivate;
  *
  * \sa hupnp_devicemodel
  *
- * \remarks This class is not thread-safe.
+ * \remarks This class is not thread-safe, with the exception of
+ * valuesSnapshot(), which can be called from any thread.
  */
 class H_UPNP_CORE_EXPORT HClientService :
     public QObject
@@ -126,6 +131,13 @@ public:
      * \brief Returns the full service description.
      *
      * \return The full service description.
+     *
+     * \remarks When the control point retrieves the service descriptions
+     * on demand, the first call to this method, actions(), stateVariables(),
+     * isEvented() or value() retrieves the description and blocks until it
+     * has been retrieved and parsed.
+     *
+     * \sa HControlPointConfiguration::setServiceDescriptionsOnDemand()
      */
     QString description() const;
 
@@ -184,6 +196,69 @@ public:
      */
     QVariant value(const QString& stateVarName, bool* ok = 0) const;
 
+    /*!
+     * \brief Returns the values of the state variables of the service.
+     *
+     * The values are those of the latest snapshot the service has published.
+     * A new snapshot is published every time an event notification changes
+     * the value of one or more state variables, and the snapshot is never
+     * modified once it has been published. Because of this the returned
+     * values are always consistent with each other, which is not the case
+     * with a series of calls to value() made while an event is being
+     * processed.
+     *
+     * \param sequence specifies a pointer to an integer, which will contain
+     * the sequence number of the returned snapshot. The number is increased
+     * every time a new snapshot is published, which makes it cheap to check
+     * whether the state has changed since it was last read. This is optional.
+     *
+     * \return The values of the state variables of the service keyed by
+     * the names of the state variables. The map is empty until the
+     * service description has been loaded.
+     *
+     * \remarks
+     * \li This method is thread-safe and it does not block. It does not
+     * load the service description in case it has not been loaded yet.
+     * \li The returned map shares the data of the snapshot, which means
+     * that reading a snapshot does not copy the values.
+     *
+     * \sa value(), stateChanged()
+     */
+    QHash<QString, QVariant> valuesSnapshot(quint32* sequence = 0) const;
+
+    /*!
+     * \brief Schedules a batch of action invocations.
+     *
+     * The method invokes the specified actions of the service asynchronously
+     * and reports the results of all of them at once. The invocations are
+     * started in the order they are specified and they are queued with the
+     * other invocations sent to the device, which lets the control point run
+     * them back to back over the connection it keeps open to the device.
+     *
+     * Once every invocation of the batch has completed or failed, the
+     * batchInvokeComplete() signal is emitted. The
+     * HClientAction::invokeComplete() signal is not emitted for the
+     * invocations of the batch.
+     *
+     * \param invocations specifies the names of the actions to invoke and
+     * the input arguments of each invocation. The same action can be
+     * specified more than once, in which case the invocations run one after
+     * the other.
+     *
+     * \return an object that identifies the batch. This object will be sent
+     * through the batchInvokeComplete() signal once the batch is done.
+     * An invocation of an action the service does not have fails with
+     * \c UpnpInvalidAction without affecting the other invocations.
+     *
+     * \remarks The batchInvokeComplete() signal is never emitted before
+     * this method returns.
+     *
+     * \sa batchInvokeComplete(), HClientAction::beginInvoke(),
+     * HControlPointConfiguration::setMaxConcurrentInvocations()
+     */
+    HClientBatchOp beginInvokeBatch(
+        const QList<QPair<QString, HActionArguments> >& invocations);
+
 public Q_SLOTS:
 
     /*!
@@ -204,6 +279,27 @@ Q_SIGNALS:
      * resides. Do not connect to this signal from other threads.
      */
     void stateChanged(const Herqq::Upnp::HClientService* source);
+
+    /*!
+     * \brief This signal is emitted when every invocation of a batch has
+     * completed or failed, or the batch has been aborted.
+     *
+     * \param source identifies the HClientService that ran the batch.
+     *
+     * \param operation specifies information of the batch that completed.
+     * The return value of it is \c UpnpSuccess when every invocation of the
+     * batch succeeded. Otherwise it is the return value of the first
+     * invocation that failed, or \c UpnpInvocationAborted when the batch
+     * was aborted.
+     *
+     * \sa beginInvokeBatch()
+     *
+     * \remarks This signal has thread affinity to the thread where the object
+     * resides. Do not connect to this signal from other threads.
+     */
+    void batchInvokeComplete(
+        Herqq::Upnp::HClientService* source,
+        const Herqq::Upnp::HClientBatchOp& operation);
 };
 
 }
@@ -30,7 +30,13 @@
 // change or the file may be removed without of notice.
 //
 
+#include "hclientbatchop_p.h"
+
 #include "../hservice_p.h"
+#include "../hactioninvoke_callback.h"
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QAtomicPointer>
 
 namespace Herqq
 {
@@ -38,8 +44,32 @@ namespace Herqq
 namespace Upnp
 {
 
+class HDefaultClientService;
 class HDefaultClientStateVariable;
 
+//
+// Creates the actions and the state variables of a service when they are
+// first needed, instead of when the service is created
+//
+class HClientServiceLoader
+{
+public:
+
+    virtual ~HClientServiceLoader() {}
+    virtual bool load(HDefaultClientService*) = 0;
+};
+
+//
+// An immutable copy of the values of the state variables of a service
+//
+struct HClientStateSnapshot
+{
+    QHash<QString, QVariant> m_values;
+    quint32 m_sequence;
+
+    HClientStateSnapshot() : m_values(), m_sequence(0) {}
+};
+
 //
 // Implementation details of HClientService
 //
@@ -53,6 +83,27 @@ public: // attributes
 
     QHash<QString, const HClientStateVariable*> m_stateVariablesConst;
 
+    HClientServiceLoader* m_loader;
+    // null unless the service description has not been loaded yet
+
+    QAtomicPointer<HClientStateSnapshot> m_snapshot;
+    // the latest values of the state variables. this is replaced, never
+    // modified, and it can be read from any thread
+
+    QAtomicInt m_snapshotEpoch;
+    // the lowest bit selects the reader count a reader announces itself in.
+    // a new epoch begins only once the readers of the previous one are done
+
+    QAtomicInt m_snapshotReaders[2];
+    // the number of threads currently copying a snapshot in each epoch
+
+    QList<HClientStateSnapshot*> m_retiredSnapshots[2];
+    // the snapshots replaced during the current and the previous epoch.
+    // those of the previous epoch are deleted when the next epoch begins
+
+    // replaces the snapshot with the current values of the state variables
+    void publishSnapshot();
+
 public: // methods
 
     HClientServicePrivate();
@@ -60,8 +111,58 @@ public: // methods
     virtual ~HClientServicePrivate();
     bool addStateVariable(HDefaultClientStateVariable*);
 
+    // loads the service description if it has not been loaded yet
+    void load();
+
+    // can be called from any thread
+    QHash<QString, QVariant> snapshot(quint32* sequence) const;
+
     ReturnValue updateVariables(
         const QList<QPair<QString, QString> >& variables, bool sendEvent);
+
+    // called by a batch runner once the batch has completed
+    void batchCompleted(const HClientBatchOp&);
+};
+
+//
+// Runs the invocations of a batch started with
+// HClientService::beginInvokeBatch() and reports the batch once every
+// invocation of it has completed
+//
+class HClientBatchRunner :
+    public QObject
+{
+Q_OBJECT
+H_DISABLE_COPY(HClientBatchRunner)
+
+private:
+
+    HClientServicePrivate* m_owner;
+    HClientBatchOp_ m_op;
+
+    qint32 m_pending;
+    // the number of invocations that have not completed
+
+    bool m_starting;
+    // true while the invocations are being started
+
+    bool m_done;
+    // true once the batch has completed or it has been aborted
+
+    bool invocationDone(HClientAction*, const HClientActionOp&);
+    void report(qint32 rc);
+
+private Q_SLOTS:
+
+    void completed();
+
+public:
+
+    HClientBatchRunner(HClientServicePrivate* owner);
+    virtual ~HClientBatchRunner();
+
+    HClientBatchOp run(const QList<QPair<QString, HActionArguments> >&);
+    void abort();
 };
 
 }
@@ -26,6 +26,8 @@
 #include "../hstatevariable_p.h"
 #include "../hstatevariable_event.h"
 
+#include "../../general/hmemoryaccount_p.h"
+
 namespace Herqq
 {
 
@@ -45,10 +47,16 @@ HClientStateVariable::HClientStateVariable(
 
     h_ptr->m_info = info;
     setValue(info.defaultValue());
+
+    HMemoryAccount::get(HMemoryAccount::ClientDeviceModel)->add(
+        sizeof(HClientStateVariable) + sizeof(HStateVariablePrivate));
 }
 
 HClientStateVariable::~HClientStateVariable()
 {
+    HMemoryAccount::get(HMemoryAccount::ClientDeviceModel)->remove(
+        sizeof(HClientStateVariable) + sizeof(HStateVariablePrivate));
+
     delete h_ptr;
 }
 
@@ -32,14 +32,13 @@
 
 #include <HUpnpCore/HClientAction>
 
-class QNetworkAccessManager;
-
 namespace Herqq
 {
 
 namespace Upnp
 {
 
+class HInvocationChannel;
 class HDefaultClientService;
 
 //
@@ -53,7 +52,7 @@ H_DISABLE_COPY(HDefaultClientAction)
 public:
 
     HDefaultClientAction(
-        const HActionInfo&, HDefaultClientService* parent, QNetworkAccessManager&);
+        const HActionInfo&, HDefaultClientService* parent, HInvocationChannel&);
 
     const QByteArray& loggingIdentifier() const;
 
@@ -33,14 +33,14 @@
 #include <HUpnpCore/HClientDevice>
 #include <HUpnpCore/HDeviceStatus>
 
-#include <QtCore/QTimer>
-
 namespace Herqq
 {
 
 namespace Upnp
 {
 
+class HIconRetriever;
+class HInvocationChannel;
 class HDefaultClientService;
 
 //
@@ -54,19 +54,28 @@ H_DISABLE_COPY(HDefaultClientDevice)
 
 private:
 
-    bool m_timedout;
-    QScopedPointer<QTimer> m_statusNotifier;
+    qint32 m_deviceTimeoutInSecs;
     QScopedPointer<HDeviceStatus> m_deviceStatus;
     qint32 m_configId;
 
+    HInvocationChannel* m_invocationChannel;
+    // the channel through which the actions of the device tree are invoked.
+    // only the root device has one and it is owned by the root device
+
+    HIconRetriever* m_iconRetriever;
+    // retrieves the icons of the device tree on demand. only the root device
+    // has one and it is owned by the root device
+
 private Q_SLOTS:
 
+    // invoked by the control point when the advertisements of the device
+    // tree have timed out
     void timeout_();
 
 public:
 
     HDefaultClientDevice(
-        const QString& description,
+        const QByteArray& description,
         const QList<QUrl>& locations,
         const HDeviceInfo&,
         qint32 deviceTimeoutInSecs,
@@ -76,15 +85,18 @@ public:
     void setEmbeddedDevices(const QList<HDefaultClientDevice*>&);
     inline void setConfigId(qint32 configId) { m_configId = configId; }
 
-public:
+    // replaces the information of the device, and the description in case of
+    // a root device, with the ones of another build of the same device.
+    // the services and the embedded devices are not touched
+    void update(const HDefaultClientDevice& other);
 
-    enum SearchCriteria
-    {
-        ThisOnly = 0,
-        EmbeddedDevices = 1,
-        Services = 2,
-        All = 3
-    };
+    // takes the ownership of the channel. root device only
+    void setInvocationChannel(HInvocationChannel*);
+
+    // takes the ownership of the retriever. root device only
+    void setIconRetriever(HIconRetriever*);
+
+public:
 
     quint32 deviceTimeoutInSecs() const;
 
@@ -94,14 +106,24 @@ public:
         return static_cast<HDefaultClientDevice*>(rootDevice())->deviceStatus();
     }
 
-    void startStatusNotifier(SearchCriteria searchCriteria);
-    void stopStatusNotifier(SearchCriteria searchCriteria);
+    inline HInvocationChannel* invocationChannel() const
+    {
+        if (!parentDevice()) { return m_invocationChannel; }
+        return static_cast<HDefaultClientDevice*>(
+            rootDevice())->invocationChannel();
+    }
+
+    inline HIconRetriever* iconRetriever() const
+    {
+        if (!parentDevice()) { return m_iconRetriever; }
+        return static_cast<HDefaultClientDevice*>(
+            rootDevice())->iconRetriever();
+    }
 
     bool addLocation(const QUrl& location);
     void addLocations(const QList<QUrl>& locations);
     void clearLocations();
     HDefaultClientDevice* rootDevice() const;
-    bool isTimedout(SearchCriteria searchCriteria) const;
 
 Q_SIGNALS:
 
@@ -41,6 +41,7 @@ namespace Upnp
 {
 
 class HDefaultClientDevice;
+class HClientServiceLoader;
 class HDefaultClientStateVariable;
 
 //
@@ -56,7 +57,21 @@ public:
     HDefaultClientService(const HServiceInfo&, HDefaultClientDevice* parentDevice);
     void addAction(HClientAction*);
     void addStateVariable(HDefaultClientStateVariable*);
-    void setDescription(const QString& description);
+    void setDescription(const QByteArray& description);
+
+    // returns the service description as it was received
+    QByteArray descriptionData() const;
+
+    // returns true in case the services were created from identical service
+    // descriptions. the descriptions are pooled by their content hashes, so
+    // this does not compare the documents
+    bool hasSameDescription(const HDefaultClientService& other) const;
+
+    // returns true in case the service description has been received
+    bool hasDescription() const;
+
+    // takes the ownership of the loader
+    void setLoader(HClientServiceLoader*);
 
     bool updateVariables(
         const QList<QPair<QString, QString> >& variables, bool sendEvent);
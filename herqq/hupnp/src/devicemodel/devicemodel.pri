@@ -3,6 +3,8 @@ HEADERS += \
     $$SRC_LOC/devicemodel/hactions_setupdata.h \
     $$SRC_LOC/devicemodel/hasyncop.h \
     $$SRC_LOC/devicemodel/hexecargs.h \
+    $$SRC_LOC/devicemodel/hcanceltoken.h \
+    $$SRC_LOC/devicemodel/hcanceltoken_p.h \
     $$SRC_LOC/devicemodel/hactioninvoke.h \
     $$SRC_LOC/devicemodel/hactioninvoke_callback.h \
     $$SRC_LOC/devicemodel/hactionarguments.h \
@@ -10,6 +12,7 @@ HEADERS += \
     $$SRC_LOC/devicemodel/hdevicestatus.h \
     $$SRC_LOC/devicemodel/hservice_p.h \
     $$SRC_LOC/devicemodel/hdevice_p.h \
+    $$SRC_LOC/devicemodel/hdescription_data_p.h \
     $$SRC_LOC/devicemodel/hdevices_setupdata.h \
     $$SRC_LOC/devicemodel/hservices_setupdata.h \
     $$SRC_LOC/devicemodel/hstatevariable_event.h \
@@ -20,6 +23,8 @@ HEADERS += \
     $$SRC_LOC/devicemodel/hstatevariables_setupdata.h \
     $$SRC_LOC/devicemodel/client/hclientaction.h \
     $$SRC_LOC/devicemodel/client/hclientactionop.h \
+    $$SRC_LOC/devicemodel/client/hclientbatchop.h \
+    $$SRC_LOC/devicemodel/client/hclientbatchop_p.h \
     $$SRC_LOC/devicemodel/client/hclientadapterop.h \
     $$SRC_LOC/devicemodel/client/hclientadapter_p.h \
     $$SRC_LOC/devicemodel/client/hclientaction_p.h \
@@ -42,6 +47,7 @@ HEADERS += \
     $$SRC_LOC/devicemodel/server/hserverservice.h \
     $$SRC_LOC/devicemodel/server/hserverservice_p.h \
     $$SRC_LOC/devicemodel/server/hserverstatevariable.h \
+    $$SRC_LOC/devicemodel/server/htypedstatevariable.h \
     $$SRC_LOC/devicemodel/server/hdevicemodelcreator.h \
     $$SRC_LOC/devicemodel/server/hdefault_serverdevice_p.h \
     $$SRC_LOC/devicemodel/server/hdefault_serveraction_p.h \
@@ -51,6 +57,7 @@ EXPORTED_PRIVATE_HEADERS += \
     $$SRC_LOC/devicemodel/hasyncop_p.h \
     $$SRC_LOC/devicemodel/hservice_p.h \
     $$SRC_LOC/devicemodel/hdevice_p.h \
+    $$SRC_LOC/devicemodel/hdescription_data_p.h \
     $$SRC_LOC/devicemodel/client/hclientadapter_p.h \
     $$SRC_LOC/devicemodel/client/hclientdevice_adapter_p.h \
     $$SRC_LOC/devicemodel/client/hclientservice_adapter_p.h \
@@ -61,7 +68,9 @@ SOURCES += \
     $$SRC_LOC/devicemodel/hactions_setupdata.cpp \
     $$SRC_LOC/devicemodel/hasyncop.cpp \
     $$SRC_LOC/devicemodel/hexecargs.cpp \
+    $$SRC_LOC/devicemodel/hcanceltoken.cpp \
     $$SRC_LOC/devicemodel/hactionarguments.cpp \
+    $$SRC_LOC/devicemodel/hdescription_data_p.cpp \
     $$SRC_LOC/devicemodel/hdevices_setupdata.cpp \
     $$SRC_LOC/devicemodel/hservices_setupdata.cpp \
     $$SRC_LOC/devicemodel/hstatevariable_event.cpp \
@@ -73,6 +82,7 @@ SOURCES += \
     $$SRC_LOC/devicemodel/client/hclientdevice_adapter.cpp \
     $$SRC_LOC/devicemodel/client/hclientaction.cpp \
     $$SRC_LOC/devicemodel/client/hclientactionop.cpp \
+    $$SRC_LOC/devicemodel/client/hclientbatchop.cpp \
     $$SRC_LOC/devicemodel/client/hclientservice.cpp \
     $$SRC_LOC/devicemodel/client/hclientservice_adapter.cpp \
     $$SRC_LOC/devicemodel/client/hclientstatevariable.cpp \
@@ -182,19 +182,64 @@ bool operator!=(const HActionArgument& arg1, const HActionArgument& arg2)
 /*******************************************************************************
  * HActionArgumentsPrivate
  *******************************************************************************/
-HActionArgumentsPrivate::HActionArgumentsPrivate()
+HActionArgumentsPrivate::HActionArgumentsPrivate() :
+    m_schema(new HActionArgumentsSchema()), m_arguments()
 {
 }
 
 HActionArgumentsPrivate::HActionArgumentsPrivate(
-    const QVector<HActionArgument>& args)
+    const QVector<HActionArgument>& args) :
+        m_schema(new HActionArgumentsSchema()), m_arguments()
 {
-    QVector<HActionArgument>::const_iterator ci = args.constBegin();
+    m_arguments.reserve(args.size());
 
+    QVector<HActionArgument>::const_iterator ci = args.constBegin();
     for (; ci != args.constEnd(); ++ci)
     {
-        append(*ci);
+        HActionArgument arg = *ci;
+        arg.detach();
+        append(arg);
+    }
+}
+
+HActionArgumentsPrivate::HActionArgumentsPrivate(
+    const HActionArgumentsPrivate& other) :
+        m_schema(other.m_schema), m_arguments()
+{
+    qint32 size = other.m_arguments.size();
+    m_arguments.reserve(size);
+
+    for (qint32 i = 0; i < size; ++i)
+    {
+        HActionArgument arg = other.m_arguments.at(i);
+        arg.detach();
+        m_arguments.append(arg);
+    }
+}
+
+void HActionArgumentsPrivate::removeAt(qint32 index)
+{
+    Q_ASSERT(index >= 0 && index < m_arguments.size());
+
+    qint32 size = m_arguments.size();
+    for (qint32 i = index; i < size - 1; ++i)
+    {
+        m_arguments[i] = m_arguments.at(i + 1);
     }
+    m_arguments.resize(size - 1);
+
+    m_schema->m_names.removeAt(index);
+    m_schema->m_indexes.clear();
+    for (qint32 i = 0; i < m_schema->m_names.size(); ++i)
+    {
+        m_schema->m_indexes.insert(m_schema->m_names.at(i), i);
+    }
+}
+
+void HActionArgumentsPrivate::clear()
+{
+    m_schema = new HActionArgumentsSchema();
+    m_arguments.clear();
 }
 
 /*******************************************************************************
@@ -206,7 +251,7 @@ HActionArguments::HActionArguments() :
 }
 
 HActionArguments::HActionArguments(const QVector<HActionArgument>& args) :
-    h_ptr(HActionArgumentsPrivate::copy(args))
+    h_ptr(new HActionArgumentsPrivate(args))
 {
 }
 
@@ -216,7 +261,7 @@ HActionArguments::~HActionArguments()
 }
 
 HActionArguments::HActionArguments(const HActionArguments& other) :
-    h_ptr(HActionArgumentsPrivate::copy(other))
+    h_ptr(new HActionArgumentsPrivate(*other.h_ptr))
 {
     Q_ASSERT(&other != this);
 }
@@ -224,104 +269,105 @@ HActionArguments::HActionArguments(const HActionArguments& other) :
 HActionArguments& HActionArguments::operator=(const HActionArguments& other)
 {
     Q_ASSERT(&other != this);
+    HActionArgumentsPrivate* newHptr =
+        new HActionArgumentsPrivate(*other.h_ptr);
+
     delete h_ptr;
-    h_ptr = HActionArgumentsPrivate::copy(other);
+    h_ptr = newHptr;
     return *this;
 }
 
 bool HActionArguments::contains(const QString& argumentName) const
 {
-    return h_ptr->m_arguments.contains(argumentName);
+    return h_ptr->indexOf(argumentName) >= 0;
 }
 
 HActionArgument HActionArguments::get(qint32 index) const
 {
-    return h_ptr->m_argumentsOrdered.at(index);
+    return h_ptr->m_arguments.at(index);
 }
 
 HActionArgument HActionArguments::get(const QString& argumentName) const
 {
-    return h_ptr->m_arguments.value(argumentName);
+    qint32 index = h_ptr->indexOf(argumentName);
+    return index >= 0 ? h_ptr->m_arguments.at(index) : HActionArgument();
+}
+
+qint32 HActionArguments::indexOf(const QString& argumentName) const
+{
+    return h_ptr->indexOf(argumentName);
 }
 
 HActionArguments::const_iterator HActionArguments::constBegin() const
 {
-    return h_ptr->m_argumentsOrdered.constBegin();
+    return h_ptr->m_arguments.constData();
 }
 
 HActionArguments::const_iterator HActionArguments::constEnd() const
 {
-    return h_ptr->m_argumentsOrdered.constEnd();
+    return h_ptr->m_arguments.constData() + h_ptr->m_arguments.size();
 }
 
 HActionArguments::iterator HActionArguments::begin()
 {
-    return h_ptr->m_argumentsOrdered.begin();
+    return h_ptr->m_arguments.data();
 }
 
 HActionArguments::iterator HActionArguments::end()
 {
-    return h_ptr->m_argumentsOrdered.end();
+    return h_ptr->m_arguments.data() + h_ptr->m_arguments.size();
 }
 
 HActionArguments::const_iterator HActionArguments::begin() const
 {
-    return h_ptr->m_argumentsOrdered.begin();
+    return constBegin();
 }
 
 HActionArguments::const_iterator HActionArguments::end() const
 {
-    return h_ptr->m_argumentsOrdered.end();
+    return constEnd();
 }
 
 qint32 HActionArguments::size() const
 {
-    return h_ptr->m_argumentsOrdered.size();
+    return h_ptr->m_arguments.size();
 }
 
 HActionArgument HActionArguments::operator[](qint32 index) const
 {
-    return h_ptr->m_argumentsOrdered.at(index);
+    return h_ptr->m_arguments.at(index);
 }
 
 HActionArgument HActionArguments::operator[](const QString& argName) const
 {
-    return h_ptr->m_arguments.value(argName);
+    return get(argName);
 }
 
 QStringList HActionArguments::names() const
 {
-    return h_ptr->m_arguments.keys();
+    return h_ptr->m_schema->m_names;
 }
 
 bool HActionArguments::isEmpty() const
 {
-    return h_ptr->m_argumentsOrdered.isEmpty();
+    return h_ptr->m_arguments.isEmpty();
 }
 
 void HActionArguments::clear()
 {
-    h_ptr->m_arguments.clear();
-    h_ptr->m_argumentsOrdered.clear();
+    h_ptr->clear();
 }
 
 bool HActionArguments::remove(const QString& name)
 {
-    if (h_ptr->m_arguments.contains(name))
+    qint32 index = h_ptr->indexOf(name);
+    if (index < 0)
     {
-        h_ptr->m_arguments.remove(name);
-        HActionArguments::iterator it = h_ptr->m_argumentsOrdered.begin();
-        for(; it != h_ptr->m_argumentsOrdered.end(); ++it)
-        {
-            if (it->name() == name)
-            {
-                h_ptr->m_argumentsOrdered.erase(it);
-                return true;
-            }
-        }
+        return false;
     }
 
-    return false;
+    h_ptr->removeAt(index);
+    return true;
 }
 
 bool HActionArguments::append(const HActionArgument& arg)
@@ -330,13 +376,12 @@ bool HActionArguments::append(const HActionArgument& arg)
     {
         return false;
     }
-    else if (h_ptr->m_arguments.contains(arg.name()))
+    else if (h_ptr->indexOf(arg.name()) >= 0)
     {
         return false;
     }
 
-    h_ptr->m_arguments.insert(arg.name(), arg);
-    h_ptr->m_argumentsOrdered.append(arg);
+    h_ptr->append(arg);
 
     return true;
 }
@@ -345,9 +390,10 @@ QVariant HActionArguments::value(const QString& name, bool* ok) const
 {
     QVariant retVal;
 
-    if (h_ptr->m_arguments.contains(name))
+    qint32 index = h_ptr->indexOf(name);
+    if (index >= 0)
     {
-        retVal = h_ptr->m_arguments.value(name).value();
+        retVal = h_ptr->m_arguments.at(index).value();
         if (ok) { *ok = true; }
     }
     else
@@ -360,9 +406,10 @@ QVariant HActionArguments::value(const QString& name, bool* ok) const
 
 bool HActionArguments::setValue(const QString& name, const QVariant& value)
 {
-    if (h_ptr->m_arguments.contains(name))
+    qint32 index = h_ptr->indexOf(name);
+    if (index >= 0)
     {
-        return h_ptr->m_arguments[name].setValue(value);
+        return h_ptr->m_arguments[index].setValue(value);
     }
 
     return false;
@@ -388,17 +435,15 @@ void swap(HActionArguments& a, HActionArguments& b)
 
 bool operator==(const HActionArguments& arg1, const HActionArguments& arg2)
 {
-    if (arg1.h_ptr->m_argumentsOrdered.size() !=
-        arg2.h_ptr->m_argumentsOrdered.size())
+    if (arg1.h_ptr->m_arguments.size() != arg2.h_ptr->m_arguments.size())
     {
         return false;
     }
 
-    qint32 size = arg1.h_ptr->m_argumentsOrdered.size();
+    qint32 size = arg1.h_ptr->m_arguments.size();
     for(qint32 i = 0; i < size; ++i)
     {
-        if (arg1.h_ptr->m_argumentsOrdered.at(i) !=
-            arg2.h_ptr->m_argumentsOrdered.at(i))
+        if (arg1.h_ptr->m_arguments.at(i) != arg2.h_ptr->m_arguments.at(i))
         {
             return false;
         }
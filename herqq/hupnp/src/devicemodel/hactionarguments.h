@@ -426,6 +426,62 @@ public:
      */
     HActionArgument get(qint32 index) const;
 
+    /*!
+     * \brief Returns the index of the argument with the specified name.
+     *
+     * The index of an argument does not change unless arguments are removed,
+     * which is why the index can be looked up once and used with every copy
+     * of the arguments of the same action.
+     *
+     * \param argumentName specifies the name of the argument.
+     *
+     * \return The index of the argument with the specified name or -1 in
+     * case no argument with the specified name exists.
+     *
+     * \remarks This is a \e constant-time operation.
+     */
+    qint32 indexOf(const QString& argumentName) const;
+
+    /*!
+     * \brief Returns the value of the specified argument as the specified type.
+     *
+     * For instance, <c>args.get<quint32>("InstanceID")</c> returns the value
+     * of the argument \c InstanceID as an unsigned integer. In case the type
+     * is the one the data type of the argument maps to, the value is returned
+     * as it is stored and no conversion is done.
+     *
+     * \param argumentName specifies the name of the argument.
+     *
+     * \param ok specifies a pointer to \c bool, which will be \e true if
+     * the argument was found and its value could be converted to the
+     * specified type. This parameter is optional.
+     *
+     * \return The value of the specified argument as the specified type or
+     * a default-constructed value in case the argument was not found.
+     */
+    template<typename T>
+    T get(const QString& argumentName, bool* ok = 0) const
+    {
+        return get<T>(indexOf(argumentName), ok);
+    }
+
+    /*!
+     * \brief Returns the value of the argument at the specified index as the
+     * specified type.
+     *
+     * \param index specifies the index of the argument, which is usually
+     * retrieved once using indexOf().
+     *
+     * \param ok specifies a pointer to \c bool, which will be \e true if
+     * the index was valid and the value could be converted to the
+     * specified type. This parameter is optional.
+     *
+     * \return The value of the specified argument as the specified type or
+     * a default-constructed value in case the index was not valid.
+     */
+    template<typename T>
+    T get(qint32 index, bool* ok = 0) const;
+
     /*!
      * \brief Returns a const STL-style iterator pointing to the first item.
      *
@@ -513,7 +569,8 @@ public:
     /*!
      * \brief Returns the names of all the contained action arguments.
      *
-     * \return The names of all the contained action arguments.
+     * \return The names of all the contained action arguments in the order
+     * the arguments are iterated.
      */
     QStringList names() const;
 
@@ -591,6 +648,46 @@ public:
      */
     bool setValue(const QString& name, const QVariant& value);
 
+    /*!
+     * Attempts to set the value of the specified argument.
+     *
+     * In case the type is the one the data type of the argument maps to,
+     * the value is checked against the constraints of the argument without
+     * any conversions.
+     *
+     * \param argumentName specifies the name of the argument.
+     *
+     * \param value specifies the value of the argument.
+     *
+     * \return \e true in case the argument was found and its value was set.
+     */
+    template<typename T>
+    bool set(const QString& argumentName, const T& value)
+    {
+        return set(indexOf(argumentName), value);
+    }
+
+    /*!
+     * Attempts to set the value of the argument at the specified index.
+     *
+     * \param index specifies the index of the argument, which is usually
+     * retrieved once using indexOf().
+     *
+     * \param value specifies the value of the argument.
+     *
+     * \return \e true in case the index was valid and the value was set.
+     */
+    template<typename T>
+    bool set(qint32 index, const T& value)
+    {
+        if (index < 0 || index >= size())
+        {
+            return false;
+        }
+
+        return get(index).setValue(QVariant::fromValue(value));
+    }
+
     /*!
      * \brief Returns a string representation of the object.
      *
@@ -605,6 +702,25 @@ public:
     QString toString() const;
 };
 
+template<typename T>
+T HActionArguments::get(qint32 index, bool* ok) const
+{
+    if (index < 0 || index >= size())
+    {
+        if (ok) { *ok = false; }
+        return T();
+    }
+
+    // qvariant_cast returns a value of the stored type without a conversion
+    const QVariant value = get(index).value();
+    if (ok)
+    {
+        *ok = value.userType() == qMetaTypeId<T>() || value.canConvert<T>();
+    }
+
+    return qvariant_cast<T>(value);
+}
+
 /*!
  * Compares the two objects for equality.
  *
@@ -24,8 +24,12 @@
 
 #include "hactionarguments.h"
 
+#include <QtCore/QHash>
 #include <QtCore/QVector>
 #include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QSharedData>
+#include <QtCore/QVarLengthArray>
 
 //
 // !! Warning !!
@@ -41,46 +45,75 @@ namespace Herqq
 namespace Upnp
 {
 
+//
+// The names of the arguments of an action and the positions of the arguments
+// in that order. The schema is built once when the arguments of an action
+// are set up and it is shared by every copy of those arguments, since the
+// copies differ only by the values of the arguments.
+//
+class HActionArgumentsSchema :
+    public QSharedData
+{
+public:
+
+    QStringList m_names;
+    // UDA 1.1 mandates that action arguments are always transmitted in the
+    // order they were specified in the service description.
+
+    QHash<QString, qint32> m_indexes;
+    // for fast name-based lookups
+
+    inline HActionArgumentsSchema() :
+        m_names(), m_indexes()
+    {
+    }
+};
+
 //
 //
 //
 class HActionArgumentsPrivate
 {
+private:
+
+    enum
+    {
+        // the number of arguments stored without a separate allocation.
+        // most actions have less arguments than this
+        PreallocatedArguments = 8
+    };
+
 public: // attributes
 
-    QVector<HActionArgument> m_argumentsOrdered;
-    // UDA 1.1 mandates that action arguments are always transmitted in the order
-    // they were specified in the service description.
+    QSharedDataPointer<HActionArgumentsSchema> m_schema;
+    // modified only when arguments are added or removed
 
-    QHash<QString, HActionArgument> m_arguments;
-    // for fast name-based lookups
+    QVarLengthArray<HActionArgument, PreallocatedArguments> m_arguments;
+    // the arguments in the order of m_schema->m_names
 
 public: // functions
 
     HActionArgumentsPrivate();
     explicit HActionArgumentsPrivate(const QVector<HActionArgument>& args);
 
-    inline void append(const HActionArgument& arg)
+    // the schema is shared with the other, but the arguments are detached
+    HActionArgumentsPrivate(const HActionArgumentsPrivate& other);
+
+    inline qint32 indexOf(const QString& name) const
     {
-        Q_ASSERT_X(arg.isValid(), H_AT, "A provided action argument has to be valid");
-        m_argumentsOrdered.push_back(arg);
-        m_arguments[arg.name()] = arg;
+        return m_schema->m_indexes.value(name, -1);
     }
 
-    template<typename T>
-    static HActionArgumentsPrivate* copy(const T& source)
+    inline void append(const HActionArgument& arg)
     {
-        HActionArgumentsPrivate* contents = new HActionArgumentsPrivate();
-
-        for(typename T::const_iterator ci = source.constBegin(); ci != source.constEnd(); ++ci)
-        {
-            HActionArgument arg = *ci;
-            arg.detach();
-            contents->append(arg);
-        }
-
-        return contents;
+        Q_ASSERT_X(arg.isValid(), H_AT, "A provided action argument has to be valid");
+        m_schema->m_indexes.insert(arg.name(), m_arguments.size());
+        m_schema->m_names.append(arg.name());
+        m_arguments.append(arg);
     }
+
+    void removeAt(qint32 index);
+    void clear();
 };
 
 }
@@ -22,10 +22,7 @@
 #include "hasyncop.h"
 #include "hasyncop_p.h"
 
-#include <QtCore/QMutex>
-
-static unsigned int s_lastInt = 0;
-static QMutex s_lastIntMutex;
+#include <QtCore/QAtomicInt>
 
 namespace Herqq
 {
@@ -35,12 +32,19 @@ namespace Upnp
 
 namespace
 {
+QAtomicInt s_lastId;
+
 inline unsigned int getNextId()
 {
     unsigned int retVal;
-    s_lastIntMutex.lock();
-    retVal = ++s_lastInt;
-    s_lastIntMutex.unlock();
+    do
+    {
+        // zero is the ID of a null operation and it is skipped when the
+        // counter wraps around
+        retVal = static_cast<unsigned int>(s_lastId.fetchAndAddRelaxed(1) + 1);
+    }
+    while(!retVal);
+
     return retVal;
 }
 }
@@ -55,6 +59,22 @@ HAsyncOpPrivate::~HAsyncOpPrivate()
     delete m_errorDescription;
 }
 
+void HAsyncOpPrivate::reset(unsigned int id)
+{
+    m_id = id;
+    m_refCount = 1;
+    m_returnValue = 0;
+    m_userData = 0;
+
+    delete m_errorDescription;
+    m_errorDescription = 0;
+}
+
+void HAsyncOpPrivate::release()
+{
+    delete this;
+}
+
 HAsyncOp::HAsyncOp() :
     h_ptr(new HAsyncOpPrivate(getNextId()))
 {
@@ -84,7 +104,7 @@ HAsyncOp::~HAsyncOp()
 {
     if (--h_ptr->m_refCount == 0)
     {
-        delete h_ptr;
+        h_ptr->release();
     }
 }
 
@@ -101,7 +121,7 @@ HAsyncOp& HAsyncOp::operator=(const HAsyncOp& op)
 
     if (--h_ptr->m_refCount == 0)
     {
-        delete h_ptr;
+        h_ptr->release();
     }
     h_ptr = op.h_ptr;
     ++h_ptr->m_refCount;
@@ -43,7 +43,12 @@ H_DISABLE_COPY(HAsyncOpPrivate)
 
 private:
 
-    const unsigned int m_id;
+    unsigned int m_id;
+
+protected:
+
+    // prepares an object of a completed operation for a new operation
+    void reset(unsigned int id);
 
 public:
 
@@ -69,6 +74,10 @@ public:
 
     virtual ~HAsyncOpPrivate();
 
+    // called when the last HAsyncOp referring to the object is destroyed.
+    // the default implementation deletes the object
+    virtual void release();
+
     inline unsigned int id() const { return m_id; }
 };
 
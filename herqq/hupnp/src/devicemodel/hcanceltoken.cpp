@@ -0,0 +1,81 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "hcanceltoken.h"
+#include "hcanceltoken_p.h"
+
+#include "client/hclientaction_p.h"
+
+#include <QtCore/QMutexLocker>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+/*******************************************************************************
+ * HCancelToken
+ ******************************************************************************/
+HCancelToken::HCancelToken() :
+    h_ptr(new HCancelTokenPrivate())
+{
+}
+
+HCancelToken::HCancelToken(const HCancelToken& other) :
+    h_ptr(other.h_ptr)
+{
+}
+
+HCancelToken& HCancelToken::operator=(const HCancelToken& other)
+{
+    h_ptr = other.h_ptr;
+    return *this;
+}
+
+HCancelToken::~HCancelToken()
+{
+}
+
+void HCancelToken::cancel()
+{
+    QMutexLocker lock(&h_ptr->m_mutex);
+    if (h_ptr->m_cancelled)
+    {
+        return;
+    }
+
+    h_ptr->m_cancelled = true;
+    foreach(HSyncInvokeWaiter* waiter, h_ptr->m_waiters)
+    {
+        waiter->cancel();
+    }
+}
+
+bool HCancelToken::isCancelled() const
+{
+    QMutexLocker lock(&h_ptr->m_mutex);
+    return h_ptr->m_cancelled;
+}
+
+}
+}
@@ -0,0 +1,112 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef HCANCELTOKEN_H_
+#define HCANCELTOKEN_H_
+
+#include <HUpnpCore/HUpnp>
+
+#include <QtCore/QExplicitlySharedDataPointer>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+class HCancelTokenPrivate;
+
+/*!
+ * \brief This class is used to cancel blocking operations from other threads.
+ *
+ * You can pass an instance of this class to a blocking operation, such as
+ * HClientAction::invoke(), and call cancel() from any thread to make
+ * the operation return early. The copies of an instance share the same
+ * state and cancelling any of them cancels every operation that was given
+ * one of the copies.
+ *
+ * A token stays cancelled once it has been cancelled. Use a new token for
+ * each operation that should be cancellable separately.
+ *
+ * \headerfile hcanceltoken.h HCancelToken
+ *
+ * \ingroup hupnp_devicemodel
+ *
+ * \sa HClientAction::invoke()
+ *
+ * \remarks This class is thread-safe.
+ */
+class H_UPNP_CORE_EXPORT HCancelToken
+{
+friend class HSyncInvokeWaiter;
+
+private:
+
+    QExplicitlySharedDataPointer<HCancelTokenPrivate> h_ptr;
+
+public:
+
+    /*!
+     * \brief Creates a new instance that has not been cancelled.
+     */
+    HCancelToken();
+
+    /*!
+     * \brief Copy constructor.
+     *
+     * Creates a copy that shares the state of the \c other.
+     */
+    HCancelToken(const HCancelToken&);
+
+    /*!
+     * \brief Assigns the contents of the other object to this.
+     *
+     * \return reference to this object.
+     */
+    HCancelToken& operator=(const HCancelToken&);
+
+    /*!
+     * \brief Destroys the instance.
+     */
+    ~HCancelToken();
+
+    /*!
+     * \brief Cancels the operations that were given this token or a copy
+     * of it.
+     *
+     * The operations that are in progress return as soon as possible and the
+     * operations started later with the token return immediately.
+     */
+    void cancel();
+
+    /*!
+     * \brief Indicates whether the token has been cancelled.
+     *
+     * \return \e true in case the token has been cancelled.
+     */
+    bool isCancelled() const;
+};
+
+}
+}
+
+#endif /* HCANCELTOKEN_H_ */
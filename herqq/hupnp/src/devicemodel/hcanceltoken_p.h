@@ -0,0 +1,74 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef HCANCELTOKEN_P_H_
+#define HCANCELTOKEN_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include "hcanceltoken.h"
+
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QSharedData>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+class HSyncInvokeWaiter;
+
+//
+// Implementation details of HCancelToken
+//
+class HCancelTokenPrivate :
+    public QSharedData
+{
+H_DISABLE_COPY(HCancelTokenPrivate)
+
+public:
+
+    QMutex m_mutex;
+    bool m_cancelled;
+
+    QList<HSyncInvokeWaiter*> m_waiters;
+    // the waiters currently blocked on an operation that was given the token.
+    // these are woken up when the token is cancelled
+
+    inline HCancelTokenPrivate() :
+        m_mutex(), m_cancelled(false), m_waiters()
+    {
+    }
+};
+
+}
+}
+
+#endif /* HCANCELTOKEN_P_H_ */
@@ -0,0 +1,225 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hdescription_data_p.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QAtomicInt>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+/*******************************************************************************
+ * HDescriptionDataPrivate
+ ******************************************************************************/
+class HDescriptionDataPrivate
+{
+H_DISABLE_COPY(HDescriptionDataPrivate)
+
+public:
+
+    QAtomicInt m_ref;
+
+    QByteArray m_data;
+    bool m_compressed;
+    // the UTF-8 form of the description, which is compressed in case
+    // m_compressed is set
+
+    qint32 m_size;
+    uint m_hash;
+    // the size and the hash of the UTF-8 form
+
+    HDescriptionDataPrivate(const QByteArray& utf8, uint hash) :
+        m_ref(1), m_data(utf8), m_compressed(false), m_size(utf8.size()),
+        m_hash(hash)
+    {
+        if (m_size >= HDescriptionData::CompressionThreshold)
+        {
+            QByteArray compressed = qCompress(utf8);
+            if (compressed.size() < m_size)
+            {
+                m_data = compressed;
+                m_compressed = true;
+            }
+        }
+    }
+
+    inline QByteArray utf8() const
+    {
+        return m_compressed ? qUncompress(m_data) : m_data;
+    }
+};
+
+namespace
+{
+//
+// The documents in use, keyed by the hashes of their UTF-8 forms. A document
+// is removed once the last instance referring to it is destroyed.
+//
+class HDescriptionPool
+{
+H_DISABLE_COPY(HDescriptionPool)
+
+public:
+
+    QMutex m_mutex;
+    QMultiHash<uint, HDescriptionDataPrivate*> m_documents;
+
+    HDescriptionPool() : m_mutex(), m_documents() {}
+
+    HDescriptionDataPrivate* acquire(const QByteArray& utf8)
+    {
+        uint hash = qHash(utf8);
+
+        QMutexLocker locker(&m_mutex);
+
+        QMultiHash<uint, HDescriptionDataPrivate*>::const_iterator ci =
+            m_documents.constFind(hash);
+
+        for(; ci != m_documents.constEnd() && ci.key() == hash; ++ci)
+        {
+            HDescriptionDataPrivate* document = ci.value();
+            if (document->m_size != utf8.size() || document->utf8() != utf8)
+            {
+                continue;
+            }
+            else if (document->m_ref.fetchAndAddOrdered(1) == 0)
+            {
+                // the last reference is being released and the document is
+                // deleted once the releasing thread gets the lock
+                document->m_ref.deref();
+                continue;
+            }
+
+            return document;
+        }
+
+        HDescriptionDataPrivate* retVal =
+            new HDescriptionDataPrivate(utf8, hash);
+        m_documents.insert(hash, retVal);
+
+        return retVal;
+    }
+
+    void release(HDescriptionDataPrivate* document)
+    {
+        if (document->m_ref.deref())
+        {
+            return;
+        }
+
+        QMutexLocker locker(&m_mutex);
+
+        // a document that is found while its last reference is being
+        // released is not acquired, which means that no other thread deletes
+        // the document and the count stays at zero
+        Q_ASSERT(document->m_ref.fetchAndAddOrdered(0) == 0);
+
+        m_documents.remove(document->m_hash, document);
+        delete document;
+    }
+};
+
+HDescriptionPool& descriptionPool()
+{
+    static HDescriptionPool retVal;
+    return retVal;
+}
+}
+
+/*******************************************************************************
+ * HDescriptionData
+ ******************************************************************************/
+HDescriptionData::HDescriptionData() :
+    h_ptr(0)
+{
+}
+
+HDescriptionData::HDescriptionData(const QString& description) :
+    h_ptr(description.isEmpty() ?
+        0 : descriptionPool().acquire(description.toUtf8()))
+{
+}
+
+HDescriptionData::HDescriptionData(const QByteArray& utf8Description) :
+    h_ptr(utf8Description.isEmpty() ?
+        0 : descriptionPool().acquire(utf8Description))
+{
+}
+
+HDescriptionData::~HDescriptionData()
+{
+    if (h_ptr)
+    {
+        descriptionPool().release(h_ptr);
+    }
+}
+
+HDescriptionData::HDescriptionData(const HDescriptionData& other) :
+    h_ptr(other.h_ptr)
+{
+    if (h_ptr)
+    {
+        h_ptr->m_ref.ref();
+    }
+}
+
+HDescriptionData& HDescriptionData::operator=(const HDescriptionData& other)
+{
+    if (other.h_ptr)
+    {
+        other.h_ptr->m_ref.ref();
+    }
+    if (h_ptr)
+    {
+        descriptionPool().release(h_ptr);
+    }
+
+    h_ptr = other.h_ptr;
+    return *this;
+}
+
+qint32 HDescriptionData::size() const
+{
+    return h_ptr ? h_ptr->m_size : 0;
+}
+
+qint32 HDescriptionData::storedSize() const
+{
+    return h_ptr ? h_ptr->m_data.size() : 0;
+}
+
+QByteArray HDescriptionData::toUtf8() const
+{
+    return h_ptr ? h_ptr->utf8() : QByteArray();
+}
+
+QString HDescriptionData::toString() const
+{
+    return h_ptr ? QString::fromUtf8(h_ptr->utf8()) : QString();
+}
+
+}
+}
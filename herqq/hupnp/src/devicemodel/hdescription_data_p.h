@@ -0,0 +1,99 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HDESCRIPTION_DATA_P_H_
+#define HDESCRIPTION_DATA_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include <HUpnpCore/HUpnp>
+
+#include <QtCore/QString>
+#include <QtCore/QByteArray>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+class HDescriptionDataPrivate;
+
+//
+// A device or service description kept as UTF-8, which is decoded only when
+// the description is requested.
+//
+// The instances created from identical documents share a single copy of the
+// document, which is looked up from a process-wide pool. Large documents are
+// compressed, in case the compressed form is smaller. A description is
+// immutable once created and the instances can be used in any thread.
+//
+class H_UPNP_CORE_EXPORT HDescriptionData
+{
+private:
+
+    HDescriptionDataPrivate* h_ptr;
+    // null when the description is empty
+
+public:
+
+    enum
+    {
+        CompressionThreshold = 1024
+        // the size in bytes from which on the UTF-8 form is compressed
+    };
+
+    HDescriptionData();
+    explicit HDescriptionData(const QString& description);
+    explicit HDescriptionData(const QByteArray& utf8Description);
+    ~HDescriptionData();
+
+    HDescriptionData(const HDescriptionData&);
+    HDescriptionData& operator=(const HDescriptionData&);
+
+    inline bool isEmpty() const { return !h_ptr; }
+
+    // returns true in case the instances share the same document, in which
+    // case the documents are known to be identical without comparing them
+    inline bool isSharedWith(const HDescriptionData& other) const
+    {
+        return h_ptr == other.h_ptr;
+    }
+
+    // returns the size of the description in UTF-8 and the size of the data
+    // the description actually occupies
+    qint32 size() const;
+    qint32 storedSize() const;
+
+    QByteArray toUtf8() const;
+    QString toString() const;
+};
+
+}
+}
+
+#endif /* HDESCRIPTION_DATA_P_H_ */
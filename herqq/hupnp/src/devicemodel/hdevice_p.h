@@ -33,6 +33,7 @@
 #include <HUpnpCore/HDeviceInfo>
 #include <HUpnpCore/HDeviceStatus>
 #include <HUpnpCore/HResourceType>
+#include <HUpnpCore/private/hdescription_data_p.h>
 
 #include <QtCore/QUrl>
 #include <QtCore/QList>
@@ -74,9 +75,10 @@ public: // attributes
     QList<QUrl> m_locations;
     // The URLs at which this device is available
 
-    QString m_deviceDescription;
-    // The full device description.
-    // CONSIDER: would it be better to load this into memory only when needed?
+    HDescriptionData m_deviceDescription;
+    // The full device description, which is shared by the devices of the
+    // tree and decoded only when requested. The client side sets this only
+    // to the root device.
 
     QScopedPointer<HDeviceStatus> m_deviceStatus;
 
@@ -111,6 +111,11 @@ public:
      * that contains this service.
      *
      * \return information of the actions the specified service type may contain.
+     *
+     * \remarks HDeviceHost asks for the information once for each combination
+     * of device type, service type, service ID and service description. The
+     * services created later with the same combination are assumed to
+     * be valid.
      */
     virtual HActionsSetupData actionsSetupData(
         const HServiceInfo& serviceInfo, const HDeviceInfo& parentDeviceInfo) const;
@@ -126,6 +131,11 @@ public:
      *
      * \return information of the state variables the specified service type
      * may contain.
+     *
+     * \remarks HDeviceHost asks for the information once for each combination
+     * of device type, service type, service ID and service description. The
+     * services created later with the same combination are assumed to
+     * be valid.
      */
     virtual HStateVariablesSetupData stateVariablesSetupData(
         const HServiceInfo& serviceInfo, const HDeviceInfo& parentDeviceInfo) const;
@@ -55,7 +55,7 @@ private:
 public:
 
     HDeviceStatus() :
-        m_bootId(0), m_configId(0), m_searchPort(0), m_online(true)
+        m_bootId(0), m_configId(0), m_searchPort(-1), m_online(true)
     {
     }
 
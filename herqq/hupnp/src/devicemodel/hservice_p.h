@@ -33,10 +33,14 @@
 #include <HUpnpCore/HServiceInfo>
 #include <HUpnpCore/HUpnpDataTypes>
 #include <HUpnpCore/HStateVariableInfo>
+#include <HUpnpCore/private/hdescription_data_p.h>
 
 #include <QtCore/QUrl>
 #include <QtCore/QHash>
+#include <QtCore/QPair>
+#include <QtCore/QVector>
 #include <QtCore/QString>
+#include <QtCore/QVariant>
 #include <QtCore/QByteArray>
 
 namespace Herqq
@@ -57,7 +61,7 @@ H_DISABLE_COPY(HServicePrivate)
 public: // attributes
 
     HServiceInfo m_serviceInfo;
-    QString m_serviceDescription;
+    HDescriptionData m_serviceDescription;
     QString m_lastError;
 
     QHash<QString, Action*> m_actions;
@@ -123,7 +127,11 @@ public: // methods
     ReturnValue updateVariables(const QList<QPair<QString, QString> >& variables)
     {
         // before modifying anything, it is better to be sure that the incoming
-        // data is valid and it can be set completely.
+        // data is valid and it can be set completely. each variable is looked
+        // up and its value converted only once
+        QVector<QPair<StateVariable*, QVariant> > resolved;
+        resolved.reserve(variables.size());
+
         for (int i = 0; i < variables.size(); ++i)
         {
             StateVariable* stateVar = m_stateVariables.value(variables[i].first);
@@ -138,9 +146,10 @@ public: // methods
             }
 
             const HStateVariableInfo& info = stateVar->info();
-            if (!info.isValidValue(
-                    HUpnpDataTypes::convertToRightVariantType(
-                        variables[i].second, info.dataType())))
+            QVariant value = HUpnpDataTypes::convertToRightVariantType(
+                variables[i].second, info.dataType());
+
+            if (!info.isValidValue(value))
             {
                 m_lastError = QString(
                     "Cannot update state variable [%1]. New value is invalid: [%2]").
@@ -148,20 +157,17 @@ public: // methods
 
                 return Failed;
             }
+
+            resolved.append(qMakePair(stateVar, value));
         }
 
         bool changed = false;
-        for (int i = 0; i < variables.size(); ++i)
+        for (int i = 0; i < resolved.size(); ++i)
         {
-            StateVariable* stateVar = m_stateVariables.value(variables[i].first);
-            Q_ASSERT(stateVar);
-
-            const HStateVariableInfo& info = stateVar->info();
-
-            if (stateVar->setValue(
-                    HUpnpDataTypes::convertToRightVariantType(
-                        variables[i].second, info.dataType())) &&
-                    !changed)
+            // a variable the value of which has not changed is not updated
+            // and it does not signal a change
+            if (resolved[i].first->value() != resolved[i].second &&
+                resolved[i].first->setValue(resolved[i].second))
             {
                 changed = true;
             }
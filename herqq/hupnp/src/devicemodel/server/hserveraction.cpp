@@ -25,6 +25,7 @@
 
 #include "../hactionarguments.h"
 
+#include "../../general/hmemoryaccount_p.h"
 #include "../../general/hlogger_p.h"
 
 namespace Herqq
@@ -37,7 +38,9 @@ namespace Upnp
  * HServerActionPrivate
  ******************************************************************************/
 HServerActionPrivate::HServerActionPrivate() :
-    q_ptr(0), m_info(), m_actionInvoke()
+    q_ptr(0), m_info(), m_actionInvoke(),
+    m_executionPolicy(HServerAction::ExecuteInHostThread),
+    m_maxPendingInvocations(0)
 {
 }
 
@@ -68,10 +71,16 @@ HServerAction::HServerAction(const HActionInfo& info, HServerService* parent) :
 
     h_ptr->m_info.reset(new HActionInfo(info));
     h_ptr->q_ptr = this;
+
+    HMemoryAccount::get(HMemoryAccount::ServerDeviceModel)->add(
+        sizeof(HServerAction) + sizeof(HServerActionPrivate));
 }
 
 HServerAction::~HServerAction()
 {
+    HMemoryAccount::get(HMemoryAccount::ServerDeviceModel)->remove(
+        sizeof(HServerAction) + sizeof(HServerActionPrivate));
+
     delete h_ptr;
 }
 
@@ -93,6 +102,26 @@ qint32 HServerAction::invoke(
     return h_ptr->m_actionInvoke(inArgs, outArgs);
 }
 
+HServerAction::ExecutionPolicy HServerAction::executionPolicy() const
+{
+    return h_ptr->m_executionPolicy;
+}
+
+void HServerAction::setExecutionPolicy(ExecutionPolicy policy)
+{
+    h_ptr->m_executionPolicy = policy;
+}
+
+qint32 HServerAction::maxPendingInvocations() const
+{
+    return h_ptr->m_maxPendingInvocations;
+}
+
+void HServerAction::setMaxPendingInvocations(qint32 count)
+{
+    h_ptr->m_maxPendingInvocations = count > 0 ? count : 0;
+}
+
 /*******************************************************************************
  * HDefaultServerAction
  ******************************************************************************/
@@ -64,6 +64,41 @@ Q_OBJECT
 H_DISABLE_COPY(HServerAction)
 H_DECLARE_PRIVATE(HServerAction)
 
+public:
+
+    /*!
+     * \brief This enumeration specifies where an HDeviceHost runs the
+     * invocations of the action that it receives from the network.
+     *
+     * \sa setExecutionPolicy()
+     */
+    enum ExecutionPolicy
+    {
+        /*!
+         * The action is invoked in the thread of the HDeviceHost, which
+         * means that no other requests are served while the action runs.
+         *
+         * This is the default.
+         */
+        ExecuteInHostThread = 0,
+
+        /*!
+         * The action is invoked in a worker thread of the HDeviceHost.
+         * The invocations of the actions of the same service that use
+         * this policy are run one at a time in the order they were received.
+         */
+        ExecuteSerialized,
+
+        /*!
+         * The action is invoked in a worker thread of the HDeviceHost
+         * and its invocations may run concurrently with each other and with
+         * the invocations of the other actions of the service.
+         *
+         * Use this only when the implementation of the action is thread-safe.
+         */
+        ExecuteConcurrently
+    };
+
 protected:
 
     HServerActionPrivate* h_ptr;
@@ -146,6 +181,76 @@ public:
      */
     qint32 invoke(
         const HActionArguments& inArgs, HActionArguments* outArgs = 0);
+
+    /*!
+     * \brief Returns where an HDeviceHost runs the invocations of the action
+     * that it receives from the network.
+     *
+     * \return where an HDeviceHost runs the invocations of the action
+     * that it receives from the network.
+     *
+     * \sa setExecutionPolicy()
+     */
+    ExecutionPolicy executionPolicy() const;
+
+    /*!
+     * \brief Specifies where an HDeviceHost runs the invocations of the action
+     * that it receives from the network.
+     *
+     * An action that blocks, for instance to read a disk or to connect to
+     * another host, prevents the device host from serving other requests
+     * and from sending SSDP messages while it runs, unless it is run in
+     * a worker thread. The response to such an invocation is sent once the
+     * action returns.
+     *
+     * \param policy specifies where an HDeviceHost runs the invocations of
+     * the action. The default is HServerAction::ExecuteInHostThread.
+     *
+     * \remarks
+     * \li An action run in a worker thread must not access the HUPnP device
+     * model directly, since the model is not thread-safe. For instance,
+     * changes to the values of state variables should be queued to the thread
+     * of the device host with QMetaObject::invokeMethod().
+     * \li This affects the invocations received after the call, and it has
+     * no effect on invoke(), which always runs the action in the calling
+     * thread.
+     *
+     * \sa executionPolicy(), HDeviceHostConfiguration::setActionThreadCount()
+     */
+    void setExecutionPolicy(ExecutionPolicy policy);
+
+    /*!
+     * \brief Returns the maximum number of invocations of the action that
+     * an HDeviceHost keeps queued or running in its worker threads.
+     *
+     * \return the maximum number of invocations of the action that
+     * an HDeviceHost keeps queued or running in its worker threads. Zero
+     * means that there is no limit.
+     *
+     * \sa setMaxPendingInvocations()
+     */
+    qint32 maxPendingInvocations() const;
+
+    /*!
+     * \brief Specifies the maximum number of invocations of the action that
+     * an HDeviceHost keeps queued or running in its worker threads.
+     *
+     * When the limit is reached, the device host responds to the further
+     * invocations received from the network with the error
+     * \c UpnpActionFailed until one of the pending invocations completes.
+     * This keeps a burst of expensive invocations from piling up behind the
+     * worker threads while their invokers wait for responses.
+     *
+     * \param count specifies the maximum number of pending invocations.
+     * Zero or a negative value means that there is no limit, which is
+     * the default.
+     *
+     * \remarks This has no effect when the action is run in the thread of
+     * the device host.
+     *
+     * \sa maxPendingInvocations(), setExecutionPolicy()
+     */
+    void setMaxPendingInvocations(qint32 count);
 };
 
 }
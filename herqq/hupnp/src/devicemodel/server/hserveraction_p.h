@@ -30,6 +30,8 @@
 // change or the file may be removed without of notice.
 //
 
+#include "hserveraction.h"
+
 #include "../hactioninvoke.h"
 
 #include "../../dataelements/hactioninfo.h"
@@ -59,6 +61,13 @@ public:
     QScopedPointer<HActionInfo> m_info;
     HActionInvoke m_actionInvoke;
 
+    HServerAction::ExecutionPolicy m_executionPolicy;
+    // where the device host runs the invocations received from the network
+
+    qint32 m_maxPendingInvocations;
+    // the number of invocations the device host keeps in its worker threads
+    // before it rejects the invocations. zero means that there is no limit
+
 public:
 
     HServerActionPrivate();
@@ -28,6 +28,7 @@
 #include "../../dataelements/hdeviceinfo.h"
 #include "../../dataelements/hserviceinfo.h"
 
+#include "../../general/hmemoryaccount_p.h"
 #include "../../general/hupnp_global_p.h"
 
 #include <QtCore/QString>
@@ -49,16 +50,23 @@ HServerDevice::HServerDevice() :
     QObject(),
         h_ptr(new HServerDevicePrivate())
 {
+    HMemoryAccount::get(HMemoryAccount::ServerDeviceModel)->add(
+        sizeof(HServerDevice) + sizeof(HServerDevicePrivate));
 }
 
 HServerDevice::HServerDevice(HServerDevicePrivate& dd) :
     QObject(),
         h_ptr(&dd)
 {
+    HMemoryAccount::get(HMemoryAccount::ServerDeviceModel)->add(
+        sizeof(HServerDevice) + sizeof(HServerDevicePrivate));
 }
 
 HServerDevice::~HServerDevice()
 {
+    HMemoryAccount::get(HMemoryAccount::ServerDeviceModel)->remove(
+        sizeof(HServerDevice) + sizeof(HServerDevicePrivate));
+
     delete h_ptr;
 }
 
@@ -128,7 +136,7 @@ const HDeviceInfo& HServerDevice::info() const
 
 QString HServerDevice::description() const
 {
-    return h_ptr->m_deviceDescription;
+    return h_ptr->m_deviceDescription.toString();
 }
 
 QList<QUrl> HServerDevice::locations(LocationUrlType urlType) const
@@ -22,8 +22,10 @@
 #include "hserverservice.h"
 #include "hserverservice_p.h"
 
+#include "../../general/hmemoryaccount_p.h"
 #include "../../general/hlogger_p.h"
 
+#include <QtCore/QVector>
 #include <QtCore/QMetaMethod>
 
 namespace Herqq
@@ -35,7 +37,8 @@ namespace Upnp
 /*******************************************************************************
  * HServerServicePrivate
  ******************************************************************************/
-HServerServicePrivate::HServerServicePrivate()
+HServerServicePrivate::HServerServicePrivate() :
+    m_batchDepth(0), m_changedInBatch(false)
 {
 }
 
@@ -43,16 +46,40 @@ HServerServicePrivate::~HServerServicePrivate()
 {
 }
 
+void HServerServicePrivate::beginBatch()
+{
+    ++m_batchDepth;
+}
+
+void HServerServicePrivate::endBatch(bool sendEvent)
+{
+    Q_ASSERT(m_batchDepth > 0);
+
+    if (--m_batchDepth > 0)
+    {
+        return;
+    }
+
+    bool changed = m_changedInBatch;
+    m_changedInBatch = false;
+
+    if (changed && sendEvent && m_evented)
+    {
+        emit q_ptr->stateChanged(q_ptr);
+    }
+}
+
 HServerServicePrivate::ReturnValue HServerServicePrivate::updateVariables(
     const QList<QPair<QString, QString> >& variables, bool sendEvent)
 {
+    // the variables signal their changes through notifyListeners(), which
+    // would otherwise emit stateChanged() once for every variable
+    beginBatch();
+
     ReturnValue rv =
         HServicePrivate<HServerService, HServerAction, HServerStateVariable>::updateVariables(variables);
 
-    if (rv == Updated && sendEvent && m_evented)
-    {
-        emit q_ptr->stateChanged(q_ptr);
-    }
+    endBatch(sendEvent);
 
     return rv;
 }
@@ -63,15 +90,22 @@ HServerServicePrivate::ReturnValue HServerServicePrivate::updateVariables(
 HServerService::HServerService() :
     h_ptr(new HServerServicePrivate())
 {
+    HMemoryAccount::get(HMemoryAccount::ServerDeviceModel)->add(
+        sizeof(HServerService) + sizeof(HServerServicePrivate));
 }
 
 HServerService::HServerService(HServerServicePrivate& dd) :
     h_ptr(&dd)
 {
+    HMemoryAccount::get(HMemoryAccount::ServerDeviceModel)->add(
+        sizeof(HServerService) + sizeof(HServerServicePrivate));
 }
 
 HServerService::~HServerService()
 {
+    HMemoryAccount::get(HMemoryAccount::ServerDeviceModel)->remove(
+        sizeof(HServerService) + sizeof(HServerServicePrivate));
+
     delete h_ptr;
 }
 
@@ -214,9 +248,9 @@ const HServiceInfo& HServerService::info() const
     return h_ptr->m_serviceInfo;
 }
 
-const QString& HServerService::description() const
+QString HServerService::description() const
 {
-    return h_ptr->m_serviceDescription;
+    return h_ptr->m_serviceDescription.toString();
 }
 
 const HServerActions& HServerService::actions() const
@@ -231,7 +265,11 @@ const HServerStateVariables& HServerService::stateVariables() const
 
 void HServerService::notifyListeners()
 {
-    if (h_ptr->m_evented)
+    if (h_ptr->m_batchDepth > 0)
+    {
+        h_ptr->m_changedInBatch = true;
+    }
+    else if (h_ptr->m_evented)
     {
         emit stateChanged(this);
     }
@@ -252,5 +290,47 @@ bool HServerService::setValue(const QString& stateVarName, const QVariant& value
     return h_ptr->setValue(stateVarName, value);
 }
 
+bool HServerService::setValues(const QHash<QString, QVariant>& values)
+{
+    // every value is validated before anything is modified, so that either
+    // all of the variables are updated or none of them are
+    QVector<QPair<HServerStateVariable*, QVariant> > resolved;
+    resolved.reserve(values.size());
+
+    QHash<QString, QVariant>::const_iterator ci = values.constBegin();
+    for (; ci != values.constEnd(); ++ci)
+    {
+        HServerStateVariable* sv = h_ptr->m_stateVariables.value(ci.key());
+        if (!sv)
+        {
+            return false;
+        }
+
+        QVariant convertedValue;
+        if (!sv->info().isValidValue(ci.value(), &convertedValue))
+        {
+            return false;
+        }
+
+        resolved.append(qMakePair(sv, convertedValue));
+    }
+
+    h_ptr->beginBatch();
+
+    bool ok = true;
+    for (qint32 i = 0; i < resolved.size(); ++i)
+    {
+        if (resolved[i].first->value() != resolved[i].second &&
+            !resolved[i].first->setValue(resolved[i].second))
+        {
+            ok = false;
+        }
+    }
+
+    h_ptr->endBatch(true);
+
+    return ok;
+}
+
 }
 }
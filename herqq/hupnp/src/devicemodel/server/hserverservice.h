@@ -26,6 +26,7 @@
 #include <HUpnpCore/HActionInvoke>
 
 #include <QtCore/QList>
+#include <QtCore/QHash>
 #include <QtCore/QObject>
 
 class QUrl;
@@ -225,7 +226,7 @@ public:
      *
      * \return The full service description.
      */
-    const QString& description() const;
+    QString description() const;
 
     /*!
      * \brief Returns the actions the service contains.
@@ -297,6 +298,30 @@ public:
      */
     bool setValue(const QString& stateVarName, const QVariant& value);
 
+    /*!
+     * \brief Sets the values of the specified state variables as a single
+     * change.
+     *
+     * Each value is validated before any of the state variables is modified.
+     * If any of the state variables does not exist or any of the values is
+     * not accepted, none of the state variables is changed. Otherwise every
+     * state variable is set and the stateChanged() signal is emitted
+     * once for the entire change, if the service is evented and any of the
+     * values changed.
+     *
+     * \param values specifies the new values keyed by the names of the state
+     * variables.
+     *
+     * \return \e true in case all of the specified state variables were found
+     * and their values were set.
+     *
+     * \remarks Each modified state variable still emits its own
+     * HServerStateVariable::valueChanged() signal.
+     *
+     * \sa setValue()
+     */
+    bool setValues(const QHash<QString, QVariant>& values);
+
 public Q_SLOTS:
 
     /*!
@@ -51,11 +51,22 @@ class H_UPNP_CORE_EXPORT HServerServicePrivate :
 H_DECLARE_PUBLIC(HServerService)
 H_DISABLE_COPY(HServerServicePrivate)
 
+public: // attributes
+
+    qint32 m_batchDepth;
+    // while positive, the changes of state variables are collected and the
+    // service signals them only once when the outermost batch ends
+
+    bool m_changedInBatch;
+
 public: // methods
 
     HServerServicePrivate();
     virtual ~HServerServicePrivate();
 
+    void beginBatch();
+    void endBatch(bool sendEvent);
+
     ReturnValue updateVariables(
         const QList<QPair<QString, QString> >& variables, bool sendEvent);
 };
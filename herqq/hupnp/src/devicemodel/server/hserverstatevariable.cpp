@@ -25,6 +25,8 @@
 #include "../hstatevariable_p.h"
 #include "../hstatevariable_event.h"
 
+#include "../../general/hmemoryaccount_p.h"
+
 namespace Herqq
 {
 
@@ -44,10 +46,16 @@ HServerStateVariable::HServerStateVariable(
 
     h_ptr->m_info = info;
     setValue(info.defaultValue());
+
+    HMemoryAccount::get(HMemoryAccount::ServerDeviceModel)->add(
+        sizeof(HServerStateVariable) + sizeof(HStateVariablePrivate));
 }
 
 HServerStateVariable::~HServerStateVariable()
 {
+    HMemoryAccount::get(HMemoryAccount::ServerDeviceModel)->remove(
+        sizeof(HServerStateVariable) + sizeof(HStateVariablePrivate));
+
     delete h_ptr;
 }
 
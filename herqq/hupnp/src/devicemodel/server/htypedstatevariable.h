@@ -0,0 +1,203 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HTYPED_STATEVARIABLE_H_
+#define HTYPED_STATEVARIABLE_H_
+
+#include <HUpnpCore/HServerService>
+#include <HUpnpCore/HUpnpDataTypes>
+#include <HUpnpCore/HStateVariableInfo>
+#include <HUpnpCore/HServerStateVariable>
+
+#include <QtCore/QHash>
+#include <QtCore/QString>
+#include <QtCore/QVariant>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+/*!
+ * \brief This is a class template for accessing the value of a server-side
+ * UPnP state variable as a specific C++ type.
+ *
+ * The state variable is looked up and its data type is checked once, when
+ * the object is created. After that the value is read and written without
+ * the lookup by name HServerService::value() and HServerService::setValue()
+ * do and without the conversions of the value to the type the data type of
+ * the state variable maps to.
+ *
+ * The type has to be the one HUpnpDataTypes::convertToVariantType() returns
+ * for the data type of the state variable, such as \c quint32 for \c ui4 and
+ * \c QString for \c string. Otherwise the object is not bound, which you can
+ * check using isBound().
+ *
+ * \code
+ *
+ * HTypedStateVariable<quint32> numberOfTracks(service, "NumberOfTracks");
+ * Q_ASSERT(numberOfTracks.isBound());
+ *
+ * numberOfTracks.setValue(numberOfTracks.value() + 1);
+ *
+ * \endcode
+ *
+ * \headerfile htypedstatevariable.h HTypedStateVariable
+ *
+ * \ingroup hupnp_devicemodel
+ *
+ * \sa HServerStateVariable
+ *
+ * \remarks This class is not thread-safe.
+ */
+template<typename T>
+class HTypedStateVariable
+{
+private:
+
+    HServerStateVariable* m_stateVariable;
+
+    static bool isCompatible(const HServerStateVariable* stateVariable)
+    {
+        return stateVariable && qMetaTypeId<T>() == static_cast<int>(
+            HUpnpDataTypes::convertToVariantType(
+                stateVariable->info().dataType()));
+    }
+
+public:
+
+    /*!
+     * \brief Creates a new instance that is not bound to any state variable.
+     *
+     * \sa isBound()
+     */
+    HTypedStateVariable() :
+        m_stateVariable(0)
+    {
+    }
+
+    /*!
+     * \brief Creates a new instance bound to the specified state variable.
+     *
+     * \param stateVariable specifies the state variable. The object is not
+     * bound in case the data type of the state variable does not map to
+     * the type of the object.
+     */
+    explicit HTypedStateVariable(HServerStateVariable* stateVariable) :
+        m_stateVariable(isCompatible(stateVariable) ? stateVariable : 0)
+    {
+    }
+
+    /*!
+     * \brief Creates a new instance bound to the specified state variable
+     * of the specified service.
+     *
+     * \param service specifies the service that contains the state variable.
+     *
+     * \param name specifies the name of the state variable. The object is not
+     * bound in case the service has no state variable with the specified name
+     * or the data type of the state variable does not map to the type of
+     * the object.
+     */
+    HTypedStateVariable(const HServerService* service, const QString& name) :
+        m_stateVariable(0)
+    {
+        if (service)
+        {
+            HServerStateVariable* stateVariable =
+                service->stateVariables().value(name);
+
+            if (isCompatible(stateVariable))
+            {
+                m_stateVariable = stateVariable;
+            }
+        }
+    }
+
+    /*!
+     * \brief Indicates whether the object is bound to a state variable.
+     *
+     * \return \e true in case the object is bound to a state variable.
+     */
+    inline bool isBound() const { return m_stateVariable; }
+
+    /*!
+     * \brief Returns the state variable the object is bound to.
+     *
+     * \return The state variable the object is bound to or null in case
+     * the object is not bound.
+     */
+    inline HServerStateVariable* stateVariable() const
+    {
+        return m_stateVariable;
+    }
+
+    /*!
+     * \brief Returns the current value of the state variable.
+     *
+     * \return The current value of the state variable or a default-constructed
+     * value in case the object is not bound.
+     */
+    T value() const
+    {
+        // qvariant_cast returns a value of the stored type without a conversion
+        return m_stateVariable ?
+            qvariant_cast<T>(m_stateVariable->value()) : T();
+    }
+
+    /*!
+     * Changes the value of the state variable.
+     *
+     * The new value is compared to the current one before it is wrapped into
+     * a \c QVariant, which is why setting a value that equals the current one
+     * costs little.
+     *
+     * \param newValue specifies the new value of the state variable.
+     *
+     * \return \e true in case the value was changed. \e false is returned in
+     * case the object is not bound, the value equals the current value or
+     * the value violates the constraints of the state variable.
+     *
+     * \sa HServerStateVariable::setValue()
+     */
+    bool setValue(const T& newValue)
+    {
+        if (!m_stateVariable)
+        {
+            return false;
+        }
+
+        const QVariant current = m_stateVariable->value();
+        if (current.userType() == qMetaTypeId<T>() &&
+            *static_cast<const T*>(current.constData()) == newValue)
+        {
+            return false;
+        }
+
+        return m_stateVariable->setValue(QVariant::fromValue(newValue));
+    }
+};
+
+}
+}
+
+#endif /* HTYPED_STATEVARIABLE_H_ */
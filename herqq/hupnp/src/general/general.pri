@@ -3,19 +3,35 @@ HEADERS += \
     $$SRC_LOC/general/hupnp_defs.h \
     $$SRC_LOC/general/hupnp_fwd.h \
     $$SRC_LOC/general/hlogger_p.h \
+    $$SRC_LOC/general/hlogsink.h \
+    $$SRC_LOC/general/hlogsink_p.h \
+    $$SRC_LOC/general/htracing.h \
+    $$SRC_LOC/general/htrace_p.h \
+    $$SRC_LOC/general/hmemoryusage.h \
+    $$SRC_LOC/general/hmemoryaccount_p.h \
+    $$SRC_LOC/general/htrafficcapture.h \
+    $$SRC_LOC/general/htrafficcapture_p.h \
     $$SRC_LOC/general/hupnp_global_p.h \
     $$SRC_LOC/general/hupnp_global.h \
     $$SRC_LOC/general/hclonable.h \
     $$SRC_LOC/general/hupnpinfo.h \
     $$SRC_LOC/general/hupnp_datatypes.h \
-    $$SRC_LOC/general/hupnp_datatypes_p.h
+    $$SRC_LOC/general/hupnp_datatypes_p.h \
+    $$SRC_LOC/general/hxmlfragment_p.h
 
 SOURCES += \
     $$SRC_LOC/general/hupnp_global.cpp \
     $$SRC_LOC/general/hclonable.cpp \
     $$SRC_LOC/general/hlogger_p.cpp \
+    $$SRC_LOC/general/hlogsink.cpp \
+    $$SRC_LOC/general/htracing.cpp \
+    $$SRC_LOC/general/hmemoryusage.cpp \
+    $$SRC_LOC/general/htrafficcapture.cpp \
     $$SRC_LOC/general/hupnpinfo.cpp \
-    $$SRC_LOC/general/hupnp_datatypes.cpp
+    $$SRC_LOC/general/hupnp_datatypes.cpp \
+    $$SRC_LOC/general/hxmlfragment_p.cpp
 
 EXPORTED_PRIVATE_HEADERS += \
-    $$SRC_LOC/general/hlogger_p.h
\ No newline at end of file
+    $$SRC_LOC/general/hlogger_p.h \
+    $$SRC_LOC/general/hmemoryaccount_p.h \
+    $$SRC_LOC/general/hxmlfragment_p.h
@@ -20,10 +20,14 @@
  */
 
 #include "hlogger_p.h"
+#include "hlogsink.h"
 
 #include <QtCore/QtDebug>
+#include <QtCore/QThread>
 #include <QtCore/QString>
 #include <QtCore/QByteArray>
+#include <QtCore/QAtomicPointer>
+#include <QtCore/QElapsedTimer>
 
 namespace Herqq
 {
@@ -31,32 +35,59 @@ namespace Herqq
 volatile int HLogger::s_logLevel = static_cast<qint32>(Critical);
 volatile bool HLogger::s_nonStdWarningsEnabled = true;
 
-HLogger::HLogger() :
-    m_methodName(0), m_logPrefix(0)
+namespace
 {
+QAtomicPointer<Upnp::HLogSink> s_sink(0);
+// not owned
 }
 
-HLogger::HLogger(const char* at, const char* methodName, const char* logPrefix) :
-    m_methodName(methodName), m_logPrefix(logPrefix)
+void HLogger::setSink(Upnp::HLogSink* sink)
 {
-    if (traceLevel() == All)
+    s_sink.fetchAndStoreOrdered(sink);
+}
+
+void HLogger::output(qint32 level, const QString& text)
+{
+    Upnp::HLogSink* sink = s_sink.fetchAndAddOrdered(0);
+    Upnp::HLogRecord record(
+        static_cast<Upnp::HLogLevel>(level), text,
+        QElapsedTimer::msecsSinceReference(), QThread::currentThreadId());
+
+    if (sink)
     {
-        QString stmt = (m_logPrefix ? QString(m_logPrefix) : QString()).append(
-            QString("Entering %1 @ %2").arg(m_methodName, at));
+        sink->write(record);
+    }
+    else if (level != Fatal)
+    {
+        Upnp::HLogSink::writeToQt(record);
+    }
 
-        qDebug() << stmt;
+    if (level == Fatal)
+    {
+        qFatal("%s", text.toLocal8Bit().data());
     }
 }
 
-HLogger::~HLogger()
+HLogger::HLogger() :
+    m_methodName(0), m_logPrefix(0)
 {
-    if (traceLevel() == All)
-    {
-        QString stmt = (m_logPrefix ? QString(m_logPrefix) : QString()).append(
-            QString("Exiting %1").arg(m_methodName));
+}
 
-        qDebug() << stmt;
-    }
+HLogger::HLogger(const char* logPrefix) :
+    m_methodName(0), m_logPrefix(logPrefix)
+{
+}
+
+void HLogger::logEntry(const char* at)
+{
+    output(All, (m_logPrefix ? QString(m_logPrefix) : QString()).append(
+        QString("Entering %1 @ %2").arg(m_methodName, at)));
+}
+
+void HLogger::logExit()
+{
+    output(All, (m_logPrefix ? QString(m_logPrefix) : QString()).append(
+        QString("Exiting %1").arg(m_methodName)));
 }
 
 namespace
@@ -69,43 +100,43 @@ inline QString stmt(const char* prefix, const QString& text)
 
 void HLogger::logDebug(const QString& text)
 {
-    qDebug() << stmt(m_logPrefix, text);
+    output(Debug, stmt(m_logPrefix, text));
 }
 
 void HLogger::logWarning(const QString& text)
 {
-    qWarning() << stmt(m_logPrefix, text);
+    output(Warning, stmt(m_logPrefix, text));
 }
 
 void HLogger::logWarningNonStd(const QString& text)
 {
     if (s_nonStdWarningsEnabled)
     {
-        qWarning() << stmt(
-            m_logPrefix, QString("**NON-STANDARD BEHAVIOR**: %1").arg(text));
+        output(Warning, stmt(
+            m_logPrefix, QString("**NON-STANDARD BEHAVIOR**: %1").arg(text)));
     }
 }
 
 void HLogger::logInformation(const QString& text)
 {
-    qDebug() << stmt(m_logPrefix, text);
+    output(Information, stmt(m_logPrefix, text));
 }
 
 void HLogger::logFatal(const QString& text)
 {
-    qFatal("%s", stmt(m_logPrefix, text).toLocal8Bit().data());
+    output(Fatal, stmt(m_logPrefix, text));
 }
 
 void HLogger::logCritical(const QString& text)
 {
-    qCritical() << stmt(m_logPrefix, text);
+    output(Critical, stmt(m_logPrefix, text));
 }
 
 void HLogger::logDebug_(const QString& text)
 {
     if (traceLevel() >= Debug)
     {
-        qDebug() << text;
+        output(Debug, text);
     }
 }
 
@@ -113,7 +144,7 @@ void HLogger::logWarning_(const QString& text)
 {
     if (traceLevel() >= Warning)
     {
-        qWarning() << text;
+        output(Warning, text);
     }
 }
 
@@ -121,7 +152,7 @@ void HLogger::logWarningNonStd_(const QString& text)
 {
     if (traceLevel() && s_nonStdWarningsEnabled)
     {
-        qWarning() << QString("**NON-STANDARD BEHAVIOR**: %1").arg(text);
+        output(Warning, QString("**NON-STANDARD BEHAVIOR**: %1").arg(text));
     }
 }
 
@@ -129,7 +160,7 @@ void HLogger::logInformation_(const QString& text)
 {
     if (traceLevel() >= Information)
     {
-        qDebug() << text;
+        output(Information, text);
     }
 }
 
@@ -137,7 +168,7 @@ void HLogger::logCritical_(const QString& text)
 {
     if (traceLevel() >= Critical)
     {
-        qCritical() << text;
+        output(Critical, text);
     }
 }
 
@@ -145,7 +176,7 @@ void HLogger::logFatal_(const QString& text)
 {
     if (traceLevel() >= Fatal)
     {
-        qFatal("%s", text.toLocal8Bit().data());
+        output(Fatal, text);
     }
 }
 
@@ -37,6 +37,11 @@ class QString;
 namespace Herqq
 {
 
+namespace Upnp
+{
+class HLogSink;
+}
+
 //
 //
 //
@@ -52,6 +57,12 @@ private:
     static volatile int s_logLevel;
     static volatile bool s_nonStdWarningsEnabled;
 
+    void logEntry(const char* at);
+    void logExit();
+
+    static void output(qint32 level, const QString& text);
+    // writes the text to the sink, if one is set
+
 public:
 
     enum HLogLevel
@@ -68,8 +79,28 @@ public:
 public:
 
     HLogger ();
-    HLogger (const char* at, const char* methodName, const char* logPrefix = 0);
-    ~HLogger();
+    explicit HLogger (const char* logPrefix);
+    // does not trace the entry and the exit of a function
+
+    // the level is checked inline, since a logger is created on the entry of
+    // nearly every function and the entry and the exit are rarely traced
+    inline HLogger (
+        const char* at, const char* methodName, const char* logPrefix = 0) :
+            m_methodName(methodName), m_logPrefix(logPrefix)
+    {
+        if (traceLevel() == All)
+        {
+            logEntry(at);
+        }
+    }
+
+    inline ~HLogger()
+    {
+        if (m_methodName && traceLevel() == All)
+        {
+            logExit();
+        }
+    }
 
     // the instance methods log the method name if it was specified. static
     // equivalents do not.
@@ -95,6 +126,13 @@ public:
         s_nonStdWarningsEnabled = arg;
     }
 
+    inline static bool nonStdWarningsEnabled()
+    {
+        return s_nonStdWarningsEnabled;
+    }
+
+    static void setSink(Upnp::HLogSink* sink);
+
     static void logDebug_        (const QString& text);
     static void logWarning_      (const QString& text);
     static void logWarningNonStd_(const QString& text);
@@ -103,16 +141,34 @@ public:
     static void logFatal_        (const QString& text);
 };
 
+//
+// The text of a log statement is evaluated only if the statement is logged.
+// Defining HUPNP_NO_TRACE, which the DISABLE_TRACE configuration of the
+// project files does, compiles the tracing of function entries and exits
+// out, but the logging of the statements remains.
+//
+#ifndef HUPNP_NO_TRACE
 #define HLOG(at, fun) \
     Herqq::HLogger herqqLog__(at, fun);
 
 #define HLOG2(at, fun, logPrefix) \
     Herqq::HLogger herqqLog__(at, fun, logPrefix);
+#else
+#define HLOG(at, fun) \
+    Herqq::HLogger herqqLog__;
+
+#define HLOG2(at, fun, logPrefix) \
+    Herqq::HLogger herqqLog__(logPrefix);
+#endif
 
 #define CHECK_LEVEL(level) \
     if (Herqq::HLogger::traceLevel() < Herqq::HLogger::level) ; \
     else
 
+#define CHECK_NONSTD \
+    if (!Herqq::HLogger::nonStdWarningsEnabled()) ; \
+    else
+
 #define HLOG_WARN(text) \
     CHECK_LEVEL(Warning) herqqLog__.logWarning(text);
 
@@ -120,7 +176,7 @@ public:
     CHECK_LEVEL(Warning) herqqLog__.logWarning(text, at);
 
 #define HLOG_WARN_NONSTD(text) \
-    CHECK_LEVEL(Warning) herqqLog__.logWarningNonStd(text);
+    CHECK_LEVEL(Warning) CHECK_NONSTD herqqLog__.logWarningNonStd(text);
 
 #define HLOG_WARN_NONSTD_AT(text, at) \
     CHECK_LEVEL(Warning) herqqLog__.logWarning(text, at);
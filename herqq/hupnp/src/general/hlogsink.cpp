@@ -0,0 +1,274 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "hlogsink.h"
+#include "hlogsink_p.h"
+
+#include <QtCore/QtDebug>
+#include <QtCore/QMutexLocker>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace
+{
+// the interval the writer thread checks the buffer while it waits, in case
+// a wake-up was missed
+const unsigned long WriterPollIntervalInMsecs = 100;
+
+inline qint32 load(const QAtomicInt& value)
+{
+    return const_cast<QAtomicInt&>(value).fetchAndAddOrdered(0);
+}
+
+inline qint32 distance(quint32 sequence, quint32 position)
+{
+    return static_cast<qint32>(sequence - position);
+}
+}
+
+/*******************************************************************************
+ * HLogRecord
+ ******************************************************************************/
+HLogRecord::HLogRecord() :
+    m_level(None), m_text(), m_timestamp(0), m_threadId(0)
+{
+}
+
+HLogRecord::HLogRecord(
+    HLogLevel level, const QString& text, qint64 timestamp,
+    Qt::HANDLE threadId) :
+        m_level(level), m_text(text), m_timestamp(timestamp),
+        m_threadId(threadId)
+{
+}
+
+/*******************************************************************************
+ * HLogSink
+ ******************************************************************************/
+HLogSink::HLogSink()
+{
+}
+
+HLogSink::~HLogSink()
+{
+}
+
+void HLogSink::writeToQt(const HLogRecord& record)
+{
+    switch(record.level())
+    {
+    case Fatal:
+    case Critical:
+        qCritical() << record.text();
+        break;
+    case Warning:
+        qWarning() << record.text();
+        break;
+    default:
+        qDebug() << record.text();
+        break;
+    }
+}
+
+/*******************************************************************************
+ * HLogRingBuffer
+ ******************************************************************************/
+HLogRingBuffer::HLogRingBuffer(quint32 capacity) :
+    m_slots(capacity), m_mask(capacity - 1), m_writePos(0), m_readPos(0)
+{
+    Q_ASSERT(capacity >= 2 && (capacity & m_mask) == 0);
+
+    for(quint32 i = 0; i < capacity; ++i)
+    {
+        m_slots[i].m_sequence.fetchAndStoreOrdered(i);
+    }
+}
+
+bool HLogRingBuffer::put(const HLogRecord& record)
+{
+    quint32 pos = load(m_writePos);
+    for(;;)
+    {
+        Slot& slot = m_slots[pos & m_mask];
+        qint32 dist = distance(load(slot.m_sequence), pos);
+        if (dist == 0)
+        {
+            if (m_writePos.testAndSetOrdered(pos, pos + 1))
+            {
+                slot.m_record = record;
+                slot.m_sequence.fetchAndStoreOrdered(pos + 1);
+                return true;
+            }
+        }
+        else if (dist < 0)
+        {
+            return false;
+        }
+
+        pos = load(m_writePos);
+    }
+}
+
+bool HLogRingBuffer::isEmpty() const
+{
+    const Slot& slot = m_slots[m_readPos & m_mask];
+    return distance(load(slot.m_sequence), m_readPos + 1) < 0;
+}
+
+bool HLogRingBuffer::take(HLogRecord* record)
+{
+    if (isEmpty())
+    {
+        return false;
+    }
+
+    Slot& slot = m_slots[m_readPos & m_mask];
+    *record = slot.m_record;
+    slot.m_record = HLogRecord();
+    slot.m_sequence.fetchAndStoreOrdered(m_readPos + m_mask + 1);
+    ++m_readPos;
+
+    return true;
+}
+
+/*******************************************************************************
+ * HLogWriterThread
+ ******************************************************************************/
+HLogWriterThread::HLogWriterThread(HAsyncLogSinkPrivate* owner) :
+    m_owner(owner)
+{
+}
+
+void HLogWriterThread::run()
+{
+    while(!m_owner->m_stopping)
+    {
+        m_owner->writeRecords();
+
+        // a producer that sees the flag set waits for the mutex, which is
+        // released only once this thread waits. a record put before the flag
+        // was set is seen by the check
+        QMutexLocker lock(&m_owner->m_mutex);
+        m_owner->m_sleeping.fetchAndStoreOrdered(1);
+
+        if (!m_owner->m_stopping && m_owner->m_buffer.isEmpty())
+        {
+            m_owner->m_wakeUp.wait(
+                &m_owner->m_mutex, WriterPollIntervalInMsecs);
+        }
+
+        m_owner->m_sleeping.fetchAndStoreOrdered(0);
+    }
+
+    m_owner->writeRecords();
+}
+
+/*******************************************************************************
+ * HAsyncLogSinkPrivate
+ ******************************************************************************/
+HAsyncLogSinkPrivate::HAsyncLogSinkPrivate(
+    HLogSink* target, quint32 capacity) :
+        m_target(target), m_buffer(capacity), m_dropped(0), m_sleeping(0),
+        m_stopping(false), m_mutex(), m_wakeUp(), m_thread(this)
+{
+}
+
+HAsyncLogSinkPrivate::~HAsyncLogSinkPrivate()
+{
+    delete m_target;
+}
+
+void HAsyncLogSinkPrivate::wakeWriter()
+{
+    if (m_sleeping.testAndSetOrdered(1, 0))
+    {
+        QMutexLocker lock(&m_mutex);
+        m_wakeUp.wakeOne();
+    }
+}
+
+void HAsyncLogSinkPrivate::writeRecords()
+{
+    HLogRecord record;
+    while(m_buffer.take(&record))
+    {
+        if (m_target)
+        {
+            m_target->write(record);
+        }
+        else
+        {
+            HLogSink::writeToQt(record);
+        }
+    }
+}
+
+/*******************************************************************************
+ * HAsyncLogSink
+ ******************************************************************************/
+HAsyncLogSink::HAsyncLogSink(HLogSink* target, qint32 capacity) :
+    h_ptr(0)
+{
+    quint32 size = 2;
+    while(static_cast<qint64>(size) < capacity && size < (1u << 30))
+    {
+        size <<= 1;
+    }
+
+    h_ptr = new HAsyncLogSinkPrivate(target, size);
+    h_ptr->m_thread.start(QThread::LowPriority);
+}
+
+HAsyncLogSink::~HAsyncLogSink()
+{
+    {
+        QMutexLocker lock(&h_ptr->m_mutex);
+        h_ptr->m_stopping = true;
+        h_ptr->m_wakeUp.wakeOne();
+    }
+
+    h_ptr->m_thread.wait();
+    delete h_ptr;
+}
+
+void HAsyncLogSink::write(const HLogRecord& record)
+{
+    if (!h_ptr->m_buffer.put(record))
+    {
+        h_ptr->m_dropped.fetchAndAddOrdered(1);
+        return;
+    }
+
+    h_ptr->wakeWriter();
+}
+
+qint64 HAsyncLogSink::droppedRecords() const
+{
+    return load(h_ptr->m_dropped);
+}
+
+}
+}
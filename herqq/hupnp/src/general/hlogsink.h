@@ -0,0 +1,240 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef HLOGSINK_H_
+#define HLOGSINK_H_
+
+#include <HUpnpCore/HUpnp>
+
+#include <QtCore/QString>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+class HAsyncLogSinkPrivate;
+
+/*!
+ * \brief This class contains a single log message of HUPnP.
+ *
+ * \headerfile hlogsink.h HLogRecord
+ *
+ * \ingroup hupnp_common
+ *
+ * \sa HLogSink
+ */
+class H_UPNP_CORE_EXPORT HLogRecord
+{
+private:
+
+    HLogLevel m_level;
+    QString m_text;
+    qint64 m_timestamp;
+    Qt::HANDLE m_threadId;
+
+public:
+
+    /*!
+     * \brief Creates a new, empty instance.
+     */
+    HLogRecord();
+
+    /*!
+     * \brief Creates a new instance.
+     *
+     * \param level specifies the level of the message.
+     *
+     * \param text specifies the message.
+     *
+     * \param timestamp specifies the time the message was logged in
+     * milliseconds of a monotonic clock.
+     *
+     * \param threadId specifies the thread that logged the message.
+     */
+    HLogRecord(
+        HLogLevel level, const QString& text, qint64 timestamp,
+        Qt::HANDLE threadId);
+
+    /*!
+     * \brief Returns the level of the message.
+     *
+     * \return The level of the message.
+     */
+    inline HLogLevel level() const { return m_level; }
+
+    /*!
+     * \brief Returns the message.
+     *
+     * \return The message.
+     */
+    inline QString text() const { return m_text; }
+
+    /*!
+     * \brief Returns the time the message was logged.
+     *
+     * \return The time the message was logged in milliseconds of a monotonic
+     * clock. Only the differences of the timestamps are meaningful.
+     */
+    inline qint64 timestamp() const { return m_timestamp; }
+
+    /*!
+     * \brief Returns the thread that logged the message.
+     *
+     * \return The ID of the thread that logged the message, as returned by
+     * \c QThread::currentThreadId().
+     */
+    inline Qt::HANDLE threadId() const { return m_threadId; }
+};
+
+/*!
+ * \brief This is an abstract base class for the destinations of the log
+ * messages of HUPnP.
+ *
+ * By default HUPnP writes its log messages with \c qDebug(), \c qWarning()
+ * and \c qCritical() in the thread that logs the message. You can direct
+ * the messages elsewhere by deriving from this class and setting an instance
+ * of it as the sink of HUPnP with Herqq::Upnp::SetLogSink().
+ *
+ * \headerfile hlogsink.h HLogSink
+ *
+ * \ingroup hupnp_common
+ *
+ * \sa HAsyncLogSink, SetLogSink()
+ *
+ * \remarks write() is called from every thread that logs a message and
+ * it has to be thread-safe.
+ */
+class H_UPNP_CORE_EXPORT HLogSink
+{
+H_DISABLE_COPY(HLogSink)
+
+public:
+
+    /*!
+     * \brief Creates a new instance.
+     */
+    HLogSink();
+
+    /*!
+     * \brief Destroys the instance.
+     */
+    virtual ~HLogSink() = 0;
+
+    /*!
+     * \brief Writes a log message.
+     *
+     * \param record specifies the log message.
+     *
+     * \remarks Fatal messages are always written with \c qFatal() once they
+     * have been given to the sink, since the application is terminated.
+     */
+    virtual void write(const HLogRecord& record) = 0;
+
+    /*!
+     * \brief Writes a log message with \c qDebug(), \c qWarning() or
+     * \c qCritical() depending on its level.
+     *
+     * This is what HUPnP does when no sink is set.
+     *
+     * \param record specifies the log message.
+     */
+    static void writeToQt(const HLogRecord& record);
+};
+
+/*!
+ * \brief This class is a log sink that writes the log messages in a
+ * background thread.
+ *
+ * The calling thread only stores the message in a bounded buffer, which
+ * does not use locks, and returns. A background thread takes the messages
+ * from the buffer and writes them to the target sink, or with
+ * HLogSink::writeToQt() if no target was specified. This keeps the latency
+ * of writing the messages to a console or to a file away from the threads
+ * that handle the network traffic.
+ *
+ * When the buffer is full, new messages are dropped and counted. The number
+ * of dropped messages is available through droppedRecords().
+ *
+ * \headerfile hlogsink.h HAsyncLogSink
+ *
+ * \ingroup hupnp_common
+ *
+ * \sa HLogSink, SetLogSink()
+ *
+ * \remarks This class is thread-safe.
+ */
+class H_UPNP_CORE_EXPORT HAsyncLogSink :
+    public HLogSink
+{
+H_DISABLE_COPY(HAsyncLogSink)
+
+private:
+
+    HAsyncLogSinkPrivate* h_ptr;
+
+public:
+
+    /*!
+     * \brief Creates a new instance and starts its background thread.
+     *
+     * \param target specifies the sink the messages are written to in the
+     * background thread. The ownership of the sink is transferred to the
+     * created instance. If the target is null, the messages are written with
+     * HLogSink::writeToQt().
+     *
+     * \param capacity specifies the maximum number of messages waiting to be
+     * written. The value is rounded up to the next power of two and values
+     * smaller than 2 are treated as 2.
+     */
+    explicit HAsyncLogSink(HLogSink* target = 0, qint32 capacity = 4096);
+
+    /*!
+     * \brief Writes the messages that are waiting to be written, stops the
+     * background thread and destroys the instance.
+     *
+     * \remarks Remove the sink from use with SetLogSink() before destroying
+     * it.
+     */
+    virtual ~HAsyncLogSink();
+
+    /*!
+     * \brief Stores the message to be written in the background thread.
+     *
+     * \param record specifies the log message.
+     */
+    virtual void write(const HLogRecord& record);
+
+    /*!
+     * \brief Returns the number of messages dropped because the buffer
+     * was full.
+     *
+     * \return The number of messages dropped because the buffer was full.
+     */
+    qint64 droppedRecords() const;
+};
+
+}
+}
+
+#endif /* HLOGSINK_H_ */
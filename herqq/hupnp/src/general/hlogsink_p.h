@@ -0,0 +1,150 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef HLOGSINK_P_H_
+#define HLOGSINK_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include "hlogsink.h"
+
+#include <QtCore/QMutex>
+#include <QtCore/QVector>
+#include <QtCore/QThread>
+#include <QtCore/QAtomicInt>
+#include <QtCore/QWaitCondition>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+//
+// A bounded queue from which a single consumer takes the records that any
+// number of producers put in it without locks
+//
+// Every slot has a sequence number that tells whose turn it is to use the
+// slot. A producer claims a slot by advancing the write position once the
+// sequence number shows the slot is free and it publishes the record by
+// advancing the sequence number. The consumer frees the slot the same way.
+//
+class HLogRingBuffer
+{
+H_DISABLE_COPY(HLogRingBuffer)
+
+private:
+
+    struct Slot
+    {
+        QAtomicInt m_sequence;
+        HLogRecord m_record;
+    };
+
+    QVector<Slot> m_slots;
+    const quint32 m_mask;
+
+    QAtomicInt m_writePos;
+    quint32 m_readPos;
+    // only the consumer uses the read position
+
+public:
+
+    explicit HLogRingBuffer(quint32 capacity);
+    // the capacity has to be a power of two
+
+    bool put(const HLogRecord&);
+    // returns false if the buffer is full
+
+    bool take(HLogRecord*);
+    // returns false if the buffer is empty. called only by the consumer
+
+    bool isEmpty() const;
+    // called only by the consumer
+};
+
+//
+//
+//
+class HLogWriterThread :
+    public QThread
+{
+H_DISABLE_COPY(HLogWriterThread)
+
+private:
+
+    HAsyncLogSinkPrivate* m_owner;
+
+protected:
+
+    virtual void run();
+
+public:
+
+    explicit HLogWriterThread(HAsyncLogSinkPrivate* owner);
+};
+
+//
+// Implementation details of HAsyncLogSink
+//
+class HAsyncLogSinkPrivate
+{
+H_DISABLE_COPY(HAsyncLogSinkPrivate)
+
+public:
+
+    HLogSink* m_target;
+    // owned. the records are written with HLogSink::writeToQt() if null
+
+    HLogRingBuffer m_buffer;
+
+    QAtomicInt m_dropped;
+
+    QAtomicInt m_sleeping;
+    // 1 when the writer thread waits for records. the producers take the
+    // mutex to wake the writer only in this case
+
+    volatile bool m_stopping;
+
+    QMutex m_mutex;
+    QWaitCondition m_wakeUp;
+
+    HLogWriterThread m_thread;
+
+    HAsyncLogSinkPrivate(HLogSink* target, quint32 capacity);
+    ~HAsyncLogSinkPrivate();
+
+    void wakeWriter();
+    void writeRecords();
+    // writes the records until the buffer is empty
+};
+
+}
+}
+
+#endif /* HLOGSINK_P_H_ */
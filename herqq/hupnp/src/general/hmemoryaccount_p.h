@@ -0,0 +1,160 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HMEMORYACCOUNT_P_H_
+#define HMEMORYACCOUNT_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include "hupnp_defs.h"
+
+#include <QtCore/QList>
+#include <QtCore/QString>
+#include <QtCore/QMutex>
+#include <QtCore/QAtomicInt>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+class HMemoryAccountRegistry;
+
+#if QT_VERSION >= 0x050300
+typedef QAtomicInteger<qint64> HMemoryCounter;
+#else
+//
+// A 64-bit counter with the interface of QAtomicInteger<qint64>, which Qt
+// provides only from 5.3 onwards. QAtomicInt is 32 bits wide, which is not
+// enough for the byte counts, so the value is protected by a mutex instead.
+//
+class HMemoryCounter
+{
+H_DISABLE_COPY(HMemoryCounter)
+
+private:
+
+    QMutex m_mutex;
+    qint64 m_value;
+
+public:
+
+    explicit HMemoryCounter(qint64 value);
+
+    qint64 fetchAndAddOrdered(qint64 valueToAdd);
+    qint64 fetchAndStoreOrdered(qint64 newValue);
+    bool testAndSetOrdered(qint64 expectedValue, qint64 newValue);
+
+    inline qint64 fetchAndAddRelaxed(qint64 valueToAdd)
+    {
+        return fetchAndAddOrdered(valueToAdd);
+    }
+};
+#endif
+
+//
+// Estimates the memory used by a subsystem: the number of objects the
+// subsystem holds and the number of bytes they use. The estimates are
+// updated by the subsystem itself whenever it allocates or releases memory.
+// With Qt 5.3 and later the updates take no locks, which is why the
+// accounts can be updated even where no lock is allowed. With older Qt
+// versions each counter has a mutex of its own that is held only for the
+// update. See HMemoryUsage for the public interface.
+//
+// The accounts are never deleted, which means that an account can be used
+// by objects that are destroyed when the program exits.
+//
+class H_UPNP_CORE_EXPORT HMemoryAccount
+{
+H_DISABLE_COPY(HMemoryAccount)
+friend class HMemoryAccountRegistry;
+
+public:
+
+    // the accounts of HUPnP Core, which exist from the start. the other
+    // libraries and applications create their accounts with get()
+    enum Subsystem
+    {
+        ClientDeviceModel,
+        ServerDeviceModel,
+        DescriptionCache,
+        ClientSubscriptions,
+        ServerSubscriptions,
+        HttpBuffers,
+        SsdpQueues,
+        SubsystemCount
+    };
+
+private:
+
+    const QString m_name;
+
+    HMemoryCounter m_objects;
+    HMemoryCounter m_bytes;
+    HMemoryCounter m_peakBytes;
+
+    explicit HMemoryAccount(const QString& name);
+
+public:
+
+    // returns the account of the specified subsystem of HUPnP Core
+    static HMemoryAccount* get(Subsystem);
+
+    // returns the account with the specified name, creating it if needed.
+    // a caller should look the account up once and keep the pointer
+    static HMemoryAccount* get(const QString& name);
+
+    // every account in the order the accounts were created
+    static QList<HMemoryAccount*> accounts();
+
+    inline const QString& name() const { return m_name; }
+
+    void add(qint64 bytes, qint32 objects = 1);
+
+    inline void remove(qint64 bytes, qint32 objects = 1)
+    {
+        add(-bytes, -objects);
+    }
+
+    // changes the number of bytes used by the objects already counted
+    inline void resize(qint64 bytes)
+    {
+        add(bytes, 0);
+    }
+
+    qint64 objects() const;
+    qint64 bytes() const;
+    qint64 peakBytes() const;
+
+    void resetPeak();
+};
+
+}
+}
+
+#endif /* HMEMORYACCOUNT_P_H_ */
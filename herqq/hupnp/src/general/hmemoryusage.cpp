@@ -0,0 +1,307 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hmemoryusage.h"
+#include "hmemoryaccount_p.h"
+
+#include <QtCore/QMutex>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QMutexLocker>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+#if QT_VERSION < 0x050300
+/*******************************************************************************
+ * HMemoryCounter
+ ******************************************************************************/
+HMemoryCounter::HMemoryCounter(qint64 value) :
+    m_mutex(), m_value(value)
+{
+}
+
+qint64 HMemoryCounter::fetchAndAddOrdered(qint64 valueToAdd)
+{
+    QMutexLocker lock(&m_mutex);
+    qint64 retVal = m_value;
+    m_value += valueToAdd;
+    return retVal;
+}
+
+qint64 HMemoryCounter::fetchAndStoreOrdered(qint64 newValue)
+{
+    QMutexLocker lock(&m_mutex);
+    qint64 retVal = m_value;
+    m_value = newValue;
+    return retVal;
+}
+
+bool HMemoryCounter::testAndSetOrdered(qint64 expectedValue, qint64 newValue)
+{
+    QMutexLocker lock(&m_mutex);
+    if (m_value != expectedValue)
+    {
+        return false;
+    }
+
+    m_value = newValue;
+    return true;
+}
+#endif
+
+/*******************************************************************************
+ * HMemoryAccountRegistry
+ ******************************************************************************/
+//
+// The registry and the accounts in it are never deleted
+//
+class HMemoryAccountRegistry
+{
+H_DISABLE_COPY(HMemoryAccountRegistry)
+
+public:
+
+    QMutex m_mutex;
+    QList<HMemoryAccount*> m_accounts;
+    HMemoryAccount* m_core[HMemoryAccount::SubsystemCount];
+
+    HMemoryAccountRegistry() :
+        m_mutex(), m_accounts()
+    {
+        static const char* names[HMemoryAccount::SubsystemCount] =
+        {
+            "client.devicemodel", "server.devicemodel",
+            "client.descriptioncache", "client.subscriptions",
+            "server.subscriptions", "http.buffers", "ssdp.queues"
+        };
+
+        for(qint32 i = 0; i < HMemoryAccount::SubsystemCount; ++i)
+        {
+            m_core[i] = new HMemoryAccount(QString::fromLatin1(names[i]));
+            m_accounts.append(m_core[i]);
+        }
+    }
+
+    HMemoryAccount* find(const QString& name) const
+    {
+        foreach(HMemoryAccount* account, m_accounts)
+        {
+            if (account->name() == name)
+            {
+                return account;
+            }
+        }
+        return 0;
+    }
+
+    HMemoryAccount* create(const QString& name)
+    {
+        HMemoryAccount* account = new HMemoryAccount(name);
+        m_accounts.append(account);
+        return account;
+    }
+};
+
+namespace
+{
+HMemoryAccountRegistry* registry()
+{
+    static HMemoryAccountRegistry* registry = new HMemoryAccountRegistry();
+    return registry;
+}
+}
+
+/*******************************************************************************
+ * HMemoryAccount
+ ******************************************************************************/
+HMemoryAccount::HMemoryAccount(const QString& name) :
+    m_name(name), m_objects(0), m_bytes(0), m_peakBytes(0)
+{
+}
+
+HMemoryAccount* HMemoryAccount::get(Subsystem subsystem)
+{
+    Q_ASSERT(subsystem >= 0 && subsystem < SubsystemCount);
+    return registry()->m_core[subsystem];
+}
+
+HMemoryAccount* HMemoryAccount::get(const QString& name)
+{
+    HMemoryAccountRegistry* reg = registry();
+    QMutexLocker lock(&reg->m_mutex);
+
+    HMemoryAccount* retVal = reg->find(name);
+    return retVal ? retVal : reg->create(name);
+}
+
+QList<HMemoryAccount*> HMemoryAccount::accounts()
+{
+    HMemoryAccountRegistry* reg = registry();
+    QMutexLocker lock(&reg->m_mutex);
+    return reg->m_accounts;
+}
+
+void HMemoryAccount::add(qint64 bytes, qint32 objects)
+{
+    if (objects)
+    {
+        m_objects.fetchAndAddRelaxed(objects);
+    }
+
+    if (!bytes)
+    {
+        return;
+    }
+
+    qint64 current = m_bytes.fetchAndAddOrdered(bytes) + bytes;
+
+    qint64 peak = m_peakBytes.fetchAndAddOrdered(0);
+    while(current > peak &&
+          !m_peakBytes.testAndSetOrdered(peak, current))
+    {
+        peak = m_peakBytes.fetchAndAddOrdered(0);
+    }
+}
+
+qint64 HMemoryAccount::objects() const
+{
+    return const_cast<HMemoryCounter&>(m_objects).fetchAndAddOrdered(0);
+}
+
+qint64 HMemoryAccount::bytes() const
+{
+    return const_cast<HMemoryCounter&>(m_bytes).fetchAndAddOrdered(0);
+}
+
+qint64 HMemoryAccount::peakBytes() const
+{
+    return const_cast<HMemoryCounter&>(m_peakBytes).fetchAndAddOrdered(0);
+}
+
+void HMemoryAccount::resetPeak()
+{
+    m_peakBytes.fetchAndStoreOrdered(bytes());
+}
+
+/*******************************************************************************
+ * HMemoryUsage
+ ******************************************************************************/
+HMemoryUsage::HMemoryUsage()
+{
+}
+
+QStringList HMemoryUsage::subsystems()
+{
+    QStringList retVal;
+    foreach(HMemoryAccount* account, HMemoryAccount::accounts())
+    {
+        retVal.append(account->name());
+    }
+    return retVal;
+}
+
+qint64 HMemoryUsage::objects(const QString& subsystem)
+{
+    foreach(HMemoryAccount* account, HMemoryAccount::accounts())
+    {
+        if (account->name() == subsystem)
+        {
+            return account->objects();
+        }
+    }
+    return 0;
+}
+
+qint64 HMemoryUsage::bytes(const QString& subsystem)
+{
+    foreach(HMemoryAccount* account, HMemoryAccount::accounts())
+    {
+        if (account->name() == subsystem)
+        {
+            return account->bytes();
+        }
+    }
+    return 0;
+}
+
+qint64 HMemoryUsage::peakBytes(const QString& subsystem)
+{
+    foreach(HMemoryAccount* account, HMemoryAccount::accounts())
+    {
+        if (account->name() == subsystem)
+        {
+            return account->peakBytes();
+        }
+    }
+    return 0;
+}
+
+qint64 HMemoryUsage::totalBytes()
+{
+    qint64 retVal = 0;
+    foreach(HMemoryAccount* account, HMemoryAccount::accounts())
+    {
+        retVal += account->bytes();
+    }
+    return retVal;
+}
+
+void HMemoryUsage::resetPeaks()
+{
+    foreach(HMemoryAccount* account, HMemoryAccount::accounts())
+    {
+        account->resetPeak();
+    }
+}
+
+QString HMemoryUsage::summary()
+{
+    QString retVal = QString("%1 %2 %3 %4 %5\n").arg(
+        "subsystem", -24).arg("objects", 10).arg("bytes", 14).arg(
+            "bytes/object", 12).arg("peak bytes", 14);
+
+    qint64 totalObjects = 0, totalBytes = 0;
+    foreach(HMemoryAccount* account, HMemoryAccount::accounts())
+    {
+        qint64 objects = account->objects();
+        qint64 bytes = account->bytes();
+
+        retVal.append(QString("%1 %2 %3 %4 %5\n").arg(
+            account->name(), -24).arg(objects, 10).arg(bytes, 14).arg(
+                objects > 0 ? bytes / objects : 0, 12).arg(
+                    account->peakBytes(), 14));
+
+        totalObjects += objects;
+        totalBytes += bytes;
+    }
+
+    retVal.append(QString("%1 %2 %3\n").arg("total", -24).arg(
+        totalObjects, 10).arg(totalBytes, 14));
+
+    return retVal;
+}
+
+}
+}
@@ -0,0 +1,148 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HMEMORYUSAGE_H_
+#define HMEMORYUSAGE_H_
+
+#include <HUpnpCore/HUpnp>
+
+class QString;
+class QStringList;
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+/*!
+ * \brief This class is used to query the memory used by the subsystems of
+ * HUPnP.
+ *
+ * HUPnP keeps an account of the objects and the bytes held by each of its
+ * main subsystems. The accounts are estimates: the size of an object is
+ * computed from the sizes of its fixed-size parts and the lengths of the
+ * strings and the byte arrays it holds, but the bookkeeping of the heap and
+ * of the containers is not included. The estimates are precise enough to
+ * compare the cost of a subsystem between releases and to extrapolate the
+ * cost of a larger deployment, such as a control point that discovers
+ * a few thousand devices, without running a heap profiler.
+ *
+ * The accounts of HUPnP Core are:
+ *
+ * \li \c client.devicemodel: the devices, services, actions and state
+ * variables built by the control points
+ * \li \c server.devicemodel: the devices, services, actions and state
+ * variables hosted by the device hosts
+ * \li \c client.descriptioncache: the service descriptions the control points
+ * share between the devices of the same model
+ * \li \c client.subscriptions: the event subscriptions of the control points
+ * \li \c server.subscriptions: the event subscribers of the device hosts
+ * \li \c http.buffers: the HTTP messages queued for sending
+ * \li \c ssdp.queues: the received SSDP datagrams waiting to be processed
+ *
+ * Other libraries, such as HUPnP Av, add accounts of their own.
+ *
+ * \headerfile hmemoryusage.h HMemoryUsage
+ *
+ * \ingroup hupnp_common
+ *
+ * \remarks This class is thread-safe. The accounts are shared by every
+ * device host and control point in the process.
+ */
+class H_UPNP_CORE_EXPORT HMemoryUsage
+{
+H_DISABLE_COPY(HMemoryUsage)
+
+private:
+
+    HMemoryUsage();
+
+public:
+
+    /*!
+     * \brief Returns the names of the subsystems that have an account.
+     *
+     * \return The names of the subsystems that have an account, in the
+     * order the accounts were created.
+     */
+    static QStringList subsystems();
+
+    /*!
+     * \brief Returns the number of objects held by a subsystem.
+     *
+     * \param subsystem specifies the name of the subsystem.
+     *
+     * \return The number of objects held by the subsystem, or zero in case
+     * the subsystem does not have an account.
+     */
+    static qint64 objects(const QString& subsystem);
+
+    /*!
+     * \brief Returns the estimated number of bytes used by a subsystem.
+     *
+     * \param subsystem specifies the name of the subsystem.
+     *
+     * \return The estimated number of bytes used by the subsystem, or zero in
+     * case the subsystem does not have an account.
+     */
+    static qint64 bytes(const QString& subsystem);
+
+    /*!
+     * \brief Returns the largest number of bytes a subsystem has used.
+     *
+     * \param subsystem specifies the name of the subsystem.
+     *
+     * \return The largest number of bytes the subsystem has used since
+     * the start or since resetPeaks() was called.
+     *
+     * \sa resetPeaks()
+     */
+    static qint64 peakBytes(const QString& subsystem);
+
+    /*!
+     * \brief Returns the estimated number of bytes used by every subsystem.
+     *
+     * \return The estimated number of bytes used by every subsystem.
+     */
+    static qint64 totalBytes();
+
+    /*!
+     * \brief Sets the peak of every account to the current number of bytes.
+     *
+     * \sa peakBytes()
+     */
+    static void resetPeaks();
+
+    /*!
+     * \brief Returns a table of the accounts suitable for logging.
+     *
+     * \return A table with a row for each subsystem listing the number of
+     * objects, the number of bytes, the number of bytes per object and the
+     * peak number of bytes, followed by the totals.
+     */
+    static QString summary();
+};
+
+}
+}
+
+#endif /* HMEMORYUSAGE_H_ */
@@ -0,0 +1,135 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef HTRACE_P_H_
+#define HTRACE_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include "hupnp_defs.h"
+
+#include <QtCore/QtGlobal>
+
+class QIODevice;
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+//
+// Stores the spans of the structured tracing. See HTracing for the public
+// interface
+//
+class H_UPNP_CORE_EXPORT HTraceRecorder
+{
+H_DISABLE_COPY(HTraceRecorder)
+
+private:
+
+    HTraceRecorder();
+
+    static volatile bool s_enabled;
+
+public:
+
+    static inline bool isEnabled() { return s_enabled; }
+    static void setEnabled(bool enable, qint32 maxEvents);
+
+    static qint64 now();
+    // the current time in microseconds of a monotonic clock
+
+    static quint32 newRequestId();
+    // never returns zero, which stands for "no request"
+
+    static void complete(
+        const char* category, const char* name, qint64 startUs,
+        quint32 requestId);
+    // records a span that started at startUs and ends now. the category and
+    // the name have to be string literals
+
+    static void clear();
+    static qint64 droppedEvents();
+    static bool writeChromeTrace(QIODevice*);
+};
+
+//
+// Records the stages of a pipeline as consecutive spans. The current stage ends
+// when the next one is started or when the object is destroyed
+//
+class HTraceSpan
+{
+H_DISABLE_COPY(HTraceSpan)
+
+private:
+
+    const char* m_category;
+    const char* m_name;
+    qint64 m_start;
+    quint32 m_requestId;
+
+public:
+
+    inline HTraceSpan(
+        const char* category, const char* name, quint32 requestId = 0) :
+            m_category(category), m_name(name),
+            m_start(HTraceRecorder::isEnabled() ? HTraceRecorder::now() : -1),
+            m_requestId(requestId)
+    {
+    }
+
+    inline ~HTraceSpan()
+    {
+        end();
+    }
+
+    inline void setRequestId(quint32 requestId) { m_requestId = requestId; }
+    inline quint32 requestId() const { return m_requestId; }
+
+    inline void next(const char* name)
+    {
+        end();
+        m_name = name;
+        m_start = HTraceRecorder::isEnabled() ? HTraceRecorder::now() : -1;
+    }
+
+    inline void end()
+    {
+        if (m_start >= 0 && m_name)
+        {
+            HTraceRecorder::complete(m_category, m_name, m_start, m_requestId);
+        }
+        m_name = 0;
+    }
+};
+
+}
+}
+
+#endif /* HTRACE_P_H_ */
@@ -0,0 +1,254 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "htracing.h"
+#include "htrace_p.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QThread>
+#include <QtCore/QVector>
+#include <QtCore/QIODevice>
+#include <QtCore/QByteArray>
+#include <QtCore/QAtomicInt>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QCoreApplication>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace
+{
+
+struct TraceEvent
+{
+    const char* m_category;
+    const char* m_name;
+    qint64 m_start;
+    qint64 m_duration;
+    Qt::HANDLE m_threadId;
+    quint32 m_requestId;
+};
+
+class TraceStore
+{
+public:
+
+    QMutex m_mutex;
+    QVector<TraceEvent> m_events;
+    qint32 m_maxEvents;
+    qint64 m_dropped;
+
+    QElapsedTimer m_clock;
+
+    TraceStore() :
+        m_mutex(), m_events(), m_maxEvents(0), m_dropped(0), m_clock()
+    {
+        m_clock.start();
+    }
+};
+
+TraceStore* traceStore()
+{
+    static TraceStore store;
+    return &store;
+}
+
+QAtomicInt s_lastRequestId;
+
+}
+
+/*******************************************************************************
+ * HTraceRecorder
+ ******************************************************************************/
+volatile bool HTraceRecorder::s_enabled = false;
+
+void HTraceRecorder::setEnabled(bool enable, qint32 maxEvents)
+{
+    TraceStore* store = traceStore();
+    QMutexLocker lock(&store->m_mutex);
+    if (enable)
+    {
+        store->m_maxEvents = maxEvents < 0 ? 0 : maxEvents;
+    }
+    s_enabled = enable;
+}
+
+qint64 HTraceRecorder::now()
+{
+#if QT_VERSION >= 0x040800
+    return traceStore()->m_clock.nsecsElapsed() / 1000;
+#else
+    return traceStore()->m_clock.elapsed() * 1000;
+#endif
+}
+
+quint32 HTraceRecorder::newRequestId()
+{
+    quint32 retVal;
+    do
+    {
+        retVal = static_cast<quint32>(
+            s_lastRequestId.fetchAndAddRelaxed(1) + 1);
+    }
+    while(!retVal);
+
+    return retVal;
+}
+
+void HTraceRecorder::complete(
+    const char* category, const char* name, qint64 startUs, quint32 requestId)
+{
+    if (!s_enabled)
+    {
+        return;
+    }
+
+    TraceEvent event;
+    event.m_category = category;
+    event.m_name = name;
+    event.m_start = startUs;
+    event.m_duration = now() - startUs;
+    event.m_threadId = QThread::currentThreadId();
+    event.m_requestId = requestId;
+
+    TraceStore* store = traceStore();
+    QMutexLocker lock(&store->m_mutex);
+    if (store->m_events.size() >= store->m_maxEvents)
+    {
+        ++store->m_dropped;
+        return;
+    }
+    store->m_events.append(event);
+}
+
+void HTraceRecorder::clear()
+{
+    TraceStore* store = traceStore();
+    QMutexLocker lock(&store->m_mutex);
+    store->m_events.clear();
+    store->m_dropped = 0;
+}
+
+qint64 HTraceRecorder::droppedEvents()
+{
+    TraceStore* store = traceStore();
+    QMutexLocker lock(&store->m_mutex);
+    return store->m_dropped;
+}
+
+bool HTraceRecorder::writeChromeTrace(QIODevice* dev)
+{
+    Q_ASSERT(dev);
+
+    TraceStore* store = traceStore();
+    QVector<TraceEvent> events;
+    {
+        QMutexLocker lock(&store->m_mutex);
+        events = store->m_events;
+    }
+
+    QByteArray pid = QByteArray::number(QCoreApplication::applicationPid());
+
+    QHash<Qt::HANDLE, qint32> threadIds;
+    // the viewers show the threads in the order of their ids, which is why
+    // the threads are numbered in the order they appear
+
+    QByteArray data("{\"traceEvents\":[");
+    for (qint32 i = 0; i < events.size(); ++i)
+    {
+        const TraceEvent& event = events[i];
+
+        QHash<Qt::HANDLE, qint32>::const_iterator it =
+            threadIds.constFind(event.m_threadId);
+
+        qint32 tid = it == threadIds.constEnd() ?
+            threadIds.insert(event.m_threadId, threadIds.size() + 1).value() :
+            it.value();
+
+        if (i > 0)
+        {
+            data.append(',');
+        }
+
+        data.append("\n{\"name\":\"").append(event.m_name);
+        data.append("\",\"cat\":\"").append(event.m_category);
+        data.append("\",\"ph\":\"X\",\"ts\":");
+        data.append(QByteArray::number(event.m_start));
+        data.append(",\"dur\":").append(QByteArray::number(event.m_duration));
+        data.append(",\"pid\":").append(pid);
+        data.append(",\"tid\":").append(QByteArray::number(tid));
+        data.append(",\"args\":{\"request\":");
+        data.append(QByteArray::number(event.m_requestId)).append("}}");
+
+        if (data.size() >= 64 * 1024)
+        {
+            if (dev->write(data) != data.size())
+            {
+                return false;
+            }
+            data.clear();
+        }
+    }
+    data.append("\n],\"displayTimeUnit\":\"ms\"}\n");
+
+    return dev->write(data) == data.size();
+}
+
+/*******************************************************************************
+ * HTracing
+ ******************************************************************************/
+HTracing::HTracing()
+{
+}
+
+void HTracing::setEnabled(bool enable, qint32 maxEvents)
+{
+    HTraceRecorder::setEnabled(enable, maxEvents);
+}
+
+bool HTracing::isEnabled()
+{
+    return HTraceRecorder::isEnabled();
+}
+
+void HTracing::clear()
+{
+    HTraceRecorder::clear();
+}
+
+qint64 HTracing::droppedEvents()
+{
+    return HTraceRecorder::droppedEvents();
+}
+
+bool HTracing::writeChromeTrace(QIODevice* dev)
+{
+    return HTraceRecorder::writeChromeTrace(dev);
+}
+
+}
+}
@@ -0,0 +1,127 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef HTRACING_H_
+#define HTRACING_H_
+
+#include <HUpnpCore/HUpnp>
+
+class QIODevice;
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+/*!
+ * \brief This class is used to control the structured tracing of HUPnP.
+ *
+ * When tracing is enabled HUPnP records a timed span for every stage of its
+ * main pipelines:
+ *
+ * \li SSDP messages: \c receive, \c parse and \c dispatch
+ * \li HTTP messages: \c accept, \c header, \c body, \c handler and
+ * \c write on the server side and \c write, \c wait, \c header and
+ * \c body when HUPnP sends a request and waits for the response
+ * \li action invocations of a control point: \c serialize, \c queue,
+ * \c network and \c parse
+ * \li device builds of a control point: \c queue, \c description and
+ * \c model
+ *
+ * The spans that belong to the same message or request share a request id,
+ * which makes it possible to follow a single request through the stages.
+ * The recorded spans can be written in the Chrome trace event format, which
+ * can be viewed with a timeline viewer such as \c chrome://tracing.
+ *
+ * Tracing is disabled by default and when it is disabled the cost
+ * of a span is a single check of a flag.
+ *
+ * \headerfile htracing.h HTracing
+ *
+ * \ingroup hupnp_common
+ *
+ * \remarks This class is thread-safe.
+ */
+class H_UPNP_CORE_EXPORT HTracing
+{
+H_DISABLE_COPY(HTracing)
+
+private:
+
+    HTracing();
+
+public:
+
+    /*!
+     * \brief Enables or disables the recording of spans.
+     *
+     * \param enable specifies whether spans are recorded.
+     *
+     * \param maxEvents specifies the maximum number of spans kept in memory.
+     * Once the limit is reached new spans are dropped until clear() is called.
+     * The limit is ignored when \a enable is \e false.
+     *
+     * \sa isEnabled(), clear()
+     */
+    static void setEnabled(bool enable, qint32 maxEvents = 100000);
+
+    /*!
+     * \brief Indicates whether spans are recorded.
+     *
+     * \return \e true in case spans are recorded.
+     *
+     * \sa setEnabled()
+     */
+    static bool isEnabled();
+
+    /*!
+     * \brief Removes the recorded spans and resets the number of dropped spans.
+     */
+    static void clear();
+
+    /*!
+     * \brief Returns the number of spans dropped because the limit
+     * of recorded spans was reached.
+     *
+     * \return The number of spans dropped because the limit
+     * of recorded spans was reached.
+     */
+    static qint64 droppedEvents();
+
+    /*!
+     * \brief Writes the recorded spans in the Chrome trace event format.
+     *
+     * \param dev specifies the device to which the spans are written. The
+     * device has to be open for writing.
+     *
+     * \return \e true in case the spans were written.
+     *
+     * \remarks The recorded spans are not removed.
+     */
+    static bool writeChromeTrace(QIODevice* dev);
+};
+
+}
+}
+
+#endif /* HTRACING_H_ */
@@ -0,0 +1,311 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "htrafficcapture.h"
+#include "htrafficcapture_p.h"
+
+#include <QtCore/QMutex>
+#include <QtCore/QIODevice>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QElapsedTimer>
+#include <QtNetwork/QHostAddress>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace
+{
+
+class CaptureStore
+{
+public:
+
+    QMutex m_mutex;
+    QDataStream m_stream;
+    qint32 m_maxPayloadSize;
+    qint64 m_captured;
+
+    QElapsedTimer m_clock;
+
+    CaptureStore() :
+        m_mutex(), m_stream(), m_maxPayloadSize(0), m_captured(0), m_clock()
+    {
+    }
+
+    inline qint64 now() const
+    {
+#if QT_VERSION >= 0x040800
+        return m_clock.nsecsElapsed() / 1000;
+#else
+        return m_clock.elapsed() * 1000;
+#endif
+    }
+};
+
+CaptureStore* captureStore()
+{
+    static CaptureStore store;
+    return &store;
+}
+
+}
+
+/*******************************************************************************
+ * HTrafficRecorder
+ ******************************************************************************/
+volatile bool HTrafficRecorder::s_enabled = false;
+
+bool HTrafficRecorder::start(QIODevice* dev, qint32 maxPayloadSize)
+{
+    Q_ASSERT(dev);
+
+    CaptureStore* store = captureStore();
+    QMutexLocker lock(&store->m_mutex);
+    if (s_enabled || !dev->isWritable())
+    {
+        return false;
+    }
+
+    store->m_stream.setDevice(dev);
+    store->m_stream.setVersion(QDataStream::Qt_4_6);
+    store->m_stream.resetStatus();
+    store->m_stream << quint32(Magic) << quint16(Version);
+    if (store->m_stream.status() != QDataStream::Ok)
+    {
+        store->m_stream.setDevice(0);
+        return false;
+    }
+
+    store->m_maxPayloadSize = maxPayloadSize < 0 ? 0 : maxPayloadSize;
+    store->m_captured = 0;
+    store->m_clock.start();
+    s_enabled = true;
+
+    return true;
+}
+
+void HTrafficRecorder::stop()
+{
+    CaptureStore* store = captureStore();
+    QMutexLocker lock(&store->m_mutex);
+    s_enabled = false;
+    store->m_stream.setDevice(0);
+}
+
+qint64 HTrafficRecorder::capturedMessages()
+{
+    CaptureStore* store = captureStore();
+    QMutexLocker lock(&store->m_mutex);
+    return store->m_captured;
+}
+
+void HTrafficRecorder::record(
+    HTrafficCaptureReader::Protocol protocol,
+    HTrafficCaptureReader::Direction direction,
+    const HEndpoint& local, const HEndpoint& peer, const QByteArray& data)
+{
+    if (!s_enabled)
+    {
+        return;
+    }
+
+    CaptureStore* store = captureStore();
+    QMutexLocker lock(&store->m_mutex);
+    if (!s_enabled)
+    {
+        // the capture was stopped while this was waiting for the lock
+        return;
+    }
+
+    QDataStream& out = store->m_stream;
+    out << quint8((protocol << 1) | direction) << store->now()
+        << local.hostAddress() << local.portNumber()
+        << peer.hostAddress() << peer.portNumber()
+        << qint32(data.size());
+
+    if (store->m_maxPayloadSize > 0 && data.size() > store->m_maxPayloadSize)
+    {
+        out << data.left(store->m_maxPayloadSize);
+    }
+    else
+    {
+        out << data;
+    }
+
+    if (out.status() != QDataStream::Ok)
+    {
+        // the device is full or it was closed. the capture is stopped, since
+        // a capture that has holes in it cannot be replayed faithfully
+        s_enabled = false;
+        out.setDevice(0);
+        return;
+    }
+
+    ++store->m_captured;
+}
+
+/*******************************************************************************
+ * HTrafficCapture
+ ******************************************************************************/
+HTrafficCapture::HTrafficCapture()
+{
+}
+
+bool HTrafficCapture::start(QIODevice* dev, qint32 maxPayloadSize)
+{
+    return HTrafficRecorder::start(dev, maxPayloadSize);
+}
+
+void HTrafficCapture::stop()
+{
+    HTrafficRecorder::stop();
+}
+
+bool HTrafficCapture::isEnabled()
+{
+    return HTrafficRecorder::isEnabled();
+}
+
+qint64 HTrafficCapture::capturedMessages()
+{
+    return HTrafficRecorder::capturedMessages();
+}
+
+/*******************************************************************************
+ * HTrafficCaptureReaderPrivate
+ ******************************************************************************/
+HTrafficCaptureReaderPrivate::HTrafficCaptureReaderPrivate(QIODevice* dev) :
+    m_stream(dev),
+    m_valid(false),
+    m_timestamp(0),
+    m_protocol(HTrafficCaptureReader::Ssdp),
+    m_direction(HTrafficCaptureReader::Inbound),
+    m_local(),
+    m_peer(),
+    m_data(),
+    m_size(0)
+{
+    m_stream.setVersion(QDataStream::Qt_4_6);
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    m_stream >> magic >> version;
+
+    m_valid = m_stream.status() == QDataStream::Ok &&
+              magic == HTrafficRecorder::Magic &&
+              version == HTrafficRecorder::Version;
+}
+
+/*******************************************************************************
+ * HTrafficCaptureReader
+ ******************************************************************************/
+HTrafficCaptureReader::HTrafficCaptureReader(QIODevice* dev) :
+    h_ptr(new HTrafficCaptureReaderPrivate(dev))
+{
+}
+
+HTrafficCaptureReader::~HTrafficCaptureReader()
+{
+    delete h_ptr;
+}
+
+bool HTrafficCaptureReader::isValid() const
+{
+    return h_ptr->m_valid;
+}
+
+bool HTrafficCaptureReader::readNext()
+{
+    if (!h_ptr->m_valid || h_ptr->m_stream.atEnd())
+    {
+        return false;
+    }
+
+    quint8 kind = 0;
+    qint64 timestamp = 0;
+    QHostAddress localAddress, peerAddress;
+    quint16 localPort = 0, peerPort = 0;
+    qint32 size = 0;
+    QByteArray data;
+
+    QDataStream& in = h_ptr->m_stream;
+    in >> kind >> timestamp >> localAddress >> localPort
+       >> peerAddress >> peerPort >> size >> data;
+
+    if (in.status() != QDataStream::Ok || kind > 3)
+    {
+        // a capture is cut short when the process capturing it is killed.
+        // the messages read so far are still valid
+        h_ptr->m_valid = false;
+        return false;
+    }
+
+    h_ptr->m_protocol = static_cast<Protocol>(kind >> 1);
+    h_ptr->m_direction = static_cast<Direction>(kind & 1);
+    h_ptr->m_timestamp = timestamp;
+    h_ptr->m_local = HEndpoint(localAddress, localPort);
+    h_ptr->m_peer = HEndpoint(peerAddress, peerPort);
+    h_ptr->m_size = size;
+    h_ptr->m_data = data;
+
+    return true;
+}
+
+qint64 HTrafficCaptureReader::timestamp() const
+{
+    return h_ptr->m_timestamp;
+}
+
+HTrafficCaptureReader::Protocol HTrafficCaptureReader::protocol() const
+{
+    return h_ptr->m_protocol;
+}
+
+HTrafficCaptureReader::Direction HTrafficCaptureReader::direction() const
+{
+    return h_ptr->m_direction;
+}
+
+HEndpoint HTrafficCaptureReader::localEndpoint() const
+{
+    return h_ptr->m_local;
+}
+
+HEndpoint HTrafficCaptureReader::peer() const
+{
+    return h_ptr->m_peer;
+}
+
+QByteArray HTrafficCaptureReader::data() const
+{
+    return h_ptr->m_data;
+}
+
+qint32 HTrafficCaptureReader::size() const
+{
+    return h_ptr->m_size;
+}
+
+}
+}
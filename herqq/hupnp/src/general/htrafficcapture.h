@@ -0,0 +1,283 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HTRAFFICCAPTURE_H_
+#define HTRAFFICCAPTURE_H_
+
+#include <HUpnpCore/HUpnp>
+
+class QIODevice;
+class QByteArray;
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+/*!
+ * \brief This class is used to capture the SSDP and HTTP traffic of HUPnP.
+ *
+ * When capturing is enabled every SSDP datagram and every HTTP message
+ * HUPnP sends or receives is written to the capture device along with
+ * the time it was sent or received and the endpoints it was exchanged
+ * between. This covers the traffic of every HDeviceHost, HControlPoint and
+ * HSsdp instance in the process. The captured traffic can be read with
+ * HTrafficCaptureReader, which makes it possible to replay the traffic seen
+ * in the field, such as the discovery pattern of a particular renderer, against
+ * an HDeviceHost or an HControlPoint in the lab.
+ *
+ * Capturing is disabled by default and when it is disabled the cost
+ * of a message is a single check of a flag.
+ *
+ * \headerfile htrafficcapture.h HTrafficCapture
+ *
+ * \ingroup hupnp_common
+ *
+ * \remarks This class is thread-safe.
+ *
+ * \sa HTrafficCaptureReader, HTracing
+ */
+class H_UPNP_CORE_EXPORT HTrafficCapture
+{
+H_DISABLE_COPY(HTrafficCapture)
+
+private:
+
+    HTrafficCapture();
+
+public:
+
+    /*!
+     * \brief Starts to capture the traffic.
+     *
+     * \param dev specifies the device to which the traffic is written. The
+     * device has to be open for writing and it has to stay valid until
+     * stop() is called. The ownership of the device is not transferred.
+     *
+     * \param maxPayloadSize specifies the maximum number of bytes of a message
+     * that are written. The rest of a larger message, such as a large
+     * response body, is left out, but the original size of the message is
+     * captured. Zero means that messages are captured in full.
+     *
+     * \return \e true in case the capture was started. The capture
+     * cannot be started in case it is already running or the header of the
+     * capture cannot be written to the device.
+     *
+     * \sa stop(), isEnabled()
+     */
+    static bool start(QIODevice* dev, qint32 maxPayloadSize = 64 * 1024);
+
+    /*!
+     * \brief Stops capturing the traffic.
+     *
+     * Once this returns HUPnP does not access the capture device anymore.
+     *
+     * \sa start()
+     */
+    static void stop();
+
+    /*!
+     * \brief Indicates whether the traffic is being captured.
+     *
+     * \return \e true in case the traffic is being captured.
+     */
+    static bool isEnabled();
+
+    /*!
+     * \brief Returns the number of messages captured since the capture was
+     * last started.
+     *
+     * \return The number of messages captured since the capture was
+     * last started.
+     */
+    static qint64 capturedMessages();
+};
+
+class HTrafficCaptureReaderPrivate;
+
+/*!
+ * \brief This class is used to read the traffic captured by HTrafficCapture.
+ *
+ * The messages are read in the order they were captured:
+ *
+ * \code
+ *
+ * QFile file("capture.bin");
+ * file.open(QIODevice::ReadOnly);
+ *
+ * HTrafficCaptureReader reader(&file);
+ * while (reader.readNext())
+ * {
+ *     if (reader.protocol() == HTrafficCaptureReader::Ssdp &&
+ *         reader.direction() == HTrafficCaptureReader::Inbound)
+ *     {
+ *         // reader.data() contains the datagram received from reader.peer()
+ *     }
+ * }
+ *
+ * \endcode
+ *
+ * \headerfile htrafficcapture.h HTrafficCaptureReader
+ *
+ * \ingroup hupnp_common
+ *
+ * \remarks This class is not thread-safe.
+ *
+ * \sa HTrafficCapture
+ */
+class H_UPNP_CORE_EXPORT HTrafficCaptureReader
+{
+H_DISABLE_COPY(HTrafficCaptureReader)
+
+private:
+
+    HTrafficCaptureReaderPrivate* h_ptr;
+
+public:
+
+    /*!
+     * \brief This enumeration specifies the protocol a message belongs to.
+     */
+    enum Protocol
+    {
+        /*!
+         * The message is an SSDP datagram.
+         */
+        Ssdp = 0,
+
+        /*!
+         * The message is an HTTP request or response, including its body.
+         */
+        Http = 1
+    };
+
+    /*!
+     * \brief This enumeration specifies whether a message was sent or
+     * received.
+     */
+    enum Direction
+    {
+        /*!
+         * The message was received from the peer.
+         */
+        Inbound = 0,
+
+        /*!
+         * The message was sent to the peer.
+         */
+        Outbound = 1
+    };
+
+    /*!
+     * \brief Creates a new instance.
+     *
+     * \param dev specifies the device from which the capture is read. The
+     * device has to be open for reading and it has to outlive this instance.
+     * The ownership of the device is not transferred.
+     *
+     * \sa isValid()
+     */
+    explicit HTrafficCaptureReader(QIODevice* dev);
+
+    /*!
+     * \brief Destroys the instance.
+     */
+    ~HTrafficCaptureReader();
+
+    /*!
+     * \brief Indicates whether the device contains a capture this
+     * instance can read.
+     *
+     * \return \e true in case the device contains a capture this
+     * instance can read.
+     */
+    bool isValid() const;
+
+    /*!
+     * \brief Reads the next message.
+     *
+     * \return \e true in case a message was read, in which case the accessors
+     * return the information of the message. \e false is returned at the end of
+     * the capture and in case the capture is invalid or truncated.
+     */
+    bool readNext();
+
+    /*!
+     * \brief Returns the time the message was captured.
+     *
+     * \return The time the message was captured in microseconds since the
+     * capture was started.
+     */
+    qint64 timestamp() const;
+
+    /*!
+     * \brief Returns the protocol of the message.
+     *
+     * \return The protocol of the message.
+     */
+    Protocol protocol() const;
+
+    /*!
+     * \brief Returns whether the message was sent or received.
+     *
+     * \return Whether the message was sent or received.
+     */
+    Direction direction() const;
+
+    /*!
+     * \brief Returns the local endpoint of the message.
+     *
+     * \return The endpoint the message was received at or sent from. The
+     * endpoint is null in case it was not known.
+     */
+    HEndpoint localEndpoint() const;
+
+    /*!
+     * \brief Returns the remote endpoint of the message.
+     *
+     * \return The endpoint the message was received from or sent to.
+     */
+    HEndpoint peer() const;
+
+    /*!
+     * \brief Returns the captured data of the message.
+     *
+     * \return The captured data of the message, which is the complete message
+     * unless it was larger than the maximum payload size of the capture.
+     *
+     * \sa size()
+     */
+    QByteArray data() const;
+
+    /*!
+     * \brief Returns the original size of the message.
+     *
+     * \return The original size of the message in bytes, which is larger
+     * than the size of data() in case the message was cut.
+     */
+    qint32 size() const;
+};
+
+}
+}
+
+#endif /* HTRAFFICCAPTURE_H_ */
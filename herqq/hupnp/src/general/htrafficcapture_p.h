@@ -0,0 +1,111 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HTRAFFICCAPTURE_P_H_
+#define HTRAFFICCAPTURE_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include "htrafficcapture.h"
+#include "../socket/hendpoint.h"
+
+#include <QtCore/QByteArray>
+#include <QtCore/QDataStream>
+
+class QIODevice;
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+//
+// Writes the captured messages. See HTrafficCapture for the public interface.
+//
+// The capture is a QDataStream that starts with a magic number and a format
+// version, which are followed by the messages in the order they were captured.
+// Each message is the protocol and the direction packed into a byte, the time
+// in microseconds since the capture was started, the local and the remote
+// address and port, the original size of the message and the captured bytes.
+//
+class H_UPNP_CORE_EXPORT HTrafficRecorder
+{
+H_DISABLE_COPY(HTrafficRecorder)
+
+private:
+
+    HTrafficRecorder();
+
+    static volatile bool s_enabled;
+
+public:
+
+    enum
+    {
+        Magic = 0x48545243,
+        Version = 1
+    };
+
+    static inline bool isEnabled() { return s_enabled; }
+
+    static bool start(QIODevice*, qint32 maxPayloadSize);
+    static void stop();
+    static qint64 capturedMessages();
+
+    static void record(
+        HTrafficCaptureReader::Protocol, HTrafficCaptureReader::Direction,
+        const HEndpoint& local, const HEndpoint& peer, const QByteArray& data);
+};
+
+//
+//
+//
+class HTrafficCaptureReaderPrivate
+{
+H_DISABLE_COPY(HTrafficCaptureReaderPrivate)
+
+public:
+
+    QDataStream m_stream;
+    bool m_valid;
+
+    qint64 m_timestamp;
+    HTrafficCaptureReader::Protocol m_protocol;
+    HTrafficCaptureReader::Direction m_direction;
+    HEndpoint m_local;
+    HEndpoint m_peer;
+    QByteArray m_data;
+    qint32 m_size;
+
+    explicit HTrafficCaptureReaderPrivate(QIODevice*);
+};
+
+}
+}
+
+#endif /* HTRAFFICCAPTURE_P_H_ */
@@ -21,6 +21,7 @@
 
 #include "hupnp_datatypes.h"
 #include "hupnp_datatypes_p.h"
+#include "hxmlfragment_p.h"
 
 #include <QtCore/QUrl>
 #include <QtCore/QDateTime>
@@ -31,102 +32,241 @@ namespace Herqq
 namespace Upnp
 {
 
+namespace
+{
+typedef QVariant (*ParseFunction)(const QString&);
+typedef QString (*FormatFunction)(const QVariant&);
+
+//
+// Conversions of the values of a single UPnP data type. The entries are
+// indexed by HUpnpDataTypes::DataType, which is why the order matters.
+//
+struct DataTypeEntry
+{
+    const char* m_name;
+    // the UDA defined name of the data type
+
+    QVariant::Type m_variantType;
 
-SoapType::SoapType(
-    const QString& name, HUpnpDataTypes::DataType dt, const QVariant& value) :
-        QtSoapSimpleType()
+    ParseFunction m_parse;
+    FormatFunction m_format;
+};
+
+inline const QChar* skipSpace(const QChar* it, const QChar* end)
 {
-    Q_ASSERT(!name.isEmpty());
-    Q_ASSERT_X(value.isValid(), "", name.toLocal8Bit());
-    Q_ASSERT(dt != HUpnpDataTypes::Undefined);
+    while (it != end && it->isSpace())
+    {
+        ++it;
+    }
+    return it;
+}
+
+// parses a decimal integer that fits in 32 bits without the overhead of the
+// generic conversions of QString, which go through the C locale. returns
+// false in case the value is not a plain integer, in which case the caller
+// falls back to the generic conversion
+bool parseInteger(const QString& value, qint64* retVal)
+{
+    const QChar* end = value.constData() + value.size();
+    const QChar* it = skipSpace(value.constData(), end);
+    while (end != it && (end - 1)->isSpace())
+    {
+        --end;
+    }
 
-    n = QtSoapQName(name);
-    t = convertToSoapType(dt);
+    bool negative = false;
+    if (it != end && (*it == QLatin1Char('-') || *it == QLatin1Char('+')))
+    {
+        negative = *it == QLatin1Char('-');
+        ++it;
+    }
 
-    if (dt == HUpnpDataTypes::uri)
+    if (it == end || end - it > 10)
     {
-        // the qtsoap library handles its "anyURI" type as it does almost any other
-        // type, as string. However, at the time of writing this (with Qt 4.5.3)
-        // the QVariant does not support toString() for Url types.
-        v = value.toUrl().toString();
+        return false;
     }
-    else
+
+    qint64 result = 0;
+    for (; it != end; ++it)
     {
-        v = value;
+        ushort digit = it->unicode() - '0';
+        if (digit > 9)
+        {
+            return false;
+        }
+        result = result * 10 + digit;
     }
+
+    *retVal = negative ? -result : result;
+    return true;
 }
 
-QtSoapType::Type convertToSoapType(HUpnpDataTypes::DataType upnpDataType)
+QVariant parseSigned(const QString& value)
 {
-    switch (upnpDataType)
+    qint64 result;
+    if (parseInteger(value, &result) &&
+        result >= -2147483647 - 1 && result <= 2147483647)
     {
-    case HUpnpDataTypes::i1:
-        return QtSoapType::Byte;
+        return static_cast<qint32>(result);
+    }
 
-    case HUpnpDataTypes::i2:
-        return QtSoapType::Short;
+    return value.toInt();
+}
 
-    case HUpnpDataTypes::i4:
-    case HUpnpDataTypes::integer:
-        return QtSoapType::Integer;
+QVariant parseUnsigned(const QString& value)
+{
+    qint64 result;
+    if (parseInteger(value, &result) &&
+        result >= 0 && result <= Q_INT64_C(4294967295))
+    {
+        return static_cast<quint32>(result);
+    }
 
-    case HUpnpDataTypes::ui1:
-        return QtSoapType::UnsignedByte;
+    return value.toUInt();
+}
 
-    case HUpnpDataTypes::ui2:
-        return QtSoapType::UnsignedShort;
+QVariant parseReal(const QString& value)
+{
+    // integral values are common and they are exactly representable
+    qint64 result;
+    if (parseInteger(value, &result))
+    {
+        return static_cast<double>(result);
+    }
 
-    case HUpnpDataTypes::ui4:
-        return QtSoapType::UnsignedInt;
+    return value.toDouble();
+}
 
-    case HUpnpDataTypes::r4:
-    case HUpnpDataTypes::r8:
-    case HUpnpDataTypes::number:
-    case HUpnpDataTypes::fixed_14_4:
-        return QtSoapType::Double;
+QVariant parseCharacter(const QString& value)
+{
+    return !value.isEmpty() ? QChar(value[0]) : QVariant(QVariant::Char);
+}
 
-    case HUpnpDataTypes::fp:
-        return QtSoapType::Float;
+QVariant parseString(const QString& value)
+{
+    return value;
+}
 
-    case HUpnpDataTypes::character:
-    case HUpnpDataTypes::string:
-        return QtSoapType::String;
+QVariant parseDate(const QString& value)
+{
+    return QDate::fromString(value, Qt::ISODate);
+}
 
-    case HUpnpDataTypes::date:
-        return QtSoapType::Date;
+QVariant parseDateTime(const QString& value)
+{
+    return QDateTime::fromString(value, Qt::ISODate);
+}
 
-    case HUpnpDataTypes::dateTime:
-    case HUpnpDataTypes::dateTimeTz:
-        return QtSoapType::DateTime;
+QVariant parseTime(const QString& value)
+{
+    return QTime::fromString(value, Qt::ISODate);
+}
 
-    case HUpnpDataTypes::time:
-    case HUpnpDataTypes::timeTz:
-        return QtSoapType::Time;
+QVariant parseBoolean(const QString& value)
+{
+    if (value.compare(QLatin1String("true"), Qt::CaseInsensitive) == 0 ||
+        value.compare(QLatin1String("yes"), Qt::CaseInsensitive) == 0 ||
+        value == QLatin1String("1"))
+    {
+        return true;
+    }
+    else if (value.compare(QLatin1String("false"), Qt::CaseInsensitive) == 0 ||
+        value.compare(QLatin1String("no"), Qt::CaseInsensitive) == 0 ||
+        value == QLatin1String("0"))
+    {
+        return false;
+    }
 
-    case HUpnpDataTypes::boolean:
-        return QtSoapType::Boolean;
+    return QVariant();
+}
 
-    case HUpnpDataTypes::bin_base64:
-        return QtSoapType::Base64Binary;
+QVariant parseUri(const QString& value)
+{
+    return QUrl(value);
+}
 
-    case HUpnpDataTypes::bin_hex:
-        return QtSoapType::HexBinary;
+// the value may have been set as any type convertible to the data type, in
+// which case it is formatted as it was set
+QString formatSigned(const QVariant& value)
+{
+    return value.type() == QVariant::Int ?
+        QString::number(value.toInt()) : value.toString();
+}
 
-    case HUpnpDataTypes::uri:
-        return QtSoapType::AnyURI;
+QString formatUnsigned(const QVariant& value)
+{
+    return value.type() == QVariant::UInt ?
+        QString::number(value.toUInt()) : value.toString();
+}
 
-    case HUpnpDataTypes::uuid:
-        return QtSoapType::ID;
+QString formatUri(const QVariant& value)
+{
+    // at the time of writing this (with Qt 4.5.3) the QVariant does not
+    // support toString() for Url types.
+    return value.toUrl().toString();
+}
 
-    case HUpnpDataTypes::Undefined:
-        return QtSoapType::Other;
+QString formatDefault(const QVariant& value)
+{
+    return value.toString();
+}
 
-    default:
+// the binary types are passed on in their textual form
+const DataTypeEntry s_dataTypes[] =
+{
+    { "Undefined", QVariant::Invalid, 0, 0 },
+    { "ui1", QVariant::UInt, parseUnsigned, formatUnsigned },
+    { "ui2", QVariant::UInt, parseUnsigned, formatUnsigned },
+    { "ui4", QVariant::UInt, parseUnsigned, formatUnsigned },
+    { "i1", QVariant::Int, parseSigned, formatSigned },
+    { "i2", QVariant::Int, parseSigned, formatSigned },
+    { "i4", QVariant::Int, parseSigned, formatSigned },
+    { "int", QVariant::Int, parseSigned, formatSigned },
+    { "r4", QVariant::Double, parseReal, formatDefault },
+    { "r8", QVariant::Double, parseReal, formatDefault },
+    { "number", QVariant::Double, parseReal, formatDefault },
+    { "fixed.14.4", QVariant::Double, parseReal, formatDefault },
+    { "float", QVariant::Double, parseReal, formatDefault },
+    { "char", QVariant::Char, parseCharacter, formatDefault },
+    { "string", QVariant::String, parseString, formatDefault },
+    { "date", QVariant::Date, parseDate, formatDefault },
+    { "dateTime", QVariant::DateTime, parseDateTime, formatDefault },
+    { "dateTime.tz", QVariant::DateTime, parseDateTime, formatDefault },
+    { "time", QVariant::Time, parseTime, formatDefault },
+    { "time.tz", QVariant::Time, parseTime, formatDefault },
+    { "boolean", QVariant::Bool, parseBoolean, formatDefault },
+    { "bin.base64", QVariant::ByteArray, parseString, formatDefault },
+    { "bin.hex", QVariant::ByteArray, parseString, formatDefault },
+    { "uri", QVariant::Url, parseUri, formatUri },
+    { "uuid", QVariant::String, parseString, formatDefault }
+};
+
+const qint32 s_dataTypeCount = sizeof(s_dataTypes) / sizeof(s_dataTypes[0]);
+
+inline const DataTypeEntry* entry(HUpnpDataTypes::DataType dt)
+{
+    if (dt <= HUpnpDataTypes::Undefined || dt >= s_dataTypeCount)
+    {
         Q_ASSERT(false);
+        return 0;
     }
 
-    Q_ASSERT(false);
-    return QtSoapType::Other;
+    return &s_dataTypes[dt];
+}
+}
+
+QString convertToString(HUpnpDataTypes::DataType dt, const QVariant& value)
+{
+    Q_ASSERT(value.isValid());
+    Q_ASSERT(dt != HUpnpDataTypes::Undefined);
+
+    if (value.userType() == qMetaTypeId<HXmlFragment>())
+    {
+        return value.value<HXmlFragment>().toString();
+    }
+
+    const DataTypeEntry* e = entry(dt);
+    return e ? e->m_format(value) : value.toString();
 }
 
 HUpnpDataTypes::HUpnpDataTypes()
@@ -139,101 +279,12 @@ HUpnpDataTypes::~HUpnpDataTypes()
 
 HUpnpDataTypes::DataType HUpnpDataTypes::dataType(const QString& dataTypeAsStr)
 {
-    if (dataTypeAsStr.compare(ui1_str()) == 0)
-    {
-        return ui1;
-    }
-    else if (dataTypeAsStr.compare(ui2_str()) == 0)
-    {
-        return ui2;
-    }
-    else if (dataTypeAsStr.compare(ui4_str()) == 0)
-    {
-        return ui4;
-    }
-    else if (dataTypeAsStr.compare(i1_str()) == 0)
-    {
-        return i1;
-    }
-    else if (dataTypeAsStr.compare(i2_str()) == 0)
-    {
-        return i2;
-    }
-    else if (dataTypeAsStr.compare(i4_str()) == 0)
-    {
-        return i4;
-    }
-    else if (dataTypeAsStr.compare(integer_str()) == 0)
-    {
-        return integer;
-    }
-    else if (dataTypeAsStr.compare(r4_str()) == 0)
-    {
-        return r4;
-    }
-    else if (dataTypeAsStr.compare(r8_str()) == 0)
-    {
-        return r8;
-    }
-    else if (dataTypeAsStr.compare(number_str()) == 0)
-    {
-        return number;
-    }
-    else if (dataTypeAsStr.compare(fixed_14_4_str()) == 0)
-    {
-        return fixed_14_4;
-    }
-    else if (dataTypeAsStr.compare(fp_str()) == 0)
-    {
-        return fp;
-    }
-    else if (dataTypeAsStr.compare(character_str()) == 0)
-    {
-        return character;
-    }
-    else if (dataTypeAsStr.compare(string_str()) == 0)
-    {
-        return string;
-    }
-    else if (dataTypeAsStr.compare(date_str()) == 0)
-    {
-        return date;
-    }
-    else if (dataTypeAsStr.compare(dateTime_str()) == 0)
+    for (qint32 i = Undefined + 1; i < s_dataTypeCount; ++i)
     {
-        return dateTime;
-    }
-    else if (dataTypeAsStr.compare(dateTimeTz_str()) == 0)
-    {
-        return dateTimeTz;
-    }
-    else if (dataTypeAsStr.compare(time_str()) == 0)
-    {
-        return time;
-    }
-    else if (dataTypeAsStr.compare(time_tz_str()) == 0)
-    {
-        return timeTz;
-    }
-    else if (dataTypeAsStr.compare(boolean_str()) == 0)
-    {
-        return boolean;
-    }
-    else if (dataTypeAsStr.compare(bin_base64_str()) == 0)
-    {
-        return bin_base64;
-    }
-    else if (dataTypeAsStr.compare(bin_hex_str()) == 0)
-    {
-        return bin_hex;
-    }
-    else if (dataTypeAsStr.compare(uri_str()) == 0)
-    {
-        return uri;
-    }
-    else if (dataTypeAsStr.compare(uuid_str()) == 0)
-    {
-        return uuid;
+        if (dataTypeAsStr == QLatin1String(s_dataTypes[i].m_name))
+        {
+            return static_cast<DataType>(i);
+        }
     }
 
     return Undefined;
@@ -301,165 +352,15 @@ QString HUpnpDataTypes::toString(DataType dataType)
 QVariant::Type HUpnpDataTypes::convertToVariantType(
     HUpnpDataTypes::DataType upnpDataType)
 {
-    switch (upnpDataType)
-    {
-    case HUpnpDataTypes::character:
-        return QVariant::Char;
-
-    case HUpnpDataTypes::i1:
-    case HUpnpDataTypes::i2:
-    case HUpnpDataTypes::i4:
-    case HUpnpDataTypes::integer:
-        return QVariant::Int;
-
-    case HUpnpDataTypes::ui1:
-    case HUpnpDataTypes::ui2:
-    case HUpnpDataTypes::ui4:
-        return QVariant::UInt;
-
-    case HUpnpDataTypes::fp:
-    case HUpnpDataTypes::r4:
-    case HUpnpDataTypes::r8:
-    case HUpnpDataTypes::number:
-    case HUpnpDataTypes::fixed_14_4:
-        return QVariant::Double;
-
-    case HUpnpDataTypes::string:
-        return QVariant::String;
-
-    case HUpnpDataTypes::date:
-        return QVariant::Date;
-
-    case HUpnpDataTypes::dateTime:
-    case HUpnpDataTypes::dateTimeTz:
-        return QVariant::DateTime;
-
-    case HUpnpDataTypes::time:
-    case HUpnpDataTypes::timeTz:
-        return QVariant::Time;
-
-    case HUpnpDataTypes::boolean:
-        return QVariant::Bool;
-
-    case HUpnpDataTypes::bin_hex:
-    case HUpnpDataTypes::bin_base64:
-        return QVariant::ByteArray;
-
-    case HUpnpDataTypes::uri:
-        return QVariant::Url;
-
-    case HUpnpDataTypes::uuid:
-        return QVariant::String;
-
-    default:
-        Q_ASSERT(false);
-    }
-
-    Q_ASSERT(false);
-    return QVariant::Invalid;
+    const DataTypeEntry* e = entry(upnpDataType);
+    return e ? e->m_variantType : QVariant::Invalid;
 }
 
 QVariant HUpnpDataTypes::convertToRightVariantType(
     const QString& value, HUpnpDataTypes::DataType upnpDataType)
 {
-    QVariant retVal;
-
-    switch (upnpDataType)
-    {
-    case HUpnpDataTypes::character:
-        return !value.isEmpty() ? QChar(value[0]) : QVariant(QVariant::Char);
-
-    case HUpnpDataTypes::i1:
-    case HUpnpDataTypes::i2:
-    case HUpnpDataTypes::i4:
-    case HUpnpDataTypes::integer:
-    {
-        bool ok = false;
-        retVal = value.toInt(&ok);
-        break;
-    }
-
-    case HUpnpDataTypes::ui1:
-    case HUpnpDataTypes::ui2:
-    case HUpnpDataTypes::ui4:
-    {
-        bool ok = false;
-        retVal = value.toUInt(&ok);
-        break;
-    }
-
-    case HUpnpDataTypes::fp:
-    case HUpnpDataTypes::r4:
-    case HUpnpDataTypes::r8:
-    case HUpnpDataTypes::number:
-    case HUpnpDataTypes::fixed_14_4:
-    {
-        bool ok = false;
-        retVal = value.toDouble(&ok);
-        break;
-    }
-
-    case HUpnpDataTypes::string:
-        return value;
-
-    case HUpnpDataTypes::date:
-    {
-        retVal = QDate::fromString(value, Qt::ISODate);
-        break;
-    }
-
-    case HUpnpDataTypes::dateTime:
-    case HUpnpDataTypes::dateTimeTz:
-    {
-        retVal = QDateTime::fromString(value, Qt::ISODate);
-        break;
-    }
-
-    case HUpnpDataTypes::time:
-    case HUpnpDataTypes::timeTz:
-    {
-        retVal = QTime::fromString(value, Qt::ISODate);
-        break;
-    }
-
-    case HUpnpDataTypes::boolean:
-    {
-        if (value.compare("true", Qt::CaseInsensitive) == 0 ||
-            value.compare("yes", Qt::CaseInsensitive) == 0 ||
-            value.compare("1") == 0)
-        {
-            retVal = true;
-        }
-        else if (value.compare("false", Qt::CaseInsensitive) == 0 ||
-            value.compare("no", Qt::CaseInsensitive) == 0 ||
-            value.compare("0") == 0)
-        {
-            retVal = false;
-        }
-
-        break;
-    }
-
-    case HUpnpDataTypes::bin_hex:
-        return value;//.toUtf8().toHex();
-
-    case HUpnpDataTypes::bin_base64:
-        return value;//.toUtf8().toBase64();
-
-    case HUpnpDataTypes::uri:
-    {
-        retVal = QUrl(value);
-        break;
-    }
-
-    case HUpnpDataTypes::uuid:
-        return value;
-
-    default:
-        Q_ASSERT(false);
-    }
-
-    return retVal;
+    const DataTypeEntry* e = entry(upnpDataType);
+    return e ? e->m_parse(value) : QVariant();
 }
 
 }
@@ -32,9 +32,6 @@
 
 #include "hupnp_datatypes.h"
 
-#include <QtSoapType>
-#include <QtSoapSimpleType>
-
 class QString;
 class QVariant;
 
@@ -47,17 +44,10 @@ namespace Upnp
 //
 // \internal
 //
-class SoapType :
-    public QtSoapSimpleType
-{
-public:
-    SoapType(const QString& name, HUpnpDataTypes::DataType, const QVariant& value);
-};
-
-//
-// \internal
+// Returns the textual representation of a value of the specified UPnP data
+// type, as it is written into SOAP messages.
 //
-QtSoapType::Type convertToSoapType(HUpnpDataTypes::DataType);
+QString convertToString(HUpnpDataTypes::DataType, const QVariant& value);
 
 }
 }
@@ -46,6 +46,7 @@ class HClientAction;
 class HClientDevice;
 class HClientService;
 class HClientActionOp;
+class HClientBatchOp;
 class HClientStateVariable;
 
 struct HNullValue;
@@ -63,6 +64,9 @@ class HServerDevice;
 class HServerService;
 class HServerStateVariable;
 
+template<typename T>
+class HTypedStateVariable;
+
 class HActionSetup;
 class HDeviceSetup;
 class HServiceSetup;
@@ -90,6 +94,7 @@ class HProductTokens;
 class HDiscoveryType;
 
 class HSsdp;
+class HSsdpMessage;
 class HResourceUpdate;
 class HDiscoveryRequest;
 class HDiscoveryResponse;
@@ -100,12 +105,24 @@ class HDeviceModelCreator;
 class HDeviceModelValidator;
 class HDeviceModelInfoProvider;
 
+class HLogSink;
+class HLogRecord;
+class HAsyncLogSink;
+
+class HTracing;
+class HMemoryUsage;
+class HTrafficCapture;
+class HTrafficCaptureReader;
+
 class HAsyncOp;
 class HExecArgs;
+class HCancelToken;
 class HControlPoint;
+class HControlPointRuntimeStatus;
 class HControlPointConfiguration;
 
 class HDeviceHost;
+class HTaskScheduler;
 class HDeviceConfiguration;
 class HDeviceHostConfiguration;
 class HDeviceHostRuntimeStatus;
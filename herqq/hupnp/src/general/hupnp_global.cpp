@@ -80,15 +80,8 @@ namespace Upnp
  * First, it is important to point out that at the moment HUPnP is
  * officially distributed in source code only. If you
  * come across a binary of HUPnP, it is not made by the author of HUPnP.
- * Second, HUPnP uses the
- * <a href="http://qt.nokia.com/products/appdev/add-on-products/catalog/4/Utilities/qtsoap">QtSoap library</a>
- * under the <a href="http://www.gnu.org/licenses/lgpl-2.1.html">LGPLv2.1</a> license.
- * The QtSoap library is distributed along the HUPnP in
- * source code and the library is built into a shared library during the compilation of HUPnP.
- * \attention At the moment, HUPnP uses a modified version of QtSoap version 2.7.
- * This is because the original version 2.7 contains few severe bugs in regard
- * to thread-safety. Until the errors are fixed in the official QtSoap release, the users
- * of HUPnP \b must use the modified version distributed with HUPnP.
+ * Second, HUPnP depends only on Qt. The SOAP messages used in action
+ * invocation are read and written by HUPnP itself.
  *
  * In order to use HUPnP, you need to build it first. By far the simplest way to do
  * this is to download the <a href="http://qt.nokia.com/downloads">Qt SDK</a>,
@@ -102,17 +95,16 @@ namespace Upnp
  * if you do not want to install the HUPnP headers and binaries anywhere. See
  * \ref deployment for further information.
  *
- * The build produces two shared libraries to which you need to link in order to use
- * HUPnP. Currently, static linking is not an option. The created libraries are
- * placed in \c bin directory and they are named <c>[lib]HUPnP[-majVer.minVer.patchVer].x</c> and
- * <c>[lib]QtSolutions_SOAP-2.7.x</c>, where \c ".x" is the platform dependent suffix
+ * The build produces a shared library to which you need to link in order to use
+ * HUPnP. Currently, static linking is not an option. The created library is
+ * placed in \c bin directory and it is named <c>[lib]HUPnP[-majVer.minVer.patchVer].x</c>,
+ * where \c ".x" is the platform dependent suffix
  * for shared libraries. In addition, your compiler
  * must be aware of the HUPnP includes, which can be found in the \c include
  * directory. It is very important that you do \b not directly include anything that
  * is not found in the \c include directory. In any case, once your compiler
  * finds the HUPnP includes and your linker finds the HUPnP shared library,
- * you are good to go. \attention You do \b not need to include the QtSoap includes.
- * HUPnP does not expose the types declared in QtSoap.
+ * you are good to go.
  *
  * \section importantnotes Important notes
  *
@@ -151,6 +143,11 @@ namespace Upnp
  * to be malfunctioning. You can enable logging in HUPnP by calling the
  * function Herqq::Upnp::SetLoggingLevel() with a desired \e level argument.
  * Include \c HUpnp to use the Herqq::Upnp::SetLoggingLevel().
+ * By default the log messages are written with \c qDebug() and its siblings
+ * in the thread that logs the message. You can use
+ * Herqq::Upnp::SetLogSink() with an Herqq::Upnp::HAsyncLogSink to write
+ * them in a background thread, or with your own Herqq::Upnp::HLogSink
+ * to write them elsewhere.
  *
  * \subsection deployment Deployment
  *
@@ -1442,6 +1439,11 @@ void EnableNonStdBehaviourWarnings(bool arg)
     HLogger::enableNonStdWarnings(arg);
 }
 
+void SetLogSink(HLogSink* sink)
+{
+    HLogger::setSink(sink);
+}
+
 QString readElementValue(
     const QString elementTagToSearch, const QDomElement& parentElement,
     bool* wasDefined)
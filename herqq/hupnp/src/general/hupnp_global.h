@@ -145,7 +145,15 @@ enum UpnpErrorCode
      * \remarks
      * This value is defined and used by HUPnP in-process only.
      */
-    UpnpInvocationAborted = 0x00f00001
+    UpnpInvocationAborted = 0x00f00001,
+
+    /*!
+     * The action invocation did not complete before its deadline.
+     *
+     * \remarks
+     * This value is defined and used by HUPnP in-process only.
+     */
+    UpnpInvocationTimedOut = 0x00f00002
 };
 
 /*!
@@ -406,6 +414,30 @@ void H_UPNP_CORE_EXPORT SetLoggingLevel(HLogLevel level);
  */
 void H_UPNP_CORE_EXPORT EnableNonStdBehaviourWarnings(bool arg);
 
+/*!
+ * \brief Sets the sink HUPnP writes its log messages to.
+ *
+ * By default HUPnP writes its log messages with \c qDebug(), \c qWarning()
+ * and \c qCritical() in the thread that logs the message. An HAsyncLogSink
+ * moves the writing to a background thread.
+ *
+ * \param sink specifies the sink. The ownership of the sink is \b not
+ * transferred and the sink has to exist until it is replaced. If the sink
+ * is null, the default behavior is restored.
+ *
+ * \remark
+ * \li The level of the messages that are logged is still controlled with
+ * SetLoggingLevel().
+ * \li The function is thread-safe, but the sink should be set before HUPnP
+ * is used and removed only after it is no longer used, since a message that
+ * is being logged during the call may still be written to the previous sink.
+ *
+ * \sa HLogSink, HAsyncLogSink
+ *
+ * \ingroup hupnp_common
+ */
+void H_UPNP_CORE_EXPORT SetLogSink(HLogSink* sink);
+
 }
 }
 
@@ -0,0 +1,253 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hxmlfragment_p.h"
+
+#include <QtCore/QString>
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define H_XML_SCAN_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace
+{
+inline bool needsEscaping(char c)
+{
+    return c == '&' || c == '<' || c == '>' || c == '"';
+}
+
+//
+// Returns the index of the first byte at or after the specified index that
+// has to be escaped, or the size of the data if there is no such byte.
+// The data is scanned 16 bytes at a time with SSE2 where the CPU supports
+// it, since in practice most of the text does not need escaping at all.
+// Other targets, ARM included, scan a byte at a time.
+//
+qint64 findEscapable(const char* data, qint64 from, qint64 size)
+{
+    qint64 i = from;
+
+#if defined(H_XML_SCAN_SSE2)
+    const __m128i amp = _mm_set1_epi8('&');
+    const __m128i lt = _mm_set1_epi8('<');
+    const __m128i gt = _mm_set1_epi8('>');
+    const __m128i quot = _mm_set1_epi8('"');
+
+    for(; i + 16 <= size; i += 16)
+    {
+        __m128i block =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+
+        __m128i matches = _mm_or_si128(
+            _mm_or_si128(
+                _mm_cmpeq_epi8(block, amp), _mm_cmpeq_epi8(block, lt)),
+            _mm_or_si128(
+                _mm_cmpeq_epi8(block, gt), _mm_cmpeq_epi8(block, quot)));
+
+        if (_mm_movemask_epi8(matches))
+        {
+            break;
+        }
+    }
+#endif
+
+    // the block containing the match, if any, and the tail shorter than a
+    // block are scanned a byte at a time
+    for(; i < size; ++i)
+    {
+        if (needsEscaping(data[i]))
+        {
+            break;
+        }
+    }
+
+    return i;
+}
+
+inline const char* entityFor(char c)
+{
+    switch(c)
+    {
+    case '&':
+        return "&amp;";
+    case '<':
+        return "&lt;";
+    case '>':
+        return "&gt;";
+    default:
+        Q_ASSERT(c == '"');
+        return "&quot;";
+    }
+}
+
+//
+// Replaces the predefined XML entities with the characters they stand for.
+// The entities are ASCII, which is why they can be replaced in the encoded
+// data before it is decoded.
+//
+QByteArray unescape(const QByteArray& escaped)
+{
+    const char* data = escaped.constData();
+    const qint32 size = escaped.size();
+
+    const char* amp = static_cast<const char*>(std::memchr(data, '&', size));
+    if (!amp)
+    {
+        return escaped;
+    }
+
+    QByteArray retVal;
+    retVal.reserve(size);
+
+    qint32 runStart = 0;
+    while(amp)
+    {
+        qint32 i = amp - data;
+        retVal.append(data + runStart, i - runStart);
+
+        const char* rest = amp + 1;
+        qint32 left = size - i - 1;
+
+        char c = 0; qint32 length = 0;
+        if (left >= 4 && !std::memcmp(rest, "amp;", 4))
+        {
+            c = '&'; length = 5;
+        }
+        else if (left >= 3 && !std::memcmp(rest, "lt;", 3))
+        {
+            c = '<'; length = 4;
+        }
+        else if (left >= 3 && !std::memcmp(rest, "gt;", 3))
+        {
+            c = '>'; length = 4;
+        }
+        else if (left >= 5 && !std::memcmp(rest, "quot;", 5))
+        {
+            c = '"'; length = 6;
+        }
+        else if (left >= 5 && !std::memcmp(rest, "apos;", 5))
+        {
+            c = '\''; length = 6;
+        }
+        else
+        {
+            // not a predefined entity, kept as is
+            c = '&'; length = 1;
+        }
+
+        retVal.append(c);
+        runStart = i + length;
+
+        amp = runStart < size ? static_cast<const char*>(
+            std::memchr(data + runStart, '&', size - runStart)) : 0;
+    }
+
+    retVal.append(data + runStart, size - runStart);
+    return retVal;
+}
+}
+
+/*******************************************************************************
+ * HXmlFragment
+ ******************************************************************************/
+HXmlFragment::HXmlFragment() :
+    m_data()
+{
+}
+
+HXmlFragment::HXmlFragment(const QByteArray& escapedUtf8) :
+    m_data(escapedUtf8)
+{
+}
+
+QString HXmlFragment::toString() const
+{
+    return QString::fromUtf8(unescape(m_data));
+}
+
+/*******************************************************************************
+ * HXmlEscapingDevice
+ ******************************************************************************/
+HXmlEscapingDevice::HXmlEscapingDevice(QIODevice* target) :
+    QIODevice(), m_target(target)
+{
+    Q_ASSERT(m_target);
+    open(QIODevice::WriteOnly);
+}
+
+HXmlEscapingDevice::~HXmlEscapingDevice()
+{
+}
+
+bool HXmlEscapingDevice::isSequential() const
+{
+    return true;
+}
+
+qint64 HXmlEscapingDevice::readData(char*, qint64)
+{
+    return -1;
+}
+
+qint64 HXmlEscapingDevice::writeData(const char* data, qint64 maxSize)
+{
+    // Unescaped runs are written in one go; only the four special
+    // characters are replaced.
+    qint64 runStart = 0;
+    for (qint64 i = findEscapable(data, 0, maxSize); i < maxSize;
+         i = findEscapable(data, runStart, maxSize))
+    {
+        if (i > runStart &&
+            m_target->write(data + runStart, i - runStart) < 0)
+        {
+            return -1;
+        }
+
+        const char* entity = entityFor(data[i]);
+        if (m_target->write(entity, qstrlen(entity)) < 0)
+        {
+            return -1;
+        }
+
+        runStart = i + 1;
+    }
+
+    if (maxSize > runStart &&
+        m_target->write(data + runStart, maxSize - runStart) < 0)
+    {
+        return -1;
+    }
+
+    return maxSize;
+}
+
+}
+}
@@ -0,0 +1,103 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HXMLFRAGMENT_P_H_
+#define HXMLFRAGMENT_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include <HUpnpCore/HUpnp>
+
+#include <QtCore/QIODevice>
+#include <QtCore/QMetaType>
+#include <QtCore/QByteArray>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+//
+// A UTF-8 encoded string value that is already escaped for use as XML
+// character data. An action argument of type string can carry an
+// HXmlFragment in its QVariant, in which case the SOAP writer copies the
+// bytes into the message as is instead of escaping and encoding the value
+// once again.
+//
+class H_UPNP_CORE_EXPORT HXmlFragment
+{
+private:
+
+    QByteArray m_data;
+
+public:
+
+    HXmlFragment();
+    explicit HXmlFragment(const QByteArray& escapedUtf8);
+
+    inline const QByteArray& data() const { return m_data; }
+    inline bool isEmpty() const { return m_data.isEmpty(); }
+
+    QString toString() const;
+    // returns the unescaped value
+};
+
+//
+// A write-only device that XML escapes everything written to it as UTF-8
+// and passes the result to the target device. The characters '&', '<', '>'
+// and '"' never appear inside a multi-byte UTF-8 sequence, which is why
+// the escaping can be done on the encoded bytes in a single pass.
+//
+class H_UPNP_CORE_EXPORT HXmlEscapingDevice :
+    public QIODevice
+{
+H_DISABLE_COPY(HXmlEscapingDevice)
+
+private:
+
+    QIODevice* m_target;
+
+protected:
+
+    virtual qint64 readData(char* data, qint64 maxSize);
+    virtual qint64 writeData(const char* data, qint64 maxSize);
+
+public:
+
+    explicit HXmlEscapingDevice(QIODevice* target);
+    virtual ~HXmlEscapingDevice();
+
+    virtual bool isSequential() const;
+};
+
+}
+}
+
+Q_DECLARE_METATYPE(Herqq::Upnp::HXmlFragment)
+
+#endif /* HXMLFRAGMENT_P_H_ */
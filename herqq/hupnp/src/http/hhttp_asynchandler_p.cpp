@@ -23,19 +23,38 @@
 #include "hhttp_messagecreator_p.h"
 #include "hhttp_utils_p.h"
 
+#include "../utils/hblockpool_p.h"
+#include "../general/htrace_p.h"
+#include "../general/htrafficcapture_p.h"
+#include "../general/hmemoryaccount_p.h"
 #include "../general/hupnp_global_p.h"
 #include "../devicehosting/messages/hevent_messages_p.h"
 
 #include <QtNetwork/QTcpSocket>
 
-#include <QtSoapMessage>
-
 namespace Herqq
 {
 
 namespace Upnp
 {
 
+namespace
+{
+// never deleted, since operations may be deleted during static destruction
+HBlockPool* const s_operationPool =
+    new HBlockPool(sizeof(HHttpAsyncOperation), 128);
+
+void capture(
+    const QTcpSocket& socket, HTrafficCaptureReader::Direction direction,
+    const QByteArray& data)
+{
+    HTrafficRecorder::record(
+        HTrafficCaptureReader::Http, direction,
+        HEndpoint(socket.localAddress(), socket.localPort()),
+        HEndpoint(socket.peerAddress(), socket.peerPort()), data);
+}
+}
+
 HHttpAsyncOperation::HHttpAsyncOperation(
     const QByteArray& loggingIdentifier, unsigned int id, HMessagingInfo* mi,
     bool waitingRequest, QObject* parent) :
@@ -46,11 +65,17 @@ HHttpAsyncOperation::HHttpAsyncOperation(
             m_dataSent(0),
             m_state(Internal_NotStarted),
             m_headerRead(0),
+            m_requestHeader(),
+            m_responseHeader(),
             m_dataRead(),
             m_dataToRead(0),
             m_id(id),
             m_loggingIdentifier(loggingIdentifier),
-            m_opType(waitingRequest ? ReceiveRequest : ReceiveResponse)
+            m_opType(waitingRequest ? ReceiveRequest : ReceiveResponse),
+            m_bodySinkActive(false),
+            m_timerWheel(0),
+            m_idleTimeout(0),
+            m_traceStart(-1)
 {
     bool ok = connect(
         &m_mi->socket(), SIGNAL(readyRead()), this, SLOT(readyRead()));
@@ -74,11 +99,17 @@ HHttpAsyncOperation::HHttpAsyncOperation(
             m_dataSent(0),
             m_state(Internal_NotStarted),
             m_headerRead(0),
+            m_requestHeader(),
+            m_responseHeader(),
             m_dataRead(),
             m_dataToRead(0),
             m_id(id),
             m_loggingIdentifier(loggingIdentifier),
-            m_opType(sendOnly ? SendOnly : MsgIO)
+            m_opType(sendOnly ? SendOnly : MsgIO),
+            m_bodySinkActive(false),
+            m_timerWheel(0),
+            m_idleTimeout(0),
+            m_traceStart(-1)
 {
     bool ok = connect(
         &m_mi->socket(), SIGNAL(bytesWritten(qint64)),
@@ -101,7 +132,16 @@ HHttpAsyncOperation::HHttpAsyncOperation(
 HHttpAsyncOperation::~HHttpAsyncOperation()
 {
     delete m_mi;
-    delete m_headerRead;
+}
+
+void* HHttpAsyncOperation::operator new(size_t size)
+{
+    return s_operationPool->allocate(size);
+}
+
+void HHttpAsyncOperation::operator delete(void* p, size_t size)
+{
+    s_operationPool->release(p, size);
 }
 
 void HHttpAsyncOperation::sendChunked()
@@ -177,9 +217,10 @@ void HHttpAsyncOperation::sendChunked()
 
     if (m_dataSent >= m_dataToSend.size())
     {
-        // write the "eof" == zero + crlf
-        const char eof[] = "0\r\n";
-        m_mi->socket().write(&eof[0], 3);
+        // write the "eof" == zero + crlf followed by the crlf that ends
+        // the (empty) trailer
+        const char eof[] = "0\r\n\r\n";
+        m_mi->socket().write(&eof[0], 5);
         m_mi->socket().flush();
 
         if (m_opType == SendOnly)
@@ -188,14 +229,93 @@ void HHttpAsyncOperation::sendChunked()
             return;
         }
 
+        traceStage("write");
         m_state = Internal_ReadingHeader;
+        if (m_mi->socket().bytesAvailable() > 0)
+        {
+            readyRead();
+        }
+    }
+}
+
+bool HHttpAsyncOperation::appendData(const char* data, qint64 size)
+{
+    if (m_bodySinkActive)
+    {
+        if (!m_mi->bodySink()->write(data, size))
+        {
+            m_mi->setLastErrorDescription("the message body was rejected");
+            done_(Internal_Failed);
+            return false;
+        }
+    }
+    else if (m_mi->maxBodySize() > 0 &&
+             m_dataRead.size() + size > m_mi->maxBodySize())
+    {
+        m_mi->setLastErrorDescription(QString(
+            "message body exceeds the maximum size of %1 bytes").arg(
+                m_mi->maxBodySize()));
+
+        done_(Internal_Failed);
+        return false;
     }
+    else
+    {
+        m_dataRead.append(data, size);
+    }
+
+    return true;
 }
 
 void HHttpAsyncOperation::readBlob()
 {
-    QByteArray buf; buf.resize(m_dataToRead+1);
-    do
+    if (!m_bodySinkActive)
+    {
+        // the body is read directly to its final location, which has been
+        // reserved once the length of the body became known
+        while(m_dataToRead > 0)
+        {
+            qint64 available = m_mi->socket().bytesAvailable();
+            if (available <= 0)
+            {
+                break;
+            }
+
+            qint32 oldSize = m_dataRead.size();
+            qint64 toRead = qMin(available, m_dataToRead);
+
+            m_dataRead.resize(oldSize + static_cast<qint32>(toRead));
+            qint64 retVal = m_mi->socket().read(m_dataRead.data() + oldSize, toRead);
+            if (retVal < 0)
+            {
+                m_dataRead.resize(oldSize);
+                m_mi->setLastErrorDescription(
+                    QString("failed to read data: %1").arg(
+                        m_mi->socket().errorString()));
+
+                done_(Internal_Failed);
+                return;
+            }
+
+            m_dataRead.resize(oldSize + static_cast<qint32>(retVal));
+            m_dataToRead -= retVal;
+
+            if (retVal == 0)
+            {
+                break;
+            }
+        }
+
+        if (m_dataToRead <= 0)
+        {
+            done_(Internal_FinishedSuccessfully);
+        }
+
+        return;
+    }
+
+    QByteArray buf; buf.resize(qMin(m_dataToRead, readBlockSize()));
+    while(m_dataToRead > 0)
     {
         qint64 retVal = m_mi->socket().read(
             buf.data(), qMin(static_cast<qint64>(buf.size()), m_dataToRead));
@@ -212,14 +332,16 @@ void HHttpAsyncOperation::readBlob()
         else if (retVal > 0)
         {
             m_dataToRead -= retVal;
-            m_dataRead.append(QByteArray(buf.data(), retVal));
+            if (!appendData(buf.data(), retVal))
+            {
+                return;
+            }
         }
         else
         {
             break;
         }
     }
-    while(m_dataToRead > 0);
 
     if (m_dataToRead <= 0)
     {
@@ -229,15 +351,15 @@ void HHttpAsyncOperation::readBlob()
 
 bool HHttpAsyncOperation::readChunkedSizeLine()
 {
-    if (m_mi->socket().bytesAvailable() <= 0)
+    if (!m_mi->socket().canReadLine())
     {
+        // the entire size line is not available yet
         return false;
     }
 
-    QByteArray buf;
-    if (!HHttpUtils::readLines(m_mi->socket(), buf, 1))
+    QByteArray buf = m_mi->socket().readLine();
+    if (!buf.endsWith("\r\n"))
     {
-        // No size line. It should be available at this point.
         m_mi->setLastErrorDescription("missing chunk-size line");
         done_(Internal_Failed);
         return false;
@@ -265,9 +387,10 @@ bool HHttpAsyncOperation::readChunkedSizeLine()
 
     if (chunkSize == 0)
     {
-        // the last chunk, ignore possible trailers
-        done_(Internal_FinishedSuccessfully);
-        return false;
+        // the last chunk. the possible trailers are ignored, but they have to
+        // be read so that a pipelined message that follows is intact
+        m_state = Internal_ReadingChunkTrailer;
+        return readChunkTrailer();
     }
 
     m_dataToRead = chunkSize;
@@ -276,35 +399,51 @@ bool HHttpAsyncOperation::readChunkedSizeLine()
     return true;
 }
 
+bool HHttpAsyncOperation::readChunkTrailer()
+{
+    while(m_mi->socket().canReadLine())
+    {
+        QByteArray line = m_mi->socket().readLine();
+        if (line == "\r\n" || line == "\n")
+        {
+            done_(Internal_FinishedSuccessfully);
+            return false;
+        }
+    }
+
+    // the rest of the trailer is not available yet
+    return false;
+}
+
 bool HHttpAsyncOperation::readChunk()
 {
     QByteArray tmp;
-    tmp.resize(m_dataToRead);
+    tmp.resize(qMin(m_dataToRead, readBlockSize()));
 
-    qint32 read = m_mi->socket().read(tmp.data(), tmp.size());
-
-    if (read < 0)
+    while(m_dataToRead > 0)
     {
-        m_mi->setLastErrorDescription(QString(
-            "failed to read chunk: %1").arg(m_mi->socket().errorString()));
+        qint64 read = m_mi->socket().read(
+            tmp.data(), qMin(static_cast<qint64>(tmp.size()), m_dataToRead));
 
-        done_(Internal_Failed);
-        return false;
-    }
-    else if (read == 0)
-    {
-        // couldn't read the entire chunk in one pass
-        return false;
-    }
+        if (read < 0)
+        {
+            m_mi->setLastErrorDescription(QString(
+                "failed to read chunk: %1").arg(m_mi->socket().errorString()));
 
-    tmp.resize(read);
-    m_dataRead.append(tmp);
+            done_(Internal_Failed);
+            return false;
+        }
+        else if (read == 0)
+        {
+            // couldn't read the entire chunk in one pass
+            return false;
+        }
 
-    m_dataToRead -= read;
-    if (m_dataToRead > 0)
-    {
-        // couldn't read the entire chunk in one pass
-        return false;
+        m_dataToRead -= read;
+        if (!appendData(tmp.data(), read))
+        {
+            return false;
+        }
     }
 
     // if here, the entire chunk data is read.
@@ -321,22 +460,46 @@ bool HHttpAsyncOperation::readChunk()
 
 bool HHttpAsyncOperation::readHeader()
 {
-    if (!HHttpUtils::readLines(m_mi->socket(), m_dataRead, 2))
+    if (m_dataRead.isEmpty() && HTraceRecorder::isEnabled() &&
+        m_mi->socket().bytesAvailable() > 0)
     {
-        m_mi->setLastErrorDescription(QString(
-            "failed to read HTTP header: %1").arg(m_mi->socket().errorString()));
+        // the header stage starts once the first bytes of the header arrive.
+        // the time a response was waited for is a stage of its own
+        if (m_traceStart >= 0)
+        {
+            traceStage("wait");
+        }
+        else
+        {
+            m_traceStart = HTraceRecorder::now();
+        }
+    }
 
-        done_(Internal_Failed);
+    if (!HHttpUtils::readHeader(m_mi->socket(), m_dataRead, maxHeaderSize()))
+    {
+        if (m_dataRead.size() > maxHeaderSize())
+        {
+            m_mi->setLastErrorDescription(QString(
+                "HTTP header exceeds the maximum size of %1 bytes").arg(
+                    maxHeaderSize()));
+
+            done_(Internal_Failed);
+        }
+
+        // the header is not fully received yet; the data read so far is kept
+        // and the scan continues once more data arrives
         return false;
     }
 
     if (m_opType == ReceiveRequest)
     {
-        m_headerRead = new HHttpRequestHeader(QString::fromUtf8(m_dataRead));
+        m_requestHeader = HHttpRequestHeader(m_dataRead);
+        m_headerRead = &m_requestHeader;
     }
     else
     {
-        m_headerRead = new HHttpResponseHeader(QString::fromUtf8(m_dataRead));
+        m_responseHeader = HHttpResponseHeader(m_dataRead);
+        m_headerRead = &m_responseHeader;
     }
 
     m_dataRead.clear();
@@ -348,8 +511,24 @@ bool HHttpAsyncOperation::readHeader()
         return false;
     }
 
+    traceStage("header");
+
     m_mi->setKeepAlive(HHttpUtils::keepAlive(*m_headerRead));
 
+    m_bodySinkActive =
+        m_mi->bodySink() && m_mi->bodySink()->begin(*m_headerRead);
+
+    if (!m_bodySinkActive && m_mi->maxBodySize() > 0 &&
+        m_headerRead->contentLength() > m_mi->maxBodySize())
+    {
+        m_mi->setLastErrorDescription(QString(
+            "message body exceeds the maximum size of %1 bytes").arg(
+                m_mi->maxBodySize()));
+
+        done_(Internal_Failed);
+        return false;
+    }
+
     if (m_headerRead->hasContentLength())
     {
         m_dataToRead = m_headerRead->contentLength();
@@ -358,8 +537,19 @@ bool HHttpAsyncOperation::readHeader()
             done_(Internal_FinishedSuccessfully);
             return false;
         }
+        else if (!m_bodySinkActive)
+        {
+            // the length comes from the peer, which is why at most the
+            // maximum body size is allocated in advance
+            qint64 maxReserve = m_mi->maxBodySize() > 0 ?
+                m_mi->maxBodySize() : maxBodyReserve();
+
+            m_dataRead.reserve(
+                static_cast<qint32>(qMin(m_dataToRead, maxReserve)));
+        }
     }
-    else if (m_headerRead->value("TRANSFER-ENCODING") != "chunked")
+    else if (!m_headerRead->valueEquals(
+                 HHttpHeader::Field_TransferEncoding, "chunked"))
     {
         done_(Internal_FinishedSuccessfully);
         return false;
@@ -376,7 +566,8 @@ bool HHttpAsyncOperation::readData()
         return false;
     }
 
-    bool chunked = m_headerRead->value("TRANSFER-ENCODING") == "chunked";
+    bool chunked = m_headerRead->valueEquals(
+        HHttpHeader::Field_TransferEncoding, "chunked");
     if (chunked)
     {
         if (m_headerRead->hasContentLength())
@@ -401,9 +592,10 @@ bool HHttpAsyncOperation::readData()
             // not chunked and content length is not specified ==>
             // no way to know what to expect ==> read all that is available
             QByteArray body = m_mi->socket().readAll();
-            m_dataRead.append(body);
-
-            done_(Internal_FinishedSuccessfully);
+            if (appendData(body.constData(), body.size()))
+            {
+                done_(Internal_FinishedSuccessfully);
+            }
             return false;
         }
     }
@@ -413,9 +605,19 @@ bool HHttpAsyncOperation::readData()
 
 bool HHttpAsyncOperation::run()
 {
+    m_traceStart = -1;
     if (m_dataToSend.isEmpty())
     {
         m_state = Internal_ReadingHeader;
+        armTimeout(m_opType == ReceiveRequest ?
+            m_idleTimeout : m_mi->receiveTimeoutForNoData());
+
+        if (m_mi->socket().bytesAvailable() > 0)
+        {
+            // the data arrived before this operation was set up and the
+            // readyRead() signal has already been emitted
+            QMetaObject::invokeMethod(this, "readyRead", Qt::QueuedConnection);
+        }
         return true;
     }
 
@@ -425,6 +627,16 @@ bool HHttpAsyncOperation::run()
         return false;
     }
 
+    if (HTraceRecorder::isEnabled())
+    {
+        m_traceStart = HTraceRecorder::now();
+    }
+
+    if (HTrafficRecorder::isEnabled())
+    {
+        capture(m_mi->socket(), HTrafficCaptureReader::Outbound, m_dataToSend);
+    }
+
     qint32 indexOfData = m_dataToSend.indexOf("\r\n\r\n");
     Q_ASSERT(indexOfData > 0);
 
@@ -449,6 +661,7 @@ bool HHttpAsyncOperation::run()
         }
 
         m_state = Internal_WritingChunkedSizeLine;
+        armTimeout(m_mi->receiveTimeoutForNoData());
         sendChunked();
     }
     else
@@ -466,6 +679,7 @@ bool HHttpAsyncOperation::run()
         }
 
         m_state = Internal_WritingBlob;
+        armTimeout(m_mi->receiveTimeoutForNoData());
 
         if (m_mi->sendWait() > 0)
         {
@@ -490,9 +704,35 @@ void HHttpAsyncOperation::done_(InternalState state, bool emitSignal)
 {
     m_mi->socket().disconnect(this);
 
+    if (m_timerWheel)
+    {
+        m_timerWheel->cancel(this);
+    }
+
+    if (m_bodySinkActive)
+    {
+        m_bodySinkActive = false;
+        m_mi->bodySink()->end(state == Internal_FinishedSuccessfully);
+    }
+
     Q_ASSERT((state == Internal_FinishedSuccessfully && (headerRead() || m_opType == SendOnly)) ||
               state != Internal_FinishedSuccessfully);
 
+    if (state == Internal_FinishedSuccessfully)
+    {
+        traceStage(m_opType == SendOnly ? "write" : "body");
+
+        if (m_opType != SendOnly && HTrafficRecorder::isEnabled())
+        {
+            // a body passed to the body sink is not buffered, in which case
+            // only the header is captured
+            capture(
+                m_mi->socket(), HTrafficCaptureReader::Inbound,
+                m_headerRead->toBytes() + m_dataRead);
+        }
+    }
+    m_traceStart = -1;
+
     m_state = state;
     if (emitSignal)
     {
@@ -500,8 +740,62 @@ void HHttpAsyncOperation::done_(InternalState state, bool emitSignal)
     }
 }
 
+void HHttpAsyncOperation::armTimeout(qint32 msecs)
+{
+    if (!m_timerWheel)
+    {
+        return;
+    }
+
+    if (msecs > 0)
+    {
+        m_timerWheel->arm(this, msecs);
+    }
+    else
+    {
+        m_timerWheel->cancel(this);
+    }
+}
+
+void HHttpAsyncOperation::traceStage(const char* name)
+{
+    if (m_traceStart >= 0)
+    {
+        HTraceRecorder::complete("http", name, m_traceStart, m_mi->requestId());
+    }
+
+    m_traceStart =
+        HTraceRecorder::isEnabled() ? HTraceRecorder::now() : -1;
+}
+
+void HHttpAsyncOperation::timerExpired()
+{
+    if (m_state == Internal_ReadingHeader && m_dataRead.isEmpty() &&
+        m_opType == ReceiveRequest)
+    {
+        // an idle connection is closed without a response
+        m_mi->setLastErrorDescription("connection idle for too long");
+    }
+    else
+    {
+        m_mi->setLastErrorDescription(
+            state() == Writing ? "timed out while sending data" :
+                                 "timed out while receiving data");
+    }
+
+    done_(Internal_Failed);
+}
+
 void HHttpAsyncOperation::bytesWritten(qint64)
 {
+    if (m_state == Internal_WritingBlob ||
+        m_state == Internal_WritingChunk ||
+        m_state == Internal_WritingChunkedSizeLine)
+    {
+        // the peer is making progress
+        armTimeout(m_mi->receiveTimeoutForNoData());
+    }
+
     if (m_state == Internal_WritingBlob)
     {
         if (m_dataSent < m_dataToSend.size())
@@ -531,7 +825,16 @@ void HHttpAsyncOperation::bytesWritten(qint64)
             }
             else
             {
+                traceStage("write");
                 m_state = Internal_ReadingHeader;
+                armTimeout(m_mi->receiveTimeoutForNoData());
+
+                if (m_mi->socket().bytesAvailable() > 0)
+                {
+                    // the response arrived before the request was reported
+                    // written and the readyRead() signal was ignored
+                    readyRead();
+                }
             }
         }
     }
@@ -544,6 +847,13 @@ void HHttpAsyncOperation::bytesWritten(qint64)
 
 void HHttpAsyncOperation::readyRead()
 {
+    if (state() == Reading && m_mi->socket().bytesAvailable() > 0)
+    {
+        // the timeout is restarted whenever data arrives. if the operation
+        // completes during this call, the timer is cancelled.
+        armTimeout(m_mi->receiveTimeoutForNoData());
+    }
+
     if (m_state == Internal_ReadingHeader)
     {
         if (!readHeader())
@@ -560,6 +870,12 @@ void HHttpAsyncOperation::readyRead()
         }
     }
 
+    if (m_state == Internal_ReadingChunkTrailer)
+    {
+        readChunkTrailer();
+        return;
+    }
+
     for(; m_state == Internal_ReadingChunkSizeLine ||
           m_state == Internal_ReadingChunk;)
     {
@@ -617,11 +933,13 @@ void HHttpAsyncOperation::error(QAbstractSocket::SocketError err)
 
         if (m_opType == ReceiveRequest)
         {
-            m_headerRead = new HHttpRequestHeader(QString::fromUtf8(m_dataRead));
+            m_requestHeader = HHttpRequestHeader(m_dataRead);
+            m_headerRead = &m_requestHeader;
         }
         else
         {
-            m_headerRead = new HHttpResponseHeader(QString::fromUtf8(m_dataRead));
+            m_responseHeader = HHttpResponseHeader(m_dataRead);
+            m_headerRead = &m_responseHeader;
         }
 
         if (!m_headerRead->isValid())
@@ -657,6 +975,7 @@ HHttpAsyncOperation::State HHttpAsyncOperation::state() const
     case Internal_ReadingData:
     case Internal_ReadingChunkSizeLine:
     case Internal_ReadingChunk:
+    case Internal_ReadingChunkTrailer:
         return Reading;
 
     case Internal_FinishedSuccessfully:
@@ -675,12 +994,23 @@ HHttpAsyncHandler::HHttpAsyncHandler(
     const QByteArray& loggingIdentifier, QObject* parent) :
         QObject(parent),
             m_loggingIdentifier(loggingIdentifier), m_operations(),
-            m_lastIdUsed(0)
+            m_lastIdUsed(0), m_queuedBytes(0),
+            m_timerWheel(new HTimerWheel(100, this)),
+            m_keepAliveTimeout(defaultKeepAliveTimeout())
 {
 }
 
 HHttpAsyncHandler::~HHttpAsyncHandler()
 {
+    // the operations still running are deleted along with the handler
+    HMemoryAccount* account = HMemoryAccount::get(HMemoryAccount::HttpBuffers);
+    foreach(HHttpAsyncOperation* ao, m_operations)
+    {
+        if (!ao->m_dataToSend.isEmpty())
+        {
+            account->remove(ao->m_dataToSend.size());
+        }
+    }
 }
 
 void HHttpAsyncHandler::done(unsigned int id)
@@ -694,10 +1024,32 @@ void HHttpAsyncHandler::done(unsigned int id)
     Q_ASSERT(ok); Q_UNUSED(ok)
 
     m_operations.remove(id);
+    m_queuedBytes -= ao->m_dataToSend.size();
+    if (!ao->m_dataToSend.isEmpty())
+    {
+        HMemoryAccount::get(HMemoryAccount::HttpBuffers)->remove(
+            ao->m_dataToSend.size());
+    }
 
     emit msgIoComplete(ao);
 }
 
+void HHttpAsyncHandler::setupOperation(HHttpAsyncOperation* ao)
+{
+    ao->m_timerWheel = m_timerWheel;
+    ao->m_idleTimeout = m_keepAliveTimeout;
+
+    bool ok = connect(ao, SIGNAL(done(unsigned int)), this, SLOT(done(unsigned int)));
+    Q_ASSERT(ok); Q_UNUSED(ok)
+
+    m_operations.insert(ao->id(), ao);
+}
+
+void HHttpAsyncHandler::setKeepAliveTimeout(qint32 msecs)
+{
+    m_keepAliveTimeout = msecs;
+}
+
 HHttpAsyncOperation* HHttpAsyncHandler::msgIo(
     HMessagingInfo* mi, const QByteArray& req)
 {
@@ -708,15 +1060,15 @@ HHttpAsyncOperation* HHttpAsyncHandler::msgIo(
         new HHttpAsyncOperation(
             m_loggingIdentifier, ++m_lastIdUsed, mi, req, false, this);
 
-    bool ok = connect(ao, SIGNAL(done(unsigned int)), this, SLOT(done(unsigned int)));
-
-    Q_ASSERT(ok); Q_UNUSED(ok)
-
-    m_operations.insert(ao->id(), ao);
+    setupOperation(ao);
+    m_queuedBytes += req.size();
+    HMemoryAccount::get(HMemoryAccount::HttpBuffers)->add(req.size());
 
     if (!ao->run())
     {
         m_operations.remove(ao->id());
+        m_queuedBytes -= req.size();
+        HMemoryAccount::get(HMemoryAccount::HttpBuffers)->remove(req.size());
         delete ao;
         return 0;
     }
@@ -724,16 +1076,6 @@ HHttpAsyncOperation* HHttpAsyncHandler::msgIo(
     return ao;
 }
 
-HHttpAsyncOperation* HHttpAsyncHandler::msgIo(
-    HMessagingInfo* mi, HHttpRequestHeader& reqHdr, const QtSoapMessage& soapMsg)
-{
-    QByteArray dataToSend =
-        HHttpMessageCreator::setupData(
-            reqHdr, soapMsg.toXmlString().toUtf8(), *mi, ContentType_TextXml);
-
-    return msgIo(mi, dataToSend);
-}
-
 HHttpAsyncOperation* HHttpAsyncHandler::send(
     HMessagingInfo* mi, const QByteArray& data)
 {
@@ -744,14 +1086,15 @@ HHttpAsyncOperation* HHttpAsyncHandler::send(
         new HHttpAsyncOperation(
             m_loggingIdentifier, ++m_lastIdUsed, mi, data, true, this);
 
-    bool ok = connect(ao, SIGNAL(done(unsigned int)), this, SLOT(done(unsigned int)));
-    Q_ASSERT(ok); Q_UNUSED(ok)
-
-    m_operations.insert(ao->id(), ao);
+    setupOperation(ao);
+    m_queuedBytes += data.size();
+    HMemoryAccount::get(HMemoryAccount::HttpBuffers)->add(data.size());
 
     if (!ao->run())
     {
         m_operations.remove(ao->id());
+        m_queuedBytes -= data.size();
+        HMemoryAccount::get(HMemoryAccount::HttpBuffers)->remove(data.size());
         delete ao;
         return 0;
     }
@@ -768,10 +1111,7 @@ HHttpAsyncOperation* HHttpAsyncHandler::receive(
         new HHttpAsyncOperation(
             m_loggingIdentifier, ++m_lastIdUsed, mi, waitingRequest, this);
 
-    bool ok = connect(ao, SIGNAL(done(unsigned int)), this, SLOT(done(unsigned int)));
-    Q_ASSERT(ok); Q_UNUSED(ok)
-
-    m_operations.insert(ao->id(), ao);
+    setupOperation(ao);
 
     if (!ao->run())
     {
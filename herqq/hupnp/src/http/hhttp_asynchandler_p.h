@@ -36,13 +36,13 @@
 #include "hhttp_header_p.h"
 #include "hhttp_messaginginfo_p.h"
 
+#include "../utils/htimerwheel_p.h"
+
 #include <QtCore/QHash>
 #include <QtCore/QObject>
 #include <QtCore/QByteArray>
 #include <QtNetwork/QAbstractSocket>
 
-class QtSoapMessage;
-
 namespace Herqq
 {
 
@@ -54,8 +54,9 @@ class HHttpAsyncHandler;
 //
 //
 //
-class HHttpAsyncOperation :
-    public QObject
+class H_UPNP_CORE_EXPORT HHttpAsyncOperation :
+    public QObject,
+    public HTimerWheelEntry
 {
 Q_OBJECT
 H_DISABLE_COPY(HHttpAsyncOperation)
@@ -84,6 +85,7 @@ private:
         Internal_ReadingData,
         Internal_ReadingChunkSizeLine,
         Internal_ReadingChunk,
+        Internal_ReadingChunkTrailer,
         Internal_FinishedSuccessfully
     };
 
@@ -104,7 +106,11 @@ private:
 
     HHttpHeader* m_headerRead;
     // the http reader read from the target socket
-    // (request / response, depends of the setup)
+    // (request / response, depends of the setup). this points to one of
+    // the two headers below once a header has been read
+
+    HHttpRequestHeader m_requestHeader;
+    HHttpResponseHeader m_responseHeader;
 
     QByteArray m_dataRead;
     // the response data that is currently read from the target socket
@@ -121,12 +127,53 @@ private:
     OpType m_opType;
     // what the operation is supposed to do
 
+    bool m_bodySinkActive;
+    // true when the body of the message is passed to the HHttpBodySink of
+    // the messaging info instead of m_dataRead
+
+    HTimerWheel* m_timerWheel;
+    // the wheel of the handler that tracks the timeout of the operation
+
+    qint32 m_idleTimeout;
+    // how long a request is waited for on an idle connection
+
+    qint64 m_traceStart;
+    // the time the current stage of the operation started, or -1 when no
+    // stage is being traced
+
 private:
 
+    // the maximum size of an HTTP header that is buffered while waiting for
+    // the header to be fully received
+    static inline qint32 maxHeaderSize()
+    {
+        const qint32 retVal = 64 * 1024;
+        return retVal;
+    }
+
+    // the maximum number of bytes read from the socket in one pass while
+    // receiving a message body
+    static inline qint64 readBlockSize()
+    {
+        const qint64 retVal = 64 * 1024;
+        return retVal;
+    }
+
+    // the maximum number of bytes allocated for a message body in advance
+    // when the size of the body is not limited
+    static inline qint64 maxBodyReserve()
+    {
+        const qint64 retVal = 1024 * 1024;
+        return retVal;
+    }
+
+    bool appendData(const char* data, qint64 size);
+
     void sendChunked();
 
     void readBlob();
     bool readChunkedSizeLine();
+    bool readChunkTrailer();
     bool readChunk();
 
     // the return value of these two methods indicate if it is okay to continue
@@ -138,6 +185,15 @@ private:
     bool run();
     void done_(InternalState state, bool emitSignal = true);
 
+    void armTimeout(qint32 msecs);
+
+    void traceStage(const char* name);
+    // records the current stage as a span and starts the next one
+
+protected:
+
+    virtual void timerExpired();
+
 private Q_SLOTS:
 
     void bytesWritten(qint64);
@@ -165,11 +221,17 @@ public:
 
     virtual ~HHttpAsyncOperation();
 
+    // an operation is created for every message, which is why the memory
+    // is taken from a pool
+    static void* operator new(size_t size);
+    static void operator delete(void* p, size_t size);
+
     State state() const;
 
     inline unsigned int id() const { return m_id; }
 
-    // the data of the response
+    // the data of the response. this is empty in case the body was passed
+    // to an HHttpBodySink
     inline QByteArray dataRead() const { return m_dataRead; }
 
     // the header of the response
@@ -209,6 +271,16 @@ private:
 
     unsigned int m_lastIdUsed;
 
+    qint64 m_queuedBytes;
+    // the number of bytes in messages that are being sent
+
+    HTimerWheel* m_timerWheel;
+    // the timeouts of every operation are tracked using this
+
+    qint32 m_keepAliveTimeout;
+
+    void setupOperation(HHttpAsyncOperation*);
+
 private Q_SLOTS:
 
     void done(unsigned int);
@@ -232,12 +304,6 @@ public:
     // NOT any sooner!
     HHttpAsyncOperation* msgIo(HMessagingInfo* mi, const QByteArray& data);
 
-    //
-    // Helper overload
-    //
-    HHttpAsyncOperation* msgIo(
-        HMessagingInfo*, HHttpRequestHeader&, const QtSoapMessage&);
-
     //
     //
     //
@@ -248,6 +314,33 @@ public:
     // expecting to receive HHttpResponseHeader
     //
     HHttpAsyncOperation* receive(HMessagingInfo*, bool waitingRequest);
+
+    //
+    // returns the number of bytes in the messages passed to send() and msgIo()
+    // that have not been fully written
+    //
+    inline qint64 queuedBytes() const { return m_queuedBytes; }
+
+    //
+    // The default time in milliseconds a request is waited for on a
+    // connection before any part of it has been received
+    //
+    static inline qint32 defaultKeepAliveTimeout()
+    {
+        const qint32 retVal = 15000;
+        return retVal;
+    }
+
+    //
+    // sets the time in milliseconds a receive() operation waiting for a
+    // request waits for the first bytes to arrive. once the data starts to
+    // arrive, the receive timeout of the messaging info is used instead.
+    // zero or a negative value means no timeout. this affects the operations
+    // started after the call.
+    //
+    void setKeepAliveTimeout(qint32 msecs);
+
+    inline qint32 keepAliveTimeout() const { return m_keepAliveTimeout; }
 };
 
 }
@@ -0,0 +1,260 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hhttp_connectionpool_p.h"
+
+#include <QtNetwork/QTcpSocket>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+/*******************************************************************************
+ * HHttpConnectionPool
+ ******************************************************************************/
+HHttpConnectionPool::HHttpConnectionPool(QObject* parent) :
+    QObject(parent),
+        m_idleConnections(),
+        m_maxIdleConnectionsPerEndpoint(2),
+        m_idleTimeout(30000),
+        m_expirationTimer(this),
+        m_statistics()
+{
+    bool ok = connect(
+        &m_expirationTimer, SIGNAL(timeout()), this, SLOT(expire()));
+    Q_ASSERT(ok); Q_UNUSED(ok)
+}
+
+HHttpConnectionPool::~HHttpConnectionPool()
+{
+    clear();
+}
+
+void HHttpConnectionPool::remove(QTcpSocket* socket)
+{
+    QHash<HEndpoint, QList<IdleConnection> >::iterator it =
+        m_idleConnections.begin();
+
+    for(; it != m_idleConnections.end(); ++it)
+    {
+        QList<IdleConnection>& connections = it.value();
+        for(qint32 i = 0; i < connections.size(); ++i)
+        {
+            if (connections[i].m_socket == socket)
+            {
+                connections.removeAt(i);
+                if (connections.isEmpty())
+                {
+                    m_idleConnections.erase(it);
+                }
+                return;
+            }
+        }
+    }
+}
+
+void HHttpConnectionPool::expire()
+{
+    QHash<HEndpoint, QList<IdleConnection> >::iterator it =
+        m_idleConnections.begin();
+
+    while(it != m_idleConnections.end())
+    {
+        QList<IdleConnection>& connections = it.value();
+        for(qint32 i = connections.size() - 1; i >= 0; --i)
+        {
+            if (connections[i].m_idleSince.elapsed() >= m_idleTimeout)
+            {
+                connections[i].m_socket->disconnect(this);
+                connections[i].m_socket->deleteLater();
+                connections.removeAt(i);
+                ++m_statistics.m_expired;
+            }
+        }
+
+        if (connections.isEmpty())
+        {
+            it = m_idleConnections.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    if (m_idleConnections.isEmpty())
+    {
+        m_expirationTimer.stop();
+    }
+}
+
+void HHttpConnectionPool::idleConnectionClosed()
+{
+    QTcpSocket* socket = qobject_cast<QTcpSocket*>(sender());
+    Q_ASSERT(socket);
+
+    // the peer closed the connection or sent something unexpected
+    remove(socket);
+    socket->disconnect(this);
+    socket->deleteLater();
+}
+
+QTcpSocket* HHttpConnectionPool::acquire(const HEndpoint& endpoint, bool* reused)
+{
+    QHash<HEndpoint, QList<IdleConnection> >::iterator it =
+        m_idleConnections.find(endpoint);
+
+    while(it != m_idleConnections.end() && !it.value().isEmpty())
+    {
+        QTcpSocket* socket = it.value().takeLast().m_socket;
+        socket->disconnect(this);
+
+        if (socket->state() == QTcpSocket::ConnectedState)
+        {
+            if (it.value().isEmpty())
+            {
+                m_idleConnections.erase(it);
+            }
+
+            ++m_statistics.m_reused;
+            if (reused) { *reused = true; }
+
+            socket->setParent(0);
+            return socket;
+        }
+
+        socket->deleteLater();
+        ++m_statistics.m_discarded;
+    }
+
+    if (it != m_idleConnections.end())
+    {
+        m_idleConnections.erase(it);
+    }
+
+    ++m_statistics.m_created;
+    if (reused) { *reused = false; }
+
+    return new QTcpSocket();
+}
+
+void HHttpConnectionPool::release(const HEndpoint& endpoint, QTcpSocket* socket)
+{
+    Q_ASSERT(socket);
+    Q_ASSERT(socket->thread() == thread());
+
+    if (endpoint.isNull())
+    {
+        socket->disconnect();
+        socket->deleteLater();
+        ++m_statistics.m_discarded;
+        return;
+    }
+
+    QList<IdleConnection>& connections = m_idleConnections[endpoint];
+
+    if (socket->state() != QTcpSocket::ConnectedState ||
+        socket->bytesAvailable() > 0 ||
+        connections.size() >= m_maxIdleConnectionsPerEndpoint)
+    {
+        if (connections.isEmpty())
+        {
+            m_idleConnections.remove(endpoint);
+        }
+
+        socket->disconnect();
+        socket->deleteLater();
+        ++m_statistics.m_discarded;
+        return;
+    }
+
+    socket->disconnect();
+    socket->setParent(this);
+
+    bool ok = connect(
+        socket, SIGNAL(disconnected()), this, SLOT(idleConnectionClosed()));
+    Q_ASSERT(ok); Q_UNUSED(ok)
+
+    ok = connect(socket, SIGNAL(readyRead()), this, SLOT(idleConnectionClosed()));
+    Q_ASSERT(ok);
+
+    IdleConnection connection;
+    connection.m_socket = socket;
+    connection.m_idleSince.start();
+    connections.append(connection);
+
+    if (!m_expirationTimer.isActive())
+    {
+        m_expirationTimer.start(qMax(1000, m_idleTimeout / 2));
+    }
+}
+
+void HHttpConnectionPool::setMaxIdleConnectionsPerEndpoint(qint32 arg)
+{
+    m_maxIdleConnectionsPerEndpoint = qMax(0, arg);
+}
+
+void HHttpConnectionPool::setIdleTimeout(qint32 msecs)
+{
+    m_idleTimeout = qMax(0, msecs);
+    if (m_expirationTimer.isActive())
+    {
+        m_expirationTimer.start(qMax(1000, m_idleTimeout / 2));
+    }
+}
+
+qint32 HHttpConnectionPool::idleConnectionCount() const
+{
+    qint32 retVal = 0;
+
+    QHash<HEndpoint, QList<IdleConnection> >::const_iterator it =
+        m_idleConnections.constBegin();
+
+    for(; it != m_idleConnections.constEnd(); ++it)
+    {
+        retVal += it.value().size();
+    }
+
+    return retVal;
+}
+
+void HHttpConnectionPool::clear()
+{
+    QHash<HEndpoint, QList<IdleConnection> >::iterator it =
+        m_idleConnections.begin();
+
+    for(; it != m_idleConnections.end(); ++it)
+    {
+        foreach(const IdleConnection& connection, it.value())
+        {
+            connection.m_socket->disconnect(this);
+            delete connection.m_socket;
+        }
+    }
+
+    m_idleConnections.clear();
+    m_expirationTimer.stop();
+}
+
+}
+}
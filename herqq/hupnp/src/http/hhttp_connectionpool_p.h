@@ -0,0 +1,161 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HHTTP_CONNECTIONPOOL_P_H_
+#define HHTTP_CONNECTIONPOOL_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include <HUpnpCore/HUpnp>
+#include <HUpnpCore/HEndpoint>
+
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QTime>
+#include <QtCore/QTimer>
+#include <QtCore/QObject>
+
+class QTcpSocket;
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+//
+// Keeps idle persistent HTTP connections so that subsequent requests to the
+// same endpoint can be sent without establishing a new TCP connection.
+//
+// A connection is acquired for the duration of a single HTTP exchange and
+// then released back to the pool, if the connection can be kept alive.
+// Idle connections that exceed the per-endpoint limit, the idle timeout, or
+// that are closed by the peer are discarded.
+//
+// This class is not thread-safe and the sockets it hands out belong to the
+// thread of the pool.
+//
+class H_UPNP_CORE_EXPORT HHttpConnectionPool :
+    public QObject
+{
+Q_OBJECT
+H_DISABLE_COPY(HHttpConnectionPool)
+
+public:
+
+    class Statistics
+    {
+    public:
+
+        qint32 m_created;
+        // the number of new connections handed out
+
+        qint32 m_reused;
+        // the number of times an idle connection was handed out
+
+        qint32 m_expired;
+        // the number of idle connections discarded due to the idle timeout
+
+        qint32 m_discarded;
+        // the number of released connections that were not kept, either
+        // because the endpoint had the maximum number of idle connections
+        // or the connection was no longer usable
+
+        inline Statistics() :
+            m_created(0), m_reused(0), m_expired(0), m_discarded(0)
+        {
+        }
+    };
+
+private:
+
+    struct IdleConnection
+    {
+        QTcpSocket* m_socket;
+        QTime m_idleSince;
+    };
+
+    QHash<HEndpoint, QList<IdleConnection> > m_idleConnections;
+
+    qint32 m_maxIdleConnectionsPerEndpoint;
+    qint32 m_idleTimeout;
+
+    QTimer m_expirationTimer;
+    Statistics m_statistics;
+
+    void remove(QTcpSocket*);
+
+private Q_SLOTS:
+
+    void expire();
+    void idleConnectionClosed();
+
+public:
+
+    HHttpConnectionPool(QObject* parent = 0);
+    virtual ~HHttpConnectionPool();
+
+    //
+    // Returns a connected socket to the specified endpoint if one is idle.
+    // Otherwise returns a new unconnected socket the caller has to connect.
+    // The caller owns the returned socket until it is released.
+    //
+    QTcpSocket* acquire(const HEndpoint&, bool* reused = 0);
+
+    //
+    // Returns the socket to the pool. The socket is kept for later use if it
+    // is connected and the endpoint does not have the maximum number of idle
+    // connections already. Otherwise the socket is deleted. Sockets released
+    // with a null endpoint are never kept.
+    //
+    void release(const HEndpoint&, QTcpSocket*);
+
+    // the maximum number of idle connections kept per endpoint. default is 2
+    inline qint32 maxIdleConnectionsPerEndpoint() const
+    {
+        return m_maxIdleConnectionsPerEndpoint;
+    }
+
+    void setMaxIdleConnectionsPerEndpoint(qint32);
+
+    // the time in milliseconds an idle connection is kept. default is 30 secs
+    inline qint32 idleTimeout() const { return m_idleTimeout; }
+
+    void setIdleTimeout(qint32 msecs);
+
+    inline const Statistics& statistics() const { return m_statistics; }
+
+    qint32 idleConnectionCount() const;
+
+    // deletes all idle connections
+    void clear();
+};
+
+}
+}
+
+#endif /* HHTTP_CONNECTIONPOOL_P_H_ */
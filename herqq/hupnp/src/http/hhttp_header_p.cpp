@@ -21,34 +21,80 @@
 
 #include "hhttp_header_p.h"
 
-#include <QtCore/QStringList>
+#include <QtCore/QList>
+
+#include <climits>
+#include <cstring>
 
 namespace
 {
-int searchKey(
-    const QString& key,
-    const QList<QPair<QString, QString> >& values)
-{
-    QString lowCaseKey = key.toLower();
-    for (int i = 0; i < values.size(); ++i)
-    {
-        if (values[i].first.toLower() == lowCaseKey)
-        {
-            return i;
-        }
-    }
-    return -1;
-}
-
-bool parseVersion(const QString& version, int* major, int* minor)
+struct WellKnownFieldName
+{
+    const char* m_name;
+    qint32 m_length;
+};
+
+// the order of these has to match the order of HHttpHeader::WellKnownField
+const WellKnownFieldName wellKnownFieldNames[] =
+{
+    { "HOST"             ,  4 },
+    { "DATE"             ,  4 },
+    { "SERVER"           ,  6 },
+    { "USER-AGENT"       , 10 },
+    { "CONNECTION"       , 10 },
+    { "CONTENT-LENGTH"   , 14 },
+    { "CONTENT-TYPE"     , 12 },
+    { "TRANSFER-ENCODING", 17 },
+    { "SOAPACTION"       , 10 },
+    { "CALLBACK"         ,  8 },
+    { "TIMEOUT"          ,  7 },
+    { "SID"              ,  3 },
+    { "SEQ"              ,  3 },
+    { "NT"               ,  2 },
+    { "NTS"              ,  3 },
+    { "USN"              ,  3 },
+    { "ST"               ,  2 },
+    { "LOCATION"         ,  8 },
+    { "CACHE-CONTROL"    , 13 },
+    { "EXT"              ,  3 },
+    { "RANGE"            ,  5 },
+    { "CONTENT-RANGE"    , 13 },
+    { "ACCEPT-RANGES"    , 13 },
+    { "ACCEPT-ENCODING"  , 15 },
+    { "CONTENT-ENCODING" , 16 },
+    { "VARY"             ,  4 },
+    { "ETAG"             ,  4 },
+    { "LAST-MODIFIED"    , 13 },
+    { "IF-NONE-MATCH"    , 13 },
+    { "MAN"              ,  3 },
+    { "MX"               ,  2 },
+    { "BOOTID.UPNP.ORG"  , 15 },
+    { "NEXTBOOTID.UPNP.ORG", 19 },
+    { "CONFIGID.UPNP.ORG", 17 },
+    { "SEARCHPORT.UPNP.ORG", 19 }
+};
+
+inline bool isWhitespace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// isdigit() is undefined for the negative values a char holds on most
+// platforms when the byte is not ASCII
+inline bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+bool parseVersion(const QByteArray& version, int* major, int* minor)
 {
     if (version.length() >= 8 &&
-        version.left(5) == "HTTP/" &&
-        version[5].isDigit() && version[6] == '.' &&
-        version[7].isDigit())
+        version.startsWith("HTTP/") &&
+        isDigit(version[5]) && version[6] == '.' &&
+        isDigit(version[7]))
     {
-        *major = version[5].toLatin1() - '0';
-        *minor = version[7].toLatin1() - '0';
+        *major = version[5] - '0';
+        *minor = version[7] - '0';
         return true;
     }
 
@@ -66,8 +112,9 @@ namespace Upnp
  * HHttpHeader
  ******************************************************************************/
 HHttpHeader::HHttpHeader() :
-    m_values(), m_valid(false), m_majorVersion(0), m_minorVersion(0)
+    m_data(), m_fields(), m_valid(false), m_majorVersion(0), m_minorVersion(0)
 {
+    clearIndex();
 }
 
 HHttpHeader::~HHttpHeader()
@@ -75,14 +122,12 @@ HHttpHeader::~HHttpHeader()
 }
 
 HHttpHeader::HHttpHeader(const HHttpHeader& other) :
-    m_values(), m_valid(false), m_majorVersion(0), m_minorVersion(0)
+    m_data(other.m_data), m_fields(other.m_fields),
+    m_valid(other.m_valid), m_majorVersion(other.m_majorVersion),
+    m_minorVersion(other.m_minorVersion)
 {
     Q_ASSERT(this != &other);
-
-    m_values = other.m_values;
-    m_valid = other.m_valid;
-    m_majorVersion = other.m_majorVersion;
-    m_minorVersion = other.m_minorVersion;
+    memcpy(m_index, other.m_index, sizeof(m_index));
 }
 
 HHttpHeader& HHttpHeader::operator=(const HHttpHeader& other)
@@ -92,30 +137,105 @@ HHttpHeader& HHttpHeader::operator=(const HHttpHeader& other)
     m_majorVersion = other.m_majorVersion;
     m_minorVersion = other.m_minorVersion;
     m_valid = other.m_valid;
-    m_values = other.m_values;
+    m_data = other.m_data;
+    m_fields = other.m_fields;
+    memcpy(m_index, other.m_index, sizeof(m_index));
 
     return *this;
 }
 
-bool HHttpHeader::parse(const QString& str)
+HHttpHeader::WellKnownField HHttpHeader::wellKnownField(
+    const char* name, qint32 length)
+{
+    for (qint32 i = 0; i < Field_Count; ++i)
+    {
+        if (wellKnownFieldNames[i].m_length == length &&
+            qstrnicmp(wellKnownFieldNames[i].m_name, name, length) == 0)
+        {
+            return static_cast<WellKnownField>(i);
+        }
+    }
+
+    return Field_Undefined;
+}
+
+const char* HHttpHeader::wellKnownFieldName(WellKnownField field)
+{
+    Q_ASSERT(field > Field_Undefined && field < Field_Count);
+    return wellKnownFieldNames[field].m_name;
+}
+
+void HHttpHeader::clearIndex()
+{
+    for (qint32 i = 0; i < Field_Count; ++i)
+    {
+        m_index[i] = -1;
+    }
+}
+
+qint32 HHttpHeader::searchKey(const char* key, qint32 length) const
+{
+    WellKnownField field = wellKnownField(key, length);
+    if (field != Field_Undefined)
+    {
+        return m_index[field];
+    }
+
+    const char* data = m_data.constData();
+    for (qint32 i = 0; i < m_fields.size(); ++i)
+    {
+        const Field& f = m_fields[i];
+        if (f.m_keyLength == length &&
+            qstrnicmp(data + f.m_keyOffset, key, length) == 0)
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+bool HHttpHeader::parse(const QByteArray& data)
 {
-    QStringList lines = str.trimmed().split("\r\n");
+    m_data = data;
+    m_fields.clear();
+    clearIndex();
+
+    const char* raw = m_data.constData();
+    qint32 size = m_data.size();
+
+    qint32 pos = 0;
+    while(pos < size && isWhitespace(raw[pos]))
+    {
+        ++pos;
+    }
 
-    if (lines.isEmpty())
+    if (pos >= size)
     {
         return false;
     }
 
-    parseFirstLine(lines[0]);
-    lines.removeFirst();
+    qint32 lineEnd = m_data.indexOf("\r\n", pos);
+    if (lineEnd < 0)
+    {
+        lineEnd = size;
+    }
+
+    parseFirstLine(QByteArray::fromRawData(raw + pos, lineEnd - pos));
 
-    foreach(const QString& line, lines)
+    for(pos = lineEnd + 2; pos < size; pos = lineEnd + 2)
     {
-        if (line.isEmpty())
+        lineEnd = m_data.indexOf("\r\n", pos);
+        if (lineEnd < 0)
+        {
+            lineEnd = size;
+        }
+
+        if (lineEnd == pos)
         {
             break;
         }
-        else if (!parseLine(line))
+        else if (!parseLine(pos, lineEnd - pos))
         {
             m_valid = false;
             return false;
@@ -125,66 +245,216 @@ bool HHttpHeader::parse(const QString& str)
     return true;
 }
 
-QString HHttpHeader::value(const QString& key) const
+bool HHttpHeader::parseLine(qint32 offset, qint32 length)
 {
-    int index = searchKey(key, m_values);
-    return index >= 0 ? m_values[index].second : QString();
-}
+    const char* raw = m_data.constData();
 
-bool HHttpHeader::hasKey(const QString& key) const
-{
-    return searchKey(key, m_values) >= 0;
+    const char* colon =
+        static_cast<const char*>(memchr(raw + offset, ':', length));
+
+    if (!colon)
+    {
+        return false;
+    }
+
+    Field field;
+
+    field.m_keyOffset = offset;
+    field.m_keyLength = colon - (raw + offset);
+    while(field.m_keyLength > 0 && isWhitespace(raw[field.m_keyOffset]))
+    {
+        ++field.m_keyOffset; --field.m_keyLength;
+    }
+    while(field.m_keyLength > 0 &&
+          isWhitespace(raw[field.m_keyOffset + field.m_keyLength - 1]))
+    {
+        --field.m_keyLength;
+    }
+
+    field.m_valueOffset = colon - raw + 1;
+    field.m_valueLength = offset + length - field.m_valueOffset;
+    while(field.m_valueLength > 0 && isWhitespace(raw[field.m_valueOffset]))
+    {
+        ++field.m_valueOffset; --field.m_valueLength;
+    }
+    while(field.m_valueLength > 0 &&
+          isWhitespace(raw[field.m_valueOffset + field.m_valueLength - 1]))
+    {
+        --field.m_valueLength;
+    }
+
+    WellKnownField wkf =
+        wellKnownField(raw + field.m_keyOffset, field.m_keyLength);
+
+    m_fields.append(field);
+
+    if (wkf != Field_Undefined && m_index[wkf] < 0)
+    {
+        m_index[wkf] = m_fields.size() - 1;
+    }
+
+    return true;
 }
 
-void HHttpHeader::setValue(const QString& key, const QString& value)
+void HHttpHeader::setRawValue(
+    const QByteArray& key, const QByteArray& value, WellKnownField wkf)
 {
-    int index = searchKey(key, m_values);
+    qint32 index = wkf != Field_Undefined ?
+        m_index[wkf] : searchKey(key.constData(), key.size());
+
     if (index >= 0)
     {
-        m_values[index].second = value;
+        Field& field = m_fields[index];
+        if (value.size() <= field.m_valueLength)
+        {
+            // the new value fits in the place of the old one
+            memcpy(m_data.data() + field.m_valueOffset,
+                   value.constData(), value.size());
+        }
+        else
+        {
+            field.m_valueOffset = m_data.size();
+            m_data.append(value);
+        }
+        field.m_valueLength = value.size();
     }
     else
     {
-        addValue(key, value);
+        Field field;
+        field.m_keyOffset = m_data.size();
+        field.m_keyLength = key.size();
+        m_data.append(key);
+
+        field.m_valueOffset = m_data.size();
+        field.m_valueLength = value.size();
+        m_data.append(value);
+
+        m_fields.append(field);
+        if (wkf != Field_Undefined)
+        {
+            m_index[wkf] = m_fields.size() - 1;
+        }
     }
 }
 
-bool HHttpHeader::parseLine(const QString& line)
+void HHttpHeader::setValue(const QString& key, const QString& value)
+{
+    QByteArray keyData = key.toUtf8();
+    setRawValue(
+        keyData, value.toUtf8(),
+        wellKnownField(keyData.constData(), keyData.size()));
+}
+
+void HHttpHeader::setValue(WellKnownField field, const QByteArray& value)
+{
+    Q_ASSERT(field > Field_Undefined && field < Field_Count);
+
+    const WellKnownFieldName& name = wellKnownFieldNames[field];
+    setRawValue(
+        QByteArray::fromRawData(name.m_name, name.m_length), value, field);
+}
+
+QString HHttpHeader::value(const QString& key) const
+{
+    QByteArray keyData = key.toUtf8();
+    return valueAt(searchKey(keyData.constData(), keyData.size()));
+}
+
+QString HHttpHeader::value(const char* key) const
+{
+    return valueAt(searchKey(key, qstrlen(key)));
+}
+
+QByteArray HHttpHeader::rawValue(const char* key) const
+{
+    return rawValueAt(searchKey(key, qstrlen(key)));
+}
+
+bool HHttpHeader::hasKey(const QString& key) const
+{
+    QByteArray keyData = key.toUtf8();
+    return searchKey(keyData.constData(), keyData.size()) >= 0;
+}
+
+bool HHttpHeader::hasKey(const char* key) const
 {
-    int i = line.indexOf(QLatin1Char(':'));
-    if (i == -1)
+    return searchKey(key, qstrlen(key)) >= 0;
+}
+
+bool HHttpHeader::valueEquals(WellKnownField field, const char* value) const
+{
+    qint32 index = m_index[field];
+    if (index < 0)
     {
         return false;
     }
 
-    addValue(line.left(i).trimmed(), line.mid(i + 1).trimmed());
-
-    return true;
+    const Field& f = m_fields[index];
+    return static_cast<qint32>(qstrlen(value)) == f.m_valueLength &&
+           qstrnicmp(m_data.constData() + f.m_valueOffset,
+                     value, f.m_valueLength) == 0;
 }
 
-QString HHttpHeader::toString() const
+uint HHttpHeader::contentLength() const
 {
-    if (!isValid())
+    qint32 index = m_index[Field_ContentLength];
+    if (index < 0)
+    {
+        return 0;
+    }
+
+    const Field& f = m_fields[index];
+    const char* data = m_data.constData() + f.m_valueOffset;
+
+    uint retVal = 0;
+    for (qint32 i = 0; i < f.m_valueLength; ++i)
     {
-        return "";
+        if (!isDigit(data[i]))
+        {
+            return 0;
+        }
+
+        uint digit = data[i] - '0';
+        if (retVal > (UINT_MAX - digit) / 10)
+        {
+            return 0;
+        }
+
+        retVal = retVal * 10 + digit;
     }
 
-    QString retVal;
+    return retVal;
+}
+
+void HHttpHeader::fieldsToBytes(QByteArray& target) const
+{
+    const char* data = m_data.constData();
+    foreach(const Field& field, m_fields)
+    {
+        target.append(data + field.m_keyOffset, field.m_keyLength)
+              .append(": ", 2)
+              .append(data + field.m_valueOffset, field.m_valueLength)
+              .append("\r\n", 2);
+    }
+}
 
-    QList<QPair<QString, QString> >::const_iterator it = m_values.constBegin();
-    for (; it != m_values.constEnd(); ++it) {
-        retVal.append((*it).first)
-              .append(": ")
-              .append((*it).second)
-              .append("\r\n");
+QByteArray HHttpHeader::toBytes() const
+{
+    if (!isValid())
+    {
+        return QByteArray();
     }
 
+    QByteArray retVal;
+    retVal.reserve(m_data.size() + m_fields.size() * 4);
+    fieldsToBytes(retVal);
+
     return retVal;
 }
 
 QString HHttpHeader::contentType(bool includeCharset) const
 {
-    QString type = value("content-type");
+    QString type = value(Field_ContentType);
     if (type.isEmpty())
     {
         return type;
@@ -215,7 +485,16 @@ HHttpResponseHeader::HHttpResponseHeader() :
 HHttpResponseHeader::HHttpResponseHeader(const QString& str) :
     HHttpHeader(), m_statusCode(0), m_reasonPhrase()
 {
-    if (parse(str))
+    if (parse(str.toUtf8()))
+    {
+        m_valid = true;
+    }
+}
+
+HHttpResponseHeader::HHttpResponseHeader(const QByteArray& data) :
+    HHttpHeader(), m_statusCode(0), m_reasonPhrase()
+{
+    if (parse(data))
     {
         m_valid = true;
     }
@@ -263,9 +542,9 @@ bool HHttpResponseHeader::setStatusLine(
     return true;
 }
 
-bool HHttpResponseHeader::parseFirstLine(const QString& constLine)
+bool HHttpResponseHeader::parseFirstLine(const QByteArray& constLine)
 {
-    QString line = constLine.simplified();
+    QByteArray line = constLine.simplified();
     if (line.length() < 10)
     {
         return false;
@@ -276,12 +555,12 @@ bool HHttpResponseHeader::parseFirstLine(const QString& constLine)
         return false;
     }
 
-    if (line[8] == ' ' && line[9].isDigit())
+    if (line[8] == ' ' && isDigit(line[9]))
     {
         int pos = line.indexOf(' ', 9);
         if (pos != -1)
         {
-            m_reasonPhrase = line.mid(pos + 1);
+            m_reasonPhrase = QString::fromUtf8(line.mid(pos + 1));
             m_statusCode = line.mid(9, pos - 9).toInt();
         }
         else {
@@ -295,16 +574,27 @@ bool HHttpResponseHeader::parseFirstLine(const QString& constLine)
     return false;
 }
 
-QString HHttpResponseHeader::toString() const
+QByteArray HHttpResponseHeader::toBytes() const
 {
     if (!isValid())
     {
-        return "";
+        return QByteArray();
     }
 
-    return QString("HTTP/%1.%2 %3 %4\r\n%5\r\n").arg(m_majorVersion).arg(
-        m_minorVersion).arg(m_statusCode).arg(m_reasonPhrase).arg(
-            HHttpHeader::toString());
+    QByteArray reasonPhrase = m_reasonPhrase.toUtf8();
+
+    QByteArray retVal;
+    retVal.reserve(512);
+    retVal.append("HTTP/", 5)
+          .append(QByteArray::number(m_majorVersion)).append('.')
+          .append(QByteArray::number(m_minorVersion)).append(' ')
+          .append(QByteArray::number(m_statusCode)).append(' ')
+          .append(reasonPhrase).append("\r\n", 2);
+
+    fieldsToBytes(retVal);
+    retVal.append("\r\n", 2);
+
+    return retVal;
 }
 
 /*******************************************************************************
@@ -328,7 +618,17 @@ HHttpRequestHeader::HHttpRequestHeader(const QString& str) :
     HHttpHeader(),
         m_method(), m_path()
 {
-    if (parse(str))
+    if (parse(str.toUtf8()))
+    {
+        m_valid = true;
+    }
+}
+
+HHttpRequestHeader::HHttpRequestHeader(const QByteArray& data) :
+    HHttpHeader(),
+        m_method(), m_path()
+{
+    if (parse(data))
     {
         m_valid = true;
     }
@@ -368,15 +668,15 @@ bool HHttpRequestHeader::setRequest(
     return true;
 }
 
-bool HHttpRequestHeader::parseFirstLine(const QString& line)
+bool HHttpRequestHeader::parseFirstLine(const QByteArray& line)
 {
-    QStringList list = line.simplified().split(" ");
+    QList<QByteArray> list = line.simplified().split(' ');
     if (list.size() > 0)
     {
-        m_method = list[0];
+        m_method = QString::fromUtf8(list[0]);
         if (list.size() > 1)
         {
-            m_path = list[1];
+            m_path = QString::fromUtf8(list[1]);
             if (list.size() > 2)
             {
                 return parseVersion(list[2], &m_majorVersion, &m_minorVersion);
@@ -387,16 +687,24 @@ bool HHttpRequestHeader::parseFirstLine(const QString& line)
     return false;
 }
 
-QString HHttpRequestHeader::toString() const
+QByteArray HHttpRequestHeader::toBytes() const
 {
     if (!isValid())
     {
-        return "";
+        return QByteArray();
     }
 
-    return QString("%1 %2 HTTP/%3.%4\r\n%5\r\n").arg(
-        m_method, m_path, QString::number(m_majorVersion),
-        QString::number(m_minorVersion), HHttpHeader::toString());
+    QByteArray retVal;
+    retVal.reserve(512);
+    retVal.append(m_method.toUtf8()).append(' ')
+          .append(m_path.toUtf8()).append(" HTTP/", 6)
+          .append(QByteArray::number(m_majorVersion)).append('.')
+          .append(QByteArray::number(m_minorVersion)).append("\r\n", 2);
+
+    fieldsToBytes(retVal);
+    retVal.append("\r\n", 2);
+
+    return retVal;
 }
 
 }
@@ -32,9 +32,9 @@
 
 #include <HUpnpCore/HUpnp>
 
-#include <QtCore/QList>
-#include <QtCore/QPair>
+#include <QtCore/QVector>
 #include <QtCore/QString>
+#include <QtCore/QByteArray>
 
 namespace Herqq
 {
@@ -47,28 +47,126 @@ namespace Upnp
 // the Qt's QHttpHeader. The main reason this class exists is that Qt
 // has deprecated QHttpHeader.
 //
+// The header data is stored as UTF-8 bytes and the fields are stored as
+// (offset, length) pairs into that data. The location of each of the fields
+// HUPnP uses frequently is indexed, which makes the lookup of those
+// constant time.
+//
 class H_UPNP_CORE_EXPORT HHttpHeader
 {
+public:
+
+    //
+    // The header fields that are indexed.
+    //
+    enum WellKnownField
+    {
+        Field_Undefined = -1,
+        Field_Host = 0,
+        Field_Date,
+        Field_Server,
+        Field_UserAgent,
+        Field_Connection,
+        Field_ContentLength,
+        Field_ContentType,
+        Field_TransferEncoding,
+        Field_SoapAction,
+        Field_Callback,
+        Field_Timeout,
+        Field_Sid,
+        Field_Seq,
+        Field_Nt,
+        Field_Nts,
+        Field_Usn,
+        Field_St,
+        Field_Location,
+        Field_CacheControl,
+        Field_Ext,
+        Field_Range,
+        Field_ContentRange,
+        Field_AcceptRanges,
+        Field_AcceptEncoding,
+        Field_ContentEncoding,
+        Field_Vary,
+        Field_ETag,
+        Field_LastModified,
+        Field_IfNoneMatch,
+        Field_Man,
+        Field_Mx,
+        Field_BootId,
+        Field_NextBootId,
+        Field_ConfigId,
+        Field_SearchPort,
+        Field_Count
+    };
+
+    // returns the well-known field matching the specified name, which is
+    // compared case-insensitively, or Field_Undefined
+    static WellKnownField wellKnownField(const char* name, qint32 length);
+
+    // returns the name of the specified well-known field
+    static const char* wellKnownFieldName(WellKnownField);
 
 private:
 
-    bool parseLine(const QString&);
+    struct Field
+    {
+        qint32 m_keyOffset;
+        qint32 m_keyLength;
+        qint32 m_valueOffset;
+        qint32 m_valueLength;
+    };
+
+    QByteArray m_data;
+    // the data the fields reference. the fields of a parsed header
+    // reference the received bytes and the values set afterwards are
+    // appended to the end
 
-    virtual bool parseFirstLine(const QString&) = 0;
+    QVector<Field> m_fields;
+    // the header fields in the order of appearance
 
-protected:
+    qint32 m_index[Field_Count];
+    // the position of each well-known field in m_fields or -1 in case the
+    // field is not present
+
+    void clearIndex();
+
+    qint32 searchKey(const char* key, qint32 length) const;
+
+    void setRawValue(
+        const QByteArray& key, const QByteArray& value, WellKnownField);
 
-    QList<QPair<QString, QString> > m_values;
+    bool parseLine(qint32 offset, qint32 length);
+
+    virtual bool parseFirstLine(const QByteArray&) = 0;
+
+    inline QByteArray rawValueAt(qint32 index) const
+    {
+        return index >= 0 ?
+            m_data.mid(m_fields[index].m_valueOffset,
+                       m_fields[index].m_valueLength) :
+            QByteArray();
+    }
+
+    inline QString valueAt(qint32 index) const
+    {
+        return index >= 0 ?
+            QString::fromUtf8(
+                m_data.constData() + m_fields[index].m_valueOffset,
+                m_fields[index].m_valueLength) :
+            QString();
+    }
+
+protected:
 
     bool m_valid;
     int m_majorVersion;
     int m_minorVersion;
 
-    bool parse(const QString&);
-    inline void addValue(const QString& key, const QString& value)
-    {
-        m_values.append(qMakePair(key, value));
-    }
+    bool parse(const QByteArray&);
+
+    // appends the header fields to the target in the HTTP format
+    void fieldsToBytes(QByteArray& target) const;
 
     HHttpHeader(const HHttpHeader&);
     HHttpHeader& operator=(const HHttpHeader&);
@@ -79,37 +177,68 @@ public:
     virtual ~HHttpHeader() = 0;
 
     void setValue(const QString& key, const QString& value);
+    void setValue(WellKnownField, const QByteArray& value);
+
     bool hasKey(const QString&) const;
+    bool hasKey(const char*) const;
+
+    inline bool hasKey(WellKnownField field) const
+    {
+        return m_index[field] >= 0;
+    }
+
     QString value(const QString&) const;
+    QString value(const char*) const;
 
-    inline bool hasContentLength() const
+    inline QString value(WellKnownField field) const
     {
-        return hasKey("content-length");
+        return valueAt(m_index[field]);
     }
 
-    inline uint contentLength() const
+    // returns the value without converting it from UTF-8
+    QByteArray rawValue(const char*) const;
+
+    inline QByteArray rawValue(WellKnownField field) const
     {
-        return value("content-length").toUInt();
+        return rawValueAt(m_index[field]);
     }
 
-    inline void setContentLength(int len)
+    // checks if the value of the specified field equals the specified value
+    // using a case-insensitive comparison. no memory is allocated.
+    bool valueEquals(WellKnownField, const char* value) const;
+
+    inline bool hasContentLength() const
     {
-        setValue("content-length", QString::number(len));
+        return hasKey(Field_ContentLength);
+    }
+
+    // returns zero in case the field is not present or it is invalid
+    uint contentLength() const;
+
+    inline void setContentLength(qint64 len)
+    {
+        setValue(Field_ContentLength, QByteArray::number(len));
     }
 
     inline bool hasContentType() const
     {
-        return hasKey("content-type");
+        return hasKey(Field_ContentType);
     }
 
     QString contentType(bool includeCharset=false) const;
 
     inline void setContentType(const QString& type)
     {
-        setValue("content-type", type);
+        setValue(Field_ContentType, type.toUtf8());
     }
 
-    virtual QString toString() const;
+    // serializes the header into the format that is sent over the wire
+    virtual QByteArray toBytes() const;
+
+    inline QString toString() const
+    {
+        return QString::fromUtf8(toBytes());
+    }
 
     inline bool isValid() const { return m_valid; }
 
@@ -127,7 +256,7 @@ class H_UPNP_CORE_EXPORT HHttpResponseHeader :
 {
 private:
 
-    virtual bool parseFirstLine(const QString& line);
+    virtual bool parseFirstLine(const QByteArray& line);
 
 protected:
 
@@ -137,7 +266,8 @@ protected:
 public:
 
     HHttpResponseHeader();
-    HHttpResponseHeader(const QString &str);
+    HHttpResponseHeader(const QString& str);
+    HHttpResponseHeader(const QByteArray& data);
     HHttpResponseHeader(
         int code, const QString& text = QString(),
         int majorVer = 1, int minorVer = 1);
@@ -159,7 +289,7 @@ public:
         return m_reasonPhrase;
     }
 
-    virtual QString toString() const;
+    virtual QByteArray toBytes() const;
 };
 
 //
@@ -173,7 +303,7 @@ class H_UPNP_CORE_EXPORT HHttpRequestHeader :
 
 private:
 
-    virtual bool parseFirstLine(const QString&);
+    virtual bool parseFirstLine(const QByteArray&);
 
 protected:
 
@@ -189,6 +319,7 @@ public:
         int majorVer = 1, int minorVer = 1);
 
     HHttpRequestHeader(const QString&);
+    HHttpRequestHeader(const QByteArray&);
 
     HHttpRequestHeader(const HHttpRequestHeader&);
     HHttpRequestHeader& operator=(const HHttpRequestHeader&);
@@ -207,7 +338,7 @@ public:
         return m_path;
     }
 
-    virtual QString toString() const;
+    virtual QByteArray toBytes() const;
 };
 
 }
@@ -23,6 +23,7 @@
 #include "hhttp_messaginginfo_p.h"
 #include "hhttp_header_p.h"
 #include "hhttp_utils_p.h"
+#include "hsoap_p.h"
 
 #include "../devicehosting/messages/hevent_messages_p.h"
 #include "../dataelements/hactioninfo.h"
@@ -30,7 +31,11 @@
 
 #include "../general/hupnp_global_p.h"
 
-#include <QtSoapMessage>
+#include <QtCore/QMutex>
+#include <QtCore/QDateTime>
+#include <QtCore/QMutexLocker>
+
+#include <ctime>
 
 namespace Herqq
 {
@@ -41,89 +46,213 @@ namespace Upnp
 namespace
 {
 void checkForActionError(
-    qint32 actionRetVal, QtSoapMessage::FaultCode* soapFault, qint32* httpStatusCode,
-    QString* httpReasonPhrase)
+    qint32 actionRetVal, qint32* httpStatusCode, QString* httpReasonPhrase)
 {
     HLOG(H_AT, H_FUN);
 
     Q_ASSERT(httpStatusCode);
     Q_ASSERT(httpReasonPhrase);
-    Q_ASSERT(soapFault);
 
     if (actionRetVal == UpnpInvalidArgs)
     {
         *httpStatusCode   = 402;
         *httpReasonPhrase = "Invalid Args";
-        *soapFault        = QtSoapMessage::Client;
     }
     else if (actionRetVal == UpnpActionFailed)
     {
         *httpStatusCode   = 501;
         *httpReasonPhrase = "Action Failed";
-        *soapFault        = QtSoapMessage::Client;
     }
     else if (actionRetVal == UpnpArgumentValueInvalid)
     {
         *httpStatusCode   = 600;
         *httpReasonPhrase = "Argument Value Invalid";
-        *soapFault        = QtSoapMessage::Client;
     }
     else if (actionRetVal == UpnpArgumentValueOutOfRange)
     {
         *httpStatusCode   = 601;
         *httpReasonPhrase = "Argument Value Out of Range";
-        *soapFault        = QtSoapMessage::Client;
     }
     else if (actionRetVal == UpnpOptionalActionNotImplemented)
     {
         *httpStatusCode   = 602;
         *httpReasonPhrase = "Optional Action Not Implemented";
-        *soapFault        = QtSoapMessage::Client;
     }
     else if (actionRetVal == UpnpOutOfMemory)
     {
         *httpStatusCode   = 603;
         *httpReasonPhrase = "Out of Memory";
-        *soapFault        = QtSoapMessage::Client;
     }
     else if (actionRetVal == UpnpHumanInterventionRequired)
     {
         *httpStatusCode   = 604;
         *httpReasonPhrase = "Human Intervention Required";
-        *soapFault        = QtSoapMessage::Client;
     }
     else if (actionRetVal == UpnpStringArgumentTooLong)
     {
         *httpStatusCode   = 605;
         *httpReasonPhrase = "String Argument Too Long";
-        *soapFault        = QtSoapMessage::Client;
     }
     else
     {
         *httpStatusCode   = actionRetVal;
         *httpReasonPhrase = QString::number(actionRetVal);
-        *soapFault        = QtSoapMessage::Client;
     }
 }
 
-QString contentTypeToString(ContentType ct)
+const char* contentTypeToString(ContentType ct)
 {
-    QString retVal;
     switch(ct)
     {
     case ContentType_TextXml:
-        retVal = "text/xml; charset=\"utf-8\"";
-        break;
+        return "text/xml; charset=\"utf-8\"";
     case ContentType_OctetStream:
-        retVal = "application/octet-stream";
-        break;
+        return "application/octet-stream";
+    case ContentType_ImagePng:
+        return "image/png";
+    case ContentType_ImageJpeg:
+        return "image/jpeg";
+    case ContentType_ImageGif:
+        return "image/gif";
+    case ContentType_ImageBmp:
+        return "image/bmp";
+    case ContentType_OpenMetrics:
+        return "application/openmetrics-text; version=1.0.0; charset=utf-8";
     default:
-        ;
+        return 0;
+    }
+}
+
+//
+// Caches the parts of HTTP messages that rarely change: the DATE field,
+// which changes once per second, and the SERVER field, which is the same for
+// every message a server sends.
+//
+class HMessageTemplateCache
+{
+H_DISABLE_COPY(HMessageTemplateCache)
+
+private:
+
+    QMutex m_mutex;
+
+    time_t m_dateTime;
+    QByteArray m_date;
+
+    QString m_serverTokens;
+    QByteArray m_serverTokensBytes;
+
+public:
+
+    HMessageTemplateCache() :
+        m_mutex(), m_dateTime(0), m_date(),
+        m_serverTokens(), m_serverTokensBytes()
+    {
+    }
+
+    QByteArray date()
+    {
+        time_t now = ::time(0);
+
+        QMutexLocker locker(&m_mutex);
+        if (now != m_dateTime)
+        {
+            m_date = HHttpUtils::toHttpDate(
+                QDateTime::fromTime_t(static_cast<uint>(now)).toUTC());
+
+            m_dateTime = now;
+        }
+
+        return m_date;
+    }
+
+    QByteArray serverTokens(const HProductTokens& tokens)
+    {
+        QString str = tokens.toString();
+
+        QMutexLocker locker(&m_mutex);
+        if (str != m_serverTokens)
+        {
+            m_serverTokens = str;
+            m_serverTokensBytes = str.toUtf8();
+        }
+
+        return m_serverTokensBytes;
     }
+};
+
+HMessageTemplateCache s_templateCache;
+
+inline bool useChunked(const HMessagingInfo& mi, qint64 bodySizeInBytes)
+{
+    return mi.chunkedInfo().max() > 0 &&
+           bodySizeInBytes > mi.chunkedInfo().max();
+}
+
+//
+// Creates an HTTP/1.1 response using the cached fields into a buffer that is
+// allocated once. The result is equivalent to what setupData() produces for
+// an HHttpResponseHeader, but this cannot be used when the body is sent
+// in chunks. The body may be empty when only the header is needed.
+//
+QByteArray createResponseData(
+    qint32 statusCode, const QByteArray& reasonPhrase, const HMessagingInfo& mi,
+    qint64 bodySizeInBytes, const QByteArray& body, ContentType ct)
+{
+    Q_ASSERT(!useChunked(mi, bodySizeInBytes));
+
+    QByteArray date = s_templateCache.date();
+
+    QByteArray server;
+    HProductTokens serverTokens = mi.serverInfo();
+    if (!serverTokens.isEmpty())
+    {
+        server = s_templateCache.serverTokens(serverTokens);
+    }
+
+    QByteArray host = mi.hostInfo().toUtf8();
+    const char* contentType = contentTypeToString(ct);
+
+    QByteArray retVal;
+    retVal.reserve(
+        160 + reasonPhrase.size() + date.size() + server.size() +
+        host.size() + body.size());
+
+    retVal.append("HTTP/1.1 ", 9)
+          .append(QByteArray::number(statusCode)).append(' ')
+          .append(reasonPhrase).append("\r\n", 2);
+
+    retVal.append("DATE: ", 6).append(date).append("\r\n", 2);
+
+    if (contentType)
+    {
+        retVal.append("CONTENT-TYPE: ", 14).append(contentType).append("\r\n", 2);
+    }
+
+    retVal.append("EXT: \r\n", 7);
+
+    if (!server.isEmpty())
+    {
+        retVal.append("SERVER: ", 8).append(server).append("\r\n", 2);
+    }
+
+    if (!mi.keepAlive())
+    {
+        retVal.append("CONNECTION: close\r\n", 19);
+    }
+
+    retVal.append("HOST: ", 6).append(host).append("\r\n", 2);
+
+    retVal.append("CONTENT-LENGTH: ", 16)
+          .append(QByteArray::number(bodySizeInBytes))
+          .append("\r\n\r\n", 4);
+
+    retVal.append(body);
+
     return retVal;
 }
 
-void getStatusInfo(StatusCode sc, qint32* statusCode, QString* reasonPhrase)
+void getStatusInfo(StatusCode sc, qint32* statusCode, const char** reasonPhrase)
 {
     switch(sc)
     {
@@ -132,6 +261,16 @@ void getStatusInfo(StatusCode sc, qint32* statusCode, QString* reasonPhrase)
         *reasonPhrase = "OK";
         break;
 
+    case PartialContent:
+        *statusCode = 206;
+        *reasonPhrase = "Partial Content";
+        break;
+
+    case NotModified:
+        *statusCode = 304;
+        *reasonPhrase = "Not Modified";
+        break;
+
     case BadRequest:
         *statusCode = 400;
         *reasonPhrase = "Bad Request";
@@ -167,6 +306,11 @@ void getStatusInfo(StatusCode sc, qint32* statusCode, QString* reasonPhrase)
         *reasonPhrase = "Precondition Failed";
         break;
 
+    case RequestedRangeNotSatisfiable:
+        *statusCode = 416;
+        *reasonPhrase = "Requested Range Not Satisfiable";
+        break;
+
     case InternalServerError:
         *statusCode = 500;
         *reasonPhrase = "Internal Server Error";
@@ -205,43 +349,45 @@ QByteArray HHttpMessageCreator::setupData(
     HLOG(H_AT, H_FUN);
     Q_ASSERT(reqHdr.isValid());
 
-    reqHdr.setValue(
-        "DATE",
-        QDateTime::currentDateTime().toString(HHttpUtils::rfc1123DateFormat()));
+    reqHdr.setValue(HHttpHeader::Field_Date, s_templateCache.date());
 
-    QString contentType = contentTypeToString(ct);
-    if (!contentType.isEmpty())
+    const char* contentType = contentTypeToString(ct);
+    if (contentType)
     {
-        reqHdr.setContentType(contentType);
+        reqHdr.setValue(HHttpHeader::Field_ContentType, contentType);
     }
 
-    reqHdr.setValue("EXT", "");
+    reqHdr.setValue(HHttpHeader::Field_Ext, QByteArray());
 
     HProductTokens serverTokens = mi.serverInfo();
     if (!serverTokens.isEmpty())
     {
-        reqHdr.setValue("Server", serverTokens.toString());
+        reqHdr.setValue(
+            HHttpHeader::Field_Server, s_templateCache.serverTokens(serverTokens));
     }
 
     if (!mi.keepAlive() && reqHdr.minorVersion() == 1)
     {
-        reqHdr.setValue("Connection", "close");
+        reqHdr.setValue(HHttpHeader::Field_Connection, "close");
     }
 
-    reqHdr.setValue("HOST", mi.hostInfo());
+    reqHdr.setValue(HHttpHeader::Field_Host, mi.hostInfo().toUtf8());
 
-    if (mi.chunkedInfo().max() > 0 &&
-        bodySizeInBytes > mi.chunkedInfo().max())
+    if (bodySizeInBytes < 0)
     {
-        reqHdr.setValue("Transfer-Encoding", "chunked");
+        // the size is unknown, in which case the caller is responsible of
+        // defining how the end of the message body is recognized
+    }
+    else if (useChunked(mi, bodySizeInBytes))
+    {
+        reqHdr.setValue(HHttpHeader::Field_TransferEncoding, "chunked");
     }
     else
     {
         reqHdr.setContentLength(bodySizeInBytes);
     }
 
-    QByteArray msg(reqHdr.toString().toUtf8());
-    return msg;
+    return reqHdr.toBytes();
 }
 
 QByteArray HHttpMessageCreator::setupData(
@@ -252,11 +398,27 @@ QByteArray HHttpMessageCreator::setupData(
     Q_ASSERT(reqHdr.isValid());
 
     QByteArray msg = setupData(reqHdr, body.size(), mi, ct);
+    msg.reserve(msg.size() + body.size());
     msg.append(body);
 
     return msg;
 }
 
+QByteArray HHttpMessageCreator::currentDate()
+{
+    return s_templateCache.date();
+}
+
+HHttpResponseHeader HHttpMessageCreator::createResponseHeader(StatusCode sc)
+{
+    qint32 statusCode = 0;
+    const char* reasonPhrase = "";
+
+    getStatusInfo(sc, &statusCode, &reasonPhrase);
+
+    return HHttpResponseHeader(statusCode, QString::fromLatin1(reasonPhrase));
+}
+
 QByteArray HHttpMessageCreator::createResponse(
     StatusCode sc, const HMessagingInfo& mi)
 {
@@ -268,58 +430,71 @@ QByteArray HHttpMessageCreator::createHeaderData(
     ContentType ct)
 {
     qint32 statusCode = 0;
-    QString reasonPhrase = "";
+    const char* reasonPhrase = "";
 
     getStatusInfo(sc, &statusCode, &reasonPhrase);
 
-    HHttpResponseHeader responseHdr(statusCode, reasonPhrase);
-    return setupData(responseHdr, bodySizeInBytes, mi, ct);
+    if (bodySizeInBytes < 0 || useChunked(mi, bodySizeInBytes))
+    {
+        HHttpResponseHeader responseHdr(
+            statusCode, QString::fromLatin1(reasonPhrase));
+
+        return setupData(responseHdr, bodySizeInBytes, mi, ct);
+    }
+
+    return createResponseData(
+        statusCode, QByteArray::fromRawData(reasonPhrase, qstrlen(reasonPhrase)),
+        mi, bodySizeInBytes, QByteArray(), ct);
 }
 
 QByteArray HHttpMessageCreator::createResponse(
     StatusCode sc, const HMessagingInfo& mi, const QByteArray& body, ContentType ct)
 {
     qint32 statusCode = 0;
-    QString reasonPhrase;
+    const char* reasonPhrase = "";
 
     getStatusInfo(sc, &statusCode, &reasonPhrase);
 
-    HHttpResponseHeader responseHdr(statusCode, reasonPhrase);
-    return setupData(responseHdr, body, mi, ct);
+    if (useChunked(mi, body.size()))
+    {
+        HHttpResponseHeader responseHdr(
+            statusCode, QString::fromLatin1(reasonPhrase));
+
+        return setupData(responseHdr, body, mi, ct);
+    }
+
+    return createResponseData(
+        statusCode, QByteArray::fromRawData(reasonPhrase, qstrlen(reasonPhrase)),
+        mi, body.size(), body, ct);
 }
 
 QByteArray HHttpMessageCreator::setupData(
     const HMessagingInfo& mi, qint32 statusCode, const QString& reasonPhrase,
-    const QString& body, ContentType ct)
+    const QByteArray& body, ContentType ct)
 {
-    HHttpResponseHeader responseHdr(statusCode, reasonPhrase);
-    return setupData(responseHdr, body.toUtf8(), mi, ct);
+    if (useChunked(mi, body.size()))
+    {
+        HHttpResponseHeader responseHdr(statusCode, reasonPhrase);
+        return setupData(responseHdr, body, mi, ct);
+    }
+
+    return createResponseData(
+        statusCode, reasonPhrase.toUtf8(), mi, body.size(), body, ct);
 }
 
 QByteArray HHttpMessageCreator::createResponse(
     const HMessagingInfo& mi, qint32 actionErrCode, const QString& description)
 {
-    QtSoapMessage::FaultCode soapFault = QtSoapMessage::Other;
     qint32 httpStatusCode = 0;
     QString httpReasonPhrase;
 
-    checkForActionError(
-        actionErrCode, &soapFault, &httpStatusCode, &httpReasonPhrase);
-
-    QtSoapMessage soapFaultResponse;
-    soapFaultResponse.setFaultCode(soapFault);
-    soapFaultResponse.setFaultString("UPnPError");
-
-    QtSoapStruct* detail = new QtSoapStruct(QtSoapQName("UPnPError"));
-    detail->insert(new QtSoapSimpleType(QtSoapQName("errorCode"), actionErrCode));
-    detail->insert(new QtSoapSimpleType(QtSoapQName("errorDescription"), description));
-    soapFaultResponse.addFaultDetail(detail);
+    checkForActionError(actionErrCode, &httpStatusCode, &httpReasonPhrase);
 
     return setupData(
         mi,
         httpStatusCode,
         httpReasonPhrase,
-        soapFaultResponse.toXmlString(),
+        HSoapMessage::createFault(actionErrCode, description),
         ContentType_TextXml);
 }
 
@@ -444,6 +619,63 @@ int HHttpMessageCreator::create(
     return retVal;
 }
 
+QByteArray HHttpMessageCreator::create(const HMulticastNotifyRequest& req)
+{
+    Q_ASSERT(req.isValid());
+
+    HHttpRequestHeader reqHdr("NOTIFY", "*", 1, 0);
+
+    reqHdr.setValue(
+        HHttpHeader::Field_Host,
+        HMulticastNotifyRequest::multicastEndpoint().toString().toUtf8());
+
+    reqHdr.setContentType("text/xml; charset=\"utf-8\"");
+    reqHdr.setValue(HHttpHeader::Field_Usn, req.usn().toString().toUtf8());
+    reqHdr.setValue("SVCID", req.serviceId().toString());
+    reqHdr.setValue(HHttpHeader::Field_Nt , "upnp:event");
+    reqHdr.setValue(HHttpHeader::Field_Nts, "upnp:propchange");
+    reqHdr.setValue(HHttpHeader::Field_Seq, QByteArray::number(req.seq()));
+    reqHdr.setValue("LVL", req.level());
+
+    if (req.bootId() >= 0)
+    {
+        reqHdr.setValue(
+            HHttpHeader::Field_BootId, QByteArray::number(req.bootId()));
+    }
+
+    reqHdr.setContentLength(req.data().size());
+
+    QByteArray msg = reqHdr.toBytes();
+    msg.append(req.data());
+
+    return msg;
+}
+
+int HHttpMessageCreator::create(
+    const HHttpRequestHeader& reqHdr, const QByteArray& body,
+    HMulticastNotifyRequest& req)
+{
+    HLOG(H_AT, H_FUN);
+
+    bool ok = false;
+    qint32 bootId = reqHdr.rawValue(HHttpHeader::Field_BootId).toInt(&ok);
+
+    HMulticastNotifyRequest nreq;
+    HNotifyRequest::RetVal retVal =
+        nreq.setContents(
+            reqHdr.value(HHttpHeader::Field_Nt),
+            reqHdr.value(HHttpHeader::Field_Nts),
+            reqHdr.value(HHttpHeader::Field_Usn),
+            reqHdr.value("SVCID"),
+            reqHdr.value(HHttpHeader::Field_Seq),
+            reqHdr.value("LVL"),
+            ok ? bootId : -1,
+            body);
+
+    req = nreq;
+    return retVal;
+}
+
 int HHttpMessageCreator::create(
     const HHttpRequestHeader& reqHdr, HSubscribeRequest& req)
 {
@@ -537,8 +769,7 @@ bool HHttpMessageCreator::create(
     HSid      sid     = HSid(respHdr.value("SID"));
     HTimeout  timeout = HTimeout(respHdr.value("TIMEOUT"));
     QString   server  = respHdr.value("SERVER");
-    QDateTime date    =
-        QDateTime::fromString(respHdr.value("DATE"), HHttpUtils::rfc1123DateFormat());
+    QDateTime date    = HHttpUtils::fromHttpDate(respHdr.rawValue("DATE"));
 
     resp = HSubscribeResponse(sid, HProductTokens(server), timeout, date);
     return resp.isValid(false);
@@ -45,6 +45,7 @@ namespace Upnp
 {
 
 class HNotifyRequest;
+class HMulticastNotifyRequest;
 class HSubscribeRequest;
 class HUnsubscribeRequest;
 class HSubscribeResponse;
@@ -65,21 +66,27 @@ private:
 
     static QByteArray setupData(
         const HMessagingInfo&, qint32 statusCode,
-        const QString& reasonPhrase, const QString& body,
-        ContentType);
-
-    static QByteArray setupData(
-        HHttpHeader& reqHdr, qint64 bodySizeBytesInBytes, const HMessagingInfo& mi,
+        const QString& reasonPhrase, const QByteArray& body,
         ContentType);
 
 public:
 
     static QByteArray setupData(HHttpHeader& hdr, const HMessagingInfo&);
 
+    static QByteArray setupData(
+        HHttpHeader& reqHdr, qint64 bodySizeBytesInBytes, const HMessagingInfo& mi,
+        ContentType);
+
     static QByteArray setupData(
         HHttpHeader& hdr, const QByteArray& body, const HMessagingInfo&,
         ContentType);
 
+    // returns the current time formatted for the DATE header field. the
+    // value is cached and formatted at most once per second
+    static QByteArray currentDate();
+
+    static HHttpResponseHeader createResponseHeader(StatusCode);
+
     static QByteArray createResponse(
         StatusCode sc, const HMessagingInfo& mi);
 
@@ -98,10 +105,17 @@ public:
     static QByteArray create(const HUnsubscribeRequest&, HMessagingInfo*);
     static QByteArray create(const HSubscribeResponse& , const HMessagingInfo&);
 
+    // creates a datagram, which is sent as is without the usual HTTP fields
+    static QByteArray create(const HMulticastNotifyRequest&);
+
     static int create(
         const HHttpRequestHeader& reqHdr, const QByteArray& body,
         HNotifyRequest& req);
 
+    static int create(
+        const HHttpRequestHeader& reqHdr, const QByteArray& body,
+        HMulticastNotifyRequest& req);
+
     static int create(
         const HHttpRequestHeader& reqHdr, HSubscribeRequest& req);
 
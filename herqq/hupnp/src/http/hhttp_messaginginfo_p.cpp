@@ -21,6 +21,8 @@
 
 #include "hhttp_messaginginfo_p.h"
 
+#include "../utils/hblockpool_p.h"
+
 #include <QtCore/QUrl>
 #include <QtCore/QList>
 #include <QtNetwork/QTcpSocket>
@@ -32,6 +34,20 @@ namespace Herqq
 namespace Upnp
 {
 
+namespace
+{
+// never deleted, since messaging infos may be deleted during static destruction
+HBlockPool* const s_messagingInfoPool =
+    new HBlockPool(sizeof(HMessagingInfo), 128);
+}
+
+/*******************************************************************************
+ * HHttpBodySink
+ ******************************************************************************/
+HHttpBodySink::~HHttpBodySink()
+{
+}
+
 /*******************************************************************************
  * HMessagingInfo
  ******************************************************************************/
@@ -39,7 +55,8 @@ HMessagingInfo::HMessagingInfo(
     QPair<QTcpSocket*, bool> sock, qint32 receiveTimeoutForNoData) :
         m_sock(), m_keepAlive(false),
         m_receiveTimeoutForNoData(receiveTimeoutForNoData),
-        m_chunkedInfo(), m_msecsToWaitOnSend(-1)
+        m_chunkedInfo(), m_msecsToWaitOnSend(-1), m_maxBodySize(0),
+        m_bodySink(0), m_requestId(0)
 {
     m_sock = qMakePair(QPointer<QTcpSocket>(sock.first), sock.second);
 }
@@ -48,7 +65,8 @@ HMessagingInfo::HMessagingInfo(
     QTcpSocket& sock, qint32 receiveTimeoutForNoData) :
         m_sock(), m_keepAlive(false),
         m_receiveTimeoutForNoData(receiveTimeoutForNoData),
-        m_chunkedInfo(), m_msecsToWaitOnSend(-1)
+        m_chunkedInfo(), m_msecsToWaitOnSend(-1), m_maxBodySize(0),
+        m_bodySink(0), m_requestId(0)
 {
     m_sock = qMakePair(QPointer<QTcpSocket>(&sock), false);
 }
@@ -57,7 +75,8 @@ HMessagingInfo::HMessagingInfo(
     QPair<QTcpSocket*, bool> sock, bool keepAlive, qint32 receiveTimeoutForNoData) :
         m_sock(), m_keepAlive(keepAlive),
         m_receiveTimeoutForNoData(receiveTimeoutForNoData),
-        m_msecsToWaitOnSend(-1)
+        m_msecsToWaitOnSend(-1), m_maxBodySize(0),
+        m_bodySink(0), m_requestId(0)
 {
     m_sock = qMakePair(QPointer<QTcpSocket>(sock.first), sock.second);
 }
@@ -66,7 +85,8 @@ HMessagingInfo::HMessagingInfo(
     QTcpSocket& sock, bool keepAlive, qint32 receiveTimeoutForNoData) :
         m_sock(), m_keepAlive(keepAlive),
         m_receiveTimeoutForNoData(receiveTimeoutForNoData),
-        m_msecsToWaitOnSend(-1)
+        m_msecsToWaitOnSend(-1), m_maxBodySize(0),
+        m_bodySink(0), m_requestId(0)
 {
     m_sock = qMakePair(QPointer<QTcpSocket>(&sock), false);
 }
@@ -80,6 +100,16 @@ HMessagingInfo::~HMessagingInfo()
     }
 }
 
+void* HMessagingInfo::operator new(size_t size)
+{
+    return s_messagingInfoPool->allocate(size);
+}
+
+void HMessagingInfo::operator delete(void* p, size_t size)
+{
+    s_messagingInfoPool->release(p, size);
+}
+
 void HMessagingInfo::setHostInfo(const QUrl& hostInfo)
 {
     QString tmp(hostInfo.host());
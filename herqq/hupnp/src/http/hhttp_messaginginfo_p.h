@@ -46,6 +46,31 @@ namespace Herqq
 namespace Upnp
 {
 
+class HHttpHeader;
+
+//
+// Receives the body of an HTTP message piece by piece as it arrives, which
+// enables large messages to be processed or spooled without buffering them
+// in memory in full.
+//
+class H_UPNP_CORE_EXPORT HHttpBodySink
+{
+public:
+
+    virtual ~HHttpBodySink();
+
+    // called once the header of a message has been received. returning true
+    // means that the body is passed to write() instead of being buffered, in
+    // which case the maximum body size of HMessagingInfo does not apply
+    virtual bool begin(const HHttpHeader&) = 0;
+
+    // returning false aborts the receive operation
+    virtual bool write(const char* data, qint64 size) = 0;
+
+    // called after the last write(), or when the operation fails
+    virtual void end(bool succeeded) = 0;
+};
+
 //
 //
 //
@@ -105,6 +130,17 @@ private:
 
     HProductTokens m_serverTokens;
 
+    qint64 m_maxBodySize;
+    // the maximum size of a message body that is buffered in memory.
+    // zero means no limit
+
+    HHttpBodySink* m_bodySink;
+    // not owned
+
+    quint32 m_requestId;
+    // identifies the spans of the structured tracing that belong to the
+    // message currently transferred. zero means no request
+
 public:
 
      //
@@ -136,6 +172,11 @@ public:
 
     ~HMessagingInfo();
 
+    // a messaging info is created for every connection, which is why
+    // the memory is taken from a pool
+    static void* operator new(size_t size);
+    static void operator delete(void* p, size_t size);
+
     inline QTcpSocket& socket() const
     {
         Q_ASSERT(!m_sock.first.isNull());
@@ -207,6 +248,36 @@ public:
     {
         return m_serverTokens;
     }
+
+    inline void setMaxBodySize(qint64 arg)
+    {
+        m_maxBodySize = arg;
+    }
+
+    inline qint64 maxBodySize() const
+    {
+        return m_maxBodySize;
+    }
+
+    inline void setBodySink(HHttpBodySink* arg)
+    {
+        m_bodySink = arg;
+    }
+
+    inline HHttpBodySink* bodySink() const
+    {
+        return m_bodySink;
+    }
+
+    inline void setRequestId(quint32 arg)
+    {
+        m_requestId = arg;
+    }
+
+    inline quint32 requestId() const
+    {
+        return m_requestId;
+    }
 };
 
 
@@ -41,12 +41,19 @@ enum ContentType
     ContentType_Undefined,
     ContentType_TextPlain,   // text/plain
     ContentType_TextXml,     // "text/xml; charset=\"utf-8\""
-    ContentType_OctetStream  // "application/octet-stream"
+    ContentType_OctetStream, // "application/octet-stream"
+    ContentType_ImagePng,    // "image/png"
+    ContentType_ImageJpeg,   // "image/jpeg"
+    ContentType_ImageGif,    // "image/gif"
+    ContentType_ImageBmp,    // "image/bmp"
+    ContentType_OpenMetrics  // "application/openmetrics-text; ..."
 };
 
 enum StatusCode
 {
     Ok,
+    PartialContent,
+    NotModified,
     BadRequest,
 
     // UDA
@@ -58,6 +65,7 @@ enum StatusCode
     NotFound,
     MethotNotAllowed,
     PreconditionFailed,
+    RequestedRangeNotSatisfiable,
     InternalServerError,
     ServiceUnavailable
 };
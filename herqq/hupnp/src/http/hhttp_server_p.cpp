@@ -26,55 +26,392 @@
 #include "hhttp_messaginginfo_p.h"
 #include "hhttp_messagecreator_p.h"
 
+#include "../general/htrace_p.h"
 #include "../general/hlogger_p.h"
 #include "../utils/hmisc_utils_p.h"
+#include "../utils/htimerwheel_p.h"
+#include "../utils/hstallwatchdog_p.h"
 
 #include "../socket/hendpoint.h"
+#include "../socket/hsocket_poller_p.h"
 #include "../general/hupnp_global_p.h"
 #include "../devicehosting/messages/hcontrol_messages_p.h"
 #include "../devicehosting/messages/hevent_messages_p.h"
 
 #include <QtCore/QUrl>
 #include <QtCore/QTime>
+#include <QtCore/QThread>
+#include <QtCore/QCoreApplication>
 #include <QtCore/QString>
+#include <QtCore/QMetaType>
+#include <QtCore/QMutexLocker>
 #include <QtCore/QByteArray>
 #include <QtNetwork/QTcpSocket>
 
+#if !defined(Q_OS_WIN)
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <cstring>
+#if defined(SO_REUSEPORT)
+#define HUPNP_USE_REUSEPORT
+#endif
+#endif
+
+static bool registerMetaTypes()
+{
+    qRegisterMetaType<Herqq::Upnp::HMessagingInfo*>(
+        "Herqq::Upnp::HMessagingInfo*");
+
+    qRegisterMetaType<Herqq::Upnp::HHttpAsyncOperation*>(
+        "Herqq::Upnp::HHttpAsyncOperation*");
+
+    return true;
+}
+
+static bool test = registerMetaTypes();
+
 namespace Herqq
 {
 
 namespace Upnp
 {
 
+namespace
+{
+// returns the method the request statistics count the specified method under
+QString requestKey(const QString& method)
+{
+    QString retVal = method.toUpper();
+    if (retVal == "GET" || retVal == "HEAD" || retVal == "POST" ||
+        retVal == "NOTIFY" || retVal == "SUBSCRIBE" || retVal == "UNSUBSCRIBE")
+    {
+        return retVal;
+    }
+
+    return QString();
+}
+
+#ifdef HUPNP_USE_REUSEPORT
+// the backlog QTcpServer uses for the sockets it opens itself
+const qint32 ListenBacklog = 50;
+
+//
+// Opens a listening socket that shares its port with the other sockets opened
+// by this function for the same address. returns -1 on failure. in case the
+// port is 0, the port is chosen by the system and it can be read from the
+// returned socket.
+//
+qint32 openSharedListener(const QHostAddress& address, quint16 port)
+{
+    sockaddr_storage storage;
+    std::memset(&storage, 0, sizeof(storage));
+
+    socklen_t length = 0;
+    if (address.protocol() == QAbstractSocket::IPv4Protocol)
+    {
+        sockaddr_in* sa = reinterpret_cast<sockaddr_in*>(&storage);
+        sa->sin_family = AF_INET;
+        sa->sin_port = htons(port);
+        sa->sin_addr.s_addr = htonl(address.toIPv4Address());
+        length = sizeof(sockaddr_in);
+    }
+    else if (address.protocol() == QAbstractSocket::IPv6Protocol)
+    {
+        sockaddr_in6* sa = reinterpret_cast<sockaddr_in6*>(&storage);
+        sa->sin6_family = AF_INET6;
+        sa->sin6_port = htons(port);
+        Q_IPV6ADDR ip6 = address.toIPv6Address();
+        std::memcpy(&sa->sin6_addr, &ip6, sizeof(ip6));
+        length = sizeof(sockaddr_in6);
+    }
+    else
+    {
+        return -1;
+    }
+
+    qint32 fd = ::socket(storage.ss_family, SOCK_STREAM, 0);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    int on = 1;
+    if (::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) < 0 ||
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) < 0 ||
+        ::bind(fd, reinterpret_cast<sockaddr*>(&storage), length) < 0 ||
+        ::listen(fd, ListenBacklog) < 0)
+    {
+        ::close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+#endif
+
+//
+// Hands a listening socket to the server it is posted to, in the thread of
+// the server
+//
+class ListenEvent :
+    public QEvent
+{
+public:
+
+    const qint32 m_socketDescriptor;
+
+    static QEvent::Type eventType()
+    {
+        static const QEvent::Type retVal =
+            static_cast<QEvent::Type>(QEvent::registerEventType());
+        return retVal;
+    }
+
+    explicit ListenEvent(qint32 socketDescriptor) :
+        QEvent(eventType()), m_socketDescriptor(socketDescriptor)
+    {
+    }
+};
+}
+
+/*******************************************************************************
+ * HHttpServerWorker
+ ******************************************************************************/
+HHttpServerWorker::HHttpServerWorker(
+    const QByteArray& loggingIdentifier, QThread* ownerThread,
+    QThread* workerThread) :
+        QObject(),
+            m_loggingIdentifier(loggingIdentifier),
+            m_httpHandler(new HHttpAsyncHandler(m_loggingIdentifier, this)),
+            m_ownerThread(ownerThread)
+{
+    bool ok = connect(
+        m_httpHandler, SIGNAL(msgIoComplete(HHttpAsyncOperation*)),
+        this, SLOT(msgIoComplete(HHttpAsyncOperation*)));
+
+    Q_ASSERT(ok); Q_UNUSED(ok)
+
+    // finished() is emitted from the worker thread and the connection is direct
+    // so that the sockets can be cleaned up in the thread they belong to
+    ok = connect(
+        workerThread, SIGNAL(finished()),
+        this, SLOT(threadFinished()), Qt::DirectConnection);
+
+    Q_ASSERT(ok);
+
+    moveToThread(workerThread);
+}
+
+HHttpServerWorker::~HHttpServerWorker()
+{
+}
+
+void HHttpServerWorker::threadFinished()
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    delete m_httpHandler;
+    m_httpHandler = 0;
+
+    qDeleteAll(findChildren<QTcpSocket*>());
+
+    // the listening sockets owned by the worker
+    qDeleteAll(findChildren<QTcpServer*>());
+}
+
+void HHttpServerWorker::msgIoComplete(HHttpAsyncOperation* op)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    if (op->state() == HHttpAsyncOperation::Failed)
+    {
+        HLOG_DBG(QString("HTTP failure: [%1]").arg(
+            op->messagingInfo()->lastErrorDescription()));
+
+        op->deleteLater();
+        return;
+    }
+
+    Q_ASSERT(op->opType() == HHttpAsyncOperation::ReceiveRequest);
+
+    // the operation is still on the call stack at this point
+    QMetaObject::invokeMethod(
+        this, "handOff", Qt::QueuedConnection,
+        Q_ARG(Herqq::Upnp::HHttpAsyncOperation*, op));
+}
+
+void HHttpServerWorker::handOff(HHttpAsyncOperation* op)
+{
+    QTcpSocket& socket = op->messagingInfo()->socket();
+    socket.setParent(0);
+    socket.moveToThread(m_ownerThread);
+
+    op->setParent(0);
+    op->moveToThread(m_ownerThread);
+
+    emit requestReceived(op);
+}
+
+void HHttpServerWorker::continueConnection(HMessagingInfo* mi)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    mi->socket().setParent(this);
+    if (!m_httpHandler->receive(mi, true))
+    {
+        HLOG_WARN(QString(
+            "Failed to read data from: [%1]. Disconnecting.").arg(
+                peerAsStr(mi->socket())));
+    }
+}
+
 /*******************************************************************************
  * HHttpServer::Server
  ******************************************************************************/
-HHttpServer::Server::Server(HHttpServer* owner) :
-    QTcpServer(owner), m_owner(owner)
+HHttpServer::Server::Server(HHttpServer* owner, HHttpServerWorker* worker) :
+    QTcpServer(worker ? static_cast<QObject*>(worker) : owner),
+        m_owner(owner), m_worker(worker), m_openConnections(0),
+        m_acceptPaused(false), m_retired(false), m_primary(0)
+{
+}
+
+QEvent::Type HHttpServer::Server::resumeEventType()
 {
+    static const QEvent::Type retVal =
+        static_cast<QEvent::Type>(QEvent::registerEventType());
+    return retVal;
+}
+
+QEvent::Type HHttpServer::Server::retireEventType()
+{
+    static const QEvent::Type retVal =
+        static_cast<QEvent::Type>(QEvent::registerEventType());
+    return retVal;
 }
 
 void HHttpServer::Server::incomingConnection(qint32 socketDescriptor)
 {
-    m_owner->processRequest(socketDescriptor);
+    m_owner->processRequest(socketDescriptor, this);
+}
+
+bool HHttpServer::Server::event(QEvent* e)
+{
+    if (e->type() == resumeEventType())
+    {
+        m_owner->resumeAccepting(this);
+        return true;
+    }
+    else if (e->type() == retireEventType())
+    {
+        m_owner->retire(this);
+        return true;
+    }
+    else if (e->type() == ListenEvent::eventType())
+    {
+        HLOG2(H_AT, H_FUN, m_owner->m_loggingIdentifier);
+
+        // the socket notifiers of the server have to be created in the
+        // thread of the server
+        qint32 socketDescriptor =
+            static_cast<ListenEvent*>(e)->m_socketDescriptor;
+
+        if (!setSocketDescriptor(socketDescriptor))
+        {
+            HLOG_WARN(QString("Failed to listen to a shared socket: %1").arg(
+                errorString()));
+#ifdef HUPNP_USE_REUSEPORT
+            ::close(socketDescriptor);
+#endif
+        }
+        return true;
+    }
+
+    return QTcpServer::event(e);
 }
 
+/*******************************************************************************
+ * HHttpServer::ParkedConnection
+ ******************************************************************************/
+class HHttpServer::ParkedConnection :
+    public HTimerWheelEntry
+{
+H_DISABLE_COPY(ParkedConnection)
+
+private:
+
+    HHttpServer* m_owner;
+
+protected:
+
+    virtual void timerExpired()
+    {
+        m_owner->parkedConnectionExpired(this);
+    }
+
+public:
+
+    const qint32 m_socketDescriptor;
+    const Connection m_connection;
+
+    ParkedConnection(
+        HHttpServer* owner, qint32 socketDescriptor,
+        const Connection& connection) :
+            m_owner(owner), m_socketDescriptor(socketDescriptor),
+            m_connection(connection)
+    {
+    }
+};
+
 /*******************************************************************************
  * HHttpServer
  ******************************************************************************/
 HHttpServer::HHttpServer(const QByteArray& loggingIdentifier, QObject* parent) :
     QObject(parent),
         m_servers(),
+        m_connectionsMutex(),
+        m_connections(),
+        m_peerConnections(),
+        m_statistics(),
+        m_maxConnectionsPerEndpoint(0),
+        m_maxConnectionsPerPeer(0),
+        m_maxQueuedWriteBytes(0),
+        m_idlePoller(0),
+        m_parkingWheel(0),
+        m_parkedConnections(),
+        m_listenersPerEndpoint(1),
+        m_openListeners(1),
+        m_listeners(),
+        m_workerThreads(),
+        m_workers(),
+        m_workerThreadCount(0),
+        m_nextWorker(0),
         m_loggingIdentifier(loggingIdentifier),
         m_httpHandler(new HHttpAsyncHandler(m_loggingIdentifier, this)),
         m_chunkedInfo(),
-        m_maxBytesToLoad(1024*1024*5) // TODO make this configurable
+        m_maxBytesToLoad(1024*1024*5),
+        m_bodySink(0),
+        m_stallWatchdog(new HStallWatchdog(m_loggingIdentifier, this))
 {
     bool ok = connect(
         m_httpHandler, SIGNAL(msgIoComplete(HHttpAsyncOperation*)),
         this, SLOT(msgIoComplete(HHttpAsyncOperation*)));
 
     Q_ASSERT(ok); Q_UNUSED(ok)
+
+    if (HSocketPoller::isSupported())
+    {
+        m_idlePoller = new HSocketPoller(this);
+        m_parkingWheel = new HTimerWheel(1000, this);
+
+        ok = connect(
+            m_idlePoller, SIGNAL(readyRead(qint32)),
+            this, SLOT(parkedConnectionReady(qint32)));
+
+        Q_ASSERT(ok);
+    }
 }
 
 HHttpServer::~HHttpServer()
@@ -90,10 +427,36 @@ void HHttpServer::processRequest(HHttpAsyncOperation* op)
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
     HMessagingInfo* mi = op->messagingInfo();
+    HTraceSpan span("http", "handler", mi->requestId());
 
     const HHttpRequestHeader* hdr =
         static_cast<const HHttpRequestHeader*>(op->headerRead());
 
+    if (isRejected(&mi->socket()))
+    {
+        HLOG_WARN(QString(
+            "Too many connections from [%1]. Responding SERVICE_UNAVAILABLE.").arg(
+                peerAsStr(mi->socket())));
+
+        sendServiceUnavailable(op->takeMessagingInfo());
+        return;
+    }
+    else if (m_maxQueuedWriteBytes > 0 &&
+             m_httpHandler->queuedBytes() >= m_maxQueuedWriteBytes)
+    {
+        HLOG_WARN(QString(
+            "Too much data queued for sending. Responding SERVICE_UNAVAILABLE "
+            "to [%1].").arg(peerAsStr(mi->socket())));
+
+        {
+            QMutexLocker locker(&m_connectionsMutex);
+            ++m_statistics.m_rejectedRequests;
+        }
+
+        sendServiceUnavailable(op->takeMessagingInfo());
+        return;
+    }
+
     if (!hdr->isValid())
     {
         m_httpHandler->send(
@@ -117,6 +480,14 @@ void HHttpServer::processRequest(HHttpAsyncOperation* op)
     mi->setKeepAlive(HHttpUtils::keepAlive(*hdr));
 
     QString method = hdr->method();
+    {
+        QMutexLocker locker(&m_connectionsMutex);
+        ++m_statistics.m_requests[requestKey(method)];
+    }
+
+    QString path = hdr->path();
+    HStallWatchdog::Scope stallScope(m_stallWatchdog, method, path);
+
     if (method.compare("GET", Qt::CaseInsensitive) == 0)
     {
         processGet(op->takeMessagingInfo(), *hdr);
@@ -162,6 +533,11 @@ void HHttpServer::processResponse(HHttpAsyncOperation* op)
     incomingResponse(op);
 }
 
+void HHttpServer::requestReceived(HHttpAsyncOperation* op)
+{
+    msgIoComplete(op);
+}
+
 void HHttpServer::msgIoComplete(HHttpAsyncOperation* op)
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
@@ -182,7 +558,27 @@ void HHttpServer::msgIoComplete(HHttpAsyncOperation* op)
         {
             if (mi->keepAlive() && mi->socket().state() == QTcpSocket::ConnectedState)
             {
-                if (!m_httpHandler->receive(op->takeMessagingInfo(), true))
+                // the next request on the connection is traced as a request
+                // of its own
+                mi->setRequestId(HTraceRecorder::isEnabled() ?
+                    HTraceRecorder::newRequestId() : 0);
+
+                if (!m_workers.isEmpty())
+                {
+                    // the connection is handed back to a worker thread, which
+                    // receives the next request
+                    HHttpServerWorker* worker = nextWorker();
+
+                    mi->socket().setParent(0);
+                    mi->socket().moveToThread(worker->thread());
+
+                    QMetaObject::invokeMethod(
+                        worker, "continueConnection", Qt::QueuedConnection,
+                        Q_ARG(Herqq::Upnp::HMessagingInfo*,
+                              op->takeMessagingInfo()));
+                }
+                else if (!parkConnection(mi) &&
+                         !m_httpHandler->receive(op->takeMessagingInfo(), true))
                 {
                     HLOG_WARN(QString(
                         "Failed to read data from: [%1]. Disconnecting.").arg(
@@ -206,26 +602,368 @@ void HHttpServer::msgIoComplete(HHttpAsyncOperation* op)
     }
 }
 
-void HHttpServer::processRequest(qint32 socketDescriptor)
+void HHttpServer::processRequest(qint32 socketDescriptor, Server* server)
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
-    QTcpSocket* client = new QTcpSocket(this);
+    HTraceSpan span("http", "accept",
+        HTraceRecorder::isEnabled() ? HTraceRecorder::newRequestId() : 0);
+
+    // a connection accepted by a listening socket of a worker is received
+    // by that worker without a handoff between the threads
+    HHttpServerWorker* owner = server->m_worker;
+
+    QTcpSocket* client = new QTcpSocket(
+        owner ? static_cast<QObject*>(owner) : this);
     client->setSocketDescriptor(socketDescriptor);
 
     QString peer = peerAsStr(*client);
     HLOG_DBG(QString("Incoming connection from [%1]").arg(peer));
 
+    if (!admitConnection(client, server))
+    {
+        // the request is read before it is answered with 503, since closing
+        // a socket with unread data may cause the client to lose the response
+        HLOG_DBG(QString(
+            "Connection from [%1] exceeds the limit of connections per "
+            "peer.").arg(peer));
+    }
+
+    HMessagingInfo* mi = createMessagingInfo(client, span.requestId());
+
+    if (owner)
+    {
+        owner->continueConnection(mi);
+    }
+    else if (!m_workers.isEmpty())
+    {
+        HHttpServerWorker* worker = nextWorker();
+
+        client->setParent(0);
+        client->moveToThread(worker->thread());
+
+        QMetaObject::invokeMethod(
+            worker, "continueConnection", Qt::QueuedConnection,
+            Q_ARG(Herqq::Upnp::HMessagingInfo*, mi));
+    }
+    else if (!m_httpHandler->receive(mi, true))
+    {
+        HLOG_WARN(QString(
+            "Failed to read data from: [%1]. Disconnecting.").arg(peer));
+    }
+}
+
+HMessagingInfo* HHttpServer::createMessagingInfo(
+    QTcpSocket* client, quint32 requestId)
+{
     HMessagingInfo* mi = new HMessagingInfo(qMakePair(client, true));
     mi->setChunkedInfo(m_chunkedInfo);
     mi->setServerInfo(HSysInfo::instance().herqqProductTokens());
+    mi->setMaxBodySize(m_maxBytesToLoad);
+    mi->setBodySink(m_bodySink);
+    mi->setRequestId(requestId);
+
+    return mi;
+}
+
+bool HHttpServer::parkConnection(HMessagingInfo* mi)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    // the parked connections are served in the thread of the server only.
+    // in addition, a connection that has buffered data of the next request
+    // is served right away, since the socket would lose the data
+    QTcpSocket& socket = mi->socket();
+    if (!m_idlePoller || !m_idlePoller->isValid() || !m_workers.isEmpty() ||
+        socket.bytesAvailable() > 0 || socket.bytesToWrite() > 0)
+    {
+        return false;
+    }
+
+    qint32 socketDescriptor = m_idlePoller->take(&socket);
+    if (socketDescriptor < 0)
+    {
+        return false;
+    }
+
+    // the connection is still open even though the socket is deleted along
+    // with the messaging info, which is why it is kept accounted for
+    disconnect(
+        &socket, SIGNAL(destroyed(QObject*)),
+        this, SLOT(connectionClosed(QObject*)));
+
+    Connection connection;
+    {
+        QMutexLocker locker(&m_connectionsMutex);
+        connection = m_connections.take(&socket);
+    }
+
+    Q_ASSERT(connection.m_server);
+
+    ParkedConnection* parked =
+        new ParkedConnection(this, socketDescriptor, connection);
+
+    m_parkedConnections.insert(socketDescriptor, parked);
+
+    if (m_httpHandler->keepAliveTimeout() > 0)
+    {
+        m_parkingWheel->arm(parked, m_httpHandler->keepAliveTimeout());
+    }
+
+    return true;
+}
+
+void HHttpServer::parkedConnectionReady(qint32 socketDescriptor)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    ParkedConnection* parked = m_parkedConnections.take(socketDescriptor);
+    Q_ASSERT(parked);
+
+    Connection connection = parked->m_connection;
+    delete parked;
+
+    QTcpSocket* client = new QTcpSocket(this);
+    if (!client->setSocketDescriptor(socketDescriptor))
+    {
+        HLOG_WARN(QString(
+            "Failed to resume an idle connection from [%1].").arg(
+                connection.m_peer));
+
+        delete client;
+        m_idlePoller->close(socketDescriptor);
+
+        QMutexLocker locker(&m_connectionsMutex);
+        releaseConnection(connection);
+        return;
+    }
+
+    {
+        QMutexLocker locker(&m_connectionsMutex);
+        m_connections.insert(client, connection);
+    }
+
+    bool ok = connect(
+        client, SIGNAL(destroyed(QObject*)),
+        this, SLOT(connectionClosed(QObject*)), Qt::DirectConnection);
+
+    Q_ASSERT(ok); Q_UNUSED(ok)
+
+    // in case the peer closed the connection, the receive fails and the
+    // connection is closed as usual
+    HMessagingInfo* mi = createMessagingInfo(client,
+        HTraceRecorder::isEnabled() ? HTraceRecorder::newRequestId() : 0);
+
     if (!m_httpHandler->receive(mi, true))
     {
         HLOG_WARN(QString(
-            "Failed to read data from: [%1]. Disconnecting.").arg(peer));
+            "Failed to read data from: [%1]. Disconnecting.").arg(
+                connection.m_peer));
     }
 }
 
+void HHttpServer::parkedConnectionExpired(ParkedConnection* parked)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    m_parkedConnections.remove(parked->m_socketDescriptor);
+    m_idlePoller->close(parked->m_socketDescriptor);
+
+    {
+        QMutexLocker locker(&m_connectionsMutex);
+        releaseConnection(parked->m_connection);
+    }
+
+    delete parked;
+}
+
+void HHttpServer::closeParkedConnections()
+{
+    QMutexLocker locker(&m_connectionsMutex);
+
+    foreach(ParkedConnection* parked, m_parkedConnections)
+    {
+        m_idlePoller->close(parked->m_socketDescriptor);
+        releaseConnection(parked->m_connection);
+        delete parked;
+    }
+
+    m_parkedConnections.clear();
+}
+
+bool HHttpServer::admitConnection(QTcpSocket* socket, Server* server)
+{
+    Connection connection;
+    connection.m_server = server;
+    connection.m_peer = socket->peerAddress().toString();
+
+    QMutexLocker locker(&m_connectionsMutex);
+
+    qint32& peerConnections = m_peerConnections[connection.m_peer];
+    connection.m_rejected =
+        m_maxConnectionsPerPeer > 0 && peerConnections >= m_maxConnectionsPerPeer;
+
+    ++peerConnections;
+    ++server->m_openConnections;
+    ++m_statistics.m_openConnections;
+
+    if (connection.m_rejected)
+    {
+        ++m_statistics.m_rejectedConnections;
+    }
+    else
+    {
+        ++m_statistics.m_acceptedConnections;
+    }
+
+    m_connections.insert(socket, connection);
+
+    qint32 maxConnections = maxConnectionsPerListener();
+    if (maxConnections > 0 &&
+        server->m_openConnections >= maxConnections &&
+        !server->m_acceptPaused)
+    {
+        // the rest of the connections are left to the backlog of the listening
+        // socket, where they wait until a connection is closed. this is run
+        // in the thread of the listening socket
+        HLOG_WARN(QString(
+            "Reached the limit of %1 connections to %2:%3. "
+            "Deferring new connections.").arg(
+                QString::number(maxConnections),
+                server->serverAddress().toString(),
+                QString::number(server->serverPort())));
+
+        server->pauseAccepting();
+        server->m_acceptPaused = true;
+        ++m_statistics.m_deferredAccepts;
+    }
+
+    // the socket may be deleted in a worker thread, which is why the
+    // connection is direct
+    bool ok = connect(
+        socket, SIGNAL(destroyed(QObject*)),
+        this, SLOT(connectionClosed(QObject*)), Qt::DirectConnection);
+
+    Q_ASSERT(ok); Q_UNUSED(ok)
+
+    return !connection.m_rejected;
+}
+
+bool HHttpServer::isRejected(QTcpSocket* socket) const
+{
+    QMutexLocker locker(&m_connectionsMutex);
+    return m_connections.value(socket).m_rejected;
+}
+
+void HHttpServer::connectionClosed(QObject* socket)
+{
+    QMutexLocker locker(&m_connectionsMutex);
+
+    QHash<QObject*, Connection>::iterator it = m_connections.find(socket);
+    if (it == m_connections.end())
+    {
+        return;
+    }
+
+    Connection connection = it.value();
+    m_connections.erase(it);
+
+    releaseConnection(connection);
+}
+
+void HHttpServer::releaseConnection(const Connection& connection)
+{
+    // the connection mutex is locked by the caller
+    Server* server = connection.m_server;
+    --server->m_openConnections;
+    --m_statistics.m_openConnections;
+
+    QHash<QString, qint32>::iterator peerIt =
+        m_peerConnections.find(connection.m_peer);
+
+    if (peerIt != m_peerConnections.end() && --peerIt.value() <= 0)
+    {
+        m_peerConnections.erase(peerIt);
+    }
+
+    if (server->m_retired)
+    {
+        if (!server->m_openConnections)
+        {
+            server->deleteLater();
+        }
+        return;
+    }
+
+    qint32 maxConnections = maxConnectionsPerListener();
+    if (server->m_acceptPaused &&
+        (maxConnections <= 0 || server->m_openConnections < maxConnections))
+    {
+        // this may be called from any thread and the listening socket
+        // has to be resumed in the thread of the listening socket
+        QCoreApplication::postEvent(
+            server, new QEvent(Server::resumeEventType()));
+    }
+}
+
+void HHttpServer::resumeAccepting(Server* server)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    QMutexLocker locker(&m_connectionsMutex);
+
+    qint32 maxConnections = maxConnectionsPerListener();
+    if (server->m_acceptPaused &&
+        (maxConnections <= 0 || server->m_openConnections < maxConnections))
+    {
+        HLOG_DBG(QString("Resuming to accept connections to %1:%2").arg(
+            server->serverAddress().toString(),
+            QString::number(server->serverPort())));
+
+        server->m_acceptPaused = false;
+        server->resumeAccepting();
+    }
+}
+
+void HHttpServer::retire(Server* server)
+{
+    server->close();
+
+    QMutexLocker locker(&m_connectionsMutex);
+
+    server->m_retired = true;
+    if (!server->m_openConnections)
+    {
+        server->deleteLater();
+    }
+}
+
+qint32 HHttpServer::maxConnectionsPerListener() const
+{
+    // the connection mutex is locked by the caller
+    if (m_maxConnectionsPerEndpoint <= 0)
+    {
+        return 0;
+    }
+
+    // rounded up, so that the limits of the sockets add up to at least the
+    // limit of the endpoint
+    return (m_maxConnectionsPerEndpoint + m_openListeners - 1) /
+        m_openListeners;
+}
+
+void HHttpServer::sendServiceUnavailable(HMessagingInfo* mi)
+{
+    mi->setKeepAlive(false);
+
+    HHttpResponseHeader responseHdr =
+        HHttpMessageCreator::createResponseHeader(ServiceUnavailable);
+
+    responseHdr.setValue("RETRY-AFTER", QString::number(retryAfter()));
+
+    m_httpHandler->send(mi, HHttpMessageCreator::setupData(responseHdr, *mi));
+}
+
 void HHttpServer::processNotifyMessage(
     HMessagingInfo* mi, const HHttpRequestHeader& hdr, const QByteArray& body)
 {
@@ -301,9 +1039,12 @@ void HHttpServer::processPost(
         return;
     }
 
-    QtSoapMessage soapMsg;
-    if (!soapMsg.setContent(body))
+    HSoapMessage soapMsg;
+    QString err;
+    if (!soapMsg.parse(body, &err))
     {
+        HLOG_WARN(QString("Invalid SOAP message: [%1]").arg(err));
+
         mi->setKeepAlive(false);
         m_httpHandler->send(mi, HHttpMessageCreator::createResponse(BadRequest, *mi));
         return;
@@ -317,7 +1058,11 @@ void HHttpServer::processPost(
         return;
     }
 
-    HInvokeActionRequest iareq(soapAction, soapMsg, controlUrl);
+    HInvokeActionRequest iareq(
+        soapAction, soapMsg, controlUrl,
+        HHttpUtils::acceptsGzip(
+            requestHdr.rawValue(HHttpHeader::Field_AcceptEncoding)));
+
     HLOG_DBG("Dispatching control request.");
     incomingControlRequest(mi, iareq);
 }
@@ -404,10 +1149,79 @@ void HHttpServer::processUnsubscription(
     incomingUnsubscriptionRequest(mi, usreq);
 }
 
+void HHttpServer::startWorkers()
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    for (qint32 i = 0; i < m_workerThreadCount; ++i)
+    {
+        QThread* workerThread = new QThread(this);
+
+        HHttpServerWorker* worker =
+            new HHttpServerWorker(m_loggingIdentifier, thread(), workerThread);
+
+        bool ok = connect(
+            worker, SIGNAL(requestReceived(Herqq::Upnp::HHttpAsyncOperation*)),
+            this, SLOT(requestReceived(Herqq::Upnp::HHttpAsyncOperation*)));
+
+        Q_ASSERT(ok); Q_UNUSED(ok)
+
+        m_workerThreads.append(workerThread);
+        m_workers.append(worker);
+
+        workerThread->start();
+    }
+
+    HLOG_INFO(QString("HTTP server using %1 worker threads").arg(
+        QString::number(m_workerThreadCount)));
+}
+
+void HHttpServer::stopWorkers()
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    foreach(QThread* workerThread, m_workerThreads)
+    {
+        workerThread->quit();
+    }
+
+    foreach(QThread* workerThread, m_workerThreads)
+    {
+        workerThread->wait();
+    }
+
+    qDeleteAll(m_workers);
+    m_workers.clear();
+
+    qDeleteAll(m_workerThreads);
+    m_workerThreads.clear();
+
+    // the listening sockets of the workers were deleted by the workers
+    m_listeners.clear();
+
+    QMutexLocker locker(&m_connectionsMutex);
+    m_openListeners = 1;
+}
+
+HHttpServerWorker* HHttpServer::nextWorker()
+{
+    Q_ASSERT(!m_workers.isEmpty());
+
+    HHttpServerWorker* retVal = m_workers[m_nextWorker];
+    m_nextWorker = (m_nextWorker + 1) % m_workers.size();
+
+    return retVal;
+}
+
 bool HHttpServer::setupIface(const HEndpoint& ep)
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
+    if (m_workerThreadCount > 0 && m_workers.isEmpty())
+    {
+        startWorkers();
+    }
+
     QHostAddress ha = ep.hostAddress();
     if (ha == QHostAddress::Null || ha == QHostAddress::Any ||
         ha == QHostAddress::Broadcast)
@@ -416,7 +1230,7 @@ bool HHttpServer::setupIface(const HEndpoint& ep)
     }
 
     QScopedPointer<Server> server(new Server(this));
-    bool b = server->listen(ha, ep.portNumber());
+    bool b = setupListeners(server.data(), ep);
     if (b)
     {
         HLOG_INFO(QString("HTTP server bound to %1:%2").arg(
@@ -434,6 +1248,80 @@ bool HHttpServer::setupIface(const HEndpoint& ep)
     return b;
 }
 
+bool HHttpServer::setupListeners(Server* primary, const HEndpoint& ep)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    qint32 count = qMin(m_listenersPerEndpoint, m_workers.size() + 1);
+    if (count <= 1)
+    {
+        return primary->listen(ep.hostAddress(), ep.portNumber());
+    }
+
+#ifdef HUPNP_USE_REUSEPORT
+    qint32 primaryFd = openSharedListener(ep.hostAddress(), ep.portNumber());
+    if (primaryFd < 0 || !primary->setSocketDescriptor(primaryFd))
+    {
+        HLOG_WARN(QString(
+            "Failed to open a shared listening socket to %1:%2. Using a "
+            "single listening socket.").arg(
+                ep.hostAddress().toString(),
+                QString::number(ep.portNumber())));
+
+        if (primaryFd >= 0)
+        {
+            ::close(primaryFd);
+        }
+
+        return primary->listen(ep.hostAddress(), ep.portNumber());
+    }
+
+    // the port is known once the primary socket is bound, in case it was
+    // left to the system to choose
+    quint16 port = primary->serverPort();
+
+    qint32 opened = 1;
+    for (qint32 i = 1; i < count; ++i)
+    {
+        qint32 fd = openSharedListener(ep.hostAddress(), port);
+        if (fd < 0)
+        {
+            HLOG_WARN(QString(
+                "Failed to open listening socket %1 of %2 to %3:%4").arg(
+                    QString::number(i + 1), QString::number(count),
+                    ep.hostAddress().toString(), QString::number(port)));
+            continue;
+        }
+
+        HHttpServerWorker* worker = m_workers[(i - 1) % m_workers.size()];
+
+        Server* listener = new Server(this, worker);
+        listener->m_primary = primary;
+        listener->moveToThread(worker->thread());
+        QCoreApplication::postEvent(listener, new ListenEvent(fd));
+
+        m_listeners.append(listener);
+        ++opened;
+    }
+
+    {
+        QMutexLocker locker(&m_connectionsMutex);
+        m_openListeners = qMax(m_openListeners, opened);
+    }
+
+    HLOG_INFO(QString("HTTP server using %1 listening sockets on %2:%3").arg(
+        QString::number(opened), ep.hostAddress().toString(),
+        QString::number(port)));
+
+    return true;
+#else
+    HLOG_WARN(QString(
+        "SO_REUSEPORT is not supported. Using a single listening socket."));
+
+    return primary->listen(ep.hostAddress(), ep.portNumber());
+#endif
+}
+
 void HHttpServer::incomingSubscriptionRequest(
     HMessagingInfo* mi, const HSubscribeRequest&)
 {
@@ -597,6 +1485,15 @@ bool HHttpServer::init(const QList<HEndpoint>& eps)
         {
             qDeleteAll(m_servers);
             m_servers.clear();
+
+            // the listening sockets of the workers are deleted in their
+            // threads
+            foreach(Server* listener, m_listeners)
+            {
+                listener->deleteLater();
+            }
+            m_listeners.clear();
+
             return false;
         }
     }
@@ -609,6 +1506,78 @@ bool HHttpServer::isInitialized() const
     return m_servers.size();
 }
 
+bool HHttpServer::addEndpoint(const HEndpoint& ep)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+    Q_ASSERT(thread() == QThread::currentThread());
+
+    if (!isInitialized())
+    {
+        return false;
+    }
+
+    foreach(const Server* server, m_servers)
+    {
+        if (server->serverAddress() == ep.hostAddress())
+        {
+            return false;
+        }
+    }
+
+    return setupIface(ep);
+}
+
+bool HHttpServer::removeEndpoint(const QHostAddress& ha)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+    Q_ASSERT(thread() == QThread::currentThread());
+
+    if (m_servers.size() <= 1)
+    {
+        return false;
+    }
+
+    Server* primary = 0;
+    for (qint32 i = 0; i < m_servers.size(); ++i)
+    {
+        if (m_servers[i]->serverAddress() == ha)
+        {
+            primary = m_servers.takeAt(i);
+            break;
+        }
+    }
+
+    if (!primary)
+    {
+        return false;
+    }
+
+    HLOG_INFO(QString("HTTP server unbound from %1:%2").arg(
+        ha.toString(), QString::number(primary->serverPort())));
+
+    // the additional listening sockets are closed in the threads of the
+    // workers. the connections accepted by them keep them alive until
+    // the connections are closed
+    QList<Server*>::iterator it = m_listeners.begin();
+    while (it != m_listeners.end())
+    {
+        if ((*it)->m_primary == primary)
+        {
+            QCoreApplication::postEvent(
+                *it, new QEvent(Server::retireEventType()));
+
+            it = m_listeners.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    retire(primary);
+    return true;
+}
+
 void HHttpServer::close()
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
@@ -625,6 +1594,20 @@ void HHttpServer::close()
             server->close();
         }
     }
+
+    // a parked connection may refer to a listening socket of a worker,
+    // which is deleted along with the worker
+    closeParkedConnections();
+    stopWorkers();
+
+    Statistics stats = statistics();
+    HLOG_DBG(QString(
+        "Connections accepted: %1, rejected: %2. Requests rejected: %3. "
+        "Accepting deferred %4 times.").arg(
+            QString::number(stats.m_acceptedConnections),
+            QString::number(stats.m_rejectedConnections),
+            QString::number(stats.m_rejectedRequests),
+            QString::number(stats.m_deferredAccepts)));
 }
 
 qint32 HHttpServer::maxBytesToLoad() const
@@ -632,5 +1615,67 @@ qint32 HHttpServer::maxBytesToLoad() const
     return m_maxBytesToLoad;
 }
 
+void HHttpServer::setMaxBytesToLoad(qint32 maxBytes)
+{
+    m_maxBytesToLoad = qMax(0, maxBytes);
+}
+
+void HHttpServer::setBodySink(HHttpBodySink* sink)
+{
+    Q_ASSERT_X(
+        !isInitialized(), H_AT,
+            "The body sink has to be set before the server is initialized.");
+
+    m_bodySink = sink;
+}
+
+void HHttpServer::setWorkerThreadCount(qint32 count)
+{
+    Q_ASSERT_X(
+        !isInitialized(), H_AT,
+            "The worker thread count has to be set before the server is "
+            "initialized.");
+
+    m_workerThreadCount = qMax(0, count);
+}
+
+void HHttpServer::setListenersPerEndpoint(qint32 count)
+{
+    Q_ASSERT_X(
+        !isInitialized(), H_AT,
+            "The listener count has to be set before the server is "
+            "initialized.");
+
+    m_listenersPerEndpoint = qMax(1, count);
+}
+
+void HHttpServer::setMaxConnectionsPerEndpoint(qint32 maxConnections)
+{
+    QMutexLocker locker(&m_connectionsMutex);
+    m_maxConnectionsPerEndpoint = qMax(0, maxConnections);
+}
+
+void HHttpServer::setMaxConnectionsPerPeer(qint32 maxConnections)
+{
+    QMutexLocker locker(&m_connectionsMutex);
+    m_maxConnectionsPerPeer = qMax(0, maxConnections);
+}
+
+void HHttpServer::setMaxQueuedWriteBytes(qint64 maxBytes)
+{
+    m_maxQueuedWriteBytes = qMax(Q_INT64_C(0), maxBytes);
+}
+
+void HHttpServer::setStallThreshold(qint32 msecs)
+{
+    m_stallWatchdog->setThreshold(qMax(0, msecs));
+}
+
+HHttpServer::Statistics HHttpServer::statistics() const
+{
+    QMutexLocker locker(&m_connectionsMutex);
+    return m_statistics;
+}
+
 }
 }
@@ -34,9 +34,13 @@
 #include <HUpnpCore/private/hhttp_asynchandler_p.h>
 #include <HUpnpCore/private/hhttp_messaginginfo_p.h>
 
+#include <QtCore/QHash>
+#include <QtCore/QEvent>
+#include <QtCore/QMutex>
 #include <QtNetwork/QTcpServer>
 
 class QUrl;
+class QThread;
 class QString;
 class QTcpSocket;
 
@@ -46,11 +50,64 @@ namespace Herqq
 namespace Upnp
 {
 
+class HTimerWheel;
+class HSocketPoller;
+class HStallWatchdog;
 class HNotifyRequest;
 class HSubscribeRequest;
 class HUnsubscribeRequest;
 class HInvokeActionRequest;
 
+//
+// Receives HTTP requests on a thread of its own, which runs an event loop
+// and an HHttpAsyncHandler of its own.
+//
+// The handoff to the owning HHttpServer goes as follows:
+// - the server accepts a connection, moves the socket to a worker thread and
+//   invokes continueConnection()
+// - once a request is fully received, the operation and its socket are moved
+//   to the thread of the server and requestReceived() is emitted. The request
+//   is dispatched and answered in that thread, which means the virtual
+//   incoming*() methods of HHttpServer are never called from a worker thread.
+// - if the connection is kept alive, the server moves the socket back to
+//   a worker thread and invokes continueConnection().
+//
+// A worker may also own listening sockets of its own, in which case the
+// connections accepted by them are received in the worker directly.
+//
+class HHttpServerWorker :
+    public QObject
+{
+Q_OBJECT
+H_DISABLE_COPY(HHttpServerWorker)
+friend class HHttpServer;
+
+private:
+
+    const QByteArray m_loggingIdentifier;
+    HHttpAsyncHandler* m_httpHandler;
+    QThread* m_ownerThread;
+
+private Q_SLOTS:
+
+    void msgIoComplete(HHttpAsyncOperation* op);
+    void handOff(Herqq::Upnp::HHttpAsyncOperation* op);
+    void continueConnection(Herqq::Upnp::HMessagingInfo* mi);
+    void threadFinished();
+
+Q_SIGNALS:
+
+    void requestReceived(Herqq::Upnp::HHttpAsyncOperation* op);
+
+public:
+
+    HHttpServerWorker(
+        const QByteArray& loggingIdentifier, QThread* ownerThread,
+        QThread* workerThread);
+
+    virtual ~HHttpServerWorker();
+};
+
 //
 // Private class for handling HTTP server duties needed in UPnP messaging
 //
@@ -73,32 +130,187 @@ private:
 
     protected:
         virtual void incomingConnection(qint32 socketDescriptor);
+        virtual bool event(QEvent*);
 
     public:
-        Server(HHttpServer* owner);
+        // the primary listening socket of an endpoint lives in the thread of
+        // the owner, while the additional ones are owned by worker threads
+        Server(HHttpServer* owner, HHttpServerWorker* worker = 0);
+
+        HHttpServerWorker* const m_worker;
+        // the worker that receives the connections accepted by this
+        // server, or null if they are accepted in the thread of the owner
+
+        // the number of open connections accepted by this server and whether
+        // accepting new connections has been paused due to the limit.
+        // these are guarded by the connection mutex of the owner.
+        qint32 m_openConnections;
+        bool m_acceptPaused;
+
+        bool m_retired;
+        // whether the endpoint of the server has been removed. a retired
+        // server no longer listens and it is deleted once the last of its
+        // connections is closed. guarded by the connection mutex.
+
+        Server* m_primary;
+        // the primary listening socket of the endpoint, or null if this is
+        // the primary listening socket
+
+        // posted to the server to resume accepting in the thread of the
+        // server
+        static QEvent::Type resumeEventType();
+
+        // posted to the server to retire it in the thread of the server
+        static QEvent::Type retireEventType();
+    };
+
+    // an open connection the server keeps track of
+    struct Connection
+    {
+        Server* m_server;
+        QString m_peer;
+        bool m_rejected;
+
+        Connection() : m_server(0), m_peer(), m_rejected(false) {}
+    };
+
+    // an idle keep-alive connection that is watched by the socket poller
+    // instead of a socket of its own until the next request arrives
+    class ParkedConnection;
+    friend class ParkedConnection;
+
+public:
+
+    //
+    // The counters of the admission control
+    //
+    struct Statistics
+    {
+        qint64 m_acceptedConnections;
+        // the number of connections accepted
+
+        qint64 m_rejectedConnections;
+        // the number of connections answered with 503 because the peer
+        // had too many connections open
+
+        qint64 m_rejectedRequests;
+        // the number of requests answered with 503 because too much data was
+        // waiting to be written
+
+        qint64 m_deferredAccepts;
+        // the number of times accepting new connections was paused because
+        // an endpoint had too many connections open
+
+        qint32 m_openConnections;
+        // the number of connections currently open
+
+        QHash<QString, qint64> m_requests;
+        // the number of requests received by method. the methods the server
+        // does not serve are counted under an empty string
+
+        Statistics() :
+            m_acceptedConnections(0), m_rejectedConnections(0),
+            m_rejectedRequests(0), m_deferredAccepts(0), m_openConnections(0),
+            m_requests()
+        {
+        }
     };
 
 private Q_SLOTS:
 
     void msgIoComplete(HHttpAsyncOperation* op);
+    void requestReceived(Herqq::Upnp::HHttpAsyncOperation* op);
+    void connectionClosed(QObject* socket);
+    void parkedConnectionReady(qint32 socketDescriptor);
 
 private:
 
     QList<Server*> m_servers;
 
+    mutable QMutex m_connectionsMutex;
+    QHash<QObject*, Connection> m_connections;
+    QHash<QString, qint32> m_peerConnections;
+    Statistics m_statistics;
+
+    qint32 m_maxConnectionsPerEndpoint;
+    qint32 m_maxConnectionsPerPeer;
+    qint64 m_maxQueuedWriteBytes;
+
+    // how many seconds a client is asked to wait before retrying a request
+    // answered with 503
+    static inline qint32 retryAfter()
+    {
+        const qint32 retVal = 2;
+        return retVal;
+    }
+
+    HSocketPoller* m_idlePoller;
+    // null when the platform has no native poller
+    HTimerWheel* m_parkingWheel;
+    QHash<qint32, ParkedConnection*> m_parkedConnections;
+
+    // watches an idle keep-alive connection using the socket poller.
+    // returns false in case the connection cannot be parked, in which case
+    // the messaging info is left intact
+    bool parkConnection(HMessagingInfo*);
+    void parkedConnectionExpired(ParkedConnection*);
+    void closeParkedConnections();
+
+    bool admitConnection(QTcpSocket*, Server*);
+    void releaseConnection(const Connection&);
+    void resumeAccepting(Server*);
+
+    // stops the server from listening and deletes it once its connections
+    // are closed. this is run in the thread of the server
+    void retire(Server*);
+
+    qint32 m_listenersPerEndpoint;
+    // the number of listening sockets requested for each endpoint
+
+    qint32 m_openListeners;
+    // the number of listening sockets opened for each endpoint. the limit
+    // of connections per endpoint is divided between them
+
+    QList<Server*> m_listeners;
+    // the additional listening sockets, which are owned by the workers
+
+    // returns the maximum number of connections open to a single
+    // listening socket, or zero if the number is not limited
+    qint32 maxConnectionsPerListener() const;
+
+    // opens the primary listening socket of the endpoint and the additional
+    // listening sockets in the worker threads
+    bool setupListeners(Server* primary, const HEndpoint&);
+    bool isRejected(QTcpSocket*) const;
+    void sendServiceUnavailable(HMessagingInfo*);
+
+    QList<QThread*> m_workerThreads;
+    QList<HHttpServerWorker*> m_workers;
+    qint32 m_workerThreadCount;
+    qint32 m_nextWorker;
+
+    void startWorkers();
+    void stopWorkers();
+    HHttpServerWorker* nextWorker();
+
 protected:
 
     const QByteArray m_loggingIdentifier;
     HHttpAsyncHandler* m_httpHandler;
     HChunkedInfo m_chunkedInfo;
     qint32 m_maxBytesToLoad;
+    HHttpBodySink* m_bodySink;
+
+    HStallWatchdog* m_stallWatchdog;
+    // times the dispatch of the requests in the thread of the server
 
 private:
 
     void processRequest(HHttpAsyncOperation*);
     void processResponse(HHttpAsyncOperation*);
 
-    void processRequest(qint32 socketDescriptor);
+    void processRequest(qint32 socketDescriptor, Server*);
+    HMessagingInfo* createMessagingInfo(QTcpSocket*, quint32 requestId);
 
     void processNotifyMessage(
         HMessagingInfo*, const HHttpRequestHeader&, const QByteArray& body);
@@ -163,7 +375,109 @@ public:
     bool isInitialized() const;
     void close();
 
+    // starts to listen to another endpoint once the server is initialized.
+    // returns false in case the address is already listened to or it
+    // cannot be bound
+    bool addEndpoint(const HEndpoint&);
+
+    // stops listening to the specified address. the connections accepted
+    // through it are served until they are closed. the last endpoint of
+    // the server cannot be removed
+    bool removeEndpoint(const QHostAddress&);
+
     qint32 maxBytesToLoad() const;
+
+    //
+    // Sets the maximum size of a request body that is buffered in memory.
+    // Requests with larger bodies are rejected, unless the body is passed to
+    // the body sink. The default is 5 MB. Zero means no limit.
+    // This affects the connections accepted after the call.
+    //
+    void setMaxBytesToLoad(qint32 maxBytes);
+
+    //
+    // Sets the sink that is offered the body of each request before it is
+    // buffered. The sink is not owned and it has to outlive the server.
+    // When worker threads are used, the sink is called from these threads.
+    // This has to be called before the server is initialized.
+    //
+    void setBodySink(HHttpBodySink*);
+
+    inline HHttpBodySink* bodySink() const { return m_bodySink; }
+
+    //
+    // Sets the number of worker threads that receive the HTTP requests.
+    // The default is zero, in which case everything is done in the thread of
+    // this instance. This has to be called before the server is initialized.
+    //
+    void setWorkerThreadCount(qint32 count);
+
+    inline qint32 workerThreadCount() const { return m_workerThreadCount; }
+
+    //
+    // Sets the number of listening sockets opened for each endpoint.
+    // The first socket accepts connections in the thread of this instance,
+    // the others are spread over the worker threads, which accept the
+    // connections themselves. The sockets share the port with SO_REUSEPORT,
+    // which makes the operating system balance the incoming connections
+    // between them. The default is 1. More than one socket is opened only if
+    // worker threads are used and the platform supports SO_REUSEPORT.
+    // This has to be called before the server is initialized.
+    //
+    void setListenersPerEndpoint(qint32 count);
+
+    inline qint32 listenersPerEndpoint() const
+    {
+        return m_listenersPerEndpoint;
+    }
+
+    //
+    // Sets the maximum number of connections open to a single endpoint.
+    // Once the limit is reached, new connections are left waiting in the
+    // backlog of the listening socket until a connection is closed.
+    // When an endpoint has several listening sockets, each of them gets an
+    // equal share of the limit. Zero means no limit, which is the default.
+    //
+    void setMaxConnectionsPerEndpoint(qint32 maxConnections);
+
+    //
+    // Sets the maximum number of connections a single peer can have open.
+    // Requests received over the connections exceeding the limit are answered
+    // with 503 and the connections are closed. Zero means no limit, which is
+    // the default.
+    //
+    void setMaxConnectionsPerPeer(qint32 maxConnections);
+
+    //
+    // Sets the maximum number of bytes waiting to be written, after which
+    // requests are answered with 503 until the queued data has been written.
+    // Zero means no limit, which is the default.
+    //
+    void setMaxQueuedWriteBytes(qint64 maxBytes);
+
+    inline qint32 maxConnectionsPerEndpoint() const
+    {
+        return m_maxConnectionsPerEndpoint;
+    }
+
+    inline qint32 maxConnectionsPerPeer() const
+    {
+        return m_maxConnectionsPerPeer;
+    }
+
+    inline qint64 maxQueuedWriteBytes() const { return m_maxQueuedWriteBytes; }
+
+    //
+    // Sets the time in msecs after which a request handler is considered
+    // to have stalled the thread of the server. The stalls are recorded by the
+    // method and the path of the request. Zero disables the detection, which
+    // is the default.
+    //
+    void setStallThreshold(qint32 msecs);
+
+    inline HStallWatchdog* stallWatchdog() const { return m_stallWatchdog; }
+
+    Statistics statistics() const;
 };
 
 }
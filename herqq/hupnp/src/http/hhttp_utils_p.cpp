@@ -23,6 +23,7 @@
 
 #include <QtCore/QUrl>
 #include <QtCore/QList>
+#include <QtCore/QDateTime>
 #include <QtCore/QByteArray>
 #include <QtNetwork/QTcpSocket>
 
@@ -32,6 +33,101 @@ namespace Herqq
 namespace Upnp
 {
 
+namespace
+{
+const char* const HttpDays[] =
+    { "Mon", "Tue", "Wed", "Thu", "Fri", "Sat", "Sun" };
+
+const char* const HttpMonths[] =
+    { "Jan", "Feb", "Mar", "Apr", "May", "Jun",
+      "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+
+//
+// Reads an unsigned decimal number of minDigits to maxDigits digits and
+// advances the specified position past it.
+//
+bool readNumber(
+    const char*& pos, const char* end, qint32 minDigits, qint32 maxDigits,
+    qint32* value)
+{
+    qint32 retVal = 0, digits = 0;
+    for(; pos < end && digits < maxDigits; ++pos, ++digits)
+    {
+        if (*pos < '0' || *pos > '9')
+        {
+            break;
+        }
+        retVal = retVal * 10 + (*pos - '0');
+    }
+
+    if (digits < minDigits)
+    {
+        return false;
+    }
+
+    *value = retVal;
+    return true;
+}
+
+inline bool readChar(const char*& pos, const char* end, char c)
+{
+    if (pos < end && *pos == c)
+    {
+        ++pos;
+        return true;
+    }
+    return false;
+}
+
+//
+// The table used in computing the CRC-32 a gzip member ends with
+//
+class HCrc32Table
+{
+private:
+
+    quint32 m_table[256];
+
+public:
+
+    HCrc32Table()
+    {
+        for (quint32 i = 0; i < 256; ++i)
+        {
+            quint32 c = i;
+            for (qint32 k = 0; k < 8; ++k)
+            {
+                c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            }
+            m_table[i] = c;
+        }
+    }
+
+    quint32 crc32(const QByteArray& data) const
+    {
+        quint32 c = 0xffffffffu;
+
+        const uchar* p = reinterpret_cast<const uchar*>(data.constData());
+        for (qint32 i = 0; i < data.size(); ++i)
+        {
+            c = m_table[(c ^ p[i]) & 0xff] ^ (c >> 8);
+        }
+
+        return c ^ 0xffffffffu;
+    }
+};
+
+const HCrc32Table s_crc32Table;
+
+void appendLittleEndian(QByteArray& target, quint32 value)
+{
+    target.append(static_cast<char>(value & 0xff));
+    target.append(static_cast<char>((value >> 8) & 0xff));
+    target.append(static_cast<char>((value >> 16) & 0xff));
+    target.append(static_cast<char>((value >> 24) & 0xff));
+}
+}
+
 QString HHttpUtils::callbackAsStr(const QList<QUrl>& callbacks)
 {
     QString retVal;
@@ -44,38 +140,190 @@ QString HHttpUtils::callbackAsStr(const QList<QUrl>& callbacks)
     return retVal;
 }
 
-bool HHttpUtils::readLines(
-    QTcpSocket& socket, QByteArray& target, qint32 lineCount)
+bool HHttpUtils::readHeader(
+    QTcpSocket& socket, QByteArray& target, qint32 maxSize)
 {
-    char readChar = 0;
-    qint32 linesRead = 0;
+    char buf[2048];
+    for(;;)
+    {
+        qint32 oldSize = target.size();
+
+        // the limit is checked before anything is appended, so that a peer
+        // cannot grow the target past it with data it has already sent
+        qint64 room = sizeof(buf);
+        if (maxSize > 0)
+        {
+            room = qMin(room, static_cast<qint64>(maxSize) + 1 - oldSize);
+            if (room <= 0)
+            {
+                return false;
+            }
+        }
+
+        qint64 peeked = socket.peek(buf, room);
+        if (peeked <= 0)
+        {
+            return false;
+        }
+
+        // the terminator may have been split between this and the previous
+        // read, which is why the last three bytes already read are re-scanned
+        qint32 searchFrom = qMax(0, oldSize - 3);
+
+        target.append(buf, peeked);
+
+        qint32 index = target.indexOf("\r\n\r\n", searchFrom);
+        qint64 bytesToConsume = index >= 0 ? index + 4 - oldSize : peeked;
+
+        if (socket.read(buf, bytesToConsume) != bytesToConsume)
+        {
+            target.resize(oldSize);
+            return false;
+        }
 
-    while(linesRead < lineCount && socket.getChar(&readChar))
+        if (index >= 0)
+        {
+            target.resize(index + 4);
+
+            // a header that ends in the byte past the limit is too large
+            // as well, which the caller sees from the size of the target
+            return maxSize <= 0 || target.size() <= maxSize;
+        }
+    }
+}
+
+QByteArray HHttpUtils::toHttpDate(const QDateTime& utc)
+{
+    QDate date = utc.date();
+    QTime time = utc.time();
+
+    char buf[32];
+    qsnprintf(buf, sizeof(buf), "%s, %02d %s %04d %02d:%02d:%02d GMT",
+        HttpDays[date.dayOfWeek() - 1], date.day(),
+        HttpMonths[date.month() - 1], date.year(),
+        time.hour(), time.minute(), time.second());
+
+    return QByteArray(buf);
+}
+
+QDateTime HHttpUtils::fromHttpDate(const QByteArray& arg)
+{
+    const char* pos = arg.constData();
+    const char* end = pos + arg.size();
+
+    while (pos < end && *pos == ' ') { ++pos; }
+    while (end > pos && *(end - 1) == ' ') { --end; }
+
+    // The name of the day is redundant and it is not checked.
+    for(qint32 i = 0; i < 3; ++i, ++pos)
+    {
+        if (pos >= end || !((*pos >= 'A' && *pos <= 'Z') ||
+                            (*pos >= 'a' && *pos <= 'z')))
+        {
+            return QDateTime();
+        }
+    }
+
+    qint32 day, month = -1, year, hour, minute, second;
+    if (!readChar(pos, end, ',') || !readChar(pos, end, ' ') ||
+        !readNumber(pos, end, 1, 2, &day) || !readChar(pos, end, ' ') ||
+        end - pos < 4)
+    {
+        return QDateTime();
+    }
+
+    for(qint32 i = 0; i < 12; ++i)
+    {
+        if (qstrnicmp(pos, HttpMonths[i], 3) == 0)
+        {
+            month = i + 1;
+            break;
+        }
+    }
+    pos += 3;
+
+    if (month < 0 || !readChar(pos, end, ' ') ||
+        !readNumber(pos, end, 4, 4, &year) || !readChar(pos, end, ' ') ||
+        !readNumber(pos, end, 2, 2, &hour) || !readChar(pos, end, ':') ||
+        !readNumber(pos, end, 2, 2, &minute) || !readChar(pos, end, ':') ||
+        !readNumber(pos, end, 2, 2, &second))
+    {
+        return QDateTime();
+    }
+
+    // The zone is always GMT, but some implementations leave it out.
+    if (pos < end && (end - pos != 4 || qstrnicmp(pos, " GMT", 4) != 0))
+    {
+        return QDateTime();
+    }
+
+    QDate date(year, month, day);
+    QTime time(hour, minute, second);
+    if (!date.isValid() || !time.isValid())
+    {
+        return QDateTime();
+    }
+
+    return QDateTime(date, time, Qt::UTC);
+}
+
+bool HHttpUtils::acceptsGzip(const QByteArray& acceptEncoding)
+{
+    QList<QByteArray> codings = acceptEncoding.split(',');
+    foreach(const QByteArray& coding, codings)
     {
-        target.push_back(readChar);
+        qint32 paramIndex = coding.indexOf(';');
 
-        if (readChar != '\r')
+        QByteArray name = coding.left(paramIndex).trimmed().toLower();
+        if (name != "gzip" && name != "x-gzip")
         {
-            if (linesRead > 0) { linesRead = 0; }
             continue;
         }
 
-        if (socket.getChar(&readChar))
+        if (paramIndex < 0)
         {
-            target.push_back(readChar);
+            return true;
+        }
 
-            if (readChar == '\n')
-            {
-                ++linesRead;
-            }
-            else if (linesRead > 0)
-            {
-                linesRead = 0;
-            }
+        // a coding listed with "q=0" is explicitly not acceptable
+        QByteArray param = coding.mid(paramIndex + 1).trimmed().toLower();
+        if (!param.startsWith("q="))
+        {
+            return true;
         }
+
+        bool ok = false;
+        double q = param.mid(2).toDouble(&ok);
+        return !ok || q > 0;
+    }
+
+    return false;
+}
+
+QByteArray HHttpUtils::gzip(const QByteArray& data)
+{
+    // qCompress() produces a four-byte length prefix followed by a zlib
+    // stream (RFC 1950). The raw deflate data in between the two-byte zlib
+    // header and the four-byte Adler-32 trailer is the same as what a gzip
+    // member contains, which is why only the framing needs to be replaced.
+    QByteArray compressed = qCompress(data, 9);
+    if (compressed.size() < 10)
+    {
+        return QByteArray();
     }
 
-    return linesRead >= lineCount;
+    static const char header[] =
+        { '\x1f', '\x8b', 8, 0, 0, 0, 0, 0, 2, '\xff' };
+
+    QByteArray retVal;
+    retVal.reserve(compressed.size() + 12);
+    retVal.append(header, sizeof(header));
+    retVal.append(compressed.constData() + 6, compressed.size() - 10);
+
+    appendLittleEndian(retVal, s_crc32Table.crc32(data));
+    appendLittleEndian(retVal, static_cast<quint32>(data.size()));
+
+    return retVal;
 }
 
 }
@@ -39,6 +39,7 @@ class QUrl;
 template<typename T>
 class QList;
 
+class QDateTime;
 class QTcpSocket;
 class QByteArray;
 
@@ -51,7 +52,7 @@ namespace Upnp
 //
 //
 //
-class HHttpUtils
+class H_UPNP_CORE_EXPORT HHttpUtils
 {
 H_DISABLE_COPY(HHttpUtils)
 HHttpUtils();
@@ -61,30 +62,50 @@ public:
     template<typename Hdr>
     static bool keepAlive(const Hdr& hdr)
     {
-        QString connection = hdr.value("CONNECTION");
         if (hdr.minorVersion() == 1)
         {
-            return connection.compare("close", Qt::CaseInsensitive) != 0;
+            return !hdr.valueEquals(Hdr::Field_Connection, "close");
         }
 
-        return connection.compare("Keep-Alive", Qt::CaseInsensitive) == 0;
+        return hdr.valueEquals(Hdr::Field_Connection, "Keep-Alive");
     }
 
     // returns the URLs as a string inside brackets. This is the format used in
     // UPnP eventing when subscribing to events.
     static QString callbackAsStr(const QList<QUrl>& callbacks);
 
-    // the date format used in UPnP
-    inline static QString rfc1123DateFormat()
-    {
-        QString retVal = "ddd, dd MMM yyyy HH:mm:ss";
-        return retVal;
-    }
+    //
+    // reads the data the socket has already buffered to the target bytearray
+    // in blocks until \r\n\r\n is found, in which case true is returned.
+    // data following the terminator is left in the socket. if false is
+    // returned the target contains a partial header, which is scanned no
+    // further than necessary when the call is repeated with more data.
+    // if maxSize is positive, the target never grows past maxSize + 1 bytes,
+    // which lets the caller tell an oversized header from a partial one.
+    static bool readHeader(
+        QTcpSocket&, QByteArray& target, qint32 maxSize = -1);
+
+    //
+    // formats the specified UTC time as specified in RFC 1123. the names of
+    // the days and months are not localized as they would be with
+    // QDateTime::toString().
+    static QByteArray toHttpDate(const QDateTime& utc);
+
+    //
+    // parses a date formatted as specified in RFC 1123, such as the value of
+    // the DATE header field. the parsing does not depend on the locale and an
+    // invalid object is returned in case the value is not in the format.
+    static QDateTime fromHttpDate(const QByteArray& arg);
+
+    //
+    // returns true if the value of an ACCEPT-ENCODING field allows the use of
+    // the gzip content-coding
+    static bool acceptsGzip(const QByteArray& acceptEncoding);
 
     //
-    // reads byte by byte to the target bytearray until \r\n\r\n is found,
-    // in which case true is returned
-    static bool readLines(QTcpSocket&, QByteArray& target, qint32 lineCount = 2);
+    // compresses the data into the gzip format (RFC 1952). an empty array is
+    // returned in case the data could not be compressed.
+    static QByteArray gzip(const QByteArray& data);
 };
 
 }
@@ -0,0 +1,156 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hopenmetrics_p.h"
+
+#include "../general/hmemoryaccount_p.h"
+
+#include <QtCore/QString>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+/*******************************************************************************
+ * HOpenMetricsWriter
+ ******************************************************************************/
+HOpenMetricsWriter::HOpenMetricsWriter() :
+    m_data()
+{
+    m_data.reserve(4096);
+}
+
+void HOpenMetricsWriter::addSampleName(
+    const char* name, const QByteArray& labels)
+{
+    m_data.append(name);
+    if (!labels.isEmpty())
+    {
+        m_data.append('{').append(labels).append('}');
+    }
+    m_data.append(' ');
+}
+
+void HOpenMetricsWriter::begin(
+    const char* name, const char* type, const char* help)
+{
+    m_data.append("# TYPE ").append(name).append(' ').append(type).append('\n');
+    m_data.append("# HELP ").append(name).append(' ').append(help).append('\n');
+}
+
+void HOpenMetricsWriter::add(
+    const char* name, qint64 value, const QByteArray& labels)
+{
+    addSampleName(name, labels);
+    m_data.append(QByteArray::number(value)).append('\n');
+}
+
+void HOpenMetricsWriter::addSummary(
+    const char* name, qint32 p50, qint32 p90, qint32 p99, qint64 count,
+    const QByteArray& labels)
+{
+    if (p50 >= 0)
+    {
+        const qint32 values[] = { p50, p90, p99 };
+        const char* quantiles[] = { "0.5", "0.9", "0.99" };
+
+        for(qint32 i = 0; i < 3; ++i)
+        {
+            QByteArray quantileLabels = labels;
+            if (!quantileLabels.isEmpty())
+            {
+                quantileLabels.append(',');
+            }
+            quantileLabels.append("quantile=\"").append(quantiles[i]).
+                append('"');
+
+            addSampleName(name, quantileLabels);
+            m_data.append(QByteArray::number(values[i] / 1000.0)).append('\n');
+        }
+    }
+
+    addSampleName(QByteArray(name).append("_count").constData(), labels);
+    m_data.append(QByteArray::number(count)).append('\n');
+}
+
+QByteArray HOpenMetricsWriter::label(const char* name, const QString& value)
+{
+    QByteArray retVal(name);
+    retVal.append("=\"");
+
+    QByteArray utf8 = value.toUtf8();
+    for(qint32 i = 0; i < utf8.size(); ++i)
+    {
+        char c = utf8.at(i);
+        if (c == '\\' || c == '"')
+        {
+            retVal.append('\\').append(c);
+        }
+        else if (c == '\n')
+        {
+            retVal.append("\\n");
+        }
+        else
+        {
+            retVal.append(c);
+        }
+    }
+
+    return retVal.append('"');
+}
+
+QByteArray HOpenMetricsWriter::finish()
+{
+    m_data.append("# EOF\n");
+    return m_data;
+}
+
+void addMemoryMetrics(HOpenMetricsWriter& writer)
+{
+    QList<HMemoryAccount*> accounts = HMemoryAccount::accounts();
+
+    writer.begin(
+        "hupnp_memory_bytes", "gauge",
+        "The estimated heap footprint by subsystem.");
+
+    foreach(const HMemoryAccount* account, accounts)
+    {
+        writer.add(
+            "hupnp_memory_bytes", account->bytes(),
+            HOpenMetricsWriter::label("subsystem", account->name()));
+    }
+
+    writer.begin(
+        "hupnp_memory_objects", "gauge",
+        "The number of objects accounted by subsystem.");
+
+    foreach(const HMemoryAccount* account, accounts)
+    {
+        writer.add(
+            "hupnp_memory_objects", account->objects(),
+            HOpenMetricsWriter::label("subsystem", account->name()));
+    }
+}
+
+}
+}
@@ -0,0 +1,189 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HOPENMETRICS_P_H_
+#define HOPENMETRICS_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include "../ssdp/hssdp.h"
+
+#include <QtCore/QByteArray>
+#include <QtCore/QStringList>
+
+class QString;
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+//
+// Renders metrics in the OpenMetrics text format. Each metric family is
+// started with begin() and its samples are added right after it. finish()
+// terminates the exposition and returns it.
+//
+class HOpenMetricsWriter
+{
+H_DISABLE_COPY(HOpenMetricsWriter)
+
+private:
+
+    QByteArray m_data;
+
+    void addSampleName(const char* name, const QByteArray& labels);
+
+public:
+
+    HOpenMetricsWriter();
+
+    // the type is one of "counter", "gauge" and "summary". the name of a
+    // counter family must not contain the "_total" suffix of its samples
+    void begin(const char* name, const char* type, const char* help);
+
+    void add(const char* name, qint64 value,
+        const QByteArray& labels = QByteArray());
+
+    // adds the quantiles of a summary, which are in milliseconds, in
+    // seconds. a negative quantile means that there are no samples, in
+    // which case only the count is added
+    void addSummary(
+        const char* name, qint32 p50, qint32 p90, qint32 p99, qint64 count,
+        const QByteArray& labels = QByteArray());
+
+    // returns name="value" with the value escaped as the format requires
+    static QByteArray label(const char* name, const QString& value);
+
+    QByteArray finish();
+};
+
+//
+// Adds the SSDP message counters of a device host or a control point
+// runtime status
+//
+template<typename RuntimeStatus>
+void addSsdpMetrics(HOpenMetricsWriter& writer, const RuntimeStatus& status)
+{
+    static const HSsdp::AllowedMessage types[] =
+    {
+        HSsdp::DeviceAvailable, HSsdp::DeviceUpdate, HSsdp::DeviceUnavailable,
+        HSsdp::DiscoveryRequest, HSsdp::DiscoveryResponse
+    };
+
+    static const char* names[] =
+    {
+        "device_available", "device_update", "device_unavailable",
+        "discovery_request", "discovery_response"
+    };
+
+    writer.begin(
+        "hupnp_ssdp_messages_received", "counter",
+        "SSDP messages received by type.");
+
+    for(qint32 i = 0; i < 5; ++i)
+    {
+        writer.add(
+            "hupnp_ssdp_messages_received_total",
+            status.ssdpMessagesReceived(types[i]),
+            HOpenMetricsWriter::label("type", names[i]));
+    }
+
+    writer.begin(
+        "hupnp_ssdp_messages_sent", "counter",
+        "SSDP messages sent by type.");
+
+    for(qint32 i = 0; i < 5; ++i)
+    {
+        writer.add(
+            "hupnp_ssdp_messages_sent_total",
+            status.ssdpMessagesSent(types[i]),
+            HOpenMetricsWriter::label("type", names[i]));
+    }
+
+    writer.begin(
+        "hupnp_ssdp_datagrams_dropped", "counter",
+        "SSDP datagrams dropped before processing by reason.");
+
+    // the kernel drops are not counted on every platform
+    qint64 kernel = status.ssdpDatagramsDropped(HSsdp::ReceiveBufferFull);
+    if (kernel >= 0)
+    {
+        writer.add(
+            "hupnp_ssdp_datagrams_dropped_total", kernel,
+            HOpenMetricsWriter::label("reason", "receive_buffer"));
+    }
+
+    writer.add(
+        "hupnp_ssdp_datagrams_dropped_total",
+        qMax(status.ssdpDatagramsDropped(HSsdp::ReceiveQueueFull),
+             Q_INT64_C(0)),
+        HOpenMetricsWriter::label("reason", "receive_queue"));
+}
+
+//
+// Adds the stall counters of a device host or a control point runtime status
+//
+template<typename RuntimeStatus>
+void addStallMetrics(HOpenMetricsWriter& writer, const RuntimeStatus& status)
+{
+    QStringList handlers = status.stalledHandlers();
+
+    writer.begin(
+        "hupnp_handler_stalls", "counter",
+        "Handlers that ran longer than the stall threshold by handler.");
+
+    foreach(const QString& handler, handlers)
+    {
+        writer.add(
+            "hupnp_handler_stalls_total", status.handlerStalls(handler),
+            HOpenMetricsWriter::label("handler", handler));
+    }
+
+    writer.begin(
+        "hupnp_handler_stall_worst_milliseconds", "gauge",
+        "The longest stall caused by a handler by handler.");
+
+    foreach(const QString& handler, handlers)
+    {
+        writer.add(
+            "hupnp_handler_stall_worst_milliseconds",
+            status.worstHandlerStall(handler),
+            HOpenMetricsWriter::label("handler", handler));
+    }
+}
+
+//
+// Adds the memory estimates of every subsystem of the process.
+// See HMemoryUsage
+//
+void addMemoryMetrics(HOpenMetricsWriter& writer);
+
+}
+}
+
+#endif /* HOPENMETRICS_P_H_ */
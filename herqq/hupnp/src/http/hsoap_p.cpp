@@ -0,0 +1,314 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "hsoap_p.h"
+
+#include "../general/hupnp_global_p.h"
+#include "../general/hupnp_datatypes_p.h"
+#include "../general/hxmlfragment_p.h"
+#include "../devicemodel/hactionarguments.h"
+
+#include <QtCore/QBuffer>
+#include <QtCore/QByteArray>
+#include <QtCore/QXmlStreamReader>
+#include <QtCore/QXmlStreamWriter>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace
+{
+const char SoapEnvelopeNs[] = "http://schemas.xmlsoap.org/soap/envelope/";
+const char SoapEncodingNs[] = "http://schemas.xmlsoap.org/soap/encoding/";
+const char UpnpControlNs[]  = "urn:schemas-upnp-org:control-1-0";
+
+void writeEnvelopeStart(QXmlStreamWriter& writer)
+{
+    writer.writeStartDocument();
+    writer.writeStartElement("s:Envelope");
+    writer.writeAttribute("xmlns:s", SoapEnvelopeNs);
+    writer.writeAttribute("s:encodingStyle", SoapEncodingNs);
+    writer.writeStartElement("s:Body");
+}
+
+void writeEnvelopeEnd(QXmlStreamWriter& writer)
+{
+    writer.writeEndElement(); // Body
+    writer.writeEndElement(); // Envelope
+    writer.writeEndDocument();
+}
+
+bool setError(
+    const QXmlStreamReader& reader, const QString& descr, QString* err)
+{
+    if (err)
+    {
+        *err = reader.hasError() ?
+            QString("%1 at line %2, column %3").arg(
+                reader.errorString(),
+                QString::number(reader.lineNumber()),
+                QString::number(reader.columnNumber())) :
+            descr;
+    }
+    return false;
+}
+}
+
+HSoapMessage::HSoapMessage() :
+    m_type(Undefined), m_methodName(), m_methodNamespace(), m_arguments(),
+    m_faultCode(), m_faultString(), m_errorCode(UpnpUndefinedFailure),
+    m_errorDescription()
+{
+}
+
+HSoapMessage::~HSoapMessage()
+{
+}
+
+void HSoapMessage::clear()
+{
+    m_type = Undefined;
+    m_methodName.clear();
+    m_methodNamespace.clear();
+    m_arguments.clear();
+    m_faultCode.clear();
+    m_faultString.clear();
+    m_errorCode = UpnpUndefinedFailure;
+    m_errorDescription.clear();
+}
+
+bool HSoapMessage::parse(const QByteArray& data, QString* err)
+{
+    clear();
+
+    QXmlStreamReader reader(data);
+    if (!reader.readNextStartElement() || reader.name() != "Envelope")
+    {
+        return setError(reader, "Missing <Envelope> element", err);
+    }
+
+    bool bodyFound = false;
+    while(reader.readNextStartElement())
+    {
+        if (reader.name() == "Body")
+        {
+            bodyFound = true;
+            break;
+        }
+
+        // the Header element, which UPnP does not use
+        reader.skipCurrentElement();
+    }
+
+    if (!bodyFound)
+    {
+        return setError(reader, "Missing <Body> element", err);
+    }
+
+    if (!reader.readNextStartElement())
+    {
+        return setError(reader, "The <Body> element is empty", err);
+    }
+
+    if (reader.name() == "Fault" && reader.namespaceUri() == SoapEnvelopeNs)
+    {
+        while(reader.readNextStartElement())
+        {
+            if (reader.name() == "faultcode")
+            {
+                m_faultCode = reader.readElementText(
+                    QXmlStreamReader::SkipChildElements);
+            }
+            else if (reader.name() == "faultstring")
+            {
+                m_faultString = reader.readElementText(
+                    QXmlStreamReader::SkipChildElements);
+            }
+            else if (reader.name() == "detail")
+            {
+                while(reader.readNextStartElement())
+                {
+                    if (reader.name() != "UPnPError")
+                    {
+                        reader.skipCurrentElement();
+                        continue;
+                    }
+
+                    while(reader.readNextStartElement())
+                    {
+                        QString name = reader.name().toString();
+                        QString text = reader.readElementText(
+                            QXmlStreamReader::SkipChildElements);
+
+                        if (name == "errorCode")
+                        {
+                            bool ok = false;
+                            qint32 errorCode = text.trimmed().toInt(&ok);
+                            if (ok)
+                            {
+                                m_errorCode = errorCode;
+                            }
+                        }
+                        else if (name == "errorDescription")
+                        {
+                            m_errorDescription = text;
+                        }
+                    }
+                }
+            }
+            else
+            {
+                reader.skipCurrentElement();
+            }
+        }
+
+        if (reader.hasError())
+        {
+            clear();
+            return setError(reader, QString(), err);
+        }
+
+        m_type = Fault;
+        return true;
+    }
+
+    m_methodName = reader.name().toString();
+    m_methodNamespace = reader.namespaceUri().toString();
+
+    // the rest of the envelope is not needed once the method element has
+    // been read
+    while(reader.readNextStartElement())
+    {
+        QString name = reader.name().toString();
+        QString value =
+            reader.readElementText(QXmlStreamReader::SkipChildElements);
+
+        m_arguments.append(qMakePair(name, value));
+    }
+
+    if (reader.hasError())
+    {
+        clear();
+        return setError(reader, QString(), err);
+    }
+
+    m_type = Method;
+    return true;
+}
+
+QString HSoapMessage::argument(const QString& name, bool* found) const
+{
+    QList<QPair<QString, QString> >::const_iterator ci =
+        m_arguments.constBegin();
+    for(; ci != m_arguments.constEnd(); ++ci)
+    {
+        if (ci->first == name)
+        {
+            if (found) { *found = true; }
+            return ci->second;
+        }
+    }
+
+    if (found) { *found = false; }
+    return QString();
+}
+
+QByteArray HSoapMessage::createMethod(
+    const QString& methodName, const QString& methodNamespace,
+    const HActionArguments& args)
+{
+    Q_ASSERT(!methodName.isEmpty());
+    Q_ASSERT(!methodNamespace.isEmpty());
+
+    QByteArray retVal;
+    QBuffer buffer(&retVal);
+    buffer.open(QIODevice::WriteOnly);
+
+    QXmlStreamWriter writer(&buffer);
+
+    writeEnvelopeStart(writer);
+
+    writer.writeStartElement(QString("u:%1").arg(methodName));
+    writer.writeAttribute("xmlns:u", methodNamespace);
+
+    HActionArguments::const_iterator ci = args.constBegin();
+    for(; ci != args.constEnd(); ++ci)
+    {
+        QVariant value = ci->value();
+        if (value.userType() == qMetaTypeId<HXmlFragment>())
+        {
+            // The value is already escaped and encoded, which is why it is
+            // copied straight into the buffer. The writer does not buffer
+            // anything itself, so the output stays in order as long as the
+            // start tag is finished first.
+            const QByteArray& data = value.value<HXmlFragment>().data();
+            retVal.reserve(retVal.size() + data.size() + 1024);
+
+            writer.writeStartElement(ci->name());
+            writer.writeCharacters(QString());
+            buffer.write(data);
+            writer.writeEndElement();
+        }
+        else
+        {
+            writer.writeTextElement(
+                ci->name(), convertToString(ci->dataType(), value));
+        }
+    }
+
+    writer.writeEndElement();
+
+    writeEnvelopeEnd(writer);
+
+    return retVal;
+}
+
+QByteArray HSoapMessage::createFault(
+    qint32 errorCode, const QString& errorDescription)
+{
+    QByteArray retVal;
+    QXmlStreamWriter writer(&retVal);
+
+    writeEnvelopeStart(writer);
+
+    writer.writeStartElement("s:Fault");
+    writer.writeTextElement("faultcode", "s:Client");
+    writer.writeTextElement("faultstring", "UPnPError");
+    writer.writeStartElement("detail");
+    writer.writeStartElement("UPnPError");
+    writer.writeAttribute("xmlns", UpnpControlNs);
+    writer.writeTextElement("errorCode", QString::number(errorCode));
+    writer.writeTextElement("errorDescription", errorDescription);
+    writer.writeEndElement(); // UPnPError
+    writer.writeEndElement(); // detail
+    writer.writeEndElement(); // Fault
+
+    writeEnvelopeEnd(writer);
+
+    return retVal;
+}
+
+}
+}
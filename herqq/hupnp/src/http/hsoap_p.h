@@ -0,0 +1,140 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef HSOAP_P_H_
+#define HSOAP_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include <HUpnpCore/HUpnp>
+
+#include <QtCore/QList>
+#include <QtCore/QPair>
+#include <QtCore/QString>
+
+class QByteArray;
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+//
+// The contents of a SOAP 1.1 envelope exchanged during UPnP action invocation.
+//
+// The body of such an envelope contains either a single element named after
+// the action, the children of which are the action arguments, or a fault
+// carrying an UPnPError. The envelope is read with a pull parser and only the
+// parts UPnP uses are retained. Similarly, the messages are written directly
+// to a byte array without building any intermediate document.
+//
+class H_UPNP_CORE_EXPORT HSoapMessage
+{
+public:
+
+    enum Type
+    {
+        // the message has not been parsed or it was invalid
+        Undefined = 0,
+
+        // the body contains an action request or an action response
+        Method,
+
+        // the body contains a SOAP fault
+        Fault
+    };
+
+private:
+
+    Type m_type;
+
+    QString m_methodName;
+    QString m_methodNamespace;
+    QList<QPair<QString, QString> > m_arguments;
+
+    QString m_faultCode;
+    QString m_faultString;
+    qint32 m_errorCode;
+    QString m_errorDescription;
+
+    void clear();
+
+public:
+
+    HSoapMessage();
+    ~HSoapMessage();
+
+    // parses the specified SOAP envelope. on failure the message is left
+    // undefined and a description of the error is stored in err, if provided
+    bool parse(const QByteArray& data, QString* err = 0);
+
+    inline Type type() const { return m_type; }
+    inline bool isFault() const { return m_type == Fault; }
+
+    // the local name of the body element, which is the name of the action,
+    // or the name of the action followed by "Response"
+    inline QString methodName() const { return m_methodName; }
+
+    // the namespace of the body element, which is the service type
+    inline QString methodNamespace() const { return m_methodNamespace; }
+
+    // the arguments of the method as name-value pairs in document order
+    inline QList<QPair<QString, QString> > arguments() const
+    {
+        return m_arguments;
+    }
+
+    // returns the value of the named method argument. the lookup is linear,
+    // as actions seldom have more than a handful of arguments
+    QString argument(const QString& name, bool* found) const;
+
+    inline QString faultCode() const { return m_faultCode; }
+    inline QString faultString() const { return m_faultString; }
+
+    // the errorCode of the UPnPError of a fault, or UpnpUndefinedFailure
+    // in case the fault did not contain one
+    inline qint32 errorCode() const { return m_errorCode; }
+    inline QString errorDescription() const { return m_errorDescription; }
+
+    // creates an action request, or a response when the methodName is
+    // of the form "<actionName>Response"
+    static QByteArray createMethod(
+        const QString& methodName, const QString& methodNamespace,
+        const HActionArguments& args);
+
+    // creates a Client fault with the UPnPError detail that is used to
+    // signal action invocation errors
+    static QByteArray createFault(
+        qint32 errorCode, const QString& errorDescription);
+};
+
+}
+}
+
+#endif /* HSOAP_P_H_ */
@@ -5,7 +5,10 @@ HEADERS += \
     $$SRC_LOC/http/hhttp_server_p.h \
     $$SRC_LOC/http/hhttp_asynchandler_p.h \
     $$SRC_LOC/http/hhttp_messaginginfo_p.h \
-    $$SRC_LOC/http/hhttp_messagecreator_p.h
+    $$SRC_LOC/http/hhttp_messagecreator_p.h \
+    $$SRC_LOC/http/hhttp_connectionpool_p.h \
+    $$SRC_LOC/http/hopenmetrics_p.h \
+    $$SRC_LOC/http/hsoap_p.h
 
 EXPORTED_PRIVATE_HEADERS += \
     $$SRC_LOC/http/hhttp_p.h \
@@ -14,7 +17,9 @@ EXPORTED_PRIVATE_HEADERS += \
     $$SRC_LOC/http/hhttp_server_p.h \
     $$SRC_LOC/http/hhttp_asynchandler_p.h \
     $$SRC_LOC/http/hhttp_messaginginfo_p.h \
-    $$SRC_LOC/http/hhttp_messagecreator_p.h
+    $$SRC_LOC/http/hhttp_messagecreator_p.h \
+    $$SRC_LOC/http/hhttp_connectionpool_p.h \
+    $$SRC_LOC/http/hsoap_p.h
 
 SOURCES += \
     $$SRC_LOC/http/hhttp_utils_p.cpp \
@@ -22,4 +27,7 @@ SOURCES += \
     $$SRC_LOC/http/hhttp_server_p.cpp \
     $$SRC_LOC/http/hhttp_asynchandler_p.cpp \
     $$SRC_LOC/http/hhttp_messaginginfo_p.cpp \
-    $$SRC_LOC/http/hhttp_messagecreator_p.cpp
+    $$SRC_LOC/http/hhttp_messagecreator_p.cpp \
+    $$SRC_LOC/http/hhttp_connectionpool_p.cpp \
+    $$SRC_LOC/http/hopenmetrics_p.cpp \
+    $$SRC_LOC/http/hsoap_p.cpp
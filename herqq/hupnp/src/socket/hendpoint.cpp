@@ -23,6 +23,7 @@
 #include "../utils/hmisc_utils_p.h"
 
 #include <QtCore/QUrl>
+#include <QtCore/QtAlgorithms>
 
 namespace Herqq
 {
@@ -33,47 +34,36 @@ namespace Upnp
 /*******************************************************************************
  * HEndpoint
  ******************************************************************************/
-HEndpoint::HEndpoint(const QHostAddress& hostAddress, quint16 portNumber) :
-    m_hostAddress(hostAddress),
-    m_portNumber(hostAddress == QHostAddress::Null ? (quint16)0 : portNumber)
+HEndpoint::HEndpoint(const QHostAddress& hostAddress, quint16 portNumber)
 {
+    init(hostAddress, portNumber);
 }
 
-HEndpoint::HEndpoint(const QHostAddress& hostAddress) :
-    m_hostAddress(hostAddress), m_portNumber(0)
+HEndpoint::HEndpoint(const QHostAddress& hostAddress)
 {
+    init(hostAddress, 0);
 }
 
-HEndpoint::HEndpoint() :
-    m_hostAddress(QHostAddress::Null), m_portNumber(0)
+HEndpoint::HEndpoint()
 {
+    init(QHostAddress(QHostAddress::Null), 0);
 }
 
-HEndpoint::HEndpoint(const QUrl& url) :
-    m_hostAddress(QHostAddress(url.host())),
-    m_portNumber(m_hostAddress == QHostAddress::Null ? (quint16)0 : url.port())
+HEndpoint::HEndpoint(const QUrl& url)
 {
+    init(QHostAddress(url.host()), url.port());
 }
 
-HEndpoint::HEndpoint(const QString& arg) :
-    m_hostAddress(), m_portNumber(0)
+HEndpoint::HEndpoint(const QString& arg)
 {
     qint32 delim = arg.indexOf(':');
     if (delim < 0)
     {
-        m_hostAddress = arg;
+        init(QHostAddress(arg), 0);
     }
     else
     {
-        m_hostAddress = arg.left(delim);
-        if (m_hostAddress == QHostAddress::Null)
-        {
-            m_portNumber = 0;
-        }
-        else
-        {
-            m_portNumber = arg.mid(delim+1).toUShort();
-        }
+        init(QHostAddress(arg.left(delim)), arg.mid(delim+1).toUShort());
     }
 }
 
@@ -81,30 +71,65 @@ HEndpoint::~HEndpoint()
 {
 }
 
-bool HEndpoint::isMulticast() const
+void HEndpoint::init(const QHostAddress& hostAddress, quint16 portNumber)
 {
-    quint32 ipaddr = m_hostAddress.toIPv4Address();
-    return ((ipaddr & 0xe0000000) == 0xe0000000) ||
-           ((ipaddr & 0xe8000000) == 0xe8000000) ||
-           ((ipaddr & 0xef000000) == 0xef000000);
+    // the address is kept in plain integers so that endpoints can be copied,
+    // compared and hashed without touching the heap. the hash is computed
+    // once, since endpoints are mostly used as keys
+    m_protocol = static_cast<qint8>(hostAddress.protocol());
+    m_portNumber = isNull() ? (quint16)0 : portNumber;
+
+    m_ipv4Address = m_protocol == QAbstractSocket::IPv4Protocol ?
+        hostAddress.toIPv4Address() : 0;
+
+    if (m_protocol == QAbstractSocket::IPv6Protocol)
+    {
+        m_ipv6Address = hostAddress.toIPv6Address();
+    }
+    else
+    {
+        qFill(m_ipv6Address.c, m_ipv6Address.c + 16, 0);
+    }
+
+    quint32 tmp = m_ipv4Address ^ m_portNumber;
+    m_hash = hash(reinterpret_cast<char*>(&tmp), sizeof(tmp));
+    if (m_protocol == QAbstractSocket::IPv6Protocol)
+    {
+        m_hash ^= hash(reinterpret_cast<char*>(m_ipv6Address.c), 16);
+    }
 }
 
-QString HEndpoint::toString() const
+QHostAddress HEndpoint::hostAddress() const
 {
-    return isNull() ? QString() :
-        m_hostAddress.toString().append(":").append(QString::number(m_portNumber));
+    switch(m_protocol)
+    {
+    case QAbstractSocket::UnknownNetworkLayerProtocol:
+        return QHostAddress();
+    case QAbstractSocket::IPv4Protocol:
+        return QHostAddress(m_ipv4Address);
+    case QAbstractSocket::IPv6Protocol:
+        return QHostAddress(m_ipv6Address);
+    default:
+        // the dual-stack "any" address
+        return QHostAddress(QHostAddress::Any);
+    }
 }
 
-bool operator==(const HEndpoint& ep1, const HEndpoint& ep2)
+QString HEndpoint::toString() const
 {
-    return ep1.m_hostAddress == ep2.m_hostAddress &&
-           ep1.m_portNumber  == ep2.m_portNumber;
+    return isNull() ? QString() :
+        hostAddress().toString().append(":").append(
+            QString::number(m_portNumber));
 }
 
-quint32 qHash(const HEndpoint& key)
+bool operator==(const HEndpoint& ep1, const HEndpoint& ep2)
 {
-    quint32 tmp = key.m_hostAddress.toIPv4Address() ^ key.portNumber();
-    return hash(reinterpret_cast<char*>(&tmp), sizeof(tmp));
+    return ep1.m_hash == ep2.m_hash &&
+           ep1.m_protocol == ep2.m_protocol &&
+           ep1.m_ipv4Address == ep2.m_ipv4Address &&
+           ep1.m_portNumber == ep2.m_portNumber &&
+           qEqual(ep1.m_ipv6Address.c, ep1.m_ipv6Address.c + 16,
+                  ep2.m_ipv6Address.c);
 }
 
 }
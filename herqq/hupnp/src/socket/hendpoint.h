@@ -26,6 +26,7 @@
 #include <HUpnpCore/HUpnp>
 
 #include <QtNetwork/QHostAddress>
+#include <QtNetwork/QAbstractSocket>
 
 class QUrl;
 
@@ -48,12 +49,24 @@ class H_UPNP_CORE_EXPORT HEndpoint
 friend H_UPNP_CORE_EXPORT bool operator==(
     const HEndpoint&, const HEndpoint&);
 
-friend H_UPNP_CORE_EXPORT quint32 qHash(const HEndpoint&);
+friend quint32 qHash(const HEndpoint&);
 
 private:
 
-    QHostAddress m_hostAddress;
-    quint16      m_portNumber;
+    quint32 m_ipv4Address;
+    // zero unless the protocol is IPv4
+
+    Q_IPV6ADDR m_ipv6Address;
+    // all zeroes unless the protocol is IPv6
+
+    qint8 m_protocol;
+    // the QAbstractSocket::NetworkLayerProtocol of the address, which is
+    // QAbstractSocket::UnknownNetworkLayerProtocol when the address is null
+
+    quint16 m_portNumber;
+    quint32 m_hash;
+
+    void init(const QHostAddress& hostAddress, quint16 portNumber);
 
 public:
 
@@ -119,14 +132,17 @@ public:
      *
      * \return \e true in case the end point is not defined.
      */
-    inline bool isNull() const { return m_hostAddress.isNull(); }
+    inline bool isNull() const
+    {
+        return m_protocol == QAbstractSocket::UnknownNetworkLayerProtocol;
+    }
 
     /*!
      * \brief Returns the host address of the endpoint.
      *
      * \return The host address of the endpoint.
      */
-    inline QHostAddress hostAddress() const { return m_hostAddress; }
+    QHostAddress hostAddress() const;
 
     /*!
      * \brief Returns the port number of the endpoint.
@@ -140,7 +156,12 @@ public:
      *
      * \return \e true in case the end point refers to a multicast address.
      */
-    bool isMulticast() const;
+    inline bool isMulticast() const
+    {
+        return ((m_ipv4Address & 0xe0000000) == 0xe0000000) ||
+               ((m_ipv4Address & 0xe8000000) == 0xe8000000) ||
+               ((m_ipv4Address & 0xef000000) == 0xef000000);
+    }
 
     /*!
      * \brief Returns a string representation of the endpoint.
@@ -184,7 +205,10 @@ inline bool operator!=(const HEndpoint& obj1, const HEndpoint& obj2)
  *
  * \relates HEndpoint
  */
-H_UPNP_CORE_EXPORT quint32 qHash(const HEndpoint& key);
+inline quint32 qHash(const HEndpoint& key)
+{
+    return key.m_hash;
+}
 
 }
 }
@@ -20,6 +20,7 @@
  */
 
 #include "hmulticast_socket.h"
+#include "hendpoint.h"
 #include "../general/hlogger_p.h"
 
 #ifdef Q_OS_WIN
@@ -32,19 +33,98 @@
 #include <arpa/inet.h>
 #endif
 
+#ifdef Q_OS_LINUX
+#include <sys/socket.h>
+#ifdef MSG_WAITFORONE
+#define HUPNP_USE_RECVMMSG
+#endif
+#if defined(__GLIBC_PREREQ)
+#if __GLIBC_PREREQ(2, 14)
+#define HUPNP_USE_SENDMMSG
+#endif
+#endif
+#if defined(HUPNP_USE_RECVMMSG) && defined(SO_RXQ_OVFL)
+#define HUPNP_USE_RXQ_OVFL
+#endif
+#endif
+
 #include <QtNetwork/QNetworkProxy>
 
+#include <cerrno>
+#include <cstring>
+
 namespace Herqq
 {
 
 namespace Upnp
 {
 
+namespace
+{
+#if defined(HUPNP_USE_RECVMMSG) || defined(HUPNP_USE_SENDMMSG)
+// the maximum number of datagrams read or written with a single system call
+const qint32 MaxBatchSize = 16;
+#endif
+
+#ifdef HUPNP_USE_RECVMMSG
+
+// the maximum size of a datagram read in a batch
+const qint32 MaxBatchDatagramSize = 8192;
+
+HEndpoint toEndpoint(const sockaddr_storage& addr)
+{
+    const sockaddr* sa = reinterpret_cast<const sockaddr*>(&addr);
+
+    quint16 port = 0;
+    if (sa->sa_family == AF_INET)
+    {
+        port = ntohs(reinterpret_cast<const sockaddr_in*>(sa)->sin_port);
+    }
+    else if (sa->sa_family == AF_INET6)
+    {
+        port = ntohs(reinterpret_cast<const sockaddr_in6*>(sa)->sin6_port);
+    }
+
+    return HEndpoint(QHostAddress(sa), port);
+}
+#endif
+
+#ifdef HUPNP_USE_RXQ_OVFL
+// returns the kernel drop counter of the socket attached to the message or
+// -1 in case the message has none. the counter is attached only once the
+// socket has dropped something
+qint64 dropCount(msghdr* msg)
+{
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(msg); cmsg;
+         cmsg = CMSG_NXTHDR(msg, cmsg))
+    {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_RXQ_OVFL)
+        {
+            quint32 drops = 0;
+            memcpy(&drops, CMSG_DATA(cmsg), sizeof(drops));
+            return drops;
+        }
+    }
+
+    return -1;
+}
+#endif
+}
+
 //
 //
 //
 class HMulticastSocketPrivate
 {
+public:
+
+    QByteArray m_batchBuffer;
+    // the buffer for the batched reads. allocated on first use
+
+    qint64 m_droppedDatagrams;
+    // the last value of the kernel drop counter. -1 if it is not counted
+
+    HMulticastSocketPrivate() : m_batchBuffer(), m_droppedDatagrams(-1) {}
 };
 
 HMulticastSocket::HMulticastSocket(QObject* parent) :
@@ -223,5 +303,361 @@ bool HMulticastSocket::setMulticastTtl(quint8 ttl)
     return true;
 }
 
+bool HMulticastSocket::setReceiveBufferSize(qint32 bytes)
+{
+    HLOG(H_AT, H_FUN);
+
+    if (socketDescriptor() == -1)
+    {
+        HLOG_WARN("Socket descriptor is invalid.");
+        setSocketError(QAbstractSocket::UnknownSocketError);
+        return false;
+    }
+
+    int size = bytes;
+    if (setsockopt(
+            socketDescriptor(),
+            SOL_SOCKET,
+            SO_RCVBUF,
+            reinterpret_cast<char*>(&size),
+            sizeof(size)) < 0)
+    {
+        HLOG_WARN(QString(
+            "Could not set the receive buffer size to [%1].").arg(
+                QString::number(bytes)));
+
+        setSocketError(QAbstractSocket::UnknownSocketError);
+        return false;
+    }
+
+    return true;
+}
+
+qint32 HMulticastSocket::receiveBufferSize() const
+{
+    if (socketDescriptor() == -1)
+    {
+        return -1;
+    }
+
+    int size = 0;
+#ifdef Q_OS_WIN
+    int length = sizeof(size);
+#else
+    socklen_t length = sizeof(size);
+#endif
+    if (getsockopt(
+            socketDescriptor(),
+            SOL_SOCKET,
+            SO_RCVBUF,
+            reinterpret_cast<char*>(&size),
+            &length) < 0)
+    {
+        return -1;
+    }
+
+    return size;
+}
+
+bool HMulticastSocket::setSendBufferSize(qint32 bytes)
+{
+    HLOG(H_AT, H_FUN);
+
+    if (socketDescriptor() == -1)
+    {
+        HLOG_WARN("Socket descriptor is invalid.");
+        setSocketError(QAbstractSocket::UnknownSocketError);
+        return false;
+    }
+
+    int size = bytes;
+    if (setsockopt(
+            socketDescriptor(),
+            SOL_SOCKET,
+            SO_SNDBUF,
+            reinterpret_cast<char*>(&size),
+            sizeof(size)) < 0)
+    {
+        HLOG_WARN(QString(
+            "Could not set the send buffer size to [%1].").arg(
+                QString::number(bytes)));
+
+        setSocketError(QAbstractSocket::UnknownSocketError);
+        return false;
+    }
+
+    return true;
+}
+
+qint32 HMulticastSocket::sendBufferSize() const
+{
+    if (socketDescriptor() == -1)
+    {
+        return -1;
+    }
+
+    int size = 0;
+#ifdef Q_OS_WIN
+    int length = sizeof(size);
+#else
+    socklen_t length = sizeof(size);
+#endif
+    if (getsockopt(
+            socketDescriptor(),
+            SOL_SOCKET,
+            SO_SNDBUF,
+            reinterpret_cast<char*>(&size),
+            &length) < 0)
+    {
+        return -1;
+    }
+
+    return size;
+}
+
+bool HMulticastSocket::enableDropCounting()
+{
+#ifdef HUPNP_USE_RXQ_OVFL
+    HLOG(H_AT, H_FUN);
+
+    if (socketDescriptor() == -1)
+    {
+        HLOG_WARN("Socket descriptor is invalid.");
+        setSocketError(QAbstractSocket::UnknownSocketError);
+        return false;
+    }
+
+    int enable = 1;
+    if (setsockopt(
+            socketDescriptor(),
+            SOL_SOCKET,
+            SO_RXQ_OVFL,
+            reinterpret_cast<char*>(&enable),
+            sizeof(enable)) < 0)
+    {
+        HLOG_WARN("Could not enable counting the dropped datagrams.");
+        setSocketError(QAbstractSocket::UnknownSocketError);
+        return false;
+    }
+
+    if (h_ptr->m_droppedDatagrams < 0)
+    {
+        h_ptr->m_droppedDatagrams = 0;
+    }
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+qint64 HMulticastSocket::droppedDatagrams() const
+{
+    return h_ptr->m_droppedDatagrams;
+}
+
+qint32 HMulticastSocket::readDatagrams(
+    QList<QByteArray>* datagrams, QList<HEndpoint>* senders,
+    qint32 maxDatagrams)
+{
+    HLOG(H_AT, H_FUN);
+    Q_ASSERT(datagrams);
+    Q_ASSERT(senders);
+
+    if (maxDatagrams <= 0 || !hasPendingDatagrams())
+    {
+        return 0;
+    }
+
+    // the first datagram is always read through QUdpSocket, since that is
+    // what re-enables the read notifications of the socket
+    QHostAddress ha; quint16 port = 0;
+
+    QByteArray buf;
+    buf.resize(pendingDatagramSize() + 1);
+
+    qint64 read = readDatagram(buf.data(), buf.size(), &ha, &port);
+    if (read < 0)
+    {
+        HLOG_WARN(QString("Read failed: %1").arg(errorString()));
+        return 0;
+    }
+
+    buf.resize(read);
+    datagrams->append(buf);
+    senders->append(HEndpoint(ha, port));
+
+    qint32 retVal = 1;
+
+#ifdef HUPNP_USE_RECVMMSG
+    if (h_ptr->m_batchBuffer.isEmpty())
+    {
+        h_ptr->m_batchBuffer.resize(MaxBatchSize * MaxBatchDatagramSize);
+    }
+
+    char* data = h_ptr->m_batchBuffer.data();
+
+    mmsghdr msgs[MaxBatchSize];
+    iovec iovecs[MaxBatchSize];
+    sockaddr_storage addrs[MaxBatchSize];
+#ifdef HUPNP_USE_RXQ_OVFL
+    char controls[MaxBatchSize][CMSG_SPACE(sizeof(quint32))];
+    bool countDrops = h_ptr->m_droppedDatagrams >= 0;
+#endif
+
+    while (retVal < maxDatagrams)
+    {
+        qint32 count = qMin(maxDatagrams - retVal, MaxBatchSize);
+
+        memset(msgs, 0, sizeof(mmsghdr) * count);
+        for (qint32 i = 0; i < count; ++i)
+        {
+            iovecs[i].iov_base = data + i * MaxBatchDatagramSize;
+            iovecs[i].iov_len = MaxBatchDatagramSize;
+            msgs[i].msg_hdr.msg_iov = &iovecs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+            msgs[i].msg_hdr.msg_name = &addrs[i];
+            msgs[i].msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+#ifdef HUPNP_USE_RXQ_OVFL
+            if (countDrops)
+            {
+                msgs[i].msg_hdr.msg_control = controls[i];
+                msgs[i].msg_hdr.msg_controllen = sizeof(controls[i]);
+            }
+#endif
+        }
+
+        int received = ::recvmmsg(
+            socketDescriptor(), msgs, count, MSG_DONTWAIT, 0);
+
+        if (received <= 0)
+        {
+            // either there is nothing more to read or the read failed, in
+            // which case the error is seen again on the next notification
+            break;
+        }
+
+        for (qint32 i = 0; i < received; ++i)
+        {
+#ifdef HUPNP_USE_RXQ_OVFL
+            if (countDrops)
+            {
+                qint64 drops = dropCount(&msgs[i].msg_hdr);
+                if (drops >= 0)
+                {
+                    h_ptr->m_droppedDatagrams = drops;
+                }
+            }
+#endif
+            if (msgs[i].msg_hdr.msg_flags & MSG_TRUNC)
+            {
+                HLOG_WARN("Ignoring a datagram that was truncated.");
+                continue;
+            }
+
+            datagrams->append(QByteArray(
+                data + i * MaxBatchDatagramSize, msgs[i].msg_len));
+
+            senders->append(toEndpoint(addrs[i]));
+            ++retVal;
+        }
+
+        if (received < count)
+        {
+            break;
+        }
+    }
+#else
+    while (retVal < maxDatagrams && hasPendingDatagrams())
+    {
+        buf.resize(pendingDatagramSize() + 1);
+
+        read = readDatagram(buf.data(), buf.size(), &ha, &port);
+        if (read < 0)
+        {
+            HLOG_WARN(QString("Read failed: %1").arg(errorString()));
+            break;
+        }
+
+        buf.resize(read);
+        datagrams->append(buf);
+        senders->append(HEndpoint(ha, port));
+        ++retVal;
+    }
+#endif
+
+    return retVal;
+}
+
+qint32 HMulticastSocket::writeDatagrams(
+    const QList<QByteArray>& datagrams, const HEndpoint& receiver)
+{
+    HLOG(H_AT, H_FUN);
+
+    quint16 port = receiver.portNumber();
+    if (!port) { port = 1900; }
+
+    QHostAddress ha = receiver.hostAddress();
+
+    qint32 retVal = 0;
+
+#ifdef HUPNP_USE_SENDMMSG
+    if (ha.protocol() == QAbstractSocket::IPv4Protocol)
+    {
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(sockaddr_in));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(ha.toIPv4Address());
+
+        mmsghdr msgs[MaxBatchSize];
+        iovec iovecs[MaxBatchSize];
+
+        while (retVal < datagrams.size())
+        {
+            qint32 count = qMin(datagrams.size() - retVal, MaxBatchSize);
+
+            memset(msgs, 0, sizeof(mmsghdr) * count);
+            for (qint32 i = 0; i < count; ++i)
+            {
+                const QByteArray& datagram = datagrams[retVal + i];
+                iovecs[i].iov_base = const_cast<char*>(datagram.constData());
+                iovecs[i].iov_len = datagram.size();
+                msgs[i].msg_hdr.msg_iov = &iovecs[i];
+                msgs[i].msg_hdr.msg_iovlen = 1;
+                msgs[i].msg_hdr.msg_name = &addr;
+                msgs[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+            }
+
+            int sent = ::sendmmsg(socketDescriptor(), msgs, count, 0);
+            if (sent <= 0)
+            {
+                HLOG_DBG(QString("Failed to send datagrams: [%1].").arg(
+                    QString::fromLocal8Bit(strerror(errno))));
+                break;
+            }
+
+            retVal += sent;
+        }
+
+        return retVal;
+    }
+#endif
+
+    foreach(const QByteArray& datagram, datagrams)
+    {
+        if (writeDatagram(datagram, ha, port) == datagram.size())
+        {
+            ++retVal;
+        }
+        else
+        {
+            HLOG_DBG(errorString());
+        }
+    }
+
+    return retVal;
+}
+
 }
 }
@@ -24,6 +24,7 @@
 
 #include <HUpnpCore/HUpnp>
 
+#include <QtCore/QList>
 #include <QtNetwork/QUdpSocket>
 
 namespace Herqq
@@ -141,6 +142,126 @@ public:
      * \return \e true in case the operation succeeded.
      */
     bool bind(quint16 port = 0);
+
+    using QUdpSocket::bind;
+
+    /*!
+     * Attempts to set the size of the receive buffer of the socket.
+     *
+     * A large receive buffer lets the operating system queue a burst of
+     * datagrams, such as the responses to a multicast discovery request,
+     * while the event loop is busy.
+     *
+     * \param bytes specifies the requested size in bytes. The operating
+     * system may adjust the value.
+     *
+     * \return \e true in case the operation succeeded.
+     *
+     * \sa receiveBufferSize()
+     */
+    bool setReceiveBufferSize(qint32 bytes);
+
+    /*!
+     * Returns the size of the receive buffer of the socket.
+     *
+     * \return The size of the receive buffer of the socket in bytes or -1
+     * in case the size could not be determined.
+     *
+     * \sa setReceiveBufferSize()
+     */
+    qint32 receiveBufferSize() const;
+
+    /*!
+     * Attempts to set the size of the send buffer of the socket.
+     *
+     * A large send buffer lets a burst of datagrams, such as the
+     * announcements of a device tree, be queued for sending without
+     * any of them being dropped by the operating system.
+     *
+     * \param bytes specifies the requested size in bytes. The operating
+     * system may adjust the value.
+     *
+     * \return \e true in case the operation succeeded.
+     *
+     * \sa sendBufferSize()
+     */
+    bool setSendBufferSize(qint32 bytes);
+
+    /*!
+     * Returns the size of the send buffer of the socket.
+     *
+     * \return The size of the send buffer of the socket in bytes or -1
+     * in case the size could not be determined.
+     *
+     * \sa setSendBufferSize()
+     */
+    qint32 sendBufferSize() const;
+
+    /*!
+     * Attempts to enable counting the datagrams the operating system drops
+     * because the receive buffer of the socket is full.
+     *
+     * On Linux the count is maintained by the kernel and it is reported
+     * with the datagrams that are read in a batch. The datagrams are dropped
+     * only when the receive buffer is full, in which case the next read is
+     * always a batch. The counting is not supported on other platforms.
+     *
+     * \return \e true in case the counting is supported and it was enabled.
+     *
+     * \sa droppedDatagrams()
+     */
+    bool enableDropCounting();
+
+    /*!
+     * Returns the number of datagrams the operating system has dropped
+     * because the receive buffer of the socket was full.
+     *
+     * \return The number of datagrams dropped since the socket was bound,
+     * as of the last batch read, or -1 in case the counting is not enabled.
+     *
+     * \sa enableDropCounting()
+     */
+    qint64 droppedDatagrams() const;
+
+    /*!
+     * Reads the pending datagrams.
+     *
+     * On Linux the datagrams are read in batches using a single system call
+     * per batch. Elsewhere the datagrams are read one at a time.
+     *
+     * \param datagrams specifies the list to which the read datagrams are
+     * appended. This cannot be null.
+     *
+     * \param senders specifies the list to which the senders of the read
+     * datagrams are appended in the same order. This cannot be null.
+     *
+     * \param maxDatagrams specifies the maximum number of datagrams to read.
+     *
+     * \return The number of datagrams appended to the lists.
+     *
+     * \remarks a datagram larger than 8 kilobytes is discarded when it is
+     * read in a batch.
+     */
+    qint32 readDatagrams(
+        QList<QByteArray>* datagrams, QList<HEndpoint>* senders,
+        qint32 maxDatagrams);
+
+    /*!
+     * Sends the specified datagrams to the specified receiver.
+     *
+     * On Linux the datagrams are sent to an IPv4 receiver in batches using
+     * a single system call per batch. Elsewhere the datagrams are sent
+     * one at a time.
+     *
+     * \param datagrams specifies the datagrams to send.
+     *
+     * \param receiver specifies the receiver of the datagrams. If the
+     * port is not specified, the port 1900 is used.
+     *
+     * \return The number of datagrams that were sent.
+     */
+    qint32 writeDatagrams(
+        const QList<QByteArray>& datagrams, const HEndpoint& receiver);
 };
 
 }
@@ -0,0 +1,240 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hsocket_poller_p.h"
+#include "../general/hlogger_p.h"
+
+#if defined(Q_OS_LINUX)
+#define HUPNP_USE_EPOLL
+#include <sys/epoll.h>
+#elif defined(Q_OS_MAC) || defined(Q_OS_FREEBSD) || \
+      defined(Q_OS_NETBSD) || defined(Q_OS_OPENBSD)
+#define HUPNP_USE_KQUEUE
+#include <sys/types.h>
+#include <sys/event.h>
+#include <sys/time.h>
+#endif
+
+#if defined(HUPNP_USE_EPOLL) || defined(HUPNP_USE_KQUEUE)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <QtCore/QSocketNotifier>
+#include <QtNetwork/QAbstractSocket>
+
+#include <cerrno>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace
+{
+#if defined(HUPNP_USE_EPOLL) || defined(HUPNP_USE_KQUEUE)
+// the maximum number of readiness events read per notification. the rest
+// are read on the following notification, which keeps the event loop
+// responsive when a large number of sockets become ready at once
+const qint32 MaxEventsPerNotification = 64;
+
+int closeDescriptor(int fd)
+{
+    int retVal;
+    do
+    {
+        retVal = ::close(fd);
+    }
+    while (retVal < 0 && errno == EINTR);
+    return retVal;
+}
+#endif
+}
+
+/*******************************************************************************
+ * HSocketPoller
+ ******************************************************************************/
+HSocketPoller::HSocketPoller(QObject* parent) :
+    QObject(parent),
+        m_pollDescriptor(-1), m_notifier(0), m_descriptors()
+{
+#if defined(HUPNP_USE_EPOLL)
+    m_pollDescriptor = ::epoll_create(MaxEventsPerNotification);
+#elif defined(HUPNP_USE_KQUEUE)
+    m_pollDescriptor = ::kqueue();
+#endif
+
+    if (m_pollDescriptor < 0)
+    {
+        return;
+    }
+
+#if defined(HUPNP_USE_EPOLL) || defined(HUPNP_USE_KQUEUE)
+    ::fcntl(m_pollDescriptor, F_SETFD, FD_CLOEXEC);
+#endif
+
+    // the poll descriptor itself is readable whenever any of the watched
+    // sockets is ready
+    m_notifier =
+        new QSocketNotifier(m_pollDescriptor, QSocketNotifier::Read, this);
+
+    bool ok = connect(
+        m_notifier, SIGNAL(activated(int)), this, SLOT(activated()));
+
+    Q_ASSERT(ok); Q_UNUSED(ok)
+}
+
+HSocketPoller::~HSocketPoller()
+{
+    // the descriptors still watched belong to the poller, but the owner
+    // is expected to close them, since it keeps track of them anyway
+    Q_ASSERT(m_descriptors.isEmpty());
+
+    delete m_notifier;
+
+#if defined(HUPNP_USE_EPOLL) || defined(HUPNP_USE_KQUEUE)
+    if (m_pollDescriptor >= 0)
+    {
+        closeDescriptor(m_pollDescriptor);
+    }
+#endif
+}
+
+bool HSocketPoller::isSupported()
+{
+#if defined(HUPNP_USE_EPOLL) || defined(HUPNP_USE_KQUEUE)
+    return true;
+#else
+    return false;
+#endif
+}
+
+qint32 HSocketPoller::take(QAbstractSocket* socket)
+{
+    Q_ASSERT(socket);
+
+    if (!isValid() || socket->state() != QAbstractSocket::ConnectedState)
+    {
+        return -1;
+    }
+
+#if defined(HUPNP_USE_EPOLL) || defined(HUPNP_USE_KQUEUE)
+    // the connection is kept open by the duplicate when the socket closes
+    // its own descriptor
+    int fd = ::fcntl(
+        static_cast<int>(socket->socketDescriptor()), F_DUPFD_CLOEXEC, 0);
+
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+#if defined(HUPNP_USE_EPOLL)
+    // a one-shot registration is disabled once reported, which means the
+    // descriptor is reported exactly once and no other event can be pending
+    // for it by the time the receiver hands it to a new socket
+    epoll_event event;
+    event.events = EPOLLIN | EPOLLRDHUP | EPOLLET | EPOLLONESHOT;
+    event.data.fd = fd;
+
+    if (::epoll_ctl(m_pollDescriptor, EPOLL_CTL_ADD, fd, &event) < 0)
+#else
+    struct kevent event;
+    EV_SET(&event, fd, EVFILT_READ, EV_ADD | EV_ONESHOT | EV_CLEAR, 0, 0, 0);
+
+    if (::kevent(m_pollDescriptor, &event, 1, 0, 0, 0) < 0)
+#endif
+    {
+        closeDescriptor(fd);
+        return -1;
+    }
+
+    socket->abort();
+
+    m_descriptors.insert(fd);
+    return fd;
+#else
+    return -1;
+#endif
+}
+
+void HSocketPoller::close(qint32 socketDescriptor)
+{
+#if defined(HUPNP_USE_EPOLL) || defined(HUPNP_USE_KQUEUE)
+    // closing the descriptor removes it from the epoll or kqueue descriptor,
+    // since there are no other references to the connection left
+    m_descriptors.remove(socketDescriptor);
+    closeDescriptor(socketDescriptor);
+#else
+    Q_UNUSED(socketDescriptor)
+#endif
+}
+
+void HSocketPoller::activated()
+{
+    HLOG(H_AT, H_FUN);
+
+#if defined(HUPNP_USE_EPOLL)
+    epoll_event events[MaxEventsPerNotification];
+
+    int count;
+    do
+    {
+        count = ::epoll_wait(
+            m_pollDescriptor, events, MaxEventsPerNotification, 0);
+    }
+    while (count < 0 && errno == EINTR);
+
+    for (int i = 0; i < count; ++i)
+    {
+        int fd = events[i].data.fd;
+        ::epoll_ctl(m_pollDescriptor, EPOLL_CTL_DEL, fd, 0);
+
+        m_descriptors.remove(fd);
+        emit readyRead(fd);
+    }
+#elif defined(HUPNP_USE_KQUEUE)
+    struct kevent events[MaxEventsPerNotification];
+    struct timespec timeout = { 0, 0 };
+
+    int count;
+    do
+    {
+        count = ::kevent(
+            m_pollDescriptor, 0, 0, events, MaxEventsPerNotification,
+            &timeout);
+    }
+    while (count < 0 && errno == EINTR);
+
+    for (int i = 0; i < count; ++i)
+    {
+        // a one-shot event is deleted once it has been reported
+        qint32 fd = static_cast<qint32>(events[i].ident);
+
+        m_descriptors.remove(fd);
+        emit readyRead(fd);
+    }
+#endif
+}
+
+}
+}
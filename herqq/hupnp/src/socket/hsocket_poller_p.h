@@ -0,0 +1,117 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HSOCKET_POLLER_P_H_
+#define HSOCKET_POLLER_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include "../general/hupnp_defs.h"
+
+#include <QtCore/QSet>
+#include <QtCore/QObject>
+
+class QSocketNotifier;
+class QAbstractSocket;
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+//
+// Watches a large number of idle sockets for incoming data using the native
+// readiness API of the platform, which is epoll on Linux and kqueue on BSD
+// and Mac OS X. The readiness of all the sockets is signaled through a single
+// socket notifier of the event loop and the ready sockets are read in
+// batches, which is why a watched socket costs neither a QObject nor a
+// QSocketNotifier of its own.
+//
+// A socket is taken over from a QAbstractSocket, which is closed. The poller
+// owns the descriptor until it is reported ready, at which point the
+// descriptor is no longer watched and the receiver of the signal owns it.
+//
+// This class is not thread-safe.
+//
+class HSocketPoller :
+    public QObject
+{
+Q_OBJECT
+H_DISABLE_COPY(HSocketPoller)
+
+private:
+
+    qint32 m_pollDescriptor;
+    // the epoll or kqueue descriptor. -1 when not supported.
+
+    QSocketNotifier* m_notifier;
+
+    QSet<qint32> m_descriptors;
+    // the descriptors watched
+
+private Q_SLOTS:
+
+    void activated();
+
+Q_SIGNALS:
+
+    // emitted when a watched socket has data available or it has been
+    // closed by the peer. the receiver takes the ownership of the descriptor.
+    void readyRead(qint32 socketDescriptor);
+
+public:
+
+    explicit HSocketPoller(QObject* parent = 0);
+    virtual ~HSocketPoller();
+
+    // returns true in case a native backend is available on this platform
+    static bool isSupported();
+
+    inline bool isValid() const { return m_pollDescriptor >= 0; }
+
+    inline qint32 count() const { return m_descriptors.size(); }
+
+    //
+    // takes over the descriptor of the specified connected socket, which is
+    // aborted, and starts watching it. returns the descriptor the poller
+    // reports once the socket is ready or -1 in case the socket could not be
+    // taken over, in which case the socket is left intact.
+    //
+    qint32 take(QAbstractSocket* socket);
+
+    //
+    // closes the specified descriptor returned by take(). the descriptor
+    // is no longer watched after this.
+    //
+    void close(qint32 socketDescriptor);
+};
+
+}
+}
+
+#endif /* HSOCKET_POLLER_P_H_ */
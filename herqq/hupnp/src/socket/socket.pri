@@ -1,7 +1,9 @@
 HEADERS += \
     $$SRC_LOC/socket/hmulticast_socket.h \
+    $$SRC_LOC/socket/hsocket_poller_p.h \
     $$SRC_LOC/socket/hendpoint.h
 
 SOURCES += \
     $$SRC_LOC/socket/hendpoint.cpp \
-    $$SRC_LOC/socket/hmulticast_socket.cpp
+    $$SRC_LOC/socket/hmulticast_socket.cpp \
+    $$SRC_LOC/socket/hsocket_poller_p.cpp
@@ -118,22 +118,29 @@ HResourceAvailable::HResourceAvailable(
         // do not define this ==> cannot require it
     }
 
-    if (serverTokens.upnpToken().minorVersion() > 0)
+    if (searchPort < 49152 || searchPort > 65535)
     {
-        if (bootId < 0 || configId < 0)
+        searchPort = -1;
+    }
+
+    // the UPnP version matters only if some of the UDA v1.1 fields are
+    // missing or a search port is specified. this spares parsing the server
+    // tokens of most UDA v1.1 announcements
+    if (bootId < 0 || configId < 0 || searchPort >= 0)
+    {
+        if (serverTokens.upnpToken().minorVersion() > 0)
         {
-            HLOG_WARN("bootId and configId must both be >= 0.");
-            return;
+            if (bootId < 0 || configId < 0)
+            {
+                HLOG_WARN("bootId and configId must both be >= 0.");
+                return;
+            }
         }
-        if (searchPort < 49152 || searchPort > 65535)
+        else
         {
             searchPort = -1;
         }
     }
-    else
-    {
-        searchPort = -1;
-    }
 
     h_ptr->m_serverTokens       = serverTokens;
     h_ptr->m_usn                = usn;
@@ -508,7 +515,12 @@ public: // methods
         }
 
         bool treatAsUpnp1_0 = true;
-        if (!userAgent.hasUpnpToken())
+        if (mx >= 1 && mx <= 5)
+        {
+            // the value is treated the same way by every UPnP version,
+            // which spares parsing the user agent
+        }
+        else if (!userAgent.hasUpnpToken())
         {
             HLOG_WARN_NONSTD(QString("Invalid user agent: [%1]").arg(
                 userAgent.toString()));
@@ -538,9 +550,9 @@ public: // methods
         }
         else
         {
-            if (mx < 1)
+            if (mx < 0)
             {
-                HLOG_WARN("MX cannot be smaller than 1");
+                HLOG_WARN("MX cannot be negative");
                 return false;
             }
             else if (mx > 5)
@@ -691,13 +703,11 @@ HDiscoveryResponse::HDiscoveryResponse(
         return;
     }
 
-    if (serverTokens.upnpToken().minorVersion() > 0)
+    if ((bootId < 0 || configId < 0) &&
+        serverTokens.upnpToken().minorVersion() > 0)
     {
-        if (bootId < 0 || configId < 0)
-        {
-            HLOG_WARN("bootId and configId must both be positive.");
-            return;
-        }
+        HLOG_WARN("bootId and configId must both be positive.");
+        return;
     }
 
     h_ptr->m_serverTokens       = serverTokens;
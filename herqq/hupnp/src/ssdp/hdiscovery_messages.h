@@ -609,7 +609,9 @@ public:
      * object will be invalid, i.e. isValid() returns false in case the provided
      * information is invalid.
      *
-     * \param mx specifies the maximum wait time in seconds.
+     * \param mx specifies the maximum wait time in seconds. Zero denotes
+     * a unicast request, which has no MX header field and which is answered
+     * immediately.
      *
      * \param resource specifies the Search Target (ST). If the object is invalid,
      * the created object will be invalid.
@@ -618,7 +620,7 @@ public:
      *
      * \remarks
      * - if userAgent identifies a UPnP v1.1 requester:
-     *   - if mx is smaller than 1 it is set to 1 and
+     *   - if mx is smaller than 0 the object is invalid and
      *   - if mx is larger than 5 it it set to 5.
      * - if userAgent does not specify UPnP version (it always should however) or
      * the userAgent identifies a UPnP v1.0 requester:
@@ -677,7 +679,8 @@ public:
      * this many seconds to balance load for the control point when it
      * processes responses</em>.
      *
-     * \return The maximum wait time in seconds.
+     * \return The maximum wait time in seconds. Zero denotes a unicast
+     * request, which is answered immediately.
      */
     qint32 mx() const;
 
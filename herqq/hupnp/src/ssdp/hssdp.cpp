@@ -21,6 +21,8 @@
 
 #include "hssdp.h"
 #include "hssdp_p.h"
+#include "hssdp_hub_p.h"
+#include "hssdp_receiver_p.h"
 #include "hdiscovery_messages.h"
 #include "hssdp_messagecreator_p.h"
 
@@ -29,7 +31,10 @@
 
 #include "../socket/hendpoint.h"
 
+#include "../http/hhttp_utils_p.h"
+
 #include "../general/hlogger_p.h"
+#include "../general/htrafficcapture_p.h"
 #include "../utils/hmisc_utils_p.h"
 
 #include <QtCore/QUrl>
@@ -143,6 +148,173 @@ inline HEndpoint multicastEndpoint()
     static HEndpoint retVal = HEndpoint("239.255.255.250:1900");
     return retVal;
 }
+
+inline qint32 defaultReceiveBufferSize()
+{
+    const qint32 retVal = 256 * 1024;
+    return retVal;
+}
+
+// the maximum number of datagrams processed per read notification.
+// the rest are processed on the following notification, which keeps
+// the event loop responsive during a long burst
+inline qint32 maxDatagramsPerNotification()
+{
+    const qint32 retVal = 128;
+    return retVal;
+}
+
+inline bool startsWith(const QByteArray& data, const char* prefix)
+{
+    const qint32 length = static_cast<qint32>(qstrlen(prefix));
+    return data.size() >= length &&
+           qstrnicmp(data.constData(), prefix, length) == 0;
+}
+
+// the view does not have to be null-terminated
+inline bool equals(const QByteArray& view, const char* str)
+{
+    const qint32 length = static_cast<qint32>(qstrlen(str));
+    return view.size() == length &&
+           qstrnicmp(view.constData(), str, length) == 0;
+}
+
+inline bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+//
+// Returns the value of the specified header field as a view to the message
+// data. Only the lines up to the field are examined, no header object is
+// created and no memory is allocated. The message has to outlive the view.
+//
+QByteArray fieldView(const QByteArray& msg, const char* name)
+{
+    const char* data = msg.constData();
+    const qint32 size = msg.size();
+    const qint32 nameLength = static_cast<qint32>(qstrlen(name));
+
+    // skip the request / status line
+    qint32 lineStart = msg.indexOf('\n') + 1;
+    while (lineStart > 0 && lineStart < size)
+    {
+        qint32 lineEnd = msg.indexOf('\n', lineStart);
+        if (lineEnd < 0)
+        {
+            lineEnd = size;
+        }
+
+        qint32 valueEnd = lineEnd;
+        while (valueEnd > lineStart && isSpace(data[valueEnd - 1]))
+        {
+            --valueEnd;
+        }
+
+        if (valueEnd == lineStart)
+        {
+            // the empty line terminating the header
+            break;
+        }
+
+        if (valueEnd - lineStart > nameLength &&
+            data[lineStart + nameLength] == ':' &&
+            qstrnicmp(data + lineStart, name, nameLength) == 0)
+        {
+            qint32 valueStart = lineStart + nameLength + 1;
+            while (valueStart < valueEnd && isSpace(data[valueStart]))
+            {
+                ++valueStart;
+            }
+
+            return QByteArray::fromRawData(
+                data + valueStart, valueEnd - valueStart);
+        }
+
+        lineStart = lineEnd + 1;
+    }
+
+    return QByteArray();
+}
+
+inline qint32 toInt(const QByteArray& value)
+{
+    bool ok = false;
+    qint32 retVal = value.toInt(&ok);
+    return ok ? retVal : -1;
+}
+
+// returns the type of the specified serialized message or HSsdp::None in
+// case the message is not an SSDP message
+HSsdp::AllowedMessage messageType(const QByteArray& msg)
+{
+    if (startsWith(msg, "NOTIFY * HTTP/1.1"))
+    {
+        QByteArray nts = fieldView(msg, "NTS");
+        if (equals(nts, "ssdp:alive"))
+        {
+            return HSsdp::DeviceAvailable;
+        }
+        else if (equals(nts, "ssdp:byebye"))
+        {
+            return HSsdp::DeviceUnavailable;
+        }
+        else if (equals(nts, "ssdp:update"))
+        {
+            return HSsdp::DeviceUpdate;
+        }
+    }
+    else if (startsWith(msg, "M-SEARCH * HTTP/1.1"))
+    {
+        return HSsdp::DiscoveryRequest;
+    }
+    else if (startsWith(msg, "HTTP/1.1 200"))
+    {
+        return HSsdp::DiscoveryResponse;
+    }
+
+    return HSsdp::None;
+}
+
+// returns the index of the counters of the specified message type or -1 in
+// case the value is not a single message type
+inline qint32 counterIndex(HSsdp::AllowedMessage type)
+{
+    switch(type)
+    {
+    case HSsdp::DeviceAvailable:
+        return 0;
+    case HSsdp::DeviceUpdate:
+        return 1;
+    case HSsdp::DeviceUnavailable:
+        return 2;
+    case HSsdp::DiscoveryRequest:
+        return 3;
+    case HSsdp::DiscoveryResponse:
+        return 4;
+    default:
+        return -1;
+    }
+}
+
+// returns the USN, the location, the boot ID and the config ID of an
+// announcement or a discovery response as one key, or an empty array
+// in case the message has no USN
+QByteArray repeatKeyOf(const QByteArray& msg)
+{
+    QByteArray usn = fieldView(msg, "USN");
+    if (usn.isEmpty())
+    {
+        return QByteArray();
+    }
+
+    QByteArray retVal(usn.constData(), usn.size());
+    retVal.append('\n').append(fieldView(msg, "LOCATION"));
+    retVal.append('\n').append(fieldView(msg, "BOOTID.UPNP.ORG"));
+    retVal.append('\n').append(fieldView(msg, "CONFIGID.UPNP.ORG"));
+
+    return retVal;
+}
 }
 
 /*******************************************************************************
@@ -152,11 +324,26 @@ HSsdpPrivate::HSsdpPrivate(
     HSsdp* qptr, const QByteArray& loggingIdentifier) :
         m_loggingIdentifier(loggingIdentifier),
         m_multicastSocket(0),
+        m_useReceiveThread(false),
+        m_receiveThread(0),
+        m_shareMulticast(false),
+        m_multicastHub(0),
         m_unicastSocket  (0),
+        m_receiveBufferSize(defaultReceiveBufferSize()),
+        m_sendBufferSize(0),
         q_ptr            (qptr),
         m_allowedMessages(HSsdp::All),
-        m_lastError()
+        m_repeatFilter(0),
+        m_repeatKey(),
+        m_lastError(),
+        m_batchDelivery(false),
+        m_batch()
 {
+    for (qint32 i = 0; i < 5; ++i)
+    {
+        m_messagesReceived[i] = 0;
+        m_messagesSent[i] = 0;
+    }
 }
 
 HSsdpPrivate::~HSsdpPrivate()
@@ -164,25 +351,24 @@ HSsdpPrivate::~HSsdpPrivate()
     clear();
 }
 
-bool HSsdpPrivate::parseCacheControl(const QString& str, qint32* retVal)
+bool HSsdpPrivate::parseCacheControl(const QByteArray& value, qint32* retVal)
 {
-    bool ok = false;
-
-    QString cacheControl = str.simplified();
-    QStringList slist = cacheControl.split('=');
-
-    if (slist.size() != 2 || slist[0].simplified() != "max-age")
+    qint32 index = value.indexOf('=');
+    if (index < 0 || value.left(index).trimmed() != "max-age")
     {
-        m_lastError =
-            QString("Invalid Cache-Control field value: %1").arg(str);
+        m_lastError = QString("Invalid Cache-Control field value: %1").arg(
+            QString::fromUtf8(value));
+
         return false;
     }
 
-    qint32 maxAge = slist[1].simplified().toInt(&ok);
+    bool ok = false;
+    qint32 maxAge = value.mid(index + 1).trimmed().toInt(&ok);
     if (!ok)
     {
-        m_lastError =
-            QString("Invalid Cache-Control field value: %1").arg(str);
+        m_lastError = QString("Invalid Cache-Control field value: %1").arg(
+            QString::fromUtf8(value));
+
         return false;
     }
 
@@ -190,13 +376,14 @@ bool HSsdpPrivate::parseCacheControl(const QString& str, qint32* retVal)
     return true;
 }
 
-bool HSsdpPrivate::checkHost(const QString& host)
+bool HSsdpPrivate::checkHost(const QByteArray& host)
 {
-    QStringList slist = host.split(':');
-    if (slist.size() < 1 || slist[0].simplified() != "239.255.255.250")
+    qint32 index = host.indexOf(':');
+    if ((index < 0 ? host : host.left(index)).trimmed() != "239.255.255.250")
     {
-        m_lastError =
-            QString("HOST header field is invalid: %1").arg(host);
+        m_lastError = QString("HOST header field is invalid: %1").arg(
+            QString::fromUtf8(host));
+
         return false;
     }
 
@@ -206,24 +393,14 @@ bool HSsdpPrivate::checkHost(const QString& host)
 bool HSsdpPrivate::parseDiscoveryResponse(
     const HHttpResponseHeader& hdr, HDiscoveryResponse* retVal)
 {
-    QString   cacheControl  = hdr.value("CACHE-CONTROL");
-    QDateTime date          = QDateTime::fromString(hdr.value("DATE"));
-    QUrl      location      = hdr.value("LOCATION");
-    QString   server        = hdr.value("SERVER");
-    //QString   st            = hdr.value("ST");
-    QString   usn           = hdr.value("USN");
-    QString   bootIdStr     = hdr.value("BOOTID.UPNP.ORG");
-    QString   configIdStr   = hdr.value("CONFIGID.UPNP.ORG");
-    QString   searchPortStr = hdr.value("SEARCHPORT.UPNP.ORG");
-
-    if (!hdr.hasKey("EXT"))
+    if (!hdr.hasKey(HHttpHeader::Field_Ext))
     {
         m_lastError = QString("EXT field is missing:\n%1").arg(
             hdr.toString());
 
         return false;
     }
-    else if (!hdr.value("EXT").isEmpty())
+    else if (!hdr.rawValue(HHttpHeader::Field_Ext).isEmpty())
     {
         m_lastError =
             QString("EXT field is not empty, although it should be:\n%1").
@@ -233,75 +410,68 @@ bool HSsdpPrivate::parseDiscoveryResponse(
     }
 
     qint32 maxAge;
-    if (!parseCacheControl(cacheControl, &maxAge))
+    if (!parseCacheControl(
+            hdr.rawValue(HHttpHeader::Field_CacheControl), &maxAge))
     {
         return false;
     }
 
-    bool ok = false;
-    qint32 bootId = bootIdStr.toInt(&ok);
-    if (!ok)
-    {
-        bootId = -1;
-    }
-
-    qint32 configId = configIdStr.toInt(&ok);
-    if (!ok)
-    {
-        configId = -1;
-    }
-
-    qint32 searchPort = searchPortStr.toInt(&ok);
-    if (!ok)
-    {
-        searchPort = -1;
-    }
+    qint32 configId = hdr.hasKey(HHttpHeader::Field_ConfigId) ?
+        toInt(hdr.rawValue(HHttpHeader::Field_ConfigId)) : 0;
+    // ^^ configid is optional even in UDA v1.1 ==> cannot provide -1
+    // unless the header field is specified and the value is invalid
 
+    // the DATE field is not parsed, since HDiscoveryResponse does not use
+    // the date it is given
     *retVal = HDiscoveryResponse(
         maxAge,
-        date,
-        location,
-        HProductTokens(server),
-        HDiscoveryType(usn, LooseChecks),
-        bootId,
-        hdr.hasKey("CONFIGID.UPNP.ORG") ? configId : 0,
-        // ^^ configid is optional even in UDA v1.1 ==> cannot provide -1
-        // unless the header field is specified and the value is invalid
-        searchPort);
+        QDateTime(),
+        QUrl(hdr.value(HHttpHeader::Field_Location)),
+        HProductTokens(hdr.value(HHttpHeader::Field_Server)),
+        HDiscoveryType(hdr.value(HHttpHeader::Field_Usn), LooseChecks),
+        toInt(hdr.rawValue(HHttpHeader::Field_BootId)),
+        configId,
+        toInt(hdr.rawValue(HHttpHeader::Field_SearchPort)));
 
     return retVal->isValid(LooseChecks);
 }
 
 bool HSsdpPrivate::parseDiscoveryRequest(
-    const HHttpRequestHeader& hdr, HDiscoveryRequest* retVal)
+    const HHttpRequestHeader& hdr, bool unicast, HDiscoveryRequest* retVal)
 {
-    QString host = hdr.value("HOST");
-    QString man  = hdr.value("MAN").simplified();
+    QByteArray man = hdr.rawValue(HHttpHeader::Field_Man).simplified();
 
     bool ok = false;
-    qint32 mx = hdr.value("MX").toInt(&ok);
+    qint32 mx = hdr.rawValue(HHttpHeader::Field_Mx).toInt(&ok);
 
     if (!ok)
     {
-        m_lastError = QString("MX is not specified.");
-        return false;
+        if (!unicast || hdr.hasKey(HHttpHeader::Field_Mx))
+        {
+            m_lastError = QString("MX is not specified.");
+            return false;
+        }
+        mx = 0;
+        // a unicast M-SEARCH has no MX and it is answered immediately
     }
 
-    QString st = hdr.value("ST");
-    QString ua = hdr.value("USER-AGENT");
-
-    checkHost(host);
+    if (!unicast)
+    {
+        checkHost(hdr.rawValue(HHttpHeader::Field_Host));
+    }
 
-    if (man.compare(QString("\"ssdp:discover\""), Qt::CaseInsensitive) != 0)
+    if (!equals(man, "\"ssdp:discover\""))
     {
-        m_lastError =
-            QString("MAN header field is invalid: [%1].").arg(man);
+        m_lastError = QString("MAN header field is invalid: [%1].").arg(
+            QString::fromUtf8(man));
 
         return false;
     }
 
     *retVal = HDiscoveryRequest(
-        mx, HDiscoveryType(st, LooseChecks), HProductTokens(ua));
+        mx,
+        HDiscoveryType(hdr.value(HHttpHeader::Field_St), LooseChecks),
+        HProductTokens(hdr.value(HHttpHeader::Field_UserAgent)));
 
     return retVal->isValid(LooseChecks);
 }
@@ -309,51 +479,23 @@ bool HSsdpPrivate::parseDiscoveryRequest(
 bool HSsdpPrivate::parseDeviceAvailable(
     const HHttpRequestHeader& hdr, HResourceAvailable* retVal)
 {
-    QString host          = hdr.value("HOST");
-    QString server        = hdr.value("SERVER");
-    QString usn           = hdr.value("USN");
-    //QString nt            = hdr.value("NT");
-    QUrl    location      = hdr.value("LOCATION");
-    QString cacheControl  = hdr.value("CACHE-CONTROL");
-    QString bootIdStr     = hdr.value("BOOTID.UPNP.ORG");
-    QString configIdStr   = hdr.value("CONFIGID.UPNP.ORG");
-    QString searchPortStr = hdr.value("SEARCHPORT.UPNP.ORG");
-
     qint32 maxAge;
-    if (!parseCacheControl(cacheControl, &maxAge))
+    if (!parseCacheControl(
+            hdr.rawValue(HHttpHeader::Field_CacheControl), &maxAge))
     {
         return false;
     }
 
-    bool ok = false;
-    qint32 bootId = bootIdStr.toInt(&ok);
-    if (!ok)
-    {
-        bootId = -1;
-    }
-
-    qint32 configId = configIdStr.toInt(&ok);
-    if (!ok)
-    {
-        configId = -1;
-    }
-
-    checkHost(host);
-
-    qint32 searchPort = searchPortStr.toInt(&ok);
-    if (!ok)
-    {
-        searchPort = -1;
-    }
+    checkHost(hdr.rawValue(HHttpHeader::Field_Host));
 
     *retVal = HResourceAvailable(
         maxAge,
-        location,
-        HProductTokens(server),
-        HDiscoveryType(usn, LooseChecks),
-        bootId,
-        configId,
-        searchPort);
+        QUrl(hdr.value(HHttpHeader::Field_Location)),
+        HProductTokens(hdr.value(HHttpHeader::Field_Server)),
+        HDiscoveryType(hdr.value(HHttpHeader::Field_Usn), LooseChecks),
+        toInt(hdr.rawValue(HHttpHeader::Field_BootId)),
+        toInt(hdr.rawValue(HHttpHeader::Field_ConfigId)),
+        toInt(hdr.rawValue(HHttpHeader::Field_SearchPort)));
 
     return retVal->isValid(LooseChecks);
 }
@@ -361,29 +503,12 @@ bool HSsdpPrivate::parseDeviceAvailable(
 bool HSsdpPrivate::parseDeviceUnavailable(
     const HHttpRequestHeader& hdr, HResourceUnavailable* retVal)
 {
-    QString host        = hdr.value("HOST");
-    //QString nt          = hdr.value("NT");
-    QString usn         = hdr.value("USN");
-    QString bootIdStr   = hdr.value("BOOTID.UPNP.ORG");
-    QString configIdStr = hdr.value("CONFIGID.UPNP.ORG");
-
-    bool ok = false;
-    qint32 bootId = bootIdStr.toInt(&ok);
-    if (!ok)
-    {
-        bootId = -1;
-    }
-
-    qint32 configId = configIdStr.toInt(&ok);
-    if (!ok)
-    {
-        configId = -1;
-    }
-
-    checkHost(host);
+    checkHost(hdr.rawValue(HHttpHeader::Field_Host));
 
     *retVal = HResourceUnavailable(
-        HDiscoveryType(usn, LooseChecks), bootId, configId);
+        HDiscoveryType(hdr.value(HHttpHeader::Field_Usn), LooseChecks),
+        toInt(hdr.rawValue(HHttpHeader::Field_BootId)),
+        toInt(hdr.rawValue(HHttpHeader::Field_ConfigId)));
 
     return retVal->isValid(LooseChecks);
 }
@@ -391,51 +516,30 @@ bool HSsdpPrivate::parseDeviceUnavailable(
 bool HSsdpPrivate::parseDeviceUpdate(
     const HHttpRequestHeader& hdr, HResourceUpdate* retVal)
 {
-    QString host          = hdr.value("HOST");
-    QUrl    location      = hdr.value("LOCATION");
-    //QString nt            = hdr.value("NT");
-    QString usn           = hdr.value("USN");
-    QString bootIdStr     = hdr.value("BOOTID.UPNP.ORG");
-    QString configIdStr   = hdr.value("CONFIGID.UPNP.ORG");
-    QString nextBootIdStr = hdr.value("NEXTBOOTID.UPNP.ORG");
-    QString searchPortStr = hdr.value("SEARCHPORT.UPNP.ORG");
-
-    bool ok = false;
-    qint32 bootId = bootIdStr.toInt(&ok);
-    if (!ok)
-    {
-        bootId = -1;
-    }
+    checkHost(hdr.rawValue(HHttpHeader::Field_Host));
 
-    qint32 configId = configIdStr.toInt(&ok);
-    if (!ok)
-    {
-        configId = -1;
-    }
+    *retVal = HResourceUpdate(
+        QUrl(hdr.value(HHttpHeader::Field_Location)),
+        HDiscoveryType(hdr.value(HHttpHeader::Field_Usn), LooseChecks),
+        toInt(hdr.rawValue(HHttpHeader::Field_BootId)),
+        toInt(hdr.rawValue(HHttpHeader::Field_ConfigId)),
+        toInt(hdr.rawValue(HHttpHeader::Field_NextBootId)),
+        toInt(hdr.rawValue(HHttpHeader::Field_SearchPort)));
 
-    qint32 nextBootId = nextBootIdStr.toInt(&ok);
-    if (!ok)
-    {
-        nextBootId = -1;
-    }
+    return retVal->isValid(LooseChecks);
+}
 
-    qint32 searchPort = searchPortStr.toInt(&ok);
-    if (!ok)
+bool HSsdpPrivate::handleRepeat(const QByteArray& msg, const HEndpoint& source)
+{
+    if (!m_repeatFilter)
     {
-        searchPort = -1;
+        m_repeatKey.clear();
+        return false;
     }
 
-    checkHost(host);
-
-    *retVal = HResourceUpdate(
-        location,
-        HDiscoveryType(usn, LooseChecks),
-        bootId,
-        configId,
-        nextBootId,
-        searchPort);
-
-    return retVal->isValid(LooseChecks);
+    m_repeatKey = repeatKeyOf(msg);
+    return !m_repeatKey.isEmpty() &&
+           m_repeatFilter->handleRepeat(m_repeatKey, source);
 }
 
 bool HSsdpPrivate::send(const QByteArray& data, const HEndpoint& receiver)
@@ -448,13 +552,88 @@ bool HSsdpPrivate::send(const QByteArray& data, const HEndpoint& receiver)
     qint64 retVal = m_unicastSocket->writeDatagram(
         data, receiver.hostAddress(), port);
 
-    return retVal == data.size();
+    if (retVal != data.size())
+    {
+        return false;
+    }
+
+    countSent(data);
+    capture(data, HEndpoint(receiver.hostAddress(), port));
+    return true;
+}
+
+qint32 HSsdpPrivate::send(
+    const QList<QByteArray>& datagrams, const HEndpoint& receiver)
+{
+    Q_ASSERT(isInitialized());
+
+    qint32 retVal = m_unicastSocket->writeDatagrams(datagrams, receiver);
+    for (qint32 i = 0; i < retVal; ++i)
+    {
+        countSent(datagrams[i]);
+        capture(datagrams[i], receiver);
+    }
+
+    return retVal;
+}
+
+void HSsdpPrivate::capture(
+    const QByteArray& datagram, const HEndpoint& receiver)
+{
+    if (HTrafficRecorder::isEnabled())
+    {
+        HTrafficRecorder::record(
+            HTrafficCaptureReader::Ssdp, HTrafficCaptureReader::Outbound,
+            HEndpoint(
+                m_unicastSocket->localAddress(), m_unicastSocket->localPort()),
+            receiver, datagram);
+    }
+}
+
+void HSsdpPrivate::countReceived(HSsdp::AllowedMessage type)
+{
+    qint32 index = counterIndex(type);
+    if (index >= 0)
+    {
+        ++m_messagesReceived[index];
+    }
+}
+
+void HSsdpPrivate::countSent(const QByteArray& datagram)
+{
+    qint32 index = counterIndex(messageType(datagram));
+    if (index >= 0)
+    {
+        ++m_messagesSent[index];
+    }
+}
+
+qint32 HSsdpPrivate::announce(const QList<QByteArray>& datagrams)
+{
+    if (!isInitialized())
+    {
+        return -1;
+    }
+
+    return send(datagrams, multicastEndpoint());
 }
 
-void HSsdpPrivate::processResponse(const QString& msg, const HEndpoint& source)
+void HSsdpPrivate::processResponse(
+    const QByteArray& msg, const HEndpoint& source, HTraceSpan& span)
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
+    if (startsWith(msg, "HTTP/1.1 200"))
+    {
+        countReceived(HSsdp::DiscoveryResponse);
+    }
+
+    if (!(m_allowedMessages & HSsdp::DiscoveryResponse) ||
+        handleRepeat(msg, source))
+    {
+        return;
+    }
+
     HHttpResponseHeader hdr(msg);
     if (!hdr.isValid())
     {
@@ -462,112 +641,191 @@ void HSsdpPrivate::processResponse(const QString& msg, const HEndpoint& source)
         return;
     }
 
-    if (m_allowedMessages & HSsdp::DiscoveryResponse)
+    HDiscoveryResponse rcvdMsg;
+    if (!parseDiscoveryResponse(hdr, &rcvdMsg))
     {
-        HDiscoveryResponse rcvdMsg;
-        if (!parseDiscoveryResponse(hdr, &rcvdMsg))
-        {
-            HLOG_WARN(QString("Ignoring invalid message from [%1]: %2").arg(
-                source.toString(), msg));
-        }
-        else if (!q_ptr->incomingDiscoveryResponse(rcvdMsg, source))
+        HLOG_WARN(QString("Ignoring invalid message from [%1]: %2").arg(
+            source.toString(), QString::fromUtf8(msg)));
+    }
+    else if (m_batchDelivery)
+    {
+        m_batch.append(HSsdpMessage(rcvdMsg, source));
+    }
+    else
+    {
+        span.next("dispatch");
+        if (!q_ptr->incomingDiscoveryResponse(rcvdMsg, source))
         {
             emit q_ptr->discoveryResponseReceived(rcvdMsg, source);
         }
     }
 }
 
-void HSsdpPrivate::processNotify(const QString& msg, const HEndpoint& source)
+void HSsdpPrivate::processNotify(
+    const QByteArray& msg, const HEndpoint& source, HTraceSpan& span)
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
-    HHttpRequestHeader hdr(msg);
+    // the announcement type is checked from the raw data, since most of the
+    // announcements are filtered and parsing those would be wasted effort
+    QByteArray nts = fieldView(msg, "NTS");
+
+    HSsdp::AllowedMessage type;
+    if (equals(nts, "ssdp:alive"))
+    {
+        type = HSsdp::DeviceAvailable;
+    }
+    else if (equals(nts, "ssdp:byebye"))
+    {
+        type = HSsdp::DeviceUnavailable;
+    }
+    else if (equals(nts, "ssdp:update"))
+    {
+        type = HSsdp::DeviceUpdate;
+    }
+    else
+    {
+        HLOG_WARN(QString(
+            "Ignoring an invalid SSDP presence announcement: [%1].").arg(
+                QString::fromUtf8(nts)));
+        return;
+    }
+
+    countReceived(type);
+
+    if (!(m_allowedMessages & type))
+    {
+        return;
+    }
+
+    if (type == HSsdp::DeviceAvailable && handleRepeat(msg, source))
+    {
+        return;
+    }
+
+    HHttpRequestHeader hdr = requestHeader(msg);
     if (!hdr.isValid())
     {
         HLOG_WARN("Ignoring an invalid HTTP NOTIFY request.");
         return;
     }
 
-    QString nts = hdr.value("NTS");
-    if (nts.compare(QString("ssdp:alive"), Qt::CaseInsensitive) == 0)
+    switch(type)
     {
-        if (m_allowedMessages & HSsdp::DeviceAvailable)
+    case HSsdp::DeviceAvailable:
         {
             HResourceAvailable rcvdMsg;
             if (!parseDeviceAvailable(hdr, &rcvdMsg))
             {
                 HLOG_WARN(QString(
-                    "Ignoring an invalid ssdp:alive announcement:\n%1").arg(msg));
+                    "Ignoring an invalid ssdp:alive announcement:\n%1").arg(
+                        QString::fromUtf8(msg)));
+            }
+            else if (m_batchDelivery)
+            {
+                m_batch.append(HSsdpMessage(rcvdMsg, source));
             }
-            else if (!q_ptr->incomingDeviceAvailableAnnouncement(rcvdMsg, source))
+            else
             {
-                emit q_ptr->resourceAvailableReceived(rcvdMsg, source);
+                span.next("dispatch");
+                if (!q_ptr->incomingDeviceAvailableAnnouncement(
+                        rcvdMsg, source))
+                {
+                    emit q_ptr->resourceAvailableReceived(rcvdMsg, source);
+                }
             }
         }
-    }
-    else if (nts.compare(QString("ssdp:byebye"), Qt::CaseInsensitive) == 0)
-    {
-        if (m_allowedMessages & HSsdp::DeviceUnavailable)
+        break;
+
+    case HSsdp::DeviceUnavailable:
         {
             HResourceUnavailable rcvdMsg;
             if (!parseDeviceUnavailable(hdr, &rcvdMsg))
             {
                 HLOG_WARN(QString(
-                    "Ignoring an invalid ssdp:byebye announcement:\n%1").arg(msg));
+                    "Ignoring an invalid ssdp:byebye announcement:\n%1").arg(
+                        QString::fromUtf8(msg)));
+            }
+            else if (m_batchDelivery)
+            {
+                m_batch.append(HSsdpMessage(rcvdMsg, source));
             }
-            else if (!q_ptr->incomingDeviceUnavailableAnnouncement(rcvdMsg, source))
+            else
             {
-                emit q_ptr->resourceUnavailableReceived(rcvdMsg, source);
+                span.next("dispatch");
+                if (!q_ptr->incomingDeviceUnavailableAnnouncement(
+                        rcvdMsg, source))
+                {
+                    emit q_ptr->resourceUnavailableReceived(rcvdMsg, source);
+                }
             }
         }
-    }
-    else if (nts.compare(QString("ssdp:update"), Qt::CaseInsensitive) == 0)
-    {
-        if (m_allowedMessages & HSsdp::DeviceUpdate)
+        break;
+
+    default:
         {
             HResourceUpdate rcvdMsg;
             if (!parseDeviceUpdate(hdr, &rcvdMsg))
             {
                 HLOG_WARN(QString(
-                    "Ignoring invalid ssdp:update announcement:\n%1").arg(msg));
+                    "Ignoring invalid ssdp:update announcement:\n%1").arg(
+                        QString::fromUtf8(msg)));
             }
-            else if (!q_ptr->incomingDeviceUpdateAnnouncement(rcvdMsg, source))
+            else if (m_batchDelivery)
             {
-                emit q_ptr->deviceUpdateReceived(rcvdMsg, source);
+                m_batch.append(HSsdpMessage(rcvdMsg, source));
+            }
+            else
+            {
+                span.next("dispatch");
+                if (!q_ptr->incomingDeviceUpdateAnnouncement(rcvdMsg, source))
+                {
+                    emit q_ptr->deviceUpdateReceived(rcvdMsg, source);
+                }
             }
         }
-    }
-    else
-    {
-        HLOG_WARN(QString(
-            "Ignoring an invalid SSDP presence announcement: [%1].").arg(nts));
+        break;
     }
 }
 
 void HSsdpPrivate::processSearch(
-    const QString& msg, const HEndpoint& source, const HEndpoint& destination)
+    const QByteArray& msg, const HEndpoint& source,
+    const HEndpoint& destination, HTraceSpan& span)
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
-    HHttpRequestHeader hdr(msg);
+    countReceived(HSsdp::DiscoveryRequest);
+
+    if (!(m_allowedMessages & HSsdp::DiscoveryRequest))
+    {
+        return;
+    }
+
+    HHttpRequestHeader hdr = requestHeader(msg);
     if (!hdr.isValid())
     {
         HLOG_WARN("Ignoring an invalid HTTP M-SEARCH request.");
         return;
     }
 
-    if (m_allowedMessages & HSsdp::DiscoveryRequest)
-    {
-        HSsdp::DiscoveryRequestMethod type = destination.isMulticast() ?
-            HSsdp::MulticastDiscovery : HSsdp::UnicastDiscovery;
+    HSsdp::DiscoveryRequestMethod type = destination.isMulticast() ?
+        HSsdp::MulticastDiscovery : HSsdp::UnicastDiscovery;
 
-        HDiscoveryRequest rcvdMsg;
-        if (!parseDiscoveryRequest(hdr, &rcvdMsg))
-        {
-            HLOG_WARN(QString("Ignoring invalid message from [%1]: %2").arg(
-                source.toString(), msg));
-        }
-        else if (!q_ptr->incomingDiscoveryRequest(rcvdMsg, source, type))
+    HDiscoveryRequest rcvdMsg;
+    if (!parseDiscoveryRequest(
+            hdr, type == HSsdp::UnicastDiscovery, &rcvdMsg))
+    {
+        HLOG_WARN(QString("Ignoring invalid message from [%1]: %2").arg(
+            source.toString(), QString::fromUtf8(msg)));
+    }
+    else if (m_batchDelivery)
+    {
+        m_batch.append(HSsdpMessage(rcvdMsg, source, type));
+    }
+    else
+    {
+        span.next("dispatch");
+        if (!q_ptr->incomingDiscoveryRequest(rcvdMsg, source, type))
         {
             emit q_ptr->discoveryRequestReceived(rcvdMsg, source, type);
         }
@@ -583,8 +841,14 @@ void HSsdpPrivate::clear()
         m_multicastSocket->leaveMulticastGroup(
             multicastAddress(), m_unicastSocket->localAddress());
     }
+    if (m_multicastHub)
+    {
+        HSsdpMulticastHub::detach(this, m_multicastHub); m_multicastHub = 0;
+    }
+    delete m_receiveThread; m_receiveThread = 0;
     delete m_unicastSocket; m_unicastSocket = 0;
     delete m_multicastSocket; m_multicastSocket = 0;
+    m_batch.clear();
 }
 
 bool HSsdpPrivate::init(const QHostAddress& addressToBind)
@@ -592,34 +856,58 @@ bool HSsdpPrivate::init(const QHostAddress& addressToBind)
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
     Q_ASSERT(!isInitialized());
 
-    m_multicastSocket = new HMulticastSocket(q_ptr);
-    m_unicastSocket   = new QUdpSocket(q_ptr);
+    m_unicastSocket = new HMulticastSocket(q_ptr);
 
     bool ok = QObject::connect(
-        m_multicastSocket, SIGNAL(readyRead()),
-        q_ptr, SLOT(multicastMessageReceived()));
-
-    Q_ASSERT(ok); Q_UNUSED(ok)
-
-    ok = QObject::connect(
         m_unicastSocket, SIGNAL(readyRead()),
         q_ptr, SLOT(unicastMessageReceived()));
 
-    Q_ASSERT(ok);
+    Q_ASSERT(ok); Q_UNUSED(ok)
 
-    if (!m_multicastSocket->bind(1900))
+    if (m_useReceiveThread)
     {
-        HLOG_WARN("Failed to bind multicast socket for listening");
-        return false;
+        m_receiveThread = new HSsdpReceiveThread(m_loggingIdentifier, q_ptr);
+        if (!m_receiveThread->startReceiving(addressToBind, m_receiveBufferSize))
+        {
+            clear();
+            return false;
+        }
     }
-
-    if (!m_multicastSocket->joinMulticastGroup(
-            multicastAddress(), addressToBind))
+    else if (m_shareMulticast)
+    {
+        m_multicastHub = HSsdpMulticastHub::attach(this, addressToBind);
+        if (!m_multicastHub)
+        {
+            clear();
+            return false;
+        }
+    }
+    else
     {
-        HLOG_WARN(QString("Could not join %1").arg(
-            multicastAddress().toString()));
+        m_multicastSocket = new HMulticastSocket(q_ptr);
+
+        ok = QObject::connect(
+            m_multicastSocket, SIGNAL(readyRead()),
+            q_ptr, SLOT(multicastMessageReceived()));
 
-        //return false;
+        Q_ASSERT(ok);
+
+        if (!m_multicastSocket->bind(1900))
+        {
+            HLOG_WARN("Failed to bind multicast socket for listening");
+            return false;
+        }
+
+        if (!m_multicastSocket->joinMulticastGroup(
+                multicastAddress(), addressToBind))
+        {
+            HLOG_WARN(QString("Could not join %1").arg(
+                multicastAddress().toString()));
+
+            //return false;
+        }
+
+        m_multicastSocket->enableDropCounting();
     }
 
     HLOG_DBG(QString(
@@ -658,48 +946,196 @@ bool HSsdpPrivate::init(const QHostAddress& addressToBind)
         return false;
     }
 
+    m_unicastSocket->enableDropCounting();
+
+    applyReceiveBufferSize();
+    applySendBufferSize();
+
     return true;
 }
 
-void HSsdpPrivate::messageReceived(QUdpSocket* socket, const HEndpoint* dest)
+void HSsdpPrivate::applyReceiveBufferSize()
 {
-    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+    Q_ASSERT(isInitialized());
+
+    if (m_receiveBufferSize > 0)
+    {
+        if (m_receiveThread)
+        {
+            m_receiveThread->setReceiveBufferSize(m_receiveBufferSize);
+        }
+        else if (m_multicastHub)
+        {
+            m_multicastHub->setReceiveBufferSize(m_receiveBufferSize);
+        }
+        else
+        {
+            m_multicastSocket->setReceiveBufferSize(m_receiveBufferSize);
+        }
+        m_unicastSocket->setReceiveBufferSize(m_receiveBufferSize);
+    }
+}
 
-    QHostAddress ha; quint16 port;
+void HSsdpPrivate::applySendBufferSize()
+{
+    Q_ASSERT(isInitialized());
 
-    QByteArray buf;
-    buf.resize(socket->pendingDatagramSize() + 1);
+    if (m_sendBufferSize > 0)
+    {
+        m_unicastSocket->setSendBufferSize(m_sendBufferSize);
+    }
+}
 
-    qint64 read = socket->readDatagram(buf.data(), buf.size(), &ha, &port);
-    if (read < 0)
+qint64 HSsdpPrivate::kernelDrops() const
+{
+    qint64 multicast = -1;
+    if (m_receiveThread)
     {
-        HLOG_WARN(QString("Read failed: %1").arg(socket->errorString()));
-        Q_ASSERT(false);
-        return;
+        multicast = m_receiveThread->kernelDrops();
+    }
+    else if (m_multicastHub)
+    {
+        multicast = m_multicastHub->droppedDatagrams();
+    }
+    else if (m_multicastSocket)
+    {
+        multicast = m_multicastSocket->droppedDatagrams();
     }
 
-    QString msg(QString::fromUtf8(buf, read));
-    HEndpoint source(ha, port);
-    HEndpoint destination(
-        dest ? *dest : HEndpoint(socket->localAddress(), socket->localPort()));
+    qint64 unicast =
+        m_unicastSocket ? m_unicastSocket->droppedDatagrams() : -1;
+
+    if (multicast < 0 && unicast < 0)
+    {
+        return -1;
+    }
+
+    return qMax(multicast, Q_INT64_C(0)) + qMax(unicast, Q_INT64_C(0));
+}
+
+HHttpRequestHeader HSsdpPrivate::requestHeader(const QByteArray& msg)
+{
+    if (m_multicastHub && m_multicastHub->isDispatching(msg))
+    {
+        return m_multicastHub->requestHeader();
+    }
+
+    return HHttpRequestHeader(msg);
+}
 
-    if (msg.startsWith("NOTIFY * HTTP/1.1", Qt::CaseInsensitive))
+void HSsdpPrivate::processMessage(
+    const QByteArray& msg, const HEndpoint& source,
+    const HEndpoint& destination)
+{
+    HTraceSpan span("ssdp", "parse",
+        HTraceRecorder::isEnabled() ? HTraceRecorder::newRequestId() : 0);
+
+    if (HTrafficRecorder::isEnabled())
+    {
+        HTrafficRecorder::record(
+            HTrafficCaptureReader::Ssdp, HTrafficCaptureReader::Inbound,
+            destination, source, msg);
+    }
+
+    // the message is classified and filtered using the raw bytes. the
+    // data is converted and parsed only if the message is wanted
+    if (startsWith(msg, "NOTIFY * HTTP/1.1"))
     {
         // Possible presence announcement
-        processNotify(msg, source);
+        processNotify(msg, source, span);
     }
-    else if (msg.startsWith("M-SEARCH * HTTP/1.1", Qt::CaseInsensitive))
+    else if (startsWith(msg, "M-SEARCH * HTTP/1.1"))
     {
         // Possible discovery request.
-        processSearch(msg, source, destination);
+        processSearch(msg, source, destination, span);
     }
     else
     {
         // Possible discovery response
-        processResponse(msg, source);
+        processResponse(msg, source, span);
+    }
+}
+
+void HSsdpPrivate::messageReceived(
+    HMulticastSocket* socket, const HEndpoint* dest)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    QList<QByteArray> datagrams;
+    QList<HEndpoint> sources;
+
+    // the receive stage covers the whole batch of datagrams, which is why
+    // it does not belong to any single message
+    HTraceSpan span("ssdp", "receive");
+    socket->readDatagrams(&datagrams, &sources, maxDatagramsPerNotification());
+    span.end();
+
+    if (datagrams.isEmpty())
+    {
+        return;
+    }
+
+    HEndpoint destination(
+        dest ? *dest : HEndpoint(socket->localAddress(), socket->localPort()));
+
+    for (qint32 i = 0; i < datagrams.size(); ++i)
+    {
+        processMessage(datagrams[i], sources[i], destination);
+    }
+
+    deliverBatch();
+}
+
+void HSsdpPrivate::deliverBatch()
+{
+    if (m_batch.isEmpty())
+    {
+        return;
+    }
+
+    QList<HSsdpMessage> batch = m_batch;
+    m_batch.clear();
+
+    HTraceSpan span("ssdp", "dispatch");
+    if (!q_ptr->incomingMessages(batch))
+    {
+        emit q_ptr->messageBatchReceived(batch);
     }
 }
 
+void HSsdpPrivate::queuedMessagesReceived()
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    m_receiveThread->wakeupReceived();
+
+    HDatagramQueue& queue = m_receiveThread->queue();
+    HEndpoint destination = multicastEndpoint();
+
+    QByteArray msg;
+    HEndpoint source;
+    for (qint32 i = 0; i < maxDatagramsPerNotification(); ++i)
+    {
+        // processing a message may shut the instance down
+        if (!m_receiveThread || !queue.pop(&msg, &source))
+        {
+            deliverBatch();
+            return;
+        }
+
+        processMessage(msg, source, destination);
+    }
+
+    // the rest are processed after the events already posted to this
+    // thread, such as the datagrams of the other interfaces
+    if (m_receiveThread && !queue.isEmpty())
+    {
+        m_receiveThread->wakeup();
+    }
+
+    deliverBatch();
+}
+
 /*******************************************************************************
  * HSsdp
  ******************************************************************************/
@@ -727,8 +1163,15 @@ void HSsdp::unicastMessageReceived()
 
 void HSsdp::multicastMessageReceived()
 {
-    HEndpoint ep = multicastEndpoint();
-    h_ptr->messageReceived(h_ptr->m_multicastSocket, &ep);
+    if (h_ptr->m_receiveThread)
+    {
+        h_ptr->queuedMessagesReceived();
+    }
+    else if (h_ptr->m_multicastSocket)
+    {
+        HEndpoint ep = multicastEndpoint();
+        h_ptr->messageReceived(h_ptr->m_multicastSocket, &ep);
+    }
 }
 
 void HSsdp::setFilter(AllowedMessages allowedMessages)
@@ -741,6 +1184,104 @@ HSsdp::AllowedMessages HSsdp::filter() const
     return h_ptr->m_allowedMessages;
 }
 
+void HSsdp::setReceiveBufferSize(qint32 bytes)
+{
+    if (bytes < 0)
+    {
+        return;
+    }
+
+    h_ptr->m_receiveBufferSize = bytes;
+    if (isInitialized())
+    {
+        h_ptr->applyReceiveBufferSize();
+    }
+}
+
+qint32 HSsdp::receiveBufferSize() const
+{
+    return h_ptr->m_receiveBufferSize;
+}
+
+void HSsdp::setSendBufferSize(qint32 bytes)
+{
+    if (bytes < 0)
+    {
+        return;
+    }
+
+    h_ptr->m_sendBufferSize = bytes;
+    if (isInitialized())
+    {
+        h_ptr->applySendBufferSize();
+    }
+}
+
+qint32 HSsdp::sendBufferSize() const
+{
+    return h_ptr->m_sendBufferSize;
+}
+
+void HSsdp::setReceiveThreadEnabled(bool enable)
+{
+    h_ptr->m_useReceiveThread = enable;
+}
+
+bool HSsdp::receiveThreadEnabled() const
+{
+    return h_ptr->m_useReceiveThread;
+}
+
+void HSsdp::setMulticastSharingEnabled(bool enable)
+{
+    h_ptr->m_shareMulticast = enable;
+}
+
+bool HSsdp::multicastSharingEnabled() const
+{
+    return h_ptr->m_shareMulticast;
+}
+
+void HSsdp::setBatchDeliveryEnabled(bool enable)
+{
+    h_ptr->m_batchDelivery = enable;
+    if (!enable)
+    {
+        h_ptr->deliverBatch();
+    }
+}
+
+bool HSsdp::batchDeliveryEnabled() const
+{
+    return h_ptr->m_batchDelivery;
+}
+
+qint64 HSsdp::messagesReceived(AllowedMessage type) const
+{
+    qint32 index = counterIndex(type);
+    return index >= 0 ? h_ptr->m_messagesReceived[index] : 0;
+}
+
+qint64 HSsdp::messagesSent(AllowedMessage type) const
+{
+    qint32 index = counterIndex(type);
+    return index >= 0 ? h_ptr->m_messagesSent[index] : 0;
+}
+
+qint64 HSsdp::droppedDatagrams(DropReason reason) const
+{
+    switch(reason)
+    {
+    case ReceiveBufferFull:
+        return h_ptr->kernelDrops();
+    case ReceiveQueueFull:
+        return h_ptr->m_receiveThread ?
+            h_ptr->m_receiveThread->queueDrops() : 0;
+    default:
+        return 0;
+    }
+}
+
 bool HSsdp::init()
 {
     HLOG2(H_AT, H_FUN, h_ptr->m_loggingIdentifier);
@@ -809,8 +1350,25 @@ bool HSsdp::incomingDeviceUpdateAnnouncement(
     return false;
 }
 
+bool HSsdp::incomingMessages(const QList<HSsdpMessage>&)
+{
+    return false;
+}
+
 namespace
 {
+template<class Msg>
+inline QByteArray datagram(const Msg& msg, const HEndpoint&)
+{
+    return HSsdpMessageCreator::create(msg);
+}
+
+inline QByteArray datagram(
+    const HDiscoveryRequest& msg, const HEndpoint& receiver)
+{
+    return HSsdpMessageCreator::create(msg, receiver);
+}
+
 template<class Msg>
 qint32 send(HSsdpPrivate* hptr, const Msg& msg, const HEndpoint& receiver,
             qint32 count)
@@ -822,11 +1380,12 @@ qint32 send(HSsdpPrivate* hptr, const Msg& msg, const HEndpoint& receiver,
         return -1;
     }
 
+    QByteArray data = datagram(msg, receiver);
+    Q_ASSERT(!data.isEmpty());
+
     qint32 sent = 0;
     for (qint32 i = 0; i < count; ++i)
     {
-        QByteArray data = HSsdpMessageCreator::create(msg);
-        Q_ASSERT(!data.isEmpty());
         if (hptr->send(data, receiver))
         {
             ++sent;
@@ -873,5 +1432,162 @@ qint32 HSsdp::sendDiscoveryResponse(
     return send(h_ptr, msg, destination, count);
 }
 
+/*******************************************************************************
+ * HSsdpMessagePrivate
+ ******************************************************************************/
+HSsdpMessagePrivate::HSsdpMessagePrivate() :
+    QSharedData(),
+        m_type(HSsdp::None), m_source(),
+        m_requestMethod(HSsdp::MulticastDiscovery),
+        m_discoveryRequest(0), m_discoveryResponse(0),
+        m_resourceAvailable(0), m_resourceUnavailable(0), m_resourceUpdate(0)
+{
+}
+
+namespace
+{
+template<typename Msg>
+inline Msg* copy(const Msg* msg)
+{
+    return msg ? new Msg(*msg) : 0;
+}
+}
+
+HSsdpMessagePrivate::HSsdpMessagePrivate(const HSsdpMessagePrivate& other) :
+    QSharedData(other),
+        m_type(other.m_type), m_source(other.m_source),
+        m_requestMethod(other.m_requestMethod),
+        m_discoveryRequest(copy(other.m_discoveryRequest)),
+        m_discoveryResponse(copy(other.m_discoveryResponse)),
+        m_resourceAvailable(copy(other.m_resourceAvailable)),
+        m_resourceUnavailable(copy(other.m_resourceUnavailable)),
+        m_resourceUpdate(copy(other.m_resourceUpdate))
+{
+}
+
+HSsdpMessagePrivate::~HSsdpMessagePrivate()
+{
+    delete m_discoveryRequest;
+    delete m_discoveryResponse;
+    delete m_resourceAvailable;
+    delete m_resourceUnavailable;
+    delete m_resourceUpdate;
+}
+
+/*******************************************************************************
+ * HSsdpMessage
+ ******************************************************************************/
+HSsdpMessage::HSsdpMessage() :
+    h_ptr(new HSsdpMessagePrivate())
+{
+}
+
+HSsdpMessage::HSsdpMessage(
+    const HDiscoveryRequest& msg, const HEndpoint& source,
+    HSsdp::DiscoveryRequestMethod requestType) :
+        h_ptr(new HSsdpMessagePrivate())
+{
+    h_ptr->m_type = HSsdp::DiscoveryRequest;
+    h_ptr->m_source = source;
+    h_ptr->m_requestMethod = requestType;
+    h_ptr->m_discoveryRequest = new HDiscoveryRequest(msg);
+}
+
+HSsdpMessage::HSsdpMessage(
+    const HDiscoveryResponse& msg, const HEndpoint& source) :
+        h_ptr(new HSsdpMessagePrivate())
+{
+    h_ptr->m_type = HSsdp::DiscoveryResponse;
+    h_ptr->m_source = source;
+    h_ptr->m_discoveryResponse = new HDiscoveryResponse(msg);
+}
+
+HSsdpMessage::HSsdpMessage(
+    const HResourceAvailable& msg, const HEndpoint& source) :
+        h_ptr(new HSsdpMessagePrivate())
+{
+    h_ptr->m_type = HSsdp::DeviceAvailable;
+    h_ptr->m_source = source;
+    h_ptr->m_resourceAvailable = new HResourceAvailable(msg);
+}
+
+HSsdpMessage::HSsdpMessage(
+    const HResourceUnavailable& msg, const HEndpoint& source) :
+        h_ptr(new HSsdpMessagePrivate())
+{
+    h_ptr->m_type = HSsdp::DeviceUnavailable;
+    h_ptr->m_source = source;
+    h_ptr->m_resourceUnavailable = new HResourceUnavailable(msg);
+}
+
+HSsdpMessage::HSsdpMessage(
+    const HResourceUpdate& msg, const HEndpoint& source) :
+        h_ptr(new HSsdpMessagePrivate())
+{
+    h_ptr->m_type = HSsdp::DeviceUpdate;
+    h_ptr->m_source = source;
+    h_ptr->m_resourceUpdate = new HResourceUpdate(msg);
+}
+
+HSsdpMessage::HSsdpMessage(const HSsdpMessage& other) :
+    h_ptr(other.h_ptr)
+{
+}
+
+HSsdpMessage& HSsdpMessage::operator=(const HSsdpMessage& other)
+{
+    h_ptr = other.h_ptr;
+    return *this;
+}
+
+HSsdpMessage::~HSsdpMessage()
+{
+}
+
+HSsdp::AllowedMessage HSsdpMessage::type() const
+{
+    return h_ptr->m_type;
+}
+
+HEndpoint HSsdpMessage::source() const
+{
+    return h_ptr->m_source;
+}
+
+HSsdp::DiscoveryRequestMethod HSsdpMessage::discoveryRequestMethod() const
+{
+    return h_ptr->m_requestMethod;
+}
+
+HDiscoveryRequest HSsdpMessage::discoveryRequest() const
+{
+    return h_ptr->m_discoveryRequest ?
+        *h_ptr->m_discoveryRequest : HDiscoveryRequest();
+}
+
+HDiscoveryResponse HSsdpMessage::discoveryResponse() const
+{
+    return h_ptr->m_discoveryResponse ?
+        *h_ptr->m_discoveryResponse : HDiscoveryResponse();
+}
+
+HResourceAvailable HSsdpMessage::resourceAvailable() const
+{
+    return h_ptr->m_resourceAvailable ?
+        *h_ptr->m_resourceAvailable : HResourceAvailable();
+}
+
+HResourceUnavailable HSsdpMessage::resourceUnavailable() const
+{
+    return h_ptr->m_resourceUnavailable ?
+        *h_ptr->m_resourceUnavailable : HResourceUnavailable();
+}
+
+HResourceUpdate HSsdpMessage::resourceUpdate() const
+{
+    return h_ptr->m_resourceUpdate ?
+        *h_ptr->m_resourceUpdate : HResourceUpdate();
+}
+
 }
 }
@@ -24,7 +24,9 @@
 
 #include <HUpnpCore/HUpnp>
 
+#include <QtCore/QList>
 #include <QtCore/QObject>
+#include <QtCore/QSharedDataPointer>
 
 class QUrl;
 class QString;
@@ -37,6 +39,7 @@ namespace Upnp
 {
 
 class HSsdpPrivate;
+class HSsdpMessagePrivate;
 
 /*!
  * \brief This class is used for sending and receiving SSDP messages defined by the
@@ -52,6 +55,13 @@ class HSsdpPrivate;
  * derive a sub-class and override the various virtual member functions to handle
  * the received messages.
  *
+ * By default every message is delivered on its own as soon as it has been
+ * parsed. When batch delivery is enabled, the messages parsed from the
+ * datagrams read in one go are delivered together to incomingMessages() and
+ * messageBatchReceived() instead. This is useful when a large number of
+ * messages arrives at once, such as the responses to a discovery request
+ * sent to \c ssdp:all.
+ *
  * \headerfile hssdp.h HSsdp
  *
  * \ingroup hupnp_ssdp
@@ -203,6 +213,26 @@ protected:
     virtual bool incomingDeviceUpdateAnnouncement(
         const HResourceUpdate& msg, const HEndpoint& source);
 
+    /*!
+     * This method is called after the datagrams read from a socket in one
+     * go have been parsed, in case batch delivery is enabled.
+     *
+     * Override this method if you want to handle the messages. You can also
+     * connect to the messageBatchReceived() signal.
+     *
+     * \param msgs specifies the messages in the order they were received.
+     * The list is never empty.
+     *
+     * \retval true in case the messages were handled successfully and the
+     * messageBatchReceived() signal should not be sent.
+     *
+     * \retval false in case the messages were not handled and the
+     * messageBatchReceived() signal should be sent.
+     *
+     * \sa messageBatchReceived(), setBatchDeliveryEnabled()
+     */
+    virtual bool incomingMessages(const QList<HSsdpMessage>& msgs);
+
 public:
 
     /*!
@@ -263,6 +293,31 @@ public:
 
     Q_DECLARE_FLAGS(AllowedMessages, AllowedMessage);
 
+    /*!
+     * This enum specifies why a received datagram was dropped before it
+     * was processed.
+     *
+     * \sa droppedDatagrams()
+     */
+    enum DropReason
+    {
+        /*!
+         * The operating system dropped the datagram, because the receive
+         * buffer of the socket was full.
+         *
+         * \sa setReceiveBufferSize()
+         */
+        ReceiveBufferFull,
+
+        /*!
+         * The receive thread dropped the datagram, because the queue of the
+         * datagrams not yet processed by the instance was full.
+         *
+         * \sa setReceiveThreadEnabled()
+         */
+        ReceiveQueueFull
+    };
+
     /*!
      * \brief Sets the filter of what message types are accepted for processing.
      *
@@ -286,6 +341,212 @@ public:
      */
     AllowedMessages filter() const;
 
+    /*!
+     * \brief Sets the size of the receive buffer of the sockets the instance
+     * uses.
+     *
+     * A large receive buffer reduces the number of datagrams dropped
+     * during a burst of SSDP traffic, such as the responses to a
+     * discovery request sent to \c ssdp:all. The default is 256 kilobytes.
+     *
+     * \param bytes specifies the size of the receive buffer in bytes. A value
+     * of zero means that the default of the operating system is used. A
+     * negative value is ignored.
+     *
+     * \remarks The value is applied when the instance is initialized and
+     * immediately in case the instance is already initialized.
+     *
+     * \sa receiveBufferSize()
+     */
+    void setReceiveBufferSize(qint32 bytes);
+
+    /*!
+     * \brief Returns the requested size of the receive buffer of the sockets
+     * the instance uses.
+     *
+     * \return The requested size of the receive buffer of the sockets
+     * the instance uses in bytes.
+     *
+     * \sa setReceiveBufferSize()
+     */
+    qint32 receiveBufferSize() const;
+
+    /*!
+     * \brief Sets the size of the send buffer of the unicast socket the
+     * instance uses.
+     *
+     * Every message the instance sends, including the multicast
+     * announcements, is sent using the unicast socket. A large send buffer
+     * keeps the operating system from dropping the datagrams of a long burst
+     * of announcements or discovery responses. The default is zero.
+     *
+     * \param bytes specifies the size of the send buffer in bytes. A value
+     * of zero means that the default of the operating system is used. A
+     * negative value is ignored.
+     *
+     * \remarks The value is applied when the instance is initialized and
+     * immediately in case the instance is already initialized.
+     *
+     * \sa sendBufferSize()
+     */
+    void setSendBufferSize(qint32 bytes);
+
+    /*!
+     * \brief Returns the requested size of the send buffer of the unicast
+     * socket the instance uses.
+     *
+     * \return The requested size of the send buffer of the unicast socket
+     * the instance uses in bytes.
+     *
+     * \sa setSendBufferSize()
+     */
+    qint32 sendBufferSize() const;
+
+    /*!
+     * \brief Specifies whether the multicast messages are received in a
+     * thread of their own.
+     *
+     * When enabled, the multicast socket of the instance is read in a
+     * dedicated thread, which queues the received datagrams for the thread
+     * of the instance. A burst of traffic on one network interface then does
+     * not delay reading the sockets of the other instances, and the
+     * datagrams of several instances are processed in turns. The messages
+     * are still parsed and dispatched in the thread of the instance.
+     *
+     * \param enable specifies whether a receive thread is used.
+     *
+     * \remarks The value is applied when the instance is initialized.
+     *
+     * \sa receiveThreadEnabled()
+     */
+    void setReceiveThreadEnabled(bool enable);
+
+    /*!
+     * \brief Indicates whether the multicast messages are received in a
+     * thread of their own.
+     *
+     * \return \e true in case the multicast messages are received in a
+     * thread of their own. The default is \e false.
+     *
+     * \sa setReceiveThreadEnabled()
+     */
+    bool receiveThreadEnabled() const;
+
+    /*!
+     * \brief Specifies whether the multicast socket is shared with the other
+     * instances of the thread that use the same network interface.
+     *
+     * When enabled, the instances of a thread that are initialized to the
+     * same address read the SSDP multicast traffic using a single socket.
+     * Each message is then read and parsed once and dispatched to every
+     * instance, instead of being received and parsed by each instance
+     * separately. The unicast socket is never shared.
+     *
+     * \param enable specifies whether the multicast socket is shared.
+     *
+     * \remarks
+     * \li The value is applied when the instance is initialized.
+     * \li The value is ignored in case a receive thread is enabled.
+     *
+     * \sa multicastSharingEnabled(), setReceiveThreadEnabled()
+     */
+    void setMulticastSharingEnabled(bool enable);
+
+    /*!
+     * \brief Indicates whether the multicast socket is shared with the other
+     * instances of the thread that use the same network interface.
+     *
+     * \return \e true in case the multicast socket is shared with the other
+     * instances of the thread. The default is \e false.
+     *
+     * \sa setMulticastSharingEnabled()
+     */
+    bool multicastSharingEnabled() const;
+
+    /*!
+     * \brief Specifies whether the received messages are delivered in
+     * batches.
+     *
+     * When enabled, the messages parsed from the datagrams read from a socket
+     * in one go are delivered together to incomingMessages() and
+     * messageBatchReceived(). The virtual methods and the signals of the
+     * individual message types are then not used at all. A consumer can
+     * then deduplicate the messages and update its own data structures once
+     * per batch instead of once per message.
+     *
+     * \param enable specifies whether the messages are delivered in batches.
+     *
+     * \remarks The value can be changed at any time. The messages that
+     * have been parsed but not yet delivered are delivered in a batch.
+     *
+     * \sa batchDeliveryEnabled(), incomingMessages()
+     */
+    void setBatchDeliveryEnabled(bool enable);
+
+    /*!
+     * \brief Indicates whether the received messages are delivered in
+     * batches.
+     *
+     * \return \e true in case the received messages are delivered in
+     * batches. The default is \e false.
+     *
+     * \sa setBatchDeliveryEnabled()
+     */
+    bool batchDeliveryEnabled() const;
+
+    /*!
+     * \brief Returns the number of messages of the specified type the
+     * instance has received.
+     *
+     * The messages are counted before they are filtered, which means that
+     * the number includes the messages that were not processed because of
+     * the filter or because they were invalid.
+     *
+     * \param type specifies the message type. The value has to be a single
+     * message type.
+     *
+     * \return The number of messages of the specified type the instance
+     * has received.
+     *
+     * \sa messagesSent(), setFilter()
+     */
+    qint64 messagesReceived(AllowedMessage type) const;
+
+    /*!
+     * \brief Returns the number of messages of the specified type the
+     * instance has sent.
+     *
+     * Every repetition of a message is counted.
+     *
+     * \param type specifies the message type. The value has to be a single
+     * message type.
+     *
+     * \return The number of messages of the specified type the instance
+     * has sent.
+     *
+     * \sa messagesReceived()
+     */
+    qint64 messagesSent(AllowedMessage type) const;
+
+    /*!
+     * \brief Returns the number of received datagrams that were dropped
+     * for the specified reason.
+     *
+     * The datagrams dropped by the operating system are counted only on
+     * Linux, where the count is reported by the kernel. In case the
+     * multicast socket is shared, the datagrams the shared socket has
+     * dropped are included in the count of every instance sharing it.
+     *
+     * \param reason specifies the reason the datagrams were dropped.
+     *
+     * \return The number of datagrams the sockets of the instance have
+     * dropped for the specified reason since the instance was initialized,
+     * or -1 in case the datagrams are not counted on this platform.
+     *
+     * \sa setReceiveBufferSize()
+     */
+    qint64 droppedDatagrams(DropReason reason) const;
+
     /*!
      * \brief Sets the instance to listen the network for SSDP messages and and attempts to
      * init the unicast socket of the instance to the address of the first
@@ -477,10 +738,177 @@ Q_SIGNALS:
     void resourceUnavailableReceived(
         const Herqq::Upnp::HResourceUnavailable& msg,
         const Herqq::Upnp::HEndpoint& source);
+
+    /*!
+     * \brief This signal is emitted when a batch of messages is received
+     * and batch delivery is enabled.
+     *
+     * \param msgs specifies the messages in the order they were received.
+     *
+     * \sa setBatchDeliveryEnabled()
+     */
+    void messageBatchReceived(const QList<Herqq::Upnp::HSsdpMessage>& msgs);
 };
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(HSsdp::AllowedMessages)
 
+/*!
+ * \brief This is a class that contains a single SSDP message received by
+ * HSsdp in batch delivery mode.
+ *
+ * The type() of the message tells which one of the accessors returns the
+ * message. The rest of the accessors return invalid objects.
+ *
+ * \headerfile hssdp.h HSsdpMessage
+ *
+ * \ingroup hupnp_ssdp
+ *
+ * \remarks the class provides an assignment operator, which is not
+ * thread-safe.
+ *
+ * \sa HSsdp::setBatchDeliveryEnabled(), HSsdp::incomingMessages()
+ */
+class H_UPNP_CORE_EXPORT HSsdpMessage
+{
+private:
+
+    QSharedDataPointer<HSsdpMessagePrivate> h_ptr;
+
+public:
+
+    /*!
+     * Constructs a new, empty instance. The type() of the constructed
+     * object is HSsdp::None.
+     */
+    HSsdpMessage();
+
+    /*!
+     * Constructs a new instance containing a discovery request.
+     *
+     * \param msg specifies the message.
+     * \param source specifies the endpoint that sent the message.
+     * \param requestType specifies the type of the discovery request.
+     */
+    HSsdpMessage(
+        const HDiscoveryRequest& msg, const HEndpoint& source,
+        HSsdp::DiscoveryRequestMethod requestType);
+
+    /*!
+     * Constructs a new instance containing a discovery response.
+     *
+     * \param msg specifies the message.
+     * \param source specifies the endpoint that sent the message.
+     */
+    HSsdpMessage(const HDiscoveryResponse& msg, const HEndpoint& source);
+
+    /*!
+     * Constructs a new instance containing a device available announcement.
+     *
+     * \param msg specifies the message.
+     * \param source specifies the endpoint that sent the message.
+     */
+    HSsdpMessage(const HResourceAvailable& msg, const HEndpoint& source);
+
+    /*!
+     * Constructs a new instance containing a device unavailable
+     * announcement.
+     *
+     * \param msg specifies the message.
+     * \param source specifies the endpoint that sent the message.
+     */
+    HSsdpMessage(const HResourceUnavailable& msg, const HEndpoint& source);
+
+    /*!
+     * Constructs a new instance containing a device update announcement.
+     *
+     * \param msg specifies the message.
+     * \param source specifies the endpoint that sent the message.
+     */
+    HSsdpMessage(const HResourceUpdate& msg, const HEndpoint& source);
+
+    /*!
+     * \brief Copy constructor.
+     *
+     * Copies the contents of the other to this.
+     */
+    HSsdpMessage(const HSsdpMessage&);
+
+    /*!
+     * \brief Assigns the contents of the other object to this.
+     *
+     * \return a reference to this.
+     */
+    HSsdpMessage& operator=(const HSsdpMessage&);
+
+    /*!
+     * \brief Destroys the instance.
+     */
+    ~HSsdpMessage();
+
+    /*!
+     * \brief Returns the type of the message.
+     *
+     * \return The type of the message, which is a single message type or
+     * HSsdp::None in case the object is empty.
+     */
+    HSsdp::AllowedMessage type() const;
+
+    /*!
+     * \brief Returns the endpoint that sent the message.
+     *
+     * \return The endpoint that sent the message.
+     */
+    HEndpoint source() const;
+
+    /*!
+     * \brief Returns the type of the discovery request.
+     *
+     * \return The type of the discovery request. The value is meaningful
+     * only in case the type() is HSsdp::DiscoveryRequest.
+     */
+    HSsdp::DiscoveryRequestMethod discoveryRequestMethod() const;
+
+    /*!
+     * \brief Returns the discovery request.
+     *
+     * \return The discovery request, or an invalid object in case the type()
+     * is not HSsdp::DiscoveryRequest.
+     */
+    HDiscoveryRequest discoveryRequest() const;
+
+    /*!
+     * \brief Returns the discovery response.
+     *
+     * \return The discovery response, or an invalid object in case the
+     * type() is not HSsdp::DiscoveryResponse.
+     */
+    HDiscoveryResponse discoveryResponse() const;
+
+    /*!
+     * \brief Returns the device available announcement.
+     *
+     * \return The device available announcement, or an invalid object in
+     * case the type() is not HSsdp::DeviceAvailable.
+     */
+    HResourceAvailable resourceAvailable() const;
+
+    /*!
+     * \brief Returns the device unavailable announcement.
+     *
+     * \return The device unavailable announcement, or an invalid object in
+     * case the type() is not HSsdp::DeviceUnavailable.
+     */
+    HResourceUnavailable resourceUnavailable() const;
+
+    /*!
+     * \brief Returns the device update announcement.
+     *
+     * \return The device update announcement, or an invalid object in case
+     * the type() is not HSsdp::DeviceUpdate.
+     */
+    HResourceUpdate resourceUpdate() const;
+};
+
 }
 }
 
@@ -0,0 +1,246 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hssdp_hub_p.h"
+#include "hssdp_p.h"
+
+#include "../general/hlogger_p.h"
+#include "../socket/hendpoint.h"
+#include "../socket/hmulticast_socket.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QThread>
+#include <QtCore/QMutexLocker>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace
+{
+// the hubs of all threads, keyed by the thread and the interface address
+typedef QHash<QString, HSsdpMulticastHub*> HubRegistry;
+
+QMutex s_registryMutex;
+
+HubRegistry& registry()
+{
+    static HubRegistry retVal;
+    return retVal;
+}
+
+QString registryKey(QThread* thread, const QHostAddress& address)
+{
+    return QString("%1|%2").arg(
+        QString::number(reinterpret_cast<quintptr>(thread)),
+        address.toString());
+}
+
+inline QHostAddress multicastAddress()
+{
+    static QHostAddress retVal("239.255.255.250");
+    return retVal;
+}
+
+// the same limit the HSsdp instances use with sockets of their own
+inline qint32 maxDatagramsPerNotification()
+{
+    const qint32 retVal = 128;
+    return retVal;
+}
+}
+
+/*******************************************************************************
+ * HSsdpMulticastHub
+ ******************************************************************************/
+HSsdpMulticastHub::HSsdpMulticastHub(const QHostAddress& address) :
+    QObject(),
+        m_address(address),
+        m_socket(new HMulticastSocket(this)),
+        m_listeners(),
+        m_current(0),
+        m_headerParsed(false),
+        m_header(),
+        m_receiveBufferSize(0)
+{
+    bool ok = connect(m_socket, SIGNAL(readyRead()), this, SLOT(readyRead()));
+    Q_ASSERT(ok); Q_UNUSED(ok)
+}
+
+HSsdpMulticastHub::~HSsdpMulticastHub()
+{
+    if (m_socket->state() == QUdpSocket::BoundState)
+    {
+        m_socket->leaveMulticastGroup(multicastAddress(), m_address);
+    }
+}
+
+bool HSsdpMulticastHub::init()
+{
+    HLOG(H_AT, H_FUN);
+
+    if (!m_socket->bind(1900))
+    {
+        HLOG_WARN("Failed to bind multicast socket for listening");
+        return false;
+    }
+
+    if (!m_socket->joinMulticastGroup(multicastAddress(), m_address))
+    {
+        HLOG_WARN(QString("Could not join %1").arg(
+            multicastAddress().toString()));
+    }
+
+    m_socket->enableDropCounting();
+
+    return true;
+}
+
+HSsdpMulticastHub* HSsdpMulticastHub::attach(
+    HSsdpPrivate* listener, const QHostAddress& address)
+{
+    Q_ASSERT(listener);
+
+    QString key = registryKey(QThread::currentThread(), address);
+
+    QMutexLocker lock(&s_registryMutex);
+
+    HSsdpMulticastHub* hub = registry().value(key);
+    if (!hub)
+    {
+        hub = new HSsdpMulticastHub(address);
+        if (!hub->init())
+        {
+            delete hub;
+            return 0;
+        }
+        registry().insert(key, hub);
+    }
+
+    hub->m_listeners.append(listener);
+    return hub;
+}
+
+void HSsdpMulticastHub::detach(HSsdpPrivate* listener, HSsdpMulticastHub* hub)
+{
+    Q_ASSERT(hub);
+    Q_ASSERT(hub->thread() == QThread::currentThread());
+
+    QMutexLocker lock(&s_registryMutex);
+
+    hub->m_listeners.removeAll(listener);
+    if (!hub->m_listeners.isEmpty())
+    {
+        return;
+    }
+
+    registry().remove(registryKey(hub->thread(), hub->m_address));
+
+    if (hub->m_current)
+    {
+        // the last listener was removed while a datagram was dispatched
+        hub->deleteLater();
+    }
+    else
+    {
+        delete hub;
+    }
+}
+
+void HSsdpMulticastHub::setReceiveBufferSize(qint32 bytes)
+{
+    if (bytes > m_receiveBufferSize)
+    {
+        m_receiveBufferSize = bytes;
+        m_socket->setReceiveBufferSize(bytes);
+    }
+}
+
+qint64 HSsdpMulticastHub::droppedDatagrams() const
+{
+    return m_socket->droppedDatagrams();
+}
+
+const HHttpRequestHeader& HSsdpMulticastHub::requestHeader()
+{
+    Q_ASSERT(m_current);
+
+    if (!m_headerParsed)
+    {
+        m_header = HHttpRequestHeader(*m_current);
+        m_headerParsed = true;
+    }
+
+    return m_header;
+}
+
+void HSsdpMulticastHub::readyRead()
+{
+    QList<QByteArray> datagrams;
+    QList<HEndpoint> sources;
+
+    m_socket->readDatagrams(&datagrams, &sources, maxDatagramsPerNotification());
+
+    HEndpoint destination(multicastAddress(), 1900);
+
+    for (qint32 i = 0; i < datagrams.size(); ++i)
+    {
+        m_current = &datagrams[i];
+        m_headerParsed = false;
+
+        // a listener may detach or be destroyed while a datagram is
+        // dispatched, which is why each one is checked before it is used
+        QList<HSsdpPrivate*> listeners = m_listeners;
+        foreach(HSsdpPrivate* listener, listeners)
+        {
+            if (m_listeners.contains(listener))
+            {
+                listener->processMessage(datagrams[i], sources[i], destination);
+            }
+        }
+
+        if (m_listeners.isEmpty())
+        {
+            break;
+        }
+    }
+
+    // the listeners in batch delivery mode get the messages of the whole
+    // read at once. m_current is still set, so that the hub is not deleted
+    // in case the last listener detaches during the delivery
+    QList<HSsdpPrivate*> listeners = m_listeners;
+    foreach(HSsdpPrivate* listener, listeners)
+    {
+        if (m_listeners.contains(listener))
+        {
+            listener->deliverBatch();
+        }
+    }
+
+    m_current = 0;
+    m_header = HHttpRequestHeader();
+}
+
+}
+}
@@ -0,0 +1,123 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HSSDP_HUB_P_H_
+#define HSSDP_HUB_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include "../general/hupnp_defs.h"
+#include "../http/hhttp_header_p.h"
+
+#include <QtCore/QList>
+#include <QtCore/QObject>
+#include <QtNetwork/QHostAddress>
+
+class QByteArray;
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+class HSsdpPrivate;
+class HMulticastSocket;
+
+//
+// A multicast socket shared by the HSsdp instances of a thread that listen
+// to the same network interface. Each received datagram is read once and
+// dispatched to every listener, and the HTTP header of the datagram is
+// parsed at most once regardless of the number of listeners.
+//
+class HSsdpMulticastHub :
+    public QObject
+{
+Q_OBJECT
+H_DISABLE_COPY(HSsdpMulticastHub)
+
+private:
+
+    const QHostAddress m_address;
+
+    HMulticastSocket* m_socket;
+
+    QList<HSsdpPrivate*> m_listeners;
+    // not owned
+
+    const QByteArray* m_current;
+    // the datagram being dispatched. null when nothing is dispatched.
+
+    bool m_headerParsed;
+    HHttpRequestHeader m_header;
+    // the header of the datagram being dispatched, once it has been parsed
+
+    qint32 m_receiveBufferSize;
+    // the largest receive buffer size requested by the listeners
+
+    HSsdpMulticastHub(const QHostAddress& address);
+    ~HSsdpMulticastHub();
+
+    bool init();
+
+private Q_SLOTS:
+
+    void readyRead();
+
+public:
+
+    // returns the hub of the calling thread that listens to the specified
+    // address, creating one if needed, and registers the listener with it.
+    // returns null in case the multicast socket could not be bound.
+    static HSsdpMulticastHub* attach(
+        HSsdpPrivate* listener, const QHostAddress& address);
+
+    // unregisters the listener. the hub is deleted once it has no listeners.
+    static void detach(HSsdpPrivate* listener, HSsdpMulticastHub* hub);
+
+    // the socket uses the largest size requested by the listeners
+    void setReceiveBufferSize(qint32 bytes);
+
+    // the number of datagrams the shared socket has dropped,
+    // or -1 if they are not counted
+    qint64 droppedDatagrams() const;
+
+    // returns true in case the specified message is the datagram being
+    // dispatched by the hub
+    inline bool isDispatching(const QByteArray& msg) const
+    {
+        return m_current == &msg;
+    }
+
+    // returns the header of the datagram being dispatched
+    const HHttpRequestHeader& requestHeader();
+};
+
+}
+}
+
+#endif /* HSSDP_HUB_P_H_ */
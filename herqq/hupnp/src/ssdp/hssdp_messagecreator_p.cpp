@@ -27,10 +27,10 @@
 #include "../dataelements/hproduct_tokens.h"
 
 #include "../socket/hendpoint.h"
+
 #include "../general/hlogger_p.h"
 
 #include <QtCore/QUrl>
-#include <QtCore/QTextStream>
 
 namespace Herqq
 {
@@ -40,11 +40,11 @@ namespace Upnp
 
 namespace
 {
-HEndpoint multicastEndpoint()
-{
-    static HEndpoint retVal(QHostAddress("239.255.255.250"), 1900);
-    return retVal;
-}
+// the HOST header line of every multicast message
+const char HostField[] = "HOST: 239.255.255.250:1900\r\n";
+
+// the initial capacity of a message, which fits a typical SSDP message
+const qint32 MessageCapacity = 512;
 
 QString getTarget(const HDiscoveryType& ri)
 {
@@ -66,6 +66,16 @@ QString getTarget(const HDiscoveryType& ri)
 
     return QString();
 }
+
+inline void appendField(QByteArray& msg, const char* name, const QString& value)
+{
+    msg.append(name).append(value.toUtf8()).append("\r\n");
+}
+
+inline void appendField(QByteArray& msg, const char* name, qint32 value)
+{
+    msg.append(name).append(QByteArray::number(value)).append("\r\n");
+}
 }
 
 HSsdpMessageCreator::HSsdpMessageCreator()
@@ -83,51 +93,76 @@ QByteArray HSsdpMessageCreator::create(const HResourceUpdate& msg)
         return QByteArray();
     }
 
-    QString retVal;
-    QTextStream ts(&retVal);
+    QByteArray retVal;
+    retVal.reserve(MessageCapacity);
 
-    ts << "NOTIFY * HTTP/1.1\r\n"
-       << "HOST: "     << multicastEndpoint().toString()  << "\r\n"
-       << "LOCATION: " << msg.location().toString()           << "\r\n"
-       << "NT: "       << getTarget(msg.usn()) << "\r\n"
-       << "NTS: "      << "ssdp:update\r\n"
-       << "USN: "      << msg.usn().toString() << "\r\n";
+    retVal.append("NOTIFY * HTTP/1.1\r\n").append(HostField);
+    appendField(retVal, "LOCATION: ", msg.location().toString());
+    appendField(retVal, "NT: ", getTarget(msg.usn()));
+    retVal.append("NTS: ssdp:update\r\n");
+    appendField(retVal, "USN: ", msg.usn().toString());
 
     if (msg.bootId() >= 0)
     {
-        ts << "BOOTID.UPNP.ORG: "       << msg.bootId()     << "\r\n"
-           << "CONFIGID.UPNP.ORG: "     << msg.configId()   << "\r\n"
-           << "NEXTBOOTID.UPNP.ORG: "   << msg.nextBootId() << "\r\n";
+        appendField(retVal, "BOOTID.UPNP.ORG: ", msg.bootId());
+        appendField(retVal, "CONFIGID.UPNP.ORG: ", msg.configId());
+        appendField(retVal, "NEXTBOOTID.UPNP.ORG: ", msg.nextBootId());
 
         if (msg.searchPort() >= 0)
         {
-            ts << "SEARCHPORT.UPNP.ORG: " << msg.searchPort() << "\r\n";
+            appendField(retVal, "SEARCHPORT.UPNP.ORG: ", msg.searchPort());
         }
     }
 
-    ts << "\r\n";
+    retVal.append("\r\n");
 
-    return retVal.toUtf8();
+    return retVal;
 }
 
 QByteArray HSsdpMessageCreator::create(const HDiscoveryRequest& msg)
+{
+    return create(msg, HEndpoint());
+}
+
+QByteArray HSsdpMessageCreator::create(
+    const HDiscoveryRequest& msg, const HEndpoint& destination)
 {
     if (!msg.isValid(StrictChecks))
     {
         return QByteArray();
     }
 
-    QString retVal;
-    QTextStream out(&retVal);
+    QByteArray retVal;
+    retVal.reserve(MessageCapacity);
 
-    out << "M-SEARCH * HTTP/1.1\r\n"
-        << "HOST: "       << multicastEndpoint().toString() << "\r\n"
-        << "MAN: "        << "\"ssdp:discover\"\r\n"
-        << "MX: "         << msg.mx()                  << "\r\n"
-        << "ST: "         << getTarget(msg.searchTarget()) << "\r\n"
-        << "USER-AGENT: " << msg.userAgent().toString()<< "\r\n\r\n";
+    retVal.append("M-SEARCH * HTTP/1.1\r\n");
 
-    return retVal.toUtf8();
+    bool unicast = !destination.isNull() && !destination.isMulticast();
+    if (unicast)
+    {
+        // UDA 1.1 requires the HOST of a unicast M-SEARCH to identify the
+        // device and the MX to be left out, as the device has to respond
+        // immediately
+        appendField(retVal, "HOST: ", QString("%1:%2").arg(
+            destination.hostAddress().toString(),
+            QString::number(destination.portNumber() ?
+                destination.portNumber() : 1900)));
+    }
+    else
+    {
+        retVal.append(HostField);
+    }
+
+    retVal.append("MAN: \"ssdp:discover\"\r\n");
+    if (!unicast || msg.mx() > 0)
+    {
+        appendField(retVal, "MX: ", msg.mx());
+    }
+    appendField(retVal, "ST: ", getTarget(msg.searchTarget()));
+    appendField(retVal, "USER-AGENT: ", msg.userAgent().toString());
+    retVal.append("\r\n");
+
+    return retVal;
 }
 
 QByteArray HSsdpMessageCreator::create(const HDiscoveryResponse& msg)
@@ -137,31 +172,31 @@ QByteArray HSsdpMessageCreator::create(const HDiscoveryResponse& msg)
         return QByteArray();
     }
 
-    QString retVal;
-    QTextStream out(&retVal);
+    QByteArray retVal;
+    retVal.reserve(MessageCapacity);
 
-    out << "HTTP/1.1 200 OK\r\n"
-        << "CACHE-CONTROL: max-age=" << msg.cacheControlMaxAge() << "\r\n"
-        << "EXT:\r\n"
-        << "LOCATION: "              << msg.location().toString() << "\r\n"
-        << "SERVER: "                << msg.serverTokens().toString() << "\r\n"
-        << "ST: "                    << getTarget(msg.usn()) << "\r\n"
-        << "USN: "                   << msg.usn().toString() << "\r\n";
+    retVal.append("HTTP/1.1 200 OK\r\n");
+    appendField(retVal, "CACHE-CONTROL: max-age=", msg.cacheControlMaxAge());
+    retVal.append("EXT:\r\n");
+    appendField(retVal, "LOCATION: ", msg.location().toString());
+    appendField(retVal, "SERVER: ", msg.serverTokens().toString());
+    appendField(retVal, "ST: ", getTarget(msg.usn()));
+    appendField(retVal, "USN: ", msg.usn().toString());
 
     if (msg.bootId() >= 0)
     {
-        out << "BOOTID.UPNP.ORG: "   << msg.bootId()   << "\r\n"
-            << "CONFIGID.UPNP.ORG: " << msg.configId() <<"\r\n";
+        appendField(retVal, "BOOTID.UPNP.ORG: ", msg.bootId());
+        appendField(retVal, "CONFIGID.UPNP.ORG: ", msg.configId());
 
         if (msg.searchPort() >= 0)
         {
-            out << "SEARCHPORT.UPNP.ORG: " << msg.searchPort() << "\r\n";
+            appendField(retVal, "SEARCHPORT.UPNP.ORG: ", msg.searchPort());
         }
     }
 
-    out << "\r\n";
+    retVal.append("\r\n");
 
-    return retVal.toUtf8();
+    return retVal;
 }
 
 QByteArray HSsdpMessageCreator::create(const HResourceAvailable& msg)
@@ -171,32 +206,31 @@ QByteArray HSsdpMessageCreator::create(const HResourceAvailable& msg)
         return QByteArray();
     }
 
-    QString retVal;
-    QTextStream ts(&retVal);
+    QByteArray retVal;
+    retVal.reserve(MessageCapacity);
 
-    ts << "NOTIFY * HTTP/1.1\r\n"
-       << "HOST: "                  << multicastEndpoint().toString() << "\r\n"
-       << "CACHE-CONTROL: max-age=" << msg.cacheControlMaxAge() << "\r\n"
-       << "LOCATION: "              << msg.location().toString() << "\r\n"
-       << "NT: "                    << getTarget(msg.usn()) << "\r\n"
-       << "NTS: "                   << "ssdp:alive\r\n"
-       << "SERVER: "                << msg.serverTokens().toString() << "\r\n"
-       << "USN: "                   << msg.usn().toString() << "\r\n";
+    retVal.append("NOTIFY * HTTP/1.1\r\n").append(HostField);
+    appendField(retVal, "CACHE-CONTROL: max-age=", msg.cacheControlMaxAge());
+    appendField(retVal, "LOCATION: ", msg.location().toString());
+    appendField(retVal, "NT: ", getTarget(msg.usn()));
+    retVal.append("NTS: ssdp:alive\r\n");
+    appendField(retVal, "SERVER: ", msg.serverTokens().toString());
+    appendField(retVal, "USN: ", msg.usn().toString());
 
     if (msg.serverTokens().upnpToken().minorVersion() > 0)
     {
-        ts << "BOOTID.UPNP.ORG: "   << msg.bootId()   << "\r\n"
-           << "CONFIGID.UPNP.ORG: " << msg.configId() << "\r\n";
+        appendField(retVal, "BOOTID.UPNP.ORG: ", msg.bootId());
+        appendField(retVal, "CONFIGID.UPNP.ORG: ", msg.configId());
 
         if (msg.searchPort() >= 0)
         {
-            ts << "SEARCHPORT.UPNP.ORG: " << msg.searchPort() << "\r\n";
+            appendField(retVal, "SEARCHPORT.UPNP.ORG: ", msg.searchPort());
         }
     }
 
-    ts << "\r\n";
+    retVal.append("\r\n");
 
-    return retVal.toUtf8();
+    return retVal;
 }
 
 QByteArray HSsdpMessageCreator::create(const HResourceUnavailable& msg)
@@ -206,24 +240,23 @@ QByteArray HSsdpMessageCreator::create(const HResourceUnavailable& msg)
         return QByteArray();
     }
 
-    QString retVal;
-    QTextStream ts(&retVal);
+    QByteArray retVal;
+    retVal.reserve(MessageCapacity);
 
-    ts << "NOTIFY * HTTP/1.1\r\n"
-       << "HOST: " << multicastEndpoint().toString()<< "\r\n"
-       << "NT: "   << getTarget(msg.usn()) << "\r\n"
-       << "NTS: "  << "ssdp:byebye\r\n"
-       << "USN: "  << msg.usn().toString() << "\r\n";
+    retVal.append("NOTIFY * HTTP/1.1\r\n").append(HostField);
+    appendField(retVal, "NT: ", getTarget(msg.usn()));
+    retVal.append("NTS: ssdp:byebye\r\n");
+    appendField(retVal, "USN: ", msg.usn().toString());
 
     if (msg.bootId() >= 0)
     {
-        ts << "BOOTID.UPNP.ORG: "   << msg.bootId  () << "\r\n"
-           << "CONFIGID.UPNP.ORG: " << msg.configId() << "\r\n";
+        appendField(retVal, "BOOTID.UPNP.ORG: ", msg.bootId());
+        appendField(retVal, "CONFIGID.UPNP.ORG: ", msg.configId());
     }
 
-    ts << "\r\n";
+    retVal.append("\r\n");
 
-    return retVal.toUtf8();
+    return retVal;
 }
 
 }
@@ -42,7 +42,7 @@ namespace Upnp
 //
 //
 //
-class HSsdpMessageCreator
+class H_UPNP_CORE_EXPORT HSsdpMessageCreator
 {
 H_DISABLE_COPY(HSsdpMessageCreator)
 
@@ -55,6 +55,11 @@ public:
 
     static QByteArray create(const HResourceUpdate&);
     static QByteArray create(const HDiscoveryRequest&);
+
+    // creates a unicast M-SEARCH in case the destination is not the
+    // multicast address
+    static QByteArray create(
+        const HDiscoveryRequest&, const HEndpoint& destination);
     static QByteArray create(const HDiscoveryResponse&);
     static QByteArray create(const HResourceAvailable&);
     static QByteArray create(const HResourceUnavailable&);
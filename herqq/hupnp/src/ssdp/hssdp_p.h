@@ -34,11 +34,14 @@
 #include "hdiscovery_messages.h"
 
 #include "../socket/hendpoint.h"
+#include "../general/htrace_p.h"
 #include "../general/hupnp_defs.h"
 #include "../http/hhttp_header_p.h"
 #include "../socket/hmulticast_socket.h"
 
+#include <QtCore/QList>
 #include <QtCore/QByteArray>
+#include <QtCore/QSharedData>
 
 class QUrl;
 class QString;
@@ -51,24 +54,70 @@ namespace Upnp
 {
 
 class HSsdp;
+class HSsdpReceiveThread;
+class HSsdpMulticastHub;
+
+//
+// Interface for handling repeated presence announcements and discovery
+// responses before they are parsed.
+//
+class HSsdpRepeatFilter
+{
+public:
+
+    virtual ~HSsdpRepeatFilter()
+    {
+    }
+
+    // the key identifies the announced resource and the state in which it
+    // was announced. returns true in case the message was handled as a
+    // repetition of an earlier message, in which case it is not parsed.
+    virtual bool handleRepeat(const QByteArray& key, const HEndpoint& source) = 0;
+};
+
+//
+// Implementation details of HSsdpMessage. Only the message of the type of
+// the instance is allocated, since most batches carry hundreds of responses.
+//
+class HSsdpMessagePrivate :
+    public QSharedData
+{
+private:
+
+    HSsdpMessagePrivate& operator=(const HSsdpMessagePrivate&);
+
+public:
+
+    HSsdp::AllowedMessage m_type;
+    HEndpoint m_source;
+    HSsdp::DiscoveryRequestMethod m_requestMethod;
+
+    HDiscoveryRequest* m_discoveryRequest;
+    HDiscoveryResponse* m_discoveryResponse;
+    HResourceAvailable* m_resourceAvailable;
+    HResourceUnavailable* m_resourceUnavailable;
+    HResourceUpdate* m_resourceUpdate;
+    // at most one of these is set, according to the type
+
+    HSsdpMessagePrivate();
+    HSsdpMessagePrivate(const HSsdpMessagePrivate&);
+    ~HSsdpMessagePrivate();
+};
 
 //
 // Implementation details of HSsdp
 //
-class HSsdpPrivate
+class H_UPNP_CORE_EXPORT HSsdpPrivate
 {
 H_DISABLE_COPY(HSsdpPrivate)
 
 private:
 
-    bool parseCacheControl(const QString&, qint32*);
-    bool checkHost(const QString& host);
+    bool parseCacheControl(const QByteArray&, qint32*);
+    bool checkHost(const QByteArray& host);
 
-    bool parseDiscoveryResponse(const HHttpResponseHeader&, HDiscoveryResponse*);
-    bool parseDiscoveryRequest (const HHttpRequestHeader&, HDiscoveryRequest*);
-    bool parseDeviceAvailable  (const HHttpRequestHeader&, HResourceAvailable*);
-    bool parseDeviceUnavailable(const HHttpRequestHeader&, HResourceUnavailable*);
-    bool parseDeviceUpdate     (const HHttpRequestHeader&, HResourceUpdate*);
+    // returns true in case the repeat filter handled the message
+    bool handleRepeat(const QByteArray& msg, const HEndpoint& source);
 
     void clear();
 
@@ -77,17 +126,49 @@ public: // attributes
     QByteArray m_loggingIdentifier;
 
     HMulticastSocket* m_multicastSocket;
-    // for listening multicast messages
+    // for listening multicast messages. null when the messages are received
+    // in a separate thread.
 
-    QUdpSocket* m_unicastSocket;
-    // for sending datagrams and listening messages directed to this instance
+    bool m_useReceiveThread;
+    HSsdpReceiveThread* m_receiveThread;
+    // owns the multicast socket and reads it in a thread of its own.
+    // null unless a receive thread is used.
+
+    bool m_shareMulticast;
+    HSsdpMulticastHub* m_multicastHub;
+    // the multicast socket shared with the other instances of the thread.
+    // not owned. null unless the multicast socket is shared.
+
+    HMulticastSocket* m_unicastSocket;
+    // for sending datagrams and listening messages directed to this instance.
+    // HMulticastSocket is used for its batched reads
+
+    qint32 m_receiveBufferSize;
+    qint32 m_sendBufferSize;
+    // zero means the default of the operating system
 
     HSsdp* q_ptr;
 
     HSsdp::AllowedMessages m_allowedMessages;
 
+    HSsdpRepeatFilter* m_repeatFilter;
+    // not owned. may be null.
+
+    QByteArray m_repeatKey;
+    // the repeat key of the message being processed. empty if the message
+    // was not offered to the repeat filter.
+
     QString m_lastError;
 
+    bool m_batchDelivery;
+    QList<HSsdpMessage> m_batch;
+    // the messages parsed but not yet delivered in batch delivery mode
+
+    qint64 m_messagesReceived[5];
+    qint64 m_messagesSent[5];
+    // the number of messages received and sent of each type, indexed by the
+    // position of the bit of the type in HSsdp::AllowedMessage
+
 public: // methods
 
     HSsdpPrivate(
@@ -95,22 +176,73 @@ public: // methods
 
     ~HSsdpPrivate();
 
+    // these do not touch the sockets or the q_ptr, which is why they can be
+    // used on an instance that is not initialized
+    bool parseDiscoveryResponse(
+        const HHttpResponseHeader&, HDiscoveryResponse*);
+    bool parseDiscoveryRequest (
+        const HHttpRequestHeader&, bool unicast, HDiscoveryRequest*);
+    bool parseDeviceAvailable  (const HHttpRequestHeader&, HResourceAvailable*);
+    bool parseDeviceUnavailable(
+        const HHttpRequestHeader&, HResourceUnavailable*);
+    bool parseDeviceUpdate     (const HHttpRequestHeader&, HResourceUpdate*);
+
     bool init(const QHostAddress& addressToBind);
 
     inline bool isInitialized() const
     {
-        return m_unicastSocket && m_multicastSocket;
+        return m_unicastSocket &&
+               (m_multicastSocket || m_receiveThread || m_multicastHub);
     }
 
-    void processNotify(const QString& msg, const HEndpoint& source);
-    void processSearch(const QString& msg, const HEndpoint& source,
-                       const HEndpoint& destination);
+    // the span traces the parsing of the message and it is advanced to the
+    // dispatch stage once the message has been parsed
+    void processNotify(
+        const QByteArray& msg, const HEndpoint& source, HTraceSpan& span);
+
+    void processSearch(const QByteArray& msg, const HEndpoint& source,
+                       const HEndpoint& destination, HTraceSpan& span);
 
-    void processResponse(const QString& msg, const HEndpoint& source);
+    void processResponse(
+        const QByteArray& msg, const HEndpoint& source, HTraceSpan& span);
+
+    // returns the HTTP header of the message. the header of a message
+    // dispatched by a multicast hub is parsed only once for all listeners
+    HHttpRequestHeader requestHeader(const QByteArray& msg);
 
     bool send(const QByteArray& data, const HEndpoint& receiver);
 
-    void messageReceived(QUdpSocket*, const HEndpoint* = 0);
+    // sends the specified datagrams in batches and returns the number of
+    // datagrams sent
+    qint32 send(const QList<QByteArray>& datagrams, const HEndpoint& receiver);
+
+    // multicasts the specified pre-serialized announcements
+    qint32 announce(const QList<QByteArray>& datagrams);
+
+    void applyReceiveBufferSize();
+    void applySendBufferSize();
+
+    // returns -1 in case none of the sockets counts its drops
+    qint64 kernelDrops() const;
+
+    void countReceived(HSsdp::AllowedMessage type);
+    void countSent(const QByteArray& datagram);
+
+    // writes a datagram that was sent to the traffic capture, if enabled
+    void capture(const QByteArray& datagram, const HEndpoint& receiver);
+
+    void processMessage(
+        const QByteArray& msg, const HEndpoint& source,
+        const HEndpoint& destination);
+
+    void messageReceived(HMulticastSocket*, const HEndpoint* = 0);
+
+    // delivers the messages collected in batch delivery mode, if any.
+    // the instance may be deleted during the call
+    void deliverBatch();
+
+    // processes datagrams queued by the receive thread
+    void queuedMessagesReceived();
 };
 
 }
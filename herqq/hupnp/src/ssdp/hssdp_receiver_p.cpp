@@ -0,0 +1,309 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "hssdp_receiver_p.h"
+#include "hssdp.h"
+
+#include "../general/hlogger_p.h"
+#include "../general/hmemoryaccount_p.h"
+#include "../socket/hmulticast_socket.h"
+
+#include <QtCore/QMetaObject>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace
+{
+// the number of datagrams read from the socket at once
+const qint32 MaxDatagramsPerRead = 64;
+
+// the number of datagrams queued before new datagrams are dropped
+const qint32 QueueCapacity = 1024;
+
+quint32 roundUpToPowerOfTwo(qint32 value)
+{
+    quint32 retVal = 1;
+    while (retVal < static_cast<quint32>(value))
+    {
+        retVal <<= 1;
+    }
+    return retVal;
+}
+}
+
+/*******************************************************************************
+ * HDatagramQueue
+ ******************************************************************************/
+HDatagramQueue::HDatagramQueue(qint32 capacity) :
+    m_entries(roundUpToPowerOfTwo(capacity)),
+    m_mask(m_entries.size() - 1),
+    m_head(0), m_tail(0)
+{
+    HMemoryAccount::get(HMemoryAccount::SsdpQueues)->add(
+        m_entries.size() * sizeof(Entry), 0);
+}
+
+HDatagramQueue::~HDatagramQueue()
+{
+    HMemoryAccount* account = HMemoryAccount::get(HMemoryAccount::SsdpQueues);
+
+    quint32 head = m_head.fetchAndAddAcquire(0);
+    quint32 tail = m_tail.fetchAndAddAcquire(0);
+    for(; head != tail; ++head)
+    {
+        account->remove(m_entries[head & m_mask].m_data.size());
+    }
+
+    account->remove(m_entries.size() * sizeof(Entry), 0);
+}
+
+bool HDatagramQueue::push(const QByteArray& data, const HEndpoint& source)
+{
+    quint32 tail = m_tail.fetchAndAddRelaxed(0);
+    quint32 head = m_head.fetchAndAddAcquire(0);
+
+    if (tail - head > m_mask)
+    {
+        return false;
+    }
+
+    Entry& entry = m_entries[tail & m_mask];
+    entry.m_data = data;
+    entry.m_source = source;
+
+    HMemoryAccount::get(HMemoryAccount::SsdpQueues)->add(data.size());
+
+    // publishes the entry to the consumer
+    m_tail.fetchAndStoreRelease(tail + 1);
+    return true;
+}
+
+bool HDatagramQueue::pop(QByteArray* data, HEndpoint* source)
+{
+    quint32 head = m_head.fetchAndAddRelaxed(0);
+    quint32 tail = m_tail.fetchAndAddAcquire(0);
+
+    if (head == tail)
+    {
+        return false;
+    }
+
+    Entry& entry = m_entries[head & m_mask];
+    *data = entry.m_data;
+    *source = entry.m_source;
+    entry.m_data.clear();
+
+    HMemoryAccount::get(HMemoryAccount::SsdpQueues)->remove(data->size());
+
+    // returns the entry to the producer
+    m_head.fetchAndStoreRelease(head + 1);
+    return true;
+}
+
+bool HDatagramQueue::isEmpty() const
+{
+    HDatagramQueue* self = const_cast<HDatagramQueue*>(this);
+    return self->m_head.fetchAndAddRelaxed(0) ==
+           self->m_tail.fetchAndAddAcquire(0);
+}
+
+/*******************************************************************************
+ * HSsdpReceiveThread
+ ******************************************************************************/
+HSsdpReceiveThread::HSsdpReceiveThread(
+    const QByteArray& loggingIdentifier, HSsdp* owner) :
+        QThread(),
+            m_loggingIdentifier(loggingIdentifier),
+            m_owner(owner),
+            m_address(),
+            m_receiveBufferSize(0),
+            m_socket(0),
+            m_queue(QueueCapacity),
+            m_wakeupPending(0),
+            m_kernelDrops(-1),
+            m_queueDrops(0),
+            m_started(0),
+            m_startOk(false)
+{
+    Q_ASSERT(m_owner);
+}
+
+HSsdpReceiveThread::~HSsdpReceiveThread()
+{
+    stopReceiving();
+}
+
+void HSsdpReceiveThread::run()
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    HMulticastSocket socket;
+    m_socket = &socket;
+
+    bool ok = connect(
+        &socket, SIGNAL(readyRead()), this, SLOT(readyRead_()),
+        Qt::DirectConnection);
+
+    Q_ASSERT(ok); Q_UNUSED(ok)
+
+    QHostAddress multicastAddress("239.255.255.250");
+
+    m_startOk = socket.bind(1900);
+    if (!m_startOk)
+    {
+        HLOG_WARN("Failed to bind multicast socket for listening");
+    }
+    else
+    {
+        if (!socket.joinMulticastGroup(multicastAddress, m_address))
+        {
+            HLOG_WARN(QString("Could not join %1").arg(
+                multicastAddress.toString()));
+        }
+
+        if (m_receiveBufferSize > 0)
+        {
+            socket.setReceiveBufferSize(m_receiveBufferSize);
+        }
+
+        if (socket.enableDropCounting())
+        {
+            m_kernelDrops.fetchAndStoreRelaxed(0);
+        }
+    }
+
+    m_started.release();
+
+    if (m_startOk)
+    {
+        exec();
+        socket.leaveMulticastGroup(multicastAddress, m_address);
+    }
+
+    m_socket = 0;
+}
+
+void HSsdpReceiveThread::readyRead_()
+{
+    QList<QByteArray> datagrams;
+    QList<HEndpoint> sources;
+
+    m_socket->readDatagrams(&datagrams, &sources, MaxDatagramsPerRead);
+
+    if (m_socket->droppedDatagrams() >= 0)
+    {
+        m_kernelDrops.fetchAndStoreRelaxed(
+            static_cast<int>(m_socket->droppedDatagrams()));
+    }
+
+    for (qint32 i = 0; i < datagrams.size(); ++i)
+    {
+        if (!m_queue.push(datagrams[i], sources[i]))
+        {
+            qint32 dropped = datagrams.size() - i;
+            m_queueDrops.fetchAndAddRelaxed(dropped);
+
+            HLOG_WARN(QString(
+                "Dropping [%1] SSDP datagrams: the receive queue is full").arg(
+                    QString::number(dropped)));
+            break;
+        }
+    }
+
+    if (!datagrams.isEmpty())
+    {
+        wakeup();
+    }
+}
+
+bool HSsdpReceiveThread::startReceiving(
+    const QHostAddress& addressToBind, qint32 receiveBufferSize)
+{
+    Q_ASSERT(!isRunning());
+
+    m_address = addressToBind;
+    m_receiveBufferSize = receiveBufferSize;
+
+    start();
+    m_started.acquire();
+
+    if (!m_startOk)
+    {
+        wait();
+    }
+
+    return m_startOk;
+}
+
+void HSsdpReceiveThread::stopReceiving()
+{
+    if (isRunning())
+    {
+        quit();
+        wait();
+    }
+}
+
+void HSsdpReceiveThread::setReceiveBufferSize(qint32 bytes)
+{
+    // setting a socket option is safe from any thread
+    m_receiveBufferSize = bytes;
+    if (m_socket && bytes > 0)
+    {
+        m_socket->setReceiveBufferSize(bytes);
+    }
+}
+
+qint64 HSsdpReceiveThread::kernelDrops() const
+{
+    HSsdpReceiveThread* self = const_cast<HSsdpReceiveThread*>(this);
+    qint32 drops = self->m_kernelDrops.fetchAndAddRelaxed(0);
+    // the kernel counter is unsigned
+    return drops == -1 ? -1 : static_cast<qint64>(static_cast<quint32>(drops));
+}
+
+qint64 HSsdpReceiveThread::queueDrops() const
+{
+    HSsdpReceiveThread* self = const_cast<HSsdpReceiveThread*>(this);
+    return self->m_queueDrops.fetchAndAddRelaxed(0);
+}
+
+void HSsdpReceiveThread::wakeupReceived()
+{
+    m_wakeupPending.fetchAndStoreOrdered(0);
+}
+
+void HSsdpReceiveThread::wakeup()
+{
+    if (m_wakeupPending.testAndSetOrdered(0, 1))
+    {
+        QMetaObject::invokeMethod(
+            m_owner, "multicastMessageReceived", Qt::QueuedConnection);
+    }
+}
+
+}
+}
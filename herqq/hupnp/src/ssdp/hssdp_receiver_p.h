@@ -0,0 +1,176 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef HSSDP_RECEIVER_P_H_
+#define HSSDP_RECEIVER_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include "../socket/hendpoint.h"
+#include "../general/hupnp_defs.h"
+
+#include <QtCore/QThread>
+#include <QtCore/QVector>
+#include <QtCore/QAtomicInt>
+#include <QtCore/QByteArray>
+#include <QtCore/QSemaphore>
+#include <QtNetwork/QHostAddress>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+class HSsdp;
+class HMulticastSocket;
+
+//
+// A fixed-size queue of received datagrams for exactly one producer thread
+// and one consumer thread. Neither side ever blocks or takes a lock: the
+// producer publishes an entry by advancing the tail and the consumer
+// releases an entry by advancing the head.
+//
+class HDatagramQueue
+{
+H_DISABLE_COPY(HDatagramQueue)
+
+private:
+
+    struct Entry
+    {
+        QByteArray m_data;
+        HEndpoint m_source;
+    };
+
+    QVector<Entry> m_entries;
+    const quint32 m_mask;
+
+    QAtomicInt m_head;
+    // the index of the next entry to pop. written only by the consumer.
+
+    QAtomicInt m_tail;
+    // the index of the next entry to push. written only by the producer.
+
+public:
+
+    // the capacity is rounded up to a power of two
+    explicit HDatagramQueue(qint32 capacity);
+    ~HDatagramQueue();
+
+    // returns false in case the queue is full, in which case the
+    // datagram is dropped. called only from the producer thread.
+    bool push(const QByteArray& data, const HEndpoint& source);
+
+    // returns false in case the queue is empty.
+    // called only from the consumer thread.
+    bool pop(QByteArray* data, HEndpoint* source);
+
+    // called only from the consumer thread
+    bool isEmpty() const;
+};
+
+//
+// A thread that owns the multicast socket of an HSsdp instance and reads
+// the datagrams arriving on it into a queue. The HSsdp instance is
+// notified through its event loop when the queue has new datagrams.
+//
+class HSsdpReceiveThread :
+    public QThread
+{
+Q_OBJECT
+H_DISABLE_COPY(HSsdpReceiveThread)
+
+private:
+
+    const QByteArray m_loggingIdentifier;
+
+    HSsdp* m_owner;
+    // the instance notified of received datagrams
+
+    QHostAddress m_address;
+    qint32 m_receiveBufferSize;
+
+    HMulticastSocket* m_socket;
+    // created, used and destroyed in run()
+
+    HDatagramQueue m_queue;
+
+    QAtomicInt m_wakeupPending;
+    // one when the owner has been notified of datagrams it has not yet read
+
+    QAtomicInt m_kernelDrops;
+    // the drop counter of the socket, or -1 if it is not counted
+
+    QAtomicInt m_queueDrops;
+    // the number of datagrams dropped because the queue was full
+
+    QSemaphore m_started;
+    bool m_startOk;
+
+private Q_SLOTS:
+
+    // invoked in this thread through a direct connection
+    void readyRead_();
+
+protected:
+
+    virtual void run();
+
+public:
+
+    HSsdpReceiveThread(const QByteArray& loggingIdentifier, HSsdp* owner);
+    virtual ~HSsdpReceiveThread();
+
+    // starts the thread, binds the multicast socket to the specified
+    // address and blocks until the socket is ready or has failed
+    bool startReceiving(
+        const QHostAddress& addressToBind, qint32 receiveBufferSize);
+
+    // stops the thread and waits for it to finish
+    void stopReceiving();
+
+    void setReceiveBufferSize(qint32 bytes);
+
+    // these can be called from any thread
+    qint64 kernelDrops() const;
+    qint64 queueDrops() const;
+
+    inline HDatagramQueue& queue() { return m_queue; }
+
+    // called by the owner before it reads the queue
+    void wakeupReceived();
+
+    // notifies the owner of queued datagrams unless already notified
+    void wakeup();
+};
+
+}
+}
+
+#endif /* HSSDP_RECEIVER_P_H_ */
@@ -0,0 +1,98 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hblockpool_p.h"
+
+#include <QtCore/QMutexLocker>
+
+#include <new>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+/*******************************************************************************
+ * HBlockPool
+ ******************************************************************************/
+HBlockPool::HBlockPool(std::size_t blockSize, int maxFreeBlocks) :
+    m_blockSize(blockSize),
+    m_maxFreeBlocks(maxFreeBlocks),
+    m_mutex(),
+    m_freeBlocks(0),
+    m_freeBlockCount(0)
+{
+    Q_ASSERT(blockSize >= sizeof(Block));
+}
+
+HBlockPool::~HBlockPool()
+{
+    while (m_freeBlocks)
+    {
+        Block* block = m_freeBlocks;
+        m_freeBlocks = block->m_next;
+        ::operator delete(block);
+    }
+}
+
+void* HBlockPool::allocate(std::size_t size)
+{
+    if (size == m_blockSize)
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_freeBlocks)
+        {
+            Block* block = m_freeBlocks;
+            m_freeBlocks = block->m_next;
+            --m_freeBlockCount;
+            return block;
+        }
+    }
+
+    return ::operator new(size);
+}
+
+void HBlockPool::release(void* block, std::size_t size)
+{
+    if (!block)
+    {
+        return;
+    }
+
+    if (size == m_blockSize)
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_freeBlockCount < m_maxFreeBlocks)
+        {
+            Block* freeBlock = static_cast<Block*>(block);
+            freeBlock->m_next = m_freeBlocks;
+            m_freeBlocks = freeBlock;
+            ++m_freeBlockCount;
+            return;
+        }
+    }
+
+    ::operator delete(block);
+}
+
+}
+}
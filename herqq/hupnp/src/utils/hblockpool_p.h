@@ -0,0 +1,89 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HBLOCKPOOL_P_H_
+#define HBLOCKPOOL_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include "../general/hupnp_defs.h"
+
+#include <QtCore/QMutex>
+
+#include <cstddef>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+//
+// A free list of fixed-size memory blocks, which is meant to be used from the
+// class-specific operator new and delete of objects that are created and
+// destroyed at a high rate. A released block is kept for reuse, unless
+// the pool already holds the maximum number of free blocks.
+//
+// Requests of another size, such as ones for derived classes, are passed to
+// the global allocation functions.
+//
+// This class is thread-safe, since blocks may be released in another
+// thread than the one in which they were allocated. A pool used by
+// operator delete should not be destroyed before the objects it serves,
+// which is why such pools are usually allocated once and never deleted.
+//
+class HBlockPool
+{
+H_DISABLE_COPY(HBlockPool)
+
+private:
+
+    struct Block
+    {
+        Block* m_next;
+    };
+
+    const std::size_t m_blockSize;
+    const int m_maxFreeBlocks;
+
+    QMutex m_mutex;
+    Block* m_freeBlocks;
+    int m_freeBlockCount;
+
+public:
+
+    HBlockPool(std::size_t blockSize, int maxFreeBlocks);
+    ~HBlockPool();
+
+    void* allocate(std::size_t size);
+    void release(void* block, std::size_t size);
+};
+
+}
+}
+
+#endif /* HBLOCKPOOL_P_H_ */
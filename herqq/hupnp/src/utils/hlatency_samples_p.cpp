@@ -0,0 +1,70 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "hlatency_samples_p.h"
+
+#include <QtCore/QtAlgorithms>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+/*******************************************************************************
+ * HLatencySamples
+ ******************************************************************************/
+HLatencySamples::HLatencySamples(qint32 capacity) :
+    m_samples(), m_next(0), m_capacity(qMax(1, capacity)), m_count(0)
+{
+}
+
+void HLatencySamples::add(qint32 msecs)
+{
+    ++m_count;
+    if (m_samples.size() < m_capacity)
+    {
+        m_samples.append(msecs);
+    }
+    else
+    {
+        m_samples[m_next] = msecs;
+        m_next = (m_next + 1) % m_capacity;
+    }
+}
+
+qint32 HLatencySamples::percentile(qint32 percentile) const
+{
+    if (m_samples.isEmpty())
+    {
+        return -1;
+    }
+
+    QVector<qint32> sorted = m_samples;
+    qSort(sorted);
+
+    qint32 index = (qBound(0, percentile, 100) * (sorted.size() - 1)) / 100;
+    return sorted.at(index);
+}
+
+}
+}
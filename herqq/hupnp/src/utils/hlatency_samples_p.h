@@ -0,0 +1,76 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef HLATENCY_SAMPLES_P_H_
+#define HLATENCY_SAMPLES_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include "../general/hupnp_defs.h"
+
+#include <QtCore/QVector>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+//
+// Keeps the latest durations of an operation for computing percentiles of them.
+// Once the capacity is reached, a new sample replaces the oldest one, which
+// keeps the memory use constant and the percentiles current.
+//
+class HLatencySamples
+{
+private:
+
+    QVector<qint32> m_samples;
+    qint32 m_next;
+    qint32 m_capacity;
+
+    qint64 m_count;
+    // the number of samples added, including the ones replaced since
+
+public:
+
+    explicit HLatencySamples(qint32 capacity = 1024);
+
+    void add(qint32 msecs);
+
+    // returns the specified percentile of the samples kept or -1 in case
+    // no sample has been added
+    qint32 percentile(qint32 percentile) const;
+
+    inline qint64 count() const { return m_count; }
+};
+
+}
+}
+
+#endif /* HLATENCY_SAMPLES_P_H_ */
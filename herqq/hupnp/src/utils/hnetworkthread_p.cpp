@@ -0,0 +1,159 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "hnetworkthread_p.h"
+
+#include <QtCore/QEvent>
+#include <QtCore/QSemaphore>
+#include <QtCore/QCoreApplication>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace
+{
+const QEvent::Type CallEvent =
+    static_cast<QEvent::Type>(QEvent::registerEventType());
+
+class HNetworkThreadCall :
+    public QEvent
+{
+public:
+
+    Functor<void> m_call;
+    QSemaphore* m_done;
+
+    HNetworkThreadCall(const Functor<void>& call, QSemaphore* done) :
+        QEvent(CallEvent), m_call(call), m_done(done)
+    {
+    }
+};
+}
+
+/*******************************************************************************
+ * HNetworkThreadAgent
+ ******************************************************************************/
+class HNetworkThreadAgent :
+    public QObject
+{
+H_DISABLE_COPY(HNetworkThreadAgent)
+
+public:
+
+    HNetworkThreadAgent() : QObject()
+    {
+    }
+
+    virtual bool event(QEvent* e)
+    {
+        if (e->type() != CallEvent)
+        {
+            return QObject::event(e);
+        }
+
+        HNetworkThreadCall* call = static_cast<HNetworkThreadCall*>(e);
+        call->m_call();
+        call->m_done->release();
+
+        return true;
+    }
+};
+
+/*******************************************************************************
+ * HNetworkThread
+ ******************************************************************************/
+HNetworkThread::HNetworkThread(QObject* object) :
+    QThread(),
+        m_object(object), m_agent(new HNetworkThreadAgent()),
+        m_returnThread(0)
+{
+    Q_ASSERT(m_object);
+}
+
+HNetworkThread::~HNetworkThread()
+{
+    Q_ASSERT(!isRunning());
+    delete m_agent;
+}
+
+void HNetworkThread::moveBack()
+{
+    m_object->moveToThread(m_returnThread);
+}
+
+bool HNetworkThread::attach()
+{
+    Q_ASSERT(m_object->thread() == QThread::currentThread());
+
+    if (m_object->parent())
+    {
+        return false;
+    }
+
+    // the objects are moved before the thread starts, which means that the
+    // thread begins with the events already posted to them
+    m_agent->moveToThread(this);
+    m_object->moveToThread(this);
+
+    start();
+    return true;
+}
+
+void HNetworkThread::execute(const Functor<void>& call)
+{
+    Q_ASSERT(QThread::currentThread() != this);
+    Q_ASSERT(isRunning());
+
+    QSemaphore done;
+    QCoreApplication::postEvent(m_agent, new HNetworkThreadCall(call, &done));
+    done.acquire();
+}
+
+void HNetworkThread::release()
+{
+    if (QThread::currentThread() == this)
+    {
+        // a thread cannot wait for itself to finish
+        bool ok = connect(this, SIGNAL(finished()), this, SLOT(deleteLater()));
+        Q_ASSERT(ok); Q_UNUSED(ok)
+
+        quit();
+        return;
+    }
+
+    if (isRunning())
+    {
+        m_returnThread = QThread::currentThread();
+        execute(Functor<void>(this, &HNetworkThread::moveBack));
+
+        quit();
+        wait();
+    }
+
+    delete this;
+}
+
+}
+}
@@ -0,0 +1,103 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef HNETWORKTHREAD_P_H_
+#define HNETWORKTHREAD_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include "hfunctor.h"
+#include "../general/hupnp_defs.h"
+
+#include <QtCore/QThread>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+class HNetworkThreadAgent;
+
+//
+// A thread in which a control point or a device host does all of its
+// networking, so that the networking does not compete with the other work
+// of the thread that created the object.
+//
+// The object is moved into the thread by attach(). From then on the calls
+// the object receives from other threads are run in the thread by execute(),
+// which blocks the calling thread until the call has been run.
+//
+class HNetworkThread :
+    public QThread
+{
+H_DISABLE_COPY(HNetworkThread)
+
+private:
+
+    QObject* m_object;
+    // the object run in this thread; not owned
+
+    HNetworkThreadAgent* m_agent;
+    // lives in this thread and runs the calls made through execute()
+
+    QThread* m_returnThread;
+    // the thread the object is moved back to when it is released
+
+    void moveBack();
+
+public:
+
+    explicit HNetworkThread(QObject* object);
+    virtual ~HNetworkThread();
+
+    //
+    // Moves the object into this thread and starts the thread. This has
+    // to be called from the thread of the object, and it fails in case the
+    // object has a parent
+    //
+    bool attach();
+
+    //
+    // Runs the specified call in this thread and waits for it to complete.
+    // This must not be called from this thread
+    //
+    void execute(const Functor<void>& call);
+
+    //
+    // Moves the object back into the calling thread, stops this thread and
+    // deletes this instance. When called from this thread, the object is left
+    // where it is and the instance is deleted once the thread has finished
+    //
+    void release();
+};
+
+}
+}
+
+#endif /* HNETWORKTHREAD_P_H_ */
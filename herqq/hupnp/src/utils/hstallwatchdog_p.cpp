@@ -0,0 +1,178 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hstallwatchdog_p.h"
+
+#include "../general/hlogger_p.h"
+
+#include <QtCore/QTimerEvent>
+#include <QtCore/QMutexLocker>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+/*******************************************************************************
+ * HStallWatchdog::Scope
+ ******************************************************************************/
+HStallWatchdog::Scope::Scope(HStallWatchdog* owner, const QString& name) :
+    m_owner(0), m_outer(0), m_kind(0), m_name(&name), m_timer(),
+    m_inner(false)
+{
+    enter(owner);
+}
+
+HStallWatchdog::Scope::Scope(
+    HStallWatchdog* owner, const QString& kind, const QString& name) :
+        m_owner(0), m_outer(0), m_kind(&kind), m_name(&name), m_timer(),
+        m_inner(false)
+{
+    enter(owner);
+}
+
+void HStallWatchdog::Scope::enter(HStallWatchdog* owner)
+{
+    if (owner && owner->m_threshold > 0)
+    {
+        m_owner = owner;
+        m_outer = owner->m_scope;
+        owner->m_scope = this;
+        m_timer.start();
+    }
+}
+
+HStallWatchdog::Scope::~Scope()
+{
+    if (!m_owner)
+    {
+        return;
+    }
+
+    m_owner->m_scope = m_outer;
+
+    qint64 elapsed = m_timer.elapsed();
+    if (m_owner->m_threshold <= 0 || elapsed < m_owner->m_threshold)
+    {
+        return;
+    }
+
+    if (!m_inner)
+    {
+        m_owner->record(
+            m_kind ? QString("%1 %2").arg(*m_kind, *m_name) : *m_name,
+            elapsed);
+    }
+
+    if (m_outer)
+    {
+        m_outer->m_inner = true;
+    }
+    m_owner->m_attributed = true;
+}
+
+/*******************************************************************************
+ * HStallWatchdog
+ ******************************************************************************/
+HStallWatchdog::HStallWatchdog(
+    const QByteArray& loggingIdentifier, QObject* parent) :
+        QObject(parent),
+            m_loggingIdentifier(loggingIdentifier),
+            m_threshold(0),
+            m_timerId(0),
+            m_heartbeat(),
+            m_scope(0),
+            m_attributed(false),
+            m_mutex(),
+            m_stalls()
+{
+}
+
+HStallWatchdog::~HStallWatchdog()
+{
+}
+
+void HStallWatchdog::record(const QString& identity, qint64 msecs)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    qint32 duration = static_cast<qint32>(qMin(msecs, qint64(0x7fffffff)));
+    {
+        QMutexLocker locker(&m_mutex);
+        HStallStatistics& stats = m_stalls[identity];
+        ++stats.m_count;
+        stats.m_worst = qMax(stats.m_worst, duration);
+    }
+
+    HLOG_WARN(QString("The event loop was blocked for %1 ms by [%2]").arg(
+        QString::number(duration),
+        identity.isEmpty() ? QString("an untracked handler") : identity));
+}
+
+void HStallWatchdog::timerEvent(QTimerEvent* event)
+{
+    if (event->timerId() != m_timerId)
+    {
+        QObject::timerEvent(event);
+        return;
+    }
+
+    // the heartbeat should fire once per threshold. the time it was late
+    // is the time the event loop could not run
+    qint64 late = m_heartbeat.restart() - m_threshold;
+    if (late >= m_threshold && !m_attributed)
+    {
+        record(QString(), late);
+    }
+    m_attributed = false;
+}
+
+void HStallWatchdog::setThreshold(qint32 msecs)
+{
+    if (msecs < 0)
+    {
+        return;
+    }
+
+    if (m_timerId)
+    {
+        killTimer(m_timerId);
+        m_timerId = 0;
+    }
+
+    m_threshold = msecs;
+    m_attributed = false;
+    if (msecs > 0)
+    {
+        m_timerId = startTimer(msecs);
+        m_heartbeat.start();
+    }
+}
+
+QHash<QString, HStallStatistics> HStallWatchdog::stalls() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_stalls;
+}
+
+}
+}
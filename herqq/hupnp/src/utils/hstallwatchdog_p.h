@@ -0,0 +1,164 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HSTALLWATCHDOG_P_H_
+#define HSTALLWATCHDOG_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include "hglobal.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QObject>
+#include <QtCore/QString>
+#include <QtCore/QElapsedTimer>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+//
+// The stalls recorded for a single handler
+//
+class HStallStatistics
+{
+public:
+
+    qint64 m_count;
+    // the number of times the handler ran longer than the threshold
+
+    qint32 m_worst;
+    // the longest run of the handler in msecs
+
+    HStallStatistics() : m_count(0), m_worst(0) {}
+};
+
+//
+// Detects the handlers that block the event loop of the thread it lives in.
+//
+// Every dispatched handler is timed by a Scope, which records a stall under
+// the identity of the handler once the handler runs longer than the threshold.
+// In case scopes are nested, a stall is recorded only for the innermost scope
+// that exceeded the threshold, since the outer ones were merely waiting for it.
+// In addition, a heartbeat timer that should fire once per threshold catches
+// the stalls of the handlers that are not timed by scopes. These are recorded
+// under an empty identity, unless a scope recorded a stall during the same
+// heartbeat.
+//
+// The statistics can be read from any thread. Everything else has to be
+// done in the thread the watchdog lives in.
+//
+class HStallWatchdog :
+    public QObject
+{
+Q_OBJECT
+H_DISABLE_COPY(HStallWatchdog)
+
+public:
+
+    class Scope
+    {
+    H_DISABLE_COPY(Scope)
+
+    private:
+
+        HStallWatchdog* m_owner;
+        // null if the watchdog is disabled
+
+        Scope* m_outer;
+        const QString* m_kind;
+        // null if the identity is the name alone
+        const QString* m_name;
+        QElapsedTimer m_timer;
+
+        bool m_inner;
+        // whether a nested scope recorded a stall
+
+        void enter(HStallWatchdog* owner);
+
+    public:
+
+        // the identity of the handler is the name, such as the name of
+        // an action, or the kind followed by the name, such as the HTTP method
+        // and the path. the identity is built only once a stall is detected,
+        // which is why the strings have to outlive the scope
+        Scope(HStallWatchdog* owner, const QString& name);
+        Scope(HStallWatchdog* owner, const QString& kind, const QString& name);
+
+        ~Scope();
+    };
+
+private:
+
+    const QByteArray m_loggingIdentifier;
+
+    qint32 m_threshold;
+    // in msecs, zero if the watchdog is disabled
+
+    qint32 m_timerId;
+    QElapsedTimer m_heartbeat;
+    // the time since the heartbeat fired last
+
+    Scope* m_scope;
+    // the innermost scope that is running
+
+    bool m_attributed;
+    // whether a scope recorded a stall after the heartbeat fired last
+
+    mutable QMutex m_mutex;
+    QHash<QString, HStallStatistics> m_stalls;
+    // guarded by the mutex
+
+    void record(const QString& identity, qint64 msecs);
+
+protected:
+
+    virtual void timerEvent(QTimerEvent*);
+
+public:
+
+    HStallWatchdog(const QByteArray& loggingIdentifier, QObject* parent = 0);
+    virtual ~HStallWatchdog();
+
+    // zero disables the watchdog, which is the default. negative values
+    // are ignored
+    void setThreshold(qint32 msecs);
+
+    inline qint32 threshold() const { return m_threshold; }
+
+    // the stalls recorded by the identity of the handler. the stalls caught
+    // only by the heartbeat are under an empty identity
+    QHash<QString, HStallStatistics> stalls() const;
+};
+
+}
+}
+
+#endif /* HSTALLWATCHDOG_P_H_ */
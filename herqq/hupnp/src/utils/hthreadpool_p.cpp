@@ -32,7 +32,7 @@ namespace Upnp
  ******************************************************************************/
 HRunnable::HRunnable() :
     m_status(NotStarted), m_statusMutex(), m_statusWait(),
-    m_owner(0), m_doNotInform(false)
+    m_owner(0), m_doNotInform(false), m_queuePriority(0)
 {
 }
 
@@ -49,7 +49,11 @@ void HRunnable::signalTaskComplete()
     QMutexLocker locker(&m_statusMutex);
     Q_ASSERT(m_status == RunningTask);
     m_status = WaitingNewTask;
-    m_statusWait.wakeOne();
+    m_statusWait.wakeAll();
+}
+
+void HRunnable::cancel()
+{
 }
 
 void HRunnable::signalExit()
@@ -61,23 +65,29 @@ void HRunnable::signalExit()
     }
     m_status = Exiting;
     m_statusWait.wakeAll();
+    locker.unlock();
+
+    cancel();
 }
 
 HRunnable::Status HRunnable::wait()
 {
     QMutexLocker locker(&m_statusMutex);
     Q_ASSERT(m_status != NotStarted);
-    for(;;)
-    {
-        if (m_status == Exiting || m_status == WaitingNewTask)
-        {
-            return m_status;
-        }
 
-        m_statusWait.wait(&m_statusMutex, 100);
+    // every change of the status wakes the waiters
+    while (m_status != Exiting && m_status != WaitingNewTask)
+    {
+        m_statusWait.wait(&m_statusMutex);
     }
 
-    return Exiting;
+    return m_status;
+}
+
+bool HRunnable::isExiting()
+{
+    QMutexLocker locker(&m_statusMutex);
+    return m_status == Exiting;
 }
 
 bool HRunnable::setupNewTask()
@@ -92,12 +102,54 @@ bool HRunnable::setupNewTask()
     return true;
 }
 
+/*******************************************************************************
+ * HThreadPoolTask
+ ******************************************************************************/
+//
+// Runs a runnable of an HThreadPool in the thread pool and informs the
+// HThreadPool when the runnable completes. Used so that an HThreadPool can
+// track its own runnables in a thread pool shared with other instances.
+//
+class HThreadPoolTask :
+    public QRunnable
+{
+private:
+
+    HThreadPool* m_owner;
+    HRunnable* m_runnable;
+
+public:
+
+    HThreadPoolTask(HThreadPool* owner, HRunnable* runnable) :
+        m_owner(owner), m_runnable(runnable)
+    {
+        setAutoDelete(true);
+    }
+
+    virtual void run()
+    {
+        bool autoDelete = m_runnable->autoDelete();
+
+        m_runnable->run();
+
+        if (autoDelete)
+        {
+            delete m_runnable;
+        }
+
+        m_owner->taskDone();
+    }
+};
+
 /*******************************************************************************
  * HThreadPool
  ******************************************************************************/
 HThreadPool::HThreadPool(QObject* parent) :
     QObject(parent),
-        m_threadPool(new QThreadPool(this))
+        m_ownThreadPool(new QThreadPool(this)),
+        m_threadPool(m_ownThreadPool),
+        m_runnables(), m_runnablesMutex(), m_queue(),
+        m_maxConcurrency(0), m_priority(0), m_running(0), m_idle()
 {
 }
 
@@ -120,7 +172,31 @@ void HThreadPool::exiting(HRunnable* runnable)
     }
 }
 
-void HThreadPool::start(HRunnable* runnable)
+void HThreadPool::dispatch()
+{
+    while (!m_queue.isEmpty() &&
+           (m_maxConcurrency <= 0 || m_running < m_maxConcurrency))
+    {
+        ++m_running;
+        m_threadPool->start(
+            new HThreadPoolTask(this, m_queue.takeFirst()), m_priority);
+    }
+}
+
+void HThreadPool::taskDone()
+{
+    QMutexLocker locker(&m_runnablesMutex);
+
+    --m_running;
+    dispatch();
+
+    if (!m_running)
+    {
+        m_idle.wakeAll();
+    }
+}
+
+void HThreadPool::start(HRunnable* runnable, qint32 queuePriority)
 {
     Q_ASSERT(runnable);
     Q_ASSERT(runnable->m_status == HRunnable::NotStarted);
@@ -128,12 +204,21 @@ void HThreadPool::start(HRunnable* runnable)
 
     runnable->m_status = HRunnable::WaitingNewTask;
     runnable->m_owner = this;
+    runnable->m_queuePriority = queuePriority;
 
     QMutexLocker locker(&m_runnablesMutex);
     m_runnables.append(runnable);
-    locker.unlock();
 
-    m_threadPool->start(runnable);
+    // usually every runnable has the same priority and the runnable is
+    // appended without a scan
+    qint32 i = m_queue.size();
+    while (i > 0 && m_queue[i - 1]->m_queuePriority < queuePriority)
+    {
+        --i;
+    }
+    m_queue.insert(i, runnable);
+
+    dispatch();
 }
 
 void HThreadPool::shutdown()
@@ -145,9 +230,39 @@ void HThreadPool::shutdown()
         m_runnables.at(i)->signalExit();
     }
     m_runnables.clear();
-    locker.unlock();
 
-    m_threadPool->waitForDone();
+    // the runnables that are still queued are run as well, as the owners
+    // of the runnables expect every started runnable to run
+    qint32 maxConcurrency = m_maxConcurrency;
+    m_maxConcurrency = 0;
+    dispatch();
+    m_maxConcurrency = maxConcurrency;
+
+    while (m_running > 0)
+    {
+        m_idle.wait(&m_runnablesMutex);
+    }
+}
+
+void HThreadPool::setThreadPool(QThreadPool* sharedPool)
+{
+    QMutexLocker locker(&m_runnablesMutex);
+    Q_ASSERT(!m_running && m_queue.isEmpty());
+
+    m_threadPool = sharedPool ? sharedPool : m_ownThreadPool;
+}
+
+void HThreadPool::setMaxConcurrency(qint32 count)
+{
+    QMutexLocker locker(&m_runnablesMutex);
+    m_maxConcurrency = count < 0 ? 0 : count;
+    dispatch();
+}
+
+void HThreadPool::setPriority(qint32 priority)
+{
+    QMutexLocker locker(&m_runnablesMutex);
+    m_priority = priority;
 }
 
 }
@@ -46,6 +46,7 @@ namespace Upnp
 {
 
 class HThreadPool;
+class HThreadPoolTask;
 
 //
 //
@@ -76,6 +77,16 @@ private:
     HThreadPool* m_owner;
     bool m_doNotInform;
 
+    qint32 m_queuePriority;
+    // the priority of the runnable in the queue of the owner
+
+protected:
+
+    // called from the thread that shuts down the thread pool, while the
+    // runnable may be running in another thread. a runnable that blocks
+    // should make its wait end promptly
+    virtual void cancel();
+
 public:
 
     HRunnable();
@@ -87,6 +98,10 @@ public:
     Status wait();
 
     bool setupNewTask();
+
+    // returns true once the thread pool has been shut down, in which case
+    // a runnable that has not started its work should not start it
+    bool isExiting();
 };
 
 //
@@ -98,23 +113,59 @@ class HThreadPool :
 Q_OBJECT
 H_DISABLE_COPY(HThreadPool)
 friend class HRunnable;
+friend class HThreadPoolTask;
 
 private:
 
+    QThreadPool* m_ownThreadPool;
     QThreadPool* m_threadPool;
+    // either the own thread pool or a thread pool shared with other
+    // instances, which is not owned
+
     QList<HRunnable*> m_runnables;
     QMutex m_runnablesMutex;
 
+    QList<HRunnable*> m_queue;
+    // the runnables waiting for a free slot within m_maxConcurrency, in
+    // the descending order of their queue priorities. runnables of the same
+    // priority are kept in the order they were started
+
+    qint32 m_maxConcurrency;
+    // the maximum number of runnables of this instance that run at the same
+    // time. zero means that only the thread pool limits the concurrency
+
+    qint32 m_priority;
+    // the priority of the runnables in the queue of the thread pool
+
+    qint32 m_running;
+    // the number of runnables handed to the thread pool that have not
+    // completed. guarded by m_runnablesMutex, like the queue
+
+    QWaitCondition m_idle;
+
     void exiting(HRunnable*);
 
+    // m_runnablesMutex has to be locked
+    void dispatch();
+    void taskDone();
+
 public:
 
     HThreadPool(QObject* parent);
     virtual ~HThreadPool();
 
-    void start(HRunnable*);
+    // a runnable with a higher queue priority is dispatched before the
+    // queued runnables of lower priority
+    void start(HRunnable*, qint32 queuePriority = 0);
     void shutdown();
 
+    // the instance must not have runnables when the thread pool is changed.
+    // a null pointer makes the instance use a thread pool of its own
+    void setThreadPool(QThreadPool* sharedPool);
+
+    void setMaxConcurrency(qint32 count);
+    void setPriority(qint32 priority);
+
     inline void setMaxThreadCount(qint32 count)
     {
         m_threadPool->setMaxThreadCount(count);
@@ -0,0 +1,320 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "htimerwheel_p.h"
+
+#include <QtCore/QTimerEvent>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+/*******************************************************************************
+ * HTimerWheelEntry
+ ******************************************************************************/
+HTimerWheelEntry::HTimerWheelEntry() :
+    HTimerWheelLink(), m_wheel(0), m_expirationTick(0)
+{
+}
+
+HTimerWheelEntry::~HTimerWheelEntry()
+{
+    if (m_wheel)
+    {
+        m_wheel->cancel(this);
+    }
+}
+
+/*******************************************************************************
+ * HTimerWheel::Invocation
+ ******************************************************************************/
+class HTimerWheel::Invocation :
+    public HTimerWheelEntry
+{
+H_DISABLE_COPY(Invocation)
+
+private:
+
+    HTimerWheel* m_owner;
+
+protected:
+
+    virtual void timerExpired()
+    {
+        // the slot may schedule the target again, which is why the
+        // invocation is released before the slot is invoked
+        QObject* target = m_target;
+        const char* member = m_member;
+
+        m_owner->m_invocations.remove(target);
+        delete this;
+
+        QMetaObject::invokeMethod(target, member);
+    }
+
+public:
+
+    QObject* const m_target;
+    const char* m_member;
+
+    Invocation(HTimerWheel* owner, QObject* target, const char* member) :
+        HTimerWheelEntry(), m_owner(owner), m_target(target), m_member(member)
+    {
+    }
+};
+
+/*******************************************************************************
+ * HTimerWheel
+ ******************************************************************************/
+HTimerWheel::HTimerWheel(qint32 tickMsecs, QObject* parent) :
+    QObject(parent),
+        m_tickMsecs(qMax(1, tickMsecs)),
+        m_currentTick(0),
+        m_count(0),
+        m_clock(),
+        m_timer(),
+        m_invocations()
+{
+    m_clock.start();
+}
+
+HTimerWheel::~HTimerWheel()
+{
+    qDeleteAll(m_invocations);
+
+    // the remaining timers are detached so that they do not refer to
+    // a deleted wheel
+    for (qint32 i = 0; i < InnerSlots; ++i)
+    {
+        while (m_inner[i].isLinked())
+        {
+            cancel(static_cast<HTimerWheelEntry*>(m_inner[i].m_next));
+        }
+    }
+
+    for (qint32 i = 0; i < OuterSlots; ++i)
+    {
+        while (m_outer[i].isLinked())
+        {
+            cancel(static_cast<HTimerWheelEntry*>(m_outer[i].m_next));
+        }
+    }
+}
+
+qint64 HTimerWheel::now() const
+{
+    return m_clock.elapsed() / m_tickMsecs;
+}
+
+void HTimerWheel::insert(HTimerWheelEntry* entry)
+{
+    qint64 expirationTick = qMax(entry->m_expirationTick, m_currentTick + 1);
+
+    if (expirationTick - m_currentTick < InnerSlots)
+    {
+        entry->linkBefore(&m_inner[expirationTick & (InnerSlots - 1)]);
+    }
+    else if ((expirationTick >> InnerBits) - (m_currentTick >> InnerBits) <
+             OuterSlots)
+    {
+        entry->linkBefore(
+            &m_outer[(expirationTick >> InnerBits) & (OuterSlots - 1)]);
+    }
+    else
+    {
+        // parked in the slot that is cascaded last, after which
+        // the timer is inserted again
+        entry->linkBefore(
+            &m_outer[((m_currentTick >> InnerBits) + OuterSlots - 1) &
+                (OuterSlots - 1)]);
+    }
+}
+
+void HTimerWheel::cascade()
+{
+    HTimerWheelLink& slot =
+        m_outer[(m_currentTick >> InnerBits) & (OuterSlots - 1)];
+
+    HTimerWheelLink pending;
+    if (slot.isLinked())
+    {
+        pending.linkBefore(&slot);
+        slot.unlink();
+    }
+
+    while (pending.isLinked())
+    {
+        HTimerWheelEntry* entry =
+            static_cast<HTimerWheelEntry*>(pending.m_next);
+        entry->unlink();
+        insert(entry);
+    }
+}
+
+void HTimerWheel::expire(HTimerWheelLink* slot)
+{
+    // the timers are moved to a separate list first, since the callbacks
+    // may arm and cancel timers, including the ones in this slot
+    HTimerWheelLink pending;
+    if (slot->isLinked())
+    {
+        pending.linkBefore(slot);
+        slot->unlink();
+    }
+
+    while (pending.isLinked())
+    {
+        HTimerWheelEntry* entry =
+            static_cast<HTimerWheelEntry*>(pending.m_next);
+        entry->unlink();
+
+        if (entry->m_expirationTick > m_currentTick)
+        {
+            insert(entry);
+            continue;
+        }
+
+        entry->m_wheel = 0;
+        --m_count;
+
+        entry->timerExpired();
+    }
+}
+
+void HTimerWheel::timerEvent(QTimerEvent* event)
+{
+    if (event->timerId() != m_timer.timerId())
+    {
+        QObject::timerEvent(event);
+        return;
+    }
+
+    qint64 nowTick = now();
+    while (m_count > 0 && m_currentTick < nowTick)
+    {
+        ++m_currentTick;
+        if ((m_currentTick & (InnerSlots - 1)) == 0)
+        {
+            cascade();
+        }
+
+        expire(&m_inner[m_currentTick & (InnerSlots - 1)]);
+    }
+
+    if (m_count <= 0)
+    {
+        m_timer.stop();
+    }
+}
+
+void HTimerWheel::arm(HTimerWheelEntry* entry, qint32 msecs)
+{
+    Q_ASSERT(entry);
+    Q_ASSERT_X(!entry->m_wheel || entry->m_wheel == this, H_AT,
+        "The timer is armed in another wheel.");
+
+    if (entry->m_wheel)
+    {
+        entry->unlink();
+    }
+    else
+    {
+        if (m_count++ == 0)
+        {
+            // nothing is armed and no ticks need to be processed
+            m_currentTick = now();
+            m_timer.start(m_tickMsecs, this);
+        }
+
+        entry->m_wheel = this;
+    }
+
+    entry->m_expirationTick =
+        now() + (qMax(0, msecs) + m_tickMsecs - 1) / m_tickMsecs;
+
+    insert(entry);
+}
+
+void HTimerWheel::cancel(HTimerWheelEntry* entry)
+{
+    Q_ASSERT(entry);
+    if (entry->m_wheel != this)
+    {
+        return;
+    }
+
+    entry->unlink();
+    entry->m_wheel = 0;
+
+    if (--m_count == 0)
+    {
+        m_timer.stop();
+    }
+}
+
+void HTimerWheel::schedule(
+    QObject* target, const char* member, qint32 msecs, qint32 jitterInMsecs)
+{
+    Q_ASSERT(target);
+    Q_ASSERT(member);
+
+    Invocation* invocation = m_invocations.value(target);
+    if (!invocation)
+    {
+        invocation = new Invocation(this, target, member);
+        m_invocations.insert(target, invocation);
+    }
+    else
+    {
+        invocation->m_member = member;
+    }
+
+    if (jitterInMsecs > 0 && msecs > 0)
+    {
+        msecs -= qrand() % (qMin(jitterInMsecs, msecs) + 1);
+    }
+
+    arm(invocation, msecs);
+}
+
+void HTimerWheel::unschedule(QObject* target)
+{
+    // the entry cancels itself when it is deleted
+    delete m_invocations.take(target);
+}
+
+qint64 HTimerWheel::remainingTime(QObject* target) const
+{
+    const HTimerWheelEntry* entry = m_invocations.value(target);
+    if (!entry)
+    {
+        return -1;
+    }
+
+    // the tick is processed once its start has passed
+    return qMax(
+        entry->m_expirationTick * m_tickMsecs - m_clock.elapsed(), qint64(0));
+}
+
+}
+}
@@ -0,0 +1,224 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HTIMERWHEEL_P_H_
+#define HTIMERWHEEL_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include "../general/hupnp_defs.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QObject>
+#include <QtCore/QBasicTimer>
+#include <QtCore/QElapsedTimer>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+class HTimerWheel;
+
+//
+// A node of the intrusive, circular and doubly-linked lists that hold the
+// timers of each slot of an HTimerWheel
+//
+class HTimerWheelLink
+{
+H_DISABLE_COPY(HTimerWheelLink)
+friend class HTimerWheel;
+
+private:
+
+    HTimerWheelLink* m_prev;
+    HTimerWheelLink* m_next;
+
+protected:
+
+    inline HTimerWheelLink() : m_prev(this), m_next(this) {}
+
+    inline bool isLinked() const { return m_next != this; }
+
+    inline void unlink()
+    {
+        m_prev->m_next = m_next;
+        m_next->m_prev = m_prev;
+        m_prev = m_next = this;
+    }
+
+    inline void linkBefore(HTimerWheelLink* other)
+    {
+        m_next = other;
+        m_prev = other->m_prev;
+        other->m_prev->m_next = this;
+        other->m_prev = this;
+    }
+};
+
+//
+// A timer that can be armed in an HTimerWheel. The timer is cancelled when
+// the object is destroyed.
+//
+class HTimerWheelEntry :
+    public HTimerWheelLink
+{
+H_DISABLE_COPY(HTimerWheelEntry)
+friend class HTimerWheel;
+
+private:
+
+    HTimerWheel* m_wheel;
+    // the wheel the timer is armed in, if any
+
+    qint64 m_expirationTick;
+
+protected:
+
+    // called when the timer expires. the timer is no longer armed at this
+    // point and it can be re-armed
+    virtual void timerExpired() = 0;
+
+public:
+
+    HTimerWheelEntry();
+    virtual ~HTimerWheelEntry();
+
+    inline bool isArmed() const { return m_wheel; }
+};
+
+//
+// Tracks a large number of timeouts using a single timer of the event loop.
+//
+// The wheel has two levels. The inner level has a slot for each tick of the
+// next 256 ticks and the outer level has a slot for each 256 ticks after
+// those. When a round of the inner level completes, the timers in the next
+// outer slot are moved to the inner level. Timers further away than the
+// outer level covers are parked in its last slot and re-inserted when the
+// slot is reached.
+//
+// Arming and cancelling a timer are constant-time operations and the expiry
+// of a timer is accurate to a single tick. The event loop timer is running
+// only while at least one timer is armed.
+//
+// A timer is either an HTimerWheelEntry the caller embeds in its own object,
+// or a slot of a QObject scheduled with schedule(), in which case the wheel
+// allocates the entry. Each QObject has at most one slot scheduled at a time
+// and it has to be unscheduled before the object is deleted.
+//
+// This class is not thread-safe.
+//
+class HTimerWheel :
+    public QObject
+{
+Q_OBJECT
+H_DISABLE_COPY(HTimerWheel)
+
+private:
+
+    enum
+    {
+        InnerBits = 8,
+        InnerSlots = 1 << InnerBits,
+        OuterSlots = 64
+    };
+
+    const qint32 m_tickMsecs;
+
+    HTimerWheelLink m_inner[InnerSlots];
+    HTimerWheelLink m_outer[OuterSlots];
+
+    qint64 m_currentTick;
+    // the last tick that has been processed
+
+    qint32 m_count;
+    // the number of timers armed
+
+    QElapsedTimer m_clock;
+    QBasicTimer m_timer;
+
+    class Invocation;
+    QHash<QObject*, Invocation*> m_invocations;
+    // the timers of the objects scheduled with schedule(). owned
+
+    qint64 now() const;
+    void insert(HTimerWheelEntry*);
+    void cascade();
+    void expire(HTimerWheelLink* slot);
+
+protected:
+
+    virtual void timerEvent(QTimerEvent*);
+
+public:
+
+    explicit HTimerWheel(qint32 tickMsecs = 100, QObject* parent = 0);
+    virtual ~HTimerWheel();
+
+    //
+    // arms the timer to expire after the specified number of milliseconds.
+    // a timer that is already armed is re-armed.
+    //
+    void arm(HTimerWheelEntry*, qint32 msecs);
+
+    //
+    // cancels the timer, if it is armed in this wheel
+    //
+    void cancel(HTimerWheelEntry*);
+
+    //
+    // schedules the member slot of the target to be invoked once msecs has
+    // elapsed. the timeout is randomly advanced by at most jitterInMsecs,
+    // which spreads timeouts of the same duration that are scheduled
+    // together. a timeout the target already had is replaced
+    //
+    void schedule(
+        QObject* target, const char* member, qint32 msecs,
+        qint32 jitterInMsecs = 0);
+
+    void unschedule(QObject* target);
+
+    //
+    // returns the time in msecs until the timeout of the target elapses or
+    // -1 in case the target has no timeout scheduled
+    //
+    qint64 remainingTime(QObject* target) const;
+
+    inline bool isScheduled(QObject* target) const
+    {
+        return m_invocations.contains(target);
+    }
+
+    inline qint32 count() const { return m_count; }
+    inline qint32 tickMsecs() const { return m_tickMsecs; }
+};
+
+}
+}
+
+#endif /* HTIMERWHEEL_P_H_ */
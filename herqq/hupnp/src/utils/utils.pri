@@ -3,12 +3,23 @@ HEADERS += \
     $$SRC_LOC/hfunctor.h \
     $$SRC_LOC/hglobal.h \
     $$SRC_LOC/hsysutils_p.h \
-    $$SRC_LOC/hthreadpool_p.h
+    $$SRC_LOC/hthreadpool_p.h \
+    $$SRC_LOC/hblockpool_p.h \
+    $$SRC_LOC/htimerwheel_p.h \
+    $$SRC_LOC/hlatency_samples_p.h \
+    $$SRC_LOC/hstallwatchdog_p.h \
+    $$SRC_LOC/hnetworkthread_p.h
     
 EXPORTED_PRIVATE_HEADERS += \
-    $$SRC_LOC/hmisc_utils_p.h
+    $$SRC_LOC/hmisc_utils_p.h \
+    $$SRC_LOC/htimerwheel_p.h
     
 SOURCES += \
     $$SRC_LOC/hmisc_utils_p.cpp \
     $$SRC_LOC/hsysutils_p.cpp \
-    $$SRC_LOC/hthreadpool_p.cpp
+    $$SRC_LOC/hthreadpool_p.cpp \
+    $$SRC_LOC/hblockpool_p.cpp \
+    $$SRC_LOC/htimerwheel_p.cpp \
+    $$SRC_LOC/hlatency_samples_p.cpp \
+    $$SRC_LOC/hstallwatchdog_p.cpp \
+    $$SRC_LOC/hnetworkthread_p.cpp
@@ -10,6 +10,8 @@ exists(options.pri) {
     include(options.pri)
 }
 
+CONFIG(DISABLE_TRACE) : DEFINES += HUPNP_NO_TRACE
+
 INCLUDEPATH += ./include/
 
 isEmpty(PREFIX) {
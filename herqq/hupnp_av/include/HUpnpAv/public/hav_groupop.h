@@ -0,0 +1 @@
+#include "../../../src/controlpoint/hav_groupop.h"
@@ -0,0 +1 @@
+#include "../../../src/cds_model/datasource/hcds_metadata_extractor.h"
@@ -0,0 +1 @@
+#include "../../../src/cds_model/model_mgmt/hcds_objectview.h"
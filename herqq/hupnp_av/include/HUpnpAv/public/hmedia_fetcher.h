@@ -0,0 +1 @@
+#include "../../../src/mediarenderer/hmedia_fetcher.h"
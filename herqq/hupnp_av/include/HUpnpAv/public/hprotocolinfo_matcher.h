@@ -0,0 +1 @@
+#include "../../../src/common/hprotocolinfo_matcher.h"
@@ -0,0 +1 @@
+#include "../../../src/mediaserver/hthumbnail_generator.h"
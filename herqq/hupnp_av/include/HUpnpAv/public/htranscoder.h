@@ -0,0 +1 @@
+#include "../../../src/mediaserver/htranscoder.h"
@@ -8,6 +8,7 @@ HEADERS += \
     $$SRC_LOC/cds_model/hmatching_id.h \
     $$SRC_LOC/cds_model/hchannel_id.h \
     $$SRC_LOC/cds_model/hcdsclassinfo.h \
+    $$SRC_LOC/cds_model/hcds_classhierarchy_p.h \
     $$SRC_LOC/cds_model/hpersonwithrole.h \
     $$SRC_LOC/cds_model/hcontentduration.h \
     $$SRC_LOC/cds_model/hchannelgroupname.h \
@@ -16,17 +17,24 @@ HEADERS += \
     $$SRC_LOC/cds_model/hstatevariablecollection.h \
     $$SRC_LOC/cds_model/hscheduledtime.h \
     $$SRC_LOC/cds_model/datasource/habstract_cds_datasource_p.h \
+    $$SRC_LOC/cds_model/datasource/hcds_objectstore_p.h \
+    $$SRC_LOC/cds_model/datasource/hcds_snapshot_p.h \
+    $$SRC_LOC/cds_model/datasource/hcds_searchindex_p.h \
     $$SRC_LOC/cds_model/datasource/habstract_cds_datasource.h \
     $$SRC_LOC/cds_model/datasource/hcds_datasource_p.h \
     $$SRC_LOC/cds_model/datasource/hcds_datasource.h \
     $$SRC_LOC/cds_model/datasource/hrootdir.h \
     $$SRC_LOC/cds_model/datasource/hfsys_datasource.h \
+    $$SRC_LOC/cds_model/datasource/hcds_metadata_extractor.h \
     $$SRC_LOC/cds_model/datasource/hfsys_datasource_p.h \
     $$SRC_LOC/cds_model/datasource/hfsys_datasource_configuration.h \
     $$SRC_LOC/cds_model/datasource/hfsys_datasource_configuration_p.h \
     $$SRC_LOC/cds_model/datasource/hcds_datasource_configuration_p.h \
     $$SRC_LOC/cds_model/datasource/hcds_datasource_configuration.h \
+    $$SRC_LOC/cds_model/model_mgmt/hcds_fsys_index_p.h \
+    $$SRC_LOC/cds_model/model_mgmt/hcds_metadata_pipeline_p.h \
     $$SRC_LOC/cds_model/model_mgmt/hcds_fsys_reader_p.h \
+    $$SRC_LOC/cds_model/model_mgmt/hcds_fsys_watcher_p.h \
     $$SRC_LOC/cds_model/model_mgmt/hcdsobjectdata_p.h \
     $$SRC_LOC/cds_model/model_mgmt/hcds_dlite_serializer.h \
     $$SRC_LOC/cds_model/model_mgmt/hcdsproperty_db.h \
@@ -35,8 +43,12 @@ HEADERS += \
     $$SRC_LOC/cds_model/model_mgmt/hcdsproperty.h \
     $$SRC_LOC/cds_model/model_mgmt/hcdspropertyinfo.h \
     $$SRC_LOC/cds_model/model_mgmt/hcds_dlite_serializer_p.h \
+    $$SRC_LOC/cds_model/model_mgmt/hcds_propertyfilter_p.h \
+    $$SRC_LOC/cds_model/model_mgmt/hcds_objectview.h \
+    $$SRC_LOC/cds_model/model_mgmt/hcds_objectview_p.h \
     $$SRC_LOC/cds_model/cds_objects/hobject.h \
     $$SRC_LOC/cds_model/cds_objects/hobject_p.h \
+    $$SRC_LOC/cds_model/cds_objects/hcds_objectpool_p.h \
     $$SRC_LOC/cds_model/cds_objects/hitem.h \
     $$SRC_LOC/cds_model/cds_objects/hitem_p.h \
     $$SRC_LOC/cds_model/cds_objects/haudioitem.h \
@@ -117,6 +129,7 @@ SOURCES += \
     $$SRC_LOC/cds_model/hmatching_id.cpp \
     $$SRC_LOC/cds_model/hchannel_id.cpp \
     $$SRC_LOC/cds_model/hcdsclassinfo.cpp \
+    $$SRC_LOC/cds_model/hcds_classhierarchy_p.cpp \
     $$SRC_LOC/cds_model/hpersonwithrole.cpp \
     $$SRC_LOC/cds_model/hcontentduration.cpp \
     $$SRC_LOC/cds_model/hchannelgroupname.cpp \
@@ -125,19 +138,29 @@ SOURCES += \
     $$SRC_LOC/cds_model/hstatevariablecollection.cpp \
     $$SRC_LOC/cds_model/hscheduledtime.cpp \
     $$SRC_LOC/cds_model/datasource/habstract_cds_datasource.cpp \
+    $$SRC_LOC/cds_model/datasource/hcds_objectstore_p.cpp \
+    $$SRC_LOC/cds_model/datasource/hcds_snapshot_p.cpp \
+    $$SRC_LOC/cds_model/datasource/hcds_searchindex.cpp \
     $$SRC_LOC/cds_model/datasource/hcds_datasource.cpp \
     $$SRC_LOC/cds_model/datasource/hrootdir.cpp \
     $$SRC_LOC/cds_model/datasource/hfsys_datasource.cpp \
+    $$SRC_LOC/cds_model/datasource/hcds_metadata_extractor.cpp \
     $$SRC_LOC/cds_model/datasource/hcds_datasource_configuration.cpp \
     $$SRC_LOC/cds_model/datasource/hfsys_datasource_configuration.cpp \
+    $$SRC_LOC/cds_model/model_mgmt/hcds_fsys_index_p.cpp \
+    $$SRC_LOC/cds_model/model_mgmt/hcds_metadata_pipeline_p.cpp \
     $$SRC_LOC/cds_model/model_mgmt/hcds_fsys_reader_p.cpp \
+    $$SRC_LOC/cds_model/model_mgmt/hcds_fsys_watcher_p.cpp \
     $$SRC_LOC/cds_model/model_mgmt/hcdsobjectdata_p.cpp \
     $$SRC_LOC/cds_model/model_mgmt/hcdsproperty_db.cpp \
     $$SRC_LOC/cds_model/model_mgmt/hcdsproperties.cpp \
     $$SRC_LOC/cds_model/model_mgmt/hcdsproperty.cpp \
     $$SRC_LOC/cds_model/model_mgmt/hcdspropertyinfo.cpp \
     $$SRC_LOC/cds_model/model_mgmt/hcds_dlite_serializer.cpp \
+    $$SRC_LOC/cds_model/model_mgmt/hcds_propertyfilter.cpp \
+    $$SRC_LOC/cds_model/model_mgmt/hcds_objectview.cpp \
     $$SRC_LOC/cds_model/cds_objects/hobject.cpp \
+    $$SRC_LOC/cds_model/cds_objects/hcds_objectpool_p.cpp \
     $$SRC_LOC/cds_model/cds_objects/hitem.cpp \
     $$SRC_LOC/cds_model/cds_objects/haudioitem.cpp \
     $$SRC_LOC/cds_model/cds_objects/haudioprogram.cpp \
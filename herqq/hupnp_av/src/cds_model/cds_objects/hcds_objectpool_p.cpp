@@ -0,0 +1,177 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hcds_objectpool_p.h"
+
+#include <QtCore/QMutex>
+#include <QtCore/QAtomicPointer>
+
+#include <new>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+namespace
+{
+struct FreeBlock
+{
+    FreeBlock* m_next;
+};
+
+class Pool
+{
+public:
+
+    enum
+    {
+        SizeClassCount =
+            HCdsObjectPool::MaxBlockSize / HCdsObjectPool::Granularity
+    };
+
+    QMutex m_mutex;
+    FreeBlock* m_freeLists[SizeClassCount];
+    qint32 m_blocksInUse;
+
+    Pool() :
+        m_mutex(), m_blocksInUse(0)
+    {
+        for (qint32 i = 0; i < SizeClassCount; ++i)
+        {
+            m_freeLists[i] = 0;
+        }
+    }
+
+    // carves a new chunk into blocks of the specified size class
+    FreeBlock* grow(qint32 sizeClass)
+    {
+        std::size_t blockSize = (sizeClass + 1) * HCdsObjectPool::Granularity;
+        std::size_t count = HCdsObjectPool::ChunkSize / blockSize;
+
+        char* chunk = static_cast<char*>(
+            ::operator new(count * blockSize));
+
+        FreeBlock* head = 0;
+        for (std::size_t i = count; i > 0; --i)
+        {
+            FreeBlock* block =
+                reinterpret_cast<FreeBlock*>(chunk + (i - 1) * blockSize);
+            block->m_next = head;
+            head = block;
+        }
+        return head;
+    }
+};
+
+QAtomicPointer<Pool> s_pool(0);
+
+// The pool is never deleted, since objects may still be destroyed
+// during the destruction of static objects.
+Pool* pool()
+{
+    Pool* retVal = s_pool.fetchAndAddOrdered(0);
+    if (!retVal)
+    {
+        Pool* newPool = new Pool();
+        if (s_pool.testAndSetOrdered(0, newPool))
+        {
+            retVal = newPool;
+        }
+        else
+        {
+            delete newPool;
+            retVal = s_pool.fetchAndAddOrdered(0);
+        }
+    }
+    return retVal;
+}
+
+inline qint32 sizeClass(std::size_t size)
+{
+    return size ? (size - 1) / HCdsObjectPool::Granularity : 0;
+}
+}
+
+/*******************************************************************************
+ * HCdsObjectPool
+ ******************************************************************************/
+void* HCdsObjectPool::allocate(std::size_t size)
+{
+    if (size > MaxBlockSize)
+    {
+        return ::operator new(size);
+    }
+
+    qint32 index = sizeClass(size);
+
+    Pool* p = pool();
+    QMutexLocker locker(&p->m_mutex);
+
+    FreeBlock* block = p->m_freeLists[index];
+    if (!block)
+    {
+        block = p->grow(index);
+    }
+
+    p->m_freeLists[index] = block->m_next;
+    ++p->m_blocksInUse;
+
+    return block;
+}
+
+void HCdsObjectPool::deallocate(void* block, std::size_t size)
+{
+    if (!block)
+    {
+        return;
+    }
+    else if (size > MaxBlockSize)
+    {
+        ::operator delete(block);
+        return;
+    }
+
+    qint32 index = sizeClass(size);
+
+    Pool* p = pool();
+    QMutexLocker locker(&p->m_mutex);
+
+    FreeBlock* freeBlock = static_cast<FreeBlock*>(block);
+    freeBlock->m_next = p->m_freeLists[index];
+    p->m_freeLists[index] = freeBlock;
+    --p->m_blocksInUse;
+}
+
+qint32 HCdsObjectPool::blocksInUse()
+{
+    Pool* p = pool();
+    QMutexLocker locker(&p->m_mutex);
+    return p->m_blocksInUse;
+}
+
+}
+}
+}
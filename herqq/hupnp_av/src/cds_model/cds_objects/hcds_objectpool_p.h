@@ -0,0 +1,87 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HCDS_OBJECTPOOL_P_H_
+#define HCDS_OBJECTPOOL_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include <HUpnpAv/HUpnpAv>
+
+#include <cstddef>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+//
+// A slab allocator for the small, fixed-size blocks that make up a CDS object
+// graph: the HObject instances and their private classes. The blocks are
+// carved out of large chunks and a freed block is put on the free list of its
+// size class, which is why creating and destroying a large number of objects
+// does not hit the general purpose heap for every object.
+//
+// The chunks are never returned to the system, but they are reused for new
+// objects. Blocks larger than MaxBlockSize are allocated from the heap.
+//
+// The allocator is thread-safe, since objects are created by the scanner
+// threads of the file system data source.
+//
+class HCdsObjectPool
+{
+H_DISABLE_COPY(HCdsObjectPool)
+
+public:
+
+    enum
+    {
+        Granularity = 16,
+        MaxBlockSize = 256,
+        ChunkSize = 64 * 1024
+    };
+
+    static void* allocate(std::size_t size);
+    static void deallocate(void* block, std::size_t size);
+
+    // returns the number of blocks currently handed out from the chunks
+    static qint32 blocksInUse();
+
+private:
+
+    HCdsObjectPool();
+};
+
+}
+}
+}
+
+#endif /* HCDS_OBJECTPOOL_P_H_ */
@@ -134,7 +134,7 @@ bool operator==(const HContainerEventInfo& obj1, const HContainerEventInfo& obj2
  ******************************************************************************/
 HContainerPrivate::HContainerPrivate(
     const QString& clazz, HObject::CdsType cdsType) :
-        HObjectPrivate(clazz, cdsType), m_childIds()
+        HObjectPrivate(clazz, cdsType), m_childIds(), m_childPositions()
 {
     const HCdsProperties& inst = HCdsProperties::instance();
     insert(inst.get(HCdsProperties::upnp_containerUpdateID).name(), 0U);
@@ -145,6 +145,64 @@ HContainerPrivate::HContainerPrivate(
     insert(inst.get(HCdsProperties::dlite_searchable).name(), false);
 }
 
+bool HContainerPrivate::appendChild(const QString& id)
+{
+    if (m_childPositions.contains(id))
+    {
+        return false;
+    }
+
+    m_childPositions.insert(id, m_childIds.size());
+    m_childIds.append(id);
+    return true;
+}
+
+bool HContainerPrivate::removeChild(const QString& id)
+{
+    QHash<QString, qint32>::iterator it = m_childPositions.find(id);
+    if (it == m_childPositions.end())
+    {
+        return false;
+    }
+
+    qint32 pos = it.value();
+    m_childPositions.erase(it);
+    m_childIds.removeAt(pos);
+
+    for(qint32 i = pos; i < m_childIds.size(); ++i)
+    {
+        m_childPositions[m_childIds[i]] = i;
+    }
+
+    return true;
+}
+
+void HContainerPrivate::removeChildren(const QSet<QString>& ids)
+{
+    qint32 target = 0;
+    for(qint32 i = 0; i < m_childIds.size(); ++i)
+    {
+        const QString& id = m_childIds[i];
+        if (ids.contains(id))
+        {
+            m_childPositions.remove(id);
+            continue;
+        }
+
+        if (target != i)
+        {
+            m_childIds[target] = id;
+            m_childPositions[id] = target;
+        }
+        ++target;
+    }
+
+    while(m_childIds.size() > target)
+    {
+        m_childIds.removeLast();
+    }
+}
+
 /*******************************************************************************
  * HContainer
  ******************************************************************************/
@@ -211,7 +269,10 @@ void HContainer::doClone(HClonable* target) const
     HContainer* obj = dynamic_cast<HContainer*>(target);
     if (obj)
     {
-        static_cast<HContainerPrivate*>(obj->h_ptr)->m_childIds = h->m_childIds;
+        HContainerPrivate* objPriv =
+            static_cast<HContainerPrivate*>(obj->h_ptr);
+        objPriv->m_childIds = h->m_childIds;
+        objPriv->m_childPositions = h->m_childPositions;
         HObject::doClone(obj);
     }
 }
@@ -219,44 +280,81 @@ void HContainer::doClone(HClonable* target) const
 bool HContainer::hasChildId(const QString& childId) const
 {
     const H_D(HContainer);
-    return h->m_childIds.contains(childId);
+    return h->containsChild(childId);
 }
 
 void HContainer::setChildIds(const QSet<QString>& childIds)
 {
     H_D(HContainer);
 
-    bool differentExpectedCount = childIds.size() != h->m_childIds.size();
+    QStringList ids;
+    foreach(const QString& id, h->m_childIds)
+    {
+        // The children that are kept retain their positions.
+        if (childIds.contains(id))
+        {
+            ids.append(id);
+        }
+    }
+
+    foreach(const QString& id, childIds)
+    {
+        if (!h->containsChild(id))
+        {
+            ids.append(id);
+        }
+    }
+
+    setChildIds(ids);
+}
+
+void HContainer::setChildIds(const QStringList& childIds)
+{
+    H_D(HContainer);
 
-    QSet<QString> copy(childIds);
+    qint32 oldSize = h->m_childIds.size();
 
-    QSet<QString>::iterator it = h->m_childIds.begin();
-    while(it != h->m_childIds.end())
+    QSet<QString> newIds = childIds.toSet();
+    QSet<QString> removedIds;
+    foreach(const QString& id, h->m_childIds)
     {
-        QString id = *it;
-        if (!copy.contains(id))
+        if (!newIds.contains(id))
         {
-            it = h->m_childIds.erase(it);
-            emit containerModified(
-                this, HContainerEventInfo(HContainerEventInfo::ChildRemoved, id));
+            removedIds.insert(id);
         }
-        else
+    }
+
+    QStringList addedIds;
+    foreach(const QString& id, childIds)
+    {
+        if (!h->containsChild(id))
         {
-            copy.remove(id);
-            ++it;
+            addedIds.append(id);
         }
     }
 
-    foreach(const QString& id, copy)
+    h->m_childIds.clear();
+    h->m_childPositions.clear();
+    foreach(const QString& id, childIds)
+    {
+        h->appendChild(id);
+    }
+
+    foreach(const QString& id, removedIds)
+    {
+        emit containerModified(
+            this, HContainerEventInfo(HContainerEventInfo::ChildRemoved, id));
+    }
+
+    foreach(const QString& id, addedIds)
     {
-        h->m_childIds.insert(id);
         emit containerModified(
             this, HContainerEventInfo(HContainerEventInfo::ChildAdded, id));
     }
 
-    if (differentExpectedCount)
+    if (h->m_childIds.size() != oldSize)
     {
-        setExpectedChildCount(childIds.size());
+        setExpectedChildCount(h->m_childIds.size());
     }
 }
 
@@ -267,10 +365,8 @@ void HContainer::addChildIds(const QSet<QString>& childIds)
     bool modified = false;
     foreach(const QString& id, childIds)
     {
-        if (!h->m_childIds.contains(id))
+        if (h->appendChild(id))
         {
-            h->m_childIds.insert(id);
-
             emit containerModified(
                 this, HContainerEventInfo(HContainerEventInfo::ChildAdded, id));
 
@@ -288,10 +384,8 @@ void HContainer::addChildId(const QString& childId)
 {
     H_D(HContainer);
 
-    if (!h->m_childIds.contains(childId))
+    if (h->appendChild(childId))
     {
-        h->m_childIds.insert(childId);
-
         emit containerModified(
             this, HContainerEventInfo(HContainerEventInfo::ChildAdded, childId));
 
@@ -303,10 +397,8 @@ void HContainer::removeChildId(const QString& childId)
 {
     H_D(HContainer);
 
-    if (h->m_childIds.contains(childId))
+    if (h->removeChild(childId))
     {
-        h->m_childIds.remove(childId);
-
         emit containerModified(
             this, HContainerEventInfo(HContainerEventInfo::ChildRemoved, childId));
 
@@ -318,24 +410,28 @@ void HContainer::removeChildIds(const QSet<QString>& childIDs)
 {
     H_D(HContainer);
 
-    bool modified = false;
+    QSet<QString> removedIds;
     foreach(const QString& id, childIDs)
     {
-        if (h->m_childIds.contains(id))
+        if (h->containsChild(id))
         {
-            h->m_childIds.remove(id);
-
-            emit containerModified(
-                this, HContainerEventInfo(HContainerEventInfo::ChildRemoved, id));
-
-            modified = true;
+            removedIds.insert(id);
         }
     }
 
-    if (modified)
+    if (removedIds.isEmpty())
     {
-        setExpectedChildCount(h->m_childIds.size());
+        return;
     }
+
+    h->removeChildren(removedIds);
+    foreach(const QString& id, removedIds)
+    {
+        emit containerModified(
+            this, HContainerEventInfo(HContainerEventInfo::ChildRemoved, id));
+    }
+
+    setExpectedChildCount(h->m_childIds.size());
 }
 
 /*
@@ -386,11 +482,29 @@ bool HContainer::doCompare(
 }*/
 
 QSet<QString> HContainer::childIds() const
+{
+    const H_D(HContainer);
+    return h->m_childIds.toSet();
+}
+
+QStringList HContainer::orderedChildIds() const
 {
     const H_D(HContainer);
     return h->m_childIds;
 }
 
+qint32 HContainer::childCount() const
+{
+    const H_D(HContainer);
+    return h->m_childIds.size();
+}
+
+qint32 HContainer::indexOfChild(const QString& childId) const
+{
+    const H_D(HContainer);
+    return h->m_childPositions.value(childId, -1);
+}
+
 bool HContainer::searchable() const
 {
     QVariant value;
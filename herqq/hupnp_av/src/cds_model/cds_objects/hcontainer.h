@@ -24,6 +24,8 @@
 
 #include <HUpnpAv/HObject>
 
+#include <QtCore/QStringList>
+
 namespace Herqq
 {
 
@@ -301,10 +303,45 @@ public:
      * \return The IDs of the individual content objects that this container
      * contains.
      *
-     * \sa setChildIds(), expectedChildCount()
+     * \sa setChildIds(), expectedChildCount(), orderedChildIds()
      */
     QSet<QString> childIds() const;
 
+    /*!
+     * \brief Returns the IDs of the individual content objects that this
+     * container contains in the order they were added.
+     *
+     * Unlike childIds(), this does not create a copy of the IDs and the
+     * order stays the same across calls as long as the container is not
+     * modified. Because of that a page of the children can be taken
+     * directly from the returned list.
+     *
+     * \return The IDs of the individual content objects that this container
+     * contains in the order they were added.
+     *
+     * \sa childIds(), indexOfChild()
+     */
+    QStringList orderedChildIds() const;
+
+    /*!
+     * \brief Returns the number of child IDs this container contains.
+     *
+     * \return The number of child IDs this container contains.
+     *
+     * \sa orderedChildIds()
+     */
+    qint32 childCount() const;
+
+    /*!
+     * \brief Returns the position of the specified child ID.
+     *
+     * \param childId specifies the child ID.
+     *
+     * \return The position of the specified child ID in orderedChildIds(),
+     * or -1 in case the container does not contain the ID.
+     */
+    qint32 indexOfChild(const QString& childId) const;
+
     /*!
      * \brief Indicates if a search can be performed to this container.
      *
@@ -393,6 +430,17 @@ public:
      */
     void setChildIds(const QSet<QString>& childIds);
 
+    /*!
+     * \brief Sets the IDs of the individual content objects that this
+     * container contains in the specified order.
+     *
+     * \param childIds specifies the IDs of the individual content objects
+     * that this container contains. A duplicate ID is ignored.
+     *
+     * \sa orderedChildIds()
+     */
+    void setChildIds(const QStringList& childIds);
+
     /*!
      * Adds the specified IDs of the individual content objects to this container.
      *
@@ -33,6 +33,8 @@
 #include "hobject_p.h"
 
 #include <QtCore/QSet>
+#include <QtCore/QHash>
+#include <QtCore/QStringList>
 
 namespace Herqq
 {
@@ -53,9 +55,27 @@ H_DISABLE_COPY(HContainerPrivate)
 
 public:
 
-    QSet<QString> m_childIds;
+    QStringList m_childIds;
+    // the child IDs in the order they were added
+
+    QHash<QString, qint32> m_childPositions;
+    // key == child ID, value == the index of the ID in m_childIds
 
     HContainerPrivate(const QString& clazz, HObject::CdsType cdsType);
+
+    inline bool containsChild(const QString& id) const
+    {
+        return m_childPositions.contains(id);
+    }
+
+    // returns false in case the child was already there
+    bool appendChild(const QString& id);
+
+    // returns false in case the child was not there
+    bool removeChild(const QString& id);
+
+    // removes the specified children in a single pass
+    void removeChildren(const QSet<QString>& ids);
 };
 
 }
@@ -98,6 +98,13 @@ bool HItem::isRef() const
     return !refId().isEmpty();
 }
 
+HItem* HItem::newReference(const QString& parentId, const QString& id) const
+{
+    HItem* retVal = newInstance();
+    retVal->h_ptr->reference(*h_ptr, id, parentId, this->id());
+    return retVal;
+}
+
 bool HItem::hasContentFormat() const
 {
     foreach(const HResource& resource, resources())
@@ -136,6 +136,30 @@ public:
      */
     bool isRef() const;
 
+    /*!
+     * \brief Creates a reference item to this item.
+     *
+     * The reference shares the properties of this item except for the ID,
+     * the parent ID and the ref ID, which is why it takes little memory
+     * regardless of the metadata of this item. A modification of this item
+     * is visible in the reference, whereas a modification of the reference
+     * affects only the reference. The reference is serialized with the
+     * full metadata of this item.
+     *
+     * \param parentId specifies the ID of the container of the reference.
+     *
+     * \param id specifies the ID of the reference. If this is not specified,
+     * a unique identifier within the running process is created.
+     *
+     * \return a new item of the same type as this item, the ref ID of which is
+     * the ID of this item. The ownership of the item is transferred to the
+     * caller.
+     *
+     * \sa refId(), HContentDirectoryService::createReference()
+     */
+    HItem* newReference(
+        const QString& parentId, const QString& id = QString()) const;
+
     /*!
      * Checks if any of the HResource objects contained by this item has
      * specified a MIME type.
@@ -21,6 +21,7 @@
 
 #include "hobject.h"
 #include "hobject_p.h"
+#include "hcds_objectpool_p.h"
 #include "hcontainer.h"
 #include "hitem.h"
 
@@ -32,6 +33,7 @@
 #include <HUpnpCore/private/hlogger_p.h>
 #include <HUpnpCore/private/hmisc_utils_p.h>
 
+#include <QtCore/QSet>
 #include <QtCore/QMutex>
 #include <QtCore/QXmlStreamWriter>
 
@@ -56,6 +58,11 @@ static bool regMetaT = registerMetaTypes();
 static unsigned int s_lastInt = 0;
 static QMutex s_lastIntMutex;
 
+static QReadWriteLock s_propertyLock;
+
+static QSet<QString> s_internedValues;
+static QMutex s_internedValuesMutex;
+
 namespace
 {
 inline unsigned int getNextId()
@@ -187,6 +194,266 @@ bool operator==(const HObjectEventInfo& obj1, const HObjectEventInfo& obj2)
            obj1.updateId() == obj2.updateId();
 }
 
+/*******************************************************************************
+ * HCdsPropertyStore
+ ******************************************************************************/
+HCdsPropertyStore::ConstIterator::ConstIterator(
+    const HCdsPropertyStore& store) :
+        m_own(&store.m_entries),
+        m_shared(store.m_shared ? &store.m_shared->m_entries : 0),
+        m_ownIndex(0), m_sharedIndex(0), m_current(0)
+{
+    next();
+}
+
+void HCdsPropertyStore::ConstIterator::next()
+{
+    const Entry* own =
+        m_ownIndex < m_own->size() ? &m_own->at(m_ownIndex) : 0;
+
+    const Entry* shared = m_shared && m_sharedIndex < m_shared->size() ?
+        &m_shared->at(m_sharedIndex) : 0;
+
+    if (own && (!shared || own->m_id <= shared->m_id))
+    {
+        if (shared && shared->m_id == own->m_id)
+        {
+            // The property of a reference overrides the shared one.
+            ++m_sharedIndex;
+        }
+        m_current = own;
+        ++m_ownIndex;
+    }
+    else
+    {
+        m_current = shared;
+        if (shared)
+        {
+            ++m_sharedIndex;
+        }
+    }
+}
+
+HCdsPropertyStore::HCdsPropertyStore() :
+    m_entries(), m_shared(), m_isReference(false)
+{
+}
+
+HCdsPropertyStore::HCdsPropertyStore(const HCdsPropertyStore& other) :
+    m_entries(other.m_entries), m_shared(), m_isReference(other.m_isReference)
+{
+    if (m_isReference)
+    {
+        m_shared = other.m_shared;
+    }
+    else if (other.m_shared)
+    {
+        m_entries = other.m_shared->m_entries;
+    }
+}
+
+HCdsPropertyStore& HCdsPropertyStore::operator=(const HCdsPropertyStore& other)
+{
+    if (this != &other)
+    {
+        HCdsPropertyStore copy(other);
+        m_entries = copy.m_entries;
+        m_shared = copy.m_shared;
+        m_isReference = copy.m_isReference;
+    }
+    return *this;
+}
+
+qint32 HCdsPropertyStore::indexOf(const QVector<Entry>& entries, qint32 id)
+{
+    qint32 low = 0, high = entries.size() - 1;
+    while(low <= high)
+    {
+        qint32 middle = (low + high) / 2;
+        qint32 middleId = entries[middle].m_id;
+        if (middleId < id)
+        {
+            low = middle + 1;
+        }
+        else if (middleId > id)
+        {
+            high = middle - 1;
+        }
+        else
+        {
+            return middle;
+        }
+    }
+    return -1;
+}
+
+qint32 HCdsPropertyStore::insert(
+    QVector<Entry>* entries, qint32 id, const QVariant& value)
+{
+    Q_ASSERT(id >= 0 && id <= HCdsPropertyDb::MaxPropertyId);
+
+    qint32 index = 0;
+    for(; index < entries->size() && entries->at(index).m_id < id; ++index)
+    {
+    }
+
+    if (index < entries->size() && entries->at(index).m_id == id)
+    {
+        (*entries)[index].m_value = value;
+        return index;
+    }
+
+    // The properties are inserted when the object is constructed, which is
+    // why the array is kept at the exact size instead of growing it
+    // geometrically.
+    entries->reserve(entries->size() + 1);
+
+    Entry entry;
+    entry.m_id = static_cast<quint16>(id);
+    entry.m_value = value;
+    entries->insert(index, entry);
+
+    return index;
+}
+
+const QVariant* HCdsPropertyStore::value(qint32 id) const
+{
+    qint32 index = indexOf(m_entries, id);
+    if (index >= 0)
+    {
+        return &m_entries[index].m_value;
+    }
+    else if (m_shared)
+    {
+        const QVector<Entry>& shared = m_shared->m_entries;
+        index = indexOf(shared, id);
+        return index >= 0 ? &shared[index].m_value : 0;
+    }
+    return 0;
+}
+
+QVariant* HCdsPropertyStore::modifiableValue(qint32 id)
+{
+    qint32 index = indexOf(m_entries, id);
+    if (index >= 0)
+    {
+        return &m_entries[index].m_value;
+    }
+    else if (!m_shared)
+    {
+        return 0;
+    }
+
+    index = indexOf(m_shared->m_entries, id);
+    if (index < 0)
+    {
+        return 0;
+    }
+    else if (!m_isReference)
+    {
+        return &m_shared->m_entries[index].m_value;
+    }
+
+    // A modification of a reference must not be visible in the referenced
+    // item, which is why the property is copied to the reference first.
+    // The readers in the other threads may be reading the array.
+    QWriteLocker lock(&s_propertyLock);
+    index = insert(&m_entries, id, m_shared->m_entries[index].m_value);
+    return &m_entries[index].m_value;
+}
+
+void HCdsPropertyStore::insert(qint32 id, const QVariant& value)
+{
+    if (m_shared && !m_isReference)
+    {
+        insert(&m_shared->m_entries, id, value);
+    }
+    else
+    {
+        insert(&m_entries, id, value);
+    }
+}
+
+void HCdsPropertyStore::reference(
+    const HCdsPropertyStore& target, const qint32 ownIds[], qint32 count)
+{
+    QWriteLocker lock(&s_propertyLock);
+
+    // The properties of the target are moved to the shared array when the
+    // first reference to it is created. A reference to a reference shares
+    // the properties of the original item, without the properties that have
+    // been modified through the reference.
+    HCdsPropertyStore& t = const_cast<HCdsPropertyStore&>(target);
+    if (!t.m_shared)
+    {
+        t.m_shared = new SharedEntries();
+        t.m_shared->m_entries = t.m_entries;
+        t.m_entries.clear();
+    }
+
+    QVector<Entry> own;
+    for(qint32 i = 0; i < count; ++i)
+    {
+        const QVariant* current = value(ownIds[i]);
+        if (current)
+        {
+            insert(&own, ownIds[i], *current);
+        }
+    }
+
+    m_entries = own;
+    m_shared = t.m_shared;
+    m_isReference = true;
+}
+
+HCdsPropertyMap HCdsPropertyStore::toMap() const
+{
+    HCdsPropertyMap retVal;
+    HCdsPropertyDb& db = HCdsPropertyDb::instance();
+    for(ConstIterator it(*this); !it.atEnd(); it.next())
+    {
+        retVal.insert(db.propertyName(it.id()), it.value());
+    }
+    return retVal;
+}
+
+qint64 HCdsPropertyStore::footprint(const QVector<Entry>& entries)
+{
+    qint64 retVal = entries.capacity() * sizeof(Entry);
+    for(qint32 i = 0; i < entries.size(); ++i)
+    {
+        const QVariant& value = entries[i].m_value;
+        switch(value.type())
+        {
+        case QVariant::String:
+            retVal += value.toString().size() * sizeof(QChar);
+            break;
+        case QVariant::StringList:
+            foreach(const QString& str, value.toStringList())
+            {
+                retVal += sizeof(QString) + str.size() * sizeof(QChar);
+            }
+            break;
+        case QVariant::ByteArray:
+            retVal += value.toByteArray().size();
+            break;
+        default:
+            break;
+        }
+    }
+    return retVal;
+}
+
+qint64 HCdsPropertyStore::footprint() const
+{
+    qint64 retVal = footprint(m_entries);
+    if (m_shared && !m_isReference)
+    {
+        retVal += sizeof(SharedEntries) + footprint(m_shared->m_entries);
+    }
+    return retVal;
+}
+
 /*******************************************************************************
  * HObjectPrivate
  ******************************************************************************/
@@ -215,6 +482,112 @@ HObjectPrivate::~HObjectPrivate()
 {
 }
 
+void* HObjectPrivate::operator new(std::size_t size)
+{
+    return HCdsObjectPool::allocate(size);
+}
+
+void HObjectPrivate::operator delete(void* ptr, std::size_t size)
+{
+    HCdsObjectPool::deallocate(ptr, size);
+}
+
+qint32 HObjectPrivate::propertyId(const QString& property)
+{
+    return HCdsPropertyDb::instance().propertyId(property);
+}
+
+QReadWriteLock* HObjectPrivate::propertyLock()
+{
+    return &s_propertyLock;
+}
+
+void HObjectPrivate::reserveId(const QString& id)
+{
+    bool ok = false;
+    unsigned int value = id.toUInt(&ok);
+    if (ok)
+    {
+        s_lastIntMutex.lock();
+        s_lastInt = qMax(s_lastInt, value);
+        s_lastIntMutex.unlock();
+    }
+}
+
+QVariant HObjectPrivate::intern(qint32 id, const QVariant& value)
+{
+    switch(id)
+    {
+    case HCdsProperties::upnp_class:
+    case HCdsProperties::dc_creator:
+    case HCdsProperties::upnp_album:
+    case HCdsProperties::dc_publisher:
+    case HCdsProperties::upnp_storageMedium:
+        break;
+    default:
+        return value;
+    }
+
+    QMutexLocker locker(&s_internedValuesMutex);
+    if (value.type() == QVariant::String)
+    {
+        QString str = value.toString();
+        if (str.isEmpty())
+        {
+            return value;
+        }
+        return *s_internedValues.insert(str);
+    }
+    else if (value.type() == QVariant::StringList)
+    {
+        QStringList strs = value.toStringList();
+        for(qint32 i = 0; i < strs.size(); ++i)
+        {
+            strs[i] = *s_internedValues.insert(strs[i]);
+        }
+        return strs;
+    }
+
+    return value;
+}
+
+void HObjectPrivate::insert(const HCdsPropertyInfo& arg)
+{
+    insert(arg.name(), arg.defaultValue());
+}
+
+void HObjectPrivate::insert(const QString& arg, const QVariant& var)
+{
+    qint32 id = HCdsPropertyDb::instance().registerPropertyId(arg);
+    if (id >= 0)
+    {
+        m_properties.insert(id, intern(id, var));
+    }
+}
+
+void HObjectPrivate::reference(
+    const HObjectPrivate& target, const QString& id, const QString& parentId,
+    const QString& refId)
+{
+    const qint32 ownIds[] =
+    {
+        HCdsProperties::dlite_id, HCdsProperties::dlite_parentId,
+        HCdsProperties::dlite_refId
+    };
+
+    m_properties.reference(
+        target.m_properties, ownIds, sizeof(ownIds) / sizeof(ownIds[0]));
+
+    m_properties.insert(
+        HCdsProperties::dlite_id,
+        id.isEmpty() ? QString::number(getNextId()) : id);
+    m_properties.insert(HCdsProperties::dlite_parentId, parentId);
+    m_properties.insert(HCdsProperties::dlite_refId, refId);
+
+    m_cdsType = target.m_cdsType;
+    m_disabledProperties = target.m_disabledProperties;
+}
+
 /*******************************************************************************
  * HObject
  ******************************************************************************/
@@ -235,6 +608,16 @@ HObject::~HObject()
     delete h_ptr;
 }
 
+void* HObject::operator new(std::size_t size)
+{
+    return HCdsObjectPool::allocate(size);
+}
+
+void HObject::operator delete(void* ptr, std::size_t size)
+{
+    HCdsObjectPool::deallocate(ptr, size);
+}
+
 HObject* HObject::clone() const
 {
     return static_cast<HObject*>(HClonable::clone());
@@ -263,32 +646,39 @@ bool HObject::isInitialized() const
 
 bool HObject::hasCdsProperty(const QString& property) const
 {
-    return h_ptr->m_properties.contains(property);
+    return h_ptr->m_properties.contains(HObjectPrivate::propertyId(property));
 }
 
 bool HObject::hasCdsProperty(HCdsProperties::Property property) const
 {
-    return h_ptr->m_properties.contains(HCdsProperties::instance().get(property).name());
+    return h_ptr->m_properties.contains(property);
 }
 
 bool HObject::isCdsPropertySet(const QString& property) const
 {
-    QVariant var = h_ptr->m_properties.value(property);
-    return var.isValid() && !var.isNull();
+    const QVariant* var =
+        h_ptr->m_properties.value(HObjectPrivate::propertyId(property));
+
+    return var && var->isValid() && !var->isNull();
 }
 
 bool HObject::isCdsPropertySet(HCdsProperties::Property property) const
 {
-    QVariant var = h_ptr->m_properties.value(HCdsProperties::instance().get(property).name());
-    return var.isValid() && !var.isNull();
+    const QVariant* var = h_ptr->m_properties.value(property);
+    return var && var->isValid() && !var->isNull();
 }
 
 bool HObject::setCdsProperty(const QString& property, const QVariant& value)
 {
-    if (h_ptr->m_properties.contains(property))
+    qint32 id = HObjectPrivate::propertyId(property);
+    QVariant* current = h_ptr->m_properties.modifiableValue(id);
+    if (current)
     {
-        QVariant oldValue = h_ptr->m_properties.value(property);
-        h_ptr->m_properties.insert(property, value);
+        QVariant oldValue = *current;
+        QVariant newValue = HObjectPrivate::intern(id, value);
+        s_propertyLock.lockForWrite();
+        *current = newValue;
+        s_propertyLock.unlock();
         const HCdsPropertyInfo& info = HCdsProperties::instance().get(property);
         if (info.isValid() &&
             info.type() != HCdsProperties::upnp_objectUpdateID &&
@@ -304,11 +694,15 @@ bool HObject::setCdsProperty(const QString& property, const QVariant& value)
 
 bool HObject::setCdsProperty(HCdsProperties::Property property, const QVariant& value)
 {
-    const HCdsPropertyInfo& info = HCdsProperties::instance().get(property);
-    if (h_ptr->m_properties.contains(info.name()))
+    QVariant* current = h_ptr->m_properties.modifiableValue(property);
+    if (current)
     {
-        QVariant oldValue = h_ptr->m_properties.value(info.name());
-        h_ptr->m_properties.insert(info.name(), value);
+        const HCdsPropertyInfo& info = HCdsProperties::instance().get(property);
+        QVariant oldValue = *current;
+        QVariant newValue = HObjectPrivate::intern(property, value);
+        s_propertyLock.lockForWrite();
+        *current = newValue;
+        s_propertyLock.unlock();
         if (property != HCdsProperties::upnp_objectUpdateID &&
             property != HCdsProperties::upnp_containerUpdateID &&
             property != HCdsProperties::upnp_totalDeletedChildCount &&
@@ -325,9 +719,12 @@ bool HObject::getCdsProperty(const QString& property, QVariant* value) const
 {
     Q_ASSERT(value);
 
-    if (h_ptr->m_properties.contains(property))
+    const QVariant* current =
+        h_ptr->m_properties.value(HObjectPrivate::propertyId(property));
+
+    if (current)
     {
-        *value = h_ptr->m_properties.value(property);
+        *value = *current;
         return true;
     }
 
@@ -338,10 +735,10 @@ bool HObject::getCdsProperty(HCdsProperties::Property property, QVariant* value)
 {
     Q_ASSERT(value);
 
-    const HCdsPropertyInfo& info = HCdsProperties::instance().get(property);
-    if (h_ptr->m_properties.contains(info.name()))
+    const QVariant* current = h_ptr->m_properties.value(property);
+    if (current)
     {
-        *value = h_ptr->m_properties.value(info.name());
+        *value = *current;
         return true;
     }
 
@@ -426,11 +823,13 @@ bool HObject::enableCdsProperty(const QString& property, bool arg)
         }
         else
         {
+            QWriteLocker lock(&s_propertyLock);
             h_ptr->m_disabledProperties.removeOne(property);
         }
     }
     else if (!h_ptr->m_disabledProperties.contains(property))
     {
+        QWriteLocker lock(&s_propertyLock);
         h_ptr->m_disabledProperties.append(property);
     }
 
@@ -473,7 +872,7 @@ void HObject::doClone(HClonable* target) const
 
 QHash<QString, QVariant> HObject::cdsProperties() const
 {
-    return h_ptr->m_properties;
+    return h_ptr->m_properties.toMap();
 }
 
 bool HObject::neverPlayable() const
@@ -31,6 +31,8 @@
 #include <QtCore/QMetaType>
 #include <QtCore/QSharedDataPointer>
 
+#include <cstddef>
+
 class QXmlStreamReader;
 class QXmlStreamWriter;
 
@@ -216,6 +218,8 @@ H_DISABLE_COPY(HObject)
 H_DECLARE_PRIVATE(HObject)
 
 friend class HCdsDidlLiteSerializerPrivate;
+friend class HAbstractCdsDataSourcePrivate;
+friend class HCdsObjectStore;
 
 public:
 
@@ -603,6 +607,29 @@ public:
      */
     virtual ~HObject() = 0;
 
+    /*!
+     * \brief Allocates memory for a CDS object.
+     *
+     * The CDS objects, including instances of user-defined subclasses, are
+     * allocated from a pool of fixed-size blocks owned by HUPnPAv, which
+     * makes creating and destroying large object graphs considerably
+     * cheaper than allocating every object from the general purpose heap.
+     *
+     * \param size specifies the size of the object in bytes.
+     *
+     * \return a pointer to the allocated memory.
+     */
+    static void* operator new(std::size_t size);
+
+    /*!
+     * \brief Releases memory allocated for a CDS object.
+     *
+     * \param ptr specifies the memory to be released.
+     *
+     * \param size specifies the size of the object in bytes.
+     */
+    static void operator delete(void* ptr, std::size_t size);
+
     // Documented in HClonable
     virtual HObject* clone() const;
 
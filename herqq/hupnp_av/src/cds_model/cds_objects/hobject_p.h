@@ -35,8 +35,13 @@
 
 #include <QtCore/QHash>
 #include <QtCore/QString>
+#include <QtCore/QVector>
 #include <QtCore/QVariant>
+#include <QtCore/QSharedData>
 #include <QtCore/QLinkedList>
+#include <QtCore/QReadWriteLock>
+
+#include <cstddef>
 
 namespace Herqq
 {
@@ -69,6 +74,103 @@ QList<T> toList(const QList<QVariant>& values)
     return retVal;
 }
 
+//
+// The CDS properties of an object as an array of (property ID, value) pairs
+// sorted by the property ID. The IDs are assigned by HCdsPropertyDb, which
+// is why the names of the properties are not stored in every object.
+//
+// A reference item shares the array of the item it references, in which case
+// the store of the reference holds only the properties that identify the
+// reference and the properties that have been modified through it. The
+// array is shared explicitly, which means that a modification of the
+// referenced item is visible in its references.
+//
+class HCdsPropertyStore
+{
+private:
+
+    struct Entry
+    {
+        quint16 m_id;
+        QVariant m_value;
+    };
+
+    struct SharedEntries :
+        public QSharedData
+    {
+        QVector<Entry> m_entries;
+    };
+
+    QVector<Entry> m_entries;
+    // the properties held by this store alone. This is empty in the store of
+    // a referenced item, the properties of which are all in m_shared
+
+    QExplicitlySharedDataPointer<SharedEntries> m_shared;
+    // the properties shared by a referenced item and its references. This
+    // is null until the first reference to the item is created
+
+    bool m_isReference;
+
+    static qint32 indexOf(const QVector<Entry>&, qint32 id);
+    static qint32 insert(QVector<Entry>*, qint32 id, const QVariant&);
+    static qint64 footprint(const QVector<Entry>&);
+
+public:
+
+    //
+    // Visits the properties of a store in the order of their IDs.
+    //
+    class ConstIterator
+    {
+    private:
+
+        const QVector<Entry>* m_own;
+        const QVector<Entry>* m_shared;
+        qint32 m_ownIndex, m_sharedIndex;
+        const Entry* m_current;
+
+    public:
+
+        explicit ConstIterator(const HCdsPropertyStore&);
+
+        inline bool atEnd() const { return !m_current; }
+        inline qint32 id() const { return m_current->m_id; }
+        inline const QVariant& value() const { return m_current->m_value; }
+
+        void next();
+    };
+
+    friend class ConstIterator;
+
+    HCdsPropertyStore();
+
+    // a copy of a reference shares the properties of the referenced item
+    // as well, whereas a copy of any other store is independent of it
+    HCdsPropertyStore(const HCdsPropertyStore&);
+    HCdsPropertyStore& operator=(const HCdsPropertyStore&);
+
+    inline bool contains(qint32 id) const { return value(id) != 0; }
+    inline bool isReference() const { return m_isReference; }
+
+    // these return null in case the property is not found. the latter
+    // copies a shared property to a reference before returning it
+    const QVariant* value(qint32 id) const;
+    QVariant* modifiableValue(qint32 id);
+
+    void insert(qint32 id, const QVariant& value);
+
+    // makes this store share the properties of the specified store, keeping
+    // only the specified properties of this store
+    void reference(
+        const HCdsPropertyStore& target, const qint32 ownIds[], qint32 count);
+
+    HCdsPropertyMap toMap() const;
+
+    // the estimated number of bytes the properties use. the shared
+    // properties are counted in the store of the referenced item only
+    qint64 footprint() const;
+};
+
 //
 //
 //
@@ -78,22 +180,47 @@ H_DISABLE_COPY(HObjectPrivate)
 
 public:
 
-    QHash<QString, QVariant> m_properties;
+    HCdsPropertyStore m_properties;
     HObject::CdsType m_cdsType;
     QLinkedList<QString> m_disabledProperties;
 
     HObjectPrivate(const QString& clazz, HObject::CdsType cdsType);
     virtual ~HObjectPrivate();
 
-    inline void insert(const HCdsPropertyInfo& arg)
-    {
-        m_properties.insert(arg.name(), arg.defaultValue());
-    }
-
-    inline void insert(const QString& arg, const QVariant& var)
-    {
-        m_properties.insert(arg, var);
-    }
+    // the private classes of all the CDS objects are allocated from
+    // HCdsObjectPool. The destructor is virtual, which is why the size
+    // of the dynamic type is passed to operator delete.
+    static void* operator new(std::size_t size);
+    static void operator delete(void* ptr, std::size_t size);
+
+    // returns the ID of the specified property or -1 in case the property
+    // is not known to any object
+    static qint32 propertyId(const QString& property);
+
+    // returns the specified value, or a value sharing the string data of
+    // an equal value in case the property is known to have few distinct
+    // values, such as upnp:class and upnp:album
+    static QVariant intern(qint32 id, const QVariant& value);
+
+    // guards the properties of every object against the threads other than
+    // the one that modifies the objects. a modification always locks this
+    // for writing, whereas only the readers in the other threads, such as
+    // the worker threads of a content directory, lock this for reading
+    static QReadWriteLock* propertyLock();
+
+    // ensures that the IDs generated for new objects do not collide with
+    // the specified ID, which is used by an object that is restored from
+    // persistent storage
+    static void reserveId(const QString& id);
+
+    void insert(const HCdsPropertyInfo& arg);
+    void insert(const QString& arg, const QVariant& var);
+
+    // makes this object a reference to the specified object, sharing all the
+    // properties of it except for the ID, the parent ID and the ref ID
+    void reference(
+        const HObjectPrivate& target, const QString& id,
+        const QString& parentId, const QString& refId);
 };
 
 }
@@ -24,8 +24,11 @@
 #include "hcds_datasource_configuration.h"
 #include "../cds_objects/hitem.h"
 #include "../cds_objects/hcontainer.h"
+#include "../cds_objects/hobject_p.h"
 
 #include <QtCore/QSet>
+#include <QtCore/QThread>
+#include <QtCore/QMutexLocker>
 
 /*!
  * \defgroup hupnp_av_cds_ds Data Sources
@@ -47,21 +50,60 @@ namespace Av
  *******************************************************************************/
 HAbstractCdsDataSourcePrivate::HAbstractCdsDataSourcePrivate() :
     m_configuration(0), m_objectsById(), m_objectIdsByParentId(),
-    m_initialized(false), q_ptr(0)
+    m_searchIndex(0), m_initialized(false), m_bulkUpdateDepth(0),
+    m_bulkAddedIds(), m_bulkModifiedIds(), m_bulkContainerIds(),
+    m_snapshotMutex(), m_snapshot(new HCdsSnapshot()),
+    m_modifiedContainerIds(), m_updateId(0), m_systemUpdateId(0),
+    m_publishPending(false), q_ptr(0)
 {
 }
 
 HAbstractCdsDataSourcePrivate::HAbstractCdsDataSourcePrivate(
     const HCdsDataSourceConfiguration& conf) :
         m_configuration(conf.clone()), m_objectsById(),
-        m_objectIdsByParentId(), m_initialized(false), q_ptr(0)
-{
+        m_objectIdsByParentId(), m_searchIndex(0), m_initialized(false),
+        m_bulkUpdateDepth(0), m_bulkAddedIds(), m_bulkModifiedIds(),
+        m_bulkContainerIds(), m_snapshotMutex(),
+        m_snapshot(new HCdsSnapshot()), m_modifiedContainerIds(),
+        m_updateId(0), m_systemUpdateId(0), m_publishPending(false),
+        q_ptr(0)
+{
+    if (conf.searchIndexingEnabled())
+    {
+        m_searchIndex.reset(new HCdsSearchIndex());
+    }
 }
 
 HAbstractCdsDataSourcePrivate::~HAbstractCdsDataSourcePrivate()
 {
-    qDeleteAll(m_objectsById);
-    qDeleteAll(m_objectIdsByParentId);
+    // The readers may outlive the data source, in which case the objects are
+    // deleted when the last snapshot is released.
+    removeAll();
+}
+
+void HAbstractCdsDataSourcePrivate::removeAll()
+{
+    foreach(const QString& id, m_snapshot->m_childIds.keys())
+    {
+        m_modifiedContainerIds.insert(id);
+    }
+
+    foreach(HObject* obj, m_objectsById.takeAll())
+    {
+        retire(obj);
+    }
+    m_sharingReferences.clear();
+}
+
+QString HAbstractCdsDataSourcePrivate::sharedRefId(const HObject* obj)
+{
+    QVariant refId;
+    if (obj->h_ptr->m_properties.isReference() &&
+        obj->getCdsProperty(HCdsProperties::dlite_refId, &refId))
+    {
+        return refId.toString();
+    }
+    return QString();
 }
 
 void HAbstractCdsDataSourcePrivate::add(HObject* obj)
@@ -73,7 +115,25 @@ void HAbstractCdsDataSourcePrivate::add(HObject* obj)
         SLOT(objectModified_(Herqq::Upnp::Av::HObject*, Herqq::Upnp::Av::HObjectEventInfo)));
     Q_ASSERT(ok); Q_UNUSED(ok)
 
-    m_objectsById.insert(obj->id(), obj);
+    m_objectsById.insert(obj);
+    modified(obj->isContainer() ? obj->id() : QString());
+
+    QString refId = sharedRefId(obj);
+    if (!refId.isEmpty())
+    {
+        m_sharingReferences[refId].append(obj->id());
+    }
+
+    if (inBulkUpdate())
+    {
+        // indexed once the bulk update ends
+        m_bulkAddedIds.insert(obj->id());
+        m_bulkModifiedIds.remove(obj->id());
+    }
+    else if (m_searchIndex)
+    {
+        m_searchIndex->add(obj);
+    }
 
     if (obj->isContainer())
     {
@@ -86,6 +146,167 @@ void HAbstractCdsDataSourcePrivate::add(HObject* obj)
     }
 }
 
+void HAbstractCdsDataSourcePrivate::remove(const QString& id)
+{
+    if (m_searchIndex)
+    {
+        m_searchIndex->remove(id);
+    }
+
+    HObject* obj = m_objectsById.take(id);
+    if (obj)
+    {
+        QString refId = sharedRefId(obj);
+        if (!refId.isEmpty())
+        {
+            QHash<QString, QStringList>::iterator it =
+                m_sharingReferences.find(refId);
+            if (it != m_sharingReferences.end())
+            {
+                it->removeOne(id);
+                if (it->isEmpty())
+                {
+                    m_sharingReferences.erase(it);
+                }
+            }
+        }
+
+        modified(obj->isContainer() ? id : QString());
+        retire(obj);
+    }
+}
+
+qint32 HAbstractCdsDataSourcePrivate::removeSubtree(
+    const QString& id, QStringList* removedIds)
+{
+    HObject* obj = m_objectsById.value(id);
+    if (!obj)
+    {
+        return 0;
+    }
+
+    // The parent is updated once for the entire subtree, which emits a single
+    // containerModified() signal, or none, if the parent is not in the
+    // data source.
+    QString pid = obj->parentId();
+    HObject* parent = m_objectsById.value(pid);
+    if (parent && parent->isContainer())
+    {
+        parent->asContainer()->removeChildId(id);
+    }
+    else
+    {
+        QHash<QString, QStringList>::iterator it =
+            m_objectIdsByParentId.find(pid);
+
+        if (it != m_objectIdsByParentId.end())
+        {
+            it.value().removeOne(id);
+            if (it.value().isEmpty())
+            {
+                m_objectIdsByParentId.erase(it);
+            }
+        }
+    }
+
+    // The descendants are found through the child IDs of the containers and
+    // none of them is unlinked from its parent, since the parents are removed
+    // as well. An ID listed more than once is not found the second time.
+    qint32 retVal = 0;
+
+    QStringList pending;
+    pending.append(id);
+    while(!pending.isEmpty())
+    {
+        QString objectId = pending.takeLast();
+
+        obj = m_objectsById.take(objectId);
+        if (!obj)
+        {
+            continue;
+        }
+
+        if (obj->isContainer())
+        {
+            pending.append(obj->asContainer()->orderedChildIds());
+            modified(objectId);
+        }
+        else
+        {
+            modified();
+        }
+
+        if (m_searchIndex)
+        {
+            m_searchIndex->remove(objectId);
+        }
+
+        if (removedIds)
+        {
+            removedIds->append(objectId);
+        }
+
+        retire(obj);
+        ++retVal;
+    }
+
+    return retVal;
+}
+
+void HAbstractCdsDataSourcePrivate::beginBulkUpdate()
+{
+    ++m_bulkUpdateDepth;
+}
+
+void HAbstractCdsDataSourcePrivate::endBulkUpdate()
+{
+    Q_ASSERT(m_bulkUpdateDepth > 0);
+    if (--m_bulkUpdateDepth > 0)
+    {
+        return;
+    }
+
+    H_Q(HAbstractCdsDataSource);
+
+    // Objects removed during the bulk update are not reported.
+    QStringList addedIds = takeExisting(&m_bulkAddedIds, true);
+    QStringList modifiedIds = takeExisting(&m_bulkModifiedIds, true);
+    QStringList containerIds = takeExisting(&m_bulkContainerIds, false);
+
+    if (!addedIds.isEmpty() || !modifiedIds.isEmpty() ||
+        !containerIds.isEmpty())
+    {
+        emit q->bulkUpdateFinished(addedIds, modifiedIds, containerIds);
+    }
+
+    // The snapshot is published after the receivers of the signal have
+    // updated SystemUpdateID, which then describes the snapshot.
+    publish();
+}
+
+QStringList HAbstractCdsDataSourcePrivate::takeExisting(
+    QSet<QString>* ids, bool index)
+{
+    QStringList retVal;
+    retVal.reserve(ids->size());
+
+    foreach(const QString& id, *ids)
+    {
+        HObject* obj = m_objectsById.value(id);
+        if (obj)
+        {
+            if (index && m_searchIndex)
+            {
+                m_searchIndex->add(obj);
+            }
+            retVal.append(id);
+        }
+    }
+
+    ids->clear();
+    return retVal;
+}
+
 bool HAbstractCdsDataSourcePrivate::add(
     HObject* object, HAbstractCdsDataSource::AddFlag addFlag)
 {
@@ -110,9 +331,9 @@ bool HAbstractCdsDataSourcePrivate::add(
         break;
 
     case HAbstractCdsDataSource::AddAndOverwrite:
-        if (m_objectsById.contains(id))
+        if (m_objectsById.contains(id) && m_objectsById.value(id) != object)
         {
-            delete m_objectsById.value(id);
+            remove(id);
         }
         add(object);
         retVal = true;
@@ -129,14 +350,15 @@ bool HAbstractCdsDataSourcePrivate::add(
             // The parent object of "object" is not in control of this data source.
             // Store the ID of this object so that IF the parent object is added later on,
             // this object can be marked as a child of the parent (that is not yet here).
-            QSet<QString>* pids = m_objectIdsByParentId.value(pid);
-            if (!pids)
+            QStringList& pids = m_objectIdsByParentId[pid];
+            if (!pids.contains(id))
+            {
+                pids.append(id);
+            }
+            if (!inBulkUpdate())
             {
-                pids = new QSet<QString>();
-                m_objectIdsByParentId.insert(pid, pids);
+                emit q->independentObjectAdded(object);
             }
-            pids->insert(id);
-            emit q->independentObjectAdded(object);
         }
         else
         {
@@ -146,6 +368,10 @@ bool HAbstractCdsDataSourcePrivate::add(
             {
                 container->addChildId(id);
             }
+            else if (inBulkUpdate())
+            {
+                m_bulkContainerIds.insert(pid);
+            }
             else
             {
                 HContainerEventInfo einfo(HContainerEventInfo::ChildAdded, id);
@@ -155,16 +381,20 @@ bool HAbstractCdsDataSourcePrivate::add(
 
         // Check if there are object IDs stored and marked as children of the object
         // that was just added.
-        QSet<QString>* children = m_objectIdsByParentId.value(id);
-        if (children)
+        QHash<QString, QStringList>::iterator it =
+            m_objectIdsByParentId.find(id);
+
+        if (it != m_objectIdsByParentId.end())
         {
             // There are, update the object accordingly.
             Q_ASSERT(HObject::isContainer(object->type()));
             HContainer* container = static_cast<HContainer*>(object);
-            container->addChildIds(*children);
+            foreach(const QString& childId, it.value())
+            {
+                container->addChildId(childId);
+            }
 
-            delete children;
-            m_objectIdsByParentId.remove(id);
+            m_objectIdsByParentId.erase(it);
             // Remove the temporary child IDs, since the parent object is now
             // controlled by the data source and its child information is up to date.
         }
@@ -173,6 +403,104 @@ bool HAbstractCdsDataSourcePrivate::add(
     return retVal;
 }
 
+void HAbstractCdsDataSourcePrivate::modified(const QString& containerId)
+{
+    ++m_updateId;
+    if (!containerId.isEmpty())
+    {
+        m_modifiedContainerIds.insert(containerId);
+    }
+
+    schedulePublish();
+}
+
+void HAbstractCdsDataSourcePrivate::setSystemUpdateId(quint32 updateId)
+{
+    m_systemUpdateId = updateId;
+    schedulePublish();
+}
+
+void HAbstractCdsDataSourcePrivate::schedulePublish()
+{
+    if (!m_publishPending && !inBulkUpdate())
+    {
+        // The modifications made during the same event loop iteration are
+        // published together.
+        m_publishPending = true;
+        bool ok = QMetaObject::invokeMethod(
+            q_ptr, "publishSnapshot_", Qt::QueuedConnection);
+        Q_ASSERT(ok); Q_UNUSED(ok)
+    }
+}
+
+void HAbstractCdsDataSourcePrivate::retire(HObject* obj)
+{
+    Q_ASSERT(obj);
+
+    if (m_snapshot->object(obj->id()) != obj)
+    {
+        // no snapshot has seen the object
+        delete obj;
+        return;
+    }
+
+    // The snapshots older than the latest one cannot be modified, but the
+    // latest one is always destroyed after them.
+    QObject::disconnect(obj, 0, q_ptr, 0);
+    m_snapshot->m_retired.append(obj);
+}
+
+void HAbstractCdsDataSourcePrivate::publish()
+{
+    if (inBulkUpdate() || (m_snapshot->m_updateId == m_updateId &&
+        m_snapshot->m_systemUpdateId == m_systemUpdateId))
+    {
+        return;
+    }
+
+    HCdsSnapshotPtr next(new HCdsSnapshot());
+    next->m_slots = m_objectsById.slotArray();
+    next->m_handles = m_objectsById.handles();
+    next->m_childIds = m_snapshot->m_childIds;
+    next->m_updateId = m_updateId;
+    next->m_systemUpdateId = m_systemUpdateId;
+
+    foreach(const QString& id, m_modifiedContainerIds)
+    {
+        HObject* obj = m_objectsById.value(id);
+        if (obj && obj->isContainer())
+        {
+            next->m_childIds.insert(id, obj->asContainer()->orderedChildIds());
+        }
+        else
+        {
+            next->m_childIds.remove(id);
+        }
+    }
+    m_modifiedContainerIds.clear();
+
+    HCdsSnapshotPtr previous = m_snapshot;
+    previous->m_next = next;
+    {
+        QMutexLocker lock(&m_snapshotMutex);
+        m_snapshot = next;
+    }
+    // the previous snapshot is released outside the lock, since releasing it
+    // may delete the objects retired into it
+}
+
+HCdsSnapshotPtr HAbstractCdsDataSourcePrivate::snapshot()
+{
+    if (QThread::currentThread() == q_ptr->thread())
+    {
+        publish();
+        return m_snapshot;
+    }
+
+    QMutexLocker lock(&m_snapshotMutex);
+    return m_snapshot;
+}
+
 /*******************************************************************************
  * HAbstractCdsDataSource
  *******************************************************************************/
@@ -213,22 +541,73 @@ HAbstractCdsDataSource::~HAbstractCdsDataSource()
 void HAbstractCdsDataSource::objectModified_(
     HObject* source, const HObjectEventInfo& eventInfo)
 {
-    emit objectModified(source, eventInfo);
+    h_ptr->modified();
 
-    HContainer* parent = findContainer(source->parentId());
-    if (parent)
+    // The references that share the properties of the object are modified
+    // with it, which keeps their index entries and the caches up to date.
+    HObjects objects;
+    objects.append(source);
+    foreach(const QString& id, h_ptr->m_sharingReferences.value(source->id()))
     {
-        HContainerEventInfo info(HContainerEventInfo::ChildModified, source->id());
-        emit containerModified(parent, info);
+        HObject* reference = h_ptr->m_objectsById.value(id);
+        if (reference)
+        {
+            objects.append(reference);
+        }
+    }
+
+    foreach(HObject* object, objects)
+    {
+        if (h_ptr->inBulkUpdate())
+        {
+            if (!h_ptr->m_bulkAddedIds.contains(object->id()))
+            {
+                h_ptr->m_bulkModifiedIds.insert(object->id());
+            }
+            if (h_ptr->m_objectsById.contains(object->parentId()))
+            {
+                h_ptr->m_bulkContainerIds.insert(object->parentId());
+            }
+            continue;
+        }
+
+        if (h_ptr->m_searchIndex)
+        {
+            h_ptr->m_searchIndex->add(object);
+        }
+
+        emit objectModified(object, eventInfo);
+
+        HContainer* parent = findContainer(object->parentId());
+        if (parent)
+        {
+            HContainerEventInfo info(
+                HContainerEventInfo::ChildModified, object->id());
+            emit containerModified(parent, info);
+        }
     }
 }
 
 void HAbstractCdsDataSource::containerModified_(
     HContainer* source, const HContainerEventInfo& eventInfo)
 {
+    h_ptr->modified(source->id());
+
+    if (h_ptr->inBulkUpdate())
+    {
+        h_ptr->m_bulkContainerIds.insert(source->id());
+        return;
+    }
+
     emit containerModified(source, eventInfo);
 }
 
+void HAbstractCdsDataSource::publishSnapshot_()
+{
+    h_ptr->m_publishPending = false;
+    h_ptr->publish();
+}
+
 bool HAbstractCdsDataSource::doInit()
 {
     return true;
@@ -278,6 +657,7 @@ HObject* HAbstractCdsDataSource::findObject(const QString& id)
 HObjects HAbstractCdsDataSource::findObjects(const QSet<QString>& ids)
 {
     QList<HObject*> retVal;
+    retVal.reserve(ids.size());
     foreach(const QString& objectId, ids)
     {
         HObject* obj = h_ptr->m_objectsById.value(objectId);
@@ -289,6 +669,48 @@ HObjects HAbstractCdsDataSource::findObjects(const QSet<QString>& ids)
     return retVal;
 }
 
+HObjects HAbstractCdsDataSource::findObjects(const QStringList& ids)
+{
+    QList<HObject*> retVal;
+    retVal.reserve(ids.size());
+    for(qint32 i = 0; i < ids.size(); ++i)
+    {
+        HObject* obj = h_ptr->m_objectsById.value(ids[i]);
+        if (obj)
+        {
+            retVal.append(obj);
+        }
+    }
+    return retVal;
+}
+
+HObjects HAbstractCdsDataSource::findChildren(
+    const HContainer* container, qint32 startingIndex, qint32 count)
+{
+    Q_ASSERT(container);
+
+    QStringList childIds = container->orderedChildIds();
+    if (startingIndex < 0 || startingIndex >= childIds.size())
+    {
+        return HObjects();
+    }
+
+    qint32 end = count < 0 ?
+        childIds.size() : qMin(childIds.size(), startingIndex + count);
+
+    QList<HObject*> retVal;
+    retVal.reserve(end - startingIndex);
+    for(qint32 i = startingIndex; i < end; ++i)
+    {
+        HObject* obj = h_ptr->m_objectsById.value(childIds[i]);
+        if (obj)
+        {
+            retVal.append(obj);
+        }
+    }
+    return retVal;
+}
+
 HContainer* HAbstractCdsDataSource::findContainerWithTitle(const QString& title)
 {
     HContainer* retVal = 0;
@@ -323,6 +745,7 @@ HItem* HAbstractCdsDataSource::findItem(const QString& id)
 HItems HAbstractCdsDataSource::findItems(const QSet<QString>& ids)
 {
     QList<HItem*> retVal;
+    retVal.reserve(ids.size());
     foreach(const QString& objectId, ids)
     {
         HObject* obj = h_ptr->m_objectsById.value(objectId);
@@ -338,12 +761,13 @@ HItems HAbstractCdsDataSource::items() const
 {
     QList<HItem*> retVal;
 
-    QHash<QString, HObject*>::iterator it = h_ptr->m_objectsById.begin();
-    for (; it != h_ptr->m_objectsById.end(); ++it)
+    const HCdsObjectStore& store = h_ptr->m_objectsById;
+    for (qint32 i = 0; i < store.slotCount(); ++i)
     {
-        if (it.value()->isItem())
+        HObject* obj = store.object(i);
+        if (obj && obj->isItem())
         {
-            retVal.append(static_cast<HItem*>(it.value()));
+            retVal.append(static_cast<HItem*>(obj));
         }
     }
 
@@ -360,6 +784,7 @@ HContainer* HAbstractCdsDataSource::findContainer(const QString& id)
 HContainers HAbstractCdsDataSource::findContainers(const QSet<QString>& ids)
 {
     QList<HContainer*> retVal;
+    retVal.reserve(ids.size());
 
     foreach(const QString& objectId, ids)
     {
@@ -377,12 +802,13 @@ HContainers HAbstractCdsDataSource::containers() const
 {
     QList<HContainer*> retVal;
 
-    QHash<QString, HObject*>::iterator it = h_ptr->m_objectsById.begin();
-    for (; it != h_ptr->m_objectsById.end(); ++it)
+    const HCdsObjectStore& store = h_ptr->m_objectsById;
+    for (qint32 i = 0; i < store.slotCount(); ++i)
     {
-        if (it.value()->isContainer())
+        HObject* obj = store.object(i);
+        if (obj && obj->isContainer())
         {
-            retVal.append(static_cast<HContainer*>(it.value()));
+            retVal.append(static_cast<HContainer*>(obj));
         }
     }
 
@@ -394,9 +820,27 @@ QIODevice* HAbstractCdsDataSource::loadItemData(const QString& /*itemId*/)
     return 0;
 }
 
+bool HAbstractCdsDataSource::supportsStoring() const
+{
+    return false;
+}
+
+QIODevice* HAbstractCdsDataSource::storeItemData(
+    const QString& /*itemId*/, qint64 /*offset*/)
+{
+    return 0;
+}
+
+void HAbstractCdsDataSource::objectsRequested(const QStringList& /*objectIds*/)
+{
+}
+
 HObjects HAbstractCdsDataSource::add(const HObjects& objects, AddFlag addFlag)
 {
+    h_ptr->m_objectsById.reserve(h_ptr->m_objectsById.size() + objects.size());
+
     HObjects notAdded;
+    h_ptr->beginBulkUpdate();
     foreach(HObject* obj, objects)
     {
         if (!add(obj, addFlag))
@@ -404,6 +848,7 @@ HObjects HAbstractCdsDataSource::add(const HObjects& objects, AddFlag addFlag)
             notAdded.append(obj);
         }
     }
+    h_ptr->endBulkUpdate();
     return notAdded;
 }
 
@@ -416,13 +861,17 @@ bool HAbstractCdsDataSource::remove(const QString& id)
 {
     if (h_ptr->m_objectsById.contains(id))
     {
-        delete h_ptr->m_objectsById.value(id);
-        h_ptr->m_objectsById.remove(id);
+        h_ptr->remove(id);
         return true;
     }
     return false;
 }
 
+qint32 HAbstractCdsDataSource::removeSubtree(const QString& id)
+{
+    return h_ptr->removeSubtree(id);
+}
+
 qint32 HAbstractCdsDataSource::remove(const HObjects& objects)
 {
     qint32 removed = 0;
@@ -431,8 +880,7 @@ qint32 HAbstractCdsDataSource::remove(const HObjects& objects)
         QString id = obj->id();
         if (h_ptr->m_objectsById.contains(id))
         {
-            delete h_ptr->m_objectsById.value(id);
-            h_ptr->m_objectsById.remove(id);
+            h_ptr->remove(id);
             ++removed;
         }
     }
@@ -446,20 +894,46 @@ qint32 HAbstractCdsDataSource::remove(const QSet<QString>& ids)
     {
         if (h_ptr->m_objectsById.contains(id))
         {
-            delete h_ptr->m_objectsById.value(id);
-            h_ptr->m_objectsById.remove(id);
+            h_ptr->remove(id);
             ++removed;
         }
     }
     return removed;
 }
 
+void HAbstractCdsDataSource::beginBulkUpdate()
+{
+    h_ptr->beginBulkUpdate();
+}
+
+void HAbstractCdsDataSource::endBulkUpdate()
+{
+    h_ptr->endBulkUpdate();
+}
+
+bool HAbstractCdsDataSource::inBulkUpdate() const
+{
+    return h_ptr->inBulkUpdate();
+}
+
 void HAbstractCdsDataSource::clear()
 {
-    qDeleteAll(h_ptr->m_objectsById);
-    h_ptr->m_objectsById.clear();
-    qDeleteAll(h_ptr->m_objectIdsByParentId);
+    h_ptr->removeAll();
+    h_ptr->modified();
     h_ptr->m_objectIdsByParentId.clear();
+    h_ptr->m_bulkAddedIds.clear();
+    h_ptr->m_bulkModifiedIds.clear();
+    h_ptr->m_bulkContainerIds.clear();
+
+    if (h_ptr->m_searchIndex)
+    {
+        h_ptr->m_searchIndex->clear();
+    }
+}
+
+const HCdsSearchIndex* HAbstractCdsDataSource::searchIndex() const
+{
+    return h_ptr->m_searchIndex.data();
 }
 
 }
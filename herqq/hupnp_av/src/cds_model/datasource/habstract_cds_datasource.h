@@ -27,6 +27,7 @@
 #include <QtCore/QObject>
 
 class QIODevice;
+class QStringList;
 
 namespace Herqq
 {
@@ -37,7 +38,9 @@ namespace Upnp
 namespace Av
 {
 
+class HCdsSearchIndex;
 class HAbstractCdsDataSourcePrivate;
+class HContentDirectoryServicePrivate;
 
 /*!
  * \brief This class is used to store instances of the HUPnPAv CDS object model.
@@ -56,6 +59,7 @@ class H_UPNP_AV_EXPORT HAbstractCdsDataSource :
 Q_OBJECT
 H_DISABLE_COPY(HAbstractCdsDataSource)
 H_DECLARE_PRIVATE(HAbstractCdsDataSource)
+friend class HContentDirectoryServicePrivate;
 
 private Q_SLOTS:
 
@@ -67,6 +71,8 @@ private Q_SLOTS:
         Herqq::Upnp::Av::HContainer* source,
         const Herqq::Upnp::Av::HContainerEventInfo& eventInfo);
 
+    void publishSnapshot_();
+
 public:
 
     /*!
@@ -259,6 +265,52 @@ protected:
      */
     qint32 remove(const QSet<QString>& ids);
 
+    /*!
+     * \brief Removes the specified object and all of its descendants from the
+     * data source.
+     *
+     * The descendants are found through the child IDs of the containers and
+     * removed in a single pass. The parent container of the object is
+     * updated once, which means that a single containerModified() signal
+     * reports the removal of the whole subtree. No signal is emitted for the
+     * descendants.
+     *
+     * \param id specifies the ID of the topmost object to be removed.
+     *
+     * \return The number of removed objects. The return value is 0 in case
+     * the object was not found.
+     *
+     * \sa remove()
+     */
+    qint32 removeSubtree(const QString& id);
+
+    /*!
+     * \brief Starts a bulk update of the data source.
+     *
+     * While a bulk update is in progress, the data source does not emit
+     * objectModified(), containerModified() or independentObjectAdded().
+     * Instead, it records the IDs of the affected objects and containers,
+     * defers search indexing of the added and modified objects and emits
+     * a single bulkUpdateFinished() signal once the update ends. This makes
+     * adding a large number of objects considerably cheaper for both the
+     * data source and the components listening to its signals.
+     *
+     * Bulk updates can be nested, in which case the update ends once
+     * endBulkUpdate() has been called as many times as this method.
+     *
+     * \remarks add(const HObjects&, AddFlag) runs as a bulk update.
+     *
+     * \sa endBulkUpdate(), inBulkUpdate(), bulkUpdateFinished()
+     */
+    void beginBulkUpdate();
+
+    /*!
+     * \brief Ends a bulk update of the data source.
+     *
+     * \sa beginBulkUpdate()
+     */
+    void endBulkUpdate();
+
 public:
 
     /*!
@@ -266,6 +318,14 @@ public:
      */
     virtual ~HAbstractCdsDataSource() = 0;
 
+    //
+    // \internal
+    //
+    // Returns the search index of the data source, or null in case search
+    // indexing is not enabled in the configuration.
+    //
+    const HCdsSearchIndex* searchIndex() const;
+
     /*!
      * Initializes the data source. After a successful call, the data
      * source is ready to use.
@@ -287,6 +347,15 @@ public:
      */
     bool isInitialized() const;
 
+    /*!
+     * \brief Indicates if a bulk update of the data source is in progress.
+     *
+     * \return \e true if a bulk update of the data source is in progress.
+     *
+     * \sa beginBulkUpdate()
+     */
+    bool inBulkUpdate() const;
+
     /*!
      * \brief Indicates if the data source supports loading the possible data associated
      * with CDS items.
@@ -329,6 +398,60 @@ public:
      */
     virtual QIODevice* loadItemData(const QString& itemId);
 
+    /*!
+     * \brief Indicates if the data source supports storing the data
+     * associated with CDS items.
+     *
+     * \return \e true in case the data source supports storing the data
+     * associated with CDS items.
+     *
+     * \remarks The default implementation does not support storing of data.
+     * Override this method in derived classes that support storing of data.
+     *
+     * \sa storeItemData()
+     */
+    virtual bool supportsStoring() const;
+
+    /*!
+     * Opens the data of the specified HItem for storing.
+     *
+     * This is used when a resource is imported into an item, which is why
+     * the data can be stored in parts. The data is written at the specified
+     * offset, the data before it is kept as it is and the data after it
+     * is discarded.
+     *
+     * \param itemId specifies the ID of the HItem, which data is to be stored.
+     *
+     * \param offset specifies the position at which the data is written.
+     * Zero means that the previous data of the item is replaced.
+     *
+     * \return a pointer to a \c QIODevice opened for writing when the
+     * operation succeeds. The ownership of the pointer \b is transferred to
+     * the caller. If the operation fails a null pointer is returned.
+     *
+     * \remarks The default implementation returns a null pointer always, as it
+     * doesn't support storing of data. Override this method in derived classes
+     * that support storing of data.
+     *
+     * \sa supportsStoring()
+     */
+    virtual QIODevice* storeItemData(const QString& itemId, qint64 offset);
+
+    /*!
+     * \brief Informs the data source that the specified objects are being
+     * returned to a control point.
+     *
+     * The ContentDirectory service calls this method with the objects of
+     * each page it returns from a browse or a search. A data source that
+     * completes the information of its objects lazily can use this to handle
+     * the objects the clients are looking at first.
+     *
+     * \param objectIds specifies the IDs of the objects.
+     *
+     * \remarks The default implementation does nothing.
+     */
+    virtual void objectsRequested(const QStringList& objectIds);
+
     /*!
      * Attempts to find an object with the given object ID.
      *
@@ -366,6 +489,46 @@ public:
      */
     HObjects findObjects(const QSet<QString>& objectIds);
 
+    /*!
+     * Attempts to find objects with the specified object IDs.
+     *
+     * \param objectIds specifies the object IDs to be searched.
+     *
+     * \return The objects with the given object IDs in the order of the IDs.
+     *
+     * \remarks
+     * \li IDs that are not found are ignored.
+     *
+     * \li the ownership of the returned pointers are \b not transferred
+     * to the caller.
+     *
+     * \sa findChildren()
+     */
+    HObjects findObjects(const QStringList& objectIds);
+
+    /*!
+     * Returns a range of the child objects of the specified container.
+     *
+     * \param container specifies the container.
+     *
+     * \param startingIndex specifies the position of the first child
+     * in HContainer::orderedChildIds().
+     *
+     * \param count specifies the maximum number of children to return.
+     * A negative value means that all the children starting from
+     * \a startingIndex are returned.
+     *
+     * \return The child objects of the specified container in the order
+     * of HContainer::orderedChildIds(). Children that are not in this data
+     * source are ignored.
+     *
+     * \remarks The ownership of the returned pointers are \b not transferred
+     * to the caller.
+     */
+    HObjects findChildren(
+        const HContainer* container, qint32 startingIndex = 0,
+        qint32 count = -1);
+
     /*!
      * Indicates if the datasource has a container with the specified title.
      *
@@ -515,6 +678,27 @@ Q_SIGNALS:
      * \param source specifies the HObject that has been added.
      */
     void independentObjectAdded(Herqq::Upnp::Av::HObject* source);
+
+    /*!
+     * \brief This signal is emitted when a bulk update of the data source
+     * has ended.
+     *
+     * The signal summarizes the modifications made during the bulk update,
+     * which are not reported through the other modification signals.
+     *
+     * \param addedIds specifies the IDs of the objects that were added.
+     *
+     * \param modifiedIds specifies the IDs of the objects that were
+     * modified, excluding the objects that were added.
+     *
+     * \param containerIds specifies the IDs of the containers whose child
+     * lists or children were modified.
+     *
+     * \sa beginBulkUpdate()
+     */
+    void bulkUpdateFinished(
+        const QStringList& addedIds, const QStringList& modifiedIds,
+        const QStringList& containerIds);
 };
 
 }
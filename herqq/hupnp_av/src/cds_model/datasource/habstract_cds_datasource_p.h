@@ -30,10 +30,17 @@
 // change or the file may be removed without of notice.
 //
 
+#include "hcds_snapshot_p.h"
+#include "hcds_objectstore_p.h"
+#include "hcds_searchindex_p.h"
+
 #include <HUpnpAv/HAbstractCdsDataSource>
 
+#include <QtCore/QSet>
 #include <QtCore/QHash>
+#include <QtCore/QMutex>
 #include <QtCore/QString>
+#include <QtCore/QStringList>
 #include <QtCore/QScopedPointer>
 
 namespace Herqq
@@ -56,12 +63,51 @@ H_DECLARE_PUBLIC(HAbstractCdsDataSource)
 public: // attributes
 
     QScopedPointer<HCdsDataSourceConfiguration> m_configuration;
-    QHash<QString, HObject*> m_objectsById;
+    HCdsObjectStore m_objectsById;
+
+    QHash<QString, QStringList> m_objectIdsByParentId;
+    // key == the id of a parent that is not in the data source, value ==
+    // the ids of its children in the order they were added
 
-    QHash<QString, QSet<QString>*> m_objectIdsByParentId;
+    QScopedPointer<HCdsSearchIndex> m_searchIndex;
+    // null unless search indexing is enabled in the configuration
+
+    QHash<QString, QStringList> m_sharingReferences;
+    // key == the id of a referenced item, value == the ids of the references
+    // that share the properties of the item. see HItem::newReference()
 
     bool m_initialized;
 
+    qint32 m_bulkUpdateDepth;
+    // the nesting level of bulk updates. no modification signals are
+    // emitted and no objects are indexed while this is greater than 0
+
+    QSet<QString> m_bulkAddedIds;
+    // the ids of the objects added during the bulk update
+
+    QSet<QString> m_bulkModifiedIds;
+    // the ids of the objects modified, but not added during the bulk update
+
+    QSet<QString> m_bulkContainerIds;
+    // the ids of the containers modified during the bulk update
+
+    QMutex m_snapshotMutex;
+    HCdsSnapshotPtr m_snapshot;
+    // the latest published snapshot, which is never null. the mutex guards
+    // the pointer only, as the snapshot itself is never modified
+
+    QSet<QString> m_modifiedContainerIds;
+    // the ids of the objects whose child ids may have changed since the
+    // latest snapshot was published
+
+    quint32 m_updateId;
+    // incremented on every modification of the data source
+
+    quint32 m_systemUpdateId;
+    // the SystemUpdateID set by the content directory serving the data source
+
+    bool m_publishPending;
+
     HAbstractCdsDataSource* q_ptr;
 
 public: // methods
@@ -70,8 +116,57 @@ public: // methods
     HAbstractCdsDataSourcePrivate(const HCdsDataSourceConfiguration&);
     virtual ~HAbstractCdsDataSourcePrivate();
 
+    // returns the id of the item the object shares its properties with or
+    // an empty string in case the object is not such a reference
+    static QString sharedRefId(const HObject*);
+
     void add(HObject*);
     bool add(HObject*, HAbstractCdsDataSource::AddFlag addFlag);
+    void remove(const QString& id);
+
+    // removes the object, its descendants and the reference to the object in
+    // its parent. returns the number of removed objects, the ids of which are
+    // appended to removedIds, if specified
+    qint32 removeSubtree(const QString& id, QStringList* removedIds = 0);
+
+    // removes every object without reporting the removals
+    void removeAll();
+
+    inline bool inBulkUpdate() const { return m_bulkUpdateDepth > 0; }
+    void beginBulkUpdate();
+    void endBulkUpdate();
+
+    // returns the ids that are still in the data source and clears the set.
+    // the objects are added to the search index if requested
+    QStringList takeExisting(QSet<QString>* ids, bool index);
+
+    // records a modification of the data source and schedules the publishing
+    // of a new snapshot. the id specifies an object whose child ids have
+    // changed, if any
+    void modified(const QString& containerId = QString());
+
+    // called by the content directory whenever it increments its
+    // SystemUpdateID in response to the modifications, which is why the
+    // value is published along with the modifications
+    void setSystemUpdateId(quint32);
+
+    // schedules the publishing of a new snapshot in the next event loop
+    // iteration, unless one is scheduled already or a bulk update is
+    // in progress
+    void schedulePublish();
+
+    // deletes an object that has been removed from the data source, once
+    // none of the snapshots refers to it any more
+    void retire(HObject*);
+
+    // publishes the current contents of the data source, unless a bulk
+    // update is in progress. must be called from the thread of the data source
+    void publish();
+
+    // returns the latest published snapshot. this can be called from any
+    // thread. when called from the thread of the data source, the pending
+    // modifications are published first, unless a bulk update is in progress
+    HCdsSnapshotPtr snapshot();
 };
 
 }
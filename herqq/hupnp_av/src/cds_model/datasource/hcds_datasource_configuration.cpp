@@ -34,7 +34,9 @@ namespace Av
 /*******************************************************************************
  * HCdsDataSourceConfigurationPrivate
  *******************************************************************************/
-HCdsDataSourceConfigurationPrivate::HCdsDataSourceConfigurationPrivate()
+HCdsDataSourceConfigurationPrivate::HCdsDataSourceConfigurationPrivate() :
+    m_searchIndexingEnabled(false), m_didlLiteCacheSize(0),
+    m_browseCacheSize(0)
 {
 }
 
@@ -63,14 +65,17 @@ HCdsDataSourceConfiguration::~HCdsDataSourceConfiguration()
 
 void HCdsDataSourceConfiguration::doClone(HClonable* target) const
 {
-    Q_UNUSED(target)
-//    HCdsDataSourceConfiguration* conf =
-//        dynamic_cast<HCdsDataSourceConfiguration*>(target);
-//
-//    if (!conf)
-//    {
-//        return;
-//    }
+    HCdsDataSourceConfiguration* conf =
+        dynamic_cast<HCdsDataSourceConfiguration*>(target);
+
+    if (!conf)
+    {
+        return;
+    }
+
+    conf->h_ptr->m_searchIndexingEnabled = h_ptr->m_searchIndexingEnabled;
+    conf->h_ptr->m_didlLiteCacheSize = h_ptr->m_didlLiteCacheSize;
+    conf->h_ptr->m_browseCacheSize = h_ptr->m_browseCacheSize;
 }
 
 HCdsDataSourceConfiguration* HCdsDataSourceConfiguration::newInstance() const
@@ -83,6 +88,36 @@ HCdsDataSourceConfiguration* HCdsDataSourceConfiguration::clone() const
     return static_cast<HCdsDataSourceConfiguration*>(HClonable::clone());
 }
 
+bool HCdsDataSourceConfiguration::searchIndexingEnabled() const
+{
+    return h_ptr->m_searchIndexingEnabled;
+}
+
+void HCdsDataSourceConfiguration::setSearchIndexingEnabled(bool enabled)
+{
+    h_ptr->m_searchIndexingEnabled = enabled;
+}
+
+qint32 HCdsDataSourceConfiguration::didlLiteCacheSize() const
+{
+    return h_ptr->m_didlLiteCacheSize;
+}
+
+void HCdsDataSourceConfiguration::setDidlLiteCacheSize(qint32 maxBytes)
+{
+    h_ptr->m_didlLiteCacheSize = qMax(maxBytes, 0);
+}
+
+qint32 HCdsDataSourceConfiguration::browseCacheSize() const
+{
+    return h_ptr->m_browseCacheSize;
+}
+
+void HCdsDataSourceConfiguration::setBrowseCacheSize(qint32 maxBytes)
+{
+    h_ptr->m_browseCacheSize = qMax(maxBytes, 0);
+}
+
 }
 }
 }
@@ -79,6 +79,94 @@ public:
 
     // Documented in HClonable
     virtual HCdsDataSourceConfiguration* clone() const;
+
+    /*!
+     * \brief Indicates whether the data source maintains indexes for
+     * searching its objects.
+     *
+     * \return \e true in case the data source maintains indexes for
+     * searching its objects.
+     *
+     * \sa setSearchIndexingEnabled()
+     */
+    bool searchIndexingEnabled() const;
+
+    /*!
+     * \brief Specifies whether the data source should maintain indexes for
+     * searching its objects.
+     *
+     * The indexes enable a ContentDirectory to answer searches by class,
+     * by artist, album or genre and by words of titles without evaluating
+     * the search criteria against every object in the data source. The
+     * indexes are updated whenever objects are added, removed or modified,
+     * which increases the memory usage and the cost of modifications.
+     * By default the indexes are not maintained.
+     *
+     * \param enabled specifies whether the data source should maintain
+     * indexes for searching its objects.
+     *
+     * \sa searchIndexingEnabled()
+     */
+    void setSearchIndexingEnabled(bool enabled);
+
+    /*!
+     * \brief Returns the maximum number of bytes a ContentDirectory may use
+     * for caching serialized DIDL-Lite of the objects of the data source.
+     *
+     * \return The maximum number of bytes a ContentDirectory may use
+     * for caching serialized DIDL-Lite of the objects of the data source.
+     * Zero means that the caching is disabled.
+     *
+     * \sa setDidlLiteCacheSize()
+     */
+    qint32 didlLiteCacheSize() const;
+
+    /*!
+     * \brief Specifies the maximum number of bytes a ContentDirectory may use
+     * for caching serialized DIDL-Lite of the objects of the data source.
+     *
+     * When the cache is enabled, a ContentDirectory keeps the DIDL-Lite
+     * of each object it returns for each distinct filter it is requested
+     * with, which means that browsing the same containers over and over
+     * again does not require serializing the objects every time. A cached
+     * object is dropped when it is modified. By default the cache is disabled.
+     *
+     * \param maxBytes specifies the maximum number of bytes used for caching.
+     * Zero or a negative value disables the cache.
+     *
+     * \sa didlLiteCacheSize()
+     */
+    void setDidlLiteCacheSize(qint32 maxBytes);
+
+    /*!
+     * \brief Returns the maximum number of bytes a ContentDirectory may use
+     * for caching the results of browse requests.
+     *
+     * \return The maximum number of bytes a ContentDirectory may use
+     * for caching the results of browse requests.
+     * Zero means that the caching is disabled.
+     *
+     * \sa setBrowseCacheSize()
+     */
+    qint32 browseCacheSize() const;
+
+    /*!
+     * \brief Specifies the maximum number of bytes a ContentDirectory may use
+     * for caching the results of browse requests.
+     *
+     * When the cache is enabled, a ContentDirectory keeps the results of the
+     * browse requests it has handled, keyed by the arguments of the requests.
+     * Repeated identical requests, such as control points polling the same
+     * container, are then answered without browsing the data source.
+     * A cached result is dropped when the browsed object or any of its
+     * children is modified. By default the cache is disabled.
+     *
+     * \param maxBytes specifies the maximum number of bytes used for caching.
+     * Zero or a negative value disables the cache.
+     *
+     * \sa browseCacheSize(), setDidlLiteCacheSize()
+     */
+    void setBrowseCacheSize(qint32 maxBytes);
 };
 
 }
@@ -48,6 +48,12 @@ class H_UPNP_AV_EXPORT HCdsDataSourceConfigurationPrivate
 {
 H_DISABLE_COPY(HCdsDataSourceConfigurationPrivate)
 
+public: // attributes
+
+    bool m_searchIndexingEnabled;
+    qint32 m_didlLiteCacheSize;
+    qint32 m_browseCacheSize;
+
 public: // methods
 
     HCdsDataSourceConfigurationPrivate();
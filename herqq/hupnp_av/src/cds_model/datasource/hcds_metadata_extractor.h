@@ -0,0 +1,112 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HCDS_METADATA_EXTRACTOR_H_
+#define HCDS_METADATA_EXTRACTOR_H_
+
+#include <HUpnpAv/HUpnpAv>
+
+#include <QtCore/QHash>
+#include <QtCore/QVariant>
+
+class QString;
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+/*!
+ * \brief This is an abstract base class for reading metadata, such as
+ * tags and stream headers, from media files.
+ *
+ * HFileSystemDataSource publishes the items it finds in the file system
+ * using only the information available from the file names. When metadata
+ * extractors are configured, the items are handed over to the extractors
+ * in the background once they have been published and the properties
+ * returned by the extractors are set to the items afterwards.
+ *
+ * \headerfile hcds_metadata_extractor.h HCdsMetadataExtractor
+ *
+ * \ingroup hupnp_av_cds_ds
+ *
+ * \remarks The methods of this class are called from worker threads and
+ * possibly from several threads at the same time. The implementations have
+ * to be thread-safe.
+ *
+ * \sa HFileSystemDataSourceConfiguration::setMetadataExtractors()
+ */
+class H_UPNP_AV_EXPORT HCdsMetadataExtractor
+{
+H_DISABLE_COPY(HCdsMetadataExtractor)
+
+public:
+
+    /*!
+     * \brief Creates a new instance.
+     */
+    HCdsMetadataExtractor();
+
+    /*!
+     * \brief Destroys the instance.
+     */
+    virtual ~HCdsMetadataExtractor();
+
+    /*!
+     * \brief Indicates if the extractor can read metadata from files of the
+     * specified type.
+     *
+     * \param contentFormat specifies the MIME type of a file, such as
+     * \c audio/mpeg.
+     *
+     * \return \e true in case the extractor can read metadata from files of the
+     * specified type.
+     */
+    virtual bool supports(const QString& contentFormat) const = 0;
+
+    /*!
+     * \brief Reads the metadata of the specified file.
+     *
+     * \param path specifies the path of the file.
+     *
+     * \param contentFormat specifies the MIME type of the file.
+     *
+     * \param properties specifies a pointer to a hash that receives
+     * the metadata. The keys are CDS property names, such as
+     * \c upnp:artist and \c dc:date, and the values are the values of the
+     * properties.
+     *
+     * \return \e true in case metadata was read from the file.
+     */
+    virtual bool extract(
+        const QString& path, const QString& contentFormat,
+        QHash<QString, QVariant>* properties) = 0;
+};
+
+}
+}
+}
+
+#endif /* HCDS_METADATA_EXTRACTOR_H_ */
@@ -0,0 +1,190 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hcds_objectstore_p.h"
+
+#include "../cds_objects/hobject.h"
+#include "../cds_objects/hobject_p.h"
+
+#include <HUpnpCore/private/hmemoryaccount_p.h>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+namespace
+{
+HMemoryAccount* memoryAccount()
+{
+    static HMemoryAccount* const retVal =
+        HMemoryAccount::get(QLatin1String("cds.objects"));
+    return retVal;
+}
+}
+
+/*******************************************************************************
+ * HCdsObjectStore
+ ******************************************************************************/
+HCdsObjectStore::HCdsObjectStore() :
+    m_slots(), m_footprints(), m_freeSlots(), m_handles()
+{
+}
+
+HCdsObjectStore::~HCdsObjectStore()
+{
+    deleteAll();
+}
+
+qint64 HCdsObjectStore::footprint(const HObject* object)
+{
+    // the object and its private part are sized by their static types,
+    // the key of the object in m_handles is counted as well
+    return sizeof(HObject) + sizeof(HObjectPrivate) +
+        object->h_ptr->m_properties.footprint() +
+        object->id().size() * sizeof(QChar);
+}
+
+void HCdsObjectStore::account(qint32 handle, HObject* object)
+{
+    // an object that is modified while it is in the store keeps the
+    // footprint it had when it was inserted
+    qint64 bytes = object ? footprint(object) : 0;
+    memoryAccount()->add(
+        bytes - m_footprints[handle],
+        (object ? 1 : 0) - (m_slots[handle] ? 1 : 0));
+
+    m_slots[handle] = object;
+    m_footprints[handle] = bytes;
+}
+
+void HCdsObjectStore::unaccountAll()
+{
+    qint64 bytes = 0;
+    for(qint32 i = 0; i < m_footprints.size(); ++i)
+    {
+        bytes += m_footprints[i];
+    }
+    memoryAccount()->remove(bytes, m_handles.size());
+}
+
+qint32 HCdsObjectStore::insert(HObject* object)
+{
+    Q_ASSERT(object);
+
+    QString id = object->id();
+    qint32 retVal = handle(id);
+    if (retVal >= 0)
+    {
+        if (m_slots[retVal] != object)
+        {
+            delete m_slots[retVal];
+            account(retVal, object);
+        }
+        return retVal;
+    }
+
+    if (!m_freeSlots.isEmpty())
+    {
+        retVal = m_freeSlots.last();
+        m_freeSlots.pop_back();
+    }
+    else
+    {
+        retVal = m_slots.size();
+        m_slots.append(0);
+        m_footprints.append(0);
+    }
+    account(retVal, object);
+
+    m_handles.insert(id, retVal);
+    return retVal;
+}
+
+HObject* HCdsObjectStore::take(const QString& id)
+{
+    QHash<QString, qint32>::iterator it = m_handles.find(id);
+    if (it == m_handles.end())
+    {
+        return 0;
+    }
+
+    qint32 h = it.value();
+    m_handles.erase(it);
+
+    HObject* retVal = m_slots[h];
+    account(h, 0);
+    m_freeSlots.append(h);
+
+    return retVal;
+}
+
+HObjects HCdsObjectStore::values() const
+{
+    HObjects retVal;
+    retVal.reserve(m_handles.size());
+
+    for(qint32 i = 0; i < m_slots.size(); ++i)
+    {
+        if (m_slots[i])
+        {
+            retVal.append(m_slots[i]);
+        }
+    }
+
+    return retVal;
+}
+
+void HCdsObjectStore::reserve(qint32 size)
+{
+    m_slots.reserve(size);
+    m_footprints.reserve(size);
+    m_handles.reserve(size);
+}
+
+void HCdsObjectStore::deleteAll()
+{
+    unaccountAll();
+    qDeleteAll(m_slots);
+    m_slots.clear();
+    m_footprints.clear();
+    m_freeSlots.clear();
+    m_handles.clear();
+}
+
+HObjects HCdsObjectStore::takeAll()
+{
+    HObjects retVal = values();
+    unaccountAll();
+    m_slots.clear();
+    m_footprints.clear();
+    m_freeSlots.clear();
+    m_handles.clear();
+    return retVal;
+}
+
+}
+}
+}
@@ -0,0 +1,141 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HCDS_OBJECTSTORE_P_H_
+#define HCDS_OBJECTSTORE_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include <HUpnpAv/HUpnpAv>
+
+#include <QtCore/QHash>
+#include <QtCore/QVector>
+#include <QtCore/QString>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+//
+// Stores the objects of a data source in a slot array. Each object is
+// addressed by a dense integer handle that stays the same as long as the
+// object is in the store, and the string IDs are mapped to handles once.
+// The slots of removed objects are reused.
+//
+class HCdsObjectStore
+{
+H_DISABLE_COPY(HCdsObjectStore)
+
+private:
+
+    QVector<HObject*> m_slots;
+    // a removed object leaves a null slot behind until it is reused
+
+    QVector<qint64> m_footprints;
+    // the estimated footprints of the objects when they were inserted,
+    // indexed by handle
+
+    QVector<qint32> m_freeSlots;
+
+    QHash<QString, qint32> m_handles;
+    // key == object id, value == the index of the object in m_slots
+
+    static qint64 footprint(const HObject*);
+
+    void account(qint32 handle, HObject*);
+    void unaccountAll();
+
+public:
+
+    HCdsObjectStore();
+    ~HCdsObjectStore();
+
+    inline qint32 handle(const QString& id) const
+    {
+        return m_handles.value(id, -1);
+    }
+
+    inline HObject* object(qint32 handle) const
+    {
+        return handle >= 0 && handle < m_slots.size() ? m_slots[handle] : 0;
+    }
+
+    inline HObject* value(const QString& id) const
+    {
+        return object(handle(id));
+    }
+
+    inline bool contains(const QString& id) const
+    {
+        return m_handles.contains(id);
+    }
+
+    inline qint32 size() const
+    {
+        return m_handles.size();
+    }
+
+    // the handles are in the range [0, slotCount()), but some of the slots
+    // may be empty
+    inline qint32 slotCount() const
+    {
+        return m_slots.size();
+    }
+
+    // the arrays are implicitly shared with the snapshots of the data source
+    inline const QVector<HObject*>& slotArray() const { return m_slots; }
+    inline const QHash<QString, qint32>& handles() const { return m_handles; }
+
+    // the ownership of the object is transferred to the store. an object
+    // with the same id that is already in the store is deleted
+    qint32 insert(HObject* object);
+
+    // the ownership of the object is transferred to the caller
+    HObject* take(const QString& id);
+
+    HObjects values() const;
+
+    // reserves space for the specified number of objects
+    void reserve(qint32 size);
+
+    void deleteAll();
+
+    // empties the store and transfers the ownership of the objects to
+    // the caller
+    HObjects takeAll();
+};
+
+}
+}
+}
+
+#endif /* HCDS_OBJECTSTORE_P_H_ */
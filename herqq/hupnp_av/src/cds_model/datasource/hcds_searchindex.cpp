@@ -0,0 +1,543 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hcds_searchindex_p.h"
+
+#include "../hgenre.h"
+#include "../hcds_classhierarchy_p.h"
+#include "../hpersonwithrole.h"
+#include "../hscheduledtime.h"
+#include "../cds_objects/hobject.h"
+
+#include <HUpnpCore/private/hmemoryaccount_p.h>
+
+#include <QtCore/QDateTime>
+
+#include <limits>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+namespace
+{
+const char* const ValueIndexedProperties[] =
+{
+    "upnp:artist", "upnp:album", "upnp:genre", "upnp:actor", "upnp:author",
+    "dc:creator", "upnp:channelName", 0
+};
+
+const char* const TokenIndexedProperties[] =
+{
+    "dc:title", "upnp:artist", "upnp:album", "dc:creator", 0
+};
+
+// the estimated overhead of a single posting: the node of the ID in the set
+// of the term and the (property, term) pair kept in IndexedTerms
+const qint64 PostingBytes =
+    sizeof(QString) + 2 * sizeof(void*) + sizeof(QPair<QString, QString>);
+
+HMemoryAccount* memoryAccount()
+{
+    static HMemoryAccount* const retVal =
+        HMemoryAccount::get(QLatin1String("cds.index"));
+    return retVal;
+}
+
+bool contains(const char* const properties[], const QString& property)
+{
+    for(qint32 i = 0; properties[i]; ++i)
+    {
+        if (property == QLatin1String(properties[i]))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool getScheduledTime(
+    const HObject* object, const QString& property, qint64* time)
+{
+    QList<QVariant> values;
+    HCdsSearchIndex::getValues(object, property, &values);
+    if (values.isEmpty())
+    {
+        return false;
+    }
+
+    *time = values.first().toDateTime().toMSecsSinceEpoch();
+    return true;
+}
+
+void appendValues(const QVariant& value, QList<QVariant>* values)
+{
+    if (!value.isValid() || value.isNull())
+    {
+        return;
+    }
+
+    qint32 type = value.userType();
+    if (type == QVariant::List)
+    {
+        foreach(const QVariant& item, value.toList())
+        {
+            appendValues(item, values);
+        }
+    }
+    else if (type == QVariant::StringList)
+    {
+        foreach(const QString& item, value.toStringList())
+        {
+            if (!item.isEmpty())
+            {
+                values->append(item);
+            }
+        }
+    }
+    else if (type == qMetaTypeId<HPersonWithRole>())
+    {
+        values->append(value.value<HPersonWithRole>().name());
+    }
+    else if (type == qMetaTypeId<HGenre>())
+    {
+        values->append(value.value<HGenre>().name());
+    }
+    else if (type == qMetaTypeId<HScheduledTime>())
+    {
+        // The daylight saving indicator does not take part in comparisons.
+        QDateTime time = value.value<HScheduledTime>().value();
+        if (time.isValid())
+        {
+            values->append(time);
+        }
+    }
+    else
+    {
+        values->append(value);
+    }
+}
+}
+
+/*******************************************************************************
+ * HCdsScheduleWindow
+ ******************************************************************************/
+HCdsScheduleWindow::HCdsScheduleWindow() :
+    m_startMin(std::numeric_limits<qint64>::min()),
+    m_startMax(std::numeric_limits<qint64>::max()),
+    m_endMin(std::numeric_limits<qint64>::min()),
+    m_endMax(std::numeric_limits<qint64>::max())
+{
+}
+
+/*******************************************************************************
+ * HCdsSearchIndex
+ ******************************************************************************/
+HCdsSearchIndex::HCdsSearchIndex() :
+    m_classes(), m_values(), m_tokens(), m_schedule(),
+    m_maxScheduledDuration(0), m_endOnly(), m_indexedTerms(), m_footprint(0)
+{
+}
+
+HCdsSearchIndex::~HCdsSearchIndex()
+{
+    clear();
+}
+
+void HCdsSearchIndex::removePosting(
+    QHash<QString, Postings>* index, const QString& property,
+    const QString& term, const QString& id)
+{
+    QHash<QString, Postings>::iterator it = index->find(property);
+    if (it == index->end())
+    {
+        return;
+    }
+
+    Postings::iterator pit = it->find(term);
+    if (pit != it->end())
+    {
+        pit->remove(id);
+        if (pit->isEmpty())
+        {
+            it->erase(pit);
+        }
+    }
+}
+
+void HCdsSearchIndex::add(const HObject* object)
+{
+    Q_ASSERT(object);
+
+    QString id = object->id();
+    remove(id);
+
+    IndexedTerms terms;
+    terms.m_clazz = object->clazz();
+    m_classes[terms.m_clazz].insert(id);
+    terms.m_footprint =
+        sizeof(IndexedTerms) + id.size() * sizeof(QChar) + PostingBytes;
+
+    QSet<QString> properties;
+    for(qint32 i = 0; ValueIndexedProperties[i]; ++i)
+    {
+        properties.insert(QLatin1String(ValueIndexedProperties[i]));
+    }
+    for(qint32 i = 0; TokenIndexedProperties[i]; ++i)
+    {
+        properties.insert(QLatin1String(TokenIndexedProperties[i]));
+    }
+
+    foreach(const QString& property, properties)
+    {
+        QList<QVariant> values;
+        getValues(object, property, &values);
+
+        bool valueIndexed = contains(ValueIndexedProperties, property);
+        bool tokenIndexed = contains(TokenIndexedProperties, property);
+
+        foreach(const QVariant& value, values)
+        {
+            QString str = value.toString();
+            if (valueIndexed)
+            {
+                QString term = str.toCaseFolded();
+                m_values[property][term].insert(id);
+                terms.m_values.append(qMakePair(property, term));
+                terms.m_footprint +=
+                    PostingBytes + term.size() * sizeof(QChar);
+            }
+            if (tokenIndexed)
+            {
+                foreach(const QString& token, tokenize(str))
+                {
+                    m_tokens[property][token].insert(id);
+                    terms.m_tokens.append(qMakePair(property, token));
+                    terms.m_footprint +=
+                        PostingBytes + token.size() * sizeof(QChar);
+                }
+            }
+        }
+    }
+
+    qint64 start = 0, end = 0;
+    bool hasStart = getScheduledTime(
+        object, QLatin1String("upnp:scheduledStartTime"), &start);
+    bool hasEnd = getScheduledTime(
+        object, QLatin1String("upnp:scheduledEndTime"), &end);
+
+    if (hasStart)
+    {
+        ScheduledEntry entry;
+        entry.m_end = hasEnd ? qMax(start, end) : start;
+        entry.m_id = id;
+        m_schedule.insert(start, entry);
+        m_maxScheduledDuration =
+            qMax(m_maxScheduledDuration, entry.m_end - start);
+
+        terms.m_scheduled = true;
+        terms.m_scheduledStart = start;
+        terms.m_footprint += sizeof(ScheduledEntry) + 2 * sizeof(void*);
+    }
+    else if (hasEnd)
+    {
+        m_endOnly.insert(id);
+        terms.m_endOnly = true;
+        terms.m_footprint += sizeof(QString) + 2 * sizeof(void*);
+    }
+
+    m_indexedTerms.insert(id, terms);
+    m_footprint += terms.m_footprint;
+    memoryAccount()->add(terms.m_footprint);
+}
+
+void HCdsSearchIndex::remove(const QString& id)
+{
+    QHash<QString, IndexedTerms>::iterator it = m_indexedTerms.find(id);
+    if (it == m_indexedTerms.end())
+    {
+        return;
+    }
+
+    const IndexedTerms& terms = it.value();
+
+    Postings::iterator cit = m_classes.find(terms.m_clazz);
+    if (cit != m_classes.end())
+    {
+        cit->remove(id);
+        if (cit->isEmpty())
+        {
+            m_classes.erase(cit);
+        }
+    }
+
+    for(qint32 i = 0; i < terms.m_values.size(); ++i)
+    {
+        removePosting(
+            &m_values, terms.m_values[i].first, terms.m_values[i].second, id);
+    }
+
+    for(qint32 i = 0; i < terms.m_tokens.size(); ++i)
+    {
+        removePosting(
+            &m_tokens, terms.m_tokens[i].first, terms.m_tokens[i].second, id);
+    }
+
+    if (terms.m_scheduled)
+    {
+        QMultiMap<qint64, ScheduledEntry>::iterator sit =
+            m_schedule.find(terms.m_scheduledStart);
+        for(; sit != m_schedule.end() &&
+              sit.key() == terms.m_scheduledStart; ++sit)
+        {
+            if (sit->m_id == id)
+            {
+                m_schedule.erase(sit);
+                break;
+            }
+        }
+    }
+    else if (terms.m_endOnly)
+    {
+        m_endOnly.remove(id);
+    }
+
+    m_footprint -= terms.m_footprint;
+    memoryAccount()->remove(terms.m_footprint);
+
+    m_indexedTerms.erase(it);
+}
+
+void HCdsSearchIndex::clear()
+{
+    memoryAccount()->remove(m_footprint, m_indexedTerms.size());
+    m_footprint = 0;
+
+    m_classes.clear();
+    m_values.clear();
+    m_tokens.clear();
+    m_schedule.clear();
+    m_maxScheduledDuration = 0;
+    m_endOnly.clear();
+    m_indexedTerms.clear();
+}
+
+bool HCdsSearchIndex::findClass(
+    const QString& clazz, QSet<QString>* ids) const
+{
+    Q_ASSERT(ids);
+
+    // The number of distinct classes is small compared to the number of
+    // objects, which is why this is not a hash lookup. The comparison is
+    // case-insensitive in the same way as in the search criteria.
+    Postings::const_iterator it = m_classes.constBegin();
+    for(; it != m_classes.constEnd(); ++it)
+    {
+        if (it.key().compare(clazz, Qt::CaseInsensitive) == 0)
+        {
+            ids->unite(it.value());
+        }
+    }
+    return true;
+}
+
+bool HCdsSearchIndex::findDerivedFrom(
+    const QString& clazz, QSet<QString>* ids) const
+{
+    Q_ASSERT(ids);
+
+    // The base class is looked up once, after which the check against each of
+    // the indexed classes is an interval test on the class IDs.
+    qint32 baseId = HCdsClassHierarchy::id(clazz);
+
+    Postings::const_iterator it = m_classes.constBegin();
+    for(; it != m_classes.constEnd(); ++it)
+    {
+        if (HCdsClassHierarchy::isDerivedFrom(it.key(), clazz, baseId))
+        {
+            ids->unite(it.value());
+        }
+    }
+    return true;
+}
+
+bool HCdsSearchIndex::findEqual(
+    const QString& property, const QString& value, QSet<QString>* ids) const
+{
+    Q_ASSERT(ids);
+
+    if (!contains(ValueIndexedProperties, property))
+    {
+        return false;
+    }
+
+    ids->unite(m_values.value(property).value(value.toCaseFolded()));
+    return true;
+}
+
+bool HCdsSearchIndex::findContaining(
+    const QString& property, const QString& value, QSet<QString>* ids) const
+{
+    Q_ASSERT(ids);
+
+    QStringList words = tokenize(value);
+    if (words.isEmpty() || !contains(TokenIndexedProperties, property))
+    {
+        return false;
+    }
+
+    // Every word of the value has to be a part of a word of the property.
+    // The tokens are scanned instead of looked up, since a word of the
+    // value may be a part of a longer word, as in "beat" of "beatles".
+    const Postings tokens = m_tokens.value(property);
+
+    QSet<QString> retVal;
+    for(qint32 i = 0; i < words.size(); ++i)
+    {
+        QSet<QString> matches;
+        Postings::const_iterator it = tokens.constBegin();
+        for(; it != tokens.constEnd(); ++it)
+        {
+            if (it.key().contains(words[i]))
+            {
+                matches.unite(it.value());
+            }
+        }
+
+        if (i == 0)
+        {
+            retVal = matches;
+        }
+        else
+        {
+            retVal.intersect(matches);
+        }
+
+        if (retVal.isEmpty())
+        {
+            break;
+        }
+    }
+
+    ids->unite(retVal);
+    return true;
+}
+
+bool HCdsSearchIndex::findScheduled(
+    const HCdsScheduleWindow& window, QSet<QString>* ids) const
+{
+    Q_ASSERT(ids);
+
+    // An item that ends within the window starts at most the longest
+    // duration before the lower bound of the end time.
+    qint64 first = window.m_startMin;
+    if (window.m_endMin >
+        std::numeric_limits<qint64>::min() + m_maxScheduledDuration)
+    {
+        first = qMax(first, window.m_endMin - m_maxScheduledDuration);
+    }
+
+    QMultiMap<qint64, ScheduledEntry>::const_iterator it =
+        m_schedule.lowerBound(first);
+    for(; it != m_schedule.constEnd() && it.key() <= window.m_startMax; ++it)
+    {
+        if (it->m_end >= window.m_endMin && it->m_end <= window.m_endMax)
+        {
+            ids->insert(it->m_id);
+        }
+    }
+
+    if (!window.hasStartBounds())
+    {
+        // The items that have no start time match a window that
+        // bounds only the end time.
+        ids->unite(m_endOnly);
+    }
+
+    return true;
+}
+
+bool HCdsSearchIndex::isDerivedFrom(const QString& clazz, const QString& base)
+{
+    return HCdsClassHierarchy::isDerivedFrom(clazz, base);
+}
+
+void HCdsSearchIndex::getValues(
+    const HObject* object, const QString& property, QList<QVariant>* values)
+{
+    Q_ASSERT(object);
+    Q_ASSERT(values);
+
+    // The object ID, the parent ID and the class are always present and
+    // they have dedicated accessors.
+    if (property == QLatin1String("@id"))
+    {
+        values->append(object->id());
+    }
+    else if (property == QLatin1String("@parentID"))
+    {
+        values->append(object->parentId());
+    }
+    else if (property == QLatin1String("upnp:class"))
+    {
+        values->append(object->clazz());
+    }
+    else if (object->isCdsPropertyActive(property))
+    {
+        QVariant value;
+        if (object->getCdsProperty(property, &value))
+        {
+            appendValues(value, values);
+        }
+    }
+}
+
+QStringList HCdsSearchIndex::tokenize(const QString& arg)
+{
+    QStringList retVal;
+
+    QString folded = arg.toCaseFolded();
+    qint32 start = -1;
+    for(qint32 i = 0; i <= folded.size(); ++i)
+    {
+        bool isWordChar = i < folded.size() && folded[i].isLetterOrNumber();
+        if (isWordChar && start < 0)
+        {
+            start = i;
+        }
+        else if (!isWordChar && start >= 0)
+        {
+            retVal.append(folded.mid(start, i - start));
+            start = -1;
+        }
+    }
+
+    return retVal;
+}
+
+}
+}
+}
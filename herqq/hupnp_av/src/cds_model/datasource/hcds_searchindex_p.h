@@ -0,0 +1,198 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HCDS_SEARCHINDEX_P_H_
+#define HCDS_SEARCHINDEX_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include <HUpnpAv/HUpnpAv>
+
+#include <QtCore/QSet>
+#include <QtCore/QHash>
+#include <QtCore/QPair>
+#include <QtCore/QMultiMap>
+#include <QtCore/QString>
+#include <QtCore/QVariant>
+#include <QtCore/QStringList>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+//
+// Bounds on the scheduled start and end times of the EPG items searched for,
+// in milliseconds since the epoch. The bounds are inclusive and a window
+// that is constructed with the default constructor is unbounded.
+//
+struct HCdsScheduleWindow
+{
+    qint64 m_startMin, m_startMax;
+    qint64 m_endMin, m_endMax;
+
+    HCdsScheduleWindow();
+
+    inline bool hasStartBounds() const
+    {
+        return m_startMin != HCdsScheduleWindow().m_startMin ||
+               m_startMax != HCdsScheduleWindow().m_startMax;
+    }
+};
+
+//
+// Secondary indexes of the objects of a data source, which enable a search
+// to compute a set of candidate objects without visiting every object in
+// the data source. The index contains:
+//
+// - the IDs of the objects of each class, which answers both
+//   "upnp:class = x" and "upnp:class derivedfrom x" by visiting the classes
+//   instead of the objects,
+// - exact-match postings of the values of properties such as upnp:artist,
+//   upnp:album and upnp:genre and
+// - the words of properties such as dc:title, which answer "contains" and
+// - the scheduled times of EPG items ordered by the start time, which
+//   answers a window such as "the programs on air between x and y" by
+//   visiting only the programs that start within the window or up to the
+//   longest duration before it.
+//
+// The answers are supersets of the matching objects: a search still
+// evaluates the criteria against each of the candidates.
+//
+class HCdsSearchIndex
+{
+H_DISABLE_COPY(HCdsSearchIndex)
+
+private:
+
+    typedef QHash<QString, QSet<QString> > Postings;
+    // term -> IDs of the objects having the term
+
+    struct IndexedTerms
+    {
+        QString m_clazz;
+        QList<QPair<QString, QString> > m_values;
+        QList<QPair<QString, QString> > m_tokens;
+        // (property, term) pairs the object was indexed with
+
+        bool m_scheduled;
+        qint64 m_scheduledStart;
+        // whether the object is in m_schedule and the key it is found with
+
+        bool m_endOnly;
+        // whether the object is in m_endOnly
+
+        qint64 m_footprint;
+        // the estimated number of bytes the entries of the object use
+
+        IndexedTerms() :
+            m_clazz(), m_values(), m_tokens(), m_scheduled(false),
+            m_scheduledStart(0), m_endOnly(false), m_footprint(0)
+        {
+        }
+    };
+
+    struct ScheduledEntry
+    {
+        qint64 m_end;
+        QString m_id;
+    };
+
+    Postings m_classes;
+    QHash<QString, Postings> m_values;
+    QHash<QString, Postings> m_tokens;
+
+    QMultiMap<qint64, ScheduledEntry> m_schedule;
+    // start time -> end time and the ID of the object. An item without an
+    // end time is stored as if it ended when it starts.
+
+    qint64 m_maxScheduledDuration;
+    // the longest duration of the items in m_schedule. This is not lowered
+    // when items are removed, which only makes a lookup visit more items.
+
+    QSet<QString> m_endOnly;
+    // the IDs of the items that have an end time, but no start time
+
+    QHash<QString, IndexedTerms> m_indexedTerms;
+    // object ID -> terms the object is found with. This is used to remove
+    // the object from the postings when it is modified or removed.
+
+    qint64 m_footprint;
+    // the sum of the footprints of the indexed objects
+
+    static void removePosting(
+        QHash<QString, Postings>*, const QString& property,
+        const QString& term, const QString& id);
+
+public:
+
+    HCdsSearchIndex();
+    ~HCdsSearchIndex();
+
+    // indexes the specified object, replacing the previous entries
+    // of an object with the same ID, if any
+    void add(const HObject*);
+    void remove(const QString& id);
+    void clear();
+
+    bool findClass(const QString& clazz, QSet<QString>* ids) const;
+    bool findDerivedFrom(const QString& clazz, QSet<QString>* ids) const;
+
+    // these return false in case the property is not indexed
+    bool findEqual(
+        const QString& property, const QString& value,
+        QSet<QString>* ids) const;
+
+    bool findContaining(
+        const QString& property, const QString& value,
+        QSet<QString>* ids) const;
+
+    // inserts the IDs of the items that may be scheduled within the specified
+    // window to the specified set
+    bool findScheduled(
+        const HCdsScheduleWindow& window, QSet<QString>* ids) const;
+
+    static bool isDerivedFrom(const QString& clazz, const QString& base);
+
+    // the values of the specified property of the specified object with
+    // multi-valued properties flattened into a list of scalar values
+    static void getValues(
+        const HObject*, const QString& property, QList<QVariant>* values);
+
+    // the case folded words of the specified string
+    static QStringList tokenize(const QString&);
+};
+
+}
+}
+}
+
+#endif /* HCDS_SEARCHINDEX_P_H_ */
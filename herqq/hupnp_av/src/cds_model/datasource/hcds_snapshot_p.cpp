@@ -0,0 +1,111 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hcds_snapshot_p.h"
+
+#include "../cds_objects/hobject.h"
+#include "../cds_objects/hcontainer.h"
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+/*******************************************************************************
+ * HCdsSnapshot
+ ******************************************************************************/
+HCdsSnapshot::HCdsSnapshot() :
+    m_slots(), m_handles(), m_childIds(), m_updateId(0),
+    m_systemUpdateId(0), m_retired(),
+    m_next()
+{
+}
+
+HCdsSnapshot::~HCdsSnapshot()
+{
+    qDeleteAll(m_retired);
+
+    // The successors that no one else refers to are released one after
+    // another, since releasing them recursively could exhaust the stack
+    // after a reader has held an old snapshot for a long time.
+    HCdsSnapshotPtr next = m_next;
+    m_next.reset();
+    while (next && next->ref.fetchAndAddOrdered(0) == 1)
+    {
+        HCdsSnapshotPtr tmp = next->m_next;
+        next->m_next.reset();
+        next = tmp;
+    }
+}
+
+HObject* HCdsSnapshot::object(const QString& id) const
+{
+    qint32 handle = m_handles.value(id, -1);
+    return handle >= 0 && handle < m_slots.size() ? m_slots[handle] : 0;
+}
+
+HContainer* HCdsSnapshot::container(const QString& id) const
+{
+    HObject* obj = object(id);
+    return obj && obj->isContainer() ? static_cast<HContainer*>(obj) : 0;
+}
+
+QStringList HCdsSnapshot::childIds(const QString& containerId) const
+{
+    return m_childIds.value(containerId);
+}
+
+HObjects HCdsSnapshot::children(
+    const QString& containerId, qint32 startingIndex, qint32 count) const
+{
+    QHash<QString, QStringList>::const_iterator ci =
+        m_childIds.constFind(containerId);
+
+    if (ci == m_childIds.constEnd() ||
+        startingIndex < 0 || startingIndex >= ci.value().size())
+    {
+        return HObjects();
+    }
+
+    const QStringList& childIds = ci.value();
+    qint32 end = count < 0 ?
+        childIds.size() : qMin(childIds.size(), startingIndex + count);
+
+    HObjects retVal;
+    retVal.reserve(end - startingIndex);
+    for(qint32 i = startingIndex; i < end; ++i)
+    {
+        HObject* obj = object(childIds[i]);
+        if (obj)
+        {
+            retVal.append(obj);
+        }
+    }
+    return retVal;
+}
+
+}
+}
+}
@@ -0,0 +1,123 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HCDS_SNAPSHOT_P_H_
+#define HCDS_SNAPSHOT_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include <HUpnpAv/HUpnpAv>
+
+#include <QtCore/QHash>
+#include <QtCore/QVector>
+#include <QtCore/QString>
+#include <QtCore/QSharedData>
+#include <QtCore/QStringList>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+class HCdsSnapshot;
+
+typedef QExplicitlySharedDataPointer<HCdsSnapshot> HCdsSnapshotPtr;
+
+//
+// An immutable view of the contents of a data source at the time the view was
+// published. A snapshot can be read from any thread without locking while the
+// data source is modified in its own thread.
+//
+// The object arrays of the data source are implicitly shared with the
+// snapshots, which means that publishing a snapshot is cheap and the data
+// source copies an array only when it modifies the array the next time. The
+// child IDs of the containers are copied only for the containers that changed
+// since the previous snapshot.
+//
+// The objects removed from the data source are handed to the newest snapshot
+// that contains them and they are deleted along with it. Every snapshot keeps
+// the next one alive, which means that a snapshot is destroyed only after
+// every older snapshot has been released.
+//
+class H_UPNP_AV_EXPORT HCdsSnapshot :
+    public QSharedData
+{
+H_DISABLE_COPY(HCdsSnapshot)
+friend class HAbstractCdsDataSourcePrivate;
+
+private:
+
+    QVector<HObject*> m_slots;
+    QHash<QString, qint32> m_handles;
+    // shared with HCdsObjectStore of the data source at the time of publishing
+
+    QHash<QString, QStringList> m_childIds;
+    // key == container id, value == the ordered child ids of the container
+
+    quint32 m_updateId;
+    quint32 m_systemUpdateId;
+
+    QList<HObject*> m_retired;
+    // the objects removed from the data source after this was published
+
+    HCdsSnapshotPtr m_next;
+
+public:
+
+    HCdsSnapshot();
+    ~HCdsSnapshot();
+
+    // the number of modifications the data source had seen when this
+    // was published
+    inline quint32 updateId() const { return m_updateId; }
+
+    // the SystemUpdateID of the content directory serving the data source
+    // after the modifications this contains
+    inline quint32 systemUpdateId() const { return m_systemUpdateId; }
+
+    inline qint32 count() const { return m_handles.size(); }
+
+    HObject* object(const QString& id) const;
+    HContainer* container(const QString& id) const;
+
+    QStringList childIds(const QString& containerId) const;
+
+    // returns at most count children of the container starting from the
+    // specified index. a negative count returns every remaining child
+    HObjects children(
+        const QString& containerId, qint32 startingIndex, qint32 count) const;
+};
+
+}
+}
+}
+
+#endif /* HCDS_SNAPSHOT_P_H_ */
@@ -26,10 +26,21 @@
 #include "../cds_objects/hitem.h"
 #include "../cds_objects/hstoragefolder.h"
 #include "../model_mgmt/hcdsobjectdata_p.h"
+#include "../cds_objects/hobject_p.h"
+#include "../model_mgmt/hcds_fsys_index_p.h"
 #include "../model_mgmt/hcds_fsys_reader_p.h"
+#include "../model_mgmt/hcds_fsys_watcher_p.h"
+#include "../model_mgmt/hcds_dlite_serializer.h"
+#include "../model_mgmt/hcds_metadata_pipeline_p.h"
 
+#include <HUpnpCore/HTaskScheduler>
 #include <HUpnpCore/private/hlogger_p.h>
 
+#include <QtCore/QDir>
+#include <QtCore/QPair>
+#include <QtCore/QFileInfo>
+#include <QtCore/QStringList>
+
 namespace Herqq
 {
 
@@ -39,24 +50,41 @@ namespace Upnp
 namespace Av
 {
 
+namespace
+{
+// The time file system notifications are collected before the affected
+// directories are re-read.
+const qint32 WatchCoalescingMsecs = 500;
+
+// The number of scanned objects added in a single step of the task that
+// adds them in the task scheduler. Adding an object takes a few microseconds.
+const qint32 AddsPerStep = 64;
+}
+
 /*******************************************************************************
  * HFileSystemDataSourcePrivate
  *******************************************************************************/
 HFileSystemDataSourcePrivate::HFileSystemDataSourcePrivate() :
     HAbstractCdsDataSourcePrivate(),
-        m_itemPaths(), m_fsysReader()
+        m_itemPaths(), m_fsysReader(), m_fsysScanner(), m_fsysWatcher(),
+        m_watchedDirs(), m_metadataPipeline(), m_restoringIndex(false),
+        m_dirTimestamps(), m_taskScheduler(), m_pendingAdds(), m_addTaskId(0)
 {
     m_configuration.reset(new HFileSystemDataSourceConfiguration());
 }
 
 HFileSystemDataSourcePrivate::HFileSystemDataSourcePrivate(
     const HFileSystemDataSourceConfiguration& conf) :
-        HAbstractCdsDataSourcePrivate(conf), m_itemPaths(), m_fsysReader()
+        HAbstractCdsDataSourcePrivate(conf), m_itemPaths(), m_fsysReader(),
+        m_fsysScanner(), m_fsysWatcher(), m_watchedDirs(), m_metadataPipeline(),
+        m_restoringIndex(false), m_dirTimestamps(), m_taskScheduler(),
+        m_pendingAdds(), m_addTaskId(0)
 {
 }
 
 HFileSystemDataSourcePrivate::~HFileSystemDataSourcePrivate()
 {
+    clearPending();
 }
 
 bool HFileSystemDataSourcePrivate::add(
@@ -68,6 +96,19 @@ bool HFileSystemDataSourcePrivate::add(
     if (add(obj, addFlag))
     {
         m_itemPaths.insert(obj->id(), item->dataPath());
+        if (obj->isContainer() && !item->dataPath().isEmpty())
+        {
+            m_dirTimestamps.insert(
+                item->dataPath(), QFileInfo(item->dataPath()).lastModified());
+        }
+        watch(item);
+        if (m_metadataPipeline && !m_restoringIndex && obj->isItem() &&
+            !item->dataPath().isEmpty())
+        {
+            m_metadataPipeline->enqueue(
+                obj->id(), item->dataPath(),
+                HCdsFileSystemReader::deduceMimeType(item->dataPath()));
+        }
         item->takeObject();
         return true;
     }
@@ -78,16 +119,496 @@ bool HFileSystemDataSourcePrivate::add(
 bool HFileSystemDataSourcePrivate::add(
     const QList<HCdsObjectData*> items, HFileSystemDataSource::AddFlag addFlag)
 {
+    m_objectsById.reserve(m_objectsById.size() + items.size());
+
+    bool retVal = true;
+    beginBulkUpdate();
     foreach(HCdsObjectData* item, items)
     {
         if (!add(item, addFlag))
         {
-            return false;
+            retVal = false;
+            break;
+        }
+    }
+    endBulkUpdate();
+    return retVal;
+}
+
+void HFileSystemDataSourcePrivate::addScanned(
+    const QList<HCdsObjectData*>& items)
+{
+    HLOG(H_AT, H_FUN);
+
+    // The batches arrive in no particular order, but a child that is added
+    // before its parent folder is linked to the folder once it arrives.
+    if (m_taskScheduler)
+    {
+        // The scanner deletes the batch once this returns.
+        QList<HCdsObjectData*> copies;
+        foreach(HCdsObjectData* item, items)
+        {
+            copies.append(
+                new HCdsObjectData(item->takeObject(), item->dataPath()));
+        }
+        addLater(copies, HFileSystemDataSource::AddNewOnly);
+        return;
+    }
+
+    beginBulkUpdate();
+    foreach(HCdsObjectData* item, items)
+    {
+        if (!add(item))
+        {
+            HLOG_WARN(QString("Could not add scanned object [%1]").arg(
+                item->dataPath()));
+        }
+    }
+    endBulkUpdate();
+}
+
+void HFileSystemDataSourcePrivate::addLater(
+    const QList<HCdsObjectData*>& items,
+    HFileSystemDataSource::AddFlag addFlag)
+{
+    foreach(HCdsObjectData* item, items)
+    {
+        m_pendingAdds.append(qMakePair(item, addFlag));
+    }
+
+    if (!m_taskScheduler)
+    {
+        while (!m_pendingAdds.isEmpty())
+        {
+            addPending();
+        }
+    }
+    else if (!m_addTaskId && !m_pendingAdds.isEmpty())
+    {
+        m_addTaskId = m_taskScheduler->schedule(
+            HTaskStep(this, &HFileSystemDataSourcePrivate::addPending),
+            HTaskScheduler::LowPriority);
+    }
+}
+
+bool HFileSystemDataSourcePrivate::addPending()
+{
+    HLOG(H_AT, H_FUN);
+
+    beginBulkUpdate();
+    for (qint32 i = 0; i < AddsPerStep && !m_pendingAdds.isEmpty(); ++i)
+    {
+        QPair<HCdsObjectData*, HFileSystemDataSource::AddFlag> pending =
+            m_pendingAdds.takeFirst();
+
+        if (!add(pending.first, pending.second))
+        {
+            HLOG_WARN(QString("Could not add scanned object [%1]").arg(
+                pending.first->dataPath()));
+        }
+        delete pending.first;
+    }
+    endBulkUpdate();
+
+    if (m_pendingAdds.isEmpty())
+    {
+        m_addTaskId = 0;
+        return false;
+    }
+    return true;
+}
+
+void HFileSystemDataSourcePrivate::clearPending()
+{
+    if (m_addTaskId && m_taskScheduler)
+    {
+        m_taskScheduler->cancel(m_addTaskId);
+    }
+    m_addTaskId = 0;
+
+    for (qint32 i = 0; i < m_pendingAdds.size(); ++i)
+    {
+        delete m_pendingAdds[i].first;
+    }
+    m_pendingAdds.clear();
+}
+
+bool HFileSystemDataSourcePrivate::findRootDir(
+    const QString& path, HRootDir* rootDir) const
+{
+    foreach(const HRootDir& rd, configuration()->rootDirs())
+    {
+        QString rootPath = rd.dir().absolutePath();
+        if (path == rootPath || (rd.scanMode() == HRootDir::RecursiveScan &&
+            path.startsWith(rootPath + '/')))
+        {
+            *rootDir = rd;
+            return true;
+        }
+    }
+    return false;
+}
+
+void HFileSystemDataSourcePrivate::watch(HCdsObjectData* item)
+{
+    HObject* obj = item->object();
+    if (!obj->isContainer() || item->dataPath().isEmpty())
+    {
+        return;
+    }
+
+    HRootDir rootDir;
+    if (!findRootDir(item->dataPath(), &rootDir) ||
+        rootDir.watchMode() != HRootDir::WatchForChanges)
+    {
+        return;
+    }
+
+    if (!m_fsysWatcher)
+    {
+        m_fsysWatcher.reset(new HCdsFileSystemWatcher(
+            HDirectoriesChangedCallback(
+                this, &HFileSystemDataSourcePrivate::directoriesChanged),
+            WatchCoalescingMsecs));
+    }
+
+    if (m_fsysWatcher->addDir(item->dataPath()))
+    {
+        m_watchedDirs.insert(item->dataPath(), obj->id());
+    }
+}
+
+void HFileSystemDataSourcePrivate::directoriesChanged(const QStringList& paths)
+{
+    HLOG(H_AT, H_FUN);
+
+    // A parent directory is updated before its subdirectories, which means
+    // that a subdirectory removed along with its parent is not re-read.
+    QStringList sortedPaths = paths;
+    qSort(sortedPaths);
+
+    foreach(const QString& path, sortedPaths)
+    {
+        QString containerId = m_watchedDirs.value(path);
+        if (!containerId.isEmpty())
+        {
+            update(path, containerId);
+        }
+    }
+}
+
+void HFileSystemDataSourcePrivate::update(
+    const QString& path, const QString& containerId)
+{
+    HLOG(H_AT, H_FUN);
+
+    HObject* obj = m_objectsById.value(containerId);
+    if (!obj || !obj->isContainer())
+    {
+        return;
+    }
+
+    QDir dir(path);
+    HRootDir rootDir;
+    if (!dir.exists() || !findRootDir(path, &rootDir))
+    {
+        removeTree(containerId);
+        return;
+    }
+
+    HLOG_DBG(QString("Updating directory %1").arg(path));
+
+    // The time stamp is taken before the directory is read, so that a change
+    // made while the directory is read is detected the next time.
+    m_dirTimestamps.insert(path, QFileInfo(path).lastModified());
+
+    QHash<QString, QString> childIdsByPath;
+    foreach(const QString& childId, obj->asContainer()->orderedChildIds())
+    {
+        QString childPath = m_itemPaths.value(childId);
+        if (!childPath.isEmpty())
+        {
+            childIdsByPath.insert(childPath, childId);
+        }
+    }
+
+    QFileInfoList infoList =
+        dir.entryInfoList(QDir::Files | QDir::AllDirs | QDir::NoDotAndDotDot);
+
+    foreach(const QFileInfo& finfo, infoList)
+    {
+        QString entryPath = finfo.absoluteFilePath();
+        if (childIdsByPath.remove(entryPath))
+        {
+            continue;
+        }
+
+        QList<HCdsObjectData*> items;
+        if (finfo.isDir())
+        {
+            if (rootDir.scanMode() != HRootDir::RecursiveScan)
+            {
+                continue;
+            }
+
+            HRootDir subdir(QDir(entryPath), HRootDir::RecursiveScan);
+            m_fsysReader->scan(subdir, containerId, &items);
+        }
+        else
+        {
+            HCdsObjectData* item =
+                HCdsFileSystemReader::index(finfo, containerId);
+
+            if (item)
+            {
+                items.append(item);
+            }
+        }
+
+        // Adding an object to its parent container emits the containerModified
+        // signal for the added child only.
+        foreach(HCdsObjectData* item, items)
+        {
+            add(item);
+        }
+        qDeleteAll(items);
+    }
+
+    foreach(const QString& childId, childIdsByPath)
+    {
+        removeTree(childId);
+    }
+}
+
+void HFileSystemDataSourcePrivate::removeTree(const QString& id)
+{
+    QStringList removedIds;
+    if (!removeSubtree(id, &removedIds))
+    {
+        return;
+    }
+
+    if (m_metadataPipeline)
+    {
+        m_metadataPipeline->remove(removedIds);
+    }
+
+    foreach(const QString& removedId, removedIds)
+    {
+        QString path = m_itemPaths.take(removedId);
+        m_dirTimestamps.remove(path);
+        if (m_watchedDirs.remove(path) && m_fsysWatcher)
+        {
+            m_fsysWatcher->removeDir(path);
+        }
+    }
+}
+
+QSet<QString> HFileSystemDataSourcePrivate::loadIndex()
+{
+    HLOG(H_AT, H_FUN);
+
+    QSet<QString> retVal;
+
+    QString filePath = configuration()->indexFilePath();
+    if (filePath.isEmpty() || !QFile::exists(filePath))
+    {
+        return retVal;
+    }
+
+    HCdsFileSystemIndex index(filePath);
+    QList<HCdsIndexedRootDir> indexedRootDirs;
+    QList<HCdsIndexedDirectory> indexedDirs;
+    if (!index.read(&indexedRootDirs, &indexedDirs))
+    {
+        HLOG_WARN(QString("Ignoring index [%1]: %2").arg(
+            filePath, index.lastErrorDescription()));
+        return retVal;
+    }
+
+    // A root directory is restored only if it was scanned the same way
+    // when the index was written. Otherwise the index may lack directories
+    // that should be there.
+    QHash<QString, qint32> scanModes;
+    foreach(const HCdsIndexedRootDir& indexedRootDir, indexedRootDirs)
+    {
+        scanModes.insert(indexedRootDir.m_path, indexedRootDir.m_scanMode);
+    }
+
+    foreach(const HRootDir& rootDir, configuration()->rootDirs())
+    {
+        QString rootPath = rootDir.dir().absolutePath();
+        if (scanModes.contains(rootPath) &&
+            scanModes.value(rootPath) == rootDir.scanMode())
+        {
+            retVal.insert(rootPath);
+        }
+    }
+
+    HCdsDidlLiteSerializer serializer;
+    QList<QPair<QString, QString> > modifiedDirs;
+    beginBulkUpdate();
+    foreach(const HCdsIndexedDirectory& indexedDir, indexedDirs)
+    {
+        HRootDir rootDir;
+        if (!findRootDir(indexedDir.m_path, &rootDir) ||
+            !retVal.contains(rootDir.dir().absolutePath()))
+        {
+            continue;
+        }
+
+        HObjects objects;
+        if (!serializer.serializeFromXml(
+            QString::fromUtf8(indexedDir.m_didlLite), &objects))
+        {
+            HLOG_WARN(QString("Could not restore directory [%1]").arg(
+                indexedDir.m_path));
+            continue;
+        }
+
+        m_restoringIndex = true;
+        foreach(HObject* object, objects)
+        {
+            HObjectPrivate::reserveId(object->id());
+
+            HCdsObjectData data(
+                object, indexedDir.m_dataPaths.value(object->id()));
+
+            add(&data);
+        }
+        m_restoringIndex = false;
+
+        if (QFileInfo(indexedDir.m_path).lastModified() !=
+            indexedDir.m_lastModified)
+        {
+            modifiedDirs.append(
+                qMakePair(indexedDir.m_path, indexedDir.m_containerId));
         }
     }
+    endBulkUpdate();
+
+    // The entries of a directory have changed only if the modification time
+    // of the directory has changed, which is why only those directories are
+    // read again. A removed directory is removed from the data source.
+    for(qint32 i = 0; i < modifiedDirs.size(); ++i)
+    {
+        update(modifiedDirs[i].first, modifiedDirs[i].second);
+    }
+
+    return retVal;
+}
+
+bool HFileSystemDataSourcePrivate::saveIndex()
+{
+    HLOG(H_AT, H_FUN);
+
+    QString filePath = configuration()->indexFilePath();
+    if (filePath.isEmpty())
+    {
+        return true;
+    }
+
+    QList<HCdsIndexedRootDir> indexedRootDirs;
+    foreach(const HRootDir& rootDir, configuration()->rootDirs())
+    {
+        HCdsIndexedRootDir indexedRootDir;
+        indexedRootDir.m_path = rootDir.dir().absolutePath();
+        indexedRootDir.m_scanMode = rootDir.scanMode();
+        indexedRootDirs.append(indexedRootDir);
+    }
+
+    QHash<QString, HObject*> containersByPath;
+    QHash<QString, QString>::const_iterator ci = m_itemPaths.constBegin();
+    for(; ci != m_itemPaths.constEnd(); ++ci)
+    {
+        HObject* object = m_objectsById.value(ci.key());
+        if (object && object->isContainer())
+        {
+            containersByPath.insert(ci.value(), object);
+        }
+    }
+
+    HCdsDidlLiteSerializer serializer;
+    QList<HCdsIndexedDirectory> indexedDirs;
+    QHash<QString, QDateTime>::const_iterator it = m_dirTimestamps.constBegin();
+    for(; it != m_dirTimestamps.constEnd(); ++it)
+    {
+        HObject* container = containersByPath.value(it.key());
+        HRootDir rootDir;
+        if (!container || !findRootDir(it.key(), &rootDir))
+        {
+            continue;
+        }
+
+        HCdsIndexedDirectory indexedDir;
+        indexedDir.m_path = it.key();
+        indexedDir.m_lastModified = it.value();
+        indexedDir.m_containerId = container->id();
+
+        // The subdirectories are stored as directories of their own.
+        HObjects objects;
+        objects.append(container);
+        QStringList childIds = container->asContainer()->orderedChildIds();
+        foreach(const QString& childId, childIds)
+        {
+            HObject* child = m_objectsById.value(childId);
+            QString childPath = m_itemPaths.value(childId);
+            if (child && child->isItem() && !childPath.isEmpty())
+            {
+                objects.append(child);
+            }
+        }
+
+        foreach(HObject* object, objects)
+        {
+            indexedDir.m_dataPaths.insert(
+                object->id(), m_itemPaths.value(object->id()));
+        }
+
+        indexedDir.m_didlLite = serializer.serializeToXml(objects).toUtf8();
+        indexedDirs.append(indexedDir);
+    }
+
+    HCdsFileSystemIndex index(filePath);
+    if (!index.write(indexedRootDirs, indexedDirs))
+    {
+        HLOG_WARN(index.lastErrorDescription());
+        return false;
+    }
+
     return true;
 }
 
+void HFileSystemDataSourcePrivate::applyMetadata(
+    const QList<HCdsMetadataResult>& results)
+{
+    HLOG(H_AT, H_FUN);
+
+    beginBulkUpdate();
+    foreach(const HCdsMetadataResult& result, results)
+    {
+        HObject* obj = m_objectsById.value(result.m_objectId);
+        if (!obj)
+        {
+            // The object was removed while its metadata was being read.
+            continue;
+        }
+
+        QHash<QString, QVariant>::const_iterator it =
+            result.m_properties.constBegin();
+
+        for(; it != result.m_properties.constEnd(); ++it)
+        {
+            if (!obj->setCdsProperty(it.key(), it.value()))
+            {
+                HLOG_DBG(QString("Could not set property [%1] of [%2]").arg(
+                    it.key(), result.m_objectId));
+            }
+        }
+    }
+    endBulkUpdate();
+}
+
 /*******************************************************************************
  * HFileSystemDataSource
  *******************************************************************************/
@@ -110,6 +631,15 @@ HFileSystemDataSource::HFileSystemDataSource(
 
 HFileSystemDataSource::~HFileSystemDataSource()
 {
+    H_D(HFileSystemDataSource);
+
+    // A partially scanned tree is not stored, since the directories that were
+    // not yet scanned would be considered empty when the index is read.
+    if (isInitialized() && h->m_pendingAdds.isEmpty() &&
+        (!h->m_fsysScanner || !h->m_fsysScanner->isScanning()))
+    {
+        h->saveIndex();
+    }
 }
 
 bool HFileSystemDataSource::doInit()
@@ -123,13 +653,51 @@ bool HFileSystemDataSource::doInit()
     h->m_fsysReader.reset(new HCdsFileSystemReader());
 
     const HFileSystemDataSourceConfiguration* conf = configuration();
-    HRootDirs rootDirs = conf->rootDirs();
+    if (!conf->metadataExtractors().isEmpty())
+    {
+        h->m_metadataPipeline.reset(new HCdsMetadataPipeline(
+            conf->metadataExtractors(),
+            HCdsMetadataCallback(
+                h, &HFileSystemDataSourcePrivate::applyMetadata),
+            conf->metadataThreadCount()));
+    }
+
+    QSet<QString> restoredRootDirs = h->loadIndex();
+
+    HRootDirs rootDirs;
+    foreach(const HRootDir& rootDir, conf->rootDirs())
+    {
+        if (!restoredRootDirs.contains(rootDir.dir().absolutePath()))
+        {
+            rootDirs.append(rootDir);
+        }
+    }
+
+    if (conf->scanThreadCount() > 0)
+    {
+        h->m_fsysScanner.reset(new HCdsFileSystemScanner(
+            HCdsObjectBatchCallback(
+                h, &HFileSystemDataSourcePrivate::addScanned),
+            conf->scanThreadCount()));
+
+        foreach(const HRootDir& rootDir, rootDirs)
+        {
+            h->m_fsysScanner->scan(rootDir, "0");
+        }
+        return true;
+    }
+
     foreach(const HRootDir& rootDir, rootDirs)
     {
         QList<HCdsObjectData*> items;
         if (h->m_fsysReader->scan(rootDir, "0", &items))
         {
-            if (!h->add(items))
+            if (h->m_taskScheduler)
+            {
+                h->addLater(items, AddNewOnly);
+                continue;
+            }
+            else if (!h->add(items))
             {
                 qDeleteAll(items);
                 return false;
@@ -138,6 +706,14 @@ bool HFileSystemDataSource::doInit()
         qDeleteAll(items);
     }
 
+    // The index is saved when the data source is deleted in case the objects
+    // are still being added.
+    if (h->m_pendingAdds.isEmpty() &&
+        (!rootDirs.isEmpty() || !restoredRootDirs.isEmpty()))
+    {
+        h->saveIndex();
+    }
+
     return true;
 }
 
@@ -191,6 +767,49 @@ QIODevice* HFileSystemDataSource::loadItemData(const QString& itemId)
     return file;
 }
 
+bool HFileSystemDataSource::supportsStoring() const
+{
+    return true;
+}
+
+QIODevice* HFileSystemDataSource::storeItemData(
+    const QString& itemId, qint64 offset)
+{
+    if (!isInitialized())
+    {
+        return 0;
+    }
+
+    HLOG(H_AT, H_FUN);
+    HLOG_INFO(QString("Attempting to store item [%1]").arg(itemId));
+
+    QString path = getPath(itemId);
+    if (path.isEmpty())
+    {
+        QString err =
+            QString("The specified objectId [%1] does not correspond to any "
+            "item that can be stored").arg(itemId);
+
+        HLOG_WARN(err);
+        return 0;
+    }
+
+    QFile* file = new QFile(path);
+    QIODevice::OpenMode mode =
+        offset > 0 ? QIODevice::ReadWrite : QIODevice::WriteOnly;
+
+    if (!file->open(mode) ||
+        (offset > 0 && (!file->resize(offset) || !file->seek(offset))))
+    {
+        QString err = QString("Could not open file [%1] for writing").arg(path);
+        HLOG_WARN(err);
+        delete file;
+        return 0;
+    }
+
+    return file;
+}
+
 void HFileSystemDataSource::clear()
 {
     if (!isInitialized())
@@ -199,6 +818,14 @@ void HFileSystemDataSource::clear()
     }
 
     H_D(HFileSystemDataSource);
+    h->m_fsysScanner.reset();
+    h->clearPending();
+    h->m_fsysWatcher.reset();
+    h->m_watchedDirs.clear();
+    if (h->m_metadataPipeline)
+    {
+        h->m_metadataPipeline->clear();
+    }
     HAbstractCdsDataSource::clear();
 
     h->configuration()->clear();
@@ -291,7 +918,12 @@ qint32 HFileSystemDataSource::add(const HRootDir& rootDir, AddFlag addFlag)
     QList<HCdsObjectData*> items;
     if (h->m_fsysReader->scan(rootDir, "0", &items))
     {
-        if (!h->add(items, addFlag))
+        if (h->m_taskScheduler)
+        {
+            h->addLater(items, addFlag);
+            return items.size();
+        }
+        else if (!h->add(items, addFlag))
         {
             qDeleteAll(items);
             h->configuration()->removeRootDir(rootDir);
@@ -303,6 +935,48 @@ qint32 HFileSystemDataSource::add(const HRootDir& rootDir, AddFlag addFlag)
     return items.size();
 }
 
+void HFileSystemDataSource::objectsRequested(const QStringList& objectIds)
+{
+    H_D(HFileSystemDataSource);
+    if (h->m_metadataPipeline)
+    {
+        h->m_metadataPipeline->prioritize(objectIds);
+    }
+}
+
+void HFileSystemDataSource::setTaskScheduler(HTaskScheduler* scheduler)
+{
+    H_D(HFileSystemDataSource);
+    if (scheduler == h->m_taskScheduler)
+    {
+        return;
+    }
+
+    if (scheduler && scheduler->thread() != thread())
+    {
+        HLOG(H_AT, H_FUN);
+        HLOG_WARN("Ignoring a task scheduler of another thread");
+        return;
+    }
+
+    if (h->m_addTaskId && h->m_taskScheduler)
+    {
+        h->m_taskScheduler->cancel(h->m_addTaskId);
+    }
+    h->m_addTaskId = 0;
+
+    // The objects that are still waiting are added by the new scheduler,
+    // or at once in case the scheduler is removed.
+    h->m_taskScheduler = scheduler;
+    h->addLater(QList<HCdsObjectData*>(), AddNewOnly);
+}
+
+HTaskScheduler* HFileSystemDataSource::taskScheduler() const
+{
+    const H_D(HFileSystemDataSource);
+    return h->m_taskScheduler;
+}
+
 QString HFileSystemDataSource::getPath(const QString& objectId) const
 {
     const H_D(HFileSystemDataSource);
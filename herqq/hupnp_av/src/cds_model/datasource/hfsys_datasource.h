@@ -101,6 +101,15 @@ public:
     // Documented in HAbstractCdsDataSource
     virtual QIODevice* loadItemData(const QString& itemId);
 
+    // Documented in HAbstractCdsDataSource
+    virtual bool supportsStoring() const;
+
+    // Documented in HAbstractCdsDataSource
+    virtual QIODevice* storeItemData(const QString& itemId, qint64 offset);
+
+    // Documented in HAbstractCdsDataSource
+    virtual void objectsRequested(const QStringList& objectIds);
+
     // Documented in HAbstractCdsDataSource
     virtual void clear();
 
@@ -165,9 +174,51 @@ public:
      * \param addFlag specifies the addition mode.
      *
      * \return the number CDS objects that were found, created and added.
+     * In case a task scheduler is set, this is the number of objects that
+     * were found and that are added by the scheduler.
+     *
+     * \sa setTaskScheduler()
      */
     qint32 add(const HRootDir& rootDir, AddFlag addFlag=AddNewOnly);
 
+    /*!
+     * \brief Specifies the scheduler that adds the scanned objects to the
+     * data source.
+     *
+     * By default the objects found when a root directory is scanned are
+     * added in a single call, which keeps the thread of the data source busy
+     * until every object is added. When a scheduler is set, the objects are
+     * added as a low priority task of the scheduler a few at a time, which
+     * lets a device host in the same thread answer the network requests
+     * while a large directory tree is being added. This applies to the
+     * root directories added during init() and with add(const HRootDir&),
+     * and to the objects found by the background scan threads.
+     *
+     * \param scheduler specifies the scheduler, such as the one returned from
+     * Herqq::Upnp::HDeviceHost::taskScheduler(). The scheduler has to live in
+     * the thread of the data source. A null pointer removes the scheduler,
+     * in which case the objects that are still waiting are added at once.
+     *
+     * \remarks
+     * \li The ownership of the scheduler is not transferred.
+     * \li The objects that are waiting to be added are not yet visible
+     * to browse and search.
+     *
+     * \sa taskScheduler()
+     */
+    void setTaskScheduler(HTaskScheduler* scheduler);
+
+    /*!
+     * \brief Returns the scheduler that adds the scanned objects to the
+     * data source.
+     *
+     * \return The scheduler that adds the scanned objects to the data source,
+     * or null in case none is set.
+     *
+     * \sa setTaskScheduler()
+     */
+    HTaskScheduler* taskScheduler() const;
+
     /*!
      * \brief Returns the absolute path to the file in the local file system corresponding
      * the specified CDS object ID.
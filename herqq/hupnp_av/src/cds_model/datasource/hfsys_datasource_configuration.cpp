@@ -35,7 +35,8 @@ namespace Av
  * HFileSystemDataSourceConfigurationPrivate
  *******************************************************************************/
 HFileSystemDataSourceConfigurationPrivate::HFileSystemDataSourceConfigurationPrivate() :
-    m_rootDirs()
+    m_rootDirs(), m_scanThreadCount(0), m_indexFilePath(),
+    m_metadataExtractors(), m_metadataThreadCount(1)
 {
 }
 
@@ -79,6 +80,12 @@ void HFileSystemDataSourceConfiguration::doClone(HClonable* target) const
             conf->h_ptr);
 
     confPriv->m_rootDirs = h->m_rootDirs;
+    confPriv->m_scanThreadCount = h->m_scanThreadCount;
+    confPriv->m_indexFilePath = h->m_indexFilePath;
+    confPriv->m_metadataExtractors = h->m_metadataExtractors;
+    confPriv->m_metadataThreadCount = h->m_metadataThreadCount;
+
+    HCdsDataSourceConfiguration::doClone(target);
 }
 
 HFileSystemDataSourceConfiguration* HFileSystemDataSourceConfiguration::newInstance() const
@@ -163,6 +170,57 @@ void HFileSystemDataSourceConfiguration::clear()
     h->m_rootDirs.clear();
 }
 
+qint32 HFileSystemDataSourceConfiguration::scanThreadCount() const
+{
+    const H_D(HFileSystemDataSourceConfiguration);
+    return h->m_scanThreadCount;
+}
+
+void HFileSystemDataSourceConfiguration::setScanThreadCount(qint32 count)
+{
+    H_D(HFileSystemDataSourceConfiguration);
+    h->m_scanThreadCount = qMax(count, 0);
+}
+
+QString HFileSystemDataSourceConfiguration::indexFilePath() const
+{
+    const H_D(HFileSystemDataSourceConfiguration);
+    return h->m_indexFilePath;
+}
+
+void HFileSystemDataSourceConfiguration::setIndexFilePath(const QString& path)
+{
+    H_D(HFileSystemDataSourceConfiguration);
+    h->m_indexFilePath = path;
+}
+
+QList<HCdsMetadataExtractor*>
+    HFileSystemDataSourceConfiguration::metadataExtractors() const
+{
+    const H_D(HFileSystemDataSourceConfiguration);
+    return h->m_metadataExtractors;
+}
+
+void HFileSystemDataSourceConfiguration::setMetadataExtractors(
+    const QList<HCdsMetadataExtractor*>& extractors)
+{
+    H_D(HFileSystemDataSourceConfiguration);
+    h->m_metadataExtractors = extractors;
+    h->m_metadataExtractors.removeAll(0);
+}
+
+qint32 HFileSystemDataSourceConfiguration::metadataThreadCount() const
+{
+    const H_D(HFileSystemDataSourceConfiguration);
+    return h->m_metadataThreadCount;
+}
+
+void HFileSystemDataSourceConfiguration::setMetadataThreadCount(qint32 count)
+{
+    H_D(HFileSystemDataSourceConfiguration);
+    h->m_metadataThreadCount = qMax(count, 1);
+}
+
 }
 }
 }
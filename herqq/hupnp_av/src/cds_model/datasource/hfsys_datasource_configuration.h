@@ -135,6 +135,121 @@ public:
      * Clears the state of the object, such as removes all root directories.
      */
     void clear();
+
+    /*!
+     * \brief Returns the number of threads used for scanning the root
+     * directories when the data source is initialized.
+     *
+     * \return The number of threads used for scanning the root
+     * directories when the data source is initialized. Zero means that the
+     * root directories are scanned in the thread that initializes the
+     * data source.
+     *
+     * \sa setScanThreadCount()
+     */
+    qint32 scanThreadCount() const;
+
+    /*!
+     * \brief Specifies the number of threads used for scanning the root
+     * directories when the data source is initialized.
+     *
+     * When this is greater than zero, the initialization of the data source
+     * returns once the scanning has been started. The directories are then
+     * scanned concurrently in the background and the found objects are
+     * added to the data source in batches, which means that the containers
+     * of the data source are populated progressively. By default the
+     * root directories are scanned before the initialization returns.
+     *
+     * \param count specifies the number of threads used for scanning the
+     * root directories. Zero or a negative value means that the root
+     * directories are scanned in the thread that initializes the data source.
+     *
+     * \sa scanThreadCount()
+     */
+    void setScanThreadCount(qint32 count);
+
+    /*!
+     * \brief Returns the path of the file the data source uses to persist
+     * its object tree.
+     *
+     * \return The path of the file the data source uses to persist
+     * its object tree. By default the path is empty and no index is used.
+     *
+     * \sa setIndexFilePath()
+     */
+    QString indexFilePath() const;
+
+    /*!
+     * \brief Specifies the path of the file the data source uses to persist
+     * its object tree.
+     *
+     * When the path is set, the data source stores the objects it has found
+     * in the root directories into the specified file once the directories
+     * have been scanned and when the data source is destroyed. When
+     * the data source is initialized again, the objects are restored from the
+     * file and only the directories that have been modified since the index
+     * was written are scanned.
+     *
+     * The objects retain their IDs across restarts, which means that
+     * control points do not have to discard the information they have cached.
+     *
+     * \param path specifies the path of the index file. An empty path
+     * disables the index.
+     *
+     * \sa indexFilePath()
+     */
+    void setIndexFilePath(const QString& path);
+
+    /*!
+     * \brief Returns the metadata extractors the data source uses to enrich
+     * the items it finds.
+     *
+     * \return The metadata extractors the data source uses to enrich
+     * the items it finds.
+     *
+     * \sa setMetadataExtractors()
+     */
+    QList<HCdsMetadataExtractor*> metadataExtractors() const;
+
+    /*!
+     * \brief Specifies the metadata extractors the data source uses to enrich
+     * the items it finds.
+     *
+     * The items are published as soon as they are found and their metadata
+     * is read in the background afterwards. The items that are browsed by
+     * control points are handled before the others. The properties read
+     * from the files are set to the items in batches, which means that
+     * the objectModified() signals of several items are emitted together.
+     *
+     * \param extractors specifies the metadata extractors. For each
+     * file the extractors are run in the specified order and a property
+     * returned by an extractor is not overwritten by the ones after it.
+     * The ownership of the extractors is \b not transferred and the
+     * extractors have to exist as long as the data source uses them.
+     *
+     * \sa metadataExtractors(), setMetadataThreadCount()
+     */
+    void setMetadataExtractors(const QList<HCdsMetadataExtractor*>& extractors);
+
+    /*!
+     * \brief Returns the number of threads used for reading metadata.
+     *
+     * \return The number of threads used for reading metadata.
+     *
+     * \sa setMetadataThreadCount()
+     */
+    qint32 metadataThreadCount() const;
+
+    /*!
+     * \brief Specifies the number of threads used for reading metadata.
+     *
+     * \param count specifies the number of threads used for reading metadata.
+     * The default is one, which keeps the extraction from competing with
+     * the scanning of the directories for disk access.
+     *
+     * \sa metadataThreadCount(), setMetadataExtractors()
+     */
+    void setMetadataThreadCount(qint32 count);
 };
 
 }
@@ -34,6 +34,7 @@
 #include "hcds_datasource_configuration_p.h"
 
 #include <QtCore/QList>
+#include <QtCore/QString>
 
 namespace Herqq
 {
@@ -55,6 +56,10 @@ H_DISABLE_COPY(HFileSystemDataSourceConfigurationPrivate)
 public: // attributes
 
     QList<HRootDir> m_rootDirs;
+    qint32 m_scanThreadCount;
+    QString m_indexFilePath;
+    QList<HCdsMetadataExtractor*> m_metadataExtractors;
+    qint32 m_metadataThreadCount;
 
 public: // methods
 
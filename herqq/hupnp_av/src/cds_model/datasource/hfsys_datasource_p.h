@@ -32,8 +32,16 @@
 
 #include "habstract_cds_datasource_p.h"
 
+#include <HUpnpCore/HTaskScheduler>
+
+#include <QtCore/QSet>
+#include <QtCore/QPair>
+#include <QtCore/QPointer>
+#include <QtCore/QDateTime>
 #include <QtCore/QScopedPointer>
 
+class QStringList;
+
 namespace Herqq
 {
 
@@ -59,6 +67,36 @@ public: // attributes
 
     QScopedPointer<HCdsFileSystemReader> m_fsysReader;
 
+    QScopedPointer<HCdsFileSystemScanner> m_fsysScanner;
+    // used only when the root directories are scanned in the background
+
+    QScopedPointer<HCdsFileSystemWatcher> m_fsysWatcher;
+    // created once the first directory to be watched is added
+
+    QHash<QString, QString> m_watchedDirs;
+    // key == file system path, value == container id
+
+    QScopedPointer<HCdsMetadataPipeline> m_metadataPipeline;
+    // used only when metadata extractors are configured
+
+    bool m_restoringIndex;
+    // the restored items have their metadata already
+
+    QHash<QString, QDateTime> m_dirTimestamps;
+    // key == file system path of a container, value == the modification time
+    // of the directory when it was last read
+
+    QPointer<HTaskScheduler> m_taskScheduler;
+    // runs the additions of m_pendingAdds in slices, if set
+
+    QList<QPair<HCdsObjectData*, HFileSystemDataSource::AddFlag> >
+        m_pendingAdds;
+    // the scanned objects waiting to be added by the task scheduler,
+    // in the order they were scanned. the objects are owned
+
+    qint32 m_addTaskId;
+    // the task that adds m_pendingAdds, or zero if none is scheduled
+
 public: // methods
 
     using HAbstractCdsDataSourcePrivate::add;
@@ -76,6 +114,30 @@ public: // methods
         const QList<HCdsObjectData*> items,
         HFileSystemDataSource::AddFlag addFlag=HFileSystemDataSource::AddNewOnly);
 
+    void addScanned(const QList<HCdsObjectData*>& items);
+
+    // adds the objects in the task scheduler in case it is set and in this
+    // call otherwise. takes the ownership of the objects
+    void addLater(
+        const QList<HCdsObjectData*>& items,
+        HFileSystemDataSource::AddFlag addFlag);
+
+    // a step of the task that adds m_pendingAdds
+    bool addPending();
+    void clearPending();
+
+    bool findRootDir(const QString& path, HRootDir* rootDir) const;
+    void watch(HCdsObjectData* item);
+    void directoriesChanged(const QStringList& paths);
+    void update(const QString& path, const QString& containerId);
+    void removeTree(const QString& id);
+
+    // returns the paths of the root directories that were restored
+    QSet<QString> loadIndex();
+    bool saveIndex();
+
+    void applyMetadata(const QList<HCdsMetadataResult>& results);
+
     inline HFileSystemDataSourceConfiguration* configuration() const
     {
         return static_cast<HFileSystemDataSourceConfiguration*>(m_configuration.data());
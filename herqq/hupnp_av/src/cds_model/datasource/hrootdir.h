@@ -62,6 +62,12 @@ public:
 
         /*!
          * The data source should monitor the specified directory (tree).
+         *
+         * Files and directories added to or removed from a monitored
+         * directory are added to or removed from the data source as they
+         * appear and disappear, which is reported by the affected containers.
+         * Changes are coalesced, so that a burst of file system changes
+         * results in a single update of each affected container.
          */
         WatchForChanges
     };
@@ -104,7 +110,8 @@ public:
      *
      * \param scanMode specifies how the directory will be scanned.
      *
-     * \param watchMode
+     * \param watchMode specifies whether the directory will be monitored
+     * for changes after it has been scanned.
      *
      * \sa isValid()
      */
@@ -143,8 +150,6 @@ public:
      * \return The watch mode.
      *
      * \sa setWatchMode()
-     *
-     * \note Watch-mode is not currently implemented.
      */
     inline WatchMode watchMode() const
     {
@@ -190,8 +195,6 @@ public:
      * \param wmode specifies the watch mode.
      *
      * \sa watchMode()
-     *
-     * \note Watch-mode is not currently implemented.
      */
     void setWatchMode(WatchMode wmode);
 };
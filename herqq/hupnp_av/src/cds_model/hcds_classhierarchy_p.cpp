@@ -0,0 +1,187 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hcds_classhierarchy_p.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QVector>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+namespace
+{
+// In preorder, i.e. every class is followed by its descendants.
+const char* const Classes[] =
+{
+    "object",
+    "object.container",
+    "object.container.album",
+    "object.container.album.musicAlbum",
+    "object.container.album.photoAlbum",
+    "object.container.bookmarkFolder",
+    "object.container.channelGroup",
+    "object.container.channelGroup.audioChannelGroup",
+    "object.container.channelGroup.videoChannelGroup",
+    "object.container.epgContainer",
+    "object.container.genre",
+    "object.container.genre.movieGenre",
+    "object.container.genre.musicGenre",
+    "object.container.person",
+    "object.container.person.musicArtist",
+    "object.container.playlistContainer",
+    "object.container.storageFolder",
+    "object.container.storageSystem",
+    "object.container.storageVolume",
+    "object.item",
+    "object.item.audioItem",
+    "object.item.audioItem.audioBook",
+    "object.item.audioItem.audioBroadcast",
+    "object.item.audioItem.musicTrack",
+    "object.item.bookmarkItem",
+    "object.item.epgItem",
+    "object.item.epgItem.audioProgram",
+    "object.item.epgItem.videoProgram",
+    "object.item.imageItem",
+    "object.item.imageItem.photo",
+    "object.item.playlistItem",
+    "object.item.textItem",
+    "object.item.videoItem",
+    "object.item.videoItem.movie",
+    "object.item.videoItem.musicVideoClip",
+    "object.item.videoItem.videoBroadcast"
+};
+
+const qint32 ClassCount = sizeof(Classes) / sizeof(Classes[0]);
+
+bool isDerivedFromByName(const QString& clazz, const QString& base)
+{
+    // The class hierarchy is encoded in the dotted class names,
+    // e.g. object.item.audioItem.musicTrack is derived from
+    // object.item.audioItem.
+    return clazz.startsWith(base, Qt::CaseInsensitive) &&
+           (clazz.size() == base.size() || clazz[base.size()] == '.');
+}
+
+QHash<QString, qint32> createIds(bool caseFolded)
+{
+    QHash<QString, qint32> retVal;
+    for (qint32 i = 0; i < ClassCount; ++i)
+    {
+        QString name = QString::fromLatin1(Classes[i]);
+        retVal.insert(caseFolded ? name.toCaseFolded() : name, i);
+    }
+    return retVal;
+}
+
+QVector<qint32> createLastDescendants()
+{
+    QVector<qint32> retVal(ClassCount);
+    for (qint32 i = 0; i < ClassCount; ++i)
+    {
+        QString base = QString::fromLatin1(Classes[i]);
+
+        qint32 last = i;
+        while (last + 1 < ClassCount && isDerivedFromByName(
+            QString::fromLatin1(Classes[last + 1]), base))
+        {
+            ++last;
+        }
+        retVal[i] = last;
+    }
+    return retVal;
+}
+
+const QHash<QString, qint32> Ids = createIds(false);
+const QHash<QString, qint32> CaseFoldedIds = createIds(true);
+
+const QVector<qint32> LastDescendants = createLastDescendants();
+// indexed by class ID
+}
+
+/*******************************************************************************
+ * HCdsClassHierarchy
+ *******************************************************************************/
+qint32 HCdsClassHierarchy::count()
+{
+    return ClassCount;
+}
+
+qint32 HCdsClassHierarchy::id(
+    const QString& className, Qt::CaseSensitivity cs)
+{
+    qint32 retVal = Ids.value(className, -1);
+    if (retVal < 0 && cs == Qt::CaseInsensitive)
+    {
+        // The class names are almost always in the canonical form, which is
+        // why the name is folded only when the exact lookup fails.
+        retVal = CaseFoldedIds.value(className.toCaseFolded(), -1);
+    }
+    return retVal;
+}
+
+qint32 HCdsClassHierarchy::nearestId(const QString& className)
+{
+    qint32 retVal = id(className);
+    for (qint32 end = className.size(); retVal < 0 && end > 0; )
+    {
+        end = className.lastIndexOf('.', end - 1);
+        if (end <= 0)
+        {
+            break;
+        }
+        retVal = id(className.left(end));
+    }
+    return retVal;
+}
+
+bool HCdsClassHierarchy::isA(qint32 classId, qint32 baseId)
+{
+    return baseId >= 0 && classId >= baseId &&
+           classId <= LastDescendants[baseId];
+}
+
+bool HCdsClassHierarchy::isDerivedFrom(
+    const QString& clazz, const QString& base)
+{
+    return isDerivedFrom(clazz, base, id(base));
+}
+
+bool HCdsClassHierarchy::isDerivedFrom(
+    const QString& clazz, const QString& base, qint32 baseId)
+{
+    if (baseId < 0)
+    {
+        // A vendor-defined base class is not in the table.
+        return isDerivedFromByName(clazz, base);
+    }
+    return isA(nearestId(clazz), baseId);
+}
+
+}
+}
+}
@@ -0,0 +1,97 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HCDS_CLASSHIERARCHY_P_H_
+#define HCDS_CLASSHIERARCHY_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include <HUpnpAv/HUpnpAv>
+
+#include <QtCore/QString>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+//
+// The standard CDS classes numbered in the preorder of the class hierarchy.
+//
+// The descendants of a class have the IDs that follow the ID of the class,
+// which is why a class is derived from another exactly when its ID lies
+// between the ID of the other class and the ID of the last descendant of
+// that class. The IDs and the intervals are computed once and a check
+// between two known classes is two integer comparisons.
+//
+class HCdsClassHierarchy
+{
+H_DISABLE_COPY(HCdsClassHierarchy)
+
+private:
+
+    HCdsClassHierarchy();
+
+public:
+
+    // the number of the standard classes. the IDs are in the range
+    // [0, count())
+    static qint32 count();
+
+    // returns the ID of the specified standard class, or -1 in case the
+    // class is not a standard class
+    static qint32 id(
+        const QString& className, Qt::CaseSensitivity cs = Qt::CaseInsensitive);
+
+    // returns the ID of the specified class, or, in case it is not a standard
+    // class, the ID of its closest standard ancestor. returns -1 in case the
+    // class is not derived from any standard class
+    static qint32 nearestId(const QString& className);
+
+    // indicates whether the class that has the first ID is derived from the
+    // class that has the second ID. a class is considered derived from itself
+    static bool isA(qint32 classId, qint32 baseId);
+
+    // indicates whether the first class is derived from the second. the
+    // comparison is case-insensitive, as it is in the search criteria
+    static bool isDerivedFrom(const QString& clazz, const QString& base);
+
+    // the same as above, when the ID of the base class has been
+    // looked up already
+    static bool isDerivedFrom(
+        const QString& clazz, const QString& base, qint32 baseId);
+};
+
+}
+}
+}
+
+#endif /* HCDS_CLASSHIERARCHY_P_H_ */
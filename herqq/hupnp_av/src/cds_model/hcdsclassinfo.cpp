@@ -20,6 +20,7 @@
  */
 
 #include "hcdsclassinfo.h"
+#include "hcds_classhierarchy_p.h"
 
 #include <QtCore/QString>
 
@@ -46,9 +47,19 @@ public:
     QString m_className;
     bool m_includeDerived;
 
+    qint32 m_classId;
+    // the ID of the class in HCdsClassHierarchy, or -1 if it is not
+    // a standard class
+
     HCdsClassInfoPrivate() :
-        m_name(), m_className(), m_includeDerived(true)
+        m_name(), m_className(), m_includeDerived(true), m_classId(-1)
+    {
+    }
+
+    void setClassName(const QString& className)
     {
+        m_className = className;
+        m_classId = HCdsClassHierarchy::id(className);
     }
 };
 
@@ -63,7 +74,7 @@ HCdsClassInfo::HCdsClassInfo() :
 HCdsClassInfo::HCdsClassInfo(const QString& className) :
     h_ptr(new HCdsClassInfoPrivate())
 {
-    h_ptr->m_className = className.trimmed();
+    h_ptr->setClassName(className.trimmed());
 }
 
 HCdsClassInfo::HCdsClassInfo(
@@ -73,7 +84,7 @@ HCdsClassInfo::HCdsClassInfo(
     QString classNameTrimmed = className.trimmed();
     if (!classNameTrimmed.isEmpty())
     {
-        h_ptr->m_className = classNameTrimmed;
+        h_ptr->setClassName(classNameTrimmed);
         h_ptr->m_name = name.trimmed();
         h_ptr->m_includeDerived = includeDerived;
     }
@@ -126,6 +137,22 @@ bool HCdsClassInfo::includeDerived() const
     return h_ptr->m_includeDerived;
 }
 
+bool HCdsClassInfo::matches(const QString& className) const
+{
+    if (!isValid())
+    {
+        return false;
+    }
+    else if (!h_ptr->m_includeDerived)
+    {
+        return className.compare(
+            h_ptr->m_className, Qt::CaseInsensitive) == 0;
+    }
+
+    return HCdsClassHierarchy::isDerivedFrom(
+        className, h_ptr->m_className, h_ptr->m_classId);
+}
+
 bool operator==(const HCdsClassInfo& obj1, const HCdsClassInfo& obj2)
 {
     return obj1.h_ptr->m_className == obj2.h_ptr->m_className &&
@@ -152,6 +152,21 @@ public:
      */
     bool includeDerived() const;
 
+    /*!
+     * \brief Indicates whether the specified class is covered by this
+     * class information.
+     *
+     * \param className specifies the UPnP CDS class name (type), such as
+     * \c object.item.photo.
+     *
+     * \return \e true in case the specified class is the className(), or
+     * includeDerived() is \e true and the specified class is derived from
+     * the className(). The class names are compared case-insensitively.
+     *
+     * \sa className(), includeDerived()
+     */
+    bool matches(const QString& className) const;
+
     /*!
      * \brief Sets the friendly name.
      *
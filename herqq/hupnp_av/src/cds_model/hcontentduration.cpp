@@ -62,40 +62,104 @@ HContentDuration::HContentDuration() :
 {
 }
 
+namespace
+{
+//
+// Reads an unsigned decimal number of minDigits to maxDigits digits and
+// advances the specified position past it.
+//
+bool readNumber(
+    const QChar*& pos, const QChar* end, qint32 minDigits, qint32 maxDigits,
+    qint32* value)
+{
+    qint32 retVal = 0, digits = 0;
+    for(; pos < end && digits < maxDigits; ++pos, ++digits)
+    {
+        ushort c = pos->unicode();
+        if (c < '0' || c > '9')
+        {
+            break;
+        }
+        retVal = retVal * 10 + (c - '0');
+    }
+
+    if (digits < minDigits)
+    {
+        return false;
+    }
+
+    *value = retVal;
+    return true;
+}
+
+inline bool readChar(const QChar*& pos, const QChar* end, char c)
+{
+    if (pos < end && pos->unicode() == c)
+    {
+        ++pos;
+        return true;
+    }
+    return false;
+}
+}
+
 HContentDuration::HContentDuration(const QString& arg) :
     h_ptr(new HContentDurationPrivate())
 {
-    if (arg.size() >= 6 && arg[0] == 'P')
+    // The format is P[n+D]HH:MM:SS[.F+]
+    const QChar* pos = arg.constData();
+    const QChar* end = pos + arg.size();
+
+    if (!readChar(pos, end, 'P'))
     {
-        int days = 0;
-        int iDays = arg.indexOf('D');
-        if (iDays > 1)
+        return;
+    }
+
+    const QChar* begin = pos;
+
+    qint32 days = 0;
+    if (!readNumber(pos, end, 1, 9, &days) || !readChar(pos, end, 'D'))
+    {
+        // There are no days, unless the number was followed by something
+        // else than the time.
+        pos = begin;
+        days = 0;
+    }
+
+    qint32 hours, minutes, seconds, msecs = 0;
+    if (!readNumber(pos, end, 2, 2, &hours) || !readChar(pos, end, ':') ||
+        !readNumber(pos, end, 2, 2, &minutes) || !readChar(pos, end, ':') ||
+        !readNumber(pos, end, 2, 2, &seconds))
+    {
+        return;
+    }
+
+    if (readChar(pos, end, '.'))
+    {
+        // Only milliseconds can be stored, the rest of the digits are ignored.
+        const QChar* fraction = pos;
+        if (!readNumber(pos, end, 1, 3, &msecs))
         {
-            bool ok = false;
-            days = arg.mid(1, iDays-1).toInt(&ok);
-            if (ok)
-            {
-                ++iDays;
-            }
-            else
-            {
-                iDays = -1;
-            }
+            return;
         }
-        else
+        for(qint32 i = pos - fraction; i < 3; ++i)
         {
-            iDays = 1;
+            msecs *= 10;
         }
+        qint32 ignored;
+        while (readNumber(pos, end, 1, 9, &ignored)) {}
+    }
 
-        if (iDays > 0)
-        {
-            QTime tmp = QTime::fromString(arg.mid(iDays), Qt::ISODate);
-            if (tmp.isValid())
-            {
-                h_ptr->m_time = tmp;
-                h_ptr->m_days = days >= 0 ? days : -1;
-            }
-        }
+    if (pos < end)
+    {
+        return;
+    }
+
+    QTime time(hours, minutes, seconds, msecs);
+    if (time.isValid())
+    {
+        h_ptr->m_time = time;
+        h_ptr->m_days = days;
     }
 }
 
@@ -138,9 +202,21 @@ QString HContentDuration::toString() const
         return QString();
     }
 
-    return QString("P%1%2").arg(
-        days() > 1 ? QString::number(days()).append(QString('D')) : QString(),
-        time().toString(Qt::ISODate));
+    QTime time = h_ptr->m_time;
+
+    char buf[32];
+    if (h_ptr->m_days > 0)
+    {
+        qsnprintf(buf, sizeof(buf), "P%dD%02d:%02d:%02d",
+            h_ptr->m_days, time.hour(), time.minute(), time.second());
+    }
+    else
+    {
+        qsnprintf(buf, sizeof(buf), "P%02d:%02d:%02d",
+            time.hour(), time.minute(), time.second());
+    }
+
+    return QString::fromLatin1(buf);
 }
 
 void HContentDuration::setDays(qint32 arg)
@@ -21,10 +21,15 @@
 
 #include "hcds_dlite_serializer.h"
 #include "hcds_dlite_serializer_p.h"
+#include "hcds_propertyfilter_p.h"
+#include "hcds_objectview_p.h"
 #include "hcdsproperty_db.h"
 #include "hcdsproperty.h"
 
+#include "../hcds_classhierarchy_p.h"
+
 #include "../cds_objects/hitem.h"
+#include "../cds_objects/hobject_p.h"
 #include "../cds_objects/halbum.h"
 #include "../cds_objects/hmovie.h"
 #include "../cds_objects/hphoto.h"
@@ -61,8 +66,10 @@
 #include "../cds_objects/hplaylistcontainer.h"
 
 #include <HUpnpCore/private/hlogger_p.h>
+#include <HUpnpCore/private/hmisc_utils_p.h>
 
 #include <QtCore/QSet>
+#include <QtCore/QIODevice>
 #include <QtCore/QVariant>
 #include <QtCore/QStringList>
 #include <QtCore/QXmlStreamReader>
@@ -148,6 +155,23 @@ end:
 
     return retVal;
 }
+
+class HViewCollector
+{
+private:
+
+    QList<HCdsObjectView>* m_views;
+
+public:
+
+    HViewCollector(QList<HCdsObjectView>* views) : m_views(views) {}
+
+    bool operator()(const HCdsObjectView& view)
+    {
+        m_views->append(view);
+        return true;
+    }
+};
 }
 
 /*******************************************************************************
@@ -193,50 +217,59 @@ inline HObject* createBookmarkFolder() { return HBookmarkFolder::create(); }
 }
 
 HCdsDidlLiteSerializerPrivate::HCdsDidlLiteSerializerPrivate() :
-    m_creatorFunctions(), m_lastErrorDescription()
+    m_creatorFunctions(HCdsClassHierarchy::count(), 0),
+    m_lastErrorDescription()
 {
-    m_creatorFunctions.insert(HItem::sClass(), createItem);
-    m_creatorFunctions.insert(HImageItem::sClass(), createImageItem);
-    m_creatorFunctions.insert(HPhoto::sClass(), createPhoto);
-    m_creatorFunctions.insert(HAudioItem::sClass(), createAudioItem);
-    m_creatorFunctions.insert(HMusicTrack::sClass(), createMusicTrack);
-    m_creatorFunctions.insert(HAudioBroadcast::sClass(), createAudioBroadcast);
-    m_creatorFunctions.insert(HAudioBook::sClass(), createAudioBook);
-    m_creatorFunctions.insert(HVideoItem::sClass(), createVideoItem);
-    m_creatorFunctions.insert(HMovie::sClass(), createMovie);
-    m_creatorFunctions.insert(HVideoBroadcast::sClass(), createVideoBroadcast);
-    m_creatorFunctions.insert(HMusicVideoClip::sClass(), createMusicVideoClip);
-    m_creatorFunctions.insert(HPlaylistItem::sClass(), createPlaylistItem);
-    m_creatorFunctions.insert(HTextItem::sClass(), createTextItem);
-    m_creatorFunctions.insert(HBookmarkItem::sClass(), createBookmarkItem);
-    m_creatorFunctions.insert(HEpgItem::sClass(), createEpgItem);
-    m_creatorFunctions.insert(HAudioProgram::sClass(), createAudioProgram);
-    m_creatorFunctions.insert(HVideoProgram::sClass(), createVideoProgram);
-
-    m_creatorFunctions.insert(HContainer::sClass(), createContainer);
-    m_creatorFunctions.insert(HPerson::sClass(), createPerson);
-    m_creatorFunctions.insert(HMusicArtist::sClass(), createMusicArtist);
-    m_creatorFunctions.insert(HPlaylistContainer::sClass(), createPlaylistContainer);
-    m_creatorFunctions.insert(HAlbum::sClass(), createAlbum);
-    m_creatorFunctions.insert(HMusicAlbum::sClass(), createMusicAlbum);
-    m_creatorFunctions.insert(HPhotoAlbum::sClass(), createPhotoAlbum);
-    m_creatorFunctions.insert(HGenreContainer::sClass(), createGenreContainer);
-    m_creatorFunctions.insert(HMusicGenre::sClass(), createMusicGenre);
-    m_creatorFunctions.insert(HMovieGenre::sClass(), createMovieGenre);
-    m_creatorFunctions.insert(HChannelGroup::sClass(), createChannelGroup);
-    m_creatorFunctions.insert(HAudioChannelGroup::sClass(), createAudioChannelGroup);
-    m_creatorFunctions.insert(HVideoChannelGroup::sClass(), createVideoChannelGroup);
-    m_creatorFunctions.insert(HEpgContainer::sClass(), createEpgContainer);
-    m_creatorFunctions.insert(HStorageSystem::sClass(), createStorageSystem);
-    m_creatorFunctions.insert(HStorageVolume::sClass(), createStorageVolume);
-    m_creatorFunctions.insert(HStorageFolder::sClass(), createStorageFolder);
-    m_creatorFunctions.insert(HBookmarkFolder::sClass(), createBookmarkFolder);
+    addCreator(HItem::sClass(), createItem);
+    addCreator(HImageItem::sClass(), createImageItem);
+    addCreator(HPhoto::sClass(), createPhoto);
+    addCreator(HAudioItem::sClass(), createAudioItem);
+    addCreator(HMusicTrack::sClass(), createMusicTrack);
+    addCreator(HAudioBroadcast::sClass(), createAudioBroadcast);
+    addCreator(HAudioBook::sClass(), createAudioBook);
+    addCreator(HVideoItem::sClass(), createVideoItem);
+    addCreator(HMovie::sClass(), createMovie);
+    addCreator(HVideoBroadcast::sClass(), createVideoBroadcast);
+    addCreator(HMusicVideoClip::sClass(), createMusicVideoClip);
+    addCreator(HPlaylistItem::sClass(), createPlaylistItem);
+    addCreator(HTextItem::sClass(), createTextItem);
+    addCreator(HBookmarkItem::sClass(), createBookmarkItem);
+    addCreator(HEpgItem::sClass(), createEpgItem);
+    addCreator(HAudioProgram::sClass(), createAudioProgram);
+    addCreator(HVideoProgram::sClass(), createVideoProgram);
+
+    addCreator(HContainer::sClass(), createContainer);
+    addCreator(HPerson::sClass(), createPerson);
+    addCreator(HMusicArtist::sClass(), createMusicArtist);
+    addCreator(HPlaylistContainer::sClass(), createPlaylistContainer);
+    addCreator(HAlbum::sClass(), createAlbum);
+    addCreator(HMusicAlbum::sClass(), createMusicAlbum);
+    addCreator(HPhotoAlbum::sClass(), createPhotoAlbum);
+    addCreator(HGenreContainer::sClass(), createGenreContainer);
+    addCreator(HMusicGenre::sClass(), createMusicGenre);
+    addCreator(HMovieGenre::sClass(), createMovieGenre);
+    addCreator(HChannelGroup::sClass(), createChannelGroup);
+    addCreator(HAudioChannelGroup::sClass(), createAudioChannelGroup);
+    addCreator(HVideoChannelGroup::sClass(), createVideoChannelGroup);
+    addCreator(HEpgContainer::sClass(), createEpgContainer);
+    addCreator(HStorageSystem::sClass(), createStorageSystem);
+    addCreator(HStorageVolume::sClass(), createStorageVolume);
+    addCreator(HStorageFolder::sClass(), createStorageFolder);
+    addCreator(HBookmarkFolder::sClass(), createBookmarkFolder);
 }
 
 HCdsDidlLiteSerializerPrivate::~HCdsDidlLiteSerializerPrivate()
 {
 }
 
+void HCdsDidlLiteSerializerPrivate::addCreator(
+    const QString& clazz, HObjectCreator creator)
+{
+    qint32 classId = HCdsClassHierarchy::id(clazz, Qt::CaseSensitive);
+    Q_ASSERT(classId >= 0);
+    m_creatorFunctions[classId] = creator;
+}
+
 bool HCdsDidlLiteSerializerPrivate::serializePropertyFromAttribute(
     HObject* object, const QString& xmlTokenName, const QString& attributeValue)
 {
@@ -320,20 +353,29 @@ bool HCdsDidlLiteSerializerPrivate::serializePropertyFromElement(
 }
 
 bool HCdsDidlLiteSerializerPrivate::serializeProperty(
-    const HObject& object, const QString& propName, const QVariant& value,
-    const QSet<QString>& filter, QXmlStreamWriter& writer)
+    const HObject& object, qint32 propertyId, const QVariant& value,
+    const HCdsPropertyFilter& filter, QXmlStreamWriter& writer)
 {
     HLOG(H_AT, H_FUN);
 
-    if (!object.isCdsPropertySet(propName) ||
-        !object.isCdsPropertyActive(propName))
+    // The mandatory standard properties are included in the filter, but a
+    // custom property registered into the database may be mandatory as well.
+    bool filterOk = filter.accepts(propertyId);
+    if ((!filterOk && propertyId < HCdsPropertyDb::FirstCustomPropertyId) ||
+        !value.isValid() || value.isNull())
     {
         return false;
     }
 
-    bool filterOk = filter.contains("*") || filter.contains(propName);
+    HCdsPropertyDb& db = HCdsPropertyDb::instance();
 
-    HCdsProperty prop = HCdsPropertyDb::instance().property(propName);
+    QString propName = db.propertyName(propertyId);
+    if (object.h_ptr->m_disabledProperties.contains(propName))
+    {
+        return false;
+    }
+
+    HCdsProperty prop = db.property(propName);
 
     if (!prop.isValid())
     {
@@ -378,31 +420,31 @@ bool HCdsDidlLiteSerializerPrivate::serializeProperty(
 }
 
 bool HCdsDidlLiteSerializerPrivate::serializeObject(
-    const HObject& object, const QSet<QString>& filter,
+    const HObject& object, const HCdsPropertyFilter& filter,
     QXmlStreamWriter& writer)
 {
     HLOG(H_AT, H_FUN);
 
     writer.writeStartElement(HObject::isItem(object.type()) ? "item" : "container");
 
-    QHash<QString, QVariant> cdsProps = object.cdsProperties();
-
-    QSet<QString> didlLiteDepProps =
-        HCdsPropertyDb::instance().didlLiteDependentProperties();
-
-    foreach(const QString& arg, didlLiteDepProps)
+    // The attributes of the DIDL-Lite element have to be written before
+    // any of the child elements.
+    const HCdsPropertyStore& props = object.h_ptr->m_properties;
+    HCdsPropertyStore::ConstIterator it(props);
+    for(; !it.atEnd(); it.next())
     {
-        if (cdsProps.contains(arg))
+        if (filter.isAttribute(it.id()))
         {
-            serializeProperty(object, arg, cdsProps.value(arg), filter, writer);
-            cdsProps.remove(arg);
+            serializeProperty(object, it.id(), it.value(), filter, writer);
         }
     }
 
-    QHash<QString, QVariant>::const_iterator ci = cdsProps.constBegin();
-    for(; ci != cdsProps.constEnd(); ++ci)
+    for(it = HCdsPropertyStore::ConstIterator(props); !it.atEnd(); it.next())
     {
-        serializeProperty(object, ci.key(), ci.value(), filter, writer);
+        if (!filter.isAttribute(it.id()))
+        {
+            serializeProperty(object, it.id(), it.value(), filter, writer);
+        }
     }
 
     writer.writeEndElement();
@@ -445,7 +487,9 @@ HObject* HCdsDidlLiteSerializerPrivate::parseObject(
         }
 
         QString clazz = itemReader.readElementText();
-        HObjectCreator creator = m_creatorFunctions.value(clazz);
+        qint32 classId = HCdsClassHierarchy::id(clazz, Qt::CaseSensitive);
+        HObjectCreator creator =
+            classId >= 0 ? m_creatorFunctions[classId] : 0;
         if (!creator)
         {
             m_lastErrorDescription =  QString("Unknown class: [%1]").arg(clazz);
@@ -520,6 +564,124 @@ HObject* HCdsDidlLiteSerializerPrivate::parseObject(
     return 0;
 }
 
+bool HCdsDidlLiteSerializerPrivate::parseViews(
+    const QString& didlLiteDoc, HCdsDidlLiteSerializer::XmlType inputType,
+    HCdsObjectViewCallback& callback)
+{
+    HLOG(H_AT, H_FUN);
+
+    QXmlStreamReader reader(didlLiteDoc);
+
+    if (inputType == HCdsDidlLiteSerializer::Document)
+    {
+        addNamespaces(reader);
+        if (reader.readNextStartElement())
+        {
+            if (reader.name().compare("DIDL-Lite", Qt::CaseInsensitive) != 0)
+            {
+                m_lastErrorDescription = "Missing mandatory DIDL-Lite element";
+                return false;
+            }
+        }
+    }
+    else
+    {
+        reader.setNamespaceProcessing(false);
+    }
+
+    // The views share the document and refer to the elements of the objects
+    // by their position in the document. Only the attributes of the object
+    // element and the title and the class are parsed here.
+    QSharedDataPointer<HCdsObjectViewPrivate> view;
+    qint32 depth = 0;
+    qint32 tokenStart = static_cast<qint32>(reader.characterOffset());
+    while(!reader.atEnd() && reader.readNext())
+    {
+        switch(reader.tokenType())
+        {
+        case QXmlStreamReader::StartElement:
+            if (!view)
+            {
+                QStringRef name = reader.name();
+                if (name != "item" && name != "container")
+                {
+                    break;
+                }
+
+                view = new HCdsObjectViewPrivate();
+                view->m_document = didlLiteDoc;
+                view->m_offset = didlLiteDoc.indexOf(
+                    QString("<%1").arg(reader.qualifiedName().toString()),
+                    tokenStart);
+                view->m_isItem = name == "item";
+
+                QXmlStreamAttributes attrs = reader.attributes();
+                view->m_id = attrs.value("id").toString();
+                view->m_parentId = attrs.value("parentID").toString();
+
+                bool ok = false;
+                view->m_restricted =
+                    toBool(attrs.value("restricted").toString(), &ok) && ok;
+
+                depth = 0;
+            }
+            else if (depth == 0 && reader.qualifiedName() == "dc:title")
+            {
+                view->m_title = reader.readElementText();
+            }
+            else if (depth == 0 && reader.qualifiedName() == "upnp:class")
+            {
+                view->m_clazz = reader.readElementText();
+            }
+            else
+            {
+                ++depth;
+            }
+            break;
+
+        case QXmlStreamReader::EndElement:
+            if (view && depth > 0)
+            {
+                --depth;
+            }
+            else if (view)
+            {
+                qint32 end = static_cast<qint32>(reader.characterOffset());
+                if (end <= 0 || didlLiteDoc.at(end - 1) != '>')
+                {
+                    end = didlLiteDoc.indexOf('>', end) + 1;
+                }
+                view->m_length = end - view->m_offset;
+
+                HCdsObjectView retVal;
+                retVal.h_ptr = view;
+                view = 0;
+
+                if (!callback(retVal))
+                {
+                    return true;
+                }
+            }
+            break;
+
+        default:
+            break;
+        }
+
+        tokenStart = static_cast<qint32>(reader.characterOffset());
+    }
+
+    if (reader.error() != QXmlStreamReader::NoError)
+    {
+        m_lastErrorDescription =
+            QString("Parse failed: [%1]").arg(reader.errorString());
+
+        return false;
+    }
+
+    return true;
+}
+
 void HCdsDidlLiteSerializerPrivate::writeDidlLiteDocumentInfo(
     QXmlStreamWriter& writer)
 {
@@ -616,6 +778,42 @@ bool HCdsDidlLiteSerializer::serializeFromXml(
     return true;
 }
 
+bool HCdsDidlLiteSerializer::serializeFromXml(
+    const QString& didlLiteDoc, QList<HCdsObjectView>* retVal,
+    XmlType inputType)
+{
+    HLOG(H_AT, H_FUN);
+    Q_ASSERT(retVal);
+
+    QList<HCdsObjectView> tmp;
+    HCdsObjectViewCallback callback = HViewCollector(&tmp);
+    if (!h_ptr->parseViews(didlLiteDoc, inputType, callback))
+    {
+        return false;
+    }
+
+    *retVal = tmp;
+    return true;
+}
+
+bool HCdsDidlLiteSerializer::serializeFromXml(
+    const QString& didlLiteDoc, const HCdsObjectViewCallback& callback,
+    XmlType inputType)
+{
+    HLOG(H_AT, H_FUN);
+
+    if (!callback)
+    {
+        h_ptr->m_lastErrorDescription = "The callback is not valid";
+        return false;
+    }
+
+    // The callable entity is invoked through a copy, as invoking it
+    // is not a const operation.
+    HCdsObjectViewCallback tmp(callback);
+    return h_ptr->parseViews(didlLiteDoc, inputType, tmp);
+}
+
 QString HCdsDidlLiteSerializer::serializeToXml(
     const HObject& object, XmlType xmlType)
 {
@@ -634,7 +832,7 @@ QString HCdsDidlLiteSerializer::serializeToXml(
         h_ptr->writeDidlLiteDocumentInfo(writer);
     }
 
-    if (!h_ptr->serializeObject(object, filter, writer))
+    if (!h_ptr->serializeObject(object, HCdsPropertyFilter(filter), writer))
     {
         return "";
     }
@@ -661,9 +859,10 @@ QString HCdsDidlLiteSerializer::serializeToXml(
 
     h_ptr->writeDidlLiteDocumentInfo(writer);
 
+    HCdsPropertyFilter compiledFilter(filter);
     foreach(const HObject* obj, objects)
     {
-        if (!h_ptr->serializeObject(*obj, filter, writer))
+        if (!h_ptr->serializeObject(*obj, compiledFilter, writer))
         {
             return "";
         }
@@ -674,6 +873,56 @@ QString HCdsDidlLiteSerializer::serializeToXml(
     return retVal;
 }
 
+bool HCdsDidlLiteSerializer::serializeToXml(
+    const HObjects& objects, const QSet<QString>& filter, QIODevice* device)
+{
+    Q_ASSERT(device && device->isWritable());
+
+    QXmlStreamWriter writer(device);
+
+    h_ptr->writeDidlLiteDocumentInfo(writer);
+
+    HCdsPropertyFilter compiledFilter(filter);
+    foreach(const HObject* obj, objects)
+    {
+        if (!h_ptr->serializeObject(*obj, compiledFilter, writer))
+        {
+            return false;
+        }
+    }
+
+    writer.writeEndDocument();
+
+    return true;
+}
+
+bool HCdsDidlLiteSerializer::serializeToXml(
+    const QList<QByteArray>& excerpts, QIODevice* device)
+{
+    Q_ASSERT(device && device->isWritable());
+
+    QXmlStreamWriter writer(device);
+
+    h_ptr->writeDidlLiteDocumentInfo(writer);
+
+    // The writer passes everything to the device immediately. Once the
+    // start tag of the DIDL-Lite element is finished, the excerpts can be
+    // written to the device directly.
+    writer.writeCharacters(QString());
+
+    foreach(const QByteArray& excerpt, excerpts)
+    {
+        if (device->write(excerpt) != excerpt.size())
+        {
+            return false;
+        }
+    }
+
+    writer.writeEndDocument();
+
+    return true;
+}
+
 }
 }
 }
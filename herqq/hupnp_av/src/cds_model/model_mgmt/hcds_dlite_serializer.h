@@ -23,7 +23,10 @@
 #define HCDS_DLITE_SERIALIZER_H_
 
 #include <HUpnpAv/HUpnpAv>
+#include <HUpnpAv/HCdsObjectView>
 
+class QIODevice;
+class QByteArray;
 class QStringList;
 
 template <typename T>
@@ -119,6 +122,51 @@ public:
         const QString& didlLiteDoc, HObjects* retVal,
         XmlType inputType = Document);
 
+    /*!
+     * \brief Creates lightweight views of the CDS objects in a DIDL-Lite
+     * document.
+     *
+     * This is considerably faster than creating HObject instances, as only
+     * the most commonly used properties are parsed when the views are created.
+     *
+     * \param didlLiteDoc specifies the DIDL-Lite document.
+     *
+     * \param retVal specifies a pointer to a list that will contain the views
+     * if the serialization succeeds.
+     *
+     * \param inputType specifies the XML type of the string passed to the method.
+     *
+     * \return \e true when the serialization succeeds.
+     *
+     * \sa HCdsObjectView
+     */
+    bool serializeFromXml(
+        const QString& didlLiteDoc, QList<HCdsObjectView>* retVal,
+        XmlType inputType = Document);
+
+    /*!
+     * \brief Creates lightweight views of the CDS objects in a DIDL-Lite
+     * document and passes them to the specified callback one at a time.
+     *
+     * The views are passed to the callback as soon as they are parsed,
+     * which means that no list of the objects is created.
+     *
+     * \param didlLiteDoc specifies the DIDL-Lite document.
+     *
+     * \param callback specifies the callable entity that is called for each
+     * of the objects in the document. The parsing is stopped without an error
+     * when the callable entity returns \e false.
+     *
+     * \param inputType specifies the XML type of the string passed to the method.
+     *
+     * \return \e true when the serialization succeeds.
+     *
+     * \sa HCdsObjectView
+     */
+    bool serializeFromXml(
+        const QString& didlLiteDoc, const HCdsObjectViewCallback& callback,
+        XmlType inputType = Document);
+
     /*!
      * \brief Serializes the specified HObject into a DIDL-Lite document.
      *
@@ -173,6 +221,44 @@ public:
      * \return The objects serialized to DIDL-Lite.
      */
     QString serializeToXml(const HObjects& objects, const QSet<QString>& filter);
+
+    /*!
+     * \brief Serializes the specified HObjects into a DIDL-Lite document
+     * that is written to the specified device.
+     *
+     * The document is written as UTF-8 while the objects are serialized,
+     * which means that no intermediate copy of the whole document is created.
+     *
+     * \param objects specifies the objects to be serialized.
+     *
+     * \param filter specifies the properties to be serialized. If this is not
+     * empty or it doesn't contain an asterisk, only the properties specified
+     * in the set will be serialized.
+     *
+     * \param device specifies the device to which the document is written.
+     * The device has to be open for writing.
+     *
+     * \return \e true when the serialization succeeds.
+     */
+    bool serializeToXml(
+        const HObjects& objects, const QSet<QString>& filter,
+        QIODevice* device);
+
+    /*!
+     * \internal
+     *
+     * \brief Writes a DIDL-Lite document that contains the specified,
+     * already serialized objects to the specified device.
+     *
+     * \param excerpts specifies the serialized objects. Each of these is
+     * an excerpt returned by serializeToXml() encoded as UTF-8.
+     *
+     * \param device specifies the device to which the document is written.
+     * The device has to be open for writing.
+     *
+     * \return \e true when the serialization succeeds.
+     */
+    bool serializeToXml(const QList<QByteArray>& excerpts, QIODevice* device);
 };
 
 }
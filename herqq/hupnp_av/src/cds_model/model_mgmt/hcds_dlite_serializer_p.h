@@ -32,12 +32,15 @@
 
 #include <HUpnpAv/HCdsDidlLiteSerializer>
 
-#include <QtCore/QHash>
 #include <QtCore/QString>
+#include <QtCore/QVector>
 
 class QXmlStreamReader;
 class QXmlStreamWriter;
 
+template<typename T>
+class QSet;
+
 namespace Herqq
 {
 
@@ -47,6 +50,8 @@ namespace Upnp
 namespace Av
 {
 
+class HCdsPropertyFilter;
+
 //
 // Implementation details of HCdsDidlLiteSerializer.
 //
@@ -56,13 +61,17 @@ public:
 
     typedef HObject* (*HObjectCreator)();
 
-    QHash<QString, HObjectCreator> m_creatorFunctions;
+    QVector<HObjectCreator> m_creatorFunctions;
+    // indexed by the ID of the class in HCdsClassHierarchy. the slot of
+    // the abstract object class is null
 
     QString m_lastErrorDescription;
 
     HCdsDidlLiteSerializerPrivate();
     ~HCdsDidlLiteSerializerPrivate();
 
+    void addCreator(const QString& clazz, HObjectCreator creator);
+
     bool serializePropertyFromAttribute(
         HObject* object, const QString& xmlTokenName,
         const QString& attributeValue);
@@ -73,14 +82,18 @@ public:
 
     HObject* parseObject(QXmlStreamReader&, HCdsDidlLiteSerializer::XmlType);
 
+    bool parseViews(
+        const QString& didlLiteDoc, HCdsDidlLiteSerializer::XmlType,
+        HCdsObjectViewCallback& callback);
+
     void writeDidlLiteDocumentInfo(QXmlStreamWriter&);
 
     bool serializeProperty(
-        const HObject& object, const QString& propName, const QVariant& value,
-        const QSet<QString>& filter, QXmlStreamWriter& writer);
+        const HObject& object, qint32 propertyId, const QVariant& value,
+        const HCdsPropertyFilter& filter, QXmlStreamWriter& writer);
 
     bool serializeObject(
-        const HObject&, const QSet<QString>&, QXmlStreamWriter&);
+        const HObject&, const HCdsPropertyFilter&, QXmlStreamWriter&);
 };
 
 }
@@ -0,0 +1,200 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hcds_fsys_index_p.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QDataStream>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+// The operators have to be in the namespace of the types for the QList
+// operators of QDataStream to find them.
+QDataStream& operator<<(QDataStream& out, const HCdsIndexedRootDir& arg)
+{
+    out << arg.m_path << arg.m_scanMode;
+    return out;
+}
+
+QDataStream& operator>>(QDataStream& in, HCdsIndexedRootDir& arg)
+{
+    in >> arg.m_path >> arg.m_scanMode;
+    return in;
+}
+
+QDataStream& operator<<(QDataStream& out, const HCdsIndexedDirectory& arg)
+{
+    out << arg.m_path << arg.m_lastModified << arg.m_containerId
+        << arg.m_dataPaths << arg.m_didlLite;
+
+    return out;
+}
+
+QDataStream& operator>>(QDataStream& in, HCdsIndexedDirectory& arg)
+{
+    in >> arg.m_path >> arg.m_lastModified >> arg.m_containerId
+       >> arg.m_dataPaths >> arg.m_didlLite;
+
+    return in;
+}
+
+namespace
+{
+const quint32 IndexMagic = 0x48434458; // "HCDX"
+
+bool readIndex(
+    QDataStream& in, QList<HCdsIndexedRootDir>* rootDirs,
+    QList<HCdsIndexedDirectory>* dirs, QString* errDescr)
+{
+    in.setVersion(QDataStream::Qt_4_6);
+
+    quint32 magic = 0, version = 0;
+    in >> magic >> version;
+    if (magic != IndexMagic)
+    {
+        *errDescr = "The file is not a HUPnP CDS index";
+        return false;
+    }
+    else if (version != HCdsFileSystemIndex::Version)
+    {
+        *errDescr = QString("Unsupported index version [%1]").arg(version);
+        return false;
+    }
+
+    QList<HCdsIndexedRootDir> tmpRootDirs;
+    QList<HCdsIndexedDirectory> tmpDirs;
+    in >> tmpRootDirs >> tmpDirs;
+
+    if (in.status() != QDataStream::Ok)
+    {
+        *errDescr = "The index is corrupted";
+        return false;
+    }
+
+    *rootDirs = tmpRootDirs;
+    *dirs = tmpDirs;
+
+    return true;
+}
+}
+
+/*******************************************************************************
+ * HCdsFileSystemIndex
+ ******************************************************************************/
+HCdsFileSystemIndex::HCdsFileSystemIndex(const QString& filePath) :
+    m_filePath(filePath), m_lastErrorDescription()
+{
+}
+
+HCdsFileSystemIndex::~HCdsFileSystemIndex()
+{
+}
+
+bool HCdsFileSystemIndex::read(
+    QList<HCdsIndexedRootDir>* rootDirs, QList<HCdsIndexedDirectory>* dirs)
+{
+    Q_ASSERT(rootDirs);
+    Q_ASSERT(dirs);
+
+    QFile file(m_filePath);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        m_lastErrorDescription =
+            QString("Could not open file [%1] for reading").arg(m_filePath);
+        return false;
+    }
+
+    bool ok = false;
+    uchar* mapped = file.size() > 0 ? file.map(0, file.size()) : 0;
+    if (mapped)
+    {
+        // The strings and the DIDL-Lite documents are copied out of the mapped
+        // region while they are read, which is why the mapping can be
+        // released right after.
+        QByteArray data = QByteArray::fromRawData(
+            reinterpret_cast<const char*>(mapped), file.size());
+
+        QDataStream in(data);
+        ok = readIndex(in, rootDirs, dirs, &m_lastErrorDescription);
+
+        file.unmap(mapped);
+    }
+    else
+    {
+        QDataStream in(&file);
+        ok = readIndex(in, rootDirs, dirs, &m_lastErrorDescription);
+    }
+
+    return ok;
+}
+
+bool HCdsFileSystemIndex::write(
+    const QList<HCdsIndexedRootDir>& rootDirs,
+    const QList<HCdsIndexedDirectory>& dirs)
+{
+    QString tmpPath = m_filePath;
+    tmpPath.append(".tmp");
+
+    QFile file(tmpPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        m_lastErrorDescription =
+            QString("Could not open file [%1] for writing").arg(tmpPath);
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_4_6);
+    out << IndexMagic << static_cast<quint32>(Version) << rootDirs << dirs;
+
+    file.close();
+    if (out.status() != QDataStream::Ok || file.error() != QFile::NoError)
+    {
+        m_lastErrorDescription =
+            QString("Could not write the index to [%1]").arg(tmpPath);
+
+        QFile::remove(tmpPath);
+        return false;
+    }
+
+    QFile::remove(m_filePath);
+    if (!QFile::rename(tmpPath, m_filePath))
+    {
+        m_lastErrorDescription =
+            QString("Could not replace the index [%1]").arg(m_filePath);
+
+        QFile::remove(tmpPath);
+        return false;
+    }
+
+    return true;
+}
+
+}
+}
+}
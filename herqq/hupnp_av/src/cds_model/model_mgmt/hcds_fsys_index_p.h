@@ -0,0 +1,128 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HCDS_FILESYSTEM_INDEX_P_H_
+#define HCDS_FILESYSTEM_INDEX_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include <HUpnpAv/HUpnpAv>
+
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QString>
+#include <QtCore/QDateTime>
+#include <QtCore/QByteArray>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+//
+// The persisted state of a single scanned directory
+//
+class HCdsIndexedDirectory
+{
+public:
+
+    QString m_path;
+    // the absolute path of the directory
+
+    QDateTime m_lastModified;
+    // the modification time of the directory when it was last read
+
+    QString m_containerId;
+    // the id of the container representing the directory
+
+    QHash<QString, QString> m_dataPaths;
+    // key == object id, value == file system path
+
+    QByteArray m_didlLite;
+    // the container and the items directly under it as a UTF-8 encoded
+    // DIDL-Lite document
+};
+
+//
+// The persisted state of a root directory
+//
+class HCdsIndexedRootDir
+{
+public:
+
+    QString m_path;
+    qint32 m_scanMode;
+};
+
+//
+// Reads and writes the versioned index file of HFileSystemDataSource.
+//
+// The index is read from a memory-mapped view of the file whenever the
+// file system supports that. A file that is written by an incompatible
+// version is ignored, which results in a full scan.
+//
+class HCdsFileSystemIndex
+{
+H_DISABLE_COPY(HCdsFileSystemIndex)
+
+private:
+
+    QString m_filePath;
+    QString m_lastErrorDescription;
+
+public:
+
+    enum
+    {
+        Version = 1
+    };
+
+    explicit HCdsFileSystemIndex(const QString& filePath);
+    ~HCdsFileSystemIndex();
+
+    bool read(QList<HCdsIndexedRootDir>*, QList<HCdsIndexedDirectory>*);
+
+    // The index is written to a temporary file first, so that an interrupted
+    // write never leaves a truncated index behind.
+    bool write(
+        const QList<HCdsIndexedRootDir>&, const QList<HCdsIndexedDirectory>&);
+
+    inline QString lastErrorDescription() const
+    {
+        return m_lastErrorDescription;
+    }
+};
+
+}
+}
+}
+
+#endif /* HCDS_FILESYSTEM_INDEX_P_H_ */
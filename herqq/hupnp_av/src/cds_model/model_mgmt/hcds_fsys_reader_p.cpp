@@ -33,10 +33,13 @@
 #include <HUpnpCore/private/hlogger_p.h>
 
 #include <QtCore/QDir>
-#include <QtCore/QSet>
+#include <QtCore/QStringList>
 #include <QtCore/QHash>
 #include <QtCore/QString>
 #include <QtCore/QFileInfo>
+#include <QtCore/QThread>
+#include <QtCore/QRunnable>
+#include <QtCore/QMutexLocker>
 
 namespace Herqq
 {
@@ -122,6 +125,29 @@ QHash<QString, MimeAndItemCreator> initializeCreatorFunctions()
 
 QHash<QString, MimeAndItemCreator> creatorFunctions = initializeCreatorFunctions();
 
+// The creator functions are only read after the static initialization, which
+// is why they can be used from the threads of HCdsFileSystemScanner as long
+// as operator[] is not used.
+HCdsObjectData* indexFile(const QFileInfo& file, const QString& parentId)
+{
+    HLOG(H_AT, H_FUN);
+
+    QString sufx = file.suffix().toLower();
+
+    MimeAndItemCreator creator = creatorFunctions.value(sufx);
+    if (!creator.second)
+    {
+        HLOG_WARN(QString("File type [%1] is not supported.").arg(sufx));
+        return 0;
+    }
+
+    HItem* item = creator.second(file, parentId);
+    Q_ASSERT(item);
+    item->setContentFormat(creator.first);
+
+    return new HCdsObjectData(item, file.absoluteFilePath());
+}
+
 }
 
 /*******************************************************************************
@@ -133,9 +159,6 @@ friend class HCdsFileSystemReader;
 
 private:
 
-    HCdsObjectData* indexFile(
-        const QFileInfo& fileInfo, const QString& parentId);
-
     HContainer* indexDir (
         const QDir& dir, const QString& parentId, const QString& id,
         const QList<HObject*>& children);
@@ -155,27 +178,6 @@ HCdsFileSystemReaderPrivate::~HCdsFileSystemReaderPrivate()
 {
 }
 
-HCdsObjectData* HCdsFileSystemReaderPrivate::indexFile(
-    const QFileInfo& file, const QString& parentId)
-{
-    HLOG(H_AT, H_FUN);
-
-    QString sufx = file.suffix().toLower();
-
-    MimeAndItemCreator creator = creatorFunctions[sufx];
-    if (!creator.second)
-    {
-        HLOG_WARN(QString("File type [%1] is not supported.").arg(sufx));
-        return 0;
-    }
-
-    HItem* item = creator.second(file, parentId);
-    Q_ASSERT(item);
-    item->setContentFormat(creator.first);
-
-    return new HCdsObjectData(item, file.absoluteFilePath());
-}
-
 HCdsObjectData* HCdsFileSystemReaderPrivate::scan(
     const HRootDir& rdir, const QString& parentId, QList<HCdsObjectData*>* result)
 {
@@ -190,7 +192,7 @@ HCdsObjectData* HCdsFileSystemReaderPrivate::scan(
     HCdsObjectData* item = new HCdsObjectData(folder, dir.absolutePath());
     result->append(item);
 
-    QSet<QString> childIds;
+    QStringList childIds;
     QFileInfoList infoList =
         dir.entryInfoList(QDir::Files | QDir::AllDirs | QDir::NoDotAndDotDot);
 
@@ -209,7 +211,7 @@ HCdsObjectData* HCdsFileSystemReaderPrivate::scan(
             HCdsObjectData* child = scan(subdir, id, result);
             Q_ASSERT(child);
 
-            childIds.insert(child->object()->id());
+            childIds.append(child->object()->id());
 
             continue;
         }
@@ -218,7 +220,7 @@ HCdsObjectData* HCdsFileSystemReaderPrivate::scan(
         if (child)
         {
             result->append(child);
-            childIds.insert(child->object()->id());
+            childIds.append(child->object()->id());
         }
     }
 
@@ -262,7 +264,7 @@ QString HCdsFileSystemReader::deduceMimeType(const QString& filename)
 {
     QString fileSuffix = filename.mid(filename.lastIndexOf('.')+1).toLower();
 
-    MimeAndItemCreator creator = creatorFunctions[fileSuffix];
+    MimeAndItemCreator creator = creatorFunctions.value(fileSuffix);
     if (!creator.second)
     {
         return "";
@@ -276,7 +278,7 @@ HItem* HCdsFileSystemReader::createItem(
 {
     QString fileSuffix = filename.mid(filename.lastIndexOf('.')+1).toLower();
 
-    MimeAndItemCreator creator = creatorFunctions[fileSuffix];
+    MimeAndItemCreator creator = creatorFunctions.value(fileSuffix);
     if (!creator.second)
     {
         return 0;
@@ -285,6 +287,223 @@ HItem* HCdsFileSystemReader::createItem(
     return creator.second(QFileInfo(filename), parentId);
 }
 
+HCdsObjectData* HCdsFileSystemReader::index(
+    const QFileInfo& file, const QString& parentId)
+{
+    return indexFile(file, parentId);
+}
+
+/*******************************************************************************
+ * HCdsFileSystemScanner::Job
+ ******************************************************************************/
+class HCdsFileSystemScanner::Job :
+    public QRunnable
+{
+H_DISABLE_COPY(Job)
+
+private:
+
+    HCdsFileSystemScanner* m_owner;
+    HCdsObjectData* m_folder;
+    bool m_recursive;
+
+public:
+
+    Job(HCdsFileSystemScanner* owner, HCdsObjectData* folder, bool recursive) :
+        m_owner(owner), m_folder(folder), m_recursive(recursive)
+    {
+    }
+
+    virtual ~Job()
+    {
+        delete m_folder;
+    }
+
+    virtual void run();
+};
+
+void HCdsFileSystemScanner::Job::run()
+{
+    HLOG(H_AT, H_FUN);
+
+    QList<HCdsObjectData*> batch;
+    if (m_owner->m_cancelled.fetchAndAddOrdered(0))
+    {
+        m_owner->jobDone(batch);
+        return;
+    }
+
+    QDir dir(m_folder->dataPath());
+    HLOG_DBG(QString("Entering directory %1").arg(dir.absolutePath()));
+
+    HContainer* folder = static_cast<HContainer*>(m_folder->object());
+    QString id = folder->id();
+
+    QList<HCdsObjectData*> subfolders;
+    QStringList childIds;
+    QFileInfoList infoList =
+        dir.entryInfoList(QDir::Files | QDir::AllDirs | QDir::NoDotAndDotDot);
+
+    for(qint32 i = 0; i < infoList.size(); ++i)
+    {
+        QFileInfo finfo = infoList[i];
+        if (finfo.isDir())
+        {
+            if (!m_recursive || QDir(finfo.absoluteFilePath()) == dir)
+            {
+                continue;
+            }
+
+            QDir subdir(finfo.absoluteFilePath());
+            HStorageFolder* subfolder =
+                new HStorageFolder(subdir.dirName(), id);
+
+            subfolders.append(
+                new HCdsObjectData(subfolder, finfo.absoluteFilePath()));
+
+            childIds.append(subfolder->id());
+            continue;
+        }
+
+        HCdsObjectData* child = indexFile(finfo, id);
+        if (child)
+        {
+            batch.append(child);
+            childIds.append(child->object()->id());
+        }
+    }
+
+    folder->setChildIds(childIds);
+
+    // The objects are delivered to the thread of the scanner, which is
+    // why their thread affinity has to be changed while they are still
+    // owned by the thread that created them. The folder of this job was
+    // already moved by the job that created it.
+    QThread* targetThread = m_owner->thread();
+    foreach(HCdsObjectData* data, batch)
+    {
+        data->object()->moveToThread(targetThread);
+    }
+
+    foreach(HCdsObjectData* subfolder, subfolders)
+    {
+        subfolder->object()->moveToThread(targetThread);
+        m_owner->start(subfolder, true);
+    }
+
+    batch.prepend(m_folder);
+    m_folder = 0;
+
+    m_owner->jobDone(batch);
+}
+
+/*******************************************************************************
+ * HCdsFileSystemScanner
+ ******************************************************************************/
+HCdsFileSystemScanner::HCdsFileSystemScanner(
+    const HCdsObjectBatchCallback& callback, qint32 threadCount,
+    QObject* parent) :
+        QObject(parent),
+            m_callback(callback), m_threadPool(), m_batchesMutex(),
+            m_batches(), m_pendingJobs(0), m_cancelled(0)
+{
+    Q_ASSERT(!!m_callback);
+    m_threadPool.setMaxThreadCount(qMax(threadCount, 1));
+}
+
+HCdsFileSystemScanner::~HCdsFileSystemScanner()
+{
+    cancel();
+}
+
+void HCdsFileSystemScanner::start(HCdsObjectData* folder, bool recursive)
+{
+    QMutexLocker locker(&m_batchesMutex);
+    ++m_pendingJobs;
+    locker.unlock();
+
+    m_threadPool.start(new Job(this, folder, recursive));
+}
+
+void HCdsFileSystemScanner::jobDone(const QList<HCdsObjectData*>& batch)
+{
+    QMutexLocker locker(&m_batchesMutex);
+    if (!batch.isEmpty())
+    {
+        m_batches.append(batch);
+    }
+    --m_pendingJobs;
+    locker.unlock();
+
+    // The pending job count is decremented before the delivery is scheduled,
+    // which ensures that the delivery run after the last job sees the count
+    // as zero.
+    bool ok = QMetaObject::invokeMethod(
+        this, "deliverBatches", Qt::QueuedConnection);
+    Q_ASSERT(ok); Q_UNUSED(ok)
+}
+
+void HCdsFileSystemScanner::deliverBatches()
+{
+    QMutexLocker locker(&m_batchesMutex);
+    QList<QList<HCdsObjectData*> > batches = m_batches;
+    m_batches.clear();
+    bool done = !m_pendingJobs && !batches.isEmpty();
+    locker.unlock();
+
+    for(qint32 i = 0; i < batches.size(); ++i)
+    {
+        if (!m_cancelled.fetchAndAddOrdered(0))
+        {
+            m_callback(batches[i]);
+        }
+        qDeleteAll(batches[i]);
+    }
+
+    if (done && !m_cancelled.fetchAndAddOrdered(0))
+    {
+        emit finished();
+    }
+}
+
+bool HCdsFileSystemScanner::scan(
+    const HRootDir& rootDir, const QString& parentId)
+{
+    HLOG(H_AT, H_FUN);
+
+    QDir dir = rootDir.dir();
+    if (!dir.exists())
+    {
+        return false;
+    }
+
+    HStorageFolder* folder = new HStorageFolder(dir.dirName(), parentId);
+    start(
+        new HCdsObjectData(folder, dir.absolutePath()),
+        rootDir.scanMode() == HRootDir::RecursiveScan);
+
+    return true;
+}
+
+void HCdsFileSystemScanner::cancel()
+{
+    m_cancelled.fetchAndStoreOrdered(1);
+    m_threadPool.waitForDone();
+
+    QMutexLocker locker(&m_batchesMutex);
+    for(qint32 i = 0; i < m_batches.size(); ++i)
+    {
+        qDeleteAll(m_batches[i]);
+    }
+    m_batches.clear();
+}
+
+bool HCdsFileSystemScanner::isScanning()
+{
+    QMutexLocker locker(&m_batchesMutex);
+    return m_pendingJobs > 0 || !m_batches.isEmpty();
+}
+
 }
 }
 }
@@ -31,8 +31,16 @@
 //
 
 #include <HUpnpAv/HUpnpAv>
+#include <HUpnpCore/HFunctor>
+
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QObject>
+#include <QtCore/QAtomicInt>
+#include <QtCore/QThreadPool>
 
 class QString;
+class QFileInfo;
 
 namespace Herqq
 {
@@ -67,6 +75,70 @@ public:
     static QString deduceMimeType(const QString& filename);
 
     static HItem* createItem(const QString& filename, const QString& parentId);
+
+    static HCdsObjectData* index(
+        const QFileInfo& file, const QString& parentId);
+};
+
+typedef Functor<void, H_TYPELIST_1(const QList<HCdsObjectData*>&)>
+    HCdsObjectBatchCallback;
+
+//
+// Scans directories concurrently using a thread pool of its own. Each directory
+// is scanned by a job of its own and the objects found in a directory are
+// delivered as a batch to the callback in the thread of the scanner.
+//
+class HCdsFileSystemScanner :
+    public QObject
+{
+Q_OBJECT
+H_DISABLE_COPY(HCdsFileSystemScanner)
+
+private:
+
+    class Job;
+    friend class Job;
+
+    HCdsObjectBatchCallback m_callback;
+
+    QThreadPool m_threadPool;
+
+    QMutex m_batchesMutex;
+    QList<QList<HCdsObjectData*> > m_batches;
+    qint32 m_pendingJobs;
+    // the batches and the number of pending jobs are guarded by m_batchesMutex
+
+    QAtomicInt m_cancelled;
+
+    void start(HCdsObjectData* folder, bool recursive);
+    void jobDone(const QList<HCdsObjectData*>& batch);
+
+private Q_SLOTS:
+
+    void deliverBatches();
+
+public:
+
+    HCdsFileSystemScanner(
+        const HCdsObjectBatchCallback& callback, qint32 threadCount,
+        QObject* parent = 0);
+
+    virtual ~HCdsFileSystemScanner();
+
+    // Starts scanning the specified directory in the background. The folder
+    // representing the directory is always delivered in the first batch.
+    bool scan(const HRootDir&, const QString& parentId);
+
+    // Signals the pending jobs to stop and discards everything that has not
+    // been delivered yet. Blocks until the running jobs have stopped. The
+    // scanner cannot be used to scan anything after this.
+    void cancel();
+
+    bool isScanning();
+
+Q_SIGNALS:
+
+    void finished();
 };
 
 }
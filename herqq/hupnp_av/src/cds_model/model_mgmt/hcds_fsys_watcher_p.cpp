@@ -0,0 +1,114 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hcds_fsys_watcher_p.h"
+
+#include <HUpnpCore/private/hlogger_p.h>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+/*******************************************************************************
+ * HCdsFileSystemWatcher
+ ******************************************************************************/
+HCdsFileSystemWatcher::HCdsFileSystemWatcher(
+    const HDirectoriesChangedCallback& callback, qint32 coalescingMsecs,
+    QObject* parent) :
+        QObject(parent),
+            m_callback(callback), m_watcher(), m_coalescingTimer(),
+            m_changedDirs()
+{
+    Q_ASSERT(!!m_callback);
+
+    m_coalescingTimer.setSingleShot(true);
+    m_coalescingTimer.setInterval(qMax(coalescingMsecs, 0));
+
+    bool ok = connect(
+        &m_watcher, SIGNAL(directoryChanged(QString)),
+        this, SLOT(directoryChanged(QString)));
+    Q_ASSERT(ok);
+
+    ok = connect(
+        &m_coalescingTimer, SIGNAL(timeout()), this, SLOT(coalescingTimeout()));
+    Q_ASSERT(ok); Q_UNUSED(ok)
+}
+
+HCdsFileSystemWatcher::~HCdsFileSystemWatcher()
+{
+}
+
+void HCdsFileSystemWatcher::directoryChanged(const QString& path)
+{
+    m_changedDirs.insert(path);
+
+    // The timer is not restarted on every notification, since a directory that
+    // is modified constantly would otherwise never be reported.
+    if (!m_coalescingTimer.isActive())
+    {
+        m_coalescingTimer.start();
+    }
+}
+
+void HCdsFileSystemWatcher::coalescingTimeout()
+{
+    QStringList changedDirs = m_changedDirs.toList();
+    m_changedDirs.clear();
+
+    m_callback(changedDirs);
+}
+
+bool HCdsFileSystemWatcher::addDir(const QString& path)
+{
+    HLOG(H_AT, H_FUN);
+
+    if (m_watcher.directories().contains(path))
+    {
+        return true;
+    }
+
+    m_watcher.addPath(path);
+    if (!m_watcher.directories().contains(path))
+    {
+        HLOG_WARN(QString("Could not watch directory [%1]").arg(path));
+        return false;
+    }
+
+    return true;
+}
+
+void HCdsFileSystemWatcher::removeDir(const QString& path)
+{
+    if (m_watcher.directories().contains(path))
+    {
+        m_watcher.removePath(path);
+    }
+    m_changedDirs.remove(path);
+}
+
+}
+}
+}
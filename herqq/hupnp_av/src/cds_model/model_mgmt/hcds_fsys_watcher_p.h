@@ -0,0 +1,98 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HCDS_FILESYSTEM_WATCHER_P_H_
+#define HCDS_FILESYSTEM_WATCHER_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include <HUpnpAv/HUpnpAv>
+#include <HUpnpCore/HFunctor>
+
+#include <QtCore/QSet>
+#include <QtCore/QTimer>
+#include <QtCore/QObject>
+#include <QtCore/QStringList>
+#include <QtCore/QFileSystemWatcher>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+typedef Functor<void, H_TYPELIST_1(const QStringList&)>
+    HDirectoriesChangedCallback;
+
+//
+// Watches directories for changes using the native file system notifications
+// and reports the changed directories in batches. The notifications received
+// within the coalescing interval are combined into a single batch, so that
+// copying a set of files into a directory results in a single callback.
+//
+class HCdsFileSystemWatcher :
+    public QObject
+{
+Q_OBJECT
+H_DISABLE_COPY(HCdsFileSystemWatcher)
+
+private:
+
+    HDirectoriesChangedCallback m_callback;
+
+    QFileSystemWatcher m_watcher;
+
+    QTimer m_coalescingTimer;
+
+    QSet<QString> m_changedDirs;
+    // the directories that have changed since the last callback
+
+private Q_SLOTS:
+
+    void directoryChanged(const QString&);
+    void coalescingTimeout();
+
+public:
+
+    HCdsFileSystemWatcher(
+        const HDirectoriesChangedCallback& callback, qint32 coalescingMsecs,
+        QObject* parent = 0);
+
+    virtual ~HCdsFileSystemWatcher();
+
+    bool addDir(const QString& path);
+    void removeDir(const QString& path);
+};
+
+}
+}
+}
+
+#endif /* HCDS_FILESYSTEM_WATCHER_P_H_ */
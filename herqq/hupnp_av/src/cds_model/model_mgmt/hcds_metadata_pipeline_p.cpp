@@ -0,0 +1,294 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hcds_metadata_pipeline_p.h"
+#include "../datasource/hcds_metadata_extractor.h"
+
+#include <HUpnpCore/private/hlogger_p.h>
+
+#include <QtCore/QRunnable>
+#include <QtCore/QMutexLocker>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+namespace
+{
+// The time results are collected before they are delivered, so that the
+// objectModified signals of many items are emitted together.
+const qint32 DeliveryIntervalMsecs = 250;
+}
+
+/*******************************************************************************
+ * HCdsMetadataPipeline::Worker
+ ******************************************************************************/
+class HCdsMetadataPipeline::Worker :
+    public QRunnable
+{
+H_DISABLE_COPY(Worker)
+
+private:
+
+    HCdsMetadataPipeline* m_owner;
+
+public:
+
+    Worker(HCdsMetadataPipeline* owner) : m_owner(owner)
+    {
+    }
+
+    virtual void run();
+};
+
+void HCdsMetadataPipeline::Worker::run()
+{
+    HLOG(H_AT, H_FUN);
+
+    QString objectId;
+    Task task;
+    while(m_owner->takeTask(&objectId, &task))
+    {
+        HCdsMetadataResult result;
+        result.m_objectId = objectId;
+
+        // The extractors are run in the order they were configured and
+        // a property set by an extractor is not overwritten by the ones after.
+        foreach(HCdsMetadataExtractor* extractor, m_owner->m_extractors)
+        {
+            if (!extractor->supports(task.m_contentFormat))
+            {
+                continue;
+            }
+
+            QHash<QString, QVariant> properties;
+            if (extractor->extract(
+                task.m_path, task.m_contentFormat, &properties))
+            {
+                QHash<QString, QVariant>::const_iterator it =
+                    properties.constBegin();
+
+                for(; it != properties.constEnd(); ++it)
+                {
+                    if (!result.m_properties.contains(it.key()))
+                    {
+                        result.m_properties.insert(it.key(), it.value());
+                    }
+                }
+            }
+        }
+
+        if (!result.m_properties.isEmpty())
+        {
+            m_owner->addResult(result);
+        }
+    }
+}
+
+/*******************************************************************************
+ * HCdsMetadataPipeline
+ ******************************************************************************/
+HCdsMetadataPipeline::HCdsMetadataPipeline(
+    const QList<HCdsMetadataExtractor*>& extractors,
+    const HCdsMetadataCallback& callback, qint32 threadCount,
+    QObject* parent) :
+        QObject(parent),
+            m_extractors(extractors), m_callback(callback), m_threadPool(),
+            m_mutex(), m_tasks(), m_urgent(), m_normal(), m_activeWorkers(0),
+            m_results(), m_cancelled(0), m_deliveryTimer()
+{
+    Q_ASSERT(!!m_callback);
+    m_threadPool.setMaxThreadCount(qMax(threadCount, 1));
+
+    m_deliveryTimer.setSingleShot(true);
+    m_deliveryTimer.setInterval(DeliveryIntervalMsecs);
+
+    bool ok = connect(
+        &m_deliveryTimer, SIGNAL(timeout()), this, SLOT(deliverResults()));
+    Q_ASSERT(ok); Q_UNUSED(ok)
+}
+
+HCdsMetadataPipeline::~HCdsMetadataPipeline()
+{
+    cancel();
+}
+
+bool HCdsMetadataPipeline::takeTask(QString* objectId, Task* task)
+{
+    QMutexLocker locker(&m_mutex);
+    while(!m_cancelled.fetchAndAddOrdered(0))
+    {
+        QQueue<QString>* queue =
+            !m_urgent.isEmpty() ? &m_urgent :
+            !m_normal.isEmpty() ? &m_normal : 0;
+
+        if (!queue)
+        {
+            break;
+        }
+
+        *objectId = queue->dequeue();
+        if (m_tasks.contains(*objectId))
+        {
+            *task = m_tasks.take(*objectId);
+            return true;
+        }
+    }
+
+    --m_activeWorkers;
+    return false;
+}
+
+void HCdsMetadataPipeline::addResult(const HCdsMetadataResult& result)
+{
+    QMutexLocker locker(&m_mutex);
+    bool wasEmpty = m_results.isEmpty();
+    m_results.append(result);
+    locker.unlock();
+
+    if (wasEmpty)
+    {
+        bool ok = QMetaObject::invokeMethod(
+            this, "scheduleDelivery", Qt::QueuedConnection);
+        Q_ASSERT(ok); Q_UNUSED(ok)
+    }
+}
+
+void HCdsMetadataPipeline::scheduleDelivery()
+{
+    if (!m_deliveryTimer.isActive())
+    {
+        m_deliveryTimer.start();
+    }
+}
+
+void HCdsMetadataPipeline::deliverResults()
+{
+    QMutexLocker locker(&m_mutex);
+    QList<HCdsMetadataResult> results = m_results;
+    m_results.clear();
+    locker.unlock();
+
+    if (!results.isEmpty() && !m_cancelled.fetchAndAddOrdered(0))
+    {
+        m_callback(results);
+    }
+}
+
+void HCdsMetadataPipeline::enqueue(
+    const QString& objectId, const QString& path, const QString& contentFormat)
+{
+    bool supported = false;
+    foreach(HCdsMetadataExtractor* extractor, m_extractors)
+    {
+        if (extractor->supports(contentFormat))
+        {
+            supported = true;
+            break;
+        }
+    }
+
+    if (!supported)
+    {
+        return;
+    }
+
+    Task task;
+    task.m_path = path;
+    task.m_contentFormat = contentFormat;
+
+    QMutexLocker locker(&m_mutex);
+    if (m_cancelled.fetchAndAddOrdered(0))
+    {
+        return;
+    }
+
+    m_tasks.insert(objectId, task);
+    m_normal.enqueue(objectId);
+
+    if (m_activeWorkers < m_threadPool.maxThreadCount())
+    {
+        ++m_activeWorkers;
+        m_threadPool.start(new Worker(this));
+    }
+}
+
+void HCdsMetadataPipeline::prioritize(const QStringList& objectIds)
+{
+    QMutexLocker locker(&m_mutex);
+    foreach(const QString& objectId, objectIds)
+    {
+        if (m_tasks.contains(objectId))
+        {
+            m_urgent.enqueue(objectId);
+        }
+    }
+}
+
+void HCdsMetadataPipeline::remove(const QString& objectId)
+{
+    QMutexLocker locker(&m_mutex);
+    m_tasks.remove(objectId);
+}
+
+void HCdsMetadataPipeline::remove(const QStringList& objectIds)
+{
+    QMutexLocker locker(&m_mutex);
+    foreach(const QString& objectId, objectIds)
+    {
+        m_tasks.remove(objectId);
+    }
+}
+
+void HCdsMetadataPipeline::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_tasks.clear();
+    m_urgent.clear();
+    m_normal.clear();
+    m_results.clear();
+}
+
+void HCdsMetadataPipeline::cancel()
+{
+    m_cancelled.fetchAndStoreOrdered(1);
+
+    QMutexLocker locker(&m_mutex);
+    m_tasks.clear();
+    m_urgent.clear();
+    m_normal.clear();
+    locker.unlock();
+
+    m_threadPool.waitForDone();
+    m_deliveryTimer.stop();
+
+    locker.relock();
+    m_results.clear();
+}
+
+}
+}
+}
@@ -0,0 +1,157 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HCDS_METADATA_PIPELINE_P_H_
+#define HCDS_METADATA_PIPELINE_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include <HUpnpAv/HUpnpAv>
+#include <HUpnpCore/HFunctor>
+
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QQueue>
+#include <QtCore/QTimer>
+#include <QtCore/QObject>
+#include <QtCore/QVariant>
+#include <QtCore/QAtomicInt>
+#include <QtCore/QStringList>
+#include <QtCore/QThreadPool>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+class HCdsMetadataExtractor;
+
+//
+// The metadata extracted for a single object
+//
+class HCdsMetadataResult
+{
+public:
+
+    QString m_objectId;
+    QHash<QString, QVariant> m_properties;
+};
+
+typedef Functor<void, H_TYPELIST_1(const QList<HCdsMetadataResult>&)>
+    HCdsMetadataCallback;
+
+//
+// Runs the configured metadata extractors for the queued files in a thread pool
+// of its own. The files that are prioritized are handled before the others
+// and the results are delivered to the callback in the thread of the pipeline
+// in batches.
+//
+class HCdsMetadataPipeline :
+    public QObject
+{
+Q_OBJECT
+H_DISABLE_COPY(HCdsMetadataPipeline)
+
+private:
+
+    class Task
+    {
+    public:
+
+        QString m_path;
+        QString m_contentFormat;
+    };
+
+    class Worker;
+    friend class Worker;
+
+    QList<HCdsMetadataExtractor*> m_extractors;
+    HCdsMetadataCallback m_callback;
+
+    QThreadPool m_threadPool;
+
+    QMutex m_mutex;
+    QHash<QString, Task> m_tasks;
+    // key == object id
+    QQueue<QString> m_urgent;
+    QQueue<QString> m_normal;
+    // the ids of the objects that have been prioritized and of the rest.
+    // an id may be in both queues, in which case the one found first wins
+    qint32 m_activeWorkers;
+    QList<HCdsMetadataResult> m_results;
+    // the members above are guarded by m_mutex
+
+    QAtomicInt m_cancelled;
+
+    QTimer m_deliveryTimer;
+
+    bool takeTask(QString* objectId, Task*);
+    void addResult(const HCdsMetadataResult&);
+
+private Q_SLOTS:
+
+    void scheduleDelivery();
+    void deliverResults();
+
+public:
+
+    HCdsMetadataPipeline(
+        const QList<HCdsMetadataExtractor*>& extractors,
+        const HCdsMetadataCallback& callback, qint32 threadCount,
+        QObject* parent = 0);
+
+    virtual ~HCdsMetadataPipeline();
+
+    void enqueue(
+        const QString& objectId, const QString& path,
+        const QString& contentFormat);
+
+    // Moves the specified objects to the front of the queue, if they are
+    // still waiting for their metadata.
+    void prioritize(const QStringList& objectIds);
+
+    void remove(const QString& objectId);
+    void remove(const QStringList& objectIds);
+
+    // Discards the pending work without stopping the pipeline.
+    void clear();
+
+    // Discards the pending work and blocks until the running extractions
+    // have completed.
+    void cancel();
+};
+
+}
+}
+}
+
+#endif /* HCDS_METADATA_PIPELINE_P_H_ */
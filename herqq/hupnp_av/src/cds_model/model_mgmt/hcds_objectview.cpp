@@ -0,0 +1,165 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "hcds_objectview.h"
+#include "hcds_objectview_p.h"
+#include "hcds_dlite_serializer.h"
+
+#include "../cds_objects/hobject.h"
+
+#include <QtCore/QVariant>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+/*******************************************************************************
+ * HCdsObjectViewPrivate
+ ******************************************************************************/
+HCdsObjectViewPrivate::HCdsObjectViewPrivate() :
+    m_document(), m_offset(0), m_length(0), m_isItem(false),
+    m_restricted(false), m_id(), m_parentId(), m_title(), m_clazz(),
+    m_parsed(false), m_object()
+{
+}
+
+HObject* HCdsObjectViewPrivate::parse() const
+{
+    HObjects objects;
+    HCdsDidlLiteSerializer serializer;
+    if (!serializer.serializeFromXml(
+            m_document.mid(m_offset, m_length), &objects,
+            HCdsDidlLiteSerializer::XmlExcerpt) || objects.isEmpty())
+    {
+        qDeleteAll(objects);
+        return 0;
+    }
+
+    HObject* retVal = objects.takeFirst();
+    qDeleteAll(objects);
+
+    return retVal;
+}
+
+/*******************************************************************************
+ * HCdsObjectView
+ ******************************************************************************/
+HCdsObjectView::HCdsObjectView() :
+    h_ptr(new HCdsObjectViewPrivate())
+{
+}
+
+HCdsObjectView::HCdsObjectView(const HCdsObjectView& other) :
+    h_ptr(other.h_ptr)
+{
+    Q_ASSERT(this != &other);
+}
+
+HCdsObjectView& HCdsObjectView::operator=(const HCdsObjectView& other)
+{
+    Q_ASSERT(this != &other);
+    h_ptr = other.h_ptr;
+    return *this;
+}
+
+HCdsObjectView::~HCdsObjectView()
+{
+}
+
+bool HCdsObjectView::isValid() const
+{
+    return h_ptr->m_length > 0;
+}
+
+bool HCdsObjectView::isItem() const
+{
+    return isValid() && h_ptr->m_isItem;
+}
+
+bool HCdsObjectView::isContainer() const
+{
+    return isValid() && !h_ptr->m_isItem;
+}
+
+QString HCdsObjectView::id() const
+{
+    return h_ptr->m_id;
+}
+
+QString HCdsObjectView::parentId() const
+{
+    return h_ptr->m_parentId;
+}
+
+QString HCdsObjectView::title() const
+{
+    return h_ptr->m_title;
+}
+
+QString HCdsObjectView::clazz() const
+{
+    return h_ptr->m_clazz;
+}
+
+bool HCdsObjectView::isRestricted() const
+{
+    return h_ptr->m_restricted;
+}
+
+QString HCdsObjectView::xml() const
+{
+    return h_ptr->m_document.mid(h_ptr->m_offset, h_ptr->m_length);
+}
+
+QVariant HCdsObjectView::property(const QString& name) const
+{
+    if (!h_ptr->m_parsed && isValid())
+    {
+        h_ptr->m_object = QSharedPointer<HObject>(h_ptr->parse());
+        h_ptr->m_parsed = true;
+    }
+
+    QVariant retVal;
+    if (h_ptr->m_object)
+    {
+        h_ptr->m_object->getCdsProperty(name, &retVal);
+    }
+
+    return retVal;
+}
+
+HObject* HCdsObjectView::createObject() const
+{
+    if (h_ptr->m_object)
+    {
+        return h_ptr->m_object->clone();
+    }
+
+    return isValid() ? h_ptr->parse() : 0;
+}
+
+}
+}
+}
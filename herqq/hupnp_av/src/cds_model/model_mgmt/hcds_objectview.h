@@ -0,0 +1,214 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef HCDS_OBJECTVIEW_H_
+#define HCDS_OBJECTVIEW_H_
+
+#include <HUpnpAv/HUpnpAv>
+
+#include <HUpnpCore/HFunctor>
+
+#include <QtCore/QSharedDataPointer>
+
+class QString;
+class QVariant;
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+class HCdsObjectViewPrivate;
+
+/*!
+ * \brief This class is a lightweight, read-only view of a CDS object
+ * serialized in a DIDL-Lite document.
+ *
+ * The most commonly used properties of the object, which are the ID, the ID
+ * of the parent, the title, the class and whether the object is restricted,
+ * are parsed when the view is created. The view retains the DIDL-Lite of the
+ * object and the rest of the properties are parsed only when they are
+ * accessed for the first time.
+ *
+ * \headerfile hcds_objectview.h HCdsObjectView
+ *
+ * \ingroup hupnp_av_cds_om_mgmt
+ *
+ * \remarks This class is not thread-safe.
+ *
+ * \sa HCdsDidlLiteSerializer::serializeFromXml()
+ */
+class H_UPNP_AV_EXPORT HCdsObjectView
+{
+friend class HCdsDidlLiteSerializerPrivate;
+
+private:
+
+    QSharedDataPointer<HCdsObjectViewPrivate> h_ptr;
+
+public:
+
+    /*!
+     * \brief Creates a new, invalid instance.
+     *
+     * \sa isValid()
+     */
+    HCdsObjectView();
+
+    /*!
+     * \brief Copy constructor.
+     *
+     * Creates a copy of \c other.
+     */
+    HCdsObjectView(const HCdsObjectView&);
+
+    /*!
+     * \brief Assignment operator.
+     *
+     * Copies the contents of \c other to this.
+     *
+     * \return a reference to this.
+     */
+    HCdsObjectView& operator=(const HCdsObjectView&);
+
+    /*!
+     * \brief Destroys the instance.
+     */
+    ~HCdsObjectView();
+
+    /*!
+     * \brief Indicates if the object is valid.
+     *
+     * \return \e true in case the object was created from a DIDL-Lite
+     * document.
+     */
+    bool isValid() const;
+
+    /*!
+     * \brief Indicates if the object is an item.
+     *
+     * \return \e true in case the object is an item.
+     */
+    bool isItem() const;
+
+    /*!
+     * \brief Indicates if the object is a container.
+     *
+     * \return \e true in case the object is a container.
+     */
+    bool isContainer() const;
+
+    /*!
+     * \brief Returns the ID of the object.
+     *
+     * \return The ID of the object.
+     */
+    QString id() const;
+
+    /*!
+     * \brief Returns the ID of the parent of the object.
+     *
+     * \return The ID of the parent of the object.
+     */
+    QString parentId() const;
+
+    /*!
+     * \brief Returns the title of the object.
+     *
+     * \return The title of the object.
+     */
+    QString title() const;
+
+    /*!
+     * \brief Returns the class of the object.
+     *
+     * \return The class of the object, such as
+     * <c>object.item.audioItem.musicTrack</c>.
+     */
+    QString clazz() const;
+
+    /*!
+     * \brief Indicates if the object is restricted.
+     *
+     * \return \e true in case the object is restricted.
+     */
+    bool isRestricted() const;
+
+    /*!
+     * \brief Returns the DIDL-Lite of the object.
+     *
+     * \return The DIDL-Lite of the object. This is an XML excerpt that can
+     * be passed to HCdsDidlLiteSerializer::serializeFromXml().
+     */
+    QString xml() const;
+
+    /*!
+     * \brief Returns the value of the specified property.
+     *
+     * The properties of the object are parsed on the first call of
+     * this method.
+     *
+     * \param name specifies the name of the property, such as
+     * <c>upnp:artist</c>.
+     *
+     * \return The value of the specified property. The returned value is
+     * invalid in case the property is not set or the DIDL-Lite of the
+     * object could not be parsed.
+     *
+     * \sa createObject()
+     */
+    QVariant property(const QString& name) const;
+
+    /*!
+     * \brief Creates an HObject of the object.
+     *
+     * \return an HObject of the object, or a null pointer in case the
+     * DIDL-Lite of the object could not be parsed. The ownership of the
+     * returned object is passed to the caller.
+     */
+    HObject* createObject() const;
+};
+
+/*!
+ * This is a type definition for a <em>callable entity</em> that is called
+ * for each object found in a DIDL-Lite document, in the order the objects
+ * appear in the document.
+ *
+ * The callable entity returns \e true to continue parsing the document
+ * and \e false to stop the parsing.
+ *
+ * \headerfile hcds_objectview.h HCdsObjectViewCallback
+ *
+ * \ingroup hupnp_av_cds_om_mgmt
+ *
+ * \sa HCdsDidlLiteSerializer::serializeFromXml()
+ */
+typedef Functor<bool, H_TYPELIST_1(const HCdsObjectView&)>
+    HCdsObjectViewCallback;
+
+}
+}
+}
+
+#endif /* HCDS_OBJECTVIEW_H_ */
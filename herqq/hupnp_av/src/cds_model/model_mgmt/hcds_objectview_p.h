@@ -0,0 +1,86 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef HCDS_OBJECTVIEW_P_H_
+#define HCDS_OBJECTVIEW_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include "hcds_objectview.h"
+
+#include <QtCore/QString>
+#include <QtCore/QSharedData>
+#include <QtCore/QSharedPointer>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+//
+// Implementation details of HCdsObjectView
+//
+class HCdsObjectViewPrivate :
+    public QSharedData
+{
+H_DISABLE_ASSIGN(HCdsObjectViewPrivate)
+
+public:
+
+    QString m_document;
+    // the whole DIDL-Lite document, which is shared by the views of all
+    // the objects in it
+
+    qint32 m_offset;
+    qint32 m_length;
+    // the position of the element of the object in the document
+
+    bool m_isItem;
+    bool m_restricted;
+    QString m_id;
+    QString m_parentId;
+    QString m_title;
+    QString m_clazz;
+
+    mutable bool m_parsed;
+    mutable QSharedPointer<HObject> m_object;
+    // the object parsed on the first access of a property that is not
+    // parsed when the view is created
+
+    HCdsObjectViewPrivate();
+
+    HObject* parse() const;
+};
+
+}
+}
+}
+
+#endif /* HCDS_OBJECTVIEW_P_H_ */
@@ -0,0 +1,89 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "hcds_propertyfilter_p.h"
+#include "hcdsproperty_db.h"
+#include "hcdsproperties.h"
+#include "hcdspropertyinfo.h"
+
+#include <QtCore/QSet>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+/*******************************************************************************
+ * HCdsPropertyFilter
+ ******************************************************************************/
+HCdsPropertyFilter::HCdsPropertyFilter(const QSet<QString>& filter) :
+    m_acceptsAll(filter.contains("*")), m_accepted(), m_attributes()
+{
+    HCdsPropertyDb& db = HCdsPropertyDb::instance();
+
+    if (!m_acceptsAll)
+    {
+        foreach(const QString& name, filter)
+        {
+            // A property that has no identifier is not set in any object.
+            set(&m_accepted, db.propertyId(name));
+        }
+
+        const HCdsProperties& props = HCdsProperties::instance();
+        for (qint32 i = HCdsProperties::undefined + 1;
+             i < HCdsPropertyDb::FirstCustomPropertyId; ++i)
+        {
+            const HCdsPropertyInfo& info =
+                props.get(static_cast<HCdsProperties::Property>(i));
+
+            if (info.propertyFlags() & HCdsPropertyInfo::Mandatory)
+            {
+                set(&m_accepted, i);
+            }
+        }
+    }
+
+    foreach(const QString& name, db.didlLiteDependentProperties())
+    {
+        set(&m_attributes, db.propertyId(name));
+    }
+}
+
+void HCdsPropertyFilter::set(QBitArray* mask, qint32 id)
+{
+    if (id < 0)
+    {
+        return;
+    }
+    else if (id >= mask->size())
+    {
+        mask->resize(id + 1);
+    }
+
+    mask->setBit(id);
+}
+
+}
+}
+}
@@ -0,0 +1,96 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef HCDS_PROPERTYFILTER_P_H_
+#define HCDS_PROPERTYFILTER_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include <HUpnpAv/HUpnpAv>
+
+#include <QtCore/QBitArray>
+
+template<typename T>
+class QSet;
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+//
+// A Browse or Search filter compiled into bit masks over the property
+// identifiers of HCdsPropertyDb. The standard properties that are always
+// serialized, such as @id, @parentID, @restricted and upnp:class, are
+// included in the mask, which is why deciding whether a property of an
+// object is serialized is a single bit test.
+//
+class HCdsPropertyFilter
+{
+private:
+
+    bool m_acceptsAll;
+    // true when the filter contains an asterisk
+
+    QBitArray m_accepted;
+    // the properties named in the filter and the mandatory standard properties
+
+    QBitArray m_attributes;
+    // the properties that are serialized as attributes of the object element
+
+    static inline bool test(const QBitArray& mask, qint32 id)
+    {
+        return id >= 0 && id < mask.size() && mask.testBit(id);
+    }
+
+    static void set(QBitArray* mask, qint32 id);
+
+public:
+
+    explicit HCdsPropertyFilter(const QSet<QString>& filter);
+
+    // returns true when the property is named in the filter, it is
+    // a mandatory standard property or the filter contains an asterisk
+    inline bool accepts(qint32 id) const
+    {
+        return m_acceptsAll || test(m_accepted, id);
+    }
+
+    inline bool isAttribute(qint32 id) const
+    {
+        return test(m_attributes, id);
+    }
+};
+
+}
+}
+}
+
+#endif /* HCDS_PROPERTYFILTER_P_H_ */
@@ -37,11 +37,10 @@
 #include <HUpnpAv/HPrice>
 
 #include <QtCore/QHash>
-#include <QtCore/QMutex>
 #include <QtCore/QVector>
 #include <QtCore/QString>
 #include <QtCore/QVariant>
-#include <QtCore/QMutexLocker>
+#include <QtCore/QAtomicPointer>
 
 namespace Herqq
 {
@@ -52,8 +51,12 @@ namespace Upnp
 namespace Av
 {
 
-HCdsProperties* HCdsProperties::s_instance = 0;
-QMutex* HCdsProperties::s_instanceLock = new QMutex();
+namespace
+{
+// The instance is never modified once it has been created, which is why it
+// is read without locking. It is never deleted.
+QAtomicPointer<HCdsProperties> s_properties(0);
+}
 
 class HCdsPropertiesPrivate
 {
@@ -100,7 +103,7 @@ HCdsProperties::HCdsProperties() :
     h_ptr->insert(obj);
 
     obj = HCdsPropertyInfo::create(
-        "@parentID", HCdsProperties::dlite_id, QVariant::String,
+        "@parentID", HCdsProperties::dlite_parentId, QVariant::String,
         HCdsPropertyInfo::PropertyFlags(HCdsPropertyInfo::Mandatory) | HCdsPropertyInfo::StandardType);
     h_ptr->insert(obj);
 
@@ -494,12 +497,21 @@ HCdsProperties::~HCdsProperties()
 
 const HCdsProperties& HCdsProperties::instance()
 {
-    QMutexLocker locker(s_instanceLock);
-    if (!s_instance)
+    HCdsProperties* retVal = s_properties.fetchAndAddOrdered(0);
+    if (!retVal)
     {
-        s_instance = new HCdsProperties();
+        HCdsProperties* newInstance = new HCdsProperties();
+        if (s_properties.testAndSetOrdered(0, newInstance))
+        {
+            retVal = newInstance;
+        }
+        else
+        {
+            delete newInstance;
+            retVal = s_properties.fetchAndAddOrdered(0);
+        }
     }
-    return *s_instance;
+    return *retVal;
 }
 
 const HCdsPropertyInfo& HCdsProperties::get(Property property) const
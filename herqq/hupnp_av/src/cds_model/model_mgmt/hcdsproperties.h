@@ -24,7 +24,6 @@
 
 #include <HUpnpAv/HUpnpAv>
 
-class QMutex;
 
 namespace Herqq
 {
@@ -54,9 +53,6 @@ private:
 
     HCdsPropertiesPrivate* h_ptr;
 
-    static HCdsProperties* s_instance;
-    static QMutex* s_instanceLock;
-
     HCdsProperties();
    ~HCdsProperties();
 
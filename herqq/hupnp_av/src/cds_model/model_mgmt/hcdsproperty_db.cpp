@@ -48,7 +48,7 @@
 #include <HUpnpCore/HServiceId>
 #include <HUpnpCore/HResourceType>
 
-#include <QtCore/QMutex>
+#include <QtCore/QMutexLocker>
 
 namespace Herqq
 {
@@ -62,16 +62,7 @@ namespace Av
 /*******************************************************************************
  * HCdsPropertyDbPrivate
  ******************************************************************************/
-HCdsPropertyDbPrivate::HCdsPropertyDbPrivate() :
-    m_properties(), m_didlLiteDependentProperties(), m_propertiesLock()
-{
-}
-
-HCdsPropertyDbPrivate::~HCdsPropertyDbPrivate()
-{
-}
-
-void HCdsPropertyDbPrivate::insert(const HCdsProperty& prop)
+void HCdsPropertyTable::insert(const HCdsProperty& prop)
 {
     QString name = prop.info().name();
     m_properties.insert(name, prop);
@@ -81,12 +72,36 @@ void HCdsPropertyDbPrivate::insert(const HCdsProperty& prop)
     }
 }
 
-void HCdsPropertyDbPrivate::remove(const QString& propName)
+void HCdsPropertyTable::remove(const QString& propName)
 {
     m_properties.remove(propName);
     m_didlLiteDependentProperties.remove(propName);
 }
 
+/*******************************************************************************
+ * HCdsPropertyDbPrivate
+ ******************************************************************************/
+HCdsPropertyDbPrivate::HCdsPropertyDbPrivate() :
+    m_table(new HCdsPropertyTable()), m_writeMutex(), m_retiredTables()
+{
+}
+
+HCdsPropertyDbPrivate::~HCdsPropertyDbPrivate()
+{
+    delete m_table.fetchAndStoreOrdered(0);
+    qDeleteAll(m_retiredTables);
+}
+
+void HCdsPropertyDbPrivate::publish(HCdsPropertyTable* next)
+{
+    m_retiredTables.append(m_table.fetchAndStoreOrdered(next));
+}
+
+void HCdsPropertyDbPrivate::insert(const HCdsProperty& prop)
+{
+    m_table.fetchAndAddOrdered(0)->insert(prop);
+}
+
 QString HCdsPropertyDbPrivate::variantAsString(const QVariant& var) const
 {
     QString retVal;
@@ -122,8 +137,9 @@ bool HCdsPropertyDbPrivate::serializeHResourceOut(
     writer.writeStartElement(property);
     writer.writeAttribute("protocolInfo", res.protocolInfo().toString());
 
-    QHash<QString, QString>::const_iterator ci = res.mediaInfo().constBegin();
-    for(; ci != res.mediaInfo().constEnd(); ++ci)
+    QHash<QString, QString> mediaInfo = res.mediaInfo();
+    QHash<QString, QString>::const_iterator ci = mediaInfo.constBegin();
+    for(; ci != mediaInfo.constEnd(); ++ci)
     {
         writer.writeAttribute(ci.key(), ci.value());
     }
@@ -1608,8 +1624,12 @@ void HCdsPropertyDbPrivate::init()
 /*******************************************************************************
  * HCdsPropertyDb
  ******************************************************************************/
-HCdsPropertyDb* HCdsPropertyDb::s_instance = 0;
-QMutex* HCdsPropertyDb::s_instanceLock = new QMutex();
+namespace
+{
+// The database is never deleted, since it may be used during the destruction
+// of static objects.
+QAtomicPointer<HCdsPropertyDb> s_db(0);
+}
 
 HCdsPropertyDb::HCdsPropertyDb() :
     h_ptr(new HCdsPropertyDbPrivate())
@@ -1624,50 +1644,115 @@ HCdsPropertyDb::~HCdsPropertyDb()
 
 HCdsPropertyDb& HCdsPropertyDb::instance()
 {
-    QMutexLocker locker(s_instanceLock);
-    if (!s_instance)
+    HCdsPropertyDb* retVal = s_db.fetchAndAddOrdered(0);
+    if (!retVal)
     {
-        s_instance = new HCdsPropertyDb();
+        HCdsPropertyDb* newInstance = new HCdsPropertyDb();
+        if (s_db.testAndSetOrdered(0, newInstance))
+        {
+            retVal = newInstance;
+        }
+        else
+        {
+            delete newInstance;
+            retVal = s_db.fetchAndAddOrdered(0);
+        }
     }
 
-    return *s_instance;
+    return *retVal;
 }
 
 HCdsProperty HCdsPropertyDb::property(const QString& property) const
 {
-    QReadLocker locker(&h_ptr->m_propertiesLock);
-    return h_ptr->m_properties.value(property);
+    return h_ptr->table()->m_properties.value(property);
+}
+
+qint32 HCdsPropertyDb::propertyId(const QString& name) const
+{
+    const HCdsPropertyInfo& info = HCdsProperties::instance().get(name);
+    if (info.isValid() && info.type() != HCdsProperties::undefined)
+    {
+        return info.type();
+    }
+
+    return h_ptr->table()->m_customPropertyIds.value(name, -1);
+}
+
+qint32 HCdsPropertyDb::registerPropertyId(const QString& name)
+{
+    qint32 retVal = propertyId(name);
+    if (retVal >= 0)
+    {
+        return retVal;
+    }
+
+    QMutexLocker locker(&h_ptr->m_writeMutex);
+    const HCdsPropertyTable* current = h_ptr->table();
+    retVal = current->m_customPropertyIds.value(name, -1);
+    if (retVal < 0)
+    {
+        retVal = FirstCustomPropertyId + current->m_customPropertyNames.size();
+        if (retVal > MaxPropertyId)
+        {
+            Q_ASSERT_X(false, "", "Too many custom CDS properties");
+            return -1;
+        }
+
+        HCdsPropertyTable* next = new HCdsPropertyTable(*current);
+        next->m_customPropertyNames.append(name);
+        next->m_customPropertyIds.insert(name, retVal);
+        h_ptr->publish(next);
+    }
+
+    return retVal;
+}
+
+QString HCdsPropertyDb::propertyName(qint32 id) const
+{
+    if (id >= 0 && id < FirstCustomPropertyId)
+    {
+        return HCdsProperties::instance().get(
+            static_cast<HCdsProperties::Property>(id)).name();
+    }
+
+    return h_ptr->table()->m_customPropertyNames.value(
+        id - FirstCustomPropertyId);
 }
 
 QSet<QString> HCdsPropertyDb::didlLiteDependentProperties() const
 {
-    QReadLocker locker(&h_ptr->m_propertiesLock);
-    return h_ptr->m_didlLiteDependentProperties;
+    return h_ptr->table()->m_didlLiteDependentProperties;
 }
 
 bool HCdsPropertyDb::registerProperty(const HCdsProperty& property)
 {
-    QWriteLocker locker(&h_ptr->m_propertiesLock);
-    if (h_ptr->m_properties.contains(property.info().name()))
+    QMutexLocker locker(&h_ptr->m_writeMutex);
+    const HCdsPropertyTable* current = h_ptr->table();
+    if (current->m_properties.contains(property.info().name()))
     {
         return false;
     }
 
-    h_ptr->insert(property);
+    HCdsPropertyTable* next = new HCdsPropertyTable(*current);
+    next->insert(property);
+    h_ptr->publish(next);
     return true;
 }
 
 bool HCdsPropertyDb::unregisterProperty(const QString& name)
 {
-    QWriteLocker locker(&h_ptr->m_propertiesLock);
-    if (!h_ptr->m_properties.contains(name) ||
-        h_ptr->m_properties.value(name).info().propertyFlags() &
+    QMutexLocker locker(&h_ptr->m_writeMutex);
+    const HCdsPropertyTable* current = h_ptr->table();
+    if (!current->m_properties.contains(name) ||
+        current->m_properties.value(name).info().propertyFlags() &
         HCdsPropertyInfo::StandardType)
     {
         return false;
     }
 
-    h_ptr->remove(name);
+    HCdsPropertyTable* next = new HCdsPropertyTable(*current);
+    next->remove(name);
+    h_ptr->publish(next);
     return true;
 }
 
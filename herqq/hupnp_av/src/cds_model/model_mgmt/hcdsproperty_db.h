@@ -22,9 +22,8 @@
 #ifndef HCDSPROPERTY_DB_H_
 #define HCDSPROPERTY_DB_H_
 
-#include <HUpnpAv/HUpnpAv>
+#include <HUpnpAv/HCdsProperties>
 
-class QMutex;
 
 namespace Herqq
 {
@@ -46,7 +45,11 @@ class HCdsPropertyDbPrivate;
  *
  * \ingroup hupnp_av_cds_om_mgmt
  *
- * \remarks This class \b is thread-safe.
+ * \remarks This class \b is thread-safe. The lookups do not lock, which
+ * makes them cheap enough for serializing and sorting large numbers of
+ * objects in several threads at once. Registering a property or a property
+ * identifier copies the tables of the database, which is why the
+ * registrations should be done at startup.
  */
 class H_UPNP_AV_EXPORT HCdsPropertyDb
 {
@@ -56,9 +59,6 @@ private:
 
     HCdsPropertyDbPrivate* h_ptr;
 
-    static HCdsPropertyDb* s_instance;
-    static QMutex* s_instanceLock;
-
     HCdsPropertyDb();
     ~HCdsPropertyDb();
 
@@ -107,6 +107,65 @@ public:
      * namespace.
      */
     QSet<QString> didlLiteDependentProperties() const;
+
+    /*!
+     * \brief This enumeration specifies the range of property identifiers.
+     */
+    enum PropertyIdRange
+    {
+        /*!
+         * The first identifier assigned to a property that is not defined
+         * in HCdsProperties. The identifiers of the properties defined in
+         * HCdsProperties are the values of HCdsProperties::Property.
+         */
+        FirstCustomPropertyId = HCdsProperties::dlite_desc + 1,
+
+        /*!
+         * The largest identifier that is assigned to a property.
+         */
+        MaxPropertyId = 0xffff
+    };
+
+    /*!
+     * \brief Returns the identifier of the specified property, if any.
+     *
+     * Property identifiers are small integers that enable CDS objects to
+     * refer to their properties without storing the property names.
+     * The identifiers are valid only within the process.
+     *
+     * \param name specifies the name of the CDS property.
+     *
+     * \return the identifier of the specified property, or -1 in case no
+     * identifier has been assigned to the specified name.
+     *
+     * \sa registerPropertyId(), propertyName()
+     */
+    qint32 propertyId(const QString& name) const;
+
+    /*!
+     * \brief Returns the identifier of the specified property and assigns
+     * a new one if necessary.
+     *
+     * \param name specifies the name of the CDS property.
+     *
+     * \return the identifier of the specified property, or -1 in case all
+     * the identifiers are in use.
+     *
+     * \sa propertyId(), propertyName()
+     */
+    qint32 registerPropertyId(const QString& name);
+
+    /*!
+     * \brief Returns the name of the property with the specified identifier.
+     *
+     * \param id specifies the identifier of the CDS property.
+     *
+     * \return the name of the property that has the specified identifier or
+     * an empty string in case no such property exists.
+     *
+     * \sa propertyId()
+     */
+    QString propertyName(qint32 id) const;
 };
 
 }
@@ -45,8 +45,10 @@
 #include <QtCore/QString>
 #include <QtCore/QVariant>
 #include <QtCore/QDateTime>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
 #include <QtCore/QStringList>
-#include <QtCore/QReadWriteLock>
+#include <QtCore/QAtomicPointer>
 #include <QtCore/QXmlStreamReader>
 #include <QtCore/QXmlStreamWriter>
 
@@ -59,6 +61,29 @@ namespace Upnp
 namespace Av
 {
 
+//
+// The contents of HCdsPropertyDb. A table is never modified once it has been
+// published, which is why it is read without locking. A registration
+// publishes a modified copy of the table, which shares the unmodified
+// containers with the original.
+//
+class HCdsPropertyTable
+{
+public:
+
+    QHash<QString, HCdsProperty> m_properties;
+    QSet<QString> m_didlLiteDependentProperties;
+
+    QHash<QString, qint32> m_customPropertyIds;
+    QStringList m_customPropertyNames;
+    // the identifiers assigned to property names that are not defined in
+    // HCdsProperties. The names are never removed, since objects may
+    // refer to the identifiers after a property is unregistered.
+
+    void insert(const HCdsProperty& prop);
+    void remove(const QString& propName);
+};
+
 //
 //
 //
@@ -68,12 +93,25 @@ H_DISABLE_COPY(HCdsPropertyDbPrivate)
 
 public:
 
-    QHash<QString, HCdsProperty> m_properties;
-    QSet<QString> m_didlLiteDependentProperties;
-    QReadWriteLock m_propertiesLock;
+    QAtomicPointer<HCdsPropertyTable> m_table;
+    // the published table
 
+    QMutex m_writeMutex;
+    QList<HCdsPropertyTable*> m_retiredTables;
+    // serializes the registrations and keeps the tables they have replaced
+    // until the database is destroyed, since readers may still be using them
+
+    inline const HCdsPropertyTable* table()
+    {
+        return m_table.fetchAndAddOrdered(0);
+    }
+
+    // replaces the published table. must be called with m_writeMutex locked
+    void publish(HCdsPropertyTable* next);
+
+    // adds the property to the table that is not published yet. used only
+    // by init()
     void insert(const HCdsProperty& prop);
-    void remove(const QString& propName);
     QString variantAsString(const QVariant& var) const;
 
     bool serializeHResourceOut      (const QString&, const QVariant&, QXmlStreamWriter&) const;
@@ -1,6 +1,7 @@
 
 HEADERS += \
     $$SRC_LOC/common/hprotocolinfo.h \
+    $$SRC_LOC/common/hprotocolinfo_matcher.h \
     $$SRC_LOC/common/hstoragemedium.h \
     $$SRC_LOC/common/hresource.h \
     $$SRC_LOC/common/hrating.h \
@@ -8,6 +9,7 @@ HEADERS += \
 
 SOURCES += \
     $$SRC_LOC/common/hprotocolinfo.cpp \
+    $$SRC_LOC/common/hprotocolinfo_matcher.cpp \
     $$SRC_LOC/common/hstoragemedium.cpp \
     $$SRC_LOC/common/hresource.cpp \
     $$SRC_LOC/common/hrating.cpp \
@@ -22,7 +22,6 @@
 #include "hprotocolinfo.h"
 
 #include <QtCore/QString>
-#include <QtCore/QStringList>
 
 namespace Herqq
 {
@@ -45,8 +44,13 @@ public:
 
     QString m_protocol, m_network, m_contentFormat, m_additionalInfo;
 
+    mutable QString m_dlnaProfile;
+    mutable bool m_dlnaProfileParsed;
+    // DLNA.ORG_PN is parsed from m_additionalInfo when it is first asked for
+
     HProtocolInfoPrivate() :
-        m_protocol(), m_network(), m_contentFormat(), m_additionalInfo()
+        m_protocol(), m_network(), m_contentFormat(), m_additionalInfo(),
+        m_dlnaProfile(), m_dlnaProfileParsed(false)
     {
     }
 };
@@ -62,16 +66,18 @@ HProtocolInfo::HProtocolInfo() :
 HProtocolInfo::HProtocolInfo(const QString& arg) :
     h_ptr(new HProtocolInfoPrivate())
 {
-    QStringList tmp = arg.split(":");
-    if (tmp.size() != 4)
+    int first = arg.indexOf(':');
+    int second = first < 0 ? -1 : arg.indexOf(':', first + 1);
+    int third = second < 0 ? -1 : arg.indexOf(':', second + 1);
+    if (third < 0 || arg.indexOf(':', third + 1) >= 0)
     {
         return;
     }
 
-    setProtocol(tmp[0]);
-    setNetwork(tmp[1]);
-    setContentFormat(tmp[2]);
-    setAdditionalInfo(tmp[3]);
+    h_ptr->m_protocol = arg.left(first).trimmed();
+    h_ptr->m_network = arg.mid(first + 1, second - first - 1).trimmed();
+    h_ptr->m_contentFormat = arg.mid(second + 1, third - second - 1).trimmed();
+    h_ptr->m_additionalInfo = arg.mid(third + 1).trimmed();
 }
 
 HProtocolInfo::HProtocolInfo(
@@ -122,6 +128,24 @@ QString HProtocolInfo::additionalInfo() const
     return h_ptr->m_additionalInfo;
 }
 
+QString HProtocolInfo::dlnaProfile() const
+{
+    if (!h_ptr->m_dlnaProfileParsed)
+    {
+        const QString& info = h_ptr->m_additionalInfo;
+        int index = info.indexOf("DLNA.ORG_PN=", 0, Qt::CaseInsensitive);
+        if (index == 0 || (index > 0 && info.at(index - 1) == ';'))
+        {
+            index += 12;
+            int end = info.indexOf(';', index);
+            h_ptr->m_dlnaProfile =
+                info.mid(index, end < 0 ? -1 : end - index).trimmed();
+        }
+        h_ptr->m_dlnaProfileParsed = true;
+    }
+    return h_ptr->m_dlnaProfile;
+}
+
 void HProtocolInfo::setProtocol(const QString& arg)
 {
     if (!arg.contains(':'))
@@ -151,6 +175,8 @@ void HProtocolInfo::setAdditionalInfo(const QString& arg)
     if (!arg.contains(':'))
     {
         h_ptr->m_additionalInfo = arg.trimmed();
+        h_ptr->m_dlnaProfile.clear();
+        h_ptr->m_dlnaProfileParsed = false;
     }
 }
 
@@ -170,6 +170,21 @@ public:
      */
     QString additionalInfo() const;
 
+    /*!
+     * \brief Returns the DLNA media format profile specified in the
+     * additional information element.
+     *
+     * \return The value of the \c DLNA.ORG_PN parameter of the additional
+     * information element, or an empty string in case the parameter
+     * is not specified.
+     *
+     * \remarks The parameter is parsed only once per value of the additional
+     * information element.
+     *
+     * \sa additionalInfo()
+     */
+    QString dlnaProfile() const;
+
     /*!
      * \brief Sets the transport protocol.
      *
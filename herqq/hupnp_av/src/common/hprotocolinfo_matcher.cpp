@@ -0,0 +1,281 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hprotocolinfo_matcher.h"
+#include "hprotocolinfo.h"
+#include "hresource.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QVector>
+#include <QtCore/QString>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+namespace
+{
+enum
+{
+    WildcardFormatRank = 1,
+    MajorTypeRank = 2,
+    ContentFormatRank = 4,
+    DlnaProfileRank = 8
+};
+
+// Returns the MIME type of a content format in lower case and without
+// the parameters, e.g. "audio/L16;rate=44100" -> "audio/l16".
+QString normalizedFormat(const QString& contentFormat)
+{
+    int index = contentFormat.indexOf(';');
+    return (index < 0 ? contentFormat : contentFormat.left(index)).
+        trimmed().toLower();
+}
+
+bool elementMatches(const QString& sink, const QString& source)
+{
+    return sink == "*" || source == "*" || sink == source;
+}
+}
+
+/*******************************************************************************
+ * HProtocolInfoMatcherPrivate
+ ******************************************************************************/
+class HProtocolInfoMatcherPrivate :
+    public QSharedData
+{
+H_DISABLE_ASSIGN(HProtocolInfoMatcherPrivate)
+
+public:
+
+    struct Entry
+    {
+        QString m_protocol;
+        QString m_network;
+        QString m_dlnaProfile;
+        qint32 m_rank;
+        // the rank the content format of the entry gives to a match
+    };
+
+    HProtocolInfos m_sinkProtocolInfos;
+
+    QHash<QString, QVector<Entry> > m_byFormat;
+    // key == normalized content format, e.g. "audio/mpeg"
+
+    QHash<QString, QVector<Entry> > m_byMajorType;
+    // for the entries of the form "type/*", key == "type"
+
+    QVector<Entry> m_wildcards;
+    // the entries whose content format is "*"
+
+    HProtocolInfoMatcherPrivate() :
+        m_sinkProtocolInfos(), m_byFormat(), m_byMajorType(), m_wildcards()
+    {
+    }
+
+    void index(const HProtocolInfos& sinkProtocolInfos)
+    {
+        m_sinkProtocolInfos.clear();
+        m_byFormat.clear();
+        m_byMajorType.clear();
+        m_wildcards.clear();
+
+        foreach(const HProtocolInfo& pinfo, sinkProtocolInfos)
+        {
+            if (!pinfo.isValid())
+            {
+                continue;
+            }
+
+            m_sinkProtocolInfos.append(pinfo);
+
+            Entry entry;
+            entry.m_protocol = pinfo.protocol();
+            entry.m_network = pinfo.network();
+            entry.m_dlnaProfile = pinfo.dlnaProfile();
+
+            QString format = normalizedFormat(pinfo.contentFormat());
+            if (format == "*")
+            {
+                entry.m_rank = WildcardFormatRank;
+                m_wildcards.append(entry);
+            }
+            else if (format.endsWith("/*"))
+            {
+                entry.m_rank = MajorTypeRank;
+                m_byMajorType[format.left(format.size() - 2)].append(entry);
+            }
+            else
+            {
+                entry.m_rank = ContentFormatRank;
+                m_byFormat[format].append(entry);
+            }
+        }
+    }
+
+    static qint32 rank(
+        const QVector<Entry>& entries, const HProtocolInfo& pinfo,
+        const QString& dlnaProfile, qint32 best)
+    {
+        foreach(const Entry& entry, entries)
+        {
+            if (!elementMatches(entry.m_protocol, pinfo.protocol()) ||
+                !elementMatches(entry.m_network, pinfo.network()))
+            {
+                continue;
+            }
+
+            qint32 rank = entry.m_rank;
+            if (!entry.m_dlnaProfile.isEmpty() && !dlnaProfile.isEmpty())
+            {
+                if (entry.m_dlnaProfile.compare(
+                        dlnaProfile, Qt::CaseInsensitive) != 0)
+                {
+                    continue;
+                }
+                rank += DlnaProfileRank;
+            }
+
+            if (rank > best)
+            {
+                best = rank;
+            }
+        }
+        return best;
+    }
+};
+
+/*******************************************************************************
+ * HProtocolInfoMatcher
+ ******************************************************************************/
+HProtocolInfoMatcher::HProtocolInfoMatcher() :
+    h_ptr(new HProtocolInfoMatcherPrivate())
+{
+}
+
+HProtocolInfoMatcher::HProtocolInfoMatcher(
+    const HProtocolInfos& sinkProtocolInfos) :
+        h_ptr(new HProtocolInfoMatcherPrivate())
+{
+    h_ptr->index(sinkProtocolInfos);
+}
+
+HProtocolInfoMatcher::~HProtocolInfoMatcher()
+{
+}
+
+HProtocolInfoMatcher::HProtocolInfoMatcher(const HProtocolInfoMatcher& other) :
+    h_ptr(other.h_ptr)
+{
+    Q_ASSERT(this != &other);
+}
+
+HProtocolInfoMatcher& HProtocolInfoMatcher::operator=(
+    const HProtocolInfoMatcher& other)
+{
+    Q_ASSERT(this != &other);
+    h_ptr = other.h_ptr;
+    return *this;
+}
+
+void HProtocolInfoMatcher::setSinkProtocolInfos(const HProtocolInfos& arg)
+{
+    h_ptr->index(arg);
+}
+
+HProtocolInfos HProtocolInfoMatcher::sinkProtocolInfos() const
+{
+    return h_ptr->m_sinkProtocolInfos;
+}
+
+bool HProtocolInfoMatcher::isCompatible(const HProtocolInfo& arg) const
+{
+    return rank(arg) >= 0;
+}
+
+qint32 HProtocolInfoMatcher::rank(const HProtocolInfo& arg) const
+{
+    if (!arg.isValid())
+    {
+        return -1;
+    }
+
+    typedef HProtocolInfoMatcherPrivate::Entry Entry;
+
+    QString format = normalizedFormat(arg.contentFormat());
+    QString dlnaProfile = arg.dlnaProfile();
+
+    qint32 retVal = -1;
+    if (format == "*")
+    {
+        // A wild-card source matches every sink entry on the content format.
+        foreach(const QVector<Entry>& entries, h_ptr->m_byFormat)
+        {
+            retVal = HProtocolInfoMatcherPrivate::rank(
+                entries, arg, dlnaProfile, retVal);
+        }
+        foreach(const QVector<Entry>& entries, h_ptr->m_byMajorType)
+        {
+            retVal = HProtocolInfoMatcherPrivate::rank(
+                entries, arg, dlnaProfile, retVal);
+        }
+    }
+    else
+    {
+        retVal = HProtocolInfoMatcherPrivate::rank(
+            h_ptr->m_byFormat.value(format), arg, dlnaProfile, retVal);
+
+        int index = format.indexOf('/');
+        if (index > 0)
+        {
+            retVal = HProtocolInfoMatcherPrivate::rank(
+                h_ptr->m_byMajorType.value(format.left(index)), arg,
+                dlnaProfile, retVal);
+        }
+    }
+
+    return HProtocolInfoMatcherPrivate::rank(
+        h_ptr->m_wildcards, arg, dlnaProfile, retVal);
+}
+
+qint32 HProtocolInfoMatcher::bestMatch(const HResources& resources) const
+{
+    qint32 retVal = -1, best = -1;
+    for(qint32 i = 0; i < resources.size(); ++i)
+    {
+        qint32 rank = this->rank(resources.at(i).protocolInfo());
+        if (rank > best)
+        {
+            best = rank;
+            retVal = i;
+        }
+    }
+    return retVal;
+}
+
+}
+}
+}
@@ -0,0 +1,174 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HPROTOCOLINFO_MATCHER_H_
+#define HPROTOCOLINFO_MATCHER_H_
+
+#include <HUpnpAv/HUpnpAv>
+#include <QtCore/QSharedDataPointer>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+class HProtocolInfoMatcherPrivate;
+
+/*!
+ * \brief This class is used to match \e ProtocolInfo values against the
+ * \e ProtocolInfo values of a sink.
+ *
+ * The sink \e ProtocolInfo values are parsed and indexed by content format
+ * once, when they are set. After that checking the compatibility of a
+ * \e ProtocolInfo or finding the best match from a list of resources requires
+ * only a lookup of the content format and a comparison of the few sink entries
+ * that share it.
+ *
+ * A \e ProtocolInfo is compatible with a sink entry when:
+ * - the protocols are equal or either of them is a wild-card "*",
+ * - the networks are equal or either of them is a wild-card "*",
+ * - the content format of the sink entry is equal to the content format
+ * of the \e ProtocolInfo, it is of the form <tt>type/</tt>* and the
+ * major types are equal or it is a wild-card "*" and
+ * - if both specify a DLNA media format profile, the profiles are equal.
+ *
+ * \headerfile hprotocolinfo_matcher.h HProtocolInfoMatcher
+ *
+ * \ingroup hupnp_av_common
+ *
+ * \remarks This class is not thread-safe.
+ *
+ * \sa HProtocolInfo
+ */
+class H_UPNP_AV_EXPORT HProtocolInfoMatcher
+{
+private:
+
+    QSharedDataPointer<HProtocolInfoMatcherPrivate> h_ptr;
+
+public:
+
+    /*!
+     * \brief Creates a new instance that has no sink \e ProtocolInfo values.
+     *
+     * \sa setSinkProtocolInfos()
+     */
+    HProtocolInfoMatcher();
+
+    /*!
+     * \brief Creates a new instance.
+     *
+     * \param sinkProtocolInfos specifies the \e ProtocolInfo values of the
+     * sink to match against.
+     */
+    HProtocolInfoMatcher(const HProtocolInfos& sinkProtocolInfos);
+
+    /*!
+     * \brief Destroys the instance.
+     */
+    ~HProtocolInfoMatcher();
+
+    /*!
+     * \brief Copy constructor.
+     *
+     * Creates a copy of \c other.
+     */
+    HProtocolInfoMatcher(const HProtocolInfoMatcher&);
+
+    /*!
+     * \brief Assignment operator.
+     *
+     * Copies the contents of \c other to this.
+     */
+    HProtocolInfoMatcher& operator=(const HProtocolInfoMatcher&);
+
+    /*!
+     * \brief Specifies the \e ProtocolInfo values of the sink.
+     *
+     * \param arg specifies the \e ProtocolInfo values of the sink. Invalid
+     * values are ignored.
+     *
+     * \sa sinkProtocolInfos()
+     */
+    void setSinkProtocolInfos(const HProtocolInfos& arg);
+
+    /*!
+     * \brief Returns the \e ProtocolInfo values of the sink.
+     *
+     * \return The \e ProtocolInfo values of the sink.
+     *
+     * \sa setSinkProtocolInfos()
+     */
+    HProtocolInfos sinkProtocolInfos() const;
+
+    /*!
+     * \brief Indicates if the specified \e ProtocolInfo is compatible with
+     * any of the \e ProtocolInfo values of the sink.
+     *
+     * \param arg specifies the \e ProtocolInfo to check.
+     *
+     * \return \e true in case the specified \e ProtocolInfo is compatible
+     * with the sink.
+     *
+     * \sa rank()
+     */
+    bool isCompatible(const HProtocolInfo& arg) const;
+
+    /*!
+     * \brief Ranks the specified \e ProtocolInfo against the \e ProtocolInfo
+     * values of the sink.
+     *
+     * \param arg specifies the \e ProtocolInfo to rank.
+     *
+     * \return A non-negative value designating how well the specified
+     * \e ProtocolInfo matches the sink, the higher the better, or -1 in case
+     * the \e ProtocolInfo is not compatible with the sink. A match that
+     * agrees on the DLNA media format profile ranks higher than a match on
+     * the content format alone and an exact content format ranks higher than
+     * a wild-card.
+     *
+     * \sa isCompatible(), bestMatch()
+     */
+    qint32 rank(const HProtocolInfo& arg) const;
+
+    /*!
+     * \brief Returns the index of the resource that matches the sink best.
+     *
+     * \param resources specifies the resources to choose from.
+     *
+     * \return The index of the resource that has the highest rank or -1 in
+     * case none of the resources is compatible with the sink. In case several
+     * resources rank the same, the first one of them is returned.
+     *
+     * \sa rank()
+     */
+    qint32 bestMatch(const HResources& resources) const;
+};
+
+}
+}
+}
+
+#endif /* HPROTOCOLINFO_MATCHER_H_ */
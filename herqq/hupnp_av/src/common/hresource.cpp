@@ -22,8 +22,12 @@
 #include "hresource.h"
 #include "hprotocolinfo.h"
 
+#include <QtCore/QSet>
 #include <QtCore/QUrl>
 #include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QByteArray>
+#include <QtCore/QtAlgorithms>
 
 namespace Herqq
 {
@@ -34,6 +38,76 @@ namespace Upnp
 namespace Av
 {
 
+static QHash<QString, HProtocolInfo> s_internedProtocolInfos;
+static QSet<QByteArray> s_internedLocationBases;
+static QMutex s_internedValuesMutex;
+
+namespace
+{
+const char* const NumericAttributeNames[] =
+{
+    "size",
+    "bitrate",
+    "sampleFrequency",
+    "bitsPerSample",
+    "nrAudioChannels",
+    "colorDepth"
+};
+
+enum
+{
+    NumericAttributeCount =
+        sizeof(NumericAttributeNames) / sizeof(NumericAttributeNames[0])
+};
+
+HProtocolInfo intern(const HProtocolInfo& arg)
+{
+    if (!arg.isValid())
+    {
+        return arg;
+    }
+
+    QString key = arg.toString();
+
+    QMutexLocker locker(&s_internedValuesMutex);
+    QHash<QString, HProtocolInfo>::const_iterator ci =
+        s_internedProtocolInfos.constFind(key);
+    if (ci != s_internedProtocolInfos.constEnd())
+    {
+        return ci.value();
+    }
+
+    // The shared instance may be read from several threads, so the lazily
+    // parsed DLNA profile is parsed before the instance is published.
+    arg.dlnaProfile();
+    s_internedProtocolInfos.insert(key, arg);
+    return arg;
+}
+
+QByteArray intern(const QByteArray& arg)
+{
+    if (arg.isEmpty())
+    {
+        return arg;
+    }
+
+    QMutexLocker locker(&s_internedValuesMutex);
+    return *s_internedLocationBases.insert(arg);
+}
+
+qint32 numericAttribute(const QString& name)
+{
+    for(qint32 i = 0; i < NumericAttributeCount; ++i)
+    {
+        if (name == QLatin1String(NumericAttributeNames[i]))
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+}
+
 /*******************************************************************************
  * HResourcePrivate
  ******************************************************************************/
@@ -42,19 +116,123 @@ class HResourcePrivate :
 {
 public:
 
-    QHash<QString, QString> m_mediaInfo;
-    QUrl m_location;
+    QByteArray m_locationBase;
+    // the encoded location up to and including the last '/' of it,
+    // shared by all the resources that are located in the same directory
+
+    QByteArray m_locationSuffix;
+    // the rest of the encoded location
+
     HProtocolInfo m_protocolInfo;
+    // interned, so that all the resources that have the same protocol info
+    // share the same instance
+
+    qint64 m_numericInfo[NumericAttributeCount];
+    // indexed by HResource::NumericAttribute, -1 == the attribute is not set
+
+    QString m_duration, m_resolution;
+    QHash<QString, QString> m_otherInfo;
+    // the media information that is not stored in the members above
+
     quint32 m_updateCount;
     bool m_trackChangesOptionEnabled;
 
     HResourcePrivate();
+
+    QUrl location() const;
+    void setLocation(const QUrl&);
+
+    QHash<QString, QString> mediaInfo() const;
+    void setMediaInfo(const QHash<QString, QString>&);
 };
 
 HResourcePrivate::HResourcePrivate() :
-    m_mediaInfo(), m_location(), m_protocolInfo(), m_updateCount(0),
+    m_locationBase(), m_locationSuffix(), m_protocolInfo(), m_duration(),
+    m_resolution(), m_otherInfo(), m_updateCount(0),
     m_trackChangesOptionEnabled(false)
 {
+    qFill(m_numericInfo, m_numericInfo + NumericAttributeCount, -1);
+}
+
+QUrl HResourcePrivate::location() const
+{
+    if (m_locationSuffix.isEmpty())
+    {
+        return QUrl::fromEncoded(m_locationBase);
+    }
+    return QUrl::fromEncoded(m_locationBase + m_locationSuffix);
+}
+
+void HResourcePrivate::setLocation(const QUrl& arg)
+{
+    QByteArray encoded = arg.toEncoded();
+
+    qint32 index = encoded.lastIndexOf('/') + 1;
+    m_locationBase = intern(encoded.left(index));
+    m_locationSuffix = encoded.mid(index);
+}
+
+QHash<QString, QString> HResourcePrivate::mediaInfo() const
+{
+    QHash<QString, QString> retVal = m_otherInfo;
+    for(qint32 i = 0; i < NumericAttributeCount; ++i)
+    {
+        if (m_numericInfo[i] >= 0)
+        {
+            retVal.insert(
+                QLatin1String(NumericAttributeNames[i]),
+                QString::number(m_numericInfo[i]));
+        }
+    }
+    if (!m_duration.isEmpty())
+    {
+        retVal.insert("duration", m_duration);
+    }
+    if (!m_resolution.isEmpty())
+    {
+        retVal.insert("resolution", m_resolution);
+    }
+    return retVal;
+}
+
+void HResourcePrivate::setMediaInfo(const QHash<QString, QString>& arg)
+{
+    qFill(m_numericInfo, m_numericInfo + NumericAttributeCount, -1);
+    m_duration.clear();
+    m_resolution.clear();
+    m_otherInfo.clear();
+
+    QHash<QString, QString>::const_iterator ci = arg.constBegin();
+    for(; ci != arg.constEnd(); ++ci)
+    {
+        qint32 index = numericAttribute(ci.key());
+        if (index >= 0)
+        {
+            // Only the values that are written back exactly as they were
+            // read are stored in binary form.
+            bool ok = false;
+            qint64 value = ci.value().toLongLong(&ok);
+            if (ok && value >= 0 && QString::number(value) == ci.value())
+            {
+                m_numericInfo[index] = value;
+                continue;
+            }
+        }
+        else if (!ci.value().isEmpty())
+        {
+            if (ci.key() == "duration")
+            {
+                m_duration = ci.value();
+                continue;
+            }
+            else if (ci.key() == "resolution")
+            {
+                m_resolution = ci.value();
+                continue;
+            }
+        }
+        m_otherInfo.insert(ci.key(), ci.value());
+    }
 }
 
 /*******************************************************************************
@@ -68,14 +246,14 @@ HResource::HResource() :
 HResource::HResource(const HProtocolInfo& protocolInfo) :
     h_ptr(new HResourcePrivate())
 {
-    h_ptr->m_protocolInfo = protocolInfo;
+    h_ptr->m_protocolInfo = intern(protocolInfo);
 }
 
 HResource::HResource(const QUrl& location, const HProtocolInfo& protocolInfo) :
     h_ptr(new HResourcePrivate())
 {
-    h_ptr->m_location = location;
-    h_ptr->m_protocolInfo = protocolInfo;
+    h_ptr->setLocation(location);
+    h_ptr->m_protocolInfo = intern(protocolInfo);
 }
 
 HResource::~HResource()
@@ -97,7 +275,7 @@ HResource& HResource::operator=(const HResource& other)
 
 QUrl HResource::location() const
 {
-    return h_ptr->m_location;
+    return h_ptr->location();
 }
 
 const HProtocolInfo& HResource::protocolInfo() const
@@ -105,9 +283,19 @@ const HProtocolInfo& HResource::protocolInfo() const
     return h_ptr->m_protocolInfo;
 }
 
-const QHash<QString, QString>& HResource::mediaInfo() const
+QHash<QString, QString> HResource::mediaInfo() const
+{
+    return h_ptr->mediaInfo();
+}
+
+qint64 HResource::numericMediaInfo(NumericAttribute attr, bool* ok) const
 {
-    return h_ptr->m_mediaInfo;
+    qint64 retVal =
+        attr >= 0 && static_cast<qint32>(attr) < NumericAttributeCount ?
+            h_ptr->m_numericInfo[attr] : -1;
+
+    if (ok) { *ok = retVal >= 0; }
+    return retVal;
 }
 
 quint32 HResource::updateCount() const
@@ -122,17 +310,17 @@ bool HResource::trackChangesOptionEnabled() const
 
 void HResource::setLocation(const QUrl& arg)
 {
-    h_ptr->m_location = arg;
+    h_ptr->setLocation(arg);
 }
 
 void HResource::setProtocolInfo(const HProtocolInfo& arg)
 {
-    h_ptr->m_protocolInfo = arg;
+    h_ptr->m_protocolInfo = intern(arg);
 }
 
 void HResource::setMediaInfo(const QHash<QString, QString>& arg)
 {
-    h_ptr->m_mediaInfo = arg;
+    h_ptr->setMediaInfo(arg);
 }
 
 void HResource::setUpdateCount(quint32 arg)
@@ -147,12 +335,22 @@ void HResource::enableTrackChangesOption(bool arg)
 
 bool operator==(const HResource& obj1, const HResource& obj2)
 {
-    return obj1.h_ptr->m_location == obj2.h_ptr->m_location &&
-           obj1.h_ptr->m_protocolInfo == obj2.h_ptr->m_protocolInfo &&
-           obj1.h_ptr->m_mediaInfo    == obj2.h_ptr->m_mediaInfo &&
-           obj1.h_ptr->m_trackChangesOptionEnabled ==
-           obj2.h_ptr->m_trackChangesOptionEnabled &&
-           obj1.h_ptr->m_mediaInfo    == obj2.h_ptr->m_mediaInfo;
+    const HResourcePrivate* p1 = obj1.h_ptr.constData();
+    const HResourcePrivate* p2 = obj2.h_ptr.constData();
+    if (p1 == p2)
+    {
+        return true;
+    }
+
+    return p1->m_locationBase   == p2->m_locationBase &&
+           p1->m_locationSuffix == p2->m_locationSuffix &&
+           p1->m_protocolInfo   == p2->m_protocolInfo &&
+           qEqual(p1->m_numericInfo, p1->m_numericInfo + NumericAttributeCount,
+                  p2->m_numericInfo) &&
+           p1->m_duration   == p2->m_duration &&
+           p1->m_resolution == p2->m_resolution &&
+           p1->m_otherInfo  == p2->m_otherInfo &&
+           p1->m_trackChangesOptionEnabled == p2->m_trackChangesOptionEnabled;
 }
 
 }
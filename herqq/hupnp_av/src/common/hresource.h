@@ -63,6 +63,47 @@ private: // attributes
 
 public:
 
+    /*!
+     * \brief This enumeration specifies the numeric media information
+     * attributes that are stored in binary form.
+     *
+     * \sa numericMediaInfo()
+     */
+    enum NumericAttribute
+    {
+        /*!
+         * The \c size attribute, the size of the resource in bytes.
+         */
+        Size = 0,
+
+        /*!
+         * The \c bitrate attribute, the bitrate of the resource in bytes
+         * per second.
+         */
+        Bitrate,
+
+        /*!
+         * The \c sampleFrequency attribute, the sample frequency of the
+         * resource in Hz.
+         */
+        SampleFrequency,
+
+        /*!
+         * The \c bitsPerSample attribute.
+         */
+        BitsPerSample,
+
+        /*!
+         * The \c nrAudioChannels attribute.
+         */
+        NrAudioChannels,
+
+        /*!
+         * The \c colorDepth attribute.
+         */
+        ColorDepth
+    };
+
     /*!
      * Creates a new, invalid instance.
      *
@@ -133,9 +174,29 @@ public:
      *
      * \return The media information associated with the resource.
      *
+     * \remarks The common attributes are not stored in a hash table and
+     * therefore the returned hash is constructed on every call. Use
+     * numericMediaInfo() to access the numeric attributes.
+     *
      * \sa setMediaInfo()
      */
-    const QHash<QString, QString>& mediaInfo() const;
+    QHash<QString, QString> mediaInfo() const;
+
+    /*!
+     * \brief Returns the value of a numeric media information attribute.
+     *
+     * \param attr specifies the attribute.
+     *
+     * \param ok specifies a pointer to \c bool, which is set to \e true
+     * in case the attribute has a numeric value. This is optional.
+     *
+     * \return The value of the specified attribute, or -1 in case the
+     * attribute is not set or its value is not a plain non-negative integer,
+     * in which case the value is available only through mediaInfo().
+     *
+     * \sa mediaInfo()
+     */
+    qint64 numericMediaInfo(NumericAttribute attr, bool* ok = 0) const;
 
     /*!
      * \brief Returns the number of times a change was made to the content
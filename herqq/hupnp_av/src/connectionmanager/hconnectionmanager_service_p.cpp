@@ -42,8 +42,10 @@ namespace Av
 HConnectionManagerService::HConnectionManagerService() :
     HAbstractConnectionManagerService(),
         m_sinkProtocolInfo(),
+        m_sinkMatcher(),
         m_sourceProtocolInfo(),
-        m_currentConnectionIDs(),
+        m_connections(),
+        m_connectionIdsCsv(),
         m_lastConnectionId(-1)
 {
 }
@@ -52,15 +54,52 @@ HConnectionManagerService::~HConnectionManagerService()
 {
 }
 
-void HConnectionManagerService::updateConnectionsList()
+bool HConnectionManagerService::findConnection(
+    qint32 connectionId, qint32* index) const
 {
-    QString newStateVarValue = numToCsvString(m_currentConnectionIDs.keys());
-    HServerStateVariable* sv = stateVariables().value("CurrentConnectionIDs");
-    if (sv->value() != newStateVarValue)
+    qint32 first = 0, last = m_connections.size();
+    if (last > 0 && m_connections.at(last - 1).first < connectionId)
+    {
+        // The common case of a new connection.
+        *index = last;
+        return false;
+    }
+
+    while (first < last)
+    {
+        qint32 middle = first + (last - first) / 2;
+        if (m_connections.at(middle).first < connectionId)
+        {
+            first = middle + 1;
+        }
+        else
+        {
+            last = middle;
+        }
+    }
+
+    *index = first;
+    return first < m_connections.size() &&
+           m_connections.at(first).first == connectionId;
+}
+
+void HConnectionManagerService::rebuildConnectionIds()
+{
+    QList<qint32> ids;
+    foreach(const Connection& connection, m_connections)
     {
-        bool ok = sv->setValue(newStateVarValue);
-        Q_ASSERT(ok); Q_UNUSED(ok)
+        ids.append(connection.first);
     }
+    m_connectionIdsCsv = numToCsvString(ids);
+}
+
+void HConnectionManagerService::updateConnectionsList()
+{
+    // The value is changed through the state variable, which means the change
+    // is evented according to the moderation of the device host.
+    HServerStateVariable* sv = stateVariables().value("CurrentConnectionIDs");
+    bool ok = sv->setValue(m_connectionIdsCsv);
+    Q_ASSERT(ok); Q_UNUSED(ok)
 }
 
 qint32 HConnectionManagerService::getProtocolInfo(HProtocolInfoResult* result)
@@ -79,7 +118,14 @@ qint32 HConnectionManagerService::getProtocolInfo(HProtocolInfoResult* result)
 qint32 HConnectionManagerService::getCurrentConnectionIDs(QList<quint32>* oarg)
 {
     Q_ASSERT(oarg);
-    *oarg = m_currentConnectionIDs.keys();
+
+    oarg->clear();
+    oarg->reserve(m_connections.size());
+    foreach(const Connection& connection, m_connections)
+    {
+        oarg->append(connection.first);
+    }
+
     return UpnpSuccess;
 }
 
@@ -88,9 +134,10 @@ qint32 HConnectionManagerService::getCurrentConnectionInfo(
 {
     Q_ASSERT(oarg);
 
-    if (m_currentConnectionIDs.contains(connectionId))
+    qint32 index;
+    if (findConnection(connectionId, &index))
     {
-        *oarg = *m_currentConnectionIDs.value(connectionId);
+        *oarg = *m_connections.at(index).second;
         return UpnpSuccess;
     }
 
@@ -99,26 +146,65 @@ qint32 HConnectionManagerService::getCurrentConnectionInfo(
 
 void HConnectionManagerService::removeConnection(qint32 connectionId)
 {
-    m_currentConnectionIDs.remove(connectionId);
+    qint32 index;
+    if (!findConnection(connectionId, &index))
+    {
+        return;
+    }
+
+    m_connections.remove(index);
+
+    if (index == m_connections.size())
+    {
+        // The most recent connection is usually the first one to go, in which
+        // case its ID is simply chopped off the end of the list.
+        qint32 separator = m_connectionIdsCsv.lastIndexOf(',');
+        m_connectionIdsCsv.truncate(separator < 0 ? 0 : separator);
+    }
+    else
+    {
+        rebuildConnectionIds();
+    }
+
     updateConnectionsList();
 }
 
 void HConnectionManagerService::addConnection(const HConnectionInfo& connection)
 {
     Q_ASSERT(connection.isValid());
-    if (!m_currentConnectionIDs.contains(connection.connectionId()))
+
+    qint32 connectionId = connection.connectionId();
+
+    qint32 index;
+    if (findConnection(connectionId, &index))
     {
-        m_currentConnectionIDs.insert(
-            connection.connectionId(),
-            QSharedPointer<HConnectionInfo>(new HConnectionInfo(connection)));
+        return;
+    }
+
+    m_connections.insert(index, qMakePair(
+        connectionId,
+        QSharedPointer<HConnectionInfo>(new HConnectionInfo(connection))));
+
+    if (index == m_connections.size() - 1)
+    {
+        if (!m_connectionIdsCsv.isEmpty())
+        {
+            m_connectionIdsCsv.append(',');
+        }
+        m_connectionIdsCsv.append(QString::number(connectionId));
     }
+    else
+    {
+        rebuildConnectionIds();
+    }
+
     updateConnectionsList();
 }
 
 QSharedPointer<HConnectionInfo> HConnectionManagerService::createDefaultConnection(
     const HProtocolInfo& pinfo)
 {
-    Q_ASSERT(m_currentConnectionIDs.size() == 0);
+    Q_ASSERT(m_connections.isEmpty());
 
     QSharedPointer<HConnectionInfo> connectionInfo =
         QSharedPointer<HConnectionInfo>(new HConnectionInfo(0, pinfo));
@@ -126,7 +212,10 @@ QSharedPointer<HConnectionInfo> HConnectionManagerService::createDefaultConnecti
     connectionInfo->setDirection(HConnectionManagerInfo::DirectionOutput);
     connectionInfo->setStatus(HConnectionManagerInfo::StatusOk);
 
-    m_currentConnectionIDs.insert(0, connectionInfo);
+    m_connections.append(qMakePair(0, connectionInfo));
+    m_connectionIdsCsv = QString::number(0);
+    updateConnectionsList();
+
     return connectionInfo;
 }
 
@@ -155,6 +244,7 @@ void HConnectionManagerService::setSourceProtocolInfo(const HProtocolInfos& arg)
 void HConnectionManagerService::setSinkProtocolInfo(const HProtocolInfos& arg)
 {
     m_sinkProtocolInfo = arg;
+    m_sinkMatcher.setSinkProtocolInfos(arg);
 
     QString sinkProtocolInfos = strToCsvString(m_sinkProtocolInfo);
     HServerStateVariable* sv = stateVariables().value("SinkProtocolInfo");
@@ -162,21 +252,6 @@ void HConnectionManagerService::setSinkProtocolInfo(const HProtocolInfos& arg)
     Q_ASSERT(ok); Q_UNUSED(ok)
 }
 
-bool HConnectionManagerService::isMimetypeValid(
-    const QString& contentFormat, const HProtocolInfos& protocolInfos)
-{
-    foreach(const HProtocolInfo& pinfo, protocolInfos)
-    {
-        if (pinfo.contentFormat() == contentFormat ||
-            pinfo.contentFormat() == "*")
-        {
-            return true;
-        }
-    }
-
-    return false;
-}
-
 }
 }
 }
@@ -35,9 +35,11 @@
 #include "habstractconnectionmanager_service_p.h"
 
 #include "../common/hprotocolinfo.h"
+#include "../common/hprotocolinfo_matcher.h"
 #include <HUpnpCore/private/hserverservice_p.h>
 
-#include <QtCore/QHash>
+#include <QtCore/QPair>
+#include <QtCore/QVector>
 #include <QtCore/QSharedPointer>
 
 namespace Herqq
@@ -61,13 +63,29 @@ H_DISABLE_COPY(HConnectionManagerService)
 private:
 
     HProtocolInfos m_sinkProtocolInfo;
+    HProtocolInfoMatcher m_sinkMatcher;
+    // m_sinkProtocolInfo indexed for the checks of PrepareForConnection
     HProtocolInfos m_sourceProtocolInfo;
-    QHash<quint32, QSharedPointer<HConnectionInfo> > m_currentConnectionIDs;
+    typedef QPair<qint32, QSharedPointer<HConnectionInfo> > Connection;
+
+    QVector<Connection> m_connections;
+    // the current connections sorted by their IDs. the IDs are allocated
+    // in increasing order, which means new connections are appended
+
+    QString m_connectionIdsCsv;
+    // the value of CurrentConnectionIDs, kept in sync with m_connections
 
     int m_lastConnectionId;
 
 private:
 
+    // returns the index of the connection in m_connections, or
+    // the index at which it should be inserted and false
+    bool findConnection(qint32 connectionId, qint32* index) const;
+
+    // sets m_connectionIdsCsv to list the IDs of m_connections
+    void rebuildConnectionIds();
+
     void updateConnectionsList();
 
 public:
@@ -91,22 +109,30 @@ public:
     void setSourceProtocolInfo(const HProtocolInfos&);
     void setSinkProtocolInfo(const HProtocolInfos&);
 
-    static bool isMimetypeValid(
-        const QString& contentFormat, const HProtocolInfos& protocolInfos);
-
     inline const HProtocolInfos& sinkProtocolInfo() const
     {
         return m_sinkProtocolInfo;
     }
 
+    inline const HProtocolInfoMatcher& sinkMatcher() const
+    {
+        return m_sinkMatcher;
+    }
+
     inline const HProtocolInfos& sourceProtocolInfo() const
     {
         return m_sourceProtocolInfo;
     }
 
-    inline const QHash<quint32, QSharedPointer<HConnectionInfo> >& connectionIds() const
+    inline bool hasConnection(qint32 connectionId) const
+    {
+        qint32 index;
+        return findConnection(connectionId, &index);
+    }
+
+    inline qint32 connectionCount() const
     {
-        return m_currentConnectionIDs;
+        return m_connections.size();
     }
 
     inline int& lastConnectionId()
@@ -8,6 +8,12 @@ HEADERS += \
     $$SRC_LOC/contentdirectory/habstractcontentdirectory_service_p.h \
     $$SRC_LOC/contentdirectory/hcontentdirectory_service.h \
     $$SRC_LOC/contentdirectory/hcontentdirectory_service_p.h \
+    $$SRC_LOC/contentdirectory/hcds_childindex_p.h \
+    $$SRC_LOC/contentdirectory/hcds_searchquery_p.h \
+    $$SRC_LOC/contentdirectory/hcds_freeformquery_p.h \
+    $$SRC_LOC/contentdirectory/hcds_didllitecache_p.h \
+    $$SRC_LOC/contentdirectory/hcds_browsecache_p.h \
+    $$SRC_LOC/contentdirectory/hcds_transferengine_p.h \
     $$SRC_LOC/contentdirectory/hcontentdirectory_serviceconfiguration.h \
     $$SRC_LOC/contentdirectory/hcontentdirectory_serviceconfiguration_p.h \
     $$SRC_LOC/contentdirectory/hcontentdirectory_adapter.h \
@@ -21,6 +27,12 @@ SOURCES += \
     $$SRC_LOC/contentdirectory/hfreeformqueryresult.cpp \
     $$SRC_LOC/contentdirectory/habstractcontentdirectory_service.cpp \
     $$SRC_LOC/contentdirectory/hcontentdirectory_service.cpp \
+    $$SRC_LOC/contentdirectory/hcds_childindex.cpp \
+    $$SRC_LOC/contentdirectory/hcds_searchquery.cpp \
+    $$SRC_LOC/contentdirectory/hcds_freeformquery.cpp \
+    $$SRC_LOC/contentdirectory/hcds_didllitecache.cpp \
+    $$SRC_LOC/contentdirectory/hcds_browsecache.cpp \
+    $$SRC_LOC/contentdirectory/hcds_transferengine.cpp \
     $$SRC_LOC/contentdirectory/hcontentdirectory_serviceconfiguration.cpp \
     $$SRC_LOC/contentdirectory/hcontentdirectory_adapter.cpp \
     $$SRC_LOC/contentdirectory/hcontentdirectory_info.cpp
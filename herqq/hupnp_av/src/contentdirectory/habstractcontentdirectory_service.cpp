@@ -31,6 +31,7 @@
 #include "../cds_model/hsortinfo.h"
 
 #include <HUpnpCore/private/hlogger_p.h>
+#include <HUpnpCore/private/hxmlfragment_p.h>
 
 #include <HUpnpCore/HServerStateVariable>
 
@@ -48,6 +49,22 @@ namespace Upnp
 namespace Av
 {
 
+namespace
+{
+// A result that is already serialized for a SOAP message is passed to the
+// SOAP writer as is.
+QVariant toResultValue(const HSearchResult& result)
+{
+    QByteArray escapedResult = result.escapedResult();
+    if (!escapedResult.isEmpty())
+    {
+        return QVariant::fromValue(HXmlFragment(escapedResult));
+    }
+
+    return result.result();
+}
+}
+
 /*******************************************************************************
  * HAbstractContentDirectoryServicePrivate
  ******************************************************************************/
@@ -188,7 +205,7 @@ qint32 HAbstractContentDirectoryServicePrivate::browse(
 
     if (retVal == UpnpSuccess)
     {
-        outArgs->setValue("Result", result.result());
+        outArgs->setValue("Result", toResultValue(result));
         outArgs->setValue("NumberReturned", result.numberReturned());
         outArgs->setValue("TotalMatches", result.totalMatches());
         outArgs->setValue("UpdateID", result.updateId());
@@ -217,7 +234,7 @@ qint32 HAbstractContentDirectoryServicePrivate::search(
 
     if (retVal == UpnpSuccess)
     {
-        outArgs->setValue("Result", result.result());
+        outArgs->setValue("Result", toResultValue(result));
         outArgs->setValue("NumberReturned", result.numberReturned());
         outArgs->setValue("TotalMatches", result.totalMatches());
         outArgs->setValue("UpdateID", result.updateId());
@@ -0,0 +1,263 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hcds_browsecache_p.h"
+#include "hcds_didllitecache_p.h"
+
+#include "../cds_model/datasource/habstract_cds_datasource.h"
+
+#include <QtCore/QStringList>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+/*******************************************************************************
+ * HCdsBrowseCache
+ ******************************************************************************/
+HCdsBrowseCache::HCdsBrowseCache(
+    HAbstractCdsDataSource* dataSource, qint32 maxSize, QObject* parent) :
+        QObject(parent),
+            m_dataSource(dataSource), m_entries(maxSize), m_keys()
+{
+    Q_ASSERT(m_dataSource);
+    Q_ASSERT(maxSize > 0);
+
+    bool ok = connect(
+        m_dataSource,
+        SIGNAL(objectModified(Herqq::Upnp::Av::HObject*, Herqq::Upnp::Av::HObjectEventInfo)),
+        this,
+        SLOT(objectModified(Herqq::Upnp::Av::HObject*, Herqq::Upnp::Av::HObjectEventInfo)));
+    Q_ASSERT(ok); Q_UNUSED(ok)
+
+    ok = connect(
+        m_dataSource,
+        SIGNAL(containerModified(Herqq::Upnp::Av::HContainer*, Herqq::Upnp::Av::HContainerEventInfo)),
+        this,
+        SLOT(containerModified(Herqq::Upnp::Av::HContainer*, Herqq::Upnp::Av::HContainerEventInfo)));
+    Q_ASSERT(ok);
+
+    ok = connect(
+        m_dataSource,
+        SIGNAL(bulkUpdateFinished(QStringList,QStringList,QStringList)),
+        this, SLOT(bulkUpdateFinished(QStringList,QStringList,QStringList)));
+    Q_ASSERT(ok);
+
+    ok = connect(m_dataSource, SIGNAL(destroyed()), this, SLOT(clear()));
+    Q_ASSERT(ok);
+}
+
+HCdsBrowseCache::~HCdsBrowseCache()
+{
+}
+
+QString HCdsBrowseCache::key(
+    const QString& objectId, HContentDirectoryInfo::BrowseFlag browseFlag,
+    const QSet<QString>& filter, quint32 startingIndex,
+    quint32 requestedCount, const QStringList& sortCriteria)
+{
+    // The fields are separated by a character that cannot appear in the
+    // object ID or in the other arguments of a SOAP request.
+    QChar sep(0);
+    QString retVal(objectId);
+    retVal.append(sep).append(QString::number(browseFlag)).append(sep).
+        append(HCdsDidlLiteCache::normalize(filter)).append(sep).
+        append(QString::number(startingIndex)).append(sep).
+        append(QString::number(requestedCount)).append(sep).
+        append(sortCriteria.join(","));
+
+    return retVal;
+}
+
+void HCdsBrowseCache::invalidate(const QString& objectId)
+{
+    QSet<QString> keys = m_keys.take(objectId);
+    foreach(const QString& key, keys)
+    {
+        m_entries.remove(key);
+    }
+}
+
+void HCdsBrowseCache::invalidateWithParent(const QString& objectId)
+{
+    invalidate(objectId);
+
+    // A modified object is also on the pages of the children of its parent.
+    HObject* object = m_dataSource->findObject(objectId);
+    if (object)
+    {
+        invalidate(object->parentId());
+    }
+}
+
+void HCdsBrowseCache::prune()
+{
+    QHash<QString, QSet<QString> >::iterator it = m_keys.begin();
+    while(it != m_keys.end())
+    {
+        QSet<QString>::iterator kit = it->begin();
+        while(kit != it->end())
+        {
+            if (m_entries.contains(*kit))
+            {
+                ++kit;
+            }
+            else
+            {
+                kit = it->erase(kit);
+            }
+        }
+
+        if (it->isEmpty())
+        {
+            it = m_keys.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void HCdsBrowseCache::objectModified(
+    HObject* source, const HObjectEventInfo&)
+{
+    invalidate(source->id());
+    invalidate(source->parentId());
+}
+
+void HCdsBrowseCache::containerModified(
+    HContainer* source, const HContainerEventInfo& eventInfo)
+{
+    invalidate(source->id());
+
+    if (eventInfo.type() == HContainerEventInfo::ChildRemoved)
+    {
+        invalidate(eventInfo.childId());
+    }
+}
+
+void HCdsBrowseCache::bulkUpdateFinished(
+    const QStringList& addedIds, const QStringList& modifiedIds,
+    const QStringList& containerIds)
+{
+    // An added object may replace an object with the same ID.
+    foreach(const QString& id, addedIds)
+    {
+        invalidateWithParent(id);
+    }
+
+    foreach(const QString& id, modifiedIds)
+    {
+        invalidateWithParent(id);
+    }
+
+    foreach(const QString& id, containerIds)
+    {
+        invalidate(id);
+    }
+}
+
+bool HCdsBrowseCache::find(
+    const QString& objectId, HContentDirectoryInfo::BrowseFlag browseFlag,
+    const QSet<QString>& filter, quint32 startingIndex,
+    quint32 requestedCount, const QStringList& sortCriteria,
+    HSearchResult* result)
+{
+    Q_ASSERT(result);
+
+    QString k = key(
+        objectId, browseFlag, filter, startingIndex, requestedCount,
+        sortCriteria);
+
+    Entry* entry = m_entries.object(k);
+    if (!entry)
+    {
+        return false;
+    }
+
+    HObject* object = m_dataSource->findObject(objectId);
+    if (!object || entry->m_object != object ||
+        (browseFlag == HContentDirectoryInfo::BrowseDirectChildren &&
+         (!object->isContainer() ||
+          static_cast<HContainer*>(object)->containerUpdateId() !=
+              entry->m_containerUpdateId)))
+    {
+        m_entries.remove(k);
+        return false;
+    }
+
+    *result = entry->m_result;
+    return true;
+}
+
+void HCdsBrowseCache::insert(
+    const QString& objectId, HContentDirectoryInfo::BrowseFlag browseFlag,
+    const QSet<QString>& filter, quint32 startingIndex,
+    quint32 requestedCount, const QStringList& sortCriteria,
+    const HSearchResult& result)
+{
+    HObject* object = m_dataSource->findObject(objectId);
+    if (!object)
+    {
+        return;
+    }
+
+    // The result of a metadata browse is not escaped.
+    qint32 size = result.escapedResult().isEmpty() ?
+        result.result().size() * sizeof(QChar) : result.escapedResult().size();
+
+    Entry* entry = new Entry();
+    entry->m_result = result;
+    entry->m_object = object;
+    entry->m_containerUpdateId = object->isContainer() ?
+        static_cast<HContainer*>(object)->containerUpdateId() : 0;
+
+    QString k = key(
+        objectId, browseFlag, filter, startingIndex, requestedCount,
+        sortCriteria);
+
+    // An entry that does not fit into the cache is deleted by the cache.
+    if (m_entries.insert(k, entry, qMax(size, 1)))
+    {
+        m_keys[objectId].insert(k);
+    }
+
+    if (m_keys.size() > 2 * m_entries.size() + 64)
+    {
+        prune();
+    }
+}
+
+void HCdsBrowseCache::clear()
+{
+    m_entries.clear();
+    m_keys.clear();
+}
+
+}
+}
+}
@@ -0,0 +1,140 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HCDS_BROWSECACHE_P_H_
+#define HCDS_BROWSECACHE_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include "hsearchresult.h"
+#include "hcontentdirectory_info.h"
+#include "../cds_model/cds_objects/hobject.h"
+#include "../cds_model/cds_objects/hcontainer.h"
+
+#include <QtCore/QSet>
+#include <QtCore/QHash>
+#include <QtCore/QCache>
+#include <QtCore/QObject>
+#include <QtCore/QPointer>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+//
+// Caches the results of browse requests keyed by the normalized arguments
+// of the requests. A cached page of the children of a container is tagged
+// with the update ID of the container and it is used only as long as the
+// container has the same update ID. In addition, the results are dropped
+// when the browsed object or any of its children is modified.
+// The cache is bounded by the number of bytes of the cached results.
+//
+class HCdsBrowseCache :
+    public QObject
+{
+Q_OBJECT
+H_DISABLE_COPY(HCdsBrowseCache)
+
+private:
+
+    struct Entry
+    {
+        HSearchResult m_result;
+
+        QPointer<HObject> m_object;
+        // the browsed object. If an object with the same ID replaces the
+        // object, the entry is not used.
+
+        quint32 m_containerUpdateId;
+        // the update ID of the browsed container, if the children were browsed
+    };
+
+    HAbstractCdsDataSource* m_dataSource;
+
+    QCache<QString, Entry> m_entries;
+    // the cost of an entry is the size of its result
+
+    QHash<QString, QSet<QString> > m_keys;
+    // key == the ID of a browsed object, value == the keys of its entries.
+    // the entries evicted by m_entries are removed from here lazily.
+
+    static QString key(
+        const QString& objectId, HContentDirectoryInfo::BrowseFlag,
+        const QSet<QString>& filter, quint32 startingIndex,
+        quint32 requestedCount, const QStringList& sortCriteria);
+
+    void invalidate(const QString& objectId);
+    void invalidateWithParent(const QString& objectId);
+    void prune();
+
+private Q_SLOTS:
+
+    void objectModified(
+        Herqq::Upnp::Av::HObject*, const Herqq::Upnp::Av::HObjectEventInfo&);
+
+    void containerModified(
+        Herqq::Upnp::Av::HContainer*,
+        const Herqq::Upnp::Av::HContainerEventInfo&);
+
+    void bulkUpdateFinished(
+        const QStringList& addedIds, const QStringList& modifiedIds,
+        const QStringList& containerIds);
+
+public:
+
+    HCdsBrowseCache(
+        HAbstractCdsDataSource* dataSource, qint32 maxSize, QObject* parent);
+
+    virtual ~HCdsBrowseCache();
+
+    bool find(
+        const QString& objectId, HContentDirectoryInfo::BrowseFlag,
+        const QSet<QString>& filter, quint32 startingIndex,
+        quint32 requestedCount, const QStringList& sortCriteria,
+        HSearchResult*);
+
+    void insert(
+        const QString& objectId, HContentDirectoryInfo::BrowseFlag,
+        const QSet<QString>& filter, quint32 startingIndex,
+        quint32 requestedCount, const QStringList& sortCriteria,
+        const HSearchResult&);
+
+public Q_SLOTS:
+
+    void clear();
+};
+
+}
+}
+}
+
+#endif /* HCDS_BROWSECACHE_P_H_ */
@@ -0,0 +1,480 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hcds_childindex_p.h"
+
+#include "../cds_model/model_mgmt/hcdsproperty.h"
+#include "../cds_model/model_mgmt/hcdsproperty_db.h"
+#include "../cds_model/datasource/habstract_cds_datasource.h"
+
+#include <QtCore/QSet>
+#include <QtCore/QThread>
+#include <QtCore/QVector>
+#include <QtCore/QRunnable>
+#include <QtCore/QThreadPool>
+
+#include <algorithm>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+namespace
+{
+// The maximum number of sort orders cached for a single container. Control
+// points rarely use more than a couple of different sort criteria.
+const qint32 MaxSortOrdersPerContainer = 4;
+
+// The number of objects from which on the sort keys are sorted in
+// several threads.
+const qint32 ParallelSortThreshold = 16384;
+
+//
+// Sort criteria compiled into the comparers of the sorted properties, along
+// with the values of the sorted properties of each object in a contiguous
+// array. This way a comparison does not look up the properties of the
+// objects or the comparers of the properties.
+//
+class HSortKeys
+{
+H_DISABLE_COPY(HSortKeys)
+
+private:
+
+    QVector<HComparer*> m_comparers;
+    // the comparer of each sort property or null in case the property
+    // cannot be compared. The comparers are stateless, which is why they
+    // can be shared by the sorting threads.
+
+    QVector<bool> m_ascending;
+
+    QVector<QVariant> m_values;
+    // the values of the sort properties of the objects, one row per object.
+    // A value is invalid in case the object does not have the property.
+
+    qint32 m_keyCount;
+
+public:
+
+    HSortKeys(const QList<HSortInfo>& sortInfos, const HObjects& objects) :
+        m_comparers(), m_ascending(), m_values(),
+        m_keyCount(sortInfos.size())
+    {
+        HCdsPropertyDb& db = HCdsPropertyDb::instance();
+
+        QVector<qint32> ids;
+        foreach(const HSortInfo& si, sortInfos)
+        {
+            HCdsProperty prop = db.property(si.property());
+            HComparer comparer = prop.handler().comparer();
+            m_comparers.append(
+                prop.isValid() && !!comparer ? new HComparer(comparer) : 0);
+            m_ascending.append(si.sortModifier().ascending());
+            ids.append(db.propertyId(si.property()));
+        }
+
+        m_values.resize(objects.size() * m_keyCount);
+        for(qint32 i = 0; i < objects.size(); ++i)
+        {
+            for(qint32 j = 0; j < m_keyCount; ++j)
+            {
+                qint32 id = ids[j];
+                if (!m_comparers[j] || id < 0)
+                {
+                    continue;
+                }
+
+                QVariant* value = &m_values[i * m_keyCount + j];
+                if (id < HCdsPropertyDb::FirstCustomPropertyId)
+                {
+                    objects[i]->getCdsProperty(
+                        static_cast<HCdsProperties::Property>(id), value);
+                }
+                else
+                {
+                    objects[i]->getCdsProperty(sortInfos[j].property(), value);
+                }
+            }
+        }
+    }
+
+    ~HSortKeys()
+    {
+        qDeleteAll(m_comparers);
+    }
+
+    bool lessThan(qint32 obj1, qint32 obj2) const
+    {
+        const QVariant* values1 = m_values.constData() + obj1 * m_keyCount;
+        const QVariant* values2 = m_values.constData() + obj2 * m_keyCount;
+
+        for(qint32 i = 0; i < m_keyCount; ++i)
+        {
+            if (!m_comparers[i] ||
+                !values1[i].isValid() || !values2[i].isValid())
+            {
+                continue;
+            }
+
+            qint32 rc = 0;
+            if (!(*m_comparers[i])(values1[i], values2[i], &rc))
+            {
+                continue;
+            }
+
+            if (rc < 0)
+            {
+                return m_ascending[i];
+            }
+            else if (rc > 0)
+            {
+                return !m_ascending[i];
+            }
+        }
+
+        // Objects that compare equal keep their order in a stable sort only
+        // if neither is less than the other.
+        return false;
+    }
+};
+
+class HIndexLessThan
+{
+private:
+
+    const HSortKeys* m_keys;
+
+public:
+
+    HIndexLessThan(const HSortKeys* keys) : m_keys(keys) {}
+
+    inline bool operator()(qint32 obj1, qint32 obj2) const
+    {
+        return m_keys->lessThan(obj1, obj2);
+    }
+};
+
+//
+// Sorts a range of object indexes, or merges two adjacent sorted ranges,
+// in a worker thread
+//
+class HSortJob :
+    public QRunnable
+{
+H_DISABLE_COPY(HSortJob)
+
+private:
+
+    qint32* m_begin;
+    qint32* m_middle;
+    qint32* m_end;
+    // the range is sorted in case m_middle equals to m_begin. Otherwise
+    // the ranges [m_begin, m_middle) and [m_middle, m_end) are merged.
+
+    HIndexLessThan m_lessThan;
+
+public:
+
+    HSortJob(
+        qint32* begin, qint32* middle, qint32* end,
+        const HIndexLessThan& lessThan) :
+            m_begin(begin), m_middle(middle), m_end(end), m_lessThan(lessThan)
+    {
+        setAutoDelete(false);
+    }
+
+    virtual void run()
+    {
+        if (m_middle == m_begin)
+        {
+            qStableSort(m_begin, m_end, m_lessThan);
+        }
+        else
+        {
+            std::inplace_merge(m_begin, m_middle, m_end, m_lessThan);
+        }
+    }
+};
+
+void runJobs(QList<HSortJob*>* jobs)
+{
+    QThreadPool threadPool;
+    foreach(HSortJob* job, *jobs)
+    {
+        threadPool.start(job);
+    }
+    threadPool.waitForDone();
+
+    qDeleteAll(*jobs);
+    jobs->clear();
+}
+
+void sortIndexes(const HSortKeys& keys, QVector<qint32>* indexes)
+{
+    HIndexLessThan lessThan(&keys);
+
+    qint32 size = indexes->size();
+    qint32 threadCount = QThread::idealThreadCount();
+    if (size < ParallelSortThreshold || threadCount < 2)
+    {
+        qStableSort(indexes->begin(), indexes->end(), lessThan);
+        return;
+    }
+
+    // The ranges are sorted in parallel, after which the sorted ranges are
+    // merged pairwise until a single range remains. Both the sort and the
+    // merges are stable.
+    qint32 rangeCount =
+        qMax(2, qMin(threadCount, size / ParallelSortThreshold));
+    qint32 rangeSize = (size + rangeCount - 1) / rangeCount;
+    qint32* data = indexes->data();
+
+    QList<HSortJob*> jobs;
+    for(qint32 begin = 0; begin < size; begin += rangeSize)
+    {
+        qint32 end = qMin(begin + rangeSize, size);
+        jobs.append(
+            new HSortJob(data + begin, data + begin, data + end, lessThan));
+    }
+    runJobs(&jobs);
+
+    for(qint32 width = rangeSize; width < size; width *= 2)
+    {
+        for(qint32 begin = 0; begin + width < size; begin += 2 * width)
+        {
+            qint32 end = qMin(begin + 2 * width, size);
+            jobs.append(new HSortJob(
+                data + begin, data + begin + width, data + end, lessThan));
+        }
+        runJobs(&jobs);
+    }
+}
+
+QString sortKey(const QList<HSortInfo>& sortInfos)
+{
+    QString retVal;
+    foreach(const HSortInfo& si, sortInfos)
+    {
+        retVal.append(si.sortModifier().toString()).append(si.property());
+        retVal.append(QLatin1Char(','));
+    }
+    return retVal;
+}
+}
+
+/*******************************************************************************
+ * HCdsChildIndex
+ ******************************************************************************/
+HCdsChildIndex::HCdsChildIndex(
+    HAbstractCdsDataSource* dataSource, QObject* parent) :
+        QObject(parent),
+            m_dataSource(dataSource), m_entries()
+{
+    Q_ASSERT(m_dataSource);
+
+    bool ok = connect(
+        m_dataSource,
+        SIGNAL(containerModified(Herqq::Upnp::Av::HContainer*, Herqq::Upnp::Av::HContainerEventInfo)),
+        this,
+        SLOT(containerModified(Herqq::Upnp::Av::HContainer*, Herqq::Upnp::Av::HContainerEventInfo)));
+    Q_ASSERT(ok); Q_UNUSED(ok)
+
+    ok = connect(
+        m_dataSource,
+        SIGNAL(bulkUpdateFinished(QStringList,QStringList,QStringList)),
+        this, SLOT(bulkUpdateFinished(QStringList,QStringList,QStringList)));
+    Q_ASSERT(ok);
+
+    ok = connect(m_dataSource, SIGNAL(destroyed()), this, SLOT(clear()));
+    Q_ASSERT(ok);
+}
+
+HCdsChildIndex::~HCdsChildIndex()
+{
+    clear();
+}
+
+HCdsChildIndex::Entry* HCdsChildIndex::entry(HContainer* container)
+{
+    Entry* retVal = m_entries.value(container->id());
+    if (retVal && retVal->m_container == container)
+    {
+        return retVal;
+    }
+    else if (!retVal)
+    {
+        retVal = new Entry();
+        m_entries.insert(container->id(), retVal);
+    }
+
+    retVal->m_container = container;
+    retVal->m_childIds.clear();
+    retVal->m_sortedChildIds.clear();
+
+    // The objects are not kept around, since the data source may delete them
+    // without notifying the parent container. Resolving a page of IDs later
+    // on is a hash lookup per ID. The container keeps its children in a
+    // stable order, which is used as the default order as is when all the
+    // children are in the data source.
+    QStringList childIds = container->orderedChildIds();
+    for(qint32 i = 0; i < childIds.size(); ++i)
+    {
+        if (!m_dataSource->findObject(childIds[i]))
+        {
+            retVal->m_childIds = childIds.mid(0, i);
+            for(++i; i < childIds.size(); ++i)
+            {
+                if (m_dataSource->findObject(childIds[i]))
+                {
+                    retVal->m_childIds.append(childIds[i]);
+                }
+            }
+            return retVal;
+        }
+    }
+    retVal->m_childIds = childIds;
+
+    return retVal;
+}
+
+void HCdsChildIndex::containerModified(
+    HContainer* source, const HContainerEventInfo& eventInfo)
+{
+    Entry* entry = m_entries.value(source->id());
+    if (!entry)
+    {
+        return;
+    }
+
+    if (eventInfo.type() == HContainerEventInfo::ChildModified)
+    {
+        // The set of children stays the same, but any of the sort orders
+        // may have been affected by the modification.
+        entry->m_sortedChildIds.clear();
+    }
+    else
+    {
+        m_entries.remove(source->id());
+        delete entry;
+    }
+}
+
+void HCdsChildIndex::bulkUpdateFinished(
+    const QStringList& /*addedIds*/, const QStringList& /*modifiedIds*/,
+    const QStringList& containerIds)
+{
+    // The containers of the modified children are reported as well, which
+    // is why the entries of the containers are enough to invalidate.
+    foreach(const QString& id, containerIds)
+    {
+        delete m_entries.take(id);
+    }
+}
+
+QStringList HCdsChildIndex::childIds(
+    HContainer* container, const QList<HSortInfo>& sortInfos)
+{
+    Q_ASSERT(container);
+
+    Entry* e = entry(container);
+    if (sortInfos.isEmpty())
+    {
+        return e->m_childIds;
+    }
+
+    QString key = sortKey(sortInfos);
+
+    QHash<QString, QStringList>::const_iterator it =
+        e->m_sortedChildIds.constFind(key);
+
+    if (it != e->m_sortedChildIds.constEnd())
+    {
+        return it.value();
+    }
+
+    HObjects objects;
+    foreach(const QString& childId, e->m_childIds)
+    {
+        HObject* object = m_dataSource->findObject(childId);
+        Q_ASSERT(object);
+        objects.append(object);
+    }
+
+    sort(sortInfos, &objects);
+
+    QStringList retVal;
+    foreach(HObject* object, objects)
+    {
+        retVal.append(object->id());
+    }
+
+    if (e->m_sortedChildIds.size() >= MaxSortOrdersPerContainer)
+    {
+        e->m_sortedChildIds.clear();
+    }
+    e->m_sortedChildIds.insert(key, retVal);
+
+    return retVal;
+}
+
+void HCdsChildIndex::sort(const QList<HSortInfo>& sortInfos, HObjects* objects)
+{
+    Q_ASSERT(objects);
+
+    if (sortInfos.isEmpty() || objects->size() < 2)
+    {
+        return;
+    }
+
+    HSortKeys keys(sortInfos, *objects);
+
+    QVector<qint32> indexes(objects->size());
+    for(qint32 i = 0; i < indexes.size(); ++i)
+    {
+        indexes[i] = i;
+    }
+
+    sortIndexes(keys, &indexes);
+
+    HObjects sorted;
+    sorted.reserve(indexes.size());
+    for(qint32 i = 0; i < indexes.size(); ++i)
+    {
+        sorted.append(objects->at(indexes[i]));
+    }
+
+    *objects = sorted;
+}
+
+void HCdsChildIndex::clear()
+{
+    qDeleteAll(m_entries);
+    m_entries.clear();
+}
+
+}
+}
+}
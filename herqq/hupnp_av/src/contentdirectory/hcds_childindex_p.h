@@ -0,0 +1,118 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HCDS_CHILDINDEX_P_H_
+#define HCDS_CHILDINDEX_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include "../cds_model/hsortinfo.h"
+#include "../cds_model/cds_objects/hcontainer.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QObject>
+#include <QtCore/QPointer>
+#include <QtCore/QStringList>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+//
+// Caches the order of the children of the containers of a data source, both
+// in the order the children are listed by the container and sorted by
+// the sort criteria used in browse requests. This enables a browse request
+// to page through the children of a container by slicing a list of
+// object IDs, instead of fetching and sorting every child of the container
+// for every page.
+//
+class HCdsChildIndex :
+    public QObject
+{
+Q_OBJECT
+H_DISABLE_COPY(HCdsChildIndex)
+
+private:
+
+    struct Entry
+    {
+        QPointer<HContainer> m_container;
+        // the container the entry was built for. If an object with the same
+        // ID replaces the container, the entry is rebuilt.
+
+        QStringList m_childIds;
+        // the IDs of the children that were found from the data source
+
+        QHash<QString, QStringList> m_sortedChildIds;
+        // the child IDs sorted by normalized sort criteria
+    };
+
+    HAbstractCdsDataSource* m_dataSource;
+    QHash<QString, Entry*> m_entries;
+
+    Entry* entry(HContainer*);
+
+private Q_SLOTS:
+
+    void containerModified(
+        Herqq::Upnp::Av::HContainer*,
+        const Herqq::Upnp::Av::HContainerEventInfo&);
+
+    void bulkUpdateFinished(
+        const QStringList& addedIds, const QStringList& modifiedIds,
+        const QStringList& containerIds);
+
+public:
+
+    HCdsChildIndex(HAbstractCdsDataSource* dataSource, QObject* parent);
+    virtual ~HCdsChildIndex();
+
+    // returns the IDs of the children of the specified container sorted
+    // according to the specified sort criteria. If the sort criteria
+    // is empty, the IDs are returned in the order they were resolved.
+    QStringList childIds(
+        HContainer* container, const QList<HSortInfo>& sortInfos);
+
+    // sorts the specified objects stably according to the specified
+    // sort criteria
+    static void sort(const QList<HSortInfo>& sortInfos, HObjects* objects);
+
+public Q_SLOTS:
+
+    void clear();
+};
+
+}
+}
+}
+
+#endif /* HCDS_CHILDINDEX_P_H_ */
@@ -0,0 +1,186 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "hcds_didllitecache_p.h"
+
+#include "../cds_model/datasource/habstract_cds_datasource.h"
+#include "../cds_model/model_mgmt/hcds_dlite_serializer.h"
+
+#include <QtCore/QSet>
+#include <QtCore/QStringList>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+/*******************************************************************************
+ * HCdsDidlLiteCache
+ ******************************************************************************/
+HCdsDidlLiteCache::HCdsDidlLiteCache(
+    HAbstractCdsDataSource* dataSource, qint32 maxSize, QObject* parent) :
+        QObject(parent),
+            m_dataSource(dataSource), m_entries(maxSize)
+{
+    Q_ASSERT(m_dataSource);
+    Q_ASSERT(maxSize > 0);
+
+    bool ok = connect(
+        m_dataSource,
+        SIGNAL(objectModified(Herqq::Upnp::Av::HObject*, Herqq::Upnp::Av::HObjectEventInfo)),
+        this,
+        SLOT(objectModified(Herqq::Upnp::Av::HObject*, Herqq::Upnp::Av::HObjectEventInfo)));
+    Q_ASSERT(ok); Q_UNUSED(ok)
+
+    ok = connect(
+        m_dataSource,
+        SIGNAL(containerModified(Herqq::Upnp::Av::HContainer*, Herqq::Upnp::Av::HContainerEventInfo)),
+        this,
+        SLOT(containerModified(Herqq::Upnp::Av::HContainer*, Herqq::Upnp::Av::HContainerEventInfo)));
+    Q_ASSERT(ok);
+
+    ok = connect(
+        m_dataSource,
+        SIGNAL(bulkUpdateFinished(QStringList,QStringList,QStringList)),
+        this, SLOT(bulkUpdateFinished(QStringList,QStringList,QStringList)));
+    Q_ASSERT(ok);
+
+    ok = connect(m_dataSource, SIGNAL(destroyed()), this, SLOT(clear()));
+    Q_ASSERT(ok);
+}
+
+HCdsDidlLiteCache::~HCdsDidlLiteCache()
+{
+}
+
+QString HCdsDidlLiteCache::normalize(const QSet<QString>& filter)
+{
+    if (filter.contains("*"))
+    {
+        return "*";
+    }
+
+    QStringList tmp = filter.toList();
+    tmp.sort();
+
+    return tmp.join(",");
+}
+
+void HCdsDidlLiteCache::objectModified(
+    HObject* source, const HObjectEventInfo&)
+{
+    m_entries.remove(source->id());
+}
+
+void HCdsDidlLiteCache::containerModified(
+    HContainer* source, const HContainerEventInfo& eventInfo)
+{
+    // The excerpt of a container contains the number of its children,
+    // which is why any modification of the container invalidates it.
+    m_entries.remove(source->id());
+
+    if (eventInfo.type() == HContainerEventInfo::ChildRemoved)
+    {
+        m_entries.remove(eventInfo.childId());
+    }
+}
+
+void HCdsDidlLiteCache::bulkUpdateFinished(
+    const QStringList& addedIds, const QStringList& modifiedIds,
+    const QStringList& containerIds)
+{
+    // An added object may replace an object with the same ID.
+    foreach(const QString& id, addedIds)
+    {
+        m_entries.remove(id);
+    }
+
+    foreach(const QString& id, modifiedIds)
+    {
+        m_entries.remove(id);
+    }
+
+    foreach(const QString& id, containerIds)
+    {
+        m_entries.remove(id);
+    }
+}
+
+QByteArray HCdsDidlLiteCache::excerpt(
+    HObject* object, const QSet<QString>& filter)
+{
+    Q_ASSERT(object);
+
+    QString id = object->id();
+    QString normalizedFilter = normalize(filter);
+
+    Entry* entry = m_entries.object(id);
+    if (entry && entry->m_object == object)
+    {
+        QHash<QString, QByteArray>::const_iterator ci =
+            entry->m_excerpts.constFind(normalizedFilter);
+
+        if (ci != entry->m_excerpts.constEnd())
+        {
+            return ci.value();
+        }
+    }
+
+    HCdsDidlLiteSerializer serializer;
+    QByteArray retVal = serializer.serializeToXml(
+        *object, filter, HCdsDidlLiteSerializer::XmlExcerpt).toUtf8();
+
+    if (retVal.isEmpty())
+    {
+        return retVal;
+    }
+
+    // The entry is taken out of the cache and re-inserted, as its cost
+    // changes. An entry that no longer fits into the cache is deleted
+    // by the cache.
+    entry = m_entries.take(id);
+    if (!entry || entry->m_object != object)
+    {
+        delete entry;
+        entry = new Entry();
+        entry->m_object = object;
+        entry->m_size = 0;
+    }
+
+    entry->m_excerpts.insert(normalizedFilter, retVal);
+    entry->m_size += retVal.size();
+
+    m_entries.insert(id, entry, entry->m_size);
+
+    return retVal;
+}
+
+void HCdsDidlLiteCache::clear()
+{
+    m_entries.clear();
+}
+
+}
+}
+}
@@ -0,0 +1,120 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef HCDS_DIDLLITECACHE_P_H_
+#define HCDS_DIDLLITECACHE_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include "../cds_model/cds_objects/hobject.h"
+#include "../cds_model/cds_objects/hcontainer.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QCache>
+#include <QtCore/QObject>
+#include <QtCore/QPointer>
+#include <QtCore/QByteArray>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+//
+// Caches the DIDL-Lite excerpts of the objects of a data source per
+// normalized filter as UTF-8. A page of a browse or a search result can be
+// then written by concatenating the excerpts of the objects on the page.
+// The cache is bounded by the number of bytes of the cached excerpts and
+// an object is dropped from the cache when it is modified.
+//
+class HCdsDidlLiteCache :
+    public QObject
+{
+Q_OBJECT
+H_DISABLE_COPY(HCdsDidlLiteCache)
+
+private:
+
+    struct Entry
+    {
+        QPointer<HObject> m_object;
+        // the object the excerpts were serialized from. If an object with
+        // the same ID replaces the object, the entry is rebuilt.
+
+        QHash<QString, QByteArray> m_excerpts;
+        // the excerpts of the object by normalized filter
+
+        qint32 m_size;
+        // the number of bytes in the excerpts
+    };
+
+    HAbstractCdsDataSource* m_dataSource;
+    QCache<QString, Entry> m_entries;
+    // the cost of an entry is its size
+
+private Q_SLOTS:
+
+    void objectModified(
+        Herqq::Upnp::Av::HObject*, const Herqq::Upnp::Av::HObjectEventInfo&);
+
+    void containerModified(
+        Herqq::Upnp::Av::HContainer*,
+        const Herqq::Upnp::Av::HContainerEventInfo&);
+
+    void bulkUpdateFinished(
+        const QStringList& addedIds, const QStringList& modifiedIds,
+        const QStringList& containerIds);
+
+public:
+
+    HCdsDidlLiteCache(
+        HAbstractCdsDataSource* dataSource, qint32 maxSize, QObject* parent);
+
+    virtual ~HCdsDidlLiteCache();
+
+    // returns the filter in a form in which equivalent filters are equal
+    static QString normalize(const QSet<QString>& filter);
+
+    // returns the DIDL-Lite excerpt of the specified object serialized
+    // using the specified filter. The excerpt is serialized and cached on
+    // the first call. An empty array is returned in case the serialization
+    // failed.
+    QByteArray excerpt(HObject* object, const QSet<QString>& filter);
+
+public Q_SLOTS:
+
+    void clear();
+};
+
+}
+}
+}
+
+#endif /* HCDS_DIDLLITECACHE_P_H_ */
@@ -0,0 +1,623 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hcds_freeformquery_p.h"
+
+#include <QtCore/QList>
+#include <QtCore/QXmlStreamWriter>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+namespace
+{
+const char* const ComparisonOperators[][2] =
+{
+    { "=", "=" }, { "!=", "!=" }, { "<", "<" }, { "<=", "<=" },
+    { ">", ">" }, { ">=", ">=" }, { "eq", "=" }, { "ne", "!=" },
+    { "lt", "<" }, { "le", "<=" }, { "gt", ">" }, { "ge", ">=" }, { 0, 0 }
+};
+
+// quotes the specified value for a search criteria
+QString quote(const QString& value)
+{
+    QString retVal = value;
+    retVal.replace('\\', "\\\\").replace('"', "\\\"");
+    return QString("\"%1\"").arg(retVal);
+}
+
+/*******************************************************************************
+ * HFreeFormQueryParser
+ ******************************************************************************/
+class HFreeFormQueryParser
+{
+H_DISABLE_COPY(HFreeFormQueryParser)
+
+private:
+
+    enum TokenType
+    {
+        EndOfInput,
+        Name,
+        Variable,
+        Literal,
+        Symbol
+    };
+
+    struct Token
+    {
+        TokenType m_type;
+        QString m_text;
+
+        Token(TokenType type, const QString& text) :
+            m_type(type), m_text(text)
+        {
+        }
+    };
+
+    const QString m_containerId;
+    QList<Token> m_tokens;
+    qint32 m_pos;
+
+    QString m_variable;
+    // the variable of a FLWOR expression, if any
+
+    static bool isNameChar(QChar ch)
+    {
+        return ch.isLetterOrNumber() || ch == ':' || ch == '@' || ch == '_' ||
+               ch == '-' || ch == '.' || ch == '*';
+    }
+
+    bool tokenize(const QString& request)
+    {
+        for(qint32 i = 0; i < request.size();)
+        {
+            QChar ch = request[i];
+            if (ch.isSpace())
+            {
+                ++i;
+            }
+            else if (ch == '"' || ch == '\'')
+            {
+                // A quote is escaped by doubling it, as in "a ""b"" c".
+                QString value;
+                for(++i; i < request.size(); ++i)
+                {
+                    if (request[i] == ch)
+                    {
+                        if (i + 1 >= request.size() || request[i + 1] != ch)
+                        {
+                            break;
+                        }
+                        ++i;
+                    }
+                    value.append(request[i]);
+                }
+
+                if (i >= request.size())
+                {
+                    return fail("Unterminated string literal");
+                }
+                ++i;
+                m_tokens.append(Token(Literal, value));
+            }
+            else if (ch == '$' || isNameChar(ch))
+            {
+                qint32 start = i;
+                for(++i; i < request.size() && isNameChar(request[i]); ++i)
+                {
+                }
+                TokenType type = ch == '$' ? Variable : Name;
+                m_tokens.append(Token(type, request.mid(start, i - start)));
+            }
+            else
+            {
+                // The two-character symbols are //, != , <= and >=.
+                QString symbol(ch);
+                if (i + 1 < request.size() &&
+                    ((ch == '/' && request[i + 1] == '/') ||
+                     (QString("!<>").contains(ch) && request[i + 1] == '=')))
+                {
+                    symbol.append(request[i + 1]);
+                }
+                else if (!QString("/[](),|=<>").contains(ch))
+                {
+                    return fail(QString("Unexpected character [%1]").arg(ch));
+                }
+                i += symbol.size();
+                m_tokens.append(Token(Symbol, symbol));
+            }
+        }
+
+        m_tokens.append(Token(EndOfInput, QString()));
+        return true;
+    }
+
+    inline const Token& current() const { return m_tokens[m_pos]; }
+
+    bool isName(const char* name) const
+    {
+        return current().m_type == Name &&
+               current().m_text == QLatin1String(name);
+    }
+
+    bool isSymbol(const char* symbol) const
+    {
+        return current().m_type == Symbol &&
+               current().m_text == QLatin1String(symbol);
+    }
+
+    bool accept(TokenType type, const char* text)
+    {
+        if (current().m_type == type &&
+            current().m_text == QLatin1String(text))
+        {
+            ++m_pos;
+            return true;
+        }
+        return false;
+    }
+
+    bool expect(TokenType type, const char* text)
+    {
+        return accept(type, text) ||
+               fail(QString("Expected [%1] at token [%2]").arg(
+                   QLatin1String(text), QString::number(m_pos)));
+    }
+
+    bool fail(const QString& description)
+    {
+        if (m_errorDescription.isEmpty())
+        {
+            m_errorDescription = description;
+        }
+        return false;
+    }
+
+    bool unsupported(const QString& instruction)
+    {
+        m_unsupported = true;
+        return fail(QString(
+            "The instruction [%1] is not supported").arg(instruction));
+    }
+
+    bool parseProperty(QString* property)
+    {
+        // The property of the context item may be prefixed with the variable
+        // of the FLWOR expression or with ".".
+        if (current().m_type == Variable || isName("."))
+        {
+            if (current().m_type == Variable &&
+                current().m_text != m_variable)
+            {
+                return fail(QString(
+                    "Undeclared variable [%1]").arg(current().m_text));
+            }
+            ++m_pos;
+            if (!expect(Symbol, "/"))
+            {
+                return false;
+            }
+        }
+
+        if (current().m_type != Name)
+        {
+            return fail(QString("Expected a property name at token [%1]").arg(
+                QString::number(m_pos)));
+        }
+
+        *property = current().m_text;
+        ++m_pos;
+        return true;
+    }
+
+    bool parseLiteral(QString* value)
+    {
+        // A number is a name as far as the tokenizer is concerned.
+        bool isNumber = false;
+        if (current().m_type == Name)
+        {
+            current().m_text.toDouble(&isNumber);
+        }
+
+        if (current().m_type != Literal && !isNumber)
+        {
+            return fail(QString("Expected a literal at token [%1]").arg(
+                QString::number(m_pos)));
+        }
+
+        *value = current().m_text;
+        ++m_pos;
+        return true;
+    }
+
+    bool parseTerm(QString* criteria)
+    {
+        if (accept(Symbol, "("))
+        {
+            QString expr;
+            if (!parseOr(&expr) || !expect(Symbol, ")"))
+            {
+                return false;
+            }
+            *criteria = QString("(%1)").arg(expr);
+            return true;
+        }
+
+        if (current().m_type == Name && m_tokens[m_pos + 1].m_type == Symbol &&
+            m_tokens[m_pos + 1].m_text == QLatin1String("("))
+        {
+            QString function = current().m_text;
+            m_pos += 2;
+
+            QString property, value;
+            if (function == QLatin1String("contains"))
+            {
+                if (!parseProperty(&property) || !expect(Symbol, ",") ||
+                    !parseLiteral(&value))
+                {
+                    return false;
+                }
+                *criteria = QString("%1 contains %2").arg(
+                    property, quote(value));
+            }
+            else if (function == QLatin1String("exists") ||
+                     function == QLatin1String("empty"))
+            {
+                if (!parseProperty(&property))
+                {
+                    return false;
+                }
+                *criteria = QString("%1 exists %2").arg(property,
+                    function == QLatin1String("exists") ? "true" : "false");
+            }
+            else
+            {
+                return unsupported(function);
+            }
+            return expect(Symbol, ")");
+        }
+
+        QString property, value;
+        if (!parseProperty(&property))
+        {
+            return false;
+        }
+
+        for(qint32 i = 0; ComparisonOperators[i][0]; ++i)
+        {
+            if ((current().m_type == Symbol || current().m_type == Name) &&
+                current().m_text == QLatin1String(ComparisonOperators[i][0]))
+            {
+                ++m_pos;
+                if (!parseLiteral(&value))
+                {
+                    return false;
+                }
+                *criteria = QString("%1 %2 %3").arg(
+                    property, ComparisonOperators[i][1], quote(value));
+                return true;
+            }
+        }
+
+        return fail(QString("Expected a comparison at token [%1]").arg(
+            QString::number(m_pos)));
+    }
+
+    bool parseAnd(QString* criteria)
+    {
+        if (!parseTerm(criteria))
+        {
+            return false;
+        }
+
+        while(accept(Name, "and"))
+        {
+            QString right;
+            if (!parseTerm(&right))
+            {
+                return false;
+            }
+            criteria->append(" and ").append(right);
+        }
+        return true;
+    }
+
+    bool parseOr(QString* criteria)
+    {
+        if (!parseAnd(criteria))
+        {
+            return false;
+        }
+
+        while(accept(Name, "or"))
+        {
+            QString right;
+            if (!parseAnd(&right))
+            {
+                return false;
+            }
+            *criteria = QString("(%1) or (%2)").arg(*criteria, right);
+        }
+        return true;
+    }
+
+    bool parseStep(QStringList* conditions)
+    {
+        bool descendants = accept(Symbol, "//");
+        if (!descendants && !expect(Symbol, "/"))
+        {
+            return false;
+        }
+
+        if (!descendants)
+        {
+            conditions->append(
+                QString("@parentID = %1").arg(quote(m_containerId)));
+        }
+
+        if (accept(Name, "item"))
+        {
+            conditions->append("upnp:class derivedfrom \"object.item\"");
+        }
+        else if (accept(Name, "container"))
+        {
+            conditions->append("upnp:class derivedfrom \"object.container\"");
+        }
+        else if (!accept(Name, "*"))
+        {
+            return current().m_type == Name ?
+                unsupported(current().m_text) :
+                fail("Expected a node test after the path separator");
+        }
+
+        if (accept(Symbol, "["))
+        {
+            QString predicate;
+            if (!parseOr(&predicate) || !expect(Symbol, "]"))
+            {
+                return false;
+            }
+            conditions->append(QString("(%1)").arg(predicate));
+        }
+
+        return true;
+    }
+
+    bool parseProjection()
+    {
+        if (!accept(Symbol, "/"))
+        {
+            m_projection.insert("*");
+            return true;
+        }
+
+        bool list = accept(Symbol, "(");
+        do
+        {
+            if (current().m_type != Name)
+            {
+                return fail(QString(
+                    "Expected a property name at token [%1]").arg(
+                        QString::number(m_pos)));
+            }
+            m_projection.insert(current().m_text);
+            ++m_pos;
+        }
+        while(list && (accept(Symbol, ",") || accept(Symbol, "|")));
+
+        return !list || expect(Symbol, ")");
+    }
+
+    bool parseFlwor(QStringList* conditions)
+    {
+        if (current().m_type != Variable)
+        {
+            return fail("Expected a variable after [for]");
+        }
+        m_variable = current().m_text;
+        ++m_pos;
+
+        if (!expect(Name, "in") || !parseStep(conditions))
+        {
+            return false;
+        }
+
+        if (accept(Name, "where"))
+        {
+            QString predicate;
+            if (!parseOr(&predicate))
+            {
+                return false;
+            }
+            conditions->append(QString("(%1)").arg(predicate));
+        }
+
+        if (accept(Name, "order"))
+        {
+            if (!expect(Name, "by"))
+            {
+                return false;
+            }
+
+            do
+            {
+                QString property;
+                if (!parseProperty(&property))
+                {
+                    return false;
+                }
+                bool descending = accept(Name, "descending");
+                if (!descending)
+                {
+                    accept(Name, "ascending");
+                }
+                m_sortCriteria.append(
+                    QString(descending ? "-" : "+").append(property));
+            }
+            while(accept(Symbol, ","));
+        }
+
+        if (!expect(Name, "return"))
+        {
+            return false;
+        }
+        else if (current().m_type != Variable ||
+                 current().m_text != m_variable)
+        {
+            return fail("Expected the variable of the FLWOR expression");
+        }
+        ++m_pos;
+
+        return parseProjection();
+    }
+
+public:
+
+    QString m_criteria;
+    QStringList m_sortCriteria;
+    QSet<QString> m_projection;
+
+    bool m_unsupported;
+    QString m_errorDescription;
+
+    explicit HFreeFormQueryParser(const QString& containerId) :
+        m_containerId(containerId), m_tokens(), m_pos(0), m_variable(),
+        m_criteria(), m_sortCriteria(), m_projection(), m_unsupported(false),
+        m_errorDescription()
+    {
+    }
+
+    bool parse(const QString& request)
+    {
+        if (!tokenize(request))
+        {
+            return false;
+        }
+
+        QStringList conditions;
+        if (accept(Name, "for"))
+        {
+            if (!parseFlwor(&conditions))
+            {
+                return false;
+            }
+        }
+        else if (current().m_type == Name)
+        {
+            // let, declare, doc() and the like
+            return unsupported(current().m_text);
+        }
+        else if (!parseStep(&conditions) || !parseProjection())
+        {
+            return false;
+        }
+
+        if (current().m_type != EndOfInput)
+        {
+            return current().m_type == Name ?
+                unsupported(current().m_text) :
+                fail(QString("Unexpected [%1] at token [%2]").arg(
+                    current().m_text, QString::number(m_pos)));
+        }
+
+        m_criteria = conditions.join(" and ");
+        return true;
+    }
+};
+}
+
+/*******************************************************************************
+ * HCdsFreeFormQuery
+ ******************************************************************************/
+HCdsFreeFormQuery::HCdsFreeFormQuery() :
+    m_searchQuery(), m_sortCriteria(), m_projection(), m_unsupported(false),
+    m_lastErrorDescription()
+{
+}
+
+HCdsFreeFormQuery::~HCdsFreeFormQuery()
+{
+}
+
+bool HCdsFreeFormQuery::compile(
+    const QString& containerId, const QString& queryRequest)
+{
+    m_sortCriteria.clear();
+    m_projection.clear();
+    m_unsupported = false;
+    m_lastErrorDescription.clear();
+
+    HFreeFormQueryParser parser(containerId);
+    if (!parser.parse(queryRequest))
+    {
+        m_unsupported = parser.m_unsupported;
+        m_lastErrorDescription = parser.m_errorDescription;
+        return false;
+    }
+
+    // Conditions on properties that cannot be searched are not supported,
+    // although they are valid XQuery.
+    if (!m_searchQuery.compile(parser.m_criteria))
+    {
+        m_unsupported = true;
+        m_lastErrorDescription = m_searchQuery.lastErrorDescription();
+        return false;
+    }
+
+    m_sortCriteria = parser.m_sortCriteria;
+    m_projection = parser.m_projection;
+
+    return true;
+}
+
+QString HCdsFreeFormQuery::capabilities()
+{
+    QString retVal;
+    QXmlStreamWriter writer(&retVal);
+
+    writer.writeStartDocument();
+    writer.writeStartElement("FFQCapabilities");
+    writer.writeNamespace("http://purl.org/dc/elements/1.1/", "dc");
+    writer.writeNamespace("urn:schemas-upnp-org:metadata-1-0/upnp/", "upnp");
+
+    foreach(const QString& property, HCdsSearchQuery::searchCapabilities())
+    {
+        writer.writeStartElement("property");
+        writer.writeAttribute("name", property);
+        writer.writeEndElement();
+    }
+
+    writer.writeEndElement();
+    writer.writeEndDocument();
+
+    return retVal;
+}
+
+}
+}
+}
@@ -0,0 +1,130 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HCDS_FREEFORMQUERY_P_H_
+#define HCDS_FREEFORMQUERY_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include "hcds_searchquery_p.h"
+
+#include <QtCore/QSet>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+//
+// A FreeFormQuery request of the ContentDirectory:3 specification
+// (Section 2.5.21) compiled into a search query, a sort criteria and a
+// projection. The request is a subset of XQuery evaluated against the
+// DIDL-Lite document of the container the request targets:
+//
+//   query      := path | flwor
+//   path       := step [ "/" projection ]
+//   flwor      := "for" $var "in" step [ "where" expr ]
+//                 [ "order" "by" key { "," key } ]
+//                 "return" $var [ "/" projection ]
+//   step       := ( "/" | "//" ) nodetest [ "[" expr "]" ]
+//   nodetest   := "item" | "container" | "*"
+//   projection := property | "(" property { ( "," | "|" ) property } ")"
+//   expr       := term { ( "and" | "or" ) term }, with "and" binding tighter
+//   term       := "(" expr ")" | property op literal
+//                 | "contains" "(" property "," literal ")"
+//                 | ( "exists" | "empty" ) "(" property ")"
+//   key        := property [ "ascending" | "descending" ]
+//
+// where op is one of the general (=, !=, <, <=, >, >=) or the value
+// (eq, ne, lt, le, gt, ge) comparisons and a property may be prefixed with
+// the variable of the FLWOR expression, as in $i/dc:title. A "/" step
+// selects the children of the container and a "//" step all of its
+// descendants.
+//
+// The conditions are translated into a search criteria, which is why the
+// query is evaluated with the search indexes of the data source and the
+// properties in the conditions have to be in the search capabilities.
+//
+class HCdsFreeFormQuery
+{
+H_DISABLE_COPY(HCdsFreeFormQuery)
+
+private:
+
+    HCdsSearchQuery m_searchQuery;
+
+    QStringList m_sortCriteria;
+    // in the form used by Search, e.g. "+dc:title"
+
+    QSet<QString> m_projection;
+    // the properties returned for the matching objects in the form of the
+    // filter of Search. "*" in case the whole objects are returned
+
+    bool m_unsupported;
+    QString m_lastErrorDescription;
+
+public:
+
+    HCdsFreeFormQuery();
+    ~HCdsFreeFormQuery();
+
+    // compiles the specified request targeting the specified container.
+    // Returns false in case the request is not valid or it uses XQuery
+    // that is not supported, which is told by isUnsupported().
+    bool compile(const QString& containerId, const QString& queryRequest);
+
+    inline bool isUnsupported() const { return m_unsupported; }
+
+    inline QString lastErrorDescription() const
+    {
+        return m_lastErrorDescription;
+    }
+
+    inline const HCdsSearchQuery& searchQuery() const
+    {
+        return m_searchQuery;
+    }
+
+    inline QStringList sortCriteria() const { return m_sortCriteria; }
+    inline QSet<QString> projection() const { return m_projection; }
+
+    // an FFQCapabilities document listing the properties that can be used
+    // in the conditions of a request
+    static QString capabilities();
+};
+
+}
+}
+}
+
+#endif /* HCDS_FREEFORMQUERY_P_H_ */
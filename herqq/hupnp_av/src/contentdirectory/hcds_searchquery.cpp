@@ -0,0 +1,872 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hcds_searchquery_p.h"
+
+#include "../cds_model/hcds_classhierarchy_p.h"
+#include "../cds_model/cds_objects/hobject.h"
+#include "../cds_model/datasource/hcds_searchindex_p.h"
+#include "../cds_model/model_mgmt/hcdsproperties.h"
+#include "../cds_model/model_mgmt/hcdspropertyinfo.h"
+
+#include <QtCore/QDateTime>
+#include <QtCore/QVariant>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+/*******************************************************************************
+ * HCdsSearchPredicate
+ ******************************************************************************/
+class HCdsSearchPredicate
+{
+H_DISABLE_COPY(HCdsSearchPredicate)
+
+public:
+
+    HCdsSearchPredicate(){}
+    virtual ~HCdsSearchPredicate(){}
+
+    virtual bool evaluate(const HObject*) const = 0;
+
+    // inserts the IDs of the objects that may match the predicate to the
+    // specified set. Returns false in case the index cannot narrow down
+    // the objects, which means that every object has to be evaluated.
+    virtual bool plan(const HCdsSearchIndex&, QSet<QString>*) const
+    {
+        return false;
+    }
+
+    // as plan(), but ignores the relations on the scheduled times, which
+    // HAndPredicate plans as a single window instead
+    virtual bool planTerms(
+        const HCdsSearchIndex& index, QSet<QString>* ids) const
+    {
+        return plan(index, ids);
+    }
+
+    // narrows the specified window with the relations on the scheduled times
+    // that all the matching objects satisfy. Returns false in case the
+    // predicate does not restrict the scheduled times.
+    virtual bool restrictSchedule(HCdsScheduleWindow*) const
+    {
+        return false;
+    }
+};
+
+namespace
+{
+const char* const SearchCapabilities[] =
+{
+    "@id", "@parentID", "@refID", "@childCount", "upnp:class",
+    "dc:title", "dc:creator", "dc:date", "dc:description", "dc:publisher",
+    "dc:contributor", "dc:language", "upnp:artist", "upnp:actor",
+    "upnp:author", "upnp:album", "upnp:genre", "upnp:originalTrackNumber",
+    "upnp:producer", "upnp:director", "upnp:playList", "upnp:longDescription",
+    "upnp:storageMedium", "upnp:objectUpdateID", "upnp:containerUpdateID",
+    "upnp:channelName", "upnp:channelNr", "upnp:programTitle",
+    "upnp:seriesTitle", "upnp:scheduledStartTime", "upnp:scheduledEndTime", 0
+};
+
+bool isSearchable(const QString& property)
+{
+    for(qint32 i = 0; SearchCapabilities[i]; ++i)
+    {
+        if (property == QLatin1String(SearchCapabilities[i]))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*******************************************************************************
+ * HAndPredicate, HOrPredicate
+ ******************************************************************************/
+class HAndPredicate :
+    public HCdsSearchPredicate
+{
+private:
+
+    HCdsSearchPredicate* m_left;
+    HCdsSearchPredicate* m_right;
+
+public:
+
+    HAndPredicate(HCdsSearchPredicate* left, HCdsSearchPredicate* right) :
+        m_left(left), m_right(right)
+    {
+    }
+
+    virtual ~HAndPredicate()
+    {
+        delete m_left;
+        delete m_right;
+    }
+
+    virtual bool evaluate(const HObject* object) const
+    {
+        return m_left->evaluate(object) && m_right->evaluate(object);
+    }
+
+    virtual bool plan(const HCdsSearchIndex& index, QSet<QString>* ids) const
+    {
+        // A bound on the start or the end time alone matches most of the
+        // programs of an EPG, which is why the bounds of the whole
+        // conjunction are looked up together.
+        HCdsScheduleWindow window;
+        QSet<QString> scheduled, terms;
+        bool windowPlanned = restrictSchedule(&window) &&
+            index.findScheduled(window, &scheduled);
+        bool termsPlanned = planTerms(index, &terms);
+
+        if (windowPlanned && termsPlanned)
+        {
+            ids->unite(scheduled.intersect(terms));
+        }
+        else if (windowPlanned || termsPlanned)
+        {
+            ids->unite(windowPlanned ? scheduled : terms);
+        }
+
+        return windowPlanned || termsPlanned;
+    }
+
+    virtual bool planTerms(
+        const HCdsSearchIndex& index, QSet<QString>* ids) const
+    {
+        QSet<QString> left, right;
+        bool leftPlanned = m_left->planTerms(index, &left);
+        bool rightPlanned = m_right->planTerms(index, &right);
+
+        if (leftPlanned && rightPlanned)
+        {
+            ids->unite(left.intersect(right));
+        }
+        else if (leftPlanned || rightPlanned)
+        {
+            ids->unite(leftPlanned ? left : right);
+        }
+
+        return leftPlanned || rightPlanned;
+    }
+
+    virtual bool restrictSchedule(HCdsScheduleWindow* window) const
+    {
+        bool left = m_left->restrictSchedule(window);
+        bool right = m_right->restrictSchedule(window);
+        return left || right;
+    }
+};
+
+class HOrPredicate :
+    public HCdsSearchPredicate
+{
+private:
+
+    HCdsSearchPredicate* m_left;
+    HCdsSearchPredicate* m_right;
+
+public:
+
+    HOrPredicate(HCdsSearchPredicate* left, HCdsSearchPredicate* right) :
+        m_left(left), m_right(right)
+    {
+    }
+
+    virtual ~HOrPredicate()
+    {
+        delete m_left;
+        delete m_right;
+    }
+
+    virtual bool evaluate(const HObject* object) const
+    {
+        return m_left->evaluate(object) || m_right->evaluate(object);
+    }
+
+    virtual bool plan(const HCdsSearchIndex& index, QSet<QString>* ids) const
+    {
+        QSet<QString> left, right;
+        if (!m_left->plan(index, &left) || !m_right->plan(index, &right))
+        {
+            return false;
+        }
+
+        ids->unite(left).unite(right);
+        return true;
+    }
+};
+
+/*******************************************************************************
+ * HExistsPredicate
+ ******************************************************************************/
+class HExistsPredicate :
+    public HCdsSearchPredicate
+{
+private:
+
+    QString m_property;
+    bool m_exists;
+
+public:
+
+    HExistsPredicate(const QString& property, bool exists) :
+        m_property(property), m_exists(exists)
+    {
+    }
+
+    virtual bool evaluate(const HObject* object) const
+    {
+        QList<QVariant> values;
+        HCdsSearchIndex::getValues(object, m_property, &values);
+        return values.isEmpty() != m_exists;
+    }
+};
+
+/*******************************************************************************
+ * HRelationPredicate
+ ******************************************************************************/
+class HRelationPredicate :
+    public HCdsSearchPredicate
+{
+public:
+
+    enum Operator
+    {
+        Equal,
+        NotEqual,
+        Less,
+        LessOrEqual,
+        Greater,
+        GreaterOrEqual,
+        Contains,
+        DoesNotContain,
+        DerivedFrom
+    };
+
+private:
+
+    QString m_property;
+    Operator m_op;
+
+    QString m_operand;
+    // the operand as specified in the search criteria
+
+    double m_numericOperand;
+    bool m_isNumeric;
+    // the operand converted to a number, if it is one
+
+    QDateTime m_dateTimeOperand;
+    // the operand converted to a date, if it is one
+
+    qint32 m_classId;
+    // the ID of the operand in the CDS class hierarchy, if it is
+    // a standard class
+
+    bool isScheduleRelation() const
+    {
+        if (!m_dateTimeOperand.isValid() ||
+            (m_property != QLatin1String("upnp:scheduledStartTime") &&
+             m_property != QLatin1String("upnp:scheduledEndTime")))
+        {
+            return false;
+        }
+
+        switch(m_op)
+        {
+        case Equal:
+        case Less:
+        case LessOrEqual:
+        case Greater:
+        case GreaterOrEqual:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    qint32 compare(const QVariant& value) const
+    {
+        switch(value.type())
+        {
+        case QVariant::Int:
+        case QVariant::UInt:
+        case QVariant::LongLong:
+        case QVariant::ULongLong:
+        case QVariant::Double:
+            if (m_isNumeric)
+            {
+                double tmp = value.toDouble();
+                return tmp < m_numericOperand ? -1 :
+                       tmp > m_numericOperand ?  1 : 0;
+            }
+            break;
+
+        case QVariant::Date:
+        case QVariant::DateTime:
+            if (m_dateTimeOperand.isValid())
+            {
+                QDateTime tmp = value.toDateTime();
+                return tmp < m_dateTimeOperand ? -1 :
+                       tmp > m_dateTimeOperand ?  1 : 0;
+            }
+            break;
+
+        default:
+            break;
+        }
+
+        return QString::compare(
+            value.toString(), m_operand, Qt::CaseInsensitive);
+    }
+
+    bool evaluate(const QVariant& value) const
+    {
+        switch(m_op)
+        {
+        case Equal:
+            return compare(value) == 0;
+        case NotEqual:
+            return compare(value) != 0;
+        case Less:
+            return compare(value) < 0;
+        case LessOrEqual:
+            return compare(value) <= 0;
+        case Greater:
+            return compare(value) > 0;
+        case GreaterOrEqual:
+            return compare(value) >= 0;
+        case Contains:
+            return value.toString().contains(m_operand, Qt::CaseInsensitive);
+        case DerivedFrom:
+            return HCdsClassHierarchy::isDerivedFrom(
+                value.toString(), m_operand, m_classId);
+        default:
+            Q_ASSERT(false);
+            return false;
+        }
+    }
+
+public:
+
+    HRelationPredicate(
+        const QString& property, Operator op, const QString& operand) :
+            m_property(property), m_op(op), m_operand(operand),
+            m_numericOperand(0), m_isNumeric(false), m_dateTimeOperand(),
+            m_classId(-1)
+    {
+        m_numericOperand = operand.toDouble(&m_isNumeric);
+        m_dateTimeOperand = QDateTime::fromString(operand, Qt::ISODate);
+        if (op == DerivedFrom)
+        {
+            m_classId = HCdsClassHierarchy::id(operand);
+        }
+    }
+
+    virtual bool evaluate(const HObject* object) const
+    {
+        QList<QVariant> values;
+        HCdsSearchIndex::getValues(object, m_property, &values);
+
+        if (m_op == DoesNotContain)
+        {
+            if (values.isEmpty())
+            {
+                return false;
+            }
+
+            foreach(const QVariant& value, values)
+            {
+                if (value.toString().contains(m_operand, Qt::CaseInsensitive))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+        else if (m_op == NotEqual)
+        {
+            // A multi-valued property is not equal to the operand only if
+            // none of its values are.
+            if (values.isEmpty())
+            {
+                return false;
+            }
+
+            foreach(const QVariant& value, values)
+            {
+                if (compare(value) == 0)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        foreach(const QVariant& value, values)
+        {
+            if (evaluate(value))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    virtual bool plan(const HCdsSearchIndex& index, QSet<QString>* ids) const
+    {
+        HCdsScheduleWindow window;
+        if (restrictSchedule(&window))
+        {
+            return index.findScheduled(window, ids);
+        }
+
+        bool isClass = m_property == QLatin1String("upnp:class");
+        switch(m_op)
+        {
+        case Equal:
+            return isClass ?
+                index.findClass(m_operand, ids) :
+                index.findEqual(m_property, m_operand, ids);
+        case DerivedFrom:
+            return isClass && index.findDerivedFrom(m_operand, ids);
+        case Contains:
+            return index.findContaining(m_property, m_operand, ids);
+        default:
+            return false;
+        }
+    }
+
+    virtual bool planTerms(
+        const HCdsSearchIndex& index, QSet<QString>* ids) const
+    {
+        return !isScheduleRelation() && plan(index, ids);
+    }
+
+    virtual bool restrictSchedule(HCdsScheduleWindow* window) const
+    {
+        if (!isScheduleRelation())
+        {
+            return false;
+        }
+
+        // The bounds are inclusive, which makes the window a superset of
+        // the matches of the strict relations.
+        qint64 time = m_dateTimeOperand.toMSecsSinceEpoch();
+        bool isStart = m_property == QLatin1String("upnp:scheduledStartTime");
+        qint64* min = isStart ? &window->m_startMin : &window->m_endMin;
+        qint64* max = isStart ? &window->m_startMax : &window->m_endMax;
+
+        if (m_op == Equal || m_op == Greater || m_op == GreaterOrEqual)
+        {
+            *min = qMax(*min, time);
+        }
+        if (m_op == Equal || m_op == Less || m_op == LessOrEqual)
+        {
+            *max = qMin(*max, time);
+        }
+        return true;
+    }
+};
+
+/*******************************************************************************
+ * HSearchCriteriaParser
+ ******************************************************************************/
+class HSearchCriteriaParser
+{
+H_DISABLE_COPY(HSearchCriteriaParser)
+
+private:
+
+    enum TokenType
+    {
+        EndOfInput,
+        LeftParenthesis,
+        RightParenthesis,
+        Word,
+        Symbol,
+        QuotedValue
+    };
+
+    const QString m_criteria;
+    qint32 m_pos;
+
+    TokenType m_tokenType;
+    QString m_token;
+
+    QString m_errorDescription;
+
+    static bool isSymbolChar(QChar ch)
+    {
+        return ch == '=' || ch == '!' || ch == '<' || ch == '>';
+    }
+
+    bool next()
+    {
+        m_token.clear();
+
+        while(m_pos < m_criteria.size() && m_criteria[m_pos].isSpace())
+        {
+            ++m_pos;
+        }
+
+        if (m_pos >= m_criteria.size())
+        {
+            m_tokenType = EndOfInput;
+            return true;
+        }
+
+        QChar ch = m_criteria[m_pos];
+        if (ch == '(')
+        {
+            ++m_pos;
+            m_tokenType = LeftParenthesis;
+        }
+        else if (ch == ')')
+        {
+            ++m_pos;
+            m_tokenType = RightParenthesis;
+        }
+        else if (ch == '"')
+        {
+            m_tokenType = QuotedValue;
+            for(++m_pos; m_pos < m_criteria.size(); ++m_pos)
+            {
+                ch = m_criteria[m_pos];
+                if (ch == '\\' && m_pos + 1 < m_criteria.size())
+                {
+                    m_token.append(m_criteria[++m_pos]);
+                }
+                else if (ch == '"')
+                {
+                    ++m_pos;
+                    return true;
+                }
+                else
+                {
+                    m_token.append(ch);
+                }
+            }
+
+            m_errorDescription = "Unterminated quoted value";
+            return false;
+        }
+        else if (isSymbolChar(ch))
+        {
+            m_tokenType = Symbol;
+            for(; m_pos < m_criteria.size() &&
+                  isSymbolChar(m_criteria[m_pos]); ++m_pos)
+            {
+                m_token.append(m_criteria[m_pos]);
+            }
+        }
+        else
+        {
+            m_tokenType = Word;
+            for(; m_pos < m_criteria.size(); ++m_pos)
+            {
+                ch = m_criteria[m_pos];
+                if (ch.isSpace() || ch == '(' || ch == ')' || ch == '"' ||
+                    isSymbolChar(ch))
+                {
+                    break;
+                }
+                m_token.append(ch);
+            }
+        }
+
+        return true;
+    }
+
+    bool isWord(const char* word) const
+    {
+        return m_tokenType == Word &&
+               m_token.compare(QLatin1String(word), Qt::CaseInsensitive) == 0;
+    }
+
+    HCdsSearchPredicate* fail(const QString& description)
+    {
+        if (m_errorDescription.isEmpty())
+        {
+            m_errorDescription = description;
+        }
+        return 0;
+    }
+
+    HCdsSearchPredicate* parseOr()
+    {
+        HCdsSearchPredicate* left = parseAnd();
+        while(left && isWord("or"))
+        {
+            if (!next())
+            {
+                delete left;
+                return 0;
+            }
+
+            HCdsSearchPredicate* right = parseAnd();
+            if (!right)
+            {
+                delete left;
+                return 0;
+            }
+            left = new HOrPredicate(left, right);
+        }
+        return left;
+    }
+
+    HCdsSearchPredicate* parseAnd()
+    {
+        HCdsSearchPredicate* left = parsePrimary();
+        while(left && isWord("and"))
+        {
+            if (!next())
+            {
+                delete left;
+                return 0;
+            }
+
+            HCdsSearchPredicate* right = parsePrimary();
+            if (!right)
+            {
+                delete left;
+                return 0;
+            }
+            left = new HAndPredicate(left, right);
+        }
+        return left;
+    }
+
+    HCdsSearchPredicate* parsePrimary()
+    {
+        if (m_tokenType == LeftParenthesis)
+        {
+            if (!next())
+            {
+                return 0;
+            }
+
+            HCdsSearchPredicate* retVal = parseOr();
+            if (!retVal)
+            {
+                return 0;
+            }
+            else if (m_tokenType != RightParenthesis)
+            {
+                delete retVal;
+                return fail("Missing closing parenthesis");
+            }
+            else if (!next())
+            {
+                delete retVal;
+                return 0;
+            }
+            return retVal;
+        }
+
+        return parseRelation();
+    }
+
+    HCdsSearchPredicate* parseRelation()
+    {
+        if (m_tokenType != Word)
+        {
+            return fail(QString("Expected a property name at [%1]").arg(
+                QString::number(m_pos)));
+        }
+
+        QString property = m_token;
+        if (!isSearchable(property) ||
+            !HCdsProperties::instance().get(property).isValid())
+        {
+            return fail(QString(
+                "The property [%1] cannot be searched").arg(property));
+        }
+
+        if (!next())
+        {
+            return 0;
+        }
+
+        if (isWord("exists"))
+        {
+            if (!next())
+            {
+                return 0;
+            }
+
+            bool exists = isWord("true");
+            if (!exists && !isWord("false"))
+            {
+                return fail("Expected true or false after exists");
+            }
+
+            return next() ? new HExistsPredicate(property, exists) : 0;
+        }
+
+        HRelationPredicate::Operator op;
+        if (m_tokenType == Symbol)
+        {
+            typedef HRelationPredicate P;
+            if (m_token == "=") { op = P::Equal; }
+            else if (m_token == "!=") { op = P::NotEqual; }
+            else if (m_token == "<") { op = P::Less; }
+            else if (m_token == "<=") { op = P::LessOrEqual; }
+            else if (m_token == ">") { op = P::Greater; }
+            else if (m_token == ">=") { op = P::GreaterOrEqual; }
+            else
+            {
+                return fail(QString("Invalid operator [%1]").arg(m_token));
+            }
+        }
+        else if (isWord("contains"))
+        {
+            op = HRelationPredicate::Contains;
+        }
+        else if (isWord("doesNotContain"))
+        {
+            op = HRelationPredicate::DoesNotContain;
+        }
+        else if (isWord("derivedfrom"))
+        {
+            op = HRelationPredicate::DerivedFrom;
+        }
+        else
+        {
+            return fail(QString("Invalid operator [%1]").arg(m_token));
+        }
+
+        if (!next())
+        {
+            return 0;
+        }
+        else if (m_tokenType != QuotedValue)
+        {
+            return fail(QString(
+                "Expected a quoted value after the operator at [%1]").arg(
+                    QString::number(m_pos)));
+        }
+
+        QString operand = m_token;
+        return next() ? new HRelationPredicate(property, op, operand) : 0;
+    }
+
+public:
+
+    HSearchCriteriaParser(const QString& criteria) :
+        m_criteria(criteria), m_pos(0), m_tokenType(EndOfInput), m_token(),
+        m_errorDescription()
+    {
+    }
+
+    HCdsSearchPredicate* parse()
+    {
+        if (!next())
+        {
+            return 0;
+        }
+
+        HCdsSearchPredicate* retVal = parseOr();
+        if (retVal && m_tokenType != EndOfInput)
+        {
+            delete retVal;
+            return fail(QString("Unexpected input at [%1]").arg(
+                QString::number(m_pos)));
+        }
+
+        return retVal;
+    }
+
+    inline QString errorDescription() const { return m_errorDescription; }
+};
+}
+
+/*******************************************************************************
+ * HCdsSearchQuery
+ ******************************************************************************/
+HCdsSearchQuery::HCdsSearchQuery() :
+    m_root(0), m_lastErrorDescription()
+{
+}
+
+HCdsSearchQuery::~HCdsSearchQuery()
+{
+    delete m_root;
+}
+
+bool HCdsSearchQuery::compile(const QString& searchCriteria)
+{
+    delete m_root;
+    m_root = 0;
+    m_lastErrorDescription.clear();
+
+    QString criteria = searchCriteria.trimmed();
+    if (criteria.isEmpty() || criteria == "*")
+    {
+        // An empty criteria is not valid according to the grammar, but it is
+        // sent by some control points when they mean "*".
+        return true;
+    }
+
+    HSearchCriteriaParser parser(criteria);
+    m_root = parser.parse();
+    if (!m_root)
+    {
+        m_lastErrorDescription = parser.errorDescription();
+        return false;
+    }
+
+    return true;
+}
+
+bool HCdsSearchQuery::matches(const HObject* object) const
+{
+    Q_ASSERT(object);
+    return !m_root || m_root->evaluate(object);
+}
+
+bool HCdsSearchQuery::plan(
+    const HCdsSearchIndex& index, QSet<QString>* candidates) const
+{
+    Q_ASSERT(candidates);
+    return m_root && m_root->plan(index, candidates);
+}
+
+QStringList HCdsSearchQuery::searchCapabilities()
+{
+    QStringList retVal;
+    for(qint32 i = 0; SearchCapabilities[i]; ++i)
+    {
+        retVal.append(QLatin1String(SearchCapabilities[i]));
+    }
+    return retVal;
+}
+
+}
+}
+}
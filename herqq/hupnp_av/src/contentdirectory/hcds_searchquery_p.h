@@ -0,0 +1,99 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HCDS_SEARCHQUERY_P_H_
+#define HCDS_SEARCHQUERY_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include <HUpnpAv/HUpnpAv>
+
+#include <QtCore/QSet>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+class HCdsSearchIndex;
+class HCdsSearchPredicate;
+
+//
+// A search criteria string of the ContentDirectory:3 specification
+// (Section 2.3.13) compiled into a tree of predicates. The criteria is
+// parsed and the property names and the operands are resolved once, after
+// which the query can be evaluated against any number of CDS objects.
+//
+class HCdsSearchQuery
+{
+H_DISABLE_COPY(HCdsSearchQuery)
+
+private:
+
+    HCdsSearchPredicate* m_root;
+    // the root of the predicate tree. If this is null the query matches
+    // every object, which is the case with the search criteria "*".
+
+    QString m_lastErrorDescription;
+
+public:
+
+    HCdsSearchQuery();
+    ~HCdsSearchQuery();
+
+    // compiles the specified search criteria, replacing the previously
+    // compiled query, if any. Returns false in case the criteria does not
+    // follow the grammar or it refers to a property that cannot be searched.
+    bool compile(const QString& searchCriteria);
+
+    inline QString lastErrorDescription() const
+    {
+        return m_lastErrorDescription;
+    }
+
+    bool matches(const HObject* object) const;
+
+    // inserts the IDs of the objects that may match the query to the
+    // specified set using the specified index. Returns false in case the
+    // index cannot be used to narrow down the objects to be evaluated.
+    bool plan(const HCdsSearchIndex& index, QSet<QString>* candidates) const;
+
+    // the names of the properties that can appear in a search criteria
+    static QStringList searchCapabilities();
+};
+
+}
+}
+}
+
+#endif /* HCDS_SEARCHQUERY_P_H_ */
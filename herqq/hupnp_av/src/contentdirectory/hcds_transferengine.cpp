@@ -0,0 +1,713 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hcds_transferengine_p.h"
+#include "hcontentdirectory_info.h"
+
+#include "../common/hresource.h"
+#include "../common/hprotocolinfo.h"
+#include "../cds_model/cds_objects/hitem.h"
+#include "../cds_model/datasource/habstract_cds_datasource.h"
+
+#include <HUpnpCore/private/hlogger_p.h>
+
+#include <QtCore/QStringList>
+#include <QtNetwork/QNetworkReply>
+#include <QtNetwork/QNetworkRequest>
+#include <QtNetwork/QNetworkAccessManager>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+namespace
+{
+quint32 clamp(qint64 value)
+{
+    return static_cast<quint32>(
+        qBound(Q_INT64_C(0), value, Q_INT64_C(0xffffffff)));
+}
+
+bool isResumable(QNetworkReply::NetworkError error)
+{
+    switch(error)
+    {
+    case QNetworkReply::RemoteHostClosedError:
+    case QNetworkReply::TimeoutError:
+    case QNetworkReply::TemporaryNetworkFailureError:
+        return true;
+    default:
+        return false;
+    }
+}
+}
+
+/*******************************************************************************
+ * HCdsThrottledReader
+ ******************************************************************************/
+HCdsThrottledReader::HCdsThrottledReader(
+    QIODevice* source, qint64 budget, QObject* parent) :
+        QIODevice(parent), m_source(source), m_budget(budget)
+{
+    Q_ASSERT(m_source);
+    open(QIODevice::ReadOnly);
+}
+
+HCdsThrottledReader::~HCdsThrottledReader()
+{
+    delete m_source;
+}
+
+qint64 HCdsThrottledReader::readData(char* data, qint64 maxSize)
+{
+    if (m_budget == 0)
+    {
+        return 0;
+    }
+
+    qint64 size = m_budget > 0 ? qMin(maxSize, m_budget) : maxSize;
+    qint64 retVal = m_source->read(data, size);
+    if (retVal > 0 && m_budget > 0)
+    {
+        m_budget -= retVal;
+    }
+
+    return retVal;
+}
+
+qint64 HCdsThrottledReader::writeData(const char* /*data*/, qint64 /*maxSize*/)
+{
+    return -1;
+}
+
+bool HCdsThrottledReader::isSequential() const
+{
+    return true;
+}
+
+bool HCdsThrottledReader::atEnd() const
+{
+    return m_source->atEnd() && QIODevice::bytesAvailable() == 0;
+}
+
+qint64 HCdsThrottledReader::bytesAvailable() const
+{
+    qint64 retVal = m_source->bytesAvailable();
+    if (m_budget >= 0)
+    {
+        retVal = qMin(retVal, m_budget);
+    }
+
+    return retVal + QIODevice::bytesAvailable();
+}
+
+void HCdsThrottledReader::refill(qint64 budget)
+{
+    m_budget = budget;
+    if (!m_source->atEnd())
+    {
+        emit readyRead();
+    }
+}
+
+/*******************************************************************************
+ * HCdsTransfer
+ ******************************************************************************/
+HCdsTransfer::HCdsTransfer(
+    HCdsTransferEngine* owner, quint32 id, Direction direction,
+    const QString& itemId, const QUrl& remote, qint64 offset) :
+        QObject(owner),
+            m_owner(owner), m_reply(0), m_local(0), m_offset(offset),
+            m_budget(-1), m_replyFinished(false), m_resumeAttempts(0),
+            m_id(id), m_direction(direction), m_itemId(itemId),
+            m_remote(remote), m_status(HTransferProgressInfo::InProgress),
+            m_length(offset), m_total(0), m_published(),
+            m_finishedTicks(0)
+{
+    publish();
+}
+
+HCdsTransfer::~HCdsTransfer()
+{
+    if (m_reply)
+    {
+        m_reply->disconnect(this);
+        m_reply->abort();
+        delete m_reply;
+    }
+    delete m_local;
+}
+
+bool HCdsTransfer::startRequest()
+{
+    HAbstractCdsDataSource* dataSource = m_owner->m_dataSource;
+
+    delete m_local;
+    m_local = dataSource->storeItemData(m_itemId, m_offset);
+    if (!m_local && m_offset > 0)
+    {
+        m_offset = 0;
+        m_local = dataSource->storeItemData(m_itemId, 0);
+    }
+
+    if (!m_local)
+    {
+        return false;
+    }
+
+    m_length = m_offset;
+    m_replyFinished = false;
+
+    QNetworkRequest req(m_remote);
+    if (m_offset > 0)
+    {
+        req.setRawHeader(
+            "Range", QString("bytes=%1-").arg(m_offset).toLatin1());
+    }
+
+    m_reply = m_owner->m_nam->get(req);
+    if (m_budget > 0)
+    {
+        // The reply stops reading the socket once this much is waiting,
+        // which is what makes the sender slow down.
+        m_reply->setReadBufferSize(qMax(m_budget * 2, Q_INT64_C(65536)));
+    }
+
+    bool ok = connect(m_reply, SIGNAL(readyRead()), this, SLOT(readyRead()));
+    Q_ASSERT(ok); Q_UNUSED(ok)
+
+    ok = connect(m_reply, SIGNAL(finished()), this, SLOT(finished()));
+    Q_ASSERT(ok);
+
+    ok = connect(
+        m_reply, SIGNAL(downloadProgress(qint64, qint64)),
+        this, SLOT(progress(qint64, qint64)));
+    Q_ASSERT(ok);
+
+    return true;
+}
+
+bool HCdsTransfer::start()
+{
+    HLOG(H_AT, H_FUN);
+
+    HAbstractCdsDataSource* dataSource = m_owner->m_dataSource;
+    m_budget = m_owner->tickBudget();
+
+    if (dataSource && m_direction == Import)
+    {
+        HLOG_INFO(QString("Importing [%1] into item [%2]").arg(
+            m_remote.toString(), m_itemId));
+
+        if (startRequest())
+        {
+            return true;
+        }
+    }
+    else if (dataSource)
+    {
+        HLOG_INFO(QString("Exporting item [%1] to [%2]").arg(
+            m_itemId, m_remote.toString()));
+
+        QIODevice* source = dataSource->loadItemData(m_itemId);
+        HItem* item = dataSource->findItem(m_itemId);
+        if (source && item)
+        {
+            m_total = source->size();
+            m_local = new HCdsThrottledReader(source, m_budget, 0);
+
+            QNetworkRequest req(m_remote);
+
+            // Without the length the body would be buffered in full
+            // before it is sent.
+            req.setHeader(QNetworkRequest::ContentLengthHeader, m_total);
+
+            HResources resources = item->resources();
+            QString contentFormat = resources.isEmpty() ?
+                QString() : resources.first().protocolInfo().contentFormat();
+
+            req.setHeader(QNetworkRequest::ContentTypeHeader,
+                contentFormat.isEmpty() || contentFormat == "*" ?
+                    QString("application/octet-stream") : contentFormat);
+
+            m_reply = m_owner->m_nam->post(req, m_local);
+
+            bool ok = connect(
+                m_reply, SIGNAL(finished()), this, SLOT(finished()));
+            Q_ASSERT(ok); Q_UNUSED(ok)
+
+            ok = connect(
+                m_reply, SIGNAL(uploadProgress(qint64, qint64)),
+                this, SLOT(progress(qint64, qint64)));
+            Q_ASSERT(ok);
+
+            return true;
+        }
+        delete source;
+    }
+
+    HLOG_WARN(QString("Could not start transfer [%1] of item [%2]").arg(
+        QString::number(m_id), m_itemId));
+
+    finish(HTransferProgressInfo::Error);
+    return false;
+}
+
+void HCdsTransfer::readReply()
+{
+    if (!m_reply)
+    {
+        return;
+    }
+
+    if (m_offset > 0 && m_length == m_offset &&
+        m_reply->attribute(
+            QNetworkRequest::HttpStatusCodeAttribute).toInt() != 206)
+    {
+        // The server ignored the range, so the data starts from the beginning.
+        m_offset = 0;
+        m_length = 0;
+        delete m_local;
+        m_local = m_owner->m_dataSource ?
+            m_owner->m_dataSource->storeItemData(m_itemId, 0) : 0;
+
+        if (!m_local)
+        {
+            finish(HTransferProgressInfo::Error);
+            return;
+        }
+    }
+
+    while(m_budget != 0)
+    {
+        qint64 size = m_reply->bytesAvailable();
+        if (size <= 0)
+        {
+            break;
+        }
+        else if (m_budget > 0)
+        {
+            size = qMin(size, m_budget);
+        }
+
+        QByteArray data = m_reply->read(size);
+        if (data.isEmpty())
+        {
+            break;
+        }
+        else if (m_local->write(data) != data.size())
+        {
+            HLOG(H_AT, H_FUN);
+            HLOG_WARN(QString("Failed to store the data of item [%1]").arg(
+                m_itemId));
+
+            finish(HTransferProgressInfo::Error);
+            return;
+        }
+
+        m_length += data.size();
+        if (m_budget > 0)
+        {
+            m_budget -= data.size();
+        }
+    }
+
+    if (m_replyFinished && m_reply->bytesAvailable() <= 0)
+    {
+        replyDone();
+    }
+}
+
+void HCdsTransfer::replyDone()
+{
+    if (m_total < m_length)
+    {
+        m_total = m_length;
+    }
+    finish(HTransferProgressInfo::Completed);
+}
+
+void HCdsTransfer::finish(HTransferProgressInfo::Status status)
+{
+    if (m_reply)
+    {
+        m_reply->disconnect(this);
+        m_reply->abort();
+        m_reply->deleteLater();
+        m_reply = 0;
+    }
+
+    if (m_direction == Export && m_local)
+    {
+        // The reply may still refer to the device until it is deleted.
+        m_local->deleteLater();
+    }
+    else
+    {
+        delete m_local;
+    }
+    m_local = 0;
+
+    m_status = status;
+    publish();
+
+    m_owner->transferEnded(this);
+}
+
+void HCdsTransfer::readyRead()
+{
+    readReply();
+}
+
+void HCdsTransfer::finished()
+{
+    QNetworkReply::NetworkError error = m_reply->error();
+    if (m_direction == Export)
+    {
+        finish(error == QNetworkReply::NoError ?
+            HTransferProgressInfo::Completed : HTransferProgressInfo::Error);
+        return;
+    }
+    else if (error == QNetworkReply::NoError)
+    {
+        m_replyFinished = true;
+        readReply();
+        return;
+    }
+
+    HLOG(H_AT, H_FUN);
+
+    QString errorString = m_reply->errorString();
+    if (isResumable(error) &&
+        m_resumeAttempts < HCdsTransferEngine::MaxResumeAttempts)
+    {
+        HLOG_INFO(QString("Resuming transfer [%1] at [%2]").arg(
+            QString::number(m_id), QString::number(m_length)));
+
+        // The data that was received but not stored yet is simply
+        // requested again.
+        ++m_resumeAttempts;
+        m_reply->disconnect(this);
+        m_reply->deleteLater();
+        m_reply = 0;
+        m_offset = m_length;
+
+        if (startRequest())
+        {
+            return;
+        }
+    }
+
+    HLOG_WARN(QString("Transfer [%1] failed: [%2]").arg(
+        QString::number(m_id), errorString));
+
+    finish(HTransferProgressInfo::Error);
+}
+
+void HCdsTransfer::progress(qint64 done, qint64 total)
+{
+    if (m_direction == Export)
+    {
+        m_length = done;
+        if (total > 0)
+        {
+            m_total = total;
+        }
+    }
+    else if (total > 0)
+    {
+        bool partial = m_reply->attribute(
+            QNetworkRequest::HttpStatusCodeAttribute).toInt() == 206;
+
+        m_total = partial ? m_offset + total : total;
+    }
+}
+
+void HCdsTransfer::stop()
+{
+    if (m_status == HTransferProgressInfo::InProgress)
+    {
+        finish(HTransferProgressInfo::Stopped);
+    }
+}
+
+void HCdsTransfer::refill(qint64 budget)
+{
+    m_budget = budget;
+    if (m_direction == Import)
+    {
+        readReply();
+    }
+    else if (m_local)
+    {
+        static_cast<HCdsThrottledReader*>(m_local)->refill(budget);
+    }
+}
+
+void HCdsTransfer::publish()
+{
+    m_published = HTransferProgressInfo(
+        clamp(m_length), m_status, clamp(m_total));
+}
+
+/*******************************************************************************
+ * HCdsTransferEngine
+ ******************************************************************************/
+HCdsTransferEngine::HCdsTransferEngine(
+    HAbstractCdsDataSource* dataSource, qint32 maxConcurrent,
+    qint64 bandwidthLimit, QObject* parent) :
+        QObject(parent),
+            m_dataSource(dataSource), m_nam(new QNetworkAccessManager(this)),
+            m_transfers(), m_queue(), m_running(0),
+            m_maxConcurrent(qMax(1, maxConcurrent)),
+            m_bandwidthLimit(bandwidthLimit), m_lastId(0), m_ticks(0),
+            m_timer()
+{
+    m_timer.setInterval(TickInterval);
+    bool ok = connect(&m_timer, SIGNAL(timeout()), this, SLOT(tick()));
+    Q_ASSERT(ok); Q_UNUSED(ok)
+}
+
+HCdsTransferEngine::~HCdsTransferEngine()
+{
+    // The replies are owned by the network access manager, which is why the
+    // transfers are deleted first.
+    qDeleteAll(m_transfers);
+}
+
+qint64 HCdsTransferEngine::tickBudget() const
+{
+    return m_bandwidthLimit > 0 ?
+        qMax(Q_INT64_C(1), m_bandwidthLimit * TickInterval / 1000) : -1;
+}
+
+void HCdsTransferEngine::add(HCdsTransfer* transfer, quint32* transferId)
+{
+    m_transfers.insert(transfer->m_id, transfer);
+    m_queue.append(transfer);
+    *transferId = transfer->m_id;
+
+    if (!m_timer.isActive())
+    {
+        m_timer.start();
+    }
+
+    startQueued();
+    emit transferIdsChanged();
+}
+
+void HCdsTransferEngine::startQueued()
+{
+    while(m_running < m_maxConcurrent && !m_queue.isEmpty())
+    {
+        HCdsTransfer* transfer = m_queue.takeFirst();
+        ++m_running;
+        transfer->start();
+    }
+}
+
+void HCdsTransferEngine::transferEnded(HCdsTransfer* transfer)
+{
+    if (!m_queue.removeOne(transfer))
+    {
+        --m_running;
+    }
+
+    transfer->m_finishedTicks = 0;
+
+    startQueued();
+    emit transferIdsChanged();
+}
+
+void HCdsTransferEngine::tick()
+{
+    ++m_ticks;
+    bool publish = m_ticks % (ProgressInterval / TickInterval) == 0;
+    qint64 budget = tickBudget();
+
+    foreach(HCdsTransfer* transfer, m_transfers.values())
+    {
+        if (transfer->m_status == HTransferProgressInfo::InProgress)
+        {
+            if (budget >= 0 && transfer->isRunning())
+            {
+                transfer->refill(budget);
+            }
+            if (publish &&
+                transfer->m_status == HTransferProgressInfo::InProgress)
+            {
+                transfer->publish();
+            }
+        }
+        else if (++transfer->m_finishedTicks * TickInterval >= RetentionTime)
+        {
+            m_transfers.remove(transfer->m_id);
+            delete transfer;
+        }
+    }
+
+    if (m_transfers.isEmpty())
+    {
+        m_timer.stop();
+    }
+}
+
+HItem* HCdsTransferEngine::findItem(const QUrl& resource) const
+{
+    if (!m_dataSource)
+    {
+        return 0;
+    }
+
+    // The resources of the items are published as <root url>/<item id>.
+    QString path = resource.path();
+    HItem* item = m_dataSource->findItem(path.mid(path.lastIndexOf('/') + 1));
+    if (item)
+    {
+        foreach(const HResource& res, item->resources())
+        {
+            if (res.location() == resource)
+            {
+                return item;
+            }
+        }
+    }
+
+    return 0;
+}
+
+qint32 HCdsTransferEngine::startImport(
+    const QString& itemId, const QUrl& source, quint32* transferId)
+{
+    Q_ASSERT(transferId);
+
+    HCdsTransfer* previous = 0;
+    foreach(HCdsTransfer* transfer, m_transfers)
+    {
+        if (transfer->m_itemId != itemId)
+        {
+            continue;
+        }
+        else if (transfer->m_status == HTransferProgressInfo::InProgress)
+        {
+            return HContentDirectoryInfo::TransferBusy;
+        }
+        else if (transfer->m_direction == HCdsTransfer::Import &&
+                (!previous || previous->m_id < transfer->m_id))
+        {
+            previous = transfer;
+        }
+    }
+
+    qint64 offset = 0;
+    if (previous && previous->m_remote == source &&
+        (previous->m_status == HTransferProgressInfo::Stopped ||
+         previous->m_status == HTransferProgressInfo::Error))
+    {
+        // The data stored by the previous attempt is kept.
+        offset = previous->m_length;
+    }
+
+    add(new HCdsTransfer(
+        this, ++m_lastId, HCdsTransfer::Import, itemId, source, offset),
+        transferId);
+
+    return UpnpSuccess;
+}
+
+qint32 HCdsTransferEngine::startExport(
+    const QString& itemId, const QUrl& destination, quint32* transferId)
+{
+    Q_ASSERT(transferId);
+
+    foreach(HCdsTransfer* transfer, m_transfers)
+    {
+        if (transfer->m_itemId == itemId &&
+            transfer->m_direction == HCdsTransfer::Import &&
+            transfer->m_status == HTransferProgressInfo::InProgress)
+        {
+            return HContentDirectoryInfo::TransferBusy;
+        }
+    }
+
+    add(new HCdsTransfer(
+        this, ++m_lastId, HCdsTransfer::Export, itemId, destination, 0),
+        transferId);
+
+    return UpnpSuccess;
+}
+
+qint32 HCdsTransferEngine::stop(quint32 transferId)
+{
+    HCdsTransfer* transfer = m_transfers.value(transferId);
+    if (!transfer || transfer->m_status != HTransferProgressInfo::InProgress)
+    {
+        return HContentDirectoryInfo::NoSuchFileTransfer;
+    }
+
+    transfer->stop();
+    return UpnpSuccess;
+}
+
+qint32 HCdsTransferEngine::progress(
+    quint32 transferId, HTransferProgressInfo* info) const
+{
+    Q_ASSERT(info);
+
+    HCdsTransfer* transfer = m_transfers.value(transferId);
+    if (!transfer)
+    {
+        return HContentDirectoryInfo::NoSuchFileTransfer;
+    }
+
+    *info = transfer->m_published;
+    return UpnpSuccess;
+}
+
+QString HCdsTransferEngine::transferIds() const
+{
+    QList<quint32> ids;
+    foreach(HCdsTransfer* transfer, m_transfers)
+    {
+        if (transfer->m_status == HTransferProgressInfo::InProgress)
+        {
+            ids.append(transfer->m_id);
+        }
+    }
+    qSort(ids);
+
+    QStringList retVal;
+    foreach(quint32 id, ids)
+    {
+        retVal.append(QString::number(id));
+    }
+
+    return retVal.join(",");
+}
+
+}
+}
+}
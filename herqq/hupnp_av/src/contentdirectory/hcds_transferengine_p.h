@@ -0,0 +1,283 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HCDS_TRANSFERENGINE_P_H_
+#define HCDS_TRANSFERENGINE_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include "htransferprogressinfo.h"
+
+#include <QtCore/QUrl>
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QTimer>
+#include <QtCore/QObject>
+#include <QtCore/QString>
+#include <QtCore/QPointer>
+#include <QtCore/QIODevice>
+
+class QNetworkReply;
+class QNetworkAccessManager;
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+class HItem;
+class HCdsTransferEngine;
+class HAbstractCdsDataSource;
+
+//
+// Reads the data of an exported item at most at the rate allowed by the
+// transfer engine. QNetworkAccessManager reads the POST body from this device
+// as the data is sent and waits for readyRead() when nothing can be read.
+//
+class HCdsThrottledReader :
+    public QIODevice
+{
+H_DISABLE_COPY(HCdsThrottledReader)
+
+private:
+
+    QIODevice* m_source;
+    // owned
+
+    qint64 m_budget;
+    // the number of bytes that can be read until the next refill,
+    // or -1 if there is no limit
+
+protected:
+
+    virtual qint64 readData(char* data, qint64 maxSize);
+    virtual qint64 writeData(const char* data, qint64 maxSize);
+
+public:
+
+    // takes the ownership of the source
+    HCdsThrottledReader(QIODevice* source, qint64 budget, QObject* parent);
+    virtual ~HCdsThrottledReader();
+
+    virtual bool isSequential() const;
+    virtual bool atEnd() const;
+    virtual qint64 bytesAvailable() const;
+
+    void refill(qint64 budget);
+};
+
+//
+// A single ImportResource or ExportResource transfer. An import is an HTTP
+// GET of the source written into the storage of an item of the data source,
+// and an export is an HTTP POST of the data of an item.
+//
+class HCdsTransfer :
+    public QObject
+{
+Q_OBJECT
+H_DISABLE_COPY(HCdsTransfer)
+
+public:
+
+    enum Direction
+    {
+        Import,
+        Export
+    };
+
+private:
+
+    HCdsTransferEngine* m_owner;
+
+    QNetworkReply* m_reply;
+    QIODevice* m_local;
+    // the storage of an import, or the throttled reader of an export.
+    // both are owned
+
+    qint64 m_offset;
+    // the position at which the current request of an import started
+
+    qint64 m_budget;
+    // the number of bytes that can be read from the reply of an import
+    // until the next refill, or -1 if there is no limit
+
+    bool m_replyFinished;
+    // whether the reply of an import has finished while some of its data
+    // was still waiting for the budget
+
+    qint32 m_resumeAttempts;
+
+    bool startRequest();
+    void readReply();
+    void replyDone();
+    void finish(HTransferProgressInfo::Status status);
+
+private Q_SLOTS:
+
+    void readyRead();
+    void finished();
+    void progress(qint64 done, qint64 total);
+
+public:
+
+    const quint32 m_id;
+    const Direction m_direction;
+    const QString m_itemId;
+    const QUrl m_remote;
+
+    HTransferProgressInfo::Status m_status;
+    qint64 m_length, m_total;
+    // the current state of the transfer
+
+    HTransferProgressInfo m_published;
+    // the state returned from GetTransferProgress
+
+    qint32 m_finishedTicks;
+    // the number of ticks since the transfer ended
+
+    HCdsTransfer(
+        HCdsTransferEngine* owner, quint32 id, Direction direction,
+        const QString& itemId, const QUrl& remote, qint64 offset);
+
+    virtual ~HCdsTransfer();
+
+    // returns false and ends the transfer with an error if the transfer
+    // could not be started
+    bool start();
+    void stop();
+
+    void refill(qint64 budget);
+    void publish();
+
+    inline bool isRunning() const { return m_reply != 0; }
+};
+
+//
+// Runs the ImportResource and ExportResource transfers of a ContentDirectory.
+//
+// The transfers are streamed through a QNetworkAccessManager in the thread
+// of the service, so no transfer ever blocks the thread. At most a configured
+// number of transfers run at the same time and the rest wait in a queue.
+// A bandwidth limit is enforced per transfer by handing each running transfer
+// a budget of bytes every tick. The progress returned from GetTransferProgress
+// is republished at most once per ProgressInterval, except that the end of
+// a transfer is published at once. An import that was interrupted by a
+// network error is resumed with a range request, as is an import that is
+// restarted from the same source after it was stopped or it failed.
+//
+class HCdsTransferEngine :
+    public QObject
+{
+Q_OBJECT
+H_DISABLE_COPY(HCdsTransferEngine)
+friend class HCdsTransfer;
+
+public:
+
+    enum
+    {
+        TickInterval = 100,
+        // in milliseconds
+
+        ProgressInterval = 1000,
+        // in milliseconds
+
+        RetentionTime = 30000,
+        // how long the state of an ended transfer can be queried,
+        // in milliseconds
+
+        MaxResumeAttempts = 3
+    };
+
+private:
+
+    QPointer<HAbstractCdsDataSource> m_dataSource;
+    QNetworkAccessManager* m_nam;
+
+    QHash<quint32, HCdsTransfer*> m_transfers;
+    QList<HCdsTransfer*> m_queue;
+    // the transfers waiting for a free slot, oldest first
+
+    qint32 m_running;
+    const qint32 m_maxConcurrent;
+    const qint64 m_bandwidthLimit;
+
+    quint32 m_lastId;
+    qint32 m_ticks;
+
+    QTimer m_timer;
+
+    qint64 tickBudget() const;
+
+    void add(HCdsTransfer* transfer, quint32* transferId);
+    void startQueued();
+    void transferEnded(HCdsTransfer* transfer);
+
+private Q_SLOTS:
+
+    void tick();
+
+public:
+
+    HCdsTransferEngine(
+        HAbstractCdsDataSource* dataSource, qint32 maxConcurrent,
+        qint64 bandwidthLimit, QObject* parent);
+
+    virtual ~HCdsTransferEngine();
+
+    // finds the item that has a resource at the specified location
+    HItem* findItem(const QUrl& resource) const;
+
+    // all of these return a UPnP or a ContentDirectory error code
+    qint32 startImport(
+        const QString& itemId, const QUrl& source, quint32* transferId);
+
+    qint32 startExport(
+        const QString& itemId, const QUrl& destination, quint32* transferId);
+
+    qint32 stop(quint32 transferId);
+
+    qint32 progress(quint32 transferId, HTransferProgressInfo* info) const;
+
+    // a comma-separated list of the IDs of the transfers in progress,
+    // as the TransferIDs state variable
+    QString transferIds() const;
+
+Q_SIGNALS:
+
+    void transferIdsChanged();
+};
+
+}
+}
+}
+
+#endif /* HCDS_TRANSFERENGINE_P_H_ */
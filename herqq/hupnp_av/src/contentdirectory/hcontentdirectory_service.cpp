@@ -23,17 +23,34 @@
 #include "hcontentdirectory_service_p.h"
 
 #include "hsearchresult.h"
+#include "hfreeformqueryresult.h"
+#include "hcontentdirectory_serviceconfiguration.h"
+#include "hcds_childindex_p.h"
+#include "hcds_didllitecache_p.h"
+#include "hcds_browsecache_p.h"
+#include "hcds_searchquery_p.h"
+#include "hcds_freeformquery_p.h"
+#include "hcds_transferengine_p.h"
 #include "htransferprogressinfo.h"
 
 #include "../cds_model/hsortinfo.h"
+#include "../cds_model/cds_objects/hobject_p.h"
+#include "../cds_model/datasource/hcds_searchindex_p.h"
+#include "../cds_model/datasource/habstract_cds_datasource_p.h"
 #include "../cds_model/model_mgmt/hcdsproperty.h"
 #include "../cds_model/model_mgmt/hcdsproperty_db.h"
 #include "../cds_model/model_mgmt/hcds_dlite_serializer.h"
 
 #include <HUpnpCore/private/hlogger_p.h>
+#include <HUpnpCore/private/hxmlfragment_p.h>
+
+#include <HUpnpCore/HServerAction>
 
 #include <QtCore/QSet>
+#include <QtCore/QBuffer>
 #include <QtCore/QString>
+#include <QtCore/QThread>
+#include <QtCore/QReadWriteLock>
 #include <QtCore/QStringList>
 #include <QtCore/QXmlStreamWriter>
 
@@ -50,76 +67,28 @@ namespace Av
  * HContentDirectoryServicePrivate
  ******************************************************************************/
 HContentDirectoryServicePrivate::HContentDirectoryServicePrivate() :
-    m_dataSource(0), m_lastEventSent(false), m_timer(), m_modificationEvents()
+    m_dataSource(0), m_childIndex(0), m_didlLiteCache(0),
+    m_browseCache(0), m_timer(),
+    m_pendingChanges(), m_pendingChangeSeqs(), m_firstPendingSeq(0),
+    m_maxLastChangeEntries(
+        HContentDirectoryServiceConfiguration::DefaultMaximumLastChangeEntries),
+    m_systemUpdateId(0), m_modifiedContainers(), m_lastChangeEnabled(false),
+    m_containerUpdateIdsEnabled(false), m_concurrentQueriesEnabled(false),
+    m_maxPendingQueries(HContentDirectoryServiceConfiguration::
+        DefaultMaximumPendingQueries),
+    m_transferEngine(0),
+    m_maxConcurrentTransfers(HContentDirectoryServiceConfiguration::
+        DefaultMaximumConcurrentTransfers),
+    m_transferBandwidthLimit(0)
 {
 }
 
 HContentDirectoryServicePrivate::~HContentDirectoryServicePrivate()
 {
-    qDeleteAll(m_modificationEvents);
-}
-
-namespace
-{
-class Sorter
-{
-private:
-
-    QList<HSortInfo> m_sortInfoObjects;
-
-public:
-
-    Sorter(){}
-
-    Sorter(const QList<HSortInfo>& infoObjects) :
-        m_sortInfoObjects(infoObjects)
-    {
-    }
-
-    bool operator()(HObject* obj1, HObject* obj2) const
-    {
-        Q_ASSERT(obj1);
-        Q_ASSERT(obj2);
-
-        for(qint32 i = 0; i < m_sortInfoObjects.size(); ++i)
-        {
-            qint32 rc = 0;
-            HSortInfo si = m_sortInfoObjects[i];
-            QString property = si.property();
-
-            QVariant value1, value2;
-            if (obj1->getCdsProperty(property, &value1))
-            {
-                if (obj2->getCdsProperty(property, &value2))
-                {
-                    HCdsProperty prop = HCdsPropertyDb::instance().property(property);
-                    if (prop.isValid())
-                    {
-                        if (!prop.handler().comparer()(value1, value2, &rc))
-                        {
-                            continue;
-                        }
-                    }
-                }
-            }
-
-            if (rc < 0)
-            {
-                return si.sortModifier().ascending();
-            }
-            else if (rc > 0)
-            {
-                return !si.sortModifier().ascending();
-            }
-        }
-
-        return true;
-    }
-};
 }
 
-qint32 HContentDirectoryServicePrivate::sort(
-    const QStringList& sortCriteria, QList<HObject*>& objects)
+qint32 HContentDirectoryServicePrivate::parseSortCriteria(
+    const QStringList& sortCriteria, QList<HSortInfo>* sortInfos)
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
     H_Q(HContentDirectoryService);
@@ -187,7 +156,7 @@ qint32 HContentDirectoryServicePrivate::sort(
         sortInfoObjects.append(so);
     }
 
-    qStableSort(objects.begin(), objects.end(), Sorter(sortInfoObjects));
+    *sortInfos = sortInfoObjects;
 
     return 0;
 }
@@ -219,36 +188,43 @@ qint32 HContentDirectoryServicePrivate::browseDirectChildren(
             QStringList(filter.toList()).join(","),
             sortCriteria.join(",")));
 
-    QSet<QString> childIDs = container->childIds();
-    quint32 childCount = static_cast<quint32>(childIDs.size());
-
-    if (startingIndex > childCount)
-    {
-        return UpnpInvalidArgs;
-    }
-
-    HObjects objects = m_dataSource->findObjects(childIDs);
-    Q_ASSERT(objects.size() == childIDs.size());
-
+    QList<HSortInfo> sortInfos;
     if (!sortCriteria.isEmpty())
     {
-        qint32 rc = sort(sortCriteria, objects);
+        qint32 rc = parseSortCriteria(sortCriteria, &sortInfos);
         if (rc != 0)
         {
             return rc;
         }
     }
 
+    if (!m_childIndex)
+    {
+        m_childIndex = new HCdsChildIndex(m_dataSource, q);
+    }
+
+    // The child index keeps the sorted order of the children, which is why
+    // only the objects of the requested page have to be fetched.
+    QStringList childIds = m_childIndex->childIds(container, sortInfos);
+    quint32 childCount = static_cast<quint32>(childIds.size());
+
+    if (startingIndex > childCount)
+    {
+        return UpnpInvalidArgs;
+    }
+
     quint32 numberReturned = requestedCount > 0 ?
         qMin(requestedCount, childCount - startingIndex) :
         childCount - startingIndex;
 
-    objects = objects.mid(startingIndex, requestedCount ? requestedCount : -1);
+    HObjects objects = m_dataSource->findObjects(
+        childIds.mid(startingIndex, numberReturned));
 
-    HCdsDidlLiteSerializer ser;
-    QString dliteDoc = ser.serializeToXml(objects, filter);
+    Q_ASSERT(static_cast<quint32>(objects.size()) == numberReturned);
 
-    HSearchResult retVal(
+    QByteArray dliteDoc = serialize(objects, filter);
+
+    HSearchResult retVal = HSearchResult::fromEscapedResult(
         dliteDoc, numberReturned, childCount,
         q->stateVariables().value("A_ARG_TYPE_UpdateID")->value().toUInt());
 
@@ -284,6 +260,8 @@ qint32 HContentDirectoryServicePrivate::browseMetadata(
         return HContentDirectoryInfo::InvalidObjectId;
     }
 
+    m_dataSource->objectsRequested(QStringList(objectId));
+
     HCdsDidlLiteSerializer serializer;
     QString dliteDoc = serializer.serializeToXml(
         *object, filter, HCdsDidlLiteSerializer::Document);
@@ -297,283 +275,926 @@ qint32 HContentDirectoryServicePrivate::browseMetadata(
     return UpnpSuccess;
 }
 
-void HContentDirectoryServicePrivate::enableChangeTracking()
-{
-    H_Q(HContentDirectoryService);
-
-    bool ok = QObject::connect(
-        m_dataSource, SIGNAL(objectModified(Herqq::Upnp::Av::HObject*, Herqq::Upnp::Av::HObjectEventInfo)),
-        q, SLOT(objectModified(Herqq::Upnp::Av::HObject*, Herqq::Upnp::Av::HObjectEventInfo)));
-    Q_ASSERT(ok); Q_UNUSED(ok)
-
-    ok = QObject::connect(
-        m_dataSource, SIGNAL(containerModified(Herqq::Upnp::Av::HContainer*, Herqq::Upnp::Av::HContainerEventInfo)),
-        q, SLOT(containerModified(Herqq::Upnp::Av::HContainer*, Herqq::Upnp::Av::HContainerEventInfo)));
-    Q_ASSERT(ok);
-
-    ok = QObject::connect(
-        m_dataSource, SIGNAL(independentObjectAdded(Herqq::Upnp::Av::HObject*)),
-        q, SLOT(independentObjectAdded(Herqq::Upnp::Av::HObject*)));
-    Q_ASSERT(ok);
-
-    foreach(HObject* object, m_dataSource->objects())
-    {
-        object->setTrackChangesOption(true);
-    }
-
-    m_timer.start();
-}
-
-QString HContentDirectoryServicePrivate::generateLastChange()
+void HContentDirectoryServicePrivate::search(
+    HContainer* container, const HCdsSearchQuery& query, HObjects* matches)
 {
-    QString retVal;
-
-    QXmlStreamWriter writer(&retVal);
-
-    writer.setCodec("UTF-8");
-    writer.writeStartDocument();
-    writer.writeStartElement("StateEvent");
-    writer.writeDefaultNamespace("urn:schemas-upnp-org:av:cds-event");
-    writer.writeAttribute("xmlns:xsd", "http://www.w3.org/2001/XMLSchema");
-    writer.writeAttribute("xmlns:xsi", "http://www.w3.org/2001/XMLSchema-instance");
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
-    writer.writeAttribute("xsi:schemaLocation",
-        "urn:schemas-upnp-org:av:cds-event" \
-        "http://www.upnp.org/schemas/av/cds-events.xsd");
+    // The subtree is walked without recursion, since the depth of the
+    // hierarchy is controlled by the content of the data source.
+    QSet<QString> visited;
+    QList<HContainer*> containers;
+    containers.append(container);
+    visited.insert(container->id());
 
-    foreach(const HModificationEvent* event, m_modificationEvents)
+    while(!containers.isEmpty())
     {
-        if (event->type() == HModificationEvent::ContainerModification)
+        HContainer* current = containers.takeLast();
+        foreach(const QString& childId, current->orderedChildIds())
         {
-            HContainerEventInfo cEvent = event->containerEvent();
+            HObject* child = m_dataSource->findObject(childId);
+            if (!child)
+            {
+                continue;
+            }
 
-            switch(cEvent.type())
+            if (query.matches(child))
             {
-            case HContainerEventInfo::ChildAdded:
-                if (event->source())
-                {
-                    HObject* newObj = m_dataSource->findObject(cEvent.childId());
-                    if (newObj)
-                    {
-                        writer.writeStartElement("objAdd");
-                        writer.writeAttribute("objParentID", event->source()->id());
-                        writer.writeAttribute("objClass", newObj->clazz());
-                    }
-                }
-                break;
-            case HContainerEventInfo::ChildRemoved:
-                writer.writeStartElement("objDel");
-                break;
-            case HContainerEventInfo::ChildModified:
-                writer.writeStartElement("objMod");
-                break;
-            default:
-                Q_ASSERT(false);
-                break;
+                matches->append(child);
             }
 
-            writer.writeAttribute("objID", cEvent.childId());
-            writer.writeAttribute("updateID", QString::number(cEvent.updateId()));
-            writer.writeAttribute("stUpdate", "0");
-            writer.writeEndElement();
-        }
-        else
-        {
-            if (event->source())
+            if (child->isContainer() && !visited.contains(childId))
             {
-                HObjectEventInfo oEvent = event->objectEvent();
-                writer.writeStartElement("objMod");
-                writer.writeAttribute("objID", event->source()->id());
-                writer.writeAttribute("updateID", QString::number(oEvent.updateId()));
-                writer.writeAttribute("stUpdate", "0");
-                writer.writeEndElement();
+                visited.insert(childId);
+                containers.append(static_cast<HContainer*>(child));
             }
         }
     }
-    writer.writeEndElement();
-
-    return retVal;
-}
-
-/*******************************************************************************
- * HContentDirectoryService
- ******************************************************************************/
-HContentDirectoryService::HContentDirectoryService(
-    HContentDirectoryServicePrivate& dd) :
-        HAbstractContentDirectoryService(dd)
-{
-    H_D(HContentDirectoryService);
-    h->m_timer.setInterval(200);
-    bool ok = connect(&h->m_timer, SIGNAL(timeout()), this, SLOT(timeout()));
-    Q_ASSERT(ok); Q_UNUSED(ok)
-}
-
-HContentDirectoryService::HContentDirectoryService(HAbstractCdsDataSource* dataSource) :
-    HAbstractContentDirectoryService(
-        *new HContentDirectoryServicePrivate())
-{
-    H_D(HContentDirectoryService);
-    Q_ASSERT_X(dataSource, "", "Valid HCdsDataSource has to be provided");
-    h->m_dataSource = dataSource;
-    h->m_timer.setInterval(200);
-    bool ok = connect(&h->m_timer, SIGNAL(timeout()), this, SLOT(timeout()));
-    Q_ASSERT(ok); Q_UNUSED(ok)
 }
 
-void HContentDirectoryService::timeout()
+void HContentDirectoryServicePrivate::findMatches(
+    HContainer* container, const HCdsSearchQuery& query, HObjects* matches)
 {
-    H_D(HContentDirectoryService);
-    if (!h->m_lastEventSent && h->m_modificationEvents.size())
+    QSet<QString> candidates;
+    const HCdsSearchIndex* index = m_dataSource->searchIndex();
+    if (index && query.plan(*index, &candidates))
     {
-        QString lastChangeData = h->generateLastChange();
-        bool ok = setValue("LastChange", lastChangeData);
-        h->m_lastEventSent = true;
-        Q_ASSERT(ok); Q_UNUSED(ok)
+        search(container, query, candidates, matches);
+    }
+    else
+    {
+        search(container, query, matches);
     }
 }
 
-void HContentDirectoryService::objectModified(
-    HObject* source, const HObjectEventInfo& eventInfo)
+bool HContentDirectoryServicePrivate::isDescendant(
+    const HObject* object, const QString& containerId)
 {
-    H_D(HContentDirectoryService);
-    if (h->m_lastEventSent)
+    QSet<QString> visited;
+    QString parentId = object->parentId();
+    while(parentId != containerId)
     {
-        h->m_modificationEvents.clear();
-        h->m_lastEventSent = false;
+        if (visited.contains(parentId))
+        {
+            return false;
+        }
+        visited.insert(parentId);
+
+        HObject* parent = m_dataSource->findObject(parentId);
+        if (!parent)
+        {
+            return false;
+        }
+        parentId = parent->parentId();
     }
 
-    HObjectEventInfo einfo(eventInfo);
+    return true;
+}
 
-    quint32 sysUpdateId;
-    qint32 retVal = getSystemUpdateId(&sysUpdateId);
-    Q_ASSERT(retVal == UpnpSuccess); Q_UNUSED(retVal)
+QByteArray HContentDirectoryServicePrivate::serialize(
+    const HObjects& objects, const QSet<QString>& filter)
+{
+    H_Q(HContentDirectoryService);
 
-    einfo.setUpdateId(sysUpdateId);
+    QStringList objectIds;
+    foreach(HObject* object, objects)
+    {
+        objectIds.append(object->id());
+    }
+    m_dataSource->objectsRequested(objectIds);
 
-    source->setObjectUpdateId(sysUpdateId);
+    // The document is written in the form in which it is embedded into the
+    // SOAP response, that is, as UTF-8 that is XML escaped in the same pass.
+    QByteArray retVal;
+    QBuffer buffer(&retVal);
+    buffer.open(QIODevice::WriteOnly);
 
-    h->m_modificationEvents.append(new HModificationEvent(source, einfo));
-}
+    HXmlEscapingDevice escaper(&buffer);
 
-void HContentDirectoryService::containerModified(
-    HContainer* source, const HContainerEventInfo& eventInfo)
-{
-    H_D(HContentDirectoryService);
+    qint32 cacheSize = m_dataSource->configuration()->didlLiteCacheSize();
+    if (!m_didlLiteCache && cacheSize > 0)
+    {
+        m_didlLiteCache = new HCdsDidlLiteCache(m_dataSource, cacheSize, q);
+    }
 
-    if (eventInfo.type() == HContainerEventInfo::ChildAdded)
+    HCdsDidlLiteSerializer ser;
+    bool ok;
+    if (m_didlLiteCache)
     {
-        HItem* item = h->m_dataSource->findItem(eventInfo.childId());
-        if (item)
+        QList<QByteArray> excerpts;
+        foreach(HObject* object, objects)
         {
-            if (stateVariables().contains("LastChange"))
+            QByteArray excerpt = m_didlLiteCache->excerpt(object, filter);
+            if (excerpt.isEmpty())
             {
-                item->setTrackChangesOption(true);
+                return QByteArray();
             }
+            excerpts.append(excerpt);
         }
-    }
 
-    if (h->m_lastEventSent)
+        ok = ser.serializeToXml(excerpts, &escaper);
+    }
+    else
     {
-        h->m_modificationEvents.clear();
-        h->m_lastEventSent = false;
+        ok = ser.serializeToXml(objects, filter, &escaper);
     }
 
-    HContainerEventInfo einfo(eventInfo);
-
-    quint32 sysUpdateId;
-    qint32 retVal = getSystemUpdateId(&sysUpdateId);
-    Q_ASSERT(retVal == UpnpSuccess); Q_UNUSED(retVal)
-
-    einfo.setUpdateId(sysUpdateId);
-
-    source->setContainerUpdateId(sysUpdateId);
-
-    h->m_modificationEvents.append(new HModificationEvent(source, einfo));
+    return ok ? retVal : QByteArray();
 }
 
-void HContentDirectoryService::independentObjectAdded(HObject* source)
+void HContentDirectoryServicePrivate::search(
+    HContainer* container, const HCdsSearchQuery& query,
+    const QSet<QString>& candidates, HObjects* matches)
 {
-    Q_UNUSED(source)
-    //H_D(HContentDirectoryService);
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    HLOG_DBG(QString(
+        "Evaluating [%1] candidates from the search index").arg(
+            QString::number(candidates.size())));
+
+    QString containerId = container->id();
+    foreach(const QString& candidateId, candidates)
+    {
+        HObject* candidate = m_dataSource->findObject(candidateId);
+        if (candidate && candidateId != containerId &&
+            query.matches(candidate) && isDescendant(candidate, containerId))
+        {
+            matches->append(candidate);
+        }
+    }
 }
 
-bool HContentDirectoryService::init()
+qint32 HContentDirectoryServicePrivate::browseDirectChildren(
+    const HCdsSnapshot& snapshot, const QString& containerId,
+    const QSet<QString>& filter, const QStringList& sortCriteria,
+    quint32 startingIndex, quint32 requestedCount, HSearchResult* result)
 {
-    H_D(HContentDirectoryService);
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
-    if (stateVariables().contains("LastChange"))
+    if (!snapshot.container(containerId))
     {
-        h->enableChangeTracking();
+        HLOG_WARN(QString(
+            "The specified object ID [%1] does not map to a container").arg(
+                containerId));
+
+        return HContentDirectoryInfo::InvalidObjectId;
     }
 
-    return true;
-}
+    QList<HSortInfo> sortInfos;
+    if (!sortCriteria.isEmpty())
+    {
+        qint32 rc = parseSortCriteria(sortCriteria, &sortInfos);
+        if (rc != 0)
+        {
+            return rc;
+        }
+    }
 
-HContentDirectoryService::~HContentDirectoryService()
-{
-}
+    quint32 childCount =
+        static_cast<quint32>(snapshot.childIds(containerId).size());
 
-qint32 HContentDirectoryService::getSearchCapabilities(QStringList* oarg) const
-{
-    HLOG2(H_AT, H_FUN, h_ptr->m_loggingIdentifier);
-    Q_ASSERT_X(oarg, H_AT, "Out argument(s) cannot be null");
+    if (startingIndex > childCount)
+    {
+        return UpnpInvalidArgs;
+    }
 
-    oarg->clear();
+    quint32 numberReturned = requestedCount > 0 ?
+        qMin(requestedCount, childCount - startingIndex) :
+        childCount - startingIndex;
 
-//    *oarg = QString(
-//        "@id,@parentID,upnp:class,upnp:objectUpdateID,"
-//        "upnp:containerUpdateID,dc:title,dc:creator,dc:date,res@size").split(',');
-// TODO once search is included
+    HObjects objects;
+    if (sortInfos.isEmpty())
+    {
+        objects = snapshot.children(
+            containerId, static_cast<qint32>(startingIndex),
+            static_cast<qint32>(numberReturned));
+    }
+    else
+    {
+        // Without the child index of the service every child is sorted
+        // before the requested page is taken.
+        objects = snapshot.children(containerId, 0, -1);
+        {
+            QReadLocker lock(HObjectPrivate::propertyLock());
+            HCdsChildIndex::sort(sortInfos, &objects);
+        }
+        objects = objects.mid(startingIndex, numberReturned);
+    }
 
-    return UpnpSuccess;
-}
+    QByteArray dliteDoc = serializeConcurrently(objects, filter);
 
-qint32 HContentDirectoryService::getSortCapabilities(QStringList* oarg) const
-{
-    HLOG2(H_AT, H_FUN, h_ptr->m_loggingIdentifier);
-    Q_ASSERT_X(oarg, H_AT, "Out argument(s) cannot be null");
+    *result = HSearchResult::fromEscapedResult(
+        dliteDoc, static_cast<quint32>(objects.size()), childCount,
+        snapshot.systemUpdateId());
 
-    *oarg = QString("dc:title,dc:creator,dc:date,res@size,upnp:class,upnp:album,upnp:originalTrackNumber").split(',');
     return UpnpSuccess;
 }
 
-qint32 HContentDirectoryService::getSortExtensionCapabilities(
-    QStringList* oarg) const
+qint32 HContentDirectoryServicePrivate::browseMetadata(
+    const HCdsSnapshot& snapshot, const QString& objectId,
+    const QSet<QString>& filter, quint32 startingIndex,
+    HSearchResult* result)
 {
-    HLOG2(H_AT, H_FUN, h_ptr->m_loggingIdentifier);
-    Q_ASSERT_X(oarg, H_AT, "Out argument(s) cannot be null");
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
-    if (!actions().value("GetSortExtensionCapabilities"))
+    if (startingIndex)
     {
-        return UpnpOptionalActionNotImplemented;
+        HLOG_WARN(QString(
+            "The starting index was specified as [%1], although it "
+            "should be zero when browsing meta data").arg(
+                QString::number(startingIndex)));
+
+        return UpnpInvalidArgs;
     }
 
-    *oarg = QString("+,-,TIME+,TIME-").split(',');
-    return UpnpSuccess;
-}
+    HObject* object = snapshot.object(objectId);
+    if (!object)
+    {
+        HLOG_WARN(QString(
+            "No object was found with the specified object ID [%1]").arg(
+                objectId));
 
-qint32 HContentDirectoryService::getFeatureList(QString* oarg) const
-{
-    HLOG2(H_AT, H_FUN, h_ptr->m_loggingIdentifier);
-    Q_ASSERT_X(oarg, H_AT, "Out argument(s) cannot be null");
+        return HContentDirectoryInfo::InvalidObjectId;
+    }
 
-    *oarg = QString();
-    return UpnpSuccess;
-}
+    QByteArray dliteDoc = serializeConcurrently(HObjects() << object, filter);
 
-qint32 HContentDirectoryService::getSystemUpdateId(quint32* oarg) const
-{
-    HLOG2(H_AT, H_FUN, h_ptr->m_loggingIdentifier);
-    Q_ASSERT_X(oarg, H_AT, "Out argument(s) cannot be null");
+    *result = HSearchResult::fromEscapedResult(
+        dliteDoc, 1, 1, snapshot.systemUpdateId());
 
-    *oarg = stateVariables().value("SystemUpdateID")->value().toUInt();
     return UpnpSuccess;
 }
 
-qint32 HContentDirectoryService::getServiceResetToken(QString* oarg) const
+void HContentDirectoryServicePrivate::search(
+    const HCdsSnapshot& snapshot, const QString& containerId,
+    const HCdsSearchQuery& query, HObjects* matches)
 {
-    HLOG2(H_AT, H_FUN, h_ptr->m_loggingIdentifier);
-    Q_ASSERT_X(oarg, H_AT, "Out argument(s) cannot be null");
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    // The properties are locked for one object at a time, which keeps the
+    // thread of the data source from waiting for the whole search.
+    QSet<QString> visited;
+    QStringList containerIds;
+    containerIds.append(containerId);
+    visited.insert(containerId);
+
+    while(!containerIds.isEmpty())
+    {
+        QString currentId = containerIds.takeLast();
+        foreach(const QString& childId, snapshot.childIds(currentId))
+        {
+            HObject* child = snapshot.object(childId);
+            if (!child)
+            {
+                continue;
+            }
+
+            bool match;
+            {
+                QReadLocker lock(HObjectPrivate::propertyLock());
+                match = query.matches(child);
+            }
+
+            if (match)
+            {
+                matches->append(child);
+            }
+
+            if (child->isContainer() && !visited.contains(childId))
+            {
+                visited.insert(childId);
+                containerIds.append(childId);
+            }
+        }
+    }
+}
+
+QByteArray HContentDirectoryServicePrivate::serializeConcurrently(
+    const HObjects& objects, const QSet<QString>& filter)
+{
+    H_Q(HContentDirectoryService);
+
+    QByteArray retVal;
+    QBuffer buffer(&retVal);
+    buffer.open(QIODevice::WriteOnly);
+
+    HXmlEscapingDevice escaper(&buffer);
+
+    QStringList objectIds;
+    HCdsDidlLiteSerializer ser;
+    bool ok;
+    {
+        QReadLocker lock(HObjectPrivate::propertyLock());
+        foreach(HObject* object, objects)
+        {
+            objectIds.append(object->id());
+        }
+        ok = ser.serializeToXml(objects, filter, &escaper);
+    }
+
+    bool invoked = QMetaObject::invokeMethod(
+        q, "objectsRequested", Qt::QueuedConnection,
+        Q_ARG(QStringList, objectIds));
+    Q_ASSERT(invoked); Q_UNUSED(invoked)
+
+    return ok ? retVal : QByteArray();
+}
+
+qint32 HContentDirectoryServicePrivate::browseSnapshot(
+    const QString& objectId, HContentDirectoryInfo::BrowseFlag browseFlag,
+    const QSet<QString>& filter, quint32 startingIndex,
+    quint32 requestedCount, const QStringList& sortCriteria,
+    HSearchResult* result)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    HCdsSnapshotPtr snapshot = m_dataSource->h_ptr->snapshot();
+
+    switch(browseFlag)
+    {
+    case HContentDirectoryInfo::BrowseDirectChildren:
+        return browseDirectChildren(
+            *snapshot, objectId, filter, sortCriteria, startingIndex,
+            requestedCount, result);
+
+    case HContentDirectoryInfo::BrowseMetadata:
+        return browseMetadata(
+            *snapshot, objectId, filter, startingIndex, result);
+
+    default:
+        HLOG_WARN(QString("received invalid browse flag"));
+        return UpnpInvalidArgs;
+    }
+}
+
+qint32 HContentDirectoryServicePrivate::searchSnapshot(
+    const QString& containerId, const QString& searchCriteria,
+    const QSet<QString>& filter, quint32 startingIndex,
+    quint32 requestedCount, const QStringList& sortCriteria,
+    HSearchResult* result)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    HCdsSnapshotPtr snapshot = m_dataSource->h_ptr->snapshot();
+
+    if (!snapshot->container(containerId))
+    {
+        return HContentDirectoryInfo::InvalidObjectId;
+    }
+
+    HCdsSearchQuery query;
+    if (!query.compile(searchCriteria))
+    {
+        HLOG_WARN(QString("Invalid search criteria [%1]: %2").arg(
+            searchCriteria, query.lastErrorDescription()));
+
+        return HContentDirectoryInfo::InvalidSearchCriteria;
+    }
+
+    QList<HSortInfo> sortInfos;
+    if (!sortCriteria.isEmpty())
+    {
+        qint32 rc = parseSortCriteria(sortCriteria, &sortInfos);
+        if (rc != 0)
+        {
+            return rc;
+        }
+    }
+
+    // The search index is maintained in the thread of the data source,
+    // which is why the subtree is always walked.
+    HObjects objects;
+    search(*snapshot, containerId, query, &objects);
+
+    quint32 totalMatches = static_cast<quint32>(objects.size());
+    if (startingIndex > totalMatches)
+    {
+        return UpnpInvalidArgs;
+    }
+
+    if (!sortInfos.isEmpty())
+    {
+        QReadLocker lock(HObjectPrivate::propertyLock());
+        HCdsChildIndex::sort(sortInfos, &objects);
+    }
+
+    quint32 numberReturned = requestedCount > 0 ?
+        qMin(requestedCount, totalMatches - startingIndex) :
+        totalMatches - startingIndex;
+
+    objects = objects.mid(startingIndex, numberReturned);
+
+    QByteArray dliteDoc = serializeConcurrently(objects, filter);
+
+    *result = HSearchResult::fromEscapedResult(
+        dliteDoc, numberReturned, totalMatches, snapshot->systemUpdateId());
+
+    HLOG_INFO(QString(
+        "Search handled successfully: returned: [%1] matching objects of [%2] "
+        "possible totals.").arg(
+            QString::number(numberReturned), QString::number(totalMatches)));
+
+    return UpnpSuccess;
+}
+
+void HContentDirectoryServicePrivate::enableChangeTracking()
+{
+    H_Q(HContentDirectoryService);
+
+    bool ok = QObject::connect(
+        m_dataSource, SIGNAL(objectModified(Herqq::Upnp::Av::HObject*, Herqq::Upnp::Av::HObjectEventInfo)),
+        q, SLOT(objectModified(Herqq::Upnp::Av::HObject*, Herqq::Upnp::Av::HObjectEventInfo)));
+    Q_ASSERT(ok); Q_UNUSED(ok)
+
+    ok = QObject::connect(
+        m_dataSource, SIGNAL(containerModified(Herqq::Upnp::Av::HContainer*, Herqq::Upnp::Av::HContainerEventInfo)),
+        q, SLOT(containerModified(Herqq::Upnp::Av::HContainer*, Herqq::Upnp::Av::HContainerEventInfo)));
+    Q_ASSERT(ok);
+
+    ok = QObject::connect(
+        m_dataSource, SIGNAL(independentObjectAdded(Herqq::Upnp::Av::HObject*)),
+        q, SLOT(independentObjectAdded(Herqq::Upnp::Av::HObject*)));
+    Q_ASSERT(ok);
+
+    ok = QObject::connect(
+        m_dataSource,
+        SIGNAL(bulkUpdateFinished(QStringList,QStringList,QStringList)),
+        q, SLOT(bulkUpdateFinished(QStringList,QStringList,QStringList)));
+    Q_ASSERT(ok);
+
+    foreach(HObject* object, m_dataSource->objects())
+    {
+        object->setTrackChangesOption(true);
+    }
+
+    m_timer.start();
+}
+
+void HContentDirectoryServicePrivate::recordChange(
+    HLastChangeEntry::Type type, const QString& objectId, quint32 updateId,
+    const HObject* addedObject)
+{
+    if (!m_lastChangeEnabled)
+    {
+        return;
+    }
+
+    if (type == HLastChangeEntry::ObjectModified)
+    {
+        QHash<QString, qint64>::const_iterator ci =
+            m_pendingChangeSeqs.constFind(objectId);
+
+        if (ci != m_pendingChangeSeqs.constEnd())
+        {
+            // The pending addition or modification of the object is
+            // reported with the latest update ID only.
+            m_pendingChanges[ci.value() - m_firstPendingSeq].m_updateId =
+                updateId;
+            return;
+        }
+    }
+
+    HLastChangeEntry entry(type, objectId, updateId);
+    if (type == HLastChangeEntry::ObjectAdded)
+    {
+        Q_ASSERT(addedObject);
+        entry.m_parentId = addedObject->parentId();
+        entry.m_clazz = addedObject->clazz();
+    }
+
+    if (type == HLastChangeEntry::ObjectDeleted)
+    {
+        m_pendingChangeSeqs.remove(objectId);
+    }
+    else
+    {
+        m_pendingChangeSeqs.insert(
+            objectId, m_firstPendingSeq + m_pendingChanges.size());
+    }
+
+    m_pendingChanges.append(entry);
+}
+
+QString HContentDirectoryServicePrivate::generateLastChange()
+{
+    QString retVal;
+
+    QXmlStreamWriter writer(&retVal);
+
+    writer.setCodec("UTF-8");
+    writer.writeStartDocument();
+    writer.writeStartElement("StateEvent");
+    writer.writeDefaultNamespace("urn:schemas-upnp-org:av:cds-event");
+    writer.writeAttribute("xmlns:xsd", "http://www.w3.org/2001/XMLSchema");
+    writer.writeAttribute("xmlns:xsi", "http://www.w3.org/2001/XMLSchema-instance");
+
+    writer.writeAttribute("xsi:schemaLocation",
+        "urn:schemas-upnp-org:av:cds-event" \
+        "http://www.upnp.org/schemas/av/cds-events.xsd");
+
+    qint32 count = m_pendingChanges.size();
+    if (m_maxLastChangeEntries > 0 && count > m_maxLastChangeEntries)
+    {
+        // The rest of the changes are sent in the following events.
+        count = m_maxLastChangeEntries;
+    }
+
+    for(qint32 i = 0; i < count; ++i)
+    {
+        const HLastChangeEntry& entry = m_pendingChanges[i];
+        switch(entry.m_type)
+        {
+        case HLastChangeEntry::ObjectAdded:
+            writer.writeStartElement("objAdd");
+            writer.writeAttribute("objParentID", entry.m_parentId);
+            writer.writeAttribute("objClass", entry.m_clazz);
+            break;
+        case HLastChangeEntry::ObjectModified:
+            writer.writeStartElement("objMod");
+            break;
+        case HLastChangeEntry::ObjectDeleted:
+            writer.writeStartElement("objDel");
+            break;
+        default:
+            Q_ASSERT(false);
+            break;
+        }
+
+        writer.writeAttribute("objID", entry.m_objectId);
+        writer.writeAttribute("updateID", QString::number(entry.m_updateId));
+        writer.writeAttribute("stUpdate", "0");
+        writer.writeEndElement();
+
+        // A later change of the object is no longer collapsed into this one.
+        QHash<QString, qint64>::iterator it =
+            m_pendingChangeSeqs.find(entry.m_objectId);
+
+        if (it != m_pendingChangeSeqs.end() &&
+            it.value() == m_firstPendingSeq + i)
+        {
+            m_pendingChangeSeqs.erase(it);
+        }
+    }
+    writer.writeEndElement();
+
+    m_pendingChanges.erase(
+        m_pendingChanges.begin(), m_pendingChanges.begin() + count);
+    m_firstPendingSeq += count;
+
+    return retVal;
+}
+
+quint32 HContentDirectoryServicePrivate::nextUpdateId()
+{
+    ++m_systemUpdateId;
+    if (m_dataSource)
+    {
+        // The snapshots read in the worker threads carry the value, which
+        // the responses report as their UpdateID.
+        m_dataSource->h_ptr->setSystemUpdateId(m_systemUpdateId);
+    }
+    return m_systemUpdateId;
+}
+
+void HContentDirectoryServicePrivate::containerChanged(
+    HContainer* container, quint32 updateId)
+{
+    container->setContainerUpdateId(updateId);
+
+    if (m_containerUpdateIdsEnabled)
+    {
+        // A container modified several times during the moderation interval
+        // is reported once with its latest update ID.
+        m_modifiedContainers.insert(container->id());
+    }
+}
+
+QString HContentDirectoryServicePrivate::generateContainerUpdateIds()
+{
+    // The value is a CSV list of container ID and update ID pairs, in which
+    // the commas and backslashes of the IDs are escaped.
+    QString retVal;
+    foreach(const QString& id, m_modifiedContainers)
+    {
+        HContainer* container = m_dataSource->findContainer(id);
+        if (!container)
+        {
+            continue;
+        }
+
+        if (!retVal.isEmpty())
+        {
+            retVal.append(',');
+        }
+
+        retVal.append(QString(id).replace('\\', "\\\\").replace(',', "\\,"));
+        retVal.append(',').append(
+            QString::number(container->containerUpdateId()));
+    }
+
+    m_modifiedContainers.clear();
+
+    return retVal;
+}
+
+/*******************************************************************************
+ * HContentDirectoryService
+ ******************************************************************************/
+HContentDirectoryService::HContentDirectoryService(
+    HContentDirectoryServicePrivate& dd) :
+        HAbstractContentDirectoryService(dd)
+{
+    H_D(HContentDirectoryService);
+    h->m_timer.setInterval(HContentDirectoryServiceConfiguration::
+        DefaultLastChangeModerationInterval);
+    bool ok = connect(&h->m_timer, SIGNAL(timeout()), this, SLOT(timeout()));
+    Q_ASSERT(ok); Q_UNUSED(ok)
+}
+
+HContentDirectoryService::HContentDirectoryService(HAbstractCdsDataSource* dataSource) :
+    HAbstractContentDirectoryService(
+        *new HContentDirectoryServicePrivate())
+{
+    H_D(HContentDirectoryService);
+    Q_ASSERT_X(dataSource, "", "Valid HCdsDataSource has to be provided");
+    h->m_dataSource = dataSource;
+    h->m_timer.setInterval(HContentDirectoryServiceConfiguration::
+        DefaultLastChangeModerationInterval);
+    bool ok = connect(&h->m_timer, SIGNAL(timeout()), this, SLOT(timeout()));
+    Q_ASSERT(ok); Q_UNUSED(ok)
+}
+
+HContentDirectoryService::HContentDirectoryService(
+    const HContentDirectoryServiceConfiguration& configuration) :
+        HAbstractContentDirectoryService(
+            *new HContentDirectoryServicePrivate())
+{
+    H_D(HContentDirectoryService);
+    Q_ASSERT_X(
+        configuration.isValid(), "", "Valid configuration has to be provided");
+
+    h->m_dataSource = configuration.dataSource();
+    h->m_maxLastChangeEntries = configuration.maximumLastChangeEntries();
+    h->m_concurrentQueriesEnabled = configuration.concurrentQueriesEnabled();
+    h->m_maxPendingQueries = configuration.maximumPendingQueries();
+    h->m_maxConcurrentTransfers = configuration.maximumConcurrentTransfers();
+    h->m_transferBandwidthLimit = configuration.transferBandwidthLimit();
+    h->m_timer.setInterval(configuration.lastChangeModerationInterval());
+    bool ok = connect(&h->m_timer, SIGNAL(timeout()), this, SLOT(timeout()));
+    Q_ASSERT(ok); Q_UNUSED(ok)
+}
+
+void HContentDirectoryService::timeout()
+{
+    H_D(HContentDirectoryService);
+
+    // SystemUpdateID and ContainerUpdateIDs are evented at most once per
+    // interval regardless of the number of changes during it.
+    if (stateVariables().value("SystemUpdateID")->value().toUInt() !=
+        h->m_systemUpdateId)
+    {
+        bool ok = setValue("SystemUpdateID", h->m_systemUpdateId);
+        Q_ASSERT(ok); Q_UNUSED(ok)
+    }
+
+    if (!h->m_modifiedContainers.isEmpty())
+    {
+        bool ok = setValue(
+            "ContainerUpdateIDs", h->generateContainerUpdateIds());
+        Q_ASSERT(ok); Q_UNUSED(ok)
+    }
+
+    if (!h->m_pendingChanges.isEmpty())
+    {
+        QString lastChangeData = h->generateLastChange();
+        bool ok = setValue("LastChange", lastChangeData);
+        Q_ASSERT(ok); Q_UNUSED(ok)
+    }
+}
+
+void HContentDirectoryService::transferIdsChanged()
+{
+    H_D(HContentDirectoryService);
+    if (stateVariables().contains("TransferIDs"))
+    {
+        bool ok = setValue("TransferIDs", h->m_transferEngine->transferIds());
+        Q_ASSERT(ok); Q_UNUSED(ok)
+    }
+}
+
+void HContentDirectoryService::objectModified(
+    HObject* source, const HObjectEventInfo& /*eventInfo*/)
+{
+    H_D(HContentDirectoryService);
+
+    quint32 sysUpdateId = h->nextUpdateId();
+    source->setObjectUpdateId(sysUpdateId);
+
+    h->recordChange(
+        HLastChangeEntry::ObjectModified, source->id(), sysUpdateId);
+}
+
+void HContentDirectoryService::containerModified(
+    HContainer* source, const HContainerEventInfo& eventInfo)
+{
+    H_D(HContentDirectoryService);
+
+    HObject* child = 0;
+    if (eventInfo.type() == HContainerEventInfo::ChildAdded)
+    {
+        child = h->m_dataSource->findObject(eventInfo.childId());
+        if (child && child->isItem())
+        {
+            if (h->m_lastChangeEnabled || h->m_containerUpdateIdsEnabled)
+            {
+                child->setTrackChangesOption(true);
+            }
+        }
+    }
+
+    quint32 sysUpdateId = h->nextUpdateId();
+    h->containerChanged(source, sysUpdateId);
+
+    switch(eventInfo.type())
+    {
+    case HContainerEventInfo::ChildAdded:
+        if (child)
+        {
+            h->recordChange(
+                HLastChangeEntry::ObjectAdded, child->id(), sysUpdateId, child);
+        }
+        break;
+    case HContainerEventInfo::ChildRemoved:
+        h->recordChange(
+            HLastChangeEntry::ObjectDeleted, eventInfo.childId(), sysUpdateId);
+        break;
+    case HContainerEventInfo::ChildModified:
+        h->recordChange(
+            HLastChangeEntry::ObjectModified, eventInfo.childId(), sysUpdateId);
+        break;
+    default:
+        Q_ASSERT(false);
+        break;
+    }
+}
+
+void HContentDirectoryService::objectsRequested(const QStringList& ids)
+{
+    H_D(HContentDirectoryService);
+    if (h->m_dataSource)
+    {
+        h->m_dataSource->objectsRequested(ids);
+    }
+}
+
+void HContentDirectoryService::independentObjectAdded(HObject* source)
+{
+    Q_UNUSED(source)
+    //H_D(HContentDirectoryService);
+}
+
+void HContentDirectoryService::bulkUpdateFinished(
+    const QStringList& addedIds, const QStringList& /*modifiedIds*/,
+    const QStringList& containerIds)
+{
+    H_D(HContentDirectoryService);
+
+    foreach(const QString& id, addedIds)
+    {
+        HObject* object = h->m_dataSource->findObject(id);
+        if (object)
+        {
+            object->setTrackChangesOption(true);
+        }
+    }
+
+    // The changes are reported as a single modification of each affected
+    // container, instead of an event for every added or modified child.
+    quint32 sysUpdateId = h->nextUpdateId();
+    foreach(const QString& id, containerIds)
+    {
+        HContainer* container = h->m_dataSource->findContainer(id);
+        if (container)
+        {
+            h->containerChanged(container, sysUpdateId);
+            h->recordChange(
+                HLastChangeEntry::ObjectModified, id, sysUpdateId);
+        }
+    }
+}
+
+bool HContentDirectoryService::init()
+{
+    H_D(HContentDirectoryService);
+
+    h->m_systemUpdateId =
+        stateVariables().value("SystemUpdateID")->value().toUInt();
+    h->m_dataSource->h_ptr->setSystemUpdateId(h->m_systemUpdateId);
+
+    if (h->m_concurrentQueriesEnabled)
+    {
+        // The queries read snapshots of the data source and lock the
+        // properties of the objects, which is why they can run concurrently.
+        QStringList queries;
+        queries << "Browse" << "Search";
+        foreach(const QString& name, queries)
+        {
+            HServerAction* action = actions().value(name);
+            if (action)
+            {
+                action->setExecutionPolicy(HServerAction::ExecuteConcurrently);
+                action->setMaxPendingInvocations(h->m_maxPendingQueries);
+            }
+        }
+    }
+
+    if (actions().value("ImportResource") || actions().value("ExportResource"))
+    {
+        h->m_transferEngine = new HCdsTransferEngine(
+            h->m_dataSource, h->m_maxConcurrentTransfers,
+            h->m_transferBandwidthLimit, this);
+
+        bool ok = connect(
+            h->m_transferEngine, SIGNAL(transferIdsChanged()),
+            this, SLOT(transferIdsChanged()));
+        Q_ASSERT(ok); Q_UNUSED(ok)
+    }
+
+    h->m_lastChangeEnabled = stateVariables().contains("LastChange");
+    h->m_containerUpdateIdsEnabled =
+        stateVariables().contains("ContainerUpdateIDs");
+
+    if (h->m_lastChangeEnabled || h->m_containerUpdateIdsEnabled)
+    {
+        h->enableChangeTracking();
+    }
+
+    return true;
+}
+
+HContentDirectoryService::~HContentDirectoryService()
+{
+}
+
+qint32 HContentDirectoryService::getSearchCapabilities(QStringList* oarg) const
+{
+    HLOG2(H_AT, H_FUN, h_ptr->m_loggingIdentifier);
+    Q_ASSERT_X(oarg, H_AT, "Out argument(s) cannot be null");
+
+    *oarg = HCdsSearchQuery::searchCapabilities();
+
+    return UpnpSuccess;
+}
+
+qint32 HContentDirectoryService::getSortCapabilities(QStringList* oarg) const
+{
+    HLOG2(H_AT, H_FUN, h_ptr->m_loggingIdentifier);
+    Q_ASSERT_X(oarg, H_AT, "Out argument(s) cannot be null");
+
+    *oarg = QString("dc:title,dc:creator,dc:date,res@size,upnp:class,upnp:album,upnp:originalTrackNumber").split(',');
+    return UpnpSuccess;
+}
+
+qint32 HContentDirectoryService::getSortExtensionCapabilities(
+    QStringList* oarg) const
+{
+    HLOG2(H_AT, H_FUN, h_ptr->m_loggingIdentifier);
+    Q_ASSERT_X(oarg, H_AT, "Out argument(s) cannot be null");
+
+    if (!actions().value("GetSortExtensionCapabilities"))
+    {
+        return UpnpOptionalActionNotImplemented;
+    }
+
+    *oarg = QString("+,-,TIME+,TIME-").split(',');
+    return UpnpSuccess;
+}
+
+qint32 HContentDirectoryService::getFeatureList(QString* oarg) const
+{
+    HLOG2(H_AT, H_FUN, h_ptr->m_loggingIdentifier);
+    Q_ASSERT_X(oarg, H_AT, "Out argument(s) cannot be null");
+
+    *oarg = QString();
+    return UpnpSuccess;
+}
+
+qint32 HContentDirectoryService::getSystemUpdateId(quint32* oarg) const
+{
+    HLOG2(H_AT, H_FUN, h_ptr->m_loggingIdentifier);
+    Q_ASSERT_X(oarg, H_AT, "Out argument(s) cannot be null");
+
+    // The state variable is updated only once per moderation interval.
+    const HContentDirectoryServicePrivate* h = h_func();
+
+    *oarg = h->m_systemUpdateId;
+    return UpnpSuccess;
+}
+
+qint32 HContentDirectoryService::getServiceResetToken(QString* oarg) const
+{
+    HLOG2(H_AT, H_FUN, h_ptr->m_loggingIdentifier);
+    Q_ASSERT_X(oarg, H_AT, "Out argument(s) cannot be null");
 
     *oarg = stateVariables().value("ServiceResetToken")->value().toString();
     return UpnpSuccess;
@@ -597,6 +1218,46 @@ qint32 HContentDirectoryService::browse(
 
     HLOG_INFO(QString("processing browse request to object id %1").arg(objectId));
 
+    if (QThread::currentThread() != thread())
+    {
+        qint32 retVal = h->browseSnapshot(
+            objectId, browseFlag, filter, startingIndex, requestedCount,
+            sortCriteria, result);
+
+        if (retVal == UpnpSuccess)
+        {
+            HLOG_INFO(QString(
+                "Browse handled successfully: returned: [%1] matching objects "
+                "of [%2] possible totals.").arg(
+                    QString::number(result->numberReturned()),
+                    QString::number(result->totalMatches())));
+        }
+
+        return retVal;
+    }
+
+    // Identical browse requests, such as the polling of the root container,
+    // are answered from the cache until the browsed objects change.
+    qint32 cacheSize = h->m_dataSource->configuration()->browseCacheSize();
+    if (!h->m_browseCache && cacheSize > 0)
+    {
+        h->m_browseCache =
+            new HCdsBrowseCache(h->m_dataSource, cacheSize, this);
+    }
+
+    if (h->m_browseCache && h->m_browseCache->find(
+        objectId, browseFlag, filter, startingIndex, requestedCount,
+        sortCriteria, result))
+    {
+        HLOG_INFO(QString(
+            "Browse handled from cache: returned: [%1] matching objects of "
+            "[%2] possible totals.").arg(
+                QString::number(result->numberReturned()),
+                QString::number(result->totalMatches())));
+
+        return UpnpSuccess;
+    }
+
     qint32 retVal = 0;
     switch(browseFlag)
     {
@@ -624,6 +1285,13 @@ qint32 HContentDirectoryService::browse(
         return retVal;
     }
 
+    if (h->m_browseCache)
+    {
+        h->m_browseCache->insert(
+            objectId, browseFlag, filter, startingIndex, requestedCount,
+            sortCriteria, *result);
+    }
+
     HLOG_INFO(QString(
         "Browse handled successfully: returned: [%1] matching objects of [%2] "
         "possible totals.").arg(
@@ -634,9 +1302,9 @@ qint32 HContentDirectoryService::browse(
 }
 
 qint32 HContentDirectoryService::search(
-    const QString& containerId, const QString& /*searchCriteria*/,
-    const QSet<QString>& /*filter*/, quint32 /*startingIndex*/,
-    quint32 /*requestedCount*/, const QStringList& /*sortCriteria*/,
+    const QString& containerId, const QString& searchCriteria,
+    const QSet<QString>& filter, quint32 startingIndex,
+    quint32 requestedCount, const QStringList& sortCriteria,
     HSearchResult* result)
 {
     H_D(HContentDirectoryService);
@@ -656,17 +1324,300 @@ qint32 HContentDirectoryService::search(
     HLOG_INFO(QString("attempting to locate container with id %1").arg(
         containerId));
 
+    if (QThread::currentThread() != thread())
+    {
+        return h->searchSnapshot(
+            containerId, searchCriteria, filter, startingIndex,
+            requestedCount, sortCriteria, result);
+    }
+
+    HContainer* container = qobject_cast<HContainer*>(
+        h->m_dataSource->findObject(containerId));
+
+    if (!container)
+    {
+        return HContentDirectoryInfo::InvalidObjectId;
+    }
+
+    HCdsSearchQuery query;
+    if (!query.compile(searchCriteria))
+    {
+        HLOG_WARN(QString("Invalid search criteria [%1]: %2").arg(
+            searchCriteria, query.lastErrorDescription()));
+
+        return HContentDirectoryInfo::InvalidSearchCriteria;
+    }
+
+    QList<HSortInfo> sortInfos;
+    if (!sortCriteria.isEmpty())
+    {
+        qint32 rc = h->parseSortCriteria(sortCriteria, &sortInfos);
+        if (rc != 0)
+        {
+            return rc;
+        }
+    }
+
+    HObjects objects;
+    h->findMatches(container, query, &objects);
+
+    quint32 totalMatches = static_cast<quint32>(objects.size());
+    if (startingIndex > totalMatches)
+    {
+        return UpnpInvalidArgs;
+    }
+
+    if (!sortInfos.isEmpty())
+    {
+        HCdsChildIndex::sort(sortInfos, &objects);
+    }
+
+    quint32 numberReturned = requestedCount > 0 ?
+        qMin(requestedCount, totalMatches - startingIndex) :
+        totalMatches - startingIndex;
+
+    objects = objects.mid(startingIndex, numberReturned);
+
+    QByteArray dliteDoc = h->serialize(objects, filter);
+
+    HSearchResult retVal = HSearchResult::fromEscapedResult(
+        dliteDoc, numberReturned, totalMatches,
+        stateVariables().value("A_ARG_TYPE_UpdateID")->value().toUInt());
+
+    *result = retVal;
+
+    HLOG_INFO(QString(
+        "Search handled successfully: returned: [%1] matching objects of [%2] "
+        "possible totals.").arg(
+            QString::number(numberReturned), QString::number(totalMatches)));
+
+    return UpnpSuccess;
+}
+
+qint32 HContentDirectoryService::createReference(
+    const QString& containerId, const QString& objectId, QString* newId)
+{
+    H_D(HContentDirectoryService);
+    HLOG2(H_AT, H_FUN, h_ptr->m_loggingIdentifier);
+    Q_ASSERT_X(newId, H_AT, "Out argument(s) cannot be null");
+
+    if (!actions().value("CreateReference"))
+    {
+        return UpnpOptionalActionNotImplemented;
+    }
+
     HContainer* container = qobject_cast<HContainer*>(
         h->m_dataSource->findObject(containerId));
 
     if (!container)
+    {
+        return HContentDirectoryInfo::NoSuchContainer;
+    }
+    else if (container->isRestricted())
+    {
+        return HContentDirectoryInfo::RestrictedParentObject;
+    }
+
+    HItem* item = qobject_cast<HItem*>(h->m_dataSource->findObject(objectId));
+    if (!item)
     {
         return HContentDirectoryInfo::InvalidObjectId;
     }
 
+    HItem* reference = item->newReference(containerId);
+    if (!h->m_dataSource->add(reference))
+    {
+        HLOG_WARN(QString("Failed to add a reference to object [%1]").arg(
+            objectId));
+
+        delete reference;
+        return UpnpActionFailed;
+    }
+
+    *newId = reference->id();
+    return UpnpSuccess;
+}
+
+qint32 HContentDirectoryService::freeFormQuery(
+    const QString& containerId, quint32 cdsView,
+    const QString& queryRequest, HFreeFormQueryResult* result)
+{
+    H_D(HContentDirectoryService);
+    HLOG2(H_AT, H_FUN, h_ptr->m_loggingIdentifier);
+
+    if (!result)
+    {
+        Q_ASSERT(false);
+        return UpnpInvalidArgs;
+    }
+
+    if (!actions().value("FreeFormQuery"))
+    {
+        return UpnpOptionalActionNotImplemented;
+    }
+    else if (cdsView != 0)
+    {
+        // Only the default view of the objects is available.
+        return HContentDirectoryInfo::UnsupportedOrInvalidCDSView;
+    }
+
+    HContainer* container = qobject_cast<HContainer*>(
+        h->m_dataSource->findObject(containerId));
+
+    if (!container)
+    {
+        return HContentDirectoryInfo::NoSuchContainer;
+    }
+
+    HCdsFreeFormQuery query;
+    if (!query.compile(containerId, queryRequest))
+    {
+        HLOG_WARN(QString("Invalid query request [%1]: %2").arg(
+            queryRequest, query.lastErrorDescription()));
+
+        return query.isUnsupported() ?
+            HContentDirectoryInfo::UnsupportedQueryRequestInstruction :
+            HContentDirectoryInfo::InvalidQueryRequest;
+    }
+
+    QList<HSortInfo> sortInfos;
+    if (!query.sortCriteria().isEmpty() &&
+        h->parseSortCriteria(query.sortCriteria(), &sortInfos) != 0)
+    {
+        return HContentDirectoryInfo::UnsupportedQueryRequestInstruction;
+    }
+
+    HObjects objects;
+    h->findMatches(container, query.searchQuery(), &objects);
+
+    if (!sortInfos.isEmpty())
+    {
+        HCdsChildIndex::sort(sortInfos, &objects);
+    }
+
+    QStringList objectIds;
+    foreach(HObject* object, objects)
+    {
+        objectIds.append(object->id());
+    }
+    h->m_dataSource->objectsRequested(objectIds);
+
+    // The result is escaped with the rest of the SOAP response, which is
+    // why it is not written in the escaped form used by Browse and Search.
+    HCdsDidlLiteSerializer ser;
+    *result = HFreeFormQueryResult(
+        ser.serializeToXml(objects, query.projection()),
+        stateVariables().value("A_ARG_TYPE_UpdateID")->value().toUInt());
+
+    HLOG_INFO(QString(
+        "FreeFormQuery handled successfully: returned: [%1] objects").arg(
+            QString::number(objects.size())));
+
+    return UpnpSuccess;
+}
+
+qint32 HContentDirectoryService::getFreeFormQueryCapabilities(
+    QString* ffqCapabilities)
+{
+    HLOG2(H_AT, H_FUN, h_ptr->m_loggingIdentifier);
+    Q_ASSERT_X(ffqCapabilities, H_AT, "Out argument(s) cannot be null");
+
+    if (!actions().value("GetFreeFormQueryCapabilities"))
+    {
+        return UpnpOptionalActionNotImplemented;
+    }
+
+    *ffqCapabilities = HCdsFreeFormQuery::capabilities();
     return UpnpSuccess;
 }
 
+qint32 HContentDirectoryService::importResource(
+    const QUrl& source, const QUrl& destination, quint32* transferId)
+{
+    H_D(HContentDirectoryService);
+    HLOG2(H_AT, H_FUN, h_ptr->m_loggingIdentifier);
+    Q_ASSERT_X(transferId, H_AT, "Out argument(s) cannot be null");
+
+    if (!actions().value("ImportResource"))
+    {
+        return UpnpOptionalActionNotImplemented;
+    }
+
+    HItem* item = h->m_transferEngine->findItem(destination);
+    if (!item)
+    {
+        return HContentDirectoryInfo::NoSuchDestinationResource;
+    }
+    else if (item->isRestricted() || !h->m_dataSource->supportsStoring())
+    {
+        return HContentDirectoryInfo::DestinationResourceAccessDenied;
+    }
+    else if (source.scheme() != "http")
+    {
+        return HContentDirectoryInfo::NoSuchResource;
+    }
+
+    return h->m_transferEngine->startImport(item->id(), source, transferId);
+}
+
+qint32 HContentDirectoryService::exportResource(
+    const QUrl& source, const QUrl& destination, quint32* transferId)
+{
+    H_D(HContentDirectoryService);
+    HLOG2(H_AT, H_FUN, h_ptr->m_loggingIdentifier);
+    Q_ASSERT_X(transferId, H_AT, "Out argument(s) cannot be null");
+
+    if (!actions().value("ExportResource"))
+    {
+        return UpnpOptionalActionNotImplemented;
+    }
+
+    HItem* item = h->m_transferEngine->findItem(source);
+    if (!item)
+    {
+        return HContentDirectoryInfo::NoSuchResource;
+    }
+    else if (!h->m_dataSource->isLoadable(item->id()))
+    {
+        return HContentDirectoryInfo::SourceResourceAccessDenied;
+    }
+    else if (destination.scheme() != "http")
+    {
+        return HContentDirectoryInfo::NoSuchDestinationResource;
+    }
+
+    return h->m_transferEngine->startExport(
+        item->id(), destination, transferId);
+}
+
+qint32 HContentDirectoryService::stopTransferResource(quint32 transferId)
+{
+    H_D(HContentDirectoryService);
+    HLOG2(H_AT, H_FUN, h_ptr->m_loggingIdentifier);
+
+    if (!actions().value("StopTransferResource") || !h->m_transferEngine)
+    {
+        return UpnpOptionalActionNotImplemented;
+    }
+
+    return h->m_transferEngine->stop(transferId);
+}
+
+qint32 HContentDirectoryService::getTransferProgress(
+    quint32 transferId, HTransferProgressInfo* transferInfo)
+{
+    H_D(HContentDirectoryService);
+    HLOG2(H_AT, H_FUN, h_ptr->m_loggingIdentifier);
+    Q_ASSERT_X(transferInfo, H_AT, "Out argument(s) cannot be null");
+
+    if (!actions().value("GetTransferProgress") || !h->m_transferEngine)
+    {
+        return UpnpOptionalActionNotImplemented;
+    }
+
+    return h->m_transferEngine->progress(transferId, transferInfo);
+}
+
 }
 }
 }
@@ -47,7 +47,9 @@ class HContentDirectoryServicePrivate;
  *
  * \ingroup hupnp_av_cds
  *
- * \remarks This class is not thread-safe.
+ * \remarks This class is not thread-safe, except that \c Browse and
+ * \c Search can be served in the worker threads of the device host.
+ * See HContentDirectoryServiceConfiguration::setConcurrentQueriesEnabled().
  *
  * \sa HAbstractMediaServerDevice, HAbstractContentDirectoryService
  */
@@ -68,8 +70,16 @@ private Q_SLOTS:
     void containerModified(
         Herqq::Upnp::Av::HContainer*, const Herqq::Upnp::Av::HContainerEventInfo&);
 
+    void objectsRequested(const QStringList& ids);
+
     void independentObjectAdded(Herqq::Upnp::Av::HObject* source);
 
+    void bulkUpdateFinished(
+        const QStringList& addedIds, const QStringList& modifiedIds,
+        const QStringList& containerIds);
+
+    void transferIdsChanged();
+
 protected:
 
     //
@@ -93,6 +103,21 @@ public:
      */
     HContentDirectoryService(HAbstractCdsDataSource* dataSource);
 
+    /*!
+     * \brief Creates a new instance.
+     *
+     * \param configuration specifies the data source the content directory
+     * uses and how the changes of the data source are evented.
+     *
+     * \sa init()
+     *
+     * \remarks The ownership of the data source is not transferred;
+     * the content directory service only uses it and it will never delete it.
+     * Make sure the data source is not deleted before this object is deleted.
+     */
+    HContentDirectoryService(
+        const HContentDirectoryServiceConfiguration& configuration);
+
     /*!
      * \brief Destroys the instance.
      *
@@ -131,6 +156,79 @@ public:
         quint32 requestedCount,
         const QStringList& sortCriteria,
         HSearchResult* result);
+
+    /*!
+     * Creates a reference item to an item of the data source.
+     *
+     * The reference is created with HItem::newReference(), which means that
+     * it shares the properties of the referenced item instead of copying
+     * them.
+     *
+     * \sa HAbstractContentDirectoryService::createReference()
+     */
+    virtual qint32 createReference(
+        const QString& containerId, const QString& objectId,
+        QString* newId);
+
+    /*!
+     * Runs an XQuery request.
+     *
+     * This implementation supports path and FLWOR expressions that select
+     * the items or the containers under the specified container by
+     * conditions on their properties, optionally sorted and projected to
+     * a list of properties. The result is a DIDL-Lite document of the
+     * matching objects containing only the projected properties.
+     *
+     * \sa HAbstractContentDirectoryService::freeFormQuery()
+     */
+    virtual qint32 freeFormQuery(
+        const QString& containerId, quint32 cdsView,
+        const QString& queryRequest, HFreeFormQueryResult* result);
+
+    virtual qint32 getFreeFormQueryCapabilities(QString* ffqCapabilities);
+
+    /*!
+     * Starts importing a resource into an item of the data source.
+     *
+     * The destination has to be a resource of an item the data source can
+     * store, see HAbstractCdsDataSource::storeItemData(). The resource is
+     * downloaded with HTTP GET in the background and the number of
+     * transfers running at the same time as well as the rate of each
+     * of them are limited as specified in
+     * HContentDirectoryServiceConfiguration. An import of the same
+     * source that was stopped or failed earlier continues from where it
+     * ended, if the source supports range requests.
+     *
+     * \sa HAbstractContentDirectoryService::importResource()
+     */
+    virtual qint32 importResource(
+        const QUrl& source, const QUrl& destination, quint32* transferId);
+
+    /*!
+     * Starts exporting the data of an item of the data source.
+     *
+     * The data is sent with HTTP POST in the background under the same
+     * limits as the imports.
+     *
+     * \sa HAbstractContentDirectoryService::exportResource()
+     */
+    virtual qint32 exportResource(
+        const QUrl& source, const QUrl& destination, quint32* transferId);
+
+    virtual qint32 stopTransferResource(quint32 transferId);
+
+    /*!
+     * Returns the progress of a transfer that is running or that ended
+     * recently.
+     *
+     * The progress is updated at most once a second while the transfer runs,
+     * which means the returned length lags a little behind the actual
+     * transfer.
+     *
+     * \sa HAbstractContentDirectoryService::getTransferProgress()
+     */
+    virtual qint32 getTransferProgress(
+        quint32 transferId, HTransferProgressInfo* transferInfo);
 };
 
 }
@@ -35,7 +35,10 @@
 #include "../cds_model/cds_objects/hitem.h"
 #include "../cds_model/cds_objects/hcontainer.h"
 #include "../cds_model/datasource/hcds_datasource.h"
+#include "../cds_model/datasource/hcds_snapshot_p.h"
 
+#include <QtCore/QSet>
+#include <QtCore/QHash>
 #include <QtCore/QTimer>
 #include <QtCore/QPointer>
 
@@ -48,72 +51,41 @@ namespace Upnp
 namespace Av
 {
 
+class HCdsChildIndex;
+class HCdsDidlLiteCache;
+class HCdsBrowseCache;
+class HCdsSearchQuery;
+class HCdsTransferEngine;
+
 //
+// A change that is waiting to be sent in a LastChange event. The class and
+// the parent of an added object are resolved when the change is recorded,
+// which is why the event can be written without looking up the objects.
 //
-//
-class HModificationEvent
+class HLastChangeEntry
 {
-H_DISABLE_COPY(HModificationEvent)
-
 public:
 
     enum Type
     {
-        ObjectModification,
-        ContainerModification
+        ObjectAdded,
+        ObjectModified,
+        ObjectDeleted
     };
 
-private:
-
     Type m_type;
-    QPointer<HObject> m_source;
-
-public:
-
-    union
-    {
-        HObjectEventInfo* m_objectEventInfo;
-        HContainerEventInfo* m_containerEventInfo;
-    };
+    QString m_objectId;
 
-    HModificationEvent(HObject* source, const HObjectEventInfo& info) :
-        m_type(ObjectModification), m_source(source),
-        m_objectEventInfo(new HObjectEventInfo(info))
-    {
-    }
+    QString m_parentId;
+    QString m_clazz;
+    // these are set only for ObjectAdded
 
-    HModificationEvent(HContainer* source, const HContainerEventInfo& info) :
-        m_type(ContainerModification), m_source(source),
-        m_containerEventInfo(new HContainerEventInfo(info))
-    {
-    }
+    quint32 m_updateId;
 
-    ~HModificationEvent()
-    {
-        if (m_type == ObjectModification)
-        {
-            delete m_objectEventInfo;
-        }
-        else
-        {
-            delete m_containerEventInfo;
-        }
-    }
-
-    inline Type type() const { return m_type; }
-    inline HContainerEventInfo containerEvent() const
-    {
-        Q_ASSERT(type() == ContainerModification);
-        return *m_containerEventInfo;
-    }
-    inline HObjectEventInfo objectEvent() const
-    {
-        Q_ASSERT(type() == ObjectModification);
-        return *m_objectEventInfo;
-    }
-    inline HObject* source() const
+    HLastChangeEntry(Type type, const QString& objectId, quint32 updateId) :
+        m_type(type), m_objectId(objectId), m_parentId(), m_clazz(),
+        m_updateId(updateId)
     {
-        return m_source;
     }
 };
 
@@ -128,9 +100,56 @@ H_DISABLE_COPY(HContentDirectoryServicePrivate)
 
 private:
 
-    qint32 sort(const QStringList& sortCriteria, QList<HObject*>& objects);
+    qint32 parseSortCriteria(
+        const QStringList& sortCriteria, QList<HSortInfo>* sortInfos);
+
+    qint32 browseDirectChildren(
+        const QString& containerId,
+        const QSet<QString>& filter,
+        const QStringList& sortCriteria,
+        quint32 startingIndex,
+        quint32 requestedCount,
+        HSearchResult*);
+
+    qint32 browseMetadata(
+        const QString& objectId,
+        const QSet<QString>& filter,
+        quint32 startingIndex,
+        HSearchResult*);
+
+    void search(
+        HContainer* container,
+        const HCdsSearchQuery& query,
+        HObjects* matches);
+
+    // evaluates the query against the candidates produced by a search index
+    void search(
+        HContainer* container,
+        const HCdsSearchQuery& query,
+        const QSet<QString>& candidates,
+        HObjects* matches);
+
+    // uses the search index of the data source, if any, to find the
+    // candidates, as Search and FreeFormQuery both do
+    void findMatches(
+        HContainer* container,
+        const HCdsSearchQuery& query,
+        HObjects* matches);
+
+    bool isDescendant(const HObject* object, const QString& containerId);
+
+    // serializes the objects into a DIDL-Lite document that is escaped
+    // for a SOAP message
+    QByteArray serialize(const HObjects& objects, const QSet<QString>& filter);
+
+    // the counterparts of the functions above that are run in the worker
+    // threads. these read the latest snapshot of the data source and lock
+    // the properties of the objects while reading them. the caches of the
+    // service are not used, as they are maintained in the thread of the
+    // service
 
     qint32 browseDirectChildren(
+        const HCdsSnapshot&,
         const QString& containerId,
         const QSet<QString>& filter,
         const QStringList& sortCriteria,
@@ -139,21 +158,120 @@ private:
         HSearchResult*);
 
     qint32 browseMetadata(
+        const HCdsSnapshot&,
         const QString& objectId,
         const QSet<QString>& filter,
         quint32 startingIndex,
         HSearchResult*);
 
+    void search(
+        const HCdsSnapshot&,
+        const QString& containerId,
+        const HCdsSearchQuery& query,
+        HObjects* matches);
+
+    // the data source is told about the requested objects in the thread of
+    // the service
+    QByteArray serializeConcurrently(
+        const HObjects& objects, const QSet<QString>& filter);
+
+    qint32 browseSnapshot(
+        const QString& objectId,
+        HContentDirectoryInfo::BrowseFlag browseFlag,
+        const QSet<QString>& filter,
+        quint32 startingIndex,
+        quint32 requestedCount,
+        const QStringList& sortCriteria,
+        HSearchResult*);
+
+    qint32 searchSnapshot(
+        const QString& containerId,
+        const QString& searchCriteria,
+        const QSet<QString>& filter,
+        quint32 startingIndex,
+        quint32 requestedCount,
+        const QStringList& sortCriteria,
+        HSearchResult*);
+
     void enableChangeTracking();
+
+    // records a change for the next LastChange event. a modification of an
+    // object that is already waiting to be sent is collapsed into the
+    // pending change
+    void recordChange(
+        HLastChangeEntry::Type type, const QString& objectId,
+        quint32 updateId, const HObject* addedObject = 0);
+
+    // writes at most m_maxLastChangeEntries pending changes into a LastChange
+    // document and removes them from the pending changes
     QString generateLastChange();
 
+    // increments SystemUpdateID for a change and returns the new value
+    quint32 nextUpdateId();
+
+    // sets the update ID of a modified container and marks it for the next
+    // ContainerUpdateIDs event
+    void containerChanged(HContainer* container, quint32 updateId);
+
+    // writes the modified containers into a ContainerUpdateIDs value and
+    // clears the set of modified containers
+    QString generateContainerUpdateIds();
+
 public:
 
     QPointer<HAbstractCdsDataSource> m_dataSource;
-    bool m_lastEventSent;
+
+    HCdsChildIndex* m_childIndex;
+    // created on the first browse request and owned by the service
+
+    HCdsDidlLiteCache* m_didlLiteCache;
+    // created on the first browse or search request if the cache is enabled
+    // in the configuration of the data source and owned by the service
+
+    HCdsBrowseCache* m_browseCache;
+    // created on the first browse request if the cache is enabled in the
+    // configuration of the data source and owned by the service
+
     QTimer m_timer;
+    // moderates the rate at which LastChange is evented
+
+    QList<HLastChangeEntry> m_pendingChanges;
+    // the changes that have not been sent yet, oldest first
+
+    QHash<QString, qint64> m_pendingChangeSeqs;
+    // key == the ID of an object with a pending addition or modification,
+    // value == the sequence number of the change in m_pendingChanges
+
+    qint64 m_firstPendingSeq;
+    // the sequence number of the first change in m_pendingChanges
+
+    qint32 m_maxLastChangeEntries;
+    // the maximum number of changes in a single LastChange event
+
+    quint32 m_systemUpdateId;
+    // the current value of SystemUpdateID. the state variable is updated
+    // once per moderation interval
+
+    QSet<QString> m_modifiedContainers;
+    // the IDs of the containers modified since the last ContainerUpdateIDs
+    // event
+
+    bool m_lastChangeEnabled;
+    bool m_containerUpdateIdsEnabled;
+    // whether the service has the corresponding state variables
+
+    bool m_concurrentQueriesEnabled;
+    qint32 m_maxPendingQueries;
+    // whether Browse and Search are run in the worker threads of the device
+    // host and how many of each may be pending there
+
+    HCdsTransferEngine* m_transferEngine;
+    // created in init() if the service has ImportResource or ExportResource
+    // and owned by the service
 
-    QList<HModificationEvent*> m_modificationEvents;
+    qint32 m_maxConcurrentTransfers;
+    qint64 m_transferBandwidthLimit;
+    // the configuration of the transfer engine
 
 public:
 
@@ -37,7 +37,19 @@ namespace Av
  * HContentDirectoryServiceConfigurationPrivate
  *******************************************************************************/
 HContentDirectoryServiceConfigurationPrivate::HContentDirectoryServiceConfigurationPrivate() :
-    m_dataSource(0), m_refCnt(0), m_hasOwnership(false)
+    m_dataSource(0), m_refCnt(0), m_hasOwnership(false),
+    m_lastChangeModerationInterval(
+        HContentDirectoryServiceConfiguration::
+            DefaultLastChangeModerationInterval),
+    m_maximumLastChangeEntries(
+        HContentDirectoryServiceConfiguration::DefaultMaximumLastChangeEntries),
+    m_concurrentQueriesEnabled(false),
+    m_maximumPendingQueries(
+        HContentDirectoryServiceConfiguration::DefaultMaximumPendingQueries),
+    m_maximumConcurrentTransfers(
+        HContentDirectoryServiceConfiguration::
+            DefaultMaximumConcurrentTransfers),
+    m_transferBandwidthLimit(0)
 {
 }
 
@@ -96,6 +108,14 @@ void HContentDirectoryServiceConfiguration::doClone(HClonable* target) const
     }
     conf->h_ptr->m_hasOwnership = h_ptr->m_hasOwnership;
     conf->h_ptr->m_dataSource = h_ptr->m_dataSource;
+    conf->h_ptr->m_lastChangeModerationInterval =
+        h_ptr->m_lastChangeModerationInterval;
+    conf->h_ptr->m_maximumLastChangeEntries = h_ptr->m_maximumLastChangeEntries;
+    conf->h_ptr->m_concurrentQueriesEnabled = h_ptr->m_concurrentQueriesEnabled;
+    conf->h_ptr->m_maximumPendingQueries = h_ptr->m_maximumPendingQueries;
+    conf->h_ptr->m_maximumConcurrentTransfers =
+        h_ptr->m_maximumConcurrentTransfers;
+    conf->h_ptr->m_transferBandwidthLimit = h_ptr->m_transferBandwidthLimit;
 }
 
 HContentDirectoryServiceConfiguration* HContentDirectoryServiceConfiguration::newInstance() const
@@ -144,6 +164,81 @@ void HContentDirectoryServiceConfiguration::detachDataSource()
     h_ptr->detach();
 }
 
+qint32 HContentDirectoryServiceConfiguration::lastChangeModerationInterval() const
+{
+    return h_ptr->m_lastChangeModerationInterval;
+}
+
+bool HContentDirectoryServiceConfiguration::setLastChangeModerationInterval(
+    qint32 msecs)
+{
+    if (msecs < 0)
+    {
+        return false;
+    }
+
+    h_ptr->m_lastChangeModerationInterval = msecs;
+    return true;
+}
+
+qint32 HContentDirectoryServiceConfiguration::maximumLastChangeEntries() const
+{
+    return h_ptr->m_maximumLastChangeEntries;
+}
+
+void HContentDirectoryServiceConfiguration::setMaximumLastChangeEntries(
+    qint32 count)
+{
+    h_ptr->m_maximumLastChangeEntries = count > 0 ? count : 0;
+}
+
+bool HContentDirectoryServiceConfiguration::concurrentQueriesEnabled() const
+{
+    return h_ptr->m_concurrentQueriesEnabled;
+}
+
+void HContentDirectoryServiceConfiguration::setConcurrentQueriesEnabled(
+    bool enable)
+{
+    h_ptr->m_concurrentQueriesEnabled = enable;
+}
+
+qint32 HContentDirectoryServiceConfiguration::maximumPendingQueries() const
+{
+    return h_ptr->m_maximumPendingQueries;
+}
+
+void HContentDirectoryServiceConfiguration::setMaximumPendingQueries(
+    qint32 count)
+{
+    h_ptr->m_maximumPendingQueries = count > 0 ? count : 0;
+}
+
+qint32 HContentDirectoryServiceConfiguration::maximumConcurrentTransfers() const
+{
+    return h_ptr->m_maximumConcurrentTransfers;
+}
+
+void HContentDirectoryServiceConfiguration::setMaximumConcurrentTransfers(
+    qint32 count)
+{
+    if (count > 0)
+    {
+        h_ptr->m_maximumConcurrentTransfers = count;
+    }
+}
+
+qint64 HContentDirectoryServiceConfiguration::transferBandwidthLimit() const
+{
+    return h_ptr->m_transferBandwidthLimit;
+}
+
+void HContentDirectoryServiceConfiguration::setTransferBandwidthLimit(
+    qint64 bytesPerSecond)
+{
+    h_ptr->m_transferBandwidthLimit = qMax(Q_INT64_C(0), bytesPerSecond);
+}
+
 }
 }
 }
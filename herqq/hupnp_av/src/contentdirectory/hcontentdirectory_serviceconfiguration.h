@@ -65,6 +65,29 @@ protected:
 
 public:
 
+    enum
+    {
+        /*!
+         * The default value of lastChangeModerationInterval() in milliseconds.
+         */
+        DefaultLastChangeModerationInterval = 200,
+
+        /*!
+         * The default value of maximumLastChangeEntries().
+         */
+        DefaultMaximumLastChangeEntries = 500,
+
+        /*!
+         * The default value of maximumPendingQueries().
+         */
+        DefaultMaximumPendingQueries = 64,
+
+        /*!
+         * The default value of maximumConcurrentTransfers().
+         */
+        DefaultMaximumConcurrentTransfers = 2
+    };
+
     /*!
      * \brief Creates a new instance.
      */
@@ -136,6 +159,185 @@ public:
      * \sa setDataSource()
      */
     void detachDataSource();
+
+    /*!
+     * \brief Returns the minimum time between two \c LastChange events.
+     *
+     * The changes of the data source are collected and sent to the
+     * subscribers of \c LastChange at most once per this interval.
+     * The default is DefaultLastChangeModerationInterval, which is the
+     * maximum event rate the ContentDirectory:3 specification allows.
+     *
+     * \return the minimum time between two \c LastChange events in
+     * milliseconds.
+     *
+     * \sa setLastChangeModerationInterval()
+     */
+    qint32 lastChangeModerationInterval() const;
+
+    /*!
+     * \brief Specifies the minimum time between two \c LastChange events.
+     *
+     * \param msecs specifies the minimum time between two \c LastChange
+     * events in milliseconds.
+     *
+     * \return \e true in case the value was set. The value cannot be negative.
+     *
+     * \sa lastChangeModerationInterval()
+     */
+    bool setLastChangeModerationInterval(qint32 msecs);
+
+    /*!
+     * \brief Returns the maximum number of changes a single \c LastChange
+     * event contains.
+     *
+     * In case more changes are waiting to be sent, the oldest changes are sent
+     * first and the rest of the changes are sent in the following events.
+     * Repeated modifications of an object that have not been sent yet are
+     * reported as a single change. The default is
+     * DefaultMaximumLastChangeEntries.
+     *
+     * \return the maximum number of changes a single \c LastChange event
+     * contains. Zero means that there is no limit.
+     *
+     * \sa setMaximumLastChangeEntries()
+     */
+    qint32 maximumLastChangeEntries() const;
+
+    /*!
+     * \brief Specifies the maximum number of changes a single \c LastChange
+     * event contains.
+     *
+     * \param count specifies the maximum number of changes a single
+     * \c LastChange event contains. Zero or a negative value means that
+     * there is no limit.
+     *
+     * \sa maximumLastChangeEntries()
+     */
+    void setMaximumLastChangeEntries(qint32 count);
+
+    /*!
+     * \brief Indicates whether the \c Browse and \c Search requests are
+     * served in the worker threads of the device host.
+     *
+     * \return \e true in case the \c Browse and \c Search requests are
+     * served in the worker threads of the device host.
+     *
+     * \sa setConcurrentQueriesEnabled()
+     */
+    bool concurrentQueriesEnabled() const;
+
+    /*!
+     * \brief Specifies whether the \c Browse and \c Search requests are
+     * served in the worker threads of the device host.
+     *
+     * By default the requests are served in the thread of the device host,
+     * which means that a search of a large data source delays every other
+     * request and event of the device host. When this is enabled, the
+     * requests are run concurrently in the worker threads and their
+     * responses are sent once they complete. The number of the threads is
+     * set with HDeviceHostConfiguration::setActionThreadCount().
+     *
+     * A request served in a worker thread reads the latest published
+     * snapshot of the data source, which means that it sees either all or
+     * none of the modifications made in a single event loop iteration or
+     * bulk update, and the \c UpdateID of the response is the
+     * \c SystemUpdateID that matches the snapshot. The properties of the
+     * objects are read as they are when the request runs. The
+     * ContentDirectoryService does not use its browse and DIDL-Lite caches
+     * for these requests, since the caches are maintained in the thread of
+     * the device host.
+     *
+     * \param enable specifies whether the \c Browse and \c Search requests
+     * are served in the worker threads of the device host. The default is
+     * \e false.
+     *
+     * \sa concurrentQueriesEnabled(), setMaximumPendingQueries()
+     */
+    void setConcurrentQueriesEnabled(bool enable);
+
+    /*!
+     * \brief Returns the maximum number of \c Browse and the maximum number
+     * of \c Search requests that are queued or run in the worker threads.
+     *
+     * \return the maximum number of \c Browse and the maximum number of
+     * \c Search requests that are queued or run in the worker threads.
+     * Zero means that there is no limit.
+     *
+     * \sa setMaximumPendingQueries()
+     */
+    qint32 maximumPendingQueries() const;
+
+    /*!
+     * \brief Specifies the maximum number of \c Browse and the maximum
+     * number of \c Search requests that are queued or run in the worker
+     * threads.
+     *
+     * A request received while the limit is reached is answered with the
+     * error \c UpnpActionFailed. The default is DefaultMaximumPendingQueries.
+     *
+     * \param count specifies the maximum number of pending requests of
+     * each action. Zero or a negative value means that there is no limit.
+     *
+     * \remarks This has an effect only when concurrentQueriesEnabled()
+     * is \e true.
+     *
+     * \sa maximumPendingQueries(), HServerAction::setMaxPendingInvocations()
+     */
+    void setMaximumPendingQueries(qint32 count);
+
+    /*!
+     * \brief Returns the maximum number of \c ImportResource and
+     * \c ExportResource transfers that are run at the same time.
+     *
+     * \return the maximum number of transfers that are run at the same time.
+     *
+     * \sa setMaximumConcurrentTransfers()
+     */
+    qint32 maximumConcurrentTransfers() const;
+
+    /*!
+     * \brief Specifies the maximum number of \c ImportResource and
+     * \c ExportResource transfers that are run at the same time.
+     *
+     * A transfer requested while the limit is reached is queued and started
+     * once one of the running transfers ends. The default is
+     * DefaultMaximumConcurrentTransfers.
+     *
+     * \param count specifies the maximum number of transfers that are run
+     * at the same time. A value smaller than one is ignored.
+     *
+     * \sa maximumConcurrentTransfers()
+     */
+    void setMaximumConcurrentTransfers(qint32 count);
+
+    /*!
+     * \brief Returns the maximum rate at which a single resource transfer
+     * is run.
+     *
+     * \return the maximum rate of a single transfer in bytes per second.
+     * Zero means that there is no limit.
+     *
+     * \sa setTransferBandwidthLimit()
+     */
+    qint64 transferBandwidthLimit() const;
+
+    /*!
+     * \brief Specifies the maximum rate at which a single resource transfer
+     * is run.
+     *
+     * An import is throttled by reading the response at most at this rate,
+     * which makes the sender slow down once the buffers fill up, and an
+     * export is throttled by reading the exported data at most at this rate.
+     * By default there is no limit.
+     *
+     * \param bytesPerSecond specifies the maximum rate of a single transfer
+     * in bytes per second. Zero or a negative value means that there is
+     * no limit.
+     *
+     * \sa transferBandwidthLimit()
+     */
+    void setTransferBandwidthLimit(qint64 bytesPerSecond);
 };
 
 }
@@ -54,6 +54,12 @@ public: // attributes
     QPointer<HAbstractCdsDataSource> m_dataSource;
     int* m_refCnt;
     bool m_hasOwnership;
+    qint32 m_lastChangeModerationInterval;
+    qint32 m_maximumLastChangeEntries;
+    bool m_concurrentQueriesEnabled;
+    qint32 m_maximumPendingQueries;
+    qint32 m_maximumConcurrentTransfers;
+    qint64 m_transferBandwidthLimit;
 
 public: // methods
 
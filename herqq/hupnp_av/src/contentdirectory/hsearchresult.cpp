@@ -21,6 +21,8 @@
 
 #include "hsearchresult.h"
 
+#include <HUpnpCore/private/hxmlfragment_p.h>
+
 #include <QtCore/QString>
 
 namespace Herqq
@@ -40,19 +42,22 @@ H_DISABLE_ASSIGN(HSearchResultPrivate)
 public:
 
     QString m_result;
+    QByteArray m_escapedResult;
     quint32 m_numberReturned;
     quint32 m_totalMatches;
     quint32 m_updateId;
 
     HSearchResultPrivate() :
-        m_result(), m_numberReturned(0), m_totalMatches(0), m_updateId(0)
+        m_result(), m_escapedResult(), m_numberReturned(0),
+        m_totalMatches(0), m_updateId(0)
     {
     }
 
     HSearchResultPrivate(
         const QString& result, quint32 numberReturned, quint32 totalMatches,
         quint32 updateId) :
-            m_result(result), m_numberReturned(numberReturned),
+            m_result(result), m_escapedResult(),
+            m_numberReturned(numberReturned),
             m_totalMatches(totalMatches), m_updateId(updateId)
     {
     }
@@ -70,6 +75,15 @@ HSearchResult::HSearchResult(
 {
 }
 
+HSearchResult HSearchResult::fromEscapedResult(
+    const QByteArray& escapedResult, quint32 numberReturned,
+    quint32 totalMatches, quint32 updateId)
+{
+    HSearchResult retVal(QString(), numberReturned, totalMatches, updateId);
+    retVal.h_ptr->m_escapedResult = escapedResult;
+    return retVal;
+}
+
 HSearchResult::HSearchResult(const HSearchResult& other) :
     h_ptr(other.h_ptr)
 {
@@ -89,9 +103,19 @@ HSearchResult::~HSearchResult()
 
 QString HSearchResult::result() const
 {
+    if (!h_ptr->m_escapedResult.isEmpty())
+    {
+        return HXmlFragment(h_ptr->m_escapedResult).toString();
+    }
+
     return h_ptr->m_result;
 }
 
+QByteArray HSearchResult::escapedResult() const
+{
+    return h_ptr->m_escapedResult;
+}
+
 quint32 HSearchResult::numberReturned() const
 {
     return h_ptr->m_numberReturned;
@@ -85,6 +85,30 @@ public:
         const QString& result, quint32 numberReturned, quint32 totalMatches,
         quint32 updateId);
 
+    /*!
+     * \internal
+     *
+     * \brief Creates a new instance from a result that is already serialized
+     * for a SOAP message.
+     *
+     * \param escapedResult specifies the DIDL-Lite XML document of the result
+     * encoded as UTF-8 and XML escaped for use as character data.
+     *
+     * \param numberReturned specifies the number of objects returned in the
+     * \a escapedResult argument.
+     *
+     * \param totalMatches specifies the total number of CDS objects \b in the
+     * CDS object browsed.
+     *
+     * \param updateId specifies the value of the state variable
+     * \c SystemUpdateID at the time the result was generated.
+     *
+     * \sa escapedResult()
+     */
+    static HSearchResult fromEscapedResult(
+        const QByteArray& escapedResult, quint32 numberReturned,
+        quint32 totalMatches, quint32 updateId);
+
     /*!
      * \brief Copy constructor.
      *
@@ -114,6 +138,16 @@ public:
      */
     QString result() const;
 
+    /*!
+     * \internal
+     *
+     * \brief Returns the result as it was specified to fromEscapedResult().
+     *
+     * \return The result as it was specified to fromEscapedResult(). The
+     * returned value is empty in case the result was specified as a string.
+     */
+    QByteArray escapedResult() const;
+
     /*!
      * \brief Returns the number of objects contained in the result().
      *
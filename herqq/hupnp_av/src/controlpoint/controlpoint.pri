@@ -3,8 +3,11 @@ HEADERS += \
     $$SRC_LOC/controlpoint/hav_controlpoint.h \
     $$SRC_LOC/controlpoint/hav_controlpoint_p.h \
     $$SRC_LOC/controlpoint/hav_controlpoint_configuration.h \
-    $$SRC_LOC/controlpoint/hav_controlpoint_configuration_p.h
+    $$SRC_LOC/controlpoint/hav_controlpoint_configuration_p.h \
+    $$SRC_LOC/controlpoint/hav_groupop.h \
+    $$SRC_LOC/controlpoint/hav_groupop_p.h
 
 SOURCES += \
     $$SRC_LOC/controlpoint/hav_controlpoint.cpp \
-    $$SRC_LOC/controlpoint/hav_controlpoint_configuration.cpp
+    $$SRC_LOC/controlpoint/hav_controlpoint_configuration.cpp \
+    $$SRC_LOC/controlpoint/hav_groupop.cpp
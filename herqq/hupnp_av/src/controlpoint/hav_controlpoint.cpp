@@ -22,6 +22,7 @@
 #include "hav_controlpoint.h"
 #include "hav_controlpoint_p.h"
 #include "hav_controlpoint_configuration.h"
+#include "hav_groupop_p.h"
 
 #include "../mediaserver/hmediaserver_adapter.h"
 #include "../mediaserver/hmediaserver_info.h"
@@ -33,6 +34,7 @@
 
 #include <HUpnpCore/HUdn>
 #include <HUpnpCore/HDeviceInfo>
+#include <HUpnpCore/HResourceType>
 #include <HUpnpCore/HDiscoveryType>
 #include <HUpnpCore/HControlPointConfiguration>
 
@@ -87,7 +89,11 @@ HAvControlPointPrivate::~HAvControlPointPrivate()
 bool HAvControlPointPrivate::acceptResource(
     const HDiscoveryType& /*usn*/, const HEndpoint& /*source*/)
 {
-    return true;
+    // The discovery filter of the configuration has already rejected the
+    // resources of the device types that are not interesting, but an empty
+    // filter cannot express that no device types are interesting.
+    return m_configuration->interestingDeviceTypes() !=
+        HAvControlPointConfiguration::None;
 }
 
 void HAvControlPointPrivate::rootDeviceOnline_(HClientDevice* device)
@@ -96,19 +102,25 @@ void HAvControlPointPrivate::rootDeviceOnline_(HClientDevice* device)
 
     HAvControlPoint* p = static_cast<HAvControlPoint*>(parent());
 
-    HMediaServerAdapter* msAdapter = searchAdapter(m_mediaServers, device);
+    HMediaServerAdapter* msAdapter =
+        m_mediaServerIndex.value(device->info().udn());
+
     if (msAdapter)
     {
         msAdapter->setDevice(device);
+        m_mediaServerIndex.insert(msAdapter);
         subscribeEvents(device, VisitThisRecursively);
         emit p->mediaServerOnline(msAdapter);
         return;
     }
 
-    HMediaRendererAdapter* mrAdapter = searchAdapter(m_mediaRenderers, device);
+    HMediaRendererAdapter* mrAdapter =
+        m_mediaRendererIndex.value(device->info().udn());
+
     if (mrAdapter)
     {
         mrAdapter->setDevice(device);
+        m_mediaRendererIndex.insert(mrAdapter);
         subscribeEvents(device, VisitThisRecursively);
         emit p->mediaRendererOnline(mrAdapter);
         return;
@@ -132,6 +144,7 @@ void HAvControlPointPrivate::rootDeviceOnline_(HClientDevice* device)
             {
                 subscribeEvents(device, VisitThisRecursively);
                 m_mediaServers.append(mediaServer);
+                m_mediaServerIndex.insert(mediaServer);
                 emit p->mediaServerOnline(mediaServer);
             }
         }
@@ -154,6 +167,7 @@ void HAvControlPointPrivate::rootDeviceOnline_(HClientDevice* device)
             {
                 subscribeEvents(device, VisitThisRecursively);
                 m_mediaRenderers.append(mediaRenderer);
+                m_mediaRendererIndex.insert(mediaRenderer);
                 emit p->mediaRendererOnline(mediaRenderer);
             }
         }
@@ -171,33 +185,48 @@ void HAvControlPointPrivate::rootDeviceOffline_(HClientDevice* device)
 
     HAvControlPoint* p = static_cast<HAvControlPoint*>(parent());
 
-    foreach(HMediaServerAdapter* server, m_mediaServers)
+    // The adapters of the embedded devices are indexed by the root device
+    // as well.
+    foreach(HMediaServerAdapter* server, m_mediaServerIndex.values(device))
     {
-        if (server->device()->rootDevice() == device)
-        {
-            emit p->mediaServerOffline(server);
-        }
+        emit p->mediaServerOffline(server);
     }
 
-    foreach(HMediaRendererAdapter* renderer, m_mediaRenderers)
+    HMediaRendererAdapters renderers = m_mediaRendererIndex.values(device);
+    foreach(HMediaRendererAdapter* renderer, renderers)
     {
-        if (renderer->device()->rootDevice() == device)
-        {
-            emit p->mediaRendererOffline(renderer);
-        }
+        emit p->mediaRendererOffline(renderer);
     }
+}
 
-    foreach(HClientDevice* embDev, device->embeddedDevices())
+namespace
+{
+// Returns the device types to search for and to accept advertisements of.
+// The first versions are used, since a device responds to a search of a
+// lower version of its type as well.
+QList<HDiscoveryType> discoveryTypes(const HAvControlPointConfiguration& arg)
+{
+    HAvControlPointConfiguration::InterestingDeviceTypes types =
+        arg.interestingDeviceTypes();
+
+    QList<HDiscoveryType> retVal;
+    if (types & HAvControlPointConfiguration::MediaServer)
+    {
+        retVal.append(HDiscoveryType(HResourceType(
+            "urn:schemas-upnp-org:device:MediaServer:1")));
+    }
+    if (types & HAvControlPointConfiguration::MediaRenderer)
     {
-        rootDeviceOffline_(embDev);
+        retVal.append(HDiscoveryType(HResourceType(
+            "urn:schemas-upnp-org:device:MediaRenderer:1")));
     }
+    return retVal;
 }
 
-namespace
-{
 HControlPointConfiguration* convert(const HAvControlPointConfiguration& arg)
 {
     HControlPointConfiguration* retVal = new HControlPointConfiguration();
+    retVal->setDiscoveryFilter(discoveryTypes(arg));
     retVal->setAutoDiscovery(arg.autoDiscovery());
     retVal->setDesiredSubscriptionTimeout(arg.desiredSubscriptionTimeout());
     retVal->setNetworkAddressesToUse(arg.networkAddressesToUse());
@@ -206,6 +235,12 @@ HControlPointConfiguration* convert(const HAvControlPointConfiguration& arg)
 }
 }
 
+void HAvControlPointPrivate::groupCompleted(const HAvGroupOp& op)
+{
+    HAvControlPoint* p = static_cast<HAvControlPoint*>(parent());
+    emit p->groupInvokeComplete(p, op);
+}
+
 /*******************************************************************************
  * HAvControlPoint
  ******************************************************************************/
@@ -262,7 +297,15 @@ bool HAvControlPoint::init()
         return false;
     }
 
-    return h_ptr->scan(HDiscoveryType::createDiscoveryTypeForAllResources());
+    foreach(const HDiscoveryType& type, discoveryTypes(*h_ptr->m_configuration))
+    {
+        if (!h_ptr->scan(type))
+        {
+            return false;
+        }
+    }
+
+    return true;
 }
 
 HAvControlPoint::HAvControlPointError HAvControlPoint::error() const
@@ -307,15 +350,7 @@ HMediaRendererAdapter* HAvControlPoint::mediaRenderer(const HUdn& udn)
         return 0;
     }
 
-    foreach(HMediaRendererAdapter* renderer, h_ptr->m_mediaRenderers)
-    {
-        if (renderer->device()->info().udn() == udn)
-        {
-            return renderer;
-        }
-    }
-
-    return 0;
+    return h_ptr->m_mediaRendererIndex.value(udn);
 }
 
 const HMediaServerAdapters& HAvControlPoint::mediaServers() const
@@ -331,15 +366,7 @@ HMediaServerAdapter* HAvControlPoint::mediaServer(const HUdn& udn)
         return 0;
     }
 
-    foreach(HMediaServerAdapter* server, h_ptr->m_mediaServers)
-    {
-        if (server->device()->info().udn() == udn)
-        {
-            return server;
-        }
-    }
-
-    return 0;
+    return h_ptr->m_mediaServerIndex.value(udn);
 }
 
 bool HAvControlPoint::removeMediaServer(HMediaServerAdapter* mediaServer)
@@ -355,6 +382,7 @@ bool HAvControlPoint::removeMediaServer(HMediaServerAdapter* mediaServer)
     {
         if ((*it) == mediaServer)
         {
+            h_ptr->m_mediaServerIndex.remove(mediaServer);
             delete *it;
             h_ptr->m_mediaServers.erase(it);
             return true;
@@ -378,6 +406,7 @@ bool HAvControlPoint::removeMediaRenderer(HMediaRendererAdapter* mediaRenderer)
     {
         if ((*it) == mediaRenderer)
         {
+            h_ptr->m_mediaRendererIndex.remove(mediaRenderer);
             delete *it;
             h_ptr->m_mediaRenderers.erase(it);
             return true;
@@ -388,11 +417,27 @@ bool HAvControlPoint::removeMediaRenderer(HMediaRendererAdapter* mediaRenderer)
     return false;
 }
 
+HAvGroupOp HAvControlPoint::beginGroupInvoke(
+    const HConnections& members, HAvGroupOp::Service service,
+    const QString& actionName, const QHash<QString, QVariant>& inArgs)
+{
+    HAvGroupRunner* runner = new HAvGroupRunner(h_ptr);
+    return runner->run(members, service, actionName, inArgs);
+}
+
 void HAvControlPoint::quit()
 {
+    // the group invocations are reported before the devices are deleted
+    foreach(HAvGroupRunner* runner, h_ptr->findChildren<HAvGroupRunner*>())
+    {
+        runner->abort();
+    }
+
     h_ptr->quit();
     qDeleteAll(h_ptr->m_mediaServers); h_ptr->m_mediaServers.clear();
     qDeleteAll(h_ptr->m_mediaRenderers); h_ptr->m_mediaRenderers.clear();
+    h_ptr->m_mediaServerIndex.clear();
+    h_ptr->m_mediaRendererIndex.clear();
 }
 
 }
@@ -23,8 +23,12 @@
 #define HAV_CONTROLPOINT_H_
 
 #include <HUpnpAv/HUpnpAv>
+#include <HUpnpAv/HAvGroupOp>
 #include <HUpnpCore/HClientDevice>
 
+#include <QtCore/QHash>
+#include <QtCore/QVariant>
+
 namespace Herqq
 {
 
@@ -348,6 +352,53 @@ public:
      */
     bool removeMediaRenderer(HMediaRendererAdapter* mediaRenderer);
 
+    /*!
+     * \brief Invokes an action on a group of Media Renderer connections.
+     *
+     * The method is meant for controlling the renderers of several rooms
+     * together, for instance, when every renderer of the group should start
+     * playing at the same time. The invocations of all the members are started
+     * before the method returns and without waiting for any of them to
+     * complete, so the requests are sent to the devices at the same time.
+     * The members that use the same instance ID are sent the very same SOAP
+     * message, which is created only once.
+     *
+     * Once the invocation has completed or failed on every member, the
+     * groupInvokeComplete() signal is emitted. No other completion signal is
+     * emitted for the invocations of the group.
+     *
+     * \param members specifies the connections the action is invoked on.
+     *
+     * \param service specifies the service of the connections the action
+     * belongs to.
+     *
+     * \param actionName specifies the name of the action, such as \c Play.
+     *
+     * \param inArgs specifies the values of the input arguments of the action
+     * keyed by the names of the arguments, such as \c Speed. The \c InstanceID
+     * argument is set for each member based on the information of the
+     * connection, and it should not be specified.
+     *
+     * \return an object that identifies the group invocation. This object will
+     * be sent through the groupInvokeComplete() signal once the invocation is
+     * done. The invocation of a member that does not have the specified
+     * action fails with \c UpnpInvalidAction and the invocation of a member
+     * to which the specified arguments cannot be set fails with
+     * \c UpnpInvalidArgs, without affecting the other members.
+     *
+     * \remarks
+     * \li The groupInvokeComplete() signal is never emitted before this
+     * method returns.
+     * \li The members must not be deleted before the group invocation has
+     * completed.
+     *
+     * \sa groupInvokeComplete(), HAvGroupOp
+     */
+    HAvGroupOp beginGroupInvoke(
+        const HConnections& members, HAvGroupOp::Service service,
+        const QString& actionName,
+        const QHash<QString, QVariant>& inArgs = QHash<QString, QVariant>());
+
 public Q_SLOTS:
 
     /*!
@@ -463,6 +514,23 @@ Q_SIGNALS:
      * \param server is the device that has been invalidated.
      */
     void mediaServerInvalidated(Herqq::Upnp::Av::HMediaServerAdapter* server);
+
+    /*!
+     * \brief This signal is emitted when a group invocation has completed on
+     * every member, or the group invocation has been aborted.
+     *
+     * \param source identifies the control point that ran the group invocation.
+     *
+     * \param operation specifies information of the group invocation that
+     * completed. The return value of it is \c UpnpSuccess when the invocation
+     * succeeded on every member. Otherwise it is the return value of the first
+     * member that failed, or \c UpnpInvocationAborted.
+     *
+     * \sa beginGroupInvoke()
+     */
+    void groupInvokeComplete(
+        Herqq::Upnp::Av::HAvControlPoint* source,
+        const Herqq::Upnp::Av::HAvGroupOp& operation);
 };
 
 }
@@ -71,6 +71,8 @@ void HAvControlPointConfiguration::doClone(HClonable* target) const
 
     conf->h_ptr->m_controlpointConfiguration.reset(
        h_ptr->m_controlpointConfiguration ? h_ptr->m_controlpointConfiguration->clone() : 0);
+
+    conf->h_ptr->m_interestingDeviceTypes = h_ptr->m_interestingDeviceTypes;
 }
 
 HAvControlPointConfiguration* HAvControlPointConfiguration::newInstance() const
@@ -207,6 +207,12 @@ public:
      * \param types specifies the device types the HAvControlPoint should
      * search, accept and use.
      *
+     * \remarks The HAvControlPoint searches only the specified device types
+     * and it ignores the advertisements and discovery responses of the other
+     * devices before their descriptions are retrieved. A root device is built
+     * only when it or one of its embedded devices announces itself as one of
+     * the specified types.
+     *
      * \sa interestingDeviceTypes()
      */
      void setInterestingDeviceTypes(InterestingDeviceTypes types) const;
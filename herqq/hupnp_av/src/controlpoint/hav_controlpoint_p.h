@@ -38,6 +38,9 @@
 #include <HUpnpCore/HClientDevice>
 #include <HUpnpCore/HControlPoint>
 
+#include <QtCore/QHash>
+#include <QtCore/QPair>
+
 namespace Herqq
 {
 
@@ -47,6 +50,66 @@ namespace Upnp
 namespace Av
 {
 
+//
+// Indexes the adapters of a type by the UDNs and the root devices of their
+// devices. The keys are stored per adapter, since the device of an adapter
+// may be deleted or replaced before the adapter is removed from the index.
+//
+template<typename T>
+class HAdapterIndex
+{
+private:
+
+    QHash<HUdn, T*> m_byUdn;
+    QMultiHash<HClientDevice*, T*> m_byRootDevice;
+    QHash<T*, QPair<HUdn, HClientDevice*> > m_keys;
+
+public:
+
+    void insert(T* adapter)
+    {
+        remove(adapter);
+
+        HClientDevice* device = adapter->device();
+        HUdn udn = device->info().udn();
+        HClientDevice* root = device->rootDevice();
+
+        m_byUdn.insert(udn, adapter);
+        m_byRootDevice.insert(root, adapter);
+        m_keys.insert(adapter, qMakePair(udn, root));
+    }
+
+    void remove(T* adapter)
+    {
+        typename QHash<T*, QPair<HUdn, HClientDevice*> >::iterator it =
+            m_keys.find(adapter);
+
+        if (it != m_keys.end())
+        {
+            m_byUdn.remove(it.value().first);
+            m_byRootDevice.remove(it.value().second, adapter);
+            m_keys.erase(it);
+        }
+    }
+
+    void clear()
+    {
+        m_byUdn.clear();
+        m_byRootDevice.clear();
+        m_keys.clear();
+    }
+
+    inline T* value(const HUdn& udn) const
+    {
+        return m_byUdn.value(udn);
+    }
+
+    inline QList<T*> values(HClientDevice* rootDevice) const
+    {
+        return m_byRootDevice.values(rootDevice);
+    }
+};
+
 //
 //
 //
@@ -61,20 +124,6 @@ private:
     virtual bool acceptResource(
         const HDiscoveryType& usn, const HEndpoint& source);
 
-    template<typename T>
-    static T* searchAdapter(const QList<T*> adapters, HClientDevice* device)
-    {
-        T* retVal = 0;
-        foreach(T* adapter, adapters)
-        {
-            if (adapter->device()->info().udn() == device->info().udn())
-            {
-                retVal = adapter;
-                break;
-            }
-        }
-        return retVal;
-    }
 
 private Q_SLOTS:
 
@@ -91,8 +140,15 @@ public:
     HMediaServerAdapters m_mediaServers;
     HMediaRendererAdapters m_mediaRenderers;
 
+    HAdapterIndex<HMediaServerAdapter> m_mediaServerIndex;
+    HAdapterIndex<HMediaRendererAdapter> m_mediaRendererIndex;
+    // the indexes of m_mediaServers and m_mediaRenderers
+
     HAvControlPointPrivate(const HControlPointConfiguration&, HAvControlPoint*);
     virtual ~HAvControlPointPrivate();
+
+    // called by a group runner once the group invocation has completed
+    void groupCompleted(const HAvGroupOp&);
 };
 
 }
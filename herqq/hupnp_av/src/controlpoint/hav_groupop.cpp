@@ -0,0 +1,334 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+ */
+
+#include "hav_groupop.h"
+#include "hav_groupop_p.h"
+#include "hav_controlpoint_p.h"
+
+#include "../mediarenderer/hconnection.h"
+#include "../connectionmanager/hconnectioninfo.h"
+#include "../transport/havtransport_adapter.h"
+#include "../renderingcontrol/hrenderingcontrol_adapter.h"
+
+#include <HUpnpCore/HActionInfo>
+#include <HUpnpCore/HClientAction>
+#include <HUpnpCore/HClientService>
+#include <HUpnpCore/HActionArguments>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+/*******************************************************************************
+ * HAvGroupOpPrivate
+ ******************************************************************************/
+HAvGroupOpPrivate::HAvGroupOpPrivate() :
+    HAsyncOpPrivate(HAsyncOpPrivate::genId()),
+        m_members(), m_operations(), m_latencies(), m_runner(0)
+{
+}
+
+HAvGroupOpPrivate::~HAvGroupOpPrivate()
+{
+}
+
+/*******************************************************************************
+ * HAvGroupOp
+ ******************************************************************************/
+HAvGroupOp::HAvGroupOp() :
+    HAsyncOp(*new HAvGroupOpPrivate())
+{
+}
+
+HAvGroupOp::HAvGroupOp(qint32 returnCode, const QString& errorDescription) :
+    HAsyncOp(returnCode, errorDescription, *new HAvGroupOpPrivate())
+{
+}
+
+HAvGroupOp::HAvGroupOp(const HAvGroupOp& other) :
+    HAsyncOp(other)
+{
+}
+
+HAvGroupOp::~HAvGroupOp()
+{
+}
+
+void HAvGroupOp::abort()
+{
+    H_D(HAvGroupOp);
+    if (h->m_runner)
+    {
+        h->m_runner->abort();
+    }
+}
+
+HAvGroupOp& HAvGroupOp::operator=(const HAvGroupOp& other)
+{
+    Q_ASSERT(&other != this);
+    HAsyncOp::operator=(other);
+    return *this;
+}
+
+const HConnections& HAvGroupOp::members() const
+{
+    const H_D(HAvGroupOp);
+    return h->m_members;
+}
+
+const QList<HClientActionOp>& HAvGroupOp::operations() const
+{
+    const H_D(HAvGroupOp);
+    return h->m_operations;
+}
+
+const QList<qint32>& HAvGroupOp::latencies() const
+{
+    const H_D(HAvGroupOp);
+    return h->m_latencies;
+}
+
+/*******************************************************************************
+ * HAvGroupOp_
+ ******************************************************************************/
+HAvGroupOp_::HAvGroupOp_()
+{
+}
+
+void HAvGroupOp_::setRunner(HAvGroupRunner* runner)
+{
+    H_D(HAvGroupOp);
+    h->m_runner = runner;
+}
+
+void HAvGroupOp_::setMembers(const HConnections& members)
+{
+    H_D(HAvGroupOp);
+    h->m_members = members;
+    h->m_latencies.clear();
+    for (qint32 i = 0; i < members.size(); ++i)
+    {
+        h->m_latencies.append(-1);
+    }
+}
+
+void HAvGroupOp_::setOperations(const QList<HClientActionOp>& operations)
+{
+    H_D(HAvGroupOp);
+    h->m_operations = operations;
+}
+
+void HAvGroupOp_::setLatency(qint32 index, qint32 latency)
+{
+    H_D(HAvGroupOp);
+    h->m_latencies[index] = latency;
+}
+
+/*******************************************************************************
+ * HAvGroupRunner
+ ******************************************************************************/
+HAvGroupRunner::HAvGroupRunner(HAvControlPointPrivate* owner) :
+    QObject(owner),
+        m_owner(owner), m_op(), m_indexes(), m_timer(), m_starting(false),
+        m_done(false)
+{
+}
+
+HAvGroupRunner::~HAvGroupRunner()
+{
+}
+
+HAvGroupOp HAvGroupRunner::run(
+    const HConnections& members, HAvGroupOp::Service service,
+    const QString& actionName, const QHash<QString, QVariant>& inArgs)
+{
+    m_op.setRunner(this);
+    m_op.setReturnValue(UpnpInvocationInProgress);
+    m_op.setMembers(members);
+    m_starting = true;
+    m_timer.start();
+
+    QList<HClientActionOp> operations;
+    for (qint32 i = 0; i < members.size(); ++i)
+    {
+        HConnection* member = members.at(i);
+
+        HClientServiceAdapter* adapter = 0;
+        qint32 instanceId = -1;
+        if (service == HAvGroupOp::AvTransport)
+        {
+            adapter = member->transport();
+            instanceId = member->info().avTransportId();
+        }
+        else
+        {
+            adapter = member->renderingControl();
+            instanceId = member->info().rcsId();
+        }
+
+        HClientAction* action = adapter && adapter->service() ?
+            adapter->service()->actions().value(actionName) : 0;
+
+        if (!action)
+        {
+            operations.append(HClientActionOp(
+                UpnpInvalidAction,
+                QString("The connection has no action named [%1]").arg(
+                    actionName)));
+
+            continue;
+        }
+
+        // the members that share an instance ID get identical arguments,
+        // which lets them share the serialized SOAP message as well
+        HActionArguments args = action->info().inputArguments();
+        bool ok = args.setValue("InstanceID", static_cast<quint32>(instanceId));
+
+        QHash<QString, QVariant>::const_iterator ci = inArgs.constBegin();
+        for (; ok && ci != inArgs.constEnd(); ++ci)
+        {
+            ok = args.setValue(ci.key(), ci.value());
+        }
+
+        if (!ok)
+        {
+            operations.append(HClientActionOp(
+                UpnpInvalidArgs,
+                QString("Invalid input arguments for the action [%1]").arg(
+                    actionName)));
+
+            continue;
+        }
+
+        HClientActionOp op = action->beginInvoke(
+            args, HActionInvokeCallback(this, &HAvGroupRunner::invocationDone));
+
+        if (op.returnValue() == UpnpInvocationInProgress)
+        {
+            m_indexes.insert(op.id(), i);
+        }
+
+        operations.append(op);
+    }
+
+    m_op.setOperations(operations);
+    m_starting = false;
+
+    if (m_indexes.isEmpty())
+    {
+        // the completion is always reported after the group has been
+        // returned to the caller
+        bool ok = QMetaObject::invokeMethod(
+            this, "completed", Qt::QueuedConnection);
+        Q_ASSERT(ok); Q_UNUSED(ok)
+    }
+
+    return m_op;
+}
+
+bool HAvGroupRunner::invocationDone(
+    HClientAction*, const HClientActionOp& op)
+{
+    if (m_done)
+    {
+        return false;
+    }
+
+    QHash<unsigned int, qint32>::iterator it = m_indexes.find(op.id());
+    if (it != m_indexes.end())
+    {
+        m_op.setLatency(it.value(), static_cast<qint32>(m_timer.elapsed()));
+        m_indexes.erase(it);
+    }
+
+    if (m_indexes.isEmpty() && !m_starting)
+    {
+        completed();
+    }
+
+    // the invocations of the members are reported only through the group
+    return false;
+}
+
+void HAvGroupRunner::completed()
+{
+    if (m_done)
+    {
+        return;
+    }
+
+    m_done = true;
+
+    qint32 rc = UpnpSuccess;
+    foreach(const HClientActionOp& op, m_op.operations())
+    {
+        if (op.returnValue() != UpnpSuccess)
+        {
+            rc = op.returnValue();
+            break;
+        }
+    }
+
+    report(rc);
+}
+
+void HAvGroupRunner::report(qint32 rc)
+{
+    Q_ASSERT(m_done);
+
+    m_op.setReturnValue(rc);
+    m_op.setRunner(0);
+
+    HAvGroupOp op = m_op;
+    deleteLater();
+
+    m_owner->groupCompleted(op);
+}
+
+void HAvGroupRunner::abort()
+{
+    if (m_done)
+    {
+        return;
+    }
+
+    m_done = true;
+    foreach(HClientActionOp op, m_op.operations())
+    {
+        if (op.returnValue() == UpnpInvocationInProgress)
+        {
+            op.abort();
+            op.setReturnValue(UpnpInvocationAborted);
+        }
+    }
+
+    report(UpnpInvocationAborted);
+}
+
+}
+}
+}
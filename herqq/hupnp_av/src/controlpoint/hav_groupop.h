@@ -0,0 +1,163 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+ */
+
+#ifndef HAV_GROUPOP_H_
+#define HAV_GROUPOP_H_
+
+#include <HUpnpAv/HUpnpAv>
+#include <HUpnpCore/HAsyncOp>
+#include <HUpnpCore/HClientActionOp>
+
+#include <QtCore/QList>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+class HAvGroupOpPrivate;
+
+/*!
+ * \brief This class is used to identify an action invocation sent to a group
+ * of Media Renderer connections and the results of it.
+ *
+ * When you call HAvControlPoint::beginGroupInvoke() you get an instance of
+ * this class that uniquely identifies the group invocation within the running
+ * process. Once the invocation has completed on every member of the group,
+ * the HAvControlPoint::groupInvokeComplete() signal is sent with a copy of
+ * the instance. The results of the members are found at the same index in
+ * members(), operations() and latencies().
+ *
+ * \headerfile hav_groupop.h HAvGroupOp
+ *
+ * \ingroup hupnp_av_cp
+ *
+ * \sa HAvControlPoint::beginGroupInvoke()
+ *
+ * \remarks This class is not thread-safe.
+ */
+class H_UPNP_AV_EXPORT HAvGroupOp :
+    public HAsyncOp
+{
+H_DECLARE_PRIVATE(HAvGroupOp);
+
+public:
+
+    /*!
+     * \brief This enumeration specifies the service of a Media Renderer
+     * connection the action of a group invocation belongs to.
+     */
+    enum Service
+    {
+        /*!
+         * The AVTransport service, such as \c Play or \c SetAVTransportURI.
+         */
+        AvTransport,
+
+        /*!
+         * The RenderingControl service, such as \c SetVolume.
+         */
+        RenderingControl
+    };
+
+    /*!
+     * \brief Creates a new instance.
+     */
+    HAvGroupOp();
+
+    /*!
+     * Creates a new invalid instance.
+     *
+     * \param returnCode specifies the return code.
+     *
+     * \param errorDescription specifies a human-readable description of
+     * the error that occurred.
+     */
+    HAvGroupOp(qint32 returnCode, const QString& errorDescription);
+
+    /*!
+     * \brief Copy constructor.
+     *
+     * Copies the contents of the \c other to this.
+     */
+    HAvGroupOp(const HAvGroupOp&);
+
+    /*!
+     * \brief Destroys the instance.
+     */
+    virtual ~HAvGroupOp();
+
+    /*!
+     * \brief Aborts the invocations of the members that have not completed.
+     *
+     * The HAvControlPoint::groupInvokeComplete() signal is sent immediately
+     * and the return value of the group invocation is set to
+     * \c UpnpInvocationAborted.
+     */
+    virtual void abort();
+
+    /*!
+     * \brief Assigns the contents of the other object to this.
+     *
+     * \return reference to this object.
+     */
+    HAvGroupOp& operator=(const HAvGroupOp&);
+
+    /*!
+     * \brief Returns the members of the group.
+     *
+     * \return The connections the action was invoked on, in the order they
+     * were specified to HAvControlPoint::beginGroupInvoke().
+     */
+    const HConnections& members() const;
+
+    /*!
+     * \brief Returns the invocations of the members.
+     *
+     * \return The invocation of each member, which contains the UPnP return
+     * code and the output arguments of the invocation.
+     *
+     * \remarks Do not abort the returned operations individually.
+     * Use abort() instead.
+     */
+    const QList<HClientActionOp>& operations() const;
+
+    /*!
+     * \brief Returns the time each member took to complete the invocation.
+     *
+     * \return The number of milliseconds from the start of the group
+     * invocation to the completion of the invocation of each member.
+     * The value is -1 for a member the invocation of which could not be
+     * started or was aborted.
+     */
+    const QList<qint32>& latencies() const;
+};
+
+}
+}
+}
+
+#endif /* HAV_GROUPOP_H_ */
@@ -0,0 +1,150 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+ */
+
+#ifndef HAV_GROUPOP_P_H_
+#define HAV_GROUPOP_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include "hav_groupop.h"
+
+#include <HUpnpCore/private/hasyncop_p.h>
+
+#include <QtCore/QHash>
+#include <QtCore/QObject>
+#include <QtCore/QPointer>
+#include <QtCore/QVariant>
+#include <QtCore/QElapsedTimer>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+class HClientAction;
+
+namespace Av
+{
+
+class HAvControlPointPrivate;
+class HAvGroupRunner;
+
+//
+// Implementation details of HAvGroupOp
+//
+class HAvGroupOpPrivate :
+    public HAsyncOpPrivate
+{
+public:
+
+    HConnections m_members;
+    QList<HClientActionOp> m_operations;
+    QList<qint32> m_latencies;
+    QPointer<HAvGroupRunner> m_runner;
+
+public:
+
+    HAvGroupOpPrivate();
+    virtual ~HAvGroupOpPrivate();
+};
+
+//
+//
+//
+class HAvGroupOp_ :
+    public HAvGroupOp
+{
+H_DECLARE_PRIVATE(HAvGroupOp);
+public:
+    HAvGroupOp_();
+    void setRunner(HAvGroupRunner* runner);
+    void setMembers(const HConnections& members);
+    void setOperations(const QList<HClientActionOp>& operations);
+    void setLatency(qint32 index, qint32 latency);
+};
+
+//
+// Invokes an action on every member of a group started with
+// HAvControlPoint::beginGroupInvoke() and reports the group once the
+// invocation of every member has completed
+//
+// The invocations are started one after the other without returning to the
+// event loop. Each member is a different device, which means that each
+// invocation is posted at once over the connection the control point keeps to
+// the device. The members that share an instance ID are sent the same SOAP
+// message, which is serialized only once.
+//
+class HAvGroupRunner :
+    public QObject
+{
+Q_OBJECT
+H_DISABLE_COPY(HAvGroupRunner)
+
+private:
+
+    HAvControlPointPrivate* m_owner;
+    HAvGroupOp_ m_op;
+
+    QHash<unsigned int, qint32> m_indexes;
+    // the index of the member of each invocation in progress, keyed by the
+    // ID of the invocation
+
+    QElapsedTimer m_timer;
+    // started when the group invocation is started
+
+    bool m_starting;
+    // true while the invocations are being started
+
+    bool m_done;
+    // true once every member has completed or the group has been aborted
+
+    bool invocationDone(HClientAction*, const HClientActionOp&);
+    void report(qint32 rc);
+
+private Q_SLOTS:
+
+    void completed();
+
+public:
+
+    HAvGroupRunner(HAvControlPointPrivate* owner);
+    virtual ~HAvGroupRunner();
+
+    HAvGroupOp run(
+        const HConnections& members, HAvGroupOp::Service service,
+        const QString& actionName, const QHash<QString, QVariant>& inArgs);
+
+    void abort();
+};
+
+}
+}
+}
+
+#endif /* HAV_GROUPOP_P_H_ */
@@ -168,7 +168,7 @@ HServerService* HAvDeviceModelCreator::createService(
         if (h_ptr->m_mediaServerConf && h_ptr->m_mediaServerConf->isValid())
         {
             return new HContentDirectoryService(
-                h_ptr->m_mediaServerConf->contentDirectoryConfiguration()->dataSource());
+                *h_ptr->m_mediaServerConf->contentDirectoryConfiguration());
         }
     }
     else if (serviceInfo.serviceType().compare(
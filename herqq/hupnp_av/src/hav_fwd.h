@@ -117,17 +117,31 @@ class HCdsPropertyDb;
 class HCdsDataSource;
 class HCdsProperties;
 class HCdsFileSystemReader;
+class HCdsFileSystemScanner;
+class HCdsFileSystemWatcher;
+class HCdsMetadataResult;
+class HCdsMetadataPipeline;
+class HCdsObjectStore;
+class HCdsObjectPool;
+class HLastChangeAggregator;
 class HFileSystemDataSource;
 class HAbstractCdsDataSource;
+class HCdsObjectView;
 class HCdsDidlLiteSerializer;
 class HCdsDataSourceConfiguration;
 class HFileSystemDataSourceConfiguration;
+class HCdsMetadataExtractor;
 ////////
 
 ///////// Media Server
 class HMediaServerAdapter;
 class HAbstractMediaServerDevice;
 class HMediaServerDeviceConfiguration;
+class HThumbnailGenerator;
+class HTranscoder;
+
+class HThumbnailCache;
+class HTranscodeCache;
 
 /*!
  * This is a type definition for a list of pointers to HMediaServerAdapter instances.
@@ -150,6 +164,8 @@ class HAbstractMediaRendererDevice;
 class HMediaRendererDeviceConfiguration;
 
 class HRendererConnectionManager;
+class HMediaFetcher;
+class HMediaSource;
 class HVolumeDbRangeResult;
 class HRendererConnectionEventInfo;
 
@@ -216,6 +232,7 @@ class HScheduledRecordingService;
 ////////
 
 // AV control point
+class HAvGroupOp;
 class HAvControlPoint;
 class HAvControlPointConfiguration;
 //////////
@@ -244,6 +261,7 @@ class HDeviceUdn;
 class HProgramCode;
 class HCdsClassInfo;
 class HProtocolInfo;
+class HProtocolInfoMatcher;
 class HPositionInfo;
 class HSearchResult;
 class HDateTimeRange;
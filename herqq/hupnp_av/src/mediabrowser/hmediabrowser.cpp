@@ -21,6 +21,7 @@
 
 #include "hmediabrowser.h"
 #include "hmediabrowser_p.h"
+#include "hmediabrowser_cache_p.h"
 #include "hcds_lastchange_info.h"
 
 #include "../cds_model/cds_objects/hitem.h"
@@ -32,10 +33,17 @@
 #include "../contentdirectory/hcontentdirectory_adapter.h"
 #include "../contentdirectory/hcontentdirectory_info.h"
 
+#include <HUpnpCore/HUdn>
+#include <HUpnpCore/HDeviceInfo>
+#include <HUpnpCore/HClientDevice>
+#include <HUpnpCore/HClientService>
+
 #include <HUpnpCore/private/hlogger_p.h>
 #include <HUpnpCore/private/hmisc_utils_p.h>
 
+#include <QtCore/QDir>
 #include <QtCore/QSet>
+#include <QtCore/QFile>
 #include <QtCore/QStringList>
 #include <QtCore/QXmlStreamReader>
 
@@ -159,6 +167,18 @@ HMediaBrowserPrivate::HMediaBrowserPrivate(
             m_dataSource(new HCdsDataSource()),
             m_currentUserOp(0),
             m_currentAutoOp(0),
+            m_autoOpQueue(),
+            m_maxConcurrentBrowses(4),
+            m_pageSize(200),
+            m_cacheDirectory(),
+            m_udn(),
+            m_containerUpdateIds(),
+            m_validContainers(),
+            m_serviceResetToken(),
+            m_systemUpdateIdValid(false),
+            m_systemUpdateId(0),
+            m_validation(0),
+            m_cachedRequestsScheduled(false),
             m_lastErrorCode(0),
             m_lastErrorDescription(),
             q_ptr(0)
@@ -168,6 +188,8 @@ HMediaBrowserPrivate::HMediaBrowserPrivate(
 
 HMediaBrowserPrivate::~HMediaBrowserPrivate()
 {
+    saveCache();
+
     delete m_dataSource;
     if (m_hasOwnershipOfCds)
     {
@@ -178,10 +200,16 @@ HMediaBrowserPrivate::~HMediaBrowserPrivate()
 
 void HMediaBrowserPrivate::checkNextAutoOp()
 {
-    if (!m_autoOpQueue.isEmpty())
+    while(!m_autoOpQueue.isEmpty())
     {
         m_currentAutoOp.reset(m_autoOpQueue.dequeue());
-        browse(m_currentAutoOp.data());
+
+        qint32 rc = UpnpSuccess;
+        if (browse(m_currentAutoOp.data(), &rc))
+        {
+            return;
+        }
+        m_currentAutoOp.reset(0);
     }
 }
 
@@ -189,23 +217,33 @@ void HMediaBrowserPrivate::browseCompleted(
     HContentDirectoryAdapter*, const HClientAdapterOp<HSearchResult>& op)
 {
     HBrowseOp* browseOp = 0;
-    if (m_currentAutoOp && m_currentAutoOp->m_currentOp->id() == op.id())
+    if (m_currentUserOp && m_currentUserOp->m_activeRequests.contains(op.id()))
+    {
+        browseOp = m_currentUserOp.data();
+    }
+    else if (m_currentAutoOp &&
+             m_currentAutoOp->m_activeRequests.contains(op.id()))
     {
         browseOp = m_currentAutoOp.data();
     }
-    else if (m_currentUserOp && m_currentUserOp->m_currentOp->id() != op.id())
+    else
     {
         return;
     }
-    else if (op.returnValue() != UpnpSuccess)
+
+    HBrowseRequest req = browseOp->m_activeRequests.take(op.id());
+    if (req.m_revalidate &&
+        op.returnValue() == HContentDirectoryInfo::InvalidObjectId)
     {
-        browseOp = m_currentUserOp.data();
-        browseFailed(browseOp, op.errorDescription(), op.returnValue());
+        // the cached container has been removed from the server
+        removeSubtree(req.m_objectId);
+        proceed(browseOp);
         return;
     }
-    else
+    else if (op.returnValue() != UpnpSuccess)
     {
-        browseOp = m_currentUserOp.data();
+        browseFailed(browseOp, op.errorDescription(), op.returnValue());
+        return;
     }
 
     HSearchResult result = op.value();
@@ -217,63 +255,173 @@ void HMediaBrowserPrivate::browseCompleted(
         browseFailed(browseOp, serializer.lastErrorDescription());
         return;
     }
-    else if (objects.size() > 0)
-    {
-        browseOp->m_loadedObjects.append(objects);
-        m_dataSource->add(objects);
 
-        QSet<QString> ids;
-        foreach(HObject* object, objects)
+    if (req.m_revalidate &&
+        result.updateId() != m_containerUpdateIds.value(req.m_objectId))
+    {
+        // The children of the container have changed. The cached children
+        // are dropped and browsed again, except for the cached containers,
+        // which are revalidated on their own.
+        QSet<QString> staleIds;
+        HContainer* container = m_dataSource->findContainer(req.m_objectId);
+        if (container)
         {
-            ids.insert(object->id());
+            foreach(HObject* child, m_dataSource->findChildren(container))
+            {
+                if (!m_containerUpdateIds.contains(child->id()))
+                {
+                    staleIds.insert(child->id());
+                }
+            }
         }
-        if (browseOp == m_currentUserOp.data())
+        m_dataSource->remove(staleIds);
+        m_containerUpdateIds.remove(req.m_objectId);
+
+        enqueueChildren(browseOp, req.m_objectId);
+    }
+
+    HBrowseParams::BrowseType loadType = browseOp->m_loadParams.browseType();
+    if (loadType == HBrowseParams::ObjectAndChildrenRecursively)
+    {
+        // the containers found are browsed breadth-first, in parallel with the
+        // remaining pages of the container currently being processed
+        foreach(HObject* object, objects)
         {
-            emit owner()->objectsBrowsed(owner(), ids);
+            if (object->isContainer())
+            {
+                enqueueChildren(browseOp, object->id());
+            }
         }
     }
 
-    HBrowseParams::BrowseType loadType = browseOp->m_loadParams.browseType();
-    switch(loadType)
+    if (req.m_browseFlag == HContentDirectoryInfo::BrowseDirectChildren &&
+        !req.m_startingIndex)
     {
-    case HBrowseParams::SingleItem:
-    case HBrowseParams::DirectChildren:
-        browseComplete(browseOp);
-        break;
+        // the UpdateID of a BrowseDirectChildren is the ContainerUpdateID of
+        // the container, if the server supports that
+        browseOp->m_containerUpdateIds.insert(
+            req.m_objectId, result.updateId());
+    }
 
-    case HBrowseParams::ObjectAndDirectChildren:
-        if (browseOp->m_indexUnderProcessing >= 0)
+    if (req.m_browseFlag == HContentDirectoryInfo::BrowseDirectChildren &&
+        req.m_requestedCount > 0)
+    {
+        quint32 returned = result.numberReturned();
+        quint32 total = result.totalMatches();
+        quint32 next = req.m_startingIndex + returned;
+
+        if (!returned)
         {
-            browseComplete(browseOp);
+            // nothing more to get, regardless of what the server claims
         }
-        else
+        else if (!total)
+        {
+            // The server does not know how many children the container has,
+            // in which case the container is walked a page at a time until
+            // a page comes back short.
+            if (returned >= req.m_requestedCount)
+            {
+                browseOp->m_queuedRequests.enqueue(HBrowseRequest(
+                    req.m_objectId, req.m_browseFlag,
+                    next, m_pageSize ? m_pageSize : req.m_requestedCount,
+                    true));
+            }
+        }
+        else if (req.m_firstPage)
         {
-            browseOp->m_indexUnderProcessing = 0;
-            browseOp->m_loadParams.setObjectId(objects.at(0)->id());
-            browse(browseOp);
+            quint32 pageSize = m_pageSize ? m_pageSize : total - next;
+            for(quint32 i = next; i < total; i += pageSize)
+            {
+                browseOp->m_queuedRequests.enqueue(HBrowseRequest(
+                    req.m_objectId, req.m_browseFlag,
+                    i, qMin(pageSize, total - i), false));
+            }
         }
-        break;
+        else if (returned < req.m_requestedCount && next < total)
+        {
+            // the server returned a partial page; the rest of it is requested
+            // separately
+            browseOp->m_queuedRequests.enqueue(HBrowseRequest(
+                req.m_objectId, req.m_browseFlag,
+                next, req.m_requestedCount - returned, false));
+        }
+    }
 
-    case HBrowseParams::ObjectAndChildrenRecursively:
+    if (objects.size() > 0)
     {
-        qint32 i = ++browseOp->m_indexUnderProcessing;
-        for(; i < browseOp->m_loadedObjects.size(); ++i)
+        browseOp->m_browsedObjects += objects.size();
+
+        QSet<QString> ids;
+        foreach(HObject* object, objects)
         {
-            HObject* object = browseOp->m_loadedObjects.at(i);
-            if (object->isContainer())
+            ids.insert(object->id());
+        }
+        store(objects);
+
+        if (browseOp == m_currentUserOp.data())
+        {
+            emit owner()->objectsBrowsed(owner(), ids);
+            if (browseOp != m_currentUserOp.data())
             {
-                browseOp->m_loadParams.setObjectId(object->id());
-                browseOp->m_indexUnderProcessing = i;
-                browse(browseOp);
+                // the operation was cancelled or restarted by a slot
                 return;
             }
         }
+    }
 
-        if (i == browseOp->m_loadedObjects.size())
-        {
-            browseComplete(browseOp);
-        }
+    proceed(browseOp);
+}
+
+void HMediaBrowserPrivate::getSystemUpdateIdCompleted(
+    HContentDirectoryAdapter*, const HClientAdapterOp<quint32>& op)
+{
+    if (!m_validation || m_validation->m_systemUpdateIdDone ||
+        m_validation->m_systemUpdateIdOp.id() != op.id())
+    {
+        return;
     }
+
+    m_validation->m_systemUpdateIdDone = true;
+    if (op.returnValue() == UpnpSuccess)
+    {
+        m_validation->m_systemUpdateIdValid = true;
+        m_validation->m_systemUpdateId = op.value();
+    }
+
+    validate();
+}
+
+void HMediaBrowserPrivate::getServiceResetTokenCompleted(
+    HContentDirectoryAdapter*, const HClientAdapterOp<QString>& op)
+{
+    if (!m_validation || m_validation->m_serviceResetTokenDone ||
+        m_validation->m_serviceResetTokenOp.id() != op.id())
+    {
+        return;
+    }
+
+    // GetServiceResetToken() is optional, which is why a failure only means
+    // that the token cannot be used to validate the cache
+    m_validation->m_serviceResetTokenDone = true;
+    if (op.returnValue() == UpnpSuccess)
+    {
+        m_validation->m_serviceResetToken = op.value();
+    }
+
+    validate();
+}
+
+void HMediaBrowserPrivate::processCachedRequests()
+{
+    m_cachedRequestsScheduled = false;
+
+    if (m_currentUserOp)
+    {
+        serveFromCache(m_currentUserOp.data());
+    }
+    if (m_currentAutoOp)
+    {
+        serveFromCache(m_currentAutoOp.data());
     }
 }
 
@@ -353,7 +501,11 @@ void HMediaBrowserPrivate::lastChangeReceived(
 
 void HMediaBrowserPrivate::autoBrowse(const HBrowseParams& params)
 {
-    HBrowseOp* newOp = new HBrowseOp(params);
+    autoBrowse(new HBrowseOp(params));
+}
+
+void HMediaBrowserPrivate::autoBrowse(HBrowseOp* newOp)
+{
     if (m_currentAutoOp || m_currentUserOp)
     {
         // Don't reset currently running auto update before its complete, and
@@ -364,7 +516,13 @@ void HMediaBrowserPrivate::autoBrowse(const HBrowseParams& params)
     else
     {
         m_currentAutoOp.reset(newOp);
-        browse(m_currentAutoOp.data());
+
+        qint32 rc = UpnpSuccess;
+        if (!browse(m_currentAutoOp.data(), &rc))
+        {
+            m_currentAutoOp.reset(0);
+            checkNextAutoOp();
+        }
     }
 }
 
@@ -372,10 +530,26 @@ void HMediaBrowserPrivate::update(const HCdsLastChangeInfos& data)
 {
     foreach(const HCdsLastChangeInfo& info, data)
     {
+        // Every change increments the SystemUpdateID by one, which is why the
+        // cached containers still correspond to the known SystemUpdateID only
+        // as long as no change is missed.
+        if (m_systemUpdateIdValid)
+        {
+            if (info.updateId() == m_systemUpdateId + 1)
+            {
+                m_systemUpdateId = info.updateId();
+            }
+            else if (info.updateId() > m_systemUpdateId)
+            {
+                m_systemUpdateIdValid = false;
+            }
+        }
+
         // TODO this properly
         switch(info.eventType())
         {
         case HCdsLastChangeInfo::ObjectDeleted:
+             removeSubtree(info.objectId());
              break;
         case HCdsLastChangeInfo::ObjectAdded:
         case HCdsLastChangeInfo::ObjectModified:
@@ -390,31 +564,209 @@ void HMediaBrowserPrivate::update(const HCdsLastChangeInfos& data)
     }
 }
 
-bool HMediaBrowserPrivate::browse(HBrowseOp* browseOp)
+bool HMediaBrowserPrivate::browse(HBrowseOp* browseOp, qint32* errorCode)
 {
     if (!m_contentDirectory)
     {
+        *errorCode = UpnpUndefinedFailure;
         return false;
     }
 
-    HClientAdapterOp<HSearchResult> op =
-        m_contentDirectory->browse(
-            browseOp->m_loadParams.objectId(),
-            browseOp->m_indexUnderProcessing < 0 ?
-                HContentDirectoryInfo::BrowseMetadata :
-                HContentDirectoryInfo::BrowseDirectChildren,
+    if (browseOp->m_revalidation)
+    {
+        QHash<QString, quint32>::const_iterator ci =
+            m_containerUpdateIds.constBegin();
+
+        for(; ci != m_containerUpdateIds.constEnd(); ++ci)
+        {
+            HBrowseRequest req(
+                ci.key(), HContentDirectoryInfo::BrowseMetadata, 0, 0, false);
+
+            req.m_revalidate = true;
+            browseOp->m_queuedRequests.enqueue(req);
+        }
+
+        return dispatch(browseOp, errorCode);
+    }
+
+    QString objectId = browseOp->m_loadParams.objectId();
+    switch(browseOp->m_loadParams.browseType())
+    {
+    case HBrowseParams::SingleItem:
+    case HBrowseParams::ObjectAndChildrenRecursively:
+        // in case of a recursive browse the containers are found out from
+        // the responses, starting from the metadata of the root object
+        browseOp->m_queuedRequests.enqueue(HBrowseRequest(
+            objectId, HContentDirectoryInfo::BrowseMetadata, 0, 0, false));
+        break;
+
+    case HBrowseParams::DirectChildren:
+        enqueueChildren(browseOp, objectId);
+        break;
+
+    case HBrowseParams::ObjectAndDirectChildren:
+        browseOp->m_queuedRequests.enqueue(HBrowseRequest(
+            objectId, HContentDirectoryInfo::BrowseMetadata, 0, 0, false));
+        enqueueChildren(browseOp, objectId);
+        break;
+    }
+
+    return dispatch(browseOp, errorCode);
+}
+
+bool HMediaBrowserPrivate::dispatch(HBrowseOp* browseOp, qint32* errorCode)
+{
+    Q_ASSERT(m_contentDirectory);
+
+    while(!browseOp->m_queuedRequests.isEmpty() &&
+          browseOp->m_activeRequests.size() < m_maxConcurrentBrowses)
+    {
+        HBrowseRequest req = browseOp->m_queuedRequests.dequeue();
+
+        req.m_op = m_contentDirectory->browse(
+            req.m_objectId,
+            req.m_browseFlag,
             browseOp->m_loadParams.filter(),
-            0,
-            0,
+            req.m_startingIndex,
+            req.m_requestedCount,
             QStringList());
 
-    browseOp->m_currentOp.reset(new HClientAdapterOp<HSearchResult>(op));
+        if (req.m_op.isNull())
+        {
+            *errorCode = req.m_op.returnValue();
+            abort(browseOp);
+            return false;
+        }
+
+        browseOp->m_activeRequests.insert(req.m_op.id(), req);
+    }
 
     return true;
 }
 
+void HMediaBrowserPrivate::enqueueChildren(
+    HBrowseOp* browseOp, const QString& containerId)
+{
+    if (browseOp->m_browsedContainers.contains(containerId))
+    {
+        // a server may link the same container to several places
+        return;
+    }
+    browseOp->m_browsedContainers.insert(containerId);
+
+    HBrowseRequest req(
+        containerId, HContentDirectoryInfo::BrowseDirectChildren,
+        0, m_pageSize, true);
+
+    if (m_validContainers.contains(containerId))
+    {
+        // The cached children are up to date. They are reported
+        // asynchronously, the same way the browsed children are.
+        browseOp->m_cachedRequests.enqueue(req);
+        if (!m_cachedRequestsScheduled)
+        {
+            m_cachedRequestsScheduled = true;
+            bool ok = QMetaObject::invokeMethod(
+                this, "processCachedRequests", Qt::QueuedConnection);
+            Q_ASSERT(ok); Q_UNUSED(ok)
+        }
+        return;
+    }
+
+    browseOp->m_queuedRequests.enqueue(req);
+}
+
+void HMediaBrowserPrivate::proceed(HBrowseOp* browseOp)
+{
+    qint32 rc = UpnpSuccess;
+    if (!dispatch(browseOp, &rc))
+    {
+        browseFailed(browseOp, "Failed to dispatch a browse request", rc);
+        return;
+    }
+
+    if (browseOp == m_currentUserOp.data())
+    {
+        emit owner()->browseProgress(
+            owner(), browseOp->m_browsedObjects, browseOp->pendingRequests());
+        if (browseOp != m_currentUserOp.data())
+        {
+            return;
+        }
+    }
+
+    if (!browseOp->pendingRequests())
+    {
+        browseComplete(browseOp);
+    }
+}
+
+void HMediaBrowserPrivate::serveFromCache(HBrowseOp* browseOp)
+{
+    if (browseOp->m_cachedRequests.isEmpty())
+    {
+        return;
+    }
+
+    bool recursive = browseOp->m_loadParams.browseType() ==
+        HBrowseParams::ObjectAndChildrenRecursively;
+
+    while(!browseOp->m_cachedRequests.isEmpty())
+    {
+        HBrowseRequest req = browseOp->m_cachedRequests.dequeue();
+
+        HContainer* container = m_dataSource->findContainer(req.m_objectId);
+        if (!container)
+        {
+            continue;
+        }
+
+        QSet<QString> ids;
+        foreach(HObject* child, m_dataSource->findChildren(container))
+        {
+            ids.insert(child->id());
+            if (recursive && child->isContainer())
+            {
+                enqueueChildren(browseOp, child->id());
+            }
+        }
+
+        if (!ids.isEmpty())
+        {
+            browseOp->m_browsedObjects += ids.size();
+            if (browseOp == m_currentUserOp.data())
+            {
+                emit owner()->objectsBrowsed(owner(), ids);
+                if (browseOp != m_currentUserOp.data())
+                {
+                    return;
+                }
+            }
+        }
+    }
+
+    proceed(browseOp);
+}
+
+void HMediaBrowserPrivate::abort(HBrowseOp* browseOp)
+{
+    browseOp->m_queuedRequests.clear();
+
+    // the requests are removed before they are aborted, since an aborted
+    // operation may be reported through browseCompleted() synchronously
+    QHash<unsigned int, HBrowseRequest> active = browseOp->m_activeRequests;
+    browseOp->m_activeRequests.clear();
+
+    foreach(HBrowseRequest req, active)
+    {
+        req.m_op.abort();
+    }
+}
+
 void HMediaBrowserPrivate::reset()
 {
+    saveCache();
+
     m_dataSource->clear();
     if (m_hasOwnershipOfCds)
     {
@@ -428,13 +780,305 @@ void HMediaBrowserPrivate::reset()
     m_currentUserOp.reset(0);
     m_currentAutoOp.reset(0);
     qDeleteAll(m_autoOpQueue);
+    m_autoOpQueue.clear();
+
+    m_udn.clear();
+    m_containerUpdateIds.clear();
+    m_validContainers.clear();
+    m_serviceResetToken.clear();
+    m_systemUpdateIdValid = false;
+    m_systemUpdateId = 0;
+    m_validation.reset(0);
+}
+
+void HMediaBrowserPrivate::connectContentDirectory()
+{
+    bool ok = connect(
+        m_contentDirectory,
+        SIGNAL(browseCompleted(Herqq::Upnp::Av::HContentDirectoryAdapter*,
+                               Herqq::Upnp::HClientAdapterOp<Herqq::Upnp::Av::HSearchResult>)),
+        this,
+        SLOT(browseCompleted(Herqq::Upnp::Av::HContentDirectoryAdapter*,
+                             Herqq::Upnp::HClientAdapterOp<Herqq::Upnp::Av::HSearchResult>)));
+    Q_ASSERT(ok); Q_UNUSED(ok)
+
+    ok = connect(
+        m_contentDirectory,
+        SIGNAL(lastChangeReceived(Herqq::Upnp::Av::HContentDirectoryAdapter*, QString)),
+        this,
+        SLOT(lastChangeReceived(Herqq::Upnp::Av::HContentDirectoryAdapter*, QString)));
+    Q_ASSERT(ok);
+
+    ok = connect(
+        m_contentDirectory,
+        SIGNAL(getSystemUpdateIdCompleted(Herqq::Upnp::Av::HContentDirectoryAdapter*,
+                                          Herqq::Upnp::HClientAdapterOp<quint32>)),
+        this,
+        SLOT(getSystemUpdateIdCompleted(Herqq::Upnp::Av::HContentDirectoryAdapter*,
+                                        Herqq::Upnp::HClientAdapterOp<quint32>)));
+    Q_ASSERT(ok);
+
+    ok = connect(
+        m_contentDirectory,
+        SIGNAL(getServiceResetTokenCompleted(Herqq::Upnp::Av::HContentDirectoryAdapter*,
+                                             Herqq::Upnp::HClientAdapterOp<QString>)),
+        this,
+        SLOT(getServiceResetTokenCompleted(Herqq::Upnp::Av::HContentDirectoryAdapter*,
+                                           Herqq::Upnp::HClientAdapterOp<QString>)));
+    Q_ASSERT(ok);
+}
+
+void HMediaBrowserPrivate::store(const HObjects& objects)
+{
+    // The data source links the children of a container to the container
+    // object, which is why the links are carried over to the object that
+    // replaces it.
+    foreach(HObject* object, objects)
+    {
+        if (object->isContainer())
+        {
+            HContainer* existing = m_dataSource->findContainer(object->id());
+            if (existing && existing != object)
+            {
+                object->asContainer()->setChildIds(existing->orderedChildIds());
+            }
+        }
+    }
+
+    m_dataSource->add(objects, HCdsDataSource::AddAndOverwrite);
+}
+
+void HMediaBrowserPrivate::removeSubtree(const QString& id)
+{
+    QSet<QString> ids;
+    QStringList pending(id);
+    while(!pending.isEmpty())
+    {
+        QString objectId = pending.takeLast();
+        if (ids.contains(objectId))
+        {
+            continue;
+        }
+        ids.insert(objectId);
+
+        m_containerUpdateIds.remove(objectId);
+        m_validContainers.remove(objectId);
+
+        HContainer* container = m_dataSource->findContainer(objectId);
+        if (container)
+        {
+            pending.append(container->orderedChildIds());
+        }
+    }
+
+    m_dataSource->remove(ids);
+}
+
+QString HMediaBrowserPrivate::cacheFilePath() const
+{
+    return QDir(m_cacheDirectory).absoluteFilePath(
+        QString("%1.hcdc").arg(m_udn));
+}
+
+void HMediaBrowserPrivate::openCache()
+{
+    HLOG(H_AT, H_FUN);
+
+    HClientService* service = m_contentDirectory->service();
+    if (m_cacheDirectory.isEmpty() || !service)
+    {
+        return;
+    }
+
+    m_udn = service->parentDevice()->info().udn().toSimpleUuid();
+
+    QString filePath = cacheFilePath();
+    if (QFile::exists(filePath))
+    {
+        HMediaBrowserCache cache(filePath);
+        HMediaBrowserCacheData data;
+
+        HObjects objects;
+        HCdsDidlLiteSerializer serializer;
+        if (!cache.read(m_udn, &data))
+        {
+            HLOG_WARN(QString("Ignoring cache [%1]: %2").arg(
+                filePath, cache.lastErrorDescription()));
+        }
+        else if (!serializer.serializeFromXml(
+            QString::fromUtf8(data.m_didlLite), &objects))
+        {
+            HLOG_WARN(QString("Ignoring cache [%1]: %2").arg(
+                filePath, serializer.lastErrorDescription()));
+        }
+        else
+        {
+            qDeleteAll(m_dataSource->add(objects));
+
+            m_containerUpdateIds = data.m_containerUpdateIds;
+            m_serviceResetToken = data.m_serviceResetToken;
+            m_systemUpdateIdValid = data.m_systemUpdateIdValid;
+            m_systemUpdateId = data.m_systemUpdateId;
+        }
+    }
+
+    startValidation();
+}
+
+bool HMediaBrowserPrivate::saveCache()
+{
+    HLOG(H_AT, H_FUN);
+
+    if (m_cacheDirectory.isEmpty() || m_udn.isEmpty())
+    {
+        return true;
+    }
+
+    HMediaBrowserCacheData data;
+    data.m_udn = m_udn;
+    data.m_serviceResetToken = m_serviceResetToken;
+
+    // The SystemUpdateID is stored only if every change up to it has been
+    // applied. Otherwise the cached containers are revalidated one by one.
+    data.m_systemUpdateIdValid =
+        m_systemUpdateIdValid && !m_validation &&
+        !m_currentAutoOp && m_autoOpQueue.isEmpty();
+
+    data.m_systemUpdateId = m_systemUpdateId;
+
+    HObjects objects;
+    QSet<QString> storedIds;
+    QHash<QString, quint32>::const_iterator ci =
+        m_containerUpdateIds.constBegin();
+
+    for(; ci != m_containerUpdateIds.constEnd(); ++ci)
+    {
+        HContainer* container = m_dataSource->findContainer(ci.key());
+        if (!container)
+        {
+            continue;
+        }
+
+        data.m_containerUpdateIds.insert(ci.key(), ci.value());
+
+        HObjects containerObjects = m_dataSource->findChildren(container);
+        containerObjects.prepend(container);
+        foreach(HObject* object, containerObjects)
+        {
+            if (!storedIds.contains(object->id()))
+            {
+                storedIds.insert(object->id());
+                objects.append(object);
+            }
+        }
+    }
+
+    HCdsDidlLiteSerializer serializer;
+    data.m_didlLite = serializer.serializeToXml(objects).toUtf8();
+
+    HMediaBrowserCache cache(cacheFilePath());
+    if (!cache.write(data))
+    {
+        HLOG_WARN(cache.lastErrorDescription());
+        return false;
+    }
+
+    return true;
+}
+
+void HMediaBrowserPrivate::startValidation()
+{
+    m_validation.reset(new HCacheValidation());
+
+    m_validation->m_systemUpdateIdOp = m_contentDirectory->getSystemUpdateId();
+    m_validation->m_systemUpdateIdDone =
+        m_validation->m_systemUpdateIdOp.isNull();
+
+    m_validation->m_serviceResetTokenOp =
+        m_contentDirectory->getServiceResetToken();
+    m_validation->m_serviceResetTokenDone =
+        m_validation->m_serviceResetTokenOp.isNull();
+
+    validate();
+}
+
+void HMediaBrowserPrivate::validate()
+{
+    Q_ASSERT(m_validation);
+    if (!m_validation->m_systemUpdateIdDone ||
+        !m_validation->m_serviceResetTokenDone)
+    {
+        return;
+    }
+
+    QString resetToken = m_validation->m_serviceResetToken;
+    if (!resetToken.isEmpty())
+    {
+        if (!m_serviceResetToken.isEmpty() && m_serviceResetToken != resetToken)
+        {
+            // the server has reset its object IDs, which invalidates
+            // everything that is cached
+            HLOG_INFO("ServiceResetToken changed, dropping the cache");
+
+            m_dataSource->clear();
+            m_containerUpdateIds.clear();
+            m_validContainers.clear();
+        }
+        m_serviceResetToken = resetToken;
+    }
+
+    if (m_containerUpdateIds.isEmpty() ||
+        (m_validation->m_systemUpdateIdValid && m_systemUpdateIdValid &&
+         m_validation->m_systemUpdateId == m_systemUpdateId))
+    {
+        m_validContainers = m_containerUpdateIds.keys().toSet();
+        m_systemUpdateIdValid = m_validation->m_systemUpdateIdValid;
+        m_systemUpdateId = m_validation->m_systemUpdateId;
+        m_validation.reset(0);
+        return;
+    }
+
+    // Something has changed since the cache was written. The ContainerUpdateIDs
+    // tell which containers have to be browsed again.
+    m_systemUpdateIdValid = false;
+
+    HBrowseParams params(HBrowseParams::DirectChildren);
+    params.setFilter(QSet<QString>() << "*");
+
+    HBrowseOp* op = new HBrowseOp(params);
+    op->m_revalidation = true;
+    autoBrowse(op);
 }
 
 void HMediaBrowserPrivate::browseComplete(HBrowseOp* op)
 {
+    QHash<QString, quint32>::const_iterator ci =
+        op->m_containerUpdateIds.constBegin();
+
+    for(; ci != op->m_containerUpdateIds.constEnd(); ++ci)
+    {
+        m_containerUpdateIds.insert(ci.key(), ci.value());
+        m_validContainers.insert(ci.key());
+    }
+
+    if (op->m_revalidation)
+    {
+        Q_ASSERT(m_validation);
+        m_validContainers = m_containerUpdateIds.keys().toSet();
+        m_systemUpdateIdValid = m_validation->m_systemUpdateIdValid;
+        m_systemUpdateId = m_validation->m_systemUpdateId;
+        m_validation.reset(0);
+        saveCache();
+    }
+
     if (op == m_currentUserOp.data())
     {
         m_currentUserOp.reset(0);
+        if (!m_currentAutoOp)
+        {
+            // the updates queued while the user operation was running
+            checkNextAutoOp();
+        }
         emit owner()->browseComplete(owner());
     }
     else
@@ -447,12 +1091,29 @@ void HMediaBrowserPrivate::browseComplete(HBrowseOp* op)
 void HMediaBrowserPrivate::browseFailed(
     HBrowseOp* op, const QString& errorDescription, qint32 errorCode)
 {
+    abort(op);
+
+    if (op != m_currentUserOp.data())
+    {
+        // a change reported by the server could not be applied or the cache
+        // could not be revalidated
+        m_systemUpdateIdValid = false;
+        if (op->m_revalidation)
+        {
+            m_validation.reset(0);
+        }
+    }
+
     if (op == m_currentUserOp.data())
     {
         m_lastErrorDescription = errorDescription;
         m_lastErrorCode = errorCode;
 
         m_currentUserOp.reset(0);
+        if (!m_currentAutoOp)
+        {
+            checkNextAutoOp();
+        }
         emit owner()->browseFailed(owner());
     }
     else
@@ -493,21 +1154,8 @@ bool HMediaBrowser::reset(HClientService* cds)
         return false;
     }
 
-    bool ok = connect(
-        h_ptr->m_contentDirectory,
-        SIGNAL(browseCompleted(Herqq::Upnp::Av::HContentDirectoryAdapter*,
-                               Herqq::Upnp::HClientAdapterOp<Herqq::Upnp::Av::HSearchResult>)),
-        h_ptr,
-        SLOT(browseCompleted(Herqq::Upnp::Av::HContentDirectoryAdapter*,
-                             Herqq::Upnp::HClientAdapterOp<Herqq::Upnp::Av::HSearchResult>)));
-    Q_ASSERT(ok); Q_UNUSED(ok)
-
-    ok = connect(
-        h_ptr->m_contentDirectory,
-        SIGNAL(lastChangeReceived(Herqq::Upnp::Av::HContentDirectoryAdapter*, QString)),
-        h_ptr,
-        SLOT(lastChangeReceived(Herqq::Upnp::Av::HContentDirectoryAdapter*, QString)));
-    Q_ASSERT(ok);
+    h_ptr->connectContentDirectory();
+    h_ptr->openCache();
 
     return true;
 }
@@ -520,21 +1168,8 @@ bool HMediaBrowser::reset(HContentDirectoryAdapter* cds, bool takeOwnership)
     h_ptr->m_contentDirectory = cds;
     h_ptr->m_hasOwnershipOfCds = takeOwnership;
 
-    bool ok = connect(
-        h_ptr->m_contentDirectory,
-        SIGNAL(browseCompleted(Herqq::Upnp::Av::HContentDirectoryAdapter*,
-                               Herqq::Upnp::HClientAdapterOp<Herqq::Upnp::Av::HSearchResult>)),
-        h_ptr,
-        SLOT(browseCompleted(Herqq::Upnp::Av::HContentDirectoryAdapter*,
-                             Herqq::Upnp::HClientAdapterOp<Herqq::Upnp::Av::HSearchResult>)));
-    Q_ASSERT(ok); Q_UNUSED(ok)
-
-    ok = connect(
-        h_ptr->m_contentDirectory,
-        SIGNAL(lastChangeReceived(Herqq::Upnp::Av::HContentDirectoryAdapter*, QString)),
-        h_ptr,
-        SLOT(lastChangeReceived(Herqq::Upnp::Av::HContentDirectoryAdapter*, QString)));
-    Q_ASSERT(ok);
+    h_ptr->connectContentDirectory();
+    h_ptr->openCache();
 
     return true;
 }
@@ -560,7 +1195,16 @@ bool HMediaBrowser::browse(const HBrowseParams& loadParams)
         params.setFilter(QSet<QString>(params.filter()) << "res");
     }
     h_ptr->m_currentUserOp.reset(new HBrowseOp(params));
-    return h_ptr->browse(h_ptr->m_currentUserOp.data());
+
+    qint32 rc = UpnpSuccess;
+    if (!h_ptr->browse(h_ptr->m_currentUserOp.data(), &rc))
+    {
+        h_ptr->m_currentUserOp.reset(0);
+        h_ptr->setLastError(rc, "Failed to dispatch a browse request");
+        return false;
+    }
+
+    return true;
 }
 
 bool HMediaBrowser::browseAll()
@@ -609,7 +1253,7 @@ void HMediaBrowser::cancel()
 {
     if (h_ptr->m_currentUserOp.data())
     {
-        h_ptr->m_currentUserOp->m_currentOp->abort();
+        h_ptr->abort(h_ptr->m_currentUserOp.data());
         h_ptr->m_currentUserOp.reset(0);
     }
 }
@@ -624,6 +1268,47 @@ void HMediaBrowser::setAutoUpdate(bool enable)
     h_ptr->m_autoUpdateEnabled = enable;
 }
 
+QString HMediaBrowser::cacheDirectory() const
+{
+    return h_ptr->m_cacheDirectory;
+}
+
+void HMediaBrowser::setCacheDirectory(const QString& path)
+{
+    h_ptr->m_cacheDirectory = path;
+}
+
+bool HMediaBrowser::saveCache()
+{
+    return h_ptr->saveCache();
+}
+
+qint32 HMediaBrowser::maxConcurrentBrowses() const
+{
+    return h_ptr->m_maxConcurrentBrowses;
+}
+
+bool HMediaBrowser::setMaxConcurrentBrowses(qint32 count)
+{
+    if (count < 1)
+    {
+        return false;
+    }
+
+    h_ptr->m_maxConcurrentBrowses = count;
+    return true;
+}
+
+quint32 HMediaBrowser::pageSize() const
+{
+    return h_ptr->m_pageSize;
+}
+
+void HMediaBrowser::setPageSize(quint32 count)
+{
+    h_ptr->m_pageSize = count;
+}
+
 }
 }
 }
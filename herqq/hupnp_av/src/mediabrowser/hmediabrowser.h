@@ -399,6 +399,117 @@ public:
      */
     void setAutoUpdate(bool enable);
 
+    /*!
+     * \brief Returns the directory where the browsed objects are cached.
+     *
+     * \return The directory where the browsed objects are cached. The
+     * returned string is empty when caching is disabled, which is the default.
+     *
+     * \sa setCacheDirectory()
+     */
+    QString cacheDirectory() const;
+
+    /*!
+     * \brief Specifies the directory where the browsed objects are cached.
+     *
+     * When a cache directory is set, the containers browsed from a
+     * ContentDirectory are stored to a file named after the UDN of the
+     * device when the object is reset or destroyed. The next time the same
+     * device is set using reset(), the data source is filled from the cache
+     * and the cache is validated in the background:
+     *
+     * \li If the \c ServiceResetToken of the server has changed, the cache
+     * is dropped.
+     * \li If the \c SystemUpdateID of the server has not changed, the whole
+     * cache is used as is.
+     * \li Otherwise the \c UpdateID of each cached container is checked and
+     * only the containers that have changed are browsed again.
+     *
+     * Once validated, the cached containers are served from the cache by
+     * browse(). While auto update is enabled, the cache is patched with the
+     * changes the server reports through LastChange events.
+     *
+     * \param path specifies the directory where the browsed objects are
+     * cached. An empty string disables caching. The value takes effect the
+     * next time reset() is called.
+     *
+     * \sa cacheDirectory(), saveCache(), setAutoUpdate()
+     */
+    void setCacheDirectory(const QString& path);
+
+    /*!
+     * \brief Writes the cache of the current ContentDirectory to disk.
+     *
+     * Only the containers the children of which have been completely browsed
+     * are stored. This is done automatically when the object is reset or
+     * destroyed.
+     *
+     * \return \e true in case the cache was written or caching is disabled.
+     *
+     * \sa setCacheDirectory()
+     */
+    bool saveCache();
+
+    /*!
+     * \brief Returns the maximum number of Browse() invocations a browse
+     * operation keeps in flight at the same time.
+     *
+     * \return The maximum number of Browse() invocations a browse
+     * operation keeps in flight at the same time. The default is 4.
+     *
+     * \sa setMaxConcurrentBrowses()
+     */
+    qint32 maxConcurrentBrowses() const;
+
+    /*!
+     * \brief Specifies the maximum number of Browse() invocations a browse
+     * operation keeps in flight at the same time.
+     *
+     * When a browse operation involves several containers or several pages of
+     * a container, the invocations are dispatched without waiting for the
+     * previous ones to complete.
+     *
+     * \param count specifies the maximum number of Browse() invocations in
+     * flight. The value has to be at least 1.
+     *
+     * \return \e true in case the value was set.
+     *
+     * \remarks The number of invocations the server is actually sent at the
+     * same time is also bound by the HUPnP control point the
+     * ContentDirectory belongs to.
+     *
+     * \sa maxConcurrentBrowses()
+     */
+    bool setMaxConcurrentBrowses(qint32 count);
+
+    /*!
+     * \brief Returns the number of objects requested from the
+     * ContentDirectory in a single Browse() invocation.
+     *
+     * \return The number of objects requested from the ContentDirectory in
+     * a single Browse() invocation. Zero means that the children of a
+     * container are requested in a single invocation. The default is 200.
+     *
+     * \sa setPageSize()
+     */
+    quint32 pageSize() const;
+
+    /*!
+     * \brief Specifies the number of objects requested from the
+     * ContentDirectory in a single Browse() invocation.
+     *
+     * Once the first page of a container tells how many children the
+     * container has, the rest of the pages are requested at once, up to
+     * maxConcurrentBrowses() at a time.
+     *
+     * \param count specifies the \c RequestedCount of a single Browse()
+     * invocation. Zero means that the children of a container are requested
+     * in a single invocation.
+     *
+     * \sa pageSize()
+     */
+    void setPageSize(quint32 count);
+
 Q_SIGNALS:
 
     /*!
@@ -440,6 +551,25 @@ Q_SIGNALS:
      */
     void objectsBrowsed(Herqq::Upnp::Av::HMediaBrowser* source, const QSet<QString>& ids);
 
+    /*!
+     * \brief This signal is emitted whenever a Browse() invocation of a
+     * browse operation has been processed.
+     *
+     * \param source specifies the source of the event.
+     *
+     * \param browsedObjects specifies the number of objects browsed so far
+     * by the current operation.
+     *
+     * \param pendingBrowses specifies the number of Browse() invocations
+     * known to be still needed or in flight. The number grows as new
+     * containers and pages are discovered.
+     *
+     * \sa objectsBrowsed(), browseComplete()
+     */
+    void browseProgress(
+        Herqq::Upnp::Av::HMediaBrowser* source,
+        qint32 browsedObjects, qint32 pendingBrowses);
+
     /*!
      * This signal is emitted when the instance has received LastChange data
      * from the ContentDirectoryService.
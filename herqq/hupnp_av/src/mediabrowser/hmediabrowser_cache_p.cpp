@@ -0,0 +1,149 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hmediabrowser_cache_p.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QDataStream>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+namespace
+{
+const quint32 CacheMagic = 0x48434443; // "HCDC"
+}
+
+/*******************************************************************************
+ * HMediaBrowserCache
+ ******************************************************************************/
+HMediaBrowserCache::HMediaBrowserCache(const QString& filePath) :
+    m_filePath(filePath), m_lastErrorDescription()
+{
+}
+
+HMediaBrowserCache::~HMediaBrowserCache()
+{
+}
+
+bool HMediaBrowserCache::read(const QString& udn, HMediaBrowserCacheData* data)
+{
+    Q_ASSERT(data);
+
+    QFile file(m_filePath);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        m_lastErrorDescription =
+            QString("Could not open file [%1] for reading").arg(m_filePath);
+        return false;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_4_6);
+
+    quint32 magic = 0, version = 0;
+    in >> magic >> version;
+    if (magic != CacheMagic)
+    {
+        m_lastErrorDescription = "The file is not a HUPnP media browser cache";
+        return false;
+    }
+    else if (version != Version)
+    {
+        m_lastErrorDescription =
+            QString("Unsupported cache version [%1]").arg(version);
+        return false;
+    }
+
+    HMediaBrowserCacheData tmp;
+    in >> tmp.m_udn;
+    if (tmp.m_udn != udn)
+    {
+        m_lastErrorDescription =
+            QString("The cache belongs to another device [%1]").arg(tmp.m_udn);
+        return false;
+    }
+
+    in >> tmp.m_serviceResetToken >> tmp.m_systemUpdateIdValid
+       >> tmp.m_systemUpdateId >> tmp.m_containerUpdateIds >> tmp.m_didlLite;
+
+    if (in.status() != QDataStream::Ok)
+    {
+        m_lastErrorDescription = "The cache is corrupted";
+        return false;
+    }
+
+    *data = tmp;
+    return true;
+}
+
+bool HMediaBrowserCache::write(const HMediaBrowserCacheData& data)
+{
+    QString tmpPath = m_filePath;
+    tmpPath.append(".tmp");
+
+    QFile file(tmpPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        m_lastErrorDescription =
+            QString("Could not open file [%1] for writing").arg(tmpPath);
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_4_6);
+    out << CacheMagic << static_cast<quint32>(Version)
+        << data.m_udn << data.m_serviceResetToken << data.m_systemUpdateIdValid
+        << data.m_systemUpdateId << data.m_containerUpdateIds
+        << data.m_didlLite;
+
+    file.close();
+    if (out.status() != QDataStream::Ok || file.error() != QFile::NoError)
+    {
+        m_lastErrorDescription =
+            QString("Could not write the cache to [%1]").arg(tmpPath);
+
+        QFile::remove(tmpPath);
+        return false;
+    }
+
+    QFile::remove(m_filePath);
+    if (!QFile::rename(tmpPath, m_filePath))
+    {
+        m_lastErrorDescription =
+            QString("Could not replace the cache [%1]").arg(m_filePath);
+
+        QFile::remove(tmpPath);
+        return false;
+    }
+
+    return true;
+}
+
+}
+}
+}
@@ -0,0 +1,122 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HMEDIABROWSER_CACHE_P_H_
+#define HMEDIABROWSER_CACHE_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include <HUpnpAv/HUpnpAv>
+
+#include <QtCore/QHash>
+#include <QtCore/QString>
+#include <QtCore/QByteArray>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+//
+// The persisted state of the objects HMediaBrowser has browsed from a single
+// ContentDirectory
+//
+class HMediaBrowserCacheData
+{
+public:
+
+    QString m_udn;
+    // the UDN of the device the ContentDirectory belongs to
+
+    QString m_serviceResetToken;
+    // the ServiceResetToken of the ContentDirectory, if it has one
+
+    bool m_systemUpdateIdValid;
+    quint32 m_systemUpdateId;
+    // the SystemUpdateID the cached objects correspond to, if known
+
+    QHash<QString, quint32> m_containerUpdateIds;
+    // key == id of a container the children of which are cached,
+    // value == the UpdateID returned when the children were browsed
+
+    QByteArray m_didlLite;
+    // the cached objects as a UTF-8 encoded DIDL-Lite document
+
+    HMediaBrowserCacheData() :
+        m_udn(), m_serviceResetToken(),
+        m_systemUpdateIdValid(false), m_systemUpdateId(0),
+        m_containerUpdateIds(), m_didlLite()
+    {
+    }
+};
+
+//
+// Reads and writes the versioned cache file of HMediaBrowser.
+//
+// A file that is written by an incompatible version or for another device is
+// ignored, which results in the ContentDirectory being browsed from scratch.
+//
+class HMediaBrowserCache
+{
+H_DISABLE_COPY(HMediaBrowserCache)
+
+private:
+
+    QString m_filePath;
+    QString m_lastErrorDescription;
+
+public:
+
+    enum
+    {
+        Version = 1
+    };
+
+    explicit HMediaBrowserCache(const QString& filePath);
+    ~HMediaBrowserCache();
+
+    bool read(const QString& udn, HMediaBrowserCacheData*);
+
+    // The cache is written to a temporary file first, so that an interrupted
+    // write never leaves a truncated cache behind.
+    bool write(const HMediaBrowserCacheData&);
+
+    inline QString lastErrorDescription() const
+    {
+        return m_lastErrorDescription;
+    }
+};
+
+}
+}
+}
+
+#endif /* HMEDIABROWSER_CACHE_P_H_ */
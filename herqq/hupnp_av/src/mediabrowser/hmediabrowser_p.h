@@ -32,9 +32,13 @@
 
 #include "hmediabrowser.h"
 
+#include "../contentdirectory/hcontentdirectory_info.h"
+
 #include <HUpnpAv/HSearchResult>
 #include <HUpnpCore/HClientAdapterOp>
 
+#include <QtCore/QSet>
+#include <QtCore/QHash>
 #include <QtCore/QQueue>
 #include <QtCore/QScopedPointer>
 
@@ -48,40 +52,127 @@ namespace Av
 {
 
 //
+// A single Browse() invocation run as part of a HBrowseOp
+//
+class HBrowseRequest
+{
+public:
+
+    QString m_objectId;
+    HContentDirectoryInfo::BrowseFlag m_browseFlag;
+    quint32 m_startingIndex;
+    quint32 m_requestedCount;
+
+    bool m_firstPage;
+    // when set, the response to this request is used to find out how many
+    // children the container has and the rest of the pages are requested
+    // at once
+
+    bool m_revalidate;
+    // when set, the request browses the metadata of a cached container in
+    // order to find out if the cached children are still up to date
+
+    HClientAdapterOp<HSearchResult> m_op;
+
+    HBrowseRequest() :
+        m_objectId(),
+        m_browseFlag(HContentDirectoryInfo::BrowseMetadata),
+        m_startingIndex(0), m_requestedCount(0),
+        m_firstPage(false),
+        m_revalidate(false),
+        m_op()
+    {
+    }
+
+    HBrowseRequest(
+        const QString& objectId, HContentDirectoryInfo::BrowseFlag flag,
+        quint32 startingIndex, quint32 requestedCount, bool firstPage) :
+            m_objectId(objectId),
+            m_browseFlag(flag),
+            m_startingIndex(startingIndex), m_requestedCount(requestedCount),
+            m_firstPage(firstPage),
+            m_revalidate(false),
+            m_op()
+    {
+    }
+};
+
 //
+// A browse operation started with HMediaBrowser::browse() or an automatic
+// update. The operation is run as a set of Browse() invocations, up to
+// HMediaBrowserPrivate::m_maxConcurrentBrowses of which are in flight at
+// the same time.
 //
 class HBrowseOp
 {
-HBrowseOp& operator=(const HBrowseOp&);
+H_DISABLE_COPY(HBrowseOp)
 
 public:
 
     HBrowseParams m_loadParams;
-    HObjects m_loadedObjects;
-    qint32 m_indexUnderProcessing;
-    QScopedPointer<HClientAdapterOp<HSearchResult> > m_currentOp;
-
-    HBrowseOp() :
-        m_loadParams(),
-        m_loadedObjects(),
-        m_indexUnderProcessing(-1),
-        m_currentOp(0)
-    {
-    }
+
+    QQueue<HBrowseRequest> m_queuedRequests;
+    // the requests waiting for a free slot
+
+    QHash<unsigned int, HBrowseRequest> m_activeRequests;
+    // the requests in flight, keyed by the IDs of their operations
+
+    QQueue<HBrowseRequest> m_cachedRequests;
+    // the requests for containers that are served from the cache
+
+    QSet<QString> m_browsedContainers;
+    // the containers the children of which have been requested
+
+    QHash<QString, quint32> m_containerUpdateIds;
+    // the UpdateIDs the server returned for the containers browsed. These
+    // are merged to the cache only once the operation has succeeded, since
+    // until then the children of a container may be partially browsed.
+
+    qint32 m_browsedObjects;
+
+    bool m_revalidation;
+    // when set, the operation revalidates the cached containers
 
     HBrowseOp(const HBrowseParams& arg) :
         m_loadParams(arg),
-        m_loadedObjects(),
-        m_indexUnderProcessing(arg.browseType() != HBrowseParams::DirectChildren ? -1 : 0),
-        m_currentOp(0)
+        m_queuedRequests(), m_activeRequests(), m_cachedRequests(),
+        m_browsedContainers(), m_containerUpdateIds(),
+        m_browsedObjects(0),
+        m_revalidation(false)
+    {
+    }
+
+    inline qint32 pendingRequests() const
     {
+        return m_queuedRequests.size() + m_activeRequests.size() +
+               m_cachedRequests.size();
     }
+};
+
+//
+// The state of a cache validation started when the ContentDirectory is set
+//
+class HCacheValidation
+{
+H_DISABLE_COPY(HCacheValidation)
+
+public:
+
+    HClientAdapterOp<quint32> m_systemUpdateIdOp;
+    HClientAdapterOp<QString> m_serviceResetTokenOp;
+
+    bool m_systemUpdateIdDone;
+    bool m_systemUpdateIdValid;
+    quint32 m_systemUpdateId;
 
-    HBrowseOp(const HBrowseOp& other) :
-        m_loadParams(other.m_loadParams),
-        m_loadedObjects(other.m_loadedObjects),
-        m_indexUnderProcessing(other.m_indexUnderProcessing),
-        m_currentOp(new HClientAdapterOp<HSearchResult>(*m_currentOp))
+    bool m_serviceResetTokenDone;
+    QString m_serviceResetToken;
+
+    HCacheValidation() :
+        m_systemUpdateIdOp(), m_serviceResetTokenOp(),
+        m_systemUpdateIdDone(false), m_systemUpdateIdValid(false),
+        m_systemUpdateId(0),
+        m_serviceResetTokenDone(false), m_serviceResetToken()
     {
     }
 };
@@ -104,6 +195,16 @@ private Q_SLOTS:
     void lastChangeReceived(
         Herqq::Upnp::Av::HContentDirectoryAdapter* source, const QString& data);
 
+    void getSystemUpdateIdCompleted(
+        Herqq::Upnp::Av::HContentDirectoryAdapter* source,
+        const Herqq::Upnp::HClientAdapterOp<quint32>& op);
+
+    void getServiceResetTokenCompleted(
+        Herqq::Upnp::Av::HContentDirectoryAdapter* source,
+        const Herqq::Upnp::HClientAdapterOp<QString>& op);
+
+    void processCachedRequests();
+
 public:
 
     HContentDirectoryAdapter* m_contentDirectory;
@@ -116,6 +217,29 @@ public:
     QScopedPointer<HBrowseOp> m_currentAutoOp;
     QQueue<HBrowseOp*> m_autoOpQueue;
 
+    qint32 m_maxConcurrentBrowses;
+    quint32 m_pageSize;
+
+    QString m_cacheDirectory;
+    QString m_udn;
+    // the UDN of the device of the ContentDirectory as a simple UUID;
+    // empty when the cache is not in use
+
+    QHash<QString, quint32> m_containerUpdateIds;
+    // key == id of a container the children of which have been browsed,
+    // value == the UpdateID the server returned for the children
+
+    QSet<QString> m_validContainers;
+    // the containers the cached children of which are known to be up to date
+
+    QString m_serviceResetToken;
+    bool m_systemUpdateIdValid;
+    quint32 m_systemUpdateId;
+    // the SystemUpdateID the cached containers correspond to, if known
+
+    QScopedPointer<HCacheValidation> m_validation;
+    bool m_cachedRequestsScheduled;
+
     qint32 m_lastErrorCode;
     QString m_lastErrorDescription;
 
@@ -127,12 +251,29 @@ public:
     void checkNextAutoOp();
 
     void autoBrowse(const HBrowseParams&);
+    void autoBrowse(HBrowseOp*);
 
     void update(const HCdsLastChangeInfos&);
 
-    bool browse(HBrowseOp*);
+    bool browse(HBrowseOp*, qint32* errorCode);
+    bool dispatch(HBrowseOp*, qint32* errorCode);
+    void enqueueChildren(HBrowseOp*, const QString& containerId);
+    void proceed(HBrowseOp*);
+    void serveFromCache(HBrowseOp*);
+    void abort(HBrowseOp*);
     void reset();
 
+    void connectContentDirectory();
+
+    void store(const HObjects&);
+    void removeSubtree(const QString& id);
+
+    QString cacheFilePath() const;
+    void openCache();
+    bool saveCache();
+    void startValidation();
+    void validate();
+
     HObjects browseChildren(const QString& id);
 
     inline HMediaBrowser* owner() const
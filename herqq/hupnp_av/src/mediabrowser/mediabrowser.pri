@@ -2,8 +2,10 @@
 HEADERS += \
     $$SRC_LOC/mediabrowser/hmediabrowser.h \
     $$SRC_LOC/mediabrowser/hmediabrowser_p.h \
+    $$SRC_LOC/mediabrowser/hmediabrowser_cache_p.h \
     $$SRC_LOC/mediabrowser/hcds_lastchange_info.h
 
 SOURCES += \
     $$SRC_LOC/mediabrowser/hmediabrowser.cpp \
+    $$SRC_LOC/mediabrowser/hmediabrowser_cache_p.cpp \
     $$SRC_LOC/mediabrowser/hcds_lastchange_info.cpp
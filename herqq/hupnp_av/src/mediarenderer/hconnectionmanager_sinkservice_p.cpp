@@ -115,8 +115,7 @@ qint32 HConnectionManagerSinkService::prepareForConnection(
         return HConnectionManagerInfo::IncompatibleProtocolInfo;
     }
 
-    if (!isMimetypeValid(
-        remoteProtocolInfo.contentFormat(), sinkProtocolInfo()))
+    if (!sinkMatcher().isCompatible(remoteProtocolInfo))
     {
         return HConnectionManagerInfo::IncompatibleProtocolInfo;
     }
@@ -152,7 +151,7 @@ qint32 HConnectionManagerSinkService::connectionComplete(qint32 connectionId)
         return UpnpOptionalActionNotImplemented;
     }
 
-    if (!connectionIds().contains(connectionId))
+    if (!hasConnection(connectionId))
     {
         return HConnectionManagerInfo::InvalidConnectionReference;
     }
@@ -0,0 +1,241 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hlastchange_aggregator_p.h"
+
+#include <QtCore/QXmlStreamWriter>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+/*******************************************************************************
+ * HLastChangeAggregator
+ ******************************************************************************/
+HLastChangeAggregator::HLastChangeAggregator(Type type) :
+    m_type(type), m_slots(), m_slotKeys(), m_instances(), m_dirtyInstances(),
+    m_lastChangeCapacity(0)
+{
+}
+
+HLastChangeAggregator::~HLastChangeAggregator()
+{
+    qDeleteAll(m_instances);
+}
+
+qint32 HLastChangeAggregator::slot(const QString& name, const QString& channel)
+{
+    QString key =
+        channel.isEmpty() ? name : QString(name).append('/').append(channel);
+
+    QHash<QString, qint32>::const_iterator ci = m_slots.constFind(key);
+    if (ci != m_slots.constEnd())
+    {
+        return ci.value();
+    }
+
+    qint32 retVal = m_slotKeys.size();
+    m_slotKeys.append(qMakePair(name, channel));
+    m_slots.insert(key, retVal);
+
+    return retVal;
+}
+
+void HLastChangeAggregator::setValue(
+    qint32 instanceId, const QString& name, const QString& channel,
+    const QString& value)
+{
+    Q_ASSERT(instanceId >= 0);
+
+    qint32 index = slot(name, channel);
+
+    if (instanceId >= m_instances.size())
+    {
+        m_instances.resize(instanceId + 1);
+    }
+
+    Instance* instance = m_instances[instanceId];
+    if (!instance)
+    {
+        instance = new Instance();
+        m_instances[instanceId] = instance;
+    }
+
+    if (index >= instance->m_variables.size())
+    {
+        instance->m_variables.resize(m_slotKeys.size());
+    }
+
+    Variable& var = instance->m_variables[index];
+    var.m_value = value;
+
+    if (var.m_sent && var.m_sentValue == value)
+    {
+        // The change cancels the earlier changes made since the last event.
+        var.m_dirty = false;
+        return;
+    }
+    else if (!var.m_dirty)
+    {
+        var.m_dirty = true;
+        instance->m_dirtySlots.append(index);
+    }
+
+    if (!instance->m_listed)
+    {
+        instance->m_listed = true;
+        m_dirtyInstances.append(instanceId);
+    }
+}
+
+void HLastChangeAggregator::removeInstance(qint32 instanceId)
+{
+    if (instanceId < 0 || instanceId >= m_instances.size())
+    {
+        return;
+    }
+
+    Instance* instance = m_instances[instanceId];
+    if (!instance)
+    {
+        return;
+    }
+    else if (instance->m_listed)
+    {
+        // The last changes of the instance are still sent, but a new
+        // instance with the same ID does not inherit the sent values.
+        for(qint32 i = 0; i < instance->m_variables.size(); ++i)
+        {
+            instance->m_variables[i].m_sent = false;
+        }
+    }
+    else
+    {
+        delete instance;
+        m_instances[instanceId] = 0;
+    }
+}
+
+bool HLastChangeAggregator::takeLastChange(QString* xml)
+{
+    Q_ASSERT(xml);
+
+    if (m_dirtyInstances.isEmpty())
+    {
+        return false;
+    }
+
+    QString buf;
+    buf.reserve(m_lastChangeCapacity);
+
+    QXmlStreamWriter writer(&buf);
+
+    writer.setCodec("UTF-8");
+    writer.writeStartDocument();
+
+    writer.writeStartElement("Event");
+
+    if (m_type == RenderingControl)
+    {
+        writer.writeDefaultNamespace("urn:schemas-upnp-org:metadata-1-0/RCS/");
+        writer.writeAttribute("xmlns:xsi", "http://www.w3.org/2001/XMLSchema-instance");
+        writer.writeAttribute("xsi:schemaLocation",
+            "urn:schemas-upnp-org:metadata-1-0/RCS/ " \
+            "http://www.upnp.org/schemas/av/rcs-event-v1.xsd");
+    }
+    else
+    {
+        writer.writeDefaultNamespace("urn:schemas-upnp-org:metadata-1-0/AVT/");
+        writer.writeAttribute("xmlns:xsi", "http://www.w3.org/2001/XMLSchema-instance");
+        writer.writeAttribute("xsi:schemaLocation",
+            "urn:schemas-upnp-org:metadata-1-0/AVT/ " \
+            "http://www.upnp.org/schemas/av/avt-event-v2.xsd");
+    }
+
+    qint32 count = 0;
+    foreach(qint32 instanceId, m_dirtyInstances)
+    {
+        Instance* instance = m_instances[instanceId];
+        Q_ASSERT(instance);
+
+        bool started = false;
+        foreach(qint32 index, instance->m_dirtySlots)
+        {
+            Variable& var = instance->m_variables[index];
+            if (!var.m_dirty)
+            {
+                continue;
+            }
+
+            if (!started)
+            {
+                writer.writeStartElement("InstanceID");
+                writer.writeAttribute("val", QString::number(instanceId));
+                started = true;
+            }
+
+            const QPair<QString, QString>& key = m_slotKeys[index];
+            writer.writeStartElement(key.first);
+            writer.writeAttribute("val", var.m_value);
+            if (!key.second.isEmpty())
+            {
+                writer.writeAttribute("channel", key.second);
+            }
+            writer.writeEndElement();
+
+            var.m_sentValue = var.m_value;
+            var.m_sent = true;
+            var.m_dirty = false;
+        }
+
+        if (started)
+        {
+            writer.writeEndElement();
+            ++count;
+        }
+
+        instance->m_dirtySlots.clear();
+        instance->m_listed = false;
+    }
+    writer.writeEndElement();
+
+    m_dirtyInstances.clear();
+
+    if (count == 0)
+    {
+        // All the changes were cancelled.
+        return false;
+    }
+
+    m_lastChangeCapacity = buf.size();
+    *xml = buf;
+
+    return true;
+}
+
+}
+}
+}
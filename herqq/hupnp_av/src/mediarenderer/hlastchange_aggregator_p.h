@@ -0,0 +1,144 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HLASTCHANGE_AGGREGATOR_P_H_
+#define HLASTCHANGE_AGGREGATOR_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include <HUpnpAv/HUpnpAv>
+
+#include <QtCore/QHash>
+#include <QtCore/QPair>
+#include <QtCore/QString>
+#include <QtCore/QVector>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+//
+// Collects the changes of the state variables of the virtual instances of
+// AVTransport or RenderingControl for the next LastChange event.
+//
+// Every (variable, channel) pair is assigned a slot the first time it
+// changes and the state of each instance is kept in an array indexed by the
+// slot, while the instances are kept in an array indexed by the instance ID.
+// Only the last value of a variable is kept and a change that restores the
+// value that was sent last is not reported at all.
+//
+class HLastChangeAggregator
+{
+H_DISABLE_COPY(HLastChangeAggregator)
+
+public:
+
+    enum Type
+    {
+        AvTransport,
+        RenderingControl
+    };
+
+private:
+
+    struct Variable
+    {
+        QString m_value;
+        QString m_sentValue;
+        bool m_sent;
+        bool m_dirty;
+
+        Variable() : m_value(), m_sentValue(), m_sent(false), m_dirty(false)
+        {
+        }
+    };
+
+    struct Instance
+    {
+        QVector<Variable> m_variables;
+        // indexed by slot
+
+        QVector<qint32> m_dirtySlots;
+        // the slots that have changed since the last event. a slot whose
+        // change was cancelled stays here until the next event, but it
+        // is no longer marked dirty
+
+        bool m_listed;
+        // whether the instance is in m_dirtyInstances
+
+        Instance() : m_variables(), m_dirtySlots(), m_listed(false) {}
+    };
+
+    const Type m_type;
+
+    QHash<QString, qint32> m_slots;
+    // key == the name of the variable followed by the channel, if any
+
+    QVector<QPair<QString, QString> > m_slotKeys;
+    // the name of the variable and the channel, indexed by slot
+
+    QVector<Instance*> m_instances;
+    // indexed by instance ID
+
+    QVector<qint32> m_dirtyInstances;
+    // the IDs of the instances that have changes, in the order of the changes
+
+    qint32 m_lastChangeCapacity;
+    // the size of the previous LastChange document, which is reserved for
+    // the next one
+
+    qint32 slot(const QString& name, const QString& channel);
+
+public:
+
+    explicit HLastChangeAggregator(Type type);
+    ~HLastChangeAggregator();
+
+    void setValue(
+        qint32 instanceId, const QString& name, const QString& channel,
+        const QString& value);
+
+    // forgets the values sent for the specified instance. the pending
+    // changes of the instance are still sent
+    void removeInstance(qint32 instanceId);
+
+    // writes the pending changes into a LastChange document and marks them
+    // sent. returns false and leaves the argument intact in case there
+    // are no changes to send
+    bool takeLastChange(QString* xml);
+};
+
+}
+}
+}
+
+#endif /* HLASTCHANGE_AGGREGATOR_P_H_ */
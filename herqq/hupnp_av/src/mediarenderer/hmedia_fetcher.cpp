@@ -0,0 +1,190 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hmedia_fetcher.h"
+#include "hmedia_fetcher_p.h"
+
+#include <HUpnpCore/private/hlogger_p.h>
+
+#include <QtNetwork/QNetworkReply>
+#include <QtNetwork/QNetworkRequest>
+#include <QtNetwork/QNetworkAccessManager>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+/*******************************************************************************
+ * HMediaFetcherPrivate
+ ******************************************************************************/
+HMediaFetcherPrivate::HMediaFetcherPrivate() :
+    m_nam(0), m_ownsNam(false),
+    m_readAheadSize(HMediaFetcher::DefaultReadAheadSize), m_prefetchedUri(),
+    m_prefetched(0)
+{
+}
+
+HMediaFetcherPrivate::~HMediaFetcherPrivate()
+{
+    if (m_prefetched)
+    {
+        m_prefetched->abort();
+        delete m_prefetched;
+    }
+
+    if (m_ownsNam)
+    {
+        delete m_nam;
+    }
+}
+
+QNetworkReply* HMediaFetcherPrivate::get(const QUrl& resourceUri)
+{
+    QNetworkReply* reply = m_nam->get(QNetworkRequest(resourceUri));
+
+    // The reply stops reading from the network once its buffer is full,
+    // which bounds the amount of data read ahead of the renderer.
+    reply->setReadBufferSize(m_readAheadSize);
+
+    return reply;
+}
+
+/*******************************************************************************
+ * HMediaFetcher
+ ******************************************************************************/
+HMediaFetcher::HMediaFetcher(QObject* parent) :
+    QObject(parent),
+        h_ptr(new HMediaFetcherPrivate())
+{
+    h_ptr->m_nam = new QNetworkAccessManager();
+    h_ptr->m_ownsNam = true;
+}
+
+HMediaFetcher::HMediaFetcher(QNetworkAccessManager* nam, QObject* parent) :
+    QObject(parent),
+        h_ptr(new HMediaFetcherPrivate())
+{
+    Q_ASSERT(nam);
+    h_ptr->m_nam = nam;
+}
+
+HMediaFetcher::~HMediaFetcher()
+{
+    delete h_ptr;
+}
+
+void HMediaFetcher::prefetchFinished()
+{
+    if (sender() != h_ptr->m_prefetched)
+    {
+        return;
+    }
+
+    if (h_ptr->m_prefetched->error() != QNetworkReply::NoError)
+    {
+        HLOG(H_AT, H_FUN);
+        HLOG_WARN(QString("Failed to prefetch [%1]: %2").arg(
+            h_ptr->m_prefetchedUri.toString(),
+            h_ptr->m_prefetched->errorString()));
+    }
+}
+
+qint64 HMediaFetcher::readAheadSize() const
+{
+    return h_ptr->m_readAheadSize;
+}
+
+void HMediaFetcher::setReadAheadSize(qint64 bytes)
+{
+    h_ptr->m_readAheadSize = qMax(bytes, qint64(0));
+}
+
+bool HMediaFetcher::prefetch(const QUrl& resourceUri)
+{
+    if (!resourceUri.isValid())
+    {
+        return false;
+    }
+    else if (isPrefetched(resourceUri))
+    {
+        return true;
+    }
+
+    cancel();
+
+    h_ptr->m_prefetched = h_ptr->get(resourceUri);
+    h_ptr->m_prefetchedUri = resourceUri;
+
+    bool ok = connect(
+        h_ptr->m_prefetched, SIGNAL(finished()), this, SLOT(prefetchFinished()));
+    Q_ASSERT(ok); Q_UNUSED(ok)
+
+    return true;
+}
+
+bool HMediaFetcher::isPrefetched(const QUrl& resourceUri) const
+{
+    return h_ptr->m_prefetched && h_ptr->m_prefetchedUri == resourceUri;
+}
+
+QNetworkReply* HMediaFetcher::open(const QUrl& resourceUri)
+{
+    if (isPrefetched(resourceUri))
+    {
+        QNetworkReply* retVal = h_ptr->m_prefetched;
+        retVal->disconnect(this);
+
+        // A failed prefetch is retried, since the failure may have been
+        // caused by the prefetch being started too early.
+        if (retVal->isFinished() && retVal->error() != QNetworkReply::NoError)
+        {
+            retVal->deleteLater();
+            retVal = h_ptr->get(resourceUri);
+        }
+
+        h_ptr->m_prefetched = 0;
+        h_ptr->m_prefetchedUri = QUrl();
+        return retVal;
+    }
+
+    return h_ptr->get(resourceUri);
+}
+
+void HMediaFetcher::cancel()
+{
+    if (h_ptr->m_prefetched)
+    {
+        h_ptr->m_prefetched->disconnect(this);
+        h_ptr->m_prefetched->abort();
+        h_ptr->m_prefetched->deleteLater();
+        h_ptr->m_prefetched = 0;
+        h_ptr->m_prefetchedUri = QUrl();
+    }
+}
+
+}
+}
+}
@@ -0,0 +1,188 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HMEDIA_FETCHER_H_
+#define HMEDIA_FETCHER_H_
+
+#include <HUpnpAv/HUpnpAv>
+
+#include <QtCore/QObject>
+
+class QUrl;
+class QNetworkReply;
+class QNetworkAccessManager;
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+class HMediaFetcherPrivate;
+
+/*!
+ * \brief This class is used to fetch the media a renderer plays and to
+ * prefetch the media that is played next.
+ *
+ * A renderer that receives the next resource with \c SetNextAVTransportURI
+ * can call prefetch() to start downloading the resource while the current
+ * one is still playing. When the transport moves to the next resource,
+ * open() returns the download that is already in progress, which means that
+ * the first bytes of the next track are available immediately.
+ *
+ * The amount of data read ahead from the network is bounded by
+ * readAheadSize(). Once that much data is waiting to be read, the download
+ * is paused until the renderer reads some of the data.
+ *
+ * \headerfile hmedia_fetcher.h HMediaFetcher
+ *
+ * \ingroup hupnp_av_mediarenderer
+ *
+ * \remarks This class is not thread-safe.
+ *
+ * \sa HRendererConnection::mediaFetcher()
+ */
+class H_UPNP_AV_EXPORT HMediaFetcher :
+    public QObject
+{
+Q_OBJECT
+H_DISABLE_COPY(HMediaFetcher)
+
+private Q_SLOTS:
+
+    void prefetchFinished();
+
+private:
+
+    HMediaFetcherPrivate* h_ptr;
+
+public:
+
+    enum
+    {
+        /*!
+         * The default value of readAheadSize() in bytes.
+         */
+        DefaultReadAheadSize = 4 * 1024 * 1024
+    };
+
+    /*!
+     * \brief Creates a new instance.
+     *
+     * \param parent specifies the parent object.
+     */
+    explicit HMediaFetcher(QObject* parent = 0);
+
+    /*!
+     * \brief Creates a new instance that uses the specified object for
+     * the network access.
+     *
+     * \param nam specifies the object used for the network access. The
+     * ownership of the object is \b not transferred.
+     *
+     * \param parent specifies the parent object.
+     */
+    HMediaFetcher(QNetworkAccessManager* nam, QObject* parent = 0);
+
+    /*!
+     * \brief Destroys the instance.
+     *
+     * A download started with prefetch() that has not been opened is aborted.
+     */
+    virtual ~HMediaFetcher();
+
+    /*!
+     * \brief Returns the maximum number of bytes read ahead of the renderer.
+     *
+     * \return The maximum number of bytes read ahead of the renderer.
+     *
+     * \sa setReadAheadSize()
+     */
+    qint64 readAheadSize() const;
+
+    /*!
+     * \brief Specifies the maximum number of bytes read ahead of the renderer.
+     *
+     * \param bytes specifies the maximum number of bytes read ahead of the
+     * renderer. Zero means that the downloads are not bounded.
+     * The default is DefaultReadAheadSize. This affects the downloads
+     * started after the call.
+     *
+     * \sa readAheadSize()
+     */
+    void setReadAheadSize(qint64 bytes);
+
+    /*!
+     * \brief Starts downloading the specified resource.
+     *
+     * Only one resource is prefetched at a time. If another resource is
+     * being prefetched, that download is aborted.
+     *
+     * \param resourceUri specifies the location of the resource.
+     *
+     * \return \e true in case the download was started or the resource is
+     * already being prefetched.
+     *
+     * \sa open(), isPrefetched()
+     */
+    bool prefetch(const QUrl& resourceUri);
+
+    /*!
+     * \brief Indicates if the specified resource is being prefetched.
+     *
+     * \param resourceUri specifies the location of the resource.
+     *
+     * \return \e true in case the specified resource is being prefetched
+     * and it has not been opened yet.
+     */
+    bool isPrefetched(const QUrl& resourceUri) const;
+
+    /*!
+     * \brief Opens the specified resource for reading.
+     *
+     * \param resourceUri specifies the location of the resource.
+     *
+     * \return the download of the specified resource. If the resource has
+     * been prefetched, the download that is already in progress or finished
+     * is returned. Otherwise a new download is started. Use
+     * \c QNetworkReply::isFinished() and \c QNetworkReply::error() to check
+     * whether the download has already completed.
+     * The caller should delete the object using \c QObject::deleteLater()
+     * once done with it. The object is a child of the network access manager
+     * in use, which is why it should not be used after the fetcher has been
+     * deleted.
+     */
+    QNetworkReply* open(const QUrl& resourceUri);
+
+    /*!
+     * \brief Aborts the prefetching of a resource, if any.
+     */
+    void cancel();
+};
+
+}
+}
+}
+
+#endif /* HMEDIA_FETCHER_H_ */
@@ -0,0 +1,560 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+ */
+
+#include "hmedia_source.h"
+#include "hmedia_source_p.h"
+
+#include "../common/hprotocolinfo.h"
+#include "../transport/hduration.h"
+#include "../transport/hseekinfo.h"
+#include "../transport/havtransport_info.h"
+
+#include <HUpnpCore/private/hlogger_p.h>
+
+#include <QtCore/QUrl>
+
+#include <QtNetwork/QNetworkReply>
+#include <QtNetwork/QNetworkRequest>
+#include <QtNetwork/QNetworkAccessManager>
+
+#include <cstring>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+namespace
+{
+inline qreal toSeconds(const HDuration& duration)
+{
+    return duration.hours() * 3600 + duration.minutes() * 60 +
+           duration.seconds() + duration.fractionsOfSecond();
+}
+}
+
+/*******************************************************************************
+ * HMediaSourcePrivate
+ ******************************************************************************/
+HMediaSourcePrivate::HMediaSourcePrivate() :
+    m_nam(0), m_ownsNam(false), m_reply(0), m_resource(),
+    m_bufferSize(HMediaSource::DefaultBufferSize), m_ring(), m_ringStart(0),
+    m_ringCount(0), m_windowStart(0), m_skip(0), m_size(-1),
+    m_rangeRequests(false), m_responseChecked(false), m_finished(false)
+{
+}
+
+HMediaSourcePrivate::~HMediaSourcePrivate()
+{
+    abortReply();
+
+    if (m_ownsNam)
+    {
+        delete m_nam;
+    }
+}
+
+bool HMediaSourcePrivate::downloadDone() const
+{
+    return !m_reply || (m_finished && m_reply->bytesAvailable() <= 0);
+}
+
+void HMediaSourcePrivate::clearRing(qint64 windowStart)
+{
+    m_ringStart = 0;
+    m_ringCount = 0;
+    m_windowStart = windowStart;
+}
+
+void HMediaSourcePrivate::abortReply()
+{
+    if (m_reply)
+    {
+        m_reply->disconnect();
+        m_reply->abort();
+        m_reply->deleteLater();
+        m_reply = 0;
+    }
+}
+
+void HMediaSourcePrivate::request(qint64 offset, HMediaSource* receiver)
+{
+    abortReply();
+    clearRing(offset);
+
+    m_skip = 0;
+    m_responseChecked = false;
+    m_finished = false;
+
+    QNetworkRequest req(m_resource.location());
+    if (offset > 0)
+    {
+        req.setRawHeader(
+            "Range", QByteArray("bytes=").append(QByteArray::number(offset)).
+                append('-'));
+    }
+
+    m_reply = m_nam->get(req);
+
+    // The reply stops reading from the network once its buffer is full,
+    // which pauses the download while the ring is full as well.
+    m_reply->setReadBufferSize(qMax(m_bufferSize / 4, qint64(64 * 1024)));
+
+    bool ok = QObject::connect(
+        m_reply, SIGNAL(readyRead()), receiver, SLOT(replyReadyRead()));
+    Q_ASSERT(ok); Q_UNUSED(ok)
+
+    ok = QObject::connect(
+        m_reply, SIGNAL(finished()), receiver, SLOT(replyFinished()));
+    Q_ASSERT(ok);
+}
+
+bool HMediaSourcePrivate::checkResponse(QString* err)
+{
+    m_responseChecked = true;
+
+    qint32 statusCode = m_reply->attribute(
+        QNetworkRequest::HttpStatusCodeAttribute).toInt();
+
+    if (statusCode == 206)
+    {
+        m_rangeRequests = true;
+
+        // Content-Range: bytes first-last/total
+        QByteArray range = m_reply->rawHeader("Content-Range");
+        qint32 slash = range.lastIndexOf('/');
+        if (slash >= 0)
+        {
+            bool ok = false;
+            qint64 total = range.mid(slash + 1).trimmed().toLongLong(&ok);
+            if (ok)
+            {
+                m_size = total;
+            }
+        }
+    }
+    else if (statusCode == 200)
+    {
+        // the server ignored the range, which means that the data before
+        // the requested position has to be skipped
+        m_skip = m_windowStart;
+        m_rangeRequests =
+            m_reply->rawHeader("Accept-Ranges").trimmed() == "bytes";
+
+        bool ok = false;
+        qint64 length = m_reply->header(
+            QNetworkRequest::ContentLengthHeader).toLongLong(&ok);
+        if (ok)
+        {
+            m_size = length;
+        }
+    }
+    else if (statusCode)
+    {
+        *err = QString("Failed to fetch [%1]: the server responded [%2, %3]").
+            arg(m_resource.location().toString(),
+                QString::number(statusCode),
+                m_reply->attribute(
+                    QNetworkRequest::HttpReasonPhraseAttribute).toString());
+
+        return false;
+    }
+
+    return true;
+}
+
+qint64 HMediaSourcePrivate::fill(qint64 readPos)
+{
+    if (!m_reply || !m_responseChecked)
+    {
+        return 0;
+    }
+
+    const qint64 capacity = m_ring.size();
+    qint64 stored = 0;
+
+    while(m_reply->bytesAvailable() > 0)
+    {
+        if (m_skip > 0)
+        {
+            char discard[4096];
+            qint64 read = m_reply->read(
+                discard, qMin(m_skip, qint64(sizeof(discard))));
+
+            if (read <= 0)
+            {
+                break;
+            }
+
+            m_skip -= read;
+            continue;
+        }
+
+        if (m_ringCount == capacity)
+        {
+            // a quarter of the ring is kept for the data that has been read
+            // already and the rest of the data that has been read is dropped
+            qint64 drop = readPos - m_windowStart - capacity / 4;
+            if (drop <= 0)
+            {
+                break;
+            }
+
+            drop = qMin(drop, m_ringCount);
+            m_ringStart = (m_ringStart + drop) % capacity;
+            m_ringCount -= drop;
+            m_windowStart += drop;
+        }
+
+        qint64 tail = (m_ringStart + m_ringCount) % capacity;
+        qint64 room = qMin(capacity - m_ringCount, capacity - tail);
+
+        qint64 read = m_reply->read(m_ring.data() + tail, room);
+        if (read <= 0)
+        {
+            break;
+        }
+
+        m_ringCount += read;
+        stored += read;
+    }
+
+    return stored;
+}
+
+qint64 HMediaSourcePrivate::read(qint64 pos, char* data, qint64 maxSize) const
+{
+    if (pos < m_windowStart || pos >= windowEnd())
+    {
+        return 0;
+    }
+
+    const qint64 capacity = m_ring.size();
+    qint64 count = qMin(maxSize, windowEnd() - pos);
+    qint64 index = (m_ringStart + pos - m_windowStart) % capacity;
+
+    qint64 first = qMin(count, capacity - index);
+    std::memcpy(data, m_ring.constData() + index, first);
+    if (first < count)
+    {
+        std::memcpy(data + first, m_ring.constData(), count - first);
+    }
+
+    return count;
+}
+
+/*******************************************************************************
+ * HMediaSource
+ ******************************************************************************/
+HMediaSource::HMediaSource(QObject* parent) :
+    QIODevice(parent),
+        h_ptr(new HMediaSourcePrivate())
+{
+    h_ptr->m_nam = new QNetworkAccessManager();
+    h_ptr->m_ownsNam = true;
+}
+
+HMediaSource::HMediaSource(QNetworkAccessManager* nam, QObject* parent) :
+    QIODevice(parent),
+        h_ptr(new HMediaSourcePrivate())
+{
+    Q_ASSERT(nam);
+    h_ptr->m_nam = nam;
+}
+
+HMediaSource::~HMediaSource()
+{
+    delete h_ptr;
+}
+
+void HMediaSource::replyReadyRead()
+{
+    if (!h_ptr->m_responseChecked)
+    {
+        QString err;
+        if (!h_ptr->checkResponse(&err))
+        {
+            HLOG(H_AT, H_FUN);
+            HLOG_WARN(err);
+
+            h_ptr->abortReply();
+            setErrorString(err);
+            emit failed(this);
+            return;
+        }
+    }
+
+    if (h_ptr->fill(pos()) > 0)
+    {
+        emit readyRead();
+    }
+}
+
+void HMediaSource::replyFinished()
+{
+    QNetworkReply* reply = h_ptr->m_reply;
+    if (!reply || sender() != reply)
+    {
+        return;
+    }
+
+    if (reply->error() != QNetworkReply::NoError)
+    {
+        HLOG(H_AT, H_FUN);
+        HLOG_WARN(QString("Failed to fetch [%1]: %2").arg(
+            h_ptr->m_resource.location().toString(), reply->errorString()));
+
+        setErrorString(reply->errorString());
+        h_ptr->abortReply();
+        emit failed(this);
+        return;
+    }
+
+    replyReadyRead();
+    h_ptr->m_finished = true;
+
+    if (h_ptr->downloadDone())
+    {
+        emit readChannelFinished();
+    }
+}
+
+qint64 HMediaSource::readData(char* data, qint64 maxSize)
+{
+    qint64 read = h_ptr->read(pos(), data, maxSize);
+
+    // reading makes room in the ring, which lets the download continue
+    // from where it was paused
+    if (h_ptr->fill(pos() + read) > 0 && !read)
+    {
+        read = h_ptr->read(pos(), data, maxSize);
+    }
+
+    if (!read && h_ptr->downloadDone() && pos() >= h_ptr->windowEnd())
+    {
+        return -1;
+    }
+
+    return read;
+}
+
+qint64 HMediaSource::writeData(const char*, qint64)
+{
+    return -1;
+}
+
+qint64 HMediaSource::bufferSize() const
+{
+    return h_ptr->m_bufferSize;
+}
+
+void HMediaSource::setBufferSize(qint64 bytes)
+{
+    h_ptr->m_bufferSize = qMax(bytes, qint64(4 * 1024));
+}
+
+bool HMediaSource::open(const HResource& resource)
+{
+    close();
+
+    if (!resource.location().isValid())
+    {
+        return false;
+    }
+
+    h_ptr->m_resource = resource;
+    h_ptr->m_ring.resize(static_cast<qint32>(h_ptr->m_bufferSize));
+
+    bool ok = false;
+    qint64 size = resource.numericMediaInfo(HResource::Size, &ok);
+    h_ptr->m_size = ok && size > 0 ? size : -1;
+    h_ptr->m_rangeRequests = false;
+
+    if (!QIODevice::open(QIODevice::ReadOnly | QIODevice::Unbuffered))
+    {
+        return false;
+    }
+
+    h_ptr->request(0, this);
+    return true;
+}
+
+bool HMediaSource::open(const QUrl& location)
+{
+    return open(HResource(location, HProtocolInfo()));
+}
+
+bool HMediaSource::rangeRequestsSupported() const
+{
+    return h_ptr->m_rangeRequests;
+}
+
+bool HMediaSource::byteOffset(const HDuration& position, qint64* offset) const
+{
+    Q_ASSERT(offset);
+
+    qreal seconds = toSeconds(position);
+
+    bool ok = false;
+    qint64 bitrate =
+        h_ptr->m_resource.numericMediaInfo(HResource::Bitrate, &ok);
+
+    if (ok && bitrate > 0)
+    {
+        *offset = static_cast<qint64>(seconds * bitrate);
+        return true;
+    }
+
+    QString durationStr = h_ptr->m_resource.mediaInfo().value("duration");
+    if (h_ptr->m_size <= 0 || durationStr.isEmpty())
+    {
+        return false;
+    }
+
+    qreal duration = toSeconds(HDuration(durationStr));
+    if (duration <= 0)
+    {
+        return false;
+    }
+
+    *offset = static_cast<qint64>(h_ptr->m_size * (seconds / duration));
+    return true;
+}
+
+qint32 HMediaSource::seek(const HSeekInfo& seekInfo)
+{
+    qint64 offset = 0;
+    switch(seekInfo.unit().type())
+    {
+    case HSeekMode::AbsTime:
+    case HSeekMode::RelTime:
+        {
+            HDuration position(seekInfo.target());
+            if (!position.isZero() && !position.isPositive())
+            {
+                return HAvTransportInfo::IllegalSeekTarget;
+            }
+            else if (!byteOffset(position, &offset))
+            {
+                return HAvTransportInfo::SeekModeNotSupported;
+            }
+        }
+        break;
+
+    case HSeekMode::AbsCount:
+    case HSeekMode::RelCount:
+        {
+            bool ok = false;
+            offset = seekInfo.target().toLongLong(&ok);
+            if (!ok || offset < 0)
+            {
+                return HAvTransportInfo::IllegalSeekTarget;
+            }
+        }
+        break;
+
+    default:
+        return HAvTransportInfo::SeekModeNotSupported;
+    }
+
+    return seek(offset) ? UpnpSuccess : HAvTransportInfo::IllegalSeekTarget;
+}
+
+void HMediaSource::close()
+{
+    h_ptr->abortReply();
+    h_ptr->clearRing(0);
+    h_ptr->m_ring.clear();
+    h_ptr->m_skip = 0;
+    h_ptr->m_finished = false;
+
+    QIODevice::close();
+}
+
+bool HMediaSource::seek(qint64 pos)
+{
+    if (!isOpen() || pos < 0 || (h_ptr->m_size >= 0 && pos > h_ptr->m_size))
+    {
+        return false;
+    }
+
+    qint64 windowEnd = h_ptr->windowEnd();
+    if (pos < h_ptr->m_windowStart || pos > windowEnd)
+    {
+        bool skip =
+            pos > windowEnd &&
+            pos - windowEnd <= HMediaSourcePrivate::MaxSkipSize &&
+            h_ptr->m_responseChecked && !h_ptr->downloadDone();
+
+        if (skip)
+        {
+            // a short skip forward is cheaper than a new request
+            h_ptr->m_skip += pos - windowEnd;
+            h_ptr->clearRing(pos);
+        }
+        else
+        {
+            h_ptr->request(pos, this);
+        }
+    }
+
+    if (!QIODevice::seek(pos))
+    {
+        return false;
+    }
+
+    if (h_ptr->fill(pos) > 0)
+    {
+        emit readyRead();
+    }
+
+    return true;
+}
+
+qint64 HMediaSource::size() const
+{
+    return h_ptr->m_size >= 0 ? h_ptr->m_size : 0;
+}
+
+bool HMediaSource::isSequential() const
+{
+    return false;
+}
+
+bool HMediaSource::atEnd() const
+{
+    return !isOpen() || (pos() >= h_ptr->windowEnd() && h_ptr->downloadDone());
+}
+
+qint64 HMediaSource::bytesAvailable() const
+{
+    return qMax(h_ptr->windowEnd() - pos(), qint64(0)) +
+           QIODevice::bytesAvailable();
+}
+
+}
+}
+}
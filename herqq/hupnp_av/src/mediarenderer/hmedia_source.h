@@ -0,0 +1,289 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+ */
+
+#ifndef HMEDIA_SOURCE_H_
+#define HMEDIA_SOURCE_H_
+
+#include <HUpnpAv/HUpnpAv>
+
+#include <QtCore/QIODevice>
+
+class QUrl;
+class QNetworkAccessManager;
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+class HMediaSourcePrivate;
+
+/*!
+ * \brief This class is used to stream the media a renderer plays over HTTP
+ * with support for seeking.
+ *
+ * HMediaSource is a random-access \c QIODevice for reading the resource
+ * an HRendererConnection has been given in doSetResource(). The data is
+ * downloaded into a ring buffer the size of which is bufferSize(). Once the
+ * buffer is full, the download is paused until the renderer has read some of
+ * the data, which means that the memory used does not depend on the size of
+ * the resource.
+ *
+ * A seek to a position that is still in the buffer does not access the
+ * network at all. Any other seek aborts the current download and restarts it
+ * at the target position with an HTTP \c Range request, which costs a single
+ * round trip to the media server. A seek specified in time, such as the
+ * target of an \c AVTransport \c Seek action, is mapped into a byte offset
+ * using the size, the bitrate and the duration of the resource.
+ *
+ * \code
+ *
+ * qint32 MyRendererConnection::doSetResource(
+ *     const QUrl& resourceUri, HObject* cdsMetadata)
+ * {
+ *     HResource resource(resourceUri, HProtocolInfo());
+ *     if (cdsMetadata && !cdsMetadata->resources().isEmpty())
+ *     {
+ *         resource = cdsMetadata->resources().first();
+ *     }
+ *
+ *     return m_source->open(resource) ? UpnpSuccess : UpnpUndefinedFailure;
+ * }
+ *
+ * qint32 MyRendererConnection::doSeek(const HSeekInfo& seekInfo)
+ * {
+ *     return m_source->seek(seekInfo);
+ * }
+ *
+ * \endcode
+ *
+ * \headerfile hmedia_source.h HMediaSource
+ *
+ * \ingroup hupnp_av_mediarenderer
+ *
+ * \remarks This class is not thread-safe.
+ *
+ * \sa HRendererConnection, HMediaFetcher
+ */
+class H_UPNP_AV_EXPORT HMediaSource :
+    public QIODevice
+{
+Q_OBJECT
+H_DISABLE_COPY(HMediaSource)
+
+private Q_SLOTS:
+
+    void replyReadyRead();
+    void replyFinished();
+
+private:
+
+    HMediaSourcePrivate* h_ptr;
+
+protected:
+
+    virtual qint64 readData(char* data, qint64 maxSize);
+    virtual qint64 writeData(const char* data, qint64 maxSize);
+
+public:
+
+    enum
+    {
+        /*!
+         * The default value of bufferSize() in bytes.
+         */
+        DefaultBufferSize = 2 * 1024 * 1024
+    };
+
+    /*!
+     * \brief Creates a new instance.
+     *
+     * \param parent specifies the parent object.
+     */
+    explicit HMediaSource(QObject* parent = 0);
+
+    /*!
+     * \brief Creates a new instance that uses the specified object for
+     * the network access.
+     *
+     * \param nam specifies the object used for the network access. The
+     * ownership of the object is \b not transferred.
+     *
+     * \param parent specifies the parent object.
+     */
+    HMediaSource(QNetworkAccessManager* nam, QObject* parent = 0);
+
+    /*!
+     * \brief Destroys the instance.
+     */
+    virtual ~HMediaSource();
+
+    /*!
+     * \brief Returns the size of the ring buffer in bytes.
+     *
+     * \return The size of the ring buffer in bytes.
+     *
+     * \sa setBufferSize()
+     */
+    qint64 bufferSize() const;
+
+    /*!
+     * \brief Specifies the size of the ring buffer.
+     *
+     * \param bytes specifies the size of the ring buffer in bytes.
+     * A quarter of the buffer is reserved for the data that has already been
+     * read, which lets the renderer seek backwards a bit without accessing the
+     * network. The default is DefaultBufferSize. This affects the resources
+     * opened after the call.
+     *
+     * \sa bufferSize()
+     */
+    void setBufferSize(qint64 bytes);
+
+    /*!
+     * \brief Opens the specified resource for reading.
+     *
+     * \param resource specifies the resource. The size and the duration of
+     * the resource are used for mapping the seeks specified in time into
+     * byte offsets. The bitrate is used instead of the duration, if it is
+     * available.
+     *
+     * \return \e true in case the download of the resource was started.
+     * The device is opened in the \c QIODevice::ReadOnly mode.
+     *
+     * \sa close()
+     */
+    bool open(const HResource& resource);
+
+    /*!
+     * \brief Opens the resource at the specified location for reading.
+     *
+     * This is the same as calling open(const HResource&) with a resource
+     * that has no size or duration information, which means that seeks
+     * specified in time are not supported.
+     *
+     * \param location specifies the location of the resource.
+     *
+     * \return \e true in case the download of the resource was started.
+     */
+    bool open(const QUrl& location);
+
+    /*!
+     * \brief Indicates whether the media server serves the resource with
+     * HTTP \c Range requests.
+     *
+     * \return \e true in case the server has responded to a request with
+     * <c>206 Partial Content</c> or it has stated that it accepts byte
+     * ranges. When this is \e false, a seek to a position that is not in the
+     * buffer restarts the download from the start of the resource and skips
+     * the data before the position.
+     */
+    bool rangeRequestsSupported() const;
+
+    /*!
+     * \brief Seeks to the position specified in the terms of the
+     * \c AVTransport \c Seek action.
+     *
+     * \param seekInfo specifies the target of the seek. The \c ABS_TIME and
+     * \c REL_TIME units are mapped into byte offsets and the \c ABS_COUNT and
+     * \c REL_COUNT units are interpreted as byte offsets. Both kinds of
+     * targets are measured from the start of the resource.
+     *
+     * \return \c UpnpSuccess, \c HAvTransportInfo::SeekModeNotSupported
+     * in case the unit is not supported or the resource lacks the metadata
+     * required for mapping a time into a byte offset, or
+     * \c HAvTransportInfo::IllegalSeekTarget in case the target is not
+     * valid or it is past the end of the resource. The return value is
+     * suitable for returning from HRendererConnection::doSeek().
+     */
+    qint32 seek(const HSeekInfo& seekInfo);
+
+    /*!
+     * \brief Returns the byte offset of the specified time position.
+     *
+     * \param position specifies the time from the start of the resource.
+     *
+     * \param offset specifies a pointer to the integer that receives the
+     * byte offset.
+     *
+     * \return \e true in case the offset could be determined.
+     */
+    bool byteOffset(const HDuration& position, qint64* offset) const;
+
+    /*!
+     * \reimp
+     *
+     * The current download is aborted and the buffered data is discarded.
+     */
+    virtual void close();
+
+    /*!
+     * \reimp
+     *
+     * \remarks A seek to a position outside the buffered data restarts
+     * the download at the position. The data becomes available once the
+     * server has responded, which is signaled with \c readyRead().
+     */
+    virtual bool seek(qint64 pos);
+
+    /*!
+     * \reimp
+     *
+     * \return The size of the resource, or zero until it is known.
+     */
+    virtual qint64 size() const;
+
+    /*!
+     * \reimp
+     */
+    virtual bool isSequential() const;
+
+    /*!
+     * \reimp
+     */
+    virtual bool atEnd() const;
+
+    /*!
+     * \reimp
+     */
+    virtual qint64 bytesAvailable() const;
+
+Q_SIGNALS:
+
+    /*!
+     * \brief This signal is emitted when the download of the resource fails.
+     *
+     * \param source identifies the object that failed. The description of
+     * the failure is available through \c QIODevice::errorString().
+     */
+    void failed(Herqq::Upnp::Av::HMediaSource* source);
+};
+
+}
+}
+}
+
+#endif /* HMEDIA_SOURCE_H_ */
@@ -0,0 +1,122 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+ */
+
+#ifndef HMEDIA_SOURCE_P_H_
+#define HMEDIA_SOURCE_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include "../common/hresource.h"
+
+#include <QtCore/QByteArray>
+
+class QNetworkReply;
+class QNetworkAccessManager;
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+//
+// Implementation details of HMediaSource
+//
+class HMediaSourcePrivate
+{
+H_DISABLE_COPY(HMediaSourcePrivate)
+
+public:
+
+    enum
+    {
+        MaxSkipSize = 64 * 1024
+        // the largest forward seek past the buffered data that is done by
+        // skipping the data of the current download instead of restarting it
+    };
+
+    QNetworkAccessManager* m_nam;
+    bool m_ownsNam;
+
+    QNetworkReply* m_reply;
+    HResource m_resource;
+
+    qint64 m_bufferSize;
+
+    QByteArray m_ring;
+    qint64 m_ringStart, m_ringCount;
+    // the index of the oldest byte in the ring and the number of bytes in it
+
+    qint64 m_windowStart;
+    // the offset of the oldest byte of the ring in the resource
+
+    qint64 m_skip;
+    // the number of bytes of the download to discard before the data that is
+    // stored into the ring
+
+    qint64 m_size;
+    // the size of the resource, or -1 when it is not known
+
+    bool m_rangeRequests;
+    bool m_responseChecked;
+    bool m_finished;
+    // whether the current download has completed successfully
+
+    HMediaSourcePrivate();
+    ~HMediaSourcePrivate();
+
+    inline qint64 windowEnd() const { return m_windowStart + m_ringCount; }
+
+    // returns true when no more data will be stored into the ring
+    bool downloadDone() const;
+
+    void clearRing(qint64 windowStart);
+    void abortReply();
+
+    // starts downloading the resource at the specified offset. the signals of
+    // the download are connected to the specified source
+    void request(qint64 offset, HMediaSource* receiver);
+
+    // returns false in case the server did not accept the request
+    bool checkResponse(QString* err);
+
+    // moves the downloaded data into the ring as long as there is room.
+    // returns the number of bytes stored
+    qint64 fill(qint64 readPos);
+
+    qint64 read(qint64 pos, char* data, qint64 maxSize) const;
+};
+
+}
+}
+}
+
+#endif /* HMEDIA_SOURCE_P_H_ */
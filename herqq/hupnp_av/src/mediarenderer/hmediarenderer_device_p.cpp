@@ -23,6 +23,8 @@
 #include "hrendererconnection_manager.h"
 
 #include "../renderingcontrol/hchannel.h"
+#include "../transport/hpositioninfo.h"
+#include "../transport/htransportinfo.h"
 #include "../connectionmanager/hconnectionmanager_id.h"
 
 #include <HUpnpCore/HStateVariablesSetupData>
@@ -30,7 +32,6 @@
 #include <QtCore/QEvent>
 #include <QtCore/QBuffer>
 #include <QtCore/QByteArray>
-#include <QtCore/QXmlStreamWriter>
 
 namespace Herqq
 {
@@ -46,8 +47,10 @@ namespace Av
  ******************************************************************************/
 HMediaRendererDevice::HMediaRendererDevice(
     const HMediaRendererDeviceConfiguration& conf) :
-        m_configuration(conf.clone()), m_timer(this), m_avtInstanceEvents(),
-        m_rcsInstanceEvents()
+        m_configuration(conf.clone()), m_timer(this),
+        m_avtChanges(HLastChangeAggregator::AvTransport),
+        m_rcsChanges(HLastChangeAggregator::RenderingControl),
+        m_positionUpdates(false), m_positions()
 {
     m_timer.setInterval(200);
     bool ok = connect(
@@ -64,121 +67,118 @@ HMediaRendererDevice::HMediaRendererDevice(
 HMediaRendererDevice::~HMediaRendererDevice()
 {
     delete m_configuration;
-    qDeleteAll(m_avtInstanceEvents);
-    qDeleteAll(m_rcsInstanceEvents);
 }
 
-namespace
-{
-void clear(QList<HInstanceEvents*>* events)
+void HMediaRendererDevice::timeout()
 {
-    foreach(HInstanceEvents* ie, *events)
+    m_timer.stop();
+
+    QString lastChangeData;
+    if (m_avtChanges.takeLastChange(&lastChangeData))
     {
-        ie->m_changedProperties.clear();
+        bool ok = avTransport()->setValue("LastChange", lastChangeData);
+        Q_ASSERT(ok); Q_UNUSED(ok)
     }
-}
-
-bool generateLastChange(
-    const QList<HInstanceEvents*>& events, bool rcs, QString* xml)
-{
-    QXmlStreamWriter writer(xml);
-
-    writer.setCodec("UTF-8");
-    writer.writeStartDocument();
-
-    writer.writeStartElement("Event");
-
-    if (rcs)
+    if (m_rcsChanges.takeLastChange(&lastChangeData))
     {
-        writer.writeDefaultNamespace("urn:schemas-upnp-org:metadata-1-0/RCS/");
-        writer.writeAttribute("xmlns:xsi", "http://www.w3.org/2001/XMLSchema-instance");
-        writer.writeAttribute("xsi:schemaLocation",
-            "urn:schemas-upnp-org:metadata-1-0/RCS/ " \
-            "http://www.upnp.org/schemas/av/rcs-event-v1.xsd");
+        bool ok = renderingControl()->setValue("LastChange", lastChangeData);
+        Q_ASSERT(ok); Q_UNUSED(ok)
     }
-    else
+    if (m_positionUpdates)
     {
-        writer.writeDefaultNamespace("urn:schemas-upnp-org:metadata-1-0/AVT/");
-        writer.writeAttribute("xmlns:xsi", "http://www.w3.org/2001/XMLSchema-instance");
-        writer.writeAttribute("xsi:schemaLocation",
-            "urn:schemas-upnp-org:metadata-1-0/AVT/ " \
-            "http://www.upnp.org/schemas/av/avt-event-v2.xsd");
+        publishPositions();
     }
+    m_timer.start();
+}
 
-    int count = 0;
-    foreach(const HInstanceEvents* event, events)
-    {
-        if (event->m_changedProperties.size() > 0)
-        {
-            writer.writeStartElement("InstanceID");
-            writer.writeAttribute("val", QString::number(event->m_instanceId));
+namespace
+{
+// AVTransport leaves these out of LastChange
+bool isPositionVariable(const QString& name)
+{
+    return name == "RelativeTimePosition" ||
+           name == "AbsoluteTimePosition" ||
+           name == "RelativeCounterPosition" ||
+           name == "AbsoluteCounterPosition";
+}
 
-            QHash<QString, QPair<QString, QString> >::const_iterator ci =
-                event->m_changedProperties.constBegin();
+bool affectsPositionUpdate(const QString& name)
+{
+    return name == "RelativeTimePosition" ||
+           name == "TransportState" ||
+           name == "TransportPlaySpeed" ||
+           name == "CurrentTrack";
+}
 
-            while(ci != event->m_changedProperties.constEnd())
-            {
-                writer.writeStartElement(ci.key());
-                writer.writeAttribute("val", ci.value().first);
-                if (!ci.value().second.isEmpty())
-                {
-                    writer.writeAttribute("channel", ci.value().second);
-                }
-                writer.writeEndElement();
-                ++ci;
-            }
+// The difference between a reported position and the extrapolated one that
+// is attributed to a seek rather than to the drift of the extrapolation.
+const qint64 MaxPositionDrift = 1500;
+}
 
-            writer.writeEndElement();
-            ++count;
-        }
+void HMediaRendererDevice::positionChanged(
+    qint32 avtId, HRendererConnectionInfo* source)
+{
+    HPositionInfo positionInfo = source->positionInfo();
+    HTransportInfo transportInfo = source->transportInfo();
+
+    HAvtPositionUpdate update;
+    update.m_instanceId = avtId;
+    update.m_track = positionInfo.track();
+    update.m_position =
+        HAvtPositionUpdate::toMsecs(positionInfo.relativeTimePosition());
+    update.m_state = transportInfo.state();
+    update.m_speed = transportInfo.speed();
+
+    PositionState& state = m_positions[avtId];
+    state.m_current = update;
+    state.m_dirty = true;
+
+    const HAvtPositionUpdate& published = state.m_published;
+    if (!published.isValid() ||
+        published.m_state != update.m_state ||
+        published.m_speed != update.m_speed ||
+        published.m_track != update.m_track ||
+        qAbs(published.extrapolate(state.m_publishedAt.elapsed()) -
+             update.m_position) > MaxPositionDrift)
+    {
+        state.m_urgent = true;
     }
-    writer.writeEndElement();
-
-    return count > 0;
-}
 }
 
-void HMediaRendererDevice::timeout()
+void HMediaRendererDevice::publishPositions()
 {
-    m_timer.stop();
+    qint32 interval = m_configuration->positionUpdateInterval();
 
-    QString lastChangeData;
-    if (!m_avtInstanceEvents.isEmpty())
+    bool changed = false;
+    QList<HAvtPositionUpdate> updates;
+
+    QHash<qint32, PositionState>::iterator it = m_positions.begin();
+    for(; it != m_positions.end(); ++it)
     {
-        if (generateLastChange(m_avtInstanceEvents, false, &lastChangeData))
+        PositionState& state = it.value();
+        if (state.m_dirty &&
+           (state.m_urgent || state.m_publishedAt.elapsed() >= interval))
         {
-            bool ok = avTransport()->setValue("LastChange", lastChangeData);
-            Q_ASSERT(ok); Q_UNUSED(ok)
-            clear(&m_avtInstanceEvents);
+            state.m_published = state.m_current;
+            state.m_publishedAt.start();
+            state.m_dirty = false;
+            state.m_urgent = false;
+            changed = true;
         }
-    }
-    if (!m_rcsInstanceEvents.isEmpty())
-    {
-        if (generateLastChange(m_rcsInstanceEvents, true, &lastChangeData))
+
+        if (state.m_published.isValid())
         {
-            bool ok = renderingControl()->setValue("LastChange", lastChangeData);
-            Q_ASSERT(ok); Q_UNUSED(ok)
-            clear(&m_rcsInstanceEvents);
+            updates.append(state.m_published);
         }
     }
-    m_timer.start();
-}
 
-namespace
-{
-HInstanceEvents* getInstanceEvents(QList<HInstanceEvents*>* events, qint32 id)
-{
-    HInstanceEvents* retVal = 0;
-    foreach(HInstanceEvents* event, *events)
+    if (changed)
     {
-        if (event->m_instanceId == id)
-        {
-            retVal = event;
-            break;
-        }
+        bool ok = avTransport()->setValue(
+            HAvtPositionUpdate::variableName(),
+            HAvtPositionUpdate::toString(updates));
+        Q_ASSERT(ok); Q_UNUSED(ok)
     }
-    return retVal;
-}
 }
 
 void HMediaRendererDevice::propertyChanged(
@@ -190,33 +190,39 @@ void HMediaRendererDevice::propertyChanged(
 
     Q_ASSERT(retVal == UpnpSuccess); Q_UNUSED(retVal)
 
-    HInstanceEvents* events = 0;
-    if (HAvTransportInfo::stateVariablesSetupData().contains(eventInfo.propertyName()))
+    const QString& name = eventInfo.propertyName();
+    if (HAvTransportInfo::stateVariablesSetupData().contains(name))
     {
-        events = getInstanceEvents(&m_avtInstanceEvents, info.avTransportId());
-        if (!events)
+        if (m_positionUpdates && affectsPositionUpdate(name))
+        {
+            positionChanged(info.avTransportId(), source);
+        }
+        if (!isPositionVariable(name))
         {
-            events = new HInstanceEvents(info.avTransportId());
-            m_avtInstanceEvents.append(events);
+            m_avtChanges.setValue(
+                info.avTransportId(), name,
+                eventInfo.channel().toString(), eventInfo.newValue());
         }
     }
     else
     {
-        events = getInstanceEvents(&m_rcsInstanceEvents, info.rcsId());
-        if (!events)
-        {
-            events = new HInstanceEvents(info.rcsId());
-            m_rcsInstanceEvents.append(events);
-        }
+        m_rcsChanges.setValue(
+            info.rcsId(), name,
+            eventInfo.channel().toString(), eventInfo.newValue());
     }
-    events->m_changedProperties.insert(
-        eventInfo.propertyName(),
-        qMakePair(eventInfo.newValue(), eventInfo.channel().toString()));
 }
 
 void HMediaRendererDevice::rendererConnectionRemoved(
     HAbstractConnectionManagerService*, qint32 cid)
 {
+    HConnectionInfo info;
+    qint32 retVal = connectionManager()->getCurrentConnectionInfo(cid, &info);
+    if (retVal == UpnpSuccess)
+    {
+        m_avtChanges.removeInstance(info.avTransportId());
+        m_rcsChanges.removeInstance(info.rcsId());
+        m_positions.remove(info.avTransportId());
+    }
     connectionManager()->removeConnection(cid);
 }
 
@@ -317,6 +323,11 @@ bool HMediaRendererDevice::finalizeInit(QString* errDescription)
         }
     }
 
+    m_positionUpdates =
+        m_configuration->positionUpdateInterval() > 0 &&
+        avTransport()->stateVariables().contains(
+            HAvtPositionUpdate::variableName());
+
     m_timer.start();
 
     return true;
@@ -372,53 +383,14 @@ HRendererConnection* HMediaRendererDevice::createRendererConnection(
 
 HRendererConnection* HMediaRendererDevice::findConnectionByAvTransportId(qint32 id) const
 {
-    QList<quint32> connectionIds;
-    qint32 rc = connectionManager()->getCurrentConnectionIDs(&connectionIds);
-    Q_ASSERT(rc == UpnpSuccess); Q_UNUSED(rc)
-
-    foreach(quint32 cid, connectionIds)
-    {
-        HConnectionInfo info;
-        rc = connectionManager()->getCurrentConnectionInfo((qint32)cid, &info);
-        Q_ASSERT(rc == UpnpSuccess);
-
-        if (info.avTransportId() == id)
-        {
-            HRendererConnection* connection =
-                m_configuration->rendererConnectionManager()->connection(
-                    connectionManager(), cid);
-
-            return connection;
-        }
-    }
-
-    return 0;
+    return m_configuration->rendererConnectionManager()->
+        connectionByAvTransportId(connectionManager(), id);
 }
 
 HRendererConnection* HMediaRendererDevice::findConnectionByRcsId(qint32 id) const
 {
-    QList<quint32> connectionIds;
-    qint32 rc = connectionManager()->getCurrentConnectionIDs(&connectionIds);
-    Q_ASSERT(rc == UpnpSuccess); Q_UNUSED(rc)
-
-    foreach(quint32 cid, connectionIds)
-    {
-        HConnectionInfo info;
-        rc = connectionManager()->getCurrentConnectionInfo((qint32)cid, &info);
-        Q_ASSERT(rc == UpnpSuccess);
-
-        if (info.rcsId() == id)
-        {
-            HRendererConnection* connection =
-                m_configuration->rendererConnectionManager()->connection(
-                    connectionManager(), cid);
-            Q_ASSERT(connection);
-
-            return connection;
-        }
-    }
-
-    return 0;
+    return m_configuration->rendererConnectionManager()->connectionByRcsId(
+        connectionManager(), id);
 }
 
 HMediaRendererDeviceConfiguration* HMediaRendererDevice::configuration() const
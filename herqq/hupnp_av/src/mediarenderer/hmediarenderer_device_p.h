@@ -35,12 +35,16 @@
 #include <HUpnpCore/private/hserverdevice_p.h>
 
 #include "hrendererconnection.h"
+#include "hlastchange_aggregator_p.h"
 #include "htransport_sinkservice_p.h"
 #include "habstractmediarenderer_device.h"
 #include "hconnectionmanager_sinkservice_p.h"
 #include "hmediarenderer_deviceconfiguration.h"
 #include "../renderingcontrol/hrenderingcontrol_service_p.h"
+#include "../transport/havt_positionupdate_p.h"
 
+#include <QtCore/QHash>
+#include <QtCore/QTime>
 #include <QtCore/QTimer>
 #include <QtCore/QPointer>
 #include <QtNetwork/QNetworkReply>
@@ -54,26 +58,6 @@ namespace Upnp
 namespace Av
 {
 
-//
-//
-//
-class HInstanceEvents
-{
-H_DISABLE_COPY(HInstanceEvents)
-
-public:
-
-    const qint32 m_instanceId;
-    QHash<QString, QPair<QString, QString> > m_changedProperties;
-    // The first component of the pair is the "val" attribute and the second
-    // component is the "channel", if any.
-
-    HInstanceEvents(qint32 instanceId) :
-        m_instanceId(instanceId)
-    {
-    }
-};
-
 //
 //
 //
@@ -88,8 +72,40 @@ private:
     HMediaRendererDeviceConfiguration* m_configuration;
 
     QTimer m_timer;
-    QList<HInstanceEvents*> m_avtInstanceEvents;
-    QList<HInstanceEvents*> m_rcsInstanceEvents;
+    HLastChangeAggregator m_avtChanges;
+    HLastChangeAggregator m_rcsChanges;
+
+    struct PositionState
+    {
+        HAvtPositionUpdate m_current;
+
+        HAvtPositionUpdate m_published;
+        QTime m_publishedAt;
+
+        bool m_dirty;
+        // whether m_current has changed since it was last published
+
+        bool m_urgent;
+        // whether m_current differs from what the published position
+        // extrapolates to, in which case it is published with the next
+        // LastChange event instead of the next periodic refresh
+
+        PositionState() :
+            m_current(), m_published(), m_publishedAt(),
+            m_dirty(false), m_urgent(false)
+        {
+        }
+    };
+
+    bool m_positionUpdates;
+    // whether the AVTransport declares X_HERQQ_PositionUpdate and the
+    // configuration has not disabled publishing it
+
+    QHash<qint32, PositionState> m_positions;
+    // keyed by AVTransport instance ID
+
+    void positionChanged(qint32 avtId, HRendererConnectionInfo* source);
+    void publishPositions();
 
 private Q_SLOTS:
 
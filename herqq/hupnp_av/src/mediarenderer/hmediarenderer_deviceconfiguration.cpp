@@ -35,7 +35,8 @@ namespace Av
  * HMediaRendererDeviceConfigurationPrivate
  ******************************************************************************/
 HMediaRendererDeviceConfigurationPrivate::HMediaRendererDeviceConfigurationPrivate() :
-    m_mm(0), m_refCnt(0), m_hasOwnership(false)
+    m_mm(0), m_refCnt(0), m_hasOwnership(false),
+    m_positionUpdateInterval(5000)
 {
 }
 
@@ -88,6 +89,7 @@ void HMediaRendererDeviceConfiguration::doClone(HClonable* target) const
     }
     conf->h_ptr->m_hasOwnership = h_ptr->m_hasOwnership;
     conf->h_ptr->m_mm = h_ptr->m_mm;
+    conf->h_ptr->m_positionUpdateInterval = h_ptr->m_positionUpdateInterval;
 }
 
 HMediaRendererDeviceConfiguration* HMediaRendererDeviceConfiguration::newInstance() const
@@ -136,6 +138,16 @@ void HMediaRendererDeviceConfiguration::detachRendererConnectionManager()
     h_ptr->detach();
 }
 
+qint32 HMediaRendererDeviceConfiguration::positionUpdateInterval() const
+{
+    return h_ptr->m_positionUpdateInterval;
+}
+
+void HMediaRendererDeviceConfiguration::setPositionUpdateInterval(qint32 msecs)
+{
+    h_ptr->m_positionUpdateInterval = qMax(msecs, 0);
+}
+
 }
 }
 }
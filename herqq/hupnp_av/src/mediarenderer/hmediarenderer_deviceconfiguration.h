@@ -146,6 +146,46 @@ public:
      * \sa setRendererConnectionManager()
      */
     void detachRendererConnectionManager();
+
+    /*!
+     * \brief Returns the interval at which the Media Renderer refreshes the
+     * published playback positions of its AVTransport instances.
+     *
+     * \return The interval at which the Media Renderer refreshes the
+     * published playback positions in milliseconds. The default is 5000.
+     *
+     * \sa setPositionUpdateInterval()
+     */
+    qint32 positionUpdateInterval() const;
+
+    /*!
+     * \brief Specifies the interval at which the Media Renderer refreshes the
+     * published playback positions of its AVTransport instances.
+     *
+     * The AVTransport specification leaves the position state variables out
+     * of \c LastChange, which is why control points usually poll
+     * \c GetPositionInfo. In case the AVTransport service description of the
+     * Media Renderer declares an evented state variable named
+     * \c X_HERQQ_PositionUpdate, the Media Renderer publishes the playback
+     * position, the transport state and the playback speed of each instance
+     * through that variable and HAvTransportAdapter extrapolates the
+     * position from those. Changes that the extrapolation cannot predict,
+     * such as seeks and changes of the transport state, are published
+     * within the \c LastChange moderation period, while the steady progress
+     * of the playback is published only at this interval to correct the drift.
+     *
+     * When the variable is declared with \c multicast="yes", each update is
+     * also multicast as a UPnP 1.1 multicast event, in which case control
+     * points that have multicast eventing enabled receive the positions
+     * without subscribing to the AVTransport. The subscribers receive the
+     * updates through the regular unicast events in any case.
+     *
+     * \param msecs specifies the interval in milliseconds. Zero disables
+     * the publishing altogether.
+     *
+     * \sa positionUpdateInterval(), HAvTransportAdapter::estimatedPosition()
+     */
+    void setPositionUpdateInterval(qint32 msecs);
 };
 
 }
@@ -55,6 +55,7 @@ public:
     QPointer<HRendererConnectionManager> m_mm;
     int* m_refCnt;
     bool m_hasOwnership;
+    qint32 m_positionUpdateInterval;
 
     HMediaRendererDeviceConfigurationPrivate();
     virtual ~HMediaRendererDeviceConfigurationPrivate();
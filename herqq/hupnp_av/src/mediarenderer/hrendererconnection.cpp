@@ -21,6 +21,7 @@
 
 #include "hrendererconnection.h"
 #include "hrendererconnection_p.h"
+#include "hmedia_fetcher.h"
 
 #include "../hav_global_p.h"
 
@@ -31,6 +32,7 @@
 #include "../transport/htransportinfo.h"
 #include "../transport/htransportstate.h"
 #include "../transport/htransportaction.h"
+#include "../transport/htransport_statemachine_p.h"
 #include "../transport/hrecordqualitymode.h"
 #include "../transport/htransportsettings.h"
 #include "../transport/hdevicecapabilities.h"
@@ -52,6 +54,7 @@
 
 #include <QtCore/QSet>
 #include <QtCore/QUrl>
+#include <QtCore/QPair>
 #include <QtCore/QStringList>
 
 namespace Herqq
@@ -67,7 +70,9 @@ namespace Av
  * HRendererConnectionPrivate
  ******************************************************************************/
 HRendererConnectionPrivate::HRendererConnectionPrivate() :
-    m_info(0), m_connectionInfo(0), m_service(0), q_ptr(0), m_valueSetters()
+    m_info(0), m_connectionInfo(0), m_service(0), q_ptr(0), m_valueSetters(),
+    m_mediaFetcher(0), m_volumeDebounceInterval(100), m_volumes(),
+    m_volumeTimer()
 {
     m_valueSetters.insert("Brightness", ValueSetter(this, &HRendererConnectionPrivate::setBrightness));
     m_valueSetters.insert("Contrast", ValueSetter(this, &HRendererConnectionPrivate::setContrast));
@@ -92,6 +97,20 @@ HRendererConnectionPrivate::~HRendererConnectionPrivate()
     delete m_info;
 }
 
+void HRendererConnectionPrivate::setTransportState(HTransportState::Type state)
+{
+    m_info->setTransportState(state);
+    m_info->setCurrentTransportActions(
+        HTransportStateMachine::availableActions(state));
+}
+
+HTransportState::Type HRendererConnectionPrivate::transition(
+    HTransportAction::Type action) const
+{
+    return HTransportStateMachine::transition(
+        m_info->transportState().type(), action);
+}
+
 bool HRendererConnectionPrivate::setBrightness(const QString& value, const HChannel&)
 {
     qint32 rc = q_ptr->setRcsValue(HRendererConnectionInfo::Brightness, value.toUShort());
@@ -200,8 +219,14 @@ HRendererConnection::HRendererConnection(QObject* parent) :
     h_ptr->q_ptr = this;
     h_ptr->m_info = new HRendererConnectionInfo(this);
 
+    h_ptr->m_volumeTimer.setSingleShot(true);
+    bool ok = connect(
+        &h_ptr->m_volumeTimer, SIGNAL(timeout()),
+        this, SLOT(applyPendingVolumes()));
+    Q_ASSERT(ok); Q_UNUSED(ok)
+
     h_ptr->m_info->setTransportStatus(HTransportStatus::OK);
-    h_ptr->m_info->setTransportState(HTransportState::NoMediaPresent);
+    h_ptr->setTransportState(HTransportState::NoMediaPresent);
 
     HTransportSettings transPortSettings(h_ptr->m_info->transportSettings());
     transPortSettings.setPlayMode(HPlayMode::Normal);
@@ -209,9 +234,6 @@ HRendererConnection::HRendererConnection(QObject* parent) :
     h_ptr->m_info->setTransportSettings(transPortSettings);
 
     h_ptr->m_info->setCurrentMediaCategory(HMediaInfo::NoMedia);
-
-    QSet<HTransportAction> actions = HTransportAction::allActions();
-    h_ptr->m_info->setCurrentTransportActions(actions);
 }
 
 HRendererConnection::~HRendererConnection()
@@ -266,6 +288,26 @@ qint32 HRendererConnection::doSetRecordQualityMode(const HRecordQualityMode& new
     return HAvTransportInfo::RecordQualityNotSupported;
 }
 
+HMediaFetcher* HRendererConnection::mediaFetcher()
+{
+    if (!h_ptr->m_mediaFetcher)
+    {
+        h_ptr->m_mediaFetcher = new HMediaFetcher(this);
+    }
+
+    return h_ptr->m_mediaFetcher;
+}
+
+qint32 HRendererConnection::volumeDebounceInterval() const
+{
+    return h_ptr->m_volumeDebounceInterval;
+}
+
+void HRendererConnection::setVolumeDebounceInterval(qint32 msecs)
+{
+    h_ptr->m_volumeDebounceInterval = qMax(msecs, 0);
+}
+
 qint32 HRendererConnection::doSetNextResource(
     const QUrl& resourceUri, HObject* cdsMetadata)
 {
@@ -365,15 +407,9 @@ qint32 HRendererConnection::play(const QString& speed)
 {
     HLOG(H_AT, H_FUN);
 
-    switch(h_ptr->m_info->transportState().type())
+    HTransportState::Type next = h_ptr->transition(HTransportAction::Play);
+    if (next == HTransportState::Undefined)
     {
-    case HTransportState::Stopped:
-    case HTransportState::Playing:
-    case HTransportState::PausedPlayback:
-    case HTransportState::Transitioning:
-    case HTransportState::VendorDefined:
-        break;
-    default:
         return HAvTransportInfo::TransitionNotAvailable;
     }
 
@@ -382,8 +418,8 @@ qint32 HRendererConnection::play(const QString& speed)
     {
         HTransportInfo transportInfo = h_ptr->m_info->transportInfo();
         transportInfo.setSpeed(speed);
-        transportInfo.setState(HTransportState::Playing);
         h_ptr->m_info->setTransportInfo(transportInfo);
+        h_ptr->setTransportState(next);
     }
     return rc;
 }
@@ -392,13 +428,14 @@ qint32 HRendererConnection::stop()
 {
     HLOG(H_AT, H_FUN);
 
-    if (h_ptr->m_info->transportState().type() == HTransportState::NoMediaPresent)
+    HTransportState::Type next = h_ptr->transition(HTransportAction::Stop);
+    if (next == HTransportState::Undefined)
     {
         return HAvTransportInfo::TransitionNotAvailable;
     }
 
     qint32 rc = doStop();
-    h_ptr->m_info->setTransportState(HTransportState::Stopped);
+    h_ptr->setTransportState(next);
     return rc;
 }
 
@@ -406,26 +443,16 @@ qint32 HRendererConnection::pause()
 {
     HLOG(H_AT, H_FUN);
 
-    bool pausedPlaying = true;
-    switch(h_ptr->m_info->transportState().type())
-    {
-    case HTransportState::Playing:
-    case HTransportState::PausedPlayback:
-    case HTransportState::VendorDefined:
-        break;
-    case HTransportState::PausedRecording:
-    case HTransportState::Recording:
-        pausedPlaying = false;
-        break;
-    default:
+    HTransportState::Type next = h_ptr->transition(HTransportAction::Pause);
+    if (next == HTransportState::Undefined)
+    {
         return HAvTransportInfo::TransitionNotAvailable;
     }
 
     qint32 rc = doPause();
     if (rc == UpnpSuccess)
     {
-        h_ptr->m_info->setTransportState(pausedPlaying ?
-            HTransportState::PausedPlayback : HTransportState::PausedRecording);
+        h_ptr->setTransportState(next);
     }
     return rc;
 }
@@ -434,20 +461,16 @@ qint32 HRendererConnection::record()
 {
     HLOG(H_AT, H_FUN);
 
-    switch(h_ptr->m_info->transportState().type())
+    HTransportState::Type next = h_ptr->transition(HTransportAction::Record);
+    if (next == HTransportState::Undefined)
     {
-    case HTransportState::Stopped:
-    case HTransportState::PausedRecording:
-    case HTransportState::VendorDefined:
-        break;
-    default:
         return HAvTransportInfo::TransitionNotAvailable;
     }
 
     qint32 rc = doRecord();
     if (rc == UpnpSuccess)
     {
-        h_ptr->m_info->setTransportState(HTransportState::Recording);
+        h_ptr->setTransportState(next);
     }
     return rc;
 }
@@ -456,13 +479,9 @@ qint32 HRendererConnection::seek(const HSeekInfo& seekInfo)
 {
     HLOG(H_AT, H_FUN);
 
-    switch(h_ptr->m_info->transportState().type())
+    if (h_ptr->transition(HTransportAction::Seek) ==
+        HTransportState::Undefined)
     {
-    case HTransportState::Stopped:
-    case HTransportState::Playing:
-    case HTransportState::VendorDefined:
-        break;
-    default:
         return HAvTransportInfo::TransitionNotAvailable;
     }
 
@@ -478,13 +497,9 @@ qint32 HRendererConnection::next()
 {
     HLOG(H_AT, H_FUN);
 
-    switch(h_ptr->m_info->transportState().type())
+    if (h_ptr->transition(HTransportAction::Next) ==
+        HTransportState::Undefined)
     {
-    case HTransportState::Stopped:
-    case HTransportState::Playing:
-    case HTransportState::VendorDefined:
-        break;
-    default:
         return HAvTransportInfo::TransitionNotAvailable;
     }
 
@@ -500,13 +515,9 @@ qint32 HRendererConnection::previous()
 {
     HLOG(H_AT, H_FUN);
 
-    switch(h_ptr->m_info->transportState().type())
+    if (h_ptr->transition(HTransportAction::Previous) ==
+        HTransportState::Undefined)
     {
-    case HTransportState::Stopped:
-    case HTransportState::Playing:
-    case HTransportState::VendorDefined:
-        break;
-    default:
         return HAvTransportInfo::TransitionNotAvailable;
     }
 
@@ -592,7 +603,7 @@ qint32 HRendererConnection::setResource(
 
         if (h_ptr->m_info->transportState().type() == HTransportState::NoMediaPresent)
         {
-            h_ptr->m_info->setTransportState(HTransportState::Stopped);
+            h_ptr->setTransportState(HTransportState::Stopped);
         }
     }
 
@@ -636,6 +647,13 @@ qint32 HRendererConnection::setNextResource(
         mediaInfo.setNextUri(resourceUri);
         mediaInfo.setNextUriMetadata(resourceMetadata);
         h_ptr->m_info->setMediaInfo(mediaInfo);
+
+        // The next resource is downloaded while the current one is playing,
+        // which allows the implementation to switch to it without a gap.
+        if (h_ptr->m_mediaFetcher)
+        {
+            h_ptr->m_mediaFetcher->prefetch(resourceUri);
+        }
     }
 
     return rc;
@@ -722,6 +740,88 @@ qint32 HRendererConnection::setVolume(const HChannel& channel, quint16 volume)
         return HRenderingControlInfo::InvalidChannel;
     }
 
+    qint32 interval = h_ptr->m_volumeDebounceInterval;
+    if (interval > 0)
+    {
+        HRendererConnectionPrivate::VolumeState& state =
+            h_ptr->m_volumes[channel];
+
+        if (!state.m_lastApplied.isNull())
+        {
+            qint32 elapsed = state.m_lastApplied.elapsed();
+            if (elapsed >= 0 && elapsed < interval)
+            {
+                state.m_pending = true;
+                state.m_pendingVolume = volume;
+                if (!h_ptr->m_volumeTimer.isActive())
+                {
+                    h_ptr->m_volumeTimer.start(interval - elapsed);
+                }
+                return UpnpSuccess;
+            }
+        }
+
+        state.m_pending = false;
+        state.m_lastApplied.start();
+    }
+
+    return applyVolume(channel, volume);
+}
+
+void HRendererConnection::applyPendingVolumes()
+{
+    HLOG(H_AT, H_FUN);
+
+    qint32 interval = h_ptr->m_volumeDebounceInterval;
+    qint32 nextTimeout = -1;
+
+    QList<QPair<HChannel, quint16> > due;
+
+    QHash<HChannel, HRendererConnectionPrivate::VolumeState>::iterator it =
+        h_ptr->m_volumes.begin();
+
+    for(; it != h_ptr->m_volumes.end(); ++it)
+    {
+        HRendererConnectionPrivate::VolumeState& state = it.value();
+        if (!state.m_pending)
+        {
+            continue;
+        }
+
+        qint32 elapsed = state.m_lastApplied.elapsed();
+        qint32 remaining = interval - elapsed;
+        if (elapsed < 0 || remaining <= 0)
+        {
+            due.append(qMakePair(it.key(), state.m_pendingVolume));
+            state.m_pending = false;
+            state.m_lastApplied.start();
+        }
+        else if (nextTimeout < 0 || remaining < nextTimeout)
+        {
+            nextTimeout = remaining;
+        }
+    }
+
+    if (nextTimeout >= 0)
+    {
+        h_ptr->m_volumeTimer.start(nextTimeout);
+    }
+
+    for(qint32 i = 0; i < due.size(); ++i)
+    {
+        qint32 rc = applyVolume(due.at(i).first, due.at(i).second);
+        if (rc != UpnpSuccess)
+        {
+            HLOG_WARN(QString(
+                "Failed to apply the volume [%1] to channel: [%2]").arg(
+                    QString::number(due.at(i).second),
+                    due.at(i).first.toString()));
+        }
+    }
+}
+
+qint32 HRendererConnection::applyVolume(const HChannel& channel, quint16 volume)
+{
     qint32 rc = doSetVolume(channel, volume);
     if (rc == UpnpSuccess)
     {
@@ -74,6 +74,12 @@ private:
 
     void dispose();
 
+    qint32 applyVolume(const HChannel& channel, quint16 volume);
+
+private Q_SLOTS:
+
+    void applyPendingVolumes();
+
 protected:
 
     /*!
@@ -373,6 +379,54 @@ protected:
      */
     virtual void finalizeInit();
 
+    /*!
+     * \brief Returns an object that fetches the resources this connection
+     * renders.
+     *
+     * The object is created on the first call. Once it exists, every
+     * resource set with \c SetNextAVTransportURI is prefetched, which means
+     * that an implementation of doSetResource() or doNext() can get the
+     * resource with HMediaFetcher::open() and start rendering it without
+     * waiting for the download to start.
+     *
+     * \return an object that fetches the resources this connection renders.
+     * The ownership of the object is \b not transferred.
+     *
+     * \sa HMediaFetcher
+     */
+    HMediaFetcher* mediaFetcher();
+
+    /*!
+     * \brief Returns the minimum interval between two calls of doSetVolume()
+     * for the same channel.
+     *
+     * \return The minimum interval between two calls of doSetVolume()
+     * for the same channel in milliseconds. The default is 100.
+     *
+     * \sa setVolumeDebounceInterval()
+     */
+    qint32 volumeDebounceInterval() const;
+
+    /*!
+     * \brief Specifies the minimum interval between two calls of
+     * doSetVolume() for the same channel.
+     *
+     * A control point that follows a volume slider can set the volume dozens
+     * of times a second. A volume set after the channel has been idle for the
+     * interval is applied immediately, but the values set during the interval
+     * that follows are not. Instead, the latest of them is applied once the
+     * interval has passed. setVolume() succeeds for those values right away,
+     * and the rendererConnectionInfo() and the \c LastChange event
+     * are updated only when the value is applied. In case doSetVolume()
+     * fails for a deferred value, the failure is logged.
+     *
+     * \param msecs specifies the interval in milliseconds. Zero passes every
+     * call of setVolume() to doSetVolume() immediately.
+     *
+     * \sa volumeDebounceInterval()
+     */
+    void setVolumeDebounceInterval(qint32 msecs);
+
 public:
 
     /*!
@@ -30,6 +30,8 @@
 #include <HUpnpCore/private/hmisc_utils_p.h>
 
 #include <QtCore/QUrl>
+#include <QtCore/QHash>
+#include <QtCore/QtAlgorithms>
 #include <QtCore/QStringList>
 #include <QtCore/QMetaType>
 
@@ -168,12 +170,165 @@ bool operator==(const HRendererConnectionEventInfo& obj1, const HRendererConnect
 /*******************************************************************************
  * HRendererConnectionInfoPrivate
  ******************************************************************************/
+namespace
+{
+const HRendererConnectionProperty Properties[] =
+{
+    { "TransportState",
+      &HRendererConnectionInfoPrivate::setTransportState,
+      &HRendererConnectionInfoPrivate::getTransportState },
+    { "TransportStatus",
+      &HRendererConnectionInfoPrivate::setTransportStatus,
+      &HRendererConnectionInfoPrivate::getTransportStatus },
+    { "CurrentMediaCategory",
+      &HRendererConnectionInfoPrivate::setCurrentMediaCategory,
+      &HRendererConnectionInfoPrivate::getCurrentMediaCategory },
+    { "PlaybackStorageMedium",
+      &HRendererConnectionInfoPrivate::setPlaybackStorageMedium,
+      &HRendererConnectionInfoPrivate::getPlaybackStorageMedium },
+    { "RecordStorageMedium",
+      &HRendererConnectionInfoPrivate::setRecordStorageMedium,
+      &HRendererConnectionInfoPrivate::getRecordStorageMedium },
+    { "PossiblePlaybackStorageMedia",
+      &HRendererConnectionInfoPrivate::setPossiblePlaybackStorageMedia,
+      &HRendererConnectionInfoPrivate::getPossiblePlaybackStorageMedia },
+    { "PossibleRecordStorageMedia",
+      &HRendererConnectionInfoPrivate::setPossibleRecordStorageMedia,
+      &HRendererConnectionInfoPrivate::getPossibleRecordStorageMedia },
+    { "CurrentPlayMode",
+      &HRendererConnectionInfoPrivate::setCurrentPlayMode,
+      &HRendererConnectionInfoPrivate::getCurrentPlayMode },
+    { "TransportPlaySpeed",
+      &HRendererConnectionInfoPrivate::setTransportPlaySpeed,
+      &HRendererConnectionInfoPrivate::getTransportPlaySpeed },
+    { "RecordMediumWriteStatus",
+      &HRendererConnectionInfoPrivate::setRecordMediumWriteStatus,
+      &HRendererConnectionInfoPrivate::getRecordMediumWriteStatus },
+    { "CurrentRecordQualityMode",
+      &HRendererConnectionInfoPrivate::setCurrentRecordQualityMode,
+      &HRendererConnectionInfoPrivate::getCurrentRecordQualityMode },
+    { "PossibleRecordQualityModes",
+      &HRendererConnectionInfoPrivate::setPossibleRecordQualityModes,
+      &HRendererConnectionInfoPrivate::getPossibleRecordQualityModes },
+    { "NumberOfTracks",
+      &HRendererConnectionInfoPrivate::setNumberOfTracks,
+      &HRendererConnectionInfoPrivate::getNumberOfTracks },
+    { "CurrentTrack",
+      &HRendererConnectionInfoPrivate::setCurrentTrack,
+      &HRendererConnectionInfoPrivate::getCurrentTrack },
+    { "CurrentTrackDuration",
+      &HRendererConnectionInfoPrivate::setCurrentTrackDuration,
+      &HRendererConnectionInfoPrivate::getCurrentTrackDuration },
+    { "CurrentMediaDuration",
+      &HRendererConnectionInfoPrivate::setCurrentMediaDuration,
+      &HRendererConnectionInfoPrivate::getCurrentMediaDuration },
+    { "CurrentTrackMetaData",
+      &HRendererConnectionInfoPrivate::setCurrentTrackMetaData,
+      &HRendererConnectionInfoPrivate::getCurrentTrackMetaData },
+    { "CurrentTrackURI",
+      &HRendererConnectionInfoPrivate::setCurrentTrackURI,
+      &HRendererConnectionInfoPrivate::getCurrentTrackURI },
+    { "AVTransportURI",
+      &HRendererConnectionInfoPrivate::setAVTransportURI,
+      &HRendererConnectionInfoPrivate::getAVTransportURI },
+    { "AVTransportURIMetaData",
+      &HRendererConnectionInfoPrivate::setAVTransportURIMetaData,
+      &HRendererConnectionInfoPrivate::getAVTransportURIMetaData },
+    { "NextAVTransportURI",
+      &HRendererConnectionInfoPrivate::setNextAVTransportURI,
+      &HRendererConnectionInfoPrivate::getNextAVTransportURI },
+    { "NextAVTransportURIMetaData",
+      &HRendererConnectionInfoPrivate::setNextAVTransportURIMetaData,
+      &HRendererConnectionInfoPrivate::getNextAVTransportURIMetaData },
+    { "RelativeTimePosition",
+      &HRendererConnectionInfoPrivate::setRelativeTimePosition,
+      &HRendererConnectionInfoPrivate::getRelativeTimePosition },
+    { "AbsoluteTimePosition",
+      &HRendererConnectionInfoPrivate::setAbsoluteTimePosition,
+      &HRendererConnectionInfoPrivate::getAbsoluteTimePosition },
+    { "RelativeCounterPosition",
+      &HRendererConnectionInfoPrivate::setRelativeCounterPosition,
+      &HRendererConnectionInfoPrivate::getRelativeCounterPosition },
+    { "AbsoluteCounterPosition",
+      &HRendererConnectionInfoPrivate::setAbsoluteCounterPosition,
+      &HRendererConnectionInfoPrivate::getAbsoluteCounterPosition },
+    { "CurrentTransportActions",
+      &HRendererConnectionInfoPrivate::setCurrentTransportActions,
+      &HRendererConnectionInfoPrivate::getCurrentTransportActions },
+    { "DRMState",
+      &HRendererConnectionInfoPrivate::setDrmState,
+      &HRendererConnectionInfoPrivate::getDrmState },
+    { "Brightness",
+      &HRendererConnectionInfoPrivate::setBrightness,
+      &HRendererConnectionInfoPrivate::getBrightness },
+    { "Contrast",
+      &HRendererConnectionInfoPrivate::setContrast,
+      &HRendererConnectionInfoPrivate::getContrast },
+    { "Sharpness",
+      &HRendererConnectionInfoPrivate::setSharpness,
+      &HRendererConnectionInfoPrivate::getSharpness },
+    { "RedVideoGain",
+      &HRendererConnectionInfoPrivate::setRedVideoGain,
+      &HRendererConnectionInfoPrivate::getRedVideoGain },
+    { "GreenVideoGain",
+      &HRendererConnectionInfoPrivate::setGreenVideoGain,
+      &HRendererConnectionInfoPrivate::getGreenVideoGain },
+    { "BlueVideoGain",
+      &HRendererConnectionInfoPrivate::setBlueVideoGain,
+      &HRendererConnectionInfoPrivate::getBlueVideoGain },
+    { "RedVideoBlackLevel",
+      &HRendererConnectionInfoPrivate::setRedVideoBlackLevel,
+      &HRendererConnectionInfoPrivate::getRedVideoBlackLevel },
+    { "GreenVideoBlackLevel",
+      &HRendererConnectionInfoPrivate::setGreenVideoBlackLevel,
+      &HRendererConnectionInfoPrivate::getGreenVideoBlackLevel },
+    { "BlueVideoBlackLevel",
+      &HRendererConnectionInfoPrivate::setBlueVideoBlackLevel,
+      &HRendererConnectionInfoPrivate::getBlueVideoBlackLevel },
+    { "ColorTemperature",
+      &HRendererConnectionInfoPrivate::setColorTemperature,
+      &HRendererConnectionInfoPrivate::getColorTemperature },
+    { "HorizontalKeystone",
+      &HRendererConnectionInfoPrivate::setHorizontalKeystone,
+      &HRendererConnectionInfoPrivate::getHorizontalKeystone },
+    { "VerticalKeystone",
+      &HRendererConnectionInfoPrivate::setVerticalKeystone,
+      &HRendererConnectionInfoPrivate::getVerticalKeystone },
+    { "Mute",
+      &HRendererConnectionInfoPrivate::setMute,
+      &HRendererConnectionInfoPrivate::getMute },
+    { "Volume",
+      &HRendererConnectionInfoPrivate::setVolume,
+      &HRendererConnectionInfoPrivate::getVolume },
+    { "VolumeDB",
+      &HRendererConnectionInfoPrivate::setVolumeDB,
+      &HRendererConnectionInfoPrivate::getVolumeDB },
+    { "Loudness",
+      &HRendererConnectionInfoPrivate::setLoudness,
+      &HRendererConnectionInfoPrivate::getLoudness }
+};
+
+const int PropertyCount = sizeof(Properties) / sizeof(Properties[0]);
+
+QHash<QString, const HRendererConnectionProperty*> createPropertyIndex()
+{
+    QHash<QString, const HRendererConnectionProperty*> retVal;
+    for (int i = 0; i < PropertyCount; ++i)
+    {
+        retVal.insert(QString::fromLatin1(Properties[i].name), &Properties[i]);
+    }
+    return retVal;
+}
+
+const QHash<QString, const HRendererConnectionProperty*> PropertyIndex =
+    createPropertyIndex();
+}
+
 HRendererConnectionInfoPrivate::HRendererConnectionInfoPrivate() :
     q_ptr(0),
     m_parent(0),
-    m_valueSetters(),
-    m_valueGetters(),
-    m_transportActions(),
+    m_transportActions(HTransportAction::NoActions),
+    m_vendorTransportActions(),
     m_drmState(HAvTransportInfo::DrmState_Unknown),
     m_deviceCapabilities(),
     m_mediaInfo(),
@@ -181,107 +336,25 @@ HRendererConnectionInfoPrivate::HRendererConnectionInfoPrivate() :
     m_transportInfo(),
     m_transportSettings(),
     m_presets(),
-    m_rcsAttributes(),
     m_horizontalKeystone(0),
     m_verticalKeystone(0),
-    m_channelInfo()
-{
-    m_valueSetters.insert("TransportState", ValueSetter(this, &HRendererConnectionInfoPrivate::setTransportState));
-    m_valueSetters.insert("TransportStatus", ValueSetter(this, &HRendererConnectionInfoPrivate::setTransportStatus));
-    m_valueSetters.insert("CurrentMediaCategory", ValueSetter(this, &HRendererConnectionInfoPrivate::setCurrentMediaCategory));
-    m_valueSetters.insert("PlaybackStorageMedium", ValueSetter(this, &HRendererConnectionInfoPrivate::setPlaybackStorageMedium));
-    m_valueSetters.insert("RecordStorageMedium", ValueSetter(this, &HRendererConnectionInfoPrivate::setRecordStorageMedium));
-    m_valueSetters.insert("PossiblePlaybackStorageMedia", ValueSetter(this, &HRendererConnectionInfoPrivate::setPossiblePlaybackStorageMedia));
-    m_valueSetters.insert("PossibleRecordStorageMedia", ValueSetter(this, &HRendererConnectionInfoPrivate::setPossibleRecordStorageMedia));
-    m_valueSetters.insert("CurrentPlayMode", ValueSetter(this, &HRendererConnectionInfoPrivate::setCurrentPlayMode));
-    m_valueSetters.insert("TransportPlaySpeed", ValueSetter(this, &HRendererConnectionInfoPrivate::setTransportPlaySpeed));
-    m_valueSetters.insert("RecordMediumWriteStatus", ValueSetter(this, &HRendererConnectionInfoPrivate::setRecordMediumWriteStatus));
-    m_valueSetters.insert("CurrentRecordQualityMode", ValueSetter(this, &HRendererConnectionInfoPrivate::setCurrentRecordQualityMode));
-    m_valueSetters.insert("PossibleRecordQualityModes", ValueSetter(this, &HRendererConnectionInfoPrivate::setPossibleRecordQualityModes));
-    m_valueSetters.insert("NumberOfTracks", ValueSetter(this, &HRendererConnectionInfoPrivate::setNumberOfTracks));
-    m_valueSetters.insert("CurrentTrack", ValueSetter(this, &HRendererConnectionInfoPrivate::setCurrentTrack));
-    m_valueSetters.insert("CurrentTrackDuration", ValueSetter(this, &HRendererConnectionInfoPrivate::setCurrentTrackDuration));
-    m_valueSetters.insert("CurrentMediaDuration", ValueSetter(this, &HRendererConnectionInfoPrivate::setCurrentMediaDuration));
-    m_valueSetters.insert("CurrentTrackMetaData", ValueSetter(this, &HRendererConnectionInfoPrivate::setCurrentTrackMetaData));
-    m_valueSetters.insert("CurrentTrackURI", ValueSetter(this, &HRendererConnectionInfoPrivate::setCurrentTrackURI));
-    m_valueSetters.insert("AVTransportURI", ValueSetter(this, &HRendererConnectionInfoPrivate::setAVTransportURI));
-    m_valueSetters.insert("AVTransportURIMetaData", ValueSetter(this, &HRendererConnectionInfoPrivate::setAVTransportURIMetaData));
-    m_valueSetters.insert("NextAVTransportURI", ValueSetter(this, &HRendererConnectionInfoPrivate::setNextAVTransportURI));
-    m_valueSetters.insert("NextAVTransportURIMetaData", ValueSetter(this, &HRendererConnectionInfoPrivate::setNextAVTransportURIMetaData));
-    m_valueSetters.insert("RelativeTimePosition", ValueSetter(this, &HRendererConnectionInfoPrivate::setRelativeTimePosition));
-    m_valueSetters.insert("AbsoluteTimePosition", ValueSetter(this, &HRendererConnectionInfoPrivate::setAbsoluteTimePosition));
-    m_valueSetters.insert("RelativeCounterPosition", ValueSetter(this, &HRendererConnectionInfoPrivate::setRelativeCounterPosition));
-    m_valueSetters.insert("AbsoluteCounterPosition", ValueSetter(this, &HRendererConnectionInfoPrivate::setAbsoluteCounterPosition));
-    m_valueSetters.insert("CurrentTransportActions", ValueSetter(this, &HRendererConnectionInfoPrivate::setCurrentTransportActions));
-    m_valueSetters.insert("DRMState", ValueSetter(this, &HRendererConnectionInfoPrivate::setDrmState));
-
-    m_valueSetters.insert("Brightness", ValueSetter(this, &HRendererConnectionInfoPrivate::setBrightness));
-    m_valueSetters.insert("Contrast", ValueSetter(this, &HRendererConnectionInfoPrivate::setContrast));
-    m_valueSetters.insert("Sharpness", ValueSetter(this, &HRendererConnectionInfoPrivate::setSharpness));
-    m_valueSetters.insert("RedVideoGain", ValueSetter(this, &HRendererConnectionInfoPrivate::setRedVideoGain));
-    m_valueSetters.insert("GreenVideoGain", ValueSetter(this, &HRendererConnectionInfoPrivate::setGreenVideoGain));
-    m_valueSetters.insert("BlueVideoGain", ValueSetter(this, &HRendererConnectionInfoPrivate::setBlueVideoGain));
-    m_valueSetters.insert("RedVideoBlackLevel", ValueSetter(this, &HRendererConnectionInfoPrivate::setRedVideoBlackLevel));
-    m_valueSetters.insert("GreenVideoBlackLevel", ValueSetter(this, &HRendererConnectionInfoPrivate::setGreenVideoBlackLevel));
-    m_valueSetters.insert("BlueVideoBlackLevel", ValueSetter(this, &HRendererConnectionInfoPrivate::setBlueVideoBlackLevel));
-    m_valueSetters.insert("ColorTemperature", ValueSetter(this, &HRendererConnectionInfoPrivate::setColorTemperature));
-    m_valueSetters.insert("HorizontalKeystone", ValueSetter(this, &HRendererConnectionInfoPrivate::setHorizontalKeystone));
-    m_valueSetters.insert("VerticalKeystone", ValueSetter(this, &HRendererConnectionInfoPrivate::setVerticalKeystone));
-    m_valueSetters.insert("Mute", ValueSetter(this, &HRendererConnectionInfoPrivate::setMute));
-    m_valueSetters.insert("Volume", ValueSetter(this, &HRendererConnectionInfoPrivate::setVolume));
-    m_valueSetters.insert("VolumeDB", ValueSetter(this, &HRendererConnectionInfoPrivate::setVolumeDB));
-    m_valueSetters.insert("Loudness", ValueSetter(this, &HRendererConnectionInfoPrivate::setLoudness));
-
-    m_valueGetters.insert("TransportState", ValueGetter(this, &HRendererConnectionInfoPrivate::getTransportState));
-    m_valueGetters.insert("TransportStatus", ValueGetter(this, &HRendererConnectionInfoPrivate::getTransportStatus));
-    m_valueGetters.insert("CurrentMediaCategory", ValueGetter(this, &HRendererConnectionInfoPrivate::getCurrentMediaCategory));
-    m_valueGetters.insert("PlaybackStorageMedium", ValueGetter(this, &HRendererConnectionInfoPrivate::getPlaybackStorageMedium));
-    m_valueGetters.insert("RecordStorageMedium", ValueGetter(this, &HRendererConnectionInfoPrivate::getRecordStorageMedium));
-    m_valueGetters.insert("PossiblePlaybackStorageMedia", ValueGetter(this, &HRendererConnectionInfoPrivate::getPossiblePlaybackStorageMedia));
-    m_valueGetters.insert("PossibleRecordStorageMedia", ValueGetter(this, &HRendererConnectionInfoPrivate::getPossibleRecordStorageMedia));
-    m_valueGetters.insert("CurrentPlayMode", ValueGetter(this, &HRendererConnectionInfoPrivate::getCurrentPlayMode));
-    m_valueGetters.insert("TransportPlaySpeed", ValueGetter(this, &HRendererConnectionInfoPrivate::getTransportPlaySpeed));
-    m_valueGetters.insert("RecordMediumWriteStatus", ValueGetter(this, &HRendererConnectionInfoPrivate::getRecordMediumWriteStatus));
-    m_valueGetters.insert("CurrentRecordQualityMode", ValueGetter(this, &HRendererConnectionInfoPrivate::getCurrentRecordQualityMode));
-    m_valueGetters.insert("PossibleRecordQualityModes", ValueGetter(this, &HRendererConnectionInfoPrivate::getPossibleRecordQualityModes));
-    m_valueGetters.insert("NumberOfTracks", ValueGetter(this, &HRendererConnectionInfoPrivate::getNumberOfTracks));
-    m_valueGetters.insert("CurrentTrack", ValueGetter(this, &HRendererConnectionInfoPrivate::getCurrentTrack));
-    m_valueGetters.insert("CurrentTrackDuration", ValueGetter(this, &HRendererConnectionInfoPrivate::getCurrentTrackDuration));
-    m_valueGetters.insert("CurrentMediaDuration", ValueGetter(this, &HRendererConnectionInfoPrivate::getCurrentMediaDuration));
-    m_valueGetters.insert("CurrentTrackMetaData", ValueGetter(this, &HRendererConnectionInfoPrivate::getCurrentTrackMetaData));
-    m_valueGetters.insert("CurrentTrackURI", ValueGetter(this, &HRendererConnectionInfoPrivate::getCurrentTrackURI));
-    m_valueGetters.insert("AVTransportURI", ValueGetter(this, &HRendererConnectionInfoPrivate::getAVTransportURI));
-    m_valueGetters.insert("AVTransportURIMetaData", ValueGetter(this, &HRendererConnectionInfoPrivate::getAVTransportURIMetaData));
-    m_valueGetters.insert("NextAVTransportURI", ValueGetter(this, &HRendererConnectionInfoPrivate::getNextAVTransportURI));
-    m_valueGetters.insert("NextAVTransportURIMetaData", ValueGetter(this, &HRendererConnectionInfoPrivate::getNextAVTransportURIMetaData));
-    m_valueGetters.insert("RelativeTimePosition", ValueGetter(this, &HRendererConnectionInfoPrivate::getRelativeTimePosition));
-    m_valueGetters.insert("AbsoluteTimePosition", ValueGetter(this, &HRendererConnectionInfoPrivate::getAbsoluteTimePosition));
-    m_valueGetters.insert("RelativeCounterPosition", ValueGetter(this, &HRendererConnectionInfoPrivate::getRelativeCounterPosition));
-    m_valueGetters.insert("AbsoluteCounterPosition", ValueGetter(this, &HRendererConnectionInfoPrivate::getAbsoluteCounterPosition));
-    m_valueGetters.insert("CurrentTransportActions", ValueGetter(this, &HRendererConnectionInfoPrivate::getCurrentTransportActions));
-    m_valueGetters.insert("DRMState", ValueGetter(this, &HRendererConnectionInfoPrivate::getDrmState));
-
-    m_valueGetters.insert("Brightness", ValueGetter(this, &HRendererConnectionInfoPrivate::getBrightness));
-    m_valueGetters.insert("Contrast", ValueGetter(this, &HRendererConnectionInfoPrivate::getContrast));
-    m_valueGetters.insert("Sharpness", ValueGetter(this, &HRendererConnectionInfoPrivate::getSharpness));
-    m_valueGetters.insert("RedVideoGain", ValueGetter(this, &HRendererConnectionInfoPrivate::getRedVideoGain));
-    m_valueGetters.insert("GreenVideoGain", ValueGetter(this, &HRendererConnectionInfoPrivate::getGreenVideoGain));
-    m_valueGetters.insert("BlueVideoGain", ValueGetter(this, &HRendererConnectionInfoPrivate::getBlueVideoGain));
-    m_valueGetters.insert("RedVideoBlackLevel", ValueGetter(this, &HRendererConnectionInfoPrivate::getRedVideoBlackLevel));
-    m_valueGetters.insert("GreenVideoBlackLevel", ValueGetter(this, &HRendererConnectionInfoPrivate::getGreenVideoBlackLevel));
-    m_valueGetters.insert("BlueVideoBlackLevel", ValueGetter(this, &HRendererConnectionInfoPrivate::getBlueVideoBlackLevel));
-    m_valueGetters.insert("ColorTemperature", ValueGetter(this, &HRendererConnectionInfoPrivate::getColorTemperature));
-    m_valueGetters.insert("HorizontalKeystone", ValueGetter(this, &HRendererConnectionInfoPrivate::getHorizontalKeystone));
-    m_valueGetters.insert("VerticalKeystone", ValueGetter(this, &HRendererConnectionInfoPrivate::getVerticalKeystone));
-    m_valueGetters.insert("Mute", ValueGetter(this, &HRendererConnectionInfoPrivate::getMute));
-    m_valueGetters.insert("Volume", ValueGetter(this, &HRendererConnectionInfoPrivate::getVolume));
-    m_valueGetters.insert("VolumeDB", ValueGetter(this, &HRendererConnectionInfoPrivate::getVolumeDB));
-    m_valueGetters.insert("Loudness", ValueGetter(this, &HRendererConnectionInfoPrivate::getLoudness));
+    m_vendorChannels()
+{
+    qFill(m_rcsAttributes, m_rcsAttributes + RcsAttributeCount, 0);
+    qFill(m_channels, m_channels + HChannel::VendorDefined,
+          static_cast<HChannelInformation*>(0));
 }
 
 HRendererConnectionInfoPrivate::~HRendererConnectionInfoPrivate()
 {
-    qDeleteAll(m_channelInfo);
+    qDeleteAll(m_channels, m_channels + HChannel::VendorDefined);
+    qDeleteAll(m_vendorChannels);
+}
+
+const HRendererConnectionProperty* HRendererConnectionInfoPrivate::property(
+    const QString& name)
+{
+    return PropertyIndex.value(name);
 }
 
 HChannelInformation* HRendererConnectionInfoPrivate::checkAndAddChannel(const HChannel& channel)
@@ -295,7 +368,14 @@ HChannelInformation* HRendererConnectionInfoPrivate::checkAndAddChannel(const HC
     if (!info)
     {
         info = new HChannelInformation(channel);
-        m_channelInfo.append(info);
+        if (channel.type() == HChannel::VendorDefined)
+        {
+            m_vendorChannels.append(info);
+        }
+        else
+        {
+            m_channels[channel.type()] = info;
+        }
     }
 
     return info;
@@ -303,7 +383,13 @@ HChannelInformation* HRendererConnectionInfoPrivate::checkAndAddChannel(const HC
 
 HChannelInformation* HRendererConnectionInfoPrivate::getChannel(const HChannel& channel) const
 {
-    foreach(HChannelInformation* ch, m_channelInfo)
+    HChannel::Type type = channel.type();
+    if (type != HChannel::VendorDefined)
+    {
+        return type != HChannel::Undefined ? m_channels[type] : 0;
+    }
+
+    foreach(HChannelInformation* ch, m_vendorChannels)
     {
         if (channel == ch->channel())
         {
@@ -580,7 +666,16 @@ QString HRendererConnectionInfoPrivate::getCurrentMediaCategory(const HChannel&)
 
 QString HRendererConnectionInfoPrivate::getCurrentTransportActions(const HChannel&) const
 {
-    return strToCsvString(m_transportActions);
+    QString retVal = HTransportAction::toCsvString(m_transportActions);
+    if (!m_vendorTransportActions.isEmpty())
+    {
+        if (!retVal.isEmpty())
+        {
+            retVal.append(',');
+        }
+        retVal.append(strToCsvString(m_vendorTransportActions));
+    }
+    return retVal;
 }
 
 QString HRendererConnectionInfoPrivate::getDrmState(const HChannel&) const
@@ -715,52 +810,52 @@ QString HRendererConnectionInfoPrivate::getCurrentRecordQualityMode(const HChann
 
 QString HRendererConnectionInfoPrivate::getBrightness(const HChannel&) const
 {
-    return QString::number(m_rcsAttributes.value(HRendererConnectionInfo::Brightness));
+    return QString::number(m_rcsAttributes[HRendererConnectionInfo::Brightness]);
 }
 
 QString HRendererConnectionInfoPrivate::getContrast(const HChannel&) const
 {
-    return QString::number(m_rcsAttributes.value(HRendererConnectionInfo::Contrast));
+    return QString::number(m_rcsAttributes[HRendererConnectionInfo::Contrast]);
 }
 
 QString HRendererConnectionInfoPrivate::getSharpness(const HChannel&) const
 {
-    return QString::number(m_rcsAttributes.value(HRendererConnectionInfo::Sharpness));
+    return QString::number(m_rcsAttributes[HRendererConnectionInfo::Sharpness]);
 }
 
 QString HRendererConnectionInfoPrivate::getRedVideoGain(const HChannel&) const
 {
-    return QString::number(m_rcsAttributes.value(HRendererConnectionInfo::RedVideoGain));
+    return QString::number(m_rcsAttributes[HRendererConnectionInfo::RedVideoGain]);
 }
 
 QString HRendererConnectionInfoPrivate::getGreenVideoGain(const HChannel&) const
 {
-    return QString::number(m_rcsAttributes.value(HRendererConnectionInfo::GreenVideoGain));
+    return QString::number(m_rcsAttributes[HRendererConnectionInfo::GreenVideoGain]);
 }
 
 QString HRendererConnectionInfoPrivate::getBlueVideoGain(const HChannel&) const
 {
-    return QString::number(m_rcsAttributes.value(HRendererConnectionInfo::BlueVideoGain));
+    return QString::number(m_rcsAttributes[HRendererConnectionInfo::BlueVideoGain]);
 }
 
 QString HRendererConnectionInfoPrivate::getRedVideoBlackLevel(const HChannel&) const
 {
-    return QString::number(m_rcsAttributes.value(HRendererConnectionInfo::RedVideoBlackLevel));
+    return QString::number(m_rcsAttributes[HRendererConnectionInfo::RedVideoBlackLevel]);
 }
 
 QString HRendererConnectionInfoPrivate::getGreenVideoBlackLevel(const HChannel&) const
 {
-    return QString::number(m_rcsAttributes.value(HRendererConnectionInfo::GreenVideoBlackLevel));
+    return QString::number(m_rcsAttributes[HRendererConnectionInfo::GreenVideoBlackLevel]);
 }
 
 QString HRendererConnectionInfoPrivate::getBlueVideoBlackLevel(const HChannel&) const
 {
-    return QString::number(m_rcsAttributes.value(HRendererConnectionInfo::BlueVideoBlackLevel));
+    return QString::number(m_rcsAttributes[HRendererConnectionInfo::BlueVideoBlackLevel]);
 }
 
 QString HRendererConnectionInfoPrivate::getColorTemperature(const HChannel&) const
 {
-    return QString::number(m_rcsAttributes.value(HRendererConnectionInfo::ColorTemperature));
+    return QString::number(m_rcsAttributes[HRendererConnectionInfo::ColorTemperature]);
 }
 
 QString HRendererConnectionInfoPrivate::getHorizontalKeystone(const HChannel&) const
@@ -950,6 +1045,13 @@ qint32 HRendererConnectionInfo::absoluteCounterPosition() const
 }
 
 QSet<HTransportAction> HRendererConnectionInfo::currentTransportActions() const
+{
+    return HTransportAction::fromFlags(h_ptr->m_transportActions).unite(
+        h_ptr->m_vendorTransportActions);
+}
+
+HTransportAction::ActionFlags
+    HRendererConnectionInfo::currentTransportActionFlags() const
 {
     return h_ptr->m_transportActions;
 }
@@ -1033,7 +1135,11 @@ QString HRendererConnectionInfo::rcsAttributeToString(RcsAttribute arg)
 
 quint16 HRendererConnectionInfo::rcsValue(RcsAttribute attr) const
 {
-    return h_ptr->m_rcsAttributes.value(attr);
+    if (attr < 0 || attr >= HRendererConnectionInfoPrivate::RcsAttributeCount)
+    {
+        return 0;
+    }
+    return h_ptr->m_rcsAttributes[attr];
 }
 
 qint16 HRendererConnectionInfo::horizontalKeystone() const
@@ -1378,9 +1484,34 @@ void HRendererConnectionInfo::setAbsoluteCounterPosition(qint32 arg)
 void HRendererConnectionInfo::setCurrentTransportActions(
     const QSet<HTransportAction>& arg)
 {
-    if (arg != currentTransportActions())
+    QSet<HTransportAction> vendorActions;
+    foreach(const HTransportAction& action, arg)
+    {
+        if (action.type() == HTransportAction::VendorDefined)
+        {
+            vendorActions.insert(action);
+        }
+    }
+
+    HTransportAction::ActionFlags flags = HTransportAction::toFlags(arg);
+    if (flags != h_ptr->m_transportActions ||
+        vendorActions != h_ptr->m_vendorTransportActions)
+    {
+        h_ptr->m_transportActions = flags;
+        h_ptr->m_vendorTransportActions = vendorActions;
+        emit propertyChanged(this, HRendererConnectionEventInfo(
+            "CurrentTransportActions", h_ptr->getCurrentTransportActions()));
+    }
+}
+
+void HRendererConnectionInfo::setCurrentTransportActions(
+    HTransportAction::ActionFlags arg)
+{
+    if (arg != h_ptr->m_transportActions ||
+        !h_ptr->m_vendorTransportActions.isEmpty())
     {
         h_ptr->m_transportActions = arg;
+        h_ptr->m_vendorTransportActions.clear();
         emit propertyChanged(this, HRendererConnectionEventInfo(
             "CurrentTransportActions", h_ptr->getCurrentTransportActions()));
     }
@@ -1450,9 +1581,14 @@ void HRendererConnectionInfo::setPresets(const QSet<QString>& presets)
 
 void HRendererConnectionInfo::setRcsValue(RcsAttribute attr, quint16 value)
 {
-    if (h_ptr->m_rcsAttributes.value(attr) != value)
+    if (attr < 0 || attr >= HRendererConnectionInfoPrivate::RcsAttributeCount)
+    {
+        return;
+    }
+
+    if (h_ptr->m_rcsAttributes[attr] != value)
     {
-        h_ptr->m_rcsAttributes.insert(attr, value);
+        h_ptr->m_rcsAttributes[attr] = value;
         emit propertyChanged(this, HRendererConnectionEventInfo(
             rcsAttributeToString(attr), QString::number(value)));
     }
@@ -1546,11 +1682,12 @@ QString HRendererConnectionInfo::value(const QString& svName, bool* ok) const
 QString HRendererConnectionInfo::value(
     const QString& svName, const HChannel& channel, bool* ok) const
 {
-    if (h_ptr->m_valueGetters.contains(svName))
+    const HRendererConnectionProperty* prop =
+        HRendererConnectionInfoPrivate::property(svName);
+    if (prop)
     {
         if (ok) { *ok = true; }
-        ValueGetter getter = h_ptr->m_valueGetters.value(svName);
-        return getter(channel);
+        return (h_ptr->*prop->getter)(channel);
     }
 
     if (ok) { *ok = false; }
@@ -1565,10 +1702,11 @@ bool HRendererConnectionInfo::setValue(const QString& svName, const QString& val
 bool HRendererConnectionInfo::setValue(
     const QString& svName, const HChannel& channel, const QString& value)
 {
-    if (h_ptr->m_valueSetters.contains(svName))
+    const HRendererConnectionProperty* prop =
+        HRendererConnectionInfoPrivate::property(svName);
+    if (prop)
     {
-        ValueSetter setter = h_ptr->m_valueSetters.value(svName);
-        setter(value, channel);
+        (h_ptr->*prop->setter)(value, channel);
         return true;
     }
     return false;
@@ -25,6 +25,7 @@
 #include <HUpnpAv/HUpnpAv>
 #include <HUpnpAv/HMediaInfo>
 #include <HUpnpAv/HAvTransportInfo>
+#include <HUpnpAv/HTransportAction>
 
 #include <QtCore/QObject>
 
@@ -523,6 +524,18 @@ public:
      */
     QSet<HTransportAction> currentTransportActions() const;
 
+    /*!
+     * \brief Returns the standard transport actions that can be successfully
+     * invoked for the current resource.
+     *
+     * \return The standard transport actions that can be successfully
+     * invoked for the current resource. Vendor-defined actions are only
+     * included in currentTransportActions().
+     *
+     * \sa setCurrentTransportActions()
+     */
+    HTransportAction::ActionFlags currentTransportActionFlags() const;
+
     /*!
      * \brief Returns the current state of DRM-controlled content.
      *
@@ -1032,6 +1045,18 @@ public:
      */
     void setCurrentTransportActions(const QSet<HTransportAction>& arg);
 
+    /*!
+     * \brief Specifies the standard transport actions that can be
+     * successfully invoked for the current resource.
+     *
+     * \param arg specifies the standard transport actions that can be
+     * successfully invoked for the current resource. Any vendor-defined
+     * actions set earlier are removed.
+     *
+     * \sa currentTransportActionFlags()
+     */
+    void setCurrentTransportActions(HTransportAction::ActionFlags arg);
+
     /*!
      * \brief Specifies the current state of DRM-controlled content.
      *
@@ -48,11 +48,8 @@
 
 #include "../renderingcontrol/hchannel.h"
 
-#include <HUpnpCore/HFunctor>
-
 #include <QtCore/QSet>
 #include <QtCore/QList>
-#include <QtCore/QHash>
 
 namespace Herqq
 {
@@ -84,8 +81,24 @@ public:
     inline const HChannel& channel() const { return m_channel; }
 };
 
-typedef Functor<void, H_TYPELIST_2(const QString&, const HChannel&)> ValueSetter;
-typedef Functor<QString, H_TYPELIST_1(const HChannel&)> ValueGetter;
+class HRendererConnectionInfoPrivate;
+
+typedef void (HRendererConnectionInfoPrivate::*ValueSetter)(
+    const QString&, const HChannel&);
+
+typedef QString (HRendererConnectionInfoPrivate::*ValueGetter)(
+    const HChannel&) const;
+
+//
+// Describes a state variable that can be read and written through
+// HRendererConnectionInfo::value() and HRendererConnectionInfo::setValue().
+//
+struct HRendererConnectionProperty
+{
+    const char* name;
+    ValueSetter setter;
+    ValueGetter getter;
+};
 
 //
 //
@@ -190,14 +203,19 @@ public:
 
 public:
 
+    enum
+    {
+        RcsAttributeCount = HRendererConnectionInfo::ColorTemperature + 1
+    };
+
     HRendererConnectionInfo* q_ptr;
     HRendererConnection* m_parent;
 
-    QHash<QString, ValueSetter> m_valueSetters;
-    QHash<QString, ValueGetter> m_valueGetters;
-
     // AVT
-    QSet<HTransportAction> m_transportActions;
+    HTransportAction::ActionFlags m_transportActions;
+    QSet<HTransportAction> m_vendorTransportActions;
+    // the standard actions are kept as flags, which makes the value of
+    // CurrentTransportActions a lookup in most cases
     HAvTransportInfo::DrmState m_drmState;
     HDeviceCapabilities m_deviceCapabilities;
     HMediaInfo m_mediaInfo;
@@ -207,13 +225,19 @@ public:
 
     // RCS
     QSet<QString> m_presets;
-    QHash<HRendererConnectionInfo::RcsAttribute, quint16> m_rcsAttributes;
+    quint16 m_rcsAttributes[RcsAttributeCount];
+    // indexed by HRendererConnectionInfo::RcsAttribute
     qint16 m_horizontalKeystone, m_verticalKeystone;
-    QList<HChannelInformation*> m_channelInfo;
+    HChannelInformation* m_channels[HChannel::VendorDefined];
+    // indexed by HChannel::Type, the slot of HChannel::Undefined is never used
+    QList<HChannelInformation*> m_vendorChannels;
+    // vendor-defined channels are identified only by their names
 
     HRendererConnectionInfoPrivate();
     ~HRendererConnectionInfoPrivate();
 
+    static const HRendererConnectionProperty* property(const QString& name);
+
     HChannelInformation* checkAndAddChannel(const HChannel&);
     HChannelInformation* getChannel(const HChannel&) const;
 };
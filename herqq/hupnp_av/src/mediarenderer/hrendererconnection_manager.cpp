@@ -42,10 +42,87 @@ namespace Av
  * HRendererConnectionManagerPrivate
  ******************************************************************************/
 HRendererConnectionManagerPrivate::HRendererConnectionManagerPrivate() :
-    m_connections()
+    m_entries(), m_connections(), m_avTransports(), m_renderingControls(),
+    m_connectionsByService()
 {
 }
 
+void HRendererConnectionManagerPrivate::add(
+    HAbstractConnectionManagerService* cmService,
+    const HConnectionInfo& connectionInfo, HRendererConnection* connection)
+{
+    Entry entry = {
+        cmService, connectionInfo.connectionId(),
+        connectionInfo.avTransportId(), connectionInfo.rcsId() };
+
+    m_entries.insert(connection, entry);
+    m_connections.insert(
+        ConnectionKey(cmService, entry.m_connectionId), connection);
+
+    if (entry.m_avTransportId >= 0)
+    {
+        m_avTransports.insert(
+            ConnectionKey(cmService, entry.m_avTransportId), connection);
+    }
+    if (entry.m_rcsId >= 0)
+    {
+        m_renderingControls.insert(
+            ConnectionKey(cmService, entry.m_rcsId), connection);
+    }
+
+    m_connectionsByService[cmService].append(connection);
+}
+
+HRendererConnection* HRendererConnectionManagerPrivate::remove(
+    const HAbstractConnectionManagerService* cmService, qint32 cid)
+{
+    HRendererConnection* connection =
+        m_connections.value(ConnectionKey(cmService, cid));
+
+    if (connection)
+    {
+        remove(connection);
+    }
+
+    return connection;
+}
+
+HRendererConnectionManagerPrivate::Entry
+    HRendererConnectionManagerPrivate::remove(HRendererConnection* connection)
+{
+    Entry entry = m_entries.take(connection);
+    m_connections.remove(ConnectionKey(entry.m_cmService, entry.m_connectionId));
+
+    // the instance IDs are removed only if they still refer to this
+    // connection
+    ConnectionKey avtKey(entry.m_cmService, entry.m_avTransportId);
+    if (m_avTransports.value(avtKey) == connection)
+    {
+        m_avTransports.remove(avtKey);
+    }
+
+    ConnectionKey rcsKey(entry.m_cmService, entry.m_rcsId);
+    if (m_renderingControls.value(rcsKey) == connection)
+    {
+        m_renderingControls.remove(rcsKey);
+    }
+
+    QHash<const HAbstractConnectionManagerService*,
+          QList<HRendererConnection*> >::iterator it =
+              m_connectionsByService.find(entry.m_cmService);
+
+    if (it != m_connectionsByService.end())
+    {
+        it->removeOne(connection);
+        if (it->isEmpty())
+        {
+            m_connectionsByService.erase(it);
+        }
+    }
+
+    return entry;
+}
+
 /*******************************************************************************
  * HRendererConnectionManager
  ******************************************************************************/
@@ -62,16 +139,14 @@ HRendererConnectionManager::~HRendererConnectionManager()
 
 void HRendererConnectionManager::destroyed_(QObject* obj)
 {
-    Connections::iterator it = h_ptr->m_connections.begin();
-    for(; it != h_ptr->m_connections.end(); ++it)
+    // the object is being destroyed, so it is used only as a key
+    HRendererConnection* connection = static_cast<HRendererConnection*>(obj);
+    if (h_ptr->m_entries.contains(connection))
     {
-        if (it->second == obj)
-        {
-            qint32 cid = it->first.second;
-            h_ptr->m_connections.erase(it);
-            emit connectionRemoved(it->first.first, cid);
-            break;
-        }
+        HRendererConnectionManagerPrivate::Entry entry =
+            h_ptr->remove(connection);
+
+        emit connectionRemoved(entry.m_cmService, entry.m_connectionId);
     }
 }
 
@@ -104,8 +179,7 @@ HRendererConnection* HRendererConnectionManager::createAndAdd(
 
     connection->finalizeInit();
 
-    h_ptr->m_connections.append(
-        qMakePair(qMakePair(cmService, connectionInfo.connectionId()), connection));
+    h_ptr->add(cmService, connectionInfo, connection);
 
     emit connectionAdded(cmService, connectionInfo);
 
@@ -115,65 +189,45 @@ HRendererConnection* HRendererConnectionManager::createAndAdd(
 bool HRendererConnectionManager::removeConnection(
     const HAbstractConnectionManagerService* cmService, qint32 cid)
 {
-    Connections::iterator it;
-    for(it = h_ptr->m_connections.begin(); it != h_ptr->m_connections.end(); ++it)
-    {
-        Connection connection = *it;
-        if (connection.first.first == cmService && connection.first.second == cid)
-        {
-            h_ptr->m_connections.erase(it);
-            return true;
-        }
-    }
-
-    return false;
+    return h_ptr->remove(cmService, cid) != 0;
 }
 
 HRendererConnection* HRendererConnectionManager::connection(
     HAbstractConnectionManagerService* cmService, qint32 cid) const
 {
-    foreach(Connection connection, h_ptr->m_connections)
-    {
-        if (connection.first.first == cmService && connection.first.second == cid)
-        {
-            return connection.second;
-        }
-    }
-    return 0;
+    return h_ptr->m_connections.value(ConnectionKey(cmService, cid));
 }
 
-QList<HRendererConnection*> HRendererConnectionManager::connections(
-    HAbstractConnectionManagerService* cmService) const
+HRendererConnection* HRendererConnectionManager::connectionByAvTransportId(
+    HAbstractConnectionManagerService* cmService, qint32 avTransportId) const
 {
-    QList<HRendererConnection*> retVal;
+    return h_ptr->m_avTransports.value(ConnectionKey(cmService, avTransportId));
+}
 
-    foreach(Connection connection, h_ptr->m_connections)
-    {
-        if (connection.first.first == cmService)
-        {
-            retVal.append(connection.second);
-        }
-    }
+HRendererConnection* HRendererConnectionManager::connectionByRcsId(
+    HAbstractConnectionManagerService* cmService, qint32 rcsId) const
+{
+    return h_ptr->m_renderingControls.value(ConnectionKey(cmService, rcsId));
+}
 
-    return retVal;
+QList<HRendererConnection*> HRendererConnectionManager::connections(
+    HAbstractConnectionManagerService* cmService) const
+{
+    return h_ptr->m_connectionsByService.value(cmService);
 }
 
 bool HRendererConnectionManager::connectionComplete(
     HAbstractConnectionManagerService* cmService, qint32 connectionId)
 {
-    Connections::iterator it = h_ptr->m_connections.begin();
-    for(; it != h_ptr->m_connections.end(); ++it)
+    HRendererConnection* conn = h_ptr->remove(cmService, connectionId);
+    if (!conn)
     {
-        if (it->first.first == cmService && it->first.second == connectionId)
-        {
-            HRendererConnection* conn =  it->second;
-            h_ptr->m_connections.erase(it);
-            conn->dispose();
-            emit connectionRemoved(it->first.first, connectionId);
-            return true;
-        }
+        return false;
     }
-    return false;
+
+    conn->dispose();
+    emit connectionRemoved(cmService, connectionId);
+    return true;
 }
 
 }
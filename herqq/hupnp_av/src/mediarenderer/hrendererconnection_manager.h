@@ -140,6 +140,43 @@ public:
     HRendererConnection* connection(
         HAbstractConnectionManagerService* cmService, qint32 cid) const;
 
+    /*!
+     * Returns the HRendererConnection instance managed by this manager that
+     * uses the specified virtual AVTransport instance.
+     *
+     * \param cmService specifies the Connection Manager which owns the
+     * connection.
+     *
+     * \param avTransportId specifies the \c InstanceID of the AVTransport
+     * instance.
+     *
+     * \return the HRendererConnection instance that uses the specified
+     * AVTransport instance, or a null pointer if none does.
+     *
+     * \sa connectionByRcsId()
+     */
+    HRendererConnection* connectionByAvTransportId(
+        HAbstractConnectionManagerService* cmService,
+        qint32 avTransportId) const;
+
+    /*!
+     * Returns the HRendererConnection instance managed by this manager that
+     * uses the specified virtual RenderingControl instance.
+     *
+     * \param cmService specifies the Connection Manager which owns the
+     * connection.
+     *
+     * \param rcsId specifies the \c InstanceID of the RenderingControl
+     * instance.
+     *
+     * \return the HRendererConnection instance that uses the specified
+     * RenderingControl instance, or a null pointer if none does.
+     *
+     * \sa connectionByAvTransportId()
+     */
+    HRendererConnection* connectionByRcsId(
+        HAbstractConnectionManagerService* cmService, qint32 rcsId) const;
+
     /*!
      * Returns the connections owned by the specified Connection Manager.
      *
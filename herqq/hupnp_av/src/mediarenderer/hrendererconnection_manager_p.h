@@ -32,8 +32,9 @@
 
 #include <HUpnpAv/HUpnpAv>
 
+#include <QtCore/QHash>
+#include <QtCore/QList>
 #include <QtCore/QPair>
-#include <QtCore/QPointer>
 
 namespace Herqq
 {
@@ -44,21 +45,59 @@ namespace Upnp
 namespace Av
 {
 
-typedef QPair<QPair<HAbstractConnectionManagerService*, qint32>, HRendererConnection*> Connection;
-typedef QList<Connection> Connections;
+typedef QPair<const HAbstractConnectionManagerService*, qint32> ConnectionKey;
+// a Connection Manager and an ID it has assigned, which is a connection ID,
+// an AVTransport InstanceID or a RenderingControl InstanceID
 
 //
 // Implementation details of HRendererConnectionManager
 //
+// The connections are indexed by their connection IDs and by the IDs of the
+// virtual AVTransport and RenderingControl instances they use, as every
+// AVTransport and RenderingControl action is mapped to its connection.
+// The instance IDs are read from the connection information when the
+// connection is added, as they do not change during a connection.
+//
 class HRendererConnectionManagerPrivate
 {
 public:
 
-    Connections m_connections;
+    struct Entry
+    {
+        HAbstractConnectionManagerService* m_cmService;
+        qint32 m_connectionId;
+        qint32 m_avTransportId;
+        qint32 m_rcsId;
+    };
+
+    QHash<HRendererConnection*, Entry> m_entries;
+    // the keys are not dereferenced, as a connection is looked up from here
+    // while it is being destroyed
+
+    QHash<ConnectionKey, HRendererConnection*> m_connections;
+    QHash<ConnectionKey, HRendererConnection*> m_avTransports;
+    QHash<ConnectionKey, HRendererConnection*> m_renderingControls;
+    // the negative instance IDs, which are used when the connection does
+    // not have the service, are not indexed
+
+    QHash<const HAbstractConnectionManagerService*,
+          QList<HRendererConnection*> > m_connectionsByService;
+    // in the order the connections were added
 
 public:
 
     HRendererConnectionManagerPrivate();
+
+    void add(
+        HAbstractConnectionManagerService* cmService,
+        const HConnectionInfo& connectionInfo, HRendererConnection*);
+
+    // returns the removed connection, or null if it was not found
+    HRendererConnection* remove(
+        const HAbstractConnectionManagerService* cmService, qint32 cid);
+
+    // removes the connection from every index and returns its entry
+    Entry remove(HRendererConnection*);
 };
 
 }
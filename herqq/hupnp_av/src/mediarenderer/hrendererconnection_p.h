@@ -31,11 +31,16 @@
 //
 
 #include "hrendererconnection_info.h"
+#include "../transport/htransportstate.h"
+#include "../transport/htransportaction.h"
 #include "../connectionmanager/hconnectioninfo.h"
+#include "../renderingcontrol/hchannel.h"
 
 #include <HUpnpCore/HFunctor>
 
 #include <QtCore/QHash>
+#include <QtCore/QTime>
+#include <QtCore/QTimer>
 #include <QtCore/QString>
 
 namespace Herqq
@@ -77,6 +82,14 @@ public:
     bool setVolumeDB(const QString&, const HChannel&);
     bool setLoudness(const QString&, const HChannel&);
 
+    // sets the transport state and the CurrentTransportActions available
+    // in it
+    void setTransportState(HTransportState::Type state);
+
+    // returns the state the action leads to from the current state, or
+    // HTransportState::Undefined in case the action is not available
+    HTransportState::Type transition(HTransportAction::Type action) const;
+
 public:
 
     HRendererConnectionInfo* m_info;
@@ -85,6 +98,28 @@ public:
     HRendererConnection* q_ptr;
     QHash<QString, ValueSetter> m_valueSetters;
 
+    HMediaFetcher* m_mediaFetcher;
+    // created on demand. once created, the next resource is prefetched
+    // whenever it is set
+
+    struct VolumeState
+    {
+        QTime m_lastApplied;
+
+        bool m_pending;
+        quint16 m_pendingVolume;
+        // the latest of the values set since m_lastApplied, applied once
+        // the debounce interval has passed
+
+        VolumeState() : m_lastApplied(), m_pending(false), m_pendingVolume(0)
+        {
+        }
+    };
+
+    qint32 m_volumeDebounceInterval;
+    QHash<HChannel, VolumeState> m_volumes;
+    QTimer m_volumeTimer;
+
     HRendererConnectionPrivate();
     virtual ~HRendererConnectionPrivate();
 };
@@ -13,10 +13,15 @@ HEADERS += \
     $$SRC_LOC/mediarenderer/hrcs_lastchange_info.h \
     $$SRC_LOC/mediarenderer/habstractmediarenderer_device.h \
     $$SRC_LOC/mediarenderer/hmediarenderer_device_p.h \
+    $$SRC_LOC/mediarenderer/hlastchange_aggregator_p.h \
     $$SRC_LOC/mediarenderer/hmediarenderer_deviceconfiguration.h \
     $$SRC_LOC/mediarenderer/hmediarenderer_deviceconfiguration_p.h \
     $$SRC_LOC/mediarenderer/htransport_sinkservice_p.h \
-    $$SRC_LOC/mediarenderer/hconnectionmanager_sinkservice_p.h
+    $$SRC_LOC/mediarenderer/hconnectionmanager_sinkservice_p.h \
+    $$SRC_LOC/mediarenderer/hmedia_fetcher.h \
+    $$SRC_LOC/mediarenderer/hmedia_fetcher_p.h \
+    $$SRC_LOC/mediarenderer/hmedia_source.h \
+    $$SRC_LOC/mediarenderer/hmedia_source_p.h
 
 SOURCES += \
     $$SRC_LOC/mediarenderer/hmediarenderer_adapter.cpp \
@@ -29,6 +34,9 @@ SOURCES += \
     $$SRC_LOC/mediarenderer/hrendererconnection_manager.cpp \
     $$SRC_LOC/mediarenderer/habstractmediarenderer_device.cpp \
     $$SRC_LOC/mediarenderer/hmediarenderer_device_p.cpp \
+    $$SRC_LOC/mediarenderer/hlastchange_aggregator_p.cpp \
     $$SRC_LOC/mediarenderer/hmediarenderer_deviceconfiguration.cpp \
     $$SRC_LOC/mediarenderer/htransport_sinkservice_p.cpp \
-    $$SRC_LOC/mediarenderer/hconnectionmanager_sinkservice_p.cpp
+    $$SRC_LOC/mediarenderer/hconnectionmanager_sinkservice_p.cpp \
+    $$SRC_LOC/mediarenderer/hmedia_fetcher.cpp \
+    $$SRC_LOC/mediarenderer/hmedia_source.cpp
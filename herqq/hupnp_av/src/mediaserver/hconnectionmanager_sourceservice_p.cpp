@@ -20,6 +20,7 @@
  */
 
 #include "hconnectionmanager_sourceservice_p.h"
+#include "htranscoder.h"
 
 #include "../connectionmanager/hconnectioninfo.h"
 #include "../connectionmanager/hconnectionmanager_service_p.h"
@@ -36,8 +37,17 @@
 #include <HUpnpCore/private/hhttp_header_p.h>
 #include <HUpnpCore/private/hhttp_messagecreator_p.h>
 
+#include <QtCore/QFile>
+#include <QtCore/QSocketNotifier>
 #include <QtNetwork/QTcpSocket>
 
+#ifdef Q_OS_LINUX
+#include <sys/sendfile.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#endif
+
 namespace Herqq
 {
 
@@ -47,44 +57,280 @@ namespace Upnp
 namespace Av
 {
 
+namespace
+{
+
+enum RangeParseResult
+{
+    Range_None,
+    Range_Ok,
+    Range_Unsatisfiable
+};
+
+bool parseRangeValue(const QByteArray& str, qint64* value)
+{
+    if (str.isEmpty())
+    {
+        return false;
+    }
+
+    bool ok = false;
+    *value = str.toLongLong(&ok);
+    return ok && *value >= 0;
+}
+
+// Parses the value of a Range header that contains a single byte range.
+// In case the header is malformed or contains several ranges, it is ignored
+// and the entire entity is sent, which is allowed by RFC 2616, 14.35.1
+RangeParseResult parseRange(
+    const QByteArray& value, qint64 size, qint64* first, qint64* last)
+{
+    QByteArray spec = value.trimmed();
+    if (!spec.startsWith("bytes=") || spec.contains(','))
+    {
+        return Range_None;
+    }
+
+    spec = spec.mid(6).trimmed();
+    qint32 dashIndex = spec.indexOf('-');
+    if (dashIndex < 0)
+    {
+        return Range_None;
+    }
+
+    QByteArray firstStr = spec.left(dashIndex).trimmed();
+    QByteArray lastStr = spec.mid(dashIndex + 1).trimmed();
+
+    qint64 firstPos = 0, lastPos = 0;
+    if (firstStr.isEmpty())
+    {
+        // suffix-byte-range-spec, e.g. "bytes=-500" for the last 500 bytes
+        if (!parseRangeValue(lastStr, &lastPos))
+        {
+            return Range_None;
+        }
+        else if (lastPos == 0 || size == 0)
+        {
+            return Range_Unsatisfiable;
+        }
+
+        *first = qMax(Q_INT64_C(0), size - lastPos);
+        *last = size - 1;
+        return Range_Ok;
+    }
+
+    if (!parseRangeValue(firstStr, &firstPos))
+    {
+        return Range_None;
+    }
+
+    if (lastStr.isEmpty())
+    {
+        lastPos = size - 1;
+    }
+    else if (!parseRangeValue(lastStr, &lastPos))
+    {
+        return Range_None;
+    }
+    else if (lastPos < firstPos)
+    {
+        return Range_None;
+    }
+
+    if (firstPos >= size)
+    {
+        return Range_Unsatisfiable;
+    }
+
+    *first = firstPos;
+    *last = qMin(lastPos, size - 1);
+    return Range_Ok;
+}
+
+}
+
 HHttpStreamer::HHttpStreamer(
-    HMessagingInfo* mi, const QByteArray& header, QIODevice* data, QObject* parent) :
+    HMessagingInfo* mi, const QByteArray& header, QIODevice* data,
+    qint64 length, bool chunked, QObject* parent) :
         QObject(parent),
             m_bufSize(1024*64), m_buf(new char[m_bufSize]), m_dataToSend(data),
-            m_mi(mi), m_header(header), m_read(0), m_written(0)
+            m_mi(mi), m_header(header),
+            m_fileHandle(-1), m_socketHandle(-1), m_notifier(0),
+            m_offset(data->pos()), m_remaining(length),
+            m_chunked(chunked), m_sourceFinished(false), m_finished(false)
 {
     bool ok = connect(
         &m_mi->socket(), SIGNAL(bytesWritten(qint64)),
         this, SLOT(bytesWritten(qint64)));
     Q_ASSERT(ok); Q_UNUSED(ok)
+
+    if (m_dataToSend->isSequential())
+    {
+        ok = connect(
+            m_dataToSend, SIGNAL(readyRead()), this, SLOT(sourceReadyRead()));
+        Q_ASSERT(ok);
+
+        ok = connect(
+            m_dataToSend, SIGNAL(readChannelFinished()),
+            this, SLOT(sourceFinished()));
+        Q_ASSERT(ok);
+
+        return;
+    }
+
+#ifdef Q_OS_LINUX
+    QFile* file = qobject_cast<QFile*>(m_dataToSend);
+    if (file && !file->isSequential() && file->handle() >= 0)
+    {
+        m_fileHandle = file->handle();
+    }
+#endif
 }
 
 HHttpStreamer::~HHttpStreamer()
 {
+    delete m_notifier;
+#ifdef Q_OS_LINUX
+    if (m_socketHandle >= 0)
+    {
+        ::close(m_socketHandle);
+    }
+#endif
     delete m_mi;
     delete m_dataToSend;
-    delete m_buf;
+    delete[] m_buf;
 }
 
-void HHttpStreamer::bytesWritten(qint64 written)
+bool HHttpStreamer::startZeroCopy()
 {
     HLOG(H_AT, H_FUN);
 
-    if (m_dataToSend->atEnd())
+#ifdef Q_OS_LINUX
+    m_socketHandle = ::dup(m_mi->socket().socketDescriptor());
+    if (m_socketHandle < 0)
+    {
+        return false;
+    }
+
+    m_notifier = new QSocketNotifier(
+        m_socketHandle, QSocketNotifier::Write, this);
+
+    bool ok = connect(
+        m_notifier, SIGNAL(activated(int)), this, SLOT(socketWritable()));
+    Q_ASSERT(ok); Q_UNUSED(ok)
+
+    m_mi->socket().disconnect(this);
+
+    sendFileData();
+    return true;
+#else
+    return false;
+#endif
+}
+
+void HHttpStreamer::sendFileData()
+{
+#ifdef Q_OS_LINUX
+    while(m_remaining > 0)
+    {
+        off_t offset = m_offset;
+        ssize_t sent = ::sendfile(
+            m_socketHandle, m_fileHandle, &offset,
+            static_cast<size_t>(qMin(m_remaining, qint64(m_bufSize) * 16)));
+
+        if (sent < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            else if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                // the notifier informs once the socket is writable again
+                return;
+            }
+
+            HLOG_WARN(QString("Failed to send data: %1").arg(
+                QString::fromLocal8Bit(strerror(errno))));
+
+            break;
+        }
+        else if (sent == 0)
+        {
+            HLOG_WARN(QString("Failed to read data from the data source: "
+                "the file ended prematurely"));
+
+            break;
+        }
+
+        m_offset += sent;
+        m_remaining -= sent;
+    }
+
+    m_notifier->setEnabled(false);
+    deleteLater();
+#endif
+}
+
+void HHttpStreamer::socketWritable()
+{
+    sendFileData();
+}
+
+void HHttpStreamer::writeChunk(const char* data, qint64 size)
+{
+    if (m_chunked)
+    {
+        m_mi->socket().write(QByteArray::number(size, 16).append("\r\n"));
+    }
+
+    if (size > 0 && m_mi->socket().write(data, size) != size)
     {
+        HLOG_WARN(QString("Failed to send data: %1").arg(m_mi->socket().errorString()));
+        m_finished = true;
         deleteLater();
         return;
     }
-    else if (m_dataToSend->pos() > 0)
+
+    if (m_chunked)
     {
-        // We've past the HTTP header.
-        m_written += written;
+        m_mi->socket().write("\r\n");
     }
+}
+
+void HHttpStreamer::finish()
+{
+    m_finished = true;
 
-    if (m_written >= m_read)
+    if (m_chunked)
     {
-        m_read = m_dataToSend->read(m_buf, m_bufSize);
-        if (m_read <= 0)
+        // the last-chunk, which has the size of zero
+        writeChunk(0, 0);
+    }
+
+    if (m_mi->socket().bytesToWrite() == 0)
+    {
+        deleteLater();
+    }
+}
+
+void HHttpStreamer::sendSequentialData()
+{
+    while(!m_finished && m_mi->socket().bytesToWrite() <= m_bufSize)
+    {
+        qint64 read = m_dataToSend->read(m_buf, m_bufSize);
+        if (read > 0)
+        {
+            m_offset += read;
+            writeChunk(m_buf, read);
+        }
+        else if (read == 0 && !m_sourceFinished && !qobject_cast<QFile*>(m_dataToSend))
+        {
+            // wait for readyRead(). QFile does not emit that, but with
+            // a QFile reading zero bytes means that the end has been reached
+            break;
+        }
+        else if (read < 0 && !m_sourceFinished)
         {
             HLOG_WARN(QString("Failed to read data from the data source: [%1]").arg(
                 m_dataToSend->errorString()));
@@ -92,12 +338,84 @@ void HHttpStreamer::bytesWritten(qint64 written)
             deleteLater();
             return;
         }
+        else
+        {
+            finish();
+        }
+    }
+}
+
+void HHttpStreamer::sourceReadyRead()
+{
+    sendSequentialData();
+}
+
+void HHttpStreamer::sourceFinished()
+{
+    m_sourceFinished = true;
+    sendSequentialData();
+}
+
+void HHttpStreamer::bytesWritten(qint64)
+{
+    HLOG(H_AT, H_FUN);
+
+    if (m_finished)
+    {
+        if (m_mi->socket().bytesToWrite() == 0)
+        {
+            deleteLater();
+        }
+        return;
+    }
+    else if (m_dataToSend->isSequential())
+    {
+        sendSequentialData();
+        return;
+    }
+
+    if (m_fileHandle >= 0)
+    {
+        // the data written directly to the socket descriptor would get mixed
+        // with the header unless the socket has flushed its write buffer
+        if (m_mi->socket().bytesToWrite() == 0 && !startZeroCopy())
+        {
+            m_fileHandle = -1;
+        }
+        else
+        {
+            return;
+        }
+    }
+
+    if (m_mi->socket().bytesToWrite() > m_bufSize)
+    {
+        // wait for the socket to drain before reading more data
+        return;
+    }
+    else if (m_remaining <= 0)
+    {
+        if (m_mi->socket().bytesToWrite() == 0)
+        {
+            deleteLater();
+        }
+        return;
+    }
+
+    qint64 read = m_dataToSend->read(m_buf, qMin(m_remaining, qint64(m_bufSize)));
+    if (read <= 0)
+    {
+        HLOG_WARN(QString("Failed to read data from the data source: [%1]").arg(
+            m_dataToSend->errorString()));
 
-        m_written = 0;
+        deleteLater();
+        return;
     }
 
-    written = m_mi->socket().write(m_buf + m_written, m_read - m_written);
-    if (written == -1)
+    m_offset += read;
+    m_remaining -= read;
+
+    if (m_mi->socket().write(m_buf, read) != read)
     {
         HLOG_WARN(QString("Failed to send data: %1").arg(m_mi->socket().errorString()));
         deleteLater();
@@ -107,7 +425,6 @@ void HHttpStreamer::bytesWritten(qint64 written)
 void HHttpStreamer::send()
 {
     HLOG(H_AT, H_FUN);
-    Q_ASSERT(m_dataToSend->pos() == 0);
 
     qint64 wrote = m_mi->socket().write(m_header);
     if (wrote < m_header.size())
@@ -125,13 +442,349 @@ void HHttpStreamer::send()
  ******************************************************************************/
 HConnectionManagerHttpServer::HConnectionManagerHttpServer(
     const QByteArray& loggingId, HConnectionManagerSourceService* owner) :
-        HHttpServer(loggingId, owner), m_owner(owner)
+        HHttpServer(loggingId, owner), m_owner(owner), m_thumbnailRequests(),
+            m_mappedFiles(64 * 1024 * 1024)
 {
     Q_ASSERT(owner);
 }
 
 HConnectionManagerHttpServer::~HConnectionManagerHttpServer()
 {
+    foreach(const QList<ThumbnailRequest>& requests, m_thumbnailRequests)
+    {
+        foreach(const ThumbnailRequest& request, requests)
+        {
+            delete request.m_mi;
+        }
+    }
+}
+
+void HConnectionManagerHttpServer::addDlnaHeaders(
+    HHttpResponseHeader& respHdr, const HHttpRequestHeader& reqHdr, qint64 size,
+    const QString& profile)
+{
+    if (profile.isEmpty())
+    {
+        respHdr.setValue(HHttpHeader::Field_AcceptRanges, "bytes");
+    }
+
+    if (reqHdr.hasKey("getcontentFeatures.dlna.org"))
+    {
+        // DLNA.ORG_OP=01 informs that byte based seek is supported. the
+        // thumbnails are always sent whole and DLNA.ORG_CI=1 informs that
+        // they are converted from the original content.
+        respHdr.setValue(
+            "contentFeatures.dlna.org",
+            profile.isEmpty() ? QString("DLNA.ORG_OP=01;DLNA.ORG_CI=0") :
+                QString("DLNA.ORG_PN=%1;DLNA.ORG_OP=00;DLNA.ORG_CI=1").arg(
+                    profile));
+    }
+
+    if (profile.isEmpty() && size > 0 &&
+        reqHdr.hasKey("getAvailableSeekRange.dlna.org"))
+    {
+        respHdr.setValue(
+            "availableSeekRange.dlna.org",
+            QString("1 bytes=0-%1").arg(size - 1));
+    }
+}
+
+void HConnectionManagerHttpServer::sendThumbnail(
+    HMessagingInfo* mi, const HHttpRequestHeader& hdr,
+    HThumbnailCache::Profile profile, const QByteArray& jpeg)
+{
+    mi->setKeepAlive(true);
+
+    if (jpeg.isEmpty())
+    {
+        m_httpHandler->send(
+            mi, HHttpMessageCreator::createResponse(NotFound, *mi));
+        return;
+    }
+
+    HHttpResponseHeader respHdr = HHttpMessageCreator::createResponseHeader(Ok);
+    addDlnaHeaders(
+        respHdr, hdr, jpeg.size(), HThumbnailCache::profileName(profile));
+
+    m_httpHandler->send(
+        mi,
+        HHttpMessageCreator::setupData(
+            respHdr, jpeg, *mi, ContentType_ImageJpeg));
+}
+
+bool HConnectionManagerHttpServer::processThumbnailRequest(
+    HMessagingInfo* mi, const HHttpRequestHeader& hdr)
+{
+    // the thumbnails are published as <item id>/<DLNA profile name>
+    QString path = hdr.path();
+    qint32 index = path.lastIndexOf('/');
+
+    HThumbnailCache::Profile profile;
+    if (index <= 0 ||
+        !HThumbnailCache::profileFromName(path.mid(index + 1), &profile))
+    {
+        return false;
+    }
+
+    QString itemId = path.left(index).remove('/');
+
+    HThumbnailCache* cache = m_owner->m_thumbnailCache;
+    HItem* item = cache ? m_owner->m_dataSource->findItem(itemId) : 0;
+    QIODevice* dev = item ? m_owner->m_dataSource->loadItemData(itemId) : 0;
+    if (!dev || item->resources().isEmpty())
+    {
+        delete dev;
+        sendThumbnail(mi, hdr, profile, QByteArray());
+        return true;
+    }
+
+    QString key = HThumbnailCache::key(itemId, profile, dev);
+
+    QByteArray jpeg;
+    if (cache->find(key, &jpeg) || cache->hasFailed(key))
+    {
+        delete dev;
+        sendThumbnail(mi, hdr, profile, jpeg);
+        return true;
+    }
+
+    // the first resource describes the original content, since the
+    // thumbnails are always appended after it
+    QString contentFormat =
+        item->resources().at(0).protocolInfo().contentFormat();
+
+    if (!cache->generate(key, profile, dev, contentFormat))
+    {
+        sendThumbnail(mi, hdr, profile, QByteArray());
+        return true;
+    }
+
+    ThumbnailRequest request = { mi, hdr, profile };
+    m_thumbnailRequests[key].append(request);
+
+    return true;
+}
+
+void HConnectionManagerHttpServer::thumbnailReady(
+    const QString& key, const QByteArray& jpeg)
+{
+    QList<ThumbnailRequest> requests = m_thumbnailRequests.take(key);
+    foreach(const ThumbnailRequest& request, requests)
+    {
+        if (request.m_mi->socket().state() != QTcpSocket::ConnectedState)
+        {
+            // the client gave up while the thumbnail was being generated
+            delete request.m_mi;
+            continue;
+        }
+
+        sendThumbnail(request.m_mi, request.m_hdr, request.m_profile, jpeg);
+    }
+}
+
+void HConnectionManagerHttpServer::addTranscodeHeaders(
+    HHttpResponseHeader& respHdr, const HHttpRequestHeader& reqHdr,
+    const HTranscoder* transcoder, qint64 size)
+{
+    respHdr.setValue(
+        HHttpHeader::Field_ContentType,
+        transcoder->protocolInfo().contentFormat());
+
+    if (size >= 0)
+    {
+        respHdr.setValue(HHttpHeader::Field_AcceptRanges, "bytes");
+    }
+
+    if (reqHdr.hasKey("getcontentFeatures.dlna.org"))
+    {
+        // byte based seek is supported only once the content has been
+        // transcoded, since the length is not known before that
+        QString features;
+        QString profile = transcoder->protocolInfo().dlnaProfile();
+        if (!profile.isEmpty())
+        {
+            features = QString("DLNA.ORG_PN=%1;").arg(profile);
+        }
+
+        features.append(
+            size >= 0 ? "DLNA.ORG_OP=01;DLNA.ORG_CI=1" :
+                "DLNA.ORG_OP=00;DLNA.ORG_CI=1");
+
+        respHdr.setValue("contentFeatures.dlna.org", features);
+    }
+
+    if (size > 0 && reqHdr.hasKey("getAvailableSeekRange.dlna.org"))
+    {
+        respHdr.setValue(
+            "availableSeekRange.dlna.org",
+            QString("1 bytes=0-%1").arg(size - 1));
+    }
+}
+
+void HConnectionManagerHttpServer::sendTranscoded(
+    HMessagingInfo* mi, const HHttpRequestHeader& hdr,
+    const HTranscoder* transcoder, const QString& key, qint64 size)
+{
+    HTranscodeCache* cache = m_owner->m_transcodeCache;
+
+    if (size < 0)
+    {
+        // the content is sent as it is transcoded, which is why a range
+        // request is answered with the entire content
+        HHttpResponseHeader respHdr =
+            HHttpMessageCreator::createResponseHeader(Ok);
+
+        addTranscodeHeaders(respHdr, hdr, transcoder, -1);
+
+        mi->setKeepAlive(false);
+
+        bool chunked = hdr.minorVersion() > 0;
+        if (chunked)
+        {
+            respHdr.setValue(HHttpHeader::Field_TransferEncoding, "chunked");
+        }
+
+        HHttpStreamer* streamer =
+            new HHttpStreamer(
+                mi,
+                HHttpMessageCreator::setupData(
+                    respHdr, -1, *mi, ContentType_Undefined),
+                cache->open(key, 0, -1),
+                -1,
+                chunked,
+                this);
+
+        streamer->send();
+        return;
+    }
+
+    qint64 first = 0, last = size - 1;
+
+    RangeParseResult range = Range_None;
+    if (hdr.hasKey(HHttpHeader::Field_Range))
+    {
+        range = parseRange(
+            hdr.rawValue(HHttpHeader::Field_Range), size, &first, &last);
+    }
+
+    if (range == Range_Unsatisfiable || size == 0)
+    {
+        mi->setKeepAlive(true);
+
+        HHttpResponseHeader respHdr =
+            HHttpMessageCreator::createResponseHeader(
+                size == 0 ? Ok : RequestedRangeNotSatisfiable);
+
+        if (size > 0)
+        {
+            respHdr.setValue(
+                HHttpHeader::Field_ContentRange,
+                QByteArray("bytes */").append(QByteArray::number(size)));
+        }
+
+        m_httpHandler->send(
+            mi, HHttpMessageCreator::setupData(respHdr, *mi));
+
+        return;
+    }
+
+    qint64 length = last - first + 1;
+
+    HHttpResponseHeader respHdr =
+        HHttpMessageCreator::createResponseHeader(
+            range == Range_Ok ? PartialContent : Ok);
+
+    if (range == Range_Ok)
+    {
+        respHdr.setValue(
+            HHttpHeader::Field_ContentRange,
+            QByteArray("bytes ").append(QByteArray::number(first)).
+                append('-').append(QByteArray::number(last)).
+                append('/').append(QByteArray::number(size)));
+    }
+
+    addTranscodeHeaders(respHdr, hdr, transcoder, size);
+
+    mi->setKeepAlive(false);
+
+    // the segments that contain the range are read directly from the cache
+    HHttpStreamer* streamer =
+        new HHttpStreamer(
+            mi,
+            HHttpMessageCreator::setupData(
+                respHdr, length, *mi, ContentType_Undefined),
+            cache->open(key, first, length),
+            length,
+            false,
+            this);
+
+    streamer->send();
+}
+
+bool HConnectionManagerHttpServer::processTranscodeRequest(
+    HMessagingInfo* mi, const HHttpRequestHeader& hdr)
+{
+    // the transcoded content is published as <item id>/<profile name>
+    QString path = hdr.path();
+    qint32 index = path.lastIndexOf('/');
+
+    HTranscodeCache* cache = m_owner->m_transcodeCache;
+    HTranscoder* transcoder =
+        cache && index > 0 ? cache->transcoder(path.mid(index + 1)) : 0;
+
+    if (!transcoder)
+    {
+        return false;
+    }
+
+    QString itemId = path.left(index).remove('/');
+
+    HItem* item = m_owner->m_dataSource->findItem(itemId);
+    QIODevice* dev = item ? m_owner->m_dataSource->loadItemData(itemId) : 0;
+    if (!dev || item->resources().isEmpty())
+    {
+        delete dev;
+        mi->setKeepAlive(true);
+        m_httpHandler->send(
+            mi, HHttpMessageCreator::createResponse(NotFound, *mi));
+        return true;
+    }
+
+    QString key = HTranscodeCache::key(itemId, transcoder, dev);
+
+    qint64 size = -1;
+    if (cache->isComplete(key, &size))
+    {
+        delete dev;
+        sendTranscoded(mi, hdr, transcoder, key, size);
+        return true;
+    }
+
+    // the first resource describes the original content, since the
+    // transcoded resources are always appended after it
+    QString contentFormat =
+        item->resources().at(0).protocolInfo().contentFormat();
+
+    HTranscodeCache::StartResult result =
+        cache->start(key, transcoder, dev, contentFormat);
+
+    if (result != HTranscodeCache::Started)
+    {
+        mi->setKeepAlive(true);
+        m_httpHandler->send(
+            mi,
+            HHttpMessageCreator::createResponse(
+                result == HTranscodeCache::Busy ?
+                    ServiceUnavailable : InternalServerError,
+                *mi));
+
+        return true;
+    }
+
+    sendTranscoded(
+        mi, hdr, transcoder, key, cache->isComplete(key, &size) ? size : -1);
+
+    return true;
 }
 
 void HConnectionManagerHttpServer::incomingUnknownGetRequest(
@@ -139,33 +792,154 @@ void HConnectionManagerHttpServer::incomingUnknownGetRequest(
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
+    if (processThumbnailRequest(mi, hdr) || processTranscodeRequest(mi, hdr))
+    {
+        return;
+    }
+
+    // the small files that are served repeatedly, such as photos, are kept
+    // mapped to memory, which is why a cached item is sent without opening
+    // or reading the file
+    QString itemId = hdr.path().remove('/');
+    HMappedFileCache::Region* region = m_mappedFiles.acquire(itemId);
+
     QScopedPointer<QIODevice> dev(
-        m_owner->m_dataSource->loadItemData(hdr.path().remove('/')));
+        region ? 0 : m_owner->m_dataSource->loadItemData(itemId));
 
-    if (dev)
+    if (region || dev)
     {
-        if (dev->isSequential())
+        if (!region && dev->isSequential())
         {
-            // TODO send in chunks
-            Q_ASSERT_X(false, "", "Currently sequential data sources are not supported");
+            // the length of the data is unknown. HTTP/1.0 clients do not
+            // understand the chunked transfer coding and they get the data
+            // until the connection is closed.
+            HHttpResponseHeader respHdr =
+                HHttpMessageCreator::createResponseHeader(Ok);
+
+            // the streamer closes the connection once done, which has to be
+            // announced to clients that may have pipelined further requests
+            mi->setKeepAlive(false);
+
+            bool chunked = hdr.minorVersion() > 0;
+            if (chunked)
+            {
+                respHdr.setValue(HHttpHeader::Field_TransferEncoding, "chunked");
+            }
+
+            HHttpStreamer* streamer =
+                new HHttpStreamer(
+                    mi,
+                    HHttpMessageCreator::setupData(
+                        respHdr, -1, *mi, ContentType_Undefined), // TODO content type
+                    dev.take(),
+                    -1,
+                    chunked,
+                    this);
+
+            streamer->send();
+            return;
+        }
+
+        qint64 size = region ? region->size() : dev->size();
+        qint64 first = 0, last = size - 1;
+
+        RangeParseResult range = Range_None;
+        if (hdr.hasKey(HHttpHeader::Field_Range))
+        {
+            range = parseRange(
+                hdr.rawValue(HHttpHeader::Field_Range), size, &first, &last);
+        }
+
+        if (range == Range_Unsatisfiable)
+        {
+            if (region)
+            {
+                m_mappedFiles.release(region);
+            }
+
+            mi->setKeepAlive(true);
+
+            HHttpResponseHeader respHdr =
+                HHttpMessageCreator::createResponseHeader(
+                    RequestedRangeNotSatisfiable);
+
+            respHdr.setValue(
+                HHttpHeader::Field_ContentRange,
+                QByteArray("bytes */").append(QByteArray::number(size)));
+
+            m_httpHandler->send(
+                mi, HHttpMessageCreator::setupData(respHdr, *mi));
+
+            return;
+        }
+        else if (!region && range == Range_Ok && first > 0 && !dev->seek(first))
+        {
+            mi->setKeepAlive(true);
+            m_httpHandler->send(
+                mi, HHttpMessageCreator::createResponse(InternalServerError, *mi));
+
+            return;
+        }
+
+        qint64 length = last - first + 1;
+
+        HHttpResponseHeader respHdr =
+            HHttpMessageCreator::createResponseHeader(
+                range == Range_Ok ? PartialContent : Ok);
+
+        if (range == Range_Ok)
+        {
+            respHdr.setValue(
+                HHttpHeader::Field_ContentRange,
+                QByteArray("bytes ").append(QByteArray::number(first)).
+                    append('-').append(QByteArray::number(last)).
+                    append('/').append(QByteArray::number(size)));
         }
-        else if (dev->size() < maxBytesToLoad())
+
+        addDlnaHeaders(respHdr, hdr, size);
+
+        if (region || length < maxBytesToLoad())
         {
-            QByteArray data = dev->readAll();
+            QFile* file = qobject_cast<QFile*>(dev.data());
+            if (!region && file && size < maxBytesToLoad())
+            {
+                region = m_mappedFiles.insert(itemId, file);
+                if (region)
+                {
+                    dev.take();
+                }
+            }
+
+            // the data of a mapped file is copied only once, directly to
+            // the message that is sent
+            QByteArray data = region ?
+                QByteArray::fromRawData(
+                    region->data() + first, static_cast<int>(length)) :
+                dev->read(length);
+
             mi->setKeepAlive(true);
             m_httpHandler->send(
                 mi,
-                HHttpMessageCreator::createResponse(
-                    Ok, *mi, data, ContentType_Undefined)); // TODO content type
+                HHttpMessageCreator::setupData(
+                    respHdr, data, *mi, ContentType_Undefined)); // TODO content type
+
+            if (region)
+            {
+                m_mappedFiles.release(region);
+            }
         }
         else
         {
+            mi->setKeepAlive(false);
+
             HHttpStreamer* streamer =
                 new HHttpStreamer(
                     mi,
-                    HHttpMessageCreator::createHeaderData(
-                        Ok, *mi, dev->size(), ContentType_Undefined), // TODO content type
+                    HHttpMessageCreator::setupData(
+                        respHdr, length, *mi, ContentType_Undefined), // TODO content type
                     dev.take(),
+                    length,
+                    false,
                     this);
 
             streamer->send();
@@ -186,7 +960,8 @@ HConnectionManagerSourceService::HConnectionManagerSourceService(
         HConnectionManagerService(),
             m_dataSource(0),
             m_httpServer(new HConnectionManagerHttpServer(
-                h_ptr->m_loggingIdentifier, this))
+                h_ptr->m_loggingIdentifier, this)),
+            m_thumbnailCache(0), m_transcodeCache(0)
 {
     Q_ASSERT_X(dataSource, "", "Valid HCdsDataSource has to be provided");
     m_dataSource = dataSource;
@@ -195,6 +970,8 @@ HConnectionManagerSourceService::HConnectionManagerSourceService(
 HConnectionManagerSourceService::~HConnectionManagerSourceService()
 {
     HLOG2(H_AT, H_FUN, h_ptr->m_loggingIdentifier);
+    delete m_thumbnailCache;
+    delete m_transcodeCache;
     delete m_httpServer;
 }
 
@@ -205,7 +982,7 @@ bool HConnectionManagerSourceService::finalizeInit(QString* /*errDescription*/)
         setSourceProtocolInfo(HProtocolInfo("http-get:*:*:*"));
     }
 
-    if (connectionIds().isEmpty())
+    if (connectionCount() == 0)
     {
         createDefaultConnection(sourceProtocolInfo().at(0));
     }
@@ -220,6 +997,12 @@ bool HConnectionManagerSourceService::finalizeInit(QString* /*errDescription*/)
         this, SLOT(containerModified(Herqq::Upnp::Av::HContainer*, Herqq::Upnp::Av::HContainerEventInfo)));
     Q_ASSERT(ok);
 
+    ok = connect(
+        m_dataSource,
+        SIGNAL(bulkUpdateFinished(QStringList,QStringList,QStringList)),
+        this, SLOT(bulkUpdateFinished(QStringList,QStringList,QStringList)));
+    Q_ASSERT(ok);
+
     return true;
 }
 
@@ -244,6 +1027,20 @@ void HConnectionManagerSourceService::containerModified(
     }
 }
 
+void HConnectionManagerSourceService::bulkUpdateFinished(
+    const QStringList& addedIds, const QStringList& /*modifiedIds*/,
+    const QStringList& /*containerIds*/)
+{
+    foreach(const QString& id, addedIds)
+    {
+        HItem* item = m_dataSource->findItem(id);
+        if (item)
+        {
+            addLocation(item);
+        }
+    }
+}
+
 void HConnectionManagerSourceService::addLocation(HItem* item)
 {
     QList<QUrl> rootUrls = m_httpServer->rootUrls();
@@ -294,9 +1091,90 @@ void HConnectionManagerSourceService::addLocation(HItem* item)
         }
     }
 
+    addThumbnailLocations(item, &resources, rootUrls[0]);
+    addTranscodeLocations(item, &resources, rootUrls[0]);
+
     item->setResources(resources);
 }
 
+void HConnectionManagerSourceService::addThumbnailLocations(
+    HItem* item, HResources* resources, const QUrl& rootUrl)
+{
+    if (!m_thumbnailCache || resources->isEmpty() ||
+        !m_thumbnailCache->supports(
+            resources->at(0).protocolInfo().contentFormat()))
+    {
+        return;
+    }
+
+    HThumbnailCache::Profile profiles[] =
+    {
+        HThumbnailCache::JpegTn, HThumbnailCache::JpegSm
+    };
+
+    for(int i = 0; i < 2; ++i)
+    {
+        QString name = HThumbnailCache::profileName(profiles[i]);
+        QString suffix = QString("/%1/%2").arg(item->id(), name);
+
+        bool exists = false;
+        foreach(const HResource& resource, *resources)
+        {
+            if (resource.location().path().endsWith(suffix))
+            {
+                exists = true;
+                break;
+            }
+        }
+
+        if (!exists)
+        {
+            HProtocolInfo pi(
+                "http-get", "*", "image/jpeg",
+                QString("DLNA.ORG_PN=%1;DLNA.ORG_CI=1").arg(name));
+
+            resources->append(
+                HResource(QUrl(rootUrl.toString().append(suffix)), pi));
+        }
+    }
+}
+
+void HConnectionManagerSourceService::addTranscodeLocations(
+    HItem* item, HResources* resources, const QUrl& rootUrl)
+{
+    if (!m_transcodeCache || resources->isEmpty())
+    {
+        return;
+    }
+
+    QList<HTranscoder*> transcoders = m_transcodeCache->transcoders(
+        resources->at(0).protocolInfo().contentFormat());
+
+    foreach(HTranscoder* transcoder, transcoders)
+    {
+        QString suffix = QString("/%1/%2").arg(item->id(), transcoder->name());
+
+        bool exists = false;
+        foreach(const HResource& resource, *resources)
+        {
+            if (resource.location().path().endsWith(suffix))
+            {
+                exists = true;
+                break;
+            }
+        }
+
+        if (!exists)
+        {
+            HProtocolInfo pi = transcoder->protocolInfo();
+            pi.setProtocol("http-get");
+
+            resources->append(
+                HResource(QUrl(rootUrl.toString().append(suffix)), pi));
+        }
+    }
+}
+
 bool HConnectionManagerSourceService::init()
 {
     HLOG2(H_AT, H_FUN, h_ptr->m_loggingIdentifier);
@@ -325,6 +1203,30 @@ bool HConnectionManagerSourceService::isInitialized() const
     return m_httpServer->isInitialized();
 }
 
+void HConnectionManagerSourceService::setThumbnailCache(HThumbnailCache* cache)
+{
+    Q_ASSERT(!isInitialized());
+
+    delete m_thumbnailCache;
+    m_thumbnailCache = cache;
+
+    if (m_thumbnailCache)
+    {
+        bool ok = connect(
+            m_thumbnailCache, SIGNAL(thumbnailReady(QString,QByteArray)),
+            m_httpServer, SLOT(thumbnailReady(QString,QByteArray)));
+        Q_ASSERT(ok); Q_UNUSED(ok)
+    }
+}
+
+void HConnectionManagerSourceService::setTranscodeCache(HTranscodeCache* cache)
+{
+    Q_ASSERT(!isInitialized());
+
+    delete m_transcodeCache;
+    m_transcodeCache = cache;
+}
+
 }
 }
 }
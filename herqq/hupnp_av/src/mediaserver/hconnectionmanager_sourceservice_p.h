@@ -30,9 +30,15 @@
 // change or the file may be removed without of notice.
 //
 
+#include "hthumbnail_cache_p.h"
+#include "htranscode_cache_p.h"
+#include "hmapped_file_cache_p.h"
 #include "../connectionmanager/hconnectionmanager_service_p.h"
 
 #include <HUpnpCore/private/hhttp_server_p.h>
+#include <HUpnpCore/private/hhttp_header_p.h>
+
+class QSocketNotifier;
 
 namespace Herqq
 {
@@ -46,7 +52,17 @@ namespace Av
 {
 
 //
+// Sends an HTTP header followed by the specified number of bytes read from
+// a QIODevice, starting from the current position of the device.
+//
+// When the device is a QFile on Linux, the contents are sent with sendfile(),
+// which copies the data from the page cache to the socket without passing it
+// through user space. Otherwise, the data is copied through a buffer.
 //
+// Sequential devices are read until they end and, if requested, the data is
+// sent using the chunked transfer coding. Reading is paused whenever the
+// socket has more than a buffer's worth of data waiting to be written, which
+// keeps the memory use constant regardless of the length of the stream.
 //
 class HHttpStreamer :
     public QObject
@@ -56,6 +72,10 @@ Q_OBJECT
 private Q_SLOTS:
 
     void bytesWritten(qint64 written);
+    void socketWritable();
+
+    void sourceReadyRead();
+    void sourceFinished();
 
 private:
 
@@ -66,14 +86,36 @@ private:
     HMessagingInfo* m_mi;
     QByteArray m_header;
 
-    qint64 m_read;
-    qint64 m_written;
+    int m_fileHandle;
+    // the handle of the file that is sent using sendfile(), or -1 in case
+    // the data is copied through m_buf
+
+    int m_socketHandle;
+    // a duplicate of the socket descriptor, which is used with sendfile() and
+    // m_notifier so that the socket engine of the QTcpSocket is not disturbed
+
+    QSocketNotifier* m_notifier;
+
+    qint64 m_offset;
+    qint64 m_remaining;
+    // the position of the next byte to send and the number of bytes left
+
+    bool m_chunked;
+    bool m_sourceFinished;
+    bool m_finished;
+
+    bool startZeroCopy();
+    void sendFileData();
+
+    void sendSequentialData();
+    void writeChunk(const char* data, qint64 size);
+    void finish();
 
 public:
 
     HHttpStreamer(
         HMessagingInfo*, const QByteArray& header, QIODevice* data,
-        QObject* parent = 0);
+        qint64 length, bool chunked, QObject* parent = 0);
 
     virtual ~HHttpStreamer();
 
@@ -92,10 +134,47 @@ class HConnectionManagerHttpServer :
 Q_OBJECT
 H_DISABLE_COPY(HConnectionManagerHttpServer)
 
+private Q_SLOTS:
+
+    void thumbnailReady(const QString& key, const QByteArray& jpeg);
+
 private:
 
+    struct ThumbnailRequest
+    {
+        HMessagingInfo* m_mi;
+        HHttpRequestHeader m_hdr;
+        HThumbnailCache::Profile m_profile;
+    };
+
     HConnectionManagerSourceService* m_owner;
 
+    QHash<QString, QList<ThumbnailRequest> > m_thumbnailRequests;
+    // the requests waiting for a thumbnail to be generated, keyed with the
+    // cache key of the thumbnail
+
+    HMappedFileCache m_mappedFiles;
+    // the small files that have been served recently
+
+    void addDlnaHeaders(
+        HHttpResponseHeader&, const HHttpRequestHeader&, qint64 size,
+        const QString& profile = QString());
+
+    bool processThumbnailRequest(HMessagingInfo*, const HHttpRequestHeader&);
+    bool processTranscodeRequest(HMessagingInfo*, const HHttpRequestHeader&);
+
+    void addTranscodeHeaders(
+        HHttpResponseHeader&, const HHttpRequestHeader&, const HTranscoder*,
+        qint64 size);
+
+    void sendTranscoded(
+        HMessagingInfo*, const HHttpRequestHeader&, const HTranscoder*,
+        const QString& key, qint64 size);
+    // the size is -1 in case the content is still being transcoded
+    void sendThumbnail(
+        HMessagingInfo*, const HHttpRequestHeader&, HThumbnailCache::Profile,
+        const QByteArray& jpeg);
+
 protected:
 
     virtual void incomingUnknownGetRequest(
@@ -129,6 +208,10 @@ private Q_SLOTS:
     void containerModified(
         Herqq::Upnp::Av::HContainer*, const Herqq::Upnp::Av::HContainerEventInfo&);
 
+    void bulkUpdateFinished(
+        const QStringList& addedIds, const QStringList& modifiedIds,
+        const QStringList& containerIds);
+
 private:
 
     HAbstractCdsDataSource* m_dataSource;
@@ -136,7 +219,15 @@ private:
 
     HConnectionManagerHttpServer* m_httpServer;
 
+    HThumbnailCache* m_thumbnailCache;
+    // owned, null in case thumbnails are not published
+
+    HTranscodeCache* m_transcodeCache;
+    // owned, null in case transcoded content is not published
+
     void addLocation(HItem*);
+    void addThumbnailLocations(HItem*, HResources*, const QUrl& rootUrl);
+    void addTranscodeLocations(HItem*, HResources*, const QUrl& rootUrl);
 
 protected:
 
@@ -149,6 +240,12 @@ public:
 
     bool init();
     bool isInitialized() const;
+
+    void setThumbnailCache(HThumbnailCache*);
+    // takes the ownership. has to be called before init()
+
+    void setTranscodeCache(HTranscodeCache*);
+    // takes the ownership. has to be called before init()
 };
 
 }
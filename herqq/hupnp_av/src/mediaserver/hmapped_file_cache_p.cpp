@@ -0,0 +1,180 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hmapped_file_cache_p.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+/*******************************************************************************
+ * HMappedFileCache::Region
+ ******************************************************************************/
+HMappedFileCache::Region::Region() :
+    m_itemId(), m_file(0), m_data(0), m_size(0), m_lastModified(), m_refs(0),
+    m_lastUse(0), m_cached(false)
+{
+}
+
+HMappedFileCache::Region::~Region()
+{
+    if (m_file)
+    {
+        if (m_data)
+        {
+            m_file->unmap(m_data);
+        }
+        delete m_file;
+    }
+}
+
+/*******************************************************************************
+ * HMappedFileCache
+ ******************************************************************************/
+HMappedFileCache::HMappedFileCache(qint64 maxBytes) :
+    m_regions(), m_lru(), m_mappedBytes(0), m_maxBytes(maxBytes),
+    m_useCounter(0)
+{
+}
+
+HMappedFileCache::~HMappedFileCache()
+{
+    foreach(Region* region, m_regions)
+    {
+        Q_ASSERT_X(!region->m_refs, "",
+                   "A mapped region has not been released");
+        delete region;
+    }
+}
+
+void HMappedFileCache::remove(Region* region)
+{
+    Q_ASSERT(region->m_cached);
+
+    m_regions.remove(region->m_itemId);
+    m_lru.remove(region->m_lastUse);
+    m_mappedBytes -= region->m_size;
+    region->m_cached = false;
+
+    if (!region->m_refs)
+    {
+        delete region;
+    }
+}
+
+void HMappedFileCache::evict()
+{
+    QMap<quint64, Region*>::iterator it = m_lru.begin();
+    while(m_mappedBytes > m_maxBytes && it != m_lru.end())
+    {
+        Region* region = it.value();
+        ++it;
+        remove(region);
+    }
+}
+
+HMappedFileCache::Region* HMappedFileCache::acquire(const QString& itemId)
+{
+    Region* region = m_regions.value(itemId);
+    if (!region)
+    {
+        return 0;
+    }
+
+    QFileInfo info(region->m_file->fileName());
+    if (info.size() != region->m_size ||
+        info.lastModified() != region->m_lastModified)
+    {
+        remove(region);
+        return 0;
+    }
+
+    m_lru.remove(region->m_lastUse);
+    region->m_lastUse = ++m_useCounter;
+    m_lru.insert(region->m_lastUse, region);
+
+    ++region->m_refs;
+    return region;
+}
+
+HMappedFileCache::Region* HMappedFileCache::insert(
+    const QString& itemId, QFile* file)
+{
+    Q_ASSERT(file && file->isOpen());
+
+    qint64 size = file->size();
+    if (size <= 0 || size > m_maxBytes)
+    {
+        return 0;
+    }
+
+    uchar* data = file->map(0, size);
+    if (!data)
+    {
+        return 0;
+    }
+
+    Region* old = m_regions.value(itemId);
+    if (old)
+    {
+        remove(old);
+    }
+
+    Region* region = new Region();
+    region->m_itemId = itemId;
+    region->m_file = file;
+    region->m_data = data;
+    region->m_size = size;
+    region->m_lastModified = QFileInfo(*file).lastModified();
+    region->m_refs = 1;
+    region->m_lastUse = ++m_useCounter;
+    region->m_cached = true;
+
+    m_regions.insert(itemId, region);
+    m_lru.insert(region->m_lastUse, region);
+    m_mappedBytes += size;
+
+    evict();
+
+    return region;
+}
+
+void HMappedFileCache::release(Region* region)
+{
+    Q_ASSERT(region && region->m_refs > 0);
+
+    if (!--region->m_refs && !region->m_cached)
+    {
+        delete region;
+    }
+}
+
+}
+}
+}
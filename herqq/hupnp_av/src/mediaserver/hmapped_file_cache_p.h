@@ -0,0 +1,137 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HMAPPED_FILE_CACHE_P_H_
+#define HMAPPED_FILE_CACHE_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include <HUpnpAv/HUpnpAv>
+
+#include <QtCore/QMap>
+#include <QtCore/QHash>
+#include <QtCore/QString>
+#include <QtCore/QDateTime>
+
+class QFile;
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+//
+// Keeps the contents of recently served files mapped to memory, keyed with
+// the IDs of the items the files belong to. The least recently used
+// mappings are released once the mapped bytes exceed the configured limit.
+//
+// A mapping is reference counted and it stays valid until released, even if
+// it is evicted in the meantime. A cached mapping is validated against the
+// size and modification time of the file whenever it is acquired, which costs
+// a stat() but neither an open() nor a read().
+//
+// This class is not thread-safe.
+//
+class HMappedFileCache
+{
+H_DISABLE_COPY(HMappedFileCache)
+
+public:
+
+    class Region
+    {
+    H_DISABLE_COPY(Region)
+    friend class HMappedFileCache;
+
+    private:
+
+        QString m_itemId;
+        QFile* m_file;
+        uchar* m_data;
+        qint64 m_size;
+        QDateTime m_lastModified;
+
+        qint32 m_refs;
+        quint64 m_lastUse;
+        // the position of the region in m_lru
+
+        bool m_cached;
+        // false once the region has been evicted
+
+        Region();
+        ~Region();
+
+    public:
+
+        inline const char* data() const
+        {
+            return reinterpret_cast<const char*>(m_data);
+        }
+
+        inline qint64 size() const { return m_size; }
+    };
+
+private:
+
+    QHash<QString, Region*> m_regions;
+    QMap<quint64, Region*> m_lru;
+    // the regions in the order they were last used
+
+    qint64 m_mappedBytes;
+    qint64 m_maxBytes;
+    quint64 m_useCounter;
+
+    void remove(Region*);
+    void evict();
+
+public:
+
+    HMappedFileCache(qint64 maxBytes);
+    ~HMappedFileCache();
+
+    Region* acquire(const QString& itemId);
+    // returns the cached mapping of the item or null if there is none or the
+    // file has changed
+
+    Region* insert(const QString& itemId, QFile* file);
+    // maps the entire file and takes the ownership of it, unless null is
+    // returned. the returned region is acquired.
+
+    void release(Region*);
+
+    inline qint64 mappedBytes() const { return m_mappedBytes; }
+};
+
+}
+}
+}
+
+#endif /* HMAPPED_FILE_CACHE_P_H_ */
@@ -20,6 +20,9 @@
  */
 
 #include "hmediaserver_device_p.h"
+#include "htranscoder.h"
+#include "hthumbnail_cache_p.h"
+#include "htranscode_cache_p.h"
 #include "hmediaserver_deviceconfiguration.h"
 
 #include "../cds_model/datasource/hcds_datasource.h"
@@ -85,6 +88,44 @@ bool HMediaServerDevice::finalizeInit(QString* errDescr)
     cm->setSourceProtocolInfo(
         m_configuration->connectionManagerConfiguration()->supportedContentInfo());
 
+    if (m_configuration->thumbnailGenerator())
+    {
+        cm->setThumbnailCache(new HThumbnailCache(
+            m_configuration->thumbnailGenerator(),
+            m_configuration->thumbnailCacheDirectory(),
+            m_configuration->thumbnailMemoryCacheSize(),
+            m_configuration->thumbnailDiskCacheSize(),
+            m_configuration->thumbnailThreadCount()));
+    }
+
+    QList<HTranscoder*> transcoders = m_configuration->transcoders();
+    if (!transcoders.isEmpty())
+    {
+        cm->setTranscodeCache(new HTranscodeCache(
+            transcoders,
+            m_configuration->transcodeCacheDirectory(),
+            m_configuration->transcodeDiskCacheSize(),
+            m_configuration->transcodeJobCount()));
+
+        // an empty list is replaced with a wildcard that covers the
+        // transcoded formats as well
+        HProtocolInfos sourceInfo = cm->sourceProtocolInfo();
+        if (!sourceInfo.isEmpty())
+        {
+            foreach(HTranscoder* transcoder, transcoders)
+            {
+                HProtocolInfo pi = transcoder->protocolInfo();
+                pi.setProtocol("http-get");
+                if (!sourceInfo.contains(pi))
+                {
+                    sourceInfo.append(pi);
+                }
+            }
+
+            cm->setSourceProtocolInfo(sourceInfo);
+        }
+    }
+
     if (!cm || !cm->init())
     {
         if (errDescr)
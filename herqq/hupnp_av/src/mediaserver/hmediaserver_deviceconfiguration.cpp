@@ -38,7 +38,13 @@ namespace Av
  * HMediaServerDeviceConfigurationPrivate
  ******************************************************************************/
 HMediaServerDeviceConfigurationPrivate::HMediaServerDeviceConfigurationPrivate() :
-    m_cdsConf(0), m_cmConf(new HConnectionManagerServiceConfiguration())
+    m_cdsConf(0), m_cmConf(new HConnectionManagerServiceConfiguration()),
+        m_thumbnailGenerator(0), m_thumbnailCacheDirectory(),
+        m_thumbnailMemoryCacheSize(4 * 1024 * 1024),
+        m_thumbnailDiskCacheSize(64 * 1024 * 1024),
+        m_thumbnailThreadCount(1), m_transcoders(), m_transcodeCacheDirectory(),
+        m_transcodeDiskCacheSize(Q_INT64_C(1024) * 1024 * 1024),
+        m_transcodeJobCount(2)
 {
 }
 
@@ -78,6 +84,16 @@ void HMediaServerDeviceConfiguration::doClone(HClonable* target) const
     {
         conf->h_ptr->m_cmConf.reset(connectionManagerConfiguration()->clone());
     }
+
+    conf->h_ptr->m_thumbnailGenerator = h_ptr->m_thumbnailGenerator;
+    conf->h_ptr->m_thumbnailCacheDirectory = h_ptr->m_thumbnailCacheDirectory;
+    conf->h_ptr->m_thumbnailMemoryCacheSize = h_ptr->m_thumbnailMemoryCacheSize;
+    conf->h_ptr->m_thumbnailDiskCacheSize = h_ptr->m_thumbnailDiskCacheSize;
+    conf->h_ptr->m_thumbnailThreadCount = h_ptr->m_thumbnailThreadCount;
+    conf->h_ptr->m_transcoders = h_ptr->m_transcoders;
+    conf->h_ptr->m_transcodeCacheDirectory = h_ptr->m_transcodeCacheDirectory;
+    conf->h_ptr->m_transcodeDiskCacheSize = h_ptr->m_transcodeDiskCacheSize;
+    conf->h_ptr->m_transcodeJobCount = h_ptr->m_transcodeJobCount;
 }
 
 HMediaServerDeviceConfiguration* HMediaServerDeviceConfiguration::newInstance() const
@@ -115,6 +131,112 @@ const HConnectionManagerServiceConfiguration*
     return h_ptr->m_cmConf.data();
 }
 
+void HMediaServerDeviceConfiguration::setThumbnailGenerator(
+    HThumbnailGenerator* arg)
+{
+    h_ptr->m_thumbnailGenerator = arg;
+}
+
+HThumbnailGenerator* HMediaServerDeviceConfiguration::thumbnailGenerator() const
+{
+    return h_ptr->m_thumbnailGenerator;
+}
+
+void HMediaServerDeviceConfiguration::setThumbnailCacheDirectory(
+    const QString& arg)
+{
+    h_ptr->m_thumbnailCacheDirectory = arg;
+}
+
+QString HMediaServerDeviceConfiguration::thumbnailCacheDirectory() const
+{
+    return h_ptr->m_thumbnailCacheDirectory;
+}
+
+void HMediaServerDeviceConfiguration::setThumbnailMemoryCacheSize(qint64 bytes)
+{
+    h_ptr->m_thumbnailMemoryCacheSize = qMax(bytes, qint64(0));
+}
+
+qint64 HMediaServerDeviceConfiguration::thumbnailMemoryCacheSize() const
+{
+    return h_ptr->m_thumbnailMemoryCacheSize;
+}
+
+void HMediaServerDeviceConfiguration::setThumbnailDiskCacheSize(qint64 bytes)
+{
+    h_ptr->m_thumbnailDiskCacheSize = qMax(bytes, qint64(0));
+}
+
+qint64 HMediaServerDeviceConfiguration::thumbnailDiskCacheSize() const
+{
+    return h_ptr->m_thumbnailDiskCacheSize;
+}
+
+bool HMediaServerDeviceConfiguration::setThumbnailThreadCount(qint32 count)
+{
+    if (count < 1)
+    {
+        return false;
+    }
+
+    h_ptr->m_thumbnailThreadCount = count;
+    return true;
+}
+
+qint32 HMediaServerDeviceConfiguration::thumbnailThreadCount() const
+{
+    return h_ptr->m_thumbnailThreadCount;
+}
+
+void HMediaServerDeviceConfiguration::setTranscoders(
+    const QList<HTranscoder*>& arg)
+{
+    h_ptr->m_transcoders = arg;
+}
+
+QList<HTranscoder*> HMediaServerDeviceConfiguration::transcoders() const
+{
+    return h_ptr->m_transcoders;
+}
+
+void HMediaServerDeviceConfiguration::setTranscodeCacheDirectory(
+    const QString& arg)
+{
+    h_ptr->m_transcodeCacheDirectory = arg;
+}
+
+QString HMediaServerDeviceConfiguration::transcodeCacheDirectory() const
+{
+    return h_ptr->m_transcodeCacheDirectory;
+}
+
+void HMediaServerDeviceConfiguration::setTranscodeDiskCacheSize(qint64 bytes)
+{
+    h_ptr->m_transcodeDiskCacheSize = qMax(bytes, qint64(0));
+}
+
+qint64 HMediaServerDeviceConfiguration::transcodeDiskCacheSize() const
+{
+    return h_ptr->m_transcodeDiskCacheSize;
+}
+
+bool HMediaServerDeviceConfiguration::setTranscodeJobCount(qint32 count)
+{
+    if (count < 1)
+    {
+        return false;
+    }
+
+    h_ptr->m_transcodeJobCount = count;
+    return true;
+}
+
+qint32 HMediaServerDeviceConfiguration::transcodeJobCount() const
+{
+    return h_ptr->m_transcodeJobCount;
+}
+
 bool HMediaServerDeviceConfiguration::isValid() const
 {
     return contentDirectoryConfiguration() && connectionManagerConfiguration();
@@ -114,6 +114,228 @@ public:
      */
     const HConnectionManagerServiceConfiguration* connectionManagerConfiguration() const;
 
+    /*!
+     * \brief Specifies the object that creates the thumbnails of the items
+     * the media server publishes.
+     *
+     * When a generator is set, the media server publishes DLNA \c JPEG_TN
+     * and \c JPEG_SM resources for every item whose content format the
+     * generator supports. The thumbnails are created on worker threads
+     * when they are first requested and they are cached as specified by
+     * setThumbnailCacheDirectory(), setThumbnailMemoryCacheSize() and
+     * setThumbnailDiskCacheSize().
+     *
+     * \param arg specifies the generator. A null pointer disables the
+     * thumbnails, which is the default. The ownership of the object is \b not
+     * transferred and the object has to outlive the media server.
+     *
+     * \sa thumbnailGenerator()
+     */
+    void setThumbnailGenerator(HThumbnailGenerator* arg);
+
+    /*!
+     * \brief Returns the object that creates the thumbnails of the items
+     * the media server publishes.
+     *
+     * \return The object that creates the thumbnails of the items
+     * the media server publishes or a null pointer in case none is set.
+     *
+     * \sa setThumbnailGenerator()
+     */
+    HThumbnailGenerator* thumbnailGenerator() const;
+
+    /*!
+     * \brief Specifies the directory where the created thumbnails are stored.
+     *
+     * \param arg specifies the directory where the created thumbnails are
+     * stored. The thumbnails stored in the directory are reused when the
+     * media server is restarted. An empty string means that the thumbnails
+     * are cached only in memory, which is the default.
+     *
+     * \sa thumbnailCacheDirectory(), setThumbnailDiskCacheSize()
+     */
+    void setThumbnailCacheDirectory(const QString& arg);
+
+    /*!
+     * \brief Returns the directory where the created thumbnails are stored.
+     *
+     * \return The directory where the created thumbnails are stored.
+     *
+     * \sa setThumbnailCacheDirectory()
+     */
+    QString thumbnailCacheDirectory() const;
+
+    /*!
+     * \brief Specifies the number of bytes of thumbnails kept in memory.
+     *
+     * The least recently used thumbnails are dropped from memory once the
+     * limit is exceeded. The default is 4 MB.
+     *
+     * \param bytes specifies the number of bytes of thumbnails kept in memory.
+     *
+     * \sa thumbnailMemoryCacheSize()
+     */
+    void setThumbnailMemoryCacheSize(qint64 bytes);
+
+    /*!
+     * \brief Returns the number of bytes of thumbnails kept in memory.
+     *
+     * \return The number of bytes of thumbnails kept in memory.
+     *
+     * \sa setThumbnailMemoryCacheSize()
+     */
+    qint64 thumbnailMemoryCacheSize() const;
+
+    /*!
+     * \brief Specifies the number of bytes of thumbnails kept in the
+     * thumbnail cache directory.
+     *
+     * The least recently used thumbnails are removed from the directory once
+     * the limit is exceeded. The default is 64 MB.
+     *
+     * \param bytes specifies the number of bytes of thumbnails kept in the
+     * thumbnail cache directory.
+     *
+     * \sa thumbnailDiskCacheSize(), setThumbnailCacheDirectory()
+     */
+    void setThumbnailDiskCacheSize(qint64 bytes);
+
+    /*!
+     * \brief Returns the number of bytes of thumbnails kept in the
+     * thumbnail cache directory.
+     *
+     * \return The number of bytes of thumbnails kept in the
+     * thumbnail cache directory.
+     *
+     * \sa setThumbnailDiskCacheSize()
+     */
+    qint64 thumbnailDiskCacheSize() const;
+
+    /*!
+     * \brief Specifies the number of threads used to create thumbnails.
+     *
+     * \param count specifies the number of threads used to create thumbnails.
+     * The default is 1.
+     *
+     * \return \e true in case the value was set, i.e. \a count is positive.
+     *
+     * \sa thumbnailThreadCount()
+     */
+    bool setThumbnailThreadCount(qint32 count);
+
+    /*!
+     * \brief Returns the number of threads used to create thumbnails.
+     *
+     * \return The number of threads used to create thumbnails.
+     *
+     * \sa setThumbnailThreadCount()
+     */
+    qint32 thumbnailThreadCount() const;
+
+    /*!
+     * \brief Specifies the objects that convert the items the media server
+     * publishes to other formats.
+     *
+     * For every item whose content format a transcoder supports, the media
+     * server publishes an additional resource with the protocol info of the
+     * transcoder. The content is transcoded when it is first requested and
+     * it is streamed while it is being transcoded. The transcoded content is
+     * stored in the directory specified with setTranscodeCacheDirectory(),
+     * from which it is served afterwards.
+     *
+     * \param arg specifies the transcoders. An empty list disables
+     * transcoding, which is the default. The ownership of the objects is
+     * \b not transferred and the objects have to outlive the media server.
+     *
+     * \sa transcoders()
+     */
+    void setTranscoders(const QList<HTranscoder*>& arg);
+
+    /*!
+     * \brief Returns the objects that convert the items the media server
+     * publishes to other formats.
+     *
+     * \return The objects that convert the items the media server
+     * publishes to other formats.
+     *
+     * \sa setTranscoders()
+     */
+    QList<HTranscoder*> transcoders() const;
+
+    /*!
+     * \brief Specifies the directory where the transcoded content is stored.
+     *
+     * \param arg specifies the directory where the transcoded content is
+     * stored. The content stored in the directory is reused when the media
+     * server is restarted. An empty string means a directory named
+     * \c hupnp_av_transcode in the temporary directory of the system,
+     * which is the default.
+     *
+     * \sa transcodeCacheDirectory(), setTranscodeDiskCacheSize()
+     */
+    void setTranscodeCacheDirectory(const QString& arg);
+
+    /*!
+     * \brief Returns the directory where the transcoded content is stored.
+     *
+     * \return The directory where the transcoded content is stored.
+     *
+     * \sa setTranscodeCacheDirectory()
+     */
+    QString transcodeCacheDirectory() const;
+
+    /*!
+     * \brief Specifies the number of bytes of transcoded content kept in the
+     * transcode cache directory.
+     *
+     * The least recently used content is removed from the directory once
+     * the limit is exceeded. Content that is being transcoded or sent is never
+     * removed. The default is 1 GB.
+     *
+     * \param bytes specifies the number of bytes of transcoded content kept
+     * in the transcode cache directory.
+     *
+     * \sa transcodeDiskCacheSize(), setTranscodeCacheDirectory()
+     */
+    void setTranscodeDiskCacheSize(qint64 bytes);
+
+    /*!
+     * \brief Returns the number of bytes of transcoded content kept in the
+     * transcode cache directory.
+     *
+     * \return The number of bytes of transcoded content kept in the
+     * transcode cache directory.
+     *
+     * \sa setTranscodeDiskCacheSize()
+     */
+    qint64 transcodeDiskCacheSize() const;
+
+    /*!
+     * \brief Specifies the number of items that are transcoded at the
+     * same time.
+     *
+     * Further requests wait until a transcoding job ends. In case too many
+     * requests are waiting, new requests are answered with
+     * <c>503 Service Unavailable</c>.
+     *
+     * \param count specifies the number of items that are transcoded at the
+     * same time. The default is 2.
+     *
+     * \return \e true in case the value was set, i.e. \a count is positive.
+     *
+     * \sa transcodeJobCount()
+     */
+    bool setTranscodeJobCount(qint32 count);
+
+    /*!
+     * \brief Returns the number of items that are transcoded at the same time.
+     *
+     * \return The number of items that are transcoded at the same time.
+     *
+     * \sa setTranscodeJobCount()
+     */
+    qint32 transcodeJobCount() const;
+
     /*!
      * \brief Indicates if the object is valid.
      *
@@ -31,6 +31,8 @@
 //
 
 #include <HUpnpAv/HUpnpAv>
+#include <QtCore/QList>
+#include <QtCore/QString>
 #include <QtCore/QScopedPointer>
 
 namespace Herqq
@@ -54,6 +56,21 @@ public:
     QScopedPointer<HContentDirectoryServiceConfiguration> m_cdsConf;
     QScopedPointer<HConnectionManagerServiceConfiguration> m_cmConf;
 
+    HThumbnailGenerator* m_thumbnailGenerator;
+    // not owned
+
+    QString m_thumbnailCacheDirectory;
+    qint64 m_thumbnailMemoryCacheSize;
+    qint64 m_thumbnailDiskCacheSize;
+    qint32 m_thumbnailThreadCount;
+
+    QList<HTranscoder*> m_transcoders;
+    // not owned
+
+    QString m_transcodeCacheDirectory;
+    qint64 m_transcodeDiskCacheSize;
+    qint32 m_transcodeJobCount;
+
     HMediaServerDeviceConfigurationPrivate();
     virtual ~HMediaServerDeviceConfigurationPrivate();
 };
@@ -0,0 +1,353 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hthumbnail_cache_p.h"
+#include "hthumbnail_generator.h"
+
+#include <HUpnpCore/private/hlogger_p.h>
+
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QSize>
+#include <QtCore/QRunnable>
+#include <QtCore/QFileInfo>
+#include <QtCore/QDateTime>
+#include <QtCore/QCryptographicHash>
+
+#include <climits>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+/*******************************************************************************
+ * HThumbnailCache::Job
+ ******************************************************************************/
+class HThumbnailCache::Job :
+    public QRunnable
+{
+H_DISABLE_COPY(Job)
+
+private:
+
+    HThumbnailCache* m_owner;
+    QString m_key;
+    QSize m_maxSize;
+    QIODevice* m_source;
+    // owned by m_owner
+    QString m_contentFormat;
+
+public:
+
+    Job(HThumbnailCache* owner, const QString& key, const QSize& maxSize,
+        QIODevice* source, const QString& contentFormat) :
+            m_owner(owner), m_key(key), m_maxSize(maxSize), m_source(source),
+            m_contentFormat(contentFormat)
+    {
+    }
+
+    virtual void run();
+};
+
+void HThumbnailCache::Job::run()
+{
+    HLOG(H_AT, H_FUN);
+
+    QByteArray jpeg;
+    bool stored = false;
+    if (!m_owner->m_cancelled.fetchAndAddOrdered(0))
+    {
+        if (!m_owner->m_generator->generate(
+            m_source, m_contentFormat, m_maxSize, &jpeg))
+        {
+            jpeg.clear();
+        }
+
+        if (!jpeg.isEmpty() && !m_owner->m_directory.isEmpty())
+        {
+            // the file is written under a temporary name and renamed once
+            // complete, which ensures that an interrupted write is never
+            // mistaken for a thumbnail
+            QString path = m_owner->filePath(m_key);
+            QFile file(QString(path).append(".tmp"));
+            if (file.open(QIODevice::WriteOnly) &&
+                file.write(jpeg) == jpeg.size())
+            {
+                file.close();
+                QFile::remove(path);
+                stored = file.rename(path);
+            }
+            else
+            {
+                HLOG_WARN(QString("Failed to store thumbnail to [%1]: %2").arg(
+                    file.fileName(), file.errorString()));
+                file.remove();
+            }
+        }
+    }
+
+    bool ok = QMetaObject::invokeMethod(
+        m_owner, "generated", Qt::QueuedConnection,
+        Q_ARG(QString, m_key), Q_ARG(QByteArray, jpeg), Q_ARG(bool, stored));
+    Q_ASSERT(ok); Q_UNUSED(ok)
+}
+
+/*******************************************************************************
+ * HThumbnailCache
+ ******************************************************************************/
+HThumbnailCache::HThumbnailCache(
+    HThumbnailGenerator* generator, const QString& directory,
+    qint64 maxMemoryBytes, qint64 maxDiskBytes, qint32 threadCount,
+    QObject* parent) :
+        QObject(parent),
+            m_generator(generator), m_directory(directory), m_memory(),
+            m_disk(), m_diskLru(), m_diskBytes(0), m_maxDiskBytes(maxDiskBytes),
+            m_useCounter(0), m_sources(), m_failed(), m_cancelled(0),
+            m_workers()
+{
+    Q_ASSERT(generator);
+
+    // the cost of a memory cache entry is its size in bytes
+    m_memory.setMaxCost(
+        static_cast<int>(qBound(qint64(0), maxMemoryBytes, qint64(INT_MAX))));
+
+    m_workers.setMaxThreadCount(qMax(threadCount, 1));
+
+    if (!m_directory.isEmpty())
+    {
+        if (!QDir().mkpath(m_directory))
+        {
+            HLOG_WARN(QString(
+                "Failed to create thumbnail cache directory [%1]").arg(
+                    m_directory));
+
+            m_directory.clear();
+        }
+        else
+        {
+            loadDiskIndex();
+        }
+    }
+}
+
+HThumbnailCache::~HThumbnailCache()
+{
+    m_cancelled.fetchAndStoreOrdered(1);
+    m_workers.waitForDone();
+    qDeleteAll(m_sources);
+}
+
+QString HThumbnailCache::profileName(Profile profile)
+{
+    return profile == JpegTn ? "JPEG_TN" : "JPEG_SM";
+}
+
+bool HThumbnailCache::profileFromName(const QString& name, Profile* profile)
+{
+    if (name == "JPEG_TN")
+    {
+        *profile = JpegTn;
+    }
+    else if (name == "JPEG_SM")
+    {
+        *profile = JpegSm;
+    }
+    else
+    {
+        return false;
+    }
+
+    return true;
+}
+
+QSize HThumbnailCache::maxSize(Profile profile)
+{
+    return profile == JpegTn ? QSize(160, 160) : QSize(640, 480);
+}
+
+QString HThumbnailCache::filePath(const QString& key) const
+{
+    return QString(m_directory).append('/').append(key).append(".jpg");
+}
+
+void HThumbnailCache::loadDiskIndex()
+{
+    // the least recently used files are not known after a restart, which is
+    // why the files are ordered by the time they were written instead
+    QFileInfoList files = QDir(m_directory).entryInfoList(
+        QStringList("*.jpg"), QDir::Files, QDir::Time | QDir::Reversed);
+
+    foreach(const QFileInfo& file, files)
+    {
+        touch(file.completeBaseName(), file.size());
+    }
+
+    evict();
+}
+
+void HThumbnailCache::touch(const QString& key, qint64 size)
+{
+    QHash<QString, DiskEntry>::iterator it = m_disk.find(key);
+    if (it != m_disk.end())
+    {
+        m_diskLru.remove(it->m_lastUse);
+    }
+    else
+    {
+        DiskEntry entry = { size, 0 };
+        it = m_disk.insert(key, entry);
+        m_diskBytes += size;
+    }
+
+    it->m_lastUse = ++m_useCounter;
+    m_diskLru.insert(it->m_lastUse, key);
+}
+
+void HThumbnailCache::evict()
+{
+    while(m_diskBytes > m_maxDiskBytes && !m_diskLru.isEmpty())
+    {
+        QString key = m_diskLru.take(m_diskLru.begin().key());
+        m_diskBytes -= m_disk.take(key).m_size;
+        QFile::remove(filePath(key));
+    }
+}
+
+QString HThumbnailCache::key(
+    const QString& itemId, Profile profile, const QIODevice* source)
+{
+    QByteArray id = itemId.toUtf8();
+    id.append('|').append(profileName(profile).toLatin1());
+
+    const QFile* file = qobject_cast<const QFile*>(source);
+    if (file)
+    {
+        QFileInfo info(*file);
+        id.append('|').append(info.absoluteFilePath().toUtf8());
+        id.append('|').append(QByteArray::number(info.size()));
+        id.append('|').append(
+            info.lastModified().toUTC().toString(Qt::ISODate).toLatin1());
+    }
+    else if (source)
+    {
+        id.append('|').append(QByteArray::number(source->size()));
+    }
+
+    return QCryptographicHash::hash(id, QCryptographicHash::Sha1).toHex();
+}
+
+bool HThumbnailCache::supports(const QString& contentFormat) const
+{
+    return m_generator->supports(contentFormat);
+}
+
+bool HThumbnailCache::find(const QString& key, QByteArray* jpeg)
+{
+    Q_ASSERT(jpeg);
+
+    const QByteArray* cached = m_memory.object(key);
+    if (cached)
+    {
+        *jpeg = *cached;
+        return true;
+    }
+
+    if (!m_disk.contains(key))
+    {
+        return false;
+    }
+
+    QFile file(filePath(key));
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        m_diskBytes -= m_disk.value(key).m_size;
+        m_diskLru.remove(m_disk.take(key).m_lastUse);
+        return false;
+    }
+
+    *jpeg = file.readAll();
+    touch(key, jpeg->size());
+    m_memory.insert(key, new QByteArray(*jpeg), jpeg->size());
+
+    return true;
+}
+
+bool HThumbnailCache::isGenerating(const QString& key) const
+{
+    return m_sources.contains(key);
+}
+
+bool HThumbnailCache::hasFailed(const QString& key) const
+{
+    return m_failed.contains(key);
+}
+
+bool HThumbnailCache::generate(
+    const QString& key, Profile profile, QIODevice* source,
+    const QString& contentFormat)
+{
+    Q_ASSERT(source);
+
+    if (m_sources.contains(key) || source->isSequential() ||
+        !source->isReadable())
+    {
+        delete source;
+        return m_sources.contains(key);
+    }
+
+    m_sources.insert(key, source);
+    m_workers.start(
+        new Job(this, key, maxSize(profile), source, contentFormat));
+
+    return true;
+}
+
+void HThumbnailCache::generated(
+    const QString& key, const QByteArray& jpeg, bool stored)
+{
+    delete m_sources.take(key);
+
+    if (jpeg.isEmpty())
+    {
+        m_failed.insert(key);
+    }
+    else
+    {
+        m_memory.insert(key, new QByteArray(jpeg), jpeg.size());
+
+        if (stored)
+        {
+            touch(key, jpeg.size());
+            evict();
+        }
+    }
+
+    emit thumbnailReady(key, jpeg);
+}
+
+}
+}
+}
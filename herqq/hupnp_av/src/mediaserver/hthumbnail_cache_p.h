@@ -0,0 +1,170 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HTHUMBNAIL_CACHE_P_H_
+#define HTHUMBNAIL_CACHE_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include <HUpnpAv/HUpnpAv>
+
+#include <QtCore/QSet>
+#include <QtCore/QMap>
+#include <QtCore/QHash>
+#include <QtCore/QCache>
+#include <QtCore/QObject>
+#include <QtCore/QString>
+#include <QtCore/QByteArray>
+#include <QtCore/QThreadPool>
+#include <QtCore/QAtomicInt>
+
+class QSize;
+class QIODevice;
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+//
+// Creates the thumbnails of the items a media server publishes using a
+// HThumbnailGenerator and keeps them in a memory cache and optionally in a
+// disk cache. Both caches drop the least recently used thumbnails once the
+// configured number of bytes is exceeded.
+//
+// The thumbnails are created on the threads of a private thread pool and
+// thumbnailReady() is emitted in the thread of this object once a thumbnail
+// is done, whether it succeeded or not.
+//
+class HThumbnailCache :
+    public QObject
+{
+Q_OBJECT
+H_DISABLE_COPY(HThumbnailCache)
+
+public:
+
+    enum Profile
+    {
+        JpegTn,
+        // DLNA JPEG_TN, at most 160x160
+
+        JpegSm
+        // DLNA JPEG_SM, at most 640x480
+    };
+
+    static QString profileName(Profile);
+    static bool profileFromName(const QString&, Profile*);
+    static QSize maxSize(Profile);
+
+private Q_SLOTS:
+
+    void generated(const QString& key, const QByteArray& jpeg, bool stored);
+
+private:
+
+    struct DiskEntry
+    {
+        qint64 m_size;
+        quint64 m_lastUse;
+        // the position of the entry in m_diskLru
+    };
+
+    HThumbnailGenerator* m_generator;
+    // not owned
+
+    QString m_directory;
+    // empty in case the thumbnails are not stored on disk
+
+    QCache<QString, QByteArray> m_memory;
+
+    QHash<QString, DiskEntry> m_disk;
+    QMap<quint64, QString> m_diskLru;
+    // the thumbnails on disk in the order they were last used
+
+    qint64 m_diskBytes;
+    qint64 m_maxDiskBytes;
+    quint64 m_useCounter;
+
+    QHash<QString, QIODevice*> m_sources;
+    // the data of the items whose thumbnails are being generated. the devices
+    // are deleted in the thread of this object once the workers are done.
+
+    QSet<QString> m_failed;
+
+    QAtomicInt m_cancelled;
+    QThreadPool m_workers;
+
+    void loadDiskIndex();
+    void touch(const QString& key, qint64 size);
+    void evict();
+
+    QString filePath(const QString& key) const;
+
+    class Job;
+    friend class Job;
+
+public:
+
+    HThumbnailCache(
+        HThumbnailGenerator*, const QString& directory,
+        qint64 maxMemoryBytes, qint64 maxDiskBytes, qint32 threadCount,
+        QObject* parent = 0);
+
+    virtual ~HThumbnailCache();
+
+    static QString key(
+        const QString& itemId, Profile, const QIODevice* source);
+    // the key identifies the data of the item as well, which means that
+    // the thumbnails of modified files are not served from the cache
+
+    bool supports(const QString& contentFormat) const;
+
+    bool find(const QString& key, QByteArray* jpeg);
+    bool isGenerating(const QString& key) const;
+    bool hasFailed(const QString& key) const;
+
+    bool generate(
+        const QString& key, Profile, QIODevice* source,
+        const QString& contentFormat);
+    // takes the ownership of the device
+
+Q_SIGNALS:
+
+    void thumbnailReady(const QString& key, const QByteArray& jpeg);
+    // the array is empty in case the thumbnail could not be created
+};
+
+}
+}
+}
+
+#endif /* HTHUMBNAIL_CACHE_P_H_ */
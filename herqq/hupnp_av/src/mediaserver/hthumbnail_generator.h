@@ -0,0 +1,121 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HTHUMBNAIL_GENERATOR_H_
+#define HTHUMBNAIL_GENERATOR_H_
+
+#include <HUpnpAv/HUpnpAv>
+
+class QSize;
+class QString;
+class QIODevice;
+class QByteArray;
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+/*!
+ * \brief This is an abstract base class for creating the thumbnails a media
+ * server publishes for its items.
+ *
+ * When a thumbnail generator is configured, the media server publishes
+ * DLNA \c JPEG_TN and \c JPEG_SM resources for the items the generator
+ * supports. The thumbnails are created in the background the first time
+ * a control point requests them and they are cached afterwards.
+ *
+ * HUPnP Av does not depend on QtGui, which is why the decoding and scaling of
+ * the images is left to the application. An implementation based on QtGui
+ * can load the image using \c QImageReader, scale it down with
+ * \c QImage::scaled() and \c Qt::KeepAspectRatio and write it out using
+ * \c QImageWriter with the \c "jpg" format.
+ *
+ * \headerfile hthumbnail_generator.h HThumbnailGenerator
+ *
+ * \ingroup hupnp_av_mediaserver
+ *
+ * \remarks The methods of this class are called from worker threads and
+ * possibly from several threads at the same time. The implementations have
+ * to be thread-safe.
+ *
+ * \sa HMediaServerDeviceConfiguration::setThumbnailGenerator()
+ */
+class H_UPNP_AV_EXPORT HThumbnailGenerator
+{
+H_DISABLE_COPY(HThumbnailGenerator)
+
+public:
+
+    /*!
+     * \brief Creates a new instance.
+     */
+    HThumbnailGenerator();
+
+    /*!
+     * \brief Destroys the instance.
+     */
+    virtual ~HThumbnailGenerator();
+
+    /*!
+     * \brief Indicates if the generator can create thumbnails of items of
+     * the specified type.
+     *
+     * \param contentFormat specifies the MIME type of an item, such as
+     * \c image/jpeg. A generator may support other than image items, for
+     * instance by extracting the album art embedded in audio files.
+     *
+     * \return \e true in case the generator can create thumbnails of items
+     * of the specified type.
+     */
+    virtual bool supports(const QString& contentFormat) const = 0;
+
+    /*!
+     * \brief Creates a thumbnail of the specified item.
+     *
+     * \param source specifies the data of the item, positioned at the start.
+     * The device is opened for reading and it is not sequential.
+     * The ownership of the device is \b not transferred.
+     *
+     * \param contentFormat specifies the MIME type of the item.
+     *
+     * \param maxSize specifies the maximum width and height of the thumbnail.
+     * The aspect ratio of the image should be preserved.
+     *
+     * \param jpeg specifies a pointer to a byte array that receives the
+     * thumbnail encoded as JPEG.
+     *
+     * \return \e true in case the thumbnail was created.
+     */
+    virtual bool generate(
+        QIODevice* source, const QString& contentFormat, const QSize& maxSize,
+        QByteArray* jpeg) = 0;
+};
+
+}
+}
+}
+
+#endif /* HTHUMBNAIL_GENERATOR_H_ */
@@ -0,0 +1,758 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "htranscode_cache_p.h"
+#include "htranscoder.h"
+
+#include <HUpnpCore/private/hlogger_p.h>
+
+#include <QtCore/QDir>
+#include <QtCore/QRunnable>
+#include <QtCore/QFileInfo>
+#include <QtCore/QDateTime>
+#include <QtCore/QStringList>
+#include <QtCore/QCryptographicHash>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+namespace
+{
+void removeDirectory(const QString& path)
+{
+    QDir dir(path);
+    foreach(const QString& name, dir.entryList(QDir::Files | QDir::Hidden))
+    {
+        dir.remove(name);
+    }
+
+    QDir().rmdir(path);
+}
+}
+
+/*******************************************************************************
+ * HTranscodedStream
+ ******************************************************************************/
+HTranscodedStream::HTranscodedStream(
+    HTranscodeCache* cache, const QString& key, qint64 offset, qint64 length) :
+        QIODevice(),
+            m_cache(cache), m_key(key), m_segment(),
+            m_segmentIndex(static_cast<qint32>(
+                offset / HTranscodeCache::SegmentSize)),
+            m_skip(offset % HTranscodeCache::SegmentSize),
+            m_remaining(length), m_finished(false)
+{
+    Q_ASSERT(cache);
+
+    bool ok = connect(
+        cache, SIGNAL(segmentReady(QString)),
+        this, SLOT(segmentReady(QString)));
+    Q_ASSERT(ok); Q_UNUSED(ok)
+
+    ok = connect(
+        cache, SIGNAL(transcodeFinished(QString)),
+        this, SLOT(transcodeFinished(QString)));
+    Q_ASSERT(ok);
+
+    cache->addReader(m_key);
+    open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+
+    if (!cache->m_sources.contains(m_key))
+    {
+        // the transcoding has already ended, but the signal is emitted only
+        // once the streamer has connected to it
+        ok = QMetaObject::invokeMethod(
+            this, "transcodeFinished", Qt::QueuedConnection,
+            Q_ARG(QString, m_key));
+        Q_ASSERT(ok);
+    }
+}
+
+HTranscodedStream::~HTranscodedStream()
+{
+    if (m_cache)
+    {
+        m_cache->removeReader(m_key);
+    }
+}
+
+bool HTranscodedStream::isSequential() const
+{
+    return true;
+}
+
+void HTranscodedStream::segmentReady(const QString& key)
+{
+    if (key == m_key)
+    {
+        emit readyRead();
+    }
+}
+
+void HTranscodedStream::transcodeFinished(const QString& key)
+{
+    if (key == m_key && !m_finished)
+    {
+        m_finished = true;
+        emit readChannelFinished();
+    }
+}
+
+qint64 HTranscodedStream::readData(char* data, qint64 maxSize)
+{
+    if (!m_cache)
+    {
+        setErrorString("The transcode cache has been deleted");
+        return -1;
+    }
+
+    if (m_remaining >= 0)
+    {
+        maxSize = qMin(maxSize, m_remaining);
+    }
+
+    qint64 read = 0;
+    while(read < maxSize)
+    {
+        if (!m_segment.isOpen())
+        {
+            if (m_segmentIndex >= m_cache->readySegments(m_key))
+            {
+                // wait for segmentReady() or the end of the transcoding
+                break;
+            }
+
+            m_segment.setFileName(m_cache->segmentPath(m_key, m_segmentIndex));
+            if (!m_segment.open(QIODevice::ReadOnly) ||
+                (m_skip > 0 && !m_segment.seek(m_skip)))
+            {
+                setErrorString(m_segment.errorString());
+                return read > 0 ? read : -1;
+            }
+
+            m_skip = 0;
+        }
+
+        qint64 count = m_segment.read(data + read, maxSize - read);
+        if (count < 0)
+        {
+            setErrorString(m_segment.errorString());
+            return read > 0 ? read : -1;
+        }
+        else if (count == 0)
+        {
+            m_segment.close();
+            ++m_segmentIndex;
+            continue;
+        }
+
+        read += count;
+    }
+
+    if (m_remaining >= 0)
+    {
+        m_remaining -= read;
+    }
+
+    return read;
+}
+
+qint64 HTranscodedStream::writeData(const char*, qint64)
+{
+    return -1;
+}
+
+/*******************************************************************************
+ * HTranscodeCache::Sink
+ ******************************************************************************/
+//
+// Splits the output of a transcoder into the segment files of an entry.
+// A segment is written under a temporary name and renamed once it is
+// complete, after which the owner is informed that it can be read.
+//
+class HTranscodeCache::Sink :
+    public QIODevice
+{
+H_DISABLE_COPY(Sink)
+
+private:
+
+    HTranscodeCache* m_owner;
+    const QString m_key;
+
+    QFile m_file;
+    qint32 m_index;
+    qint64 m_total;
+
+    bool closeSegment();
+
+protected:
+
+    virtual qint64 readData(char*, qint64) { return -1; }
+    virtual qint64 writeData(const char* data, qint64 maxSize);
+
+public:
+
+    Sink(HTranscodeCache* owner, const QString& key) :
+        m_owner(owner), m_key(key), m_file(), m_index(0), m_total(0)
+    {
+    }
+
+    // closes the last segment and marks the entry complete in case
+    // the transcoding succeeded
+    bool finish(bool ok);
+};
+
+bool HTranscodeCache::Sink::closeSegment()
+{
+    HLOG(H_AT, H_FUN);
+
+    qint64 size = m_file.size();
+    m_file.close();
+
+    QString path = m_owner->segmentPath(m_key, m_index);
+    if (!m_file.rename(path))
+    {
+        HLOG_WARN(QString("Failed to store transcoded segment to [%1]: %2").arg(
+            path, m_file.errorString()));
+
+        m_file.remove();
+        return false;
+    }
+
+    ++m_index;
+    m_total += size;
+
+    bool ok = QMetaObject::invokeMethod(
+        m_owner, "segmentWritten", Qt::QueuedConnection,
+        Q_ARG(QString, m_key), Q_ARG(qint64, size));
+    Q_ASSERT(ok); Q_UNUSED(ok)
+
+    return true;
+}
+
+qint64 HTranscodeCache::Sink::writeData(const char* data, qint64 maxSize)
+{
+    HLOG(H_AT, H_FUN);
+
+    if (m_owner->m_cancelled.fetchAndAddOrdered(0))
+    {
+        setErrorString("The transcoding was cancelled");
+        return -1;
+    }
+
+    qint64 written = 0;
+    while(written < maxSize)
+    {
+        if (!m_file.isOpen())
+        {
+            m_file.setFileName(
+                m_owner->segmentPath(m_key, m_index).append(".tmp"));
+
+            if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+            {
+                HLOG_WARN(QString("Failed to open [%1]: %2").arg(
+                    m_file.fileName(), m_file.errorString()));
+
+                setErrorString(m_file.errorString());
+                return -1;
+            }
+        }
+
+        qint64 count = qMin(
+            maxSize - written, qint64(SegmentSize) - m_file.pos());
+
+        if (m_file.write(data + written, count) != count)
+        {
+            HLOG_WARN(QString("Failed to write [%1]: %2").arg(
+                m_file.fileName(), m_file.errorString()));
+
+            setErrorString(m_file.errorString());
+            return -1;
+        }
+
+        written += count;
+
+        if (m_file.pos() >= SegmentSize && !closeSegment())
+        {
+            setErrorString("Failed to store a transcoded segment");
+            return -1;
+        }
+    }
+
+    return written;
+}
+
+bool HTranscodeCache::Sink::finish(bool ok)
+{
+    HLOG(H_AT, H_FUN);
+
+    if (ok && m_file.isOpen())
+    {
+        ok = closeSegment();
+    }
+    else if (m_file.isOpen())
+    {
+        m_file.close();
+        m_file.remove();
+    }
+
+    if (!ok)
+    {
+        return false;
+    }
+
+    // the total size is written last, which ensures that an entry that was
+    // interrupted is never mistaken for a complete one
+    QFile complete(m_owner->entryPath(m_key).append("/complete"));
+    if (!complete.open(QIODevice::WriteOnly | QIODevice::Truncate) ||
+        complete.write(QByteArray::number(m_total)) <= 0)
+    {
+        HLOG_WARN(QString("Failed to write [%1]: %2").arg(
+            complete.fileName(), complete.errorString()));
+
+        return false;
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+ * HTranscodeCache::Job
+ ******************************************************************************/
+class HTranscodeCache::Job :
+    public QRunnable
+{
+H_DISABLE_COPY(Job)
+
+private:
+
+    HTranscodeCache* m_owner;
+    QString m_key;
+    HTranscoder* m_transcoder;
+    QIODevice* m_source;
+    // owned by m_owner
+    QString m_contentFormat;
+
+public:
+
+    Job(HTranscodeCache* owner, const QString& key, HTranscoder* transcoder,
+        QIODevice* source, const QString& contentFormat) :
+            m_owner(owner), m_key(key), m_transcoder(transcoder),
+            m_source(source), m_contentFormat(contentFormat)
+    {
+    }
+
+    virtual void run();
+};
+
+void HTranscodeCache::Job::run()
+{
+    HLOG(H_AT, H_FUN);
+
+    bool ok = false;
+    if (!m_owner->m_cancelled.fetchAndAddOrdered(0))
+    {
+        Sink sink(m_owner, m_key);
+        sink.open(QIODevice::WriteOnly | QIODevice::Unbuffered);
+
+        ok = m_transcoder->transcode(m_source, m_contentFormat, &sink);
+        ok = sink.finish(ok && !m_owner->m_cancelled.fetchAndAddOrdered(0));
+
+        if (!ok)
+        {
+            HLOG_WARN(QString("Failed to transcode content to [%1]").arg(
+                m_transcoder->name()));
+        }
+    }
+
+    bool invoked = QMetaObject::invokeMethod(
+        m_owner, "jobFinished", Qt::QueuedConnection,
+        Q_ARG(QString, m_key), Q_ARG(bool, ok));
+    Q_ASSERT(invoked); Q_UNUSED(invoked)
+}
+
+/*******************************************************************************
+ * HTranscodeCache
+ ******************************************************************************/
+HTranscodeCache::HTranscodeCache(
+    const QList<HTranscoder*>& transcoders, const QString& directory,
+    qint64 maxDiskBytes, qint32 maxJobs, QObject* parent) :
+        QObject(parent),
+            m_transcoders(transcoders), m_directory(directory), m_entries(),
+            m_lru(), m_diskBytes(0), m_maxDiskBytes(maxDiskBytes),
+            m_useCounter(0), m_sources(), m_failed(),
+            m_maxJobs(qMax(maxJobs, 1)), m_cancelled(0), m_workers()
+{
+    HLOG(H_AT, H_FUN);
+
+    m_workers.setMaxThreadCount(m_maxJobs);
+
+    if (m_directory.isEmpty())
+    {
+        m_directory = QDir::temp().filePath("hupnp_av_transcode");
+    }
+
+    if (!QDir().mkpath(m_directory))
+    {
+        HLOG_WARN(QString(
+            "Failed to create transcode cache directory [%1]").arg(
+                m_directory));
+    }
+    else
+    {
+        loadDiskIndex();
+    }
+}
+
+HTranscodeCache::~HTranscodeCache()
+{
+    m_cancelled.fetchAndStoreOrdered(1);
+    m_workers.waitForDone();
+    qDeleteAll(m_sources);
+
+    // the entries that were being transcoded were cancelled and they
+    // cannot be completed later
+    foreach(const QString& key, m_entries.keys())
+    {
+        if (!m_entries.value(key).m_complete)
+        {
+            removeDirectory(entryPath(key));
+        }
+    }
+}
+
+QString HTranscodeCache::entryPath(const QString& key) const
+{
+    return QString(m_directory).append('/').append(key);
+}
+
+QString HTranscodeCache::segmentPath(const QString& key, qint32 index) const
+{
+    return entryPath(key).append(QString("/%1.seg").arg(index));
+}
+
+void HTranscodeCache::loadDiskIndex()
+{
+    // the least recently used entries are not known after a restart, which
+    // is why the entries are ordered by the time they were written instead
+    QFileInfoList dirs = QDir(m_directory).entryInfoList(
+        QDir::Dirs | QDir::NoDotAndDotDot, QDir::Time | QDir::Reversed);
+
+    foreach(const QFileInfo& dir, dirs)
+    {
+        QFile complete(dir.absoluteFilePath().append("/complete"));
+
+        bool ok = false;
+        qint64 size = complete.open(QIODevice::ReadOnly) ?
+            complete.readAll().trimmed().toLongLong(&ok) : -1;
+
+        if (!ok || size < 0)
+        {
+            removeDirectory(dir.absoluteFilePath());
+            continue;
+        }
+
+        Entry entry =
+        {
+            size,
+            static_cast<qint32>((size + SegmentSize - 1) / SegmentSize),
+            true, 0, 0
+        };
+
+        m_entries.insert(dir.fileName(), entry);
+        m_diskBytes += size;
+        touch(dir.fileName());
+    }
+
+    evict();
+}
+
+void HTranscodeCache::touch(const QString& key)
+{
+    QHash<QString, Entry>::iterator it = m_entries.find(key);
+    if (it == m_entries.end())
+    {
+        return;
+    }
+    else if (it->m_lastUse)
+    {
+        m_lru.remove(it->m_lastUse);
+    }
+
+    it->m_lastUse = ++m_useCounter;
+    m_lru.insert(it->m_lastUse, key);
+}
+
+void HTranscodeCache::evict()
+{
+    QStringList victims;
+    qint64 bytes = m_diskBytes;
+
+    QMap<quint64, QString>::const_iterator it = m_lru.constBegin();
+    for(; it != m_lru.constEnd() && bytes > m_maxDiskBytes; ++it)
+    {
+        const Entry& entry = m_entries[it.value()];
+        if (entry.m_complete && !entry.m_readers)
+        {
+            victims.append(it.value());
+            bytes -= entry.m_size;
+        }
+    }
+
+    foreach(const QString& key, victims)
+    {
+        remove(key);
+    }
+}
+
+void HTranscodeCache::remove(const QString& key)
+{
+    Entry entry = m_entries.take(key);
+    m_lru.remove(entry.m_lastUse);
+    m_diskBytes -= entry.m_size;
+
+    removeDirectory(entryPath(key));
+}
+
+void HTranscodeCache::addReader(const QString& key)
+{
+    QHash<QString, Entry>::iterator it = m_entries.find(key);
+    if (it != m_entries.end())
+    {
+        ++it->m_readers;
+    }
+}
+
+void HTranscodeCache::removeReader(const QString& key)
+{
+    QHash<QString, Entry>::iterator it = m_entries.find(key);
+    if (it == m_entries.end() || --it->m_readers > 0)
+    {
+        return;
+    }
+    else if (!it->m_complete && !m_sources.contains(key))
+    {
+        // the transcoding failed while the entry was being read
+        remove(key);
+    }
+    else
+    {
+        evict();
+    }
+}
+
+qint32 HTranscodeCache::readySegments(const QString& key) const
+{
+    return m_entries.value(key).m_segments;
+}
+
+QString HTranscodeCache::key(
+    const QString& itemId, const HTranscoder* transcoder,
+    const QIODevice* source)
+{
+    QByteArray id = itemId.toUtf8();
+    id.append('|').append(transcoder->name().toUtf8());
+
+    const QFile* file = qobject_cast<const QFile*>(source);
+    if (file)
+    {
+        QFileInfo info(*file);
+        id.append('|').append(info.absoluteFilePath().toUtf8());
+        id.append('|').append(QByteArray::number(info.size()));
+        id.append('|').append(
+            info.lastModified().toUTC().toString(Qt::ISODate).toLatin1());
+    }
+    else if (source && !source->isSequential())
+    {
+        id.append('|').append(QByteArray::number(source->size()));
+    }
+
+    return QCryptographicHash::hash(id, QCryptographicHash::Sha1).toHex();
+}
+
+HTranscoder* HTranscodeCache::transcoder(const QString& name) const
+{
+    foreach(HTranscoder* transcoder, m_transcoders)
+    {
+        if (transcoder->name() == name)
+        {
+            return transcoder;
+        }
+    }
+
+    return 0;
+}
+
+QList<HTranscoder*> HTranscodeCache::transcoders(
+    const QString& contentFormat) const
+{
+    QList<HTranscoder*> retVal;
+    foreach(HTranscoder* transcoder, m_transcoders)
+    {
+        if (transcoder->supports(contentFormat))
+        {
+            retVal.append(transcoder);
+        }
+    }
+
+    return retVal;
+}
+
+bool HTranscodeCache::isComplete(const QString& key, qint64* size) const
+{
+    QHash<QString, Entry>::const_iterator it = m_entries.find(key);
+    if (it == m_entries.end() || !it->m_complete)
+    {
+        return false;
+    }
+
+    if (size)
+    {
+        *size = it->m_size;
+    }
+
+    return true;
+}
+
+bool HTranscodeCache::hasFailed(const QString& key) const
+{
+    return m_failed.contains(key);
+}
+
+HTranscodeCache::StartResult HTranscodeCache::start(
+    const QString& key, HTranscoder* transcoder, QIODevice* source,
+    const QString& contentFormat)
+{
+    HLOG(H_AT, H_FUN);
+
+    Q_ASSERT(transcoder);
+    Q_ASSERT(source);
+
+    if (m_failed.contains(key) || !source->isReadable())
+    {
+        delete source;
+        return Failed;
+    }
+    else if (m_entries.contains(key))
+    {
+        // the content is being transcoded or it is already on disk
+        delete source;
+        return Started;
+    }
+    else if (m_sources.size() >= m_maxJobs + MaxQueuedJobs)
+    {
+        delete source;
+        return Busy;
+    }
+    else if (!QDir().mkpath(entryPath(key)))
+    {
+        HLOG_WARN(QString("Failed to create [%1]").arg(entryPath(key)));
+
+        delete source;
+        return Failed;
+    }
+
+    Entry entry = { 0, 0, false, 0, 0 };
+    m_entries.insert(key, entry);
+    touch(key);
+
+    m_sources.insert(key, source);
+    m_workers.start(new Job(this, key, transcoder, source, contentFormat));
+
+    return Started;
+}
+
+HTranscodedStream* HTranscodeCache::open(
+    const QString& key, qint64 offset, qint64 length)
+{
+    QHash<QString, Entry>::const_iterator it = m_entries.find(key);
+    if (it == m_entries.end())
+    {
+        return 0;
+    }
+
+    touch(key);
+
+    return new HTranscodedStream(
+        this, key, offset, it->m_complete ? length : -1);
+}
+
+void HTranscodeCache::segmentWritten(const QString& key, qint64 size)
+{
+    QHash<QString, Entry>::iterator it = m_entries.find(key);
+    if (it == m_entries.end())
+    {
+        return;
+    }
+
+    it->m_size += size;
+    ++it->m_segments;
+    m_diskBytes += size;
+
+    emit segmentReady(key);
+}
+
+void HTranscodeCache::jobFinished(const QString& key, bool ok)
+{
+    delete m_sources.take(key);
+
+    QHash<QString, Entry>::iterator it = m_entries.find(key);
+    if (it == m_entries.end())
+    {
+        return;
+    }
+
+    if (ok)
+    {
+        it->m_complete = true;
+    }
+    else
+    {
+        m_failed.insert(key);
+    }
+
+    emit transcodeFinished(key);
+
+    it = m_entries.find(key);
+    if (it == m_entries.end())
+    {
+        return;
+    }
+    else if (!ok && !it->m_readers)
+    {
+        remove(key);
+    }
+    else if (ok)
+    {
+        evict();
+    }
+}
+
+}
+}
+}
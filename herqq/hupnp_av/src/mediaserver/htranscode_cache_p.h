@@ -0,0 +1,265 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HTRANSCODE_CACHE_P_H_
+#define HTRANSCODE_CACHE_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include <HUpnpAv/HUpnpAv>
+
+#include <QtCore/QSet>
+#include <QtCore/QMap>
+#include <QtCore/QHash>
+#include <QtCore/QFile>
+#include <QtCore/QList>
+#include <QtCore/QObject>
+#include <QtCore/QString>
+#include <QtCore/QPointer>
+#include <QtCore/QIODevice>
+#include <QtCore/QThreadPool>
+#include <QtCore/QAtomicInt>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+class HTranscodeCache;
+
+//
+// Reads the transcoded content from the segments of an entry of a
+// HTranscodeCache, starting from the specified byte offset. The device is
+// sequential. In case the content is still being transcoded, reading pauses
+// at the last segment that has been written and readyRead() is emitted
+// once the next one is done. readChannelFinished() is emitted once the
+// transcoding has ended and all of the segments are available.
+//
+class HTranscodedStream :
+    public QIODevice
+{
+Q_OBJECT
+H_DISABLE_COPY(HTranscodedStream)
+
+private Q_SLOTS:
+
+    void segmentReady(const QString& key);
+    void transcodeFinished(const QString& key);
+
+private:
+
+    QPointer<HTranscodeCache> m_cache;
+    const QString m_key;
+
+    QFile m_segment;
+    qint32 m_segmentIndex;
+    // the segment that is read next or that is open
+
+    qint64 m_skip;
+    // the number of bytes to skip from the start of the next segment
+
+    qint64 m_remaining;
+    // the number of bytes left, or -1 if the data is read until the end
+
+    bool m_finished;
+
+protected:
+
+    virtual qint64 readData(char* data, qint64 maxSize);
+    virtual qint64 writeData(const char* data, qint64 maxSize);
+
+public:
+
+    HTranscodedStream(
+        HTranscodeCache* cache, const QString& key, qint64 offset,
+        qint64 length);
+
+    virtual ~HTranscodedStream();
+
+    virtual bool isSequential() const;
+};
+
+//
+// Transcodes the items a media server publishes using the configured
+// HTranscoder instances and stores the output in a disk cache.
+//
+// The output of every transcoding is split into segments of SegmentSize
+// bytes and each segment is stored in its own file in a directory of the
+// entry as soon as it is complete. The content can be streamed while it is
+// being transcoded, and once an entry is complete, byte ranges are read
+// directly from the segments that contain them. The complete entries are
+// kept across restarts and the least recently used entries are removed once
+// the configured number of bytes is exceeded. Entries that are being
+// transcoded or read are never removed.
+//
+// The transcoding jobs run on the threads of a private thread pool, which
+// limits the number of concurrent jobs. At most MaxQueuedJobs jobs wait for
+// a free thread and further jobs are refused.
+//
+class HTranscodeCache :
+    public QObject
+{
+Q_OBJECT
+H_DISABLE_COPY(HTranscodeCache)
+friend class HTranscodedStream;
+
+public:
+
+    enum
+    {
+        SegmentSize = 1024 * 1024,
+        MaxQueuedJobs = 16
+    };
+
+    enum StartResult
+    {
+        Started,
+        // the content is being transcoded or it has been transcoded
+
+        Failed,
+        // the source could not be transcoded
+
+        Busy
+        // too many jobs are waiting for a free thread
+    };
+
+private Q_SLOTS:
+
+    void segmentWritten(const QString& key, qint64 size);
+    void jobFinished(const QString& key, bool ok);
+
+private:
+
+    struct Entry
+    {
+        qint64 m_size;
+        // the number of bytes in the segments that are done
+
+        qint32 m_segments;
+        // the number of segments that can be read
+
+        bool m_complete;
+
+        quint64 m_lastUse;
+        // the position of the entry in m_lru
+
+        qint32 m_readers;
+        // the number of streams reading the entry
+    };
+
+    QList<HTranscoder*> m_transcoders;
+    // not owned
+
+    QString m_directory;
+
+    QHash<QString, Entry> m_entries;
+    QMap<quint64, QString> m_lru;
+    // the entries in the order they were last used
+
+    qint64 m_diskBytes;
+    qint64 m_maxDiskBytes;
+    quint64 m_useCounter;
+
+    QHash<QString, QIODevice*> m_sources;
+    // the data of the items being transcoded. the devices are deleted in
+    // the thread of this object once the jobs are done.
+
+    QSet<QString> m_failed;
+
+    qint32 m_maxJobs;
+
+    QAtomicInt m_cancelled;
+    QThreadPool m_workers;
+
+    void loadDiskIndex();
+    void touch(const QString& key);
+    void evict();
+    void remove(const QString& key);
+
+    QString entryPath(const QString& key) const;
+    QString segmentPath(const QString& key, qint32 index) const;
+
+    // the following are used by HTranscodedStream
+    void addReader(const QString& key);
+    void removeReader(const QString& key);
+    qint32 readySegments(const QString& key) const;
+
+    class Job;
+    friend class Job;
+    class Sink;
+    friend class Sink;
+
+public:
+
+    HTranscodeCache(
+        const QList<HTranscoder*>&, const QString& directory,
+        qint64 maxDiskBytes, qint32 maxJobs, QObject* parent = 0);
+
+    virtual ~HTranscodeCache();
+
+    static QString key(
+        const QString& itemId, const HTranscoder*, const QIODevice* source);
+    // the key identifies the data of the item as well, which means that
+    // the transcoded content of modified files is not served from the cache
+
+    HTranscoder* transcoder(const QString& name) const;
+
+    QList<HTranscoder*> transcoders(const QString& contentFormat) const;
+    // the transcoders that support the specified format
+
+    inline const QList<HTranscoder*>& transcoders() const
+    {
+        return m_transcoders;
+    }
+
+    bool isComplete(const QString& key, qint64* size = 0) const;
+    bool hasFailed(const QString& key) const;
+
+    StartResult start(
+        const QString& key, HTranscoder*, QIODevice* source,
+        const QString& contentFormat);
+    // takes the ownership of the device
+
+    HTranscodedStream* open(const QString& key, qint64 offset, qint64 length);
+    // returns null in case the entry does not exist. the length is ignored
+    // unless the entry is complete
+
+Q_SIGNALS:
+
+    void segmentReady(const QString& key);
+    void transcodeFinished(const QString& key);
+};
+
+}
+}
+}
+
+#endif /* HTRANSCODE_CACHE_P_H_ */
@@ -0,0 +1,148 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HTRANSCODER_H_
+#define HTRANSCODER_H_
+
+#include <HUpnpAv/HUpnpAv>
+
+class QString;
+class QIODevice;
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+/*!
+ * \brief This is an abstract base class for converting the items a media
+ * server publishes to formats the original content is not available in.
+ *
+ * Every transcoder describes a single target format, which is called a
+ * transcoding profile. When transcoders are configured, the media server
+ * publishes an additional resource for every item whose content format a
+ * transcoder supports. The location of the resource is
+ * <tt>\<item location\>/\<name()\></tt> and its protocol info is
+ * protocolInfo().
+ *
+ * The content is transcoded when a control point first requests it and the
+ * output is streamed to the control point as it is produced. The output
+ * is stored on disk in segments as well, which is why repeated requests for
+ * the same content, including requests for byte ranges, are served from the
+ * disk once the content has been transcoded.
+ *
+ * HUPnP Av does not contain any codecs. An implementation typically runs an
+ * external encoder, such as \c ffmpeg, using \c QProcess and copies the
+ * standard output of the process to the output device.
+ *
+ * \headerfile htranscoder.h HTranscoder
+ *
+ * \ingroup hupnp_av_mediaserver
+ *
+ * \remarks The transcode() method is called from worker threads and possibly
+ * from several threads at the same time. The implementations have to
+ * be thread-safe.
+ *
+ * \sa HMediaServerDeviceConfiguration::setTranscoders()
+ */
+class H_UPNP_AV_EXPORT HTranscoder
+{
+H_DISABLE_COPY(HTranscoder)
+
+public:
+
+    /*!
+     * \brief Creates a new instance.
+     */
+    HTranscoder();
+
+    /*!
+     * \brief Destroys the instance.
+     */
+    virtual ~HTranscoder();
+
+    /*!
+     * \brief Returns the name of the transcoding profile.
+     *
+     * \return The name of the transcoding profile, such as \c MP3 or
+     * \c AVC_TS_HD_50_AC3. The name is used as the last segment of the
+     * location of the published resources. It has to be unique among the
+     * configured transcoders and it must not be \c JPEG_TN or \c JPEG_SM, which
+     * are reserved for thumbnails.
+     */
+    virtual QString name() const = 0;
+
+    /*!
+     * \brief Returns the protocol info of the transcoded content.
+     *
+     * \return The protocol info of the transcoded content, such as
+     * <tt>http-get:*:audio/mpeg:DLNA.ORG_PN=MP3;DLNA.ORG_CI=1</tt>.
+     * The protocol is always published as \c http-get.
+     */
+    virtual HProtocolInfo protocolInfo() const = 0;
+
+    /*!
+     * \brief Indicates if the transcoder can convert items of the
+     * specified type.
+     *
+     * \param contentFormat specifies the MIME type of an item, such as
+     * \c audio/x-flac.
+     *
+     * \return \e true in case the transcoder can convert items of the
+     * specified type. A transcoder should not claim to support the format
+     * it produces, since there is no point in publishing the same format twice.
+     */
+    virtual bool supports(const QString& contentFormat) const = 0;
+
+    /*!
+     * \brief Converts the specified item.
+     *
+     * \param source specifies the data of the item, positioned at the start.
+     * The device is opened for reading. When the data of the item is stored
+     * in a file, the device is a \c QFile and the file can be passed to an
+     * external process using \c QFile::fileName(). The ownership of the device
+     * is \b not transferred.
+     *
+     * \param contentFormat specifies the MIME type of the item.
+     *
+     * \param output specifies the device the transcoded content is written to.
+     * The device is opened for writing. The data written to the device is
+     * made available to the control points as soon as possible, which is why
+     * the content should be written as it is produced. Once a write fails,
+     * the transcoding has been cancelled and the method should return without
+     * delay. The ownership of the device is \b not transferred.
+     *
+     * \return \e true in case the entire content was transcoded. In case
+     * \e false is returned, the data written to the output is dropped.
+     */
+    virtual bool transcode(
+        QIODevice* source, const QString& contentFormat, QIODevice* output) = 0;
+};
+
+}
+}
+}
+
+#endif /* HTRANSCODER_H_ */
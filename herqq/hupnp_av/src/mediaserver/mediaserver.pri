@@ -7,7 +7,12 @@ HEADERS += \
     $$SRC_LOC/mediaserver/habstractmediaserver_device.h \
     $$SRC_LOC/mediaserver/hmediaserver_deviceconfiguration.h \
     $$SRC_LOC/mediaserver/hmediaserver_deviceconfiguration_p.h \
-    $$SRC_LOC/mediaserver/hconnectionmanager_sourceservice_p.h
+    $$SRC_LOC/mediaserver/hconnectionmanager_sourceservice_p.h \
+    $$SRC_LOC/mediaserver/hthumbnail_generator.h \
+    $$SRC_LOC/mediaserver/hthumbnail_cache_p.h \
+    $$SRC_LOC/mediaserver/htranscoder.h \
+    $$SRC_LOC/mediaserver/htranscode_cache_p.h \
+    $$SRC_LOC/mediaserver/hmapped_file_cache_p.h
 
 SOURCES += \
     $$SRC_LOC/mediaserver/hmediaserver_adapter.cpp \
@@ -15,4 +20,9 @@ SOURCES += \
     $$SRC_LOC/mediaserver/hmediaserver_device_p.cpp \
     $$SRC_LOC/mediaserver/habstractmediaserver_device.cpp \
     $$SRC_LOC/mediaserver/hmediaserver_deviceconfiguration.cpp \
-    $$SRC_LOC/mediaserver/hconnectionmanager_sourceservice_p.cpp
+    $$SRC_LOC/mediaserver/hconnectionmanager_sourceservice_p.cpp \
+    $$SRC_LOC/mediaserver/hthumbnail_generator.cpp \
+    $$SRC_LOC/mediaserver/hthumbnail_cache_p.cpp \
+    $$SRC_LOC/mediaserver/htranscoder.cpp \
+    $$SRC_LOC/mediaserver/htranscode_cache_p.cpp \
+    $$SRC_LOC/mediaserver/hmapped_file_cache_p.cpp
@@ -63,7 +63,7 @@ qint32 HAbstractRenderingControlServicePrivate::listPresets(
 
     Q_ASSERT_X(outArgs, "", "An object for output arguments have to be defined");
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
 
     QStringList currentPresetNameList;
     qint32 retVal = q->listPresets(instanceId, &currentPresetNameList);
@@ -81,7 +81,7 @@ qint32 HAbstractRenderingControlServicePrivate::selectPreset(
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
     H_Q(HAbstractRenderingControlService);
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
     QString preset = inArgs.value("PresetName").toString();
 
     return q->selectPreset(instanceId, preset);
@@ -95,7 +95,7 @@ qint32 HAbstractRenderingControlServicePrivate::getBrightness(
 
     Q_ASSERT_X(outArgs, "", "An object for output arguments have to be defined");
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
 
     quint16 arg;
     qint32 retVal = q->getBrightness(instanceId, &arg);
@@ -113,7 +113,7 @@ qint32 HAbstractRenderingControlServicePrivate::setBrightness(
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
     H_Q(HAbstractRenderingControlService);
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
     quint16 arg = inArgs.value("DesiredBrightness").toUInt();
 
     return q->setBrightness(instanceId, arg);
@@ -127,7 +127,7 @@ qint32 HAbstractRenderingControlServicePrivate::getContrast(
 
     Q_ASSERT_X(outArgs, "", "An object for output arguments have to be defined");
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
 
     quint16 arg;
     qint32 retVal = q->getContrast(instanceId, &arg);
@@ -145,7 +145,7 @@ qint32 HAbstractRenderingControlServicePrivate::setContrast(
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
     H_Q(HAbstractRenderingControlService);
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
     quint16 arg = inArgs.value("DesiredContrast").toUInt();
 
     return q->setContrast(instanceId, arg);
@@ -159,7 +159,7 @@ qint32 HAbstractRenderingControlServicePrivate::getSharpness(
 
     Q_ASSERT_X(outArgs, "", "An object for output arguments have to be defined");
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
 
     quint16 arg;
     qint32 retVal = q->getSharpness(instanceId, &arg);
@@ -177,7 +177,7 @@ qint32 HAbstractRenderingControlServicePrivate::setSharpness(
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
     H_Q(HAbstractRenderingControlService);
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
     quint16 arg = inArgs.value("DesiredSharpness").toUInt();
 
     return q->setSharpness(instanceId, arg);
@@ -191,7 +191,7 @@ qint32 HAbstractRenderingControlServicePrivate::getRedVideoGain(
 
     Q_ASSERT_X(outArgs, "", "An object for output arguments have to be defined");
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
 
     quint16 arg;
     qint32 retVal = q->getRedVideoGain(instanceId, &arg);
@@ -209,7 +209,7 @@ qint32 HAbstractRenderingControlServicePrivate::setRedVideoGain(
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
     H_Q(HAbstractRenderingControlService);
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
     quint16 arg = inArgs.value("DesiredRedVideoGain").toUInt();
 
     return q->setRedVideoGain(instanceId, arg);
@@ -223,7 +223,7 @@ qint32 HAbstractRenderingControlServicePrivate::getGreenVideoGain(
 
     Q_ASSERT_X(outArgs, "", "An object for output arguments have to be defined");
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
 
     quint16 arg;
     qint32 retVal = q->getGreenVideoGain(instanceId, &arg);
@@ -241,7 +241,7 @@ qint32 HAbstractRenderingControlServicePrivate::setGreenVideoGain(
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
     H_Q(HAbstractRenderingControlService);
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
     quint16 arg = inArgs.value("DesiredGreenVideoGain").toUInt();
 
     return q->setGreenVideoGain(instanceId, arg);
@@ -255,7 +255,7 @@ qint32 HAbstractRenderingControlServicePrivate::getBlueVideoGain(
 
     Q_ASSERT_X(outArgs, "", "An object for output arguments have to be defined");
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
 
     quint16 arg;
     qint32 retVal = q->getBlueVideoGain(instanceId, &arg);
@@ -273,7 +273,7 @@ qint32 HAbstractRenderingControlServicePrivate::setBlueVideoGain(
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
     H_Q(HAbstractRenderingControlService);
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
     quint16 arg = inArgs.value("DesiredBlueVideoGain").toUInt();
 
     return q->setBlueVideoGain(instanceId, arg);
@@ -287,7 +287,7 @@ qint32 HAbstractRenderingControlServicePrivate::getRedVideoBlackLevel(
 
     Q_ASSERT_X(outArgs, "", "An object for output arguments have to be defined");
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
 
     quint16 arg;
     qint32 retVal = q->getRedVideoBlackLevel(instanceId, &arg);
@@ -305,7 +305,7 @@ qint32 HAbstractRenderingControlServicePrivate::setRedVideoBlackLevel(
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
     H_Q(HAbstractRenderingControlService);
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
     quint16 arg = inArgs.value("DesiredRedVideoBlackLevel").toUInt();
 
     return q->setRedVideoBlackLevel(instanceId, arg);
@@ -319,7 +319,7 @@ qint32 HAbstractRenderingControlServicePrivate::getGreenVideoBlackLevel(
 
     Q_ASSERT_X(outArgs, "", "An object for output arguments have to be defined");
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
 
     quint16 arg;
     qint32 retVal = q->getGreenVideoBlackLevel(instanceId, &arg);
@@ -337,7 +337,7 @@ qint32 HAbstractRenderingControlServicePrivate::setGreenVideoBlackLevel(
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
     H_Q(HAbstractRenderingControlService);
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
     quint16 arg = inArgs.value("DesiredGreenVideoBlackLevel").toUInt();
 
     return q->setGreenVideoBlackLevel(instanceId, arg);
@@ -351,7 +351,7 @@ qint32 HAbstractRenderingControlServicePrivate::getBlueVideoBlackLevel(
 
     Q_ASSERT_X(outArgs, "", "An object for output arguments have to be defined");
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
 
     quint16 arg;
     qint32 retVal = q->getBlueVideoBlackLevel(instanceId, &arg);
@@ -369,7 +369,7 @@ qint32 HAbstractRenderingControlServicePrivate::setBlueVideoBlackLevel(
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
     H_Q(HAbstractRenderingControlService);
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
     quint16 arg = inArgs.value("DesiredBlueVideoBlackLevel").toUInt();
 
     return q->setBlueVideoBlackLevel(instanceId, arg);
@@ -383,7 +383,7 @@ qint32 HAbstractRenderingControlServicePrivate::getColorTemperature(
 
     Q_ASSERT_X(outArgs, "", "An object for output arguments have to be defined");
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
 
     quint16 arg;
     qint32 retVal = q->getColorTemperature(instanceId, &arg);
@@ -401,7 +401,7 @@ qint32 HAbstractRenderingControlServicePrivate::setColorTemperature(
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
     H_Q(HAbstractRenderingControlService);
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
     quint16 arg = inArgs.value("DesiredColorTemperature").toUInt();
 
     return q->setColorTemperature(instanceId, arg);
@@ -415,7 +415,7 @@ qint32 HAbstractRenderingControlServicePrivate::getHorizontalKeystone(
 
     Q_ASSERT_X(outArgs, "", "An object for output arguments have to be defined");
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
 
     qint16 arg;
     qint32 retVal = q->getHorizontalKeystone(instanceId, &arg);
@@ -433,7 +433,7 @@ qint32 HAbstractRenderingControlServicePrivate::setHorizontalKeystone(
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
     H_Q(HAbstractRenderingControlService);
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
     quint16 arg = inArgs.value("DesiredHorizontalKeystone").toUInt();
 
     return q->setHorizontalKeystone(instanceId, arg);
@@ -447,7 +447,7 @@ qint32 HAbstractRenderingControlServicePrivate::getVerticalKeystone(
 
     Q_ASSERT_X(outArgs, "", "An object for output arguments have to be defined");
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
 
     qint16 arg;
     qint32 retVal = q->getVerticalKeystone(instanceId, &arg);
@@ -465,7 +465,7 @@ qint32 HAbstractRenderingControlServicePrivate::setVerticalKeystone(
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
     H_Q(HAbstractRenderingControlService);
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
     quint16 arg = inArgs.value("DesiredVerticalKeystone").toUInt();
 
     return q->setVerticalKeystone(instanceId, arg);
@@ -479,7 +479,7 @@ qint32 HAbstractRenderingControlServicePrivate::getMute(
 
     Q_ASSERT_X(outArgs, "", "An object for output arguments have to be defined");
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
     HChannel channel = inArgs.value("Channel").toString();
 
     bool arg;
@@ -498,7 +498,7 @@ qint32 HAbstractRenderingControlServicePrivate::setMute(
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
     H_Q(HAbstractRenderingControlService);
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
     bool arg = inArgs.value("DesiredMute").toBool();
     HChannel channel = inArgs.value("Channel").toString();
 
@@ -513,7 +513,7 @@ qint32 HAbstractRenderingControlServicePrivate::getVolume(
 
     Q_ASSERT_X(outArgs, "", "An object for output arguments have to be defined");
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
     HChannel channel = inArgs.value("Channel").toString();
 
     quint16 arg;
@@ -532,7 +532,7 @@ qint32 HAbstractRenderingControlServicePrivate::setVolume(
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
     H_Q(HAbstractRenderingControlService);
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
     HChannel channel = inArgs.value("Channel").toString();
     quint16 arg = inArgs.value("DesiredVolume").toUInt();
 
@@ -547,7 +547,7 @@ qint32 HAbstractRenderingControlServicePrivate::getVolumeDB(
 
     Q_ASSERT_X(outArgs, "", "An object for output arguments have to be defined");
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
     HChannel channel = inArgs.value("Channel").toString();
 
     qint16 arg;
@@ -566,7 +566,7 @@ qint32 HAbstractRenderingControlServicePrivate::setVolumeDB(
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
     H_Q(HAbstractRenderingControlService);
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
     qint16 arg = inArgs.value("DesiredVolume").toInt();
     HChannel channel = inArgs.value("Channel").toString();
 
@@ -581,7 +581,7 @@ qint32 HAbstractRenderingControlServicePrivate::getVolumeDBRange(
 
     Q_ASSERT_X(outArgs, "", "An object for output arguments have to be defined");
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
     HChannel channel = inArgs.value("Channel").toString();
 
     HVolumeDbRangeResult result;
@@ -603,7 +603,7 @@ qint32 HAbstractRenderingControlServicePrivate::getLoudness(
 
     Q_ASSERT_X(outArgs, "", "An object for output arguments have to be defined");
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
     HChannel channel = inArgs.value("Channel").toString();
 
     bool arg;
@@ -622,7 +622,7 @@ qint32 HAbstractRenderingControlServicePrivate::setLoudness(
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
     H_Q(HAbstractRenderingControlService);
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
     bool arg = inArgs.value("DesiredLoudness").toBool();
     HChannel channel = inArgs.value("Channel").toString();
 
@@ -637,7 +637,7 @@ qint32 HAbstractRenderingControlServicePrivate::getStateVariables(
 
     Q_ASSERT_X(outArgs, "", "An object for output arguments have to be defined");
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
     QSet<QString> svList = inArgs.value("StateVariableList").toString().split(",").toSet();
 
     QString arg;
@@ -658,7 +658,7 @@ qint32 HAbstractRenderingControlServicePrivate::setStateVariables(
 
     Q_ASSERT_X(outArgs, "", "An object for output arguments have to be defined");
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
     HUdn udn = inArgs.value("RenderingControlUDN").toString();
     HResourceType rt = HResourceType(inArgs.value("ServiceType").toString());
     HServiceId sid = inArgs.value("ServiceId").toString();
@@ -56,7 +56,7 @@ namespace Av
  ******************************************************************************/
 HRenderingControlAdapterPrivate::HRenderingControlAdapterPrivate() :
     HClientServiceAdapterPrivate(HRenderingControlInfo::supportedServiceType()),
-        m_instanceId(0)
+        m_instanceId(0), m_volumeRequests()
 {
 }
 
@@ -373,11 +373,79 @@ bool HRenderingControlAdapterPrivate::getVolume(
     return false;
 }
 
+HClientActionOp HRenderingControlAdapterPrivate::invokeSetVolume(
+    HClientAction* action, const QString& channel, quint16 volume)
+{
+    HActionArguments inArgs = action->info().inputArguments();
+    inArgs.setValue("InstanceID", m_instanceId);
+    inArgs.setValue("Channel", channel);
+    inArgs.setValue("DesiredVolume", volume);
+
+    return action->beginInvoke(
+        inArgs,
+        HActionInvokeCallback(this, &HRenderingControlAdapterPrivate::setVolume),
+        0);
+}
+
 bool HRenderingControlAdapterPrivate::setVolume(
-    HClientAction*, const HClientActionOp& op)
+    HClientAction* action, const HClientActionOp& op)
 {
     H_Q(HRenderingControlAdapter);
-    emit q->setVolumeCompleted(q, takeOp(op));
+
+    QString channel = op.inputArguments().value("Channel").toString();
+
+    HClientAdapterOpNull completed = takeOp(op);
+    QList<HClientAdapterOpNull> attached, failed;
+
+    QHash<QString, VolumeRequest>::iterator it = m_volumeRequests.find(channel);
+    if (it != m_volumeRequests.end())
+    {
+        attached = it->m_attached;
+        it->m_attached.clear();
+
+        if (it->m_hasPending)
+        {
+            // Only the latest of the values set during the invocation
+            // is sent and its result completes all of those calls.
+            HClientActionOp next =
+                invokeSetVolume(action, channel, it->m_pendingVolume);
+
+            if (next.returnValue() == UpnpInvocationInProgress)
+            {
+                addOp(it->m_waiting.first(), next);
+                it->m_attached = it->m_waiting.mid(1);
+                it->m_waiting.clear();
+                it->m_hasPending = false;
+            }
+            else
+            {
+                foreach(HClientAdapterOpNull waiting, it->m_waiting)
+                {
+                    waiting.setReturnValue(next.returnValue());
+                    waiting.setErrorDescription(next.errorDescription());
+                    failed.append(waiting);
+                }
+                m_volumeRequests.erase(it);
+            }
+        }
+        else
+        {
+            m_volumeRequests.erase(it);
+        }
+    }
+
+    emit q->setVolumeCompleted(q, completed);
+    foreach(HClientAdapterOpNull other, attached)
+    {
+        other.setReturnValue(op.returnValue());
+        other.setErrorDescription(op.errorDescription());
+        emit q->setVolumeCompleted(q, other);
+    }
+    foreach(const HClientAdapterOpNull& other, failed)
+    {
+        emit q->setVolumeCompleted(q, other);
+    }
+
     return false;
 }
 
@@ -1062,14 +1130,34 @@ HClientAdapterOpNull HRenderingControlAdapter::setVolume(
     }
 
     H_D(HRenderingControlAdapter);
-    HActionArguments inArgs = action->info().inputArguments();
-    inArgs.setValue("InstanceID", h->m_instanceId);
-    inArgs.setValue("Channel", channel.toString());
-    inArgs.setValue("DesiredVolume", desiredVolume);
+    QString channelName = channel.toString();
 
-    return h_ptr->beginInvoke(
-        action, inArgs,
-        HActionInvokeCallback(h, &HRenderingControlAdapterPrivate::setVolume));
+    QHash<QString, HRenderingControlAdapterPrivate::VolumeRequest>::iterator it =
+        h->m_volumeRequests.find(channelName);
+
+    if (it != h->m_volumeRequests.end())
+    {
+        // SetVolume is already in progress for the channel. The value is
+        // sent once the invocation completes, unless it is replaced by
+        // another value before that.
+        HClientAdapterOpNull retVal;
+        retVal.setReturnValue(UpnpInvocationInProgress);
+
+        it->m_pendingVolume = desiredVolume;
+        it->m_hasPending = true;
+        it->m_waiting.append(retVal);
+
+        return retVal;
+    }
+
+    HClientActionOp op = h->invokeSetVolume(action, channelName, desiredVolume);
+    if (op.returnValue() == UpnpInvocationInProgress)
+    {
+        h->m_volumeRequests.insert(
+            channelName, HRenderingControlAdapterPrivate::VolumeRequest());
+    }
+
+    return h->addOp<HNullValue>(op);
 }
 
 HClientAdapterOp<qint16> HRenderingControlAdapter::getVolumeDB(const HChannel& channel)
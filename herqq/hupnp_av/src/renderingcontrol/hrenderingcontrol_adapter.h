@@ -500,6 +500,14 @@ public:
     /*!
      * \brief Sets the value of the Volume setting of the specified channel.
      *
+     * Only one invocation of \c SetVolume is in progress per channel at a
+     * time. The values set while an invocation is in progress are coalesced
+     * and only the latest of them is sent once the invocation completes,
+     * which keeps a dragged volume slider from flooding the renderer. The
+     * setVolumeCompleted() signal is emitted for every call nevertheless and
+     * the calls that were coalesced complete with the result of the
+     * invocation that sent the latest value.
+     *
      * \param channel specifies the channel.
      *
      * \param desiredVolume specifies the desired volume for the specified
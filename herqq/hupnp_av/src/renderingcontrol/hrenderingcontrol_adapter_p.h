@@ -32,6 +32,9 @@
 
 #include <HUpnpCore/private/hclientservice_adapter_p.h>
 
+#include <QtCore/QHash>
+#include <QtCore/QList>
+
 namespace Herqq
 {
 
@@ -52,8 +55,32 @@ H_DISABLE_COPY(HRenderingControlAdapterPrivate)
 
 public:
 
+    struct VolumeRequest
+    {
+        bool m_hasPending;
+        quint16 m_pendingVolume;
+        // the latest of the values set while SetVolume was in progress
+
+        QList<HClientAdapterOpNull> m_waiting;
+        // the operations returned for the calls coalesced into
+        // m_pendingVolume
+
+        QList<HClientAdapterOpNull> m_attached;
+        // the operations completed by the invocation in progress in addition
+        // to the one registered for it
+
+        VolumeRequest() :
+            m_hasPending(false), m_pendingVolume(0), m_waiting(), m_attached()
+        {
+        }
+    };
+
     quint32 m_instanceId;
 
+    QHash<QString, VolumeRequest> m_volumeRequests;
+    // keyed by channel. a channel is here only while SetVolume is
+    // in progress for it
+
     HRenderingControlAdapterPrivate();
     virtual ~HRenderingControlAdapterPrivate();
 
@@ -93,6 +120,9 @@ public:
     bool getLoudness(HClientAction*, const HClientActionOp&);
     bool setLoudness(HClientAction*, const HClientActionOp&);
     bool getStateVariables(HClientAction*, const HClientActionOp&);
+
+    HClientActionOp invokeSetVolume(
+        HClientAction*, const QString& channel, quint16 volume);
     bool setStateVariables(HClientAction*, const HClientActionOp&);
 };
 
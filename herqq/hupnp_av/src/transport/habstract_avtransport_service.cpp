@@ -74,7 +74,7 @@ qint32 HAbstractTransportServicePrivate::setAVTransportURI(
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
     H_Q(HAbstractTransportService);
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
     QString currentUri = inArgs.value("CurrentURI").toString();
     QString metadata = inArgs.value("CurrentURIMetaData").toString();
 
@@ -87,7 +87,7 @@ qint32 HAbstractTransportServicePrivate::setNextAVTransportURI(
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
     H_Q(HAbstractTransportService);
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
     QString currentUri = inArgs.value("NextURI").toString();
     QString metadata = inArgs.value("NextURIMetaData").toString();
 
@@ -102,7 +102,7 @@ qint32 HAbstractTransportServicePrivate::getMediaInfo(
 
     Q_ASSERT_X(outArgs, "", "An object for output arguments have to be defined");
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
 
     HMediaInfo arg;
     qint32 retVal = q->getMediaInfo(instanceId, &arg);
@@ -130,7 +130,7 @@ qint32 HAbstractTransportServicePrivate::getMediaInfo_ext(
 
     Q_ASSERT_X(outArgs, "", "An object for output arguments have to be defined");
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
 
     HMediaInfo arg;
     qint32 retVal = q->getMediaInfo_ext(instanceId, &arg);
@@ -159,7 +159,7 @@ qint32 HAbstractTransportServicePrivate::getTransportInfo(
 
     Q_ASSERT_X(outArgs, "", "An object for output arguments have to be defined");
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
 
     HTransportInfo arg;
     qint32 retVal = q->getTransportInfo(instanceId, &arg);
@@ -181,7 +181,7 @@ qint32 HAbstractTransportServicePrivate::getPositionInfo(
 
     Q_ASSERT_X(outArgs, "", "An object for output arguments have to be defined");
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
 
     HPositionInfo arg;
     qint32 retVal = q->getPositionInfo(instanceId, &arg);
@@ -208,7 +208,7 @@ qint32 HAbstractTransportServicePrivate::getDeviceCapabilities(
 
     Q_ASSERT_X(outArgs, "", "An object for output arguments have to be defined");
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
 
     HDeviceCapabilities arg;
     qint32 retVal = q->getDeviceCapabilities(instanceId, &arg);
@@ -252,7 +252,7 @@ qint32 HAbstractTransportServicePrivate::getTransportSettings(
 
     Q_ASSERT_X(outArgs, "", "An object for output arguments have to be defined");
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
 
     HTransportSettings settings;
     qint32 retVal = q->getTransportSettings(instanceId, &settings);
@@ -271,7 +271,7 @@ qint32 HAbstractTransportServicePrivate::stop(
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
     H_Q(HAbstractTransportService);
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
 
     return q->stop(instanceId);
 }
@@ -282,7 +282,7 @@ qint32 HAbstractTransportServicePrivate::play(
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
     H_Q(HAbstractTransportService);
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
     QString playSpeed = inArgs.value("Speed").toString();
 
     return q->play(instanceId, playSpeed);
@@ -294,7 +294,7 @@ qint32 HAbstractTransportServicePrivate::pause(
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
     H_Q(HAbstractTransportService);
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
 
     return q->pause(instanceId);
 }
@@ -305,7 +305,7 @@ qint32 HAbstractTransportServicePrivate::record(
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
     H_Q(HAbstractTransportService);
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
 
     return q->record(instanceId);
 }
@@ -316,7 +316,7 @@ qint32 HAbstractTransportServicePrivate::seek(
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
     H_Q(HAbstractTransportService);
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
     QString unitAsStr = inArgs.value("Unit").toString();
     QString target = inArgs.value("Target").toString();
 
@@ -330,7 +330,7 @@ qint32 HAbstractTransportServicePrivate::next(
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
     H_Q(HAbstractTransportService);
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
 
     return q->next(instanceId);
 }
@@ -341,7 +341,7 @@ qint32 HAbstractTransportServicePrivate::previous(
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
     H_Q(HAbstractTransportService);
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
 
     return q->previous(instanceId);
 }
@@ -352,7 +352,7 @@ qint32 HAbstractTransportServicePrivate::setPlayMode(
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
     H_Q(HAbstractTransportService);
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
     HPlayMode playMode = inArgs.value("NewPlayMode").toString();
 
     return q->setPlayMode(instanceId, playMode);
@@ -364,7 +364,7 @@ qint32 HAbstractTransportServicePrivate::setRecordQualityMode(
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
     H_Q(HAbstractTransportService);
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
     QString recQualityMode =
         inArgs.value("NewRecordQualityMode").toString();
 
@@ -379,7 +379,7 @@ qint32 HAbstractTransportServicePrivate::getCurrentTransportActions(
 
     Q_ASSERT_X(outArgs, "", "An object for output arguments have to be defined");
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
 
     QSet<HTransportAction> arg;
     qint32 retVal = q->getCurrentTransportActions(instanceId, &arg);
@@ -405,7 +405,7 @@ qint32 HAbstractTransportServicePrivate::getDRMState(
 
     Q_ASSERT_X(outArgs, "", "An object for output arguments have to be defined");
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
 
     HAvTransportInfo::DrmState arg;
     qint32 retVal = q->getDrmState(instanceId, &arg);
@@ -425,7 +425,7 @@ qint32 HAbstractTransportServicePrivate::getStateVariables(
 
     Q_ASSERT_X(outArgs, "", "An object for output arguments have to be defined");
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
     QSet<QString> svNames = inArgs.value("StateVariableList").toString().split(",").toSet();
 
     QString arg;
@@ -446,7 +446,7 @@ qint32 HAbstractTransportServicePrivate::setStateVariables(
 
     Q_ASSERT_X(outArgs, "", "An object for output arguments have to be defined");
 
-    quint32 instanceId = inArgs.value("InstanceID").toUInt();
+    quint32 instanceId = inArgs.get<quint32>("InstanceID");
     HUdn udn = inArgs.value("RenderingControlUDN").toString();
     HResourceType rt = HResourceType(inArgs.value("ServiceType").toString());
     HServiceId sid = inArgs.value("ServiceId").toString();
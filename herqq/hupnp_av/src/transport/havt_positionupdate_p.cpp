@@ -0,0 +1,160 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "havt_positionupdate_p.h"
+
+#include <QtCore/QStringList>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+/*******************************************************************************
+ * HAvtPositionUpdate
+ ******************************************************************************/
+HAvtPositionUpdate::HAvtPositionUpdate() :
+    m_instanceId(0), m_track(0), m_position(0), m_state(), m_speed("1")
+{
+}
+
+bool HAvtPositionUpdate::isValid() const
+{
+    return m_state.isValid();
+}
+
+qreal HAvtPositionUpdate::rate() const
+{
+    if (m_state.type() != HTransportState::Playing)
+    {
+        return 0;
+    }
+
+    bool ok = false;
+    int index = m_speed.indexOf('/');
+    if (index < 0)
+    {
+        qreal retVal = m_speed.toDouble(&ok);
+        return ok ? retVal : 1;
+    }
+
+    qreal numerator = m_speed.left(index).toDouble(&ok);
+    if (ok)
+    {
+        qreal denominator = m_speed.mid(index + 1).toDouble(&ok);
+        if (ok && denominator != 0)
+        {
+            return numerator / denominator;
+        }
+    }
+
+    return 1;
+}
+
+qint64 HAvtPositionUpdate::extrapolate(qint64 elapsedMsecs) const
+{
+    qint64 retVal = m_position + static_cast<qint64>(elapsedMsecs * rate());
+    return qMax(retVal, static_cast<qint64>(0));
+}
+
+QString HAvtPositionUpdate::variableName()
+{
+    return "X_HERQQ_PositionUpdate";
+}
+
+qint64 HAvtPositionUpdate::toMsecs(const HDuration& arg)
+{
+    qint64 retVal =
+        (arg.hours() * 3600 + arg.minutes() * 60 + arg.seconds()) * 1000;
+
+    return arg.isPositive() ? retVal : -retVal;
+}
+
+HDuration HAvtPositionUpdate::toDuration(qint64 msecs)
+{
+    qint64 seconds = qMax(msecs, static_cast<qint64>(0)) / 1000;
+
+    return QString("%1:%2:%3").arg(
+        QString::number(seconds / 3600),
+        QString::number((seconds / 60) % 60).rightJustified(2, '0'),
+        QString::number(seconds % 60).rightJustified(2, '0'));
+}
+
+QString HAvtPositionUpdate::toString(const QList<HAvtPositionUpdate>& updates)
+{
+    QStringList entries;
+    foreach(const HAvtPositionUpdate& update, updates)
+    {
+        entries.append(QString("%1,%2,%3,%4,%5").arg(
+            QString::number(update.m_instanceId),
+            QString::number(update.m_track),
+            QString::number(update.m_position),
+            update.m_state.toString(),
+            update.m_speed));
+    }
+    return entries.join(";");
+}
+
+QList<HAvtPositionUpdate> HAvtPositionUpdate::fromString(const QString& arg)
+{
+    QList<HAvtPositionUpdate> retVal;
+    foreach(const QString& entry, arg.split(';', QString::SkipEmptyParts))
+    {
+        QStringList fields = entry.split(',');
+        if (fields.size() != 5)
+        {
+            continue;
+        }
+
+        bool ok = false;
+        HAvtPositionUpdate update;
+        update.m_instanceId = fields.at(0).toUInt(&ok);
+        if (ok)
+        {
+            update.m_track = fields.at(1).toUInt(&ok);
+        }
+        if (ok)
+        {
+            update.m_position = fields.at(2).toLongLong(&ok);
+        }
+        if (!ok)
+        {
+            continue;
+        }
+
+        update.m_state = HTransportState(fields.at(3));
+        update.m_speed = fields.at(4).trimmed();
+
+        if (update.isValid())
+        {
+            retVal.append(update);
+        }
+    }
+    return retVal;
+}
+
+}
+}
+}
@@ -0,0 +1,102 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HAVT_POSITIONUPDATE_P_H_
+#define HAVT_POSITIONUPDATE_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include "hduration.h"
+#include "htransportstate.h"
+
+#include <QtCore/QList>
+#include <QtCore/QString>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+//
+// The playback position of a virtual AVTransport instance as it is published
+// through the evented vendor state variable X_HERQQ_PositionUpdate.
+//
+// AVTransport does not event the position state variables, which is why
+// control points have to poll GetPositionInfo(). A HUPnP Media Renderer
+// publishes the position, the transport state and the playback speed of each
+// instance instead, so that a HUPnP control point can extrapolate the current
+// position locally. The variable is published only when the AVTransport
+// service description of the renderer declares it. When it is declared to be
+// multicast evented, the updates also reach the control points that listen
+// to the multicast event group without subscribing to the AVTransport.
+//
+// The value lists an entry for each instance, the entries are separated
+// by semicolons and the fields of an entry by commas:
+// "InstanceID,Track,Position in milliseconds,TransportState,TransportPlaySpeed"
+//
+class HAvtPositionUpdate
+{
+public:
+
+    quint32 m_instanceId;
+    quint32 m_track;
+
+    qint64 m_position;
+    // the relative time position in milliseconds
+
+    HTransportState m_state;
+    QString m_speed;
+
+    HAvtPositionUpdate();
+
+    bool isValid() const;
+
+    // the rate at which the position advances, zero unless the instance
+    // is playing
+    qreal rate() const;
+
+    // the position the specified time after the update was taken
+    qint64 extrapolate(qint64 elapsedMsecs) const;
+
+    static QString variableName();
+
+    static qint64 toMsecs(const HDuration&);
+    static HDuration toDuration(qint64 msecs);
+
+    static QString toString(const QList<HAvtPositionUpdate>&);
+    static QList<HAvtPositionUpdate> fromString(const QString&);
+};
+
+}
+}
+}
+
+#endif /* HAVT_POSITIONUPDATE_P_H_ */
@@ -21,6 +21,7 @@
 
 #include "havtransport_adapter.h"
 #include "havtransport_adapter_p.h"
+#include "havt_positionupdate_p.h"
 
 #include "hduration.h"
 #include "hplaymode.h"
@@ -70,7 +71,8 @@ namespace Av
  ******************************************************************************/
 HAvTransportAdapterPrivate::HAvTransportAdapterPrivate() :
     HClientServiceAdapterPrivate(HAvTransportInfo::supportedServiceType()),
-        m_instanceId(0)
+        m_instanceId(0), m_positionUpdatesSupported(false),
+        m_positionUpdate(), m_positionUpdateReceived()
 {
 }
 
@@ -406,12 +408,37 @@ HAvTransportAdapter::~HAvTransportAdapter()
 {
 }
 
+bool HAvTransportAdapterPrivate::updatePosition(const QString& value)
+{
+    QList<HAvtPositionUpdate> updates = HAvtPositionUpdate::fromString(value);
+    foreach(const HAvtPositionUpdate& update, updates)
+    {
+        if (update.m_instanceId == m_instanceId)
+        {
+            m_positionUpdate = update;
+            m_positionUpdateReceived.start();
+            return true;
+        }
+    }
+    return false;
+}
+
 void HAvTransportAdapter::lastChange(
     const HClientStateVariable*, const HStateVariableEvent& event)
 {
     emit lastChangeReceived(this, event.newValue().toString());
 }
 
+void HAvTransportAdapter::positionUpdate(
+    const HClientStateVariable*, const HStateVariableEvent& event)
+{
+    H_D(HAvTransportAdapter);
+    if (h->updatePosition(event.newValue().toString()))
+    {
+        emit positionUpdateReceived(this, estimatedPosition());
+    }
+}
+
 bool HAvTransportAdapter::prepareService(HClientService* service)
 {
     const HClientStateVariable* lastChange = service->stateVariables().value("LastChange");
@@ -424,9 +451,49 @@ bool HAvTransportAdapter::prepareService(HClientService* service)
             SLOT(lastChange(const Herqq::Upnp::HClientStateVariable*,Herqq::Upnp::HStateVariableEvent)));
         Q_ASSERT(ok); Q_UNUSED(ok)
     }
+
+    H_D(HAvTransportAdapter);
+    h->m_positionUpdate = HAvtPositionUpdate();
+
+    const HClientStateVariable* positionUpdate =
+        service->stateVariables().value(HAvtPositionUpdate::variableName());
+
+    h->m_positionUpdatesSupported = positionUpdate;
+    if (positionUpdate)
+    {
+        bool ok = connect(
+            positionUpdate,
+            SIGNAL(valueChanged(const Herqq::Upnp::HClientStateVariable*,Herqq::Upnp::HStateVariableEvent)),
+            this,
+            SLOT(positionUpdate(const Herqq::Upnp::HClientStateVariable*,Herqq::Upnp::HStateVariableEvent)));
+        Q_ASSERT(ok); Q_UNUSED(ok)
+
+        h->updatePosition(positionUpdate->value().toString());
+    }
+
     return true;
 }
 
+bool HAvTransportAdapter::isPositionUpdateSupported() const
+{
+    const HAvTransportAdapterPrivate* h = h_func();
+    return h->m_positionUpdatesSupported;
+}
+
+HDuration HAvTransportAdapter::estimatedPosition(bool* ok) const
+{
+    const HAvTransportAdapterPrivate* h = h_func();
+    if (!h->m_positionUpdate.isValid())
+    {
+        if (ok) { *ok = false; }
+        return HDuration();
+    }
+
+    if (ok) { *ok = true; }
+    return HAvtPositionUpdate::toDuration(
+        h->m_positionUpdate.extrapolate(h->m_positionUpdateReceived.elapsed()));
+}
+
 HClientAdapterOpNull HAvTransportAdapter::setAVTransportURI(
     const QUrl& currentUri, const QString& currentUriMetaData)
 {
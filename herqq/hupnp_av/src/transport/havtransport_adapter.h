@@ -22,6 +22,7 @@
 #ifndef HAVTRANSPORT_ADAPTER_H_
 #define HAVTRANSPORT_ADAPTER_H_
 
+#include <HUpnpAv/HDuration>
 #include <HUpnpAv/HMediaInfo>
 #include <HUpnpAv/HPositionInfo>
 #include <HUpnpAv/HTransportInfo>
@@ -80,6 +81,10 @@ private Q_SLOTS:
         const Herqq::Upnp::HClientStateVariable*,
         const Herqq::Upnp::HStateVariableEvent&);
 
+    void positionUpdate(
+        const Herqq::Upnp::HClientStateVariable*,
+        const Herqq::Upnp::HStateVariableEvent&);
+
 protected:
 
     virtual bool prepareService(HClientService* service);
@@ -410,6 +415,51 @@ public:
         const HUdn& avtUdn, const HResourceType& serviceType,
         const HServiceId& serviceId, const QString& stateVariableValuePairs);
 
+    /*!
+     * \brief Indicates if the AVTransport publishes the playback positions of
+     * its instances.
+     *
+     * AVTransport does not event the position state variables, which is why
+     * the playback position is normally tracked by calling getPositionInfo()
+     * periodically. A HUPnP Media Renderer can publish the position, the
+     * transport state and the playback speed of its instances through an
+     * evented vendor state variable named \c X_HERQQ_PositionUpdate instead,
+     * in which case the position can be read using estimatedPosition()
+     * without polling the renderer. The variable is multicast evented in the
+     * description of the HUPnP Media Renderer, so a control point that has
+     * multicast eventing enabled in its HControlPointConfiguration receives
+     * the updates even when it is not subscribed to the AVTransport.
+     *
+     * \return \e true if the AVTransport declares the
+     * \c X_HERQQ_PositionUpdate state variable.
+     *
+     * \sa estimatedPosition(), positionUpdateReceived()
+     */
+    bool isPositionUpdateSupported() const;
+
+    /*!
+     * \brief Returns the current playback position of the virtual
+     * AVTransport instance extrapolated from the last position update.
+     *
+     * The position is extrapolated from the last published position using
+     * the published transport state and playback speed. It is accurate to
+     * a second.
+     *
+     * \param ok specifies a pointer to a \c bool, which is set to \e true
+     * if a position update has been received for the instance. This is
+     * optional.
+     *
+     * \return The current playback position of the virtual AVTransport
+     * instance, or a zero duration in case no position update has been
+     * received. In that case use getPositionInfo() instead.
+     *
+     * \remarks This is a synchronous method that does not communicate with
+     * the AVTransport.
+     *
+     * \sa isPositionUpdateSupported(), positionUpdateReceived()
+     */
+    HDuration estimatedPosition(bool* ok = 0) const;
+
 Q_SIGNALS:
 
     /*!
@@ -743,6 +793,27 @@ Q_SIGNALS:
      */
     void lastChangeReceived(
         Herqq::Upnp::Av::HAvTransportAdapter* source, const QString& data);
+
+    /*!
+     * \brief This signal is emitted when the AVTransport has published a new
+     * playback position for the virtual AVTransport instance.
+     *
+     * The AVTransport publishes a position when the playback position,
+     * the transport state or the playback speed changes in a way that
+     * cannot be extrapolated from the previous update, as well as
+     * periodically during playback.
+     *
+     * \param source specifies the HAvTransportAdapter instance that
+     * sent the event.
+     *
+     * \param position specifies the playback position the AVTransport
+     * published.
+     *
+     * \sa isPositionUpdateSupported(), estimatedPosition()
+     */
+    void positionUpdateReceived(
+        Herqq::Upnp::Av::HAvTransportAdapter* source,
+        const Herqq::Upnp::Av::HDuration& position);
 };
 
 }
@@ -30,8 +30,12 @@
 // change or the file may be removed without of notice.
 //
 
+#include "havt_positionupdate_p.h"
+
 #include <HUpnpCore/private/hclientservice_adapter_p.h>
 
+#include <QtCore/QTime>
+
 namespace Herqq
 {
 
@@ -54,6 +58,14 @@ public:
 
     quint32 m_instanceId;
 
+    bool m_positionUpdatesSupported;
+    // whether the AVTransport declares X_HERQQ_PositionUpdate
+
+    HAvtPositionUpdate m_positionUpdate;
+    // the last position update received for m_instanceId, if any
+
+    QTime m_positionUpdateReceived;
+
     HAvTransportAdapterPrivate();
     virtual ~HAvTransportAdapterPrivate();
 
@@ -78,6 +90,9 @@ public:
     bool getDRMState(HClientAction*, const HClientActionOp&);
     bool getStateVariables(HClientAction*, const HClientActionOp&);
     bool setStateVariables(HClientAction*, const HClientActionOp&);
+
+    // returns true if the value contained an update for m_instanceId
+    bool updatePosition(const QString& value);
 };
 
 }
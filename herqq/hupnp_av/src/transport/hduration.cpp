@@ -21,7 +21,6 @@
 
 #include "hduration.h"
 
-#include <QtCore/QStringList>
 #include <QtCore/QDateTime>
 
 namespace Herqq
@@ -66,76 +65,131 @@ HDuration::HDuration() :
 
 namespace
 {
-qreal calculateFraction(const QString& arg, bool* ok)
+//
+// Reads an unsigned decimal number of at least one digit and advances the
+// specified position past it.
+//
+bool readNumber(const QChar*& pos, const QChar* end, qint64* value)
 {
-    qreal retVal = 0;
+    const QChar* begin = pos;
 
-    int index = arg.indexOf('.');
-    int index2 = arg.indexOf('/');
-    if (index > 0)
+    qint64 retVal = 0;
+    for(; pos < end && pos->unicode() >= '0' && pos->unicode() <= '9'; ++pos)
     {
-        retVal = arg.mid(index+1, index2-(index+1)).toDouble(ok);
-        if (*ok && retVal > 0)
+        if (retVal > Q_INT64_C(99999999999))
         {
-            if (index2 > 0)
-            {
-                double divisor = arg.mid(index2+1).toDouble(ok);
-                if (*ok && divisor > retVal)
-                {
-                    retVal /= divisor;
-                }
-                else
-                {
-                    *ok = false;
-                }
-            }
+            return false;
         }
+        retVal = retVal * 10 + (pos->unicode() - '0');
     }
 
-    return retVal;
+    *value = retVal;
+    return pos > begin;
+}
+
+inline bool readChar(const QChar*& pos, const QChar* end, char c)
+{
+    if (pos < end && pos->unicode() == c)
+    {
+        ++pos;
+        return true;
+    }
+    return false;
+}
+
+//
+// Reads the optional fraction of a second, which is either F+ or F0/F1.
+//
+bool readFraction(const QChar*& pos, const QChar* end, qreal* value)
+{
+    const QChar* begin = pos;
+
+    qint64 numerator;
+    if (!readNumber(pos, end, &numerator))
+    {
+        return false;
+    }
+
+    if (readChar(pos, end, '/'))
+    {
+        qint64 denominator;
+        if (!readNumber(pos, end, &denominator) || denominator <= numerator)
+        {
+            return false;
+        }
+        *value = static_cast<qreal>(numerator) / denominator;
+    }
+    else
+    {
+        qreal divisor = 1;
+        for(; begin < pos; ++begin)
+        {
+            divisor *= 10;
+        }
+        *value = numerator / divisor;
+    }
+
+    return true;
+}
+
+bool isSpace(const QChar& c)
+{
+    return c.unicode() == ' ' || c.unicode() == '\t' ||
+           c.unicode() == '\r' || c.unicode() == '\n';
+}
+
+QString format(qint32 hours, qint32 minutes, qint32 seconds)
+{
+    char buf[32];
+    qsnprintf(buf, sizeof(buf), "%02d:%02d:%02d", hours, minutes, seconds);
+    return QString::fromLatin1(buf);
 }
 }
 
 HDuration::HDuration(const QString& arg) :
     h_ptr(new HDurationPrivate())
 {
-    QString trimmed = arg.trimmed();
-    QStringList tmp = trimmed.split(":");
-    if (tmp.size() != 3)
+    const QChar* begin = arg.constData();
+    const QChar* end = begin + arg.size();
+
+    while (begin < end && isSpace(*begin)) { ++begin; }
+    while (end > begin && isSpace(*(end - 1))) { --end; }
+
+    const QChar* pos = begin;
+    bool positive = !readChar(pos, end, '-');
+    if (positive)
     {
-        h_ptr->m_duration = QString("00:00:00");
-        return;
+        readChar(pos, end, '+');
     }
-    else if (tmp.at(0).startsWith("-"))
+
+    const QChar* unsignedBegin = pos;
+
+    qint64 hours, minutes, seconds;
+    if (!readNumber(pos, end, &hours) || hours > 0x7fffffff ||
+        !readChar(pos, end, ':') ||
+        !readNumber(pos, end, &minutes) || minutes > 59 ||
+        !readChar(pos, end, ':') ||
+        !readNumber(pos, end, &seconds) || seconds > 59)
     {
-        h_ptr->m_positive = false;
-        tmp.first().remove(0, 1);
+        return;
     }
 
-    bool ok = false;
-    qint32 hours = tmp.at(0).toInt(&ok);
-    if (ok)
+    qreal fractions = 0;
+    if (readChar(pos, end, '.') && !readFraction(pos, end, &fractions))
     {
-        qint32 minutes = tmp.at(1).toInt(&ok);
-        if (ok)
-        {
-            int index = tmp.at(2).indexOf('.');
-            qint32 seconds = tmp.at(2).mid(0, index).toInt(&ok);
-            if (ok)
-            {
-                qreal fractions = calculateFraction(tmp.at(2), &ok);
-                if (ok)
-                {
-                    h_ptr->m_fractions = fractions;
-                }
-
-                h_ptr->m_seconds = seconds;
-                h_ptr->m_duration = trimmed;
-                h_ptr->m_hours = hours;
-                h_ptr->m_minutes = minutes;
-            }
-        }
+        return;
     }
+    else if (pos < end)
+    {
+        return;
+    }
+
+    h_ptr->m_hours = static_cast<qint32>(hours);
+    h_ptr->m_minutes = static_cast<qint32>(minutes);
+    h_ptr->m_seconds = static_cast<qint32>(seconds);
+    h_ptr->m_fractions = fractions;
+    h_ptr->m_positive = positive;
+    h_ptr->m_duration = QString(unsignedBegin, end - unsignedBegin);
 }
 
 HDuration::~HDuration()
@@ -161,7 +215,8 @@ HDuration::HDuration(const QTime& time) :
     h_ptr->m_hours = time.hour();
     h_ptr->m_minutes = time.minute();
     h_ptr->m_seconds = time.second();
-    h_ptr->m_duration = time.toString();
+    h_ptr->m_duration = time.isValid() ?
+        format(time.hour(), time.minute(), time.second()) : QString();
 }
 
 qint32 HDuration::hours() const
@@ -197,7 +252,8 @@ bool HDuration::isZero() const
 
 QString HDuration::toString() const
 {
-    return QString("%1%2").arg(!h_ptr->m_positive ? "-" : "", h_ptr->m_duration);
+    return h_ptr->m_positive ?
+        h_ptr->m_duration : QString(h_ptr->m_duration).prepend('-');
 }
 
 QTime HDuration::toTime() const
@@ -0,0 +1,112 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "htransport_statemachine_p.h"
+
+#include <QtCore/QVector>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+namespace
+{
+const qint32 StateCount = HTransportState::VendorDefined + 1;
+const qint32 ActionCount = HTransportAction::VendorDefined - 1;
+
+// the abbreviations of the states used in the table below
+const HTransportState::Type NA = HTransportState::Undefined;
+const HTransportState::Type S = HTransportState::Stopped;
+const HTransportState::Type P = HTransportState::Playing;
+const HTransportState::Type PP = HTransportState::PausedPlayback;
+const HTransportState::Type PR = HTransportState::PausedRecording;
+const HTransportState::Type R = HTransportState::Recording;
+const HTransportState::Type V = HTransportState::VendorDefined;
+
+// the rows are indexed by HTransportState::Type and the columns by
+// HTransportAction::Type - HTransportAction::Play. NA means that the action
+// is not available in the state
+const HTransportState::Type Transitions[StateCount][ActionCount] =
+{
+//  PLAY STOP PAUSE SEEK NEXT PREV RECORD
+    { NA, S,   NA,   NA,  NA,  NA,  NA }, // Undefined
+    { NA, NA,  NA,   NA,  NA,  NA,  NA }, // NoMediaPresent
+    { P,  S,   NA,   S,   S,   S,   R  }, // Stopped
+    { P,  S,   PP,   P,   P,   P,   NA }, // Playing
+    { P,  S,   NA,   NA,  NA,  NA,  NA }, // Transitioning
+    { P,  S,   PP,   NA,  NA,  NA,  NA }, // PausedPlayback
+    { NA, S,   PR,   NA,  NA,  NA,  R  }, // PausedRecording
+    { NA, S,   PR,   NA,  NA,  NA,  NA }, // Recording
+    { P,  S,   PP,   V,   V,   V,   R  }  // VendorDefined
+};
+
+QVector<HTransportAction::ActionFlags> createAvailableActions()
+{
+    QVector<HTransportAction::ActionFlags> retVal(StateCount);
+    for(qint32 state = 0; state < StateCount; ++state)
+    {
+        for(qint32 action = 0; action < ActionCount; ++action)
+        {
+            if (Transitions[state][action] != NA)
+            {
+                retVal[state] |= HTransportAction::toFlag(
+                    static_cast<HTransportAction::Type>(
+                        action + HTransportAction::Play));
+            }
+        }
+    }
+    return retVal;
+}
+
+// indexed by HTransportState::Type
+const QVector<HTransportAction::ActionFlags> AvailableActions =
+    createAvailableActions();
+}
+
+/*******************************************************************************
+ * HTransportStateMachine
+ ******************************************************************************/
+HTransportState::Type HTransportStateMachine::transition(
+    HTransportState::Type state, HTransportAction::Type action)
+{
+    if (action < HTransportAction::Play ||
+        action >= HTransportAction::VendorDefined)
+    {
+        return NA;
+    }
+
+    return Transitions[state][action - HTransportAction::Play];
+}
+
+HTransportAction::ActionFlags HTransportStateMachine::availableActions(
+    HTransportState::Type state)
+{
+    return AvailableActions[state];
+}
+
+}
+}
+}
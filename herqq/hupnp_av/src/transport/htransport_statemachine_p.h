@@ -0,0 +1,69 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HTRANSPORT_STATEMACHINE_P_H_
+#define HTRANSPORT_STATEMACHINE_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include "htransportstate.h"
+#include "htransportaction.h"
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+//
+// The transitions of the AVTransport state machine as a table indexed by
+// the current state and the invoked Transport Action. The actions available
+// in each state are derived from the same table once.
+//
+class HTransportStateMachine
+{
+public:
+
+    // returns the state the action leads to, or HTransportState::Undefined
+    // in case the action is not available in the specified state. an action
+    // that does not change the state leads to the state itself
+    static HTransportState::Type transition(
+        HTransportState::Type state, HTransportAction::Type action);
+
+    // returns the actions available in the specified state
+    static HTransportAction::ActionFlags availableActions(
+        HTransportState::Type state);
+};
+
+}
+}
+}
+
+#endif /* HTRANSPORT_STATEMACHINE_P_H_ */
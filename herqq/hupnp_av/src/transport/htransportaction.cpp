@@ -24,6 +24,7 @@
 #include <HUpnpCore/private/hmisc_utils_p.h>
 
 #include <QtCore/QSet>
+#include <QtCore/QVector>
 
 namespace Herqq
 {
@@ -34,6 +35,38 @@ namespace Upnp
 namespace Av
 {
 
+namespace
+{
+QVector<QString> createCsvStrings()
+{
+    QVector<QString> retVal(HTransportAction::AllActions + 1);
+    for(qint32 i = 0; i < retVal.size(); ++i)
+    {
+        QString csv;
+        for(qint32 type = HTransportAction::Play;
+            type < HTransportAction::VendorDefined; ++type)
+        {
+            HTransportAction::Type actionType =
+                static_cast<HTransportAction::Type>(type);
+
+            if (i & HTransportAction::toFlag(actionType))
+            {
+                if (!csv.isEmpty())
+                {
+                    csv.append(',');
+                }
+                csv.append(HTransportAction::toString(actionType));
+            }
+        }
+        retVal[i] = csv;
+    }
+    return retVal;
+}
+
+// indexed by HTransportAction::ActionFlags
+const QVector<QString> CsvStrings = createCsvStrings();
+}
+
 /*******************************************************************************
  * HTransportAction
  ******************************************************************************/
@@ -126,19 +159,46 @@ HTransportAction::Type HTransportAction::fromString(const QString& type)
     return retVal;
 }
 
-QSet<HTransportAction> HTransportAction::allActions()
+HTransportAction::ActionFlag HTransportAction::toFlag(Type type)
+{
+    return type > Undefined && type < VendorDefined ?
+        static_cast<ActionFlag>(1 << (type - Play)) : NoActions;
+}
+
+HTransportAction::ActionFlags HTransportAction::toFlags(
+    const QSet<HTransportAction>& actions)
+{
+    ActionFlags retVal = NoActions;
+    foreach(const HTransportAction& action, actions)
+    {
+        retVal |= toFlag(action.type());
+    }
+    return retVal;
+}
+
+QSet<HTransportAction> HTransportAction::fromFlags(ActionFlags flags)
 {
     QSet<HTransportAction> retVal;
-    retVal.insert(Play);
-    retVal.insert(Stop);
-    retVal.insert(Pause);
-    retVal.insert(Seek);
-    retVal.insert(Next);
-    retVal.insert(Previous);
-    retVal.insert(Record);
+    for(qint32 type = Play; type < VendorDefined; ++type)
+    {
+        if (flags & toFlag(static_cast<Type>(type)))
+        {
+            retVal.insert(static_cast<Type>(type));
+        }
+    }
     return retVal;
 }
 
+QString HTransportAction::toCsvString(ActionFlags flags)
+{
+    return CsvStrings[flags & AllActions];
+}
+
+QSet<HTransportAction> HTransportAction::allActions()
+{
+    return fromFlags(AllActions);
+}
+
 bool operator==(const HTransportAction& obj1, const HTransportAction& obj2)
 {
     return obj1.toString() == obj2.toString();
@@ -105,6 +105,62 @@ public:
         VendorDefined
     };
 
+    /*!
+     * \brief This enumeration specifies the standard Transport Actions as
+     * flags that can be combined into a mask.
+     *
+     * \sa toFlag(), ActionFlags
+     */
+    enum ActionFlag
+    {
+        /*!
+         * No action.
+         */
+        NoActions = 0x00,
+
+        /*!
+         * Play.
+         */
+        PlayFlag = 0x01,
+
+        /*!
+         * Stop.
+         */
+        StopFlag = 0x02,
+
+        /*!
+         * Pause.
+         */
+        PauseFlag = 0x04,
+
+        /*!
+         * Seek.
+         */
+        SeekFlag = 0x08,
+
+        /*!
+         * Next.
+         */
+        NextFlag = 0x10,
+
+        /*!
+         * Previous.
+         */
+        PreviousFlag = 0x20,
+
+        /*!
+         * Record.
+         */
+        RecordFlag = 0x40,
+
+        /*!
+         * Every standard Transport Action.
+         */
+        AllActions = 0x7f
+    };
+
+    Q_DECLARE_FLAGS(ActionFlags, ActionFlag);
+
 private:
 
     Type m_type;
@@ -178,6 +234,52 @@ public:
      */
     static Type fromString(const QString& type);
 
+    /*!
+     * \brief Returns the flag of the specified Type value.
+     *
+     * \param type specifies the Type value.
+     *
+     * \return the flag of the specified Type value, or
+     * HTransportAction::NoActions in case the type is not a standard
+     * Transport Action.
+     */
+    static ActionFlag toFlag(Type type);
+
+    /*!
+     * \brief Returns the flags of the standard Transport Actions of the
+     * specified set.
+     *
+     * \param actions specifies the Transport Actions. Vendor-defined
+     * actions are ignored.
+     *
+     * \return the flags of the standard Transport Actions of the
+     * specified set.
+     */
+    static ActionFlags toFlags(const QSet<HTransportAction>& actions);
+
+    /*!
+     * \brief Returns the Transport Actions of the specified flags.
+     *
+     * \param flags specifies the Transport Actions.
+     *
+     * \return a set containing the Transport Actions of the specified flags.
+     */
+    static QSet<HTransportAction> fromFlags(ActionFlags flags);
+
+    /*!
+     * \brief Returns the Transport Actions of the specified flags as a
+     * comma-separated list.
+     *
+     * The lists are created once, which is why this does not allocate.
+     *
+     * \param flags specifies the Transport Actions.
+     *
+     * \return the Transport Actions of the specified flags as a
+     * comma-separated list in the order of the Type values, such as
+     * "PLAY,STOP,SEEK", as in the value of \c CurrentTransportActions.
+     */
+    static QString toCsvString(ActionFlags flags);
+
     /*!
      * Returns a set containing every standard Transport Action.
      *
@@ -218,6 +320,8 @@ inline bool operator!=(const HTransportAction& obj1, const HTransportAction& obj
  */
 H_UPNP_AV_EXPORT quint32 qHash(const HTransportAction& key);
 
+Q_DECLARE_OPERATORS_FOR_FLAGS(HTransportAction::ActionFlags)
+
 }
 }
 }
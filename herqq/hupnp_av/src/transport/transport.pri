@@ -15,6 +15,8 @@ HEADERS += \
     $$SRC_LOC/transport/havtransport_adapter.h \
     $$SRC_LOC/transport/havtransport_adapter_p.h \
     $$SRC_LOC/transport/havtransport_info.h \
+    $$SRC_LOC/transport/havt_positionupdate_p.h \
+    $$SRC_LOC/transport/htransport_statemachine_p.h \
     $$SRC_LOC/transport/hrecordmediumwritestatus.h \
     $$SRC_LOC/transport/hrecordqualitymode.h
     
@@ -32,5 +34,7 @@ SOURCES += \
     $$SRC_LOC/transport/habstract_avtransport_service.cpp \
     $$SRC_LOC/transport/havtransport_adapter.cpp \
     $$SRC_LOC/transport/havtransport_info.cpp \
+    $$SRC_LOC/transport/havt_positionupdate_p.cpp \
+    $$SRC_LOC/transport/htransport_statemachine_p.cpp \
     $$SRC_LOC/transport/hrecordmediumwritestatus.cpp \
     $$SRC_LOC/transport/hrecordqualitymode.cpp